@@ -0,0 +1,38 @@
+#include <benchmark/benchmark.h>
+#include <edyn/collision/collide.hpp>
+#include <edyn/collision/collision_result.hpp>
+#include <edyn/math/constants.hpp>
+#include <edyn/math/quaternion.hpp>
+
+// Runs the collision function of a pair of shapes in contact, with the second
+// shape slightly rotated so the contact is not perfectly aligned.
+template<typename ShapeA, typename ShapeB>
+static void collide_pair(benchmark::State &state, ShapeA shA, ShapeB shB, edyn::vector3 posB) {
+    auto ctx = edyn::collision_context{};
+    ctx.posA = edyn::vector3_zero;
+    ctx.ornA = edyn::quaternion_identity;
+    ctx.posB = posB;
+    ctx.ornB = edyn::quaternion_axis_angle(edyn::normalize(edyn::vector3{1, 2, 3}), edyn::scalar(0.3));
+    ctx.threshold = edyn::scalar(0.02);
+
+    for (auto _ : state) {
+        auto result = edyn::collision_result{};
+        edyn::collide(shA, shB, ctx, result);
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+static const auto box = edyn::box_shape{edyn::vector3{0.5, 0.5, 0.5}};
+static const auto sphere = edyn::sphere_shape{0.5};
+static const auto capsule = edyn::capsule_shape{0.25, 0.5};
+static const auto cylinder = edyn::cylinder_shape{0.5, 0.5};
+static const auto plane = edyn::plane_shape{edyn::vector3_y, 0};
+
+BENCHMARK_CAPTURE(collide_pair, sphere_sphere, sphere, sphere, edyn::vector3{0.9, 0.2, 0});
+BENCHMARK_CAPTURE(collide_pair, sphere_box, sphere, box, edyn::vector3{0, 0.95, 0});
+BENCHMARK_CAPTURE(collide_pair, box_box, box, box, edyn::vector3{0, 0.95, 0});
+BENCHMARK_CAPTURE(collide_pair, box_plane, box, plane, edyn::vector3{0, -0.2, 0});
+BENCHMARK_CAPTURE(collide_pair, capsule_capsule, capsule, capsule, edyn::vector3{0.2, 0.45, 0});
+BENCHMARK_CAPTURE(collide_pair, capsule_box, capsule, box, edyn::vector3{0, 0.7, 0});
+BENCHMARK_CAPTURE(collide_pair, cylinder_cylinder, cylinder, cylinder, edyn::vector3{0, 0.95, 0});
+BENCHMARK_CAPTURE(collide_pair, cylinder_box, cylinder, box, edyn::vector3{0, 0.95, 0});
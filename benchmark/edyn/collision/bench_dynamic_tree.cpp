@@ -0,0 +1,114 @@
+#include <benchmark/benchmark.h>
+#include <edyn/collision/dynamic_tree.hpp>
+#include <cmath>
+#include <random>
+#include <vector>
+
+// Random unit boxes scattered in a cube whose size grows with the number of
+// boxes so the density stays constant.
+static void make_aabbs(size_t count, std::vector<edyn::AABB> &aabbs, std::vector<entt::entity> &entities) {
+    auto gen = std::mt19937{42};
+    auto extent = std::cbrt(edyn::scalar(count)) * 2;
+    auto dist = std::uniform_real_distribution<edyn::scalar>{-extent, extent};
+
+    for (size_t i = 0; i < count; ++i) {
+        auto center = edyn::vector3{dist(gen), dist(gen), dist(gen)};
+        aabbs.push_back({center - edyn::vector3_one * 0.5, center + edyn::vector3_one * 0.5});
+        entities.push_back(entt::entity(i));
+    }
+}
+
+static void dynamic_tree_insert(benchmark::State &state) {
+    auto aabbs = std::vector<edyn::AABB>{};
+    auto entities = std::vector<entt::entity>{};
+    make_aabbs(state.range(0), aabbs, entities);
+
+    for (auto _ : state) {
+        auto tree = edyn::dynamic_tree{};
+
+        for (size_t i = 0; i < aabbs.size(); ++i) {
+            tree.create(aabbs[i], entities[i]);
+        }
+
+        benchmark::DoNotOptimize(tree.root());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void dynamic_tree_bulk_create(benchmark::State &state) {
+    auto aabbs = std::vector<edyn::AABB>{};
+    auto entities = std::vector<entt::entity>{};
+    auto ids = std::vector<edyn::tree_node_id_t>{};
+    make_aabbs(state.range(0), aabbs, entities);
+
+    for (auto _ : state) {
+        auto tree = edyn::dynamic_tree{};
+        ids.clear();
+        tree.create(aabbs, entities, ids);
+        benchmark::DoNotOptimize(tree.root());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void dynamic_tree_query(benchmark::State &state) {
+    auto aabbs = std::vector<edyn::AABB>{};
+    auto entities = std::vector<entt::entity>{};
+    auto ids = std::vector<edyn::tree_node_id_t>{};
+    make_aabbs(state.range(0), aabbs, entities);
+
+    auto tree = edyn::dynamic_tree{};
+    tree.create(aabbs, entities, ids);
+    size_t num_results = 0;
+
+    // Query every leaf against the tree, as the broadphase does.
+    for (auto _ : state) {
+        for (auto &aabb : aabbs) {
+            tree.query(aabb, [&](edyn::tree_node_id_t) {
+                ++num_results;
+            });
+        }
+    }
+
+    benchmark::DoNotOptimize(num_results);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void dynamic_tree_raycast(benchmark::State &state) {
+    auto aabbs = std::vector<edyn::AABB>{};
+    auto entities = std::vector<entt::entity>{};
+    auto ids = std::vector<edyn::tree_node_id_t>{};
+    make_aabbs(state.range(0), aabbs, entities);
+
+    auto tree = edyn::dynamic_tree{};
+    tree.create(aabbs, entities, ids);
+
+    auto gen = std::mt19937{7};
+    auto extent = std::cbrt(edyn::scalar(state.range(0))) * 2;
+    auto dist = std::uniform_real_distribution<edyn::scalar>{-extent, extent};
+    auto rays = std::vector<std::pair<edyn::vector3, edyn::vector3>>{};
+
+    for (int i = 0; i < 256; ++i) {
+        rays.emplace_back(edyn::vector3{dist(gen), dist(gen), dist(gen)},
+                          edyn::vector3{dist(gen), dist(gen), dist(gen)});
+    }
+
+    size_t num_results = 0;
+
+    for (auto _ : state) {
+        for (auto &ray : rays) {
+            tree.raycast(ray.first, ray.second, [&](edyn::tree_node_id_t) {
+                ++num_results;
+            });
+        }
+    }
+
+    benchmark::DoNotOptimize(num_results);
+    state.SetItemsProcessed(state.iterations() * rays.size());
+}
+
+BENCHMARK(dynamic_tree_insert)->Arg(256)->Arg(4096);
+BENCHMARK(dynamic_tree_bulk_create)->Arg(256)->Arg(4096);
+BENCHMARK(dynamic_tree_query)->Arg(256)->Arg(4096);
+BENCHMARK(dynamic_tree_raycast)->Arg(256)->Arg(4096);
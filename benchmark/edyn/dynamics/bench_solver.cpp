@@ -0,0 +1,88 @@
+#include <benchmark/benchmark.h>
+#include <edyn/constraints/constraint_row.hpp>
+#include <edyn/dynamics/row_cache_soa.hpp>
+#include <edyn/math/matrix3x3.hpp>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+// Random rows between pairs of bodies, where body zero is fixed, similar to
+// the contact rows of a pile of bodies.
+static void make_problem(size_t num_bodies, size_t num_rows,
+                         std::vector<edyn::solver_body> &bodies,
+                         std::vector<edyn::constraint_row> &rows) {
+    auto gen = std::mt19937{42};
+    auto dist = std::uniform_real_distribution<edyn::scalar>{-1, 1};
+    auto body_dist = std::uniform_int_distribution<edyn::solver_body_index_t>(0, num_bodies - 1);
+    auto random_vec = [&]() { return edyn::vector3{dist(gen), dist(gen), dist(gen)}; };
+
+    bodies.emplace_back();
+
+    for (size_t i = 1; i < num_bodies; ++i) {
+        auto &body = bodies.emplace_back();
+        body.dv = random_vec();
+        body.dw = random_vec();
+        body.inv_m = 1;
+        body.inv_I = edyn::matrix3x3_identity;
+    }
+
+    for (size_t i = 0; i < num_rows; ++i) {
+        auto bodyA = body_dist(gen);
+        auto bodyB = body_dist(gen);
+
+        if (bodyA == bodyB) {
+            bodyB = (bodyB + 1) % num_bodies;
+        }
+
+        auto &row = rows.emplace_back();
+        row.J = {random_vec(), random_vec(), random_vec(), random_vec()};
+        row.body = {bodyA, bodyB};
+        row.eff_mass = edyn::scalar(1) / (bodies[bodyA].inv_m * (dot(row.J[0], row.J[0]) + dot(row.J[1], row.J[1])) +
+                                          bodies[bodyB].inv_m * (dot(row.J[2], row.J[2]) + dot(row.J[3], row.J[3])));
+        row.rhs = dist(gen);
+        row.lower_limit = 0;
+        row.upper_limit = EDYN_SCALAR_MAX;
+        row.impulse = 0;
+    }
+}
+
+// One Gauss-Seidel iteration over all rows per benchmark iteration.
+static void solver_iteration(benchmark::State &state) {
+    auto bodies = std::vector<edyn::solver_body>{};
+    auto rows = std::vector<edyn::constraint_row>{};
+    make_problem(state.range(0) / 2, state.range(0), bodies, rows);
+
+    for (auto _ : state) {
+        auto max_delta_impulse = edyn::scalar(0);
+
+        for (auto &row : rows) {
+            auto delta_impulse = edyn::solve(row, bodies);
+            edyn::apply_row_impulse(delta_impulse, row, bodies);
+            max_delta_impulse = std::max(std::abs(delta_impulse), max_delta_impulse);
+        }
+
+        benchmark::DoNotOptimize(max_delta_impulse);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Same as above but solving batches of independent rows.
+static void solver_iteration_batched(benchmark::State &state) {
+    auto bodies = std::vector<edyn::solver_body>{};
+    auto rows = std::vector<edyn::constraint_row>{};
+    make_problem(state.range(0) / 2, state.range(0), bodies, rows);
+
+    auto soa = edyn::row_cache_soa{};
+    edyn::pack_row_batches(soa, rows, bodies);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(edyn::solve(soa, rows, bodies));
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(solver_iteration)->Arg(256)->Arg(4096);
+BENCHMARK(solver_iteration_batched)->Arg(256)->Arg(4096);
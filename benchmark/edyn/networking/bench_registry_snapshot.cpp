@@ -0,0 +1,83 @@
+#include <benchmark/benchmark.h>
+#include <entt/entity/registry.hpp>
+#include <edyn/comp/position.hpp>
+#include <edyn/comp/orientation.hpp>
+#include <edyn/comp/linvel.hpp>
+#include <edyn/comp/angvel.hpp>
+#include <edyn/networking/comp/networked_comp.hpp>
+#include <edyn/networking/packet/registry_snapshot.hpp>
+#include <edyn/serialization/memory_archive.hpp>
+#include <edyn/serialization/bitpack_archive.hpp>
+#include <edyn/util/tuple_util.hpp>
+#include <vector>
+
+template<typename Component>
+static void insert_pool(entt::registry &registry, const std::vector<entt::entity> &entities,
+                        edyn::packet::registry_snapshot &snap) {
+    auto index = edyn::tuple_index_of<edyn::component_index_type, Component>(edyn::networked_components);
+    edyn::internal::snapshot_insert_entities<Component>(registry, entities.begin(), entities.end(), snap, index);
+}
+
+// Snapshot with the transform and velocities of moving rigid bodies, which
+// is what the server sends to clients in every update.
+static edyn::packet::registry_snapshot make_snapshot(entt::registry &registry, size_t count) {
+    auto entities = std::vector<entt::entity>{};
+
+    for (size_t i = 0; i < count; ++i) {
+        auto entity = registry.create();
+        auto k = edyn::scalar(i);
+        registry.emplace<edyn::position>(entity, k * edyn::scalar(0.5), edyn::scalar(1), -k);
+        registry.emplace<edyn::orientation>(entity, edyn::quaternion_axis_angle(edyn::vector3_y, k));
+        registry.emplace<edyn::linvel>(entity, edyn::scalar(1), -k * edyn::scalar(0.01), edyn::scalar(0));
+        registry.emplace<edyn::angvel>(entity, edyn::scalar(0), edyn::scalar(2), edyn::scalar(0));
+        entities.push_back(entity);
+    }
+
+    auto snap = edyn::packet::registry_snapshot{};
+    snap.id = 1;
+    insert_pool<edyn::position>(registry, entities, snap);
+    insert_pool<edyn::orientation>(registry, entities, snap);
+    insert_pool<edyn::linvel>(registry, entities, snap);
+    insert_pool<edyn::angvel>(registry, entities, snap);
+    return snap;
+}
+
+template<typename OutputArchive>
+static void registry_snapshot_encode(benchmark::State &state) {
+    auto registry = entt::registry{};
+    auto snap = make_snapshot(registry, state.range(0));
+    auto buffer = std::vector<uint8_t>{};
+
+    for (auto _ : state) {
+        buffer.clear();
+        auto archive = OutputArchive(buffer);
+        archive(snap);
+        benchmark::DoNotOptimize(buffer.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["bytes"] = buffer.size();
+}
+
+template<typename OutputArchive, typename InputArchive>
+static void registry_snapshot_decode(benchmark::State &state) {
+    auto registry = entt::registry{};
+    auto snap = make_snapshot(registry, state.range(0));
+    auto buffer = std::vector<uint8_t>{};
+    auto output = OutputArchive(buffer);
+    output(snap);
+
+    for (auto _ : state) {
+        auto result = edyn::packet::registry_snapshot{};
+        auto archive = InputArchive(buffer.data(), buffer.size());
+        archive(result);
+        benchmark::DoNotOptimize(result.entities.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(registry_snapshot_encode, edyn::memory_output_archive)->Arg(64)->Arg(1024);
+BENCHMARK_TEMPLATE(registry_snapshot_encode, edyn::bitpack_output_archive)->Arg(64)->Arg(1024);
+BENCHMARK_TEMPLATE(registry_snapshot_decode, edyn::memory_output_archive, edyn::memory_input_archive)->Arg(64)->Arg(1024);
+BENCHMARK_TEMPLATE(registry_snapshot_decode, edyn::bitpack_output_archive, edyn::bitpack_input_archive)->Arg(64)->Arg(1024);
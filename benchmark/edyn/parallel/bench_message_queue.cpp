@@ -0,0 +1,31 @@
+#include <benchmark/benchmark.h>
+#include <edyn/parallel/message_queue.hpp>
+#include <cstdint>
+
+struct bench_message {
+    uint32_t number;
+};
+
+// Pushes a burst of messages from a single sender then consumes all of them.
+// Bursts larger than the ring capacity also exercise the overflow list.
+static void message_queue_push_consume(benchmark::State &state) {
+    auto queue = edyn::message_queue{};
+    auto id = edyn::message_queue_id{0, 0};
+    auto count = static_cast<uint32_t>(state.range(0));
+    uint32_t sum = 0;
+
+    for (auto _ : state) {
+        for (uint32_t i = 0; i < count; ++i) {
+            queue.push<bench_message>(id, bench_message{i});
+        }
+
+        queue.consume([&](const edyn::message_queue_id &, edyn::message_any &content) {
+            sum += entt::any_cast<bench_message>(&content)->number;
+        });
+    }
+
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(message_queue_push_consume)->Arg(16)->Arg(64)->Arg(1024);
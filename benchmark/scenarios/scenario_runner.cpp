@@ -0,0 +1,264 @@
+#include "scenarios.hpp"
+#include <array>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+#include <entt/entity/registry.hpp>
+#include <edyn/edyn.hpp>
+#include <edyn/dynamics/island_solver_stats.hpp>
+#include <edyn/time/time.hpp>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// Runs the standard scenarios in each execution mode with different numbers
+// of worker threads and prints the results as JSON in the standard output.
+//
+// Usage: edyn_scenarios [--scenario NAME] [--mode sequential|sequential_multithreaded|asynchronous]
+//                       [--workers N] [--steps N] [--scale S]
+//
+// By default, all scenarios run in all modes with 1, 2, 4 and all hardware
+// threads. Since peak memory is measured for the entire process, run a single
+// scenario and mode per process to get the peak memory of each one.
+
+namespace {
+
+struct run_config {
+    const edyn::bench::scenario *scenario;
+    edyn::execution_mode mode;
+    size_t num_workers;
+};
+
+// Measurements of each step, recorded in the step callbacks, which run in
+// the simulation worker thread in asynchronous mode.
+struct step_recorder {
+    double step_start;
+    std::vector<double> step_times;
+    std::array<double, edyn::num_island_solver_states> state_time;
+    std::atomic<unsigned> num_steps;
+
+    void reset() {
+        step_times.clear();
+        state_time.fill(0);
+        num_steps.store(0, std::memory_order_release);
+    }
+};
+
+step_recorder recorder;
+
+void pre_step(entt::registry &) {
+    recorder.step_start = edyn::performance_time();
+}
+
+void post_step(entt::registry &registry) {
+    recorder.step_times.push_back(edyn::performance_time() - recorder.step_start);
+
+    for (auto [entity, stats] : registry.view<edyn::island_solver_stats>().each()) {
+        for (size_t i = 0; i < stats.state_time.size(); ++i) {
+            recorder.state_time[i] += stats.state_time[i];
+        }
+    }
+
+    recorder.num_steps.fetch_add(1, std::memory_order_release);
+}
+
+const char *mode_names[] = {"sequential", "sequential_multithreaded", "asynchronous"};
+
+const char *state_names[] = {
+    "pack_rows",
+    "solve_constraints",
+    "assign_applied_impulses",
+    "apply_solution",
+    "solve_position_constraints",
+    "update_nodes"
+};
+
+static_assert(std::size(state_names) == edyn::num_island_solver_states);
+
+// Steps a paused simulation and waits for the steps to be done, which
+// happens in another thread in asynchronous mode.
+void run_steps(entt::registry &registry, unsigned count) {
+    auto target = recorder.num_steps.load(std::memory_order_acquire) + count;
+
+    for (unsigned i = 0; i < count; ++i) {
+        edyn::step_simulation(registry);
+    }
+
+    while (recorder.num_steps.load(std::memory_order_acquire) < target) {
+        edyn::update(registry);
+        std::this_thread::yield();
+    }
+
+    edyn::update(registry);
+}
+
+size_t peak_memory_bytes() {
+#if defined(_WIN32)
+    auto counters = PROCESS_MEMORY_COUNTERS{};
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize;
+#else
+    auto usage = rusage{};
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+double percentile(const std::vector<double> &sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0;
+    }
+
+    auto index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+void run(const run_config &run, unsigned num_steps, edyn::scalar scale, bool first) {
+    auto registry = entt::registry{};
+    auto config = edyn::init_config{};
+    config.execution_mode = run.mode;
+    config.num_worker_threads = run.num_workers;
+    edyn::attach(registry, config);
+    edyn::set_collect_solver_stats(registry, true);
+    edyn::set_pre_step_callback(registry, &pre_step);
+    edyn::set_post_step_callback(registry, &post_step);
+    edyn::set_paused(registry, true);
+
+    auto setup_start = edyn::performance_time();
+    run.scenario->setup(registry, scale);
+    auto setup_time = edyn::performance_time() - setup_start;
+
+    recorder.reset();
+    run_steps(registry, run.scenario->warmup_steps);
+    recorder.reset();
+
+    auto start = edyn::performance_time();
+    run_steps(registry, num_steps);
+    auto elapsed = edyn::performance_time() - start;
+
+    auto num_bodies = registry.view<edyn::rigidbody_tag>().size();
+    edyn::detach(registry);
+
+    auto step_times = recorder.step_times;
+    std::sort(step_times.begin(), step_times.end());
+    auto steps = std::max(size_t(1), step_times.size());
+
+    std::printf("%s    {\n", first ? "" : ",\n");
+    std::printf("      \"scenario\": \"%s\",\n", run.scenario->name);
+    std::printf("      \"mode\": \"%s\",\n", mode_names[static_cast<size_t>(run.mode)]);
+    std::printf("      \"workers\": %zu,\n", run.num_workers);
+    std::printf("      \"bodies\": %zu,\n", num_bodies);
+    std::printf("      \"steps\": %zu,\n", step_times.size());
+    std::printf("      \"setup_ms\": %.3f,\n", setup_time * 1000);
+    std::printf("      \"steps_per_second\": %.3f,\n", step_times.size() / elapsed);
+    std::printf("      \"step_ms\": {\"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f},\n",
+                percentile(step_times, 0.5) * 1000, percentile(step_times, 0.9) * 1000,
+                percentile(step_times, 0.99) * 1000, percentile(step_times, 1) * 1000);
+    std::printf("      \"solver_phase_ms\": {");
+
+    for (size_t i = 0; i < edyn::num_island_solver_states; ++i) {
+        std::printf("%s\"%s\": %.4f", i > 0 ? ", " : "", state_names[i], recorder.state_time[i] / steps * 1000);
+    }
+
+    std::printf("},\n");
+    std::printf("      \"peak_memory_bytes\": %zu\n", peak_memory_bytes());
+    std::printf("    }");
+    std::fflush(stdout);
+}
+
+}
+
+int main(int argc, char **argv) {
+    const char *scenario_name = nullptr;
+    const char *mode_name = nullptr;
+    size_t num_workers = 0;
+    unsigned num_steps = 300;
+    auto scale = edyn::scalar(1);
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--scenario") == 0) {
+            scenario_name = argv[i + 1];
+        } else if (std::strcmp(argv[i], "--mode") == 0) {
+            mode_name = argv[i + 1];
+        } else if (std::strcmp(argv[i], "--workers") == 0) {
+            num_workers = std::strtoul(argv[i + 1], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--steps") == 0) {
+            num_steps = std::strtoul(argv[i + 1], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--scale") == 0) {
+            scale = static_cast<edyn::scalar>(std::strtod(argv[i + 1], nullptr));
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    auto worker_counts = std::vector<size_t>{};
+
+    if (num_workers > 0) {
+        worker_counts.push_back(num_workers);
+    } else {
+        auto num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+        for (size_t count : {size_t(1), size_t(2), size_t(4), size_t(num_threads)}) {
+            if (count <= num_threads &&
+                std::find(worker_counts.begin(), worker_counts.end(), count) == worker_counts.end()) {
+                worker_counts.push_back(count);
+            }
+        }
+    }
+
+    auto runs = std::vector<run_config>{};
+
+    for (auto &scenario : edyn::bench::all_scenarios()) {
+        if (scenario_name && std::strcmp(scenario_name, scenario.name) != 0) {
+            continue;
+        }
+
+        for (size_t m = 0; m < std::size(mode_names); ++m) {
+            if (mode_name && std::strcmp(mode_name, mode_names[m]) != 0) {
+                continue;
+            }
+
+            auto mode = static_cast<edyn::execution_mode>(m);
+
+            // Worker threads only run background tasks in sequential mode.
+            if (mode == edyn::execution_mode::sequential) {
+                runs.push_back({&scenario, mode, 1});
+                continue;
+            }
+
+            for (auto count : worker_counts) {
+                runs.push_back({&scenario, mode, count});
+            }
+        }
+    }
+
+    if (runs.empty()) {
+        std::fprintf(stderr, "No scenario matches the given options\n");
+        return 1;
+    }
+
+    std::printf("{\n  \"results\": [\n");
+
+    for (size_t i = 0; i < runs.size(); ++i) {
+        run(runs[i], num_steps, scale, i == 0);
+    }
+
+    std::printf("\n  ]\n}\n");
+
+    return 0;
+}
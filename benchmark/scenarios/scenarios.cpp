@@ -0,0 +1,171 @@
+#include "scenarios.hpp"
+#include <array>
+#include <cmath>
+#include <algorithm>
+#include <memory>
+#include <entt/entity/registry.hpp>
+#include <edyn/constraints/hinge_constraint.hpp>
+#include <edyn/shapes/create_paged_triangle_mesh.hpp>
+#include <edyn/shapes/paged_mesh_shape.hpp>
+#include <edyn/util/constraint_util.hpp>
+#include <edyn/util/ragdoll.hpp>
+#include <edyn/util/rigidbody.hpp>
+#include <edyn/util/shape_util.hpp>
+
+namespace edyn::bench {
+
+static size_t scaled(size_t count, scalar scale) {
+    return std::max(size_t(1), static_cast<size_t>(std::round(count * scale)));
+}
+
+static void make_ground(entt::registry &registry) {
+    auto def = rigidbody_def{};
+    def.kind = rigidbody_kind::rb_static;
+    def.shape = plane_shape{vector3_y, 0};
+    make_rigidbody(registry, def);
+}
+
+// Square pyramid of boxes, about 10k boxes at scale 1.
+static void setup_box_pyramid(entt::registry &registry, scalar scale) {
+    make_ground(registry);
+
+    auto base = scaled(31, std::cbrt(scale));
+    auto def = rigidbody_def{};
+    def.shape = box_shape{vector3_one * scalar(0.5)};
+    auto defs = std::vector<rigidbody_def>{};
+
+    for (size_t layer = 0; layer < base; ++layer) {
+        auto side = base - layer;
+        auto offset = scalar(side - 1) * scalar(0.5);
+
+        for (size_t i = 0; i < side; ++i) {
+            for (size_t j = 0; j < side; ++j) {
+                def.position = {scalar(i) - offset, scalar(layer) + scalar(0.5), scalar(j) - offset};
+                defs.push_back(def);
+            }
+        }
+    }
+
+    batch_make_rigidbodies(registry, defs);
+}
+
+// Rag dolls falling onto the ground in a grid, 1k at scale 1.
+static void setup_ragdolls(entt::registry &registry, scalar scale) {
+    make_ground(registry);
+
+    auto count = scaled(1000, scale);
+    auto side = static_cast<size_t>(std::ceil(std::sqrt(scalar(count))));
+    auto def = ragdoll_simple_def{};
+
+    for (size_t i = 0; i < count; ++i) {
+        auto x = scalar(i % side) * 2;
+        auto z = scalar(i / side) * 2;
+        def.position = {x, scalar(1 + (i % 3)), z};
+        make_ragdoll(registry, def);
+    }
+}
+
+// Boxes resting apart from each other on the ground, which fall asleep
+// during the warm-up, 100k at scale 1. Measures the cost of a large world in
+// which nothing happens.
+static void setup_sleeping_props(entt::registry &registry, scalar scale) {
+    make_ground(registry);
+
+    auto count = scaled(100000, scale);
+    auto side = static_cast<size_t>(std::ceil(std::sqrt(scalar(count))));
+    auto def = rigidbody_def{};
+    def.shape = box_shape{vector3_one * scalar(0.5)};
+    auto defs = std::vector<rigidbody_def>{};
+    defs.reserve(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        def.position = {scalar(i % side) * 2, scalar(0.5), scalar(i / side) * 2};
+        defs.push_back(def);
+    }
+
+    batch_make_rigidbodies(registry, defs);
+}
+
+// Pages are kept in memory after the mesh is created, thus nothing needs to
+// be loaded.
+class resident_page_loader : public triangle_mesh_page_loader_base {
+public:
+    void load(paged_triangle_mesh *, size_t) override {}
+};
+
+// Four-wheeled vehicles rolling over hilly paged triangle mesh terrain, 64 at
+// scale 1. Wheels are cylinders attached to the chassis with hinges.
+static void setup_vehicles_on_terrain(entt::registry &registry, scalar scale) {
+    constexpr scalar extent = 400;
+    constexpr size_t num_vertices = 201;
+
+    auto vertices = std::vector<vector3>{};
+    auto indices = std::vector<uint32_t>{};
+    make_plane_mesh(extent, extent, num_vertices, num_vertices, vertices, indices);
+
+    for (auto &v : vertices) {
+        v.y = std::sin(v.x * scalar(0.05)) * std::cos(v.z * scalar(0.07)) * 2;
+    }
+
+    auto trimesh = std::make_shared<paged_triangle_mesh>(std::make_shared<resident_page_loader>());
+    create_paged_triangle_mesh(*trimesh, vertices.begin(), vertices.end(),
+                               indices.begin(), indices.end(), 256, {}, vector3_one, nullptr);
+
+    auto terrain_def = rigidbody_def{};
+    terrain_def.kind = rigidbody_kind::rb_static;
+    terrain_def.shape = paged_mesh_shape{trimesh};
+    make_rigidbody(registry, terrain_def);
+
+    auto count = scaled(64, scale);
+    auto side = static_cast<size_t>(std::ceil(std::sqrt(scalar(count))));
+    auto speed = scalar(8);
+    auto wheel_radius = scalar(0.4);
+
+    auto chassis_def = rigidbody_def{};
+    chassis_def.mass = 800;
+    chassis_def.shape = box_shape{vector3{0.9, 0.3, 2}};
+    chassis_def.linvel = {0, 0, speed};
+
+    auto wheel_def = rigidbody_def{};
+    wheel_def.mass = 20;
+    wheel_def.shape = cylinder_shape{wheel_radius, scalar(0.15), coordinate_axis::x};
+    wheel_def.linvel = {0, 0, speed};
+    wheel_def.angvel = {speed / wheel_radius, 0, 0};
+
+    const auto wheel_pivots = std::array<vector3, 4>{
+        vector3{ 1.1, -0.3,  1.4},
+        vector3{-1.1, -0.3,  1.4},
+        vector3{ 1.1, -0.3, -1.4},
+        vector3{-1.1, -0.3, -1.4}
+    };
+
+    for (size_t i = 0; i < count; ++i) {
+        auto origin = vector3{(scalar(i % side) - scalar(side) / 2) * 6, 4,
+                              (scalar(i / side) - scalar(side) / 2) * 10};
+        chassis_def.position = origin;
+        auto chassis_entity = make_rigidbody(registry, chassis_def);
+
+        for (auto &pivot : wheel_pivots) {
+            wheel_def.position = origin + pivot;
+            auto wheel_entity = make_rigidbody(registry, wheel_def);
+            make_constraint<hinge_constraint>(registry, chassis_entity, wheel_entity, [&](hinge_constraint &hinge) {
+                hinge.pivot[0] = pivot;
+                hinge.pivot[1] = vector3_zero;
+                hinge.set_axes(vector3_x, vector3_x);
+            });
+        }
+    }
+}
+
+const std::vector<scenario> & all_scenarios() {
+    static const auto scenarios = std::vector<scenario>{
+        {"box_pyramid", &setup_box_pyramid, 0},
+        {"ragdolls", &setup_ragdolls, 0},
+        // Islands fall asleep after `island_time_to_sleep`.
+        {"sleeping_props", &setup_sleeping_props, 180},
+        {"vehicles_on_terrain", &setup_vehicles_on_terrain, 30},
+    };
+    return scenarios;
+}
+
+}
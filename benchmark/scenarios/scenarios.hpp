@@ -0,0 +1,27 @@
+#ifndef EDYN_BENCHMARK_SCENARIOS_HPP
+#define EDYN_BENCHMARK_SCENARIOS_HPP
+
+#include <vector>
+#include <entt/entity/fwd.hpp>
+#include <edyn/math/scalar.hpp>
+
+namespace edyn::bench {
+
+/**
+ * A standard world used to measure the throughput of the whole simulation.
+ * The setup function populates an attached registry and the size of the world
+ * is multiplied by the scale factor, which allows quick runs with a smaller
+ * version of each scenario.
+ */
+struct scenario {
+    const char *name;
+    void (*setup)(entt::registry &, scalar scale);
+    // Steps to run before measuring, e.g. to let bodies settle or fall asleep.
+    unsigned warmup_steps;
+};
+
+const std::vector<scenario> & all_scenarios();
+
+}
+
+#endif // EDYN_BENCHMARK_SCENARIOS_HPP
@@ -1,15 +1,25 @@
 #ifndef EDYN_COLLISION_BROADPHASE_HPP
 #define EDYN_COLLISION_BROADPHASE_HPP
 
+#include <map>
 #include <vector>
+#include <cstdint>
 #include <entt/entity/fwd.hpp>
 #include <entt/signal/sigh.hpp>
 #include "edyn/comp/aabb.hpp"
 #include "edyn/core/entity_pair.hpp"
+#include "edyn/collision/collision_stats.hpp"
 #include "edyn/collision/dynamic_tree.hpp"
+#include "edyn/collision/compact_tree.hpp"
+#include "edyn/collision/sweep_and_prune.hpp"
+#include "edyn/collision/linear_bvh.hpp"
+#include "edyn/config/broadphase_algorithm.hpp"
+#include "edyn/collision/sensor.hpp"
 
 namespace edyn {
 
+struct tree_resident;
+
 class broadphase final {
     // Offset applied to AABBs when querying the trees.
     constexpr static auto m_aabb_offset = vector3_one * -contact_breaking_threshold;
@@ -17,21 +27,46 @@ class broadphase final {
     // Separation threshold for new manifolds.
     constexpr static auto m_separation_threshold = contact_breaking_threshold * scalar(1.3);
 
-    void move_aabbs();
-    void destroy_separated_manifolds();
+    // Minimum number of new AABBs for the new tree leaves to be built in bulk
+    // instead of being inserted one by one.
+    constexpr static size_t bulk_tree_build_threshold = 64;
+
+    // Minimum number of AABBs or manifolds for them to be checked in
+    // parallel for movement or separation.
+    constexpr static size_t parallel_check_threshold = 256;
+
+    template<typename View>
+    void move_leaves(bool mt, const View &view, dynamic_tree &tree);
+    void move_aabbs(bool mt);
+    void update_compact_tree();
+    void destroy_separated_manifolds(bool mt);
+    void update_filter_mode();
+    void update_algorithm();
+    void update_sweep_and_prune();
+    void find_sweep_and_prune_pairs();
+    void update_linear_bvh();
 
-    void collide_tree(const dynamic_tree &tree, entt::entity entity, const AABB &offset_aabb) const;
-    void collide_tree_async(const dynamic_tree &tree, entt::entity entity, const AABB &offset_aabb, size_t result_index);
-    void collide_parallel();
-    void finish_collide();
+    void mark_moved(entt::entity, tree_resident &);
+    // Returns the number of overlaps found in the trees.
+    size_t collect_pairs(entt::entity entity, entity_pair_vector &pairs) const;
+    void collect_pairs_parallel();
+    void sort_pending_pairs();
+    void process_pending_pairs();
+    void update_sensor_pairs();
+    void push_sensor_event(entt::entity sensor, entt::entity other, sensor_event_type);
 
     void on_construct_aabb(entt::registry &, entt::entity);
     void on_destroy_aabb(entt::registry &, entt::entity);
     void on_destroy_tree_resident(entt::registry &, entt::entity);
     void on_construct_island_aabb(entt::registry &, entt::entity);
     void on_destroy_island_tree_resident(entt::registry &, entt::entity);
-
-    void collide_parallel_task(unsigned start, unsigned end);
+    void on_construct_sleeping_tag(entt::registry &, entt::entity);
+    void on_destroy_sleeping_tag(entt::registry &, entt::entity);
+    void move_island_to_tree(entt::entity, bool sleeping);
+    void on_destroy_contact_manifold(entt::registry &, entt::entity);
+    void on_construct_collision_filter(entt::registry &, entt::entity);
+    void on_destroy_collision_filter(entt::registry &, entt::entity);
+    void set_tree_filter(entt::entity, const collision_filter &);
 
 public:
     broadphase(entt::registry &);
@@ -44,27 +79,128 @@ public:
     template<typename Func>
     void raycast(vector3 p0, vector3 p1, Func func) const;
 
+    // Func takes the entity and the bit mask of the lanes of the packet whose
+    // segment intersects its AABB.
+    template<typename Func>
+    void raycast(const ray_packet &packet, Func func) const;
+
     template<typename Func>
     void query_procedural(const AABB &aabb, Func func) const;
 
     template<typename Func>
     void query_non_procedural(const AABB &aabb, Func func) const;
 
+    // Only report entities whose collision filter accepts `filter`.
+    template<typename Func>
+    void query_procedural(const AABB &aabb, const collision_filter &filter, Func func) const;
+
+    template<typename Func>
+    void query_non_procedural(const AABB &aabb, const collision_filter &filter, Func func) const;
+
+    // Awake and sleeping islands are kept in separate trees. Querying all
+    // islands traverses both.
     template<typename Func>
     void query_islands(const AABB &aabb, Func func) const;
 
+    template<typename Func>
+    void query_awake_islands(const AABB &aabb, Func func) const;
+
+    template<typename Func>
+    void query_sleeping_islands(const AABB &aabb, Func func) const;
+
     void clear();
 
     void set_procedural(entt::entity, bool);
 
+    // Moves many entities to the other tree at once. Past
+    // `bulk_tree_build_threshold` their leaves are built into a subtree which
+    // is inserted into the tree in one go.
+    void set_procedural(const std::vector<entt::entity> &, bool);
+
+    /**
+     * @brief Translates the trees along with the AABBs, which must be shifted
+     * by the caller. The compact tree is rebuilt in the next update.
+     * @param offset The new origin in the current coordinates.
+     */
+    void shift_origin(const vector3 &offset);
+
+    const dynamic_tree & procedural_tree() const {
+        return m_tree;
+    }
+
+    // Compact copy of the non-procedural tree, which is rebuilt in the update
+    // after the non-procedural tree changes. Its version is incremented each
+    // time it's rebuilt or cleared.
+    const compact_tree & non_procedural_compact_tree() const {
+        return m_np_compact_tree;
+    }
+
+    uint64_t non_procedural_compact_tree_version() const {
+        return m_np_compact_tree_version;
+    }
+
+    const broadphase_stats & get_stats() const {
+        return m_stats;
+    }
+
+    /**
+     * @brief Memory allocated for the trees, the compact tree and the
+     * buffers of moved entities and pairs.
+     */
+    size_t num_bytes() const;
+
 private:
     entt::registry *m_registry;
     dynamic_tree m_tree; // Procedural dynamic tree.
     dynamic_tree m_np_tree; // Non-procedural dynamic tree.
-    dynamic_tree m_island_tree; // Island AABB tree.
+    // Island AABB trees. Only the awake tree is updated in every step, while
+    // sleeping islands do not move, thus their tree stays untouched until
+    // they wake up.
+    dynamic_tree m_island_tree;
+    dynamic_tree m_sleeping_island_tree;
+    // Compact copy of the non-procedural tree used for queries, which is
+    // rebuilt before collision detection if the non-procedural tree changed.
+    // Queries fall back to the dynamic tree while it is out of date.
+    compact_tree m_np_compact_tree;
+    bool m_np_compact_tree_dirty {false};
+    uint64_t m_np_compact_tree_version {0};
     std::vector<entt::entity> m_new_aabb_entities;
+    // Entities whose inflated AABB changed since the last update, which are
+    // the only ones the trees must be queried for. Also known as the move
+    // buffer.
+    std::vector<entt::entity> m_moved_entities;
+    // Pairs of entities whose inflated AABBs overlap but which do not have a
+    // contact manifold yet, waiting for their AABBs to intersect. The first
+    // entity is always procedural.
+    entity_pair_vector m_pending_pairs;
+    bool m_sort_pending_pairs {false};
+    // Pending pairs whose AABBs started to intersect in the current update,
+    // which get a contact manifold once all pending pairs are processed.
+    entity_pair_vector m_new_manifold_pairs;
     std::vector<entity_pair_vector> m_pair_results;
+    // Buffers of the movement and separation checks, where each flag tells
+    // whether the entity at the same index moved or separated.
+    std::vector<entt::entity> m_check_entities;
+    std::vector<uint8_t> m_check_flags;
+    std::vector<tree_node_id_t> m_moved_leaves;
+    std::vector<AABB> m_moved_leaf_aabbs;
+    std::vector<vector3> m_moved_leaf_displacements;
+    std::vector<aabb_margin> m_moved_leaf_margins;
     size_t m_max_sequential_size {8};
+    // Whether the default collision filtering function is in use, in which
+    // case the collision filters stored in the tree nodes are checked while
+    // querying the trees for pairs and the function is not called.
+    bool m_filter_in_trees {true};
+    // How pairs of procedural entities are found. The procedural tree is
+    // kept up to date for queries and raycasts regardless.
+    broadphase_algorithm m_algorithm {broadphase_algorithm::dynamic_tree};
+    sweep_and_prune m_sap;
+    linear_bvh m_lbvh;
+    // Pairs of a sensor and another entity whose inflated AABBs intersect,
+    // keyed by sensor and other entity, which are tracked here instead of
+    // getting a contact manifold. The value tells whether they overlap.
+    std::map<entity_pair, bool> m_sensor_pairs;
+    broadphase_stats m_stats;
     std::vector<entt::scoped_connection> m_connections;
 };
 
@@ -73,9 +209,29 @@ void broadphase::raycast(vector3 p0, vector3 p1, Func func) const {
     m_tree.raycast(p0, p1, [&](tree_node_id_t id) {
         func(m_tree.get_node(id).entity);
     });
-    m_np_tree.raycast(p0, p1, [&](tree_node_id_t id) {
-        func(m_np_tree.get_node(id).entity);
+
+    if (!m_np_compact_tree_dirty) {
+        m_np_compact_tree.raycast(p0, p1, func);
+    } else {
+        m_np_tree.raycast(p0, p1, [&](tree_node_id_t id) {
+            func(m_np_tree.get_node(id).entity);
+        });
+    }
+}
+
+template<typename Func>
+void broadphase::raycast(const ray_packet &packet, Func func) const {
+    m_tree.raycast(packet, [&](tree_node_id_t id, unsigned mask) {
+        func(m_tree.get_node(id).entity, mask);
     });
+
+    if (!m_np_compact_tree_dirty) {
+        m_np_compact_tree.raycast(packet, func);
+    } else {
+        m_np_tree.raycast(packet, [&](tree_node_id_t id, unsigned mask) {
+            func(m_np_tree.get_node(id).entity, mask);
+        });
+    }
 }
 
 template<typename Func>
@@ -87,18 +243,53 @@ void broadphase::query_procedural(const AABB &aabb, Func func) const {
 
 template<typename Func>
 void broadphase::query_non_procedural(const AABB &aabb, Func func) const {
-    m_np_tree.query(aabb, [&](tree_node_id_t id) {
-        func(m_np_tree.get_node(id).entity);
+    if (!m_np_compact_tree_dirty) {
+        m_np_compact_tree.query(aabb, func);
+    } else {
+        m_np_tree.query(aabb, [&](tree_node_id_t id) {
+            func(m_np_tree.get_node(id).entity);
+        });
+    }
+}
+
+template<typename Func>
+void broadphase::query_procedural(const AABB &aabb, const collision_filter &filter, Func func) const {
+    m_tree.query(aabb, filter, [&](tree_node_id_t id) {
+        func(m_tree.get_node(id).entity);
     });
 }
 
+template<typename Func>
+void broadphase::query_non_procedural(const AABB &aabb, const collision_filter &filter, Func func) const {
+    if (!m_np_compact_tree_dirty) {
+        m_np_compact_tree.query(aabb, filter, func);
+    } else {
+        m_np_tree.query(aabb, filter, [&](tree_node_id_t id) {
+            func(m_np_tree.get_node(id).entity);
+        });
+    }
+}
+
 template<typename Func>
 void broadphase::query_islands(const AABB &aabb, Func func) const {
+    query_awake_islands(aabb, func);
+    query_sleeping_islands(aabb, func);
+}
+
+template<typename Func>
+void broadphase::query_awake_islands(const AABB &aabb, Func func) const {
     m_island_tree.query(aabb, [&](tree_node_id_t id) {
         func(m_island_tree.get_node(id).entity);
     });
 }
 
+template<typename Func>
+void broadphase::query_sleeping_islands(const AABB &aabb, Func func) const {
+    m_sleeping_island_tree.query(aabb, [&](tree_node_id_t id) {
+        func(m_sleeping_island_tree.get_node(id).entity);
+    });
+}
+
 }
 
 #endif // EDYN_COLLISION_BROADPHASE_HPP
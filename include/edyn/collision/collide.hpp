@@ -3,11 +3,16 @@
 
 #include "edyn/shapes/shapes.hpp"
 #include "edyn/collision/collision_result.hpp"
+#include "edyn/collision/separating_axis_cache.hpp"
 #include "edyn/util/aabb_util.hpp"
 #include "edyn/util/tuple_util.hpp"
+#include <algorithm>
+#include <vector>
 
 namespace edyn {
 
+struct compound_pair_cache;
+
 struct collision_context {
     vector3 posA;
     quaternion ornA;
@@ -19,10 +24,19 @@ struct collision_context {
 
     scalar threshold;
 
+    // Separating axis cache of the contact manifold of this pair, used by
+    // collision functions that run a SAT between convex shapes. Can be null.
+    separating_axis_cache *sat_cache {nullptr};
+
+    // Cached results of the pairs of children of the contact manifold of two
+    // compound shapes. Can be null. Not kept by `swapped` since it refers to
+    // the children in the order of A and B.
+    compound_pair_cache *compound_cache {nullptr};
+
     collision_context swapped() const {
         return {posB, ornB, aabbB,
                 posA, ornA, aabbA,
-                threshold};
+                threshold, sat_cache};
     }
 };
 
@@ -130,11 +144,22 @@ void collide(const capsule_shape &shA, const cylinder_shape &shB,
 void collide(const cylinder_shape &shA, const capsule_shape &shB,
              const collision_context &ctx, collision_result &result);
 
+// Triangle Mesh-Triangle Mesh
+void collide(const triangle_mesh &meshA, const triangle_mesh &meshB,
+             const collision_context &ctx, collision_result &result);
+
 // Mesh-Mesh
 inline
 void collide(const mesh_shape &shA, const mesh_shape &shB,
              const collision_context &ctx, collision_result &result) {
-    // collision between triangle meshes still undefined.
+    collide(*shA.trimesh, *shB.trimesh, ctx, result);
+}
+
+// Mesh-Triangle Mesh
+inline
+void collide(const mesh_shape &shA, const triangle_mesh &meshB,
+             const collision_context &ctx, collision_result &result) {
+    collide(*shA.trimesh, meshB, ctx, result);
 }
 
 // Plane-Mesh
@@ -209,11 +234,8 @@ void collide(const paged_mesh_shape &shA, const plane_shape &shB,
 }
 
 // Mesh-Paged Mesh
-inline
 void collide(const mesh_shape &shA, const paged_mesh_shape &shB,
-             const collision_context &ctx, collision_result &result) {
-    // collision between triangle meshes is undefined.
-}
+             const collision_context &ctx, collision_result &result);
 
 // Paged Mesh-Mesh
 inline
@@ -222,6 +244,52 @@ void collide(const paged_mesh_shape &shA, const mesh_shape &shB,
     swap_collide(shA, shB, ctx, result);
 }
 
+// Heightfield-Heightfield
+inline
+void collide(const heightfield_shape &shA, const heightfield_shape &shB,
+             const collision_context &ctx, collision_result &result) {
+    // collision between heightfields is undefined.
+}
+
+// Plane-Heightfield
+inline
+void collide(const plane_shape &shA, const heightfield_shape &shB,
+             const collision_context &ctx, collision_result &result) {
+    // collision between heightfields and planes is undefined.
+}
+
+// Heightfield-Plane
+inline
+void collide(const heightfield_shape &shA, const plane_shape &shB,
+             const collision_context &ctx, collision_result &result) {
+    swap_collide(shA, shB, ctx, result);
+}
+
+// Paged Mesh-Heightfield
+inline
+void collide(const paged_mesh_shape &shA, const heightfield_shape &shB,
+             const collision_context &ctx, collision_result &result) {
+    // collision between paged triangle meshes and heightfields is undefined.
+}
+
+// Heightfield-Paged Mesh
+inline
+void collide(const heightfield_shape &shA, const paged_mesh_shape &shB,
+             const collision_context &ctx, collision_result &result) {
+    swap_collide(shA, shB, ctx, result);
+}
+
+// Mesh-Heightfield
+void collide(const mesh_shape &shA, const heightfield_shape &shB,
+             const collision_context &ctx, collision_result &result);
+
+// Heightfield-Mesh
+inline
+void collide(const heightfield_shape &shA, const mesh_shape &shB,
+             const collision_context &ctx, collision_result &result) {
+    swap_collide(shA, shB, ctx, result);
+}
+
 // Polyhedron-Polyhedron
 void collide(const polyhedron_shape &shA, const polyhedron_shape &shB,
              const collision_context &ctx, collision_result &result);
@@ -282,8 +350,9 @@ void collide(const plane_shape &shA, const compound_shape &shB,
 template<typename T, std::enable_if_t<variant_has_type<T, compound_shape::shapes_variant_t>::value, bool> = true>
 void collide(const compound_shape &shA, const T &shB,
              const collision_context &ctx, collision_result &result) {
-    // Calculate AABB of B's AABB in A's space.
-    auto aabbB_in_A = aabb_to_object_space(ctx.aabbB, ctx.posA, ctx.ornA);
+    // Calculate AABB of B's AABB in A's space, expanded to include the
+    // children of A within the contact threshold.
+    auto aabbB_in_A = aabb_to_object_space(ctx.aabbB, ctx.posA, ctx.ornA).inset(vector3_one * -ctx.threshold);
     // A more precise AABB could be obtained but it would be generally more expensive.
     //auto aabbB_in_A = shape_aabb(shB, posB_in_A, ornB_in_A);
 
@@ -293,6 +362,8 @@ void collide(const compound_shape &shA, const T &shB,
         auto child_ctx = ctx;
         child_ctx.posA = to_world_space(nodeA.position, ctx.posA, ctx.ornA);
         child_ctx.ornA = ctx.ornA * nodeA.orientation;
+        // The cache belongs to the compound pair, not to its children.
+        child_ctx.sat_cache = nullptr;
 
         collision_result child_result;
         collide(sh, shB, child_ctx, child_result);
@@ -338,7 +409,8 @@ void collide(const mesh_shape &shA, const T &shB,
 template<typename T>
 void collide(const T &shA, const paged_mesh_shape &shB,
              const collision_context &ctx, collision_result &result) {
-    // Inset AABB to load nearby submeshes.
+    // Inset AABB to include nearby submeshes. Only submeshes in the cache are
+    // considered. They're loaded ahead of time in `update_paged_meshes`.
     constexpr auto inset = vector3 {
         -contact_breaking_threshold,
         -contact_breaking_threshold,
@@ -346,17 +418,48 @@ void collide(const T &shA, const paged_mesh_shape &shB,
     };
     auto inset_aabb = ctx.aabbA.inset(inset);
 
-    shB.trimesh->visit_submeshes(inset_aabb, [&](size_t mesh_idx) {
+    // Edges on the seam between two submeshes belong to a triangle in each
+    // submesh and would generate the same contact twice. Gather the visited
+    // submeshes first so one of the contacts can be dropped when both
+    // submeshes are visited.
+    auto mesh_indices = std::vector<size_t>{};
+    shB.trimesh->visit_cached_submeshes(inset_aabb, [&](size_t mesh_idx) {
+        mesh_indices.push_back(mesh_idx);
+    });
+
+    auto is_visited = [&](size_t mesh_idx) {
+        return std::find(mesh_indices.begin(), mesh_indices.end(), mesh_idx) != mesh_indices.end();
+    };
+
+    for (auto mesh_idx : mesh_indices) {
         auto trimesh = shB.trimesh->get_submesh(mesh_idx);
+
+        if (!trimesh) {
+            continue;
+        }
+
         collision_result child_result;
         collide(shA, *trimesh, ctx, child_result);
 
         for (size_t i = 0; i < child_result.num_points; ++i) {
             auto &child_point = child_result.point[i];
+
+            // The contact on a seam edge is kept in the submesh with lower
+            // index if both are visited.
+            auto *tri_feature = std::get_if<triangle_feature>(&child_point.featureB->feature);
+
+            if (tri_feature && *tri_feature == triangle_feature::edge) {
+                auto seam_mesh_idx = trimesh->get_edge_seam_submesh_index(child_point.featureB->index);
+
+                if (seam_mesh_idx < mesh_idx && is_visited(seam_mesh_idx)) {
+                    continue;
+                }
+            }
+
             child_point.featureB->part = mesh_idx;
             result.maybe_add_point(child_point);
         }
-    });
+    }
 }
 
 // Paged Mesh-Box/Sphere/Cylinder/Capsule/Polyhedron/Compound
@@ -366,6 +469,50 @@ void collide(const paged_mesh_shape &shA, const T &shB,
     swap_collide(shA, shB, ctx, result);
 }
 
+// Box/Sphere/Cylinder/Capsule/Polyhedron/Compound/Mesh-Heightfield
+template<typename T>
+void collide(const T &shA, const heightfield_shape &shB,
+             const collision_context &ctx, collision_result &result) {
+    // Generate the triangles of the cells under the inset AABB and collide
+    // against them as a triangle mesh.
+    constexpr auto inset = vector3 {
+        -contact_breaking_threshold,
+        -contact_breaking_threshold,
+        -contact_breaking_threshold
+    };
+    auto &hf = *shB.heightfield;
+    auto patch = heightfield_patch{};
+    hf.make_patch(ctx.aabbA.inset(inset), patch);
+
+    if (patch.empty()) {
+        return;
+    }
+
+    collision_result patch_result;
+    collide(shA, patch.trimesh, ctx, patch_result);
+
+    for (size_t i = 0; i < patch_result.num_points; ++i) {
+        auto &patch_point = patch_result.point[i];
+
+        // Assign the feature indices of the heightfield so they do not
+        // depend on the patch.
+        if (patch_point.featureB) {
+            if (auto *tri_feature = std::get_if<triangle_feature>(&patch_point.featureB->feature)) {
+                patch_point.featureB->index = patch.get_heightfield_feature_index(hf, *tri_feature, patch_point.featureB->index);
+            }
+        }
+
+        result.maybe_add_point(patch_point);
+    }
+}
+
+// Heightfield-Box/Sphere/Cylinder/Capsule/Polyhedron/Compound
+template<typename T>
+void collide(const heightfield_shape &shA, const T &shB,
+             const collision_context &ctx, collision_result &result) {
+    swap_collide(shA, shB, ctx, result);
+}
+
 template<typename ShapeAType, typename ShapeBType>
 void swap_collide(const ShapeAType &shA, const ShapeBType &shB,
                   const collision_context &ctx, collision_result &result) {
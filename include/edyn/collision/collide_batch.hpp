@@ -0,0 +1,84 @@
+#ifndef EDYN_COLLISION_COLLIDE_BATCH_HPP
+#define EDYN_COLLISION_COLLIDE_BATCH_HPP
+
+#include <array>
+#include <type_traits>
+#include "edyn/math/simd.hpp"
+#include "edyn/collision/collide.hpp"
+
+namespace edyn {
+
+// Number of pairs of shapes handled by each call to `collide_batch`.
+inline constexpr size_t collide_batch_size = simd_width;
+
+template<typename ShapeType>
+using collide_batch_shapes = std::array<const ShapeType *, collide_batch_size>;
+using collide_batch_contexts = std::array<collision_context, collide_batch_size>;
+using collide_batch_results = std::array<collision_result, collide_batch_size>;
+
+/**
+ * @brief Detects collision between `collide_batch_size` pairs of shapes of
+ * the same types at once, where each pair occupies one SIMD lane. The result
+ * for each pair is the same as calling `collide` for it. The results must be
+ * empty initially.
+ * @param shA First shape of each pair.
+ * @param shB Second shape of each pair.
+ * @param ctx Collision context of each pair.
+ * @param result Collision result of each pair.
+ */
+void collide_batch(const collide_batch_shapes<sphere_shape> &shA,
+                   const collide_batch_shapes<sphere_shape> &shB,
+                   const collide_batch_contexts &ctx, collide_batch_results &result);
+
+void collide_batch(const collide_batch_shapes<sphere_shape> &shA,
+                   const collide_batch_shapes<plane_shape> &shB,
+                   const collide_batch_contexts &ctx, collide_batch_results &result);
+
+void collide_batch(const collide_batch_shapes<capsule_shape> &shA,
+                   const collide_batch_shapes<plane_shape> &shB,
+                   const collide_batch_contexts &ctx, collide_batch_results &result);
+
+// Box-plane is only tested for separation in batches. Pairs which are not
+// separated are handed to the regular `collide` function, since finding the
+// support feature does not map well to SIMD.
+void collide_batch(const collide_batch_shapes<box_shape> &shA,
+                   const collide_batch_shapes<plane_shape> &shB,
+                   const collide_batch_contexts &ctx, collide_batch_results &result);
+
+// Whether `collide_batch` is available for a pair of shape types.
+template<typename ShapeAType, typename ShapeBType>
+struct has_collide_batch : std::false_type {};
+
+template<> struct has_collide_batch<sphere_shape, sphere_shape> : std::true_type {};
+template<> struct has_collide_batch<sphere_shape, plane_shape> : std::true_type {};
+template<> struct has_collide_batch<plane_shape, sphere_shape> : std::true_type {};
+template<> struct has_collide_batch<capsule_shape, plane_shape> : std::true_type {};
+template<> struct has_collide_batch<plane_shape, capsule_shape> : std::true_type {};
+template<> struct has_collide_batch<box_shape, plane_shape> : std::true_type {};
+template<> struct has_collide_batch<plane_shape, box_shape> : std::true_type {};
+
+template<typename ShapeAType, typename ShapeBType>
+inline constexpr bool has_collide_batch_v = has_collide_batch<ShapeAType, ShapeBType>::value;
+
+// Calls `collide_batch` with the shapes swapped and swaps the results, same
+// as `swap_collide`.
+template<typename ShapeBType>
+void collide_batch(const collide_batch_shapes<plane_shape> &shA,
+                   const collide_batch_shapes<ShapeBType> &shB,
+                   const collide_batch_contexts &ctx, collide_batch_results &result) {
+    collide_batch_contexts swapped;
+
+    for (size_t i = 0; i < collide_batch_size; ++i) {
+        swapped[i] = ctx[i].swapped();
+    }
+
+    collide_batch(shB, shA, swapped, result);
+
+    for (auto &res : result) {
+        res.swap();
+    }
+}
+
+}
+
+#endif // EDYN_COLLISION_COLLIDE_BATCH_HPP
@@ -0,0 +1,110 @@
+#ifndef EDYN_COLLISION_COLLISION_STATS_HPP
+#define EDYN_COLLISION_COLLISION_STATS_HPP
+
+#include <array>
+#include <tuple>
+#include <cstddef>
+#include <type_traits>
+#include <entt/entity/fwd.hpp>
+#include "edyn/shapes/shapes.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Work done in the last broadphase update.
+ */
+struct broadphase_stats {
+    // Entities whose inflated AABB changed, which queried the trees.
+    size_t num_moved_entities {0};
+    // Overlaps reported by the tree queries of the moved entities, including
+    // the entity itself and pairs which already have a manifold.
+    size_t num_overlaps {0};
+    // Pending pairs whose AABBs were tested for intersection.
+    size_t num_pending_pairs {0};
+    size_t num_manifolds_created {0};
+    // Manifolds destroyed because the AABBs of their bodies separated.
+    size_t num_manifolds_destroyed {0};
+};
+
+/**
+ * @brief Counts of the collision detection work and of the islands in the
+ * last step, which show where the cost of collision detection comes from,
+ * e.g. to tune the separation threshold of contact manifolds.
+ */
+struct collision_stats {
+    static constexpr size_t num_shapes = std::tuple_size_v<std::decay_t<decltype(shapes_tuple)>>;
+    static constexpr size_t num_shape_pairs = num_shapes * num_shapes;
+    static constexpr size_t num_island_size_buckets = 8;
+
+    broadphase_stats broadphase;
+
+    // Manifolds which went through collision detection, which does not
+    // include manifolds whose bodies did not move relative to each other.
+    size_t num_narrowphase_manifolds {0};
+    // The above by pair of shape types, indexed by
+    // `shape_index_A * num_shapes + shape_index_B`, in the order of
+    // `shapes_tuple`.
+    std::array<size_t, num_shape_pairs> num_narrowphase_manifolds_by_shape {};
+    size_t num_points_created {0};
+    size_t num_points_destroyed {0};
+    // Total number of contact manifolds, including sleeping ones.
+    size_t num_manifolds {0};
+
+    size_t num_awake_islands {0};
+    size_t num_sleeping_islands {0};
+    // Number of awake islands by number of nodes. Bucket `i` counts islands
+    // with `[2^i, 2^(i+1))` nodes and the last bucket counts all larger
+    // islands.
+    std::array<size_t, num_island_size_buckets> island_size_histogram {};
+
+    template<typename ShapeA, typename ShapeB>
+    size_t narrowphase_manifolds() const {
+        constexpr size_t indexA = get_shape_index<ShapeA>();
+        constexpr size_t indexB = get_shape_index<ShapeB>();
+        return num_narrowphase_manifolds_by_shape[indexA * num_shapes + indexB];
+    }
+};
+
+/**
+ * @brief Check whether collision statistics are collected in every step.
+ * @param registry Data source.
+ * @return Whether collision statistics are collected.
+ */
+bool get_collect_collision_stats(const entt::registry &registry);
+
+/**
+ * @brief Enable or disable collecting collision statistics, which can be read
+ * with `get_collision_stats`.
+ * @param registry Data source.
+ * @param enabled Whether to collect collision statistics.
+ */
+void set_collect_collision_stats(entt::registry &registry, bool enabled);
+
+/**
+ * @brief Get the collision statistics of the last step. In asynchronous
+ * mode, they're collected in the simulation worker and sent to the main
+ * registry along with the step update, thus they become available in a
+ * later call to `edyn::update`.
+ * @param registry Data source.
+ * @return Collision statistics.
+ */
+const collision_stats & get_collision_stats(const entt::registry &registry);
+
+}
+
+namespace edyn::internal {
+
+/**
+ * @brief Fills the collision statistics from the broadphase and narrowphase
+ * and from the islands of a registry where the simulation runs.
+ */
+void collect_collision_stats(entt::registry &registry, collision_stats &stats);
+
+/**
+ * @brief Collects the statistics into the registry context if enabled.
+ */
+void update_collision_stats(entt::registry &registry);
+
+}
+
+#endif // EDYN_COLLISION_COLLISION_STATS_HPP
@@ -0,0 +1,280 @@
+#ifndef EDYN_COLLISION_COMPACT_STATIC_TREE_HPP
+#define EDYN_COLLISION_COMPACT_STATIC_TREE_HPP
+
+#include <vector>
+#include <cstdint>
+#include "edyn/config/config.h"
+#include "edyn/comp/aabb.hpp"
+#include "edyn/core/mapped_vector.hpp"
+#include "edyn/math/geom.hpp"
+#include "edyn/collision/static_tree.hpp"
+#include "edyn/collision/compact_tree_node.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Read-only bounding volume hierarchy over a fixed set of objects,
+ * such as the triangles of a `triangle_mesh`, with the same wide nodes and
+ * quantized bounds as `compact_tree`. Leaves hold a range of object ids
+ * instead of a single one, which makes the tree much smaller and shallower
+ * than a `static_tree` with one object per leaf.
+ *
+ * The quantized bounds are always rounded outwards and leaves report all of
+ * their objects, thus queries are conservative, i.e. they report every
+ * object whose AABB satisfies the query and possibly a few more.
+ */
+class compact_static_tree final {
+public:
+    // Range of object ids in a leaf.
+    struct leaf {
+        uint32_t first;
+        uint32_t count;
+    };
+
+    // Largest number of objects per leaf.
+    constexpr static uint32_t max_leaf_size = 8;
+
+    /**
+     * @brief Builds the tree for the given range of AABBs. Object ids are the
+     * indices of the AABBs in the range.
+     * @param aabb_begin Iterator to the first AABB.
+     * @param aabb_end Past-the-end iterator.
+     * @param max_obj_per_leaf Maximum number of objects per leaf, which must
+     * be at most `max_leaf_size`.
+     * @param enqueue_task_wait Optional function used to build the tree in
+     * parallel.
+     */
+    template<typename Iterator>
+    void build(Iterator aabb_begin, Iterator aabb_end, uint32_t max_obj_per_leaf = 4,
+               enqueue_task_wait_t *enqueue_task_wait = nullptr);
+
+    /**
+     * @brief Call `func` for all objects in the leaves that overlap `aabb`.
+     * @param aabb The query AABB.
+     * @param func Function to be called for each object. It takes a single
+     * `uint32_t` parameter, which is the object id.
+     */
+    template<typename Func>
+    void query(const AABB &aabb, Func func) const;
+
+    /**
+     * @brief Call `func` for all objects in the leaves that intersect the
+     * segment [p0, p1].
+     * @param p0 First point in the segment.
+     * @param p1 Second point in the segment.
+     * @param func Function to be called for each object. It takes a single
+     * `uint32_t` parameter, which is the object id.
+     */
+    template<typename Func>
+    void raycast(vector3 p0, vector3 p1, Func func) const;
+
+    /**
+     * @brief Call `func` for all leaves that intersect any segment in the
+     * packet.
+     * @param packet The segments. Lanes clipped or terminated by `func` in
+     * the packet are taken into account for the remaining nodes.
+     * @param func Function to be called for each intersecting leaf. It takes
+     * a `uint32_t` object id and an `unsigned` bit mask of the lanes whose segment
+     * intersects the leaf.
+     */
+    template<typename Func>
+    void raycast(const ray_packet &packet, Func func) const;
+
+    AABB root_aabb() const {
+        EDYN_ASSERT(!m_nodes.empty());
+        return m_root_aabb;
+    }
+
+    bool empty() const {
+        return m_nodes.empty();
+    }
+
+    size_t num_nodes() const {
+        return m_nodes.size();
+    }
+
+    size_t num_leaves() const {
+        return m_leaves.size();
+    }
+
+    void clear();
+
+    template<typename Archive>
+    friend void serialize(Archive &archive, compact_static_tree &tree);
+    friend size_t serialization_sizeof(const compact_static_tree &tree);
+
+private:
+    void collapse(const static_tree &);
+    compact_tree_node_id_t build_node(const static_tree &, uint32_t, const compact_tree_frame &);
+
+    template<typename Func>
+    void visit_leaf(compact_tree_node_id_t child, Func &func) const {
+        auto &lf = m_leaves[child & ~compact_tree_leaf_bit];
+
+        for (auto i = lf.first; i < lf.first + lf.count; ++i) {
+            func(m_ids[i]);
+        }
+    }
+
+    AABB m_root_aabb;
+    mapped_vector<compact_tree_node> m_nodes;
+    mapped_vector<leaf> m_leaves;
+    // Object ids referred to by the leaves.
+    mapped_vector<uint32_t> m_ids;
+};
+
+template<typename Iterator>
+void compact_static_tree::build(Iterator aabb_begin, Iterator aabb_end, uint32_t max_obj_per_leaf,
+                                enqueue_task_wait_t *enqueue_task_wait) {
+    EDYN_ASSERT(max_obj_per_leaf > 0 && max_obj_per_leaf <= max_leaf_size);
+    clear();
+
+    // Build a binary tree first and then collapse it into wide nodes. The
+    // id of its leaves is the index of the range of object ids.
+    auto report_leaf = [&](static_tree::tree_node &node, auto ids_begin, auto ids_end) {
+        node.id = static_cast<uint32_t>(m_leaves.size());
+        auto first = static_cast<uint32_t>(m_ids.size());
+        m_ids.insert(m_ids.end(), ids_begin, ids_end);
+        m_leaves.push_back({first, static_cast<uint32_t>(m_ids.size()) - first});
+    };
+
+    auto tree = static_tree{};
+    tree.build_sah(aabb_begin, aabb_end, report_leaf, max_obj_per_leaf, enqueue_task_wait);
+    collapse(tree);
+}
+
+template<typename Func>
+void compact_static_tree::query(const AABB &aabb, Func func) const {
+    if (m_nodes.empty() || !intersect(m_root_aabb, aabb)) {
+        return;
+    }
+
+    struct entry {
+        compact_tree_node_id_t id;
+        compact_tree_frame f;
+    };
+
+    std::vector<entry> stack;
+    stack.push_back({0, make_compact_tree_frame(m_root_aabb)});
+
+    while (!stack.empty()) {
+        auto [id, f] = stack.back();
+        stack.pop_back();
+
+        auto &node = m_nodes[id];
+        uint16_t qmin[3], qmax[3];
+        compact_tree_quantize(f, aabb, qmin, qmax);
+        auto mask = compact_tree_overlap_mask(node, qmin, qmax);
+
+        for (unsigned k = 0; k < compact_tree_width; ++k) {
+            if (!(mask & (1u << k))) {
+                continue;
+            }
+
+            auto child = node.child[k];
+
+            if (child & compact_tree_leaf_bit) {
+                visit_leaf(child, func);
+            } else {
+                stack.push_back({child, compact_tree_child_frame(f, node, k)});
+            }
+        }
+    }
+}
+
+template<typename Func>
+void compact_static_tree::raycast(vector3 p0, vector3 p1, Func func) const {
+    if (m_nodes.empty() || !intersect_segment_aabb(p0, p1, m_root_aabb.min, m_root_aabb.max)) {
+        return;
+    }
+
+    struct entry {
+        compact_tree_node_id_t id;
+        compact_tree_frame f;
+    };
+
+    std::vector<entry> stack;
+    stack.push_back({0, make_compact_tree_frame(m_root_aabb)});
+
+    while (!stack.empty()) {
+        auto [id, f] = stack.back();
+        stack.pop_back();
+
+        auto &node = m_nodes[id];
+
+        for (unsigned k = 0; k < compact_tree_width; ++k) {
+            auto child = node.child[k];
+
+            if (child == null_compact_tree_node_id) {
+                continue;
+            }
+
+            auto cf = compact_tree_child_frame(f, node, k);
+
+            if (!intersect_segment_aabb(p0, p1, cf.aabb.min, cf.aabb.max)) {
+                continue;
+            }
+
+            if (child & compact_tree_leaf_bit) {
+                visit_leaf(child, func);
+            } else {
+                stack.push_back({child, cf});
+            }
+        }
+    }
+}
+
+template<typename Func>
+void compact_static_tree::raycast(const ray_packet &packet, Func func) const {
+    if (m_nodes.empty() || intersect_ray_packet_aabb(packet, m_root_aabb) == 0) {
+        return;
+    }
+
+    struct entry {
+        compact_tree_node_id_t id;
+        compact_tree_frame f;
+    };
+
+    std::vector<entry> stack;
+    stack.push_back({0, make_compact_tree_frame(m_root_aabb)});
+
+    while (!stack.empty()) {
+        auto [id, f] = stack.back();
+        stack.pop_back();
+
+        auto &node = m_nodes[id];
+
+        for (unsigned k = 0; k < compact_tree_width; ++k) {
+            auto child = node.child[k];
+
+            if (child == null_compact_tree_node_id) {
+                continue;
+            }
+
+            auto cf = compact_tree_child_frame(f, node, k);
+            auto mask = intersect_ray_packet_aabb(packet, cf.aabb);
+
+            if (mask == 0) {
+                continue;
+            }
+
+            if (child & compact_tree_leaf_bit) {
+                auto &lf = m_leaves[child & ~compact_tree_leaf_bit];
+
+                for (auto i = lf.first; i < lf.first + lf.count; ++i) {
+                    func(m_ids[i], mask);
+                }
+
+                if (packet.active_mask() == 0) {
+                    return;
+                }
+            } else {
+                stack.push_back({child, cf});
+            }
+        }
+    }
+}
+
+}
+
+#endif // EDYN_COLLISION_COMPACT_STATIC_TREE_HPP
@@ -0,0 +1,281 @@
+#ifndef EDYN_COLLISION_COMPACT_TREE_HPP
+#define EDYN_COLLISION_COMPACT_TREE_HPP
+
+#include <vector>
+#include <entt/entity/fwd.hpp>
+#include "edyn/comp/aabb.hpp"
+#include "edyn/math/geom.hpp"
+#include "edyn/collision/tree_node.hpp"
+#include "edyn/collision/compact_tree_node.hpp"
+#include "edyn/collision/ray_packet.hpp"
+
+namespace edyn {
+
+class dynamic_tree;
+
+/**
+ * @brief Read-only bounding volume hierarchy built by collapsing the binary
+ * nodes of a `dynamic_tree` into wide nodes with quantized child bounds. It
+ * touches far less memory per query than the dynamic tree, which makes it
+ * suitable for large sets of AABBs that rarely change, such as static
+ * geometry. It must be rebuilt after the source tree changes.
+ *
+ * The quantized bounds are always rounded outwards thus queries are
+ * conservative, i.e. they report every leaf the source tree would report
+ * and possibly a few more which are within one quantization step.
+ */
+class compact_tree final {
+    compact_tree_node_id_t build_node(const dynamic_tree &, tree_node_id_t, const compact_tree_frame &);
+
+    template<bool Filtered, typename Func>
+    void query_impl(const AABB &aabb, const collision_filter &filter, Func func) const;
+
+public:
+    /**
+     * @brief Rebuilds this tree from all leaves of the given dynamic tree.
+     * @param tree The source tree.
+     */
+    void build(const dynamic_tree &);
+
+    /**
+     * @brief Call `func` for all leaves that overlap `aabb`.
+     * @param aabb The query AABB.
+     * @param func Function to be called for each overlapping leaf. It takes a
+     * single `entt::entity` parameter.
+     */
+    template<typename Func>
+    void query(const AABB &aabb, Func func) const {
+        query_impl<false>(aabb, {}, func);
+    }
+
+    /**
+     * @brief Call `func` for all leaves that overlap `aabb` and whose
+     * collision filter accepts `filter`. Nodes whose union of filters does
+     * not accept it are not visited.
+     * @param aabb The query AABB.
+     * @param filter The collision filter of the query.
+     * @param func Function to be called for each overlapping leaf. It takes a
+     * single `entt::entity` parameter.
+     */
+    template<typename Func>
+    void query(const AABB &aabb, const collision_filter &filter, Func func) const {
+        query_impl<true>(aabb, filter, func);
+    }
+
+    /**
+     * @brief Call `func` for all leaves that intersect the segment [p0, p1].
+     * @param p0 First point in the segment.
+     * @param p1 Second point in the segment.
+     * @param func Function to be called for each intersecting leaf. It takes
+     * a single `entt::entity` parameter.
+     */
+    template<typename Func>
+    void raycast(vector3 p0, vector3 p1, Func func) const;
+
+    /**
+     * @brief Call `func` for all leaves that intersect any segment in the
+     * packet.
+     * @param packet The segments. Lanes clipped or terminated by `func` in
+     * the packet are taken into account for the remaining nodes.
+     * @param func Function to be called for each intersecting leaf. It takes
+     * an `entt::entity` and an `unsigned` bit mask of the lanes whose segment
+     * intersects the leaf.
+     */
+    template<typename Func>
+    void raycast(const ray_packet &packet, Func func) const;
+
+    /**
+     * @brief Replaces the entity of each leaf by the one returned by `func`,
+     * e.g. to map them into another registry. Queries report the new ones.
+     * @param func Function that takes an `entt::entity` and returns the
+     * entity to be stored in its place.
+     */
+    template<typename Func>
+    void remap_leaves(Func func) {
+        for (auto &entity : m_leaves) {
+            entity = func(entity);
+        }
+    }
+
+    bool empty() const {
+        return m_nodes.empty();
+    }
+
+    size_t num_nodes() const {
+        return m_nodes.size();
+    }
+
+    size_t num_leaves() const {
+        return m_leaves.size();
+    }
+
+    void clear();
+
+    size_t num_bytes() const {
+        return m_nodes.capacity() * sizeof(compact_tree_node) +
+               m_node_filters.capacity() * sizeof(collision_filter) +
+               m_leaves.capacity() * sizeof(entt::entity) +
+               m_leaf_filters.capacity() * sizeof(collision_filter);
+    }
+
+private:
+    AABB m_root_aabb;
+    std::vector<compact_tree_node> m_nodes;
+    // Union of the filters of the leaves under each node, kept apart so the
+    // nodes still fit in a cache line.
+    std::vector<collision_filter> m_node_filters;
+    std::vector<entt::entity> m_leaves;
+    std::vector<collision_filter> m_leaf_filters;
+};
+
+template<bool Filtered, typename Func>
+void compact_tree::query_impl(const AABB &aabb, [[maybe_unused]] const collision_filter &filter, Func func) const {
+    if (m_nodes.empty() || !intersect(m_root_aabb, aabb)) {
+        return;
+    }
+
+    if constexpr(Filtered) {
+        if (!collision_filter_test(m_node_filters[0], filter)) {
+            return;
+        }
+    }
+
+    struct entry {
+        compact_tree_node_id_t id;
+        compact_tree_frame f;
+    };
+
+    std::vector<entry> stack;
+    stack.push_back({0, make_compact_tree_frame(m_root_aabb)});
+
+    while (!stack.empty()) {
+        auto [id, f] = stack.back();
+        stack.pop_back();
+
+        auto &node = m_nodes[id];
+        uint16_t qmin[3], qmax[3];
+        compact_tree_quantize(f, aabb, qmin, qmax);
+        auto mask = compact_tree_overlap_mask(node, qmin, qmax);
+
+        for (unsigned k = 0; k < compact_tree_width; ++k) {
+            if (!(mask & (1u << k))) {
+                continue;
+            }
+
+            auto child = node.child[k];
+
+            if (child & compact_tree_leaf_bit) {
+                auto leaf = child & ~compact_tree_leaf_bit;
+
+                if constexpr(Filtered) {
+                    if (!collision_filter_test(m_leaf_filters[leaf], filter)) {
+                        continue;
+                    }
+                }
+
+                func(m_leaves[leaf]);
+            } else {
+                if constexpr(Filtered) {
+                    if (!collision_filter_test(m_node_filters[child], filter)) {
+                        continue;
+                    }
+                }
+
+                stack.push_back({child, compact_tree_child_frame(f, node, k)});
+            }
+        }
+    }
+}
+
+template<typename Func>
+void compact_tree::raycast(vector3 p0, vector3 p1, Func func) const {
+    if (m_nodes.empty() || !intersect_segment_aabb(p0, p1, m_root_aabb.min, m_root_aabb.max)) {
+        return;
+    }
+
+    struct entry {
+        compact_tree_node_id_t id;
+        compact_tree_frame f;
+    };
+
+    std::vector<entry> stack;
+    stack.push_back({0, make_compact_tree_frame(m_root_aabb)});
+
+    while (!stack.empty()) {
+        auto [id, f] = stack.back();
+        stack.pop_back();
+
+        auto &node = m_nodes[id];
+
+        for (unsigned k = 0; k < compact_tree_width; ++k) {
+            auto child = node.child[k];
+
+            if (child == null_compact_tree_node_id) {
+                continue;
+            }
+
+            auto cf = compact_tree_child_frame(f, node, k);
+
+            if (!intersect_segment_aabb(p0, p1, cf.aabb.min, cf.aabb.max)) {
+                continue;
+            }
+
+            if (child & compact_tree_leaf_bit) {
+                func(m_leaves[child & ~compact_tree_leaf_bit]);
+            } else {
+                stack.push_back({child, cf});
+            }
+        }
+    }
+}
+
+template<typename Func>
+void compact_tree::raycast(const ray_packet &packet, Func func) const {
+    if (m_nodes.empty() || intersect_ray_packet_aabb(packet, m_root_aabb) == 0) {
+        return;
+    }
+
+    struct entry {
+        compact_tree_node_id_t id;
+        compact_tree_frame f;
+    };
+
+    std::vector<entry> stack;
+    stack.push_back({0, make_compact_tree_frame(m_root_aabb)});
+
+    while (!stack.empty()) {
+        auto [id, f] = stack.back();
+        stack.pop_back();
+
+        auto &node = m_nodes[id];
+
+        for (unsigned k = 0; k < compact_tree_width; ++k) {
+            auto child = node.child[k];
+
+            if (child == null_compact_tree_node_id) {
+                continue;
+            }
+
+            auto cf = compact_tree_child_frame(f, node, k);
+            auto mask = intersect_ray_packet_aabb(packet, cf.aabb);
+
+            if (mask == 0) {
+                continue;
+            }
+
+            if (child & compact_tree_leaf_bit) {
+                func(m_leaves[child & ~compact_tree_leaf_bit], mask);
+
+                if (packet.active_mask() == 0) {
+                    return;
+                }
+            } else {
+                stack.push_back({child, cf});
+            }
+        }
+    }
+}
+
+}
+
+#endif // EDYN_COLLISION_COMPACT_TREE_HPP
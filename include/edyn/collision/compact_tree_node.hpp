@@ -0,0 +1,228 @@
+#ifndef EDYN_COLLISION_COMPACT_TREE_NODE_HPP
+#define EDYN_COLLISION_COMPACT_TREE_NODE_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include "edyn/comp/aabb.hpp"
+#include "edyn/math/vector3.hpp"
+
+namespace edyn {
+
+using compact_tree_node_id_t = uint32_t;
+constexpr static compact_tree_node_id_t null_compact_tree_node_id = std::numeric_limits<compact_tree_node_id_t>::max();
+
+// Children with this bit set refer to an entry in the leaf array instead of
+// another node.
+constexpr static compact_tree_node_id_t compact_tree_leaf_bit = compact_tree_node_id_t(1) << 31;
+
+// Maximum number of children per node.
+constexpr static unsigned compact_tree_width = 4;
+
+// Largest quantized coordinate, which maps to the max of the parent bounds.
+constexpr static uint16_t compact_tree_quantized_max = std::numeric_limits<uint16_t>::max();
+
+/**
+ * A node with up to `compact_tree_width` children whose bounds are quantized
+ * to 16 bits relative to the bounds of the node itself, which are in turn
+ * stored in its parent. Bounds are laid out as a structure of arrays so that
+ * all children can be tested at once. Fits in a single cache line.
+ */
+struct alignas(64) compact_tree_node {
+    uint16_t min_x[compact_tree_width];
+    uint16_t min_y[compact_tree_width];
+    uint16_t min_z[compact_tree_width];
+    uint16_t max_x[compact_tree_width];
+    uint16_t max_y[compact_tree_width];
+    uint16_t max_z[compact_tree_width];
+
+    // Index of a child node or, if `compact_tree_leaf_bit` is set, of a leaf.
+    // Unused slots are `null_compact_tree_node_id`.
+    compact_tree_node_id_t child[compact_tree_width];
+};
+
+static_assert(sizeof(compact_tree_node) == 64);
+
+/**
+ * @brief Collapses the binary subtree under a node of a binary tree, such as
+ * `dynamic_tree` or `static_tree`, by repeatedly replacing the internal node
+ * with the largest area by its two children until there are
+ * `compact_tree_width` nodes or only leaves remain.
+ * @param tree The binary tree.
+ * @param id Id of an internal node in the binary tree.
+ * @param children Array where the ids of the collapsed children are written.
+ * @return Number of children.
+ */
+template<typename Tree, typename NodeIdType>
+unsigned collapse_binary_tree_node(const Tree &tree, NodeIdType id, NodeIdType children[compact_tree_width]) {
+    auto &source = tree.get_node(id);
+    children[0] = source.child1;
+    children[1] = source.child2;
+    unsigned count = 2;
+
+    while (count < compact_tree_width) {
+        auto best = compact_tree_width;
+        auto best_area = scalar(-1);
+
+        for (unsigned k = 0; k < count; ++k) {
+            auto &node = tree.get_node(children[k]);
+
+            if (!node.leaf() && node.aabb.area() > best_area) {
+                best = k;
+                best_area = node.aabb.area();
+            }
+        }
+
+        if (best == compact_tree_width) {
+            break;
+        }
+
+        auto &node = tree.get_node(children[best]);
+        children[best] = node.child1;
+        children[count++] = node.child2;
+    }
+
+    return count;
+}
+
+/**
+ * Bounds of a compact tree node in world space and the factors to convert
+ * between world space and the quantized space of its children.
+ */
+struct compact_tree_frame {
+    AABB aabb;
+    vector3 scale;
+    vector3 inv_scale;
+};
+
+inline scalar compact_tree_dequantize_min(uint16_t q, scalar origin, scalar inv_scale) {
+    return origin + scalar(q) * inv_scale;
+}
+
+inline scalar compact_tree_dequantize_max(uint16_t q, scalar origin, scalar limit, scalar inv_scale) {
+    // Map the largest value exactly to the limit to prevent rounding errors
+    // from shrinking the bounds.
+    return q == compact_tree_quantized_max ? limit : origin + scalar(q) * inv_scale;
+}
+
+inline uint16_t compact_tree_quantize_min(scalar v, scalar origin, scalar scale, scalar inv_scale) {
+    auto q = std::clamp(std::floor((v - origin) * scale), scalar(0), scalar(compact_tree_quantized_max));
+    auto result = static_cast<uint16_t>(q);
+
+    // Grow outwards until the dequantized value contains the original value,
+    // which might not be the case due to rounding errors.
+    while (result > 0 && compact_tree_dequantize_min(result, origin, inv_scale) > v) {
+        --result;
+    }
+
+    return result;
+}
+
+inline uint16_t compact_tree_quantize_max(scalar v, scalar origin, scalar limit, scalar scale, scalar inv_scale) {
+    auto q = std::clamp(std::ceil((v - origin) * scale), scalar(0), scalar(compact_tree_quantized_max));
+    auto result = static_cast<uint16_t>(q);
+
+    while (result < compact_tree_quantized_max && compact_tree_dequantize_max(result, origin, limit, inv_scale) < v) {
+        ++result;
+    }
+
+    return result;
+}
+
+inline compact_tree_frame make_compact_tree_frame(const AABB &aabb) {
+    compact_tree_frame f;
+    f.aabb = aabb;
+
+    for (size_t i = 0; i < 3; ++i) {
+        auto extent = aabb.max[i] - aabb.min[i];
+
+        if (extent > 0) {
+            f.scale[i] = scalar(compact_tree_quantized_max) / extent;
+            f.inv_scale[i] = extent / scalar(compact_tree_quantized_max);
+        } else {
+            f.scale[i] = f.inv_scale[i] = 0;
+        }
+    }
+
+    return f;
+}
+
+inline compact_tree_frame compact_tree_child_frame(const compact_tree_frame &parent,
+                                                   const compact_tree_node &node, unsigned k) {
+    const uint16_t *qmin[] = {node.min_x, node.min_y, node.min_z};
+    const uint16_t *qmax[] = {node.max_x, node.max_y, node.max_z};
+    AABB aabb;
+
+    for (size_t i = 0; i < 3; ++i) {
+        aabb.min[i] = compact_tree_dequantize_min(qmin[i][k], parent.aabb.min[i], parent.inv_scale[i]);
+        aabb.max[i] = compact_tree_dequantize_max(qmax[i][k], parent.aabb.min[i], parent.aabb.max[i], parent.inv_scale[i]);
+    }
+
+    return make_compact_tree_frame(aabb);
+}
+
+/**
+ * @brief Quantizes a query AABB into the space of the children of the node
+ * with the given frame. Values outside of the frame are clamped.
+ */
+inline void compact_tree_quantize(const compact_tree_frame &f, const AABB &aabb, uint16_t qmin[3], uint16_t qmax[3]) {
+    constexpr auto limit = scalar(compact_tree_quantized_max);
+
+    for (size_t i = 0; i < 3; ++i) {
+        auto lo = std::floor((aabb.min[i] - f.aabb.min[i]) * f.scale[i]);
+        auto hi = std::ceil((aabb.max[i] - f.aabb.min[i]) * f.scale[i]);
+        qmin[i] = lo <= 0 ? uint16_t(0) : lo >= limit ? compact_tree_quantized_max : uint16_t(lo);
+        qmax[i] = hi <= 0 ? uint16_t(0) : hi >= limit ? compact_tree_quantized_max : uint16_t(hi);
+    }
+}
+
+/**
+ * @brief Stores the bounds of the k-th child of a node rounded outwards so
+ * that they always contain the given AABB once dequantized.
+ */
+inline void set_compact_tree_child_bounds(compact_tree_node &node, unsigned k,
+                                          const compact_tree_frame &f, const AABB &aabb) {
+    uint16_t *qmin[] = {node.min_x, node.min_y, node.min_z};
+    uint16_t *qmax[] = {node.max_x, node.max_y, node.max_z};
+
+    for (size_t i = 0; i < 3; ++i) {
+        qmin[i][k] = compact_tree_quantize_min(aabb.min[i], f.aabb.min[i], f.scale[i], f.inv_scale[i]);
+        qmax[i][k] = compact_tree_quantize_max(aabb.max[i], f.aabb.min[i], f.aabb.max[i], f.scale[i], f.inv_scale[i]);
+    }
+}
+
+/**
+ * @brief Marks the k-th child of a node as unused and gives it empty bounds.
+ */
+inline void clear_compact_tree_child(compact_tree_node &node, unsigned k) {
+    node.min_x[k] = node.min_y[k] = node.min_z[k] = compact_tree_quantized_max;
+    node.max_x[k] = node.max_y[k] = node.max_z[k] = 0;
+    node.child[k] = null_compact_tree_node_id;
+}
+
+/**
+ * @brief Tests all children of a node against quantized query bounds.
+ * @return Bit mask where the k-th bit is set if the k-th child is in use and
+ * its bounds overlap the query bounds.
+ */
+inline unsigned compact_tree_overlap_mask(const compact_tree_node &node,
+                                          const uint16_t qmin[3], const uint16_t qmax[3]) {
+    // This loop is branchless so that it is turned into a few vector
+    // instructions.
+    unsigned mask = 0;
+
+    for (unsigned k = 0; k < compact_tree_width; ++k) {
+        auto hit = (node.child[k] != null_compact_tree_node_id) &
+                   (node.min_x[k] <= qmax[0]) & (node.max_x[k] >= qmin[0]) &
+                   (node.min_y[k] <= qmax[1]) & (node.max_y[k] >= qmin[1]) &
+                   (node.min_z[k] <= qmax[2]) & (node.max_z[k] >= qmin[2]);
+        mask |= unsigned(hit) << k;
+    }
+
+    return mask;
+}
+
+}
+
+#endif // EDYN_COLLISION_COMPACT_TREE_NODE_HPP
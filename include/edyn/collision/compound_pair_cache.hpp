@@ -0,0 +1,82 @@
+#ifndef EDYN_COLLISION_COMPOUND_PAIR_CACHE_HPP
+#define EDYN_COLLISION_COMPOUND_PAIR_CACHE_HPP
+
+#include <cmath>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "edyn/math/vector3.hpp"
+#include "edyn/math/quaternion.hpp"
+#include "edyn/config/constants.hpp"
+#include "edyn/collision/collision_result.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Results of the collisions between the pairs of children of two
+ * compound shapes which were near each other in the last collision detection
+ * of a contact manifold, with the relative transform of the children at the
+ * time. A pair whose relative transform stays within
+ * `compound_pair_cache_position_tolerance` and
+ * `compound_pair_cache_orientation_tolerance` of it reuses its points instead
+ * of being collided again, including pairs which had no points. Assigned by
+ * the narrowphase to manifolds between compound shapes. It is transient thus
+ * it is not serialized nor shared between registries.
+ */
+struct compound_pair_cache {
+    struct entry {
+        uint32_t nodeA;
+        uint32_t nodeB;
+        // Position and orientation of child B in the space of child A.
+        vector3 posB;
+        quaternion ornB;
+        // Range of the points of this pair in `points`.
+        uint32_t first_point;
+        uint32_t num_points;
+
+        // Whether the given relative transform is close enough to the one
+        // stored for the points to be reused.
+        bool transform_matches(const vector3 &pos, const quaternion &orn) const {
+            constexpr auto pos_tolerance_sqr = compound_pair_cache_position_tolerance *
+                                               compound_pair_cache_position_tolerance;
+            return length_sqr(pos - posB) < pos_tolerance_sqr &&
+                   std::abs(dot(orn, ornB)) > scalar(1) - compound_pair_cache_orientation_tolerance;
+        }
+    };
+
+    // Sorted by node of A and then by node of B.
+    std::vector<entry> entries;
+    // Points of all entries, with pivots in the object space of each compound
+    // and normals in the object space of A.
+    std::vector<collision_result::collision_point> points;
+    // Number of children of each compound when the entries were made. The
+    // cache is cleared if they change.
+    size_t num_nodesA {0};
+    size_t num_nodesB {0};
+
+    // Entries and points made in the current collision detection, which then
+    // replace the ones above. Kept to avoid allocations.
+    std::vector<entry> next_entries;
+    std::vector<collision_result::collision_point> next_points;
+
+    const entry * find(uint32_t nodeA, uint32_t nodeB) const {
+        auto it = std::lower_bound(entries.begin(), entries.end(), nodeA, [&](const entry &e, uint32_t a) {
+            return e.nodeA < a || (e.nodeA == a && e.nodeB < nodeB);
+        });
+
+        if (it != entries.end() && it->nodeA == nodeA && it->nodeB == nodeB) {
+            return &*it;
+        }
+
+        return nullptr;
+    }
+
+    void clear() {
+        entries.clear();
+        points.clear();
+    }
+};
+
+}
+
+#endif // EDYN_COLLISION_COMPOUND_PAIR_CACHE_HPP
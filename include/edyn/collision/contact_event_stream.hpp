@@ -0,0 +1,115 @@
+#ifndef EDYN_COLLISION_CONTACT_EVENT_STREAM_HPP
+#define EDYN_COLLISION_CONTACT_EVENT_STREAM_HPP
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <unordered_set>
+#include <entt/entity/fwd.hpp>
+#include <entt/entity/entity.hpp>
+#include <entt/signal/sigh.hpp>
+#include "edyn/math/vector3.hpp"
+
+namespace edyn {
+
+struct contact_manifold;
+
+enum class contact_event_type : uint8_t {
+    started,
+    ended
+};
+
+/**
+ * @brief A contact which started or ended in a step.
+ */
+struct contact_event {
+    // The rigid bodies in contact, in the same order as in the manifold.
+    std::array<entt::entity, 2> body {entt::null, entt::null};
+    contact_event_type type;
+    // Total normal impulse applied on all points in the step the contact
+    // started, including restitution. Zero for ended contacts.
+    scalar impulse {0};
+    // Point where the largest impulse was applied, on the surface of the
+    // second body, in world space. Only set for started contacts.
+    vector3 point {vector3_zero};
+    // Normal at that point, pointing towards the first body.
+    vector3 normal {vector3_zero};
+};
+
+/**
+ * @brief Contact events of all steps of the last update, in a single array
+ * which is read with `get_contact_events`.
+ */
+struct contact_event_buffer {
+    std::vector<contact_event> events;
+};
+
+/**
+ * @brief Fills the `contact_event_buffer` of the registry where the
+ * simulation runs after each step, if enabled in the settings. It does the
+ * same as the `contact_event_emitter` but instead of publishing a signal for
+ * each event, the events are appended to an array which is consumed at once,
+ * and they're filtered by impulse and by tag before they get there.
+ */
+class contact_event_stream {
+public:
+    contact_event_stream(entt::registry &);
+
+    void update();
+
+    void on_destroy_contact_manifold(entt::registry &, entt::entity);
+
+private:
+    bool should_report(const contact_manifold &, scalar impulse) const;
+
+    entt::registry *m_registry;
+    // Manifolds whose start was reported, thus their end must be too.
+    std::unordered_set<entt::entity> m_reported;
+    // Ends of reported contacts whose manifold was destroyed, which could
+    // happen outside of a step, thus they're added to the buffer in the
+    // next update.
+    std::vector<contact_event> m_destroyed;
+    std::vector<entt::scoped_connection> m_connections;
+};
+
+/**
+ * @brief Check whether contact events are streamed into the contact event
+ * buffer.
+ * @param registry Data source.
+ * @return Whether contact events are streamed.
+ */
+bool get_stream_contact_events(const entt::registry &registry);
+
+/**
+ * @brief Enable or disable the contact event stream, which can be read with
+ * `get_contact_events`. The contact signals are not affected.
+ * @param registry Data source.
+ * @param enabled Whether to stream contact events.
+ */
+void set_stream_contact_events(entt::registry &registry, bool enabled);
+
+/**
+ * @brief Set which contacts are reported in the contact event stream. The
+ * filter is applied where the simulation runs thus events which do not pass
+ * it are never sent to the main registry in asynchronous mode.
+ * @param registry Data source.
+ * @param min_impulse Contacts which start with a smaller total normal impulse
+ * are not reported, and neither is their end.
+ * @param require_tag Only report contacts where one of the rigid bodies has a
+ * `contact_event_tag`.
+ */
+void set_contact_event_filter(entt::registry &registry, scalar min_impulse, bool require_tag);
+
+/**
+ * @brief Get the contact events of all steps of the last call to
+ * `edyn::update`, in the order they happened. In asynchronous mode, they're
+ * sent to the main registry with the step updates and events involving
+ * entities that no longer exist are dropped.
+ * @param registry Data source.
+ * @return Contact events.
+ */
+const std::vector<contact_event> & get_contact_events(const entt::registry &registry);
+
+}
+
+#endif // EDYN_COLLISION_CONTACT_EVENT_STREAM_HPP
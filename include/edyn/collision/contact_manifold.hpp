@@ -3,14 +3,23 @@
 
 #include <array>
 #include <limits>
+#include <type_traits>
 #include <entt/entity/fwd.hpp>
 #include <entt/entity/entity.hpp>
 #include "edyn/config/config.h"
 #include "edyn/config/constants.hpp"
 #include "edyn/collision/contact_point.hpp"
+#include "edyn/collision/separating_axis_cache.hpp"
 
 namespace edyn {
 
+struct contact_manifold_transform_cache {
+    vector3 posB; // Position of B in A's space.
+    quaternion ornB; // Orientation of B in A's space.
+    quaternion ornA; // Orientation of A when the contact normals were last updated.
+    bool valid {false};
+};
+
 struct contact_manifold {
     using contact_id_type = unsigned;
     static constexpr auto invalid_id = std::numeric_limits<contact_id_type>::max();
@@ -34,6 +43,20 @@ struct contact_manifold {
     // the `ids` array.
     std::array<contact_point, max_contacts> point;
 
+    // Material properties, restitution impulses and features of the contact
+    // points, at the same indices as in the `point` array.
+    std::array<contact_point_cold, max_contacts> cold;
+
+    // Separating axis found in the last collision detection between convex
+    // shapes. It is transient thus it is not serialized.
+    separating_axis_cache sat_cache;
+
+    // Transform of B relative to A in the last collision detection. While
+    // the bodies stay within `settings::contact_reuse_linear_tolerance` and
+    // `settings::contact_reuse_angular_tolerance` of it, collision detection
+    // is skipped and the current points are kept. Also transient.
+    contact_manifold_transform_cache transform_cache;
+
     /**
      * @brief Get a contact point by index.
      * @param index Contact point index.
@@ -49,17 +72,52 @@ struct contact_manifold {
         return const_cast<contact_point &>(std::as_const(*this).get_point(index));
     }
 
+    /**
+     * @brief Get the cold data of a contact point by index.
+     * @param index Contact point index.
+     * @return Cold data of the contact point with id at the given index.
+     */
+    auto & get_cold(unsigned index) const {
+        EDYN_ASSERT(index < num_points);
+        return cold[ids[index]];
+    }
+
+    /*! @copydoc get_cold */
+    auto & get_cold(unsigned index) {
+        return const_cast<contact_point_cold &>(std::as_const(*this).get_cold(index));
+    }
+
+    /**
+     * @brief Invokes a function for each contact point. If the function also
+     * takes a `contact_point_cold`, it gets the cold data of the point as
+     * well.
+     * @param func Function with signature `void(contact_point &)` or
+     * `void(contact_point &, contact_point_cold &)`.
+     */
     template<typename Func>
     void each_point(Func func) {
         for (auto i = num_points; i; --i) {
-            func(point[ids[i-1]]);
+            auto id = ids[i-1];
+
+            if constexpr(std::is_invocable_v<Func, contact_point &, contact_point_cold &>) {
+                func(point[id], cold[id]);
+            } else {
+                func(point[id]);
+            }
         }
     }
 
+    /*! @copydoc each_point */
     template<typename Func>
     void each_point(Func func) const {
         for (auto i = num_points; i; --i) {
-            func(point[ids[i-1]]);
+            auto id = ids[i-1];
+
+            if constexpr(std::is_invocable_v<Func, const contact_point &, const contact_point_cold &>) {
+                func(point[id], cold[id]);
+            } else {
+                func(point[id]);
+            }
         }
     }
 };
@@ -79,8 +137,8 @@ void serialize(Archive &archive, contact_manifold &manifold) {
         archive(manifold.ids[i]);
     }
 
-    manifold.each_point([&](contact_point &cp) {
-        archive(cp);
+    manifold.each_point([&](contact_point &cp, contact_point_cold &cold) {
+        archive(cp, cold);
     });
 }
 
@@ -1,16 +1,24 @@
 #ifndef EDYN_COLLISION_CONTACT_MANIFOLD_MAP
 #define EDYN_COLLISION_CONTACT_MANIFOLD_MAP
 
-#include <map>
+#include <vector>
+#include <cstdint>
 #include <utility>
 #include <entt/entity/fwd.hpp>
 #include <entt/signal/sigh.hpp>
+#include "edyn/config/memory_resource.hpp"
 #include "edyn/core/entity_pair.hpp"
 
 namespace edyn {
 
 /**
  * @brief Maps a pair of entities to their contact manifold.
+ *
+ * Uses an open-addressing hash table with linear probing keyed by the pair
+ * packed into a single integer, where the order of the entities in the pair
+ * does not matter. All const member functions only read memory thus they can
+ * be called from multiple threads at once without locking, as long as no
+ * contact manifold is created or destroyed meanwhile.
  */
 class contact_manifold_map {
 public:
@@ -40,13 +48,42 @@ public:
     /*! @copydoc get */
     entt::entity get(entt::entity, entt::entity) const;
 
+    /**
+     * @brief Allocates space for at least the given number of manifolds so
+     * that no rehashing happens until there are more manifolds than that.
+     * The table also grows automatically, doubling in size when more than
+     * half full.
+     * @param num_manifolds Number of manifolds.
+     */
+    void reserve(size_t num_manifolds);
+
+    /**
+     * @brief Gets the number of manifolds in the map.
+     * @return Number of manifolds.
+     */
+    size_t size() const {
+        return m_size;
+    }
+
     void on_construct_contact_manifold(entt::registry &, entt::entity);
     void on_destroy_contact_manifold(entt::registry &, entt::entity);
 
     void clear();
 
 private:
-    std::map<entity_pair, entt::entity> m_pair_map;
+    struct slot {
+        uint64_t key;
+        entt::entity manifold;
+    };
+
+    size_t find(uint64_t key) const;
+    void insert(uint64_t key, entt::entity manifold);
+    void erase(uint64_t key);
+    void rehash(size_t capacity);
+
+    // Number of slots is zero or a power of two.
+    resource_vector<slot> m_slots;
+    size_t m_size {0};
     std::vector<entt::scoped_connection> m_connections;
 };
 
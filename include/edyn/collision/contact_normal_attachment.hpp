@@ -21,7 +21,7 @@ enum class contact_normal_attachment : unsigned char {
 
 template<typename Archive>
 void serialize(Archive &archive, contact_normal_attachment &attachment) {
-    serialize_enum(archive, attachment);
+    serialize_bits(archive, attachment, 2);
 }
 
 }
@@ -13,26 +13,40 @@
 
 namespace edyn {
 
+/**
+ * @brief The part of a contact point which is read and written in every step
+ * by collision detection and by the solver. The rest is kept apart in a
+ * `contact_point_cold` so that iterating over the points of a manifold
+ * touches fewer cache lines.
+ */
 struct contact_point {
     vector3 pivotA; // A's pivot in object space.
     vector3 pivotB; // B's pivot in object space.
     vector3 normal; // Normal in world space.
+    scalar distance; // Signed distance along normal.
+    scalar normal_impulse; // Applied normal impulse.
+    std::array<scalar, 2> friction_impulse; // Applied tangential friction impulse.
+    scalar spin_friction_impulse; // Applied spin friction impulse.
+    std::array<scalar, 2> rolling_friction_impulse; // Applied rolling friction impulse.
     vector3 local_normal; // Normal in object space.
     contact_normal_attachment normal_attachment; // To which body the normal is attached.
+    uint32_t lifetime {0}; // Incremented in each simulation step where the contact is persisted.
+};
+
+/**
+ * @brief The part of a contact point which is assigned when the point is
+ * created or merged and is only read while preparing the constraints and by
+ * the restitution solver.
+ */
+struct contact_point_cold {
     scalar friction; // Combined friction coefficient.
     scalar spin_friction; // Combined spin friction coefficient.
     scalar roll_friction; // Combined rolling friction coefficient.
     scalar restitution; // Combined coefficient of restitution.
     scalar stiffness {large_scalar};
     scalar damping {large_scalar};
-    uint32_t lifetime {0}; // Incremented in each simulation step where the contact is persisted.
-    scalar distance; // Signed distance along normal.
     std::optional<collision_feature> featureA; // Closest feature on A.
     std::optional<collision_feature> featureB; // Closest feature on B.
-    scalar normal_impulse; // Applied normal impulse.
-    std::array<scalar, 2> friction_impulse; // Applied tangential friction impulse.
-    scalar spin_friction_impulse; // Applied spin friction impulse.
-    std::array<scalar, 2> rolling_friction_impulse; // Applied rolling friction impulse.
     scalar normal_restitution_impulse; // Applied normal impulse in restitution solver.
     std::array<scalar, 2> friction_restitution_impulse; // Applied tangential friction impulse in restitution solver.
     /**
@@ -50,21 +64,25 @@ void serialize(Archive &archive, contact_point &cp) {
     archive(cp.normal);
     archive(cp.local_normal);
     archive(cp.normal_attachment);
-    archive(cp.friction);
-    archive(cp.spin_friction);
-    archive(cp.roll_friction);
-    archive(cp.restitution);
-    archive(cp.stiffness);
-    archive(cp.damping);
     archive(cp.lifetime);
     archive(cp.distance);
-    archive(cp.featureA, cp.featureB);
     archive(cp.normal_impulse);
     archive(cp.friction_impulse);
     archive(cp.spin_friction_impulse);
     archive(cp.rolling_friction_impulse);
-    archive(cp.normal_restitution_impulse);
-    archive(cp.friction_restitution_impulse);
+}
+
+template<typename Archive>
+void serialize(Archive &archive, contact_point_cold &cold) {
+    archive(cold.friction);
+    archive(cold.spin_friction);
+    archive(cold.roll_friction);
+    archive(cold.restitution);
+    archive(cold.stiffness);
+    archive(cold.damping);
+    archive(cold.featureA, cold.featureB);
+    archive(cold.normal_restitution_impulse);
+    archive(cold.friction_restitution_impulse);
 }
 
 }
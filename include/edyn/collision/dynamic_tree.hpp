@@ -5,7 +5,9 @@
 #include <cstdint>
 #include <entt/entity/fwd.hpp>
 #include "edyn/comp/aabb.hpp"
+#include "edyn/comp/aabb_margin.hpp"
 #include "edyn/math/geom.hpp"
+#include "edyn/config/memory_resource.hpp"
 #include "edyn/collision/tree_node.hpp"
 #include "edyn/collision/query_tree.hpp"
 
@@ -21,7 +23,10 @@ namespace edyn {
  *  - https://github.com/erincatto/box2d/blob/master/src/collision/b2_dynamic_tree.cpp
  */
 class dynamic_tree final {
-    constexpr static vector3 aabb_inset = vector3_one * scalar(-0.1);
+    // Leaves are reinserted when their inflated AABB is larger than the
+    // inflated AABB they would get now by more than this many times the
+    // margin on each side, so leaves of bodies which slowed down are shrunk.
+    constexpr static scalar huge_margin_multiplier = scalar(4);
 
 private:
     tree_node_id_t allocate();
@@ -31,6 +36,7 @@ private:
     void remove(tree_node_id_t);
     void refit(tree_node_id_t);
     tree_node_id_t balance(tree_node_id_t);
+    tree_node_id_t build(tree_node_id_t *first, tree_node_id_t *last);
 
 public:
     dynamic_tree();
@@ -42,22 +48,106 @@ public:
      *
      * @param aabb The leaf node AABB.
      * @param entity The entity associated with this node.
+     * @param filter The collision filter of the entity.
+     * @param margin How much the leaf AABB is inflated.
      * @return The new node id.
      */
-    tree_node_id_t create(const AABB &, entt::entity);
+    tree_node_id_t create(const AABB &, entt::entity, const collision_filter & = {},
+                          const aabb_margin & = {});
+
+    /**
+     * @brief Creates new leaf nodes for many AABBs at once.
+     *
+     * Builds a subtree with the new leaves top-down using the surface area
+     * heuristic with binned centroids and then inserts the subtree into the
+     * tree. This is faster and results in a better tree than creating the
+     * leaves one by one, which is preferable when a large number of AABBs
+     * is added at once, e.g. when a level is loaded.
+     *
+     * @param aabbs The leaf node AABBs.
+     * @param entities The entity associated with each leaf node.
+     * @param ids Receives the id of each new leaf node.
+     * @param filters The collision filter of each entity or empty if all of
+     * them use the default filter.
+     * @param margins The margin of each leaf or empty if all of them use the
+     * default margin.
+     */
+    void create(const std::vector<AABB> &aabbs, const std::vector<entt::entity> &entities,
+                std::vector<tree_node_id_t> &ids, const std::vector<collision_filter> &filters = {},
+                const std::vector<aabb_margin> &margins = {});
+
+    /**
+     * @brief Calculates the inflated AABB of a leaf, which is the AABB
+     * inflated by the margin and extended along the displacement expected in
+     * the next step times the displacement multiplier, as in Box2D.
+     *
+     * @param aabb The AABB of the entity.
+     * @param displacement The displacement of the entity in one step.
+     * @param margin The margin policy of the entity.
+     * @return The inflated AABB.
+     */
+    static AABB inflate(const AABB &aabb, const vector3 &displacement, const aabb_margin &margin);
+
+    /**
+     * @brief Whether a leaf has to be moved, i.e. whether the AABB left the
+     * inflated AABB of the leaf or the inflated AABB of the leaf is much
+     * larger than the one it would get now. This only reads the tree, thus
+     * it can be called for many leaves in parallel before moving them.
+     *
+     * @param id The node id.
+     * @param aabb The new AABB.
+     * @param displacement The displacement of the entity in one step.
+     * @param margin The margin policy of the entity.
+     * @return Whether the leaf must be moved.
+     */
+    bool needs_move(tree_node_id_t, const AABB &, const vector3 &displacement = vector3_zero,
+                    const aabb_margin &margin = {}) const;
 
     /**
      * @brief Attempts to change the AABB of a node.
      *
      * If the provided AABB is not fully contained within the node's AABB (which
-     * is inflated internally), it changes the AABB of the node and reinserts
-     * it into the tree.
+     * is inflated internally) or the node's AABB is too large, it changes the
+     * AABB of the node and reinserts it into the tree.
      *
      * @param id The node id.
      * @param aabb The new AABB.
+     * @param displacement The displacement of the entity in one step.
+     * @param margin How much the node AABB is inflated.
      * @return Whether the AABB was changed.
      */
-    bool move(tree_node_id_t, const AABB &);
+    bool move(tree_node_id_t, const AABB &, const vector3 &displacement = vector3_zero,
+              const aabb_margin &margin = {});
+
+    /**
+     * @brief Changes the AABBs of many leaves at once.
+     *
+     * Leaves which don't need to be moved (see `needs_move`) are skipped.
+     * Leaves whose new inflated AABB fits within the AABB of their parent keep
+     * their place in the tree and their ancestors are refit bottom-up
+     * afterwards, each of them once. The other leaves are reinserted as in
+     * the single leaf version, since leaving them in place would keep growing
+     * their ancestors and degrade the tree.
+     *
+     * @param ids The leaf node ids.
+     * @param aabbs The new AABB of each leaf.
+     * @param displacements The displacement of each entity in one step or
+     * empty if none of them is moving.
+     * @param margins The margin of each leaf or empty if all of them use the
+     * default margin.
+     */
+    void move(const std::vector<tree_node_id_t> &ids, const std::vector<AABB> &aabbs,
+              const std::vector<vector3> &displacements = {},
+              const std::vector<aabb_margin> &margins = {});
+
+    /**
+     * @brief Changes the collision filter of a leaf and updates the unions
+     * of the filters of its ancestors.
+     *
+     * @param id The node id.
+     * @param filter The new collision filter.
+     */
+    void set_filter(tree_node_id_t, const collision_filter &);
 
     /**
      * @brief Destroys a node with the given id.
@@ -77,6 +167,20 @@ public:
     template<typename Func>
     void query(const AABB &aabb, Func func) const;
 
+    /**
+     * @brief Call `func` for all nodes that overlap `aabb` and whose
+     * collision filter accepts `filter`. Subtrees whose union of filters
+     * does not accept it are not visited.
+     *
+     * @tparam Func Inferred function parameter type.
+     * @param aabb The query AABB.
+     * @param filter The collision filter of the query.
+     * @param func Function to be called for each overlapping node. It takes a
+     * single `tree_node_id_t` parameter.
+     */
+    template<typename Func>
+    void query(const AABB &aabb, const collision_filter &filter, Func func) const;
+
     /**
      * @brief Call `func` for all nodes that intersect the segment [p0, p1].
      * @param p0 First point in the segment.
@@ -87,6 +191,18 @@ public:
     template<typename Func>
     void raycast(vector3 p0, vector3 p1, Func func) const;
 
+    /**
+     * @brief Call `func` for all nodes that intersect any segment in the
+     * packet.
+     * @param packet The segments. Lanes clipped or terminated by `func` in
+     * the packet are taken into account for the remaining nodes.
+     * @param func Function to be called for each intersecting node. It takes
+     * a `tree_node_id_t` and an `unsigned` bit mask of the lanes whose
+     * segment intersects the node.
+     */
+    template<typename Func>
+    void raycast(const ray_packet &packet, Func func) const;
+
     /**
      * @brief Gets a tree node.
      *
@@ -95,13 +211,42 @@ public:
      */
     const tree_node & get_node(tree_node_id_t) const;
 
+    /**
+     * @brief Gets the id of the root node.
+     * @return The root node id or `null_tree_node_id` if the tree is empty.
+     */
+    tree_node_id_t root() const {
+        return m_root;
+    }
+
+    /**
+     * @brief Translates all nodes, i.e. subtracts `offset` from their AABBs,
+     * which keeps the structure of the tree.
+     * @param offset The new origin in the current coordinates.
+     */
+    void shift_origin(const vector3 &offset);
+
     void clear();
 
+    /**
+     * @brief Memory allocated for the nodes, including free nodes.
+     */
+    size_t num_bytes() const {
+        return m_nodes.capacity() * sizeof(tree_node) +
+               (m_refit_nodes.capacity() + m_reinsert_leaves.capacity()) * sizeof(tree_node_id_t) +
+               m_refit_marks.capacity() * sizeof(uint8_t);
+    }
+
 private:
     tree_node_id_t m_root;
 
-    std::vector<tree_node> m_nodes;
+    resource_vector<tree_node> m_nodes;
     tree_node_id_t m_free_list;
+
+    // Buffers used when moving many leaves at once.
+    std::vector<tree_node_id_t> m_refit_nodes;
+    std::vector<tree_node_id_t> m_reinsert_leaves;
+    std::vector<uint8_t> m_refit_marks;
 };
 
 template<typename Func>
@@ -109,11 +254,23 @@ void dynamic_tree::query(const AABB &aabb, Func func) const {
     query_tree(*this, m_root, null_tree_node_id, aabb, func);
 }
 
+template<typename Func>
+void dynamic_tree::query(const AABB &aabb, const collision_filter &filter, Func func) const {
+    query_tree(*this, m_root, null_tree_node_id, aabb, func, [&](const tree_node &node) {
+        return collision_filter_test(node.filter, filter);
+    });
+}
+
 template<typename Func>
 void dynamic_tree::raycast(vector3 p0, vector3 p1, Func func) const {
     raycast_tree(*this, m_root, null_tree_node_id, p0, p1, func);
 }
 
+template<typename Func>
+void dynamic_tree::raycast(const ray_packet &packet, Func func) const {
+    raycast_tree_packet(*this, m_root, null_tree_node_id, packet, func);
+}
+
 }
 
 #endif // EDYN_COLLISION_DYNAMIC_TREE_HPP
@@ -0,0 +1,353 @@
+#ifndef EDYN_COLLISION_GJK_HPP
+#define EDYN_COLLISION_GJK_HPP
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include "edyn/math/vector3.hpp"
+#include "edyn/math/quaternion.hpp"
+#include "edyn/config/constants.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Simplex found by GJK between a pair of convex shapes. Its vertices
+ * are stored as the pair of support points in the object space of each shape
+ * that generated them, thus they remain points of the Minkowski difference
+ * after the shapes move. Keeping it in the contact manifold lets GJK start
+ * from the simplex of the previous step, which usually takes only one or two
+ * iterations to converge.
+ */
+struct gjk_simplex {
+    std::array<vector3, 4> pointsA;
+    std::array<vector3, 4> pointsB;
+    uint8_t size {0};
+
+    void clear() {
+        size = 0;
+    }
+};
+
+/**
+ * @brief Result of GJK.
+ */
+struct gjk_result {
+    // Whether the shapes intersect, in which case the other members are not
+    // valid and `epa` can be used to find the penetration.
+    bool intersecting {false};
+    // Distance between the shapes. If GJK stopped early because the shapes
+    // are further apart than the maximum distance, this is a lower bound of
+    // the distance, which is greater than the maximum distance.
+    scalar distance;
+    // Closest points on A and B in the object space of A.
+    vector3 pointA;
+    vector3 pointB;
+};
+
+/**
+ * @brief Result of EPA.
+ */
+struct epa_result {
+    // Direction along which B must be moved by `depth` to separate the
+    // shapes, i.e. it points from A towards B, in the object space of A.
+    vector3 normal;
+    scalar depth;
+    // Deepest points on A and B in the object space of A.
+    vector3 pointA;
+    vector3 pointB;
+};
+
+namespace detail {
+    /**
+     * Vertices of the simplex in GJK, where `w` are the points of the
+     * Minkowski difference A - B in the object space of A, and `a` and `b`
+     * are the support points of each shape in their own object space.
+     */
+    struct gjk_state {
+        std::array<vector3, 4> w;
+        std::array<vector3, 4> a;
+        std::array<vector3, 4> b;
+        std::array<scalar, 4> lambda;
+        size_t size {0};
+
+        void push(const vector3 &wi, const vector3 &ai, const vector3 &bi) {
+            w[size] = wi;
+            a[size] = ai;
+            b[size] = bi;
+            ++size;
+        }
+    };
+
+    /**
+     * Finds the point of the simplex closest to the origin, removes the
+     * vertices which are not needed to express it and assigns the
+     * barycentric coordinates of the point to `lambda`. If the simplex is a
+     * tetrahedron which contains the origin, it's kept as is.
+     */
+    vector3 gjk_closest_point(gjk_state &state);
+
+    /**
+     * Convex polytope used by EPA, a triangulated approximation of the
+     * Minkowski difference which contains the origin.
+     */
+    class epa_polytope {
+    public:
+        struct face {
+            std::array<uint32_t, 3> vertices;
+            // Outward unit normal and distance of its plane to the origin.
+            vector3 normal;
+            scalar distance;
+        };
+
+        // Builds a tetrahedron from the simplex. Returns false if it's
+        // degenerate or does not contain the origin.
+        bool init(const gjk_state &state);
+
+        // Index of the face closest to the origin.
+        size_t closest_face() const;
+
+        // Adds a new vertex, replacing the faces visible from it. Returns
+        // false if the polytope could not be expanded.
+        bool expand(const vector3 &w, const vector3 &a, const vector3 &b);
+
+        // Assigns the result given the converged face.
+        void make_result(size_t face_idx, const vector3 &posB, const quaternion &ornB,
+                         epa_result &result) const;
+
+        const face &get_face(size_t idx) const {
+            return m_faces[idx];
+        }
+
+    private:
+        bool add_face(uint32_t i0, uint32_t i1, uint32_t i2);
+
+        std::vector<vector3> m_w;
+        std::vector<vector3> m_a;
+        std::vector<vector3> m_b;
+        std::vector<face> m_faces;
+    };
+}
+
+/**
+ * @brief Computes the distance between two convex shapes with GJK. The shapes
+ * are defined by their support functions, which take a direction in the
+ * object space of the shape and return the point of the shape that's
+ * furthest along that direction in object space. Everything is calculated in
+ * the object space of A.
+ * @param support_funcA Support function of A.
+ * @param support_funcB Support function of B.
+ * @param posB Position of B in the object space of A.
+ * @param ornB Orientation of B in the object space of A.
+ * @param simplex Simplex of a previous call for the same pair of shapes to
+ * start from, or an empty simplex. Is assigned the resulting simplex.
+ * @param max_distance GJK stops as soon as it finds the shapes to be further
+ * apart than this value.
+ * @return The distance and closest points or whether the shapes intersect.
+ */
+template<typename SupportA, typename SupportB>
+gjk_result gjk(SupportA &&support_funcA, SupportB &&support_funcB,
+               const vector3 &posB, const quaternion &ornB,
+               gjk_simplex &simplex, scalar max_distance = EDYN_SCALAR_MAX) {
+    const auto ornB_conj = conjugate(ornB);
+    auto state = detail::gjk_state{};
+    auto result = gjk_result{};
+
+    // Support point of the Minkowski difference A - B along `dir`.
+    auto support = [&](const vector3 &dir, vector3 &a, vector3 &b) {
+        a = support_funcA(dir);
+        b = support_funcB(rotate(ornB_conj, -dir));
+        return a - (posB + rotate(ornB, b));
+    };
+
+    for (size_t i = 0; i < simplex.size; ++i) {
+        auto &a = simplex.pointsA[i];
+        auto &b = simplex.pointsB[i];
+        state.push(a - (posB + rotate(ornB, b)), a, b);
+    }
+
+    if (state.size == 0) {
+        vector3 a, b;
+        auto dir = posB == vector3_zero ? vector3_x : posB;
+        auto w = support(dir, a, b);
+        state.push(w, a, b);
+    }
+
+    auto v = vector3_zero;
+    auto beyond_max_distance = false;
+    auto max_distance_sqr = max_distance < large_scalar ?
+        max_distance * max_distance : EDYN_SCALAR_MAX;
+
+    for (unsigned iter = 0; iter < gjk_max_iterations; ++iter) {
+        v = detail::gjk_closest_point(state);
+        auto dist_sqr = length_sqr(v);
+
+        if (state.size == 4 || dist_sqr <= EDYN_EPSILON) {
+            result.intersecting = true;
+            break;
+        }
+
+        vector3 a, b;
+        auto w = support(-v, a, b);
+        auto vw = dot(v, w);
+
+        // `vw / |v|` is a lower bound of the distance.
+        if (vw > 0 && vw * vw > max_distance_sqr * dist_sqr) {
+            result.distance = vw / std::sqrt(dist_sqr);
+            beyond_max_distance = true;
+            break;
+        }
+
+        if (dist_sqr - vw <= gjk_relative_tolerance * dist_sqr) {
+            break;
+        }
+
+        auto is_duplicate = false;
+
+        for (size_t i = 0; i < state.size; ++i) {
+            if (distance_sqr(state.w[i], w) <= EDYN_EPSILON) {
+                is_duplicate = true;
+                break;
+            }
+        }
+
+        if (is_duplicate) {
+            break;
+        }
+
+        state.push(w, a, b);
+    }
+
+    simplex.size = static_cast<uint8_t>(state.size);
+
+    for (size_t i = 0; i < state.size; ++i) {
+        simplex.pointsA[i] = state.a[i];
+        simplex.pointsB[i] = state.b[i];
+    }
+
+    if (result.intersecting || beyond_max_distance) {
+        return result;
+    }
+
+    result.distance = length(v);
+    result.pointA = vector3_zero;
+    result.pointB = vector3_zero;
+
+    for (size_t i = 0; i < state.size; ++i) {
+        result.pointA += state.a[i] * state.lambda[i];
+        result.pointB += (posB + rotate(ornB, state.b[i])) * state.lambda[i];
+    }
+
+    return result;
+}
+
+/**
+ * @brief Computes the penetration of two intersecting convex shapes with EPA,
+ * starting from the simplex found by `gjk`. Same parameters as `gjk`.
+ * @param simplex The simplex found by `gjk` in a call which found the shapes
+ * to be intersecting.
+ * @param result The penetration depth and direction.
+ * @return Whether EPA succeeded. It can fail in degenerate situations, such as
+ * when the shapes are only touching.
+ */
+template<typename SupportA, typename SupportB>
+bool epa(SupportA &&support_funcA, SupportB &&support_funcB,
+         const vector3 &posB, const quaternion &ornB,
+         const gjk_simplex &simplex, epa_result &result) {
+    const auto ornB_conj = conjugate(ornB);
+    auto state = detail::gjk_state{};
+
+    auto support = [&](const vector3 &dir, vector3 &a, vector3 &b) {
+        a = support_funcA(dir);
+        b = support_funcB(rotate(ornB_conj, -dir));
+        return a - (posB + rotate(ornB, b));
+    };
+
+    for (size_t i = 0; i < simplex.size; ++i) {
+        auto &a = simplex.pointsA[i];
+        auto &b = simplex.pointsB[i];
+        state.push(a - (posB + rotate(ornB, b)), a, b);
+    }
+
+    // Grow simplices of lower dimension, which occur when the origin lies on
+    // their boundary, into a tetrahedron.
+    auto try_push = [&](const vector3 &dir) {
+        vector3 a, b;
+        auto w = support(dir, a, b);
+
+        if (state.size == 1) {
+            if (distance_sqr(w, state.w[0]) <= EDYN_EPSILON) {
+                return false;
+            }
+        } else if (state.size == 2) {
+            if (length_sqr(cross(w - state.w[0], state.w[1] - state.w[0])) <= EDYN_EPSILON) {
+                return false;
+            }
+        } else {
+            auto normal = cross(state.w[1] - state.w[0], state.w[2] - state.w[0]);
+            if (std::abs(dot(w - state.w[0], normal)) <= EDYN_EPSILON) {
+                return false;
+            }
+        }
+
+        state.push(w, a, b);
+        return true;
+    };
+
+    if (state.size == 0) {
+        return false;
+    }
+
+    if (state.size == 1) {
+        const vector3 axes[] = {vector3_x, -vector3_x, vector3_y, -vector3_y, vector3_z, -vector3_z};
+        for (auto &axis : axes) {
+            if (try_push(axis)) break;
+        }
+    }
+
+    if (state.size == 2) {
+        auto edge = state.w[1] - state.w[0];
+        auto axis = std::abs(edge.x) < std::abs(edge.y) ?
+            (std::abs(edge.x) < std::abs(edge.z) ? vector3_x : vector3_z) :
+            (std::abs(edge.y) < std::abs(edge.z) ? vector3_y : vector3_z);
+        auto perp0 = cross(edge, axis);
+        auto perp1 = cross(edge, perp0);
+        const vector3 dirs[] = {perp0, -perp0, perp1, -perp1};
+        for (auto &dir : dirs) {
+            if (try_push(dir)) break;
+        }
+    }
+
+    if (state.size == 3) {
+        auto normal = cross(state.w[1] - state.w[0], state.w[2] - state.w[0]);
+        if (!try_push(normal)) {
+            try_push(-normal);
+        }
+    }
+
+    auto polytope = detail::epa_polytope{};
+
+    if (state.size != 4 || !polytope.init(state)) {
+        return false;
+    }
+
+    for (unsigned iter = 0; iter < epa_max_iterations; ++iter) {
+        auto face_idx = polytope.closest_face();
+        auto &face = polytope.get_face(face_idx);
+
+        vector3 a, b;
+        auto w = support(face.normal, a, b);
+
+        if (dot(w, face.normal) - face.distance <= epa_tolerance ||
+            !polytope.expand(w, a, b)) {
+            polytope.make_result(face_idx, posB, ornB, result);
+            return true;
+        }
+    }
+
+    polytope.make_result(polytope.closest_face(), posB, ornB, result);
+    return true;
+}
+
+}
+
+#endif // EDYN_COLLISION_GJK_HPP
@@ -0,0 +1,221 @@
+#ifndef EDYN_COLLISION_LINEAR_BVH_HPP
+#define EDYN_COLLISION_LINEAR_BVH_HPP
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <entt/entity/entity.hpp>
+#include "edyn/comp/aabb.hpp"
+#include "edyn/comp/collision_filter.hpp"
+#include "edyn/config/config.h"
+
+namespace edyn {
+
+/**
+ * @brief Linear bounding volume hierarchy which is rebuilt from scratch
+ * whenever its AABBs change, instead of being updated incrementally as the
+ * dynamic tree. The entities are sorted by the Morton code of the center of
+ * their AABBs with a radix sort and the hierarchy is built over the sorted
+ * codes as described in "Maximizing Parallelism in the Construction of BVHs,
+ * Octrees, and k-d Trees" (Karras, 2012), where each internal node is found
+ * independently of the others. The build takes linear time and does not
+ * degrade as entities move, which suits large numbers of small, fast and
+ * incoherently moving entities such as debris and particles, whose leaves
+ * would otherwise be moved in the dynamic tree in every step.
+ *
+ * The AABBs are stored in Morton order after a build, thus nearby entities
+ * are close in memory as well. Queries do not modify the hierarchy and can
+ * run in parallel.
+ */
+class linear_bvh final {
+    // Marks the child index of an internal node as the index of a leaf.
+    static constexpr uint32_t leaf_bit = uint32_t{1} << 31;
+
+    // Traversal stack size. The hierarchy is at most as deep as the number of
+    // bits in the sort keys, which are the 30 bit Morton code followed by the
+    // 32 bit index of the entity.
+    static constexpr size_t max_depth = 64;
+
+    struct node {
+        AABB aabb;
+        uint32_t child[2];
+    };
+
+public:
+    /**
+     * @brief Adds an entity. Call `build` before querying.
+     * @param entity The entity.
+     * @param aabb Its AABB.
+     * @param filter Its collision filter.
+     */
+    void insert(entt::entity, const AABB &, const collision_filter & = {});
+
+    /**
+     * @brief Removes an entity. Call `build` before querying.
+     * @param entity The entity.
+     */
+    void erase(entt::entity);
+
+    bool contains(entt::entity) const;
+
+    /**
+     * @brief Changes the AABB of an entity. Call `build` before querying.
+     * @param entity The entity.
+     * @param aabb The new AABB.
+     */
+    void set_aabb(entt::entity, const AABB &);
+
+    void set_filter(entt::entity, const collision_filter &);
+
+    /**
+     * @brief Rebuilds the hierarchy if an entity was inserted, erased or
+     * changed its AABB since the last build.
+     */
+    void build();
+
+    /**
+     * @brief Calls `func` for each entity other than `entity` whose AABB
+     * intersects the AABB of `entity`. Must be called after `build`.
+     * @param entity An entity in the hierarchy.
+     * @param use_filters Whether to skip entities whose collision filters do
+     * not accept each other.
+     * @param func Function with signature `void(entt::entity)`.
+     */
+    template<typename Func>
+    void query(entt::entity entity, bool use_filters, Func func) const;
+
+    /**
+     * @brief Calls `func` for each entity whose AABB intersects `aabb`. Must
+     * be called after `build`.
+     * @param func Function with signature `void(entt::entity)`.
+     */
+    template<typename Func>
+    void query(const AABB &aabb, Func func) const;
+
+    /**
+     * @brief Translates all AABBs, i.e. subtracts `offset` from them, which
+     * keeps the hierarchy valid.
+     * @param offset The new origin in the current coordinates.
+     */
+    void shift_origin(const vector3 &offset);
+
+    void clear();
+
+    size_t size() const {
+        return m_entities.size();
+    }
+
+    bool empty() const {
+        return m_entities.empty();
+    }
+
+    size_t num_bytes() const {
+        return m_aabbs.capacity() * sizeof(AABB) +
+               m_entities.capacity() * sizeof(entt::entity) +
+               m_filters.capacity() * sizeof(collision_filter) +
+               m_sparse.capacity() * sizeof(uint32_t) +
+               m_nodes.capacity() * sizeof(node) +
+               m_parents.capacity() * sizeof(uint32_t) +
+               m_codes.capacity() * sizeof(uint32_t) +
+               m_order.capacity() * sizeof(uint32_t) +
+               m_sort_buffer.capacity() * sizeof(uint32_t) +
+               m_visits.capacity() * sizeof(uint8_t);
+    }
+
+private:
+    size_t find(entt::entity) const;
+    void set_index(size_t index);
+    void compute_codes();
+    void sort_codes();
+    void reorder();
+    void build_nodes();
+    void refit();
+
+    template<typename Func>
+    void traverse(const AABB &aabb, Func func) const;
+
+    // Entities and their AABBs and filters, in Morton order after a build.
+    std::vector<AABB> m_aabbs;
+    std::vector<entt::entity> m_entities;
+    std::vector<collision_filter> m_filters;
+    // Index of each entity plus one, indexed by entity identifier.
+    std::vector<uint32_t> m_sparse;
+    // Internal nodes, where the root is the first. There is one less
+    // internal node than there are entities.
+    std::vector<node> m_nodes;
+    // Parent of each internal node followed by the parent of each leaf.
+    std::vector<uint32_t> m_parents;
+    // Buffers of the build, kept to avoid allocations.
+    std::vector<uint32_t> m_codes;
+    std::vector<uint32_t> m_order;
+    std::vector<uint32_t> m_sort_buffer;
+    std::vector<uint8_t> m_visits;
+    bool m_dirty {false};
+};
+
+template<typename Func>
+void linear_bvh::traverse(const AABB &aabb, Func func) const {
+    EDYN_ASSERT(!m_dirty);
+
+    if (m_entities.empty()) {
+        return;
+    }
+
+    if (m_nodes.empty()) {
+        if (intersect(aabb, m_aabbs[0])) {
+            func(size_t{0});
+        }
+        return;
+    }
+
+    auto stack = std::array<uint32_t, max_depth>{};
+    size_t stack_size = 0;
+    stack[stack_size++] = 0;
+
+    while (stack_size > 0) {
+        auto &n = m_nodes[stack[--stack_size]];
+
+        for (auto child : n.child) {
+            if (child & leaf_bit) {
+                auto index = static_cast<size_t>(child & ~leaf_bit);
+
+                if (intersect(aabb, m_aabbs[index])) {
+                    func(index);
+                }
+            } else if (intersect(aabb, m_nodes[child].aabb)) {
+                EDYN_ASSERT(stack_size < max_depth);
+                stack[stack_size++] = child;
+            }
+        }
+    }
+}
+
+template<typename Func>
+void linear_bvh::query(entt::entity entity, bool use_filters, Func func) const {
+    auto self = find(entity);
+    EDYN_ASSERT(self < m_entities.size());
+    auto &filter = m_filters[self];
+
+    traverse(m_aabbs[self], [&](size_t index) {
+        if (index == self) {
+            return;
+        }
+
+        if (use_filters && !collision_filter_test(filter, m_filters[index])) {
+            return;
+        }
+
+        func(m_entities[index]);
+    });
+}
+
+template<typename Func>
+void linear_bvh::query(const AABB &aabb, Func func) const {
+    traverse(aabb, [&](size_t index) {
+        func(m_entities[index]);
+    });
+}
+
+}
+
+#endif // EDYN_COLLISION_LINEAR_BVH_HPP
@@ -2,6 +2,8 @@
 #define EDYN_COLLISION_NARROWPHASE_HPP
 
 #include <array>
+#include <tuple>
+#include <vector>
 #include <entt/entity/fwd.hpp>
 #include <entt/entity/view.hpp>
 #include "edyn/comp/aabb.hpp"
@@ -13,11 +15,32 @@
 #include "edyn/collision/contact_manifold.hpp"
 #include "edyn/collision/contact_point.hpp"
 #include "edyn/collision/collision_result.hpp"
+#include "edyn/collision/collision_stats.hpp"
 #include "edyn/util/collision_util.hpp"
+#include "edyn/shapes/shapes.hpp"
 #include "edyn/context/settings.hpp"
+#include "edyn/sys/update_rotated_meshes.hpp"
 
 namespace edyn {
 
+/**
+ * @brief Contact point churn in the last narrowphase update.
+ */
+struct narrowphase_stats {
+    // Number of manifolds that went through collision detection, which does
+    // not include manifolds whose bodies did not move relative to each other.
+    size_t num_manifolds {0};
+    size_t num_points_created {0};
+    size_t num_points_destroyed {0};
+    // Manifolds which created and destroyed points in the same step. If the
+    // same manifolds show up here step after step, their contacts are
+    // flickering.
+    std::vector<entt::entity> churning_manifolds;
+    // Manifolds that went through collision detection by pair of shape
+    // types, see `collision_stats::num_narrowphase_manifolds_by_shape`.
+    std::array<size_t, collision_stats::num_shape_pairs> num_manifolds_by_shape {};
+};
+
 class narrowphase {
     struct contact_point_construction_info {
         std::array<collision_result::collision_point, max_contacts> point;
@@ -29,8 +52,22 @@ class narrowphase {
         size_t count {0};
     };
 
+    // Number of combinations of shape types of the two bodies in a manifold.
+    constexpr static size_t num_shape_pairs = collision_stats::num_shape_pairs;
+
+    template<typename Iterator>
+    void sort_manifolds_by_shape(Iterator begin, Iterator end);
+
+    void reuse_unmoved_manifolds();
+    void attach_compound_pair_caches();
+
+    template<typename ProcessFunc>
+    void detect_collision_sorted(const entt::entity *first, const entt::entity *last,
+                                 unsigned start, ProcessFunc process);
+
+    void update_sorted_contact_manifolds();
     void detect_collision_parallel();
-    void detect_collision_parallel_range(unsigned start, unsigned end);
+    void detect_collision_range(const entt::entity *first, const entt::entity *last, unsigned start);
     void finish_detect_collision();
     void clear_contact_manifold_events();
 
@@ -45,45 +82,84 @@ public:
     template<typename Iterator>
     void update_contact_manifolds(Iterator begin, Iterator end);
 
+    /**
+     * @brief Contact point churn of the last update.
+     */
+    const narrowphase_stats &get_stats() const {
+        return m_stats;
+    }
+
 private:
     entt::registry *m_registry;
+    // Points to be created and destroyed in each manifold, in the same order
+    // as `m_manifold_entities`. Points are not created nor destroyed while
+    // detecting collisions, which may run in parallel, but afterwards in
+    // `finish_detect_collision`, where the update signals of each manifold
+    // are triggered only once.
     std::vector<contact_point_construction_info> m_cp_construction_infos;
     std::vector<contact_point_destruction_info> m_cp_destruction_infos;
+    // Manifolds to be processed grouped by the pair of shape types of their
+    // bodies.
+    std::vector<entt::entity> m_manifold_entities;
+    // Shape pair of each manifold above, i.e. `indexA * num_shapes + indexB`.
+    std::vector<unsigned> m_manifold_shape_pairs;
+    // Manifolds to be updated before sorting.
+    std::vector<entt::entity> m_pending_manifolds;
+    // Bodies whose rotated meshes must be updated before detecting collisions.
+    std::vector<entt::entity> m_rotated_mesh_entities;
     size_t m_max_sequential_size {4};
+    narrowphase_stats m_stats;
 };
 
 template<typename Iterator>
-void narrowphase::update_contact_manifolds(Iterator begin, Iterator end) {
+void narrowphase::sort_manifolds_by_shape(Iterator begin, Iterator end) {
+    // Manifolds whose bodies did not move relative to each other keep their
+    // points and are left out.
+    m_pending_manifolds.assign(begin, end);
+    reuse_unmoved_manifolds();
+
+    // Counting sort by shape pair, so that the manifolds of each pair of
+    // shape types can be processed together without dynamic dispatch.
     auto manifold_view = m_registry->view<contact_manifold>();
-    auto events_view = m_registry->view<contact_manifold_events>();
-    auto body_view = m_registry->view<AABB, shape_index, position, orientation>();
-    auto tr_view = m_registry->view<position, orientation>();
-    auto origin_view = m_registry->view<origin>();
-    auto vel_view = m_registry->view<angvel>();
-    auto rolling_view = m_registry->view<rolling_tag>();
-    auto material_view = m_registry->view<material>();
-    auto orn_view = m_registry->view<orientation>();
-    auto mesh_shape_view = m_registry->view<mesh_shape>();
-    auto paged_mesh_shape_view = m_registry->view<paged_mesh_shape>();
-    auto views_tuple = get_tuple_of_shape_views(*m_registry);
-    auto dt = m_registry->ctx().get<settings>().fixed_dt;
-
-    for (auto it = begin; it != end; ++it) {
-        entt::entity manifold_entity = *it;
+    auto index_view = m_registry->view<shape_index>();
+    constexpr auto num_shapes = std::tuple_size_v<std::decay_t<decltype(shapes_tuple)>>;
+    std::array<unsigned, num_shape_pairs> offsets {};
+
+    auto get_shape_pair = [&](entt::entity manifold_entity) {
         auto &manifold = manifold_view.template get<contact_manifold>(manifold_entity);
-        auto &events = events_view.get<contact_manifold_events>(manifold_entity);
-        collision_result result;
-        detect_collision(manifold.body, result, body_view, origin_view, views_tuple);
-
-        process_collision(manifold_entity, manifold, events, result, tr_view, vel_view,
-                          rolling_view, origin_view, orn_view, material_view,
-                          mesh_shape_view, paged_mesh_shape_view, dt,
-                          [&](const collision_result::collision_point &rp) {
-            create_contact_point(*m_registry, manifold_entity, manifold, rp);
-        }, [&](auto pt_id) {
-            destroy_contact_point(*m_registry, manifold_entity, pt_id);
-        });
+        auto [indexA] = index_view.get(manifold.body[0]);
+        auto [indexB] = index_view.get(manifold.body[1]);
+        return unsigned(indexA.value * num_shapes + indexB.value);
+    };
+
+    for (auto entity : m_pending_manifolds) {
+        ++offsets[get_shape_pair(entity)];
     }
+
+    for (unsigned i = 0, offset = 0; i < num_shape_pairs; ++i) {
+        auto num = offsets[i];
+        offsets[i] = offset;
+        offset += num;
+    }
+
+    m_manifold_entities.resize(m_pending_manifolds.size());
+    m_manifold_shape_pairs.resize(m_pending_manifolds.size());
+
+    for (auto entity : m_pending_manifolds) {
+        auto pair = get_shape_pair(entity);
+        auto idx = offsets[pair]++;
+        m_manifold_entities[idx] = entity;
+        m_manifold_shape_pairs[idx] = pair;
+    }
+
+    attach_compound_pair_caches();
+}
+
+template<typename Iterator>
+void narrowphase::update_contact_manifolds(Iterator begin, Iterator end) {
+    sort_manifolds_by_shape(begin, end);
+    update_rotated_meshes_in_contact(*m_registry, m_manifold_entities, m_rotated_mesh_entities, false);
+    update_sorted_contact_manifolds();
 }
 
 }
@@ -0,0 +1,143 @@
+#ifndef EDYN_COLLISION_OVERLAP_HPP
+#define EDYN_COLLISION_OVERLAP_HPP
+
+#include <variant>
+#include <vector>
+#include <entt/entity/fwd.hpp>
+#include <entt/entity/entity.hpp>
+#include <entt/signal/delegate.hpp>
+#include "edyn/math/vector3.hpp"
+#include "edyn/math/quaternion.hpp"
+#include "edyn/shapes/sphere_shape.hpp"
+#include "edyn/shapes/cylinder_shape.hpp"
+#include "edyn/shapes/capsule_shape.hpp"
+#include "edyn/shapes/box_shape.hpp"
+
+namespace edyn {
+
+// Shapes which can be placed in an overlap query.
+using overlap_shape_t = std::variant<sphere_shape, cylinder_shape, capsule_shape, box_shape>;
+
+/**
+ * @brief A shape placed in the world to find the rigid bodies it touches or
+ * the ones within a distance of it, e.g. for explosions or melee attacks.
+ */
+struct overlap_query {
+    overlap_shape_t shape;
+    vector3 pos {vector3_zero};
+    quaternion orn {quaternion_identity};
+    // Bodies farther than this from the shape are not reported. If zero,
+    // only bodies which intersect the shape are reported.
+    scalar max_distance {0};
+};
+
+/**
+ * @brief A rigid body found by an overlap query.
+ */
+struct overlap_hit {
+    entt::entity entity {entt::null};
+    // Signed distance between the closest points. It is negative if the
+    // shapes intersect, in which case it's the penetration depth.
+    scalar distance {EDYN_SCALAR_MAX};
+    // Closest point on the query shape, in world space.
+    vector3 pointA;
+    // Closest point on the rigid body, in world space.
+    vector3 pointB;
+    // Normal pointing from the rigid body towards the query shape.
+    vector3 normal;
+};
+
+/**
+ * @brief Information returned from an overlap query.
+ */
+struct overlap_result {
+    // All rigid bodies within the maximum distance, closest first.
+    std::vector<overlap_hit> hits;
+};
+
+/**
+ * @brief Input for an overlap query against a single shape.
+ */
+struct overlap_context {
+    // Position of the shape that is queried.
+    vector3 pos;
+    // Orientation of the shape that is queried.
+    quaternion orn;
+    overlap_query query;
+};
+
+using overlap_id_type = unsigned;
+using overlap_delegate_type = entt::delegate<void(overlap_id_type, const overlap_result &)>;
+// Receives the results of a batch of overlap queries in the same order as
+// the queries.
+using overlap_batch_delegate_type = entt::delegate<void(overlap_id_type, const std::vector<overlap_result> &)>;
+
+/**
+ * @brief Finds all rigid bodies which intersect a shape or are within the
+ * maximum distance of it. Do not call this if Edyn was initialized with
+ * `execution_mode::asynchronous`, use `overlap_async` instead.
+ * @param registry Data source.
+ * @param query The shape and its placement.
+ * @param ignore_entities Entities to be ignored.
+ * @return Result containing the rigid bodies that were found.
+ */
+overlap_result overlap(entt::registry &registry, const overlap_query &query,
+                       const std::vector<entt::entity> &ignore_entities = {});
+
+/**
+ * @brief Performs many overlap queries at once, in parallel in worker threads
+ * if Edyn was initialized with `execution_mode::sequential_multithreaded`. Do
+ * not call this if Edyn was initialized with `execution_mode::asynchronous`.
+ * @param registry Data source.
+ * @param queries The overlap queries.
+ * @param ignore_entities Entities to be ignored by all queries.
+ * @return The results, in the same order as `queries`.
+ */
+std::vector<overlap_result> overlap_batch(entt::registry &registry,
+                                          const std::vector<overlap_query> &queries,
+                                          const std::vector<entt::entity> &ignore_entities = {});
+
+/**
+ * @brief Performs an overlap query asynchronously. Only call this function if
+ * Edyn was initialized in `execution_mode::asynchronous`.
+ * @param registry Data source.
+ * @param query The shape and its placement.
+ * @param delegate Triggered when the result is available.
+ * @param ignore_entities Entities to be ignored.
+ * @return Request id, which will be passed to the delegate when it is invoked.
+ */
+overlap_id_type overlap_async(entt::registry &registry, const overlap_query &query,
+                              const overlap_delegate_type &delegate,
+                              const std::vector<entt::entity> &ignore_entities = {});
+
+/**
+ * @brief Performs many overlap queries asynchronously, which are sent to the
+ * simulation worker in one message and whose results come back in one
+ * message. Only call this function if Edyn was initialized in
+ * `execution_mode::asynchronous`.
+ * @param registry Data source.
+ * @param queries The overlap queries.
+ * @param delegate Triggered once with the results of all queries, in the same
+ * order as `queries`.
+ * @param ignore_entities Entities to be ignored by all queries.
+ * @return Request id, which will be passed to the delegate when it is invoked.
+ */
+overlap_id_type overlap_batch_async(entt::registry &registry, std::vector<overlap_query> queries,
+                                    const overlap_batch_delegate_type &delegate,
+                                    const std::vector<entt::entity> &ignore_entities = {});
+
+/**
+ * @brief Finds the closest points between the shape of a query and a single
+ * shape using the collision functions of the narrow-phase. Available for all
+ * types in `shapes_tuple`. The entity of the hit is not set.
+ * @param shape The shape that is queried.
+ * @param ctx The placement of the shape and the query.
+ * @return The closest points, or a hit with `distance` equal to
+ * `EDYN_SCALAR_MAX` if the shapes are farther apart than the maximum distance.
+ */
+template<typename Shape>
+overlap_hit overlap(const Shape &shape, const overlap_context &ctx);
+
+}
+
+#endif // EDYN_COLLISION_OVERLAP_HPP
@@ -3,20 +3,43 @@
 
 #include "edyn/collision/broadphase.hpp"
 #include "edyn/comp/aabb.hpp"
+#include "edyn/config/config.h"
+#include "edyn/parallel/query_future.hpp"
+#include "edyn/simulation/broadphase_mirror.hpp"
 #include <entt/entity/registry.hpp>
 
 namespace edyn {
 
+/**
+ * @brief Calls `func` for all procedural entities whose AABB overlaps the
+ * given AABB. In asynchronous mode, this is only available if
+ * `edyn::settings::publish_broadphase` is enabled, in which case the last
+ * state published by the simulation worker is queried, and the entities
+ * reported might have been destroyed since then.
+ */
 template<typename Func>
 void query_procedural_aabb(entt::registry &registry, const AABB &aabb, Func func) {
-    auto &bphase = registry.ctx().get<broadphase>();
-    bphase.query_procedural(aabb, func);
+    if (auto *bphase = registry.ctx().find<broadphase>()) {
+        bphase->query_procedural(aabb, func);
+    } else {
+        auto *mirror = find_broadphase_mirror(registry);
+        EDYN_ASSERT(mirror != nullptr);
+        mirror->query_procedural(aabb, func);
+    }
 }
 
+/**
+ * @brief Non-procedural counterpart of `query_procedural_aabb`.
+ */
 template<typename Func>
 void query_non_procedural_aabb(entt::registry &registry, const AABB &aabb, Func func) {
-    auto &bphase = registry.ctx().get<broadphase>();
-    bphase.query_non_procedural(aabb, func);
+    if (auto *bphase = registry.ctx().find<broadphase>()) {
+        bphase->query_non_procedural(aabb, func);
+    } else {
+        auto *mirror = find_broadphase_mirror(registry);
+        EDYN_ASSERT(mirror != nullptr);
+        mirror->query_non_procedural(aabb, func);
+    }
 }
 
 template<typename Func>
@@ -33,6 +56,8 @@ struct query_aabb_result {
 
 using query_aabb_id_type = unsigned;
 using query_aabb_delegate_type = entt::delegate<void(query_aabb_id_type, const query_aabb_result &)>;
+// Receives the results of a batch of queries in the same order as the AABBs.
+using query_aabb_batch_delegate_type = entt::delegate<void(query_aabb_id_type, const std::vector<query_aabb_result> &)>;
 
 query_aabb_id_type query_aabb_async(entt::registry &registry, const AABB &aabb,
                                     const query_aabb_delegate_type &delegate,
@@ -40,6 +65,35 @@ query_aabb_id_type query_aabb_async(entt::registry &registry, const AABB &aabb,
                                     bool query_non_procedural,
                                     bool query_islands);
 
+/**
+ * @brief Queries an AABB asynchronously and returns a future which is resolved
+ * as soon as the simulation worker is done with it, instead of invoking a
+ * delegate in the next update. The future must be taken in the main thread
+ * and before Edyn is detached. Only call this function if Edyn was
+ * initialized in `execution_mode::asynchronous`.
+ * @return Future holding the entities found in the AABB.
+ */
+query_future<query_aabb_result> query_aabb_async_future(entt::registry &registry, const AABB &aabb,
+                                                        bool query_procedural,
+                                                        bool query_non_procedural,
+                                                        bool query_islands);
+
+/**
+ * @brief Queries many AABBs asynchronously in one message, whose results
+ * come back in one message. Only call this function if Edyn was initialized
+ * in `execution_mode::asynchronous`.
+ * @param registry Data source.
+ * @param aabbs The AABBs.
+ * @param delegate Triggered once with the results of all queries, in the
+ * same order as `aabbs`.
+ * @return Request id, which will be passed to the delegate when it is invoked.
+ */
+query_aabb_id_type query_aabb_batch_async(entt::registry &registry, std::vector<AABB> aabbs,
+                                          const query_aabb_batch_delegate_type &delegate,
+                                          bool query_procedural,
+                                          bool query_non_procedural,
+                                          bool query_islands);
+
 query_aabb_id_type query_aabb_of_interest_async(entt::registry &registry, const AABB &aabb,
                                                 const query_aabb_delegate_type &delegate);
 
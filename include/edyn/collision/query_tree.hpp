@@ -1,8 +1,12 @@
 #ifndef EDYN_COLLISION_QUERY_TREE_HPP
 #define EDYN_COLLISION_QUERY_TREE_HPP
 
+#include <vector>
+#include <utility>
 #include "edyn/comp/aabb.hpp"
 #include "edyn/math/geom.hpp"
+#include "edyn/math/simd.hpp"
+#include "edyn/collision/ray_packet.hpp"
 
 namespace edyn {
 
@@ -33,22 +37,245 @@ void traverse_tree(const Tree &tree, NodeIdType root_id, NodeIdType null_node_id
     }
 }
 
+/**
+ * AABBs of up to `simd_width` tree nodes stored as a structure of arrays so
+ * that they can be tested all at once.
+ */
+struct tree_node_batch {
+    alignas(simd_alignment) scalar min[3][simd_width];
+    alignas(simd_alignment) scalar max[3][simd_width];
+};
+
+/**
+ * @brief Traverses the tree testing `simd_width` nodes at once. Nodes are
+ * taken from the traversal stack in batches and `test_func` is called with
+ * a `tree_node_batch` and must return a bit mask where the bit of each lane
+ * is set if the node in that lane passes the test. Unused lanes contain an
+ * empty AABB at the origin and are ignored. Nodes for which `node_func`
+ * returns false are skipped along with their subtree before being batched.
+ */
+template<typename Tree, typename NodeIdType, typename TestFunc, typename VisitFunc, typename NodeFunc>
+void traverse_tree_batched(const Tree &tree, NodeIdType root_id, NodeIdType null_node_id,
+                           TestFunc test_func, VisitFunc visit_func, NodeFunc node_func) {
+    std::vector<NodeIdType> stack;
+    stack.push_back(root_id);
+
+    tree_node_batch batch;
+    NodeIdType ids[simd_width];
+
+    while (!stack.empty()) {
+        unsigned count = 0;
+
+        while (count < simd_width && !stack.empty()) {
+            auto id = stack.back();
+            stack.pop_back();
+
+            if (id == null_node_id) {
+                continue;
+            }
+
+            auto &node = tree.get_node(id);
+
+            if (!node_func(node)) {
+                continue;
+            }
+
+            for (size_t i = 0; i < 3; ++i) {
+                batch.min[i][count] = node.aabb.min[i];
+                batch.max[i][count] = node.aabb.max[i];
+            }
+
+            ids[count++] = id;
+        }
+
+        if (count == 0) {
+            continue;
+        }
+
+        for (auto lane = count; lane < simd_width; ++lane) {
+            for (size_t i = 0; i < 3; ++i) {
+                batch.min[i][lane] = batch.max[i][lane] = 0;
+            }
+        }
+
+        auto mask = test_func(batch) & ((1u << count) - 1u);
+
+        for (unsigned lane = 0; lane < count; ++lane) {
+            if (!(mask & (1u << lane))) {
+                continue;
+            }
+
+            auto &node = tree.get_node(ids[lane]);
+
+            if (node.leaf()) {
+                visit_func(ids[lane]);
+            } else {
+                stack.push_back(node.child1);
+                stack.push_back(node.child2);
+            }
+        }
+    }
+}
+
+template<typename Tree, typename NodeIdType, typename TestFunc, typename VisitFunc>
+void traverse_tree_batched(const Tree &tree, NodeIdType root_id, NodeIdType null_node_id,
+                           TestFunc test_func, VisitFunc visit_func) {
+    traverse_tree_batched(tree, root_id, null_node_id, test_func, visit_func, [](auto &) { return true; });
+}
+
+/**
+ * @brief Traverses two trees simultaneously and calls `visit_func` with the
+ * ids of each pair of leaves whose AABBs intersect after the AABBs of the
+ * first tree are inset by `inset`. The node with the larger area is
+ * descended first, which keeps the pairs of nodes of similar size.
+ */
+template<typename TreeA, typename TreeB, typename NodeIdType, typename VisitFunc>
+void query_tree_pair(const TreeA &treeA, NodeIdType rootA,
+                     const TreeB &treeB, NodeIdType rootB,
+                     NodeIdType null_node_id, const vector3 &inset,
+                     VisitFunc visit_func) {
+    std::vector<std::pair<NodeIdType, NodeIdType>> stack;
+    stack.emplace_back(rootA, rootB);
+
+    while (!stack.empty()) {
+        auto [idA, idB] = stack.back();
+        stack.pop_back();
+
+        if (idA == null_node_id || idB == null_node_id) {
+            continue;
+        }
+
+        auto &nodeA = treeA.get_node(idA);
+        auto &nodeB = treeB.get_node(idB);
+        auto aabbA = nodeA.aabb.inset(inset);
+
+        if (!intersect(aabbA, nodeB.aabb)) {
+            continue;
+        }
+
+        if (nodeA.leaf() && nodeB.leaf()) {
+            visit_func(idA, idB);
+        } else if (nodeB.leaf() || (!nodeA.leaf() && aabbA.area() > nodeB.aabb.area())) {
+            stack.emplace_back(nodeA.child1, idB);
+            stack.emplace_back(nodeA.child2, idB);
+        } else {
+            stack.emplace_back(idA, nodeB.child1);
+            stack.emplace_back(idA, nodeB.child2);
+        }
+    }
+}
+
+/**
+ * @brief Calls `func` with the id of each leaf whose AABB intersects `aabb`,
+ * skipping the subtrees of the nodes for which `node_func` returns false.
+ */
+template<typename Tree, typename NodeIdType, typename Func, typename NodeFunc>
+void query_tree(const Tree &tree, NodeIdType root_id, NodeIdType null_node_id,
+                const AABB &aabb, Func func, NodeFunc node_func) {
+    const simd_scalar qmin[] = {simd_scalar::splat(aabb.min.x), simd_scalar::splat(aabb.min.y), simd_scalar::splat(aabb.min.z)};
+    const simd_scalar qmax[] = {simd_scalar::splat(aabb.max.x), simd_scalar::splat(aabb.max.y), simd_scalar::splat(aabb.max.z)};
+
+    traverse_tree_batched(tree, root_id, null_node_id, [&](const tree_node_batch &batch) {
+        auto mask = ~0u;
+
+        for (size_t i = 0; i < 3; ++i) {
+            mask &= less_equal_mask(simd_scalar::load(batch.min[i]), qmax[i]);
+            mask &= less_equal_mask(qmin[i], simd_scalar::load(batch.max[i]));
+        }
+
+        return mask;
+    }, func, node_func);
+}
+
 template<typename Tree, typename NodeIdType, typename Func>
 void query_tree(const Tree &tree, NodeIdType root_id, NodeIdType null_node_id,
                 const AABB &aabb, Func func) {
-    traverse_tree(tree, root_id, null_node_id, [&](auto &node) {
-        return intersect(node.aabb, aabb);
-    }, func);
+    query_tree(tree, root_id, null_node_id, aabb, func, [](auto &) { return true; });
 }
 
 template<typename Tree, typename NodeIdType, typename Func>
 void raycast_tree(const Tree &tree, NodeIdType root_id, NodeIdType null_node_id,
                   const vector3 &p0, const vector3 &p1, Func func) {
-    traverse_tree(tree, root_id, null_node_id, [&](auto &node) {
-        return intersect_segment_aabb(p0, p1, node.aabb.min, node.aabb.max);
+    // Same separating axis test as `intersect_segment_aabb`.
+    auto midpoint = (p0 + p1) * scalar(0.5);
+    auto half_length = p1 - midpoint;
+    auto abs_half_length = abs(half_length);
+    auto abs_half_length_eps = abs_half_length + vector3_one * EDYN_EPSILON;
+    auto half = simd_scalar::splat(scalar(0.5));
+
+    traverse_tree_batched(tree, root_id, null_node_id, [&](const tree_node_batch &batch) {
+        simd_scalar m[3], e[3];
+
+        for (size_t i = 0; i < 3; ++i) {
+            auto bmin = simd_scalar::load(batch.min[i]);
+            auto bmax = simd_scalar::load(batch.max[i]);
+            auto center = (bmin + bmax) * half;
+            e[i] = bmax - center;
+            m[i] = simd_scalar::splat(midpoint[i]) - center;
+        }
+
+        auto mask = ~0u;
+
+        // Test coordinate axes.
+        for (size_t i = 0; i < 3; ++i) {
+            mask &= less_equal_mask(abs(m[i]), e[i] + simd_scalar::splat(abs_half_length[i]));
+        }
+
+        // Test cross products of segment direction with coordinate axes.
+        for (size_t i = 0; i < 3; ++i) {
+            auto j = (i + 1) % 3;
+            auto k = (i + 2) % 3;
+            auto dist = abs(m[j] * simd_scalar::splat(half_length[k]) - m[k] * simd_scalar::splat(half_length[j]));
+            auto radius = e[j] * simd_scalar::splat(abs_half_length_eps[k]) +
+                          e[k] * simd_scalar::splat(abs_half_length_eps[j]);
+            mask &= less_equal_mask(dist, radius);
+        }
+
+        return mask;
     }, func);
 }
 
+/**
+ * @brief Traces all segments of a packet through the tree at once and calls
+ * `func` with the id of each leaf intersected by at least one active segment
+ * and the bit mask of those segments. The packet is read again for every
+ * node, thus lanes which `func` clips or terminates through a reference to
+ * the packet are dropped right away.
+ */
+template<typename Tree, typename NodeIdType, typename Func>
+void raycast_tree_packet(const Tree &tree, NodeIdType root_id, NodeIdType null_node_id,
+                         const ray_packet &packet, Func func) {
+    std::vector<NodeIdType> stack;
+    stack.push_back(root_id);
+
+    while (!stack.empty()) {
+        auto id = stack.back();
+        stack.pop_back();
+
+        if (id == null_node_id) {
+            continue;
+        }
+
+        auto &node = tree.get_node(id);
+        auto mask = intersect_ray_packet_aabb(packet, node.aabb);
+
+        if (mask == 0) {
+            continue;
+        }
+
+        if (node.leaf()) {
+            func(id, mask);
+
+            if (packet.active_mask() == 0) {
+                return;
+            }
+        } else {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+}
+
 }
 
 #endif // EDYN_COLLISION_QUERY_TREE_HPP
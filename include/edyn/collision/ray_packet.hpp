@@ -0,0 +1,108 @@
+#ifndef EDYN_COLLISION_RAY_PACKET_HPP
+#define EDYN_COLLISION_RAY_PACKET_HPP
+
+#include <cmath>
+#include "edyn/comp/aabb.hpp"
+#include "edyn/config/config.h"
+#include "edyn/math/simd.hpp"
+#include "edyn/math/vector3.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Up to `simd_width` segments which are traced through a tree at
+ * once, one per lane. Each node is tested against all segments with a single
+ * slab test and its subtree is visited if any of the segments intersects it,
+ * which pays off when the segments are coherent, e.g. a fan of sensor rays
+ * sharing an origin.
+ *
+ * Intersections past the maximum fraction of a lane are ignored. The visitor
+ * of a packet traversal can clip a lane after a hit so that farther nodes
+ * are not visited for it, or terminate a lane once it has found what it
+ * needs. The traversal stops when all lanes are terminated.
+ */
+struct ray_packet {
+    alignas(simd_alignment) scalar origin[3][simd_width];
+    alignas(simd_alignment) scalar inv_dir[3][simd_width];
+    // Fraction along each segment past which intersections are ignored. It
+    // is negative for unused and terminated lanes.
+    alignas(simd_alignment) scalar max_fraction[simd_width];
+    unsigned size {0};
+
+    ray_packet() {
+        for (size_t lane = 0; lane < simd_width; ++lane) {
+            for (size_t i = 0; i < 3; ++i) {
+                origin[i][lane] = inv_dir[i][lane] = 0;
+            }
+
+            max_fraction[lane] = -1;
+        }
+    }
+
+    /**
+     * @brief Assigns the segment [p0, p1] to the next lane.
+     * @return The lane.
+     */
+    unsigned add(const vector3 &p0, const vector3 &p1) {
+        EDYN_ASSERT(size < simd_width);
+        auto lane = size++;
+        auto dir = p1 - p0;
+
+        for (size_t i = 0; i < 3; ++i) {
+            origin[i][lane] = p0[i];
+            // Nearly parallel to a slab. This keeps NaNs out of the slab test
+            // and only rejects the slab if the origin is outside of it.
+            inv_dir[i][lane] = std::abs(dir[i]) > EDYN_EPSILON ?
+                scalar(1) / dir[i] : std::copysign(scalar(1) / EDYN_EPSILON, dir[i]);
+        }
+
+        max_fraction[lane] = 1;
+
+        return lane;
+    }
+
+    bool full() const {
+        return size == simd_width;
+    }
+
+    // Ignores intersections farther than `fraction` in a lane.
+    void clip(unsigned lane, scalar fraction) {
+        if (fraction < max_fraction[lane]) {
+            max_fraction[lane] = fraction;
+        }
+    }
+
+    void terminate(unsigned lane) {
+        max_fraction[lane] = -1;
+    }
+
+    // Bit mask of the lanes which are still traced.
+    unsigned active_mask() const {
+        return less_equal_mask(simd_scalar::splat(0), simd_scalar::load(max_fraction));
+    }
+};
+
+/**
+ * @brief Tests all segments of a packet against an AABB which is inflated by
+ * `EDYN_EPSILON` to keep the test conservative.
+ * @return Bit mask of the active lanes whose segment intersects the AABB.
+ */
+inline unsigned intersect_ray_packet_aabb(const ray_packet &packet, const AABB &aabb) {
+    auto tmin = simd_scalar::splat(0);
+    auto tmax = simd_scalar::load(packet.max_fraction);
+
+    for (size_t i = 0; i < 3; ++i) {
+        auto o = simd_scalar::load(packet.origin[i]);
+        auto inv = simd_scalar::load(packet.inv_dir[i]);
+        auto t0 = (simd_scalar::splat(aabb.min[i] - EDYN_EPSILON) - o) * inv;
+        auto t1 = (simd_scalar::splat(aabb.max[i] + EDYN_EPSILON) - o) * inv;
+        tmin = max(tmin, min(t0, t1));
+        tmax = min(tmax, max(t0, t1));
+    }
+
+    return less_equal_mask(tmin, tmax);
+}
+
+}
+
+#endif // EDYN_COLLISION_RAY_PACKET_HPP
@@ -16,6 +16,7 @@
 #include "edyn/collision/broadphase.hpp"
 #include "edyn/shapes/shapes.hpp"
 #include "edyn/util/vector_util.hpp"
+#include "edyn/parallel/query_future.hpp"
 
 namespace edyn {
 
@@ -26,6 +27,7 @@ struct compound_shape;
 struct plane_shape;
 struct mesh_shape;
 struct paged_mesh_shape;
+struct heightfield_shape;
 
 /**
  * @brief Info provided when raycasting a box.
@@ -81,6 +83,17 @@ struct paged_mesh_raycast_info {
     size_t triangle_index;
 };
 
+/**
+ * @brief Info provided when raycasting a heightfield.
+ */
+struct heightfield_raycast_info {
+    // Column and row of the first sample of the intersected cell.
+    uint32_t column;
+    uint32_t row;
+    // Index of intersected triangle. See `heightfield`.
+    size_t triangle_index;
+};
+
 /**
  * @brief Info provided when raycasting a compound.
  */
@@ -116,7 +129,8 @@ struct shape_raycast_result {
         polyhedron_raycast_info,
         compound_raycast_info,
         mesh_raycast_info,
-        paged_mesh_raycast_info
+        paged_mesh_raycast_info,
+        heightfield_raycast_info
     > info_var;
 };
 
@@ -148,16 +162,34 @@ struct raycast_context {
     vector3 p0;
     // Second point in the ray.
     vector3 p1;
+    // Whether any intersection is enough, in which case the shape can stop
+    // looking once it finds one, which is not necessarily the closest. Useful
+    // for line of sight queries.
+    bool any_hit {false};
+};
+
+/**
+ * @brief A ray in a batch of raycasts.
+ */
+struct raycast_query {
+    // First point in the ray.
+    vector3 p0;
+    // Second point in the ray.
+    vector3 p1;
 };
 
 using raycast_id_type = unsigned;
 static constexpr auto invalid_raycast_id = std::numeric_limits<raycast_id_type>::max();
 using raycast_delegate_type = entt::delegate<void(raycast_id_type, const raycast_result &, vector3, vector3)>;
+// Receives the results of a batch of raycasts in the same order as the rays.
+using raycast_batch_delegate_type = entt::delegate<void(raycast_id_type, const std::vector<raycast_result> &)>;
 
 /**
  * @brief Performs a raycast against all rigid bodies. Do not call this if Edyn
  * was initialized with `execution_mode::asynchronous`, use `raycast_async`
- * instead.
+ * instead, unless `edyn::settings::publish_broadphase` is enabled, in which
+ * case the ray is cast immediately against the last state published by the
+ * simulation worker.
  * @param registry Data source.
  * @param p0 First point in the ray.
  * @param p1 Second point in the ray.
@@ -167,6 +199,23 @@ using raycast_delegate_type = entt::delegate<void(raycast_id_type, const raycast
 raycast_result raycast(entt::registry &registry, vector3 p0, vector3 p1,
                        const std::vector<entt::entity> &ignore_entities = {});
 
+/**
+ * @brief Checks whether the ray hits any rigid body. This is cheaper than
+ * `raycast` since it stops at the first intersection it finds instead of
+ * searching for the closest, which makes it suitable for line of sight
+ * queries. Do not call this if Edyn was initialized with
+ * `execution_mode::asynchronous`, unless `edyn::settings::publish_broadphase`
+ * is enabled.
+ * @param registry Data source.
+ * @param p0 First point in the ray.
+ * @param p1 Second point in the ray.
+ * @param ignore_entities Entities to be ignored during raycast.
+ * @return Result containing an entity that was hit by the ray, which is not
+ * necessarily the first along the ray.
+ */
+raycast_result raycast_any(entt::registry &registry, vector3 p0, vector3 p1,
+                           const std::vector<entt::entity> &ignore_entities = {});
+
 /**
  * @brief Performs a raycast query asynchronously. Only call this function if
  * Edyn was initialized in `execution_mode::asynchronous`.
@@ -181,6 +230,42 @@ raycast_id_type raycast_async(entt::registry &registry, vector3 p0, vector3 p1,
                               const raycast_delegate_type &delegate,
                               const std::vector<entt::entity> &ignore_entities = {});
 
+/**
+ * @brief Performs a raycast asynchronously and returns a future which is
+ * resolved as soon as the simulation worker is done with it, which can be in
+ * the middle of a frame, instead of invoking a delegate in the next update.
+ * The future must be taken in the main thread, where the hit entity is mapped
+ * into the main registry, and before Edyn is detached. Only call this function
+ * if Edyn was initialized in `execution_mode::asynchronous`.
+ * @param registry Data source.
+ * @param p0 First point in the ray.
+ * @param p1 Second point in the ray.
+ * @param ignore_entities Entities to be ignored.
+ * @return Future holding the raycast result.
+ */
+query_future<raycast_result> raycast_async_future(entt::registry &registry, vector3 p0, vector3 p1,
+                                                  const std::vector<entt::entity> &ignore_entities = {});
+
+/**
+ * @brief Performs many raycasts asynchronously, which are sent to the
+ * simulation worker in one message and whose results come back in one
+ * message. This is much cheaper than calling `raycast_async` for each ray
+ * when there are many of them. Only call this function if Edyn was
+ * initialized in `execution_mode::asynchronous`.
+ * @param registry Data source.
+ * @param rays The rays.
+ * @param delegate Triggered once with the results of all rays, in the same
+ * order as `rays`.
+ * @param ignore_entities Entities to be ignored by all rays.
+ * @param any_hit Whether any intersection is enough instead of the closest,
+ * as in `raycast_any`, which is cheaper for line of sight checks.
+ * @return Request id, which will be passed to the delegate when it is invoked.
+ */
+raycast_id_type raycast_batch_async(entt::registry &registry, std::vector<raycast_query> rays,
+                                    const raycast_batch_delegate_type &delegate,
+                                    const std::vector<entt::entity> &ignore_entities = {},
+                                    bool any_hit = false);
+
 // Raycast functions for each shape.
 
 shape_raycast_result shape_raycast(const box_shape &, const raycast_context &);
@@ -192,6 +277,7 @@ shape_raycast_result shape_raycast(const compound_shape &, const raycast_context
 shape_raycast_result shape_raycast(const plane_shape &, const raycast_context &);
 shape_raycast_result shape_raycast(const mesh_shape &, const raycast_context &);
 shape_raycast_result shape_raycast(const paged_mesh_shape &, const raycast_context &);
+shape_raycast_result shape_raycast(const heightfield_shape &, const raycast_context &);
 
 }
 
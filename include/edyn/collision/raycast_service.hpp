@@ -2,18 +2,31 @@
 #define EDYN_COLLISION_RAYCAST_SERVICE_HPP
 
 #include "edyn/collision/raycast.hpp"
+#include "edyn/collision/overlap.hpp"
+#include "edyn/collision/shape_cast.hpp"
 #include "edyn/math/vector3.hpp"
+#include "edyn/parallel/task_graph.hpp"
 #include <entt/entity/fwd.hpp>
+#include <limits>
 #include <unordered_map>
 
 namespace edyn {
 
 class raycast_service {
+    static constexpr auto no_batch = std::numeric_limits<size_t>::max();
+
     struct broadphase_context {
         unsigned id;
         vector3 p0, p1;
         std::vector<entt::entity> ignore_entities;
         std::vector<entt::entity> candidates;
+        // Closest hit among candidates when running the task graph.
+        shape_raycast_result result;
+        entt::entity entity {entt::null};
+        // Index of the batch the ray belongs to, in which case `id` is the
+        // index of the ray in the batch.
+        size_t batch {no_batch};
+        bool any_hit {false};
     };
 
     struct narrowphase_context {
@@ -21,12 +34,100 @@ class raycast_service {
         vector3 p0, p1;
         entt::entity entity;
         shape_raycast_result result;
+        size_t batch {no_batch};
+        bool any_hit {false};
+    };
+
+    struct batch_context {
+        unsigned id;
+        // Shared by all rays in the batch.
+        std::vector<entt::entity> ignore_entities;
+        std::vector<raycast_result> results;
+    };
+
+    // Shape casts go through the same stages as rays. They always belong to
+    // a batch, which holds a single cast for individual requests.
+    struct cast_broadphase_context {
+        unsigned id;
+        size_t batch;
+        shape_cast_query query;
+        std::vector<entt::entity> candidates;
+    };
+
+    struct cast_narrowphase_context {
+        unsigned id;
+        size_t batch;
+        shape_cast_query query;
+        entt::entity entity;
+        shape_cast_result result;
     };
 
+    struct cast_batch_context {
+        unsigned id;
+        std::vector<entt::entity> ignore_entities;
+        std::vector<shape_cast_result> results;
+    };
+
+    // Overlap queries are batched in the same manner as shape casts.
+    struct overlap_broadphase_context {
+        unsigned id;
+        size_t batch;
+        overlap_query query;
+        std::vector<entt::entity> candidates;
+    };
+
+    struct overlap_narrowphase_context {
+        unsigned id;
+        size_t batch;
+        overlap_query query;
+        entt::entity entity;
+        overlap_hit hit;
+    };
+
+    struct overlap_batch_context {
+        unsigned id;
+        std::vector<entt::entity> ignore_entities;
+        std::vector<overlap_result> results;
+    };
+
+    // Consecutive rays of the same batch, which are queried in the
+    // broadphase together as a `ray_packet`.
+    struct packet_range {
+        size_t first;
+        size_t count;
+    };
+
+    bool is_ignored(const broadphase_context &, entt::entity) const;
+    raycast_result & get_result(unsigned id, size_t batch);
+
+    void make_packets();
     void run_broadphase(bool mt);
     void run_narrowphase(bool mt);
     void finish_broadphase();
     void finish_narrowphase();
+    void update_rays(bool mt);
+
+    void run_cast_broadphase(bool mt);
+    void finish_cast_broadphase();
+    void run_cast_narrowphase(bool mt);
+    void finish_cast_narrowphase();
+    void update_shape_casts(bool mt);
+
+    void run_overlap_broadphase(bool mt);
+    void finish_overlap_broadphase();
+    void run_overlap_narrowphase(bool mt);
+    void finish_overlap_narrowphase();
+    void update_overlaps(bool mt);
+
+    // Each packet gets a task for the broadphase query followed by a task
+    // per ray that raycasts its candidates, which starts as soon as the query
+    // of that packet is done instead of waiting for the queries of all rays.
+    void run_task_graph();
+    void query_broadphase(broadphase_context &);
+    void query_broadphase(const packet_range &);
+    void raycast_candidates(broadphase_context &);
+    static void query_broadphase_job(job::data_type &);
+    static void raycast_candidates_job(job::data_type &);
 
 public:
     raycast_service(entt::registry &registry);
@@ -35,6 +136,35 @@ public:
         m_broad_ctx.push_back(broadphase_context{id, p0, p1, ignore_entities});
     }
 
+    /**
+     * @brief Adds a batch of rays whose results are delivered together.
+     * @param rays The rays.
+     * @param id Batch id given back in `consume_batch_results`.
+     * @param ignore_entities Entities ignored by all rays.
+     * @param any_hit Whether any hit is enough, e.g. for line of sight.
+     */
+    void add_ray_batch(const std::vector<raycast_query> &rays, unsigned id,
+                       std::vector<entt::entity> ignore_entities, bool any_hit);
+
+    /**
+     * @brief Adds a batch of shape casts whose results are delivered together.
+     * @param queries The shape casts.
+     * @param id Batch id given back in `consume_shape_cast_results`.
+     * @param ignore_entities Entities ignored by all shape casts.
+     */
+    void add_shape_cast_batch(const std::vector<shape_cast_query> &queries, unsigned id,
+                              std::vector<entt::entity> ignore_entities);
+
+    /**
+     * @brief Adds a batch of overlap queries whose results are delivered
+     * together.
+     * @param queries The overlap queries.
+     * @param id Batch id given back in `consume_overlap_results`.
+     * @param ignore_entities Entities ignored by all queries.
+     */
+    void add_overlap_batch(const std::vector<overlap_query> &queries, unsigned id,
+                           std::vector<entt::entity> ignore_entities);
+
     void update(bool mt);
 
     template<typename Func>
@@ -45,12 +175,65 @@ public:
         m_results.clear();
     }
 
+    /**
+     * @brief Invokes the function with the id and results of each batch,
+     * which are in the same order as the rays.
+     * @param func Callable with signature
+     * `void(unsigned id, std::vector<raycast_result> &results)`.
+     */
+    template<typename Func>
+    void consume_batch_results(Func func) {
+        for (auto &batch : m_batches) {
+            func(batch.id, batch.results);
+        }
+        m_batches.clear();
+    }
+
+    /**
+     * @brief Invokes the function with the id and results of each batch of
+     * shape casts, which are in the same order as the queries.
+     * @param func Callable with signature
+     * `void(unsigned id, std::vector<shape_cast_result> &results)`.
+     */
+    template<typename Func>
+    void consume_shape_cast_results(Func func) {
+        for (auto &batch : m_cast_batches) {
+            func(batch.id, batch.results);
+        }
+        m_cast_batches.clear();
+    }
+
+    /**
+     * @brief Invokes the function with the id and results of each batch of
+     * overlap queries, which are in the same order as the queries.
+     * @param func Callable with signature
+     * `void(unsigned id, std::vector<overlap_result> &results)`.
+     */
+    template<typename Func>
+    void consume_overlap_results(Func func) {
+        for (auto &batch : m_overlap_batches) {
+            func(batch.id, batch.results);
+        }
+        m_overlap_batches.clear();
+    }
+
 private:
     entt::registry *m_registry;
 
     std::vector<broadphase_context> m_broad_ctx;
     std::vector<narrowphase_context> m_narrow_ctx;
     std::unordered_map<unsigned, raycast_result> m_results;
+    std::vector<batch_context> m_batches;
+    std::vector<packet_range> m_packets;
+    task_graph m_graph;
+
+    std::vector<cast_broadphase_context> m_cast_broad_ctx;
+    std::vector<cast_narrowphase_context> m_cast_narrow_ctx;
+    std::vector<cast_batch_context> m_cast_batches;
+
+    std::vector<overlap_broadphase_context> m_overlap_broad_ctx;
+    std::vector<overlap_narrowphase_context> m_overlap_narrow_ctx;
+    std::vector<overlap_batch_context> m_overlap_batches;
 
     size_t m_max_raycast_broadphase_sequential_size {4};
     size_t m_max_raycast_narrowphase_sequential_size {4};
@@ -0,0 +1,60 @@
+#ifndef EDYN_COLLISION_SENSOR_HPP
+#define EDYN_COLLISION_SENSOR_HPP
+
+#include <vector>
+#include <cstdint>
+#include <entt/entity/fwd.hpp>
+#include <entt/entity/entity.hpp>
+
+namespace edyn {
+
+enum class sensor_event_type : uint8_t {
+    // Another rigid body started overlapping the sensor.
+    enter,
+    // A rigid body that overlapped the sensor stopped overlapping it, was
+    // disabled or destroyed.
+    exit
+};
+
+/**
+ * @brief A rigid body entering or exiting a sensor.
+ */
+struct sensor_event {
+    entt::entity sensor {entt::null};
+    entt::entity other {entt::null};
+    sensor_event_type type;
+};
+
+/**
+ * @brief Sensor events generated since the last update, in the order they
+ * happened.
+ */
+struct sensor_event_buffer {
+    std::vector<sensor_event> events;
+};
+
+/**
+ * @brief Get the sensor events generated during the last call to
+ * `edyn::update` or `edyn::step_simulation`. In asynchronous mode, they're
+ * generated in the simulation worker and sent to the main registry along
+ * with the step updates, thus they become available in a later call to
+ * `edyn::update`, and events of entities which were destroyed in the main
+ * registry in the meantime are dropped.
+ * @param registry Data source.
+ * @return The sensor events.
+ */
+const std::vector<sensor_event> & get_sensor_events(const entt::registry &registry);
+
+}
+
+namespace edyn::internal {
+
+/**
+ * @brief Checks whether the shapes of two rigid bodies intersect using the
+ * collision function of the pair of shapes.
+ */
+bool sensor_shapes_intersect(entt::registry &registry, entt::entity sensor, entt::entity other);
+
+}
+
+#endif // EDYN_COLLISION_SENSOR_HPP
@@ -0,0 +1,71 @@
+#ifndef EDYN_COLLISION_SEPARATING_AXIS_CACHE_HPP
+#define EDYN_COLLISION_SEPARATING_AXIS_CACHE_HPP
+
+#include <cmath>
+#include <cstdint>
+#include "edyn/math/vector3.hpp"
+#include "edyn/math/quaternion.hpp"
+#include "edyn/config/constants.hpp"
+#include "edyn/collision/gjk.hpp"
+
+namespace edyn {
+
+/**
+ * @brief The feature that generated the separating axis with the greatest
+ * distance in the last full SAT run between a pair of convex shapes, and the
+ * relative transform of the shapes at the time. Testing this axis first lets
+ * separated pairs be rejected right away and resting pairs skip the search.
+ */
+struct separating_axis_cache {
+    enum class axis_type : uint8_t {
+        none,
+        // Face normal of A. `indexA` is the face index.
+        faceA,
+        // Face normal of B. `indexB` is the face index.
+        faceB,
+        // Cross product of an edge of A and an edge of B.
+        edge
+    };
+
+    axis_type type {axis_type::none};
+    uint32_t indexA;
+    uint32_t indexB;
+
+    // Position and orientation of B in the space of A.
+    vector3 posB;
+    quaternion ornB;
+
+    // Support vertices of polyhedrons found in the last step. The hill
+    // climbing in the support functions starts at these vertices, which are
+    // usually at or next to the new support vertices. They're still useful
+    // after the axis is cleared.
+    uint32_t support_vertexA {0};
+    uint32_t support_vertexB {0};
+
+    // Simplex of the last GJK run between the shapes, used as the starting
+    // point of the next one.
+    gjk_simplex simplex;
+
+    void clear() {
+        type = axis_type::none;
+    }
+
+    // Stores the relative transform the axis was found with.
+    void set_transform(const vector3 &pos, const quaternion &orn) {
+        posB = pos;
+        ornB = orn;
+    }
+
+    // Whether the given relative transform is close enough to the one stored
+    // for the cached axis to be used as the result of the SAT.
+    bool transform_matches(const vector3 &pos, const quaternion &orn) const {
+        constexpr auto pos_tolerance_sqr = separating_axis_cache_position_tolerance *
+                                           separating_axis_cache_position_tolerance;
+        return length_sqr(pos - posB) < pos_tolerance_sqr &&
+               std::abs(dot(orn, ornB)) > scalar(1) - separating_axis_cache_orientation_tolerance;
+    }
+};
+
+}
+
+#endif // EDYN_COLLISION_SEPARATING_AXIS_CACHE_HPP
@@ -0,0 +1,138 @@
+#ifndef EDYN_COLLISION_SHAPE_CAST_HPP
+#define EDYN_COLLISION_SHAPE_CAST_HPP
+
+#include <variant>
+#include <vector>
+#include <entt/entity/fwd.hpp>
+#include <entt/entity/entity.hpp>
+#include <entt/signal/delegate.hpp>
+#include "edyn/math/vector3.hpp"
+#include "edyn/math/quaternion.hpp"
+#include "edyn/shapes/sphere_shape.hpp"
+#include "edyn/shapes/capsule_shape.hpp"
+#include "edyn/shapes/box_shape.hpp"
+
+namespace edyn {
+
+// Shapes which can be swept in a shape cast.
+using shape_cast_shape_t = std::variant<sphere_shape, capsule_shape, box_shape>;
+
+/**
+ * @brief A shape swept along a segment without rotating, e.g. the capsule of
+ * a character controller or a thick projectile.
+ */
+struct shape_cast_query {
+    shape_cast_shape_t shape;
+    // Orientation of the shape along the whole sweep.
+    quaternion orn {quaternion_identity};
+    // Position of the shape at the start of the sweep.
+    vector3 p0;
+    // Position of the shape at the end of the sweep.
+    vector3 p1;
+};
+
+/**
+ * @brief Information returned from a shape cast.
+ */
+struct shape_cast_result {
+    // Fraction of the sweep where the shape first touches another. The
+    // position of the shape is `lerp(p0, p1, fraction)` at that moment. It
+    // is zero if the shape intersects another at the start.
+    scalar fraction {EDYN_SCALAR_MAX};
+    // Normal at the contact, pointing towards the swept shape.
+    vector3 normal;
+    // Contact point on the surface of the entity that was hit, in world
+    // space.
+    vector3 point;
+    // The entity that was hit. It's set to `entt::null` if no entity is hit.
+    entt::entity entity {entt::null};
+};
+
+/**
+ * @brief Input for a shape cast against a single shape.
+ */
+struct shape_cast_context {
+    // Position of the shape that is hit.
+    vector3 pos;
+    // Orientation of the shape that is hit.
+    quaternion orn;
+    // The swept shape.
+    shape_cast_query query;
+};
+
+using shape_cast_id_type = unsigned;
+using shape_cast_delegate_type = entt::delegate<void(shape_cast_id_type, const shape_cast_result &)>;
+// Receives the results of a batch of shape casts in the same order as the
+// queries.
+using shape_cast_batch_delegate_type = entt::delegate<void(shape_cast_id_type, const std::vector<shape_cast_result> &)>;
+
+/**
+ * @brief Sweeps a shape against all rigid bodies and finds the first one it
+ * touches. Do not call this if Edyn was initialized with
+ * `execution_mode::asynchronous`, use `shape_cast_async` instead.
+ * @param registry Data source.
+ * @param query The shape and the segment it is swept along.
+ * @param ignore_entities Entities to be ignored.
+ * @return Result containing the first entity that was hit.
+ */
+shape_cast_result shape_cast(entt::registry &registry, const shape_cast_query &query,
+                             const std::vector<entt::entity> &ignore_entities = {});
+
+/**
+ * @brief Performs many shape casts at once, in parallel in worker threads if
+ * Edyn was initialized with `execution_mode::sequential_multithreaded`. Do
+ * not call this if Edyn was initialized with `execution_mode::asynchronous`.
+ * @param registry Data source.
+ * @param queries The shape casts.
+ * @param ignore_entities Entities to be ignored by all shape casts.
+ * @return The results, in the same order as `queries`.
+ */
+std::vector<shape_cast_result> shape_cast_batch(entt::registry &registry,
+                                                const std::vector<shape_cast_query> &queries,
+                                                const std::vector<entt::entity> &ignore_entities = {});
+
+/**
+ * @brief Performs a shape cast asynchronously. Only call this function if
+ * Edyn was initialized in `execution_mode::asynchronous`.
+ * @param registry Data source.
+ * @param query The shape and the segment it is swept along.
+ * @param delegate Triggered when the result is available.
+ * @param ignore_entities Entities to be ignored.
+ * @return Request id, which will be passed to the delegate when it is invoked.
+ */
+shape_cast_id_type shape_cast_async(entt::registry &registry, const shape_cast_query &query,
+                                    const shape_cast_delegate_type &delegate,
+                                    const std::vector<entt::entity> &ignore_entities = {});
+
+/**
+ * @brief Performs many shape casts asynchronously, which are sent to the
+ * simulation worker in one message and whose results come back in one
+ * message. Only call this function if Edyn was initialized in
+ * `execution_mode::asynchronous`.
+ * @param registry Data source.
+ * @param queries The shape casts.
+ * @param delegate Triggered once with the results of all shape casts, in the
+ * same order as `queries`.
+ * @param ignore_entities Entities to be ignored by all shape casts.
+ * @return Request id, which will be passed to the delegate when it is invoked.
+ */
+shape_cast_id_type shape_cast_batch_async(entt::registry &registry, std::vector<shape_cast_query> queries,
+                                          const shape_cast_batch_delegate_type &delegate,
+                                          const std::vector<entt::entity> &ignore_entities = {});
+
+/**
+ * @brief Sweeps the shape of a query against a single shape by conservative
+ * advancement, i.e. it's moved forward by as much as it can move without
+ * touching the other shape according to their distance, until they touch.
+ * Available for all types in `shapes_tuple`. The entity of the result is not
+ * set.
+ * @param shape The shape that is hit.
+ * @param ctx The placement of the shape and the query.
+ * @return The result.
+ */
+template<typename Shape>
+shape_cast_result shape_cast(const Shape &shape, const shape_cast_context &ctx);
+
+}
+
+#endif // EDYN_COLLISION_SHAPE_CAST_HPP
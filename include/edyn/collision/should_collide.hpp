@@ -8,6 +8,13 @@ namespace edyn {
 bool should_collide_default(const entt::registry &, entt::entity, entt::entity);
 using should_collide_func_t = decltype(&should_collide_default);
 
+/**
+ * @brief Checks whether either entity lists the other in its
+ * `edyn::collision_exclusion`. This is the part of `should_collide_default`
+ * which is not a test of collision groups and masks.
+ */
+bool is_collision_excluded(const entt::registry &, entt::entity, entt::entity);
+
 /**
  * @brief Overrides the default collision filtering function, which checks
  * collision groups and masks. Remember to return false if both entities
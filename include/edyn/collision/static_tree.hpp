@@ -6,7 +6,9 @@
 #include <iterator>
 #include <numeric>
 #include <algorithm>
+#include "edyn/core/mapped_vector.hpp"
 #include "edyn/collision/query_tree.hpp"
+#include "edyn/context/task.hpp"
 
 namespace edyn {
 
@@ -40,6 +42,14 @@ namespace detail {
 
         return ids_begin + std::distance(ids_begin, ids_end) / 2;
     }
+
+    // Leaf node created by `static_tree::build_sah` and its range of object
+    // ids.
+    struct static_tree_leaf_range {
+        uint32_t node;
+        uint32_t first;
+        uint32_t last;
+    };
 }
 
 class static_tree {
@@ -57,6 +67,20 @@ public:
         }
     };
 
+    /**
+     * Quality metrics of the tree calculated after it is built.
+     */
+    struct build_stats {
+        // Surface area heuristic cost of the tree, assuming unit cost for
+        // traversing a node and for testing an object, and the probability
+        // of visiting a node being its area relative to the root area.
+        scalar sah_cost {0};
+        // Number of edges between the root and the deepest leaf.
+        uint32_t max_depth {0};
+        uint32_t num_nodes {0};
+        uint32_t num_leaves {0};
+    };
+
     AABB root_aabb() const {
         EDYN_ASSERT(!m_nodes.empty());
         return m_nodes.front().aabb;
@@ -76,6 +100,11 @@ public:
     template<typename Func>
     void raycast(vector3 p0, vector3 p1, Func func) const;
 
+    // Func takes the node index and the bit mask of the lanes of the packet
+    // whose segment intersects the node.
+    template<typename Func>
+    void raycast(const ray_packet &packet, Func func) const;
+
     template<typename Iterator, typename Func>
     void build(Iterator aabb_begin, Iterator aabb_end, Func &report_leaf, uint32_t max_obj_per_leaf = 1) {
         EDYN_ASSERT(aabb_begin != aabb_end);
@@ -87,8 +116,64 @@ public:
         // Insert root node.
         m_nodes.emplace_back();
 
+        // Record the size of the leaves for the build stats.
+        std::vector<uint32_t> leaf_sizes;
+        auto report = [&](tree_node &node, auto ids_begin, auto ids_end) {
+            auto node_idx = static_cast<size_t>(&node - m_nodes.data());
+
+            if (leaf_sizes.size() <= node_idx) {
+                leaf_sizes.resize(node_idx + 1);
+            }
+
+            leaf_sizes[node_idx] = static_cast<uint32_t>(std::distance(ids_begin, ids_end));
+            report_leaf(node, ids_begin, ids_end);
+        };
+
         recurse_build(aabb_begin, aabb_end, ids.begin(), ids.end(),
-                      0, report_leaf, max_obj_per_leaf);
+                      0, report, max_obj_per_leaf);
+
+        leaf_sizes.resize(m_nodes.size());
+        update_build_stats(leaf_sizes);
+    }
+
+    /**
+     * @brief Builds the tree using the surface area heuristic (SAH) with
+     * binning, which yields a tree of better quality than `build` in less
+     * time, i.e. O(n log n). The subtrees are built in parallel if
+     * `enqueue_task_wait` is provided.
+     * @param aabb_begin Iterator to the first AABB. Object ids are the indices
+     * of the AABBs in the range.
+     * @param aabb_end Past-the-end iterator.
+     * @param report_leaf Function called once for each leaf with the node and
+     * the range of object ids in it. Always called from the calling thread.
+     * @param max_obj_per_leaf Maximum number of objects per leaf.
+     * @param enqueue_task_wait Function used to run tasks in parallel.
+     */
+    template<typename Iterator, typename Func>
+    void build_sah(Iterator aabb_begin, Iterator aabb_end, Func &report_leaf,
+                   uint32_t max_obj_per_leaf = 1, enqueue_task_wait_t *enqueue_task_wait = nullptr) {
+        EDYN_ASSERT(aabb_begin != aabb_end);
+        EDYN_ASSERT(max_obj_per_leaf > 0);
+
+        auto aabbs = std::vector<AABB>(aabb_begin, aabb_end);
+        std::vector<uint32_t> ids(aabbs.size());
+        std::iota(ids.begin(), ids.end(), 0);
+
+        std::vector<detail::static_tree_leaf_range> leaves;
+        build_sah_nodes(aabbs, ids, max_obj_per_leaf, enqueue_task_wait, leaves);
+
+        std::vector<uint32_t> leaf_sizes(m_nodes.size());
+
+        for (auto &leaf : leaves) {
+            leaf_sizes[leaf.node] = leaf.last - leaf.first;
+            report_leaf(m_nodes[leaf.node], ids.begin() + leaf.first, ids.begin() + leaf.last);
+        }
+
+        update_build_stats(leaf_sizes);
+    }
+
+    const build_stats & get_build_stats() const {
+        return m_build_stats;
     }
 
     template<typename Iterator_AABB, typename Iterator_ids, typename Func>
@@ -133,6 +218,7 @@ public:
 
     void clear() {
         m_nodes.clear();
+        m_build_stats = {};
     }
 
     template<typename Archive>
@@ -140,7 +226,13 @@ public:
     friend size_t serialization_sizeof(const static_tree &tree);
 
 private:
-    std::vector<tree_node> m_nodes;
+    void build_sah_nodes(const std::vector<AABB> &aabbs, std::vector<uint32_t> &ids,
+                         uint32_t max_obj_per_leaf, enqueue_task_wait_t *enqueue_task_wait,
+                         std::vector<detail::static_tree_leaf_range> &leaves);
+    void update_build_stats(const std::vector<uint32_t> &leaf_sizes);
+
+    mapped_vector<tree_node> m_nodes;
+    build_stats m_build_stats;
 };
 
 template<typename Func>
@@ -155,6 +247,12 @@ void static_tree::raycast(vector3 p0, vector3 p1, Func func) const {
     raycast_tree(*this, root_node_idx, EDYN_NULL_NODE, p0, p1, func);
 }
 
+template<typename Func>
+void static_tree::raycast(const ray_packet &packet, Func func) const {
+    uint32_t root_node_idx = 0;
+    raycast_tree_packet(*this, root_node_idx, EDYN_NULL_NODE, packet, func);
+}
+
 }
 
 #endif // EDYN_COLLISION_STATIC_TREE_HPP
@@ -0,0 +1,207 @@
+#ifndef EDYN_COLLISION_SWEEP_AND_PRUNE_HPP
+#define EDYN_COLLISION_SWEEP_AND_PRUNE_HPP
+
+#include <vector>
+#include <cstdint>
+#include <entt/entity/entity.hpp>
+#include "edyn/comp/aabb.hpp"
+#include "edyn/comp/collision_filter.hpp"
+#include "edyn/math/simd.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Sort-and-sweep broad-phase which keeps the AABBs of a set of
+ * entities sorted by their minimum along one axis and sweeps over them to
+ * find overlapping pairs. The order is kept from one update to the next and
+ * restored with an insertion sort, which takes linear time when the entities
+ * move coherently, e.g. a large number of cars or crates on a conveyor.
+ *
+ * The bounds are stored in sorted order as blocks of `simd_width` lanes,
+ * thus the sweep tests `simd_width` candidates at once on all three axes.
+ * The sweep axis is the axis along which the centers of the AABBs are the
+ * most spread out, which is chosen again whenever the number of entities
+ * doubles.
+ */
+class sweep_and_prune final {
+    struct block {
+        alignas(simd_alignment) scalar min[3][simd_width];
+        alignas(simd_alignment) scalar max[3][simd_width];
+    };
+
+    // The axis is not chosen until there are at least this many entities.
+    static constexpr size_t min_axis_choice_size = 64;
+
+public:
+    /**
+     * @brief Adds an entity, which is considered to have moved.
+     * @param entity The entity.
+     * @param aabb Its AABB.
+     * @param filter Its collision filter.
+     */
+    void insert(entt::entity, const AABB &, const collision_filter & = {});
+
+    /**
+     * @brief Removes an entity. It is moved out of the sorted arrays in the
+     * next call to `sort`.
+     * @param entity The entity.
+     */
+    void erase(entt::entity);
+
+    bool contains(entt::entity) const;
+
+    /**
+     * @brief Changes the AABB of an entity and marks it as moved. Call
+     * `sort` before finding pairs.
+     * @param entity The entity.
+     * @param aabb The new AABB.
+     */
+    void set_aabb(entt::entity, const AABB &);
+
+    /**
+     * @brief Changes the collision filter of an entity and marks it as moved.
+     * @param entity The entity.
+     * @param filter The new collision filter.
+     */
+    void set_filter(entt::entity, const collision_filter &);
+
+    /**
+     * @brief Restores the order after AABBs changed and entities were
+     * inserted or erased.
+     */
+    void sort();
+
+    /**
+     * @brief Calls `func` once for each pair of entities whose AABBs
+     * intersect where at least one of them moved since the last call to
+     * `clear_moved`. Must be called after `sort`.
+     * @param use_filters Whether to skip pairs whose collision filters do
+     * not accept each other.
+     * @param func Function with signature `void(entt::entity, entt::entity)`.
+     */
+    template<typename Func>
+    void find_pairs(bool use_filters, Func func) const;
+
+    void clear_moved();
+
+    /**
+     * @brief Translates all AABBs, i.e. subtracts `offset` from them, which
+     * keeps their order.
+     * @param offset The new origin in the current coordinates.
+     */
+    void shift_origin(const vector3 &offset);
+
+    void clear();
+
+    size_t size() const {
+        return m_entities.size() - m_num_erased;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    unsigned axis() const {
+        return m_axis;
+    }
+
+    size_t num_bytes() const {
+        return m_blocks.capacity() * sizeof(block) +
+               m_entities.capacity() * sizeof(entt::entity) +
+               m_filters.capacity() * sizeof(collision_filter) +
+               m_moved.capacity() * sizeof(uint8_t) +
+               m_sparse.capacity() * sizeof(uint32_t);
+    }
+
+private:
+    scalar get_min(size_t index, unsigned axis) const {
+        return m_blocks[index / simd_width].min[axis][index % simd_width];
+    }
+
+    AABB get_aabb(size_t index) const;
+    void set_bounds(size_t index, const AABB &);
+    void set_padding(size_t index);
+    void move_proxy(size_t from, size_t to);
+    size_t find(entt::entity) const;
+    void choose_axis();
+
+    // Bounds in sorted order. Lanes past the end and erased entities have
+    // empty bounds at infinity which fail every test and sort last.
+    std::vector<block> m_blocks;
+    std::vector<entt::entity> m_entities;
+    std::vector<collision_filter> m_filters;
+    std::vector<uint8_t> m_moved;
+    // Index of each entity plus one, indexed by entity identifier.
+    std::vector<uint32_t> m_sparse;
+    size_t m_num_moved {0};
+    size_t m_num_erased {0};
+    size_t m_axis_choice_size {0};
+    unsigned m_axis {0};
+};
+
+template<typename Func>
+void sweep_and_prune::find_pairs(bool use_filters, Func func) const {
+    if (m_num_moved == 0) {
+        return;
+    }
+
+    const auto a0 = m_axis;
+    const auto a1 = (m_axis + 1) % 3;
+    const auto a2 = (m_axis + 2) % 3;
+    const auto all_lanes = (1u << simd_width) - 1u;
+    const auto count = m_entities.size();
+
+    for (size_t i = 0; i < count; ++i) {
+        auto &bi = m_blocks[i / simd_width];
+        auto li = i % simd_width;
+        auto max0 = simd_scalar::splat(bi.max[a0][li]);
+        auto min1 = simd_scalar::splat(bi.min[a1][li]);
+        auto max1 = simd_scalar::splat(bi.max[a1][li]);
+        auto min2 = simd_scalar::splat(bi.min[a2][li]);
+        auto max2 = simd_scalar::splat(bi.max[a2][li]);
+        auto moved_i = m_moved[i] != 0;
+        auto first = i + 1;
+
+        // The candidates are the entities after this one whose minimum along
+        // the sweep axis is not past this one's maximum.
+        for (auto k = first / simd_width; k < m_blocks.size(); ++k) {
+            auto &bk = m_blocks[k];
+            auto valid = k == first / simd_width ? (all_lanes << (first % simd_width)) & all_lanes : all_lanes;
+            auto axis_mask = less_equal_mask(simd_scalar::load(bk.min[a0]), max0) & valid;
+            auto mask = axis_mask;
+            mask &= less_equal_mask(simd_scalar::load(bk.min[a1]), max1);
+            mask &= less_equal_mask(min1, simd_scalar::load(bk.max[a1]));
+            mask &= less_equal_mask(simd_scalar::load(bk.min[a2]), max2);
+            mask &= less_equal_mask(min2, simd_scalar::load(bk.max[a2]));
+
+            for (unsigned lane = 0; mask != 0 && lane < simd_width; ++lane) {
+                if (!(mask & (1u << lane))) {
+                    continue;
+                }
+
+                mask &= ~(1u << lane);
+                auto j = k * simd_width + lane;
+
+                if (!moved_i && !m_moved[j]) {
+                    continue;
+                }
+
+                if (use_filters && !collision_filter_test(m_filters[i], m_filters[j])) {
+                    continue;
+                }
+
+                func(m_entities[i], m_entities[j]);
+            }
+
+            // Since the minimums are sorted, all following blocks are past
+            // the maximum once a lane is.
+            if (axis_mask != valid) {
+                break;
+            }
+        }
+    }
+}
+
+}
+
+#endif // EDYN_COLLISION_SWEEP_AND_PRUNE_HPP
@@ -5,6 +5,7 @@
 #include <limits>
 #include <entt/entity/fwd.hpp>
 #include "edyn/comp/aabb.hpp"
+#include "edyn/comp/collision_filter.hpp"
 
 namespace edyn {
 
@@ -14,6 +15,9 @@ constexpr static tree_node_id_t null_tree_node_id = std::numeric_limits<tree_nod
 struct tree_node {
     entt::entity entity;
     AABB aabb;
+    // Collision filter of the entity in leaves and union of the filters of
+    // the children in internal nodes.
+    collision_filter filter;
 
     union {
         tree_node_id_t parent;
@@ -0,0 +1,31 @@
+#ifndef EDYN_COMP_AABB_MARGIN_HPP
+#define EDYN_COMP_AABB_MARGIN_HPP
+
+#include "edyn/math/scalar.hpp"
+
+namespace edyn {
+
+/**
+ * @brief How much the AABB of a rigid body is inflated in the broadphase
+ * trees. Its leaf is only moved in the tree once the AABB leaves the inflated
+ * AABB, thus a larger margin means less restructuring of the tree while a
+ * smaller margin means fewer false positive pairs. The inflated AABB is also
+ * extended along the displacement of the body in one step scaled by the
+ * `displacement_multiplier`, which keeps fast bodies inside of their leaf for
+ * some steps without inflating it in the other directions. Bodies without
+ * this component use the default values.
+ */
+struct aabb_margin {
+    scalar margin {scalar(0.1)};
+    scalar displacement_multiplier {scalar(4)};
+};
+
+template<typename Archive>
+void serialize(Archive &archive, aabb_margin &m) {
+    archive(m.margin);
+    archive(m.displacement_multiplier);
+}
+
+}
+
+#endif // EDYN_COMP_AABB_MARGIN_HPP
@@ -2,6 +2,7 @@
 #define EDYN_COMP_ANGVEL_HPP
 
 #include "edyn/math/vector3.hpp"
+#include "edyn/serialization/s11n_util.hpp"
 
 namespace edyn {
 /**
@@ -19,6 +20,9 @@ void serialize(Archive &archive, angvel &v) {
     archive(v.x, v.y, v.z);
 }
 
+template<>
+struct is_bitwise_serializable<angvel> : std::bool_constant<sizeof(angvel) == 3 * sizeof(scalar)> {};
+
 }
 
 #endif // EDYN_COMP_ANGVEL_HPP
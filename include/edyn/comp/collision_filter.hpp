@@ -11,6 +11,23 @@ struct collision_filter {
     uint64_t mask {all_groups};
 };
 
+/**
+ * @brief Whether two filters accept each other, i.e. the group of each one
+ * is in the mask of the other.
+ */
+inline bool collision_filter_test(const collision_filter &a, const collision_filter &b) {
+    return (a.group & b.mask) != 0 && (b.group & a.mask) != 0;
+}
+
+/**
+ * @brief Combines filters by merging their groups and masks. A filter which
+ * fails the test against the union fails against each one of them, which
+ * allows a bounding volume hierarchy to skip subtrees.
+ */
+inline collision_filter collision_filter_union(const collision_filter &a, const collision_filter &b) {
+    return {a.group | b.group, a.mask | b.mask};
+}
+
 template<typename Archive>
 void serialize(Archive &archive, collision_filter &c) {
     archive(c.group);
@@ -19,6 +19,9 @@ struct island {
     entt::sparse_set nodes {};
     entt::sparse_set edges {};
     std::optional<double> sleep_timestamp;
+    // Time when the island first lost a node or edge since it was last
+    // checked for splits.
+    std::optional<double> split_timestamp;
 };
 
 struct island_AABB : public AABB {};
@@ -0,0 +1,66 @@
+#ifndef EDYN_COMP_KINEMATIC_TRACK_HPP
+#define EDYN_COMP_KINEMATIC_TRACK_HPP
+
+#include <cstdint>
+#include <vector>
+#include "edyn/math/vector3.hpp"
+#include "edyn/math/quaternion.hpp"
+#include "edyn/serialization/math_s11n.hpp"
+#include "edyn/serialization/s11n_util.hpp"
+#include "edyn/serialization/std_s11n.hpp"
+
+namespace edyn {
+
+enum class kinematic_track_interpolation : uint8_t {
+    // Positions are interpolated linearly between keyframes.
+    linear,
+    // Positions follow a Catmull-Rom spline through the keyframes, which has
+    // a continuous velocity.
+    spline
+};
+
+struct kinematic_keyframe {
+    scalar time;
+    vector3 position;
+    quaternion orientation;
+};
+
+/**
+ * @brief Keyframed motion of a kinematic rigid body. It's evaluated in each
+ * step wherever the simulation runs, i.e. in the simulation worker in
+ * asynchronous mode, thus moving platforms and doors do not need their
+ * position to be updated from the main thread in every frame. The body is
+ * moved to the transform of the track at the end of the step and its
+ * velocities are set so it gets there during the step, as with
+ * `update_kinematic_position` and `update_kinematic_orientation`.
+ * Orientations are always interpolated spherically between keyframes.
+ */
+struct kinematic_track {
+    // Keyframes sorted by time.
+    std::vector<kinematic_keyframe> keyframes;
+    kinematic_track_interpolation interpolation {kinematic_track_interpolation::linear};
+    // Whether to restart from the first keyframe after the last one is
+    // reached, otherwise the body stops at the last one.
+    bool loop {false};
+    // Playback time in seconds, which is advanced by the simulation. In
+    // asynchronous mode, only the copy in the simulation worker advances.
+    scalar time {0};
+    // Playback rate. Zero pauses the track.
+    scalar speed {1};
+};
+
+template<typename Archive>
+void serialize(Archive &archive, kinematic_keyframe &keyframe) {
+    archive(keyframe.time, keyframe.position, keyframe.orientation);
+}
+
+template<typename Archive>
+void serialize(Archive &archive, kinematic_track &track) {
+    archive(track.keyframes);
+    serialize_enum(archive, track.interpolation);
+    archive(track.loop, track.time, track.speed);
+}
+
+}
+
+#endif // EDYN_COMP_KINEMATIC_TRACK_HPP
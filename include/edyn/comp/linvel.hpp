@@ -2,6 +2,7 @@
 #define EDYN_COMP_VELOCITY_HPP
 
 #include "edyn/math/vector3.hpp"
+#include "edyn/serialization/s11n_util.hpp"
 
 namespace edyn {
 
@@ -20,6 +21,9 @@ void serialize(Archive &archive, linvel &v) {
     archive(v.x, v.y, v.z);
 }
 
+template<>
+struct is_bitwise_serializable<linvel> : std::bool_constant<sizeof(linvel) == 3 * sizeof(scalar)> {};
+
 }
 
 #endif // EDYN_COMP_VELOCITY_HPP
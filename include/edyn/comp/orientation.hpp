@@ -2,6 +2,7 @@
 #define EDYN_COMP_ORIENTATION_HPP
 
 #include "edyn/math/quaternion.hpp"
+#include "edyn/serialization/s11n_util.hpp"
 
 namespace edyn {
 
@@ -17,6 +18,9 @@ void serialize(Archive &archive, orientation &v) {
     archive(v.x, v.y, v.z, v.w);
 }
 
+template<>
+struct is_bitwise_serializable<orientation> : std::bool_constant<sizeof(orientation) == 4 * sizeof(scalar)> {};
+
 }
 
 #endif // EDYN_COMP_ORIENTATION_HPP
@@ -2,6 +2,7 @@
 #define EDYN_COMP_POSITION_HPP
 
 #include "edyn/math/vector3.hpp"
+#include "edyn/serialization/s11n_util.hpp"
 
 namespace edyn {
 
@@ -17,6 +18,9 @@ void serialize(Archive &archive, position &v) {
     archive(v.x, v.y, v.z);
 }
 
+template<>
+struct is_bitwise_serializable<position> : std::bool_constant<sizeof(position) == 3 * sizeof(scalar)> {};
+
 }
 
 #endif // EDYN_COMP_POSITION_HPP
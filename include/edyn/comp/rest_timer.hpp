@@ -0,0 +1,18 @@
+#ifndef EDYN_COMP_REST_TIMER_HPP
+#define EDYN_COMP_REST_TIMER_HPP
+
+namespace edyn {
+
+/**
+ * @brief Assigned to a dynamic rigid body while its velocity is under the
+ * sleep thresholds in an awake island, holding the time it came to rest.
+ * Once at rest for long enough, the body is frozen.
+ * @see `edyn::frozen_tag`
+ */
+struct rest_timer {
+    double timestamp;
+};
+
+}
+
+#endif // EDYN_COMP_REST_TIMER_HPP
@@ -2,12 +2,14 @@
 #define EDYN_SHARED_COMP_HPP
 
 #include "edyn/comp/aabb.hpp"
+#include "edyn/comp/aabb_margin.hpp"
 #include "edyn/comp/child_list.hpp"
 #include "edyn/comp/gravity.hpp"
 #include "edyn/comp/linvel.hpp"
 #include "edyn/comp/angvel.hpp"
 #include "edyn/comp/mass.hpp"
 #include "edyn/comp/inertia.hpp"
+#include "edyn/comp/kinematic_track.hpp"
 #include "edyn/comp/position.hpp"
 #include "edyn/comp/orientation.hpp"
 #include "edyn/comp/center_of_mass.hpp"
@@ -20,7 +22,10 @@
 #include "edyn/comp/collision_filter.hpp"
 #include "edyn/comp/collision_exclusion.hpp"
 #include "edyn/comp/roll_direction.hpp"
+#include "edyn/comp/solver_substeps.hpp"
 #include "edyn/constraints/null_constraint.hpp"
+#include "edyn/constraints/breakable_constraint.hpp"
+#include "edyn/dynamics/island_solver_stats.hpp"
 #include "edyn/networking/comp/discontinuity.hpp"
 #include "edyn/shapes/shapes.hpp"
 #include "edyn/collision/contact_manifold.hpp"
@@ -35,6 +40,7 @@ namespace edyn {
  */
 using shared_components_t = decltype(std::tuple_cat(std::tuple<
     AABB,
+    aabb_margin,
     island_AABB,
     collision_filter,
     collision_exclusion,
@@ -61,14 +67,24 @@ using shared_components_t = decltype(std::tuple_cat(std::tuple<
     sleeping_tag,
     sleeping_disabled_tag,
     disabled_tag,
+    low_fidelity_tag,
+    solver_substeps,
     external_tag,
     shape_index,
     island_resident,
     rigidbody_tag,
     constraint_tag,
     island_tag,
+    island_solver_stats,
     rolling_tag,
     roll_direction,
+    kinematic_track,
+    particle_tag,
+    sensor_tag,
+    sensor_aabb_tag,
+    contact_event_tag,
+    articulation_tag,
+    breakable_constraint,
     discontinuity_accumulator,
     child_list,
     parent_comp,
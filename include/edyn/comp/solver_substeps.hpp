@@ -0,0 +1,26 @@
+#ifndef EDYN_COMP_SOLVER_SUBSTEPS_HPP
+#define EDYN_COMP_SOLVER_SUBSTEPS_HPP
+
+namespace edyn {
+
+/**
+ * @brief Assign to rigid bodies which need to be simulated at a higher rate
+ * than the rest of the world, such as vehicles with stiff suspensions. The
+ * island the body resides in is solved in the largest number of substeps
+ * requested by its bodies, or `settings::num_solver_substeps` if greater,
+ * while all other islands are unaffected. The velocity iterations are
+ * distributed among the substeps, thus `settings::num_solver_iterations`
+ * might have to be increased accordingly.
+ */
+struct solver_substeps {
+    unsigned count {1};
+};
+
+template<typename Archive>
+void serialize(Archive &archive, solver_substeps &s) {
+    archive(s.count);
+}
+
+}
+
+#endif // EDYN_COMP_SOLVER_SUBSTEPS_HPP
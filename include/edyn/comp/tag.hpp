@@ -54,6 +54,14 @@ struct network_exclude_tag {};
  */
 struct sleeping_tag {};
 
+/**
+ * A dynamic rigid body which has been at rest for a while and is treated as
+ * static by the solver even though its island is awake. It's unfrozen once
+ * the impulse of one of its contacts is large enough.
+ * @see `edyn::settings::freeze_resting_bodies`
+ */
+struct frozen_tag {};
+
 /**
  * An entity that won't be put to sleep when inactive.
  */
@@ -64,6 +72,14 @@ struct sleeping_disabled_tag {};
  */
 struct disabled_tag {};
 
+/**
+ * A rigid body in a region of lesser importance, e.g. outside the AABB of
+ * interest of all network clients. Islands where all rigid bodies have this
+ * tag are solved with fewer iterations.
+ * @see `edyn::settings::num_low_fidelity_velocity_iterations`
+ */
+struct low_fidelity_tag {};
+
 /**
  * A rigid body which holds a shape that can roll. An extra step will be
  * performed to help improve contact point persistence when rolling at
@@ -71,6 +87,60 @@ struct disabled_tag {};
  */
 struct rolling_tag {};
 
+/**
+ * A fast moving rigid body that uses speculative contacts to prevent it from
+ * tunneling through other bodies. Its AABB is extended to enclose its motion
+ * during the next step and the collision threshold of its manifolds grows
+ * with the relative velocity of the bodies.
+ */
+struct ccd_tag {};
+
+/**
+ * A dynamic rigid body with a sphere shape and no angular state, e.g. debris
+ * or sand. Its moment of inertia is zero thus it never rotates and its
+ * orientation is not integrated. Its AABB is calculated directly from its
+ * position and radius.
+ */
+struct particle_tag {};
+
+/**
+ * A rigid body which doesn't collide with others and instead reports when
+ * they start and stop overlapping it as sensor events, e.g. a trigger zone.
+ * It never gets contact manifolds thus it does not connect islands.
+ * @see `edyn::get_sensor_events`
+ */
+struct sensor_tag {};
+
+/**
+ * A sensor whose overlaps are decided by the AABBs of the rigid bodies alone,
+ * without testing the shapes for intersection.
+ */
+struct sensor_aabb_tag {};
+
+/**
+ * A rigid body whose contacts are reported in the contact event stream when
+ * it is filtered by tag.
+ * @see `edyn::set_contact_event_filter`
+ */
+struct contact_event_tag {};
+
+/**
+ * An entity whose presentation transforms are updated when presenting only
+ * tagged entities. It is only assigned in the main registry.
+ * @see `edyn::set_present_tagged_only`
+ */
+struct presentation_tag {};
+
+/**
+ * A constraint whose rows without impulse limits are solved exactly, together
+ * with the other tagged constraints it forms a tree with, instead of
+ * iteratively. Suited for chains and ragdolls. Tagged constraints which
+ * would close a loop are solved as usual. Only used in islands which are not
+ * solved in parallel.
+ * @see `edyn::articulation`
+ */
+struct articulation_tag {};
+
 /**
  * An entity that was created externally and tagged via
  * `edyn::tag_external_entity` (i.e. it doesn't represent any of the internal
@@ -8,6 +8,9 @@ namespace edyn {
 struct tree_resident {
     tree_node_id_t id;
     bool procedural;
+    // Whether the node was moved or inserted since the last broadphase
+    // update and is thus in the broadphase move buffer.
+    bool moved {false};
 };
 
 }
@@ -0,0 +1,36 @@
+#ifndef EDYN_CONFIG_BROADPHASE_ALGORITHM_HPP
+#define EDYN_CONFIG_BROADPHASE_ALGORITHM_HPP
+
+namespace edyn {
+
+/**
+ * @brief How the broadphase finds pairs of procedural entities whose AABBs
+ * intersect. Queries and raycasts always use the AABB trees.
+ */
+enum class broadphase_algorithm {
+    /**
+     * Each procedural entity which moved queries a dynamic AABB tree. Suits
+     * most scenes.
+     */
+    dynamic_tree,
+
+    /**
+     * The AABBs of procedural entities are kept sorted along one axis and
+     * swept over in batches of SIMD lanes. Suits dense scenes with a large
+     * number of entities of similar size which move coherently.
+     */
+    sweep_and_prune,
+
+    /**
+     * A linear bounding volume hierarchy is rebuilt over the AABBs of the
+     * procedural entities in each step where any of them moved and each
+     * procedural entity which moved queries it. Suits scenes with a large
+     * number of small entities which move fast and incoherently, such as
+     * debris and particles.
+     */
+    linear_bvh
+};
+
+}
+
+#endif // EDYN_CONFIG_BROADPHASE_ALGORITHM_HPP
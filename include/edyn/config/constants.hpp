@@ -47,6 +47,21 @@ inline constexpr auto island_angular_sleep_threshold = pi / scalar(48);
  */
 inline constexpr auto island_time_to_sleep = scalar(2);
 
+/**
+ * The amount of time in seconds that the velocity of a rigid body must stay
+ * under the island sleep thresholds for it to be frozen while its island is
+ * awake, if `edyn::settings::freeze_resting_bodies` is enabled.
+ */
+inline constexpr auto body_time_to_freeze = scalar(0.5);
+
+/**
+ * A frozen rigid body is unfrozen once the normal impulse applied by a contact
+ * in one step, divided by the mass of the body and the step duration, exceeds
+ * this acceleration. It's a few times gravity so bodies resting on top of a
+ * frozen body do not unfreeze it, while impacts do.
+ */
+inline constexpr auto frozen_body_wake_acceleration = scalar(30);
+
 /**
  * Being exact when determining support features can lead to the undesired
  * feature being picked due to the limitations of floating point math. Usually,
@@ -79,6 +94,116 @@ inline constexpr auto convex_mesh_relevant_direction_tolerance = scalar(0.0006);
  */
 inline constexpr auto convex_mesh_validation_parallel_tolerance = scalar(0.005);
 
+/**
+ * Adjacent triangles of a convex hull whose vertices are closer than this
+ * fraction of the largest extent of the point cloud to a common plane are
+ * merged into a single polygonal face.
+ */
+inline constexpr auto convex_hull_relative_tolerance = scalar(0.0001);
+
+/**
+ * The separating axis found between two convex shapes is cached in the contact
+ * manifold and is reused without running the full SAT in the next steps while
+ * the relative position of the shapes changes by less than this amount and
+ * their relative orientation by less than
+ * `separating_axis_cache_orientation_tolerance`.
+ */
+inline constexpr auto separating_axis_cache_position_tolerance = scalar(0.001);
+
+/**
+ * Maximum change in relative orientation for the cached separating axis to be
+ * reused, given as one minus the cosine of half the angle of rotation.
+ */
+inline constexpr auto separating_axis_cache_orientation_tolerance = scalar(1e-6);
+
+/**
+ * The collision results of each pair of children of two compound shapes are
+ * cached in a `compound_pair_cache` assigned to their contact manifold and
+ * are reused in the next steps while the relative position of the children
+ * changes by less than this amount and their relative orientation by less
+ * than `compound_pair_cache_orientation_tolerance`.
+ */
+inline constexpr auto compound_pair_cache_position_tolerance = scalar(0.001);
+
+/**
+ * Maximum change in relative orientation of a pair of children of compound
+ * shapes for their cached collision results to be reused, given as one minus
+ * the cosine of half the angle of rotation.
+ */
+inline constexpr auto compound_pair_cache_orientation_tolerance = scalar(1e-6);
+
+/**
+ * Pairs of polyhedrons with more than this many pairs of edges, i.e. the
+ * product of their number of edges, find their separating axis with GJK and
+ * EPA instead of SAT, since SAT tests all pairs of edges.
+ */
+inline constexpr size_t polyhedron_sat_max_edge_pairs = 4096;
+
+/**
+ * Maximum number of iterations of GJK and EPA.
+ */
+inline constexpr unsigned gjk_max_iterations = 64;
+inline constexpr unsigned epa_max_iterations = 64;
+
+/**
+ * GJK stops once the distance between the closest point in the simplex and
+ * the origin decreases by less than this fraction in one iteration. EPA
+ * stops once the closest face of the polytope is within this distance of the
+ * boundary of the Minkowski difference.
+ */
+inline constexpr auto gjk_relative_tolerance = scalar(1e-5);
+inline constexpr auto epa_tolerance = scalar(1e-4);
+
+/**
+ * Default number of cells along each side of the tiles of a heightfield,
+ * which store the height range of their cells to skip them quickly.
+ */
+inline constexpr uint32_t heightfield_default_tile_size = 8;
+
+/**
+ * Number of times a thread waiting for the jobs of a parallel for loop checks
+ * whether they are done, yielding in between, before going to sleep. While
+ * there are other pending jobs, it runs them instead.
+ */
+inline constexpr unsigned parallel_for_wait_spin_count = 64;
+
+/**
+ * When pacing updates by deadline, the simulation worker wakes up this many
+ * seconds before the deadline and spins until it's reached, which absorbs
+ * the wake up latency of the operating system.
+ */
+inline constexpr double simulation_deadline_spin_time = 0.0005;
+
+/**
+ * In asynchronous mode, the state of a dynamic body is only sent to the main
+ * thread after a step if its position or velocities changed by more than
+ * these amounts since it was last sent, which spares bodies that barely move,
+ * such as bodies resting on the ground that aren't asleep yet. Changes are
+ * measured against the last state sent, thus small changes still add up.
+ */
+inline constexpr auto transform_mirror_position_tolerance = scalar(1e-5);
+inline constexpr auto transform_mirror_velocity_tolerance = scalar(1e-4);
+
+/**
+ * Orientation counterpart of `transform_mirror_position_tolerance`, given as
+ * one minus the cosine of half the angle of rotation.
+ */
+inline constexpr auto transform_mirror_orientation_tolerance = scalar(1e-10);
+
+/**
+ * A shape cast stops advancing once the swept shape is this close to the
+ * shape it's cast against, which is then considered to be hit.
+ */
+inline constexpr auto shape_cast_tolerance = scalar(0.001);
+
+/**
+ * Maximum number of steps of conservative advancement of a shape cast
+ * against a single shape. If the swept shape is still approaching the other
+ * after this many steps, e.g. when grazing a triangle mesh, it's hit where
+ * the last step stopped, which is never past the actual hit.
+ */
+inline constexpr unsigned shape_cast_max_iterations = 32;
+
 }
 
 #endif // EDYN_CONFIG_CONSTANTS_HPP
@@ -0,0 +1,133 @@
+#ifndef EDYN_CONFIG_MEMORY_RESOURCE_HPP
+#define EDYN_CONFIG_MEMORY_RESOURCE_HPP
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace edyn {
+
+/**
+ * @brief Source of the memory of the containers of a world which use
+ * `edyn::allocator`, such as the broadphase trees, the entity graph, the
+ * contact manifold map, the constraint preparation arenas and the registry
+ * operation buffers. It is set with `init_config::memory_resource`, which
+ * allows giving each world its own arena, away from the allocator used by
+ * the rest of the application. Functions are called from the simulation
+ * thread, the main thread and the worker threads of the job dispatcher at
+ * the same time, thus they must be thread-safe.
+ */
+class memory_resource {
+public:
+    virtual ~memory_resource() = default;
+
+    virtual void * allocate(size_t size, size_t alignment) = 0;
+    virtual void deallocate(void *ptr, size_t size, size_t alignment) = 0;
+
+    /**
+     * @brief Resource which uses the global `operator new` and
+     * `operator delete`. It is the default.
+     */
+    static memory_resource * new_delete();
+
+    /**
+     * @brief Resource used by containers constructed in the calling thread,
+     * which is the one bound with `bind_current` or `new_delete` if none
+     * was bound.
+     */
+    static memory_resource * current();
+
+    /**
+     * @brief Sets the resource returned by `current` in the calling thread,
+     * which is how the threads that run a world allocate its containers
+     * from the resource of that world.
+     * @param resource The resource. Null restores `new_delete`.
+     */
+    static void bind_current(memory_resource *resource);
+};
+
+/**
+ * @brief Binds a memory resource to the calling thread for the duration of
+ * a scope and restores the previous one afterwards.
+ */
+class scoped_memory_resource {
+public:
+    scoped_memory_resource(memory_resource *resource)
+        : m_previous(memory_resource::current())
+    {
+        memory_resource::bind_current(resource);
+    }
+
+    ~scoped_memory_resource() {
+        memory_resource::bind_current(m_previous);
+    }
+
+    scoped_memory_resource(const scoped_memory_resource &) = delete;
+    scoped_memory_resource & operator=(const scoped_memory_resource &) = delete;
+
+private:
+    memory_resource *m_previous;
+};
+
+/**
+ * @brief Allocator which takes memory from the resource that was current in
+ * the thread where it was constructed. Like `std::pmr::polymorphic_allocator`
+ * the resource is a property of a container, which keeps it afterwards.
+ * Memory is aligned at least like memory returned by `operator new`, since
+ * byte buffers are used to store objects, e.g. in `registry_operation`.
+ */
+template<typename T>
+class allocator {
+public:
+    using value_type = T;
+    static constexpr size_t alignment = alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__ ?
+        alignof(T) : __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+    // Moving a container also moves its memory, thus moving never allocates.
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    allocator() noexcept
+        : m_resource(memory_resource::current())
+    {}
+
+    allocator(memory_resource *resource) noexcept
+        : m_resource(resource)
+    {}
+
+    template<typename U>
+    allocator(const allocator<U> &other) noexcept
+        : m_resource(other.resource())
+    {}
+
+    T * allocate(size_t n) {
+        return static_cast<T *>(m_resource->allocate(n * sizeof(T), alignment));
+    }
+
+    void deallocate(T *ptr, size_t n) noexcept {
+        m_resource->deallocate(ptr, n * sizeof(T), alignment);
+    }
+
+    memory_resource * resource() const noexcept {
+        return m_resource;
+    }
+
+private:
+    memory_resource *m_resource;
+};
+
+template<typename T, typename U>
+bool operator==(const allocator<T> &a, const allocator<U> &b) noexcept {
+    return a.resource() == b.resource();
+}
+
+template<typename T, typename U>
+bool operator!=(const allocator<T> &a, const allocator<U> &b) noexcept {
+    return a.resource() != b.resource();
+}
+
+template<typename T>
+using resource_vector = std::vector<T, allocator<T>>;
+
+}
+
+#endif // EDYN_CONFIG_MEMORY_RESOURCE_HPP
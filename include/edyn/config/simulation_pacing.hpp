@@ -0,0 +1,34 @@
+#ifndef EDYN_CONFIG_SIMULATION_PACING_HPP
+#define EDYN_CONFIG_SIMULATION_PACING_HPP
+
+namespace edyn {
+
+/**
+ * @brief How the simulation worker paces its updates in asynchronous mode.
+ */
+enum class simulation_pacing {
+    /**
+     * Delays each update based on how far the duration of the previous
+     * update was from the fixed delta time. Sleeps in whole milliseconds.
+     */
+    adaptive_delay,
+
+    /**
+     * Sleeps until the absolute deadline of the next update with a high
+     * resolution timer and spins for the last moments before it. Updates
+     * don't drift, which suits high tick rates such as servers running at
+     * 120 or 240 Hz. A core is kept busy while spinning.
+     */
+    deadline,
+
+    /**
+     * Runs one step after another without waiting, advancing the simulation
+     * time by the fixed delta time in each step regardless of how much time
+     * actually passed. Meant for offline simulations.
+     */
+    as_fast_as_possible
+};
+
+}
+
+#endif // EDYN_CONFIG_SIMULATION_PACING_HPP
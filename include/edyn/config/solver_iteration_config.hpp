@@ -2,6 +2,7 @@
 #define EDYN_CONFIG_SOLVER_ITERATION_CONFIG_HPP
 
 #include <entt/entity/fwd.hpp>
+#include "edyn/math/scalar.hpp"
 
 namespace edyn {
 
@@ -65,6 +66,128 @@ unsigned get_solver_individual_restitution_iterations(const entt::registry &regi
  */
 void set_solver_individual_restitution_iterations(entt::registry &registry, unsigned iterations);
 
+/**
+ * @brief Get the number of constraint solver substeps.
+ * @param registry Data source.
+ * @return Number of solver substeps.
+ */
+unsigned get_solver_substeps(const entt::registry &registry);
+
+/**
+ * @brief Set the number of constraint solver substeps. The velocity iterations
+ * are distributed among substeps. A value of one disables substepping.
+ * @param registry Data source.
+ * @param substeps Number of solver substeps. Must be greater than zero.
+ */
+void set_solver_substeps(entt::registry &registry, unsigned substeps);
+
+/**
+ * @brief Get the minimum number of constraint solver velocity iterations in
+ * adaptive mode.
+ * @param registry Data source.
+ * @return Minimum number of solver velocity iterations.
+ */
+unsigned get_solver_min_velocity_iterations(const entt::registry &registry);
+
+/**
+ * @brief Set the minimum number of constraint solver velocity iterations in
+ * adaptive mode. The maximum is the regular number of velocity iterations.
+ * @param registry Data source.
+ * @param iterations Minimum number of solver velocity iterations.
+ */
+void set_solver_min_velocity_iterations(entt::registry &registry, unsigned iterations);
+
+/**
+ * @brief Get the tolerance of the adaptive velocity iterations.
+ * @param registry Data source.
+ * @return Velocity iteration tolerance.
+ */
+scalar get_solver_velocity_tolerance(const entt::registry &registry);
+
+/**
+ * @brief Set the tolerance of the adaptive velocity iterations. The velocity
+ * iterations of an island stop early once the largest delta impulse applied
+ * by a constraint row in one iteration is below this value. Zero disables
+ * adaptive mode, thus all islands run the full number of iterations.
+ * @param registry Data source.
+ * @param tolerance Impulse tolerance. Must not be negative.
+ */
+void set_solver_velocity_tolerance(entt::registry &registry, scalar tolerance);
+
+/**
+ * @brief Check whether the normal rows of contact manifolds are solved
+ * together as a block.
+ * @param registry Data source.
+ * @return Whether the contact block solver is enabled.
+ */
+bool get_contact_block_solver(const entt::registry &registry);
+
+/**
+ * @brief Enable or disable solving the normal rows of each contact manifold
+ * together as a block, which converges in fewer velocity iterations.
+ * @param registry Data source.
+ * @param enabled Whether to enable the contact block solver.
+ */
+void set_contact_block_solver(entt::registry &registry, bool enabled);
+
+/**
+ * @brief Check whether chains of distance constraints are solved exactly.
+ * @param registry Data source.
+ * @return Whether distance chains are articulated.
+ */
+bool get_articulate_distance_chains(const entt::registry &registry);
+
+/**
+ * @brief Enable or disable solving the links of ropes and chains made of
+ * distance constraints exactly, which removes the stretching of long ropes.
+ * See `edyn::settings::articulate_distance_chains`.
+ * @param registry Data source.
+ * @param enabled Whether to articulate distance chains.
+ */
+void set_articulate_distance_chains(entt::registry &registry, bool enabled);
+
+/**
+ * @brief Check whether the deterministic execution mode is enabled.
+ * @param registry Data source.
+ * @return Whether the simulation runs deterministically.
+ */
+bool get_deterministic(const entt::registry &registry);
+
+/**
+ * @brief Enable or disable the deterministic execution mode, where the result
+ * of each step does not depend on the number of threads. See
+ * `edyn::settings::deterministic`.
+ * @param registry Data source.
+ * @param enabled Whether to run deterministically.
+ */
+void set_deterministic(entt::registry &registry, bool enabled);
+
+/**
+ * @brief Check whether solver statistics are collected for each island.
+ * @param registry Data source.
+ * @return Whether solver statistics are collected.
+ */
+bool get_collect_solver_stats(const entt::registry &registry);
+
+/**
+ * @brief Enable or disable collecting solver statistics. If enabled, an
+ * `island_solver_stats` is assigned to each island and updated in every step,
+ * and it's also available in the main registry in asynchronous mode.
+ * @param registry Data source.
+ * @param enabled Whether to collect solver statistics.
+ */
+void set_collect_solver_stats(entt::registry &registry, bool enabled);
+
+/**
+ * @brief Get the number of velocity iterations done in the last step for an
+ * island. Must be called on the registry where the simulation runs, i.e. from
+ * within a step callback in asynchronous mode.
+ * @param registry Data source.
+ * @param island_entity Island entity.
+ * @return Number of velocity iterations done.
+ */
+unsigned get_island_solver_velocity_iterations(const entt::registry &registry, entt::entity island_entity);
+
 }
 
 #endif // EDYN_CONFIG_SOLVER_ITERATION_CONFIG_HPP
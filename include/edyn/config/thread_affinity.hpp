@@ -0,0 +1,33 @@
+#ifndef EDYN_CONFIG_THREAD_AFFINITY_HPP
+#define EDYN_CONFIG_THREAD_AFFINITY_HPP
+
+#include <vector>
+
+namespace edyn {
+
+/**
+ * @brief Set of logical processor indices a thread is allowed to run on.
+ * An empty set leaves the thread free to run on any processor.
+ */
+using core_set = std::vector<unsigned>;
+
+/**
+ * @brief Where the threads started by Edyn are allowed to run. Pinning
+ * threads to cores prevents the scheduler from migrating them, which keeps
+ * their caches warm between steps and, on machines with more than one NUMA
+ * node, keeps them close to the memory they work on.
+ */
+struct thread_affinity {
+    // Core sets of the worker threads of the job dispatcher. Worker `i` is
+    // pinned to `worker_cores[i % worker_cores.size()]`, thus a single core
+    // set confines all workers to it, while one set per worker with a single
+    // core in each pins each worker to its own core.
+    std::vector<core_set> worker_cores;
+    // Core set of the simulation worker thread in asynchronous execution
+    // mode. Usually a core not shared with the job dispatcher workers.
+    core_set simulation_cores;
+};
+
+}
+
+#endif // EDYN_CONFIG_THREAD_AFFINITY_HPP
@@ -0,0 +1,25 @@
+#ifndef EDYN_CONFIG_WORKER_IDLE_POLICY_HPP
+#define EDYN_CONFIG_WORKER_IDLE_POLICY_HPP
+
+#include <cstdint>
+
+namespace edyn {
+
+/**
+ * @brief How worker threads wait for new jobs once they run out of jobs.
+ * They first spin, then yield to other threads and then park, i.e. sleep
+ * until a job is scheduled. Spinning picks up new jobs with the lowest latency
+ * at the cost of keeping cores busy while there's nothing to do, whereas
+ * waking up a parked thread usually takes tens of microseconds. Setting both
+ * durations to zero makes workers park immediately, which saves power.
+ */
+struct worker_idle_policy {
+    // Time in microseconds spent spinning with a pause instruction.
+    uint32_t spin_microseconds {50};
+    // Time in microseconds spent yielding after spinning.
+    uint32_t yield_microseconds {100};
+};
+
+}
+
+#endif // EDYN_CONFIG_WORKER_IDLE_POLICY_HPP
@@ -0,0 +1,62 @@
+#ifndef EDYN_CONSTRAINTS_BREAKABLE_CONSTRAINT_HPP
+#define EDYN_CONSTRAINTS_BREAKABLE_CONSTRAINT_HPP
+
+#include <array>
+#include <vector>
+#include <entt/entity/fwd.hpp>
+#include <entt/entity/entity.hpp>
+#include "edyn/math/scalar.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Assigned to a constraint entity to make its constraints break once
+ * the impulse they apply in a step exceeds a threshold, which destroys the
+ * entity. The impulse of a constraint is the length of the vector of the
+ * impulses applied by all of its rows. Contact constraints never break.
+ */
+struct breakable_constraint {
+    scalar impulse_threshold;
+};
+
+template<typename Archive>
+void serialize(Archive &archive, breakable_constraint &breakable) {
+    archive(breakable.impulse_threshold);
+}
+
+/**
+ * @brief A constraint entity which was destroyed because the impulse applied
+ * by one of its constraints exceeded its threshold.
+ */
+struct constraint_break_event {
+    // The destroyed constraint entity.
+    entt::entity entity {entt::null};
+    // The rigid bodies it connected.
+    std::array<entt::entity, 2> body {entt::null, entt::null};
+    // Impulse applied in the step it broke.
+    scalar impulse {0};
+};
+
+/**
+ * @brief Constraint break events generated since the last update, in the
+ * order they happened.
+ */
+struct constraint_break_event_buffer {
+    std::vector<constraint_break_event> events;
+};
+
+/**
+ * @brief Get the constraints that broke during the last call to
+ * `edyn::update` or `edyn::step_simulation`. The island solvers only record
+ * the constraints that broke, thus nothing is done for breakable constraints
+ * until one of them breaks. In asynchronous mode, they break in the
+ * simulation worker and the events are sent to the main registry along with
+ * the step updates, in which the constraint entities are destroyed as well.
+ * @param registry Data source.
+ * @return The constraint break events.
+ */
+const std::vector<constraint_break_event> & get_constraint_break_events(const entt::registry &registry);
+
+}
+
+#endif // EDYN_CONSTRAINTS_BREAKABLE_CONSTRAINT_HPP
@@ -2,15 +2,16 @@
 #define EDYN_COMP_CONSTRAINT_ROW_HPP
 
 #include <array>
+#include <vector>
 #include "edyn/math/vector3.hpp"
 #include "edyn/math/matrix3x3.hpp"
 #include "edyn/config/constants.hpp"
-#include "edyn/comp/delta_linvel.hpp"
-#include "edyn/comp/delta_angvel.hpp"
+#include "edyn/dynamics/solver_body.hpp"
 
 namespace edyn {
 
 struct constraint_row_options;
+struct constraint_body;
 
 /**
  * `constraint_row` contains all and only the information that's required
@@ -35,26 +36,68 @@ struct constraint_row {
     // strength of impulse applied.
     scalar impulse;
 
-    // Inverse masses and inertias used during the solver iterations.
-    scalar inv_mA, inv_mB;
-    matrix3x3 inv_IA, inv_IB;
-
-    // Reference to delta velocities used during solver iterations. It is not
-    // safe to dereference these outside of the solver update context.
-    delta_linvel *dvA, *dvB;
-    delta_angvel *dwA, *dwB;
+    // Indices of the bodies in the array of solver bodies of the island,
+    // where the inverse masses, inertias and delta velocities are found.
+    // Assigned when the rows are packed into the island's row cache.
+    std::array<solver_body_index_t, 2> body;
 };
 
 void prepare_row(constraint_row &row,
                  const constraint_row_options &options,
-                 const vector3 &linvelA, const vector3 &angvelA,
-                 const vector3 &linvelB, const vector3 &angvelB);
+                 const constraint_body &bodyA, const constraint_body &bodyB);
+
+void apply_row_impulse(scalar impulse, const constraint_row &row, std::vector<solver_body> &bodies);
+
+void warm_start(const constraint_row &row, std::vector<solver_body> &bodies);
+
+scalar solve(constraint_row &row, const std::vector<solver_body> &bodies);
+
+// Clamps the accumulated impulse of the row after adding `delta_impulse` and
+// returns the delta impulse that was actually applied.
+inline scalar apply_row_limits(constraint_row &row, scalar delta_impulse) {
+    auto impulse = row.impulse + delta_impulse;
+
+    if (impulse < row.lower_limit) {
+        delta_impulse = row.lower_limit - row.impulse;
+        row.impulse = row.lower_limit;
+    } else if (impulse > row.upper_limit) {
+        delta_impulse = row.upper_limit - row.impulse;
+        row.impulse = row.upper_limit;
+    } else {
+        row.impulse = impulse;
+    }
 
-void apply_row_impulse(scalar impulse, constraint_row &row);
+    return delta_impulse;
+}
+
+/*
+ * Variants of the functions above for rows where only the body at `Side` is
+ * dynamic and the other is the fixed solver body, as in contacts against
+ * static geometry. Since the inverse mass and delta velocities of the fixed
+ * body are zero, its terms are skipped and it is never written to.
+ */
+template<size_t Side>
+void apply_row_impulse_one_sided(scalar impulse, const constraint_row &row, std::vector<solver_body> &bodies) {
+    static_assert(Side < 2);
+    auto &body = bodies[row.body[Side]];
+    body.dv += body.inv_m * row.J[2 * Side] * impulse;
+    body.dw += body.inv_I * row.J[2 * Side + 1] * impulse;
+}
 
-void warm_start(constraint_row &row);
+template<size_t Side>
+void warm_start_one_sided(const constraint_row &row, std::vector<solver_body> &bodies) {
+    apply_row_impulse_one_sided<Side>(row.impulse, row, bodies);
+}
 
-scalar solve(constraint_row &row);
+template<size_t Side>
+scalar solve_one_sided(constraint_row &row, const std::vector<solver_body> &bodies) {
+    static_assert(Side < 2);
+    auto &body = bodies[row.body[Side]];
+    auto delta_relvel = dot(row.J[2 * Side], body.dv) +
+                        dot(row.J[2 * Side + 1], body.dw);
+    auto delta_impulse = (row.rhs - delta_relvel) * row.eff_mass;
+    return apply_row_limits(row, delta_impulse);
+}
 
 }
 
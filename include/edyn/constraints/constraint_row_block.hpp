@@ -0,0 +1,59 @@
+#ifndef EDYN_CONSTRAINTS_CONSTRAINT_ROW_BLOCK_HPP
+#define EDYN_CONSTRAINTS_CONSTRAINT_ROW_BLOCK_HPP
+
+#include <array>
+#include <vector>
+#include "edyn/constraints/constraint_row.hpp"
+#include "edyn/config/constants.hpp"
+
+namespace edyn {
+
+/**
+ * A group of contiguous normal rows of one contact manifold which are solved
+ * together as a linear complementarity problem instead of one at a time,
+ * similarly to the block solver in Box2D. This converges to the exact
+ * solution for the rows in the block in a single iteration, which reduces
+ * jitter in resting contact.
+ */
+struct constraint_row_block {
+    static constexpr unsigned max_rows = max_contacts;
+
+    // Index of the first row in the array of rows.
+    unsigned first_row;
+    unsigned num_rows;
+
+    // Matrix `J M^-1 J^T` of the rows in the block, slightly regularized.
+    std::array<std::array<scalar, max_rows>, max_rows> K;
+};
+
+/**
+ * @brief Whether a row can be part of a block, which is only possible for
+ * rows which only push, i.e. with zero lower limit and no upper limit.
+ * @param row The row.
+ * @return Whether the row can be solved in a block.
+ */
+bool can_solve_in_block(const constraint_row &row);
+
+/**
+ * @brief Calculates the matrix of the block.
+ * @param block The block, with the first row and number of rows assigned.
+ * @param rows All rows.
+ * @param bodies Solver bodies referenced by the rows.
+ */
+void prepare_block(constraint_row_block &block, const std::vector<constraint_row> &rows,
+                   const std::vector<solver_body> &bodies);
+
+/**
+ * @brief Solves all rows in the block and applies the impulses to the bodies.
+ * Falls back to solving each row individually if no solution is found.
+ * @param block The block.
+ * @param rows All rows.
+ * @param bodies Solver bodies referenced by the rows.
+ * @return Largest magnitude of the delta impulses applied.
+ */
+scalar solve_block(const constraint_row_block &block, std::vector<constraint_row> &rows,
+                   std::vector<solver_body> &bodies);
+
+}
+
+#endif // EDYN_CONSTRAINTS_CONSTRAINT_ROW_BLOCK_HPP
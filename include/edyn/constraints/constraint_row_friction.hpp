@@ -22,8 +22,10 @@ struct constraint_row_friction {
     unsigned normal_row_index;
 };
 
-void solve_friction(constraint_row_friction &row, const std::vector<constraint_row> &row_cache);
-void warm_start(constraint_row_friction &row, const std::vector<constraint_row> &row_cache);
+void solve_friction(constraint_row_friction &row, const std::vector<constraint_row> &row_cache,
+                    std::vector<solver_body> &bodies);
+void warm_start(const constraint_row_friction &row, const std::vector<constraint_row> &row_cache,
+                std::vector<solver_body> &bodies);
 
 }
 
@@ -18,8 +18,10 @@ struct constraint_row_spin_friction {
     unsigned normal_row_index;
 };
 
-void solve_spin_friction(constraint_row_spin_friction &row, const std::vector<constraint_row> &row_cache);
-void warm_start(constraint_row_spin_friction &row, const std::vector<constraint_row> &row_cache);
+void solve_spin_friction(constraint_row_spin_friction &row, const std::vector<constraint_row> &row_cache,
+                         std::vector<solver_body> &bodies);
+void warm_start(const constraint_row_spin_friction &row, const std::vector<constraint_row> &row_cache,
+                std::vector<solver_body> &bodies);
 
 }
 
@@ -3,7 +3,10 @@
 
 #include <memory>
 #include <variant>
+#include "edyn/config/broadphase_algorithm.hpp"
 #include "edyn/config/execution_mode.hpp"
+#include "edyn/config/simulation_pacing.hpp"
+#include "edyn/config/thread_affinity.hpp"
 #include "edyn/context/task.hpp"
 #include "edyn/context/step_callback.hpp"
 #include "edyn/context/start_thread.hpp"
@@ -16,22 +19,219 @@
 
 namespace edyn {
 
+class job_dispatcher;
+class memory_resource;
+
 struct settings {
     scalar fixed_dt {scalar(1.0 / 60)};
     bool paused {false};
     vector3 gravity {gravity_earth};
 
+    // Mutual gravitational attraction between all dynamic rigid bodies that
+    // aren't disabled. It's applied to their velocity before the constraints
+    // are prepared in every step, without constraints between bodies, hence
+    // it does not join them in islands. The field is approximated with a
+    // Barnes-Hut octree where cells whose size divided by their distance to a
+    // body is below `nbody_gravity_theta` act as a single mass. Distances are
+    // softened by `nbody_gravity_softening` to prevent singularities.
+    bool nbody_gravity {false};
+    scalar nbody_gravity_constant {gravitational_constant};
+    scalar nbody_gravity_theta {scalar(0.5)};
+    scalar nbody_gravity_softening {scalar(0)};
+
     unsigned max_steps_per_update {10};
     unsigned num_solver_velocity_iterations {8};
+
+    // Adaptive velocity iterations. If the tolerance is greater than zero,
+    // the velocity iterations of an island stop early once the largest delta
+    // impulse applied by a constraint row in the last iteration is below the
+    // tolerance, after at least `min_solver_velocity_iterations` iterations.
+    // `num_solver_velocity_iterations` is the maximum in this case. It has no
+    // effect when substepping. The number of iterations used in each island is
+    // stored in `row_cache::num_velocity_iterations`.
+    unsigned min_solver_velocity_iterations {2};
+    scalar solver_velocity_tolerance {scalar(0)};
     unsigned num_solver_position_iterations {3};
     unsigned num_restitution_iterations {8};
     unsigned num_individual_restitution_iterations {3};
 
+    // Number of substeps the velocity solver splits each step into. In every
+    // substep, the position error of the constraints is updated from the
+    // displacement of the bodies and the rows are relaxed after the bodies
+    // are moved forward. The constraints are still prepared once per step.
+    // The velocity iterations are distributed among substeps, e.g. 8 velocity
+    // iterations and 4 substeps means two iterations per substep. Stiff
+    // chains of joints converge better with a few substeps than with more
+    // iterations. A value of one disables substepping. Islands can be solved
+    // in more substeps than the others by assigning `solver_substeps` to
+    // their bodies.
+    unsigned num_solver_substeps {1};
+
+    // Solver iterations of islands where all rigid bodies have a
+    // `low_fidelity_tag`. Values greater than the regular number of
+    // iterations have no effect.
+    unsigned num_low_fidelity_velocity_iterations {2};
+    unsigned num_low_fidelity_position_iterations {1};
+
+    // Solve the normal rows of each contact manifold together as a block,
+    // which gives the exact solution for the manifold in every iteration and
+    // reduces the number of velocity iterations needed for stable stacking.
+    // Only applies to islands which are not solved in parallel.
+    bool contact_block_solver {false};
+
+    // Solve the links of ropes and chains made of distance constraints
+    // exactly, as an `edyn::articulation`, without having to assign an
+    // `articulation_tag` to them. Only untagged distance constraints whose
+    // bodies have at most two of them are articulated, while the links at
+    // branch points and the ones that close a loop are solved iteratively.
+    // Only applies to islands which are not solved in parallel.
+    bool articulate_distance_chains {false};
+
+    // Assign an `island_solver_stats` to each island and fill it in every
+    // step with the convergence statistics and timings of its solver. In
+    // asynchronous mode, the stats are sent to the main registry along with
+    // the transforms.
+    bool collect_solver_stats {false};
+
+    // Measure the duration of each stage of the simulation step into the
+    // `step_profile` in the registry context. In asynchronous mode, the
+    // profile is sent to the main registry after each worker update.
+    bool profile_steps {false};
+
+    // Fill the `collision_stats` in the registry context in every step. In
+    // asynchronous mode, they're sent to the main registry with the step
+    // updates.
+    bool collect_collision_stats {false};
+
+    // Append the contacts which started and ended in every step to the
+    // `contact_event_buffer` in the registry context. Contacts which start
+    // with a total normal impulse below `contact_event_min_impulse` are left
+    // out, as are contacts where neither body has a `contact_event_tag` if
+    // `contact_event_require_tag` is set. In asynchronous mode, the events
+    // are sent to the main registry with the step updates.
+    bool stream_contact_events {false};
+    scalar contact_event_min_impulse {0};
+    bool contact_event_require_tag {false};
+
+    // Islands with at least this many constraints have their constraint rows
+    // partitioned by graph coloring and solved in parallel when running
+    // multi-threaded. The result is deterministic regardless of the number of
+    // threads. Set to zero to always solve islands in a single thread, which
+    // preserves the original row order.
+    unsigned min_island_constraints_parallel_solve {256};
+
+    // When running multi-threaded, islands which had fewer than this many
+    // constraint rows and bodies in the previous step are grouped into
+    // batches of about this size and each batch is solved in a single job,
+    // which saves the overhead of one job per island when there are many
+    // tiny islands. Set to zero to solve each island in its own job.
+    unsigned island_solver_batch_size {128};
+
+    // Make the result of each step independent of whether the simulation runs
+    // multi-threaded and of the number of threads, e.g. for lockstep
+    // networking and replays. Large islands are partitioned by graph coloring
+    // in all execution modes and the position constraints of all islands are
+    // colored, which keeps parallelism. Given the same sequence of changes to
+    // the registry, results are identical bit for bit on the same platform.
+    bool deterministic {false};
+
+    // Contact manifolds whose bodies moved relative to each other by less
+    // than these amounts since collision detection last ran for them keep
+    // their contact points without running it again. The linear tolerance is
+    // a distance and the angular tolerance is an angle in radians. Setting
+    // either to zero runs collision detection for all manifolds every step.
+    scalar contact_reuse_linear_tolerance {scalar(0.0005)};
+    scalar contact_reuse_angular_tolerance {scalar(0.002)};
+
+    // Freeze dynamic bodies that have been at rest for a while even if their
+    // island is still awake, e.g. because a few bodies in a large pile keep
+    // moving. Frozen bodies are treated as static by the solver until the
+    // impulse of one of their contacts is large enough to unfreeze them.
+    // Bodies attached to constraints other than contacts are never frozen.
+    bool freeze_resting_bodies {false};
+
+    // Release the row caches of sleeping islands and the preparation caches
+    // of their constraints, which are rebuilt when the island wakes up, at
+    // the cost of not refreshing rows in place in the first step after that.
+    // Contact manifolds are kept as they are since their points are needed
+    // to warm start the solver and to report contacts while asleep.
+    bool compact_sleeping_islands {false};
+
+    // Islands which lost a node or edge are checked for splits, which
+    // traverses the entire island, once they could go to sleep or after this
+    // many seconds, whichever comes first. Until then, disconnected parts of
+    // an island keep being solved together, which gives the same result.
+    // A value of zero checks for splits in every step.
+    scalar island_split_delay {scalar(0.2)};
+
+    // Sort the storages of the components of rigid bodies, constraints and
+    // contact manifolds by island every this many steps, which places the
+    // entities of each island next to each other in memory. They're also
+    // sorted once more entities moved to another island since the last sort
+    // than half of all island residents. Sorting invalidates references to
+    // these components. A value of zero never sorts them.
+    unsigned island_storage_sort_interval {0};
+
+    // Time in seconds that can be spent in each step on maintenance work
+    // which can wait, such as checking islands for splits once their delay
+    // has elapsed, optimizing the entity graph and sorting the storages by
+    // island. This work is run at the end of each step by the
+    // `maintenance_scheduler` in order of priority until the budget is
+    // exhausted, instead of all of it in the step it becomes due, which
+    // smooths out step time spikes. Since the amount of work done in a step
+    // depends on timing, a budget makes the simulation non-deterministic.
+    // A value of zero does all work right away.
+    double maintenance_budget {0};
+
+    // Pages of paged triangle meshes are loaded ahead of time for the region
+    // each awake island is expected to cover in this many seconds, based on
+    // the linear velocity of its bodies. Collision detection only uses the
+    // pages that are already loaded and never waits for a page to load.
+    scalar paged_mesh_prefetch_lookahead {scalar(0.5)};
+
+    // Only update the presentation transforms of entities which have a
+    // `presentation_tag`, e.g. the ones the renderer found to be visible. The
+    // presentation transforms of the other entities are left as they are.
+    bool present_tagged_only {false};
+
+    // The presentation transforms are calculated in worker threads once there
+    // are at least this many entities to present, in all execution modes
+    // except `execution_mode::sequential`. Set to zero to always calculate
+    // them in the calling thread.
+    unsigned min_presentation_parallel_size {4096};
+
+    // In asynchronous mode, the replacements in the step updates received
+    // from the simulation worker are applied to the main registry in worker
+    // threads, in parallel for different component types, when there are at
+    // least this many operations in the update. Then, listeners of the
+    // _update_ signal of shared components run concurrently for different
+    // components, thus it can't be enabled in a networked client or server,
+    // whose snapshot exporters observe updates. Zero disables it.
+    unsigned min_step_update_parallel_size {0};
+
+    // In asynchronous mode, publish a copy of the broadphase trees after each
+    // step for `raycast`, `raycast_any` and the AABB queries to be performed
+    // immediately in the main thread, against the last step published by the
+    // simulation worker, instead of asynchronously.
+    bool publish_broadphase {false};
+
     edyn::execution_mode execution_mode;
+    // How the simulation worker paces its updates in asynchronous mode.
+    simulation_pacing pacing {simulation_pacing::adaptive_delay};
+    // How the broadphase finds pairs of procedural entities.
+    edyn::broadphase_algorithm broadphase_algorithm {edyn::broadphase_algorithm::dynamic_tree};
 
     start_thread_func_t *start_thread_func {&start_thread_func_default};
+    // Cores the simulation worker thread pins itself to once started.
+    core_set simulation_thread_cores;
     enqueue_task_t *enqueue_task {&enqueue_task_default};
     enqueue_task_wait_t *enqueue_task_wait {&enqueue_task_wait_default};
+    // Thread pool which runs the jobs of this world when using the default
+    // task functions. Null means `job_dispatcher::global()`.
+    job_dispatcher *dispatcher {nullptr};
+    // Memory resource of the containers of this world. Null means
+    // `memory_resource::new_delete()`. Set in `attach` and cannot be changed.
+    edyn::memory_resource *memory_resource {nullptr};
 
     init_callback_t init_callback {nullptr};
     init_callback_t deinit_callback {nullptr};
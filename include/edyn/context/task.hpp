@@ -20,6 +20,11 @@ using enqueue_task_t = void (task_delegate_t task, unsigned size, task_completio
 using enqueue_task_wait_t = void (task_delegate_t task, unsigned size);
 
 void enqueue_task_default(task_delegate_t task, unsigned size, task_completion_delegate_t completion);
+// Schedules a task to be invoked once over the range [0, 1) in a worker thread
+// and returns immediately. It's the cheapest way to run the next step of a
+// sequence of tasks, such as the states of the island solver, since nothing
+// is allocated and the job is not split.
+void enqueue_continuation_default(task_delegate_t task);
 void enqueue_task_wait_default(task_delegate_t task, unsigned size);
 
 }
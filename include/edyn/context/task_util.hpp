@@ -4,7 +4,9 @@
 #include "edyn/context/settings.hpp"
 #include "edyn/context/task.hpp"
 #include <entt/entity/registry.hpp>
+#include <entt/signal/delegate.hpp>
 #include <functional>
+#include <vector>
 
 namespace edyn {
 
@@ -13,11 +15,69 @@ inline void enqueue_task(entt::registry &registry, task_delegate_t task, unsigne
     (*settings.enqueue_task)(task, size, completion);
 }
 
+/**
+ * @brief Schedules a task to be invoked once in a worker thread, e.g. the next
+ * step of a sequence of tasks. Uses `enqueue_continuation_default` with the
+ * default task functions, otherwise it's passed to the custom
+ * `edyn::settings::enqueue_task` as a task of size one.
+ * @param registry Data source.
+ * @param task Task invoked over the range [0, 1).
+ */
+inline void enqueue_continuation(entt::registry &registry, task_delegate_t task) {
+    auto &settings = registry.ctx().get<edyn::settings>();
+
+    if (settings.enqueue_task == &enqueue_task_default) {
+        enqueue_continuation_default(task);
+    } else {
+        (*settings.enqueue_task)(task, 1, {});
+    }
+}
+
 inline void enqueue_task_wait(entt::registry &registry, task_delegate_t task, unsigned size) {
     auto &settings = registry.ctx().get<edyn::settings>();
     (*settings.enqueue_task_wait)(task, size);
 }
 
+/**
+ * @brief Invokes `func(first, last, start)` for sub-ranges of an array in
+ * worker threads and waits for all of them to finish, where `[first, last)`
+ * is the sub-range and `start` is the index of `first` in the array.
+ * @param registry Data source.
+ * @param elements Array of elements. Must not be resized while running.
+ * @param func Callable invoked for each sub-range.
+ */
+template<typename T, typename Func>
+void parallel_for_each_range(entt::registry &registry, std::vector<T> &elements, Func func) {
+    auto *data = elements.data();
+    auto task_func = [data, &func](unsigned start, unsigned end) {
+        func(data + start, data + end, start);
+    };
+
+    auto task = task_delegate_t(entt::connect_arg_t<&decltype(task_func)::operator()>{}, task_func);
+    enqueue_task_wait(registry, task, static_cast<unsigned>(elements.size()));
+}
+
+/**
+ * @brief Invokes `func(first, last, start)` for sub-ranges of the entities in
+ * a view in worker threads and waits for all of them to finish. The entities
+ * are copied into a contiguous array first, so each sub-range is found in
+ * constant time, which is not possible with the iterators of views with more
+ * than one component or with exclusions, which must skip entities one by one.
+ * The entities are in the same order as when iterating the view.
+ * @param registry Data source.
+ * @param view The view.
+ * @param entities Buffer where the entities are copied into. It's reused
+ * between calls to avoid allocations.
+ * @param func Callable invoked for each sub-range of entities.
+ */
+template<typename View, typename Func>
+void parallel_for_each_view(entt::registry &registry, const View &view,
+                            std::vector<entt::entity> &entities, Func func) {
+    entities.clear();
+    entities.insert(entities.end(), view.begin(), view.end());
+    parallel_for_each_range(registry, entities, func);
+}
+
 }
 
 #endif // EDYN_CONTEXT_TASK_UTIL_HPP
@@ -2,6 +2,7 @@
 #define EDYN_CORE_ENTITY_GRAPH_HPP
 
 #include <array>
+#include <memory>
 #include <vector>
 #include <cstdint>
 #include <limits>
@@ -9,12 +10,67 @@
 #include <entt/entity/fwd.hpp>
 #include <entt/entity/entity.hpp>
 #include "edyn/config/config.h"
+#include "edyn/config/memory_resource.hpp"
 #include "edyn/core/entity_pair.hpp"
 
 namespace edyn {
 
 namespace internal {
     struct no_edge_visits {};
+
+    /**
+     * Visited marks and queue of node indices reused by the traversals done in
+     * one thread. An element has been visited if its mark is equal to the
+     * current epoch, thus starting a traversal increments the epoch instead of
+     * allocating and clearing the marks.
+     */
+    struct graph_visit_scratch {
+        std::vector<uint32_t> node_marks;
+        std::vector<uint32_t> edge_marks;
+        std::vector<size_t> to_visit;
+        uint32_t epoch {0};
+        bool in_use {false};
+
+        void begin(size_t num_nodes, size_t num_edges);
+    };
+
+    /**
+     * Acquires the scratch of the calling thread for the duration of one
+     * traversal, or a temporary one if a traversal is already in progress in
+     * this thread, e.g. when traversing from within a visitor function.
+     */
+    class graph_visit_scope {
+    public:
+        graph_visit_scope(size_t num_nodes, size_t num_edges);
+        ~graph_visit_scope();
+
+        graph_visit_scope(const graph_visit_scope &) = delete;
+        graph_visit_scope & operator=(const graph_visit_scope &) = delete;
+
+        bool node_visited(size_t node_index) const {
+            return m_scratch->node_marks[node_index] == m_scratch->epoch;
+        }
+
+        void set_node_visited(size_t node_index, bool visited) {
+            m_scratch->node_marks[node_index] = visited ? m_scratch->epoch : 0;
+        }
+
+        bool edge_visited(size_t edge_index) const {
+            return m_scratch->edge_marks[edge_index] == m_scratch->epoch;
+        }
+
+        void set_edge_visited(size_t edge_index) {
+            m_scratch->edge_marks[edge_index] = m_scratch->epoch;
+        }
+
+        std::vector<size_t> & to_visit() {
+            return m_scratch->to_visit;
+        }
+
+    private:
+        graph_visit_scratch *m_scratch;
+        std::unique_ptr<graph_visit_scratch> m_local;
+    };
 }
 
 /**
@@ -59,7 +115,6 @@ private:
     void remove_adjacency_edge(index_type source_node_index, index_type adj_index, index_type edge_index);
     void remove_adjacency(index_type source_node_index, index_type adj_index);
 
-    double efficiency() const;
     void optimize();
 
 public:
@@ -143,8 +198,10 @@ public:
     /**
      * Calculates and returns all connected components of this graph.
      * Non-connecting nodes are not walked through and can be present in
-     * multiple connected components.
-     * @return The connected components.
+     * multiple connected components. The components are found by uniting the
+     * nodes of each edge in a disjoint-set forest in a single pass over the
+     * edges, thus large graphs are not traversed node by node.
+     * @return The connected components, in the order of their first node.
      */
     connected_components_t connected_components() const;
 
@@ -162,17 +219,41 @@ public:
                   VisitNodeFunc visit_node_func,
                   VisitEdgeFunc visit_edge_func = {}) const;
 
+    /**
+     * @brief Stores the adjacencies of each node contiguously once enough
+     * edges were inserted or removed since the last time, which makes
+     * traversals more cache friendly. Node and edge indices do not change.
+     */
     void optimize_if_needed();
 
+    /**
+     * @brief Whether `optimize_if_needed` would store the adjacencies again.
+     */
+    bool needs_optimization() const;
+
     void clear();
 
+    /**
+     * @brief Memory allocated for nodes, edges and adjacencies, including
+     * free ones.
+     */
+    size_t num_bytes() const {
+        return m_nodes.capacity() * sizeof(node) +
+               m_edges.capacity() * sizeof(edge) +
+               m_adjacencies.capacity() * sizeof(adjacency);
+    }
+
 private:
-    std::vector<node> m_nodes;
-    std::vector<edge> m_edges;
-    std::vector<adjacency> m_adjacencies;
+    resource_vector<node> m_nodes;
+    resource_vector<edge> m_edges;
+    resource_vector<adjacency> m_adjacencies;
 
     size_t m_node_count {};
     size_t m_edge_count {};
+    size_t m_adjacency_count {};
+    // Number of adjacencies inserted or removed since they were last stored
+    // contiguously.
+    size_t m_adjacency_changes {};
 
     size_t m_nodes_free_list {null_index};
     size_t m_edges_free_list {null_index};
@@ -268,20 +349,16 @@ void entity_graph::reach(It first, It last, VisitNodeFunc visit_node_func,
                          ComponentFunc component_func) const {
     EDYN_ASSERT(std::distance(first, last) > 0);
 
-    std::vector<bool> visited;
-    std::vector<bool> visited_edges;
-    visited.assign(m_nodes.size(), false);
-    visited_edges.assign(m_edges.size(), false);
-
+    auto scope = internal::graph_visit_scope(m_nodes.size(), m_edges.size());
+    auto &to_visit = scope.to_visit();
     std::vector<index_type> non_connecting_indices;
-    std::vector<index_type> to_visit;
 
     for (auto it = first; it != last; ++it) {
         auto start_node_index = *it;
         // All provided nodes are expected to be connecting.
         EDYN_ASSERT(!m_nodes[start_node_index].non_connecting);
 
-        if (visited[start_node_index]) {
+        if (scope.node_visited(start_node_index)) {
             continue;
         }
 
@@ -296,7 +373,7 @@ void entity_graph::reach(It first, It last, VisitNodeFunc visit_node_func,
             auto node_index = to_visit.back();
             to_visit.pop_back();
 
-            visited[node_index] = true;
+            scope.set_node_visited(node_index, true);
 
             const auto &node = m_nodes[node_index];
             EDYN_ASSERT(node.entity != entt::null);
@@ -318,10 +395,10 @@ void entity_graph::reach(It first, It last, VisitNodeFunc visit_node_func,
                 while (edge_index != null_index) {
                     auto &edge = m_edges[edge_index];
 
-                    if (!visited_edges[edge_index]) {
+                    if (!scope.edge_visited(edge_index)) {
                         EDYN_ASSERT(edge.entity != entt::null);
                         visit_edge_func(edge.entity);
-                        visited_edges[edge_index] = true;
+                        scope.set_edge_visited(edge_index);
                     }
 
                     edge_index = edge.next;
@@ -330,10 +407,10 @@ void entity_graph::reach(It first, It last, VisitNodeFunc visit_node_func,
                 // Perhaps visit neighboring node and its edges next.
                 auto neighbor_index = adj.node_index;
 
-                if (!visited[neighbor_index] && should_func(neighbor_index)) {
+                if (!scope.node_visited(neighbor_index) && should_func(neighbor_index)) {
                     to_visit.emplace_back(neighbor_index);
                     // Set as visited to avoid adding it to `to_visit` more than once.
-                    visited[neighbor_index] = true;
+                    scope.set_node_visited(neighbor_index, true);
                 }
 
                 adj_index = adj.next;
@@ -347,7 +424,7 @@ void entity_graph::reach(It first, It last, VisitNodeFunc visit_node_func,
         // for the next connected components. Non-connecting nodes are shared
         // among connected components.
         for (auto node_index : non_connecting_indices) {
-            visited[node_index] = false;
+            scope.set_node_visited(node_index, false);
         }
 
         non_connecting_indices.clear();
@@ -359,24 +436,17 @@ template<typename VisitNodeFunc, typename VisitEdgeFunc>
 void entity_graph::traverse(index_type start_node_index,
                             VisitNodeFunc visit_node_func,
                             VisitEdgeFunc visit_edge_func) const {
-    std::vector<bool> visited;
-    std::vector<bool> visited_edges;
-    visited.assign(m_nodes.size(), false);
-
     constexpr auto should_visit_edges = !std::is_same_v<VisitEdgeFunc, internal::no_edge_visits>;
 
-    if constexpr(should_visit_edges) {
-        visited_edges.assign(m_edges.size(), false);
-    }
-
-    std::vector<index_type> to_visit;
+    auto scope = internal::graph_visit_scope(m_nodes.size(), m_edges.size());
+    // Nodes are visited in the order they're inserted for a breadth-first
+    // traversal, thus they're read from the front of the queue.
+    auto &to_visit = scope.to_visit();
     to_visit.push_back(start_node_index);
+    scope.set_node_visited(start_node_index, true);
 
-    while (!to_visit.empty()) {
-        auto node_index = to_visit.back();
-        to_visit.pop_back();
-
-        visited[node_index] = true;
+    for (size_t head = 0; head < to_visit.size(); ++head) {
+        auto node_index = to_visit[head];
         const auto &node = m_nodes[node_index];
         EDYN_ASSERT(node.entity != entt::null);
 
@@ -399,10 +469,10 @@ void entity_graph::traverse(index_type start_node_index,
                 while (edge_index != null_index) {
                     auto &edge = m_edges[edge_index];
 
-                    if (!visited_edges[edge_index]) {
+                    if (!scope.edge_visited(edge_index)) {
                         EDYN_ASSERT(edge.entity != entt::null);
                         visit_edge_func(edge_index);
-                        visited_edges[edge_index] = true;
+                        scope.set_edge_visited(edge_index);
                     }
 
                     edge_index = edge.next;
@@ -411,11 +481,10 @@ void entity_graph::traverse(index_type start_node_index,
 
             auto neighbor_index = adj.node_index;
 
-            if (!visited[neighbor_index]) {
-                // Insert to beginning for a breadth-first traversal.
-                to_visit.insert(to_visit.begin(), neighbor_index);
+            if (!scope.node_visited(neighbor_index)) {
+                to_visit.push_back(neighbor_index);
                 // Set as visited to avoid adding it to `to_visit` more than once.
-                visited[neighbor_index] = true;
+                scope.set_node_visited(neighbor_index, true);
             }
 
             adj_index = adj.next;
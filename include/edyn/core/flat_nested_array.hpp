@@ -91,8 +91,8 @@ public:
     friend size_t serialization_sizeof(const flat_nested_array<U> &);
 
 private:
-    std::vector<T> m_data;
-    std::vector<size_t> m_range_starts;
+    mapped_vector<T> m_data;
+    mapped_vector<size_t> m_range_starts;
 };
 
 }
@@ -0,0 +1,206 @@
+#ifndef EDYN_CORE_MAPPED_VECTOR_HPP
+#define EDYN_CORE_MAPPED_VECTOR_HPP
+
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include "edyn/config/config.h"
+
+namespace edyn {
+
+/**
+ * A contiguous array which either owns its elements in a `std::vector` or
+ * refers to read-only elements in memory owned elsewhere, such as a memory
+ * mapped file, in which case it is a view. Reading takes the same time in
+ * both cases. A view can't be modified, other than by `clear`, which turns
+ * it back into an empty owning array. Copies of a view refer to the same
+ * memory, which must outlive all of them.
+ */
+template<typename T>
+class mapped_vector {
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using const_iterator = const T *;
+
+    mapped_vector() = default;
+
+    mapped_vector(const mapped_vector &other)
+        : m_vector(other.m_vector)
+        , m_view(other.m_view)
+    {
+        if (m_view) {
+            m_data = other.m_data;
+            m_size = other.m_size;
+        } else {
+            sync();
+        }
+    }
+
+    mapped_vector(mapped_vector &&other) noexcept
+        : m_vector(std::move(other.m_vector))
+        , m_view(other.m_view)
+    {
+        if (m_view) {
+            m_data = other.m_data;
+            m_size = other.m_size;
+        } else {
+            sync();
+        }
+
+        other.reset();
+    }
+
+    mapped_vector & operator=(const mapped_vector &other) {
+        if (this != &other) {
+            auto copy = other;
+            swap(copy);
+        }
+        return *this;
+    }
+
+    mapped_vector & operator=(mapped_vector &&other) noexcept {
+        if (this != &other) {
+            auto moved = std::move(other);
+            swap(moved);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Turns this into a view of `size` elements starting at `data`.
+     * The elements are not copied.
+     */
+    void assign_view(const T *data, size_t size) {
+        decltype(m_vector){}.swap(m_vector);
+        m_data = data;
+        m_size = size;
+        m_view = true;
+    }
+
+    bool is_view() const {
+        return m_view;
+    }
+
+    size_t size() const {
+        return m_size;
+    }
+
+    bool empty() const {
+        return m_size == 0;
+    }
+
+    size_t capacity() const {
+        return m_view ? m_size : m_vector.capacity();
+    }
+
+    const T * data() const {
+        return m_data;
+    }
+
+    T * data() {
+        EDYN_ASSERT(!m_view);
+        return m_vector.data();
+    }
+
+    const T & operator[](size_t idx) const {
+        EDYN_ASSERT(idx < m_size);
+        return m_data[idx];
+    }
+
+    T & operator[](size_t idx) {
+        EDYN_ASSERT(!m_view);
+        EDYN_ASSERT(idx < m_size);
+        return m_vector[idx];
+    }
+
+    const T & front() const {
+        EDYN_ASSERT(m_size > 0);
+        return m_data[0];
+    }
+
+    const T & back() const {
+        EDYN_ASSERT(m_size > 0);
+        return m_data[m_size - 1];
+    }
+
+    const_iterator begin() const {
+        return m_data;
+    }
+
+    const_iterator end() const {
+        return m_data + m_size;
+    }
+
+    void reserve(size_t count) {
+        EDYN_ASSERT(!m_view);
+        m_vector.reserve(count);
+        sync();
+    }
+
+    void resize(size_t count) {
+        EDYN_ASSERT(!m_view);
+        m_vector.resize(count);
+        sync();
+    }
+
+    void push_back(const T &value) {
+        EDYN_ASSERT(!m_view);
+        m_vector.push_back(value);
+        sync();
+    }
+
+    template<typename... Args>
+    T & emplace_back(Args &&... args) {
+        EDYN_ASSERT(!m_view);
+        auto &value = m_vector.emplace_back(std::forward<Args>(args)...);
+        sync();
+        return value;
+    }
+
+    template<typename It>
+    void insert(const_iterator pos, It first, It last) {
+        EDYN_ASSERT(!m_view);
+        m_vector.insert(m_vector.begin() + (pos - m_data), first, last);
+        sync();
+    }
+
+    void clear() {
+        if (m_view) {
+            reset();
+        } else {
+            m_vector.clear();
+            sync();
+        }
+    }
+
+    void swap(mapped_vector &other) noexcept {
+        m_vector.swap(other.m_vector);
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        std::swap(m_view, other.m_view);
+    }
+
+private:
+    void sync() {
+        m_data = m_vector.data();
+        m_size = m_vector.size();
+    }
+
+    void reset() {
+        decltype(m_vector){}.swap(m_vector);
+        m_data = nullptr;
+        m_size = 0;
+        m_view = false;
+    }
+
+    std::vector<T> m_vector;
+    // Points into `m_vector` unless this is a view.
+    const T *m_data {nullptr};
+    size_t m_size {0};
+    bool m_view {false};
+};
+
+}
+
+#endif // EDYN_CORE_MAPPED_VECTOR_HPP
@@ -0,0 +1,103 @@
+#ifndef EDYN_DYNAMICS_ARTICULATION_HPP
+#define EDYN_DYNAMICS_ARTICULATION_HPP
+
+#include <array>
+#include <limits>
+#include <vector>
+#include "edyn/math/scalar.hpp"
+#include "edyn/constraints/constraint_row.hpp"
+#include "edyn/dynamics/solver_body.hpp"
+
+namespace edyn {
+
+/**
+ * A tree of rigid bodies connected by joints whose bilateral rows, i.e. rows
+ * without impulse limits, are solved exactly instead of iteratively. The
+ * bodies and joints are the nodes of the tree and the linear system of the
+ * rows, in the form `[M J^T; J 0]`, is factored by eliminating the nodes from
+ * the leaves to the root, which causes no fill-in and takes linear time,
+ * according to _Linear-Time Dynamics using Lagrange Multipliers, David Baraff,
+ * 1996_. The other rows of the joints, such as limits, and contacts are still
+ * solved iteratively and see the articulation as one block of rows which is
+ * solved once per iteration.
+ */
+struct articulation {
+    static constexpr unsigned max_node_size = 6;
+    static constexpr unsigned no_parent = std::numeric_limits<unsigned>::max();
+
+    using block = std::array<std::array<scalar, max_node_size>, max_node_size>;
+
+    struct node {
+        // Index of the parent node, or `no_parent` for the root.
+        unsigned parent;
+        // Six for bodies, number of rows for joints.
+        unsigned size;
+        bool is_body;
+        // Index of the solver body of a body node.
+        solver_body_index_t body;
+        // Indices of the rows of a joint node in the array of rows.
+        std::array<unsigned, max_node_size> rows;
+        // Inverse of the diagonal block of the node after the elimination of
+        // its children.
+        block D_inv;
+        // `D_inv` times the block which couples the node with its parent.
+        block L;
+        // Right hand side, and then solution, of the node while solving.
+        std::array<scalar, max_node_size> x;
+    };
+
+    // Nodes in elimination order, where children come before their parent.
+    std::vector<node> nodes;
+};
+
+/**
+ * Rows of one joint which can be part of an articulation.
+ */
+struct articulation_joint {
+    // Index of the first row in the array of rows. All rows of the joint
+    // share the same pair of bodies.
+    unsigned first_row;
+    unsigned num_rows;
+};
+
+/**
+ * @brief Whether a row has no impulse limits and thus can be solved in an
+ * articulation.
+ * @param row The row.
+ * @return Whether the row is bilateral.
+ */
+bool can_solve_in_articulation(const constraint_row &row);
+
+/**
+ * @brief Groups the bilateral rows of the joints into articulations which are
+ * ready to be solved. Bodies with zero inverse mass act as the ground, which
+ * is left out of the trees. Joints which would close a loop with the joints
+ * before them, including a second joint between a tree and the ground, are
+ * left out, as are trees whose rows are redundant.
+ * @param joints The joints in the order of preference.
+ * @param rows All rows.
+ * @param bodies Solver bodies referenced by the rows.
+ * @param articulations Articulations are appended to this array.
+ * @param articulated_rows Sorted indices of the rows which were added to an
+ * articulation, which must be skipped when solving rows one at a time.
+ */
+void make_articulations(const std::vector<articulation_joint> &joints,
+                        const std::vector<constraint_row> &rows,
+                        const std::vector<solver_body> &bodies,
+                        std::vector<articulation> &articulations,
+                        std::vector<unsigned> &articulated_rows);
+
+/**
+ * @brief Solves all rows of the articulation together and applies the
+ * impulses to the bodies.
+ * @param art The articulation.
+ * @param rows All rows.
+ * @param bodies Solver bodies referenced by the rows.
+ * @return Largest magnitude of the delta impulses applied.
+ */
+scalar solve_articulation(articulation &art, std::vector<constraint_row> &rows,
+                          std::vector<solver_body> &bodies);
+
+}
+
+#endif // EDYN_DYNAMICS_ARTICULATION_HPP
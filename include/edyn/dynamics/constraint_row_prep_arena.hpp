@@ -0,0 +1,81 @@
+#ifndef EDYN_DYNAMICS_CONSTRAINT_ROW_PREP_ARENA_HPP
+#define EDYN_DYNAMICS_CONSTRAINT_ROW_PREP_ARENA_HPP
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include "edyn/config/memory_resource.hpp"
+#include "edyn/constraints/constraint_row.hpp"
+#include "edyn/constraints/constraint_row_options.hpp"
+#include "edyn/constraints/constraint_row_friction.hpp"
+#include "edyn/constraints/constraint_row_spin_friction.hpp"
+
+namespace edyn {
+
+/**
+ * A constraint row and its friction rows as set up during constraint
+ * preparation, before being packed into a `row_cache`.
+ */
+struct constraint_row_prep_element {
+    constraint_row row;
+    constraint_row_options options;
+    uint8_t flags; // Whether this row has friction.
+    constraint_row_friction friction;
+    constraint_row_friction rolling;
+    constraint_row_spin_friction spinning;
+};
+
+/**
+ * Contiguous storage for the rows prepared in one step by one task, where
+ * each constraint entity appends exactly the rows it needs.
+ */
+struct constraint_row_prep_arena {
+    resource_vector<constraint_row_prep_element> elements;
+
+    constraint_row_prep_arena(memory_resource *resource)
+        : elements(allocator<constraint_row_prep_element>(resource))
+    {}
+
+    // Ensures `count` more rows can be appended without reallocating, thus
+    // references to rows appended in the meantime remain valid.
+    void reserve_rows(size_t count) {
+        auto required = elements.size() + count;
+
+        if (elements.capacity() < required) {
+            elements.reserve(std::max(elements.capacity() * 2, required));
+        }
+    }
+};
+
+/**
+ * Arenas used during constraint preparation. Each task preparing constraints
+ * acquires its own arena, thus preparation can run in parallel without
+ * appending rows to a shared buffer. Arenas keep their capacity between
+ * steps, which makes them the scratch memory of the step. They are allocated
+ * from the memory resource which was current when the pool was created,
+ * since they're usually created in the worker threads of the dispatcher.
+ */
+class constraint_row_prep_arena_pool {
+public:
+    // Returns an arena which is not in use by any other task. Thread-safe.
+    constraint_row_prep_arena & acquire();
+
+    // Clears all arenas and makes them available again. The rows of the
+    // previous step become invalid.
+    void reset();
+
+    // Memory allocated for the rows of all arenas.
+    size_t num_bytes();
+
+private:
+    std::vector<std::unique_ptr<constraint_row_prep_arena>> m_arenas;
+    size_t m_num_acquired {0};
+    memory_resource *m_resource {memory_resource::current()};
+    std::mutex m_mutex;
+};
+
+}
+
+#endif // EDYN_DYNAMICS_CONSTRAINT_ROW_PREP_ARENA_HPP
@@ -14,7 +14,13 @@ namespace edyn {
  * go over constraint entities per constraint type.
  */
 struct island_constraint_entities {
-    std::array<std::vector<entt::entity>, std::tuple_size_v<constraints_tuple_t>> entities;
+    using entity_array = std::array<std::vector<entt::entity>, std::tuple_size_v<constraints_tuple_t>>;
+    entity_array entities;
+
+    // Entities collected in the current step before packing, which are
+    // compared with the entities of the previous step to tell whether the
+    // rows can be refreshed in place, and are swapped with them otherwise.
+    entity_array next_entities;
 };
 
 }
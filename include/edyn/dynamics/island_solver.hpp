@@ -2,19 +2,86 @@
 #define EDYN_DYNAMICS_ISLAND_SOLVER_HPP
 
 #include "edyn/math/scalar.hpp"
+#include <cstddef>
+#include <cstdint>
 #include <entt/entity/fwd.hpp>
 
 namespace edyn {
 
 class atomic_counter_sync;
+struct settings;
 
+/**
+ * @brief Stages of the island solver. When an island is solved asynchronously,
+ * each stage runs in one or more tasks.
+ */
+enum class island_solver_state : uint8_t {
+    pack_rows,
+    solve_constraints,
+    assign_applied_impulses,
+    apply_solution,
+    solve_position_constraints,
+    update_nodes
+};
+
+inline constexpr size_t num_island_solver_states = 6;
+
+/**
+ * @brief Iteration parameters of the island solver. See the corresponding
+ * members in `edyn::settings`.
+ */
+struct island_solver_params {
+    unsigned num_velocity_iterations;
+    unsigned min_velocity_iterations;
+    unsigned num_position_iterations;
+    unsigned num_substeps;
+    scalar velocity_tolerance;
+    bool block_contacts;
+    bool articulate_distance_chains;
+    bool collect_stats;
+    bool deterministic;
+};
+
+island_solver_params make_island_solver_params(const settings &settings);
+
+/**
+ * @brief Runs the constraint solver for one island asynchronously, as a
+ * sequence of tasks. Once the island is solved, the state of its nodes that
+ * depends on their transforms is updated via `update_island_nodes` and then
+ * the counter is decremented.
+ */
 void run_island_solver_seq_mt(entt::registry &, entt::entity island_entity,
-                              unsigned num_iterations, unsigned num_position_iterations,
-                              scalar dt, atomic_counter_sync *counter);
+                              const island_solver_params &params, scalar dt,
+                              atomic_counter_sync *counter);
+
+/**
+ * @brief Runs the constraint solver for a batch of islands asynchronously, in
+ * a single job which solves one island after the other as in
+ * `run_island_solver_seq`. The counter is decremented once all of them are
+ * solved. The arrays must remain valid until then.
+ * @param island_entities Islands to be solved.
+ * @param params Iteration parameters of each island.
+ * @param count Number of islands.
+ */
+void run_island_solver_batch_mt(entt::registry &, const entt::entity *island_entities,
+                                const island_solver_params *const *params, size_t count,
+                                scalar dt, atomic_counter_sync *counter);
 
+/**
+ * @brief Runs the constraint solver for one island in the current thread and
+ * then updates the state of its nodes via `update_island_nodes`.
+ * @param params Iteration parameters. If `num_substeps` is greater than one,
+ * the velocity iterations are distributed among substeps.
+ * @param color Whether to partition the constraint rows by graph coloring,
+ * which changes the order in which rows are solved.
+ * @param mt Whether to solve colored rows with no bodies in common in parallel
+ * using `enqueue_task_wait`, which gives the same result as solving them in
+ * the current thread. It can be called from within a worker job, in which
+ * case the worker runs pending jobs while it waits for the rows.
+ */
 void run_island_solver_seq(entt::registry &, entt::entity island_entity,
-                           unsigned num_iterations, unsigned num_position_iterations,
-                           scalar dt);
+                           const island_solver_params &params, scalar dt,
+                           bool color = false, bool mt = false);
 
 }
 
@@ -0,0 +1,58 @@
+#ifndef EDYN_DYNAMICS_ISLAND_SOLVER_STATS_HPP
+#define EDYN_DYNAMICS_ISLAND_SOLVER_STATS_HPP
+
+#include <array>
+#include "edyn/math/scalar.hpp"
+#include "edyn/constraints/constraint.hpp"
+#include "edyn/dynamics/island_solver.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Convergence statistics of the constraint solver in the last step of
+ * an island. Assigned to island entities while `settings::collect_solver_stats`
+ * is enabled. It is a shared component, thus in asynchronous mode it can be
+ * read from the islands in the main registry after each step update.
+ */
+struct island_solver_stats {
+    // Largest delta impulse applied by a row in the first and last velocity
+    // iterations.
+    scalar initial_residual {};
+    scalar final_residual {};
+
+    unsigned num_velocity_iterations {};
+    unsigned num_position_iterations {};
+
+    // Number of normal rows of each constraint type, in the same order as in
+    // `constraints_tuple`. Friction rows are not included.
+    std::array<unsigned, std::tuple_size_v<constraints_tuple_t>> num_rows {};
+
+    // Number of normal rows which started with a non-zero impulse carried
+    // over from the previous step.
+    unsigned num_warm_started_rows {};
+
+    // Time in seconds spent in each `island_solver_state`. In asynchronous
+    // islands, this is the time spent in the tasks of the island itself, not
+    // including the work distributed among worker threads by `apply_solution`.
+    std::array<double, num_island_solver_states> state_time {};
+
+    unsigned total_rows() const {
+        unsigned total = 0;
+
+        for (auto count : num_rows) {
+            total += count;
+        }
+
+        return total;
+    }
+
+    // Fraction of the normal rows which were warm-started.
+    scalar warm_start_ratio() const {
+        auto total = total_rows();
+        return total > 0 ? scalar(num_warm_started_rows) / scalar(total) : scalar(0);
+    }
+};
+
+}
+
+#endif // EDYN_DYNAMICS_ISLAND_SOLVER_STATS_HPP
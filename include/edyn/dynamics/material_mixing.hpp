@@ -2,8 +2,10 @@
 #define EDYN_DYNAMICS_MATERIAL_MIXING_HPP
 
 #include <limits>
-#include <map>
+#include <vector>
+#include <cstdint>
 #include <utility>
+#include "edyn/config/config.h"
 #include "edyn/core/unordered_pair.hpp"
 #include "edyn/comp/material.hpp"
 
@@ -33,47 +35,103 @@ inline scalar material_mix_damping(scalar a, scalar b) {
     return 1 / (1 / a + 1 / b);
 }
 
+/**
+ * @brief Material properties for specific pairs of material ids, which
+ * override the mixing of the properties of the two materials. It is looked up
+ * whenever contact points are created, thus it uses an open-addressing hash
+ * table with linear probing keyed by the pair of ids packed into a single
+ * integer, where the order of the ids does not matter.
+ */
 class material_mix_table {
 public:
     using pair_type = unordered_pair<material::id_type>;
 
     bool contains(const pair_type &pair) const {
-        return m_table.count(pair) != 0;
+        return find(pack_pair(pair)) != npos_slot;
     }
 
-    void insert(const pair_type &pair, const material_base &material) {
-    #ifndef EDYN_DISABLE_ASSERT
-        EDYN_ASSERT(pair.first != std::numeric_limits<material::id_type>::max());
-        EDYN_ASSERT(pair.second != std::numeric_limits<material::id_type>::max());
-    #endif
-        m_table[pair] = material;
-    }
+    void insert(const pair_type &pair, const material_base &material);
 
     material_base & get(const pair_type &pair) {
-        return m_table.at(pair);
+        auto i = find(pack_pair(pair));
+        EDYN_ASSERT(i != npos_slot);
+        return m_slots[i].material;
     }
 
     const material_base & get(const pair_type &pair) const {
-        return m_table.at(pair);
+        auto i = find(pack_pair(pair));
+        EDYN_ASSERT(i != npos_slot);
+        return m_slots[i].material;
     }
 
     const material_base * try_get(const pair_type &pair) const {
-        if (m_table.count(pair)) {
-            return &m_table.at(pair);
-        }
-        return nullptr;
+        auto i = find(pack_pair(pair));
+        return i != npos_slot ? &m_slots[i].material : nullptr;
     }
 
     material_base * try_get(const pair_type &pair) {
         return const_cast<material_base *>(std::as_const(*this).try_get(pair));
     }
 
-    void remove(const pair_type &pair) {
-        m_table.erase(pair);
+    void remove(const pair_type &pair);
+
+    size_t size() const {
+        return m_size;
+    }
+
+    bool empty() const {
+        return m_size == 0;
     }
 
 private:
-    std::map<pair_type, material_base> m_table;
+    struct slot {
+        uint32_t key;
+        material_base material;
+    };
+
+    // Key of slots not in use. It corresponds to a pair of unassigned ids,
+    // which cannot be inserted.
+    static constexpr uint32_t empty_key = ~uint32_t{0};
+    static constexpr size_t npos_slot = ~size_t{0};
+
+    static uint32_t pack_pair(const pair_type &pair) {
+        auto a = static_cast<uint32_t>(pair.first);
+        auto b = static_cast<uint32_t>(pair.second);
+        return a < b ? (a << 16) | b : (b << 16) | a;
+    }
+
+    static size_t hash_key(uint32_t key) {
+        // Fibonacci hashing, which takes the high bits of the product, thus
+        // nearby ids map to distant slots.
+        return static_cast<size_t>((uint64_t{key} * 0x9e3779b97f4a7c15ull) >> 32);
+    }
+
+    size_t find(uint32_t key) const {
+        if (m_slots.empty()) {
+            return npos_slot;
+        }
+
+        auto mask = m_slots.size() - 1;
+
+        for (auto i = hash_key(key) & mask;; i = (i + 1) & mask) {
+            auto slot_key = m_slots[i].key;
+
+            if (slot_key == key) {
+                return i;
+            }
+
+            // The table is never full thus an empty slot is always found.
+            if (slot_key == empty_key) {
+                return npos_slot;
+            }
+        }
+    }
+
+    void rehash(size_t capacity);
+
+    // Number of slots is zero or a power of two.
+    std::vector<slot> m_slots;
+    size_t m_size {0};
 };
 
 }
@@ -0,0 +1,91 @@
+#ifndef EDYN_DYNAMICS_NBODY_OCTREE_HPP
+#define EDYN_DYNAMICS_NBODY_OCTREE_HPP
+
+#include <cstdint>
+#include <vector>
+#include "edyn/math/vector3.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Octree of point masses which approximates the gravitational field
+ * of all of them at a point in logarithmic time using the Barnes-Hut
+ * algorithm, i.e. the masses in a cell which is far enough from the point
+ * are replaced by a single mass at their center of mass.
+ */
+class nbody_octree {
+public:
+    // Maximum number of masses in a leaf.
+    static constexpr size_t max_leaf_size = 4;
+    // Maximum depth of a leaf, which limits the subdivision when many masses
+    // are very close to one another or coincide.
+    static constexpr unsigned max_depth = 24;
+
+    struct node {
+        vector3 center_of_mass;
+        scalar mass;
+        // Length of the sides of the cubic cell.
+        scalar size;
+        // Children are contiguous, starting at `first_child`. Leaves have no
+        // children and contain the masses in `[first, first + count)`.
+        uint32_t first_child;
+        uint32_t num_children;
+        uint32_t first;
+        uint32_t count;
+    };
+
+    struct point_mass {
+        vector3 position;
+        scalar mass;
+    };
+
+    /**
+     * @brief Removes all masses and nodes. Memory is kept to be reused.
+     */
+    void clear();
+
+    /**
+     * @brief Adds a point mass. It becomes part of the tree once `build` is
+     * called.
+     */
+    void insert(const vector3 &position, scalar mass);
+
+    /**
+     * @brief Builds the tree from the inserted masses.
+     */
+    void build();
+
+    /**
+     * @brief Calculates the acceleration due to gravity at a point, without
+     * the gravitational constant, i.e. the sum of `m * d / |d|^3` over all
+     * masses, where `d` is the vector from the point to the mass.
+     * @param point Where to evaluate the field.
+     * @param theta Opening angle. A cell is approximated by its center of
+     * mass if its size divided by its distance to the point is less than
+     * this value. Zero sums all masses directly.
+     * @param softening Length added in quadrature to the distances, which
+     * avoids singularities when masses get very close.
+     * @return Acceleration at the point. Masses located exactly at the point
+     * have no effect, thus the acceleration of an inserted mass can be
+     * queried at its position.
+     */
+    vector3 acceleration(const vector3 &point, scalar theta, scalar softening) const;
+
+    bool empty() const {
+        return m_masses.empty();
+    }
+
+    const std::vector<node> & nodes() const {
+        return m_nodes;
+    }
+
+private:
+    void subdivide(uint32_t node_index, const vector3 &min, unsigned depth);
+
+    std::vector<point_mass> m_masses;
+    std::vector<node> m_nodes;
+};
+
+}
+
+#endif // EDYN_DYNAMICS_NBODY_OCTREE_HPP
@@ -7,11 +7,30 @@
 #include "edyn/comp/position.hpp"
 #include "edyn/math/transform.hpp"
 #include "edyn/util/constraint_util.hpp"
+#include "edyn/dynamics/position_solver_body.hpp"
 
 namespace edyn {
 
 class position_solver {
 public:
+    position_solver() = default;
+
+    position_solver(position_solver_body &bodyA, position_solver_body &bodyB)
+        : originA(bodyA.has_origin ? &bodyA.orig : nullptr)
+        , originB(bodyB.has_origin ? &bodyB.orig : nullptr)
+        , comA(bodyA.com)
+        , comB(bodyB.com)
+        , posA(&bodyA.pos)
+        , posB(&bodyB.pos)
+        , ornA(&bodyA.orn)
+        , ornB(&bodyB.orn)
+        , inv_mA(bodyA.inv_m)
+        , inv_mB(bodyB.inv_m)
+        , inv_IA(&bodyA.inv_I)
+        , inv_IB(&bodyB.inv_I)
+        , inv_IA_local(&bodyA.inv_I_local)
+        , inv_IB_local(&bodyB.inv_I_local)
+    {}
 
     void solve(const std::array<vector3, 4> &J, scalar error) {
         auto eff_mass = get_effective_mass(J, inv_mA, *inv_IA, inv_mB, *inv_IB);
@@ -0,0 +1,48 @@
+#ifndef EDYN_DYNAMICS_POSITION_SOLVER_BODY_HPP
+#define EDYN_DYNAMICS_POSITION_SOLVER_BODY_HPP
+
+#include <array>
+#include "edyn/comp/inertia.hpp"
+#include "edyn/comp/orientation.hpp"
+#include "edyn/comp/origin.hpp"
+#include "edyn/comp/position.hpp"
+#include "edyn/dynamics/solver_body.hpp"
+
+namespace edyn {
+
+/**
+ * Copy of the state of a rigid body used by the position solver. The bodies
+ * of an island are packed into an array before the position iterations and
+ * the transforms are written back into the registry after. Non-procedural
+ * bodies have zero inverse mass and inertia and each constraint gets its own
+ * copy of them, thus constraints which do not share a procedural body never
+ * touch the same memory.
+ */
+struct position_solver_body {
+    position pos;
+    orientation orn;
+    origin orig;
+    vector3 com;
+    bool has_origin;
+    scalar inv_m;
+    inertia_world_inv inv_I;
+    inertia_inv inv_I_local;
+};
+
+/**
+ * Reference to a constraint solved by the position solver and the indices of
+ * its bodies in the array of `position_solver_body`.
+ */
+struct position_constraint_entry {
+    // Index of the constraint type in `constraints_tuple`.
+    unsigned type;
+
+    // Index of the constraint entity in `island_constraint_entities`.
+    unsigned entity_index;
+
+    std::array<solver_body_index_t, 2> body;
+};
+
+}
+
+#endif // EDYN_DYNAMICS_POSITION_SOLVER_BODY_HPP
@@ -6,7 +6,15 @@
 
 namespace edyn {
 
-void solve_restitution(entt::registry &registry, scalar dt);
+/**
+ * @brief Applies restitution impulses to contacts that are penetrating fast
+ * enough, before gravity is applied.
+ * @param registry Data source.
+ * @param dt Time step.
+ * @param mt Whether to solve islands in parallel using `enqueue_task_wait`.
+ * Must not be called from within a worker job if true.
+ */
+void solve_restitution(entt::registry &registry, scalar dt, bool mt = false);
 
 }
 
@@ -1,6 +1,7 @@
 #ifndef EDYN_DYNAMICS_ROW_CACHE_HPP
 #define EDYN_DYNAMICS_ROW_CACHE_HPP
 
+#include <array>
 #include <type_traits>
 #include <vector>
 #include <tuple>
@@ -9,6 +10,16 @@
 #include "edyn/constraints/constraint_row_options.hpp"
 #include "edyn/constraints/constraint_row_friction.hpp"
 #include "edyn/constraints/constraint_row_spin_friction.hpp"
+#include "edyn/constraints/constraint_row_block.hpp"
+#include "edyn/constraints/breakable_constraint.hpp"
+#include "edyn/dynamics/articulation.hpp"
+#include "edyn/dynamics/solver_body.hpp"
+#include "edyn/dynamics/position_solver_body.hpp"
+#include "edyn/dynamics/constraint_row_prep_arena.hpp"
+
+#ifdef EDYN_SIMD_SOLVER
+#include "edyn/dynamics/row_cache_soa.hpp"
+#endif
 
 namespace edyn {
 
@@ -16,6 +27,35 @@ static constexpr uint8_t constraint_row_flag_friction          = 1 << 0;
 static constexpr uint8_t constraint_row_flag_rolling_friction  = 1 << 1;
 static constexpr uint8_t constraint_row_flag_spinning_friction = 1 << 2;
 
+/**
+ * Reference to a normal row and its friction rows in a `row_cache`. Friction
+ * indices are only valid if the corresponding flag is set for the row.
+ */
+struct row_color_entry {
+    unsigned row;
+    unsigned friction;
+    unsigned rolling;
+    unsigned spinning;
+};
+
+/**
+ * Terms of the right hand side of a normal row which are kept separately so
+ * the position error can be updated in every substep. See
+ * `settings::num_solver_substeps`.
+ */
+struct row_substep_entry {
+    // Right hand side without the position error term.
+    scalar velocity_rhs;
+
+    // Position error at the start of the step divided by the step duration
+    // (i.e. `constraint_row_options::error`).
+    scalar error;
+
+    // Error reduction parameter. Zero for rows which do not correct position
+    // error, whose right hand side remains constant.
+    scalar erp;
+};
+
 /**
  * Stores the constraint rows for all constraints in an island, packed in a
  * contiguous array. It is assigned as a component for each island.
@@ -23,6 +63,9 @@ static constexpr uint8_t constraint_row_flag_spinning_friction = 1 << 2;
 struct row_cache {
     std::vector<constraint_row> rows;
 
+    // Bodies referenced by the rows. See `solver_body`.
+    std::vector<solver_body> bodies;
+
     // When packing rows, after appending rows for one constraint into the
     // `rows` array, the number of rows appended is inserted into this array.
     std::vector<uint8_t> con_num_rows;
@@ -36,43 +79,137 @@ struct row_cache {
     std::vector<constraint_row_friction> rolling;
     std::vector<constraint_row_spin_friction> spinning;
 
+    // Rows grouped by color, where the rows of one color do not share any
+    // dynamic body and can be solved in parallel. Only assigned for islands
+    // that are large enough to be solved in parallel. See `color_rows`.
+    std::vector<row_color_entry> color_entries;
+
+    // Offset of the first entry of each color in `color_entries` plus one
+    // past the last entry.
+    std::vector<unsigned> color_offsets;
+
+    // Whether the last color holds rows that could not be colored, which
+    // must be solved sequentially.
+    bool has_overflow_color {false};
+
+    // Indices of the normal rows where both bodies are dynamic and of the
+    // rows where only the first or only the second body is dynamic, which
+    // are solved with the one-sided row functions. Only assigned if
+    // `rows_partitioned` is true, in which case the normal rows are solved
+    // group by group instead of in the order they were inserted.
+    std::vector<unsigned> two_sided_rows;
+    std::array<std::vector<unsigned>, 2> one_sided_rows;
+    bool rows_partitioned {false};
+
+    // Groups of normal rows of contact manifolds which are solved together,
+    // sorted by first row. Only assigned if the contact block solver is
+    // enabled and the island is not colored. See `constraint_row_block`.
+    std::vector<constraint_row_block> blocks;
+
+    // Trees of constraints with an `articulation_tag` whose bilateral rows
+    // are solved exactly, and the sorted indices of these rows, which are
+    // skipped when solving the other rows. Only assigned if the island is not
+    // colored. See `articulation`.
+    std::vector<articulation> articulations;
+    std::vector<unsigned> articulated_rows;
+
+    // Substepping state of each body and normal row. Only assigned if the
+    // island is solved in substeps.
+    std::vector<solver_body_substep> body_substeps;
+    std::vector<row_substep_entry> row_substeps;
+
+    // Bodies and constraints of the position solver. The first body is unused
+    // and it is followed by one body per node in the same order as in the
+    // packed array of `island.nodes`, like the velocity solver bodies, then
+    // by the copies of the non-procedural bodies. Entries are grouped by
+    // color if the island is solved in parallel.
+    std::vector<position_solver_body> position_bodies;
+    std::vector<position_constraint_entry> position_entries;
+    std::vector<unsigned> position_color_offsets;
+    bool position_has_overflow_color {false};
+
+    // Constraints whose impulse exceeded the threshold of their
+    // `breakable_constraint` when the impulses were assigned, which are
+    // destroyed once all islands are solved.
+    std::vector<constraint_break_event> broken_constraints;
+
+    // Number of velocity iterations done when the island was last solved,
+    // which can be less than the maximum in adaptive mode. Not reset on clear.
+    unsigned num_velocity_iterations {0};
+
+#ifdef EDYN_SIMD_SOLVER
+    // Normal rows grouped in batches of independent rows which are solved
+    // together using SIMD instructions.
+    row_cache_soa soa;
+#endif
+
     void clear() {
         rows.clear();
+        bodies.clear();
         con_num_rows.clear();
         flags.clear();
         friction.clear();
         rolling.clear();
         spinning.clear();
+        color_entries.clear();
+        color_offsets.clear();
+        has_overflow_color = false;
+        blocks.clear();
+        articulations.clear();
+        articulated_rows.clear();
+        broken_constraints.clear();
+        two_sided_rows.clear();
+        one_sided_rows[0].clear();
+        one_sided_rows[1].clear();
+        rows_partitioned = false;
+        body_substeps.clear();
+        row_substeps.clear();
+        position_bodies.clear();
+        position_entries.clear();
+        position_color_offsets.clear();
+        position_has_overflow_color = false;
+#ifdef EDYN_SIMD_SOLVER
+        soa.clear();
+#endif
+    }
+
+    // Memory allocated for all arrays.
+    size_t num_bytes() const {
+        auto capacity_bytes = [](auto &... vectors) {
+            return ((vectors.capacity() * sizeof(typename std::decay_t<decltype(vectors)>::value_type)) + ...);
+        };
+
+        return capacity_bytes(rows, bodies, con_num_rows, flags, friction, rolling, spinning,
+                              color_entries, color_offsets, two_sided_rows,
+                              one_sided_rows[0], one_sided_rows[1], blocks,
+                              articulations, articulated_rows, broken_constraints,
+                              body_substeps, row_substeps, position_bodies,
+                              position_entries, position_color_offsets)
+#ifdef EDYN_SIMD_SOLVER
+            + capacity_bytes(soa.batches)
+#endif
+            ;
     }
 };
 
 /**
  * During constraint preparation, which happens right before solving, all
- * constraint rows are inserted into this component. This allows preparation
- * to be run in parallel with per-constraint granularity since they're not
- * appending rows to a shared buffer. They are then packed together into a
- * `row_cache` for better performance during the solver iterations.
+ * constraint rows are inserted into an arena and this component, assigned to
+ * each constraint entity, refers to its rows in the arena. This allows
+ * preparation to be run in parallel with per-constraint granularity since
+ * each task appends rows to its own arena. They are then packed together into
+ * a `row_cache` for better performance during the solver iterations.
  */
 struct constraint_row_prep_cache {
     static constexpr unsigned max_rows = 16;
     static constexpr unsigned max_constraints = 8;
 
-    struct element {
-        constraint_row row;
-        constraint_row_options options;
-        uint8_t flags; // Whether this row has friction.
-        constraint_row_friction friction;
-        constraint_row_friction rolling;
-        constraint_row_spin_friction spinning;
-
-        void clear() {
-            flags = 0;
-            options = {};
-        }
-    };
+    using element = constraint_row_prep_element;
 
-    // All rows in this entity.
-    std::array<element, max_rows> rows;
+    // Arena where the rows were stored in the current step and index of the
+    // first row in it. The rows of one entity are contiguous.
+    constraint_row_prep_arena *arena;
+    uint32_t first_row;
     uint8_t num_rows;
 
     // Number of rows per constraint in the same order they appear in the
@@ -86,26 +223,56 @@ struct constraint_row_prep_cache {
     // are "consumed" per constraint.
     uint8_t current_constraint_index;
 
+    // Index in `constraints_tuple` of the type of the constraint in this
+    // entity, or `multiple_types` if it has more than one or if it's not
+    // known, and the number of the preparation it was assigned in. These are
+    // assigned while going over the storage of each constraint type before
+    // preparation and allow constraints to be grouped by type without checking
+    // whether the entity is in the storage of every type. They're kept when
+    // the cache is cleared.
+    static constexpr uint8_t multiple_types = UINT8_MAX;
+    uint8_t type_index {multiple_types};
+    uint32_t collect_step {0};
+
     constraint_row_prep_cache() {
         clear();
     }
 
+    // Clears the cache and starts appending rows to the given arena.
+    void begin(constraint_row_prep_arena &arena) {
+        clear();
+        this->arena = &arena;
+        first_row = static_cast<uint32_t>(arena.elements.size());
+        // Prevent reallocation thus rows returned by `add_row` remain valid
+        // while the constraints in this entity are prepared.
+        arena.reserve_rows(max_rows);
+    }
+
     void add_constraint() {
         ++num_constraints;
     }
 
+    element & get_element(unsigned index) {
+        EDYN_ASSERT(index < num_rows);
+        return arena->elements[first_row + index];
+    }
+
     constraint_row & add_row() {
+        EDYN_ASSERT(arena != nullptr);
         EDYN_ASSERT(num_rows < max_rows);
         EDYN_ASSERT(num_constraints > 0);
+        EDYN_ASSERT(arena->elements.size() == first_row + num_rows);
         ++rows_per_constraint[num_constraints - 1];
-        auto &elem = rows[num_rows++];
+        ++num_rows;
+        auto &elem = arena->elements.emplace_back();
         elem.flags = 0;
+        elem.options = {};
         return elem.row;
     }
 
     constraint_row_friction & add_friction_row() {
         EDYN_ASSERT(num_constraints > 0);
-        auto &curr_row = rows[num_rows - 1];
+        auto &curr_row = get_element(num_rows - 1);
         EDYN_ASSERT(!(curr_row.flags & constraint_row_flag_friction));
         curr_row.flags |= constraint_row_flag_friction;
         return curr_row.friction;
@@ -113,7 +280,7 @@ struct constraint_row_prep_cache {
 
     constraint_row_friction & add_rolling_row() {
         EDYN_ASSERT(num_constraints > 0);
-        auto &curr_row = rows[num_rows - 1];
+        auto &curr_row = get_element(num_rows - 1);
         EDYN_ASSERT(!(curr_row.flags & constraint_row_flag_rolling_friction));
         curr_row.flags |= constraint_row_flag_rolling_friction;
         return curr_row.rolling;
@@ -121,7 +288,7 @@ struct constraint_row_prep_cache {
 
     constraint_row_spin_friction & add_spinning_row() {
         EDYN_ASSERT(num_constraints > 0);
-        auto &curr_row = rows[num_rows - 1];
+        auto &curr_row = get_element(num_rows - 1);
         EDYN_ASSERT(!(curr_row.flags & constraint_row_flag_spinning_friction));
         curr_row.flags |= constraint_row_flag_spinning_friction;
         return curr_row.spinning;
@@ -130,7 +297,7 @@ struct constraint_row_prep_cache {
     // Get preparation options for the current row.
     constraint_row_options & get_options() {
         EDYN_ASSERT(num_constraints > 0);
-        auto &curr_row = rows[num_rows - 1];
+        auto &curr_row = get_element(num_rows - 1);
         return curr_row.options;
     }
 
@@ -148,7 +315,7 @@ struct constraint_row_prep_cache {
         auto end_index = start_index + rows_per_constraint[current_constraint_index];
 
         for (auto i = start_index; i < end_index; ++i) {
-            func(rows[i]);
+            func(get_element(i));
         }
 
         ++current_constraint_index;
@@ -162,14 +329,12 @@ struct constraint_row_prep_cache {
     }
 
     void clear() {
+        arena = nullptr;
+        first_row = 0;
         num_rows = 0;
         num_constraints = 0;
         current_constraint_index = 0;
 
-        for (auto &elem : rows) {
-            elem.clear();
-        }
-
         for (auto &c : rows_per_constraint) {
             c = 0;
         }
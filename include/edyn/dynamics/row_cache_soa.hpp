@@ -0,0 +1,88 @@
+#ifndef EDYN_DYNAMICS_ROW_CACHE_SOA_HPP
+#define EDYN_DYNAMICS_ROW_CACHE_SOA_HPP
+
+#include <array>
+#include <vector>
+#include "edyn/math/simd.hpp"
+#include "edyn/constraints/constraint_row.hpp"
+#include "edyn/dynamics/solver_body.hpp"
+
+namespace edyn {
+
+/**
+ * A group of up to `simd_width` constraint rows that do not share any dynamic
+ * body, stored as a structure of arrays where each row occupies one lane.
+ * Since no two lanes touch the same body, all rows in a batch can be solved
+ * simultaneously.
+ */
+struct constraint_row_batch {
+    // Jacobian components. The first index is `3 * j + c` where `j` is the
+    // index of the Jacobian vector and `c` is the vector component.
+    alignas(simd_alignment) scalar J[12][simd_width];
+
+    // Jacobian premultiplied by the inverse mass or inverse inertia of the
+    // corresponding body, i.e. `M^-1 J^T`, which is what gets applied to the
+    // delta velocities after each row is solved.
+    alignas(simd_alignment) scalar MJ[12][simd_width];
+
+    alignas(simd_alignment) scalar eff_mass[simd_width];
+    alignas(simd_alignment) scalar rhs[simd_width];
+    alignas(simd_alignment) scalar lower_limit[simd_width];
+    alignas(simd_alignment) scalar upper_limit[simd_width];
+    alignas(simd_alignment) scalar impulse[simd_width];
+
+    // Index of the source row in `row_cache::rows` for each lane.
+    std::array<unsigned, simd_width> row_index;
+
+    // Index of the solver bodies of each lane.
+    std::array<solver_body_index_t, simd_width> bodyA, bodyB;
+
+    // Number of lanes in use.
+    unsigned count;
+};
+
+/**
+ * Structure-of-arrays version of the normal (i.e. non-friction) rows in a
+ * `row_cache`, grouped in batches of independent rows.
+ */
+struct row_cache_soa {
+    std::vector<constraint_row_batch> batches;
+
+    void clear() {
+        batches.clear();
+    }
+};
+
+/**
+ * @brief Groups the rows into batches of independent rows. Must be called
+ * after the rows are warm started.
+ * @param soa Batches to be filled.
+ * @param rows Rows to be batched.
+ * @param bodies Solver bodies referenced by the rows.
+ */
+void pack_row_batches(row_cache_soa &soa, const std::vector<constraint_row> &rows,
+                      const std::vector<solver_body> &bodies);
+
+/**
+ * @brief Copies the right hand side of the source rows into the batches.
+ * Must be called after the right hand side of the rows changes, which
+ * happens in between substeps.
+ * @param soa Row batches.
+ * @param rows Source rows.
+ */
+void update_row_batch_rhs(row_cache_soa &soa, const std::vector<constraint_row> &rows);
+
+/**
+ * @brief Runs one solver iteration over all batches, applying impulses to
+ * the delta velocities and storing the new impulse back into the source rows
+ * so they can be used by friction rows and for warm-starting.
+ * @param soa Row batches.
+ * @param rows Source rows.
+ * @param bodies Solver bodies referenced by the rows.
+ * @return Largest magnitude of the delta impulses applied.
+ */
+scalar solve(row_cache_soa &soa, std::vector<constraint_row> &rows, std::vector<solver_body> &bodies);
+
+}
+
+#endif // EDYN_DYNAMICS_ROW_CACHE_SOA_HPP
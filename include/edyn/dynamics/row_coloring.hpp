@@ -0,0 +1,38 @@
+#ifndef EDYN_DYNAMICS_ROW_COLORING_HPP
+#define EDYN_DYNAMICS_ROW_COLORING_HPP
+
+#include <cstddef>
+
+namespace edyn {
+
+struct row_cache;
+
+// Maximum number of colors assigned to rows. Rows that cannot be assigned
+// one of these colors are placed in a last color which is solved sequentially.
+inline constexpr unsigned max_row_colors = 64;
+
+/**
+ * @brief Partitions the normal rows in the cache and their friction rows into
+ * colors, where no two rows of the same color share a dynamic body, thus
+ * allowing rows of the same color to be solved in parallel. Rows attached to
+ * non-dynamic bodies are pointed at exclusive fixed bodies appended to the
+ * solver body array so that they do not write to shared memory. The
+ * assignment only depends on the order of the rows, thus it is deterministic.
+ * @param cache Row cache to be colored. Must already be warm started.
+ */
+void color_rows(row_cache &cache);
+
+/**
+ * @brief Partitions the position constraint entries in the cache into colors
+ * using the same greedy assignment as `color_rows`, so that constraints of
+ * the same color can be solved in parallel by the position solver. The
+ * entries are reordered so that the entries of each color are contiguous.
+ * @param cache Row cache with position bodies and entries.
+ * @param num_dynamic_bodies Number of position bodies which can be moved by
+ * the constraints, i.e. all but the copies of non-procedural bodies.
+ */
+void color_position_constraints(row_cache &cache, size_t num_dynamic_bodies);
+
+}
+
+#endif // EDYN_DYNAMICS_ROW_COLORING_HPP
@@ -1,7 +1,9 @@
 #ifndef EDYN_DYNAMICS_SOLVER_HPP
 #define EDYN_DYNAMICS_SOLVER_HPP
 
+#include <cstdint>
 #include <memory>
+#include <utility>
 #include <vector>
 #include <entt/entity/fwd.hpp>
 #include <entt/signal/sigh.hpp>
@@ -10,9 +12,9 @@
 namespace edyn {
 
 struct job;
-struct constraint_row;
-
-scalar solve(constraint_row &row);
+class constraint_row_prep_arena_pool;
+class nbody_octree;
+struct island_solver_params;
 
 class solver final {
 
@@ -22,9 +24,40 @@ public:
 
     void update(bool mt);
 
+    // Memory allocated for the rows prepared in each step.
+    size_t num_bytes() const;
+
 private:
     entt::registry *m_registry;
     std::vector<entt::scoped_connection> m_connections;
+
+    // Storage for the rows set up during constraint preparation, which are
+    // referred to by each `constraint_row_prep_cache`.
+    std::unique_ptr<constraint_row_prep_arena_pool> m_prep_arenas;
+
+    // Constraint entities split among tasks during preparation, grouped by
+    // constraint type. The entities of the i-th type in `constraints_tuple`
+    // are in the range `[m_prep_offsets[i], m_prep_offsets[i + 1])` and the
+    // entities with constraints of multiple types are in the last range.
+    std::vector<entt::entity> m_prep_entities;
+    std::vector<size_t> m_prep_offsets;
+
+    // Number of the current preparation, which identifies the preparation
+    // caches that were already visited while collecting the entities.
+    uint32_t m_prep_step {0};
+
+    // Octree of the dynamic bodies and buffer of the bodies it accelerates,
+    // used by n-body gravity.
+    std::unique_ptr<nbody_octree> m_nbody_octree;
+    std::vector<entt::entity> m_nbody_entities;
+
+    // Islands solved in worker threads sorted by decreasing estimated cost,
+    // along with their iteration parameters, and the ranges of islands that
+    // are solved by each job.
+    std::vector<std::pair<size_t, entt::entity>> m_island_costs;
+    std::vector<entt::entity> m_island_entities;
+    std::vector<const island_solver_params *> m_island_params;
+    std::vector<std::pair<size_t, size_t>> m_island_jobs;
 };
 
 }
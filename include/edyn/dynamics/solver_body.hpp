@@ -0,0 +1,44 @@
+#ifndef EDYN_DYNAMICS_SOLVER_BODY_HPP
+#define EDYN_DYNAMICS_SOLVER_BODY_HPP
+
+#include <cstdint>
+#include "edyn/math/vector3.hpp"
+#include "edyn/math/matrix3x3.hpp"
+
+namespace edyn {
+
+/**
+ * Packed rigid body state used during the constraint solver iterations.
+ * Constraint rows refer to bodies by their index in an array of these,
+ * which is built per island right before solving, and the delta velocities
+ * are written back into the registry once the iterations are done.
+ */
+struct solver_body {
+    vector3 dv {vector3_zero};
+    vector3 dw {vector3_zero};
+    scalar inv_m {0};
+    matrix3x3 inv_I {matrix3x3_zero};
+};
+
+/**
+ * Additional body state used when the solver runs in substeps. It holds the
+ * velocity of the body at the start of the step and the displacement that
+ * accumulated over the substeps done so far, which is used to update the
+ * position error of the constraints without preparing them again.
+ */
+struct solver_body_substep {
+    vector3 linvel {vector3_zero};
+    vector3 angvel {vector3_zero};
+    vector3 linear_displacement {vector3_zero};
+    vector3 angular_displacement {vector3_zero};
+};
+
+using solver_body_index_t = uint32_t;
+
+// Index of the body shared by all non-procedural entities in an island. It
+// has zero inverse mass and inertia, thus its delta velocities never change.
+inline constexpr solver_body_index_t fixed_solver_body_index = 0;
+
+}
+
+#endif // EDYN_DYNAMICS_SOLVER_BODY_HPP
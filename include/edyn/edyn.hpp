@@ -2,8 +2,13 @@
 #define EDYN_EDYN_HPP
 
 #include "edyn/build_settings.h"
+#include "edyn/config/broadphase_algorithm.hpp"
 #include "edyn/config/execution_mode.hpp"
+#include "edyn/config/simulation_pacing.hpp"
+#include "edyn/config/worker_idle_policy.hpp"
+#include "edyn/config/thread_affinity.hpp"
 #include "edyn/config/solver_iteration_config.hpp"
+#include "edyn/config/memory_resource.hpp"
 #include "math/constants.hpp"
 #include "math/scalar.hpp"
 #include "math/vector3.hpp"
@@ -13,24 +18,38 @@
 #include "math/transform.hpp"
 #include "math/math.hpp"
 #include "time/time.hpp"
+#include "time/tick_jitter.hpp"
 #include "util/rigidbody.hpp"
+#include "util/prefab.hpp"
 #include "util/constraint_util.hpp"
 #include "util/exclude_collision.hpp"
 #include "util/gravity_util.hpp"
 #include "util/insert_material_mixing.hpp"
+#include "util/step_profile.hpp"
+#include "util/memory_stats.hpp"
+#include "util/world_capture.hpp"
+#include "simulation/maintenance_scheduler.hpp"
 #include "collision/contact_signal.hpp"
 #include "context/step_callback.hpp"
 #include "context/start_thread.hpp"
 #include "context/task.hpp"
+#include "parallel/job_dispatcher.hpp"
 #include "collision/raycast.hpp"
+#include "collision/shape_cast.hpp"
+#include "collision/overlap.hpp"
+#include "collision/collision_stats.hpp"
+#include "collision/sensor.hpp"
+#include "collision/contact_event_stream.hpp"
 #include "shapes/shapes.hpp"
 #include "comp/shared_comp.hpp"
 #include "comp/present_position.hpp"
 #include "comp/present_orientation.hpp"
 #include "constraints/constraint.hpp"
+#include "constraints/breakable_constraint.hpp"
 #include "serialization/s11n.hpp"
 #include "replication/register_external.hpp"
 #include <optional>
+#include <vector>
 
 namespace edyn {
 
@@ -58,6 +77,36 @@ struct init_config {
     enqueue_task_t *enqueue_task {&enqueue_task_default};
     // Function to run a task on worker threads and return after the work is done.
     enqueue_task_wait_t *enqueue_task_wait {&enqueue_task_wait_default};
+    // How the worker threads of the default job dispatcher wait for jobs when
+    // idle. Latency-critical applications can spin for longer, while battery
+    // powered devices might want to park right away. Only used when the job
+    // dispatcher is started, i.e. in the first call to `attach`.
+    edyn::worker_idle_policy worker_idle_policy {};
+    // Cores the worker threads of the default job dispatcher and the
+    // simulation thread are pinned to. The simulation thread pins itself
+    // even when started by a custom `start_thread_func`. Nothing is pinned
+    // by default. Worker cores are only used when the job dispatcher is
+    // started.
+    edyn::thread_affinity thread_affinity {};
+    // Thread pool that runs the jobs of this world when using the default
+    // task functions. Multiple worlds in one process can be given separate
+    // dispatchers, e.g. one per NUMA node with its workers pinned to the
+    // cores of that node. It must be started by the caller and outlive the
+    // world. If null, the global dispatcher is used and started if needed.
+    job_dispatcher *dispatcher {nullptr};
+    // Memory of the containers of this world which use `edyn::allocator`
+    // (see `edyn::memory_resource`). It must be thread-safe and outlive the
+    // world. If null, the global `operator new` is used.
+    edyn::memory_resource *memory_resource {nullptr};
+    // How the simulation worker paces its updates in asynchronous mode.
+    simulation_pacing pacing {simulation_pacing::adaptive_delay};
+    // How the broadphase finds pairs of procedural entities. Sweep and prune
+    // can be faster in dense scenes with many similar entities.
+    edyn::broadphase_algorithm broadphase_algorithm {edyn::broadphase_algorithm::dynamic_tree};
+    // Makes each step depend only on the simulation state and not on the
+    // number of threads, allowing lockstep and replays. See
+    // `edyn::settings::deterministic`.
+    bool deterministic {false};
 };
 
 /**
@@ -98,6 +147,113 @@ void set_fixed_dt(entt::registry &registry, scalar dt);
  */
 void set_max_steps_per_update(entt::registry &registry, unsigned);
 
+/**
+ * @brief Set how far the bodies in a contact manifold are allowed to move
+ * relative to each other for the existing contact points to be kept without
+ * running collision detection again. Setting either to zero disables this.
+ * @param registry Data source.
+ * @param linear Relative displacement tolerance.
+ * @param angular Relative rotation tolerance in radians.
+ */
+void set_contact_reuse_tolerances(entt::registry &registry, scalar linear, scalar angular);
+
+/**
+ * @brief Enable or disable freezing dynamic bodies which are at rest while
+ * their island is awake. See `edyn::settings::freeze_resting_bodies`.
+ * @param registry Data source.
+ * @param enabled Whether to freeze resting bodies.
+ */
+void set_freeze_resting_bodies(entt::registry &registry, bool enabled);
+
+/**
+ * @brief Enable or disable the gravitational attraction between all dynamic
+ * rigid bodies. See `edyn::settings::nbody_gravity`.
+ * @param registry Data source.
+ * @param enabled Whether to apply n-body gravity.
+ * @param constant Gravitational constant.
+ * @param theta Barnes-Hut opening angle. Zero is exact and visits all pairs
+ * of bodies. Larger values are faster and less accurate.
+ * @param softening Length added in quadrature to the distances.
+ */
+void set_nbody_gravity(entt::registry &registry, bool enabled,
+                       scalar constant = gravitational_constant,
+                       scalar theta = scalar(0.5), scalar softening = scalar(0));
+
+/**
+ * @brief Enable or disable releasing the solver caches of sleeping islands.
+ * See `edyn::settings::compact_sleeping_islands`.
+ * @param registry Data source.
+ * @param enabled Whether to compact sleeping islands.
+ */
+void set_compact_sleeping_islands(entt::registry &registry, bool enabled);
+
+/**
+ * @brief Set how long an island that lost a node or edge can wait until it is
+ * checked for splits. Islands are also checked once they could go to sleep.
+ * @param registry Data source.
+ * @param delay Time in seconds. Zero checks for splits in every step.
+ */
+void set_island_split_delay(entt::registry &registry, scalar delay);
+
+/**
+ * @brief Set how much time can be spent in each step on maintenance work
+ * which can wait. See `edyn::settings::maintenance_budget`. Deferred work can
+ * be completed at once with `edyn::finish_maintenance`.
+ * @param registry Data source.
+ * @param budget Time in seconds. Zero does all work right away.
+ */
+void set_maintenance_budget(entt::registry &registry, double budget);
+
+/**
+ * @brief Set how often the component storages are sorted by island.
+ * See `edyn::settings::island_storage_sort_interval`.
+ * @param registry Data source.
+ * @param interval Number of steps between sorts. Zero disables sorting.
+ */
+void set_island_storage_sort_interval(entt::registry &registry, unsigned interval);
+
+/**
+ * @brief Set for how many seconds ahead the pages of paged triangle meshes
+ * are loaded around moving islands.
+ * @param registry Data source.
+ * @param lookahead Time in seconds.
+ */
+void set_paged_mesh_prefetch_lookahead(entt::registry &registry, scalar lookahead);
+
+/**
+ * @brief Only update the presentation transforms of entities which have a
+ * `edyn::presentation_tag`. See `edyn::settings::present_tagged_only`.
+ * @param registry Data source.
+ * @param enabled Whether to present tagged entities only.
+ */
+void set_present_tagged_only(entt::registry &registry, bool enabled);
+
+/**
+ * @brief Set the number of presented entities from which the presentation
+ * transforms are calculated in worker threads.
+ * @param registry Data source.
+ * @param size Minimum number of entities. Zero disables it.
+ */
+void set_min_presentation_parallel_size(entt::registry &registry, unsigned size);
+
+/**
+ * @brief Set the number of operations in a step update from which its
+ * replacements are applied to the main registry in worker threads in
+ * asynchronous mode. See `edyn::settings::min_step_update_parallel_size`.
+ * @param registry Data source.
+ * @param size Minimum number of operations. Zero disables it.
+ */
+void set_min_step_update_parallel_size(entt::registry &registry, unsigned size);
+
+/**
+ * @brief Enable or disable publishing the broadphase trees to the main thread
+ * in asynchronous mode for synchronous raycasts and AABB queries.
+ * See `edyn::settings::publish_broadphase`.
+ * @param registry Data source.
+ * @param enabled Whether to publish the broadphase.
+ */
+void set_publish_broadphase(entt::registry &registry, bool enabled);
+
 /**
  * @brief Checks if simulation is paused.
  * @param registry Data source.
@@ -129,6 +285,34 @@ void update(entt::registry &registry);
  */
 void update(entt::registry &registry, double time);
 
+/**
+ * @brief Starts updating the simulation in a worker thread and returns
+ * immediately, thus the calling thread can do other work while the physics
+ * steps run. The update must be finished with `edyn::end_update` before the
+ * registry is accessed again. Only the sequential execution modes update in
+ * the background, which is mostly useful in
+ * `execution_mode::sequential_multithreaded`. In asynchronous mode, it's the
+ * same as `edyn::update`.
+ * @param registry Data source.
+ */
+void begin_update(entt::registry &registry);
+
+/**
+ * @brief Same as `edyn::begin_update(entt::registry &)` but it takes a
+ * timestamp parameter from an external time source.
+ * @param registry Data source.
+ * @param time The current time.
+ */
+void begin_update(entt::registry &registry, double time);
+
+/**
+ * @brief Waits for the update started with `edyn::begin_update` to finish,
+ * running pending jobs in the calling thread meanwhile. Does nothing if no
+ * update is in progress.
+ * @param registry Data source.
+ */
+void end_update(entt::registry &registry);
+
 /**
  * @brief Runs a single step for a paused simulation.
  * @param registry Data source.
@@ -143,6 +327,45 @@ void step_simulation(entt::registry &registry);
  */
 void step_simulation(entt::registry &registry, double time);
 
+/**
+ * @brief Runs many steps back to back for a paused simulation, without
+ * consulting the time source and without updating presentation. Time advances
+ * by exactly one fixed delta time per step. In asynchronous mode, the state
+ * is sent back to the main registry only after the last step. Intended for
+ * offline simulation, such as rollouts for training.
+ * @param registry Data source.
+ * @param num_steps Number of steps.
+ */
+void batch_step_simulation(entt::registry &registry, unsigned num_steps);
+
+/**
+ * @brief Runs many steps for many independent paused worlds, stepping
+ * separate worlds in parallel in the job dispatcher, which is better suited
+ * for a large number of small worlds than parallelizing each step. Worlds
+ * must be in `execution_mode::sequential` and share the same task functions.
+ * Step callbacks are invoked in worker threads.
+ * @param registries The worlds.
+ * @param num_steps Number of steps to run in each world.
+ */
+void batch_step_simulation(const std::vector<entt::registry *> &registries, unsigned num_steps);
+
+/**
+ * @brief Moves the origin of the world to keep coordinates small in large
+ * worlds, where single precision loses accuracy far from the origin. The
+ * offset is subtracted from the position of every rigid body, including
+ * sleeping and static ones, and from their AABBs, and the broadphase trees
+ * are translated in place, so no leaf is reinserted. Contacts,
+ * constraints and velocities are not affected since they're relative. The
+ * application must shift its own world-space data by the same amount, e.g.
+ * the cameras and the kinematic targets. In asynchronous mode, state
+ * received from the simulation worker before it applied the shift is shifted
+ * upon arrival. Not supported in networked setups, whose state history is not
+ * shifted.
+ * @param registry Data source.
+ * @param offset The new origin in the current coordinates.
+ */
+void rebase_origin(entt::registry &registry, const vector3 &offset);
+
 execution_mode get_execution_mode(const entt::registry &registry);
 
 /**
@@ -179,6 +402,60 @@ enqueue_task_t * get_enqueue_task(entt::registry &registry);
  */
 enqueue_task_wait_t * get_enqueue_task_wait(entt::registry &registry);
 
+/**
+ * @brief Get the thread pool that runs the jobs of this world.
+ * @param registry Data source.
+ * @return The job dispatcher.
+ */
+job_dispatcher & get_job_dispatcher(entt::registry &registry);
+
+/**
+ * @brief Moves a world onto another thread pool, e.g. when rebalancing the
+ * load among NUMA nodes. In asynchronous mode the simulation thread switches
+ * at the start of its next update and is pinned to the given cores, which
+ * should be on the same node as the workers of the new dispatcher.
+ * @remark Jobs already scheduled finish in the previous dispatcher, thus it
+ * must keep running for a while, i.e. until the next step ends.
+ * @remark Memory allocated by the simulation thread stays where it was
+ * placed by the operating system, usually on the node where it was first
+ * touched. Components allocated afterwards are placed on the new node.
+ * @param registry Data source.
+ * @param dispatcher The new dispatcher. Null means the global dispatcher.
+ * @param simulation_cores Cores the simulation thread is pinned to. Not
+ * pinned if empty.
+ */
+void set_job_dispatcher(entt::registry &registry, job_dispatcher *dispatcher,
+                        const core_set &simulation_cores = {});
+
+/**
+ * @brief Get how the simulation worker paces its updates.
+ * @param registry Data source.
+ * @return The pacing mode.
+ */
+simulation_pacing get_simulation_pacing(const entt::registry &registry);
+
+/**
+ * @brief Set how the simulation worker paces its updates in asynchronous mode.
+ * @param registry Data source.
+ * @param pacing The pacing mode.
+ */
+void set_simulation_pacing(entt::registry &registry, simulation_pacing pacing);
+
+/**
+ * @brief Get a histogram of how far the time between consecutive updates of
+ * the simulation worker was from the fixed delta time, since it started or
+ * since the histogram was last reset. Only available in asynchronous mode.
+ * @param registry Data source.
+ * @return The histogram.
+ */
+tick_jitter_histogram get_tick_jitter_histogram(const entt::registry &registry);
+
+/**
+ * @brief Clear the tick jitter histogram.
+ * @param registry Data source.
+ */
+void reset_tick_jitter_histogram(entt::registry &registry);
+
 }
 
 #endif // EDYN_EDYN_HPP
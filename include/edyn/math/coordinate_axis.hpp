@@ -45,7 +45,7 @@ constexpr vector3 coordinate_axis_vector(coordinate_axis axis, const quaternion
 
 template<typename Archive>
 void serialize(Archive &archive, coordinate_axis &axis) {
-    serialize_enum(archive, axis);
+    serialize_bits(archive, axis, 2);
 }
 
 }
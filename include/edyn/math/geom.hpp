@@ -105,6 +105,52 @@ scalar closest_point_segment_segment(const vector3 &p1, const vector3 &q1,
                                      scalar *sp = nullptr, scalar *tp = nullptr,
                                      vector3 *c1p = nullptr, vector3 *c2p = nullptr) noexcept;
 
+/**
+ * @brief Computes the closest points between `count` pairs of segments
+ * `s1[i](s) = p1[i] + s*(q1[i] - p1[i])` and `s2[i](t) = p2[i] + t*(q2[i] - p2[i])`,
+ * processing `simd_width` pairs at a time. Useful to test all candidate edges
+ * of a pair of shapes at once.
+ * @remark Unlike the single pair version, parallel segments yield only one
+ * pair of closest points, which might not be the same as the one chosen by
+ * the single pair version, though the distance is the same.
+ * @param p1, q1 End points of the first segment of each pair.
+ * @param p2, q2 End points of the second segment of each pair.
+ * @param count Number of pairs.
+ * @param s Outputs the parameter of the closest point in `s1[i]`.
+ * @param t Outputs the parameter of the closest point in `s2[i]`.
+ * @param dist_sqr Outputs the squared distance between the closest points.
+ */
+void closest_point_segment_segment(const vector3 *p1, const vector3 *q1,
+                                   const vector3 *p2, const vector3 *q2,
+                                   size_t count, scalar *s, scalar *t,
+                                   scalar *dist_sqr) noexcept;
+
+/**
+ * @brief Converts `count` points in object space to world space, processing
+ * `simd_width` points at a time.
+ * @param points Points in object space.
+ * @param count Number of points.
+ * @param pos Position in world space.
+ * @param orn Orientation in world space.
+ * @param result Outputs the points in world space. Can be the same array as
+ * `points`.
+ */
+void to_world_space(const vector3 *points, size_t count, const vector3 &pos,
+                    const quaternion &orn, vector3 *result) noexcept;
+
+/**
+ * @brief Converts `count` points in world space to object space, processing
+ * `simd_width` points at a time.
+ * @param points Points in world space.
+ * @param count Number of points.
+ * @param pos Position in world space.
+ * @param orn Orientation in world space.
+ * @param result Outputs the points in object space. Can be the same array as
+ * `points`.
+ */
+void to_object_space(const vector3 *points, size_t count, const vector3 &pos,
+                     const quaternion &orn, vector3 *result) noexcept;
+
 /**
  * Find closest point in a disc to a given point.
  * @param dpos Center of disc.
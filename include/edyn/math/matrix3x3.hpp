@@ -65,12 +65,30 @@ constexpr matrix3x3 operator*(const matrix3x3 &m, const matrix3x3 &n) noexcept {
 
 // Multiply vector by matrix.
 constexpr vector3 operator*(const matrix3x3 &m, const vector3 &v) noexcept {
+#ifdef EDYN_SIMD_VECTOR
+    if (!EDYN_IS_CONSTANT_EVALUATED()) {
+        auto r = detail::simd_vec4_dot3x3(detail::simd_vec4_load(m.row[0]),
+                                          detail::simd_vec4_load(m.row[1]),
+                                          detail::simd_vec4_load(m.row[2]),
+                                          detail::simd_vec4_load(v));
+        return detail::simd_vec4_to_vector3(r);
+    }
+#endif
     return {dot(m.row[0], v), dot(m.row[1], v), dot(m.row[2], v)};
 }
 
 // Multiply vector by matrix on the right, effectively multiplying
 // by the transpose.
 constexpr vector3 operator*(const vector3 &v, const matrix3x3 &m) noexcept {
+#ifdef EDYN_SIMD_VECTOR
+    if (!EDYN_IS_CONSTANT_EVALUATED()) {
+        using namespace detail;
+        auto r = simd_vec4_mul(simd_vec4_load(m.row[0]), simd_vec4_splat(v.x));
+        r = simd_vec4_add(r, simd_vec4_mul(simd_vec4_load(m.row[1]), simd_vec4_splat(v.y)));
+        r = simd_vec4_add(r, simd_vec4_mul(simd_vec4_load(m.row[2]), simd_vec4_splat(v.z)));
+        return simd_vec4_to_vector3(r);
+    }
+#endif
     return {m.column_dot(0, v), m.column_dot(1, v), m.column_dot(2, v)};
 }
 
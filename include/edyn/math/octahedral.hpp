@@ -0,0 +1,58 @@
+#ifndef EDYN_MATH_OCTAHEDRAL_HPP
+#define EDYN_MATH_OCTAHEDRAL_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include "edyn/math/scalar.hpp"
+#include "edyn/math/vector3.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Encodes a unit vector into 32 bits by projecting it onto an
+ * octahedron which is unfolded onto a square, whose coordinates are stored
+ * as two 16-bit signed normalized integers. The error of the decoded vector
+ * is in the order of 1e-4 radians.
+ * @param v Unit vector.
+ * @return Encoded vector.
+ */
+inline uint32_t octahedral_encode(const vector3 &v) {
+    auto l1 = std::abs(v.x) + std::abs(v.y) + std::abs(v.z);
+    auto px = v.x / l1;
+    auto py = v.y / l1;
+
+    // Fold the lower hemisphere over the diagonals.
+    if (v.z < 0) {
+        auto fx = (scalar(1) - std::abs(py)) * (px >= 0 ? scalar(1) : scalar(-1));
+        auto fy = (scalar(1) - std::abs(px)) * (py >= 0 ? scalar(1) : scalar(-1));
+        px = fx;
+        py = fy;
+    }
+
+    auto qx = static_cast<int16_t>(std::round(px * INT16_MAX));
+    auto qy = static_cast<int16_t>(std::round(py * INT16_MAX));
+    return uint32_t(uint16_t(qx)) | (uint32_t(uint16_t(qy)) << 16);
+}
+
+/**
+ * @brief Decodes a unit vector encoded with `octahedral_encode`.
+ * @param e Encoded vector.
+ * @return Unit vector.
+ */
+inline vector3 octahedral_decode(uint32_t e) {
+    auto x = scalar(int16_t(uint16_t(e & 0xffff))) / INT16_MAX;
+    auto y = scalar(int16_t(uint16_t(e >> 16))) / INT16_MAX;
+    auto z = scalar(1) - std::abs(x) - std::abs(y);
+
+    // Unfold the lower hemisphere.
+    auto t = std::max(-z, scalar(0));
+    x += x >= 0 ? -t : t;
+    y += y >= 0 ? -t : t;
+
+    return normalize(vector3{x, y, z});
+}
+
+}
+
+#endif // EDYN_MATH_OCTAHEDRAL_HPP
@@ -6,7 +6,8 @@
 
 namespace edyn {
 
-struct quaternion {
+// Aligned to 16 bytes if `EDYN_SIMD_VECTOR` is defined.
+struct EDYN_SIMD_VECTOR_ALIGNAS quaternion {
     scalar x, y, z, w;
 
     scalar& operator[](size_t i) noexcept {
@@ -144,6 +145,17 @@ constexpr quaternion conjugate(const quaternion &q) noexcept {
 // Rotate a vector by a quaternion.
 constexpr vector3 rotate(const quaternion &q, const vector3 &v) noexcept {
     // Formula from https://en.wikipedia.org/wiki/Quaternions_and_spatial_rotation#Performance_comparisons
+#ifdef EDYN_SIMD_VECTOR
+    if (!EDYN_IS_CONSTANT_EVALUATED()) {
+        // The `w` of the quaternion in the last lane is ignored.
+        auto r = detail::simd_vec4_load(&q.x);
+        auto u = detail::simd_vec4_load(v);
+        auto t = detail::simd_vec4_add(detail::simd_vec4_cross3(r, u),
+                                       detail::simd_vec4_mul(detail::simd_vec4_splat(q.w), u));
+        auto c = detail::simd_vec4_cross3(detail::simd_vec4_add(r, r), t);
+        return detail::simd_vec4_to_vector3(detail::simd_vec4_add(u, c));
+    }
+#endif
     auto r = vector3{q.x, q.y, q.z};
     return v + cross(scalar(2) * r, cross(r, v) + q.w * v);
 }
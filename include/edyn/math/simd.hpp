@@ -0,0 +1,217 @@
+#ifndef EDYN_MATH_SIMD_HPP
+#define EDYN_MATH_SIMD_HPP
+
+#include <array>
+#include <cstddef>
+#include <algorithm>
+#include <cmath>
+#include "edyn/math/scalar.hpp"
+
+#if defined(__AVX__)
+#define EDYN_SIMD_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define EDYN_SIMD_SSE
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && !defined(EDYN_DOUBLE_PRECISION)
+#define EDYN_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+namespace edyn {
+
+/**
+ * A pack of scalars which are operated on in parallel using the widest
+ * instruction set available at compile time. Falls back to a plain array
+ * which the compiler is free to vectorize if no intrinsics are available.
+ * Loads and stores require memory aligned to `simd_alignment`. Comparisons
+ * such as `less_equal_mask` return a bit mask with one bit per lane, which is
+ * false for NaNs.
+ */
+struct simd_scalar;
+
+#if defined(EDYN_SIMD_AVX)
+
+#ifdef EDYN_DOUBLE_PRECISION
+inline constexpr size_t simd_width = 4;
+using simd_native_t = __m256d;
+#define EDYN_SIMD_OP(op) _mm256_##op##_pd
+#else
+inline constexpr size_t simd_width = 8;
+using simd_native_t = __m256;
+#define EDYN_SIMD_OP(op) _mm256_##op##_ps
+#endif
+inline constexpr size_t simd_alignment = 32;
+
+#elif defined(EDYN_SIMD_SSE)
+
+#ifdef EDYN_DOUBLE_PRECISION
+inline constexpr size_t simd_width = 2;
+using simd_native_t = __m128d;
+#define EDYN_SIMD_OP(op) _mm_##op##_pd
+#else
+inline constexpr size_t simd_width = 4;
+using simd_native_t = __m128;
+#define EDYN_SIMD_OP(op) _mm_##op##_ps
+#endif
+inline constexpr size_t simd_alignment = 16;
+
+#elif defined(EDYN_SIMD_NEON)
+
+inline constexpr size_t simd_width = 4;
+inline constexpr size_t simd_alignment = 16;
+using simd_native_t = float32x4_t;
+
+#else
+
+inline constexpr size_t simd_width = 4;
+inline constexpr size_t simd_alignment = alignof(scalar) * simd_width;
+
+#endif
+
+#if defined(EDYN_SIMD_AVX) || defined(EDYN_SIMD_SSE)
+
+struct simd_scalar {
+    simd_native_t v;
+
+    static simd_scalar load(const scalar *ptr) noexcept {
+        return {EDYN_SIMD_OP(load)(ptr)};
+    }
+
+    static simd_scalar splat(scalar s) noexcept {
+        return {EDYN_SIMD_OP(set1)(s)};
+    }
+
+    void store(scalar *ptr) const noexcept {
+        EDYN_SIMD_OP(store)(ptr, v);
+    }
+};
+
+inline simd_scalar operator+(simd_scalar a, simd_scalar b) noexcept { return {EDYN_SIMD_OP(add)(a.v, b.v)}; }
+inline simd_scalar operator-(simd_scalar a, simd_scalar b) noexcept { return {EDYN_SIMD_OP(sub)(a.v, b.v)}; }
+inline simd_scalar operator*(simd_scalar a, simd_scalar b) noexcept { return {EDYN_SIMD_OP(mul)(a.v, b.v)}; }
+inline simd_scalar min(simd_scalar a, simd_scalar b) noexcept { return {EDYN_SIMD_OP(min)(a.v, b.v)}; }
+inline simd_scalar max(simd_scalar a, simd_scalar b) noexcept { return {EDYN_SIMD_OP(max)(a.v, b.v)}; }
+inline simd_scalar operator/(simd_scalar a, simd_scalar b) noexcept { return {EDYN_SIMD_OP(div)(a.v, b.v)}; }
+inline simd_scalar sqrt(simd_scalar a) noexcept { return {EDYN_SIMD_OP(sqrt)(a.v)}; }
+
+#if defined(EDYN_SIMD_AVX)
+inline unsigned less_equal_mask(simd_scalar a, simd_scalar b) noexcept { return unsigned(EDYN_SIMD_OP(movemask)(EDYN_SIMD_OP(cmp)(a.v, b.v, _CMP_LE_OQ))); }
+#else
+inline unsigned less_equal_mask(simd_scalar a, simd_scalar b) noexcept { return unsigned(EDYN_SIMD_OP(movemask)(EDYN_SIMD_OP(cmple)(a.v, b.v))); }
+#endif
+
+#undef EDYN_SIMD_OP
+
+#elif defined(EDYN_SIMD_NEON)
+
+struct simd_scalar {
+    simd_native_t v;
+
+    static simd_scalar load(const scalar *ptr) noexcept {
+        return {vld1q_f32(ptr)};
+    }
+
+    static simd_scalar splat(scalar s) noexcept {
+        return {vdupq_n_f32(s)};
+    }
+
+    void store(scalar *ptr) const noexcept {
+        vst1q_f32(ptr, v);
+    }
+};
+
+inline simd_scalar operator+(simd_scalar a, simd_scalar b) noexcept { return {vaddq_f32(a.v, b.v)}; }
+inline simd_scalar operator-(simd_scalar a, simd_scalar b) noexcept { return {vsubq_f32(a.v, b.v)}; }
+inline simd_scalar operator*(simd_scalar a, simd_scalar b) noexcept { return {vmulq_f32(a.v, b.v)}; }
+inline simd_scalar min(simd_scalar a, simd_scalar b) noexcept { return {vminq_f32(a.v, b.v)}; }
+inline simd_scalar max(simd_scalar a, simd_scalar b) noexcept { return {vmaxq_f32(a.v, b.v)}; }
+
+#if defined(__aarch64__)
+inline simd_scalar operator/(simd_scalar a, simd_scalar b) noexcept { return {vdivq_f32(a.v, b.v)}; }
+inline simd_scalar sqrt(simd_scalar a) noexcept { return {vsqrtq_f32(a.v)}; }
+#else
+// No division nor square root in 32-bit NEON. Do it one lane at a time.
+inline simd_scalar operator/(simd_scalar a, simd_scalar b) noexcept {
+    alignas(simd_alignment) scalar x[simd_width], y[simd_width];
+    a.store(x); b.store(y);
+    for (size_t i = 0; i < simd_width; ++i) x[i] /= y[i];
+    return simd_scalar::load(x);
+}
+
+inline simd_scalar sqrt(simd_scalar a) noexcept {
+    alignas(simd_alignment) scalar x[simd_width];
+    a.store(x);
+    for (size_t i = 0; i < simd_width; ++i) x[i] = std::sqrt(x[i]);
+    return simd_scalar::load(x);
+}
+#endif
+
+inline unsigned less_equal_mask(simd_scalar a, simd_scalar b) noexcept {
+    auto r = vcleq_f32(a.v, b.v);
+    return (vgetq_lane_u32(r, 0) & 1u) | (vgetq_lane_u32(r, 1) & 2u) |
+           (vgetq_lane_u32(r, 2) & 4u) | (vgetq_lane_u32(r, 3) & 8u);
+}
+
+#else
+
+struct simd_scalar {
+    std::array<scalar, simd_width> v;
+
+    static simd_scalar load(const scalar *ptr) noexcept {
+        simd_scalar r;
+        for (size_t i = 0; i < simd_width; ++i) r.v[i] = ptr[i];
+        return r;
+    }
+
+    static simd_scalar splat(scalar s) noexcept {
+        simd_scalar r;
+        r.v.fill(s);
+        return r;
+    }
+
+    void store(scalar *ptr) const noexcept {
+        for (size_t i = 0; i < simd_width; ++i) ptr[i] = v[i];
+    }
+};
+
+template<typename Op>
+simd_scalar simd_binary_op(simd_scalar a, simd_scalar b, Op op) noexcept {
+    simd_scalar r;
+    for (size_t i = 0; i < simd_width; ++i) r.v[i] = op(a.v[i], b.v[i]);
+    return r;
+}
+
+inline simd_scalar operator+(simd_scalar a, simd_scalar b) noexcept { return simd_binary_op(a, b, [](scalar x, scalar y) { return x + y; }); }
+inline simd_scalar operator-(simd_scalar a, simd_scalar b) noexcept { return simd_binary_op(a, b, [](scalar x, scalar y) { return x - y; }); }
+inline simd_scalar operator*(simd_scalar a, simd_scalar b) noexcept { return simd_binary_op(a, b, [](scalar x, scalar y) { return x * y; }); }
+inline simd_scalar min(simd_scalar a, simd_scalar b) noexcept { return simd_binary_op(a, b, [](scalar x, scalar y) { return std::min(x, y); }); }
+inline simd_scalar max(simd_scalar a, simd_scalar b) noexcept { return simd_binary_op(a, b, [](scalar x, scalar y) { return std::max(x, y); }); }
+inline simd_scalar operator/(simd_scalar a, simd_scalar b) noexcept { return simd_binary_op(a, b, [](scalar x, scalar y) { return x / y; }); }
+
+inline simd_scalar sqrt(simd_scalar a) noexcept {
+    simd_scalar r;
+    for (size_t i = 0; i < simd_width; ++i) r.v[i] = std::sqrt(a.v[i]);
+    return r;
+}
+
+inline unsigned less_equal_mask(simd_scalar a, simd_scalar b) noexcept {
+    unsigned mask = 0;
+    for (size_t i = 0; i < simd_width; ++i) mask |= unsigned(a.v[i] <= b.v[i]) << i;
+    return mask;
+}
+
+#endif
+
+// Fused multiply-add, `a * b + c`.
+inline simd_scalar mul_add(simd_scalar a, simd_scalar b, simd_scalar c) noexcept {
+    return a * b + c;
+}
+
+inline simd_scalar abs(simd_scalar a) noexcept {
+    return max(a, simd_scalar::splat(0) - a);
+}
+
+}
+
+#endif // EDYN_MATH_SIMD_HPP
@@ -0,0 +1,129 @@
+#ifndef EDYN_MATH_SIMD_VEC4_HPP
+#define EDYN_MATH_SIMD_VEC4_HPP
+
+#include "edyn/math/scalar.hpp"
+
+// With `EDYN_SIMD`, vectors and quaternions are aligned to 16 bytes and are
+// loaded into a single register to calculate dot and cross products, rotations
+// and matrix-vector products using SSE or NEON. Only single precision is
+// supported. The functions have to remain `constexpr`, thus the intrinsics are
+// only used when not evaluated at compile time.
+#if defined(EDYN_SIMD) && !defined(EDYN_DOUBLE_PRECISION)
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 9
+#define EDYN_SIMD_VECTOR_CONSTEVAL
+#elif defined(__clang__) && __clang_major__ >= 9
+#define EDYN_SIMD_VECTOR_CONSTEVAL
+#elif defined(_MSC_VER) && _MSC_VER >= 1925
+#define EDYN_SIMD_VECTOR_CONSTEVAL
+#endif
+
+#ifdef EDYN_SIMD_VECTOR_CONSTEVAL
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define EDYN_SIMD_VECTOR
+#define EDYN_SIMD_VECTOR_SSE
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON)
+#define EDYN_SIMD_VECTOR
+#define EDYN_SIMD_VECTOR_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+#undef EDYN_SIMD_VECTOR_CONSTEVAL
+#endif
+
+#ifdef EDYN_SIMD_VECTOR
+#define EDYN_SIMD_VECTOR_ALIGNAS alignas(16)
+#define EDYN_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#else
+#define EDYN_SIMD_VECTOR_ALIGNAS
+#endif
+
+#ifdef EDYN_SIMD_VECTOR
+
+namespace edyn::detail {
+
+// Operations on a vector of four lanes where only the first three are used.
+// The last lane holds the padding of a `vector3` or the `w` of a quaternion
+// and does not affect the results in the other lanes.
+
+#if defined(EDYN_SIMD_VECTOR_SSE)
+
+using simd_vec4 = __m128;
+
+inline simd_vec4 simd_vec4_load(const scalar *ptr) noexcept { return _mm_load_ps(ptr); }
+inline void simd_vec4_store(scalar *ptr, simd_vec4 v) noexcept { _mm_store_ps(ptr, v); }
+inline simd_vec4 simd_vec4_splat(scalar s) noexcept { return _mm_set1_ps(s); }
+inline simd_vec4 simd_vec4_add(simd_vec4 a, simd_vec4 b) noexcept { return _mm_add_ps(a, b); }
+inline simd_vec4 simd_vec4_sub(simd_vec4 a, simd_vec4 b) noexcept { return _mm_sub_ps(a, b); }
+inline simd_vec4 simd_vec4_mul(simd_vec4 a, simd_vec4 b) noexcept { return _mm_mul_ps(a, b); }
+
+// Sum of the first three lanes.
+inline scalar simd_vec4_sum3(simd_vec4 v) noexcept {
+    auto y = _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1));
+    auto z = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2));
+    return _mm_cvtss_f32(_mm_add_ss(_mm_add_ss(v, y), z));
+}
+
+// Rotates the first three lanes to the left, i.e. `(y, z, x, w)`.
+inline simd_vec4 simd_vec4_yzx(simd_vec4 v) noexcept {
+    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 2, 1));
+}
+
+// Dot products of three vectors with a fourth, in the first three lanes.
+inline simd_vec4 simd_vec4_dot3x3(simd_vec4 a0, simd_vec4 a1, simd_vec4 a2, simd_vec4 b) noexcept {
+    auto p0 = _mm_mul_ps(a0, b);
+    auto p1 = _mm_mul_ps(a1, b);
+    auto p2 = _mm_mul_ps(a2, b);
+    auto p3 = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+    return _mm_add_ps(_mm_add_ps(p0, p1), p2);
+}
+
+#elif defined(EDYN_SIMD_VECTOR_NEON)
+
+using simd_vec4 = float32x4_t;
+
+inline simd_vec4 simd_vec4_load(const scalar *ptr) noexcept { return vld1q_f32(ptr); }
+inline void simd_vec4_store(scalar *ptr, simd_vec4 v) noexcept { vst1q_f32(ptr, v); }
+inline simd_vec4 simd_vec4_splat(scalar s) noexcept { return vdupq_n_f32(s); }
+inline simd_vec4 simd_vec4_add(simd_vec4 a, simd_vec4 b) noexcept { return vaddq_f32(a, b); }
+inline simd_vec4 simd_vec4_sub(simd_vec4 a, simd_vec4 b) noexcept { return vsubq_f32(a, b); }
+inline simd_vec4 simd_vec4_mul(simd_vec4 a, simd_vec4 b) noexcept { return vmulq_f32(a, b); }
+
+inline scalar simd_vec4_sum3(simd_vec4 v) noexcept {
+    auto xy = vget_low_f32(v);
+    return vget_lane_f32(vpadd_f32(xy, xy), 0) + vgetq_lane_f32(v, 2);
+}
+
+inline simd_vec4 simd_vec4_yzx(simd_vec4 v) noexcept {
+    return vsetq_lane_f32(vgetq_lane_f32(v, 0), vextq_f32(v, v, 1), 2);
+}
+
+inline simd_vec4 simd_vec4_dot3x3(simd_vec4 a0, simd_vec4 a1, simd_vec4 a2, simd_vec4 b) noexcept {
+    auto r = vdupq_n_f32(0);
+    r = vsetq_lane_f32(simd_vec4_sum3(vmulq_f32(a0, b)), r, 0);
+    r = vsetq_lane_f32(simd_vec4_sum3(vmulq_f32(a1, b)), r, 1);
+    r = vsetq_lane_f32(simd_vec4_sum3(vmulq_f32(a2, b)), r, 2);
+    return r;
+}
+
+#endif
+
+inline scalar simd_vec4_dot3(simd_vec4 a, simd_vec4 b) noexcept {
+    return simd_vec4_sum3(simd_vec4_mul(a, b));
+}
+
+inline simd_vec4 simd_vec4_cross3(simd_vec4 a, simd_vec4 b) noexcept {
+    // The products of `a` with `b` rotated and vice versa give the cross
+    // product rotated to `(z, x, y)`.
+    auto c = simd_vec4_sub(simd_vec4_mul(a, simd_vec4_yzx(b)),
+                           simd_vec4_mul(simd_vec4_yzx(a), b));
+    return simd_vec4_yzx(c);
+}
+
+}
+
+#endif // EDYN_SIMD_VECTOR
+
+#endif // EDYN_MATH_SIMD_VEC4_HPP
@@ -0,0 +1,159 @@
+#ifndef EDYN_MATH_SIMD_VECTOR3_HPP
+#define EDYN_MATH_SIMD_VECTOR3_HPP
+
+#include "edyn/math/simd.hpp"
+#include "edyn/math/vector3.hpp"
+
+namespace edyn {
+
+/**
+ * A pack of `simd_width` vectors stored as one `simd_scalar` per component,
+ * so that operations are performed on all vectors at once.
+ */
+struct simd_vector3 {
+    simd_scalar x, y, z;
+
+    // Loads the vectors from an array of each component.
+    static simd_vector3 load(const scalar (&v)[3][simd_width]) noexcept {
+        return {simd_scalar::load(v[0]), simd_scalar::load(v[1]), simd_scalar::load(v[2])};
+    }
+
+    void store(scalar (&v)[3][simd_width]) const noexcept {
+        x.store(v[0]);
+        y.store(v[1]);
+        z.store(v[2]);
+    }
+
+    static simd_vector3 splat(const vector3 &v) noexcept {
+        return {simd_scalar::splat(v.x), simd_scalar::splat(v.y), simd_scalar::splat(v.z)};
+    }
+
+    // Transposes up to `simd_width` vectors from an array of structures. If
+    // `count` is less than `simd_width`, the last vector is repeated in the
+    // remaining lanes so they hold valid values.
+    static simd_vector3 gather(const vector3 *v, size_t count) noexcept {
+        alignas(simd_alignment) scalar soa[3][simd_width];
+
+        for (size_t lane = 0; lane < simd_width; ++lane) {
+            auto &u = v[std::min(lane, count - 1)];
+            soa[0][lane] = u.x;
+            soa[1][lane] = u.y;
+            soa[2][lane] = u.z;
+        }
+
+        return load(soa);
+    }
+
+    // Writes the first `count` lanes into an array of structures.
+    void scatter(vector3 *v, size_t count) const noexcept {
+        alignas(simd_alignment) scalar soa[3][simd_width];
+        store(soa);
+
+        for (size_t lane = 0; lane < std::min(count, simd_width); ++lane) {
+            v[lane] = {soa[0][lane], soa[1][lane], soa[2][lane]};
+        }
+    }
+};
+
+/**
+ * A pack of `simd_width` quaternions, one `simd_scalar` per component.
+ */
+struct simd_quaternion {
+    simd_scalar x, y, z, w;
+
+    static simd_quaternion load(const scalar (&q)[4][simd_width]) noexcept {
+        return {simd_scalar::load(q[0]), simd_scalar::load(q[1]), simd_scalar::load(q[2]), simd_scalar::load(q[3])};
+    }
+};
+
+inline simd_vector3 operator+(const simd_vector3 &a, const simd_vector3 &b) noexcept {
+    return {a.x + b.x, a.y + b.y, a.z + b.z};
+}
+
+inline simd_vector3 operator-(const simd_vector3 &a, const simd_vector3 &b) noexcept {
+    return {a.x - b.x, a.y - b.y, a.z - b.z};
+}
+
+inline simd_vector3 operator*(const simd_vector3 &v, simd_scalar s) noexcept {
+    return {v.x * s, v.y * s, v.z * s};
+}
+
+inline simd_vector3 operator*(simd_scalar s, const simd_vector3 &v) noexcept {
+    return v * s;
+}
+
+inline simd_scalar dot(const simd_vector3 &a, const simd_vector3 &b) noexcept {
+    return mul_add(a.x, b.x, mul_add(a.y, b.y, a.z * b.z));
+}
+
+inline simd_vector3 cross(const simd_vector3 &a, const simd_vector3 &b) noexcept {
+    return {a.y * b.z - a.z * b.y,
+            a.z * b.x - a.x * b.z,
+            a.x * b.y - a.y * b.x};
+}
+
+inline simd_quaternion conjugate(const simd_quaternion &q) noexcept {
+    auto zero = simd_scalar::splat(0);
+    return {zero - q.x, zero - q.y, zero - q.z, q.w};
+}
+
+// Same formula as `rotate(const quaternion &, const vector3 &)`.
+inline simd_vector3 rotate(const simd_quaternion &q, const simd_vector3 &v) noexcept {
+    auto r = simd_vector3{q.x, q.y, q.z};
+    return v + cross(r * simd_scalar::splat(2), cross(r, v) + v * q.w);
+}
+
+inline simd_vector3 abs(const simd_vector3 &v) noexcept {
+    return {abs(v.x), abs(v.y), abs(v.z)};
+}
+
+/**
+ * A pack of `simd_width` 3x3 matrices, stored as three rows.
+ */
+struct simd_matrix3x3 {
+    simd_vector3 row[3];
+};
+
+// Same formula as `to_matrix3x3(const quaternion &)`.
+inline simd_matrix3x3 to_matrix3x3(const simd_quaternion &q) noexcept {
+    auto one = simd_scalar::splat(1);
+    auto d = dot(simd_vector3{q.x, q.y, q.z}, simd_vector3{q.x, q.y, q.z}) + q.w * q.w;
+    auto s = simd_scalar::splat(2) / d;
+    auto xs = q.x * s , ys = q.y * s , zs = q.z * s ;
+    auto wx = q.w * xs, wy = q.w * ys, wz = q.w * zs;
+    auto xx = q.x * xs, xy = q.x * ys, xz = q.x * zs;
+    auto yy = q.y * ys, yz = q.y * zs, zz = q.z * zs;
+
+    return {{
+        simd_vector3{one - (yy + zz), xy - wz, xz + wy},
+        simd_vector3{xy + wz, one - (xx + zz), yz - wx},
+        simd_vector3{xz - wy, yz + wx, one - (xx + yy)}
+    }};
+}
+
+inline simd_vector3 operator*(const simd_matrix3x3 &m, const simd_vector3 &v) noexcept {
+    return {dot(m.row[0], v), dot(m.row[1], v), dot(m.row[2], v)};
+}
+
+inline simd_matrix3x3 operator*(const simd_matrix3x3 &m, const simd_matrix3x3 &n) noexcept {
+    auto r = simd_matrix3x3{};
+
+    for (size_t i = 0; i < 3; ++i) {
+        auto &a = m.row[i];
+        r.row[i] = n.row[0] * a.x + n.row[1] * a.y + n.row[2] * a.z;
+    }
+
+    return r;
+}
+
+inline simd_matrix3x3 transpose(const simd_matrix3x3 &m) noexcept {
+    return {{
+        simd_vector3{m.row[0].x, m.row[1].x, m.row[2].x},
+        simd_vector3{m.row[0].y, m.row[1].y, m.row[2].y},
+        simd_vector3{m.row[0].z, m.row[1].z, m.row[2].z}
+    }};
+}
+
+}
+
+#endif // EDYN_MATH_SIMD_VECTOR3_HPP
@@ -30,6 +30,16 @@ bool point_in_triangle(const triangle_vertices &,
                        const vector3 &normal,
                        const vector3 &p);
 
+/**
+ * Checks whether each of `count` points is contained within the prism, as in
+ * the single point version, processing `simd_width` points at a time. Writes
+ * the result for `points[i]` into `result[i]`.
+ */
+void point_in_triangle(const triangle_vertices &,
+                       const vector3 &normal,
+                       const vector3 *points, size_t count,
+                       bool *result);
+
 triangle_edges get_triangle_edges(const triangle_vertices &);
 
 /**
@@ -5,11 +5,13 @@
 #include <algorithm>
 #include <type_traits>
 #include "edyn/math/scalar.hpp"
+#include "edyn/math/simd_vec4.hpp"
 #include "edyn/config/config.h"
 
 namespace edyn {
 
-struct vector3 {
+// Padded to four scalars if `EDYN_SIMD_VECTOR` is defined.
+struct EDYN_SIMD_VECTOR_ALIGNAS vector3 {
     scalar x, y, z;
 
     constexpr scalar& operator[](size_t i) noexcept {
@@ -42,6 +44,20 @@ struct vector3 {
     }
 };
 
+#ifdef EDYN_SIMD_VECTOR
+namespace detail {
+    inline simd_vec4 simd_vec4_load(const vector3 &v) noexcept {
+        return simd_vec4_load(&v.x);
+    }
+
+    inline vector3 simd_vec4_to_vector3(simd_vec4 v) noexcept {
+        vector3 r;
+        simd_vec4_store(&r.x, v);
+        return r;
+    }
+}
+#endif
+
 // Zero vector.
 inline constexpr vector3 vector3_zero {0, 0, 0};
 
@@ -189,11 +205,22 @@ constexpr bool operator<=(const vector3 &v, const vector3 &w) noexcept {
 
 // Dot product between vectors.
 constexpr scalar dot(const vector3 &v, const vector3 &w) noexcept {
+#ifdef EDYN_SIMD_VECTOR
+    if (!EDYN_IS_CONSTANT_EVALUATED()) {
+        return detail::simd_vec4_dot3(detail::simd_vec4_load(v), detail::simd_vec4_load(w));
+    }
+#endif
     return v.x * w.x + v.y * w.y + v.z * w.z;
 }
 
 // Cross product between two vectors.
 constexpr vector3 cross(const vector3 &v, const vector3 &w) noexcept {
+#ifdef EDYN_SIMD_VECTOR
+    if (!EDYN_IS_CONSTANT_EVALUATED()) {
+        auto c = detail::simd_vec4_cross3(detail::simd_vec4_load(v), detail::simd_vec4_load(w));
+        return detail::simd_vec4_to_vector3(c);
+    }
+#endif
     return {v.y * w.z - v.z * w.y,
             v.z * w.x - v.x * w.z,
             v.x * w.y - v.y * w.x};
@@ -6,11 +6,14 @@
 #include <limits>
 #include <vector>
 #include <cstdint>
+#include <cstddef>
 
 namespace edyn {
 
 /**
- * @brief A timestamped history of actions performed by a user.
+ * @brief A timestamped history of actions performed by a user. The serialized
+ * action lists of all entries are stored contiguously in a single buffer in
+ * the same order as the entries.
  */
 struct action_history {
     using action_index_type = uint8_t;
@@ -18,62 +21,170 @@ struct action_history {
     struct entry {
         double timestamp;
         action_index_type action_index; // Index of action type.
-        std::vector<uint8_t> data; // Serialized action list binary data.
-
-        entry() = default;
-        entry(double timestamp, action_index_type action_index, std::vector<uint8_t> &&data)
-            : timestamp(timestamp)
-            , action_index(action_index)
-            , data(std::move(data))
-        {}
+        uint32_t offset; // Offset of serialized action list in `data`.
+        uint32_t size; // Size of serialized action list.
     };
 
     std::vector<entry> entries;
+    std::vector<uint8_t> data; // Serialized action list binary data.
     double last_timestamp {};
 
     bool empty() const {
         return entries.empty();
     }
 
+    const uint8_t * entry_data(const entry &e) const {
+        return data.data() + e.offset;
+    }
+
+    /**
+     * @brief Inserts an entry whose serialized action list was just appended
+     * at the end of the data buffer, starting at `offset`.
+     */
+    void push_entry(double timestamp, action_index_type action_index, size_t offset) {
+        EDYN_ASSERT(offset <= data.size());
+        entries.push_back({timestamp, action_index,
+                           static_cast<uint32_t>(offset),
+                           static_cast<uint32_t>(data.size() - offset)});
+    }
+
+    void push_entry(double timestamp, action_index_type action_index,
+                    const uint8_t *bytes, size_t size) {
+        auto offset = data.size();
+        data.insert(data.end(), bytes, bytes + size);
+        push_entry(timestamp, action_index, offset);
+    }
+
+    // Erase the first `count` entries and their data.
+    void erase_first(size_t count) {
+        if (count >= entries.size()) {
+            entries.clear();
+            data.clear();
+            return;
+        }
+
+        auto num_bytes = entries[count].offset;
+        data.erase(data.begin(), data.begin() + num_bytes);
+        entries.erase(entries.begin(), entries.begin() + count);
+
+        for (auto &e : entries) {
+            e.offset -= num_bytes;
+        }
+    }
+
+    // First entry with the given timestamp, or the end if there's none.
+    // Entries must be sorted.
+    std::vector<entry>::iterator find(double timestamp) {
+        auto it = std::lower_bound(entries.begin(), entries.end(), timestamp,
+                                   [](auto &&entry, double t) { return entry.timestamp < t; });
+        return it != entries.end() && it->timestamp == timestamp ? it : entries.end();
+    }
+
+    // Erase all entries before the given time. Entries must be sorted.
     void erase_until(double timestamp) {
-        auto it = std::find_if(entries.begin(), entries.end(),
-                               [timestamp](auto &&entry) { return entry.timestamp >= timestamp; });
-        entries.erase(entries.begin(), it);
+        auto it = std::lower_bound(entries.begin(), entries.end(), timestamp,
+                                   [](auto &&entry, double t) { return entry.timestamp < t; });
+        erase_first(std::distance(entries.begin(), it));
+    }
+
+    // Erase all entries up to and including the given time. Entries must be
+    // sorted.
+    void erase_through(double timestamp) {
+        auto it = std::upper_bound(entries.begin(), entries.end(), timestamp,
+                                   [](double t, auto &&entry) { return t < entry.timestamp; });
+        erase_first(std::distance(entries.begin(), it));
     }
 
-    void merge(const action_history &other) {
+    // Appends the entries of a sorted history which are newer than all
+    // entries merged before. Returns the number of entries appended, which
+    // are the last in `entries`.
+    size_t merge(const action_history &other) {
         EDYN_ASSERT(!other.empty());
 
-        // Only append newer entries.
-        auto other_begin = std::find_if(other.entries.begin(), other.entries.end(),
-                                        [&](auto &&entry) { return entry.timestamp > last_timestamp; });
-        entries.insert(entries.end(), other_begin, other.entries.end());
+        // Only append newer entries, which are at the end since `other` is
+        // sorted.
+        auto it = std::upper_bound(other.entries.begin(), other.entries.end(), last_timestamp,
+                                   [](double t, auto &&entry) { return t < entry.timestamp; });
+        auto count = static_cast<size_t>(std::distance(it, other.entries.end()));
+
+        for (; it != other.entries.end(); ++it) {
+            push_entry(it->timestamp, it->action_index, other.entry_data(*it), it->size);
+        }
 
         if (!entries.empty()) {
             // Assign new highest timestamp yet inserted.
             last_timestamp = entries.back().timestamp;
         }
+
+        return count;
     }
 
     void sort() {
-        std::sort(entries.begin(), entries.end(), [](auto &&lhs, auto &&rhs) {
+        auto compare = [](auto &&lhs, auto &&rhs) {
             return lhs.timestamp < rhs.timestamp;
-        });
+        };
+
+        if (std::is_sorted(entries.begin(), entries.end(), compare)) {
+            return;
+        }
+
+        // Sort entries and rebuild buffer to keep data in the same order.
+        std::sort(entries.begin(), entries.end(), compare);
+        auto sorted_data = std::vector<uint8_t>{};
+        sorted_data.reserve(data.size());
+
+        for (auto &e : entries) {
+            auto offset = sorted_data.size();
+            sorted_data.insert(sorted_data.end(), data.begin() + e.offset, data.begin() + e.offset + e.size);
+            e.offset = static_cast<uint32_t>(offset);
+        }
+
+        data = std::move(sorted_data);
     }
 };
 
 template<typename Archive>
 void serialize(Archive &archive, action_history &history) {
     using size_type = uint8_t;
+    using data_size_type = uint16_t;
     size_type size = static_cast<size_type>(std::min(history.entries.size(),
                                             static_cast<size_t>(std::numeric_limits<size_type>::max())));
     archive(size);
-    history.entries.resize(size);
 
-    for (size_type i = 0; i < size; ++i) {
-        archive(history.entries[i].timestamp);
-        archive(history.entries[i].action_index);
-        archive(history.entries[i].data);
+    if constexpr(Archive::is_input::value) {
+        history.entries.clear();
+        history.data.clear();
+
+        for (size_type i = 0; i < size; ++i) {
+            double timestamp;
+            action_history::action_index_type action_index;
+            data_size_type data_size;
+            archive(timestamp);
+            archive(action_index);
+            archive(data_size);
+
+            auto offset = history.data.size();
+            history.data.resize(offset + data_size);
+
+            for (data_size_type j = 0; j < data_size; ++j) {
+                archive(history.data[offset + j]);
+            }
+
+            history.push_entry(timestamp, action_index, offset);
+        }
+    } else {
+        for (size_type i = 0; i < size; ++i) {
+            auto &entry = history.entries[i];
+            auto data_size = static_cast<data_size_type>(std::min(static_cast<size_t>(entry.size),
+                                                         static_cast<size_t>(std::numeric_limits<data_size_type>::max())));
+            archive(entry.timestamp);
+            archive(entry.action_index);
+            archive(data_size);
+
+            for (data_size_type j = 0; j < data_size; ++j) {
+                archive(history.data[entry.offset + j]);
+            }
+        }
     }
 }
 
@@ -43,6 +43,15 @@ struct exporter_modified_components {
         }
     }
 
+    void erase_index(uint16_t index) {
+        for (unsigned i = 0; i < count; ++i) {
+            if (entry[i].index == index) {
+                entry[i] = entry[--count];
+                return;
+            }
+        }
+    }
+
     void decay(unsigned elapsed_ms) {
         for (unsigned i = 0; i < count;) {
             if (elapsed_ms > entry[i].remaining) {
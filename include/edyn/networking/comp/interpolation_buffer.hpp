@@ -0,0 +1,95 @@
+#ifndef EDYN_NETWORKING_COMP_INTERPOLATION_BUFFER_HPP
+#define EDYN_NETWORKING_COMP_INTERPOLATION_BUFFER_HPP
+
+#include <array>
+#include <cstddef>
+#include "edyn/math/math.hpp"
+#include "edyn/math/quaternion.hpp"
+#include "edyn/math/vector3.hpp"
+
+namespace edyn {
+
+/**
+ * @brief The last transforms of an entity received from the server, in the
+ * client side, ordered by time. The present transform of the entity is
+ * interpolated from these instead of being taken from the local simulation
+ * (see `client_network_settings::interpolate_unpredicted_entities`).
+ */
+struct interpolation_buffer {
+    struct sample {
+        double time;
+        vector3 position;
+        quaternion orientation;
+    };
+
+    static constexpr size_t max_samples = 8;
+    std::array<sample, max_samples> samples;
+    size_t count {0};
+
+    /**
+     * @brief Inserts a sample, discarding the oldest if the buffer is full.
+     * Samples older than the oldest in a full buffer are ignored.
+     */
+    void insert(double time, const vector3 &pos, const quaternion &orn) {
+        auto index = count;
+
+        if (count == max_samples) {
+            if (time < samples[0].time) {
+                return;
+            }
+
+            for (size_t i = 1; i < count; ++i) {
+                samples[i - 1] = samples[i];
+            }
+
+            --index;
+        } else {
+            ++count;
+        }
+
+        // Samples usually arrive in order, thus the search starts at the back.
+        while (index > 0 && samples[index - 1].time > time) {
+            samples[index] = samples[index - 1];
+            --index;
+        }
+
+        samples[index] = {time, pos, orn};
+    }
+
+    /**
+     * @brief Interpolates the transform at the given time. Times outside of
+     * the range of samples are clamped to the first or last sample.
+     * @return Whether there are any samples.
+     */
+    bool interpolate(double time, vector3 &pos, quaternion &orn) const {
+        if (count == 0) {
+            return false;
+        }
+
+        if (time <= samples[0].time) {
+            pos = samples[0].position;
+            orn = samples[0].orientation;
+            return true;
+        }
+
+        for (size_t i = 1; i < count; ++i) {
+            auto &s0 = samples[i - 1];
+            auto &s1 = samples[i];
+
+            if (time < s1.time) {
+                auto s = static_cast<scalar>((time - s0.time) / (s1.time - s0.time));
+                pos = lerp(s0.position, s1.position, s);
+                orn = slerp(s0.orientation, s1.orientation, s);
+                return true;
+            }
+        }
+
+        pos = samples[count - 1].position;
+        orn = samples[count - 1].orientation;
+        return true;
+    }
+};
+
+}
+
+#endif // EDYN_NETWORKING_COMP_INTERPOLATION_BUFFER_HPP
@@ -11,6 +11,7 @@
 #include "edyn/comp/orientation.hpp"
 #include "edyn/comp/center_of_mass.hpp"
 #include "edyn/constraints/constraint.hpp"
+#include "edyn/constraints/breakable_constraint.hpp"
 #include "edyn/comp/tag.hpp"
 #include "edyn/comp/shape_index.hpp"
 #include "edyn/comp/material.hpp"
@@ -58,6 +59,13 @@ static const auto networked_components = std::tuple_cat(std::tuple<
     constraint_tag,
     rolling_tag,
     roll_direction,
+    ccd_tag,
+    particle_tag,
+    sensor_tag,
+    sensor_aabb_tag,
+    contact_event_tag,
+    articulation_tag,
+    breakable_constraint,
     null_constraint,
     gravity_constraint,
     point_constraint,
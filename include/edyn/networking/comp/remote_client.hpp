@@ -1,20 +1,22 @@
 #ifndef EDYN_NETWORKING_REMOTE_CLIENT_HPP
 #define EDYN_NETWORKING_REMOTE_CLIENT_HPP
 
+#include <limits>
 #include <vector>
+#include <unordered_map>
 #include <entt/entity/fwd.hpp>
 #include <entt/entity/sparse_set.hpp>
+#include "edyn/math/scalar.hpp"
 #include "edyn/replication/entity_map.hpp"
 #include "edyn/networking/packet/edyn_packet.hpp"
 #include "edyn/networking/util/clock_sync.hpp"
+#include "edyn/networking/util/network_stats.hpp"
+#include "edyn/networking/util/packet_batch.hpp"
+#include "edyn/networking/util/snapshot_baseline.hpp"
+#include "edyn/networking/util/timed_packet_queue.hpp"
 
 namespace edyn {
 
-struct timed_packet {
-    double timestamp;
-    packet::edyn_packet packet;
-};
-
 /**
  * @brief Stores data pertaining to a remote client in the server side.
  */
@@ -31,15 +33,55 @@ struct remote_client {
     // The delay in seconds applied to packet processing.
     double playout_delay {};
 
-    // List of delayed packets pending processing.
-    std::vector<timed_packet> packet_queue;
+    // Round-trip time plus jitter margin last used to calculate the playout
+    // delay of the clients which have entities owned by this client in their
+    // AABB of interest.
+    double playout_round_trip_time {};
+
+    // Whether the playout delay must be recalculated because the set of
+    // entities in the AABB of interest changed.
+    bool playout_delay_dirty {true};
+
+    // Delayed packets pending processing, ordered by timestamp.
+    timed_packet_queue packet_queue;
 
     // Timestamp of the last registry snapshot that was sent.
     double last_snapshot_time {0};
 
     // Rate of registry snapshots, i.e. registry snapshots sent per second.
+    // Entities may be sent at lower rates, according to their distance.
     double snapshot_rate {10};
 
+    // Maximum number of bytes per second sent in registry snapshots, or zero
+    // for no limit. When the modified entities do not fit in the share of a
+    // snapshot, the ones with the highest accumulated priority are sent and
+    // the others are sent in the following snapshots.
+    double max_snapshot_bandwidth {0};
+
+    struct entity_export_state {
+        // Priority of the entity, which accumulates between snapshots and is
+        // reset when the entity is sent. The rate is defined in
+        // `server_network_settings`.
+        scalar priority {0};
+
+        // Rate at which this entity is sent, which is at most `snapshot_rate`
+        // and depends on its distance (see `server_network_settings`).
+        double rate {0};
+
+        // Time when the entity is due to be sent again.
+        double next_export_time {0};
+
+        // Whether the entity is due to be included in the current snapshot.
+        bool due {true};
+    };
+
+    // Entities which entered the AABB of interest but haven't been sent to
+    // the client yet (see `server_network_settings::max_entities_entered_per_update`).
+    entt::sparse_set pending_entities_entered;
+
+    // Export state of the entities in the AABB of interest.
+    std::unordered_map<entt::entity, entity_export_state> entity_states;
+
     // Whether this client will be given temporary ownership of all entities in
     // the island where entities owned by it reside, thus allowing the state of
     // those entities to be set by the client.
@@ -48,6 +90,24 @@ struct remote_client {
     clock_sync_data clock_sync;
 
     double last_executed_history_entry_timestamp {0};
+
+    // Latest timestamp of the actions received from this client, in client
+    // time, which is acknowledged back to it.
+    double last_received_action_timestamp {-std::numeric_limits<double>::infinity()};
+
+    // Id of the next registry snapshot sent to this client.
+    snapshot_baseline::id_type next_snapshot_id {1};
+
+    // Registry snapshots sent to this client. Once acknowledged, they become
+    // the baseline for delta encoding the following snapshots.
+    snapshot_baseline sent_snapshots;
+
+    // Packets to be sent to this client in the current update when packet
+    // batching is enabled (see `server_network_settings::batch_packets`).
+    packet_batch outbound_packets;
+
+    // Traffic counters of this client (see `server_network_settings::collect_network_stats`).
+    network_stats stats;
 };
 
 }
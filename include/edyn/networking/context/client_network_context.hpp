@@ -8,6 +8,9 @@
 #include "edyn/networking/util/client_snapshot_importer.hpp"
 #include "edyn/networking/util/client_snapshot_exporter.hpp"
 #include "edyn/networking/util/clock_sync.hpp"
+#include "edyn/networking/util/network_stats.hpp"
+#include "edyn/networking/util/packet_batch.hpp"
+#include "edyn/networking/util/snapshot_baseline.hpp"
 #include "edyn/networking/extrapolation/extrapolation_worker.hpp"
 #include "edyn/networking/extrapolation/extrapolation_modified_comp.hpp"
 #include "edyn/replication/registry_operation.hpp"
@@ -17,6 +20,7 @@
 #include <entt/signal/sigh.hpp>
 #include <cstdint>
 #include <memory>
+#include <mutex>
 
 namespace edyn {
 
@@ -49,7 +53,14 @@ struct client_network_context {
 
     std::shared_ptr<input_state_history_writer> input_history;
 
-    std::unique_ptr<extrapolation_worker> extrapolator;
+    std::shared_ptr<input_state_history_reader> input_history_reader;
+
+    // Pool of extrapolation workers. Only the first
+    // `client_network_settings::num_extrapolation_workers` receive requests,
+    // but all of them are kept in sync with the networked entities. Also
+    // the entities involved in the requests each worker is processing.
+    std::vector<std::unique_ptr<extrapolation_worker>> extrapolators;
+    std::vector<entt::sparse_set> extrapolator_entities;
     std::vector<extrapolation_request> pending_extrapolations;
 
     message_queue_handle<extrapolation_result> message_queue {
@@ -62,6 +73,17 @@ struct client_network_context {
         return entt::sink{packet_signal};
     }
 
+    // Packets to be sent in the current update when packet batching is
+    // enabled (see `client_network_settings::batch_packets`).
+    packet_batch outbound_packets;
+
+    using packet_batch_observer_func_t = void(const uint8_t *, size_t, bool);
+    entt::sigh<packet_batch_observer_func_t> packet_batch_signal;
+
+    auto packet_batch_sink() {
+        return entt::sink{packet_batch_signal};
+    }
+
     entt::sigh<void(entt::entity)> client_assigned_signal;
     auto client_assigned_sink() {
         return entt::sink{client_assigned_signal};
@@ -89,6 +111,34 @@ struct client_network_context {
     std::shared_ptr<client_snapshot_exporter> snapshot_exporter;
 
     clock_sync_data clock_sync;
+
+    // Registry snapshots received from the server, which are the baselines
+    // the server uses for delta encoding.
+    snapshot_baseline received_snapshots;
+
+    // Ids of received snapshots to be acknowledged in the next update.
+    std::vector<snapshot_baseline::id_type> pending_snapshot_acks;
+
+    snapshot_baseline::id_type last_received_snapshot_id {snapshot_baseline::null_id};
+
+    // Registry snapshots waiting to be decoded by a background task and the
+    // ones already decoded, which are processed in the next update, along
+    // with their acknowledgements. The baseline above is only accessed by
+    // the task while it's running.
+    struct snapshot_decode_queue {
+        std::mutex mutex;
+        std::vector<packet::registry_snapshot> pending;
+        std::vector<packet::registry_snapshot> decoded;
+        std::vector<snapshot_baseline::id_type> acks;
+        // Time spent decoding by the task, added to the stats below.
+        double decode_time {0};
+        bool running {false};
+    };
+
+    std::unique_ptr<snapshot_decode_queue> snapshot_decode {std::make_unique<snapshot_decode_queue>()};
+
+    // Traffic counters (see `client_network_settings::collect_network_stats`).
+    network_stats stats;
 };
 
 }
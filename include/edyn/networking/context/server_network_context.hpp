@@ -2,10 +2,17 @@
 #define EDYN_NETWORKING_SERVER_NETWORK_CONTEXT_HPP
 
 #include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
 #include <entt/entity/fwd.hpp>
 #include <entt/signal/sigh.hpp>
+#include <entt/entity/sparse_set.hpp>
 #include "edyn/networking/util/server_snapshot_importer.hpp"
 #include "edyn/networking/util/server_snapshot_exporter.hpp"
+#include "edyn/networking/util/network_stats.hpp"
+#include "edyn/networking/util/action_queue.hpp"
+#include "edyn/shapes/paged_mesh_pinned_pages.hpp"
 
 namespace edyn {
 
@@ -17,6 +24,43 @@ struct server_network_context {
     std::shared_ptr<server_snapshot_importer> snapshot_importer;
     std::shared_ptr<server_snapshot_exporter> snapshot_exporter;
 
+    // Clients which are due a registry snapshot in the current update and
+    // the packets exported for each, which are reused between updates.
+    std::vector<entt::entity> snapshot_clients;
+    std::vector<std::vector<packet::registry_snapshot>> snapshot_packets;
+    std::vector<network_stats> snapshot_stats;
+
+    // Entities of interest to any of the clients above, whose modified
+    // components are cached by the snapshot exporter.
+    entt::sparse_set snapshot_cache_entities;
+
+    // Whether the round-trip time of a client changed significantly, which
+    // requires recalculating the playout delay of all clients.
+    bool playout_delays_dirty {false};
+
+    // Merged actions of all clients which are yet to be executed, and whether
+    // their execution times must be recalculated because the playout delay of
+    // some client changed.
+    action_queue pending_actions;
+    bool action_execution_times_dirty {false};
+
+    // Networked island residents which fell asleep or woke up since the last
+    // update, whose clients are told with a `packet::island_slept` or a
+    // `packet::island_woke` (see `server_network_settings::island_sleep_replication`).
+    std::vector<entt::entity> slept_entities;
+    std::vector<entt::entity> woken_entities;
+
+    // Number of AABBs of interest containing each entity.
+    std::unordered_map<entt::entity, unsigned> interest_counts;
+
+    // Pages of paged triangle meshes which intersect the AABB of interest of
+    // any client (see `server_network_settings::prefetch_paged_meshes_of_interest`).
+    paged_mesh_pinned_pages pinned_pages_of_interest;
+
+    // Traffic counters of all clients combined. Each `remote_client` has its
+    // own as well (see `server_network_settings::collect_network_stats`).
+    network_stats stats;
+
     // Packet signals contain the client entity and the packet.
     using packet_observer_func_t = void(entt::entity, const packet::edyn_packet &);
     entt::sigh<packet_observer_func_t> packet_signal;
@@ -24,6 +68,15 @@ struct server_network_context {
     auto packet_sink() {
         return entt::sink{packet_signal};
     }
+
+    // Packet batch signals contain the client entity, the serialized packets
+    // and whether they must be sent reliably.
+    using packet_batch_observer_func_t = void(entt::entity, const uint8_t *, size_t, bool);
+    entt::sigh<packet_batch_observer_func_t> packet_batch_signal;
+
+    auto packet_batch_sink() {
+        return entt::sink{packet_batch_signal};
+    }
 };
 
 }
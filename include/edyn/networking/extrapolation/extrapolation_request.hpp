@@ -8,7 +8,7 @@
 namespace edyn {
 
 struct extrapolation_request {
-    message_queue_identifier destination;
+    message_queue_id destination;
     double start_time;
     packet::registry_snapshot snapshot;
     double execution_time_limit {0.4};
@@ -4,6 +4,7 @@
 #include <memory>
 #include <atomic>
 #include <mutex>
+#include <string>
 #include <condition_variable>
 #include <entt/entity/fwd.hpp>
 #include "edyn/networking/extrapolation/extrapolation_modified_comp.hpp"
@@ -41,13 +42,33 @@ public:
     extrapolation_worker(const settings &settings,
                          const registry_operation_context &reg_op_ctx,
                          const material_mix_table &material_table,
-                         make_extrapolation_modified_comp_func_t *make_extrapolation_modified_comp);
+                         make_extrapolation_modified_comp_func_t *make_extrapolation_modified_comp,
+                         const std::string &queue_name = "extrapolation_worker");
 
     ~extrapolation_worker();
 
     void start();
     void stop();
 
+    message_queue_id queue_id() const {
+        return m_message_queue.id;
+    }
+
+    /**
+     * @brief Sends an extrapolation request to this worker.
+     * @param source Queue of the sender.
+     * @param request The request.
+     */
+    void send_request(message_queue_id source, extrapolation_request &&request);
+
+    /**
+     * @brief Number of requests sent to this worker which haven't been
+     * processed or discarded yet. Can be called from any thread.
+     */
+    unsigned num_pending_requests() const {
+        return m_num_pending_requests.load(std::memory_order_relaxed);
+    }
+
     void set_settings(const edyn::settings &settings);
     void set_material_table(const material_mix_table &material_table);
     void set_registry_operation_context(const registry_operation_context &reg_op_ctx);
@@ -86,8 +107,14 @@ private:
 
     std::vector<extrapolation_request> m_requests;
     unsigned m_max_requests {3};
+    std::atomic<unsigned> m_num_pending_requests {0};
     entt::sparse_set m_owned_entities;
 
+    // Entities which were simulated in a previous extrapolation and thus no
+    // longer hold the last known remote state. Only these have to be rewound
+    // before the next extrapolation.
+    entt::sparse_set m_diverged_entities;
+
     double m_init_time;
     double m_current_time;
     unsigned m_step_count {0};
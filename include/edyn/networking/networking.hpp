@@ -103,6 +103,18 @@ scalar get_network_client_discontinuity_decay_rate(entt::registry &);
 entt::sink<entt::sigh<void(const packet::edyn_packet &)>>
 network_client_packet_sink(entt::registry &);
 
+/**
+ * @brief Get client packet batch sink, which is used instead of the packet
+ * sink when `client_network_settings::batch_packets` is enabled. It is
+ * triggered at the end of each update with all packets to be sent serialized
+ * back to back, along with whether they must be sent reliably. The data must
+ * be fed into `server_receive_packet_batch` on the other end.
+ * @param registry Data source.
+ * @return Packet batch sink.
+ */
+entt::sink<entt::sigh<void(const uint8_t *, size_t, bool)>>
+network_client_packet_batch_sink(entt::registry &);
+
 /**
  * @brief Triggered when the client entity is set by the server and replicated
  * locally.
@@ -133,6 +145,20 @@ network_client_extrapolation_timeout_sink(entt::registry &);
 entt::sink<entt::sigh<void(entt::entity, const packet::edyn_packet &)>>
 network_server_packet_sink(entt::registry &);
 
+/**
+ * @brief Get server packet batch sink, which is used instead of the packet
+ * sink when `server_network_settings::batch_packets` is enabled. It is
+ * triggered at the end of each update for each client with all packets to be
+ * sent to it serialized back to back, along with whether they must be sent
+ * reliably. The data must be fed into `client_receive_packet_batch` on the
+ * other end.
+ * @param registry Data source.
+ * @return Packet batch sink where the observers take the client entity, the
+ * data, its size and whether it must be sent reliably as arguments.
+ */
+entt::sink<entt::sigh<void(entt::entity, const uint8_t *, size_t, bool)>>
+network_server_packet_batch_sink(entt::registry &);
+
 /**
  * @brief Notify client about an entity entering its AABB of interest.
  * The entity contains an `edyn::asset_ref` component which holds the id of
@@ -52,8 +52,12 @@ void register_networked_components(entt::registry &registry, std::tuple<Actions.
         auto input_history_reader_ptr =
             std::shared_ptr<std::remove_pointer_t<decltype(input_history_reader)>>(input_history_reader);
 
-        ctx->extrapolator->set_context_settings(input_history_reader_ptr,
-                                                ctx->make_extrapolation_modified_comp);
+        ctx->input_history_reader = input_history_reader_ptr;
+
+        for (auto &extrapolator : ctx->extrapolators) {
+            extrapolator->set_context_settings(input_history_reader_ptr,
+                                               ctx->make_extrapolation_modified_comp);
+        }
     }
 
     if (auto *ctx = registry.ctx().find<server_network_context>()) {
@@ -0,0 +1,23 @@
+#ifndef EDYN_NETWORKING_PACKET_ACTION_ACK_HPP
+#define EDYN_NETWORKING_PACKET_ACTION_ACK_HPP
+
+namespace edyn::packet {
+
+/**
+ * @brief Acknowledges the actions received by the server, which are all the
+ * actions up to and including the given timestamp in client time. The client
+ * removes these from its action history thus only resending actions which
+ * haven't been received yet.
+ */
+struct action_ack {
+    double timestamp;
+};
+
+template<typename Archive>
+void serialize(Archive &archive, action_ack &ack) {
+    archive(ack.timestamp);
+}
+
+}
+
+#endif // EDYN_NETWORKING_PACKET_ACTION_ACK_HPP
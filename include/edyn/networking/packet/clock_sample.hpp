@@ -0,0 +1,34 @@
+#ifndef EDYN_NETWORKING_PACKET_CLOCK_SAMPLE_HPP
+#define EDYN_NETWORKING_PACKET_CLOCK_SAMPLE_HPP
+
+namespace edyn::packet {
+
+/**
+ * @brief Timestamps piggybacked on registry snapshots for continuous
+ * round-trip time and clock offset estimation. The receiver of the sample
+ * echoes the send time back in its next snapshot, along with how long it
+ * held it for, from which the sender calculates the round-trip time and the
+ * time difference between both clocks (see `clock_sync_process_sample`).
+ */
+struct clock_sample {
+    // Time of the sender when the packet was sent.
+    double send_time {0};
+
+    // Send time of the latest sample received from the other end.
+    double echo_time {0};
+
+    // Time elapsed between receiving the echoed sample and sending this one,
+    // or negative if there's no sample to echo.
+    float echo_delay {-1};
+};
+
+template<typename Archive>
+void serialize(Archive &archive, clock_sample &sample) {
+    archive(sample.send_time);
+    archive(sample.echo_time);
+    archive(sample.echo_delay);
+}
+
+}
+
+#endif // EDYN_NETWORKING_PACKET_CLOCK_SAMPLE_HPP
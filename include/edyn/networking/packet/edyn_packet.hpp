@@ -16,6 +16,9 @@
 #include "edyn/networking/packet/time_response.hpp"
 #include "edyn/networking/packet/server_settings.hpp"
 #include "edyn/networking/packet/set_aabb_of_interest.hpp"
+#include "edyn/networking/packet/snapshot_ack.hpp"
+#include "edyn/networking/packet/action_ack.hpp"
+#include "edyn/networking/packet/island_sleep.hpp"
 #include <variant>
 
 namespace edyn::packet {
@@ -42,7 +45,11 @@ struct edyn_packet {
         entity_entered,
         entity_exited,
         asset_sync,
-        asset_sync_response
+        asset_sync_response,
+        snapshot_ack,
+        action_ack,
+        island_slept,
+        island_woke
     > var;
 };
 
@@ -56,7 +63,9 @@ using timed_packets_tuple_t = std::tuple<
 using unreliable_packets_tuple_t = std::tuple<
     packet::registry_snapshot,
     packet::time_request,
-    packet::time_response
+    packet::time_response,
+    packet::snapshot_ack,
+    packet::action_ack
 >;
 
 template<typename Archive>
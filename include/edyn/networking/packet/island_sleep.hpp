@@ -0,0 +1,39 @@
+#ifndef EDYN_NETWORKING_PACKET_ISLAND_SLEEP_HPP
+#define EDYN_NETWORKING_PACKET_ISLAND_SLEEP_HPP
+
+#include <vector>
+#include <entt/entity/fwd.hpp>
+#include "edyn/networking/packet/registry_snapshot.hpp"
+
+namespace edyn::packet {
+
+/**
+ * @brief Sent by the server when an island falls asleep, with the transforms
+ * and velocities its residents rest at. Registry snapshots don't include them
+ * while they sleep (see `server_network_settings::island_sleep_replication`).
+ */
+struct island_slept {
+    registry_snapshot snapshot;
+};
+
+/**
+ * @brief Sent by the server when an island wakes up, after which registry
+ * snapshots include its residents again.
+ */
+struct island_woke {
+    std::vector<entt::entity> entities;
+};
+
+template<typename Archive>
+void serialize(Archive &archive, island_slept &packet) {
+    archive(packet.snapshot);
+}
+
+template<typename Archive>
+void serialize(Archive &archive, island_woke &packet) {
+    archive(packet.entities);
+}
+
+}
+
+#endif // EDYN_NETWORKING_PACKET_ISLAND_SLEEP_HPP
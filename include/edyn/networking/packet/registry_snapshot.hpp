@@ -5,6 +5,7 @@
 #include "edyn/replication/entity_map.hpp"
 #include "edyn/util/tuple_util.hpp"
 #include "edyn/networking/util/pool_snapshot.hpp"
+#include "edyn/networking/packet/clock_sample.hpp"
 
 namespace edyn::packet {
 
@@ -18,6 +19,16 @@ namespace edyn::packet {
  */
 struct registry_snapshot {
     double timestamp;
+
+    // Sequence number of snapshots sent by the server to a client, which
+    // the client acknowledges to enable delta encoding relative to the
+    // snapshots it has received (see `snapshot_baseline`). Zero if the
+    // snapshot is not part of the sequence.
+    snapshot_baseline::id_type id {snapshot_baseline::null_id};
+
+    // Timestamps for round-trip time and clock offset estimation.
+    clock_sample clock;
+
     std::vector<entt::entity> entities;
     std::vector<pool_snapshot> pools;
 
@@ -35,7 +46,31 @@ struct registry_snapshot {
 template<typename Archive>
 void serialize(Archive &archive, registry_snapshot &snapshot) {
     archive(snapshot.timestamp);
-    archive(snapshot.entities);
+    archive(snapshot.id);
+    archive(snapshot.clock);
+
+    // The entity count does not use the size type of vectors in general,
+    // which would limit snapshots to 65535 entities.
+    auto num_entities = static_cast<uint32_t>(snapshot.entities.size());
+    archive(num_entities);
+
+    if constexpr(Archive::is_input::value) {
+        // Reject invalid data.
+        if (num_entities > max_snapshot_entities) {
+            snapshot.entities.clear();
+            snapshot.pools.clear();
+            return;
+        }
+
+        snapshot.entities.resize(num_entities);
+    } else {
+        EDYN_ASSERT(num_entities <= max_snapshot_entities);
+    }
+
+    for (auto &entity : snapshot.entities) {
+        archive(entity);
+    }
+
     archive(snapshot.pools);
 }
 
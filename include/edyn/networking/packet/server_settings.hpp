@@ -14,6 +14,18 @@ struct server_settings {
     uint8_t num_solver_position_iterations;
     uint8_t num_restitution_iterations;
     uint8_t num_individual_restitution_iterations;
+    uint8_t num_solver_substeps;
+    uint8_t min_solver_velocity_iterations;
+    scalar solver_velocity_tolerance;
+    bool contact_block_solver;
+    bool articulate_distance_chains;
+    bool deterministic;
+    scalar contact_reuse_linear_tolerance;
+    scalar contact_reuse_angular_tolerance;
+    bool nbody_gravity;
+    scalar nbody_gravity_constant;
+    scalar nbody_gravity_theta;
+    scalar nbody_gravity_softening;
     bool allow_full_ownership;
 
     server_settings() = default;
@@ -25,6 +37,18 @@ struct server_settings {
         , num_solver_position_iterations(settings.num_solver_position_iterations)
         , num_restitution_iterations(settings.num_restitution_iterations)
         , num_individual_restitution_iterations(settings.num_individual_restitution_iterations)
+        , num_solver_substeps(settings.num_solver_substeps)
+        , min_solver_velocity_iterations(settings.min_solver_velocity_iterations)
+        , solver_velocity_tolerance(settings.solver_velocity_tolerance)
+        , contact_block_solver(settings.contact_block_solver)
+        , articulate_distance_chains(settings.articulate_distance_chains)
+        , deterministic(settings.deterministic)
+        , contact_reuse_linear_tolerance(settings.contact_reuse_linear_tolerance)
+        , contact_reuse_angular_tolerance(settings.contact_reuse_angular_tolerance)
+        , nbody_gravity(settings.nbody_gravity)
+        , nbody_gravity_constant(settings.nbody_gravity_constant)
+        , nbody_gravity_theta(settings.nbody_gravity_theta)
+        , nbody_gravity_softening(settings.nbody_gravity_softening)
         , allow_full_ownership(allow_full_ownership)
     {}
 };
@@ -37,6 +61,18 @@ void serialize(Archive &archive, server_settings &settings) {
     archive(settings.num_solver_position_iterations);
     archive(settings.num_restitution_iterations);
     archive(settings.num_individual_restitution_iterations);
+    archive(settings.num_solver_substeps);
+    archive(settings.min_solver_velocity_iterations);
+    archive(settings.solver_velocity_tolerance);
+    archive(settings.contact_block_solver);
+    archive(settings.articulate_distance_chains);
+    archive(settings.deterministic);
+    archive(settings.contact_reuse_linear_tolerance);
+    archive(settings.contact_reuse_angular_tolerance);
+    archive(settings.nbody_gravity);
+    archive(settings.nbody_gravity_constant);
+    archive(settings.nbody_gravity_theta);
+    archive(settings.nbody_gravity_softening);
     archive(settings.allow_full_ownership);
 }
 
@@ -0,0 +1,25 @@
+#ifndef EDYN_NETWORKING_PACKET_SNAPSHOT_ACK_HPP
+#define EDYN_NETWORKING_PACKET_SNAPSHOT_ACK_HPP
+
+#include <vector>
+#include "edyn/networking/util/snapshot_baseline.hpp"
+
+namespace edyn::packet {
+
+/**
+ * @brief Acknowledges the registry snapshots received by the client, which
+ * allows the server to encode the following snapshots as a delta against
+ * them.
+ */
+struct snapshot_ack {
+    std::vector<snapshot_baseline::id_type> ids;
+};
+
+template<typename Archive>
+void serialize(Archive &archive, snapshot_ack &packet) {
+    archive(packet.ids);
+}
+
+}
+
+#endif // EDYN_NETWORKING_PACKET_SNAPSHOT_ACK_HPP
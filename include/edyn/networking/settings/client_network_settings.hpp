@@ -17,12 +17,65 @@ struct client_network_settings {
     scalar discontinuity_decay_rate {scalar(6)};
 
     // All actions older than this amount are deleted in every update.
-    // The entire action history is included in every registry snapshot, thus
-    // it is desirable to keep this low to minimize packet size. Though, a
-    // longer action history decreases the chances of actions being lost. It
-    // is sensible to increase it in case packet loss is high.
+    // Actions are removed from the history once the server acknowledges them
+    // and all actions that haven't been acknowledged are included in every
+    // registry snapshot. This only limits the size of the history if the
+    // acknowledgements are not arriving, in which case a longer history
+    // decreases the chances of actions being lost.
     double action_history_max_age {1.0};
 
+    // Number of extrapolation workers, each in its own thread and with its
+    // own copy of the networked entities, which process extrapolation
+    // requests concurrently. Requests involving entities which are being
+    // extrapolated by a worker are sent to the same worker, so results for
+    // the same entities arrive in order.
+    unsigned num_extrapolation_workers {1};
+
+    // Maximum duration of an extrapolation in seconds. Once the deadline
+    // passes, the extrapolation stops and the partial result is returned,
+    // which triggers the extrapolation timeout signal.
+    double extrapolation_time_limit {0.4};
+
+    // Whether to only extrapolate the islands which contain entities owned by
+    // this client and the islands within `extrapolation_radius` of them. The
+    // state of the other entities in registry snapshots is applied right away
+    // and smoothed out by the discontinuity accumulators, as if extrapolation
+    // was disabled.
+    bool extrapolate_owned_islands_only {false};
+    scalar extrapolation_radius {scalar(2)};
+
+    // Whether to present the entities which are not extrapolated, e.g. the
+    // ones outside of the extrapolation radius or all of them if
+    // extrapolation is disabled, by interpolating between the transforms in
+    // the last registry snapshots (see `interpolation_buffer`) instead of
+    // using the local simulation, which allows them to be made kinematic or
+    // put to sleep locally. Entities owned by this client are not affected.
+    // They are presented `interpolation_delay` seconds in the past, which
+    // should be greater than the interval between registry snapshots.
+    bool interpolate_unpredicted_entities {false};
+    double interpolation_delay {0.1};
+
+    // Whether to serialize all packets sent to the server in an update into a
+    // single buffer, which is published into the packet batch sink at the
+    // end of the update instead of publishing each packet into the packet
+    // sink. Packets sent in between updates wait until the next update.
+    bool batch_packets {false};
+
+    // Whether to accumulate the counters in `network_stats`, such as the size
+    // of each component in the registry snapshots sent, which requires
+    // serializing each pool separately.
+    bool collect_network_stats {false};
+
+    // Whether to compare the transforms and velocities in the registry
+    // snapshots which are applied right away with the local ones, and to
+    // leave the entities whose state matches within these tolerances
+    // untouched, along with their islands, which would otherwise be woken up
+    // by every snapshot. Angles are in radians.
+    bool reconcile_snapshots {true};
+    scalar reconciliation_position_tolerance {scalar(0.002)};
+    scalar reconciliation_orientation_tolerance {scalar(0.004)};
+    scalar reconciliation_velocity_tolerance {scalar(0.01)};
+
     extrapolation_callback_t extrapolation_init_callback {nullptr};
     extrapolation_callback_t extrapolation_deinit_callback {nullptr};
     extrapolation_callback_t extrapolation_begin_callback {nullptr};
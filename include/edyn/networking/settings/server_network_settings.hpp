@@ -1,8 +1,21 @@
 #ifndef EDYN_NETWORKING_SETTINGS_SERVER_NETWORK_SETTINGS_HPP
 #define EDYN_NETWORKING_SETTINGS_SERVER_NETWORK_SETTINGS_HPP
 
+#include <vector>
+#include <cstddef>
+#include <entt/entity/fwd.hpp>
+#include "edyn/math/scalar.hpp"
+
 namespace edyn {
 
+struct snapshot_rate_tier {
+    // Entities up to this distance use this tier.
+    scalar max_distance;
+
+    // Snapshot rate in Hz.
+    double rate;
+};
+
 struct server_network_settings {
     // Client playout delay buffer length will be calculated as the greatest
     // latency among all clients in its AABB of interest multiplied by this
@@ -15,6 +28,100 @@ struct server_network_settings {
     // longer be delayed, they'll be applied immediately instead, which can lead
     // to jitter.
     double max_playout_delay {2};
+
+    // Registry snapshots sent to clients are split into multiple packets with
+    // an estimated size in bytes no greater than this value, which should be
+    // the MTU of the connection minus the size of the headers added by the
+    // transport layer. The entities closest to the center of the AABB of
+    // interest of the client are placed in the first packets. Set to zero to
+    // send each snapshot in a single packet.
+    size_t max_snapshot_packet_size {1200};
+
+    // Maximum number of entities that entered the AABB of interest of a client
+    // to be sent to it in each update. The remaining are sent in the following
+    // updates, nearest to the entity followed by its AABB of interest first,
+    // and are not included in registry snapshots until then. Assets are sent
+    // as a whole and count as one. Zero means no limit.
+    size_t max_entities_entered_per_update {0};
+
+    // Size of the cells of the grid used to find the entities in the AABB of
+    // interest of each client (see `interest_grid`). Entities which share a
+    // cell with the AABB of interest are considered to be inside of it. It
+    // should be comparable to the size of the islands and a fraction of the
+    // size of the AABBs of interest. Only applied when the grid is created by
+    // the first update in sequential execution modes.
+    scalar interest_cell_size {50};
+
+    // Whether to encode components in registry snapshots as a delta against
+    // the last value acknowledged by the client. Components which haven't
+    // changed since then are not sent.
+    bool snapshot_delta_encoding {true};
+
+    // Whether to serialize all packets sent to a client in an update into a
+    // single buffer, which is published into the packet batch sink at the
+    // end of the update instead of publishing each packet into the packet
+    // sink. Packets sent in between updates wait until the next update.
+    bool batch_packets {false};
+
+    // Whether to accumulate the counters in `network_stats`, such as the size
+    // of each component in the registry snapshots sent, which requires
+    // serializing each pool separately.
+    bool collect_network_stats {false};
+
+    // Whether to tag rigid bodies outside the AABB of interest of all clients
+    // with a `low_fidelity_tag`, which makes their islands be solved with
+    // fewer iterations (see `settings::num_low_fidelity_velocity_iterations`).
+    // Full fidelity is restored once they enter an AABB of interest, thus the
+    // AABBs of interest should extend a bit beyond the region visible to the
+    // clients.
+    bool low_fidelity_outside_interest {false};
+
+    // Whether to load the pages of paged triangle meshes ahead of the AABB
+    // of interest of each client, in the direction the entity it follows is
+    // moving (see `aabb_oi_follow`), and to keep the pages which intersect
+    // any AABB of interest pinned in the `paged_mesh_page_cache`. This spares
+    // the steps from waiting on pages when a fast client enters new terrain.
+    // Pinned pages are not unloaded even if the byte budget of the cache is
+    // exceeded, thus the AABBs of interest should not be much larger than
+    // needed.
+    bool prefetch_paged_meshes_of_interest {false};
+
+    // Pages are loaded ahead of the AABBs of interest by the displacement of
+    // the followed entities in this many seconds.
+    scalar paged_mesh_of_interest_lookahead {1};
+
+    // Whether to send the state at which the residents of an island fell
+    // asleep once in a `packet::island_slept` and a `packet::island_woke`
+    // when they wake up, instead of including their transforms and velocities
+    // in registry snapshots until these are no longer considered modified.
+    // Sleeping entities are left out of registry snapshots entirely unless
+    // other components of theirs change.
+    bool island_sleep_replication {true};
+
+    // The priority of an entity in the snapshots sent to a client increases
+    // each second by `(1 + speed * priority_speed_factor) / (1 + distance *
+    // priority_distance_factor)`, where `speed` is the linear speed of the
+    // entity and `distance` is its distance to the closest entity owned by the
+    // client, or the center of its AABB of interest if it owns none. Entities
+    // with higher priority are sent first when the bandwidth is limited.
+    scalar priority_speed_factor {0.5};
+    scalar priority_distance_factor {0.1};
+
+    // Rate at which entities are included in the snapshots sent to a client
+    // according to their distance to the entity followed by the AABB of
+    // interest of the client (see `aabb_oi_follow`) or the center of the AABB
+    // of interest, sorted by increasing distance, e.g. `{{20, 60}, {80, 20},
+    // {EDYN_SCALAR_MAX, 5}}`. Entities beyond the last tier use its rate. The
+    // rate is limited by `remote_client::snapshot_rate`, which is used for
+    // all entities if empty. Modified components are only exported for a
+    // limited time, thus rates lower than 2.5 Hz might miss updates.
+    std::vector<snapshot_rate_tier> snapshot_rate_tiers;
+
+    // Optional function which returns the snapshot rate of an entity for a
+    // client, which replaces the rate tiers. Entities are not sent if the
+    // rate is not greater than zero.
+    using snapshot_rate_func_t = double(const entt::registry &, entt::entity client_entity, entt::entity entity);
+    snapshot_rate_func_t *snapshot_rate_func {nullptr};
 };
 
 }
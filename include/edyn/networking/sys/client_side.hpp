@@ -33,6 +33,14 @@ void deinit_network_client(entt::registry &);
  */
 void update_network_client(entt::registry &);
 
+/**
+ * @brief Creates extrapolation workers until there are as many as set in
+ * `client_network_settings::num_extrapolation_workers`. Workers are not
+ * destroyed if the number decreases, they just stop receiving requests.
+ * @param registry Data source.
+ */
+void update_extrapolation_workers(entt::registry &);
+
 /**
  * @brief Receives an Edyn packet from server. Must be called for every packet
  * received.
@@ -41,6 +49,16 @@ void update_network_client(entt::registry &);
  */
 void client_receive_packet(entt::registry &, packet::edyn_packet &);
 
+/**
+ * @brief Receives a batch of Edyn packets from the server, which was
+ * published into the server's packet batch sink.
+ * @param registry Data source.
+ * @param data Contents of the batch.
+ * @param size Size of the batch in bytes.
+ * @return Whether the batch was read successfully.
+ */
+bool client_receive_packet_batch(entt::registry &, const uint8_t *data, size_t size);
+
 /**
  * @brief Check whether the current client owns the given networked entity.
  * @param registry Data source.
@@ -38,6 +38,18 @@ void update_network_server(entt::registry &);
  */
 void server_receive_packet(entt::registry &, entt::entity client_entity, packet::edyn_packet &);
 
+/**
+ * @brief Receives a batch of Edyn packets from a client, which was published
+ * into the client's packet batch sink.
+ * @param registry Data source.
+ * @param client_entity Client who sent the packets.
+ * @param data Contents of the batch.
+ * @param size Size of the batch in bytes.
+ * @return Whether the batch was read successfully.
+ */
+bool server_receive_packet_batch(entt::registry &, entt::entity client_entity,
+                                 const uint8_t *data, size_t size);
+
 /**
  * @brief Create a new client. Must be called when a connection is established
  * with a new client.
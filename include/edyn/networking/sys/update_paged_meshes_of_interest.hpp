@@ -0,0 +1,27 @@
+#ifndef EDYN_NETWORKING_UPDATE_PAGED_MESHES_OF_INTEREST_HPP
+#define EDYN_NETWORKING_UPDATE_PAGED_MESHES_OF_INTEREST_HPP
+
+#include <entt/entity/fwd.hpp>
+#include "edyn/math/scalar.hpp"
+
+namespace edyn {
+
+struct paged_mesh_pinned_pages;
+
+/**
+ * @brief Starts loading the pages of paged triangle meshes which intersect
+ * the AABB of interest of each client swept by the linear velocity of the
+ * entity it follows (see `aabb_oi_follow`) times `lookahead` seconds, and
+ * pins the pages which intersect any AABB of interest in place of the
+ * previously pinned ones.
+ * @param registry Data source.
+ * @param pinned Pages pinned in the last update.
+ * @param lookahead Time in seconds ahead of the AABBs of interest.
+ */
+void update_paged_meshes_of_interest(entt::registry &registry,
+                                     paged_mesh_pinned_pages &pinned,
+                                     scalar lookahead);
+
+}
+
+#endif // EDYN_NETWORKING_UPDATE_PAGED_MESHES_OF_INTEREST_HPP
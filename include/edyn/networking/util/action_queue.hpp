@@ -0,0 +1,95 @@
+#ifndef EDYN_NETWORKING_UTIL_ACTION_QUEUE_HPP
+#define EDYN_NETWORKING_UTIL_ACTION_QUEUE_HPP
+
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+#include <entt/entity/entity.hpp>
+#include "edyn/config/config.h"
+
+namespace edyn {
+
+struct queued_action {
+    // Time at which the action is due, which is its timestamp plus the
+    // playout delay of the client.
+    double execution_time;
+    // Timestamp of the entry in the `action_history` of the entity.
+    double timestamp;
+    entt::entity entity;
+    entt::entity client_entity;
+};
+
+/**
+ * @brief Actions of all clients which are yet to be executed by the server, in
+ * a binary min-heap ordered by execution time. Actions of the same entity are
+ * due in the order of their timestamps since they share the playout delay of
+ * the same client. Insertion and removal take logarithmic time, thus each
+ * update only touches the actions that are due.
+ */
+class action_queue {
+public:
+    void push(const queued_action &action);
+
+    bool empty() const {
+        return m_heap.empty();
+    }
+
+    size_t size() const {
+        return m_heap.size();
+    }
+
+    /**
+     * @brief Action with the earliest execution time. The queue must not be
+     * empty.
+     */
+    const queued_action & top() const {
+        EDYN_ASSERT(!empty());
+        return m_heap.front();
+    }
+
+    /**
+     * @brief Removes the action with the earliest execution time. The queue
+     * must not be empty.
+     */
+    void pop();
+
+    /**
+     * @brief Assigns a new execution time to all actions and restores the
+     * order, which takes linear time. It's used when playout delays change.
+     * @param func Function with signature `double(const queued_action &)`
+     * which returns the new execution time of an action.
+     */
+    template<typename Func>
+    void update_execution_times(Func func);
+
+    void clear() {
+        m_heap.clear();
+    }
+
+private:
+    // Whether `lhs` is due after `rhs`, which makes the standard heap
+    // functions keep the earliest action at the front.
+    static bool later(const queued_action &lhs, const queued_action &rhs) {
+        if (lhs.execution_time != rhs.execution_time) {
+            return lhs.execution_time > rhs.execution_time;
+        }
+
+        return lhs.timestamp > rhs.timestamp;
+    }
+
+    std::vector<queued_action> m_heap;
+};
+
+template<typename Func>
+void action_queue::update_execution_times(Func func) {
+    for (auto &action : m_heap) {
+        action.execution_time = func(std::as_const(action));
+    }
+
+    std::make_heap(m_heap.begin(), m_heap.end(), &later);
+}
+
+}
+
+#endif // EDYN_NETWORKING_UTIL_ACTION_QUEUE_HPP
@@ -90,10 +90,11 @@ class client_snapshot_exporter_impl : public client_snapshot_exporter {
                 continue;
             }
 
-            auto data = std::vector<uint8_t>{};
-            auto archive = memory_output_archive(data);
+            // Serialize directly into the history buffer.
+            auto offset = history.data.size();
+            auto archive = memory_output_archive(history.data);
             archive(list);
-            history.entries.emplace_back(time, index, std::move(data));
+            history.push_entry(time, index, offset);
         }
     }
 
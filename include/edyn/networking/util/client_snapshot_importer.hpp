@@ -28,6 +28,10 @@ class client_snapshot_importer_impl : public client_snapshot_importer {
     void import_components(entt::registry &registry, const entity_map &emap,
                            const std::vector<entt::entity> &entities,
                            const pool_snapshot_data_impl<Component> &pool) {
+        // Look up the storage once instead of once per entity, since packets
+        // of new entities can carry thousands of them.
+        auto &storage = registry.storage<Component>();
+
         for (size_t i = 0; i < pool.entity_indices.size(); ++i) {
             auto entity_index = pool.entity_indices[i];
             auto remote_entity = entities[entity_index];
@@ -43,19 +47,19 @@ class client_snapshot_importer_impl : public client_snapshot_importer {
             }
 
             if constexpr(std::is_empty_v<Component>) {
-                if (!registry.any_of<Component>(local_entity)) {
-                    registry.emplace<Component>(local_entity);
+                if (!storage.contains(local_entity)) {
+                    storage.emplace(local_entity);
                 }
             } else {
                 auto comp = pool.components[i];
                 internal::map_child_entity(registry, emap, comp);
 
-                if (registry.any_of<Component>(local_entity)) {
-                    registry.patch<Component>(local_entity, [&](auto &&current) {
+                if (storage.contains(local_entity)) {
+                    storage.patch(local_entity, [&](auto &&current) {
                         merge_component(current, comp);
                     });
                 } else {
-                    registry.emplace<Component>(local_entity, comp);
+                    storage.emplace(local_entity, comp);
                 }
             }
         }
@@ -3,6 +3,7 @@
 
 #include "edyn/config/config.h"
 #include "edyn/networking/packet/edyn_packet.hpp"
+#include "edyn/networking/packet/clock_sample.hpp"
 #include "edyn/networking/packet/time_request.hpp"
 #include "edyn/networking/packet/time_response.hpp"
 #include <entt/signal/fwd.hpp>
@@ -54,6 +55,36 @@ struct clock_sync_data {
     // clock syncs should be performed.
     double period {5.0 * 60.0};
 
+    // Send time of the latest clock sample received from the remote end,
+    // which is echoed back, and the local time when it was received.
+    double remote_send_time {0};
+    double remote_receive_time {0};
+    bool has_remote_sample {false};
+
+    // Echo time of the last clock sample processed, which is used to ignore
+    // repeated echoes, e.g. when a snapshot is split in multiple packets.
+    double last_echo_time {0};
+
+    // Local time when the last round-trip time sample was obtained.
+    double last_sample_time {0};
+
+    // Number of round-trip time samples obtained from clock samples.
+    unsigned sample_count {0};
+
+    // Smoothed round-trip time and its mean deviation, i.e. jitter, given by
+    // exponentially weighted moving averages of the samples.
+    double round_trip_time {0};
+    double round_trip_time_deviation {0};
+
+    // Weights of new samples in the moving averages.
+    static constexpr double round_trip_time_gain = 0.125;
+    static constexpr double deviation_gain = 0.25;
+    static constexpr double time_delta_gain = 0.125;
+
+    // Time requests are not sent while clock samples arrive more often than
+    // this interval.
+    double sample_timeout {2.0};
+
     // Delegate invoked when the clock synchronization process needs to send a
     // packet, such as a time request.
     entt::delegate<void(const packet::edyn_packet &)> send_packet;
@@ -62,6 +93,25 @@ struct clock_sync_data {
 void clock_sync_process_time_response(clock_sync_data &clock_sync, const packet::time_response &res, double time);
 void update_clock_sync(clock_sync_data &clock_sync, double time, double avg_rtt);
 
+/**
+ * @brief Creates a clock sample to be sent to the remote end at the given time.
+ */
+packet::clock_sample clock_sync_make_sample(const clock_sync_data &clock_sync, double time);
+
+/**
+ * @brief Updates the round-trip time and time delta estimates with a clock
+ * sample received from the remote end at the given time.
+ */
+void clock_sync_process_sample(clock_sync_data &clock_sync, const packet::clock_sample &sample, double time);
+
+/**
+ * @brief Smoothed round-trip time estimated from clock samples, or the given
+ * value if there are no samples yet.
+ */
+inline double clock_sync_round_trip_time(const clock_sync_data &clock_sync, double fallback_rtt) {
+    return clock_sync.sample_count > 0 ? clock_sync.round_trip_time : fallback_rtt;
+}
+
 }
 
 #endif // EDYN_NETWORKING_UTIL_CLOCK_SYNC_HPP
@@ -2,10 +2,15 @@
 #define EDYN_NETWORKING_UTIL_INPUT_STATE_HISTORY_HPP
 
 #include <entt/entity/fwd.hpp>
+#include <array>
+#include <atomic>
+#include <limits>
 #include <memory>
-#include <mutex>
 #include <vector>
+#include <utility>
+#include <algorithm>
 #include <type_traits>
+#include <unordered_map>
 #include <entt/core/type_info.hpp>
 #include <entt/entity/registry.hpp>
 #include "edyn/comp/action_list.hpp"
@@ -15,37 +20,281 @@
 namespace edyn {
 
 namespace internal {
+    /**
+     * @brief Fixed-capacity ring buffer of the timestamped states of an input
+     * component of one entity. There's a single writer which appends states
+     * in chronological order and discards the oldest once full, and readers
+     * in other threads which never block the writer. Each slot has a sequence
+     * number which is odd while it's being written, thus a reader discards a
+     * state if the sequence changed while copying it.
+     */
     template<typename Component>
-    struct component_history {
+    class input_ring {
+        static_assert(std::is_trivially_copyable_v<Component>,
+                      "Input components must be trivially copyable.");
+
+    public:
+        static constexpr size_t capacity = 256;
+
         struct entry {
             Component component;
             double timestamp;
         };
 
-        std::vector<entry> entries;
+        // Writer only.
+        void push(const Component &comp, double timestamp) {
+            auto index = m_end.load(std::memory_order_relaxed);
+
+            if (index - m_begin.load(std::memory_order_relaxed) == capacity) {
+                m_begin.store(index - capacity + 1, std::memory_order_release);
+            }
+
+            auto &s = m_slots[index % capacity];
+            auto seq = s.seq.load(std::memory_order_relaxed);
+            s.seq.store(seq + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            s.value = {comp, timestamp};
+            s.seq.store(seq + 2, std::memory_order_release);
+            m_end.store(index + 1, std::memory_order_release);
+        }
+
+        // Writer only. Discards all states with a timestamp up to the given
+        // time.
+        void erase_until(double timestamp) {
+            auto begin = m_begin.load(std::memory_order_relaxed);
+            auto end = m_end.load(std::memory_order_relaxed);
+
+            while (begin < end && m_slots[begin % capacity].value.timestamp <= timestamp) {
+                ++begin;
+            }
+
+            m_begin.store(begin, std::memory_order_release);
+        }
+
+        // Range of indices of the valid states at the time of the call.
+        std::pair<uint64_t, uint64_t> range() const {
+            auto end = m_end.load(std::memory_order_acquire);
+            auto begin = m_begin.load(std::memory_order_acquire);
+            return {std::min(begin, end), end};
+        }
+
+        // Copy the state at the given index into `result`. Returns false if
+        // it was overwritten in the meantime.
+        size_t num_bytes() const {
+            return sizeof(*this);
+        }
+
+        bool read(uint64_t index, entry &result) const {
+            auto &s = m_slots[index % capacity];
+            auto seq = s.seq.load(std::memory_order_acquire);
+
+            if (seq & 1) {
+                return false;
+            }
+
+            result = s.value;
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            return s.seq.load(std::memory_order_relaxed) == seq &&
+                   m_begin.load(std::memory_order_relaxed) <= index;
+        }
+
+    private:
+        struct slot {
+            std::atomic<uint64_t> seq {0};
+            entry value {};
+        };
+
+        std::array<slot, capacity> m_slots;
+        std::atomic<uint64_t> m_begin {0};
+        std::atomic<uint64_t> m_end {0};
+    };
+
+    /**
+     * @brief Fixed-capacity ring buffer of the actions of one entity. Action
+     * data has variable size, thus entries are immutable and are replaced
+     * atomically (RCU-style) instead of being copied under a sequence number.
+     */
+    class action_ring {
+    public:
+        static constexpr size_t capacity = 256;
+
+        struct entry {
+            double timestamp;
+            action_history::action_index_type action_index;
+            std::vector<uint8_t> data;
+        };
+
+        using entry_ptr = std::shared_ptr<const entry>;
+
+        // Writer only. Appends entries newer than the last appended, as in
+        // `action_history::merge`.
+        void merge(const action_history &history) {
+            for (auto &entry : history.entries) {
+                if (entry.timestamp <= m_last_timestamp) {
+                    continue;
+                }
+
+                auto index = m_end.load(std::memory_order_relaxed);
+
+                if (index - m_begin.load(std::memory_order_relaxed) == capacity) {
+                    m_begin.store(index - capacity + 1, std::memory_order_release);
+                }
+
+                auto *data = history.entry_data(entry);
+                auto ptr = std::make_shared<const action_ring::entry>(action_ring::entry{
+                    entry.timestamp, entry.action_index, std::vector<uint8_t>(data, data + entry.size)});
+                std::atomic_store_explicit(&m_slots[index % capacity], std::move(ptr),
+                                           std::memory_order_release);
+                m_end.store(index + 1, std::memory_order_release);
+                m_last_timestamp = entry.timestamp;
+            }
+        }
+
+        // Writer only. Discards all entries before the given time.
+        void erase_until(double timestamp) {
+            auto begin = m_begin.load(std::memory_order_relaxed);
+            auto end = m_end.load(std::memory_order_relaxed);
+
+            while (begin < end) {
+                auto &slot = m_slots[begin % capacity];
+
+                if (std::atomic_load_explicit(&slot, std::memory_order_relaxed)->timestamp >= timestamp) {
+                    break;
+                }
+
+                ++begin;
+            }
+
+            m_begin.store(begin, std::memory_order_release);
+        }
+
+        std::pair<uint64_t, uint64_t> range() const {
+            auto end = m_end.load(std::memory_order_acquire);
+            auto begin = m_begin.load(std::memory_order_acquire);
+            return {std::min(begin, end), end};
+        }
+
+        // Entry at the given index, which might be a newer entry if it was
+        // overwritten in the meantime.
+        entry_ptr read(uint64_t index) const {
+            return std::atomic_load_explicit(&m_slots[index % capacity], std::memory_order_acquire);
+        }
+
+        // Writer only.
+        size_t num_bytes() const {
+            auto size = sizeof(*this);
+
+            for (auto &slot : m_slots) {
+                if (auto ptr = std::atomic_load_explicit(&slot, std::memory_order_relaxed)) {
+                    size += sizeof(entry) + ptr->data.capacity();
+                }
+            }
+
+            return size;
+        }
+
+    private:
+        std::array<entry_ptr, capacity> m_slots;
+        std::atomic<uint64_t> m_begin {0};
+        std::atomic<uint64_t> m_end {0};
+        double m_last_timestamp {-std::numeric_limits<double>::infinity()};
+    };
+
+    /**
+     * @brief The rings of all entities with a history of some kind. The
+     * writer keeps its own map and publishes an immutable copy of it whenever
+     * an entity is inserted or removed, which readers acquire atomically. The
+     * rings are shared, thus a reader holding a copy of the list can keep
+     * reading from a ring even after its entity is removed.
+     */
+    template<typename Ring>
+    class ring_list {
+    public:
+        using list_type = std::vector<std::pair<entt::entity, std::shared_ptr<Ring>>>;
+
+        // Writer only.
+        Ring & get_or_insert(entt::entity entity) {
+            if (auto it = m_rings.find(entity); it != m_rings.end()) {
+                return *it->second;
+            }
+
+            auto &ring = m_rings[entity];
+            ring = std::make_shared<Ring>();
+            publish();
+            return *ring;
+        }
+
+        // Writer only.
+        void remove(entt::entity entity) {
+            if (m_rings.erase(entity) > 0) {
+                publish();
+            }
+        }
+
+        // Writer only.
+        template<typename Func>
+        void each(Func func) {
+            for (auto &[entity, ring] : m_rings) {
+                func(*ring);
+            }
+        }
+
+        std::shared_ptr<const list_type> acquire() const {
+            return std::atomic_load_explicit(&m_published, std::memory_order_acquire);
+        }
+
+        // Writer only. Estimated memory used by the rings and the map, not
+        // counting the published copies of the list.
+        size_t num_bytes() const {
+            auto size = m_rings.bucket_count() * sizeof(void *);
+
+            for (auto &[entity, ring] : m_rings) {
+                size += sizeof(typename decltype(m_rings)::value_type) + 2 * sizeof(void *) + ring->num_bytes();
+            }
+
+            return size;
+        }
+
+    private:
+        void publish() {
+            auto list = std::make_shared<list_type>(m_rings.begin(), m_rings.end());
+            std::atomic_store_explicit(&m_published, std::shared_ptr<const list_type>(std::move(list)),
+                                       std::memory_order_release);
+        }
+
+        std::unordered_map<entt::entity, std::shared_ptr<Ring>> m_rings;
+        std::shared_ptr<const list_type> m_published {std::make_shared<const list_type>()};
     };
 }
 
 /**
  * @brief A history of user inputs and actions which will be applied during
- * extrapolation. It is accessed from multiple threads so it has to be thread-safe.
+ * extrapolation. It is written by the main thread and read by extrapolation
+ * workers concurrently. Each entity has a ring buffer per input and one for
+ * actions, which are read without locking, thus reading never blocks the
+ * writer and vice versa. Input components must be trivially copyable.
  */
 template<typename... Inputs>
 struct input_state_history {
-    entt::storage<action_history> actions;
-    std::tuple<entt::storage<internal::component_history<Inputs>>...> inputs;
-    std::mutex mutex;
+    internal::ring_list<internal::action_ring> actions;
+    std::tuple<internal::ring_list<internal::input_ring<Inputs>>...> inputs;
 
     input_state_history() = default;
-    input_state_history(input_state_history &) = default;
-    input_state_history(input_state_history &&) = default;
-    input_state_history & operator=(input_state_history &) = default;
-    input_state_history & operator=(input_state_history &&) = default;
     input_state_history([[maybe_unused]] const std::tuple<Inputs...> &) {}
 
     template<typename Input>
     auto & get_inputs() {
-        return std::get<entt::storage<internal::component_history<Input>>>(inputs);
+        return std::get<internal::ring_list<internal::input_ring<Input>>>(inputs);
+    }
+
+    template<typename Input>
+    auto & get_inputs() const {
+        return std::get<internal::ring_list<internal::input_ring<Input>>>(inputs);
+    }
+
+    size_t num_bytes() const {
+        return actions.num_bytes() + (get_inputs<Inputs>().num_bytes() + ... + 0);
     }
 };
 
@@ -67,6 +316,9 @@ public:
     // Removes an entity from internal storages in case it had been added before.
     // Must be called for all entities that have been destroyed.
     virtual void remove_entity(entt::entity entity) = 0;
+
+    // Estimated memory used by the history.
+    virtual size_t num_bytes() const = 0;
 };
 
 class input_state_history_reader {
@@ -93,12 +345,8 @@ class input_state_history_writer_impl : public input_state_history_writer {
 
         for (auto entity : entities) {
             if (view.contains(entity)) {
-                if (!inputs.contains(entity)) {
-                    inputs.emplace(entity);
-                }
-
                 auto [comp] = view.get(entity);
-                inputs.get(entity).entries.push_back({comp, timestamp});
+                inputs.get_or_insert(entity).push(comp, timestamp);
             }
         }
     }
@@ -115,11 +363,7 @@ class input_state_history_writer_impl : public input_state_history_writer {
             auto &comp = typed_pool->components[i];
 
             if (entities.contains(entity)) {
-                if (!inputs.contains(entity)) {
-                    inputs.emplace(entity);
-                }
-
-                inputs.get(entity).entries.push_back({comp, timestamp});
+                inputs.get_or_insert(entity).push(comp, timestamp);
             }
         }
     }
@@ -132,11 +376,7 @@ class input_state_history_writer_impl : public input_state_history_writer {
                 auto [history] = history_view.get(entity);
 
                 if (!history.empty()) {
-                    if (!m_history->actions.contains(entity)) {
-                        m_history->actions.emplace(entity, history);
-                    } else {
-                        m_history->actions.get(entity).merge(history);
-                    }
+                    m_history->actions.get_or_insert(entity).merge(history);
                 }
             }
         }
@@ -155,29 +395,16 @@ class input_state_history_writer_impl : public input_state_history_writer {
                     entry.timestamp += time_delta;
                 }
 
-                if (!m_history->actions.contains(entity)) {
-                    m_history->actions.emplace(entity, comp);
-                } else {
-                    m_history->actions.get(entity).merge(comp);
-                }
+                m_history->actions.get_or_insert(entity).merge(comp);
             }
         }
     }
 
-    template<typename Array>
-    auto first_after(const Array &arr, double timestamp) const {
-        return std::find_if(arr.begin(), arr.end(),
-                            [timestamp](auto &&elem) { return elem.timestamp > timestamp; });
-    }
-
     template<typename Component>
     void erase_until(double timestamp) {
-        auto &inputs = m_history->template get_inputs<Component>();
-
-        for (auto [entity, history] : inputs.each()) {
-            auto it = first_after(history.entries, timestamp);
-            history.entries.erase(history.entries.begin(), it);
-        }
+        m_history->template get_inputs<Component>().each([timestamp](auto &ring) {
+            ring.erase_until(timestamp);
+        });
     }
 
 public:
@@ -187,7 +414,6 @@ public:
 
     void emplace(const entt::registry &registry,
                  const entt::sparse_set &entities, double timestamp) override {
-        std::lock_guard lock(m_history->mutex);
         (add<Inputs>(registry, entities, timestamp), ...);
         add_actions(registry, entities);
     }
@@ -195,7 +421,6 @@ public:
     void emplace(const packet::registry_snapshot &snap,
                  const entt::sparse_set &entities,
                  double timestamp, double time_delta) override {
-        std::lock_guard lock(m_history->mutex);
         for (auto &pool : snap.pools) {
             ((entt::type_index<Inputs>::value() == pool.ptr->get_type_id() ?
                 add<Inputs>(snap.entities, pool, entities, timestamp) :
@@ -209,21 +434,22 @@ public:
     }
 
     void erase_until(double timestamp) override {
-        std::lock_guard lock(m_history->mutex);
         (erase_until<Inputs>(timestamp), ...);
 
-        for (auto [entity, actions] : m_history->actions.each()) {
-            actions.erase_until(timestamp);
-        }
+        m_history->actions.each([timestamp](auto &ring) {
+            ring.erase_until(timestamp);
+        });
     }
 
     void remove_entity(entt::entity entity) override {
-        std::lock_guard lock(m_history->mutex);
-
         m_history->actions.remove(entity);
         (m_history->template get_inputs<Inputs>().remove(entity), ...);
     }
 
+    size_t num_bytes() const override {
+        return m_history->num_bytes();
+    }
+
 private:
     std::shared_ptr<input_state_history<Inputs...>> m_history;
 };
@@ -258,11 +484,18 @@ class input_state_history_reader_impl : public input_state_history_reader {
     template<typename Component>
     void import_each_input(double start_time, double length_of_time,
                            entt::registry &registry, const entity_map &emap) const {
-        auto &inputs = m_history->template get_inputs<Component>();
+        auto list = m_history->template get_inputs<Component>().acquire();
         auto end_time = start_time + length_of_time;
+        auto entry = typename internal::input_ring<Component>::entry{};
+
+        for (auto &[entity, ring] : *list) {
+            auto [begin, end] = ring->range();
+
+            for (auto i = begin; i < end; ++i) {
+                if (!ring->read(i, entry)) {
+                    continue;
+                }
 
-        for (auto [entity, history] : inputs.each()) {
-            for (auto &entry : history.entries) {
                 if (entry.timestamp > end_time) {
                     break;
                 }
@@ -280,55 +513,67 @@ class input_state_history_reader_impl : public input_state_history_reader {
             return;
         }
 
+        auto list = m_history->actions.acquire();
         auto end_time = start_time + length_of_time;
 
-        for (auto [entity, actions] : m_history->actions.each()) {
-            for (auto &entry : actions.entries) {
-                if (entry.timestamp > end_time) {
-                    break;
-                }
+        for (auto &[entity, ring] : *list) {
+            auto remote_entity = entity;
 
-                if (entry.timestamp >= start_time) {
-                    auto remote_entity = entity;
+            if (!emap.contains(remote_entity)) {
+                continue;
+            }
+
+            auto local_entity = emap.at(remote_entity);
 
-                    if (emap.contains(remote_entity)) {
-                        auto local_entity = emap.at(remote_entity);
+            if (!registry.valid(local_entity)) {
+                continue;
+            }
+
+            auto [begin, end] = ring->range();
+
+            for (auto i = begin; i < end; ++i) {
+                auto entry = ring->read(i);
+
+                if (!entry) {
+                    continue;
+                }
+
+                if (entry->timestamp > end_time) {
+                    break;
+                }
 
-                        if (registry.valid(local_entity)) {
-                            (*m_import_action_func)(registry, local_entity, entry.action_index, entry.data);
-                        }
-                    }
+                if (entry->timestamp >= start_time) {
+                    (*m_import_action_func)(registry, local_entity, entry->action_index,
+                                            entry->data.data(), entry->data.size());
                 }
             }
         }
     }
 
-    template<typename Array>
-    auto first_before(const Array &arr, double timestamp) const {
-        return std::find_if(arr.rbegin(), arr.rend(),
-                            [timestamp](auto &&elem) { return elem.timestamp <= timestamp; });
-    }
-
     template<typename Component>
     void import_latest_inputs(double time, entt::registry &registry, const entity_map &emap) const {
-        auto &inputs = m_history->template get_inputs<Component>();
+        auto list = m_history->template get_inputs<Component>().acquire();
+        auto entry = typename internal::input_ring<Component>::entry{};
 
-        for (auto [entity, history] : inputs.each()) {
-            // Import the first component state that's before the given time.
-            auto it = first_before(history.entries, time);
+        for (auto &[entity, ring] : *list) {
+            auto [begin, end] = ring->range();
 
-            if (it != history.entries.rend()) {
-                import_component(registry, entity, it->component, emap);
+            // Import the first component state that's before the given time.
+            for (auto i = end; i > begin; --i) {
+                if (ring->read(i - 1, entry) && entry.timestamp <= time) {
+                    import_component(registry, entity, entry.component, emap);
+                    break;
+                }
             }
         }
     }
 
     template<typename Action>
     static void import_action_single(entt::registry &registry, entt::entity entity,
-                                     const std::vector<uint8_t> &data) {
+                                     const uint8_t *data, size_t size) {
         using ActionListType = action_list<Action>;
         ActionListType import_list;
-        auto archive = memory_input_archive(data.data(), data.size());
+        auto archive = memory_input_archive(data, size);
         archive(import_list);
 
         if (archive.failed()) {
@@ -347,15 +592,15 @@ class input_state_history_reader_impl : public input_state_history_reader {
     template<typename... Actions>
     static auto import_action(entt::registry &registry, entt::entity entity,
                               action_history::action_index_type action_index,
-                              const std::vector<uint8_t> &data) {
+                              const uint8_t *data, size_t size) {
         static_assert(sizeof...(Actions) > 0);
         if constexpr(sizeof...(Actions) == 1) {
-            (import_action_single<Actions>(registry, entity, data), ...);
+            (import_action_single<Actions>(registry, entity, data, size), ...);
         } else {
             static const auto actions = std::tuple<Actions...>{};
             visit_tuple(actions, action_index, [&](auto &&a) {
                 using ActionType = std::decay_t<decltype(a)>;
-                import_action_single<ActionType>(registry, entity, data);
+                import_action_single<ActionType>(registry, entity, data, size);
             });
         }
     }
@@ -373,13 +618,11 @@ public:
 
     void import_each(double start_time, double length_of_time,
                      entt::registry &registry, const entity_map &emap) const override {
-        std::lock_guard lock(m_history->mutex);
         (import_each_input<Inputs>(start_time, length_of_time, registry, emap), ...);
         import_each_action(start_time, length_of_time, registry, emap);
     }
 
     void import_latest(double time, entt::registry &registry, const entity_map &emap) const override {
-        std::lock_guard lock(m_history->mutex);
         (import_latest_inputs<Inputs>(time, registry, emap), ...);
     }
 
@@ -388,7 +631,7 @@ private:
 
     using import_action_func_t = void(entt::registry &, entt::entity,
                                       action_history::action_index_type,
-                                      const std::vector<uint8_t> &);
+                                      const uint8_t *, size_t);
     import_action_func_t *m_import_action_func {nullptr};
 };
 
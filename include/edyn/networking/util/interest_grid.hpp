@@ -0,0 +1,95 @@
+#ifndef EDYN_NETWORKING_UTIL_INTEREST_GRID_HPP
+#define EDYN_NETWORKING_UTIL_INTEREST_GRID_HPP
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+#include <unordered_set>
+#include <entt/entity/fwd.hpp>
+#include "edyn/comp/aabb.hpp"
+#include "edyn/math/scalar.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Uniform grid which maintains the networked entities in the AABB of
+ * interest of each client incrementally. Islands and non-procedural entities
+ * are inserted in the cells their AABB overlaps and AABBs of interest watch
+ * the cells they overlap, thus a client is interested in all entities which
+ * share a cell with it. Only the islands and entities which moved to other
+ * cells or whose contents changed since the last update are visited, along
+ * with the cells a client enters or exits, and the entities that entered or
+ * exited the AABB of interest are calculated from these transitions instead
+ * of comparing the entire set of entities of interest of every client.
+ * Islands and entities with AABBs covering too many cells, such as planes,
+ * are not inserted in the grid and are tested against every AABB of interest
+ * directly.
+ */
+class interest_grid {
+public:
+    // AABBs covering more cells than this are not inserted in the grid.
+    static constexpr size_t max_unit_cells = 512;
+
+    explicit interest_grid(scalar cell_size);
+
+    /**
+     * @brief Updates the entities in all `aabb_of_interest`s, including the
+     * entities that entered and exited each.
+     */
+    void update(entt::registry &registry);
+
+private:
+    struct cell_range {
+        std::array<int32_t, 3> min;
+        std::array<int32_t, 3> max;
+
+        bool contains(const std::array<int32_t, 3> &coords) const;
+        bool overlaps(const cell_range &other) const;
+        size_t num_cells() const;
+        bool operator==(const cell_range &other) const;
+        bool operator!=(const cell_range &other) const;
+    };
+
+    // Entity which is inserted in the grid, i.e. an island or a
+    // non-procedural entity, along with the networked entities it contains.
+    struct unit {
+        AABB aabb;
+        cell_range range;
+        bool global;
+        std::vector<entt::entity> entities;
+    };
+
+    struct cell {
+        std::vector<entt::entity> units;
+        std::vector<entt::entity> watchers;
+    };
+
+    struct watcher {
+        AABB aabb;
+        cell_range range;
+        // Units which share a cell with this watcher.
+        std::unordered_set<entt::entity> units;
+        // Number of units containing each entity of interest.
+        std::unordered_map<entt::entity, unsigned> entity_count;
+    };
+
+    cell_range get_range(const AABB &aabb) const;
+
+    template<typename Func>
+    void each_cell(const cell_range &range, Func func);
+
+    void insert_unit(entt::entity, const unit &);
+    void erase_unit(entt::entity, const unit &);
+    bool is_interested(const watcher &, const unit &) const;
+
+    scalar m_cell_size;
+    std::unordered_map<uint64_t, cell> m_cells;
+    std::unordered_map<entt::entity, unit> m_units;
+    std::unordered_map<entt::entity, watcher> m_watchers;
+};
+
+}
+
+#endif // EDYN_NETWORKING_UTIL_INTEREST_GRID_HPP
@@ -0,0 +1,377 @@
+#ifndef EDYN_NETWORKING_UTIL_NETWORK_ENCODING_HPP
+#define EDYN_NETWORKING_UTIL_NETWORK_ENCODING_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include "edyn/math/vector3.hpp"
+#include "edyn/math/quaternion.hpp"
+#include "edyn/comp/position.hpp"
+#include "edyn/comp/orientation.hpp"
+#include "edyn/comp/linvel.hpp"
+#include "edyn/comp/angvel.hpp"
+#include "edyn/shapes/polyhedron_shape.hpp"
+#include "edyn/shapes/compound_shape.hpp"
+#include "edyn/shapes/shape_asset_cache.hpp"
+#include "edyn/serialization/s11n_util.hpp"
+
+namespace edyn {
+
+/**
+ * Encodings of the arrays of components of a pool in a snapshot. An encoding
+ * has a static `write` and `read` function taking the archive, a pointer to
+ * the components and their count. The quantized encodings only apply to the
+ * bit-packing archives and serialize components as is with other archives.
+ */
+
+/**
+ * @brief Serializes each component with its `serialize` function.
+ */
+struct raw_network_encoding {
+    template<typename Archive, typename Component>
+    static void write(Archive &archive, const Component *components, size_t count) {
+        archive.write_array(components, count);
+    }
+
+    template<typename Archive, typename Component>
+    static void read(Archive &archive, Component *components, size_t count) {
+        archive.read_array(components, count);
+    }
+};
+
+/**
+ * @brief Encodes vectors relative to the bounds of all vectors in the pool,
+ * in steps of `1 / StepsPerUnit`. The bounds are sent first and each
+ * coordinate is then stored in as many bits as necessary to cover them,
+ * thus there is no fixed range and no value is clamped. For positions, the
+ * bounds are within the AABB of interest of the client the snapshot is sent
+ * to. If bounds are so large that a coordinate would need more than
+ * `max_num_bits`, precision is reduced instead.
+ */
+template<unsigned StepsPerUnit>
+struct bounded_vector3_encoding {
+    static constexpr auto precision = scalar(1) / scalar(StepsPerUnit);
+    static constexpr unsigned max_num_bits = 24;
+
+    template<typename Archive, typename Component>
+    static void write(Archive &archive, const Component *components, size_t count) {
+        if constexpr(is_bitpack_archive_v<Archive>) {
+            write_quantized(archive, components, count);
+        } else {
+            raw_network_encoding::write(archive, components, count);
+        }
+    }
+
+private:
+    template<typename Archive, typename Component>
+    static void write_quantized(Archive &archive, const Component *components, size_t count) {
+        if (count == 0) {
+            return;
+        }
+
+        vector3 lower = components[0], upper = components[0];
+
+        for (size_t i = 1; i < count; ++i) {
+            lower = min(lower, components[i]);
+            upper = max(upper, components[i]);
+        }
+
+        archive(lower.x, lower.y, lower.z, upper.x, upper.y, upper.z);
+
+        for (size_t i = 0; i < count; ++i) {
+            for (size_t j = 0; j < 3; ++j) {
+                auto step = get_step(lower[j], upper[j]);
+                auto num_bits = get_num_bits(lower[j], upper[j], step);
+                auto q = std::round((components[i][j] - lower[j]) / step);
+                archive.write_bits(static_cast<uint64_t>(q), num_bits);
+            }
+        }
+    }
+
+public:
+    template<typename Archive, typename Component>
+    static void read(Archive &archive, Component *components, size_t count) {
+        if constexpr(is_bitpack_archive_v<Archive>) {
+            read_quantized(archive, components, count);
+        } else {
+            raw_network_encoding::read(archive, components, count);
+        }
+    }
+
+private:
+    template<typename Archive, typename Component>
+    static void read_quantized(Archive &archive, Component *components, size_t count) {
+        if (count == 0) {
+            return;
+        }
+
+        vector3 lower, upper;
+        archive(lower.x, lower.y, lower.z, upper.x, upper.y, upper.z);
+
+        for (size_t i = 0; i < count; ++i) {
+            for (size_t j = 0; j < 3; ++j) {
+                auto step = get_step(lower[j], upper[j]);
+                auto num_bits = get_num_bits(lower[j], upper[j], step);
+                auto q = archive.read_bits(num_bits);
+                components[i][j] = std::min(lower[j] + scalar(q) * step, upper[j]);
+            }
+        }
+    }
+
+    static scalar get_step(scalar lower, scalar upper) {
+        return std::max(precision, (upper - lower) / scalar((uint32_t(1) << max_num_bits) - 1));
+    }
+
+    static unsigned get_num_bits(scalar lower, scalar upper, scalar step) {
+        auto num_steps = static_cast<uint64_t>(std::round((upper - lower) / step));
+        auto num_bits = unsigned{0};
+
+        while (num_bits < max_num_bits && (uint64_t(1) << num_bits) <= num_steps) {
+            ++num_bits;
+        }
+
+        return num_bits;
+    }
+};
+
+/**
+ * @brief Encodes unit quaternions with the index of the component with the
+ * largest magnitude in 2 bits, followed by the other three components in
+ * `NumBits` bits each. The largest component is recovered from the unit
+ * length and its sign is made positive, since `q` and `-q` represent the
+ * same rotation. Uses 32 bits with the default of 10 bits per component.
+ */
+template<unsigned NumBits = 10>
+struct smallest_three_encoding {
+    // The three smallest components of a unit quaternion are within
+    // `[-1/sqrt(2), 1/sqrt(2)]`.
+    static constexpr auto range = scalar(0.707106781186547524);
+    static constexpr auto max_value = (uint32_t(1) << NumBits) - 1;
+
+    template<typename Archive, typename Component>
+    static void write(Archive &archive, const Component *components, size_t count) {
+        if constexpr(is_bitpack_archive_v<Archive>) {
+            write_quantized(archive, components, count);
+        } else {
+            raw_network_encoding::write(archive, components, count);
+        }
+    }
+
+private:
+    template<typename Archive, typename Component>
+    static void write_quantized(Archive &archive, const Component *components, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            auto q = normalize(static_cast<const quaternion &>(components[i]));
+            size_t largest = 0;
+
+            for (size_t j = 1; j < 4; ++j) {
+                if (std::abs(q[j]) > std::abs(q[largest])) {
+                    largest = j;
+                }
+            }
+
+            auto sign = q[largest] < 0 ? scalar(-1) : scalar(1);
+            archive.write_bits(largest, 2);
+
+            for (size_t j = 0; j < 4; ++j) {
+                if (j != largest) {
+                    auto v = std::clamp(q[j] * sign, -range, range);
+                    auto k = std::round((v + range) / (2 * range) * scalar(max_value));
+                    archive.write_bits(static_cast<uint64_t>(k), NumBits);
+                }
+            }
+        }
+    }
+
+public:
+    template<typename Archive, typename Component>
+    static void read(Archive &archive, Component *components, size_t count) {
+        if constexpr(is_bitpack_archive_v<Archive>) {
+            read_quantized(archive, components, count);
+        } else {
+            raw_network_encoding::read(archive, components, count);
+        }
+    }
+
+private:
+    template<typename Archive, typename Component>
+    static void read_quantized(Archive &archive, Component *components, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            auto largest = static_cast<size_t>(archive.read_bits(2));
+            auto q = quaternion{};
+            auto len_sqr = scalar(0);
+
+            for (size_t j = 0; j < 4; ++j) {
+                if (j != largest) {
+                    auto k = archive.read_bits(NumBits);
+                    q[j] = scalar(k) / scalar(max_value) * (2 * range) - range;
+                    len_sqr += q[j] * q[j];
+                }
+            }
+
+            q[largest] = std::sqrt(std::max(scalar(0), scalar(1) - len_sqr));
+            components[i] = normalize(q);
+        }
+    }
+};
+
+/**
+ * @brief Encodes the convex meshes of polyhedrons, including those inside
+ * compounds, with their id in the global `shape_asset_cache` instead of their
+ * geometry. Meshes that aren't in the cache are inserted when written. The
+ * receiver must have the same meshes in its cache, which is the case if they
+ * were created from the same data, e.g. with
+ * `shape_asset_cache::get_convex_mesh` or by creating rigid bodies with them.
+ * Applies to all archives.
+ */
+struct mesh_id_encoding {
+    template<typename Archive>
+    static void write(Archive &archive, const polyhedron_shape *components, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            write_mesh_id(archive, components[i]);
+        }
+    }
+
+    template<typename Archive>
+    static void read(Archive &archive, polyhedron_shape *components, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            read_mesh_id(archive, components[i]);
+        }
+    }
+
+    template<typename Archive>
+    static void write(Archive &archive, const compound_shape *components, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            auto &compound = components[i];
+            auto num_nodes = static_cast<uint16_t>(compound.nodes.size());
+            EDYN_ASSERT(num_nodes == compound.nodes.size());
+            archive(num_nodes);
+
+            for (auto &node : compound.nodes) {
+                archive(node.position, node.orientation, node.aabb);
+                auto id = static_cast<uint8_t>(node.shape_var.index());
+                archive(id);
+
+                std::visit([&](auto &&shape) {
+                    using ShapeType = std::decay_t<decltype(shape)>;
+
+                    if constexpr(std::is_same_v<ShapeType, polyhedron_shape>) {
+                        write_mesh_id(archive, shape);
+                    } else {
+                        archive(shape);
+                    }
+                }, node.shape_var);
+            }
+        }
+    }
+
+    template<typename Archive>
+    static void read(Archive &archive, compound_shape *components, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            auto &compound = components[i];
+            uint16_t num_nodes {};
+            archive(num_nodes);
+            compound.nodes.resize(num_nodes);
+
+            for (auto &node : compound.nodes) {
+                archive(node.position, node.orientation, node.aabb);
+                uint8_t id {};
+                archive(id);
+                read_node_shape(archive, id, node.shape_var);
+            }
+
+            compound.tree.clear();
+            compound.finish();
+        }
+    }
+
+private:
+    template<typename Archive>
+    static void write_mesh_id(Archive &archive, const polyhedron_shape &shape) {
+        auto id = shape_asset_cache::global().insert(shape.mesh);
+        archive(id);
+    }
+
+    template<typename Archive>
+    static void read_mesh_id(Archive &archive, polyhedron_shape &shape) {
+        auto id = shape_asset_cache::id_type{};
+        archive(id);
+        shape.mesh = shape_asset_cache::global().find_convex_mesh(id);
+        EDYN_ASSERT(shape.mesh, "Convex mesh is not in the shape asset cache.");
+    }
+
+    template<size_t Index = 0, typename Archive>
+    static void read_node_shape(Archive &archive, uint8_t id, compound_shape::shapes_variant_t &var) {
+        if constexpr(Index < std::variant_size_v<compound_shape::shapes_variant_t>) {
+            if (id == Index) {
+                auto shape = std::variant_alternative_t<Index, compound_shape::shapes_variant_t>{};
+
+                if constexpr(std::is_same_v<decltype(shape), polyhedron_shape>) {
+                    read_mesh_id(archive, shape);
+                } else {
+                    archive(shape);
+                }
+
+                var = std::move(shape);
+            } else {
+                read_node_shape<Index + 1>(archive, id, var);
+            }
+        }
+    }
+};
+
+namespace detail {
+    template<typename Component>
+    struct default_network_encoding {
+        using type = raw_network_encoding;
+    };
+
+    template<>
+    struct default_network_encoding<position> {
+        using type = bounded_vector3_encoding<1000>;
+    };
+
+    template<>
+    struct default_network_encoding<orientation> {
+        using type = smallest_three_encoding<>;
+    };
+
+    template<>
+    struct default_network_encoding<linvel> {
+        using type = bounded_vector3_encoding<1000>;
+    };
+
+    template<>
+    struct default_network_encoding<angvel> {
+        using type = bounded_vector3_encoding<1000>;
+    };
+
+    template<>
+    struct default_network_encoding<polyhedron_shape> {
+        using type = mesh_id_encoding;
+    };
+
+    template<>
+    struct default_network_encoding<compound_shape> {
+        using type = mesh_id_encoding;
+    };
+}
+
+/**
+ * @brief Selects the encoding of a networked component in snapshots. With the
+ * bit-packing archives, positions and velocities are quantized to millimeters
+ * and millimeters per second (or milliradians per second) relative to the
+ * bounds of the pool and orientations use the smallest three encoding. With
+ * all archives, polyhedrons and compounds refer to their convex meshes by id
+ * and every other component is serialized as is. Specialize
+ * to choose the encoding of a component, including the built-in ones, e.g.
+ * `template<> struct edyn::network_encoding<edyn::position> { using type =
+ * edyn::raw_network_encoding; };`. Server and clients must agree.
+ */
+template<typename Component>
+struct network_encoding : detail::default_network_encoding<Component> {};
+
+}
+
+#endif // EDYN_NETWORKING_UTIL_NETWORK_ENCODING_HPP
@@ -0,0 +1,74 @@
+#ifndef EDYN_NETWORKING_UTIL_NETWORK_STATS_HPP
+#define EDYN_NETWORKING_UTIL_NETWORK_STATS_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "edyn/networking/util/component_index_type.hpp"
+
+namespace edyn {
+
+namespace packet {
+    struct registry_snapshot;
+}
+
+/**
+ * @brief Counters of the registry snapshots sent and received, accumulated
+ * until reset. Collected while `collect_network_stats` is enabled in the
+ * client or server network settings. Sizes are estimated by serializing into
+ * a memory archive, thus they do not include the overhead of the transport
+ * layer.
+ */
+struct network_stats {
+    struct component_stats {
+        // Number of components sent.
+        uint64_t count {};
+
+        // Serialized size in bytes of the pools containing them.
+        uint64_t bytes {};
+    };
+
+    // Registry snapshots exported and the packets they were split into.
+    uint64_t snapshots_sent {};
+    uint64_t packets_sent {};
+    uint64_t entities_sent {};
+    uint64_t bytes_sent {};
+
+    // Indexed by the component index of each networked component.
+    std::vector<component_stats> components_sent;
+
+    // Entities which were due but were left out of a snapshot because the
+    // bandwidth budget was exhausted. They're sent in later snapshots.
+    uint64_t entities_deferred {};
+
+    // Time in seconds spent exporting, splitting and encoding snapshots.
+    double export_time {};
+
+    // Registry snapshot packets received, and the ones which were discarded
+    // because they contained unknown entities.
+    uint64_t packets_received {};
+    uint64_t entities_received {};
+    uint64_t packets_discarded {};
+
+    // Time in seconds spent decoding and importing received snapshots.
+    double import_time {};
+
+    void reset() {
+        *this = network_stats{};
+    }
+
+    /**
+     * @brief Adds the counters of another instance into this one.
+     */
+    void merge(const network_stats &other);
+
+    /**
+     * @brief Records a registry snapshot packet that's about to be sent.
+     * @return Serialized size of the packet in bytes.
+     */
+    size_t record_sent(packet::registry_snapshot &snap);
+};
+
+}
+
+#endif // EDYN_NETWORKING_UTIL_NETWORK_STATS_HPP
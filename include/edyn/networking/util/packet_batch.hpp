@@ -0,0 +1,97 @@
+#ifndef EDYN_NETWORKING_UTIL_PACKET_BATCH_HPP
+#define EDYN_NETWORKING_UTIL_PACKET_BATCH_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include "edyn/networking/packet/edyn_packet.hpp"
+#include "edyn/serialization/memory_archive.hpp"
+#include "edyn/serialization/std_s11n.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Outbound Edyn packets serialized back to back into reusable buffers,
+ * one for packets which must be sent reliably and another for the rest (see
+ * `should_send_reliably`). Each packet is preceded by its size in bytes. The
+ * buffers keep their capacity after being flushed, thus no allocations occur
+ * once they're large enough.
+ */
+class packet_batch {
+public:
+    using size_type = uint32_t;
+
+    /**
+     * @brief Serializes a packet at the end of the batch.
+     */
+    void insert(const packet::edyn_packet &packet);
+
+    bool empty() const {
+        return m_reliable.empty() && m_unreliable.empty();
+    }
+
+    /**
+     * @brief Invokes `func(const uint8_t *data, size_t size, bool reliable)`
+     * with the contents of each non-empty buffer and clears them.
+     */
+    template<typename Func>
+    void flush(Func func) {
+        if (!m_reliable.empty()) {
+            func(m_reliable.data(), m_reliable.size(), true);
+            m_reliable.clear();
+        }
+
+        if (!m_unreliable.empty()) {
+            func(m_unreliable.data(), m_unreliable.size(), false);
+            m_unreliable.clear();
+        }
+    }
+
+private:
+    std::vector<uint8_t> m_reliable;
+    std::vector<uint8_t> m_unreliable;
+};
+
+/**
+ * @brief Deserializes the packets in the contents of a `packet_batch` and
+ * invokes `func(packet::edyn_packet &)` for each.
+ * @return Whether all packets were read successfully. Reading stops at the
+ * first malformed packet.
+ */
+template<typename Func>
+bool read_packet_batch(const uint8_t *data, size_t size, Func func) {
+    size_t position = 0;
+
+    while (position < size) {
+        packet_batch::size_type packet_size;
+
+        if (size - position < sizeof(packet_size)) {
+            return false;
+        }
+
+        std::memcpy(&packet_size, data + position, sizeof(packet_size));
+        position += sizeof(packet_size);
+
+        if (size - position < packet_size) {
+            return false;
+        }
+
+        auto packet = packet::edyn_packet{};
+        auto archive = memory_input_archive(data + position, packet_size);
+        archive(packet);
+        position += packet_size;
+
+        if (archive.failed()) {
+            return false;
+        }
+
+        func(packet);
+    }
+
+    return true;
+}
+
+}
+
+#endif // EDYN_NETWORKING_UTIL_PACKET_BATCH_HPP
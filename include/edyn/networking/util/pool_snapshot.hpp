@@ -20,17 +20,29 @@ extern std::unique_ptr<pool_snapshot_data>(*g_make_pool_snapshot_data)(component
 template<typename Archive>
 void serialize(Archive &archive, pool_snapshot &pool) {
     archive(pool.component_index);
-    std::vector<uint8_t> data;
 
-    if constexpr(Archive::is_input::value) {
-        archive(data);
-        auto input = memory_input_archive(data.data(), data.size());
-        pool.ptr = (*g_make_pool_snapshot_data)(pool.component_index);
-        pool.ptr->read(input);
+    // Bit-packing archives are passed to the pool directly, which also saves
+    // the size of the intermediate buffer.
+    if constexpr(is_bitpack_archive_v<Archive>) {
+        if constexpr(Archive::is_input::value) {
+            pool.ptr = (*g_make_pool_snapshot_data)(pool.component_index);
+            pool.ptr->read(archive);
+        } else {
+            pool.ptr->write(archive);
+        }
     } else {
-        auto output = memory_output_archive(data);
-        pool.ptr->write(output);
-        archive(data);
+        std::vector<uint8_t> data;
+
+        if constexpr(Archive::is_input::value) {
+            archive(data);
+            auto input = memory_input_archive(data.data(), data.size());
+            pool.ptr = (*g_make_pool_snapshot_data)(pool.component_index);
+            pool.ptr->read(input);
+        } else {
+            auto output = memory_output_archive(data);
+            pool.ptr->write(output);
+            archive(data);
+        }
     }
 }
 
@@ -1,30 +1,51 @@
 #ifndef EDYN_NETWORKING_UTIL_POOL_SNAPSHOT_DATA_HPP
 #define EDYN_NETWORKING_UTIL_POOL_SNAPSHOT_DATA_HPP
 
+#include <limits>
+#include <cstring>
 #include <iterator>
 #include <memory>
 #include <vector>
 #include <utility>
+#include <algorithm>
 #include <entt/entity/fwd.hpp>
 #include "edyn/comp/merge_component.hpp"
 #include "edyn/comp/tag.hpp"
 #include "edyn/replication/map_child_entity.hpp"
 #include "edyn/serialization/std_s11n.hpp"
 #include "edyn/serialization/memory_archive.hpp"
+#include "edyn/serialization/bitpack_archive.hpp"
+#include "edyn/networking/util/network_encoding.hpp"
+#include "edyn/networking/util/snapshot_baseline.hpp"
+#include "edyn/networking/util/component_index_type.hpp"
 #include "edyn/replication/entity_map.hpp"
 #include "edyn/config/config.h"
 
 namespace edyn {
 
+// Upper bound for the number of entities in a registry snapshot.
+inline constexpr size_t max_snapshot_entities = 1 << 20;
+
 struct pool_snapshot_data {
-    // Snapshot is not expected to have more than 256 entities.
-    using index_type = uint8_t;
+    // Indices are serialized with the smallest width among 8, 16 and 32 bits
+    // which fits all values in the pool.
+    using index_type = uint32_t;
     std::vector<index_type> entity_indices;
 
+    // Empty unless some entries are encoded as a delta against a baseline
+    // (see `snapshot_baseline`). For each entry, the number of snapshots since
+    // the baseline, or zero if the entry holds the full value, and a mask with
+    // a bit set for each word of 32 bits of the component which differs from
+    // the baseline. Only the words that differ are serialized.
+    std::vector<uint16_t> baseline_ages;
+    std::vector<uint32_t> delta_masks;
+
     virtual ~pool_snapshot_data() = default;
     virtual void convert_remloc(const entt::registry &registry, const entity_map &emap) = 0;
     virtual void write(memory_output_archive &archive) = 0;
     virtual void read(memory_input_archive &archive) = 0;
+    virtual void write(bitpack_output_archive &archive) = 0;
+    virtual void read(bitpack_input_archive &archive) = 0;
 
     virtual void replace_into_registry(entt::registry &registry,
                                        const std::vector<entt::entity> &entities,
@@ -33,16 +54,56 @@ struct pool_snapshot_data {
     virtual void replace_into_registry(entt::registry &registry,
                                        const std::vector<entt::entity> &entities) = 0;
 
+    // Appends the entry at `position` in another pool of the same type
+    // referring to the entity at `entity_index` in the destination snapshot.
+    virtual void append(const pool_snapshot_data &other, size_t position, index_type entity_index) = 0;
+
+    // Records the value of all entries in the snapshot with the given id.
+    virtual void record_baseline(snapshot_baseline &baseline, snapshot_baseline::id_type id,
+                                 const std::vector<entt::entity> &pool_entities,
+                                 component_index_type component_index) const = 0;
+
+    // Encodes entries as a delta against their last acknowledged value and
+    // removes the entries which are equal to it.
+    virtual void encode_deltas(const snapshot_baseline &baseline, snapshot_baseline::id_type id,
+                               const std::vector<entt::entity> &pool_entities,
+                               component_index_type component_index) = 0;
+
+    // Restores the full value of delta-encoded entries and removes the ones
+    // whose baseline is not available, in which case false is returned.
+    virtual bool decode_deltas(const snapshot_baseline &baseline, snapshot_baseline::id_type id,
+                               const std::vector<entt::entity> &pool_entities,
+                               component_index_type component_index) = 0;
+
     virtual entt::id_type get_type_id() const = 0;
 
     bool empty() const {
         return entity_indices.empty();
     }
+
+protected:
+    static index_type find_or_push_entity(std::vector<entt::entity> &pool_entities, entt::entity entity) {
+        // Search backwards since the entity is usually the last one inserted
+        // because exporters insert all components of an entity in sequence.
+        auto found_it = std::find(pool_entities.rbegin(), pool_entities.rend(), entity);
+
+        if (found_it != pool_entities.rend()) {
+            return static_cast<index_type>(std::distance(found_it, pool_entities.rend()) - 1);
+        }
+
+        EDYN_ASSERT(pool_entities.size() < max_snapshot_entities);
+        pool_entities.push_back(entity);
+        return static_cast<index_type>(pool_entities.size() - 1);
+    }
 };
 
 template<typename Component>
 struct pool_snapshot_data_impl : public pool_snapshot_data {
     static constexpr auto is_empty_type = std::is_empty_v<Component>;
+    static constexpr auto is_delta_encodable = !is_empty_type &&
+        std::is_trivially_copyable_v<Component> &&
+        sizeof(Component) <= snapshot_baseline::max_words * sizeof(uint32_t);
+    static constexpr size_t num_words = (sizeof(Component) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
     std::vector<Component> components;
 
     void convert_remloc(const entt::registry &registry, const entity_map &emap) override {
@@ -54,37 +115,280 @@ struct pool_snapshot_data_impl : public pool_snapshot_data {
         }
     }
 
-    void write(memory_output_archive &archive) override {
-        index_type num_entities = static_cast<index_type>(entity_indices.size());
-        archive(num_entities);
+    static uint32_t get_word(const uint8_t *data, size_t index) {
+        auto word = uint32_t{};
+        auto offset = index * sizeof(uint32_t);
+        std::memcpy(&word, data + offset, std::min(sizeof(uint32_t), sizeof(Component) - offset));
+        return word;
+    }
+
+    static void set_word(uint8_t *data, size_t index, uint32_t word) {
+        auto offset = index * sizeof(uint32_t);
+        std::memcpy(data + offset, &word, std::min(sizeof(uint32_t), sizeof(Component) - offset));
+    }
+
+    // Removes all entries where `keep` is false while preserving order.
+    void erase_entries(const std::vector<bool> &keep) {
+        size_t count = 0;
+
+        for (size_t i = 0; i < entity_indices.size(); ++i) {
+            if (!keep[i]) {
+                continue;
+            }
+
+            entity_indices[count] = entity_indices[i];
 
-        for (auto &idx : entity_indices) {
-            archive(idx);
+            if constexpr(!is_empty_type) {
+                components[count] = components[i];
+            }
+
+            if (!baseline_ages.empty()) {
+                baseline_ages[count] = baseline_ages[i];
+                delta_masks[count] = delta_masks[i];
+            }
+
+            ++count;
         }
 
+        entity_indices.resize(count);
+
         if constexpr(!is_empty_type) {
-            for (auto &comp : components) {
-                archive(comp);
+            components.resize(count);
+        }
+
+        if (!baseline_ages.empty()) {
+            baseline_ages.resize(count);
+            delta_masks.resize(count);
+        }
+    }
+
+    template<typename Archive>
+    void write_word(Archive &archive, uint32_t word) {
+        // Words are arbitrary bit patterns, which aren't suited for varints.
+        if constexpr(is_bitpack_archive_v<Archive>) {
+            archive.write_bits(word, 32);
+        } else {
+            archive(word);
+        }
+    }
+
+    template<typename Archive>
+    uint32_t read_word(Archive &archive) {
+        if constexpr(is_bitpack_archive_v<Archive>) {
+            return static_cast<uint32_t>(archive.read_bits(32));
+        } else {
+            auto word = uint32_t{};
+            archive(word);
+            return word;
+        }
+    }
+
+    // Entries holding the full value are written first, in bulk, followed by
+    // the words that changed in the delta-encoded entries.
+    template<typename Archive>
+    void write_deltas(Archive &archive) {
+        EDYN_ASSERT(baseline_ages.size() == entity_indices.size());
+        EDYN_ASSERT(delta_masks.size() == entity_indices.size());
+        auto full_components = std::vector<Component>{};
+
+        for (size_t i = 0; i < baseline_ages.size(); ++i) {
+            archive(baseline_ages[i]);
+
+            if (baseline_ages[i] == 0) {
+                full_components.push_back(components[i]);
+            } else {
+                archive(delta_masks[i]);
+            }
+        }
+
+        using encoding_type = typename network_encoding<Component>::type;
+        encoding_type::write(archive, full_components.data(), full_components.size());
+
+        for (size_t i = 0; i < baseline_ages.size(); ++i) {
+            if (baseline_ages[i] == 0) {
+                continue;
+            }
+
+            auto *data = reinterpret_cast<const uint8_t *>(&components[i]);
+
+            for (size_t j = 0; j < num_words; ++j) {
+                if (delta_masks[i] & (uint32_t(1) << j)) {
+                    write_word(archive, get_word(data, j));
+                }
             }
         }
     }
 
-    void read(memory_input_archive &archive) override {
-        index_type num_entities;
+    template<typename Archive>
+    void read_deltas(Archive &archive) {
+        const auto num_entries = entity_indices.size();
+        baseline_ages.resize(num_entries);
+        delta_masks.assign(num_entries, 0);
+        size_t num_full = 0;
+
+        for (size_t i = 0; i < num_entries; ++i) {
+            archive(baseline_ages[i]);
+
+            if (baseline_ages[i] == 0) {
+                ++num_full;
+            } else {
+                archive(delta_masks[i]);
+            }
+        }
+
+        auto full_components = std::vector<Component>(num_full);
+        using encoding_type = typename network_encoding<Component>::type;
+        encoding_type::read(archive, full_components.data(), full_components.size());
+
+        for (size_t i = 0, k = 0; i < num_entries; ++i) {
+            if (baseline_ages[i] == 0) {
+                components[i] = full_components[k++];
+                continue;
+            }
+
+            auto *data = reinterpret_cast<uint8_t *>(&components[i]);
+
+            for (size_t j = 0; j < num_words; ++j) {
+                if (delta_masks[i] & (uint32_t(1) << j)) {
+                    set_word(data, j, read_word(archive));
+                }
+            }
+        }
+    }
+
+    template<typename T, typename Archive>
+    void write_indices(Archive &archive) {
+        T num_entities = static_cast<T>(entity_indices.size());
         archive(num_entities);
+
+        if constexpr(std::is_same_v<T, index_type>) {
+            archive.write_array(entity_indices.data(), entity_indices.size());
+        } else {
+            auto indices = std::vector<T>(entity_indices.begin(), entity_indices.end());
+            archive.write_array(indices.data(), indices.size());
+        }
+    }
+
+    template<typename T, typename Archive>
+    void read_indices(Archive &archive) {
+        T num_entities {};
+        archive(num_entities);
+
+        // Indices refer to the entities in the snapshot, which cannot be more
+        // than this. Protects against allocating huge amounts of memory when
+        // reading invalid data.
+        if (num_entities > max_snapshot_entities) {
+            entity_indices.clear();
+            return;
+        }
+
         entity_indices.resize(num_entities);
 
-        for (auto &idx : entity_indices) {
-            archive(idx);
+        if constexpr(std::is_same_v<T, index_type>) {
+            archive.read_array(entity_indices.data(), entity_indices.size());
+        } else {
+            auto indices = std::vector<T>(num_entities);
+            archive.read_array(indices.data(), indices.size());
+            std::copy(indices.begin(), indices.end(), entity_indices.begin());
+        }
+    }
+
+    template<typename Archive>
+    void write_data(Archive &archive) {
+        // The width must also fit the number of entities.
+        size_t max_value = entity_indices.size();
+
+        for (auto idx : entity_indices) {
+            max_value = std::max(max_value, size_t(idx));
+        }
+
+        uint8_t index_size = max_value <= std::numeric_limits<uint8_t>::max() ? sizeof(uint8_t) :
+                             max_value <= std::numeric_limits<uint16_t>::max() ? sizeof(uint16_t) :
+                             sizeof(uint32_t);
+        archive(index_size);
+
+        switch (index_size) {
+        case sizeof(uint8_t):
+            write_indices<uint8_t>(archive);
+            break;
+        case sizeof(uint16_t):
+            write_indices<uint16_t>(archive);
+            break;
+        default:
+            write_indices<uint32_t>(archive);
+        }
+
+        if constexpr(is_delta_encodable) {
+            uint8_t has_deltas = !baseline_ages.empty();
+            archive(has_deltas);
+
+            if (has_deltas) {
+                write_deltas(archive);
+                return;
+            }
         }
 
         if constexpr(!is_empty_type) {
-            components.resize(num_entities);
+            using encoding_type = typename network_encoding<Component>::type;
+            encoding_type::write(archive, components.data(), components.size());
+        }
+    }
 
-            for (auto &comp : components) {
-                archive(comp);
+    template<typename Archive>
+    void read_data(Archive &archive) {
+        uint8_t index_size {};
+        archive(index_size);
+
+        switch (index_size) {
+        case sizeof(uint8_t):
+            read_indices<uint8_t>(archive);
+            break;
+        case sizeof(uint16_t):
+            read_indices<uint16_t>(archive);
+            break;
+        case sizeof(uint32_t):
+            read_indices<uint32_t>(archive);
+            break;
+        default:
+            // Invalid data.
+            entity_indices.clear();
+            return;
+        }
+
+        if constexpr(!is_empty_type) {
+            components.resize(entity_indices.size());
+        }
+
+        if constexpr(is_delta_encodable) {
+            uint8_t has_deltas {};
+            archive(has_deltas);
+
+            if (has_deltas) {
+                read_deltas(archive);
+                return;
             }
         }
+
+        if constexpr(!is_empty_type) {
+            using encoding_type = typename network_encoding<Component>::type;
+            encoding_type::read(archive, components.data(), components.size());
+        }
+    }
+
+    void write(memory_output_archive &archive) override {
+        write_data(archive);
+    }
+
+    void read(memory_input_archive &archive) override {
+        read_data(archive);
+    }
+
+    void write(bitpack_output_archive &archive) override {
+        write_data(archive);
+    }
+
+    void read(bitpack_input_archive &archive) override {
+        read_data(archive);
     }
 
     void replace_into_registry(entt::registry &registry,
@@ -95,6 +399,11 @@ struct pool_snapshot_data_impl : public pool_snapshot_data {
 
             for (size_t i = 0; i < entity_indices.size(); ++i) {
                 auto entity_index = entity_indices[i];
+
+                if (entity_index >= pool_entities.size()) {
+                    continue;
+                }
+
                 auto remote_entity = pool_entities[entity_index];
 
                 if (emap.contains(remote_entity)) {
@@ -119,6 +428,11 @@ struct pool_snapshot_data_impl : public pool_snapshot_data {
 
             for (size_t i = 0; i < entity_indices.size(); ++i) {
                 auto entity_index = entity_indices[i];
+
+                if (entity_index >= pool_entities.size()) {
+                    continue;
+                }
+
                 auto entity = pool_entities[entity_index];
 
                 if (registry.valid(entity) && registry.all_of<Component>(entity)) {
@@ -135,15 +449,7 @@ struct pool_snapshot_data_impl : public pool_snapshot_data {
                        std::vector<entt::entity> &pool_entities) {
         EDYN_ASSERT((registry.all_of<networked_tag, Component>(entity)));
 
-        auto found_it = std::find(pool_entities.begin(), pool_entities.end(), entity);
-        index_type idx;
-
-        if (found_it != pool_entities.end()) {
-            idx = std::distance(pool_entities.begin(), found_it);
-        } else {
-            idx = pool_entities.size();
-            pool_entities.push_back(entity);
-        }
+        auto idx = find_or_push_entity(pool_entities, entity);
 
         entity_indices.push_back(idx);
 
@@ -162,15 +468,7 @@ struct pool_snapshot_data_impl : public pool_snapshot_data {
             auto entity = *first;
             EDYN_ASSERT((registry.all_of<networked_tag, Component>(entity)));
 
-            auto found_it = std::find(pool_entities.begin(), pool_entities.end(), entity);
-            index_type idx;
-
-            if (found_it != pool_entities.end()) {
-                idx = std::distance(pool_entities.begin(), found_it);
-            } else {
-                idx = pool_entities.size();
-                pool_entities.push_back(entity);
-            }
+            auto idx = find_or_push_entity(pool_entities, entity);
 
             entity_indices.push_back(idx);
 
@@ -181,6 +479,144 @@ struct pool_snapshot_data_impl : public pool_snapshot_data {
         }
     }
 
+    // Inserts the entry at `position` in another pool of the same type, for
+    // an entity which is added to `pool_entities` if it's not there yet.
+    void insert_from(const pool_snapshot_data_impl<Component> &other, size_t position,
+                     entt::entity entity, std::vector<entt::entity> &pool_entities) {
+        append(other, position, find_or_push_entity(pool_entities, entity));
+    }
+
+    void append(const pool_snapshot_data &other, size_t position, index_type entity_index) override {
+        auto &typed_other = static_cast<const pool_snapshot_data_impl<Component> &>(other);
+        EDYN_ASSERT(typed_other.get_type_id() == get_type_id());
+        EDYN_ASSERT(typed_other.baseline_ages.empty());
+        entity_indices.push_back(entity_index);
+
+        if constexpr(!is_empty_type) {
+            components.push_back(typed_other.components[position]);
+        }
+    }
+
+    void record_baseline(snapshot_baseline &baseline, snapshot_baseline::id_type id,
+                         const std::vector<entt::entity> &pool_entities,
+                         component_index_type component_index) const override {
+        if constexpr(is_delta_encodable) {
+            for (size_t i = 0; i < entity_indices.size(); ++i) {
+                auto entity = pool_entities[entity_indices[i]];
+                baseline.insert(id, entity, component_index, &components[i], sizeof(Component));
+            }
+        }
+    }
+
+    void encode_deltas(const snapshot_baseline &baseline, snapshot_baseline::id_type id,
+                       const std::vector<entt::entity> &pool_entities,
+                       component_index_type component_index) override {
+        if constexpr(is_delta_encodable) {
+            const auto num_entries = entity_indices.size();
+            baseline_ages.assign(num_entries, 0);
+            delta_masks.assign(num_entries, 0);
+            auto keep = std::vector<bool>(num_entries, true);
+            auto has_deltas = false;
+            auto has_unchanged = false;
+
+            for (size_t i = 0; i < num_entries; ++i) {
+                auto entity = pool_entities[entity_indices[i]];
+                auto baseline_id = baseline.find_acknowledged(entity, component_index);
+
+                if (baseline_id == snapshot_baseline::null_id || baseline_id >= id ||
+                    id - baseline_id > snapshot_baseline::max_age) {
+                    continue;
+                }
+
+                auto *baseline_data = baseline.find(baseline_id, entity, component_index);
+
+                if (baseline_data == nullptr) {
+                    continue;
+                }
+
+                auto *data = reinterpret_cast<const uint8_t *>(&components[i]);
+                auto mask = uint32_t{};
+                auto num_changed = size_t{};
+
+                for (size_t j = 0; j < num_words; ++j) {
+                    if (get_word(data, j) != get_word(baseline_data, j)) {
+                        mask |= uint32_t(1) << j;
+                        ++num_changed;
+                    }
+                }
+
+                if (mask == 0) {
+                    keep[i] = false;
+                    has_unchanged = true;
+                } else if (num_changed * 2 <= num_words) {
+                    // Only use a delta if at most half of the words changed
+                    // since the full value is possibly quantized into fewer
+                    // bits than the raw words.
+                    baseline_ages[i] = static_cast<uint16_t>(id - baseline_id);
+                    delta_masks[i] = mask;
+                    has_deltas = true;
+                }
+            }
+
+            if (!has_deltas) {
+                baseline_ages.clear();
+                delta_masks.clear();
+            }
+
+            if (has_unchanged) {
+                erase_entries(keep);
+            }
+        }
+    }
+
+    bool decode_deltas(const snapshot_baseline &baseline, snapshot_baseline::id_type id,
+                       const std::vector<entt::entity> &pool_entities,
+                       component_index_type component_index) override {
+        if (baseline_ages.empty()) {
+            return true;
+        }
+
+        auto keep = std::vector<bool>(entity_indices.size(), true);
+        auto success = true;
+
+        for (size_t i = 0; i < entity_indices.size(); ++i) {
+            auto age = baseline_ages[i];
+
+            if (age == 0) {
+                continue;
+            }
+
+            if constexpr(is_delta_encodable) {
+                auto entity_index = entity_indices[i];
+                auto *baseline_data = age < id && entity_index < pool_entities.size() ?
+                    baseline.find(id - age, pool_entities[entity_index], component_index) : nullptr;
+
+                if (baseline_data == nullptr) {
+                    keep[i] = false;
+                    success = false;
+                    continue;
+                }
+
+                auto *data = reinterpret_cast<uint8_t *>(&components[i]);
+
+                for (size_t j = 0; j < num_words; ++j) {
+                    if (!(delta_masks[i] & (uint32_t(1) << j))) {
+                        set_word(data, j, get_word(baseline_data, j));
+                    }
+                }
+            } else {
+                keep[i] = false;
+                success = false;
+            }
+        }
+
+        baseline_ages.clear();
+        delta_masks.clear();
+        erase_entries(keep);
+
+        return success;
+    }
+
     entt::id_type get_type_id() const override {
         return entt::type_index<Component>::value();
     }
@@ -0,0 +1,45 @@
+#ifndef EDYN_NETWORKING_UTIL_RECONCILE_POOL_SNAPSHOT_HPP
+#define EDYN_NETWORKING_UTIL_RECONCILE_POOL_SNAPSHOT_HPP
+
+#include <vector>
+#include <entt/entity/fwd.hpp>
+
+namespace edyn {
+
+struct pool_snapshot;
+struct client_network_settings;
+class entity_map;
+
+/**
+ * @brief Removes the transforms and velocities of the entities in a registry
+ * snapshot whose local position, orientation, linear and angular velocity
+ * all match the received values within the reconciliation tolerances in the
+ * client settings, since snapping them would only wake up their islands.
+ * Entities with a mismatch keep all their entries.
+ * @param registry Registry where the snapshot is going to be applied.
+ * @param emap Maps the entities of the snapshot into `registry`.
+ * @param entities Entities of the snapshot.
+ * @param pools Pools of the snapshot.
+ * @param settings Client settings holding the tolerances.
+ * @param corrected Filled with the entities of the snapshot which still have
+ * entries in any pool, i.e. the ones whose islands must be woken up.
+ */
+void reconcile_pool_snapshot(const entt::registry &registry, const entity_map &emap,
+                             const std::vector<entt::entity> &entities,
+                             std::vector<pool_snapshot> &pools,
+                             const client_network_settings &settings,
+                             std::vector<entt::entity> &corrected);
+
+/**
+ * @brief Same as above, for snapshots whose entities are already in the
+ * space of `registry`.
+ */
+void reconcile_pool_snapshot(const entt::registry &registry,
+                             const std::vector<entt::entity> &entities,
+                             std::vector<pool_snapshot> &pools,
+                             const client_network_settings &settings,
+                             std::vector<entt::entity> &corrected);
+
+}
+
+#endif // EDYN_NETWORKING_UTIL_RECONCILE_POOL_SNAPSHOT_HPP
@@ -3,10 +3,14 @@
 
 #include <entt/entity/registry.hpp>
 #include <entt/signal/sigh.hpp>
+#include <array>
+#include <algorithm>
+#include <limits>
 #include <numeric>
 #include <type_traits>
 #include <vector>
 #include <utility>
+#include <unordered_map>
 #include "edyn/comp/action_list.hpp"
 #include "edyn/comp/angvel.hpp"
 #include "edyn/comp/child_list.hpp"
@@ -39,6 +43,9 @@ public:
     virtual void export_all(packet::registry_snapshot &snap, const std::vector<entt::entity> &entities) const = 0;
 
     // Write all components that have been recently modified into a snapshot.
+    // Entities which are not due in the destination client are skipped and
+    // the others are inserted in order of their accumulated priority (see
+    // `remote_client::entity_states`).
     virtual void export_modified(packet::registry_snapshot &snap,
                                  const entt::sparse_set &entities_of_interest,
                                  entt::entity dest_client_entity) const = 0;
@@ -46,10 +53,45 @@ public:
     virtual void export_comp_index(packet::registry_snapshot &snap, entt::entity entity,
                                    const std::vector<component_index_type> &indices) const = 0;
 
+    // Copies the recently modified components of the given entities and of
+    // their children into a cache, which `export_modified` takes them from
+    // instead of the registry until the cache is cleared. This way each
+    // component is read once per update instead of once per client when
+    // many clients are interested in the same entities. Must not be called
+    // concurrently with `export_modified`.
+    virtual void cache_modified(const entt::sparse_set &entities) = 0;
+    virtual void clear_cache() = 0;
+
     // Decays the time remaining in each of the recently modified components.
     // They stop being included in the snapshot once the timer reaches zero.
     virtual void update(double time) = 0;
 
+    // Whether the transforms and velocities of sleeping entities stop being
+    // considered modified in `update`, since their resting state is sent in
+    // a `packet::island_slept` instead.
+    void set_exclude_sleeping(bool exclude) {
+        m_exclude_sleeping = exclude;
+    }
+
+    // Writes the transforms and velocities of the given entities into a
+    // snapshot, which is the state at which sleeping entities rest.
+    void export_rest_state(packet::registry_snapshot &snap, const std::vector<entt::entity> &entities) const;
+
+    /**
+     * @brief Splits a snapshot into multiple snapshots with the same timestamp
+     * whose estimated size when serialized is at most `max_size` bytes, such
+     * as the MTU of the connection minus the size of the transport headers.
+     * Entities are distributed in the order they appear in the source
+     * snapshot, thus the first snapshots contain the entities with the highest
+     * priority. All components of an entity are kept in the same snapshot.
+     * An entity which does not fit alone gets a snapshot of its own.
+     * @param snap Source snapshot.
+     * @param max_size Maximum size of each snapshot in bytes.
+     * @param result Receives the new snapshots, which are appended.
+     */
+    void split(const packet::registry_snapshot &snap, size_t max_size,
+               std::vector<packet::registry_snapshot> &result) const;
+
     template<typename Component>
     component_index_type get_component_index() const {
         auto id = entt::type_index<Component>();
@@ -58,6 +100,7 @@ public:
 
 protected:
     std::map<entt::id_type, component_index_type> m_component_indices;
+    bool m_exclude_sleeping {false};
 };
 
 template<typename... Components>
@@ -70,6 +113,11 @@ class server_snapshot_exporter_impl : public server_snapshot_exporter {
         (modified.bump_index(index_of_v<unsigned, Cs, Components...>), ...);
     }
 
+    template<typename... Cs>
+    void erase_component(modified_components &modified) const {
+        (modified.erase_index(index_of_v<unsigned, Cs, Components...>), ...);
+    }
+
     template<typename Component>
     void on_update(entt::registry &registry, entt::entity entity) {
         auto modified_view = registry.view<modified_components>();
@@ -92,6 +140,24 @@ class server_snapshot_exporter_impl : public server_snapshot_exporter {
                                 packet::registry_snapshot &snap) const {
         static const auto components_tuple = std::tuple<Components...>{};
 
+        if (auto it = m_cache_entries.find(entity); it != m_cache_entries.end()) {
+            for (auto [comp_index, position] : it->second) {
+                visit_tuple(components_tuple, comp_index, [&](auto &&c) {
+                    using CompType = std::decay_t<decltype(c)>;
+                    constexpr auto is_input = std::is_base_of_v<network_input, CompType>;
+                    constexpr auto is_action = std::is_same_v<CompType, action_history>;
+
+                    if (!(is_action && owned_by_destination) && !(is_input && owned_by_destination)) {
+                        using pool_snapshot_data_t = pool_snapshot_data_impl<CompType>;
+                        auto &cache_pool = static_cast<const pool_snapshot_data_t &>(*m_cache.pools[m_cache_pool_indices[comp_index]].ptr);
+                        internal::get_pool<CompType>(snap.pools, comp_index)->insert_from(cache_pool, position, entity, snap.entities);
+                    }
+                });
+            }
+
+            return;
+        }
+
         for (unsigned i = 0; i < modified.count; ++i) {
             auto comp_index = modified.entry[i].index;
             visit_tuple(components_tuple, comp_index, [&](auto &&c) {
@@ -108,6 +174,19 @@ class server_snapshot_exporter_impl : public server_snapshot_exporter {
         }
     }
 
+    template<typename Component>
+    pool_snapshot_data_impl<Component> * get_cache_pool(component_index_type comp_index) {
+        auto &pool_index = m_cache_pool_indices[comp_index];
+
+        if (pool_index == null_pool_index) {
+            pool_index = m_cache.pools.size();
+            auto &pool = m_cache.pools.emplace_back(pool_snapshot{comp_index});
+            pool.ptr.reset(new pool_snapshot_data_impl<Component>);
+        }
+
+        return static_cast<pool_snapshot_data_impl<Component> *>(m_cache.pools[pool_index].ptr.get());
+    }
+
     template<typename Component, typename It>
     void export_single(packet::registry_snapshot &snap, It first, It last, size_t index) const {
         constexpr auto is_action = std::is_same_v<Component, action_history>;
@@ -139,6 +218,8 @@ public:
 
         auto i = component_index_type{};
         (m_component_indices.emplace(entt::type_index<Components>(), i++), ...);
+
+        m_cache_pool_indices.fill(null_pool_index);
     }
 
     template<typename It>
@@ -167,7 +248,13 @@ public:
         auto parent_view = registry.view<parent_comp>();
         auto child_view = registry.view<child_list>();
 
-        bool allow_ownership = registry.get<remote_client>(dest_client_entity).allow_full_ownership;
+        auto &dest_client = registry.get<remote_client>(dest_client_entity);
+        bool allow_ownership = dest_client.allow_full_ownership;
+
+        // Entities are sorted by priority before being exported so that the
+        // most relevant ones come first in the snapshot, which is what goes
+        // in the first packet if the snapshot is split.
+        auto export_queue = std::vector<std::pair<scalar, entt::entity>>{};
 
         // Do not include input components of entities owned by destination
         // client as to not override client input on the client-side.
@@ -188,6 +275,18 @@ public:
                 continue;
             }
 
+            // Skip entities sent recently according to their rate.
+            auto state_it = dest_client.entity_states.find(entity);
+            auto priority = scalar(0);
+
+            if (state_it != dest_client.entity_states.end()) {
+                if (!state_it->second.due) {
+                    continue;
+                }
+
+                priority = state_it->second.priority;
+            }
+
             // Traverse entity graph using this entity as the starting point and
             // collect all owners (i.e. clients) that are reachable from this node.
             // If the only reachable client is the destination client, do not
@@ -235,13 +334,22 @@ public:
                 continue;
             }
 
+            export_queue.emplace_back(priority, entity);
+        }
+
+        std::stable_sort(export_queue.begin(), export_queue.end(), [](auto &lhs, auto &rhs) {
+            return lhs.first > rhs.first;
+        });
+
+        for (auto [priority, entity] : export_queue) {
+            auto [modified] = modified_view.get(entity);
             const auto owned_by_destination =
                 owner_view.contains(entity) &&
                 std::get<0>(owner_view.get(entity)).client_entity == dest_client_entity;
             export_modified_entity(registry, entity, modified, owned_by_destination, snap);
 
             // Include child entities
-            if (is_parent) {
+            if (parent_view.contains(entity)) {
                 auto [parent] = parent_view.get(entity);
                 auto child_entity = parent.child;
 
@@ -274,6 +382,62 @@ public:
         }
     }
 
+    void cache_modified(const entt::sparse_set &entities) override {
+        static const auto components_tuple = std::tuple<Components...>{};
+        clear_cache();
+
+        auto &registry = *m_registry;
+        auto modified_view = registry.view<const modified_components>();
+        auto parent_view = registry.view<parent_comp>();
+        auto child_view = registry.view<child_list>();
+
+        auto cache_entity = [&](entt::entity entity) {
+            if (!modified_view.contains(entity) || m_cache_entries.count(entity)) {
+                return;
+            }
+
+            auto [modified] = modified_view.get(entity);
+            auto &entries = m_cache_entries[entity];
+
+            for (unsigned i = 0; i < modified.count; ++i) {
+                auto comp_index = modified.entry[i].index;
+
+                visit_tuple(components_tuple, comp_index, [&](auto &&c) {
+                    using CompType = std::decay_t<decltype(c)>;
+                    auto *pool = get_cache_pool<CompType>(comp_index);
+                    pool->insert_single(registry, entity, m_cache.entities);
+                    entries.emplace_back(comp_index, pool->entity_indices.size() - 1);
+                });
+            }
+        };
+
+        for (auto entity : entities) {
+            if (!registry.valid(entity)) {
+                continue;
+            }
+
+            cache_entity(entity);
+
+            if (parent_view.contains(entity)) {
+                auto [parent] = parent_view.get(entity);
+                auto child_entity = parent.child;
+
+                while (child_entity != entt::null) {
+                    cache_entity(child_entity);
+                    auto [child] = child_view.get(child_entity);
+                    child_entity = child.next;
+                }
+            }
+        }
+    }
+
+    void clear_cache() override {
+        m_cache.entities.clear();
+        m_cache.pools.clear();
+        m_cache_entries.clear();
+        m_cache_pool_indices.fill(null_pool_index);
+    }
+
     void update(double time) override {
         EDYN_ASSERT(!(time < m_last_time));
         auto elapsed_ms = static_cast<unsigned>((time - m_last_time) * 1000u);
@@ -281,6 +445,7 @@ public:
 
         auto modified_view = m_registry->view<modified_components>();
         auto dynamic_view = m_registry->view<dynamic_tag>(exclude_sleeping_disabled);
+        auto sleeping_view = m_registry->view<sleeping_tag>();
 
         for (auto [entity, modified] : modified_view.each()) {
             modified.decay(elapsed_ms);
@@ -291,6 +456,8 @@ public:
             // signals every time.
             if (dynamic_view.contains(entity)) {
                 bump_component<position, orientation, linvel, angvel>(modified);
+            } else if (m_exclude_sleeping && sleeping_view.contains(entity)) {
+                erase_component<position, orientation, linvel, angvel>(modified);
             }
         }
     }
@@ -299,6 +466,13 @@ private:
     entt::registry *m_registry;
     std::vector<entt::scoped_connection> m_connections;
     double m_last_time {};
+
+    // Modified components shared by all exports in an update. For each
+    // entity, the index and position of its components in the pools.
+    static constexpr auto null_pool_index = std::numeric_limits<size_t>::max();
+    packet::registry_snapshot m_cache;
+    std::array<size_t, sizeof...(Components)> m_cache_pool_indices;
+    std::unordered_map<entt::entity, std::vector<std::pair<component_index_type, size_t>>> m_cache_entries;
 };
 
 }
@@ -2,6 +2,7 @@
 #define EDYN_NETWORKING_UTIL_SERVER_SNAPSHOT_IMPORTER_HPP
 
 #include <entt/entity/registry.hpp>
+#include <optional>
 #include <type_traits>
 #include "edyn/comp/action_list.hpp"
 #include "edyn/comp/child_list.hpp"
@@ -14,6 +15,7 @@
 #include "edyn/networking/comp/remote_client.hpp"
 #include "edyn/networking/comp/entity_owner.hpp"
 #include "edyn/networking/packet/registry_snapshot.hpp"
+#include "edyn/networking/util/action_queue.hpp"
 #include "edyn/networking/util/pool_snapshot.hpp"
 #include "edyn/replication/map_child_entity.hpp"
 #include "edyn/serialization/memory_archive.hpp"
@@ -36,22 +38,25 @@ public:
                                     packet::registry_snapshot &snap, bool check_ownership) = 0;
 
     // Merge all action_history components in the snapshot with corresponding
-    // components in the registry.
-    virtual void merge_action_history(entt::registry &registry, packet::registry_snapshot &snap,
-                                      double time_delta) = 0;
+    // components in the registry and push the merged actions into the queue,
+    // to be executed after the playout delay. Returns the latest timestamp of
+    // the actions in the snapshot in the client's time, if any.
+    virtual std::optional<double> merge_action_history(entt::registry &registry, entt::entity client_entity,
+                                                       packet::registry_snapshot &snap, double time_delta,
+                                                       double playout_delay, action_queue &queue) = 0;
 
     void import_action(entt::registry &registry, entt::entity entity,
                        action_history::action_index_type action_index,
-                       const std::vector<uint8_t> &data) {
+                       const uint8_t *data, size_t size) {
         if (m_import_action_func) {
-            (*m_import_action_func)(registry, entity, action_index, data);
+            (*m_import_action_func)(registry, entity, action_index, data, size);
         }
     }
 
 protected:
     using import_action_func_t = void(entt::registry &, entt::entity,
                                       action_history::action_index_type,
-                                      const std::vector<uint8_t> &);
+                                      const uint8_t *, size_t);
     import_action_func_t *m_import_action_func {nullptr};
 };
 
@@ -232,10 +237,10 @@ class server_snapshot_importer_impl : public server_snapshot_importer {
 
     template<typename Action>
     static void import_action_single(entt::registry &registry, entt::entity entity,
-                                     const std::vector<uint8_t> &data) {
+                                     const uint8_t *data, size_t size) {
         using ActionListType = action_list<Action>;
         ActionListType import_list;
-        auto archive = memory_input_archive(data.data(), data.size());
+        auto archive = memory_input_archive(data, size);
         archive(import_list);
 
         if (archive.failed()) {
@@ -254,15 +259,15 @@ class server_snapshot_importer_impl : public server_snapshot_importer {
     template<typename... Actions>
     static auto import_action(entt::registry &registry, entt::entity entity,
                               action_history::action_index_type action_index,
-                              const std::vector<uint8_t> &data) {
+                              const uint8_t *data, size_t size) {
         static_assert(sizeof...(Actions) > 0);
         if constexpr(sizeof...(Actions) == 1) {
-            (import_action_single<Actions>(registry, entity, data), ...);
+            (import_action_single<Actions>(registry, entity, data, size), ...);
         } else {
             static const auto actions = std::tuple<Actions...>{};
             visit_tuple(actions, action_index, [&](auto &&a) {
                 using ActionType = std::decay_t<decltype(a)>;
-                import_action_single<ActionType>(registry, entity, data);
+                import_action_single<ActionType>(registry, entity, data, size);
             });
         }
     }
@@ -315,16 +320,20 @@ public:
         }
     }
 
-    void merge_action_history(entt::registry &registry, packet::registry_snapshot &snap, double time_delta) override {
+    std::optional<double> merge_action_history(entt::registry &registry, entt::entity client_entity,
+                                               packet::registry_snapshot &snap, double time_delta,
+                                               double playout_delay, action_queue &queue) override {
         auto pool_it = std::find_if(snap.pools.begin(), snap.pools.end(), [](auto &&pool) {
             auto action_history_index = index_of_v<component_index_type, action_history, Components...>;
             return pool.component_index == action_history_index;
         });
 
         if (pool_it == snap.pools.end()) {
-            return;
+            return {};
         }
 
+        auto latest_timestamp = std::optional<double>{};
+
         auto *history_pool = static_cast<pool_snapshot_data_impl<action_history> *>(pool_it->ptr.get());
 
         for (size_t i = 0; i < history_pool->components.size(); ++i) {
@@ -338,17 +347,28 @@ public:
 
             history.sort();
 
+            if (!latest_timestamp || history.entries.back().timestamp > *latest_timestamp) {
+                latest_timestamp = history.entries.back().timestamp;
+            }
+
             for (auto &entry : history.entries) {
                 entry.timestamp += time_delta;
             }
 
             registry.patch<action_history>(entity, [&](action_history &current) {
-                current.merge(history);
+                auto count = current.merge(history);
+
+                for (auto i = current.entries.size() - count; i < current.entries.size(); ++i) {
+                    auto timestamp = current.entries[i].timestamp;
+                    queue.push({timestamp + playout_delay, timestamp, entity, client_entity});
+                }
             });
         }
 
         *pool_it = std::move(snap.pools.back());
         snap.pools.pop_back();
+
+        return latest_timestamp;
     }
 };
 
@@ -0,0 +1,114 @@
+#ifndef EDYN_NETWORKING_UTIL_SNAPSHOT_BASELINE_HPP
+#define EDYN_NETWORKING_UTIL_SNAPSHOT_BASELINE_HPP
+
+#include <map>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <entt/entity/fwd.hpp>
+#include "edyn/networking/util/component_index_type.hpp"
+
+namespace edyn {
+
+namespace packet {
+    struct registry_snapshot;
+}
+
+/**
+ * @brief Values of the components in recent registry snapshots, which are
+ * used as the baseline for delta encoding. The server records the snapshots
+ * it sends to a client and the client records the snapshots it receives,
+ * which it acknowledges back to the server. Components are then encoded as
+ * the difference against the last value the client acknowledged and are not
+ * sent at all if they didn't change. Only components that are trivially
+ * copyable and that have at most `max_words` words of 32 bits are recorded.
+ */
+class snapshot_baseline {
+public:
+    using id_type = uint32_t;
+
+    // Snapshot id which represents the lack of an id.
+    static constexpr id_type null_id = 0;
+
+    // A baseline can be at most this many snapshots older than the snapshot
+    // that refers to it. Records older than that are discarded.
+    static constexpr id_type max_age = 1024;
+
+    // Maximum number of words of a component for it to be delta encoded,
+    // which is the number of bits in the mask of changed words.
+    static constexpr size_t max_words = 32;
+
+    /**
+     * @brief Records the value of all delta-encodable components in a
+     * snapshot, which must have an id.
+     */
+    void insert(const packet::registry_snapshot &snap);
+
+    /**
+     * @brief Records the value of a component in a snapshot.
+     */
+    void insert(id_type id, entt::entity entity, component_index_type component_index,
+                const void *data, size_t size);
+
+    /**
+     * @brief Find the value of a component in a recorded snapshot.
+     * @return Pointer to the component data or null if there's no such record.
+     */
+    const uint8_t * find(id_type id, entt::entity entity, component_index_type component_index) const;
+
+    /**
+     * @brief Marks a snapshot as received by the remote end, which makes its
+     * values the baseline of the components it contains.
+     */
+    void acknowledge(id_type id);
+
+    /**
+     * @brief Id of the most recent acknowledged snapshot containing a component.
+     * @return Snapshot id or `null_id` if none.
+     */
+    id_type find_acknowledged(entt::entity entity, component_index_type component_index) const;
+
+    /**
+     * @brief Releases all records of snapshots older than the given id.
+     */
+    void erase_until(id_type id);
+
+    /**
+     * @brief Encodes all components in a snapshot about to be sent as a delta
+     * against their latest acknowledged value and removes components and
+     * entities which haven't changed. The snapshot must have an id.
+     */
+    void encode(packet::registry_snapshot &snap) const;
+
+    /**
+     * @brief Restores the value of all delta-encoded components in a received
+     * snapshot. Components whose baseline is not available are removed.
+     * @return Whether all components were decoded successfully.
+     */
+    bool decode(packet::registry_snapshot &snap) const;
+
+    bool empty() const {
+        return m_records.empty();
+    }
+
+    /**
+     * @brief Estimated memory used by the records.
+     */
+    size_t num_bytes() const;
+
+private:
+    using key_type = std::pair<entt::entity, component_index_type>;
+
+    struct record {
+        std::vector<uint8_t> data;
+        std::map<key_type, size_t> offsets;
+    };
+
+    std::map<id_type, record> m_records;
+    std::map<key_type, id_type> m_acknowledged;
+};
+
+}
+
+#endif // EDYN_NETWORKING_UTIL_SNAPSHOT_BASELINE_HPP
@@ -0,0 +1,82 @@
+#ifndef EDYN_NETWORKING_UTIL_TIMED_PACKET_QUEUE_HPP
+#define EDYN_NETWORKING_UTIL_TIMED_PACKET_QUEUE_HPP
+
+#include <vector>
+#include <cstddef>
+#include "edyn/config/config.h"
+#include "edyn/networking/packet/edyn_packet.hpp"
+
+namespace edyn {
+
+struct timed_packet {
+    double timestamp;
+    packet::edyn_packet packet;
+};
+
+/**
+ * @brief Packets ordered by timestamp in a ring buffer, which is used to
+ * delay the processing of timed packets (see `timed_packets_tuple_t`).
+ * Packets with the same timestamp are kept in order of insertion. Packets
+ * usually arrive in order, thus insertion is constant time in the common case
+ * since it starts from the back and only moves the few packets with a later
+ * timestamp. Removing from the front is always constant time. The buffer
+ * keeps its capacity, thus no allocations occur once it's large enough.
+ */
+class timed_packet_queue {
+public:
+    /**
+     * @brief Inserts a packet after all packets with a timestamp less than or
+     * equal to the given timestamp.
+     */
+    void push(double timestamp, packet::edyn_packet &&packet);
+
+    bool empty() const {
+        return m_size == 0;
+    }
+
+    size_t size() const {
+        return m_size;
+    }
+
+    /**
+     * @brief Packet with the earliest timestamp. The queue must not be empty.
+     */
+    timed_packet & front() {
+        EDYN_ASSERT(!empty());
+        return m_buffer[m_head];
+    }
+
+    /**
+     * @brief Removes the packet with the earliest timestamp. The queue must
+     * not be empty.
+     */
+    void pop_front() {
+        EDYN_ASSERT(!empty());
+        // Release the memory held by the packet.
+        m_buffer[m_head].packet = {};
+        m_head = (m_head + 1) & (m_buffer.size() - 1);
+        --m_size;
+    }
+
+    void clear() {
+        while (!empty()) {
+            pop_front();
+        }
+    }
+
+private:
+    timed_packet & at(size_t index) {
+        return m_buffer[(m_head + index) & (m_buffer.size() - 1)];
+    }
+
+    void grow();
+
+    // Capacity is always a power of two.
+    std::vector<timed_packet> m_buffer;
+    size_t m_head {0};
+    size_t m_size {0};
+};
+
+}
+
+#endif // EDYN_NETWORKING_UTIL_TIMED_PACKET_QUEUE_HPP
@@ -34,6 +34,11 @@ public:
         cv.wait(lock, [&] { return done; });
     }
 
+    bool is_done() {
+        std::lock_guard lock(mutex);
+        return done;
+    }
+
 private:
     size_t count;
     bool done;
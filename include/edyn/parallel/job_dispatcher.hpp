@@ -1,47 +1,199 @@
 #ifndef EDYN_PARALLEL_JOB_DISPATCHER_HPP
 #define EDYN_PARALLEL_JOB_DISPATCHER_HPP
 
-#include <map>
 #include <atomic>
+#include <cstdint>
 #include <vector>
 #include <thread>
 #include <mutex>
-#include <shared_mutex>
+#include <condition_variable>
 #include "edyn/parallel/worker.hpp"
+#include "edyn/config/worker_idle_policy.hpp"
+#include "edyn/config/thread_affinity.hpp"
 
 namespace edyn {
 
 struct job;
 
 /**
- * Manages a set of worker threads and dispatches jobs to them.
+ * @brief Counters of a worker of a `job_dispatcher`.
+ */
+struct worker_stats {
+    // Number of jobs run by the worker, including the ones run while it waits
+    // for other jobs to finish.
+    uint64_t jobs_executed {0};
+    // Number of jobs taken from other workers.
+    uint64_t jobs_stolen {0};
+    // Time spent running jobs, in seconds.
+    double busy_time {0};
+    // Time spent waiting for jobs, spinning, yielding or parked, in seconds.
+    double idle_time {0};
+    // Largest number of jobs pending in the deque and queue of the worker.
+    size_t max_queue_depth {0};
+};
+
+/**
+ * @brief Measurements of a single call to `enqueue_task_wait_default`.
+ */
+struct task_wait_call_stats {
+    // Number of chunks the range was split into.
+    unsigned num_chunks {0};
+    // Duration of the call, in seconds.
+    double duration {0};
+    // Time the calling thread spent waiting for the other jobs to finish
+    // after it ran out of chunks, in seconds.
+    double wait_time {0};
+
+    // Fraction of the call spent waiting, which is zero if all chunks
+    // finished at the same time.
+    double imbalance() const {
+        return duration > 0 ? wait_time / duration : 0;
+    }
+};
+
+/**
+ * @brief Accumulated measurements of the calls to `enqueue_task_wait_default`
+ * which ran in a `job_dispatcher`.
+ */
+struct task_wait_stats {
+    uint64_t num_calls {0};
+    uint64_t num_chunks {0};
+    double duration {0};
+    double wait_time {0};
+    // Longest wait in a single call.
+    double max_wait_time {0};
+    // The most recent call.
+    task_wait_call_stats last;
+
+    double imbalance() const {
+        return duration > 0 ? wait_time / duration : 0;
+    }
+};
+
+/**
+ * @brief Statistics of a `job_dispatcher`. Jobs are always counted, while
+ * times and queue depths are only measured while enabled with
+ * `job_dispatcher::set_collect_stats`.
+ */
+struct job_dispatcher_stats {
+    std::vector<worker_stats> workers;
+    task_wait_stats task_wait;
+};
+
+/**
+ * Manages a set of worker threads and dispatches jobs to them. Each worker
+ * has its own deque of jobs and idle workers steal jobs from the others,
+ * which keeps all workers busy when jobs pile up in one of them.
  */
 class job_dispatcher {
 public:
     static job_dispatcher &global();
 
+    /**
+     * Dispatcher for jobs scheduled from the calling thread. In a worker
+     * thread it's the dispatcher of that worker. Otherwise, it's the one bound
+     * to the calling thread via `bind_current` or the global dispatcher if
+     * none was bound.
+     */
+    static job_dispatcher &current();
+
+    /**
+     * Sets the dispatcher returned by `current` in the calling thread, which
+     * is how a simulation thread sends all jobs of its world to the thread
+     * pool the world is bound to.
+     * @param dispatcher The dispatcher. Null restores the global dispatcher.
+     */
+    static void bind_current(job_dispatcher *dispatcher);
+
     ~job_dispatcher();
 
-    void start(size_t num_worker_threads);
+    /**
+     * Starts worker threads.
+     * @param num_worker_threads Number of workers.
+     * @param idle_policy How workers wait for jobs once they run out of work.
+     * @param worker_cores Core sets the workers are pinned to. Worker `i`
+     * uses the set at `i % worker_cores.size()`. Workers are not pinned if
+     * empty.
+     */
+    void start(size_t num_worker_threads, const worker_idle_policy &idle_policy = {},
+               const std::vector<core_set> &worker_cores = {});
 
     void stop();
 
     bool running() const;
 
     /**
-     * Schedules a job to run asynchronously in a worker thread.
+     * Schedules a job to run asynchronously in a worker thread. If called
+     * from one of the workers, the job is inserted into its deque, otherwise
+     * it's inserted into the queue of a worker chosen in round-robin.
      */
     void async(const job &);
 
+    /**
+     * Takes a pending job from the workers and runs it in the current thread,
+     * which is useful to make progress while waiting for other jobs to finish.
+     * @return False if there were no jobs to take.
+     */
+    bool run_pending_job();
+
     /**
      * Number of background workers.
      */
     size_t num_workers() const;
 
+    /**
+     * Enables collecting the statistics returned by `get_stats`, which
+     * requires reading the clock around each job. Disabled by default.
+     */
+    void set_collect_stats(bool collect);
+
+    bool collecting_stats() const {
+        return m_collect_stats.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Statistics collected since the workers were started or since the last
+     * call to `reset_stats`. Must not be called concurrently with `start`
+     * and `stop`.
+     */
+    job_dispatcher_stats get_stats() const;
+
+    void reset_stats();
+
+    /**
+     * Adds the measurements of a call to `enqueue_task_wait_default` which
+     * scheduled jobs in this dispatcher.
+     */
+    void record_task_wait(const task_wait_call_stats &);
+
 private:
+    friend class worker;
+
+    // Takes a job from the worker, or steals it from another worker. The
+    // worker can be null if not called from a worker thread, in which case
+    // it steals from all workers.
+    bool try_take_job(worker *, job &);
+
+    // Blocks until there are jobs to be taken, spinning and yielding for a
+    // while before parking, according to the idle policy. Returns false if
+    // the dispatcher is stopping and there are no jobs left.
+    bool wait_for_jobs();
+
     std::vector<std::unique_ptr<std::thread>> m_threads;
-    std::map<std::thread::id, std::unique_ptr<worker>> m_workers;
-    std::atomic<size_t> m_start;
+    std::vector<std::unique_ptr<worker>> m_workers;
+    std::atomic<size_t> m_start {0};
+    worker_idle_policy m_idle_policy;
+
+    // Number of jobs which were scheduled and not yet taken by a worker.
+    std::atomic<size_t> m_num_pending {0};
+    std::atomic<size_t> m_num_sleeping {0};
+    std::atomic<bool> m_stopping {false};
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+
+    std::atomic<bool> m_collect_stats {false};
+    mutable std::mutex m_stats_mutex;
+    task_wait_stats m_task_wait_stats;
 };
 
 }
@@ -2,10 +2,18 @@
 #define EDYN_PARALLEL_MESSAGE_HPP
 
 #include <entt/entity/fwd.hpp>
+#include "edyn/collision/query_aabb.hpp"
 #include "edyn/collision/raycast.hpp"
+#include "edyn/collision/overlap.hpp"
+#include "edyn/collision/shape_cast.hpp"
+#include "edyn/collision/collision_stats.hpp"
+#include "edyn/collision/contact_event_stream.hpp"
+#include "edyn/collision/sensor.hpp"
 #include "edyn/comp/aabb.hpp"
 #include "edyn/comp/island.hpp"
+#include "edyn/constraints/breakable_constraint.hpp"
 #include "edyn/context/registry_operation_context.hpp"
+#include "edyn/parallel/query_future.hpp"
 #include "edyn/math/vector3.hpp"
 #include "edyn/context/settings.hpp"
 #include "edyn/dynamics/material_mixing.hpp"
@@ -16,6 +24,8 @@
 #include "edyn/core/entity_pair.hpp"
 #include "edyn/replication/registry_operation.hpp"
 #include "edyn/util/rigidbody.hpp"
+#include "edyn/util/memory_stats.hpp"
+#include "edyn/util/step_profile.hpp"
 
 namespace edyn::msg {
 
@@ -35,7 +45,17 @@ struct set_material_table {
     edyn::material_mix_table table;
 };
 
-struct step_simulation {};
+struct step_simulation {
+    // Steps are run back to back and the state is only sent back after the
+    // last one.
+    unsigned num_steps {1};
+};
+
+struct shift_origin {
+    vector3 offset;
+};
+
+struct finish_maintenance {};
 
 struct set_com {
     entt::entity entity;
@@ -49,6 +69,25 @@ struct set_com {
 struct step_update {
     registry_operation ops;
     double timestamp;
+    // Number of `shift_origin` messages applied before the state was taken.
+    uint32_t origin_shift_count;
+    // Statistics of the last step, if they're being collected.
+    std::unique_ptr<collision_stats> stats;
+    // Sensor events generated since the previous step update.
+    std::vector<sensor_event> sensor_events;
+    // Contact events generated since the previous step update, if they're
+    // being streamed.
+    std::vector<contact_event> contact_events;
+    // Constraints that broke since the previous step update.
+    std::vector<constraint_break_event> constraint_break_events;
+};
+
+/**
+ * Message sent by worker to the main thread after each update in which steps
+ * were performed while step profiling is enabled.
+ */
+struct step_profile_update {
+    step_profile profile;
 };
 
 /**
@@ -77,6 +116,8 @@ struct raycast_request {
     unsigned int id;
     vector3 p0, p1;
     std::vector<entt::entity> ignore_entities;
+    // If valid, the result is set into it instead of being sent back.
+    query_promise<raycast_result> promise;
 };
 
 struct raycast_response {
@@ -84,12 +125,51 @@ struct raycast_response {
     raycast_result result;
 };
 
+struct raycast_batch_request {
+    unsigned int id;
+    std::vector<raycast_query> rays;
+    std::vector<entt::entity> ignore_entities;
+    bool any_hit;
+};
+
+struct raycast_batch_response {
+    unsigned int id;
+    // One result per ray in the order of the request.
+    std::vector<raycast_result> results;
+};
+
+struct shape_cast_request {
+    unsigned int id;
+    std::vector<shape_cast_query> queries;
+    std::vector<entt::entity> ignore_entities;
+};
+
+struct shape_cast_response {
+    unsigned int id;
+    // One result per query in the order of the request.
+    std::vector<shape_cast_result> results;
+};
+
+struct overlap_request {
+    unsigned int id;
+    std::vector<overlap_query> queries;
+    std::vector<entt::entity> ignore_entities;
+};
+
+struct overlap_response {
+    unsigned int id;
+    // One result per query in the order of the request.
+    std::vector<overlap_result> results;
+};
+
 struct query_aabb_request {
     unsigned id;
     AABB aabb;
     bool query_procedural;
     bool query_non_procedural;
     bool query_islands;
+    // If valid, the result is set into it instead of being sent back.
+    query_promise<query_aabb_result> promise;
 };
 
 struct query_aabb_of_interest_request {
@@ -104,6 +184,24 @@ struct query_aabb_response {
     std::vector<entt::entity> island_entities;
 };
 
+struct query_aabb_batch_request {
+    unsigned id;
+    std::vector<AABB> aabbs;
+    bool query_procedural;
+    bool query_non_procedural;
+    bool query_islands;
+};
+
+struct query_aabb_batch_response {
+    unsigned id;
+    // One result per AABB in the order of the request.
+    std::vector<query_aabb_result> results;
+};
+
+struct query_memory_stats_request {
+    query_promise<memory_stats> promise;
+};
+
 struct set_extrapolator_context_settings {
     std::shared_ptr<input_state_history_reader> input_history;
     make_extrapolation_modified_comp_func_t *make_extrapolation_modified_comp;
@@ -114,6 +212,17 @@ struct paged_triangle_mesh_load_page {
     size_t mesh_index;
 };
 
+struct paged_triangle_mesh_evict_page {
+    paged_triangle_mesh *trimesh;
+    size_t mesh_index;
+};
+
+struct paged_triangle_mesh_page_miss {
+    paged_triangle_mesh *trimesh;
+    size_t mesh_index;
+    AABB aabb;
+};
+
 }
 
 #endif // EDYN_PARALLEL_MESSAGE_HPP
@@ -1,6 +1,8 @@
 #ifndef EDYN_PARALLEL_MESSAGE_DISPATCHER_HPP
 #define EDYN_PARALLEL_MESSAGE_DISPATCHER_HPP
 
+#include <array>
+#include <atomic>
 #include <mutex>
 #include <shared_mutex>
 #include <unordered_map>
@@ -8,6 +10,7 @@
 #include <vector>
 #include "edyn/config/config.h"
 #include "edyn/parallel/message_queue.hpp"
+#include "edyn/util/profiling.hpp"
 
 namespace edyn {
 
@@ -15,19 +18,20 @@ template<typename... MessageTypes>
 class message_queue_handle {
 
     template<typename T>
-    void maybe_consume_message(any_message &msg) {
-        if (entt::type_id<T>() == msg.content.type()) {
+    void maybe_consume_message(const message_queue_id &sender, message_any &content) {
+        if (entt::type_id<T>() == content.type()) {
             using signal_type = entt::sigh<void(message<T> &)>;
-            auto m = message<T>{msg.sender, std::move(*entt::any_cast<T>(&msg.content))};
+            auto m = message<T>{sender, std::move(*entt::any_cast<T>(&content))};
             std::get<signal_type>(m_signals).publish(m);
         }
     }
 
 public:
-    const message_queue_identifier identifier;
+    // Handle to this queue, to be given to `message_dispatcher::send`.
+    const message_queue_id id;
 
-    message_queue_handle(message_queue_identifier identifier, message_queue &queue)
-        : identifier(identifier)
+    message_queue_handle(message_queue_id id, message_queue &queue)
+        : id(id)
         , m_queue(&queue)
     {}
 
@@ -38,8 +42,9 @@ public:
     }
 
     void update() {
-        m_queue->consume([&] (any_message &msg) {
-            (maybe_consume_message<MessageTypes>(msg), ...);
+        EDYN_PROFILE_ZONE("consume_messages");
+        m_queue->consume([&] (const message_queue_id &sender, message_any &content) {
+            (maybe_consume_message<MessageTypes>(sender, content), ...);
         });
     }
 
@@ -52,33 +57,130 @@ private:
     message_queue *m_queue;
 };
 
+/**
+ * Owns message queues and delivers messages to them. Queues are found by the
+ * `message_queue_id` returned when they're made, which takes no lock, or by
+ * name if they were given one, which requires a lookup in a hash map.
+ */
 class message_dispatcher {
+    static constexpr size_t max_queues = 256;
+
+    struct queue_slot {
+        std::atomic<message_queue *> queue {nullptr};
+        std::atomic<uint32_t> generation {0};
+        // Number of threads pushing into the queue, which must reach zero
+        // before the queue can be deleted.
+        std::atomic<uint32_t> num_senders {0};
+    };
+
+    message_queue_id lookup_locked(const message_queue_identifier &name) const {
+        if (auto it = m_names.find(name.value); it != m_names.end()) {
+            return it->second;
+        }
+
+        return {};
+    }
+
+    void destroy_slot(uint32_t index);
+
 public:
     static message_dispatcher &global();
 
+    ~message_dispatcher();
+
+    /**
+     * @brief Makes a new queue.
+     * @param name Optional name by which others can find the queue. Must be
+     * unique. Anonymous queues are only reachable by their id.
+     * @return Handle to consume the messages of the new queue.
+     */
     template<typename... MessageTypes>
-    auto make_queue(const std::string &name) {
+    auto make_queue(const std::string &name = {}) {
         auto lock = std::lock_guard(m_queues_mutex);
-        EDYN_ASSERT(!m_queues.count(name));
-        m_queues[name] = std::make_unique<message_queue>();
-        return message_queue_handle<MessageTypes...>({name}, *m_queues.at(name));
+        EDYN_ASSERT(name.empty() || !m_names.count(name));
+
+        uint32_t index;
+
+        if (!m_free_indices.empty()) {
+            index = m_free_indices.back();
+            m_free_indices.pop_back();
+        } else {
+            EDYN_ASSERT(m_num_slots < max_queues);
+            index = m_num_slots++;
+        }
+
+        auto &slot = m_slots[index];
+        auto *queue = new message_queue;
+        auto id = message_queue_id{index, slot.generation.load(std::memory_order_relaxed)};
+        slot.queue.store(queue, std::memory_order_release);
+
+        if (!name.empty()) {
+            m_names[name] = id;
+        }
+
+        return message_queue_handle<MessageTypes...>(id, *queue);
     }
 
-    template<typename T, typename... Args>
-    void send(message_queue_identifier destination, message_queue_identifier source, Args&& ... args) {
+    /**
+     * @brief Destroys a queue. No thread may send messages to it or consume
+     * its messages anymore.
+     * @param id The queue.
+     */
+    void destroy_queue(const message_queue_id &id);
+
+    /**
+     * @brief Finds a queue by name.
+     * @param name Name of the queue.
+     * @return The queue's id, or a null id if no queue has that name.
+     */
+    message_queue_id lookup(const message_queue_identifier &name) const {
         auto lock = std::shared_lock(m_queues_mutex);
-        if (m_queues.count(destination.value)) {
-            m_queues.at(destination.value)->push<T>(source, std::forward<Args>(args)...);
+        return lookup_locked(name);
+    }
+
+    /**
+     * @brief Sends a message to a queue without taking locks. Nothing is
+     * done if the queue doesn't exist anymore.
+     * @param destination The receiving queue.
+     * @param source Queue of the sender, e.g. where responses should be sent.
+     * @param args Arguments to construct the message with.
+     */
+    template<typename T, typename... Args>
+    void send(const message_queue_id &destination, const message_queue_id &source, Args&& ... args) {
+        if (!destination.valid() || destination.index >= max_queues) {
+            return;
+        }
+
+        EDYN_PROFILE_ZONE("send_message");
+
+        auto &slot = m_slots[destination.index];
+        slot.num_senders.fetch_add(1, std::memory_order_seq_cst);
+        auto *queue = slot.queue.load(std::memory_order_seq_cst);
+
+        if (queue && slot.generation.load(std::memory_order_relaxed) == destination.generation) {
+            queue->push<T>(source, std::forward<Args>(args)...);
         }
+
+        slot.num_senders.fetch_sub(1, std::memory_order_release);
     }
 
-    void clear_queues() {
+    /**
+     * @brief Sends a message to a queue found by name, which takes a lock and
+     * does a lookup in a hash map. Prefer sending to an id where possible.
+     */
+    template<typename T, typename... Args>
+    void send(const message_queue_identifier &destination, const message_queue_id &source, Args&& ... args) {
         auto lock = std::shared_lock(m_queues_mutex);
-        m_queues.clear();
+        send<T>(lookup_locked(destination), source, std::forward<Args>(args)...);
     }
 
+    void clear_queues();
+
 private:
-    std::unordered_map<std::string, std::unique_ptr<message_queue>> m_queues;
+    mutable std::array<queue_slot, max_queues> m_slots;
+    uint32_t m_num_slots {0};
+    std::vector<uint32_t> m_free_indices;
+    std::unordered_map<std::string, message_queue_id> m_names;
     mutable std::shared_mutex m_queues_mutex;
 };
 
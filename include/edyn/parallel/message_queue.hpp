@@ -1,8 +1,14 @@
 #ifndef EDYN_PARALLEL_MESSAGE_QUEUE_HPP
 #define EDYN_PARALLEL_MESSAGE_QUEUE_HPP
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 #include <entt/core/any.hpp>
 #include <entt/signal/sigh.hpp>
 
@@ -12,36 +18,198 @@ struct message_queue_identifier {
     std::string value;
 };
 
+/**
+ * Handle to a queue in the message dispatcher obtained when the queue is
+ * made, which finds the queue without a lookup by name. A default handle
+ * refers to no queue and is used as the sender of anonymous messages.
+ */
+struct message_queue_id {
+    static constexpr uint32_t null_index = std::numeric_limits<uint32_t>::max();
+
+    uint32_t index {null_index};
+    // Distinguishes queues which reuse the index of a destroyed queue.
+    uint32_t generation {0};
+
+    bool valid() const {
+        return index != null_index;
+    }
+
+    bool operator==(const message_queue_id &other) const {
+        return index == other.index && generation == other.generation;
+    }
+
+    bool operator!=(const message_queue_id &other) const {
+        return !(*this == other);
+    }
+};
+
+// Messages up to this size that can be moved without throwing are stored
+// inline, without allocating memory.
+inline constexpr size_t message_inline_size = 128;
+
+using message_any = entt::basic_any<message_inline_size>;
+
 struct any_message {
-    message_queue_identifier sender;
-    entt::any content;
+    message_queue_id sender;
+    message_any content;
 };
 
 template<typename T>
 struct message {
-    message_queue_identifier sender;
+    message_queue_id sender;
     T content;
 };
 
+/**
+ * Receives messages from any number of threads and delivers them to the
+ * thread that consumes them. Each sender gets a bounded single-producer,
+ * single-consumer ring, thus neither sending nor consuming takes a lock
+ * or allocates memory in the common case. A message goes into a locked
+ * overflow list instead when the ring of its sender is full, when there are
+ * too many senders or when another thread is pushing with the same sender
+ * in that moment. Messages of each sender are delivered in order.
+ */
 class message_queue {
+    static constexpr size_t ring_capacity = 64;
+    static constexpr size_t max_senders = 16;
+
+    struct ring {
+        message_queue_id sender;
+        std::array<message_any, ring_capacity> slots;
+        // Index of the next message to be consumed.
+        std::atomic<size_t> head {0};
+        // Index of the next message to be pushed.
+        std::atomic<size_t> tail {0};
+        // Set while a thread is pushing, in case more than one thread sends
+        // messages with the same sender.
+        std::atomic<bool> pushing {false};
+        // Number of messages of this sender in the overflow list. While
+        // non-zero, new messages also go into the overflow list to keep
+        // them in order.
+        std::atomic<size_t> num_overflow {0};
+    };
+
+    struct overflow_message {
+        ring *source_ring;
+        any_message msg;
+    };
+
+    ring * find_ring(const message_queue_id &source) {
+        auto count = m_num_rings.load(std::memory_order_acquire);
+
+        for (size_t i = 0; i < count; ++i) {
+            if (m_rings[i]->sender == source) {
+                return m_rings[i].get();
+            }
+        }
+
+        return nullptr;
+    }
+
+    ring * find_or_create_ring(const message_queue_id &source) {
+        if (auto *r = find_ring(source)) {
+            return r;
+        }
+
+        auto lock = std::lock_guard(m_rings_mutex);
+
+        if (auto *r = find_ring(source)) {
+            return r;
+        }
+
+        auto count = m_num_rings.load(std::memory_order_relaxed);
+
+        if (count == max_senders) {
+            return nullptr;
+        }
+
+        m_rings[count] = std::make_unique<ring>();
+        m_rings[count]->sender = source;
+        m_num_rings.store(count + 1, std::memory_order_release);
+
+        return m_rings[count].get();
+    }
+
+    template<typename T, typename... Args>
+    bool try_push_ring(ring &r, Args&& ... args) {
+        if (r.num_overflow.load(std::memory_order_acquire) > 0 ||
+            r.pushing.exchange(true, std::memory_order_acquire)) {
+            return false;
+        }
+
+        auto tail = r.tail.load(std::memory_order_relaxed);
+        auto pushed = tail - r.head.load(std::memory_order_acquire) < ring_capacity;
+
+        if (pushed) {
+            r.slots[tail % ring_capacity].template emplace<T>(std::forward<Args>(args)...);
+            r.tail.store(tail + 1, std::memory_order_release);
+        }
+
+        r.pushing.store(false, std::memory_order_release);
+
+        return pushed;
+    }
+
 public:
     template<typename T, typename... Args>
-    void push(message_queue_identifier source, Args&& ... args) {
-        // TODO: create a new single-producer/single-consumer queue for each new source.
-        auto lock = std::lock_guard(m_mutex);
-        m_messages.emplace_back(any_message{source, entt::any(std::in_place_type_t<T>{}, std::forward<Args>(args)...)});
+    void push(const message_queue_id &source, Args&& ... args) {
+        auto *r = find_or_create_ring(source);
+
+        if (!r || !try_push_ring<T>(*r, std::forward<Args>(args)...)) {
+            auto lock = std::lock_guard(m_overflow_mutex);
+
+            if (r) {
+                r->num_overflow.fetch_add(1, std::memory_order_release);
+            }
+
+            m_overflow.push_back(overflow_message{r, any_message{source, message_any(std::in_place_type_t<T>{}, std::forward<Args>(args)...)}});
+        }
+
         m_push_signal.publish();
     }
 
+    /**
+     * @brief Invokes the function for each pending message. Must only be
+     * called from one thread at a time.
+     * @param func Callable with signature
+     * `void(const message_queue_id &, message_any &)`.
+     */
     template<typename Func>
     void consume(Func func) {
-        auto lock = std::unique_lock(m_mutex);
-        auto messages = std::move(m_messages);
+        // Take the overflow list before the rings. Senders which have
+        // messages in it do not push into their ring until these are
+        // delivered, thus the messages in their rings are older.
+        auto lock = std::unique_lock(m_overflow_mutex);
+        std::swap(m_overflow, m_overflow_consumed);
         lock.unlock();
 
-        for (auto &msg : messages) {
-            func(msg);
+        auto count = m_num_rings.load(std::memory_order_acquire);
+
+        for (size_t i = 0; i < count; ++i) {
+            auto &r = *m_rings[i];
+            auto head = r.head.load(std::memory_order_relaxed);
+            auto tail = r.tail.load(std::memory_order_acquire);
+
+            for (; head != tail; ++head) {
+                auto &slot = r.slots[head % ring_capacity];
+                func(r.sender, slot);
+                slot.reset();
+                r.head.store(head + 1, std::memory_order_release);
+            }
         }
+
+        for (auto &entry : m_overflow_consumed) {
+            if (entry.source_ring) {
+                entry.source_ring->num_overflow.fetch_sub(1, std::memory_order_release);
+            }
+        }
+
+        for (auto &entry : m_overflow_consumed) {
+            func(entry.msg.sender, entry.msg.content);
+        }
+
+        // Keep the memory of the list to be swapped in the next call.
+        m_overflow_consumed.clear();
     }
 
     auto push_sink() {
@@ -49,8 +217,14 @@ public:
     }
 
 private:
-    mutable std::mutex m_mutex;
-    std::vector<any_message> m_messages;
+    std::array<std::unique_ptr<ring>, max_senders> m_rings;
+    std::atomic<size_t> m_num_rings {0};
+    std::mutex m_rings_mutex;
+
+    std::mutex m_overflow_mutex;
+    std::vector<overflow_message> m_overflow;
+    std::vector<overflow_message> m_overflow_consumed;
+
     entt::sigh<void(void)> m_push_signal;
 };
 
@@ -0,0 +1,161 @@
+#ifndef EDYN_PARALLEL_QUERY_FUTURE_HPP
+#define EDYN_PARALLEL_QUERY_FUTURE_HPP
+
+#include "edyn/config/config.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace edyn {
+
+namespace detail {
+    template<typename T>
+    struct query_shared_state {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::atomic<bool> ready {false};
+        T value;
+        // Invoked in the thread which takes the value the first time it is
+        // taken, e.g. to map entities into the registry of that thread.
+        std::function<void(T &)> finish;
+        bool finished {false};
+    };
+}
+
+template<typename T>
+class query_promise;
+
+/**
+ * Result of an asynchronous query which is resolved by the simulation worker
+ * as soon as the query is done, instead of being delivered by a callback in
+ * the next `edyn::update`. It can be polled with `is_ready` once per frame or
+ * waited on. It must be taken in one thread only.
+ */
+template<typename T>
+class query_future {
+    friend class query_promise<T>;
+
+    query_future(std::shared_ptr<detail::query_shared_state<T>> state)
+        : m_state(std::move(state))
+    {}
+
+public:
+    query_future() = default;
+
+    /**
+     * @brief Whether this future refers to a query.
+     */
+    bool valid() const {
+        return static_cast<bool>(m_state);
+    }
+
+    /**
+     * @brief Whether the result is available, in which case `get` does not
+     * block.
+     */
+    bool is_ready() const {
+        EDYN_ASSERT(valid());
+        return m_state->ready.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Blocks until the result is available.
+     */
+    void wait() const {
+        EDYN_ASSERT(valid());
+
+        if (is_ready()) {
+            return;
+        }
+
+        auto lock = std::unique_lock(m_state->mutex);
+        m_state->cv.wait(lock, [&] { return m_state->ready.load(std::memory_order_relaxed); });
+    }
+
+    /**
+     * @brief Blocks until the result is available or the timeout expires.
+     * @return Whether the result is available.
+     */
+    template<typename Rep, typename Period>
+    bool wait_for(const std::chrono::duration<Rep, Period> &timeout) const {
+        EDYN_ASSERT(valid());
+
+        if (is_ready()) {
+            return true;
+        }
+
+        auto lock = std::unique_lock(m_state->mutex);
+        return m_state->cv.wait_for(lock, timeout, [&] { return m_state->ready.load(std::memory_order_relaxed); });
+    }
+
+    /**
+     * @brief Blocks until the result is available and returns it.
+     */
+    const T & get() {
+        wait();
+
+        if (!m_state->finished) {
+            if (m_state->finish) {
+                m_state->finish(m_state->value);
+            }
+
+            m_state->finished = true;
+        }
+
+        return m_state->value;
+    }
+
+private:
+    std::shared_ptr<detail::query_shared_state<T>> m_state;
+};
+
+/**
+ * Holds the shared state which the party doing the query will set the result
+ * into. A default constructed promise is empty, which is cheap to carry in
+ * messages of queries where no future was requested.
+ */
+template<typename T>
+class query_promise {
+public:
+    bool valid() const {
+        return static_cast<bool>(m_state);
+    }
+
+    /**
+     * @brief Creates the shared state and returns a future referring to it.
+     * @param finish Optional function invoked in the thread which takes the
+     * value, before it is returned.
+     */
+    query_future<T> get_future(std::function<void(T &)> finish = {}) {
+        EDYN_ASSERT(!valid());
+        m_state = std::make_shared<detail::query_shared_state<T>>();
+        m_state->finish = std::move(finish);
+        return query_future<T>(m_state);
+    }
+
+    /**
+     * @brief Resolves the future. Can be called from any thread, and only once.
+     */
+    void set_value(T value) {
+        EDYN_ASSERT(valid());
+        EDYN_ASSERT(!m_state->ready.load(std::memory_order_relaxed));
+
+        {
+            auto lock = std::lock_guard(m_state->mutex);
+            m_state->value = std::move(value);
+            m_state->ready.store(true, std::memory_order_release);
+        }
+
+        m_state->cv.notify_all();
+    }
+
+private:
+    std::shared_ptr<detail::query_shared_state<T>> m_state;
+};
+
+}
+
+#endif // EDYN_PARALLEL_QUERY_FUTURE_HPP
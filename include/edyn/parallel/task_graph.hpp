@@ -0,0 +1,83 @@
+#ifndef EDYN_PARALLEL_TASK_GRAPH_HPP
+#define EDYN_PARALLEL_TASK_GRAPH_HPP
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include "edyn/parallel/job.hpp"
+
+namespace edyn {
+
+class job_dispatcher;
+
+/**
+ * A set of jobs with dependencies among them. Once a job finishes, the jobs
+ * which depend on it are dispatched as soon as all of their other
+ * dependencies have also finished, thus independent chains of jobs progress
+ * without waiting for each other, instead of synchronizing all of them at
+ * barriers between phases.
+ */
+class task_graph {
+public:
+    using task_id = uint32_t;
+
+    /**
+     * @brief Adds a job to the graph.
+     * @param j The job.
+     * @return Identifier of the new task.
+     */
+    task_id add_task(const job &j);
+
+    /**
+     * @brief Makes a task only start after another finishes.
+     * @param before The task that runs first.
+     * @param after The task that depends on `before`.
+     */
+    void precede(task_id before, task_id after);
+
+    /**
+     * @brief Runs all tasks in the worker threads of the dispatcher and
+     * returns once all of them are done. The calling thread runs pending jobs
+     * while it waits.
+     * @param dispatcher The dispatcher.
+     */
+    void run(job_dispatcher &dispatcher);
+
+    /**
+     * @brief Removes all tasks. Must not be called while running.
+     */
+    void clear();
+
+    size_t size() const {
+        return m_tasks.size();
+    }
+
+private:
+    struct task {
+        job j;
+        std::vector<task_id> successors;
+        uint32_t num_predecessors {0};
+    };
+
+    static void run_task_job(job::data_type &);
+    void dispatch(task_id);
+    void finish_task();
+
+    // Set in `m_num_unfinished` when the thread in `run` is asleep.
+    static constexpr size_t parked_bit = size_t(1) << (sizeof(size_t) * 8 - 1);
+
+    std::vector<task> m_tasks;
+    // Number of unfinished predecessors of each task while running.
+    std::unique_ptr<std::atomic<uint32_t>[]> m_remaining;
+    std::atomic<size_t> m_num_unfinished {0};
+    job_dispatcher *m_dispatcher {nullptr};
+    bool m_done {false};
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+};
+
+}
+
+#endif // EDYN_PARALLEL_TASK_GRAPH_HPP
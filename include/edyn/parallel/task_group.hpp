@@ -0,0 +1,71 @@
+#ifndef EDYN_PARALLEL_TASK_GROUP_HPP
+#define EDYN_PARALLEL_TASK_GROUP_HPP
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include "edyn/context/task.hpp"
+#include "edyn/parallel/job.hpp"
+
+namespace edyn {
+
+class job_dispatcher;
+
+/**
+ * A set of tasks which are waited on together and which can be used from
+ * inside of jobs, e.g. to run the narrowphase of an island in parallel from
+ * the job that steps the island. The waiting thread runs pending jobs in the
+ * meantime. Worker threads never park while waiting, since that would take
+ * them out of the pool while the jobs they wait for might still be queued,
+ * thus nested groups keep making progress even if all workers are waiting.
+ * Other threads park after spinning for a while, as in `edyn::parallel_for`.
+ */
+class task_group {
+public:
+    /**
+     * @brief Creates an empty group whose jobs are dispatched to the given
+     * dispatcher.
+     * @param dispatcher The dispatcher. Usually `job_dispatcher::current()`.
+     */
+    task_group(job_dispatcher &dispatcher);
+
+    task_group(const task_group &) = delete;
+    task_group & operator=(const task_group &) = delete;
+
+    /**
+     * @brief Waits for the remaining tasks.
+     */
+    ~task_group();
+
+    /**
+     * @brief Schedules a task to be invoked over sub-ranges of `[0, size)`
+     * in worker threads and returns immediately. The range is split into one
+     * job per worker plus one, which the waiting thread usually takes.
+     * @param task The task.
+     * @param size Size of the range.
+     */
+    void run(task_delegate_t task, unsigned size);
+
+    /**
+     * @brief Returns once all tasks scheduled so far are done. The group can
+     * be reused afterwards.
+     */
+    void wait();
+
+private:
+    static void run_chunk_job(job::data_type &);
+    void finish_job();
+
+    // Set in `m_num_unfinished` when the thread in `wait` is asleep.
+    static constexpr size_t parked_bit = size_t(1) << (sizeof(size_t) * 8 - 1);
+
+    job_dispatcher *m_dispatcher;
+    std::atomic<size_t> m_num_unfinished {0};
+    bool m_done {false};
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+};
+
+}
+
+#endif // EDYN_PARALLEL_TASK_GROUP_HPP
@@ -0,0 +1,18 @@
+#ifndef EDYN_PARALLEL_THREAD_AFFINITY_HPP
+#define EDYN_PARALLEL_THREAD_AFFINITY_HPP
+
+#include "edyn/config/thread_affinity.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Restricts the calling thread to the given set of cores.
+ * @param cores Logical processor indices. Nothing is done if empty.
+ * @return Whether the affinity was set. Fails if the platform does not
+ * support it (e.g. macOS) or if all cores are out of range.
+ */
+bool set_current_thread_affinity(const core_set &cores);
+
+}
+
+#endif // EDYN_PARALLEL_THREAD_AFFINITY_HPP
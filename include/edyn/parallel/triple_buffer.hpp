@@ -0,0 +1,74 @@
+#ifndef EDYN_PARALLEL_TRIPLE_BUFFER_HPP
+#define EDYN_PARALLEL_TRIPLE_BUFFER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace edyn {
+
+/**
+ * Passes the latest value from one writer thread to one reader thread
+ * without locks. The writer fills the back buffer and publishes it, while
+ * the reader holds on to the front buffer until it takes the latest
+ * published one. Neither side ever waits for the other, and values published
+ * while the reader holds the front buffer are replaced by newer ones.
+ */
+template<typename T>
+class triple_buffer {
+    static constexpr uint8_t index_mask = 0b011;
+    // Set in the middle index when it holds a value the reader hasn't taken.
+    static constexpr uint8_t fresh_bit = 0b100;
+
+public:
+    /**
+     * @brief Buffer to be written by the writer thread. Holds the value
+     * published three times before, or the value taken by the reader the last
+     * time, thus it must be fully rewritten or updated based on what it had.
+     */
+    T & back() {
+        return m_buffers[m_back];
+    }
+
+    /**
+     * @brief Makes the back buffer available to the reader. Called from the
+     * writer thread.
+     */
+    void publish() {
+        auto prev = m_middle.exchange(m_back | fresh_bit, std::memory_order_acq_rel);
+        m_back = prev & index_mask;
+    }
+
+    /**
+     * @brief Takes the latest published buffer, if any. Called from the
+     * reader thread.
+     * @return Whether a new buffer was taken into the front.
+     */
+    bool swap() {
+        if ((m_middle.load(std::memory_order_relaxed) & fresh_bit) == 0) {
+            return false;
+        }
+
+        auto prev = m_middle.exchange(m_front, std::memory_order_acq_rel);
+        m_front = prev & index_mask;
+
+        return true;
+    }
+
+    /**
+     * @brief Buffer last taken by the reader.
+     */
+    const T & front() const {
+        return m_buffers[m_front];
+    }
+
+private:
+    std::array<T, 3> m_buffers {};
+    uint8_t m_back {0};
+    std::atomic<uint8_t> m_middle {1};
+    uint8_t m_front {2};
+};
+
+}
+
+#endif // EDYN_PARALLEL_TRIPLE_BUFFER_HPP
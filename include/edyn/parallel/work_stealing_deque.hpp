@@ -0,0 +1,68 @@
+#ifndef EDYN_PARALLEL_WORK_STEALING_DEQUE_HPP
+#define EDYN_PARALLEL_WORK_STEALING_DEQUE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include "edyn/parallel/job.hpp"
+
+namespace edyn {
+
+/**
+ * Lock-free double-ended queue of jobs with a fixed capacity, based on the
+ * Chase-Lev deque. Only the owner thread can push and pop jobs, at the bottom,
+ * while any other thread can steal jobs from the top.
+ * Reference: Correct and Efficient Work-Stealing for Weak Memory Models -
+ * Nhat Minh Lê, Antoniu Pop, Albert Cohen, Francesco Zappa Nardelli.
+ */
+class work_stealing_deque {
+public:
+    static constexpr size_t capacity = 1024;
+
+    /**
+     * Inserts a job at the bottom. Owner thread only.
+     * @return False if the deque is full.
+     */
+    bool push(const job &);
+
+    /**
+     * Takes the job at the bottom, i.e. the most recently pushed job. Owner
+     * thread only.
+     * @return False if the deque is empty.
+     */
+    bool pop(job &);
+
+    /**
+     * Takes the job at the top, i.e. the oldest job. Can be called from any
+     * thread.
+     * @return False if the deque is empty or if the job was taken by another
+     * thread at the same time.
+     */
+    bool steal(job &);
+
+    /**
+     * Approximate number of jobs in the deque.
+     */
+    size_t size() const;
+
+private:
+    static_assert((capacity & (capacity - 1)) == 0, "Capacity must be a power of two.");
+    static_assert(sizeof(job) % sizeof(uint64_t) == 0);
+
+    // Jobs are stored as words which are loaded and stored atomically since a
+    // thief can read a slot while the owner is writing a new job into it, in
+    // which case the stolen copy is discarded.
+    static constexpr size_t words_per_job = sizeof(job) / sizeof(uint64_t);
+    using slot_type = std::array<std::atomic<uint64_t>, words_per_job>;
+
+    void store(int64_t index, const job &);
+    job load(int64_t index) const;
+
+    alignas(64) std::atomic<int64_t> m_top {0};
+    alignas(64) std::atomic<int64_t> m_bottom {0};
+    alignas(64) std::array<slot_type, capacity> m_slots;
+};
+
+}
+
+#endif // EDYN_PARALLEL_WORK_STEALING_DEQUE_HPP
@@ -3,59 +3,81 @@
 
 #include <atomic>
 #include <memory>
+#include <cstdint>
 #include "edyn/parallel/job_queue.hpp"
+#include "edyn/parallel/work_stealing_deque.hpp"
 
 namespace edyn {
 
+class job_dispatcher;
+struct worker_stats;
+
 /**
- * A worker that runs jobs in a thread.
+ * A worker that runs jobs in a thread. Jobs scheduled from its own thread go
+ * into a work-stealing deque and jobs scheduled from other threads go into a
+ * queue. When both are empty, it steals jobs from the other workers of its
+ * dispatcher and sleeps if there's nothing left to steal.
  */
 class worker {
 public:
-    void push_job(const job &j) {
-        m_queue.push(j);
-        ++m_size;
-    }
+    worker(job_dispatcher &dispatcher);
 
-    void run() {
-        m_running = true;
+    /**
+     * Inserts a job from any thread.
+     */
+    void push_job(const job &j);
 
-        for (;;) {
-            auto j = m_queue.pop();
-            j();
-            --m_size;
+    /**
+     * Inserts a job into the deque. Must only be called from the thread
+     * running this worker.
+     */
+    void push_local_job(const job &j);
 
-            if (!m_running) {
-                break;
-            }
-        }
-    }
+    /**
+     * Takes a job from the deque, or from the queue if the deque is empty.
+     * Must only be called from the thread running this worker.
+     */
+    bool try_pop(job &j);
 
-    void once() {
-        job j;
-        while (m_queue.try_pop(j)) {
-            j();
-            --m_size;
-        }
-    }
+    /**
+     * Takes a job from another thread.
+     */
+    bool try_steal(job &j);
 
-    void stop() {
-        m_running = false;
-        m_queue.push(job::noop()); // Unblock queue with a no-op job.
-    }
+    void run();
 
-    size_t size() {
-        return m_size.load();
-    }
+    size_t size() const;
 
-    job_queue &get_queue() {
-        return m_queue;
+    job_dispatcher &dispatcher() const {
+        return *m_dispatcher;
     }
 
+    /**
+     * The worker running in the current thread or null if this is not a
+     * worker thread.
+     */
+    static worker *current();
+
+    worker_stats get_stats() const;
+
+    void reset_stats();
+
 private:
-    std::atomic_bool m_running {false};
+    friend class job_dispatcher;
+
+    void update_max_queue_depth();
+
+    job_dispatcher *m_dispatcher;
+    work_stealing_deque m_deque;
     job_queue m_queue;
-    std::atomic<size_t> m_size {0};
+
+    // Counters are only incremented by the thread running this worker,
+    // except for the queue depth. Times are in nanoseconds.
+    std::atomic<uint64_t> m_jobs_executed {0};
+    std::atomic<uint64_t> m_jobs_stolen {0};
+    std::atomic<uint64_t> m_busy_time {0};
+    std::atomic<uint64_t> m_idle_time {0};
+    std::atomic<size_t> m_max_queue_depth {0};
 };
 
 }
@@ -2,13 +2,20 @@
 #define EDYN_REPLICATION_ENTITY_MAP_HPP
 
 #include "edyn/config/config.h"
-#include <unordered_map>
-#include <entt/entity/fwd.hpp>
+#include <array>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <entt/entity/entity.hpp>
 
 namespace edyn {
 
 /**
- * @brief Maps between remote and local entities and vice-versa.
+ * @brief Maps between remote and local entities and vice-versa. Both
+ * directions are sparse arrays indexed by the entity identifier, which point
+ * into packed arrays of entity pairs, thus mapping takes constant time
+ * without hashing. Since the packed arrays hold the full entities, an entity
+ * whose identifier is present with another version is not found.
  */
 class entity_map {
 public:
@@ -18,10 +25,14 @@ public:
      * @param local Local entity.
      */
     void insert(entt::entity entity, entt::entity local) {
-        EDYN_ASSERT(!map.count(entity));
-        EDYN_ASSERT(!map_local.count(local));
-        map[entity] = local;
-        map_local[local] = entity;
+        EDYN_ASSERT(entity != entt::null && local != entt::null);
+        EDYN_ASSERT(!contains(entity));
+        EDYN_ASSERT(!contains_local(local));
+        auto index = static_cast<index_type>(m_packed[m_remote].size());
+        m_packed[m_remote].push_back(entity);
+        m_packed[local_side()].push_back(local);
+        assure(m_sparse[m_remote], entity) = index + 1;
+        assure(m_sparse[local_side()], local) = index + 1;
     }
 
     /**
@@ -29,9 +40,9 @@ public:
      * @param entity Remote entity.
      */
     void erase(entt::entity entity) {
-        auto local = map.at(entity);
-        map.erase(entity);
-        map_local.erase(local);
+        auto index = find(m_remote, entity);
+        EDYN_ASSERT(index != npos);
+        erase_at(index);
     }
 
     /**
@@ -39,9 +50,9 @@ public:
      * @param local Local entity.
      */
     void erase_local(entt::entity local) {
-        auto entity = map_local.at(local);
-        map.erase(entity);
-        map_local.erase(local);
+        auto index = find(local_side(), local);
+        EDYN_ASSERT(index != npos);
+        erase_at(index);
     }
 
     /**
@@ -50,7 +61,7 @@ public:
      * @return Whether map contains given remote entity.
      */
     bool contains(entt::entity entity) const {
-        return map.count(entity) > 0;
+        return find(m_remote, entity) != npos;
     }
 
     /**
@@ -59,7 +70,7 @@ public:
      * @return Whether map contains given local entity.
      */
     bool contains_local(entt::entity local) const {
-        return map_local.count(local) > 0;
+        return find(local_side(), local) != npos;
     }
 
     /**
@@ -68,7 +79,9 @@ public:
      * @return Corresponding local entity.
      */
     entt::entity at(entt::entity entity) const {
-        return map.at(entity);
+        auto index = find(m_remote, entity);
+        EDYN_ASSERT(index != npos);
+        return m_packed[local_side()][index];
     }
 
     /**
@@ -77,7 +90,9 @@ public:
      * @return Corresponding remote entity.
      */
     entt::entity at_local(entt::entity local) const {
-        return map_local.at(local);
+        auto index = find(local_side(), local);
+        EDYN_ASSERT(index != npos);
+        return m_packed[m_remote][index];
     }
 
     /**
@@ -88,12 +103,13 @@ public:
      */
     template<typename Predicate>
     void erase_if(Predicate predicate) {
-        for (auto it = map.begin(); it != map.end();) {
-            if (predicate(it->first, it->second)) {
-                map_local.erase(it->second);
-                it = map.erase(it);
-            } else {
-                ++it;
+        // Iterate backwards since erasing moves the last pair into the slot
+        // of the erased pair.
+        for (auto i = m_packed[m_remote].size(); i > 0; --i) {
+            auto index = static_cast<index_type>(i - 1);
+
+            if (predicate(m_packed[m_remote][index], m_packed[local_side()][index])) {
+                erase_at(index);
             }
         }
     }
@@ -105,8 +121,11 @@ public:
      */
     template<typename Func>
     void each(Func func) const {
-        for (auto it = map.begin(); it != map.end(); ++it) {
-            func(it->first, it->second);
+        auto &remote = m_packed[m_remote];
+        auto &local = m_packed[local_side()];
+
+        for (size_t i = 0; i < remote.size(); ++i) {
+            func(remote[i], local[i]);
         }
     }
 
@@ -114,17 +133,80 @@ public:
      * @brief Swaps remote and local entities.
      */
     void swap() {
-        std::swap(map, map_local);
+        m_remote = local_side();
     }
 
     void clear() {
-        map.clear();
-        map_local.clear();
+        for (auto side : {0, 1}) {
+            m_sparse[side].clear();
+            m_packed[side].clear();
+        }
+    }
+
+    size_t size() const {
+        return m_packed[0].size();
+    }
+
+    bool empty() const {
+        return m_packed[0].empty();
     }
 
 private:
-    std::unordered_map<entt::entity, entt::entity> map;
-    std::unordered_map<entt::entity, entt::entity> map_local;
+    // Indices into the packed arrays are offset by one in the sparse arrays,
+    // where zero means not present.
+    using index_type = uint32_t;
+    static constexpr index_type npos = ~index_type{0};
+
+    unsigned local_side() const {
+        return m_remote ^ 1u;
+    }
+
+    static index_type & assure(std::vector<index_type> &sparse, entt::entity entity) {
+        auto id = static_cast<size_t>(entt::to_entity(entity));
+
+        if (id >= sparse.size()) {
+            sparse.resize(id + 1, 0);
+        }
+
+        return sparse[id];
+    }
+
+    index_type find(unsigned side, entt::entity entity) const {
+        auto id = static_cast<size_t>(entt::to_entity(entity));
+        auto &sparse = m_sparse[side];
+
+        if (id >= sparse.size() || sparse[id] == 0) {
+            return npos;
+        }
+
+        auto index = sparse[id] - 1;
+
+        // Check version.
+        return m_packed[side][index] == entity ? index : npos;
+    }
+
+    void erase_at(index_type index) {
+        auto last = static_cast<index_type>(m_packed[0].size() - 1);
+
+        for (auto side : {0u, 1u}) {
+            auto &packed = m_packed[side];
+            auto &sparse = m_sparse[side];
+            sparse[static_cast<size_t>(entt::to_entity(packed[index]))] = 0;
+
+            if (index != last) {
+                packed[index] = packed[last];
+                sparse[static_cast<size_t>(entt::to_entity(packed[index]))] = index + 1;
+            }
+
+            packed.pop_back();
+        }
+    }
+
+    // Pairs are stored at the same index in both packed arrays. The roles of
+    // the two sides are swapped by flipping `m_remote`.
+    std::array<std::vector<index_type>, 2> m_sparse;
+    std::array<std::vector<entt::entity>, 2> m_packed;
+    unsigned m_remote {0};
 };
 
 }
@@ -56,8 +56,10 @@ void register_external_components(entt::registry &registry, std::tuple<Actions..
 
     if (auto *ctx = registry.ctx().find<client_network_context>()) {
         auto &settings = registry.ctx().get<edyn::settings>();
-        ctx->extrapolator->set_settings(settings);
-        ctx->extrapolator->set_registry_operation_context(reg_op_ctx);
+        for (auto &extrapolator : ctx->extrapolators) {
+            extrapolator->set_settings(settings);
+            extrapolator->set_registry_operation_context(reg_op_ctx);
+        }
     }
 }
 
@@ -2,11 +2,13 @@
 #define EDYN_REPLICATION_REGISTRY_OPERATION_HPP
 
 #include <entt/core/type_info.hpp>
+#include <algorithm>
 #include <memory>
 #include <type_traits>
 #include <vector>
 #include <entt/entity/registry.hpp>
 #include "edyn/config/config.h"
+#include "edyn/config/memory_resource.hpp"
 #include "edyn/core/entity_pair.hpp"
 #include "edyn/replication/map_child_entity.hpp"
 #include "edyn/replication/entity_map.hpp"
@@ -275,37 +277,50 @@ struct operation_remove : public operation_base {
 /**
  * @brief An operation to replicate contents of one registry into another.
  * It contains an array of buffers which hold the data of each operation.
- * Placement new is used to allocate operation objects into these buffers.
+ * Placement new is used to allocate operation objects into these buffers,
+ * which lays them out contiguously. The buffers can be reused after the
+ * operations are cleared, see `registry_operation_pool`.
  */
 class registry_operation final {
 public:
     static constexpr auto default_block_size{128ul};
-    std::vector<std::vector<uint8_t>> data_blocks;
+    using data_block = resource_vector<uint8_t>;
+    resource_vector<data_block> data_blocks;
     std::vector<operation_base *> operations;
 
     registry_operation() {
-        auto data = std::vector<uint8_t>{};
+        auto data = data_block(data_blocks.get_allocator());
         data.resize(default_block_size);
         data_blocks.emplace_back(std::move(data));
+        track_allocation(default_block_size);
     }
 
-    registry_operation(registry_operation &&other) {
-        data_blocks = std::move(other.data_blocks);
-        operations = std::move(other.operations);
-
-        // Ensure there's always one data block.
-        auto data = std::vector<uint8_t>{};
-        data.resize(default_block_size);
-        other.data_blocks.emplace_back(std::move(data));
+    // Moving does not allocate a data block for the moved-from object, thus
+    // it can't throw, which allows messages containing operations to be
+    // stored inline in message queues. The builder allocates a block once
+    // it needs one.
+    registry_operation(registry_operation &&other) noexcept
+        : data_blocks(std::move(other.data_blocks))
+        , operations(std::move(other.operations))
+    {
+        other.data_blocks.clear();
+        other.operations.clear();
     }
 
-    registry_operation & operator=(registry_operation &&other) {
+    registry_operation & operator=(registry_operation &&other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+
+        for (auto *op : operations) {
+            op->~operation_base();
+        }
+
+        track_deallocation(block_bytes());
         data_blocks = std::move(other.data_blocks);
         operations = std::move(other.operations);
-
-        auto data = std::vector<uint8_t>{};
-        data.resize(default_block_size);
-        other.data_blocks.emplace_back(std::move(data));
+        other.data_blocks.clear();
+        other.operations.clear();
 
         return *this;
     }
@@ -317,8 +332,34 @@ public:
         for (auto *op : operations) {
             op->~operation_base();
         }
+
+        track_deallocation(block_bytes());
     }
 
+    /**
+     * @brief Total size of the data blocks.
+     */
+    size_t block_bytes() const {
+        size_t size = 0;
+
+        for (auto &block : data_blocks) {
+            size += block.size();
+        }
+
+        return size;
+    }
+
+    /**
+     * @brief Total size of the data blocks of all registry operations which
+     * currently exist in the process, including the ones kept in the
+     * `registry_operation_pool`.
+     */
+    static size_t allocated_bytes();
+
+    // Must be called whenever a data block is added to an operation.
+    static void track_allocation(size_t size);
+    static void track_deallocation(size_t size);
+
     template<typename... Func>
     void execute(entt::registry &registry, entity_map &entity_map, Func... func) const {
         for (auto *op : operations) {
@@ -327,6 +368,79 @@ public:
         }
     }
 
+    /**
+     * @brief Executes all operations in order except the replacements, which
+     * are instead collected into `replace_groups`, one group per component
+     * type, in the order they appear. Each group only modifies the pool of
+     * its component, thus different groups can be executed in parallel with
+     * `execute_replace_group` afterwards. The result is the same as executing
+     * all operations in order unless a component is replaced before being
+     * emplaced in the same registry operation, which builders never do.
+     * @param registry Destination registry.
+     * @param entity_map Maps entities of the source registry into `registry`.
+     * @param replace_groups Buffer where the replacements are collected. The
+     * arrays it holds are cleared first and reused between calls.
+     * @param func Callables invoked after each operation which is executed.
+     * @return Number of groups, i.e. of the first arrays in `replace_groups`
+     * which hold replacements.
+     */
+    template<typename... Func>
+    size_t execute_except_replace(entt::registry &registry, entity_map &entity_map,
+                                std::vector<std::vector<operation_base *>> &replace_groups,
+                                Func... func) const {
+        for (auto &group : replace_groups) {
+            group.clear();
+        }
+
+        auto num_groups = size_t{0};
+        auto last_type_id = entt::type_index<void>::value();
+        auto last_group = size_t{0};
+
+        for (auto *op : operations) {
+            if (op->operation_type() != registry_operation_type::replace) {
+                op->execute(registry, entity_map);
+                (func(op), ...);
+                continue;
+            }
+
+            // Replacements usually come in long runs of the same component.
+            auto type_id = op->payload_type_id();
+
+            if (num_groups == 0 || type_id != last_type_id) {
+                auto it = std::find_if(replace_groups.begin(), replace_groups.begin() + num_groups,
+                                       [type_id](auto &group) { return group.front()->payload_type_id() == type_id; });
+                last_group = static_cast<size_t>(it - replace_groups.begin());
+                last_type_id = type_id;
+
+                if (last_group == num_groups) {
+                    if (num_groups == replace_groups.size()) {
+                        replace_groups.emplace_back();
+                    }
+                    ++num_groups;
+                }
+            }
+
+            replace_groups[last_group].push_back(op);
+        }
+
+        return num_groups;
+    }
+
+    /**
+     * @brief Executes a group of replacements collected by
+     * `execute_except_replace`. It's safe to invoke concurrently for
+     * different groups as long as `func` is.
+     */
+    template<typename... Func>
+    static void execute_replace_group(entt::registry &registry, entity_map &entity_map,
+                                      const std::vector<operation_base *> &group, Func... func) {
+        // Replacements only read the entity map.
+        for (auto *op : group) {
+            op->execute(registry, entity_map);
+            (func(op), ...);
+        }
+    }
+
     void execute(entt::registry &registry) const {
         for (auto *op : operations) {
             op->execute(registry);
@@ -342,6 +456,33 @@ public:
     bool empty() const {
         return operations.empty();
     }
+
+    /**
+     * @brief Destroys the operations whose payload is any of the given
+     * component types.
+     */
+    template<typename... Ts>
+    void erase_payload() {
+        auto it = std::remove_if(operations.begin(), operations.end(), [](operation_base *op) {
+            if (op->payload_type_any_of<Ts...>()) {
+                op->~operation_base();
+                return true;
+            }
+            return false;
+        });
+        operations.erase(it, operations.end());
+    }
+
+    /**
+     * @brief Destroys all operations but keeps the memory of the buffers.
+     */
+    void clear() {
+        for (auto *op : operations) {
+            op->~operation_base();
+        }
+
+        operations.clear();
+    }
 };
 
 }
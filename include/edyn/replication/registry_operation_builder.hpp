@@ -6,6 +6,7 @@
 #include <memory>
 #include <entt/entity/registry.hpp>
 #include "edyn/replication/registry_operation.hpp"
+#include "edyn/replication/registry_operation_pool.hpp"
 #include "edyn/util/vector_util.hpp"
 
 namespace edyn {
@@ -22,15 +23,32 @@ class registry_operation_builder {
         constexpr unsigned long size = sizeof(T);
         static_assert(size <= max_block_size, "Component size larger than maximum block size.");
 
-        // Create new data block if current block size would be exceeded.
-        if (m_data_index + size > operation.data_blocks.back().size()) {
-            auto data = std::vector<uint8_t>{};
-            data.resize(std::min(size * data_block_unit_size, max_block_size));
-            operation.data_blocks.emplace_back(std::move(data));
+        static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "Over-aligned operation.");
+
+        auto &blocks = operation.data_blocks;
+
+        // Operations are placed at offsets aligned to their type since
+        // components might be over-aligned, e.g. SIMD vectors.
+        m_data_index = (m_data_index + alignof(T) - 1) & ~(alignof(T) - 1);
+
+        // Move on to the next data block if current block size would be
+        // exceeded. Blocks of recycled operations are reused if large enough.
+        if (blocks.empty() || m_data_index + size > blocks[m_block_index].size()) {
+            if (!blocks.empty()) {
+                ++m_block_index;
+            }
+
             m_data_index = 0;
+
+            if (m_block_index == blocks.size() || blocks[m_block_index].size() < size) {
+                auto data = registry_operation::data_block(blocks.get_allocator());
+                data.resize(std::min(size * data_block_unit_size, max_block_size));
+                registry_operation::track_allocation(data.size());
+                blocks.insert(blocks.begin() + m_block_index, std::move(data));
+            }
         }
 
-        auto buff = &operation.data_blocks.back()[m_data_index];
+        auto buff = &blocks[m_block_index][m_data_index];
         m_data_index += size;
 
         // Use placement new to allocate object in the current buffer.
@@ -100,6 +118,13 @@ public:
         }
     }
 
+    template<typename Component>
+    void emplace(entt::entity entity, const Component &comp) {
+        auto *op = make_op<operation_emplace<Component>>();
+        op->entity = entity;
+        op->component = comp;
+    }
+
     template<typename Component, typename It>
     void replace(It first, It last) {
         auto view = registry->view<Component>();
@@ -167,8 +192,16 @@ public:
         return operation.empty();
     }
 
-    registry_operation && finish() {
-        return std::move(operation);
+    /**
+     * @brief Takes the operations built so far. The builder continues with
+     * the memory of an operation from the pool.
+     */
+    registry_operation finish() {
+        auto ops = std::move(operation);
+        operation = registry_operation_pool::global().acquire();
+        m_block_index = 0;
+        m_data_index = 0;
+        return ops;
     }
 
     entt::registry & get_registry() {
@@ -215,6 +248,7 @@ public:
 protected:
     entt::registry *registry;
     registry_operation operation;
+    size_t m_block_index {};
     size_t m_data_index {};
 };
 
@@ -3,7 +3,14 @@
 
 #include "edyn/comp/tag.hpp"
 #include "edyn/replication/registry_operation_builder.hpp"
+#include "edyn/util/tuple_util.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <tuple>
+#include <vector>
 #include <entt/entity/fwd.hpp>
+#include <entt/entity/entity.hpp>
 #include <entt/signal/sigh.hpp>
 
 namespace edyn {
@@ -35,10 +42,21 @@ public:
         }
     }
 
+    bool is_observed(entt::entity entity) const {
+        return m_observed_entities.contains(entity);
+    }
+
     void set_active(bool active) {
         m_active = active;
     }
 
+    /**
+     * @brief Inserts replacements of all components which were updated since
+     * the last flush into the builder. Must be called before the builder is
+     * finished.
+     */
+    virtual void flush() = 0;
+
 protected:
     registry_operation_builder *m_builder;
     entt::sparse_set m_observed_entities;
@@ -46,6 +64,80 @@ protected:
     bool m_active;
 };
 
+/**
+ * @brief Set of entities whose component was updated, with one bit per entity
+ * identifier, thus checking whether an entity is already in the set doesn't
+ * touch anything but a word of the bitset.
+ */
+class dirty_entity_set {
+public:
+    // Returns whether the entity was not in the set already.
+    bool insert(entt::entity entity) {
+        auto [word, mask] = locate(entity);
+
+        if (word >= m_bits.size()) {
+            m_bits.resize(word + 1);
+        }
+
+        if (m_bits[word] & mask) {
+            return false;
+        }
+
+        m_bits[word] |= mask;
+        m_entities.push_back(entity);
+        return true;
+    }
+
+    void erase(entt::entity entity) {
+        // The entity stays in the array until the next flush, where it's
+        // skipped since its bit is not set.
+        if (auto [word, mask] = locate(entity); word < m_bits.size()) {
+            m_bits[word] &= ~mask;
+        }
+    }
+
+    /**
+     * @brief Empties the set and moves the entities which were in it and for
+     * which `pred` returns true to the front of the array of entities, in the
+     * order they were inserted.
+     * @return One past the last entity for which `pred` returned true.
+     */
+    template<typename Predicate>
+    std::vector<entt::entity>::iterator take(Predicate pred) {
+        auto last = std::remove_if(m_entities.begin(), m_entities.end(), [&](entt::entity entity) {
+            auto [word, mask] = locate(entity);
+            auto contained = (m_bits[word] & mask) != 0;
+            m_bits[word] &= ~mask;
+            return !contained || !pred(entity);
+        });
+
+        return last;
+    }
+
+    auto begin() { return m_entities.begin(); }
+
+    void clear_entities() {
+        m_entities.clear();
+    }
+
+private:
+    static std::pair<size_t, uint64_t> locate(entt::entity entity) {
+        auto index = static_cast<size_t>(entt::to_entity(entity));
+        return {index / 64, uint64_t{1} << (index % 64)};
+    }
+
+    std::vector<uint64_t> m_bits;
+    std::vector<entt::entity> m_entities;
+};
+
+/**
+ * @brief Observes changes to the given components in the observed entities
+ * and inserts the corresponding operations into the builder. Constructions
+ * and destructions are inserted right away, while updates only mark the
+ * entity in the dirty set of the component. The replacements are gathered
+ * in bulk in `flush`, once per entity and component regardless of how many
+ * times it was patched, with the values the components have at that time.
+ */
 template<typename... Components>
 class registry_operation_observer_impl : public registry_operation_observer {
     template<typename Component>
@@ -58,17 +150,41 @@ class registry_operation_observer_impl : public registry_operation_observer {
     template<typename Component>
     void on_update(entt::registry &registry, entt::entity entity) {
         if (m_active && m_observed_entities.contains(entity)) {
-            m_builder->replace<Component>(entity);
+            dirty_set<Component>().insert(entity);
         }
     }
 
     template<typename Component>
     void on_destroy(entt::registry &registry, entt::entity entity) {
+        // An update made before the component was removed must not be
+        // replicated. This also clears the bit of destroyed entities, whose
+        // identifier could be recycled.
+        dirty_set<Component>().erase(entity);
+
         if (m_active && m_observed_entities.contains(entity)) {
             m_builder->remove<Component>(entity);
         }
     }
 
+    template<typename Component>
+    dirty_entity_set & dirty_set() {
+        return m_dirty_sets[index_of_v<size_t, Component, Components...>];
+    }
+
+    template<typename Component>
+    void flush_component(entt::registry &registry) {
+        auto &dirty = dirty_set<Component>();
+        auto last = dirty.take([&](entt::entity entity) {
+            return m_observed_entities.contains(entity) && registry.all_of<Component>(entity);
+        });
+
+        if constexpr(!std::is_empty_v<Component>) {
+            m_builder->replace<Component>(dirty.begin(), last);
+        }
+
+        dirty.clear_entities();
+    }
+
 public:
     registry_operation_observer_impl(registry_operation_builder &builder, [[maybe_unused]] std::tuple<Components...>)
         : registry_operation_observer(builder)
@@ -80,8 +196,15 @@ public:
     }
 
     virtual ~registry_operation_observer_impl() {}
-};
 
+    void flush() override {
+        auto &registry = m_builder->get_registry();
+        (flush_component<Components>(registry), ...);
+    }
+
+private:
+    std::array<dirty_entity_set, sizeof...(Components)> m_dirty_sets;
+};
 }
 
 #endif // EDYN_REPLICATION_REGISTRY_OPERATION_OBSERVER_HPP
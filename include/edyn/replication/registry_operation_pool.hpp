@@ -0,0 +1,49 @@
+#ifndef EDYN_REPLICATION_REGISTRY_OPERATION_POOL_HPP
+#define EDYN_REPLICATION_REGISTRY_OPERATION_POOL_HPP
+
+#include <mutex>
+#include <vector>
+#include "edyn/replication/registry_operation.hpp"
+
+namespace edyn {
+
+/**
+ * Keeps the memory of registry operations which were executed, to be reused
+ * by builders on either side of a message queue. Once all operations in
+ * flight have been recycled, building and sending operations does not
+ * allocate memory anymore, unless components themselves allocate when copied.
+ */
+class registry_operation_pool {
+    // Upper bound on the number of operations kept, which should be around
+    // the number of operations in flight at once.
+    static constexpr size_t max_pooled = 16;
+
+public:
+    static registry_operation_pool &global();
+
+    /**
+     * @brief Takes an operation from the pool, which reuses the memory of
+     * an operation executed before, or a new one if the pool is empty.
+     */
+    registry_operation acquire();
+
+    /**
+     * @brief Returns an operation which is not needed anymore, e.g. after
+     * being executed, to the pool. Its operations are destroyed but its
+     * memory is kept.
+     */
+    void release(registry_operation &&ops);
+
+    /**
+     * @brief Total size of the data blocks of the operations in the pool.
+     */
+    size_t pooled_bytes() const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<registry_operation> m_operations;
+};
+
+}
+
+#endif // EDYN_REPLICATION_REGISTRY_OPERATION_POOL_HPP
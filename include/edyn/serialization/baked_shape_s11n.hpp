@@ -0,0 +1,117 @@
+#ifndef EDYN_SERIALIZATION_BAKED_SHAPE_S11N_HPP
+#define EDYN_SERIALIZATION_BAKED_SHAPE_S11N_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "edyn/shapes/compound_shape.hpp"
+#include "edyn/shapes/triangle_mesh.hpp"
+#include "edyn/util/shape_io.hpp"
+
+namespace edyn {
+
+/**
+ * Header at the start of a baked shape file, which contains shapes with all
+ * of their calculated properties, i.e. normals, edges, adjacency and trees,
+ * thus loading them involves no processing besides copying the arrays out
+ * of the memory mapped file, or none at all for triangle meshes which refer
+ * to the mapped file directly. Data is stored with the byte order of the
+ * platform that wrote the file. Shapes are usually baked from *.obj files
+ * offline with the `edyn_shape_baker` tool.
+ */
+struct baked_shape_header {
+    uint32_t magic;
+    uint32_t version;
+    // Must match `sizeof(scalar)` when reading.
+    uint32_t scalar_size;
+    uint32_t alignment;
+    uint32_t kind;
+    uint32_t count;
+};
+
+enum class baked_shape_kind : uint32_t {
+    triangle_mesh,
+    convex_polyhedrons
+};
+
+// "EDBS" in little endian.
+inline constexpr uint32_t baked_shape_magic = 0x53424445;
+inline constexpr uint32_t baked_shape_version = 2;
+
+/**
+ * @brief Writes an initialized triangle mesh to a baked shape file.
+ * @param path Path to file.
+ * @param trimesh The triangle mesh, after `triangle_mesh::initialize`.
+ * @return Whether the file was written successfully.
+ */
+bool write_baked_triangle_mesh(const std::string &path, triangle_mesh &trimesh);
+
+/**
+ * @brief Loads a triangle mesh from a baked shape file, ready to be used in
+ * a `mesh_shape`.
+ * @param path Path to file.
+ * @return The triangle mesh or null if the file could not be read, has a
+ * different version or was written with a different scalar type.
+ */
+std::shared_ptr<triangle_mesh> load_baked_triangle_mesh(const std::string &path);
+
+/**
+ * @brief Creates a triangle mesh which refers to the arrays in a baked shape
+ * file in memory instead of copying them, thus it takes no time to load and
+ * no memory besides the blob itself, other than for the convexity and
+ * boundary flags of the edges, which are unpacked. The triangle tree is used
+ * as stored. The mesh is a view, which can't be initialized or compressed.
+ * @param data Contents of a file written by `write_baked_triangle_mesh`. It
+ * should be aligned to `mapped_archive_alignment`, otherwise arrays which are
+ * misaligned for their type are copied.
+ * @param size Size of the data.
+ * @param owner Optional owner of the data, which is kept alive as long as the
+ * mesh is. Otherwise, the data must outlive the mesh. Copies of the mesh
+ * object refer to the same data and aren't covered by this.
+ * @return The triangle mesh or null if the data is invalid, has a different
+ * version or was written with a different scalar type.
+ */
+std::shared_ptr<triangle_mesh> view_baked_triangle_mesh(const uint8_t *data, size_t size,
+                                                        std::shared_ptr<const void> owner = {});
+
+/**
+ * @brief Maps a baked shape file into memory and creates a triangle mesh
+ * which refers to it with `view_baked_triangle_mesh`. The file stays mapped
+ * as long as the mesh is referenced. The operating system loads the pages of
+ * the file as they're accessed and shares them between processes.
+ * @param path Path to file.
+ * @return The triangle mesh or null if the file could not be read.
+ */
+std::shared_ptr<triangle_mesh> map_baked_triangle_mesh(const std::string &path);
+
+/**
+ * @brief Writes convex polyhedrons, such as the ones returned by
+ * `load_convex_polyhedrons_from_obj`, to a baked shape file.
+ * @param path Path to file.
+ * @param polyhedrons The polyhedrons with their centroids.
+ * @return Whether the file was written successfully.
+ */
+bool write_baked_convex_polyhedrons(const std::string &path,
+                                    std::vector<polyhedron_with_center> &polyhedrons);
+
+/**
+ * @brief Loads convex polyhedrons from a baked shape file.
+ * @param path Path to file.
+ * @return The polyhedrons with their centroids or an empty array if the file
+ * could not be read.
+ */
+std::vector<polyhedron_with_center> load_baked_convex_polyhedrons(const std::string &path);
+
+/**
+ * @brief Loads a compound shape from a baked file of convex polyhedrons, as
+ * a faster equivalent of `load_compound_shape_from_obj`. Only the tree of the
+ * compound shape is built.
+ * @param path Path to file.
+ * @return Compound shape, which is empty if the file could not be read.
+ */
+compound_shape load_baked_compound_shape(const std::string &path);
+
+}
+
+#endif // EDYN_SERIALIZATION_BAKED_SHAPE_S11N_HPP
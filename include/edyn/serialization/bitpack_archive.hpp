@@ -0,0 +1,255 @@
+#ifndef EDYN_SERIALIZATION_BITPACK_ARCHIVE_HPP
+#define EDYN_SERIALIZATION_BITPACK_ARCHIVE_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+#include "edyn/config/config.h"
+#include "edyn/math/scalar.hpp"
+#include "edyn/serialization/s11n_util.hpp"
+
+namespace edyn {
+
+namespace detail {
+    // Number of bits needed to quantize the range `[min, max]` in steps of
+    // `precision`.
+    inline unsigned bitpack_quantized_num_bits(scalar min, scalar max, scalar precision) {
+        EDYN_ASSERT(max > min && precision > 0);
+        auto num_steps = std::ceil((max - min) / precision);
+        auto num_bits = unsigned{1};
+
+        while (num_bits < 32 && scalar(uint64_t(1) << num_bits) <= num_steps) {
+            ++num_bits;
+        }
+
+        return num_bits;
+    }
+
+    template<typename T>
+    using bitpack_uint_t = std::conditional_t<sizeof(T) <= 4, uint32_t, uint64_t>;
+}
+
+/**
+ * Reads data written by a `bitpack_output_archive`.
+ */
+class bitpack_input_archive {
+public:
+    using data_type = uint8_t;
+    using buffer_type = const data_type*;
+    using is_input = std::true_type;
+    using is_output = std::false_type;
+
+    bitpack_input_archive(buffer_type buffer, size_t size)
+        : m_buffer(buffer)
+        , m_size(size)
+        , m_bit_position(0)
+        , m_failed(false)
+    {}
+
+    template<typename T>
+    void operator()(T& t) {
+        if constexpr(std::is_same_v<T, bool>) {
+            t = read_bits(1) != 0;
+        } else if constexpr(std::is_integral_v<T> && sizeof(T) == 1) {
+            t = static_cast<T>(read_bits(8));
+        } else if constexpr(std::is_integral_v<T> && std::is_unsigned_v<T>) {
+            t = static_cast<T>(read_varint());
+        } else if constexpr(std::is_integral_v<T>) {
+            // Zigzag decoding.
+            auto u = read_varint();
+            t = static_cast<T>(static_cast<int64_t>(u >> 1) ^ -static_cast<int64_t>(u & 1));
+        } else if constexpr(std::is_floating_point_v<T>) {
+            using uint_type = detail::bitpack_uint_t<T>;
+            auto u = static_cast<uint_type>(read_bits(sizeof(T) * 8));
+            std::memcpy(&t, &u, sizeof(T));
+        } else if constexpr(!std::is_empty_v<T>) {
+            serialize(*this, t);
+        }
+    }
+
+    template<typename... Ts>
+    void operator()(Ts&... t) {
+        (operator()(t), ...);
+    }
+
+    template<typename T>
+    void read_array(T *data, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            operator()(data[i]);
+        }
+    }
+
+    /**
+     * @brief Reads an unsigned integer stored in the given number of bits.
+     */
+    uint64_t read_bits(unsigned num_bits) {
+        EDYN_ASSERT(num_bits <= 64);
+
+        if (m_failed) return 0;
+
+        if (num_bits > m_size * 8 - m_bit_position) {
+            m_failed = true;
+            return 0;
+        }
+
+        auto value = uint64_t{0};
+        auto shift = unsigned{0};
+
+        while (shift < num_bits) {
+            auto byte_index = m_bit_position / 8;
+            auto bit_offset = unsigned(m_bit_position % 8);
+            auto count = std::min(8 - bit_offset, num_bits - shift);
+            auto bits = (uint64_t(m_buffer[byte_index]) >> bit_offset) & ((uint64_t(1) << count) - 1);
+            value |= bits << shift;
+            shift += count;
+            m_bit_position += count;
+        }
+
+        return value;
+    }
+
+    uint64_t read_varint() {
+        auto value = uint64_t{0};
+
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            auto group = read_bits(8);
+            value |= (group & 0x7f) << shift;
+
+            if ((group & 0x80) == 0) {
+                break;
+            }
+        }
+
+        return value;
+    }
+
+    scalar read_quantized(scalar min, scalar max, scalar precision) {
+        auto q = read_bits(detail::bitpack_quantized_num_bits(min, max, precision));
+        return std::min(min + scalar(q) * precision, max);
+    }
+
+    bool failed() const {
+        return m_failed;
+    }
+
+    bool eof() const {
+        return (m_bit_position + 7) / 8 == m_size;
+    }
+
+private:
+    buffer_type m_buffer;
+    size_t m_size;
+    size_t m_bit_position;
+    bool m_failed;
+};
+
+/**
+ * Writes data in a compact form for network transmission, appending to a
+ * buffer. Booleans take one bit, integers wider than one byte are stored as
+ * variable length integers, where negative values are zigzag encoded, and
+ * values are not aligned to byte boundaries. Scalars can be quantized in
+ * the serialization function of a component using `serialize_quantized`,
+ * which has no effect with other archives.
+ */
+class bitpack_output_archive {
+public:
+    using data_type = uint8_t;
+    using buffer_type = std::vector<data_type>;
+    using is_input = std::false_type;
+    using is_output = std::true_type;
+
+    bitpack_output_archive(buffer_type& buffer)
+        : m_buffer(&buffer)
+        , m_bit_position(buffer.size() * 8)
+    {}
+
+    template<typename T>
+    void operator()(T& t) {
+        if constexpr(std::is_same_v<T, bool>) {
+            write_bits(t ? 1 : 0, 1);
+        } else if constexpr(std::is_integral_v<T> && sizeof(T) == 1) {
+            write_bits(static_cast<uint8_t>(t), 8);
+        } else if constexpr(std::is_integral_v<T> && std::is_unsigned_v<T>) {
+            write_varint(t);
+        } else if constexpr(std::is_integral_v<T>) {
+            // Zigzag encoding keeps small negative values small.
+            auto i = static_cast<int64_t>(t);
+            write_varint((static_cast<uint64_t>(i) << 1) ^ static_cast<uint64_t>(i >> 63));
+        } else if constexpr(std::is_floating_point_v<T>) {
+            using uint_type = detail::bitpack_uint_t<T>;
+            uint_type u;
+            std::memcpy(&u, &t, sizeof(T));
+            write_bits(u, sizeof(T) * 8);
+        } else if constexpr(!std::is_empty_v<T>) {
+            serialize(*this, t);
+        }
+    }
+
+    template<typename T>
+    void operator()(const T& t) {
+        operator()(const_cast<T &>(t));
+    }
+
+    template<typename... Ts>
+    void operator()(Ts&... t) {
+        (operator()(t), ...);
+    }
+
+    template<typename T>
+    void write_array(const T *data, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            operator()(data[i]);
+        }
+    }
+
+    /**
+     * @brief Writes the lower `num_bits` bits of an unsigned integer.
+     */
+    void write_bits(uint64_t value, unsigned num_bits) {
+        EDYN_ASSERT(num_bits <= 64);
+        m_buffer->resize((m_bit_position + num_bits + 7) / 8);
+        auto shift = unsigned{0};
+
+        while (shift < num_bits) {
+            auto byte_index = m_bit_position / 8;
+            auto bit_offset = unsigned(m_bit_position % 8);
+            auto count = std::min(8 - bit_offset, num_bits - shift);
+            auto bits = (value >> shift) & ((uint64_t(1) << count) - 1);
+            (*m_buffer)[byte_index] |= static_cast<data_type>(bits << bit_offset);
+            shift += count;
+            m_bit_position += count;
+        }
+    }
+
+    void write_varint(uint64_t value) {
+        do {
+            auto group = value & 0x7f;
+            value >>= 7;
+            write_bits(value != 0 ? group | 0x80 : group, 8);
+        } while (value != 0);
+    }
+
+    void write_quantized(scalar value, scalar min, scalar max, scalar precision) {
+        auto num_bits = detail::bitpack_quantized_num_bits(min, max, precision);
+        auto q = std::round((std::clamp(value, min, max) - min) / precision);
+        write_bits(static_cast<uint64_t>(q), num_bits);
+    }
+
+private:
+    buffer_type *m_buffer;
+    size_t m_bit_position;
+};
+
+template<>
+struct is_bitpack_archive<bitpack_input_archive> : std::true_type {};
+
+template<>
+struct is_bitpack_archive<bitpack_output_archive> : std::true_type {};
+
+}
+
+#endif // EDYN_SERIALIZATION_BITPACK_ARCHIVE_HPP
@@ -0,0 +1,47 @@
+#ifndef EDYN_SERIALIZATION_COMPACT_STATIC_TREE_S11N_HPP
+#define EDYN_SERIALIZATION_COMPACT_STATIC_TREE_S11N_HPP
+
+#include "edyn/collision/compact_static_tree.hpp"
+#include "edyn/serialization/math_s11n.hpp"
+#include "edyn/serialization/std_s11n.hpp"
+#include "edyn/serialization/mapped_vector_s11n.hpp"
+
+namespace edyn {
+
+template<typename Archive>
+void serialize(Archive &archive, compact_tree_node &node) {
+    for (unsigned k = 0; k < compact_tree_width; ++k) {
+        archive(node.min_x[k], node.min_y[k], node.min_z[k]);
+        archive(node.max_x[k], node.max_y[k], node.max_z[k]);
+        archive(node.child[k]);
+    }
+}
+
+template<typename Archive>
+void serialize(Archive &archive, compact_static_tree::leaf &leaf) {
+    archive(leaf.first);
+    archive(leaf.count);
+}
+
+template<typename Archive>
+void serialize(Archive &archive, compact_static_tree &tree) {
+    archive(tree.m_root_aabb.min);
+    archive(tree.m_root_aabb.max);
+    archive(tree.m_nodes);
+    archive(tree.m_leaves);
+    archive(tree.m_ids);
+}
+
+inline
+size_t serialization_sizeof(const compact_static_tree &tree) {
+    return
+        sizeof(tree.m_root_aabb.min) +
+        sizeof(tree.m_root_aabb.max) +
+        serialization_sizeof(tree.m_nodes) +
+        serialization_sizeof(tree.m_leaves) +
+        serialization_sizeof(tree.m_ids);
+}
+
+}
+
+#endif // EDYN_SERIALIZATION_COMPACT_STATIC_TREE_S11N_HPP
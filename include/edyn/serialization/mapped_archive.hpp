@@ -0,0 +1,227 @@
+#ifndef EDYN_SERIALIZATION_MAPPED_ARCHIVE_HPP
+#define EDYN_SERIALIZATION_MAPPED_ARCHIVE_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "edyn/core/mapped_vector.hpp"
+#include "edyn/serialization/s11n_util.hpp"
+
+namespace edyn {
+
+// Alignment of arrays in a buffer written by a `mapped_output_archive`,
+// relative to the start of the buffer. If the buffer is placed at an aligned
+// offset in a file that is memory mapped, the arrays are aligned in memory.
+inline constexpr size_t mapped_archive_alignment = 64;
+
+namespace detail {
+    template<typename T>
+    struct is_mapped_archive_vector : std::false_type {};
+
+    template<typename T, typename Allocator>
+    struct is_mapped_archive_vector<std::vector<T, Allocator>> : std::true_type {};
+
+    template<typename T>
+    struct is_mapped_archive_vector<mapped_vector<T>> : std::true_type {};
+
+    inline size_t mapped_archive_align(size_t position) {
+        return (position + mapped_archive_alignment - 1) & ~(mapped_archive_alignment - 1);
+    }
+}
+
+/**
+ * Reads data written by a `mapped_output_archive`, usually from a region of
+ * a memory mapped file. Vectors of trivially copyable types are read with a
+ * single copy of their memory instead of one element at a time and their
+ * size is not limited. If borrowing, a `mapped_vector` of a trivially
+ * copyable type becomes a view of its elements in the buffer instead, unless
+ * they're misaligned for their type, thus the buffer must outlive it.
+ */
+class mapped_input_archive {
+public:
+    using data_type = uint8_t;
+    using buffer_type = const data_type*;
+    using is_input = std::true_type;
+    using is_output = std::false_type;
+
+    mapped_input_archive(buffer_type buffer, size_t size, bool borrow = false)
+        : m_buffer(buffer)
+        , m_size(size)
+        , m_position(0)
+        , m_failed(false)
+        , m_borrow(borrow)
+    {}
+
+    template<typename T>
+    void operator()(T& t) {
+        if constexpr(std::is_fundamental_v<T>) {
+            read_bytes(&t, sizeof(T));
+        } else if constexpr(detail::is_mapped_archive_vector<T>::value) {
+            read_vector(t);
+        } else if constexpr(!std::is_empty_v<T>) {
+            serialize(*this, t);
+        }
+    }
+
+    template<typename... Ts>
+    void operator()(Ts&... t) {
+        (operator()(t), ...);
+    }
+
+    bool failed() const {
+        return m_failed;
+    }
+
+    size_t tell_position() const {
+        return m_position;
+    }
+
+    size_t remaining_size() const {
+        return m_size - m_position;
+    }
+
+private:
+    void read_bytes(void *dest, size_t size) {
+        if (m_failed || size == 0) return;
+
+        if (size > m_size - m_position) {
+            m_failed = true;
+            return;
+        }
+
+        std::memcpy(dest, m_buffer + m_position, size);
+        m_position += size;
+    }
+
+    template<typename Vector>
+    void read_vector(Vector &vector) {
+        using T = typename Vector::value_type;
+        uint64_t size {};
+        read_bytes(&size, sizeof(size));
+
+        if (m_failed) return;
+
+        m_position = std::min(detail::mapped_archive_align(m_position), m_size);
+
+        if constexpr(std::is_same_v<T, bool>) {
+            if (size > m_size - m_position) {
+                m_failed = true;
+                return;
+            }
+
+            auto *data = m_buffer + m_position;
+            vector.assign(data, data + size);
+            m_position += size;
+        } else if constexpr(std::is_trivially_copyable_v<T>) {
+            if (size > (m_size - m_position) / sizeof(T)) {
+                m_failed = true;
+                return;
+            }
+
+            if constexpr(std::is_same_v<Vector, mapped_vector<T>>) {
+                auto *data = m_buffer + m_position;
+
+                if (m_borrow && size > 0 && reinterpret_cast<uintptr_t>(data) % alignof(T) == 0) {
+                    vector.assign_view(reinterpret_cast<const T *>(data), size);
+                    m_position += size * sizeof(T);
+                    return;
+                }
+
+                // Might be a view, which can't be resized.
+                vector.clear();
+            }
+
+            vector.resize(size);
+            read_bytes(vector.data(), size * sizeof(T));
+        } else {
+            vector.resize(size);
+
+            for (size_t i = 0; i < size; ++i) {
+                operator()(vector[i]);
+            }
+        }
+    }
+
+    buffer_type m_buffer;
+    size_t m_size;
+    size_t m_position;
+    bool m_failed;
+    bool m_borrow;
+};
+
+/**
+ * Writes data to a buffer in a format which can be read efficiently with a
+ * `mapped_input_archive`. Vectors of trivially copyable types are stored
+ * with a 64 bit size followed by their memory, aligned to
+ * `mapped_archive_alignment`. Data is stored with the byte order of the
+ * platform.
+ */
+class mapped_output_archive {
+public:
+    using data_type = uint8_t;
+    using buffer_type = std::vector<data_type>;
+    using is_input = std::false_type;
+    using is_output = std::true_type;
+
+    mapped_output_archive(buffer_type& buffer)
+        : m_buffer(&buffer)
+    {}
+
+    template<typename T>
+    void operator()(T& t) {
+        if constexpr(std::is_fundamental_v<T>) {
+            write_bytes(&t, sizeof(T));
+        } else if constexpr(detail::is_mapped_archive_vector<T>::value) {
+            write_vector(t);
+        } else if constexpr(!std::is_empty_v<T>) {
+            serialize(*this, t);
+        }
+    }
+
+    template<typename... Ts>
+    void operator()(Ts&... t) {
+        (operator()(t), ...);
+    }
+
+private:
+    void write_bytes(const void *src, size_t size) {
+        if (size == 0) return;
+
+        auto idx = m_buffer->size();
+        m_buffer->resize(idx + size);
+        std::memcpy(m_buffer->data() + idx, src, size);
+    }
+
+    template<typename Vector>
+    void write_vector(Vector &vector) {
+        using T = typename Vector::value_type;
+        auto size = static_cast<uint64_t>(vector.size());
+        write_bytes(&size, sizeof(size));
+        m_buffer->resize(detail::mapped_archive_align(m_buffer->size()));
+
+        if constexpr(std::is_same_v<T, bool>) {
+            for (bool value : vector) {
+                m_buffer->push_back(static_cast<data_type>(value));
+            }
+        } else if constexpr(std::is_trivially_copyable_v<T>) {
+            write_bytes(std::as_const(vector).data(), vector.size() * sizeof(T));
+        } else {
+            static_assert(!std::is_same_v<Vector, mapped_vector<T>>,
+                          "Elements of a mapped vector must be trivially copyable.");
+
+            for (auto &value : vector) {
+                operator()(value);
+            }
+        }
+    }
+
+    buffer_type *m_buffer;
+};
+
+}
+
+#endif // EDYN_SERIALIZATION_MAPPED_ARCHIVE_HPP
@@ -0,0 +1,56 @@
+#ifndef EDYN_SERIALIZATION_MAPPED_FILE_HPP
+#define EDYN_SERIALIZATION_MAPPED_FILE_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace edyn {
+
+/**
+ * @brief A file mapped into memory for reading. The contents are loaded by
+ * the operating system as they're accessed and the memory is shared with
+ * other processes and other mappings of the same file.
+ */
+class mapped_file {
+public:
+    mapped_file() = default;
+    mapped_file(const std::string &path);
+    ~mapped_file();
+
+    mapped_file(const mapped_file &) = delete;
+    mapped_file & operator=(const mapped_file &) = delete;
+
+    /**
+     * @brief Maps a file into memory.
+     * @param path Path to file.
+     * @return Whether the file was mapped successfully.
+     */
+    bool open(const std::string &path);
+
+    void close();
+
+    bool is_open() const {
+        return m_data != nullptr;
+    }
+
+    const uint8_t * data() const {
+        return m_data;
+    }
+
+    size_t size() const {
+        return m_size;
+    }
+
+private:
+    const uint8_t *m_data {nullptr};
+    size_t m_size {0};
+#if defined(_WIN32)
+    void *m_file_handle {nullptr};
+    void *m_mapping_handle {nullptr};
+#endif
+};
+
+}
+
+#endif // EDYN_SERIALIZATION_MAPPED_FILE_HPP
@@ -0,0 +1,42 @@
+#ifndef EDYN_SERIALIZATION_MAPPED_VECTOR_S11N_HPP
+#define EDYN_SERIALIZATION_MAPPED_VECTOR_S11N_HPP
+
+#include <limits>
+#include <utility>
+#include <cstdint>
+#include <algorithm>
+#include "edyn/core/mapped_vector.hpp"
+
+namespace edyn {
+
+// Same format as a `std::vector`. Reading always makes an owning array.
+template<typename Archive, typename T>
+void serialize(Archive &archive, mapped_vector<T> &vector) {
+    using size_type = uint16_t;
+    size_type size = std::min(vector.size(), static_cast<size_t>(std::numeric_limits<size_type>::max()));
+    archive(size);
+
+    if constexpr(Archive::is_input::value) {
+        vector.clear();
+        vector.resize(size);
+
+        for (size_t i = 0; i < size; ++i) {
+            archive(vector[i]);
+        }
+    } else {
+        // Elements of a view can't be referenced as mutable.
+        for (size_t i = 0; i < size; ++i) {
+            auto value = std::as_const(vector)[i];
+            archive(value);
+        }
+    }
+}
+
+template<typename T>
+size_t serialization_sizeof(const mapped_vector<T> &vec) {
+    return sizeof(size_t) + vec.size() * sizeof(T);
+}
+
+}
+
+#endif // EDYN_SERIALIZATION_MAPPED_VECTOR_S11N_HPP
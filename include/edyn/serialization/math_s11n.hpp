@@ -18,6 +18,13 @@ void serialize(Archive &archive, quaternion &q) {
     archive(q.x, q.y, q.z, q.w);
 }
 
+// Not bitwise when padded for SIMD.
+template<>
+struct is_bitwise_serializable<vector3> : std::bool_constant<sizeof(vector3) == 3 * sizeof(scalar)> {};
+
+template<>
+struct is_bitwise_serializable<quaternion> : std::bool_constant<sizeof(quaternion) == 4 * sizeof(scalar)> {};
+
 template<typename Archive>
 void serialize(Archive &archive, matrix3x3 &m) {
     archive(m.row);
@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
 #include <type_traits>
 #include <vector>
 #include <array>
@@ -48,6 +49,29 @@ public:
         return m_position == m_size;
     }
 
+    /**
+     * @brief Reads `count` consecutive values. Values of bitwise serializable
+     * types are copied out of the buffer at once.
+     */
+    template<typename T>
+    void read_array(T *data, size_t count) {
+        if constexpr(is_bitwise_serializable_v<T>) {
+            if (m_failed || count == 0) return;
+
+            if (count > (m_size - m_position) / sizeof(T)) {
+                m_failed = true;
+                return;
+            }
+
+            std::memcpy(data, m_buffer + m_position, count * sizeof(T));
+            m_position += count * sizeof(T);
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                operator()(data[i]);
+            }
+        }
+    }
+
 protected:
     template<typename T>
     void read_bytes(T &t) {
@@ -105,6 +129,26 @@ public:
         (operator()(t), ...);
     }
 
+    /**
+     * @brief Writes `count` consecutive values. Values of bitwise serializable
+     * types are copied into the buffer at once.
+     */
+    template<typename T>
+    void write_array(const T *data, size_t count) {
+        if constexpr(is_bitwise_serializable_v<T>) {
+            auto idx = m_buffer->size();
+            m_buffer->resize(idx + count * sizeof(T));
+
+            if (count > 0) {
+                std::memcpy(&(*m_buffer)[idx], data, count * sizeof(T));
+            }
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                operator()(data[i]);
+            }
+        }
+    }
+
 protected:
     template<typename T>
     void write_bytes(const T &t) {
@@ -0,0 +1,108 @@
+#ifndef EDYN_SERIALIZATION_PAGED_TRIANGLE_MESH_MAPPED_S11N_HPP
+#define EDYN_SERIALIZATION_PAGED_TRIANGLE_MESH_MAPPED_S11N_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "edyn/context/task.hpp"
+#include "edyn/shapes/paged_triangle_mesh.hpp"
+#include "edyn/shapes/triangle_mesh_page_loader.hpp"
+#include "edyn/serialization/mapped_file.hpp"
+
+namespace edyn {
+
+/**
+ * Header at the start of a memory mappable paged triangle mesh file. After
+ * the header, there's an array of `mapped_paged_triangle_mesh_page` with one
+ * entry per submesh, followed by the data of the `paged_triangle_mesh` and
+ * then the data of each submesh. All sections start at offsets which are
+ * multiples of `mapped_archive_alignment`. Data is stored with the byte
+ * order of the platform that wrote the file.
+ */
+struct mapped_paged_triangle_mesh_header {
+    uint32_t magic;
+    uint32_t version;
+    // Must match `sizeof(scalar)` when reading.
+    uint32_t scalar_size;
+    uint32_t alignment;
+    uint64_t num_pages;
+    uint64_t mesh_offset;
+    uint64_t mesh_size;
+};
+
+// Location of a submesh in the file.
+struct mapped_paged_triangle_mesh_page {
+    uint64_t offset;
+    uint64_t size;
+};
+
+// "EDPM" in little endian.
+inline constexpr uint32_t mapped_paged_triangle_mesh_magic = 0x4d504445;
+inline constexpr uint32_t mapped_paged_triangle_mesh_version = 3;
+
+/**
+ * @brief Writes a paged triangle mesh to a file which can be loaded with a
+ * `paged_triangle_mesh_mapped_input_archive`. All submeshes must be loaded,
+ * which is the case right after `create_paged_triangle_mesh`.
+ * @param path Path to file.
+ * @param paged_tri_mesh The paged triangle mesh.
+ * @return Whether the file was written successfully.
+ */
+bool write_mapped_paged_triangle_mesh(const std::string &path, paged_triangle_mesh &paged_tri_mesh);
+
+/**
+ * Reads a `paged_triangle_mesh` from a file written with
+ * `write_mapped_paged_triangle_mesh` and loads its submeshes on demand. The
+ * file is memory mapped, thus loading a submesh only requires the operating
+ * system to bring its pages into memory, after which the submesh is copied
+ * out of the mapping in a few bulk copies, without parsing. Unloaded
+ * submeshes cost nothing to reload, and multiple meshes reading the same file
+ * share the same memory in the page cache of the operating system.
+ */
+class paged_triangle_mesh_mapped_input_archive: public triangle_mesh_page_loader_base {
+public:
+    /**
+     * @brief Maps the file into memory and validates its header.
+     * @param path Path to file.
+     * @param enqueue_task Optional function used to load submeshes in the
+     * background. If null, submeshes are loaded in the calling thread.
+     */
+    paged_triangle_mesh_mapped_input_archive(const std::string &path, enqueue_task_t *enqueue_task = nullptr);
+
+    /**
+     * @brief Whether the file was mapped and has a valid header of a
+     * compatible version.
+     */
+    bool is_valid() const {
+        return m_valid;
+    }
+
+    void load(paged_triangle_mesh *trimesh, size_t index) override;
+
+    friend void serialize(paged_triangle_mesh_mapped_input_archive &archive,
+                          paged_triangle_mesh &paged_tri_mesh);
+    friend struct load_mapped_mesh_context;
+
+private:
+    void load_page(paged_triangle_mesh *trimesh, size_t index) const;
+
+    mapped_file m_file;
+    std::vector<mapped_paged_triangle_mesh_page> m_pages;
+    uint64_t m_mesh_offset {0};
+    uint64_t m_mesh_size {0};
+    bool m_valid {false};
+    enqueue_task_t *m_enqueue_task {nullptr};
+};
+
+/**
+ * @brief Reads the paged triangle mesh from the mapped file. It does not load
+ * any submeshes. The archive must be the page loader of the mesh.
+ * @param archive The mapped file. Must be valid.
+ * @param paged_tri_mesh The paged triangle mesh.
+ */
+void serialize(paged_triangle_mesh_mapped_input_archive &archive,
+               paged_triangle_mesh &paged_tri_mesh);
+
+}
+
+#endif // EDYN_SERIALIZATION_PAGED_TRIANGLE_MESH_MAPPED_S11N_HPP
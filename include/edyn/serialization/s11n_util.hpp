@@ -3,9 +3,23 @@
 
 #include <cstdint>
 #include <type_traits>
+#include "edyn/math/scalar.hpp"
 
 namespace edyn {
 
+/**
+ * Whether the serialized representation of `T` is the same as its object
+ * representation, i.e. its members are serialized in declaration order and
+ * there's no padding in between. Arrays of such types are copied in bulk by
+ * memory archives. Specialize for types which are written as their members
+ * in order.
+ */
+template<typename T>
+struct is_bitwise_serializable : std::is_arithmetic<T> {};
+
+template<typename T>
+inline constexpr bool is_bitwise_serializable_v = is_bitwise_serializable<T>::value;
+
 template<typename Archive, typename Enum>
 void serialize_enum(Archive &archive, Enum &value) {
     using underlying_type = std::underlying_type_t<Enum>;
@@ -19,6 +33,53 @@ void serialize_enum(Archive &archive, Enum &value) {
     }
 }
 
+/**
+ * Whether `Archive` is one of the bit-packing archives, which support
+ * quantization and values which take a given number of bits.
+ */
+template<typename Archive>
+struct is_bitpack_archive : std::false_type {};
+
+template<typename Archive>
+inline constexpr bool is_bitpack_archive_v = is_bitpack_archive<Archive>::value;
+
+/**
+ * @brief Serializes a scalar quantized to steps of `precision` within
+ * `[min, max]` in bit-packing archives, and as is in any other archive.
+ * Values outside the range are clamped.
+ */
+template<typename Archive>
+void serialize_quantized(Archive &archive, scalar &value, scalar min, scalar max, scalar precision) {
+    if constexpr(is_bitpack_archive_v<Archive>) {
+        if constexpr(Archive::is_input::value) {
+            value = archive.read_quantized(min, max, precision);
+        } else {
+            archive.write_quantized(value, min, max, precision);
+        }
+    } else {
+        archive(value);
+    }
+}
+
+/**
+ * @brief Serializes an unsigned integer or enum that fits in `num_bits` in
+ * bit-packing archives, and as is in any other archive.
+ */
+template<typename Archive, typename T>
+void serialize_bits(Archive &archive, T &value, unsigned num_bits) {
+    if constexpr(is_bitpack_archive_v<Archive>) {
+        if constexpr(Archive::is_input::value) {
+            value = static_cast<T>(archive.read_bits(num_bits));
+        } else {
+            archive.write_bits(static_cast<uint64_t>(value), num_bits);
+        }
+    } else if constexpr(std::is_enum_v<T>) {
+        serialize_enum(archive, value);
+    } else {
+        archive(value);
+    }
+}
+
 template<typename Archive, typename T>
 void serialize_pointer(Archive &archive, T **ptr) {
     if constexpr(Archive::is_input::value) {
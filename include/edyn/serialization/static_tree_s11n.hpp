@@ -3,6 +3,7 @@
 
 #include "edyn/collision/static_tree.hpp"
 #include "edyn/serialization/std_s11n.hpp"
+#include "edyn/serialization/mapped_vector_s11n.hpp"
 
 namespace edyn {
 
@@ -3,7 +3,10 @@
 
 #include "edyn/shapes/triangle_mesh.hpp"
 #include "edyn/serialization/std_s11n.hpp"
+#include "edyn/serialization/mapped_vector_s11n.hpp"
+#include "edyn/serialization/s11n_util.hpp"
 #include "edyn/serialization/static_tree_s11n.hpp"
+#include "edyn/serialization/compact_static_tree_s11n.hpp"
 
 namespace edyn {
 
@@ -31,17 +34,38 @@ size_t serialization_sizeof(const flat_nested_array<T> &array) {
 
 template<typename Archive>
 void serialize(Archive &archive, triangle_mesh &tri_mesh) {
-    archive(tri_mesh.m_vertices);
-    archive(tri_mesh.m_indices);
-    archive(tri_mesh.m_normals);
+    archive(tri_mesh.m_compressed);
+
+    if (tri_mesh.m_compressed) {
+        archive(tri_mesh.m_vertex_origin);
+        archive(tri_mesh.m_vertex_scale);
+        archive(tri_mesh.m_quantized_vertices);
+        archive(tri_mesh.m_compact_indices);
+        archive(tri_mesh.m_indices);
+        archive(tri_mesh.m_encoded_normals);
+        archive(tri_mesh.m_encoded_adjacent_normals);
+    } else {
+        archive(tri_mesh.m_vertices);
+        archive(tri_mesh.m_indices);
+        archive(tri_mesh.m_normals);
+        archive(tri_mesh.m_adjacent_normals);
+    }
+
     archive(tri_mesh.m_edge_vertex_indices);
     archive(tri_mesh.m_vertex_edge_indices);
-    archive(tri_mesh.m_adjacent_normals);
     archive(tri_mesh.m_face_edge_indices);
     archive(tri_mesh.m_edge_face_indices);
     archive(tri_mesh.m_is_boundary_edge);
     archive(tri_mesh.m_is_convex_edge);
-    archive(tri_mesh.m_triangle_tree);
+    archive(tri_mesh.m_edge_seam_submesh_indices);
+    serialize_enum(archive, tri_mesh.m_tree_type);
+
+    if (tri_mesh.m_tree_type == triangle_mesh::tree_type::compact) {
+        archive(tri_mesh.m_compact_triangle_tree);
+    } else {
+        archive(tri_mesh.m_triangle_tree);
+    }
+
     archive(tri_mesh.m_friction);
     archive(tri_mesh.m_restitution);
     archive(tri_mesh.m_material_ids);
@@ -50,18 +74,31 @@ void serialize(Archive &archive, triangle_mesh &tri_mesh) {
 
 inline
 size_t serialization_sizeof(const triangle_mesh &tri_mesh) {
-    return
+    auto geometry_size = tri_mesh.m_compressed ?
+        sizeof(tri_mesh.m_vertex_origin) + sizeof(tri_mesh.m_vertex_scale) +
+        serialization_sizeof(tri_mesh.m_quantized_vertices) +
+        serialization_sizeof(tri_mesh.m_compact_indices) +
+        serialization_sizeof(tri_mesh.m_indices) +
+        serialization_sizeof(tri_mesh.m_encoded_normals) +
+        serialization_sizeof(tri_mesh.m_encoded_adjacent_normals) :
         serialization_sizeof(tri_mesh.m_vertices) +
         serialization_sizeof(tri_mesh.m_indices) +
         serialization_sizeof(tri_mesh.m_normals) +
+        serialization_sizeof(tri_mesh.m_adjacent_normals);
+
+    return
+        sizeof(tri_mesh.m_compressed) + geometry_size +
         serialization_sizeof(tri_mesh.m_edge_vertex_indices) +
         serialization_sizeof(tri_mesh.m_vertex_edge_indices) +
-        serialization_sizeof(tri_mesh.m_adjacent_normals) +
         serialization_sizeof(tri_mesh.m_face_edge_indices) +
         serialization_sizeof(tri_mesh.m_edge_face_indices) +
         serialization_sizeof(tri_mesh.m_is_boundary_edge) +
         serialization_sizeof(tri_mesh.m_is_convex_edge) +
-        serialization_sizeof(tri_mesh.m_triangle_tree) +
+        serialization_sizeof(tri_mesh.m_edge_seam_submesh_indices) +
+        sizeof(tri_mesh.m_tree_type) +
+        (tri_mesh.m_tree_type == triangle_mesh::tree_type::compact ?
+            serialization_sizeof(tri_mesh.m_compact_triangle_tree) :
+            serialization_sizeof(tri_mesh.m_triangle_tree)) +
         serialization_sizeof(tri_mesh.m_friction) +
         serialization_sizeof(tri_mesh.m_restitution) +
         serialization_sizeof(tri_mesh.m_material_ids) +
@@ -0,0 +1,75 @@
+#ifndef EDYN_SERIALIZATION_WORLD_S11N_HPP
+#define EDYN_SERIALIZATION_WORLD_S11N_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <entt/entity/fwd.hpp>
+
+namespace edyn {
+
+class entity_map;
+
+// "EDWS" in little endian.
+inline constexpr uint32_t world_save_magic = 0x53574445;
+inline constexpr uint32_t world_save_version = 8;
+
+/**
+ * @brief Writes the physics state of all rigid bodies in a registry into a
+ * buffer, including their shapes, the constraints between them and their
+ * contact manifolds with the impulses used to warm start the solver.
+ *
+ * Convex meshes and triangle meshes shared by multiple shapes are stored
+ * once. The arrays of each component are stored in a format that can be
+ * copied in bulk by `load_world`. Bodies with paged mesh and heightfield
+ * shapes are not included since these shapes refer to data which is managed
+ * by the application. External entities and components are not included.
+ *
+ * @param registry Data source.
+ * @param buffer Receives the data, which is appended.
+ */
+void save_world(const entt::registry &registry, std::vector<uint8_t> &buffer);
+
+/**
+ * @brief Writes the physics state to a file.
+ * @see save_world
+ * @return Whether the file was written successfully.
+ */
+bool save_world(const entt::registry &registry, const std::string &path);
+
+/**
+ * @brief Creates the rigid bodies, constraints and contact manifolds stored
+ * by `save_world` in a registry, which can already contain other entities.
+ *
+ * Each component array is copied in a single allocation and assigned to all
+ * new entities at once. Bodies are inserted into the entity graph right
+ * away, thus islands are formed in the next step, where the broadphase also
+ * builds a subtree with all new AABBs at once. Bodies start awake, and
+ * contact manifolds are restored with their contact points so the first
+ * step is warm started.
+ *
+ * @param registry Target registry.
+ * @param data Buffer written by `save_world`.
+ * @param size Size of buffer.
+ * @param entities Optionally receives the new rigid body entities, in the
+ * order they were in when saved.
+ * @param saved_entities Optionally receives the mapping of the rigid body and
+ * constraint entities at the time they were saved into the new entities.
+ * @return Whether the data is valid and of a compatible version. If false,
+ * nothing is created.
+ */
+bool load_world(entt::registry &registry, const uint8_t *data, size_t size,
+                std::vector<entt::entity> *entities = nullptr,
+                entity_map *saved_entities = nullptr);
+
+/**
+ * @brief Loads the physics state from a file, which is memory mapped.
+ * @see load_world
+ */
+bool load_world(entt::registry &registry, const std::string &path,
+                std::vector<entt::entity> *entities = nullptr,
+                entity_map *saved_entities = nullptr);
+
+}
+
+#endif // EDYN_SERIALIZATION_WORLD_S11N_HPP
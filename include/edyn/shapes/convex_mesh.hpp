@@ -52,6 +52,11 @@ struct convex_mesh {
     std::vector<uint32_t> neighbors_start;
     std::vector<uint32_t> neighbor_indices;
 
+    // Radius of the smallest sphere centered at the origin of the object
+    // space which contains all vertices. It allows raycasts to reject a
+    // polyhedron without having to go through all of its faces.
+    scalar bounding_radius {0};
+
     /**
      * @brief Initializes calculated properties. Call this after vertices,
      * indices and faces are assigned.
@@ -163,6 +168,7 @@ struct convex_mesh {
     void calculate_neighbors();
     void calculate_relevant_faces();
     void calculate_relevant_edges();
+    void calculate_bounding_radius();
 
     bool validate() const;
 };
@@ -170,11 +176,16 @@ struct convex_mesh {
 /**
  * @brief Accompanying component for `convex_mesh`es containing their
  * rotated vertices, normals and edges to prevent repeated recalculation of
- * these values.
+ * these values. It is updated lazily, right before it is needed in collision
+ * detection, thus it can be outdated at other times.
  */
 struct rotated_mesh {
     std::vector<vector3> vertices;
     std::vector<vector3> normals;
+
+    // Orientation the vertices and normals were rotated by. The mesh is only
+    // rotated again if the orientation is different.
+    quaternion orientation {quaternion_identity};
 };
 
 /**
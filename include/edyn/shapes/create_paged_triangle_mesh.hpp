@@ -45,6 +45,16 @@ struct submesh_builder {
         // Allocate space in cache for all submeshes.
         paged_tri_mesh.m_cache.resize(infos.size());
 
+        // Submesh of each triangle of the global mesh, used to find which
+        // edges are on the seam between two submeshes.
+        auto triangle_submesh_indices = std::vector<triangle_mesh::index_type>(global_tri_mesh.num_triangles());
+
+        for (size_t idx = 0; idx < infos.size(); ++idx) {
+            for (auto tri_idx : infos[idx].ids) {
+                triangle_submesh_indices[tri_idx] = idx;
+            }
+        }
+
         // Create submeshes using the triangle indices stored in the `build_info`s.
         auto task_func = [&](unsigned start, unsigned end) {
             for (auto idx = start; idx < end; ++idx) {
@@ -126,6 +136,7 @@ struct submesh_builder {
 
                 auto local_num_edges = submesh->m_edge_vertex_indices.size();
                 submesh->m_is_convex_edge.resize(local_num_edges);
+                submesh->m_edge_seam_submesh_indices.resize(local_num_edges);
 
                 // Assign edge normals.
                 for (size_t edge_idx = 0; edge_idx < local_num_edges; ++edge_idx) {
@@ -161,6 +172,24 @@ struct submesh_builder {
                         auto is_convex = global_tri_mesh.m_is_convex_edge[global_edge_idx];
                         submesh->m_is_convex_edge[edge_idx] = is_convex;
 
+                        // Edges on the seam between submeshes have a single
+                        // face in the submesh, but are only at the boundary
+                        // if they are in the global mesh. Record in which
+                        // submesh the other face is instead.
+                        auto is_boundary = global_tri_mesh.m_is_boundary_edge[global_edge_idx];
+                        submesh->m_is_boundary_edge[edge_idx] = is_boundary;
+                        submesh->m_edge_seam_submesh_indices[edge_idx] = triangle_mesh::invalid_submesh_index;
+
+                        if (!is_boundary) {
+                            auto global_face_indices = global_tri_mesh.m_edge_face_indices[global_edge_idx];
+                            auto submesh_idx0 = triangle_submesh_indices[global_face_indices[0]];
+                            auto submesh_idx1 = triangle_submesh_indices[global_face_indices[1]];
+
+                            if (submesh_idx0 != submesh_idx1) {
+                                submesh->m_edge_seam_submesh_indices[edge_idx] = submesh_idx0 == idx ? submesh_idx1 : submesh_idx0;
+                            }
+                        }
+
                     #if EDYN_DEBUG && !EDYN_DISABLE_ASSERT
                         edge_was_found = true;
                     #endif
@@ -253,12 +282,7 @@ void create_paged_triangle_mesh(
     paged_tri_mesh.m_tree.build(aabbs.begin(), aabbs.end(), builder, max_tri_per_submesh);
     builder.build(paged_tri_mesh, global_tri_mesh, vertex_begin, index_begin, vertex_colors, color_scale, enqueue_task_wait);
 
-    // Resize LRU queue to have the number of leaves.
-    paged_tri_mesh.m_lru_indices.resize(paged_tri_mesh.m_cache.size());
-    std::iota(paged_tri_mesh.m_lru_indices.begin(),
-              paged_tri_mesh.m_lru_indices.end(), 0);
-
-    paged_tri_mesh.m_is_loading_submesh = std::make_unique<std::atomic<bool>[]>(paged_tri_mesh.m_cache.size());
+    paged_tri_mesh.init_cache();
 }
 
 }
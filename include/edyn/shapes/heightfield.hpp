@@ -0,0 +1,340 @@
+#ifndef EDYN_SHAPES_HEIGHTFIELD_HPP
+#define EDYN_SHAPES_HEIGHTFIELD_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include "edyn/config/config.h"
+#include "edyn/config/constants.hpp"
+#include "edyn/math/math.hpp"
+#include "edyn/math/vector3.hpp"
+#include "edyn/math/triangle.hpp"
+#include "edyn/comp/aabb.hpp"
+#include "edyn/shapes/triangle_mesh.hpp"
+
+namespace edyn {
+
+class heightfield;
+
+/**
+ * @brief A small triangle mesh generated from the cells of a heightfield
+ * which overlap a region. It is what the `collide` functions involving a
+ * heightfield operate on, which lets them share the implementation of the
+ * triangle mesh, including its treatment of internal edges.
+ */
+struct heightfield_patch {
+    triangle_mesh trimesh;
+    // Column and row of the first sample in the patch in the heightfield.
+    uint32_t first_column {0};
+    uint32_t first_row {0};
+    // Number of samples along each row of the patch.
+    uint32_t num_columns {0};
+
+    bool empty() const {
+        return trimesh.num_triangles() == 0;
+    }
+
+    /**
+     * @brief Converts the index of a feature of the patch mesh into the index
+     * of the same feature in the heightfield, which remains the same when a
+     * new patch is generated in another step.
+     * @param hf The heightfield the patch was generated from.
+     * @param tri_feature Triangle feature.
+     * @param index Index of the feature in the patch mesh.
+     * @return Index of the feature in the heightfield.
+     */
+    size_t get_heightfield_feature_index(const heightfield &hf, triangle_feature tri_feature, size_t index) const;
+};
+
+/**
+ * @brief A regular grid of heights which forms a terrain. Samples are laid
+ * out in rows along the x axis, and rows follow each other along the z axis.
+ * Each cell between four samples is split in two triangles. Only the heights
+ * are stored and triangles are generated when needed, using a fraction of the
+ * memory of a `triangle_mesh` of the same terrain. Instead of a tree, queries
+ * go straight to the cells under the query region, and the grid is split in
+ * square tiles which store the minimum and maximum height of their cells so
+ * whole tiles can be skipped quickly.
+ *
+ * The indices of features follow from the grid. The vertex index of the
+ * sample at column `c` and row `r` is `r * num_columns + c`. Triangles of the
+ * cell whose first sample is at column `c` and row `r` have index
+ * `2 * (r * (num_columns - 1) + c) + k`, where `k` is 0 or 1. Edges starting
+ * at vertex `v` have index `3 * v + k`, where `k` is 0 for the edge to the
+ * next sample in the row, 1 to the sample in the next row and 2 for the
+ * diagonal to the next sample in the next row.
+ */
+class heightfield {
+public:
+    template<typename It>
+    void insert_heights(It first, It last) {
+        m_heights.clear();
+        m_heights.insert(m_heights.end(), first, last);
+    }
+
+    /**
+     * @brief Sets up the heightfield after the heights are inserted.
+     * @param num_columns Number of samples along the x axis.
+     * @param num_rows Number of samples along the z axis. The number of
+     * heights must be `num_columns * num_rows`.
+     * @param cell_size Distance between neighboring samples.
+     * @param origin Position of the first sample at zero height, i.e. the
+     * corner of the grid with minimum x and z.
+     * @param tile_size Number of cells along each side of a tile. No tiles
+     * are created if zero.
+     */
+    void initialize(uint32_t num_columns, uint32_t num_rows, scalar cell_size,
+                    const vector3 &origin = vector3_zero,
+                    uint32_t tile_size = heightfield_default_tile_size);
+
+    uint32_t num_columns() const {
+        return m_num_columns;
+    }
+
+    uint32_t num_rows() const {
+        return m_num_rows;
+    }
+
+    scalar get_cell_size() const {
+        return m_cell_size;
+    }
+
+    AABB get_aabb() const {
+        return m_aabb;
+    }
+
+    scalar get_height(uint32_t column, uint32_t row) const {
+        EDYN_ASSERT(column < m_num_columns && row < m_num_rows);
+        return m_heights[row * m_num_columns + column];
+    }
+
+    vector3 get_vertex_position(uint32_t column, uint32_t row) const {
+        return m_origin + vector3{column * m_cell_size, get_height(column, row), row * m_cell_size};
+    }
+
+    /**
+     * @brief Vertices of one of the triangles of a cell.
+     * @param column Column of the first sample of the cell.
+     * @param row Row of the first sample of the cell.
+     * @param k Triangle index in the cell, 0 or 1.
+     * @return Triangle vertices in counter-clockwise order seen from above.
+     */
+    triangle_vertices get_cell_triangle_vertices(uint32_t column, uint32_t row, uint32_t k) const;
+
+    uint32_t get_triangle_index(uint32_t column, uint32_t row, uint32_t k) const {
+        return 2 * (row * (m_num_columns - 1) + column) + k;
+    }
+
+    /**
+     * @brief Get the range of cells under the given AABB, ignoring height.
+     * @return False if the AABB is outside of the grid.
+     */
+    bool get_cell_range(const AABB &aabb, uint32_t &first_column, uint32_t &first_row,
+                        uint32_t &last_column, uint32_t &last_row) const;
+
+    /**
+     * @brief Visits the cells under the given AABB whose tiles have a height
+     * range which intersects the AABB, taking into account the thickness.
+     * @param aabb The query AABB.
+     * @param func Called with the column and row of the first sample of each
+     * cell.
+     */
+    template<typename Func>
+    void visit_cells(const AABB &aabb, Func func) const;
+
+    /**
+     * @brief Visits the cells crossed by a line segment, in the order they
+     * are crossed. Tiles whose height range is not crossed by the segment are
+     * skipped.
+     * @param p0 Start of segment.
+     * @param p1 End of segment.
+     * @param func Called with the column and row of the first sample of each
+     * cell. Visiting stops if it returns false.
+     */
+    template<typename Func>
+    void raycast(const vector3 &p0, const vector3 &p1, Func func) const;
+
+    /**
+     * @brief Generates a triangle mesh with the cells under `aabb` and one
+     * extra ring of cells around them so edges inside the region have both of
+     * their faces and are not treated as boundary edges.
+     * @param aabb The query region.
+     * @param patch The patch to be generated. It is left empty if no cell
+     * inside the region intersects it.
+     */
+    void make_patch(const AABB &aabb, heightfield_patch &patch) const;
+
+    scalar get_thickness() const { return m_thickness; }
+
+    /**
+     * @brief Set depth below the surface where objects are still pushed up.
+     * See `triangle_mesh::set_thickness`.
+     */
+    void set_thickness(scalar thickness) { m_thickness = thickness; }
+
+private:
+    // Finds the interval of parameters where the segment is inside the AABB,
+    // extended downwards by the thickness.
+    bool clip_segment(const vector3 &p0, const vector3 &p1, scalar &t0, scalar &t1) const;
+
+    bool tile_intersects(uint32_t tile_column, uint32_t tile_row, scalar min_y, scalar max_y) const;
+
+    // Calls `func(x, z, t_enter, t_exit)` for each cell of a grid with
+    // `num_x` by `num_z` square cells of size `size` and first corner at
+    // `origin_x, origin_z`, crossed by the segment in the interval of
+    // parameters `[t0, t1]`. Stops if `func` returns false and returns
+    // whether all cells were visited.
+    template<typename Func>
+    static bool walk_grid(const vector3 &p0, const vector3 &p1, scalar t0, scalar t1,
+                          scalar origin_x, scalar origin_z, scalar size,
+                          uint32_t first_x, uint32_t first_z, uint32_t num_x, uint32_t num_z,
+                          Func func);
+
+    std::vector<scalar> m_heights;
+    uint32_t m_num_columns {0};
+    uint32_t m_num_rows {0};
+    scalar m_cell_size {1};
+    vector3 m_origin {vector3_zero};
+    AABB m_aabb;
+    scalar m_thickness {1};
+
+    // Minimum and maximum height of the cells in each tile, stored by rows.
+    uint32_t m_tile_size {0};
+    uint32_t m_num_tile_columns {0};
+    uint32_t m_num_tile_rows {0};
+    std::vector<scalar> m_tile_min;
+    std::vector<scalar> m_tile_max;
+};
+
+template<typename Func>
+void heightfield::visit_cells(const AABB &aabb, Func func) const {
+    uint32_t first_column, first_row, last_column, last_row;
+
+    if (!get_cell_range(aabb, first_column, first_row, last_column, last_row)) {
+        return;
+    }
+
+    if (aabb.max.y < m_aabb.min.y - m_thickness || aabb.min.y > m_aabb.max.y) {
+        return;
+    }
+
+    for (auto row = first_row; row <= last_row; ++row) {
+        for (auto column = first_column; column <= last_column; ++column) {
+            if (m_tile_size > 0 &&
+                !tile_intersects(column / m_tile_size, row / m_tile_size,
+                                 aabb.min.y, aabb.max.y + m_thickness)) {
+                continue;
+            }
+
+            func(column, row);
+        }
+    }
+}
+
+template<typename Func>
+bool heightfield::walk_grid(const vector3 &p0, const vector3 &p1, scalar t0, scalar t1,
+                            scalar origin_x, scalar origin_z, scalar size,
+                            uint32_t first_x, uint32_t first_z, uint32_t num_x, uint32_t num_z,
+                            Func func) {
+    auto d = p1 - p0;
+    auto start = p0 + d * t0;
+    auto to_cell = [&](scalar value, scalar origin, uint32_t first, uint32_t num) {
+        auto idx = static_cast<int64_t>(std::floor((value - origin) / size));
+        return static_cast<uint32_t>(std::clamp<int64_t>(idx, first, first + num - 1));
+    };
+
+    auto x = to_cell(start.x, origin_x, first_x, num_x);
+    auto z = to_cell(start.z, origin_z, first_z, num_z);
+    auto step_x = d.x > 0 ? 1 : -1;
+    auto step_z = d.z > 0 ? 1 : -1;
+
+    // Parameter where the segment crosses the next cell boundary along each
+    // axis and the parameter increment between boundaries.
+    auto t_next_x = std::abs(d.x) > EDYN_EPSILON ? (origin_x + (d.x > 0 ? x + 1 : x) * size - p0.x) / d.x : EDYN_SCALAR_MAX;
+    auto t_next_z = std::abs(d.z) > EDYN_EPSILON ? (origin_z + (d.z > 0 ? z + 1 : z) * size - p0.z) / d.z : EDYN_SCALAR_MAX;
+    auto t_delta_x = std::abs(d.x) > EDYN_EPSILON ? size / std::abs(d.x) : EDYN_SCALAR_MAX;
+    auto t_delta_z = std::abs(d.z) > EDYN_EPSILON ? size / std::abs(d.z) : EDYN_SCALAR_MAX;
+
+    auto t = t0;
+
+    while (t <= t1) {
+        auto t_exit = std::min(std::min(t_next_x, t_next_z), t1);
+
+        if (!func(x, z, t, t_exit)) {
+            return false;
+        }
+
+        if (t_next_x < t_next_z) {
+            if ((step_x > 0 && x + 1 >= first_x + num_x) || (step_x < 0 && x == first_x)) {
+                break;
+            }
+
+            x += step_x;
+            t = t_next_x;
+            t_next_x += t_delta_x;
+        } else {
+            if (t_next_z == EDYN_SCALAR_MAX ||
+                (step_z > 0 && z + 1 >= first_z + num_z) || (step_z < 0 && z == first_z)) {
+                break;
+            }
+
+            z += step_z;
+            t = t_next_z;
+            t_next_z += t_delta_z;
+        }
+
+        if (t > t1) {
+            break;
+        }
+    }
+
+    return true;
+}
+
+template<typename Func>
+void heightfield::raycast(const vector3 &p0, const vector3 &p1, Func func) const {
+    // Clip the segment to the bounds of the grid.
+    scalar t0, t1;
+
+    if (!clip_segment(p0, p1, t0, t1)) {
+        return;
+    }
+
+    const auto num_cells_x = m_num_columns - 1;
+    const auto num_cells_z = m_num_rows - 1;
+    auto visit_cell = [&](uint32_t column, uint32_t row, scalar, scalar) {
+        return static_cast<bool>(func(column, row));
+    };
+
+    if (m_tile_size == 0) {
+        walk_grid(p0, p1, t0, t1, m_origin.x, m_origin.z, m_cell_size,
+                  0, 0, num_cells_x, num_cells_z, visit_cell);
+        return;
+    }
+
+    const auto tile_extent = m_cell_size * m_tile_size;
+
+    walk_grid(p0, p1, t0, t1, m_origin.x, m_origin.z, tile_extent,
+              0, 0, m_num_tile_columns, m_num_tile_rows,
+              [&](uint32_t tile_column, uint32_t tile_row, scalar tile_t0, scalar tile_t1) {
+        auto y0 = lerp(p0.y, p1.y, tile_t0);
+        auto y1 = lerp(p0.y, p1.y, tile_t1);
+
+        if (!tile_intersects(tile_column, tile_row, std::min(y0, y1), std::max(y0, y1) + m_thickness)) {
+            return true;
+        }
+
+        auto first_x = tile_column * m_tile_size;
+        auto first_z = tile_row * m_tile_size;
+        auto num_x = std::min(m_tile_size, num_cells_x - first_x);
+        auto num_z = std::min(m_tile_size, num_cells_z - first_z);
+
+        return walk_grid(p0, p1, tile_t0, tile_t1, m_origin.x, m_origin.z, m_cell_size,
+                         first_x, first_z, num_x, num_z, visit_cell);
+    });
+}
+
+}
+
+#endif // EDYN_SHAPES_HEIGHTFIELD_HPP
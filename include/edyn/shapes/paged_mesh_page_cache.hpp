@@ -0,0 +1,121 @@
+#ifndef EDYN_SHAPES_PAGED_MESH_PAGE_CACHE_HPP
+#define EDYN_SHAPES_PAGED_MESH_PAGE_CACHE_HPP
+
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+
+namespace edyn {
+
+class paged_triangle_mesh;
+
+/**
+ * @brief Counters of a `paged_mesh_page_cache`.
+ */
+struct paged_mesh_page_cache_stats {
+    // Number of times a page that was in the cache was requested.
+    uint64_t hits {0};
+    // Number of times a page that was not in the cache was requested, which
+    // causes it to be loaded.
+    uint64_t misses {0};
+    // Number of pages unloaded to make room for other pages.
+    uint64_t evictions {0};
+    // Number of pages currently in the cache.
+    size_t num_pages {0};
+    // Number of pages which are currently pinned, loaded or not.
+    size_t num_pinned_pages {0};
+    // Estimated memory used by the pages currently in the cache.
+    size_t num_bytes {0};
+};
+
+/**
+ * @brief Process-wide cache of the pages of all `paged_triangle_mesh`
+ * instances. It keeps the loaded pages in least recently used order and
+ * after a new page is loaded, it unloads the least recently used pages of
+ * any mesh until the estimated memory used by all pages stays within the
+ * byte budget. Pinned pages are never unloaded, thus the budget can be
+ * exceeded if all pages are pinned. All functions are thread-safe.
+ */
+class paged_mesh_page_cache {
+public:
+    static paged_mesh_page_cache &global();
+
+    /**
+     * @brief Set the maximum amount of memory used by the pages of all paged
+     * triangle meshes. It takes effect when the next page is loaded.
+     * @param num_bytes Budget in bytes.
+     */
+    void set_byte_budget(size_t num_bytes);
+    size_t get_byte_budget() const;
+
+    paged_mesh_page_cache_stats get_stats() const;
+
+    // Resets the hit, miss and eviction counters.
+    void reset_stats();
+
+    /**
+     * @brief Prevent a page from being unloaded. Pins are counted, thus a
+     * page must be unpinned as many times as it was pinned before it can be
+     * unloaded again. A page can be pinned before it is loaded.
+     * @param trimesh The paged triangle mesh.
+     * @param index Page index.
+     */
+    void pin(paged_triangle_mesh *trimesh, size_t index);
+    void unpin(paged_triangle_mesh *trimesh, size_t index);
+    bool is_pinned(paged_triangle_mesh *trimesh, size_t index) const;
+
+private:
+    friend class paged_triangle_mesh;
+
+    struct page_key {
+        paged_triangle_mesh *trimesh;
+        size_t index;
+
+        bool operator==(const page_key &other) const {
+            return trimesh == other.trimesh && index == other.index;
+        }
+    };
+
+    struct page_key_hash {
+        size_t operator()(const page_key &key) const;
+    };
+
+    struct page_entry {
+        page_key key;
+        size_t num_bytes;
+    };
+
+    using lru_list = std::list<page_entry>;
+
+    // Functions used by `paged_triangle_mesh` to keep the cache updated. They
+    // must not be called while holding a lock of the mesh since the cache
+    // locks the mesh when unloading a page.
+    void insert(paged_triangle_mesh *trimesh, size_t index, size_t num_bytes, bool evict_pages);
+    void erase(paged_triangle_mesh *trimesh);
+    void remove_mesh(paged_triangle_mesh *trimesh);
+    void touch(paged_triangle_mesh *trimesh, size_t index);
+    void record_hit();
+    void record_miss();
+    bool evict_least_recently_used(paged_triangle_mesh *trimesh);
+
+    bool is_pinned_unlocked(const page_key &key) const;
+    void evict(lru_list::iterator it);
+
+    mutable std::mutex m_mutex;
+    // Most recently used pages at the front.
+    lru_list m_lru;
+    std::unordered_map<page_key, lru_list::iterator, page_key_hash> m_entries;
+    std::unordered_map<page_key, unsigned, page_key_hash> m_pin_counts;
+    size_t m_byte_budget {size_t(256) << 20};
+    size_t m_num_bytes {0};
+    std::atomic<uint64_t> m_hits {0};
+    std::atomic<uint64_t> m_misses {0};
+    std::atomic<uint64_t> m_evictions {0};
+};
+
+}
+
+#endif // EDYN_SHAPES_PAGED_MESH_PAGE_CACHE_HPP
@@ -0,0 +1,62 @@
+#ifndef EDYN_SHAPES_PAGED_MESH_PINNED_PAGES_HPP
+#define EDYN_SHAPES_PAGED_MESH_PINNED_PAGES_HPP
+
+#include <memory>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include "edyn/shapes/paged_mesh_page_cache.hpp"
+
+namespace edyn {
+
+class paged_triangle_mesh;
+
+/**
+ * @brief A set of pages pinned in the `paged_mesh_page_cache`, which are
+ * unpinned when the set is replaced or destroyed. A reference to each mesh is
+ * kept so it stays alive until its pages are unpinned.
+ */
+struct paged_mesh_pinned_pages {
+    using page_type = std::pair<std::shared_ptr<paged_triangle_mesh>, size_t>;
+    std::vector<page_type> pages;
+
+    paged_mesh_pinned_pages() = default;
+    paged_mesh_pinned_pages(const paged_mesh_pinned_pages &) = delete;
+    paged_mesh_pinned_pages(paged_mesh_pinned_pages &&) = default;
+    paged_mesh_pinned_pages & operator=(const paged_mesh_pinned_pages &) = delete;
+    paged_mesh_pinned_pages & operator=(paged_mesh_pinned_pages &&) = delete;
+
+    ~paged_mesh_pinned_pages() {
+        assign({});
+    }
+
+    /**
+     * @brief Replace the pinned pages. Duplicates are removed.
+     * @param new_pages The pages to be pinned.
+     */
+    void assign(std::vector<page_type> new_pages) {
+        auto page_less = [](auto &a, auto &b) {
+            return a.first != b.first ? a.first < b.first : a.second < b.second;
+        };
+        std::sort(new_pages.begin(), new_pages.end(), page_less);
+        new_pages.erase(std::unique(new_pages.begin(), new_pages.end()), new_pages.end());
+
+        // Pin new pages before unpinning the previous ones so pages which
+        // are in both sets never become unpinned.
+        auto &page_cache = paged_mesh_page_cache::global();
+
+        for (auto &[trimesh, index] : new_pages) {
+            page_cache.pin(trimesh.get(), index);
+        }
+
+        for (auto &[trimesh, index] : pages) {
+            page_cache.unpin(trimesh.get(), index);
+        }
+
+        pages = std::move(new_pages);
+    }
+};
+
+}
+
+#endif // EDYN_SHAPES_PAGED_MESH_PINNED_PAGES_HPP
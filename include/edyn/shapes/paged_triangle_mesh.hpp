@@ -2,6 +2,7 @@
 #define EDYN_SHAPES_PAGED_TRIANGLE_MESH_HPP
 
 #include <mutex>
+#include <string>
 #include <vector>
 #include <atomic>
 #include <memory>
@@ -14,6 +15,8 @@ namespace edyn {
 
 class paged_triangle_mesh_file_input_archive;
 class paged_triangle_mesh_file_output_archive;
+class paged_triangle_mesh_mapped_input_archive;
+class paged_mesh_page_cache;
 class finish_load_mesh_job;
 
 // Forward declaration of `detail::submesh_builder` needed by `friend`
@@ -23,7 +26,9 @@ namespace detail {
 }
 
 /**
- * @brief A triangle mesh which loads chunks on demand.
+ * @brief A triangle mesh which loads chunks on demand. The loaded chunks
+ * are kept in the process-wide `paged_mesh_page_cache`, which decides which
+ * chunks to unload when memory is needed.
  */
 class paged_triangle_mesh {
 public:
@@ -35,6 +40,7 @@ public:
     };
 
     paged_triangle_mesh(std::shared_ptr<triangle_mesh_page_loader_base> loader);
+    ~paged_triangle_mesh();
 
     /**
      * @brief Visit submeshes which intersect the given AABB. It will start
@@ -57,6 +63,65 @@ public:
         });
     }
 
+    /**
+     * @brief Visit submeshes in the cache which intersect the given AABB.
+     * Submeshes that are not loaded are skipped and no loads are started.
+     * @tparam Func Type of the function object to invoke.
+     * @param aabb Query AABB.
+     * @param func Will be called with submesh index.
+     */
+    template<typename Func>
+    void visit_cached_submeshes(const AABB &aabb, Func func) const {
+        m_tree.query(aabb, [&](auto tree_node_idx) {
+            auto mesh_idx = m_tree.get_node(tree_node_idx).id;
+
+            if (m_cache[mesh_idx].trimesh) {
+                func(mesh_idx);
+            }
+        });
+    }
+
+    /**
+     * @brief Visit submeshes which intersect the given AABB and are not in
+     * the cache.
+     * @tparam Func Type of the function object to invoke.
+     * @param aabb Query AABB.
+     * @param func Will be called with the submesh index and its AABB.
+     */
+    template<typename Func>
+    void visit_missing_submeshes(const AABB &aabb, Func func) const {
+        m_tree.query(aabb, [&](auto tree_node_idx) {
+            auto &node = m_tree.get_node(tree_node_idx);
+
+            if (!m_cache[node.id].trimesh) {
+                func(size_t(node.id), node.aabb);
+            }
+        });
+    }
+
+    /**
+     * @brief Visit all submeshes which intersect the given AABB, whether they
+     * are in the cache or not. No loads are started.
+     * @tparam Func Type of the function object to invoke.
+     * @param aabb Query AABB.
+     * @param func Will be called with submesh index.
+     */
+    template<typename Func>
+    void visit_submesh_indices(const AABB &aabb, Func func) const {
+        m_tree.query(aabb, [&](auto tree_node_idx) {
+            func(size_t(m_tree.get_node(tree_node_idx).id));
+        });
+    }
+
+    /**
+     * @brief Start loading all submeshes which intersect the given AABB and
+     * are not in the cache, and mark the ones in the cache as recently
+     * visited so they are not unloaded. Whether loading is asynchronous
+     * depends on the page loader.
+     * @param aabb Query AABB.
+     */
+    void prefetch(const AABB &aabb);
+
     /**
      * @brief Loops over all edges present in the cache.
      * @tparam Func Type of the function object to invoke.
@@ -115,7 +180,8 @@ public:
      */
     template<typename Func>
     void visit_cached_triangles(const AABB &aabb, Func func) const {
-        for (size_t mesh_idx = 0; mesh_idx < m_cache.size(); ++mesh_idx) {
+        m_tree.query(aabb, [&](auto tree_node_idx) {
+            auto mesh_idx = m_tree.get_node(tree_node_idx).id;
             auto trimesh = m_cache[mesh_idx].trimesh;
 
             if (trimesh) {
@@ -123,7 +189,7 @@ public:
                     func(mesh_idx, tri_idx);
                 });
             }
-        }
+        });
     }
 
     /**
@@ -287,11 +353,23 @@ public:
 
     void set_thickness(scalar thickness);
 
+    /**
+     * @brief Compresses the submeshes which are in the cache, usually right
+     * after `create_paged_triangle_mesh` and before the mesh is written to a
+     * file, which then stores the compressed submeshes. Must not be called
+     * while the mesh is in use by a simulation.
+     * @see triangle_mesh::compress
+     */
+    void compress();
+
     /**
      * @brief Maximum number of vertices in the cache. Before a new triangle mesh
      * is loaded, if the number of vertices would exceed this number, the
      * least recently visited nodes will be unloaded until the new total
-     * number of vertices stays below this value.
+     * number of vertices stays below this value. Pinned nodes are not
+     * unloaded. This limit applies to this mesh only and is enforced in
+     * addition to the byte budget of the `paged_mesh_page_cache` shared by
+     * all meshes.
      */
     size_t m_max_cache_num_vertices = 1 << 13;
 
@@ -306,6 +384,7 @@ public:
             enqueue_task_wait_t *enqueue_task_wait);
 
     friend struct detail::submesh_builder;
+    friend class paged_mesh_page_cache;
 
     friend class paged_triangle_mesh_file_input_archive;
     friend class paged_triangle_mesh_file_output_archive;
@@ -316,15 +395,21 @@ public:
     friend void serialize(paged_triangle_mesh_file_input_archive &archive,
                           paged_triangle_mesh &paged_tri_mesh);
 
+    friend void serialize(paged_triangle_mesh_mapped_input_archive &archive,
+                          paged_triangle_mesh &paged_tri_mesh);
+
+    friend bool write_mapped_paged_triangle_mesh(const std::string &path,
+                                                 paged_triangle_mesh &paged_tri_mesh);
+
 private:
+    void init_cache();
     void load_node_if_needed(size_t trimesh_idx);
     void mark_recent_visit(size_t trimesh_idx);
-    void unload_least_recently_visited_node();
+    void unload_page(size_t trimesh_idx);
 
     static_tree m_tree;
     std::vector<triangle_mesh_node> m_cache;
-    std::vector<size_t> m_lru_indices;
-    std::mutex m_lru_mutex;
+    std::mutex m_cache_mutex;
     std::unique_ptr<std::atomic<bool>[]> m_is_loading_submesh;
     std::shared_ptr<triangle_mesh_page_loader_base> m_page_loader;
     scalar m_thickness {1};
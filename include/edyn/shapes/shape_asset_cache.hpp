@@ -0,0 +1,115 @@
+#ifndef EDYN_SHAPES_SHAPE_ASSET_CACHE_HPP
+#define EDYN_SHAPES_SHAPE_ASSET_CACHE_HPP
+
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+#include "edyn/math/vector3.hpp"
+#include "edyn/shapes/convex_mesh.hpp"
+#include "edyn/shapes/triangle_mesh.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Process-wide cache of convex meshes and triangle meshes, identified
+ * by a hash of their contents. Identical meshes are built once and shared by
+ * all shapes in all registries. Since the id only depends on the contents,
+ * the same mesh has the same id in all machines, which allows shapes to be
+ * replicated over the network by id (see `mesh_id_encoding`), as long as the
+ * mesh is in the cache of the receiver, e.g. by creating it from the same
+ * source data on both ends. The cache holds a reference to its meshes, thus
+ * they're kept alive until `clear_unused` is called. Triangle meshes with
+ * per-vertex material properties are not deduplicated. All functions are
+ * thread-safe.
+ */
+class shape_asset_cache {
+public:
+    using id_type = uint64_t;
+    static constexpr id_type invalid_id = 0;
+
+    static shape_asset_cache &global();
+
+    /**
+     * @brief Obtain the convex mesh with the given vertices and faces. If it
+     * isn't in the cache, it's created and initialized.
+     * @param vertices Vertex positions.
+     * @param indices Vertex indices of all faces.
+     * @param faces Pairs of the index of the first vertex of a face in the
+     * `indices` array and the number of vertices in the face.
+     * @return Shared convex mesh.
+     */
+    std::shared_ptr<convex_mesh> get_convex_mesh(const std::vector<vector3> &vertices,
+                                                 const std::vector<uint32_t> &indices,
+                                                 const std::vector<uint32_t> &faces);
+
+    /**
+     * @brief Obtain the triangle mesh with the given vertices and triangles.
+     * If it isn't in the cache, it's created and initialized.
+     * @param vertices Vertex positions.
+     * @param indices Three vertex indices per triangle.
+     * @param type Type of tree used to accelerate queries.
+     * @return Shared triangle mesh.
+     */
+    std::shared_ptr<triangle_mesh> get_triangle_mesh(const std::vector<vector3> &vertices,
+                                                     const std::vector<uint32_t> &indices,
+                                                     triangle_mesh::tree_type type = triangle_mesh::tree_type::binary);
+
+    /**
+     * @brief Inserts an initialized mesh into the cache unless an identical
+     * mesh is already there.
+     * @return Id of the mesh in the cache.
+     */
+    id_type insert(const std::shared_ptr<convex_mesh> &mesh);
+    id_type insert(const std::shared_ptr<triangle_mesh> &mesh);
+
+    /**
+     * @brief Returns the mesh in the cache which is identical to the given
+     * mesh, which is inserted if there's none.
+     */
+    std::shared_ptr<convex_mesh> share(const std::shared_ptr<convex_mesh> &mesh);
+    std::shared_ptr<triangle_mesh> share(const std::shared_ptr<triangle_mesh> &mesh);
+
+    /**
+     * @brief Id of a mesh which is in the cache.
+     * @return Mesh id or `invalid_id` if this instance is not in the cache.
+     */
+    id_type get_id(const convex_mesh *mesh) const;
+    id_type get_id(const triangle_mesh *mesh) const;
+
+    /**
+     * @brief Find a mesh by id.
+     * @return The mesh or null if there's no mesh with this id in the cache.
+     */
+    std::shared_ptr<convex_mesh> find_convex_mesh(id_type id) const;
+    std::shared_ptr<triangle_mesh> find_triangle_mesh(id_type id) const;
+
+    /**
+     * @brief Releases all meshes which are only referenced by the cache.
+     */
+    void clear_unused();
+
+    size_t num_convex_meshes() const;
+    size_t num_triangle_meshes() const;
+
+private:
+    template<typename Mesh>
+    struct mesh_table {
+        std::unordered_map<id_type, std::shared_ptr<Mesh>> meshes;
+        std::unordered_map<const Mesh *, id_type> ids;
+    };
+
+    template<typename Mesh, typename Equal>
+    id_type insert_unlocked(mesh_table<Mesh> &table, const std::shared_ptr<Mesh> &mesh,
+                            id_type hash, Equal equal);
+
+    mutable std::mutex m_mutex;
+    mesh_table<convex_mesh> m_convex_meshes;
+    mesh_table<triangle_mesh> m_triangle_meshes;
+};
+
+}
+
+#endif // EDYN_SHAPES_SHAPE_ASSET_CACHE_HPP
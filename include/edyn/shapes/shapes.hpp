@@ -9,39 +9,97 @@
 #include "edyn/shapes/box_shape.hpp"
 #include "edyn/shapes/polyhedron_shape.hpp"
 #include "edyn/shapes/paged_mesh_shape.hpp"
+#include "edyn/shapes/heightfield_shape.hpp"
 #include "edyn/shapes/compound_shape.hpp"
 #include "edyn/comp/shape_index.hpp"
 #include "edyn/math/coordinate_axis.hpp"
 #include "edyn/util/tuple_util.hpp"
 #include "edyn/util/entt_util.hpp"
 #include "edyn/util/visit_component.hpp"
+#include "edyn/build_settings.h"
 #include <entt/entity/fwd.hpp>
+#include <type_traits>
+#include <utility>
 
 namespace edyn {
 
+/**
+ * Whether a shape type is part of the build. Shapes can be left out with the
+ * CMake option `EDYN_CONFIG_DISABLED_SHAPES`, which removes them from the
+ * shape tuples and variant below, thus no views, dispatch entries or
+ * collision function instantiations are generated for them and they can't
+ * be assigned to rigid bodies. They can still be children of compound shapes.
+ */
+template<typename ShapeType>
+struct is_shape_enabled : std::true_type {};
+
+#ifdef EDYN_DISABLE_PLANE_SHAPE
+template<> struct is_shape_enabled<plane_shape> : std::false_type {};
+#endif
+#ifdef EDYN_DISABLE_CYLINDER_SHAPE
+template<> struct is_shape_enabled<cylinder_shape> : std::false_type {};
+#endif
+#ifdef EDYN_DISABLE_CAPSULE_SHAPE
+template<> struct is_shape_enabled<capsule_shape> : std::false_type {};
+#endif
+#ifdef EDYN_DISABLE_POLYHEDRON_SHAPE
+template<> struct is_shape_enabled<polyhedron_shape> : std::false_type {};
+#endif
+#ifdef EDYN_DISABLE_COMPOUND_SHAPE
+template<> struct is_shape_enabled<compound_shape> : std::false_type {};
+#endif
+#ifdef EDYN_DISABLE_MESH_SHAPE
+template<> struct is_shape_enabled<mesh_shape> : std::false_type {};
+#endif
+#ifdef EDYN_DISABLE_PAGED_MESH_SHAPE
+template<> struct is_shape_enabled<paged_mesh_shape> : std::false_type {};
+#endif
+#ifdef EDYN_DISABLE_HEIGHTFIELD_SHAPE
+template<> struct is_shape_enabled<heightfield_shape> : std::false_type {};
+#endif
+
+template<typename ShapeType>
+inline constexpr bool is_shape_enabled_v = is_shape_enabled<ShapeType>::value;
+
+/**
+ * Removes the shapes which are not part of the build from a tuple of shapes.
+ */
+template<typename Tuple>
+struct enabled_shapes;
+
+template<typename... Ts>
+struct enabled_shapes<std::tuple<Ts...>> {
+    using type = decltype(std::tuple_cat(
+        std::declval<std::conditional_t<is_shape_enabled_v<Ts>, std::tuple<Ts>, std::tuple<>>>()...));
+};
+
+template<typename Tuple>
+using enabled_shapes_t = typename enabled_shapes<Tuple>::type;
+
 // Shapes that can be transformed.
-using dynamic_shapes_tuple_t = std::tuple<
+using dynamic_shapes_tuple_t = enabled_shapes_t<std::tuple<
     sphere_shape,
     cylinder_shape,
     capsule_shape,
     box_shape,
     polyhedron_shape,
     compound_shape
->;
+>>;
 
 // Shapes which can't be transformed.
-using static_shapes_tuple_t = std::tuple<
+using static_shapes_tuple_t = enabled_shapes_t<std::tuple<
     plane_shape,
     mesh_shape,
-    paged_mesh_shape
->;
+    paged_mesh_shape,
+    heightfield_shape
+>>;
 
 // Shapes that can roll.
-using rolling_shapes_tuple_t = std::tuple<
+using rolling_shapes_tuple_t = enabled_shapes_t<std::tuple<
     sphere_shape,
     cylinder_shape,
     capsule_shape
->;
+>>;
 
 static const auto dynamic_shapes_tuple = dynamic_shapes_tuple_t{};
 static const auto static_shapes_tuple = static_shapes_tuple_t{};
@@ -65,7 +123,8 @@ using shape_feature_t = std::variant<
 /**
  * @brief Returns the index value of a shape type. This is the value that
  * should be stored in a `shape_index` component.
- * @tparam ShapeType One of the shape types in `shapes_tuple`.
+ * @tparam ShapeType One of the shape types in `shapes_tuple`, i.e. an enabled
+ * shape.
  * @return Index of shape type.
  */
 template<typename ShapeType>
@@ -73,6 +132,22 @@ constexpr auto get_shape_index() {
     return tuple_index_of<shape_index::index_type, ShapeType>(shapes_tuple);
 }
 
+/**
+ * @brief Checks whether a shape index refers to a shape type. Unlike comparing
+ * with `get_shape_index`, it can be used with shapes which are not enabled.
+ * @tparam ShapeType Any shape type.
+ * @param index Shape index.
+ * @return Whether the index refers to the shape type.
+ */
+template<typename ShapeType>
+constexpr bool is_shape_index(const shape_index &index) {
+    if constexpr(is_shape_enabled_v<ShapeType>) {
+        return index.value == get_shape_index<ShapeType>();
+    } else {
+        return false;
+    }
+}
+
 /**
  * @brief Creates a tuple of shape views, such as
  * `std::make_tuple(registry.view<sphere_shape>(), registry.view<cylinder_shape>, ...)`.
@@ -3,16 +3,20 @@
 
 #include <vector>
 #include <cstdint>
+#include <limits>
 #include "edyn/config/config.h"
 #include "edyn/math/math.hpp"
 #include "edyn/math/vector3.hpp"
 #include "edyn/math/geom.hpp"
+#include "edyn/math/octahedral.hpp"
 #include "edyn/math/triangle.hpp"
 #include "edyn/comp/aabb.hpp"
 #include "edyn/comp/material.hpp"
 #include "edyn/collision/static_tree.hpp"
+#include "edyn/collision/compact_static_tree.hpp"
 #include "edyn/core/unordered_pair.hpp"
 #include "edyn/core/flat_nested_array.hpp"
+#include "edyn/core/mapped_vector.hpp"
 
 namespace edyn {
 
@@ -33,6 +37,23 @@ class triangle_mesh {
 public:
     using index_type = uint32_t;
 
+    // Value of `get_edge_seam_submesh_index` for edges which are not on the
+    // seam between two submeshes of a paged triangle mesh.
+    static constexpr auto invalid_submesh_index = std::numeric_limits<index_type>::max();
+
+    /**
+     * Type of tree used to accelerate queries.
+     */
+    enum class tree_type : uint8_t {
+        // Binary tree with full precision bounds and one triangle per leaf.
+        binary,
+        // Tree with 4-wide nodes, 16-bit quantized bounds and a few triangles
+        // per leaf. Uses a fraction of the memory of the binary tree and is
+        // shallower, which is preferable for very large meshes. Queries are
+        // conservative and might report a few more triangles.
+        compact
+    };
+
     template<typename It>
     void insert_vertices(It first, It last) {
         m_vertices.reserve(std::distance(first, last));
@@ -61,10 +82,46 @@ public:
         m_restitution.insert(m_restitution.end(), first, last);
     }
 
-    void initialize();
+    /**
+     * @brief Calculates normals and adjacency information and builds the
+     * triangle tree. Must be called after vertices and indices are inserted.
+     * @param type Type of tree to be built.
+     */
+    void initialize(tree_type type = tree_type::binary);
+
+    /**
+     * @brief Replaces vertices, indices and normals with a compressed
+     * representation which takes several times less memory, at the cost of
+     * decoding them when they're accessed. Vertex positions are quantized to
+     * 16 bits per coordinate relative to the AABB of the vertices, thus the
+     * error on each axis is at most half the size of the AABB over 65535.
+     * Indices take 16 bits if there are no more than 65536 vertices, as in
+     * the submeshes of paged triangle meshes. Face normals and the normals of
+     * adjacent faces are octahedral-encoded into 32 bits. The triangle tree
+     * is rebuilt to enclose the quantized triangles. Must be called after
+     * the mesh is initialized.
+     */
+    void compress();
+
+    bool is_compressed() const {
+        return m_compressed;
+    }
+
+    /**
+     * @brief Whether the arrays of this mesh refer to memory owned elsewhere,
+     * such as the meshes returned by `view_baked_triangle_mesh`. A view can't
+     * be initialized or compressed.
+     */
+    bool is_view() const {
+        return m_edge_face_indices.is_view();
+    }
+
+    tree_type get_tree_type() const {
+        return m_tree_type;
+    }
 
     size_t num_vertices() const {
-        return m_vertices.size();
+        return m_compressed ? m_quantized_vertices.size() : m_vertices.size();
     }
 
     size_t num_edges() const {
@@ -72,21 +129,44 @@ public:
     }
 
     size_t num_triangles() const {
-        return m_indices.size();
+        return m_compact_indices.empty() ? m_indices.size() : m_compact_indices.size();
     }
 
     AABB get_aabb() const {
-        return m_triangle_tree.root_aabb();
+        return m_tree_type == tree_type::compact ?
+            m_compact_triangle_tree.root_aabb() : m_triangle_tree.root_aabb();
     }
 
     vector3 get_vertex_position(size_t vertex_idx) const {
+        if (m_compressed) {
+            EDYN_ASSERT(vertex_idx < m_quantized_vertices.size());
+            auto &q = m_quantized_vertices[vertex_idx];
+            return m_vertex_origin + vector3{scalar(q[0]), scalar(q[1]), scalar(q[2])} * m_vertex_scale;
+        }
+
         EDYN_ASSERT(vertex_idx < m_vertices.size());
         return m_vertices[vertex_idx];
     }
 
     triangle_vertices get_triangle_vertices(size_t tri_idx) const;
 
+    std::array<index_type, 3> get_triangle_vertex_indices(size_t tri_idx) const {
+        if (!m_compact_indices.empty()) {
+            EDYN_ASSERT(tri_idx < m_compact_indices.size());
+            auto &indices = m_compact_indices[tri_idx];
+            return {indices[0], indices[1], indices[2]};
+        }
+
+        EDYN_ASSERT(tri_idx < m_indices.size());
+        return m_indices[tri_idx];
+    }
+
     vector3 get_triangle_normal(size_t tri_idx) const {
+        if (m_compressed) {
+            EDYN_ASSERT(tri_idx < m_encoded_normals.size());
+            return octahedral_decode(m_encoded_normals[tri_idx]);
+        }
+
         EDYN_ASSERT(tri_idx < m_normals.size());
         return m_normals[tri_idx];
     }
@@ -94,8 +174,8 @@ public:
     std::array<vector3, 2> get_edge_vertices(size_t edge_idx) const {
         EDYN_ASSERT(edge_idx < m_edge_vertex_indices.size());
         return {
-            m_vertices[m_edge_vertex_indices[edge_idx][0]],
-            m_vertices[m_edge_vertex_indices[edge_idx][1]]
+            get_vertex_position(m_edge_vertex_indices[edge_idx][0]),
+            get_vertex_position(m_edge_vertex_indices[edge_idx][1])
         };
     }
 
@@ -114,33 +194,95 @@ public:
 
     template<typename Func>
     void visit_triangles(const AABB &aabb, Func func) const {
+        if (m_tree_type == tree_type::compact) {
+            m_compact_triangle_tree.query(aabb, func);
+            return;
+        }
+
         m_triangle_tree.query(aabb, [&](auto tree_node_idx) {
             auto tri_idx = m_triangle_tree.get_node(tree_node_idx).id;
             func(tri_idx);
         });
     }
 
+    /**
+     * @brief Visits the pairs of triangles of this mesh and another mesh that
+     * are within a distance of each other, i.e. whose AABBs intersect after
+     * being inflated by `threshold`. If both meshes have a binary tree, both
+     * trees are traversed at once, otherwise each triangle of this mesh near
+     * the other mesh is queried in the tree of the other mesh.
+     * @param other The other mesh.
+     * @param threshold Distance by which AABBs are inflated.
+     * @param func Called with the triangle index in this mesh and the triangle
+     * index in the other mesh.
+     */
+    template<typename Func>
+    void visit_triangle_pairs(const triangle_mesh &other, scalar threshold, Func func) const {
+        if (num_triangles() == 0 || other.num_triangles() == 0) {
+            return;
+        }
+
+        const auto inset = vector3_one * -threshold;
+
+        if (m_tree_type == tree_type::binary && other.m_tree_type == tree_type::binary) {
+            query_tree_pair(m_triangle_tree, uint32_t{0}, other.m_triangle_tree, uint32_t{0},
+                            EDYN_NULL_NODE, inset,
+                            [&](uint32_t node_idx, uint32_t other_node_idx) {
+                func(m_triangle_tree.get_node(node_idx).id,
+                     other.m_triangle_tree.get_node(other_node_idx).id);
+            });
+            return;
+        }
+
+        visit_triangles(other.get_aabb().inset(inset), [&](auto tri_idx) {
+            auto tri_aabb = get_triangle_aabb(get_triangle_vertices(tri_idx)).inset(inset);
+            other.visit_triangles(tri_aabb, [&](auto other_tri_idx) {
+                func(tri_idx, other_tri_idx);
+            });
+        });
+    }
+
     template<typename Func>
     void visit_all(Func func) const {
         for (size_t i = 0; i < num_triangles(); ++i) {
-            auto verts = triangle_vertices{
-                m_vertices[m_indices[i][0]],
-                m_vertices[m_indices[i][1]],
-                m_vertices[m_indices[i][2]]
-            };
-
-            func(i, verts);
+            func(i, get_triangle_vertices(i));
         }
     }
 
     template<typename Func>
     void raycast(const vector3 &p0, const vector3 &p1, Func func) const {
+        if (m_tree_type == tree_type::compact) {
+            m_compact_triangle_tree.raycast(p0, p1, func);
+            return;
+        }
+
         m_triangle_tree.raycast(p0, p1, [&](auto tree_node_idx) {
             auto tri_idx = m_triangle_tree.get_node(tree_node_idx).id;
             func(tri_idx);
         });
     }
 
+    /**
+     * @brief Visits the triangles whose AABB intersects any segment in the
+     * packet. Clip a lane of the packet after a hit to skip the triangles
+     * farther along it, or terminate it once any hit is enough.
+     * @param packet The segments in the object space of this mesh.
+     * @param func Called with the triangle index and the bit mask of the
+     * lanes whose segment intersects its AABB.
+     */
+    template<typename Func>
+    void raycast(const ray_packet &packet, Func func) const {
+        if (m_tree_type == tree_type::compact) {
+            m_compact_triangle_tree.raycast(packet, func);
+            return;
+        }
+
+        m_triangle_tree.raycast(packet, [&](auto tree_node_idx, unsigned mask) {
+            auto tri_idx = m_triangle_tree.get_node(tree_node_idx).id;
+            func(tri_idx, mask);
+        });
+    }
+
     bool is_convex_edge(size_t edge_idx) const {
         EDYN_ASSERT(edge_idx < m_is_convex_edge.size());
         return m_is_convex_edge[edge_idx];
@@ -151,10 +293,27 @@ public:
         return m_is_boundary_edge[edge_idx];
     }
 
+    /**
+     * @brief If this mesh is a submesh of a paged triangle mesh, returns the
+     * index of the submesh which contains the other face that shares an edge
+     * with a face of this submesh.
+     * @param edge_idx Edge index.
+     * @return Index of neighboring submesh or `invalid_submesh_index` if the
+     * edge is not on a seam between submeshes.
+     */
+    index_type get_edge_seam_submesh_index(size_t edge_idx) const {
+        if (m_edge_seam_submesh_indices.empty()) {
+            return invalid_submesh_index;
+        }
+
+        EDYN_ASSERT(edge_idx < m_edge_seam_submesh_indices.size());
+        return m_edge_seam_submesh_indices[edge_idx];
+    }
+
     index_type get_face_vertex_index(size_t tri_idx, size_t vertex_idx) const {
         EDYN_ASSERT(tri_idx < m_face_edge_indices.size());
         EDYN_ASSERT(vertex_idx < 3);
-        return m_indices[tri_idx][vertex_idx];
+        return get_triangle_vertex_indices(tri_idx)[vertex_idx];
     }
 
     index_type get_face_edge_index(size_t tri_idx, size_t edge_idx) const {
@@ -164,8 +323,14 @@ public:
     }
 
     vector3 get_adjacent_face_normal(size_t tri_idx, size_t edge_idx) const {
-        EDYN_ASSERT(tri_idx < m_adjacent_normals.size());
         EDYN_ASSERT(edge_idx < 3);
+
+        if (m_compressed) {
+            EDYN_ASSERT(tri_idx < m_encoded_adjacent_normals.size());
+            return octahedral_decode(m_encoded_adjacent_normals[tri_idx][edge_idx]);
+        }
+
+        EDYN_ASSERT(tri_idx < m_adjacent_normals.size());
         return m_adjacent_normals[tri_idx][edge_idx];
     }
 
@@ -212,32 +377,32 @@ public:
 
 private:
     // Vertex positions.
-    std::vector<vector3> m_vertices;
+    mapped_vector<vector3> m_vertices;
 
     // Vertex indices for each triangular face. Each element represents the
     // vertex indices of one triangle.
-    std::vector<std::array<index_type, 3>> m_indices;
+    mapped_vector<std::array<index_type, 3>> m_indices;
 
     // Face normals.
-    std::vector<vector3> m_normals;
+    mapped_vector<vector3> m_normals;
 
     // Normal vector of adjacent faces which share an edge with the i-th face.
-    std::vector<std::array<vector3, 3>> m_adjacent_normals;
+    mapped_vector<std::array<vector3, 3>> m_adjacent_normals;
 
     // Vertex indices for each unique edge. Each pair of values represent the
     // vertex indices for one edge.
-    std::vector<unordered_pair<index_type>> m_edge_vertex_indices;
+    mapped_vector<unordered_pair<index_type>> m_edge_vertex_indices;
 
     // Indices of edges for each vertex. Each element is a list of indices of
     // edges that share the vertex.
     flat_nested_array<index_type> m_vertex_edge_indices;
 
     // Each element represents the indices of the three edges of a face.
-    std::vector<std::array<index_type, 3>> m_face_edge_indices;
+    mapped_vector<std::array<index_type, 3>> m_face_edge_indices;
 
     // Indices of the two faces that share the i-th edge. Perimetral edges will
     // have the same value for both faces.
-    std::vector<std::array<index_type, 2>> m_edge_face_indices;
+    mapped_vector<std::array<index_type, 2>> m_edge_face_indices;
 
     // Indicates whether an edge is at the boundary. These edges are associated
     // with a single triangle.
@@ -246,14 +411,34 @@ private:
     // Whether an edge is convex.
     std::vector<bool> m_is_convex_edge;
 
+    // For submeshes of a paged triangle mesh, the index of the submesh which
+    // contains the other face of each edge which is on a seam between two
+    // submeshes. Empty for meshes which are not submeshes.
+    mapped_vector<index_type> m_edge_seam_submesh_indices;
+
     // Per-vertex friction and restitution coefficients.
-    std::vector<scalar> m_friction;
-    std::vector<scalar> m_restitution;
-    std::vector<material::id_type> m_material_ids;
+    mapped_vector<scalar> m_friction;
+    mapped_vector<scalar> m_restitution;
+    mapped_vector<material::id_type> m_material_ids;
+
+    // Compressed representation, which replaces the vertices, normals and
+    // adjacent normals above, and the indices if there are few enough
+    // vertices. See `compress`.
+    bool m_compressed {false};
+    // A quantized vertex `q` is at `m_vertex_origin + q * m_vertex_scale`.
+    vector3 m_vertex_origin {vector3_zero};
+    vector3 m_vertex_scale {vector3_zero};
+    mapped_vector<std::array<uint16_t, 3>> m_quantized_vertices;
+    mapped_vector<std::array<uint16_t, 3>> m_compact_indices;
+    mapped_vector<uint32_t> m_encoded_normals;
+    mapped_vector<std::array<uint32_t, 3>> m_encoded_adjacent_normals;
 
     scalar m_thickness {1};
 
+    // Only one of the trees is built, according to `m_tree_type`.
+    tree_type m_tree_type {tree_type::binary};
     static_tree m_triangle_tree;
+    compact_static_tree m_compact_triangle_tree;
 };
 
 }
@@ -0,0 +1,135 @@
+#ifndef EDYN_SIMULATION_BROADPHASE_MIRROR_HPP
+#define EDYN_SIMULATION_BROADPHASE_MIRROR_HPP
+
+#include <cstdint>
+#include <entt/entity/fwd.hpp>
+#include <entt/entity/entity.hpp>
+#include "edyn/comp/aabb.hpp"
+#include "edyn/collision/compact_tree.hpp"
+#include "edyn/parallel/triple_buffer.hpp"
+#include "edyn/sys/shift_origin.hpp"
+
+namespace edyn {
+
+class broadphase;
+class entity_map;
+
+/**
+ * Read-only copy of the broadphase trees of the simulation worker which is
+ * published after each step for synchronous queries in the main thread in
+ * asynchronous mode, if `edyn::settings::publish_broadphase` is enabled. The
+ * trees are compact trees whose leaves hold the entities of the main
+ * registry and they're triple buffered, thus the worker never waits for the
+ * main thread and the main thread queries the last state published without
+ * a round trip to the worker. Leaves of entities which do not exist in the
+ * main registry hold a null entity, which is never reported.
+ */
+class broadphase_mirror {
+    struct buffer {
+        // Number of origin shifts the worker had applied.
+        uint32_t origin_shift_count {0};
+        compact_tree procedural_tree;
+        compact_tree np_tree;
+        // Version of the non-procedural tree of the writer held in `np_tree`.
+        uint64_t np_tree_version {0};
+    };
+
+public:
+    /**
+     * @brief Publishes the trees of the broadphase. Called in the simulation
+     * worker after each step.
+     * @param bphase Broadphase of the simulation worker.
+     * @param emap Maps entities of the main registry into the worker registry.
+     * @param origin_shift_count Number of origin shifts applied in the worker.
+     */
+    void write(const broadphase &bphase, const entity_map &emap, uint32_t origin_shift_count = 0);
+
+    /**
+     * @brief Takes the latest published trees, if anything new was published
+     * since the last time. Called in the main thread.
+     * @param shifts Origin shifts requested in the main thread. Queries are
+     * shifted by the ones the worker had not applied yet, thus it must remain
+     * valid while the mirror is queried.
+     * @return Whether anything new was published.
+     */
+    bool read(const origin_shift_history *shifts = nullptr);
+
+    /**
+     * @brief Number of origin shifts applied in the worker when the trees
+     * taken in the last `read` were published.
+     */
+    uint32_t read_origin_shift_count() const {
+        return m_buffers.front().origin_shift_count;
+    }
+
+    template<typename Func>
+    void raycast(vector3 p0, vector3 p1, Func func) const;
+
+    template<typename Func>
+    void query_procedural(const AABB &aabb, Func func) const;
+
+    template<typename Func>
+    void query_non_procedural(const AABB &aabb, Func func) const;
+
+private:
+    vector3 offset() const {
+        return m_shifts ? m_shifts->offset_since(read_origin_shift_count()) : vector3_zero;
+    }
+
+    triple_buffer<buffer> m_buffers;
+
+    // State of the writer. The non-procedural tree rarely changes, thus it's
+    // only mapped and copied into the back buffer after it does.
+    compact_tree m_np_tree;
+    uint64_t m_np_tree_version {0};
+
+    // State of the reader.
+    const origin_shift_history *m_shifts {nullptr};
+};
+
+/**
+ * @brief Returns the broadphase mirror of the main registry in asynchronous
+ * mode if `edyn::settings::publish_broadphase` is enabled, or null otherwise.
+ */
+const broadphase_mirror * find_broadphase_mirror(const entt::registry &registry);
+
+template<typename Func>
+void broadphase_mirror::raycast(vector3 p0, vector3 p1, Func func) const {
+    // The trees are in the coordinates of the worker.
+    auto off = offset();
+    auto visit = [&](entt::entity entity) {
+        if (entity != entt::null) {
+            func(entity);
+        }
+    };
+
+    auto &front = m_buffers.front();
+    front.procedural_tree.raycast(p0 + off, p1 + off, visit);
+    front.np_tree.raycast(p0 + off, p1 + off, visit);
+}
+
+template<typename Func>
+void broadphase_mirror::query_procedural(const AABB &aabb, Func func) const {
+    auto off = offset();
+    auto shifted = AABB{aabb.min + off, aabb.max + off};
+    m_buffers.front().procedural_tree.query(shifted, [&](entt::entity entity) {
+        if (entity != entt::null) {
+            func(entity);
+        }
+    });
+}
+
+template<typename Func>
+void broadphase_mirror::query_non_procedural(const AABB &aabb, Func func) const {
+    auto off = offset();
+    auto shifted = AABB{aabb.min + off, aabb.max + off};
+    m_buffers.front().np_tree.query(shifted, [&](entt::entity entity) {
+        if (entity != entt::null) {
+            func(entity);
+        }
+    });
+}
+
+}
+
+#endif // EDYN_SIMULATION_BROADPHASE_MIRROR_HPP
@@ -17,12 +17,25 @@ class island_manager {
     entt::entity merge_islands(const std::vector<entt::entity> &island_entities,
                                const std::vector<entt::entity> &new_nodes,
                                const std::vector<entt::entity> &new_edges);
+    void destroy_merged_islands();
     void split_islands();
+    void split_island(entt::entity island_entity);
     void wake_up_islands();
 
     bool could_go_to_sleep(entt::entity island_entity) const;
     void put_islands_to_sleep();
 
+    void unfreeze_bodies_hit_by_contacts();
+    void freeze_resting_bodies();
+    void update_frozen_bodies();
+
+    void sort_storages_if_needed();
+
+    // Maintenance jobs, run by the `maintenance_scheduler` when deferred.
+    bool split_deferred_island();
+    bool optimize_graph();
+    bool sort_storages();
+
     void on_construct_graph_node(entt::registry &, entt::entity);
     void on_construct_graph_edge(entt::registry &, entt::entity);
     void on_destroy_graph_node(entt::registry &, entt::entity);
@@ -41,6 +54,15 @@ public:
 
     void set_procedural(entt::entity entity, bool is_procedural);
 
+    /**
+     * @brief Changes whether many entities are procedural at once. Entities
+     * which become procedural are grouped by the islands they touch and each
+     * group of islands is merged only once, instead of once per entity.
+     * @param entities Graph node entities, each of them appearing once.
+     * @param is_procedural Whether they became procedural.
+     */
+    void set_procedural(const std::vector<entt::entity> &entities, bool is_procedural);
+
     void set_last_time(double time) {
         m_last_time = time;
     }
@@ -50,9 +72,22 @@ private:
     std::vector<entt::entity> m_new_graph_nodes;
     std::vector<entt::entity> m_new_graph_edges;
     entt::sparse_set m_islands_to_split;
+    // Islands due to be checked for splits which are split one at a time by
+    // a maintenance job, if there is a maintenance budget.
+    entt::sparse_set m_deferred_splits;
     entt::sparse_set m_islands_to_wake_up;
+    // Islands which were absorbed by other islands in a merge. They're
+    // destroyed together after all merges of an update are done.
+    std::vector<entt::entity> m_merged_island_entities;
+    // Non-procedural nodes already inserted into the connected component
+    // being visited while initializing new nodes.
+    entt::sparse_set m_connected_non_procedural;
     std::vector<entt::scoped_connection> m_connections;
     double m_last_time;
+    // Number of updates and of entities moved to another island since the
+    // storages were last sorted by island.
+    unsigned m_updates_since_storage_sort {0};
+    size_t m_residents_moved_since_storage_sort {0};
 };
 
 }
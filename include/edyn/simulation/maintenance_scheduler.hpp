@@ -0,0 +1,120 @@
+#ifndef EDYN_SIMULATION_MAINTENANCE_SCHEDULER_HPP
+#define EDYN_SIMULATION_MAINTENANCE_SCHEDULER_HPP
+
+#include <vector>
+#include <cstdint>
+#include <entt/entity/fwd.hpp>
+#include <entt/signal/delegate.hpp>
+
+namespace edyn {
+
+/**
+ * @brief Order in which maintenance jobs are run. Jobs of the same priority
+ * run in the order they were scheduled.
+ */
+enum class maintenance_priority : uint8_t {
+    high,
+    normal,
+    low
+};
+
+/**
+ * @brief Runs occasional and heavy work which isn't needed right away, such
+ * as splitting islands, in slices at the end of each step, as much as fits
+ * in `settings::maintenance_budget`, instead of all of it in the step where
+ * it was triggered. This spreads step time spikes over many steps. It's kept
+ * in the context of the registry where the simulation runs.
+ */
+class maintenance_scheduler {
+public:
+    /**
+     * @brief Performs a slice of a job and returns whether the job is done.
+     * Jobs which aren't done are run again later.
+     */
+    using job_delegate_t = entt::delegate<bool(void)>;
+
+    /**
+     * @brief Schedules a job, which must not be scheduled already.
+     * @param job The job.
+     * @param priority Priority of the job.
+     */
+    void schedule(job_delegate_t job, maintenance_priority priority = maintenance_priority::normal);
+
+    /**
+     * @brief Removes a job, e.g. before the instance it is bound to is
+     * destroyed.
+     * @param job The job.
+     */
+    void cancel(job_delegate_t job);
+
+    bool contains(job_delegate_t job) const;
+
+    bool empty() const {
+        return m_jobs.empty();
+    }
+
+    /**
+     * @brief Runs slices of the jobs in order of priority until all jobs are
+     * done or the budget is exhausted. At least one slice is run if there is
+     * a job, so jobs always make progress.
+     * @param budget Time budget in seconds.
+     * @return Number of slices run.
+     */
+    unsigned run(double budget);
+
+    /**
+     * @brief Runs all jobs until they're done.
+     * @return Number of slices run.
+     */
+    unsigned finish();
+
+private:
+    struct entry {
+        job_delegate_t job;
+        maintenance_priority priority;
+        uint64_t sequence;
+    };
+
+    struct entry_compare {
+        bool operator()(const entry &lhs, const entry &rhs) const {
+            // The top of the heap is the greatest entry, thus the one with
+            // the highest priority which was scheduled first.
+            if (lhs.priority != rhs.priority) {
+                return lhs.priority > rhs.priority;
+            }
+
+            return lhs.sequence > rhs.sequence;
+        }
+    };
+
+    // Runs a slice of the job on top of the heap.
+    void run_top();
+
+    // Binary heap of jobs, not including the one which is running.
+    std::vector<entry> m_jobs;
+    uint64_t m_next_sequence {0};
+    job_delegate_t m_running_job;
+    bool m_running_job_cancelled {false};
+};
+
+/**
+ * @brief Force all deferred maintenance work to complete. In asynchronous
+ * execution mode, this happens in the simulation worker before its next
+ * update.
+ * @param registry Data source.
+ */
+void finish_maintenance(entt::registry &registry);
+
+}
+
+namespace edyn::internal {
+
+/**
+ * @brief Runs the maintenance jobs of a registry after a step, under the
+ * budget in its settings. All jobs are finished if there is no budget.
+ */
+void run_maintenance(entt::registry &registry);
+
+}
+
+#endif // EDYN_SIMULATION_MAINTENANCE_SCHEDULER_HPP
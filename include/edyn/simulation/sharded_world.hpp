@@ -0,0 +1,179 @@
+#ifndef EDYN_SIMULATION_SHARDED_WORLD_HPP
+#define EDYN_SIMULATION_SHARDED_WORLD_HPP
+
+#include <memory>
+#include <vector>
+#include <entt/entity/fwd.hpp>
+#include <entt/entity/entity.hpp>
+#include <entt/signal/sigh.hpp>
+#include "edyn/edyn.hpp"
+#include "edyn/comp/aabb.hpp"
+#include "edyn/collision/raycast.hpp"
+#include "edyn/collision/query_aabb.hpp"
+#include "edyn/parallel/query_future.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Refers to an entity in one of the shards of a `sharded_world`.
+ */
+struct sharded_entity {
+    size_t shard;
+    entt::entity entity {entt::null};
+};
+
+/**
+ * @brief Result of a query done in all shards of a `sharded_world`, which is
+ * ready once every shard has answered.
+ */
+template<typename T>
+class sharded_query_future {
+public:
+    sharded_query_future(std::vector<query_future<T>> futures)
+        : m_futures(std::move(futures))
+    {}
+
+    size_t size() const {
+        return m_futures.size();
+    }
+
+    bool is_ready() const {
+        for (auto &future : m_futures) {
+            if (!future.is_ready()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void wait() const {
+        for (auto &future : m_futures) {
+            future.wait();
+        }
+    }
+
+    /**
+     * @brief Blocks until the given shard has answered and returns its result,
+     * where entities belong to the registry of that shard.
+     */
+    const T & get(size_t shard) {
+        return m_futures[shard].get();
+    }
+
+private:
+    std::vector<query_future<T>> m_futures;
+};
+
+struct sharded_raycast_result {
+    size_t shard;
+    raycast_result result;
+};
+
+/**
+ * @brief Blocks until all shards have answered and returns the closest hit.
+ */
+sharded_raycast_result closest_raycast_result(sharded_query_future<raycast_result> &future);
+
+/**
+ * Partitions the world into spatial regions, each one with its own registry
+ * running in asynchronous mode, thus each region is simulated in a separate
+ * simulation worker with its own broadphase. Dynamic bodies are created in the
+ * shard whose region contains them, while static and kinematic bodies are
+ * created in every shard. Once the center of the AABB of an island leaves the
+ * region of its shard, the entire island migrates into the shard whose region
+ * contains it, which gives it new entities. Bodies in different shards do not
+ * collide with each other, thus borders are best placed where islands seldom
+ * meet, such as between distinct areas of a large world.
+ */
+class sharded_world {
+    using migrate_func_t = void(const sharded_entity &from, const sharded_entity &to);
+
+    void migrate_island(size_t from, size_t to, const std::vector<entt::entity> &entities);
+
+public:
+    /**
+     * @brief Creates one shard for each region.
+     * @param regions Region of each shard. If regions overlap, the first one
+     * containing a point takes it.
+     * @param config Configuration for all shards. Must be asynchronous.
+     */
+    sharded_world(const std::vector<AABB> &regions, const init_config &config = {});
+    ~sharded_world();
+
+    sharded_world(const sharded_world &) = delete;
+    sharded_world & operator=(const sharded_world &) = delete;
+
+    size_t num_shards() const {
+        return m_shards.size();
+    }
+
+    entt::registry & registry(size_t shard) {
+        return *m_shards[shard].registry;
+    }
+
+    const AABB & region(size_t shard) const {
+        return m_shards[shard].region;
+    }
+
+    /**
+     * @brief Finds the shard whose region contains a point, or the one with
+     * the closest region if none does.
+     */
+    size_t shard_at(const vector3 &point) const;
+
+    /**
+     * @brief Creates a dynamic rigid body in the shard whose region contains
+     * its position.
+     */
+    sharded_entity make_rigidbody(const rigidbody_def &def);
+
+    /**
+     * @brief Creates a static or kinematic rigid body in every shard. Kinematic
+     * bodies must be moved in all shards.
+     * @return Entity of the body in each shard.
+     */
+    std::vector<entt::entity> make_shared_rigidbody(const rigidbody_def &def);
+
+    /**
+     * @brief Updates all shards and migrates islands which left their region.
+     */
+    void update();
+
+    /**
+     * @brief Raycasts in all shards.
+     */
+    sharded_query_future<raycast_result> raycast_async(vector3 p0, vector3 p1);
+
+    /**
+     * @brief Queries an AABB in all shards.
+     */
+    sharded_query_future<query_aabb_result> query_aabb_async(const AABB &aabb,
+                                                             bool query_procedural,
+                                                             bool query_non_procedural,
+                                                             bool query_islands);
+
+    /**
+     * @brief Signal triggered for each entity of a migrating island, after
+     * it is created in the new shard and before it is destroyed in the old.
+     * Shared components are copied into the new entity, thus any other
+     * component has to be copied by the observer.
+     */
+    entt::sink<entt::sigh<migrate_func_t>> on_migrate() {
+        return {m_migrate_signal};
+    }
+
+private:
+    struct shard {
+        AABB region;
+        std::unique_ptr<entt::registry> registry;
+    };
+
+    std::vector<shard> m_shards;
+    // Entity of each shared body in every shard.
+    std::vector<std::vector<entt::entity>> m_shared_bodies;
+    entt::sigh<migrate_func_t> m_migrate_signal;
+};
+
+}
+
+#endif // EDYN_SIMULATION_SHARDED_WORLD_HPP
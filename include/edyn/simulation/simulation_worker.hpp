@@ -3,6 +3,7 @@
 
 #include <condition_variable>
 #include <memory>
+#include <unordered_map>
 #include <atomic>
 #include <entt/signal/sigh.hpp>
 #include <entt/entity/fwd.hpp>
@@ -16,7 +17,10 @@
 #include "edyn/replication/entity_map.hpp"
 #include "edyn/replication/registry_operation_builder.hpp"
 #include "edyn/replication/registry_operation_observer.hpp"
+#include "edyn/simulation/broadphase_mirror.hpp"
 #include "edyn/simulation/island_manager.hpp"
+#include "edyn/simulation/transform_mirror.hpp"
+#include "edyn/time/tick_jitter.hpp"
 #include "edyn/util/polyhedron_shape_initializer.hpp"
 
 namespace edyn {
@@ -31,12 +35,14 @@ class simulation_worker final {
     void init();
     void deinit();
     void sync();
+    void write_mirrors();
+    void send_step_profile();
     void run();
     void update();
+    void wait_next_update(double dt, double &deadline, double &i_term);
 
     void wake_up_affected_islands(const registry_operation &ops);
     void consume_raycast_results();
-    void mark_transforms_replaced();
 
 public:
     simulation_worker(const settings &settings,
@@ -54,21 +60,63 @@ public:
     void on_set_reg_op_ctx(message<msg::set_registry_operation_context> &msg);
     void on_set_material_table(message<msg::set_material_table> &msg);
     void on_set_com(message<msg::set_com> &);
+    void on_shift_origin(message<msg::shift_origin> &);
+    void on_finish_maintenance(message<msg::finish_maintenance> &);
     void on_raycast_request(message<msg::raycast_request> &);
+    void on_raycast_batch_request(message<msg::raycast_batch_request> &);
+    void on_shape_cast_request(message<msg::shape_cast_request> &);
+    void on_overlap_request(message<msg::overlap_request> &);
     void on_query_aabb_request(message<msg::query_aabb_request> &);
+    void on_query_aabb_batch_request(message<msg::query_aabb_batch_request> &);
     void on_query_aabb_of_interest_request(message<msg::query_aabb_of_interest_request> &);
+    void on_query_memory_stats_request(message<msg::query_memory_stats_request> &);
     void on_apply_network_pools(message<msg::apply_network_pools> &);
     void on_extrapolation_result(message<extrapolation_result> &);
     void on_wake_up_residents(message<msg::wake_up_residents> &);
     void on_change_rigidbody_kind(message<msg::change_rigidbody_kind> &);
 
-    void start();
+    // Starts the simulation thread, which sends its updates and responses
+    // to the given queue of the main thread.
+    void start(message_queue_id main_queue);
     void stop();
 
+    message_queue_id queue_id() const {
+        return m_message_queue.id;
+    }
+
+    // Transforms of dynamic bodies written after each step, to be read in the
+    // main thread.
+    transform_mirror & get_transform_mirror() {
+        return m_transform_mirror;
+    }
+
+    // Broadphase trees written after each step if enabled, to be queried in
+    // the main thread.
+    broadphase_mirror & get_broadphase_mirror() {
+        return m_broadphase_mirror;
+    }
+
+    const broadphase_mirror & get_broadphase_mirror() const {
+        return m_broadphase_mirror;
+    }
+
+    tick_jitter_recorder & get_tick_jitter() {
+        return m_tick_jitter;
+    }
+
+    const tick_jitter_recorder & get_tick_jitter() const {
+        return m_tick_jitter;
+    }
+
 private:
     entt::registry m_registry;
     entity_map m_entity_map;
     raycast_service m_raycast_service;
+    // Raycasts whose result is set into a future instead of being sent back.
+    std::unordered_map<unsigned, query_promise<raycast_result>> m_raycast_promises;
+    transform_mirror m_transform_mirror;
+    broadphase_mirror m_broadphase_mirror;
+    tick_jitter_recorder m_tick_jitter;
     island_manager m_island_manager;
     polyhedron_shape_initializer m_poly_initializer;
     solver m_solver;
@@ -79,19 +127,29 @@ private:
         msg::set_registry_operation_context,
         msg::step_simulation,
         msg::set_com,
+        msg::shift_origin,
+        msg::finish_maintenance,
         msg::set_material_table,
         msg::update_entities,
         msg::apply_network_pools,
         msg::wake_up_residents,
         msg::change_rigidbody_kind,
         msg::raycast_request,
+        msg::raycast_batch_request,
+        msg::shape_cast_request,
+        msg::overlap_request,
         msg::query_aabb_request,
+        msg::query_aabb_batch_request,
         msg::query_aabb_of_interest_request,
+        msg::query_memory_stats_request,
         extrapolation_result> m_message_queue;
+    message_queue_id m_main_queue;
 
     std::unique_ptr<registry_operation_builder> m_op_builder;
     std::unique_ptr<registry_operation_observer> m_op_observer;
     bool m_importing;
+    // Number of origin shifts applied, sent along with the state.
+    uint32_t m_origin_shift_count {0};
 
     std::atomic<bool> m_running {true};
     std::atomic<bool> m_finished {false};
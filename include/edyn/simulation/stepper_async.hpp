@@ -7,9 +7,12 @@
 #include <entt/signal/sigh.hpp>
 #include "edyn/collision/query_aabb.hpp"
 #include "edyn/collision/raycast.hpp"
+#include "edyn/collision/overlap.hpp"
+#include "edyn/collision/shape_cast.hpp"
 #include "edyn/comp/aabb.hpp"
 #include "edyn/config/config.h"
 #include "edyn/simulation/simulation_worker.hpp"
+#include "edyn/sys/shift_origin.hpp"
 #include "edyn/parallel/message.hpp"
 #include "edyn/replication/registry_operation_builder.hpp"
 #include "edyn/replication/registry_operation_observer.hpp"
@@ -40,10 +43,34 @@ class stepper_async final {
         query_aabb_delegate_type delegate;
     };
 
+    struct worker_raycast_batch_context {
+        raycast_batch_delegate_type delegate;
+    };
+
+    // Individual shape casts are sent as a batch of one, in which case the
+    // single delegate is connected instead of the batch delegate.
+    struct worker_shape_cast_context {
+        shape_cast_delegate_type delegate;
+        shape_cast_batch_delegate_type batch_delegate;
+    };
+
+    // Same as for shape casts.
+    struct worker_overlap_context {
+        overlap_delegate_type delegate;
+        overlap_batch_delegate_type batch_delegate;
+    };
+
+    struct worker_query_aabb_batch_context {
+        query_aabb_batch_delegate_type delegate;
+    };
+
+    entt::entity map_result_entity(entt::entity) const;
+
 public:
     stepper_async(stepper_async const&) = delete;
     stepper_async operator=(stepper_async const&) = delete;
     stepper_async(entt::registry &, double time);
+    ~stepper_async();
 
     void on_construct_shared(entt::registry &, entt::entity);
 
@@ -51,17 +78,26 @@ public:
     void on_destroy_graph_edge(entt::registry &, entt::entity);
 
     void on_step_update(message<msg::step_update> &);
+    void on_step_profile_update(message<msg::step_profile_update> &);
     void on_raycast_response(message<msg::raycast_response> &);
+    void on_raycast_batch_response(message<msg::raycast_batch_response> &);
+    void on_shape_cast_response(message<msg::shape_cast_response> &);
+    void on_overlap_response(message<msg::overlap_response> &);
     void on_query_aabb_response(message<msg::query_aabb_response> &);
+    void on_query_aabb_batch_response(message<msg::query_aabb_batch_response> &);
 
     void update(double current_time);
 
     void set_paused(bool);
-    void step_simulation();
+    void step_simulation(unsigned num_steps = 1);
 
     void set_center_of_mass(entt::entity entity, const vector3 &com);
+    void shift_origin(const vector3 &offset);
+    void finish_maintenance();
     void wake_up_entity(entt::entity entity);
+    void wake_up_entities(const std::vector<entt::entity> &entities);
     void set_rigidbody_kind(entt::entity entity, rigidbody_kind kind);
+    void set_rigidbody_kind(const std::vector<entt::entity> &entities, rigidbody_kind kind);
 
     // Call when settings have changed in the registry's context. It will
     // propagate changes to island workers.
@@ -72,12 +108,13 @@ public:
     void material_table_changed();
 
     double get_simulation_timestamp() const { return m_sim_time; }
+    message_queue_id worker_queue_id() const { return m_worker.queue_id(); }
     double get_presentation_delay() const { return m_presentation_delay; }
 
     template<typename Message, typename... Args>
     void send_message_to_worker(Args &&... args) {
-        message_dispatcher::global().send<Message>({"worker"},
-                                                   m_message_queue_handle.identifier,
+        message_dispatcher::global().send<Message>(m_worker.queue_id(),
+                                                   m_message_queue_handle.id,
                                                    std::forward<Args>(args)...);
     }
 
@@ -85,13 +122,62 @@ public:
                             const raycast_delegate_type &delegate,
                             std::vector<entt::entity> ignore_entities = {});
 
+    query_future<raycast_result> raycast_future(vector3 p0, vector3 p1,
+                                                std::vector<entt::entity> ignore_entities = {});
+
+    raycast_id_type raycast_batch(std::vector<raycast_query> rays,
+                                  const raycast_batch_delegate_type &delegate,
+                                  std::vector<entt::entity> ignore_entities = {},
+                                  bool any_hit = false);
+
+    shape_cast_id_type shape_cast(const shape_cast_query &query,
+                                  const shape_cast_delegate_type &delegate,
+                                  std::vector<entt::entity> ignore_entities = {});
+
+    shape_cast_id_type shape_cast_batch(std::vector<shape_cast_query> queries,
+                                        const shape_cast_batch_delegate_type &delegate,
+                                        std::vector<entt::entity> ignore_entities = {});
+
+    overlap_id_type overlap(const overlap_query &query,
+                            const overlap_delegate_type &delegate,
+                            std::vector<entt::entity> ignore_entities = {});
+
+    overlap_id_type overlap_batch(std::vector<overlap_query> queries,
+                                  const overlap_batch_delegate_type &delegate,
+                                  std::vector<entt::entity> ignore_entities = {});
+
     query_aabb_id_type query_aabb(const AABB &aabb, const query_aabb_delegate_type &delegate,
                                   bool query_procedural,
                                   bool query_non_procedural,
                                   bool query_islands);
 
+    query_future<query_aabb_result> query_aabb_future(const AABB &aabb,
+                                                      bool query_procedural,
+                                                      bool query_non_procedural,
+                                                      bool query_islands);
+
+    query_aabb_id_type query_aabb_batch(std::vector<AABB> aabbs,
+                                        const query_aabb_batch_delegate_type &delegate,
+                                        bool query_procedural,
+                                        bool query_non_procedural,
+                                        bool query_islands);
+
     query_aabb_id_type query_aabb_of_interest(const AABB &aabb, const query_aabb_delegate_type &delegate);
 
+    // Broadphase trees last published by the worker, which are only kept up
+    // to date if `settings::publish_broadphase` is enabled.
+    const broadphase_mirror & get_broadphase_mirror() const {
+        return m_worker.get_broadphase_mirror();
+    }
+
+    tick_jitter_histogram get_tick_jitter_histogram() const {
+        return m_worker.get_tick_jitter().histogram();
+    }
+
+    void reset_tick_jitter_histogram() {
+        m_worker.get_tick_jitter().reset();
+    }
+
 private:
     entt::registry *m_registry;
 
@@ -102,8 +188,13 @@ private:
     std::unique_ptr<registry_operation_observer> m_op_observer;
     message_queue_handle<
         msg::step_update,
+        msg::step_profile_update,
         msg::raycast_response,
-        msg::query_aabb_response
+        msg::raycast_batch_response,
+        msg::shape_cast_response,
+        msg::overlap_response,
+        msg::query_aabb_response,
+        msg::query_aabb_batch_response
     > m_message_queue_handle;
 
     bool m_importing {false};
@@ -114,12 +205,26 @@ private:
     bool m_should_calculate_presentation_delay {false};
     bool m_adjusting_presentation_delay {true};
     bool m_paused {false};
+    // Shifts which state received from the worker might not include yet.
+    origin_shift_history m_origin_shifts;
+    uint32_t m_step_update_origin_shift_count {0};
+    // Replace operations of a step update grouped by component, which are
+    // applied in parallel. Reused between step updates.
+    std::vector<std::vector<operation_base *>> m_replace_groups;
 
     raycast_id_type m_next_raycast_id {};
     std::map<raycast_id_type, worker_raycast_context> m_raycast_ctx;
+    std::map<raycast_id_type, worker_raycast_batch_context> m_raycast_batch_ctx;
+
+    shape_cast_id_type m_next_shape_cast_id {};
+    std::map<shape_cast_id_type, worker_shape_cast_context> m_shape_cast_ctx;
+
+    overlap_id_type m_next_overlap_id {};
+    std::map<overlap_id_type, worker_overlap_context> m_overlap_ctx;
 
     query_aabb_id_type m_next_query_aabb_id {};
     std::map<query_aabb_id_type, worker_query_aabb_context> m_query_aabb_ctx;
+    std::map<query_aabb_id_type, worker_query_aabb_batch_context> m_query_aabb_batch_ctx;
 
     std::vector<entt::scoped_connection> m_connections;
 };
@@ -1,6 +1,7 @@
 #ifndef EDYN_SIMULATION_STEPPER_SEQUENTIAL_HPP
 #define EDYN_SIMULATION_STEPPER_SEQUENTIAL_HPP
 
+#include <atomic>
 #include <entt/entity/fwd.hpp>
 #include "edyn/dynamics/solver.hpp"
 #include "edyn/simulation/island_manager.hpp"
@@ -13,11 +14,32 @@ namespace edyn {
  * registry. It can optionally parallelize many steps of the simulation.
  */
 class stepper_sequential {
+    void run_step();
+    void run_update_task(unsigned, unsigned);
+
 public:
     stepper_sequential(entt::registry &registry, double time, bool multithreaded);
 
     void update(double time);
+
+    /**
+     * @brief Runs `update` in a worker thread, which must be waited on with
+     * `end_update` before the registry is accessed again.
+     */
+    void begin_update(double time);
+    void end_update();
+
+    bool is_updating() const {
+        return m_updating;
+    }
+
     void step_simulation(double time);
+
+    /**
+     * @brief Runs many steps back to back for a paused simulation, without
+     * updating presentation.
+     */
+    void batch_step_simulation(unsigned num_steps);
     void set_paused(bool paused);
 
     bool is_paused() const {
@@ -32,6 +54,10 @@ public:
         return m_island_manager;
     }
 
+    const solver & get_solver() const {
+        return m_solver;
+    }
+
 private:
     entt::registry *m_registry;
     island_manager m_island_manager;
@@ -42,6 +68,11 @@ private:
     double m_last_time {};
     bool m_multithreaded;
     bool m_paused;
+
+    // State of the update started with `begin_update`.
+    double m_update_time {};
+    bool m_updating {false};
+    std::atomic<bool> m_update_done {true};
 };
 
 }
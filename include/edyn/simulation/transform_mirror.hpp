@@ -0,0 +1,114 @@
+#ifndef EDYN_SIMULATION_TRANSFORM_MIRROR_HPP
+#define EDYN_SIMULATION_TRANSFORM_MIRROR_HPP
+
+#include <cstdint>
+#include <vector>
+#include <entt/entity/fwd.hpp>
+#include <entt/entity/entity.hpp>
+#include "edyn/math/vector3.hpp"
+#include "edyn/math/quaternion.hpp"
+#include "edyn/parallel/triple_buffer.hpp"
+
+namespace edyn {
+
+class entity_map;
+class origin_shift_history;
+
+/**
+ * Slot of a body in the transform mirror, assigned in the registry of the
+ * simulation worker.
+ */
+struct transform_mirror_slot {
+    uint32_t index;
+};
+
+/**
+ * Carries the transforms and velocities of dynamic bodies, and of kinematic
+ * bodies which follow a `kinematic_track`, from the simulation worker to the
+ * main thread after each step, instead of having them replaced one by one
+ * through a `registry_operation`. Each body has a stable slot in arrays which
+ * are triple buffered, so the worker never waits for the main thread and the
+ * main thread assigns the values to its bodies directly, without entity map
+ * lookups. Bodies whose state barely changed since it was last sent are
+ * skipped, as are bodies which do not exist in the main registry.
+ */
+class transform_mirror {
+    struct buffer {
+        // Value of `m_step` when this buffer was written.
+        uint64_t step {0};
+        double timestamp {0};
+        // Number of origin shifts the worker had applied.
+        uint32_t origin_shift_count {0};
+        // Entity in the main registry of each slot, or null if free.
+        std::vector<entt::entity> entities;
+        // Step in which the values of each slot last changed.
+        std::vector<uint64_t> changed_step;
+        std::vector<vector3> positions;
+        std::vector<quaternion> orientations;
+        std::vector<vector3> linvels;
+        std::vector<vector3> angvels;
+    };
+
+    void assign_slot(entt::registry &, entt::entity local, entt::entity remote);
+    bool update_slot(uint32_t index, const vector3 &pos, const quaternion &orn,
+                     const vector3 &linvel, const vector3 &angvel);
+
+public:
+    /**
+     * @brief Publishes the state of awake dynamic bodies and of kinematic
+     * bodies which follow a track. Called in the simulation worker after
+     * each step.
+     * @param registry Registry of the simulation worker.
+     * @param emap Maps entities of the main registry into the worker registry.
+     * @param timestamp Simulation time of the step.
+     * @param origin_shift_count Number of origin shifts applied in the worker.
+     */
+    void write(entt::registry &registry, const entity_map &emap, double timestamp,
+               uint32_t origin_shift_count = 0);
+
+    /**
+     * @brief Assigns the latest published state to the bodies in the main
+     * registry, if anything new was published since the last time. Called
+     * in the main thread.
+     * @param registry The main registry.
+     * @param timestamp Set to the simulation time of the published state.
+     * @param shifts Origin shifts requested in the main thread. Positions
+     * published before some of them were applied are shifted accordingly.
+     * @return Whether anything new was published.
+     */
+    bool read(entt::registry &registry, double &timestamp,
+              const origin_shift_history *shifts = nullptr);
+
+    /**
+     * @brief Number of origin shifts applied in the worker when the state
+     * assigned in the last `read` was published.
+     */
+    uint32_t read_origin_shift_count() const {
+        return m_read_origin_shift_count;
+    }
+
+    void on_destroy_slot(entt::registry &, entt::entity);
+
+private:
+    triple_buffer<buffer> m_buffers;
+
+    // State of the writer.
+    uint64_t m_step {0};
+    std::vector<entt::entity> m_local_entities;
+    std::vector<entt::entity> m_remote_entities;
+    std::vector<uint64_t> m_changed_step;
+    // State last sent for each slot.
+    std::vector<vector3> m_positions;
+    std::vector<quaternion> m_orientations;
+    std::vector<vector3> m_linvels;
+    std::vector<vector3> m_angvels;
+    std::vector<uint32_t> m_free_slots;
+
+    // State of the reader.
+    uint64_t m_read_step {0};
+    uint32_t m_read_origin_shift_count {0};
+};
+
+}
+
+#endif // EDYN_SIMULATION_TRANSFORM_MIRROR_HPP
@@ -10,7 +10,8 @@
 namespace edyn {
 
 inline void apply_gravity(entt::registry &registry, scalar dt) {
-    auto view = registry.view<linvel, gravity, dynamic_tag>(exclude_sleeping_disabled);
+    // Frozen bodies are treated as static, thus they must not gain velocity.
+    auto view = registry.view<linvel, gravity, dynamic_tag>(entt::exclude<sleeping_tag, disabled_tag, frozen_tag>);
     view.each([&](linvel &vel, gravity &g) {
         vel += g * dt;
     });
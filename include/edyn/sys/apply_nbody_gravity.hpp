@@ -0,0 +1,28 @@
+#ifndef EDYN_SYS_APPLY_NBODY_GRAVITY_HPP
+#define EDYN_SYS_APPLY_NBODY_GRAVITY_HPP
+
+#include <vector>
+#include <entt/entity/fwd.hpp>
+#include "edyn/math/scalar.hpp"
+
+namespace edyn {
+
+class nbody_octree;
+
+/**
+ * @brief Applies the gravitational attraction between all dynamic rigid
+ * bodies to their linear velocity, if `edyn::settings::nbody_gravity` is
+ * enabled. Sleeping bodies attract the others but are not accelerated.
+ * @param registry The registry to be updated.
+ * @param octree Octree rebuilt from the bodies, reused between steps.
+ * @param entities Buffer for the bodies that are accelerated, reused between
+ * steps.
+ * @param dt Time step.
+ * @param mt Whether to calculate the accelerations in worker threads.
+ */
+void apply_nbody_gravity(entt::registry &registry, nbody_octree &octree,
+                         std::vector<entt::entity> &entities, scalar dt, bool mt);
+
+}
+
+#endif // EDYN_SYS_APPLY_NBODY_GRAVITY_HPP
@@ -0,0 +1,67 @@
+#ifndef EDYN_SYS_SHIFT_ORIGIN_HPP
+#define EDYN_SYS_SHIFT_ORIGIN_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <entt/entity/fwd.hpp>
+#include "edyn/math/vector3.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Moves the origin of the world to `offset`, i.e. subtracts it from
+ * the positions, origins, presentation positions, AABBs and kinematic track
+ * keyframes of all entities, including sleeping ones, and translates the
+ * broadphase trees if there's a broadphase in the registry. Components are
+ * assigned directly, without triggering any signal.
+ * @param registry Data source.
+ * @param offset The new origin in the current coordinates.
+ */
+void shift_origin(entt::registry &registry, const vector3 &offset);
+
+/**
+ * Origin shifts requested in the main thread which the simulation worker
+ * might not have applied yet in the state it published. Positions published
+ * after `n` shifts are brought into the current frame by subtracting the
+ * total offset of the shifts that came after the first `n`.
+ */
+class origin_shift_history {
+public:
+    void push(const vector3 &offset) {
+        m_offsets.push_back(offset);
+    }
+
+    // Number of shifts pushed so far.
+    uint32_t count() const {
+        return m_first + static_cast<uint32_t>(m_offsets.size());
+    }
+
+    // Total offset of the shifts after the first `n`. Shifts which were
+    // already forgotten are taken as applied.
+    vector3 offset_since(uint32_t n) const {
+        auto offset = vector3_zero;
+
+        for (auto i = std::max(n, m_first); i < count(); ++i) {
+            offset += m_offsets[i - m_first];
+        }
+
+        return offset;
+    }
+
+    // Forgets the first `n` shifts once no state older than them will arrive.
+    void acknowledge(uint32_t n) {
+        if (n > m_first) {
+            m_offsets.erase(m_offsets.begin(), m_offsets.begin() + (n - m_first));
+            m_first = n;
+        }
+    }
+
+private:
+    std::vector<vector3> m_offsets;
+    uint32_t m_first {0};
+};
+
+}
+
+#endif // EDYN_SYS_SHIFT_ORIGIN_HPP
@@ -0,0 +1,22 @@
+#ifndef EDYN_SYS_SORT_STORAGES_BY_ISLAND_HPP
+#define EDYN_SYS_SORT_STORAGES_BY_ISLAND_HPP
+
+#include <entt/entity/fwd.hpp>
+
+namespace edyn {
+
+/**
+ * @brief Sorts the storages of the components of procedural rigid bodies,
+ * constraints and contact manifolds so that the entities of each island are
+ * next to each other, in the order they appear in the island, with the awake
+ * islands before the sleeping ones. The groups of awake entities of the hot
+ * systems are sorted in the same way, since they're iterated in their own
+ * order. All entities remain valid but references to their components are
+ * invalidated.
+ * @param registry Data source.
+ */
+void sort_storages_by_island(entt::registry &registry);
+
+}
+
+#endif // EDYN_SYS_SORT_STORAGES_BY_ISLAND_HPP
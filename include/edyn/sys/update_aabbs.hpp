@@ -21,8 +21,22 @@ void update_aabbs(entt::registry &registry);
  */
 void update_aabb(entt::registry &registry, entt::entity entity);
 
+/**
+ * @brief Update AABBs of kinematic entities only.
+ * @param registry The registry to be updated.
+ */
+void update_kinematic_aabbs(entt::registry &registry);
+
 void update_island_aabbs(entt::registry &registry);
 
+/**
+ * @brief Update the AABB of a single island, which encloses the AABBs of all
+ * of its procedural nodes. The AABBs of the nodes must be up to date.
+ * @param registry The registry to be updated.
+ * @param island_entity Island entity.
+ */
+void update_island_aabb(entt::registry &registry, entt::entity island_entity);
+
 }
 
 #endif // EDYN_SYS_UPDATE_AABBS_HPP
@@ -0,0 +1,33 @@
+#ifndef EDYN_SYS_UPDATE_ISLAND_NODES_HPP
+#define EDYN_SYS_UPDATE_ISLAND_NODES_HPP
+
+#include <entt/entity/fwd.hpp>
+
+namespace edyn {
+
+/**
+ * @brief Updates the state which depends on the transforms of the dynamic
+ * nodes of an island after it is solved, i.e. origins, AABBs
+ * and world-space inertias, and the AABB of the island, which is refit from
+ * the AABBs of the dynamic nodes in the same pass. It only writes
+ * to components of the island and its nodes, thus it can run in a worker
+ * thread while other islands are still being solved, as long as the storage
+ * of these components was created beforehand. See
+ * `reserve_update_island_nodes_storage`. The nodes of large islands are
+ * split into ranges which are updated in parallel. World-space inertias and
+ * the AABBs of boxes are calculated in packs of `simd_width` bodies.
+ * @param registry Data source.
+ * @param island_entity Island entity.
+ */
+void update_island_nodes(entt::registry &registry, entt::entity island_entity);
+
+/**
+ * @brief Creates the storage of all components used by `update_island_nodes`,
+ * since storage must not be created from worker threads.
+ * @param registry Data source.
+ */
+void reserve_update_island_nodes_storage(entt::registry &registry);
+
+}
+
+#endif // EDYN_SYS_UPDATE_ISLAND_NODES_HPP
@@ -0,0 +1,33 @@
+#ifndef EDYN_SYS_UPDATE_KINEMATIC_TRACKS_HPP
+#define EDYN_SYS_UPDATE_KINEMATIC_TRACKS_HPP
+
+#include <entt/entity/fwd.hpp>
+#include "edyn/math/vector3.hpp"
+#include "edyn/math/quaternion.hpp"
+
+namespace edyn {
+
+struct kinematic_track;
+
+/**
+ * @brief Calculates the transform of a track at the given time.
+ * @param track The track, which must have at least one keyframe.
+ * @param time Playback time, which wraps around if the track loops and is
+ * clamped to the range of the keyframes otherwise.
+ * @param pos Set to the position at the given time.
+ * @param orn Set to the orientation at the given time.
+ */
+void evaluate_kinematic_track(const kinematic_track &track, scalar time,
+                              vector3 &pos, quaternion &orn);
+
+/**
+ * @brief Advances the tracks of kinematic rigid bodies by one step and moves
+ * the bodies along them, setting their velocities accordingly.
+ * @param registry Data source.
+ * @param dt Step duration.
+ */
+void update_kinematic_tracks(entt::registry &registry, scalar dt);
+
+}
+
+#endif // EDYN_SYS_UPDATE_KINEMATIC_TRACKS_HPP
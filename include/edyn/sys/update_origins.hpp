@@ -7,6 +7,12 @@ namespace edyn {
 
 void update_origins(entt::registry &);
 
+/**
+ * @brief Updates the origins of all kinematic and static entities. The origins
+ * of dynamic entities are updated per island in `update_island_nodes`.
+ */
+void update_non_dynamic_origins(entt::registry &);
+
 }
 
 #endif // EDYN_SYS_UPDATE_ORIGINS_HPP
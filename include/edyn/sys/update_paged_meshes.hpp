@@ -0,0 +1,23 @@
+#ifndef EDYN_SYS_UPDATE_PAGED_MESHES_HPP
+#define EDYN_SYS_UPDATE_PAGED_MESHES_HPP
+
+#include <entt/entity/fwd.hpp>
+
+namespace edyn {
+
+/**
+ * @brief Starts loading the pages of paged triangle meshes that awake islands
+ * are expected to touch within `settings::paged_mesh_prefetch_lookahead`
+ * seconds, so that collision detection, which only uses pages that are in
+ * the cache, does not have to wait for them. Pages that islands are already
+ * touching but are still not loaded are reported as missed and can be
+ * observed via `on_paged_mesh_page_missed`. Pages referenced by contact
+ * points are pinned in the `paged_mesh_page_cache` so they are not unloaded
+ * while bodies rest on them.
+ * @param registry Data source.
+ */
+void update_paged_meshes(entt::registry &registry);
+
+}
+
+#endif // EDYN_SYS_UPDATE_PAGED_MESHES_HPP
@@ -1,6 +1,7 @@
 #ifndef EDYN_SYS_UPDATE_ROTATED_MESHES_HPP
 #define EDYN_SYS_UPDATE_ROTATED_MESHES_HPP
 
+#include <vector>
 #include <entt/entity/fwd.hpp>
 
 namespace edyn {
@@ -11,14 +12,36 @@ struct quaternion;
 
 /**
  * @brief Updates the rotated mesh of all polyhedron shapes, including the ones
- * in compound shapes.
+ * in compound shapes, whose orientation changed since they were last rotated.
  * @param registry Source of shapes.
  */
 void update_rotated_meshes(entt::registry &registry);
 
+/**
+ * @brief Updates the rotated meshes of the bodies in the given contact
+ * manifolds whose orientation changed since they were last rotated. Rotated
+ * meshes are only used in collision detection thus this is called by the
+ * narrowphase before detecting collisions, which means bodies that are not
+ * in contact with anything are not rotated at all.
+ * @param registry Data source.
+ * @param manifold_entities Manifolds which will be processed.
+ * @param entities Buffer where the entities to be updated are collected. It
+ * is reused between calls to avoid allocations.
+ * @param mt Whether to update them in worker threads.
+ */
+void update_rotated_meshes_in_contact(entt::registry &registry,
+                                      const std::vector<entt::entity> &manifold_entities,
+                                      std::vector<entt::entity> &entities, bool mt);
+
+/**
+ * @brief Updates the rotated mesh of kinematic entities only.
+ * @param registry Source of shapes.
+ */
+void update_kinematic_rotated_meshes(entt::registry &registry);
+
 /**
  * @brief Updates the rotated mesh of a single entity, which is assumed to have
- * either a polyhedron or a compound shape.
+ * either a polyhedron or a compound shape, if its orientation changed.
  * @param registry Data source.
  * @param entity Entity to be updated.
  */
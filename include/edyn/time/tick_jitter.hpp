@@ -0,0 +1,68 @@
+#ifndef EDYN_TIME_TICK_JITTER_HPP
+#define EDYN_TIME_TICK_JITTER_HPP
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+namespace edyn {
+
+/**
+ * @brief Histogram of how far the time between consecutive updates of the
+ * simulation worker was from the fixed delta time.
+ */
+struct tick_jitter_histogram {
+    // Upper bound of each bucket in microseconds. The last bucket holds all
+    // greater values.
+    static constexpr std::array<uint32_t, 9> bucket_bounds {10, 20, 50, 100, 200, 500, 1000, 2000, 5000};
+    static constexpr size_t num_buckets = bucket_bounds.size() + 1;
+
+    std::array<uint64_t, num_buckets> counts {};
+
+    static size_t bucket_index(double jitter) {
+        auto us = std::abs(jitter) * 1e6;
+        size_t i = 0;
+
+        while (i < bucket_bounds.size() && us >= bucket_bounds[i]) {
+            ++i;
+        }
+
+        return i;
+    }
+};
+
+/**
+ * @brief Tick jitter histogram written by the simulation worker which can be
+ * read from other threads at any time.
+ */
+class tick_jitter_recorder {
+public:
+    void record(double jitter) {
+        auto index = tick_jitter_histogram::bucket_index(jitter);
+        m_counts[index].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    tick_jitter_histogram histogram() const {
+        auto hist = tick_jitter_histogram{};
+
+        for (size_t i = 0; i < hist.counts.size(); ++i) {
+            hist.counts[i] = m_counts[i].load(std::memory_order_relaxed);
+        }
+
+        return hist;
+    }
+
+    void reset() {
+        for (auto &count : m_counts) {
+            count.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, tick_jitter_histogram::num_buckets> m_counts {};
+};
+
+}
+
+#endif // EDYN_TIME_TICK_JITTER_HPP
@@ -17,6 +17,15 @@ uint32_t ticks();
  */
 void delay(uint32_t ms);
 
+/**
+ * @brief Sleep for a duration with sub-millisecond resolution where supported,
+ * i.e. using `clock_nanosleep` on Linux and a high resolution waitable timer
+ * on Windows. The thread can still wake up a bit late, thus callers which
+ * need precise deadlines should sleep for less and spin for the remainder.
+ * @param seconds The duration in seconds.
+ */
+void sleep_for(double seconds);
+
 /**
  * @brief Get the current value of the high resolution counter.
  * @return Counter value.
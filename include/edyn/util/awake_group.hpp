@@ -0,0 +1,35 @@
+#ifndef EDYN_UTIL_AWAKE_GROUP_HPP
+#define EDYN_UTIL_AWAKE_GROUP_HPP
+
+#include <entt/entity/registry.hpp>
+#include "edyn/util/island_util.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Gets the group of entities which have all the given components and
+ * are neither asleep nor disabled.
+ *
+ * A view which excludes `sleeping_tag` and `disabled_tag` iterates over all
+ * entities in its leading storage and skips the ones which are tagged, which
+ * is wasteful when most of the world is asleep. This non-owning group keeps
+ * a packed array of the matching entities instead, which is updated when
+ * these components or tags are added or removed, i.e. when islands fall
+ * asleep or wake up, thus iterating it only visits awake entities and its
+ * size is known upfront. The group is created in the first call and is then
+ * kept up to date by the registry, thus it's best to always use the same
+ * components in the same order for the same purpose.
+ * @note Entities must not be added to or removed from the group while
+ * iterating it, e.g. by assigning a `sleeping_tag` or destroying them.
+ * @tparam Component Types of component the entities must have.
+ * @param registry Data source.
+ * @return Non-owning group.
+ */
+template<typename... Component>
+auto awake_group(entt::registry &registry) {
+    return registry.group<>(entt::get<Component...>, exclude_sleeping_disabled);
+}
+
+}
+
+#endif // EDYN_UTIL_AWAKE_GROUP_HPP
@@ -34,7 +34,8 @@ using paged_mesh_shape_view_t = entt::basic_view<entt::get_t<entt::registry::sto
  * in case a mesh shape with per-vertex materials is involved.
  */
 void merge_point(std::array<entt::entity, 2> body,
-                 const collision_result::collision_point &rp, contact_point &cp,
+                 const collision_result::collision_point &rp,
+                 contact_point &cp, contact_point_cold &cold,
                  const orientation_view_t &, const material_view_t &,
                  const mesh_shape_view_t &, const paged_mesh_shape_view_t &);
 
@@ -72,6 +73,48 @@ void create_contact_point(entt::registry &registry,
                           contact_manifold &manifold,
                           const collision_result::collision_point& rp);
 
+/**
+ * Material properties of the contact points of a manifold, resolved once
+ * from the materials of both bodies and the material mix table.
+ */
+struct contact_material {
+    material_base material;
+    // Whether both bodies have a material. Points keep their default
+    // properties otherwise.
+    bool valid {false};
+    // Whether the properties come from the material mix table, in which case
+    // per-vertex properties of meshes are not used.
+    bool from_table {false};
+};
+
+/**
+ * Mixes the materials of the bodies of a manifold. Resolve it once before
+ * inserting many points into the same manifold.
+ */
+contact_material mix_contact_material(entt::registry &registry, const contact_manifold &manifold);
+
+/**
+ * Same as `create_contact_point` but the contact created event is added to
+ * the given events and no update signals are triggered. Useful when many
+ * points are created in the same manifold, in which case the signals must be
+ * triggered once for all of them by patching the `contact_manifold` and the
+ * `contact_manifold_events` afterwards.
+ */
+void insert_contact_point(entt::registry &registry,
+                          contact_manifold &manifold,
+                          contact_manifold_events &events,
+                          const collision_result::collision_point& rp);
+
+/**
+ * Same as above using material properties resolved previously with
+ * `mix_contact_material`.
+ */
+void insert_contact_point(entt::registry &registry,
+                          contact_manifold &manifold,
+                          contact_manifold_events &events,
+                          const collision_result::collision_point& rp,
+                          const contact_material &mixed);
+
 /**
  * Removes a contact point from a manifold if it's separating.
  */
@@ -94,6 +137,16 @@ using detect_collision_body_view_t = entt::basic_view<
 
 using origin_view_t = entt::basic_view<entt::get_t<entt::registry::storage_for_type<origin>>, entt::exclude_t<>>;
 
+struct collision_context;
+
+/**
+ * Fills in the collision context for a pair of bodies. Returns false if their
+ * AABBs are not intersecting, in which case there is no need to look for
+ * closest points.
+ */
+bool make_collision_context(std::array<entt::entity, 2> body, collision_context &,
+                            const detect_collision_body_view_t &, const origin_view_t &);
+
 /**
  * Detects collision between two bodies and adds closest points to the given
  * collision result
@@ -163,7 +216,7 @@ void process_collision(entt::entity manifold_entity,
         }
 
         if (nearest_idx < result.num_points && !merged_indices[nearest_idx]) {
-            merge_point(manifold.body, result.point[nearest_idx], cp, orn_view, material_view, mesh_shape_view, paged_mesh_shape_view);
+            merge_point(manifold.body, result.point[nearest_idx], cp, manifold.cold[pt_id], orn_view, material_view, mesh_shape_view, paged_mesh_shape_view);
             merged_indices[nearest_idx] = true;
         } else if (maybe_remove_point(manifold, events, pt_idx, originA, ornA, originB, ornB)) {
             destroy_point_func(pt_id);
@@ -263,7 +316,7 @@ void process_collision(entt::entity manifold_entity,
                 new_point_func(local_pt.point);
             } else {
                 merge_point(manifold.body, local_pt.point, manifold.point[local_pt.pt_id],
-                            orn_view, material_view, mesh_shape_view, paged_mesh_shape_view);
+                            manifold.cold[local_pt.pt_id], orn_view, material_view, mesh_shape_view, paged_mesh_shape_view);
             }
             break;
         case point_insertion_type::replace:
@@ -1,6 +1,7 @@
 #ifndef EDYN_UTIL_CONSTRAINT_UTIL_HPP
 #define EDYN_UTIL_CONSTRAINT_UTIL_HPP
 
+#include <vector>
 #include <entt/entity/registry.hpp>
 #include "edyn/comp/graph_edge.hpp"
 #include "edyn/comp/graph_node.hpp"
@@ -12,6 +13,7 @@ namespace edyn {
 struct contact_manifold;
 struct constraint_row;
 struct matrix3x3;
+struct solver_body;
 
 namespace internal {
     bool pre_make_constraint(entt::registry &registry, entt::entity entity,
@@ -103,9 +105,22 @@ void make_contact_manifold(entt::entity contact_entity, entt::registry &,
                            entt::entity body0, entt::entity body1,
                            scalar separation_threshold);
 
+/**
+ * @brief Creates a contact manifold for each pair of bodies which does not
+ * have one yet. Equivalent to calling `make_contact_manifold` for each pair,
+ * with the storages and context objects looked up only once, which is
+ * cheaper when many manifolds are created in the same step.
+ * @param registry Data source.
+ * @param pairs Pairs of bodies.
+ * @param separation_threshold Separation threshold of the new manifolds.
+ * @return Number of manifolds created.
+ */
+size_t make_contact_manifolds(entt::registry &registry, const entity_pair_vector &pairs,
+                              scalar separation_threshold);
+
 void swap_manifold(contact_manifold &manifold);
 
-scalar get_effective_mass(const constraint_row &);
+scalar get_effective_mass(const constraint_row &, const std::vector<solver_body> &bodies);
 
 scalar get_effective_mass(const std::array<vector3, 4> &J,
                           scalar inv_mA, const matrix3x3 &inv_IA,
@@ -0,0 +1,54 @@
+#ifndef EDYN_UTIL_CONVEX_HULL_HPP
+#define EDYN_UTIL_CONVEX_HULL_HPP
+
+#include <vector>
+#include "edyn/math/vector3.hpp"
+#include "edyn/config/constants.hpp"
+#include "edyn/context/task.hpp"
+#include "edyn/shapes/convex_mesh.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Builds the convex hull of a point cloud using the quickhull
+ * algorithm and assigns it to a convex mesh which is ready to be used in a
+ * `polyhedron_shape`, i.e. there's no need to call `convex_mesh::initialize`.
+ * Nearly coplanar triangles are merged into polygonal faces and vertices
+ * which are not corners of the hull are removed. All calculated properties
+ * are derived from the adjacency information of the hull, in time
+ * proportional to its size. It does not use any global state thus it can be
+ * called from multiple threads at once.
+ * @param points The point cloud.
+ * @param mesh Mesh to be overwritten with the hull.
+ * @param centroid If not null, the vertices of the hull are shifted to be
+ * positioned relative to its centroid, which is assigned to it. This is
+ * necessary for the moment of inertia to be calculated correctly.
+ * @param tolerance Distance below which triangles are considered coplanar and
+ * are merged into one face, as a fraction of the largest extent of the point
+ * cloud.
+ * @return Whether a hull with non-zero volume was found. If false, the mesh
+ * is left empty.
+ */
+bool make_convex_hull(const std::vector<vector3> &points, convex_mesh &mesh,
+                      vector3 *centroid = nullptr,
+                      scalar tolerance = convex_hull_relative_tolerance);
+
+/**
+ * @brief Builds the convex hulls of many point clouds at once, such as the
+ * pieces of a fractured object.
+ * @param point_clouds The point clouds.
+ * @param meshes Array to be filled with one mesh per point cloud. Meshes of
+ * point clouds which have no volume are left empty.
+ * @param centroids If not null, it's filled with the centroid of each hull
+ * and the vertices are shifted to be relative to it.
+ * @param enqueue_task_wait Optional function used to build the hulls in
+ * parallel in worker threads.
+ */
+void make_convex_hulls(const std::vector<std::vector<vector3>> &point_clouds,
+                       std::vector<convex_mesh> &meshes,
+                       std::vector<vector3> *centroids = nullptr,
+                       enqueue_task_wait_t *enqueue_task_wait = nullptr);
+
+}
+
+#endif // EDYN_UTIL_CONVEX_HULL_HPP
@@ -44,6 +44,12 @@ inline void entity_vector_erase_invalid(std::vector<entt::entity> &vec,
     vec.erase(std::remove_if(vec.begin(), vec.end(), predicate), vec.end());
 }
 
+// Reserve room for `count` more elements in the storage of each component.
+template<typename... Component>
+void reserve_storage(entt::registry &registry, size_t count) {
+    (registry.storage<Component>().reserve(registry.storage<Component>().size() + count), ...);
+}
+
 template<typename View>
 size_t calculate_view_size(const View &view) {
     return static_cast<size_t>(std::distance(view.begin(), view.end()));
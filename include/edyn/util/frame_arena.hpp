@@ -0,0 +1,95 @@
+#ifndef EDYN_UTIL_FRAME_ARENA_HPP
+#define EDYN_UTIL_FRAME_ARENA_HPP
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include "edyn/config/memory_resource.hpp"
+
+namespace edyn {
+
+/**
+ * @brief Linear allocator of the calling thread for transient buffers which
+ * only live during part of a step, e.g. the sets of a query. Allocating
+ * bumps an offset and deallocating does nothing. Memory is released in bulk
+ * by rewinding to a marker, usually with a `frame_scope`. Chunks are kept
+ * after rewinding, therefore once the arena has grown to the size a step
+ * needs, steps do not allocate from the heap anymore.
+ */
+class frame_arena final : public memory_resource {
+public:
+    struct marker {
+        size_t chunk {0};
+        size_t offset {0};
+    };
+
+    // Arena of the calling thread.
+    static frame_arena & local();
+
+    void * allocate(size_t size, size_t alignment) override;
+
+    // Memory is only reclaimed by `rewind`.
+    void deallocate(void *, size_t, size_t) override {}
+
+    marker mark() const {
+        return {m_chunk, m_offset};
+    }
+
+    // Releases all memory allocated after the marker was taken.
+    void rewind(marker m) {
+        m_chunk = m.chunk;
+        m_offset = m.offset;
+    }
+
+    void reset() {
+        rewind({});
+    }
+
+    // Total size of the chunks.
+    size_t capacity() const;
+
+private:
+    static constexpr size_t min_chunk_size = 64 * 1024;
+
+    struct chunk {
+        std::unique_ptr<uint8_t[]> data;
+        size_t size;
+    };
+
+    std::vector<chunk> m_chunks;
+    size_t m_chunk {0};
+    size_t m_offset {0};
+};
+
+/**
+ * @brief Rewinds the arena of the calling thread when it goes out of scope.
+ * Containers using `get_allocator` must be destroyed before the scope, i.e.
+ * they must be declared after it.
+ */
+class frame_scope {
+public:
+    frame_scope()
+        : m_arena(frame_arena::local())
+        , m_marker(m_arena.mark())
+    {}
+
+    ~frame_scope() {
+        m_arena.rewind(m_marker);
+    }
+
+    frame_scope(const frame_scope &) = delete;
+    frame_scope & operator=(const frame_scope &) = delete;
+
+    template<typename T>
+    allocator<T> get_allocator() const {
+        return allocator<T>(&m_arena);
+    }
+
+private:
+    frame_arena &m_arena;
+    frame_arena::marker m_marker;
+};
+
+}
+
+#endif // EDYN_UTIL_FRAME_ARENA_HPP
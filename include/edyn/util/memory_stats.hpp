@@ -0,0 +1,71 @@
+#ifndef EDYN_UTIL_MEMORY_STATS_HPP
+#define EDYN_UTIL_MEMORY_STATS_HPP
+
+#include <cstddef>
+#include <entt/entity/fwd.hpp>
+#include "edyn/parallel/query_future.hpp"
+
+namespace edyn {
+
+class solver;
+
+/**
+ * @brief Memory held by each subsystem of a world, in bytes. Sizes are
+ * estimated from the capacity of the containers, thus they include memory
+ * which is allocated but not in use, and do not include the overhead of the
+ * allocator.
+ */
+struct memory_stats {
+    // Nodes of the procedural, non-procedural and island trees, the compact
+    // tree and the buffers of the broadphase.
+    size_t broadphase {0};
+    // Storage of `contact_manifold` components.
+    size_t contact_manifolds {0};
+    // Packed constraint rows of the islands (see `row_cache`).
+    size_t row_caches {0};
+    // Arenas of the rows prepared in each step and the storage of
+    // `constraint_row_prep_cache` components.
+    size_t prep_caches {0};
+    // Nodes, edges and adjacencies of the entity graph.
+    size_t entity_graph {0};
+    // Input and action histories and snapshot baselines of the client or
+    // server network context, if any.
+    size_t network_histories {0};
+
+    // The following are shared by all worlds in the process.
+
+    // Pages of all paged triangle meshes (see `paged_mesh_page_cache`).
+    size_t paged_mesh_pages {0};
+    // Data blocks of registry operations which are being built, sent or
+    // executed, i.e. which are not kept in the `registry_operation_pool`.
+    size_t registry_operations_in_flight {0};
+    // Data blocks of registry operations kept in the pool for reuse.
+    size_t registry_operations_pooled {0};
+
+    // Total of the subsystems of the world.
+    size_t world_total() const {
+        return broadphase + contact_manifolds + row_caches + prep_caches +
+               entity_graph + network_histories;
+    }
+};
+
+/**
+ * @brief Measure the memory held by the subsystems of the simulation. In
+ * asynchronous mode, the simulation subsystems are measured in the simulation
+ * worker when it processes the request, which resolves the future. Otherwise,
+ * the returned future is ready.
+ * @param registry Data source.
+ * @return Future memory statistics.
+ */
+query_future<memory_stats> query_memory_stats(entt::registry &registry);
+
+namespace internal {
+    // Fills in the statistics of the subsystems which live in the registry
+    // where the simulation runs.
+    void collect_simulation_memory_stats(entt::registry &registry, const solver &solver,
+                                         memory_stats &stats);
+}
+
+}
+
+#endif // EDYN_UTIL_MEMORY_STATS_HPP
@@ -3,17 +3,39 @@
 
 #include <entt/entity/fwd.hpp>
 #include <entt/signal/sigh.hpp>
+#include "edyn/comp/aabb.hpp"
 
 namespace edyn {
 
 /**
- * @brief Triggers when a new page is loaded or unloaded on a paged mesh shape.
+ * @brief Triggers when a new page is loaded on a paged mesh shape.
  * @param registry Data source.
  * @return Sink which allows observing page load events. It provides the shape
- * entity and the index of page that was loaded or unloaded.
+ * entity and the index of page that was loaded.
  */
 entt::sink<entt::sigh<void(entt::entity, size_t)>> on_paged_mesh_page_loaded(entt::registry &);
 
+/**
+ * @brief Triggers when a page of a paged mesh shape is unloaded to make
+ * room for other pages in the `paged_mesh_page_cache`.
+ * @param registry Data source.
+ * @return Sink which allows observing page evictions. It provides the shape
+ * entity and the index of page that was unloaded.
+ */
+entt::sink<entt::sigh<void(entt::entity, size_t)>> on_paged_mesh_page_evicted(entt::registry &);
+
+/**
+ * @brief Triggers in every step in which an island touches a page of a paged
+ * mesh shape that is not loaded yet, which means collisions against that
+ * page are not being detected. Bodies in that region could be frozen or
+ * treated as resting until the page is loaded, which can be observed with
+ * `on_paged_mesh_page_loaded`.
+ * @param registry Data source.
+ * @return Sink which allows observing page misses. It provides the shape
+ * entity, the index of the page that was missed and its AABB.
+ */
+entt::sink<entt::sigh<void(entt::entity, size_t, const AABB &)>> on_paged_mesh_page_missed(entt::registry &);
+
 }
 
 namespace edyn::internal {
@@ -0,0 +1,100 @@
+#ifndef EDYN_UTIL_PHYSICS_SNAPSHOT_HPP
+#define EDYN_UTIL_PHYSICS_SNAPSHOT_HPP
+
+#include <memory>
+#include <vector>
+#include <entt/entity/fwd.hpp>
+#include <entt/entity/registry.hpp>
+#include <entt/entity/sparse_set.hpp>
+
+namespace edyn {
+
+namespace detail {
+    struct physics_snapshot_pool {
+        std::vector<entt::entity> entities;
+
+        virtual ~physics_snapshot_pool() = default;
+        virtual void capture(const entt::registry &registry) = 0;
+        virtual void restore(entt::registry &registry) const = 0;
+        virtual size_t size_bytes() const = 0;
+    };
+
+    template<typename Component>
+    struct physics_snapshot_pool_impl : public physics_snapshot_pool {
+        std::vector<Component> components;
+
+        void capture(const entt::registry &registry) override {
+            auto view = registry.view<Component>();
+            // Keeps the capacity, thus capturing repeatedly doesn't allocate
+            // unless the pool grows.
+            entities.clear();
+            components.clear();
+            entities.reserve(view.size());
+            components.reserve(view.size());
+
+            for (auto [entity, comp] : view.each()) {
+                entities.push_back(entity);
+                components.push_back(comp);
+            }
+        }
+
+        void restore(entt::registry &registry) const override {
+            auto view = registry.view<Component>();
+
+            for (size_t i = 0; i < entities.size(); ++i) {
+                if (view.contains(entities[i])) {
+                    view.template get<Component>(entities[i]) = components[i];
+                }
+            }
+        }
+
+        size_t size_bytes() const override {
+            return entities.size() * (sizeof(entt::entity) + sizeof(Component));
+        }
+    };
+}
+
+/**
+ * Copy of the physics state of a registry which can be restored in one pass,
+ * for rollback or to simulate ahead and go back, e.g. for AI lookahead. It
+ * holds the transforms, velocities, AABBs, world-space inertias, contact
+ * manifolds with their warm-starting impulses and constraints with their
+ * applied impulses. The broadphase trees are refitted from the restored AABBs
+ * in the next step.
+ *
+ * Values are restored into entities which still exist, thus entities created
+ * or destroyed in between, or changes in islands and sleeping, are not undone.
+ * Contact manifolds created after the capture lose their points on restore so
+ * they don't warm start with impulses from the future. It's intended for
+ * registries stepped in the calling thread, i.e. in one of the sequential
+ * execution modes.
+ */
+class physics_snapshot {
+public:
+    physics_snapshot();
+
+    /**
+     * @brief Also captures the given component, e.g. an external component
+     * which holds state that has to be rolled back.
+     */
+    template<typename Component>
+    void add_component() {
+        m_pools.push_back(std::make_unique<detail::physics_snapshot_pool_impl<Component>>());
+    }
+
+    void capture(const entt::registry &registry);
+    void restore(entt::registry &registry) const;
+
+    /**
+     * @brief Amount of memory taken by the captured state.
+     */
+    size_t size_bytes() const;
+
+private:
+    std::vector<std::unique_ptr<detail::physics_snapshot_pool>> m_pools;
+    entt::sparse_set m_manifold_entities;
+};
+
+}
+
+#endif // EDYN_UTIL_PHYSICS_SNAPSHOT_HPP
@@ -1,12 +1,15 @@
 #ifndef EDYN_UTIL_POLYHEDRON_SHAPE_INITIALIZER_HPP
 #define EDYN_UTIL_POLYHEDRON_SHAPE_INITIALIZER_HPP
 
+#include <memory>
 #include <vector>
 #include <entt/entity/fwd.hpp>
 #include <entt/signal/sigh.hpp>
 
 namespace edyn {
 
+struct rotated_mesh;
+
 /**
  * @brief Sets up rotated meshes for polyhedrons that have been recently
  * created, including polyhedrons which reside in compound shapes.
@@ -20,12 +23,27 @@ public:
     void on_construct_compound_shape(entt::registry &, entt::entity);
     void on_destroy_rotated_mesh_list(entt::registry &, entt::entity);
 
-    void init_new_shapes();
+    /**
+     * @brief Creates the rotated meshes of the new shapes.
+     * @param mt Whether to build the rotated meshes in worker threads when
+     * there are many of them, e.g. when a level is streamed in.
+     */
+    void init_new_shapes(bool mt = false);
 
 private:
     entt::registry *m_registry;
     std::vector<entt::entity> m_new_polyhedron_shapes;
     std::vector<entt::entity> m_new_compound_shapes;
+
+    // A polyhedron in a new shape and its rotated mesh, which is built
+    // before being assigned. For compounds, `node_index` is the index of the
+    // node holding the polyhedron.
+    struct new_rotated_mesh {
+        entt::entity entity;
+        size_t node_index;
+        std::unique_ptr<rotated_mesh> rotated;
+    };
+    std::vector<new_rotated_mesh> m_new_rotated_meshes;
     std::vector<entt::scoped_connection> m_connections;
 };
 
@@ -0,0 +1,134 @@
+#ifndef EDYN_UTIL_PREFAB_HPP
+#define EDYN_UTIL_PREFAB_HPP
+
+#include <array>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <entt/entity/fwd.hpp>
+#include "edyn/constraints/constraint.hpp"
+#include "edyn/constraints/null_constraint.hpp"
+#include "edyn/constraints/breakable_constraint.hpp"
+#include "edyn/math/vector3.hpp"
+#include "edyn/math/quaternion.hpp"
+#include "edyn/util/rigidbody.hpp"
+#include "edyn/util/tuple_util.hpp"
+
+namespace edyn {
+
+/**
+ * A constraint of a prefab, which refers to its entity and bodies by index.
+ */
+template<typename Constraint>
+struct prefab_constraint {
+    using constraint_type = Constraint;
+
+    // Index of the constraint entity. Multiple constraints of different types
+    // can be assigned to the same entity.
+    unsigned entity;
+    // Indices of the rigid bodies in the prefab.
+    std::array<unsigned, 2> body;
+    // Constraint with null body entities.
+    Constraint con;
+};
+
+/**
+ * Constraints that can be part of a prefab, i.e. all but contacts, which are
+ * created by the collision detection.
+ */
+using prefab_constraints_tuple_t = std::tuple<
+    null_constraint,
+    gravity_constraint,
+    distance_constraint,
+    soft_distance_constraint,
+    hinge_constraint,
+    generic_constraint,
+    cvjoint_constraint,
+    cone_constraint,
+    point_constraint
+>;
+
+template<typename Constraint>
+using prefab_constraint_array = std::vector<prefab_constraint<Constraint>>;
+
+/**
+ * A group of rigid bodies and the constraints and collision exclusions between
+ * them, which is captured once and then instantiated any number of times.
+ * Everything that doesn't depend on the placement of the instances, such as
+ * the moments of inertia and the frames and state of the constraints, is
+ * calculated when the prefab is made and instances share the meshes of the
+ * shapes.
+ */
+struct prefab {
+    // Definitions of the rigid bodies, relative to the frame of the prefab.
+    // The moment of inertia of the dynamic rigid bodies is always set, which
+    // avoids calculating it again for each instance.
+    std::vector<rigidbody_def> bodies;
+
+    // Number of constraint entities of each instance.
+    unsigned num_constraint_entities {0};
+
+    // Constraints of each type.
+    map_tuple<prefab_constraint_array, prefab_constraints_tuple_t>::type constraints;
+
+    // Pairs of rigid bodies which do not collide with one another.
+    std::vector<std::array<unsigned, 2>> collision_exclusions;
+
+    // Constraint entities that have an `articulation_tag`.
+    std::vector<unsigned> articulated;
+
+    // Constraint entities that have a `breakable_constraint`.
+    std::vector<std::pair<unsigned, breakable_constraint>> breakable;
+};
+
+/**
+ * Entities created by `instantiate_prefab`.
+ */
+struct prefab_instances {
+    // Rigid bodies of all instances, one instance after another and in the
+    // same order as in `prefab::bodies` in each instance.
+    std::vector<entt::entity> bodies;
+    // Constraint entities of all instances, one instance after another and in
+    // the order of their index in each instance.
+    std::vector<entt::entity> constraints;
+};
+
+/**
+ * @brief Captures existing rigid bodies and constraints into a prefab. The
+ * constraint entities are numbered in the given order and all constraints
+ * assigned to them are included. Collision exclusions between the rigid
+ * bodies are included as well.
+ * @param registry Data source.
+ * @param bodies Rigid body entities.
+ * @param constraints Constraint entities. Both bodies of each constraint must
+ * be in `bodies`.
+ * @param position Origin of the frame of the prefab in world space.
+ * @param orientation Orientation of the frame of the prefab in world space.
+ * @return The prefab.
+ */
+prefab make_prefab(const entt::registry &registry,
+                   const std::vector<entt::entity> &bodies,
+                   const std::vector<entt::entity> &constraints,
+                   const vector3 &position = vector3_zero,
+                   const quaternion &orientation = quaternion_identity);
+
+/**
+ * @brief Creates one instance of the prefab for each pair of position and
+ * orientation. Like `batch_make_rigidbodies`, all rigid bodies of all
+ * instances are created at once, followed by the constraints of each type.
+ * In asynchronous execution mode, everything is sent to the simulation
+ * worker in the same registry operation.
+ * @param registry Data source and destination.
+ * @param pf The prefab.
+ * @param positions Position of the frame of each instance.
+ * @param orientations Orientation of the frame of each instance. Must have
+ * the same size as `positions`.
+ * @return Entities created.
+ */
+prefab_instances instantiate_prefab(entt::registry &registry, const prefab &pf,
+                                    const std::vector<vector3> &positions,
+                                    const std::vector<quaternion> &orientations);
+
+}
+
+#endif // EDYN_UTIL_PREFAB_HPP
@@ -0,0 +1,74 @@
+#ifndef EDYN_UTIL_PROFILING_HPP
+#define EDYN_UTIL_PROFILING_HPP
+
+#include <string>
+#include "edyn/build_settings.h"
+
+/**
+ * Instrumentation zones for timeline profilers, which show the jobs run by the
+ * workers of the job dispatcher, the states of the island solvers and the
+ * messages sent between threads. Zones are only compiled in if Edyn is built
+ * with `EDYN_ENABLE_PROFILING`, otherwise the macros expand to nothing. If
+ * `EDYN_PROFILING_TRACY` is also set, zones are forwarded to Tracy. Otherwise
+ * they're recorded while a capture is active and written in the Chrome trace
+ * event format, which can be opened in `chrome://tracing` or Perfetto.
+ *
+ * `EDYN_PROFILE_ZONE(name)` times the enclosing scope. The name must have
+ * static storage duration, e.g. a string literal.
+ * `EDYN_PROFILE_THREAD_NAME(name)` names the current thread in the timeline.
+ */
+
+#define EDYN_PROFILE_CONCAT_IMPL(a, b) a##b
+#define EDYN_PROFILE_CONCAT(a, b) EDYN_PROFILE_CONCAT_IMPL(a, b)
+
+#if defined(EDYN_ENABLE_PROFILING) && defined(EDYN_PROFILING_TRACY)
+#include <cstring>
+#include <tracy/Tracy.hpp>
+#define EDYN_PROFILE_ZONE(name) ZoneScoped; ZoneName(name, std::strlen(name))
+#define EDYN_PROFILE_THREAD_NAME(name) tracy::SetThreadName(name)
+#elif defined(EDYN_ENABLE_PROFILING)
+#define EDYN_PROFILE_ZONE(name) ::edyn::trace_zone EDYN_PROFILE_CONCAT(edyn_trace_zone_, __LINE__)(name)
+#define EDYN_PROFILE_THREAD_NAME(name) ::edyn::set_trace_thread_name(name)
+#else
+#define EDYN_PROFILE_ZONE(name)
+#define EDYN_PROFILE_THREAD_NAME(name)
+#endif
+
+namespace edyn {
+
+/**
+ * @brief Starts recording trace events in all threads, discarding events
+ * from a previous capture which weren't written. Does nothing unless built
+ * with `EDYN_ENABLE_PROFILING` and without `EDYN_PROFILING_TRACY`.
+ */
+void begin_trace_capture();
+
+/**
+ * @brief Stops recording trace events and writes the events recorded since
+ * `begin_trace_capture` as Chrome trace event JSON.
+ * @param path Path of the output file.
+ * @return Whether the file was written.
+ */
+bool end_trace_capture(const std::string &path);
+
+#if defined(EDYN_ENABLE_PROFILING) && !defined(EDYN_PROFILING_TRACY)
+/**
+ * @brief Records the duration of its lifetime as a trace event in the
+ * current thread while a capture is active.
+ */
+class trace_zone {
+public:
+    trace_zone(const char *name);
+    ~trace_zone();
+
+private:
+    const char *m_name;
+    double m_start;
+};
+
+void set_trace_thread_name(const char *name);
+#endif
+
+}
+
+#endif // EDYN_UTIL_PROFILING_HPP
@@ -4,6 +4,7 @@
 #include "edyn/math/vector3.hpp"
 #include "edyn/math/quaternion.hpp"
 #include <entt/entity/fwd.hpp>
+#include "edyn/util/prefab.hpp"
 
 namespace edyn {
 
@@ -22,6 +23,10 @@ struct ragdoll_simple_def {
     scalar friction{0.5};
 
     ragdoll_shape_type shape_type{ragdoll_shape_type::capsule};
+
+    // Assign an `articulation_tag` to all constraints so their joints are
+    // solved exactly.
+    bool articulated{false};
 };
 
 struct ragdoll_def {
@@ -59,6 +64,10 @@ struct ragdoll_def {
     scalar friction{0.5};
 
     ragdoll_shape_type shape_type{ragdoll_shape_type::capsule};
+
+    // Assign an `articulation_tag` to all constraints so their joints are
+    // solved exactly.
+    bool articulated{false};
 };
 
 struct ragdoll_entities {
@@ -139,6 +148,26 @@ ragdoll_entities make_ragdoll(entt::registry &registry, const ragdoll_simple_def
  */
 ragdoll_entities make_ragdoll(entt::registry &registry, const ragdoll_def &def);
 
+/**
+ * @brief Captures a rag doll into a prefab, to create many identical rag dolls
+ * at once with `instantiate_prefab`. The frame of the prefab is the hip, i.e.
+ * the instances are placed like `ragdoll_def::position` and
+ * `ragdoll_def::orientation` place a rag doll.
+ * @param registry Data source.
+ * @param entities Entities of a rag doll created with `make_ragdoll`.
+ * @return Rag doll prefab.
+ */
+prefab make_ragdoll_prefab(const entt::registry &registry, const ragdoll_entities &entities);
+
+/**
+ * @brief Get the entities of one rag doll created with `instantiate_prefab`
+ * from a rag doll prefab.
+ * @param instances Entities of all instances.
+ * @param index Index of the instance.
+ * @return Rag doll entities.
+ */
+ragdoll_entities get_ragdoll_instance(const prefab_instances &instances, size_t index);
+
 }
 
 #endif // EDYN_UTIL_RAGDOLL_HPP
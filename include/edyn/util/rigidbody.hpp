@@ -2,6 +2,8 @@
 #define EDYN_UTIL_RIGIDBODY_HPP
 
 #include <optional>
+#include <utility>
+#include <vector>
 #include <entt/entity/fwd.hpp>
 #include "edyn/math/vector3.hpp"
 #include "edyn/math/quaternion.hpp"
@@ -57,7 +59,8 @@ struct rigidbody_def {
     std::optional<shapes_variant_t> shape;
 
     // Optional material. If not set, the rigid body will not respond to
-    // collisions, i.e. it becomes a _sensor_.
+    // collisions, though it still gets contact manifolds and contact points.
+    // Use `sensor` for trigger zones.
     std::optional<edyn::material> material {edyn::material{}};
 
     uint64_t collision_group {collision_filter::all_groups};
@@ -70,6 +73,26 @@ struct rigidbody_def {
     // Prevent this rigid body from sleeping while it barely moves.
     bool sleeping_disabled {false};
 
+    // Use speculative contacts to prevent this rigid body from tunneling
+    // through others when moving fast. Only applies to dynamic rigid bodies.
+    bool ccd {false};
+
+    // Turn this rigid body into a sensor, which never collides with others
+    // nor gets contact manifolds and instead reports when other rigid bodies
+    // enter and exit it as sensor events. Pairs of sensors and pairs of
+    // non-procedural rigid bodies are ignored, as usual.
+    bool sensor {false};
+
+    // Simulate this rigid body as a particle, which has no angular state and
+    // is cheaper to update, e.g. for debris or sand. It must be dynamic and
+    // have a `sphere_shape` and no center of mass offset. The inertia and
+    // angular velocity are ignored and it still collides with everything.
+    bool particle {false};
+
+    // Whether a sensor tests the shapes of the rigid bodies for intersection
+    // instead of just their AABBs.
+    bool sensor_exact {true};
+
     // Share this rigid body over the network.
     bool networked {false};
 };
@@ -92,6 +115,28 @@ void make_rigidbody(entt::entity, entt::registry &, const rigidbody_def &);
  */
 entt::entity make_rigidbody(entt::registry &, const rigidbody_def &);
 
+/**
+ * @brief Assigns to each entity all necessary components to build a rigid body
+ * according to the definition at the same index. Equivalent to calling
+ * `make_rigidbody` for each entity, but storage is reserved up front and each
+ * component is assigned to all entities before moving on to the next, which
+ * is much faster when creating a large number of rigid bodies at once.
+ * @param entities Target rigid body entities.
+ * @param registry Data source and destination.
+ * @param defs Rigid body definitions. Must have the same size as `entities`.
+ */
+void batch_make_rigidbodies(const std::vector<entt::entity> &, entt::registry &,
+                            const std::vector<rigidbody_def> &);
+
+/**
+ * @brief Creates one entity for each definition and assigns all necessary
+ * components to build the rigid bodies. See the overload above.
+ * @param registry Data source and destination.
+ * @param defs Rigid body definitions.
+ * @return Rigid body entities, in the same order as the definitions.
+ */
+std::vector<entt::entity> batch_make_rigidbodies(entt::registry &, const std::vector<rigidbody_def> &);
+
 /**
  * @brief Destroys a rigid body without destroying the entity. All components
  * assigned in `make_rigidbody` are removed.
@@ -214,6 +259,15 @@ void rigidbody_update_origin(entt::registry &, entt::entity);
  */
 void wake_up_entity(entt::registry &, entt::entity);
 
+/**
+ * @brief Wake up many entities at once. Each island is woken up once no
+ * matter how many of the entities it contains. In asynchronous mode, a single
+ * message is sent to the simulation worker.
+ * @param registry Data source.
+ * @param entities Rigid body entities.
+ */
+void wake_up_entities(entt::registry &, const std::vector<entt::entity> &);
+
 /**
  * @brief Change rigid body shape.
  * @param registry Data source.
@@ -245,6 +299,19 @@ bool rigidbody_has_shape(const entt::registry &, entt::entity);
  */
 void rigidbody_set_kind(entt::registry &, entt::entity, rigidbody_kind);
 
+/**
+ * @brief Assign a new kind to many existing rigid bodies at once, e.g. when
+ * a kinematic building collapses. Compared to changing them one by one, the
+ * islands connected by the bodies are merged once per connected group, their
+ * broadphase tree leaves are rebuilt in bulk and, in asynchronous mode, a
+ * single message is sent to the simulation worker.
+ * @remark The same remarks of the single-body version apply.
+ * @param registry Data source.
+ * @param entities Rigid body entities, each of them appearing once.
+ * @param kind The new kind.
+ */
+void rigidbody_set_kind(entt::registry &, const std::vector<entt::entity> &, rigidbody_kind);
+
 }
 
 namespace edyn::internal {
@@ -253,6 +320,9 @@ namespace edyn::internal {
     void rigidbody_assert_supports_kind(entt::registry &registry, entt::entity entity, rigidbody_kind kind);
     void rigidbody_apply_kind(entt::registry &registry, entt::entity entity, rigidbody_kind kind,
                               island_manager &isle_mgr);
+    void rigidbody_apply_kind(entt::registry &registry,
+                              const std::vector<std::pair<entt::entity, rigidbody_kind>> &changes,
+                              island_manager &isle_mgr);
 }
 
 #endif // EDYN_UTIL_RIGIDBODY_HPP
@@ -127,6 +127,24 @@ scalar polyhedron_support_projection(const std::vector<vector3> &vertices,
                                      const std::vector<uint32_t> &neighbor_indices,
                                      const vector3 &dir);
 
+/**
+ * @brief Calculates the maximum projection of all vertices along the given
+ * direction, starting the search at the given vertex. Starting at the support
+ * vertex of a similar direction, such as that of the previous step, takes
+ * only a few iterations.
+ * @param vertices Vertices of a convex polyhedron.
+ * @param neighbors_start See `convex_mesh:neighbors_start`.
+ * @param neighbor_indices See `convex_mesh:neighbors_start`.
+ * @param dir A direction vector (non-zero).
+ * @param vertex_idx Index of the vertex where the search starts. Is assigned
+ * the index of the support vertex.
+ * @return The maximal projection.
+ */
+scalar polyhedron_support_projection(const std::vector<vector3> &vertices,
+                                     const std::vector<uint32_t> &neighbors_start,
+                                     const std::vector<uint32_t> &neighbor_indices,
+                                     const vector3 &dir, uint32_t &vertex_idx);
+
 /**
  * @brief Calculates the maximum projection of all points along the given
  * direction.
@@ -272,6 +290,30 @@ support_polygon point_cloud_support_polygon(It first, It last,
     return polygon;
 }
 
+/**
+ * @brief Finds the polygon in a convex polyhedron that's furthest away in the
+ * given direction. Same as `point_cloud_support_polygon` but instead of
+ * visiting all vertices, it uses the vertex adjacency to find the support
+ * vertex and the vertices near it.
+ * @param vertices Vertices of a convex polyhedron.
+ * @param neighbors_start See `convex_mesh:neighbors_start`.
+ * @param neighbor_indices See `convex_mesh:neighbors_start`.
+ * @param offset Vector to be added to each vertex during calculations.
+ * @param dir A direction vector (non-zero).
+ * @param projection The support projection along the given direction.
+ * @param positive_side Whether the direction points towards the polyhedron.
+ * @param tolerance The distance from the projection boundary which decides
+ * whether the vertex is part of the support polygon.
+ * @param vertex_idx Index of the vertex where the search for the support
+ * vertex starts. Is assigned the index of the support vertex.
+ */
+support_polygon polyhedron_support_polygon(const std::vector<vector3> &vertices,
+                                           const std::vector<uint32_t> &neighbors_start,
+                                           const std::vector<uint32_t> &neighbor_indices,
+                                           const vector3 &offset, const vector3 &dir,
+                                           scalar projection, bool positive_side,
+                                           scalar tolerance, uint32_t &vertex_idx);
+
 /**
  * @brief Finds a point on the boundary of a convex polygon that's closest to a
  * point `p` located outside the polygon.
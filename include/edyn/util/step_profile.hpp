@@ -0,0 +1,130 @@
+#ifndef EDYN_UTIL_STEP_PROFILE_HPP
+#define EDYN_UTIL_STEP_PROFILE_HPP
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <entt/entity/fwd.hpp>
+
+namespace edyn {
+
+/**
+ * @brief Stages of a simulation step which are timed by the step profiler.
+ * The solver stages are nested in the solver update, i.e. `restitution`,
+ * `prepare_constraints`, `solve_islands` and `post_solve` add up to the time
+ * spent in the solver, `maintenance` is the deferred work run after the
+ * solver and `step` is the duration of the entire step.
+ */
+enum class step_phase : uint8_t {
+    broadphase,
+    island_management,
+    paged_meshes,
+    narrowphase,
+    restitution,
+    prepare_constraints,
+    solve_islands,
+    post_solve,
+    maintenance,
+    step
+};
+
+inline constexpr size_t num_step_phases = 10;
+
+/**
+ * @brief Duration of each stage of the simulation step in seconds. Filled in
+ * every step while step profiling is enabled.
+ */
+struct step_profile {
+    struct timing {
+        // Duration in the last step.
+        double last {};
+        // Exponential moving average of the duration.
+        double average {};
+        // Longest duration since profiling was enabled.
+        double max {};
+    };
+
+    // Weight of the duration of the last step in the moving average.
+    static constexpr double smoothing = 0.05;
+
+    std::array<timing, num_step_phases> phases {};
+
+    // Number of steps profiled since profiling was enabled.
+    uint64_t num_steps {};
+
+    const timing & operator[](step_phase phase) const {
+        return phases[static_cast<size_t>(phase)];
+    }
+
+    void record(step_phase phase, double duration);
+
+    void reset() {
+        *this = {};
+    }
+};
+
+/**
+ * @brief Measures consecutive stages of a step. Each call to `record`
+ * assigns the time elapsed since the previous call, or since construction, to
+ * a stage. Does nothing if the profile is null.
+ */
+class step_profile_timer {
+public:
+    step_profile_timer(step_profile *profile);
+
+    // Assigns the time since the previous record to a phase.
+    void record(step_phase phase);
+
+    // Discards the time since the previous record, e.g. time spent in stages
+    // which are timed separately.
+    void skip();
+
+    // Records the duration of the entire step and counts it.
+    void finish();
+
+private:
+    step_profile *m_profile;
+    double m_step_start;
+    double m_start;
+};
+
+/**
+ * @brief Check whether the duration of each stage of the simulation step is
+ * being measured.
+ * @param registry Data source.
+ * @return Whether step profiling is enabled.
+ */
+bool get_step_profiling(const entt::registry &registry);
+
+/**
+ * @brief Enable or disable measuring the duration of each stage of the
+ * simulation step, which can be read with `get_step_profile`. Enabling it
+ * resets the profile.
+ * @param registry Data source.
+ * @param enabled Whether to profile steps.
+ */
+void set_step_profiling(entt::registry &registry, bool enabled);
+
+/**
+ * @brief Get the duration of each stage of the last steps. In asynchronous
+ * mode, the profile is measured in the simulation worker and is sent to the
+ * main registry after each update of the worker, thus it becomes available
+ * in a later call to `edyn::update`.
+ * @param registry Data source.
+ * @return Step profile.
+ */
+const step_profile & get_step_profile(const entt::registry &registry);
+
+}
+
+namespace edyn::internal {
+
+/**
+ * @brief Get the profile to be filled in the steps of a registry.
+ * @return Pointer to the profile or null if profiling is disabled.
+ */
+step_profile * find_step_profile(entt::registry &registry);
+
+}
+
+#endif // EDYN_UTIL_STEP_PROFILE_HPP
@@ -0,0 +1,137 @@
+#ifndef EDYN_UTIL_WORLD_CAPTURE_HPP
+#define EDYN_UTIL_WORLD_CAPTURE_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <entt/entity/fwd.hpp>
+
+namespace edyn {
+
+namespace packet { struct edyn_packet; }
+
+// "EDRC" in little endian.
+inline constexpr uint32_t world_capture_magic = 0x43524445;
+inline constexpr uint32_t world_capture_version = 2;
+
+struct world_capture_header {
+    uint32_t magic {world_capture_magic};
+    uint32_t version {world_capture_version};
+    uint8_t scalar_size {};
+    // Whether the world was a networking server, in which case the packets
+    // received from clients are part of the capture.
+    bool server {false};
+    // Time when the capture began.
+    double start_time {};
+};
+
+/**
+ * @brief Counts of what was replayed by `replay_capture`.
+ */
+struct world_replay_stats {
+    uint32_t num_updates {};
+    uint32_t num_steps {};
+    uint32_t num_packets {};
+    uint32_t num_operations {};
+    // Time between the beginning of the capture and its last record.
+    double captured_duration {};
+};
+
+/**
+ * @brief Starts recording everything that enters a world, which can be
+ * replayed in another process with the same workload with `replay_capture`
+ * to reproduce performance issues.
+ *
+ * The state of the world is saved with `save_world` at first. Then, the
+ * changes made to the components shared with the simulation between calls
+ * to `edyn::update`, the calls themselves and their time, the settings and
+ * the packets received from clients in a networking server, by means of
+ * `server_receive_packet` and `update_network_server`, are recorded in
+ * order. Components which can't be serialized, and bodies with mesh, paged
+ * mesh and heightfield shapes created after the capture began, along with
+ * their constraints, are not included. Packets received by clients are not
+ * recorded, but the changes they make are captured as any other.
+ *
+ * @param registry Data source, which must not be capturing already.
+ */
+void begin_capture(entt::registry &registry);
+
+/**
+ * @brief Whether a capture is in progress.
+ */
+bool is_capturing(const entt::registry &registry);
+
+/**
+ * @brief Stops capturing and appends the compact binary capture to a buffer.
+ * Nothing is appended if not capturing. Captures in progress are discarded
+ * in `edyn::detach`.
+ */
+void end_capture(entt::registry &registry, std::vector<uint8_t> &buffer);
+
+/**
+ * @brief Stops capturing and writes the capture to a file.
+ * @return Whether the file was written successfully.
+ */
+bool end_capture(entt::registry &registry, const std::string &path);
+
+/**
+ * @brief Reads the header of a capture.
+ * @return Whether the data starts with a valid header of a compatible version.
+ */
+bool read_capture_header(const uint8_t *data, size_t size, world_capture_header &header);
+
+/**
+ * @brief Replays a capture in a registry, which should have been attached
+ * with the same execution mode and have a networking server if the capture
+ * was made on one. The world is loaded and the recorded calls are made back
+ * to back, with the time elapsed since the capture began offset by the time
+ * when the replay began, which is also returned by the time function of the
+ * world during the replay. Clients are created as their first packet is
+ * replayed.
+ * @param registry Target registry.
+ * @param data Buffer written by `end_capture`.
+ * @param size Size of buffer.
+ * @param stats Optionally receives what was replayed.
+ * @return Whether the capture is valid and of a compatible version. Records
+ * replayed before invalid data is found are not undone.
+ */
+bool replay_capture(entt::registry &registry, const uint8_t *data, size_t size,
+                    world_replay_stats *stats = nullptr);
+
+/**
+ * @brief Replays a capture from a file.
+ * @see replay_capture
+ */
+bool replay_capture(entt::registry &registry, const std::string &path,
+                    world_replay_stats *stats = nullptr);
+
+}
+
+namespace edyn::internal {
+
+enum class capture_record_type : uint8_t {
+    operations,
+    settings,
+    update,
+    step,
+    batch_step,
+    packet,
+    network_update,
+    created_entities
+};
+
+/**
+ * @brief Records a call which changes the world, if capturing. The changes
+ * made from now on are not recorded until `capture_resume`, since the call
+ * makes them again on replay.
+ */
+void capture_call(entt::registry &registry, capture_record_type type, double time,
+                  uint32_t num_steps = 1);
+void capture_packet(entt::registry &registry, entt::entity client_entity,
+                    const packet::edyn_packet &packet);
+void capture_resume(entt::registry &registry);
+void deinit_capture(entt::registry &registry);
+
+}
+
+#endif // EDYN_UTIL_WORLD_CAPTURE_HPP
@@ -1,12 +1,14 @@
 #include "edyn/collision/broadphase.hpp"
 #include "edyn/collision/tree_node.hpp"
 #include "edyn/comp/aabb.hpp"
-#include "edyn/comp/collision_exclusion.hpp"
-#include "edyn/comp/collision_filter.hpp"
+#include "edyn/comp/aabb_margin.hpp"
+#include "edyn/comp/linvel.hpp"
 #include "edyn/comp/island.hpp"
 #include "edyn/comp/tree_resident.hpp"
 #include "edyn/collision/contact_manifold.hpp"
 #include "edyn/collision/contact_manifold_map.hpp"
+#include "edyn/collision/should_collide.hpp"
+#include "edyn/comp/collision_exclusion.hpp"
 #include "edyn/comp/tag.hpp"
 #include "edyn/config/config.h"
 #include "edyn/util/constraint_util.hpp"
@@ -14,13 +16,18 @@
 #include "edyn/context/task_util.hpp"
 #include "edyn/util/entt_util.hpp"
 #include "edyn/util/island_util.hpp"
+#include "edyn/util/awake_group.hpp"
 #include <entt/entity/registry.hpp>
 #include <entt/signal/delegate.hpp>
+#include <algorithm>
+#include <atomic>
 
 namespace edyn {
 
 struct island_tree_resident {
     tree_node_id_t id;
+    // Whether the leaf is in the tree of sleeping islands.
+    bool sleeping;
 };
 
 broadphase::broadphase(entt::registry &registry)
@@ -31,13 +38,28 @@ broadphase::broadphase(entt::registry &registry)
     m_connections.emplace_back(registry.on_destroy<tree_resident>().connect<&broadphase::on_destroy_tree_resident>(*this));
     m_connections.emplace_back(registry.on_construct<island_AABB>().connect<&broadphase::on_construct_island_aabb>(*this));
     m_connections.emplace_back(registry.on_destroy<island_tree_resident>().connect<&broadphase::on_destroy_island_tree_resident>(*this));
+    m_connections.emplace_back(registry.on_construct<sleeping_tag>().connect<&broadphase::on_construct_sleeping_tag>(*this));
+    m_connections.emplace_back(registry.on_destroy<sleeping_tag>().connect<&broadphase::on_destroy_sleeping_tag>(*this));
+    m_connections.emplace_back(registry.on_destroy<contact_manifold>().connect<&broadphase::on_destroy_contact_manifold>(*this));
+    m_connections.emplace_back(registry.on_construct<collision_filter>().connect<&broadphase::on_construct_collision_filter>(*this));
+    m_connections.emplace_back(registry.on_update<collision_filter>().connect<&broadphase::on_construct_collision_filter>(*this));
+    m_connections.emplace_back(registry.on_destroy<collision_filter>().connect<&broadphase::on_destroy_collision_filter>(*this));
+}
+
+static collision_filter get_collision_filter(const entt::registry &registry, entt::entity entity) {
+    if (auto *filter = registry.try_get<collision_filter>(entity)) {
+        return *filter;
+    }
+
+    return {};
+}
+
+static aabb_margin get_aabb_margin(const entt::registry &registry, entt::entity entity) {
+    if (auto *margin = registry.try_get<aabb_margin>(entity)) {
+        return *margin;
+    }
 
-    // The `should_collide_func` function will be invoked in parallel when
-    // running broadphase in parallel, in the call to `broadphase::collide_tree_async`.
-    // Avoid multi-threading issues by pre-allocating the pools that will be
-    // needed in `should_collide_func`.
-    static_cast<void>(registry.storage<collision_filter>());
-    static_cast<void>(registry.storage<collision_exclusion>());
+    return {};
 }
 
 void broadphase::on_construct_aabb(entt::registry &, entt::entity entity) {
@@ -56,20 +78,93 @@ void broadphase::on_destroy_tree_resident(entt::registry &registry, entt::entity
 
     if (node.procedural) {
         m_tree.destroy(node.id);
+
+        if (m_sap.contains(entity)) {
+            m_sap.erase(entity);
+        }
+
+        if (m_lbvh.contains(entity)) {
+            m_lbvh.erase(entity);
+        }
     } else {
         m_np_tree.destroy(node.id);
+        m_np_compact_tree_dirty = true;
+    }
+}
+
+void broadphase::on_destroy_contact_manifold(entt::registry &registry, entt::entity entity) {
+    // The AABBs of the pair might still be close thus it must be checked
+    // again for intersection even if none of them move.
+    auto &manifold = registry.get<contact_manifold>(entity);
+    m_pending_pairs.emplace_back(manifold.body[0], manifold.body[1]);
+    m_sort_pending_pairs = true;
+}
+
+void broadphase::on_construct_collision_filter(entt::registry &registry, entt::entity entity) {
+    set_tree_filter(entity, registry.get<collision_filter>(entity));
+}
+
+void broadphase::on_destroy_collision_filter(entt::registry &, entt::entity entity) {
+    set_tree_filter(entity, {});
+}
+
+void broadphase::set_tree_filter(entt::entity entity, const collision_filter &filter) {
+    // Entities which are not in a tree yet get their filter when inserted.
+    auto *resident = m_registry->try_get<tree_resident>(entity);
+
+    if (!resident) {
+        return;
     }
+
+    if (resident->procedural) {
+        m_tree.set_filter(resident->id, filter);
+    } else {
+        m_np_tree.set_filter(resident->id, filter);
+        m_np_compact_tree_dirty = true;
+    }
+
+    // Query the trees again since the new filter might accept pairs which
+    // were skipped before.
+    mark_moved(entity, *resident);
 }
 
 void broadphase::on_construct_island_aabb(entt::registry &registry, entt::entity entity) {
     auto &aabb = registry.get<island_AABB>(entity);
-    tree_node_id_t id = m_island_tree.create(aabb, entity);
-    registry.emplace<island_tree_resident>(entity, id);
+    auto sleeping = registry.all_of<sleeping_tag>(entity);
+    auto &tree = sleeping ? m_sleeping_island_tree : m_island_tree;
+    tree_node_id_t id = tree.create(aabb, entity);
+    registry.emplace<island_tree_resident>(entity, id, sleeping);
 }
 
 void broadphase::on_destroy_island_tree_resident(entt::registry &registry, entt::entity entity) {
     auto &node = registry.get<island_tree_resident>(entity);
-    m_island_tree.destroy(node.id);
+    auto &tree = node.sleeping ? m_sleeping_island_tree : m_island_tree;
+    tree.destroy(node.id);
+}
+
+void broadphase::on_construct_sleeping_tag(entt::registry &, entt::entity entity) {
+    move_island_to_tree(entity, true);
+}
+
+void broadphase::on_destroy_sleeping_tag(entt::registry &, entt::entity entity) {
+    move_island_to_tree(entity, false);
+}
+
+void broadphase::move_island_to_tree(entt::entity entity, bool sleeping) {
+    // Bodies are tagged as well, which are not in the island trees. The AABB
+    // might be gone already if the island is being destroyed.
+    auto *node = m_registry->try_get<island_tree_resident>(entity);
+    auto *aabb = m_registry->try_get<island_AABB>(entity);
+
+    if (!node || !aabb || node->sleeping == sleeping) {
+        return;
+    }
+
+    auto &from = node->sleeping ? m_sleeping_island_tree : m_island_tree;
+    auto &to = sleeping ? m_sleeping_island_tree : m_island_tree;
+    from.destroy(node->id);
+    node->id = to.create(*aabb, entity);
+    node->sleeping = sleeping;
 }
 
 void broadphase::init_new_aabb_entities() {
@@ -82,6 +177,42 @@ void broadphase::init_new_aabb_entities() {
     auto aabb_view = m_registry->view<AABB>();
     auto procedural_view = m_registry->view<procedural_tag>();
 
+    if (m_new_aabb_entities.size() >= bulk_tree_build_threshold) {
+        // Build a subtree for each tree with all new leaves at once, which is
+        // faster and gives better trees when many entities are added at once,
+        // such as when a level is loaded.
+        std::vector<AABB> aabbs[2];
+        std::vector<entt::entity> entities[2];
+        std::vector<collision_filter> filters[2];
+        std::vector<aabb_margin> margins[2];
+        std::vector<tree_node_id_t> ids;
+
+        for (auto entity : m_new_aabb_entities) {
+            if (!aabb_view.contains(entity)) continue;
+
+            auto procedural = procedural_view.contains(entity) ? 1 : 0;
+            aabbs[procedural].push_back(aabb_view.get<AABB>(entity));
+            entities[procedural].push_back(entity);
+            filters[procedural].push_back(get_collision_filter(*m_registry, entity));
+            margins[procedural].push_back(get_aabb_margin(*m_registry, entity));
+        }
+
+        for (int procedural = 0; procedural < 2; ++procedural) {
+            auto &tree = procedural ? m_tree : m_np_tree;
+            tree.create(aabbs[procedural], entities[procedural], ids, filters[procedural], margins[procedural]);
+            m_np_compact_tree_dirty |= procedural == 0 && !ids.empty();
+
+            for (size_t i = 0; i < ids.size(); ++i) {
+                auto entity = entities[procedural][i];
+                auto &resident = m_registry->emplace<tree_resident>(entity, ids[i], procedural == 1);
+                mark_moved(entity, resident);
+            }
+        }
+
+        m_new_aabb_entities.clear();
+        return;
+    }
+
     for (auto entity : m_new_aabb_entities) {
         // Entity might've been cleared.
         if (!aabb_view.contains(entity)) continue;
@@ -89,152 +220,693 @@ void broadphase::init_new_aabb_entities() {
         auto &aabb = aabb_view.get<AABB>(entity);
         bool procedural = procedural_view.contains(entity);
         auto &tree = procedural ? m_tree : m_np_tree;
-        tree_node_id_t id = tree.create(aabb, entity);
-        m_registry->emplace<tree_resident>(entity, id, procedural);
+        tree_node_id_t id = tree.create(aabb, entity, get_collision_filter(*m_registry, entity),
+                                        get_aabb_margin(*m_registry, entity));
+        auto &resident = m_registry->emplace<tree_resident>(entity, id, procedural);
+        mark_moved(entity, resident);
+        m_np_compact_tree_dirty |= !procedural;
     }
 
     m_new_aabb_entities.clear();
 }
 
-void broadphase::move_aabbs() {
+template<typename View>
+void broadphase::move_leaves(bool mt, const View &view, dynamic_tree &tree) {
+    m_check_entities.clear();
+    m_check_entities.insert(m_check_entities.end(), view.begin(), view.end());
+    m_check_flags.assign(m_check_entities.size(), 0);
+
+    // The inflated AABBs are extended along the displacement of the entities
+    // in the next step. Assure the storages before running in parallel.
+    auto fixed_dt = m_registry->ctx().get<settings>().fixed_dt;
+    auto &linvel_storage = m_registry->storage<linvel>();
+    auto &margin_storage = m_registry->storage<aabb_margin>();
+
+    auto get_displacement = [&](entt::entity entity) {
+        return linvel_storage.contains(entity) ? linvel_storage.get(entity) * fixed_dt : vector3_zero;
+    };
+
+    auto get_margin = [&](entt::entity entity) {
+        return margin_storage.contains(entity) ? margin_storage.get(entity) : aabb_margin{};
+    };
+
+    // Only test whether the AABBs left the inflated AABBs of their leaves,
+    // which reads the tree and can run in parallel. The tree is changed
+    // after, for the leaves that moved only.
+    auto check = [&](const entt::entity *first, const entt::entity *last, unsigned start) {
+        for (auto index = start; first != last; ++first, ++index) {
+            auto [resident, aabb] = view.template get<tree_resident, AABB>(*first);
+            m_check_flags[index] = tree.needs_move(resident.id, aabb, get_displacement(*first), get_margin(*first));
+        }
+    };
+
+    if (mt && m_check_entities.size() > parallel_check_threshold) {
+        parallel_for_each_range(*m_registry, m_check_entities, check);
+    } else {
+        check(m_check_entities.data(), m_check_entities.data() + m_check_entities.size(), 0);
+    }
+
+    m_moved_leaves.clear();
+    m_moved_leaf_aabbs.clear();
+    m_moved_leaf_displacements.clear();
+    m_moved_leaf_margins.clear();
+
+    for (size_t i = 0; i < m_check_entities.size(); ++i) {
+        if (m_check_flags[i]) {
+            auto entity = m_check_entities[i];
+            auto [resident, aabb] = view.template get<tree_resident, AABB>(entity);
+            m_moved_leaves.push_back(resident.id);
+            m_moved_leaf_aabbs.push_back(aabb);
+            m_moved_leaf_displacements.push_back(get_displacement(entity));
+            m_moved_leaf_margins.push_back(get_margin(entity));
+            mark_moved(entity, resident);
+        }
+    }
+
+    if (!m_moved_leaves.empty()) {
+        tree.move(m_moved_leaves, m_moved_leaf_aabbs, m_moved_leaf_displacements, m_moved_leaf_margins);
+    }
+}
+
+void broadphase::move_aabbs(bool mt) {
     // Update AABBs of procedural nodes in the dynamic tree.
     auto proc_aabb_node_view = m_registry->view<tree_resident, AABB, procedural_tag>(exclude_sleeping_disabled);
-    proc_aabb_node_view.each([&](tree_resident &node, AABB &aabb) {
-        m_tree.move(node.id, aabb);
-    });
+    move_leaves(mt, proc_aabb_node_view, m_tree);
 
-    // Update kinematic AABBs in non-procedural tree.
-    // TODO: only do this for kinematic entities that had their AABB updated.
+    // Update kinematic AABBs in non-procedural tree. Only the kinematic
+    // entities whose AABB left the inflated AABB of their leaf change the
+    // tree and require the compact tree to be rebuilt.
     auto kinematic_aabb_node_view = m_registry->view<tree_resident, AABB, kinematic_tag>(exclude_sleeping_disabled);
-    kinematic_aabb_node_view.each([&](tree_resident &node, AABB &aabb) {
-        m_np_tree.move(node.id, aabb);
-    });
+    move_leaves(mt, kinematic_aabb_node_view, m_np_tree);
+    m_np_compact_tree_dirty |= !m_moved_leaves.empty();
 
+    // Only awake islands move. Islands whose AABB is still within the
+    // inflated AABB of their leaf are skipped by the tree.
     auto island_aabb_node_view = m_registry->view<island_tree_resident, island_AABB>(exclude_sleeping_disabled);
-    island_aabb_node_view.each([&](island_tree_resident &node, island_AABB &aabb) {
-        m_island_tree.move(node.id, aabb);
-    });
+    m_moved_leaves.clear();
+    m_moved_leaf_aabbs.clear();
+    m_moved_leaf_displacements.clear();
+    m_moved_leaf_margins.clear();
+
+    for (auto [entity, node, aabb] : island_aabb_node_view.each()) {
+        EDYN_ASSERT(!node.sleeping);
+        m_moved_leaves.push_back(node.id);
+        m_moved_leaf_aabbs.push_back(aabb);
+    }
+
+    if (!m_moved_leaves.empty()) {
+        m_island_tree.move(m_moved_leaves, m_moved_leaf_aabbs, m_moved_leaf_displacements, m_moved_leaf_margins);
+    }
+}
+
+void broadphase::update_compact_tree() {
+    if (m_np_compact_tree_dirty) {
+        m_np_compact_tree.build(m_np_tree);
+        m_np_compact_tree_dirty = false;
+        ++m_np_compact_tree_version;
+    }
 }
 
-void broadphase::destroy_separated_manifolds() {
+void broadphase::destroy_separated_manifolds(bool mt) {
     auto aabb_view = m_registry->view<AABB>();
-    auto manifold_view = m_registry->view<contact_manifold>(exclude_sleeping_disabled);
+    auto manifold_view = awake_group<contact_manifold>(*m_registry);
+
+    m_check_entities.clear();
+    m_check_entities.insert(m_check_entities.end(), manifold_view.begin(), manifold_view.end());
+    m_check_flags.assign(m_check_entities.size(), 0);
+
+    // Find manifolds of pairs whose AABBs are not intersecting anymore.
+    auto check = [&](const entt::entity *first, const entt::entity *last, unsigned start) {
+        for (auto index = start; first != last; ++first, ++index) {
+            auto [manifold] = manifold_view.get(*first);
+            auto [b0] = aabb_view.get(manifold.body[0]);
+            auto [b1] = aabb_view.get(manifold.body[1]);
+            const auto separation_offset = vector3_one * -manifold.separation_threshold;
+            m_check_flags[index] = !intersect(b0.inset(separation_offset), b1);
+        }
+    };
+
+    if (mt && m_check_entities.size() > parallel_check_threshold) {
+        parallel_for_each_range(*m_registry, m_check_entities, check);
+    } else {
+        check(m_check_entities.data(), m_check_entities.data() + m_check_entities.size(), 0);
+    }
+
+    // Destroy them in the order of the view, which does not depend on how
+    // the work was split.
+    for (size_t i = 0; i < m_check_entities.size(); ++i) {
+        if (m_check_flags[i]) {
+            m_registry->destroy(m_check_entities[i]);
+            ++m_stats.num_manifolds_destroyed;
+        }
+    }
+}
+
+void broadphase::mark_moved(entt::entity entity, tree_resident &resident) {
+    if (!resident.moved) {
+        resident.moved = true;
+        m_moved_entities.push_back(entity);
+    }
+}
+
+size_t broadphase::collect_pairs(entt::entity entity, entity_pair_vector &pairs) const {
+    auto resident_view = m_registry->view<tree_resident>();
+    auto &resident = resident_view.get<tree_resident>(entity);
+    auto &tree = resident.procedural ? m_tree : m_np_tree;
+    // Lookups are lock-free and this can run in parallel since manifolds are
+    // only created and destroyed after all pairs are collected. Pairs with a
+    // manifold are skipped since they become pending again once their
+    // manifold is destroyed.
+    auto &manifold_map = m_registry->ctx().get<contact_manifold_map>();
 
-    // Destroy manifolds of pairs whose AABBs are not intersecting anymore.
-    manifold_view.each([&](entt::entity entity, contact_manifold &manifold) {
-        auto [b0] = aabb_view.get(manifold.body[0]);
-        auto [b1] = aabb_view.get(manifold.body[1]);
-        const auto separation_offset = vector3_one * -manifold.separation_threshold;
+    // Query with the inflated AABB since the entity can move anywhere inside
+    // of it before it is queried again.
+    auto &node = tree.get_node(resident.id);
+    auto offset_aabb = node.aabb.inset(m_aabb_offset);
+    size_t num_overlaps = 0;
+
+    // Skip entities and subtrees the collision filter does not accept while
+    // traversing the trees.
+    auto query_proc = [&](auto func) {
+        if (m_filter_in_trees) {
+            query_procedural(offset_aabb, node.filter, func);
+        } else {
+            query_procedural(offset_aabb, func);
+        }
+    };
 
-        if (!intersect(b0.inset(separation_offset), b1)) {
-            m_registry->destroy(entity);
+    auto query_np = [&](auto func) {
+        if (m_filter_in_trees) {
+            query_non_procedural(offset_aabb, node.filter, func);
+        } else {
+            query_non_procedural(offset_aabb, func);
         }
+    };
+
+    // Pairs of procedural entities are found by sweep and prune.
+    if (resident.procedural && m_algorithm == broadphase_algorithm::sweep_and_prune) {
+        query_np([&](entt::entity other) {
+            ++num_overlaps;
+
+            if (!resident_view.get<tree_resident>(other).moved && !manifold_map.contains(entity, other)) {
+                pairs.emplace_back(entity, other);
+            }
+        });
+    } else if (resident.procedural && m_algorithm == broadphase_algorithm::linear_bvh) {
+        // The hierarchy holds the AABBs inflated by half the offset, as the
+        // sweep and prune does, and is queried with the entity's own.
+        m_lbvh.query(entity, m_filter_in_trees, [&](entt::entity other) {
+            ++num_overlaps;
+
+            if ((resident_view.get<tree_resident>(other).moved && other < entity) ||
+                manifold_map.contains(entity, other)) {
+                return;
+            }
+
+            pairs.emplace_back(entity, other);
+        });
+
+        query_np([&](entt::entity other) {
+            ++num_overlaps;
+
+            if (!resident_view.get<tree_resident>(other).moved && !manifold_map.contains(entity, other)) {
+                pairs.emplace_back(entity, other);
+            }
+        });
+    } else if (resident.procedural) {
+        query_proc([&](entt::entity other) {
+            ++num_overlaps;
+
+            // If both moved, only one of them adds the pair.
+            if (other == entity || (resident_view.get<tree_resident>(other).moved && other < entity) ||
+                manifold_map.contains(entity, other)) {
+                return;
+            }
+
+            pairs.emplace_back(entity, other);
+        });
+
+        query_np([&](entt::entity other) {
+            ++num_overlaps;
+
+            // A moved non-procedural entity finds this one when it queries
+            // the procedural tree.
+            if (!resident_view.get<tree_resident>(other).moved && !manifold_map.contains(entity, other)) {
+                pairs.emplace_back(entity, other);
+            }
+        });
+    } else {
+        // Non-procedural entities never collide with one another.
+        query_proc([&](entt::entity other) {
+            ++num_overlaps;
+
+            if (!manifold_map.contains(other, entity)) {
+                pairs.emplace_back(other, entity);
+            }
+        });
+    }
+
+    return num_overlaps;
+}
+
+void broadphase::collect_pairs_parallel() {
+    // The result vectors are never shrunk so their memory can be reused in
+    // the next steps, even if fewer entities move in between.
+    if (m_pair_results.size() < m_moved_entities.size()) {
+        m_pair_results.resize(m_moved_entities.size());
+    }
+
+    auto num_overlaps = std::atomic<size_t>{0};
+
+    parallel_for_each_range(*m_registry, m_moved_entities,
+                            [this, &num_overlaps](const entt::entity *first, const entt::entity *last, unsigned start) {
+        size_t count = 0;
+
+        for (auto index = start; first != last; ++first, ++index) {
+            count += collect_pairs(*first, m_pair_results[index]);
+        }
+
+        num_overlaps.fetch_add(count, std::memory_order_relaxed);
     });
+
+    m_stats.num_overlaps += num_overlaps.load(std::memory_order_relaxed);
+
+    for (size_t i = 0; i < m_moved_entities.size(); ++i) {
+        auto &pairs = m_pair_results[i];
+        m_pending_pairs.insert(m_pending_pairs.end(), pairs.begin(), pairs.end());
+        pairs.clear();
+    }
 }
 
-void broadphase::collide_tree(const dynamic_tree &tree, entt::entity entity,
-                              const AABB &offset_aabb) const {
+void broadphase::sort_pending_pairs() {
+    auto resident_view = m_registry->view<tree_resident>();
+
+    // Put pairs in a canonical order so duplicates are adjacent after sorting.
+    // Pairs involving entities that are not in a tree anymore are dropped.
+    auto last = std::remove_if(m_pending_pairs.begin(), m_pending_pairs.end(), [&](entity_pair &pair) {
+        if (!m_registry->valid(pair.first) || !m_registry->valid(pair.second) ||
+            !resident_view.contains(pair.first) || !resident_view.contains(pair.second)) {
+            return true;
+        }
+
+        auto procedural0 = resident_view.get<tree_resident>(pair.first).procedural;
+        auto procedural1 = resident_view.get<tree_resident>(pair.second).procedural;
+
+        if (!procedural0 && !procedural1) {
+            return true;
+        }
+
+        if (!procedural0 || (procedural1 && pair.second < pair.first)) {
+            std::swap(pair.first, pair.second);
+        }
+
+        return false;
+    });
+    m_pending_pairs.erase(last, m_pending_pairs.end());
+
+    std::sort(m_pending_pairs.begin(), m_pending_pairs.end());
+    m_pending_pairs.erase(std::unique(m_pending_pairs.begin(), m_pending_pairs.end()), m_pending_pairs.end());
+}
+
+void broadphase::process_pending_pairs() {
     auto aabb_view = m_registry->view<AABB>();
+    auto resident_view = m_registry->view<tree_resident>();
+    auto sleeping_view = m_registry->view<sleeping_tag>();
+    auto disabled_view = m_registry->view<disabled_tag>();
+    auto sensor_view = m_registry->view<sensor_tag>();
     auto &settings = m_registry->ctx().get<edyn::settings>();
+    auto exclusion_view = m_registry->view<collision_exclusion>();
     auto &manifold_map = m_registry->ctx().get<contact_manifold_map>();
-    auto disabled_view = m_registry->view<disabled_tag>();
+    size_t num_pending = 0;
+    m_stats.num_pending_pairs = m_pending_pairs.size();
 
-    tree.query(offset_aabb, [&](tree_node_id_t id) {
-        auto &node = tree.get_node(id);
-        auto collides = (*settings.should_collide_func)(*m_registry, entity, node.entity);
+    auto should_collide = [&](entt::entity first, entt::entity second) {
+        if (!m_filter_in_trees) {
+            return (*settings.should_collide_func)(*m_registry, first, second);
+        }
 
-        if (collides && !manifold_map.contains(entity, node.entity) && !disabled_view.contains(node.entity)) {
-            auto [other_aabb] = aabb_view.get(node.entity);
+        // The filters were tested already. Exclusions are rare thus only
+        // look them up if any of the entities has one.
+        return !(exclusion_view.contains(first) || exclusion_view.contains(second)) ||
+               !is_collision_excluded(*m_registry, first, second);
+    };
 
-            if (intersect(offset_aabb, other_aabb)) {
-                make_contact_manifold(*m_registry, entity, node.entity, m_separation_threshold);
+    for (auto &pair : m_pending_pairs) {
+        auto [first, second] = pair;
+
+        if (!m_registry->valid(first) || !m_registry->valid(second) ||
+            !resident_view.contains(first) || !resident_view.contains(second)) {
+            continue;
+        }
+
+        auto &resident0 = resident_view.get<tree_resident>(first);
+        auto &resident1 = resident_view.get<tree_resident>(second);
+        auto &node0 = (resident0.procedural ? m_tree : m_np_tree).get_node(resident0.id);
+        auto &node1 = (resident1.procedural ? m_tree : m_np_tree).get_node(resident1.id);
+
+        // Drop pairs whose inflated AABBs are not close anymore. One of them
+        // must move for them to become close again, which would find the
+        // pair once more.
+        if (!intersect(node0.aabb.inset(m_aabb_offset), node1.aabb)) {
+            continue;
+        }
+
+        // It will be added back when the manifold is destroyed.
+        if (manifold_map.contains(first, second)) {
+            continue;
+        }
+
+        // Sensors do not interact with one another. Tracked sensor pairs are
+        // added back once their AABBs separate.
+        auto sensor0 = sensor_view.contains(first);
+        auto sensor1 = sensor_view.contains(second);
+        auto sensor_pair = sensor0 ? entity_pair{first, second} : entity_pair{second, first};
+
+        if ((sensor0 && sensor1) || ((sensor0 || sensor1) && m_sensor_pairs.count(sensor_pair))) {
+            continue;
+        }
+
+        // Pairs found before a filter changed. The pair is found again if a
+        // filter changes once more.
+        if (m_filter_in_trees && !collision_filter_test(node0.filter, node1.filter)) {
+            continue;
+        }
+
+        auto awake = !sleeping_view.contains(first) || (resident1.procedural && !sleeping_view.contains(second));
+        auto enabled = !disabled_view.contains(first) && !disabled_view.contains(second);
+        auto [aabb0] = aabb_view.get(first);
+        auto [aabb1] = aabb_view.get(second);
+
+        if (awake && enabled && intersect(aabb0.inset(m_aabb_offset), aabb1) &&
+            should_collide(first, second)) {
+            // Sensors only track whether they overlap the other entity, which
+            // is decided in `update_sensor_pairs`.
+            if (sensor0 || sensor1) {
+                m_sensor_pairs.emplace(sensor_pair, false);
+                continue;
             }
+
+            m_new_manifold_pairs.push_back(pair);
+            continue;
         }
-    });
+
+        m_pending_pairs[num_pending++] = pair;
+    }
+
+    m_pending_pairs.resize(num_pending);
+
+    // Manifolds are created after all pairs are processed, all at once.
+    m_stats.num_manifolds_created +=
+        make_contact_manifolds(*m_registry, m_new_manifold_pairs, m_separation_threshold);
+    m_new_manifold_pairs.clear();
+}
+
+void broadphase::push_sensor_event(entt::entity sensor, entt::entity other, sensor_event_type type) {
+    // Registries which only simulate ahead, such as in extrapolation, do not
+    // collect events.
+    if (auto *buffer = m_registry->ctx().find<sensor_event_buffer>()) {
+        buffer->events.push_back(sensor_event{sensor, other, type});
+    }
 }
 
-void broadphase::collide_tree_async(const dynamic_tree &tree, entt::entity entity,
-                                    const AABB &offset_aabb, size_t result_index) {
+void broadphase::update_sensor_pairs() {
+    if (m_sensor_pairs.empty()) {
+        return;
+    }
+
     auto aabb_view = m_registry->view<AABB>();
-    auto &settings = m_registry->ctx().get<edyn::settings>();
+    auto resident_view = m_registry->view<tree_resident>();
+    auto sleeping_view = m_registry->view<sleeping_tag>();
     auto disabled_view = m_registry->view<disabled_tag>();
+    auto sensor_aabb_view = m_registry->view<sensor_aabb_tag>();
+    const auto separation_offset = vector3_one * -m_separation_threshold;
+
+    for (auto it = m_sensor_pairs.begin(); it != m_sensor_pairs.end();) {
+        auto [sensor, other] = it->first;
+        auto &overlapping = it->second;
+
+        // One of them was destroyed or lost its shape.
+        if (!m_registry->valid(sensor) || !m_registry->valid(other) ||
+            !resident_view.contains(sensor) || !resident_view.contains(other)) {
+            if (overlapping) {
+                push_sensor_event(sensor, other, sensor_event_type::exit);
+            }
 
-    tree.query(offset_aabb, [&](tree_node_id_t id) {
-        auto &node = tree.get_node(id);
+            it = m_sensor_pairs.erase(it);
+            continue;
+        }
 
-        if ((*settings.should_collide_func)(*m_registry, entity, node.entity) && !disabled_view.contains(node.entity)) {
-            auto [other_aabb] = aabb_view.get(node.entity);
+        auto [aabb0] = aabb_view.get(sensor);
+        auto [aabb1] = aabb_view.get(other);
 
-            if (intersect(offset_aabb, other_aabb)) {
-                m_pair_results[result_index].emplace_back(entity, node.entity);
+        // Stop tracking the pair once the AABBs separate, as is done with
+        // contact manifolds. Their AABBs might still be close thus the pair
+        // becomes pending again.
+        if (!intersect(aabb0.inset(separation_offset), aabb1)) {
+            if (overlapping) {
+                push_sensor_event(sensor, other, sensor_event_type::exit);
             }
+
+            m_pending_pairs.emplace_back(sensor, other);
+            m_sort_pending_pairs = true;
+            it = m_sensor_pairs.erase(it);
+            continue;
         }
-    });
+
+        // Nothing changes while the procedural entities in the pair sleep.
+        auto procedural0 = resident_view.get<tree_resident>(sensor).procedural;
+        auto procedural1 = resident_view.get<tree_resident>(other).procedural;
+        auto asleep = (!procedural0 || sleeping_view.contains(sensor)) &&
+                      (!procedural1 || sleeping_view.contains(other));
+
+        if (!asleep) {
+            auto overlaps = !disabled_view.contains(sensor) && !disabled_view.contains(other) &&
+                            intersect(aabb0, aabb1) &&
+                            (sensor_aabb_view.contains(sensor) ||
+                             internal::sensor_shapes_intersect(*m_registry, sensor, other));
+
+            if (overlaps != overlapping) {
+                overlapping = overlaps;
+                push_sensor_event(sensor, other, overlaps ? sensor_event_type::enter : sensor_event_type::exit);
+            }
+        }
+
+        ++it;
+    }
 }
 
-void broadphase::update(bool mt) {
-    init_new_aabb_entities();
-    destroy_separated_manifolds();
-    move_aabbs();
+void broadphase::update_filter_mode() {
+    auto &settings = m_registry->ctx().get<edyn::settings>();
+    auto filter_in_trees = settings.should_collide_func == &should_collide_default;
+
+    if (filter_in_trees == m_filter_in_trees) {
+        return;
+    }
 
-    // Search for new AABB intersections and create manifolds.
-    auto aabb_proc_view = m_registry->view<AABB, procedural_tag>(exclude_sleeping_disabled);
+    m_filter_in_trees = filter_in_trees;
 
-    if (mt && calculate_view_size(aabb_proc_view) > m_max_sequential_size) {
-        collide_parallel();
-        finish_collide();
-    } else {
-        for (auto [entity, aabb] : aabb_proc_view.each()) {
-            auto offset_aabb = aabb.inset(m_aabb_offset);
-            collide_tree(m_tree, entity, offset_aabb);
-            collide_tree(m_np_tree, entity, offset_aabb);
-        }
+    // Pairs were skipped according to the previous mode. Query the trees
+    // again for all entities.
+    for (auto [entity, resident] : m_registry->view<tree_resident>().each()) {
+        mark_moved(entity, resident);
     }
 }
 
-void broadphase::collide_parallel_task(unsigned start, unsigned end) {
-    auto aabb_proc_view = m_registry->view<AABB, procedural_tag>(exclude_sleeping_disabled);
-    auto first = aabb_proc_view.begin();
-    std::advance(first, start);
-    auto index = start;
+void broadphase::update_algorithm() {
+    auto &settings = m_registry->ctx().get<edyn::settings>();
+
+    if (settings.broadphase_algorithm == m_algorithm) {
+        return;
+    }
+
+    m_algorithm = settings.broadphase_algorithm;
+    m_sap.clear();
+    m_lbvh.clear();
 
-    for (; index != end; ++first, ++index) {
-        auto entity = *first;
-        auto &aabb = aabb_proc_view.get<AABB>(entity);
-        auto offset_aabb = aabb.inset(m_aabb_offset);
-        collide_tree_async(m_tree, entity, offset_aabb, index);
-        collide_tree_async(m_np_tree, entity, offset_aabb, index);
+    // Find all pairs again with the new algorithm. Procedural entities are
+    // inserted into the sweep and prune or the linear hierarchy as they're
+    // marked as moved.
+    for (auto [entity, resident] : m_registry->view<tree_resident>().each()) {
+        mark_moved(entity, resident);
     }
 }
 
-void broadphase::collide_parallel() {
-    auto aabb_proc_view = m_registry->view<AABB, procedural_tag>(exclude_sleeping_disabled);
-    auto aabb_proc_size = calculate_view_size(aabb_proc_view);
-    m_pair_results.resize(aabb_proc_size);
+void broadphase::update_sweep_and_prune() {
+    auto resident_view = m_registry->view<tree_resident>();
 
-    auto task = task_delegate_t(entt::connect_arg_t<&broadphase::collide_parallel_task>{}, *this);
-    enqueue_task_wait(*m_registry, task, aabb_proc_size);
+    for (auto entity : m_moved_entities) {
+        auto &resident = resident_view.get<tree_resident>(entity);
+
+        if (!resident.procedural) {
+            continue;
+        }
+
+        // Inflate both AABBs by half the offset, which makes them intersect
+        // if the AABB of one of them inflated by the full offset intersects
+        // the other, as in the tree queries.
+        auto &node = m_tree.get_node(resident.id);
+        auto aabb = node.aabb.inset(m_aabb_offset * scalar(0.5));
+
+        if (m_sap.contains(entity)) {
+            m_sap.set_aabb(entity, aabb);
+            m_sap.set_filter(entity, node.filter);
+        } else {
+            m_sap.insert(entity, aabb, node.filter);
+        }
+    }
+
+    m_sap.sort();
 }
 
-void broadphase::finish_collide() {
+void broadphase::update_linear_bvh() {
+    auto resident_view = m_registry->view<tree_resident>();
+
+    for (auto entity : m_moved_entities) {
+        auto &resident = resident_view.get<tree_resident>(entity);
+
+        if (!resident.procedural) {
+            continue;
+        }
+
+        auto &node = m_tree.get_node(resident.id);
+        auto aabb = node.aabb.inset(m_aabb_offset * scalar(0.5));
+
+        if (m_lbvh.contains(entity)) {
+            m_lbvh.set_aabb(entity, aabb);
+            m_lbvh.set_filter(entity, node.filter);
+        } else {
+            m_lbvh.insert(entity, aabb, node.filter);
+        }
+    }
+
+    // Rebuilt before collecting pairs, which queries it in parallel.
+    m_lbvh.build();
+}
+
+void broadphase::find_sweep_and_prune_pairs() {
     auto &manifold_map = m_registry->ctx().get<contact_manifold_map>();
 
-    for (auto &pairs : m_pair_results) {
-        for (auto &pair : pairs) {
-            if (!manifold_map.contains(pair.first, pair.second)) {
-                make_contact_manifold(*m_registry, pair.first, pair.second, m_separation_threshold);
+    m_sap.find_pairs(m_filter_in_trees, [&](entt::entity first, entt::entity second) {
+        ++m_stats.num_overlaps;
+
+        if (!manifold_map.contains(first, second)) {
+            m_pending_pairs.emplace_back(first, second);
+        }
+    });
+
+    m_sap.clear_moved();
+}
+
+void broadphase::update(bool mt) {
+    m_stats = {};
+    update_filter_mode();
+    update_algorithm();
+    init_new_aabb_entities();
+    destroy_separated_manifolds(mt);
+    move_aabbs(mt);
+    update_compact_tree();
+
+    // Only query the trees for entities whose inflated AABB changed. Pairs
+    // of entities that did not move were found in a previous update and
+    // are still pending or have a manifold already.
+    auto resident_view = m_registry->view<tree_resident>();
+    entity_vector_erase_invalid(m_moved_entities, *m_registry);
+    m_moved_entities.erase(std::remove_if(m_moved_entities.begin(), m_moved_entities.end(), [&](auto entity) {
+        return !resident_view.contains(entity);
+    }), m_moved_entities.end());
+
+    m_stats.num_moved_entities = m_moved_entities.size();
+
+    if (!m_moved_entities.empty()) {
+        if (m_algorithm == broadphase_algorithm::sweep_and_prune) {
+            update_sweep_and_prune();
+        } else if (m_algorithm == broadphase_algorithm::linear_bvh) {
+            update_linear_bvh();
+        }
+
+        if (mt && m_moved_entities.size() > m_max_sequential_size) {
+            collect_pairs_parallel();
+        } else {
+            for (auto entity : m_moved_entities) {
+                m_stats.num_overlaps += collect_pairs(entity, m_pending_pairs);
             }
         }
-        pairs.clear();
+
+        if (m_algorithm == broadphase_algorithm::sweep_and_prune) {
+            find_sweep_and_prune_pairs();
+        }
+
+        for (auto entity : m_moved_entities) {
+            resident_view.get<tree_resident>(entity).moved = false;
+        }
+
+        m_moved_entities.clear();
+        m_sort_pending_pairs = true;
+    }
+
+    if (m_sort_pending_pairs) {
+        sort_pending_pairs();
+        m_sort_pending_pairs = false;
+    }
+
+    // Create manifolds for pending pairs that started intersecting.
+    process_pending_pairs();
+    update_sensor_pairs();
+}
+
+void broadphase::shift_origin(const vector3 &offset) {
+    m_tree.shift_origin(offset);
+    m_np_tree.shift_origin(offset);
+    m_island_tree.shift_origin(offset);
+    m_sleeping_island_tree.shift_origin(offset);
+    m_sap.shift_origin(offset);
+    m_lbvh.shift_origin(offset);
+
+    // The quantized bounds are relative to the root bounds, which would have
+    // to be shifted as well, but rebuilding keeps them exactly conservative.
+    if (!m_np_compact_tree.empty()) {
+        m_np_compact_tree_dirty = true;
     }
 }
 
+size_t broadphase::num_bytes() const {
+    auto size = m_tree.num_bytes() + m_np_tree.num_bytes() + m_island_tree.num_bytes() +
+                m_sleeping_island_tree.num_bytes() +
+                m_np_compact_tree.num_bytes() + m_sap.num_bytes() + m_lbvh.num_bytes();
+    size += (m_new_aabb_entities.capacity() + m_moved_entities.capacity()) * sizeof(entt::entity);
+    size += (m_pending_pairs.capacity() + m_new_manifold_pairs.capacity()) * sizeof(entity_pair);
+    size += m_check_entities.capacity() * sizeof(entt::entity) + m_check_flags.capacity();
+    size += m_moved_leaves.capacity() * sizeof(tree_node_id_t) + m_moved_leaf_aabbs.capacity() * sizeof(AABB);
+    size += m_moved_leaf_displacements.capacity() * sizeof(vector3) +
+            m_moved_leaf_margins.capacity() * sizeof(aabb_margin);
+
+    for (auto &pairs : m_pair_results) {
+        size += pairs.capacity() * sizeof(entity_pair);
+    }
+
+    // Each node of the map holds three pointers and a color besides the
+    // value.
+    size += m_sensor_pairs.size() * (sizeof(decltype(m_sensor_pairs)::value_type) + 4 * sizeof(void *));
+
+    return size;
+}
+
 void broadphase::clear() {
     m_tree.clear();
     m_np_tree.clear();
+    m_np_compact_tree.clear();
+    m_np_compact_tree_dirty = false;
+    ++m_np_compact_tree_version;
     m_island_tree.clear();
+    m_sleeping_island_tree.clear();
+    m_sap.clear();
+    m_lbvh.clear();
     m_new_aabb_entities.clear();
+    m_moved_entities.clear();
+    m_pending_pairs.clear();
+    m_sort_pending_pairs = false;
     m_pair_results.clear();
+    m_sensor_pairs.clear();
 }
 
 void broadphase::set_procedural(entt::entity entity, bool procedural) {
@@ -252,14 +924,90 @@ void broadphase::set_procedural(entt::entity entity, bool procedural) {
 
     if (resident.procedural) {
         m_tree.destroy(resident.id);
+
+        if (m_sap.contains(entity)) {
+            m_sap.erase(entity);
+        }
+
+        if (m_lbvh.contains(entity)) {
+            m_lbvh.erase(entity);
+        }
     } else {
         m_np_tree.destroy(resident.id);
     }
 
+    m_np_compact_tree_dirty = true;
+
     auto &tree = procedural ? m_tree : m_np_tree;
     auto &aabb = m_registry->get<AABB>(entity);
-    resident.id = tree.create(aabb, entity);
+    resident.id = tree.create(aabb, entity, get_collision_filter(*m_registry, entity),
+                              get_aabb_margin(*m_registry, entity));
     resident.procedural = procedural;
+    mark_moved(entity, resident);
+}
+
+void broadphase::set_procedural(const std::vector<entt::entity> &entities, bool procedural) {
+    if (entities.size() < bulk_tree_build_threshold) {
+        for (auto entity : entities) {
+            set_procedural(entity, procedural);
+        }
+        return;
+    }
+
+    auto resident_view = m_registry->view<AABB, tree_resident>();
+    auto aabbs = std::vector<AABB>{};
+    auto changed_entities = std::vector<entt::entity>{};
+    auto filters = std::vector<collision_filter>{};
+    auto margins = std::vector<aabb_margin>{};
+    auto ids = std::vector<tree_node_id_t>{};
+
+    for (auto entity : entities) {
+        if (!resident_view.contains(entity)) {
+            continue;
+        }
+
+        auto [aabb, resident] = resident_view.get(entity);
+
+        if (resident.procedural == procedural) {
+            continue;
+        }
+
+        if (resident.procedural) {
+            m_tree.destroy(resident.id);
+
+            if (m_sap.contains(entity)) {
+                m_sap.erase(entity);
+            }
+
+            if (m_lbvh.contains(entity)) {
+                m_lbvh.erase(entity);
+            }
+        } else {
+            m_np_tree.destroy(resident.id);
+        }
+
+        aabbs.push_back(aabb);
+        changed_entities.push_back(entity);
+        filters.push_back(get_collision_filter(*m_registry, entity));
+        margins.push_back(get_aabb_margin(*m_registry, entity));
+    }
+
+    if (changed_entities.empty()) {
+        return;
+    }
+
+    m_np_compact_tree_dirty = true;
+
+    auto &tree = procedural ? m_tree : m_np_tree;
+    tree.create(aabbs, changed_entities, ids, filters, margins);
+
+    for (size_t i = 0; i < ids.size(); ++i) {
+        auto entity = changed_entities[i];
+        auto &resident = resident_view.get<tree_resident>(entity);
+        resident.id = ids[i];
+        resident.procedural = procedural;
+        mark_moved(entity, resident);
+    }
 }
 
 }
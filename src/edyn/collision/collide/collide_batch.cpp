@@ -0,0 +1,278 @@
+#include "edyn/collision/collide_batch.hpp"
+#include "edyn/math/simd_vector3.hpp"
+#include "edyn/math/transform.hpp"
+
+namespace edyn {
+
+// Contexts of a batch transposed into a structure of arrays.
+struct collide_batch_transforms {
+    simd_vector3 posA, posB;
+    simd_quaternion ornA, ornB;
+    simd_scalar threshold;
+};
+
+// Lane values of a batch of vectors.
+struct collide_batch_vectors {
+    alignas(simd_alignment) scalar v[3][simd_width];
+
+    vector3 operator[](size_t lane) const {
+        return {v[0][lane], v[1][lane], v[2][lane]};
+    }
+};
+
+static simd_vector3 load_vector3(const vector3 *v) {
+    alignas(simd_alignment) scalar soa[3][simd_width];
+
+    for (size_t lane = 0; lane < simd_width; ++lane) {
+        for (size_t i = 0; i < 3; ++i) {
+            soa[i][lane] = v[lane][i];
+        }
+    }
+
+    return simd_vector3::load(soa);
+}
+
+static simd_quaternion load_quaternion(const quaternion *q) {
+    alignas(simd_alignment) scalar soa[4][simd_width];
+
+    for (size_t lane = 0; lane < simd_width; ++lane) {
+        for (size_t i = 0; i < 4; ++i) {
+            soa[i][lane] = q[lane][i];
+        }
+    }
+
+    return simd_quaternion::load(soa);
+}
+
+template<typename Func>
+static simd_scalar load_scalar(Func func) {
+    alignas(simd_alignment) scalar values[simd_width];
+
+    for (size_t lane = 0; lane < simd_width; ++lane) {
+        values[lane] = func(lane);
+    }
+
+    return simd_scalar::load(values);
+}
+
+static collide_batch_transforms load_transforms(const collide_batch_contexts &ctx) {
+    vector3 posA[simd_width], posB[simd_width];
+    quaternion ornA[simd_width], ornB[simd_width];
+
+    for (size_t lane = 0; lane < simd_width; ++lane) {
+        posA[lane] = ctx[lane].posA;
+        posB[lane] = ctx[lane].posB;
+        ornA[lane] = ctx[lane].ornA;
+        ornB[lane] = ctx[lane].ornB;
+    }
+
+    collide_batch_transforms tr;
+    tr.posA = load_vector3(posA);
+    tr.posB = load_vector3(posB);
+    tr.ornA = load_quaternion(ornA);
+    tr.ornB = load_quaternion(ornB);
+    tr.threshold = load_scalar([&](size_t lane) { return ctx[lane].threshold; });
+    return tr;
+}
+
+static simd_vector3 load_plane_normals(const collide_batch_shapes<plane_shape> &planes) {
+    vector3 normals[simd_width];
+
+    for (size_t lane = 0; lane < simd_width; ++lane) {
+        normals[lane] = planes[lane]->normal;
+    }
+
+    return load_vector3(normals);
+}
+
+void collide_batch(const collide_batch_shapes<sphere_shape> &shA,
+                   const collide_batch_shapes<sphere_shape> &shB,
+                   const collide_batch_contexts &ctx, collide_batch_results &result) {
+    auto tr = load_transforms(ctx);
+    auto radiusA = load_scalar([&](size_t lane) { return shA[lane]->radius; });
+    auto radiusB = load_scalar([&](size_t lane) { return shB[lane]->radius; });
+
+    auto d = tr.posA - tr.posB;
+    auto dist_sqr = dot(d, d);
+    auto r = radiusA + radiusB + tr.threshold;
+    auto mask = less_equal_mask(dist_sqr, r * r);
+
+    if (mask == 0) {
+        return;
+    }
+
+    auto dist = sqrt(dist_sqr);
+    // Lanes with coincident centers divide by zero here. These are redone
+    // below with the regular function.
+    auto dn = d * (simd_scalar::splat(1) / dist);
+    auto zero = simd_scalar::splat(0);
+    auto pivotA = rotate(conjugate(tr.ornA), dn * (zero - radiusA));
+    auto pivotB = rotate(conjugate(tr.ornB), dn * radiusB);
+    auto distance = dist - radiusA - radiusB;
+
+    collide_batch_vectors pivotA_lanes, pivotB_lanes, normal_lanes;
+    alignas(simd_alignment) scalar dist_lanes[simd_width];
+    alignas(simd_alignment) scalar distance_lanes[simd_width];
+    pivotA.store(pivotA_lanes.v);
+    pivotB.store(pivotB_lanes.v);
+    dn.store(normal_lanes.v);
+    dist.store(dist_lanes);
+    distance.store(distance_lanes);
+
+    for (size_t lane = 0; lane < simd_width; ++lane) {
+        if (!(mask & (1u << lane))) {
+            continue;
+        }
+
+        if (!(dist_lanes[lane] > EDYN_EPSILON)) {
+            collide(*shA[lane], *shB[lane], ctx[lane], result[lane]);
+            continue;
+        }
+
+        result[lane].add_point({pivotA_lanes[lane], pivotB_lanes[lane], normal_lanes[lane],
+                                distance_lanes[lane], contact_normal_attachment::none});
+    }
+}
+
+void collide_batch(const collide_batch_shapes<sphere_shape> &shA,
+                   const collide_batch_shapes<plane_shape> &shB,
+                   const collide_batch_contexts &ctx, collide_batch_results &result) {
+    auto tr = load_transforms(ctx);
+    auto radius = load_scalar([&](size_t lane) { return shA[lane]->radius; });
+    auto constant = load_scalar([&](size_t lane) { return shB[lane]->constant; });
+    auto normal = load_plane_normals(shB);
+
+    auto center = normal * constant;
+    auto d = tr.posA - center;
+    auto l = dot(normal, d);
+    auto mask = less_equal_mask(l, radius);
+
+    if (mask == 0) {
+        return;
+    }
+
+    auto zero = simd_scalar::splat(0);
+    auto pivotA = rotate(conjugate(tr.ornA), normal * (zero - radius));
+    auto pivotB = rotate(conjugate(tr.ornB), d - normal * l - center);
+    auto distance = l - radius;
+
+    collide_batch_vectors pivotA_lanes, pivotB_lanes;
+    alignas(simd_alignment) scalar distance_lanes[simd_width];
+    pivotA.store(pivotA_lanes.v);
+    pivotB.store(pivotB_lanes.v);
+    distance.store(distance_lanes);
+
+    for (size_t lane = 0; lane < simd_width; ++lane) {
+        if (mask & (1u << lane)) {
+            result[lane].add_point({pivotA_lanes[lane], pivotB_lanes[lane], shB[lane]->normal,
+                                    distance_lanes[lane], contact_normal_attachment::normal_on_B});
+        }
+    }
+}
+
+void collide_batch(const collide_batch_shapes<capsule_shape> &shA,
+                   const collide_batch_shapes<plane_shape> &shB,
+                   const collide_batch_contexts &ctx, collide_batch_results &result) {
+    auto tr = load_transforms(ctx);
+    auto radius = load_scalar([&](size_t lane) { return shA[lane]->radius; });
+    auto half_length = load_scalar([&](size_t lane) { return shA[lane]->half_length; });
+    auto constant = load_scalar([&](size_t lane) { return shB[lane]->constant; });
+    auto normal = load_plane_normals(shB);
+
+    vector3 local_axes[simd_width];
+
+    for (size_t lane = 0; lane < simd_width; ++lane) {
+        local_axes[lane] = coordinate_axis_vector(shA[lane]->axis);
+    }
+
+    auto axis = rotate(tr.ornA, load_vector3(local_axes));
+    auto center = normal * constant;
+    simd_vector3 vertices[] = {
+        tr.posA + axis * half_length,
+        tr.posA - axis * half_length
+    };
+
+    simd_scalar proj[2];
+    unsigned masks[2];
+    collide_batch_vectors pivotA_lanes[2], pivotB_lanes[2];
+    alignas(simd_alignment) scalar proj_lanes[2][simd_width];
+    alignas(simd_alignment) scalar distance_lanes[2][simd_width];
+
+    for (size_t i = 0; i < 2; ++i) {
+        proj[i] = dot(vertices[i] - center, normal);
+        auto distance = proj[i] - radius;
+        masks[i] = less_equal_mask(distance, tr.threshold);
+        proj[i].store(proj_lanes[i]);
+        distance.store(distance_lanes[i]);
+    }
+
+    if ((masks[0] | masks[1]) == 0) {
+        return;
+    }
+
+    auto conjA = conjugate(tr.ornA);
+
+    for (size_t i = 0; i < 2; ++i) {
+        auto pivotA_world = vertices[i] - normal * radius;
+        auto pivotA = rotate(conjA, pivotA_world - tr.posA);
+        auto pivotB = vertices[i] - normal * proj[i];
+        pivotA.store(pivotA_lanes[i].v);
+        pivotB.store(pivotB_lanes[i].v);
+    }
+
+    for (size_t lane = 0; lane < simd_width; ++lane) {
+        collision_feature featureA;
+        auto is_capsule_edge = std::abs(proj_lanes[0][lane] - proj_lanes[1][lane]) < support_feature_tolerance;
+
+        if (is_capsule_edge) {
+            featureA.feature = capsule_feature::side;
+        } else {
+            featureA.feature = capsule_feature::hemisphere;
+            featureA.index = proj_lanes[0][lane] < proj_lanes[1][lane] ? 0 : 1;
+        }
+
+        for (size_t i = 0; i < 2; ++i) {
+            if (masks[i] & (1u << lane)) {
+                result[lane].add_point({pivotA_lanes[i][lane], pivotB_lanes[i][lane], shB[lane]->normal,
+                                        distance_lanes[i][lane], contact_normal_attachment::normal_on_B, featureA});
+            }
+        }
+    }
+}
+
+void collide_batch(const collide_batch_shapes<box_shape> &shA,
+                   const collide_batch_shapes<plane_shape> &shB,
+                   const collide_batch_contexts &ctx, collide_batch_results &result) {
+    auto tr = load_transforms(ctx);
+    auto constant = load_scalar([&](size_t lane) { return shB[lane]->constant; });
+    auto normal = load_plane_normals(shB);
+
+    vector3 half_extents[simd_width];
+
+    for (size_t lane = 0; lane < simd_width; ++lane) {
+        half_extents[lane] = shA[lane]->half_extents;
+    }
+
+    auto extents = load_vector3(half_extents);
+
+    // The box projected onto the plane normal has a radius equal to the sum
+    // of its half extents scaled by the plane normal in box space.
+    auto local_normal = rotate(conjugate(tr.ornA), normal);
+    auto radius = mul_add(abs(local_normal.x), extents.x,
+                  mul_add(abs(local_normal.y), extents.y,
+                          abs(local_normal.z) * extents.z));
+    auto distance = dot(tr.posA - normal * constant, normal) - radius;
+
+    // Use a small tolerance so that rounding differences with respect to the
+    // support feature computation never reject a pair that touches.
+    constexpr auto tolerance = scalar(1e-4);
+    auto mask = less_equal_mask(distance, tr.threshold + simd_scalar::splat(tolerance));
+
+    for (size_t lane = 0; lane < simd_width; ++lane) {
+        if (mask & (1u << lane)) {
+            collide(*shA[lane], *shB[lane], ctx[lane], result[lane]);
+        }
+    }
+}
+
+}
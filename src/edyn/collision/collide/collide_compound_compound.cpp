@@ -1,47 +1,157 @@
 #include "edyn/collision/collide.hpp"
+#include "edyn/collision/compound_pair_cache.hpp"
+#include "edyn/util/aabb_util.hpp"
 #include "edyn/math/transform.hpp"
+#include <algorithm>
 
 namespace edyn {
 
 void collide(const compound_shape &shA, const compound_shape &shB,
              const collision_context &ctx, collision_result &result) {
-    // Collide every node of B with A. Swap it if B has more nodes than A.
-    if (shA.nodes.size() < shB.nodes.size()) {
-        swap_collide(shA, shB, ctx, result);
-        return;
+    auto *cache = ctx.compound_cache;
+
+    if (cache) {
+        if (cache->num_nodesA != shA.nodes.size() || cache->num_nodesB != shB.nodes.size()) {
+            cache->clear();
+            cache->num_nodesA = shA.nodes.size();
+            cache->num_nodesB = shB.nodes.size();
+        }
+
+        cache->next_entries.clear();
+        cache->next_points.clear();
     }
 
-    for (size_t node_idx = 0; node_idx < shB.nodes.size(); ++node_idx) {
-        auto &nodeB = shB.nodes[node_idx];
+    auto add_point = [&](collision_result::collision_point point) {
+        if (cache) {
+            // Store the normal in the object space of A so it can follow its
+            // rotation when reused.
+            auto cached_point = point;
+            cached_point.normal = rotate(conjugate(ctx.ornA), point.normal);
+            cache->next_points.push_back(cached_point);
+        }
 
-        // Create a new collision context with the position of the child of B
-        // in world space.
+        result.maybe_add_point(point);
+    };
+
+    auto collide_children = [&](size_t idxA, size_t idxB) {
+        auto &nodeA = shA.nodes[idxA];
+        auto &nodeB = shB.nodes[idxB];
+
+        // Collision context with the children in world space.
         auto child_ctx = ctx;
+        child_ctx.posA = to_world_space(nodeA.position, ctx.posA, ctx.ornA);
+        child_ctx.ornA = ctx.ornA * nodeA.orientation;
+        child_ctx.aabbA = aabb_to_world_space(nodeA.aabb, ctx.posA, ctx.ornA);
         child_ctx.posB = to_world_space(nodeB.position, ctx.posB, ctx.ornB);
         child_ctx.ornB = ctx.ornB * nodeB.orientation;
+        child_ctx.aabbB = aabb_to_world_space(nodeB.aabb, ctx.posB, ctx.ornB);
+        child_ctx.sat_cache = nullptr;
+        child_ctx.compound_cache = nullptr;
+
+        auto entry = compound_pair_cache::entry{};
+
+        if (cache) {
+            auto inv_child_ornA = conjugate(child_ctx.ornA);
+            entry.nodeA = static_cast<uint32_t>(idxA);
+            entry.nodeB = static_cast<uint32_t>(idxB);
+            entry.posB = rotate(inv_child_ornA, child_ctx.posB - child_ctx.posA);
+            entry.ornB = inv_child_ornA * child_ctx.ornB;
+            entry.first_point = static_cast<uint32_t>(cache->next_points.size());
+
+            if (auto *cached = cache->find(entry.nodeA, entry.nodeB);
+                cached && cached->transform_matches(entry.posB, entry.ornB)) {
+                // Keep the points and the transform they were found with, so
+                // the tolerance is not exceeded by slowly drifting apart. The
+                // pivots are in object space thus only the normals and
+                // distances must be updated.
+                for (auto i = cached->first_point; i < cached->first_point + cached->num_points; ++i) {
+                    auto point = cache->points[i];
+                    cache->next_points.push_back(point);
+                    point.normal = rotate(ctx.ornA, point.normal);
+                    auto pivotA = to_world_space(point.pivotA, ctx.posA, ctx.ornA);
+                    auto pivotB = to_world_space(point.pivotB, ctx.posB, ctx.ornB);
+                    point.distance = dot(point.normal, pivotA - pivotB);
+                    result.maybe_add_point(point);
+                }
+
+                auto &next = cache->next_entries.emplace_back(*cached);
+                next.first_point = entry.first_point;
+                return;
+            }
+        }
+
         collision_result child_result;
 
-        // Collide child shape with compound.
-        std::visit([&](auto &&sh) {
-            collide(shA, sh, child_ctx, child_result);
-        }, nodeB.shape_var);
+        std::visit([&](auto &&shapeA) {
+            std::visit([&](auto &&shapeB) {
+                collide(shapeA, shapeB, child_ctx, child_result);
+            }, nodeB.shape_var);
+        }, nodeA.shape_var);
 
-        // Transform the B elements of the result points from child shape space
-        // into B's space.
+        // Transform the pivots from the space of the children into the space
+        // of the compounds and assign the part indices.
         for (size_t i = 0; i < child_result.num_points; ++i) {
             auto &child_point = child_result.point[i];
+            child_point.pivotA = to_world_space(child_point.pivotA, nodeA.position, nodeA.orientation);
             child_point.pivotB = to_world_space(child_point.pivotB, nodeB.position, nodeB.orientation);
 
-            // Assign the part index for the second compound. The part index
-            // for featureA was already assigned in the call to `collide` above.
+            if (!child_point.featureA) {
+                child_point.featureA = collision_feature{};
+            }
+
             if (!child_point.featureB) {
                 child_point.featureB = collision_feature{};
             }
 
-            child_point.featureB->part = node_idx;
+            child_point.featureA->part = idxA;
+            child_point.featureB->part = idxB;
+
+            add_point(child_point);
+        }
 
-            result.maybe_add_point(child_point);
+        if (cache) {
+            entry.num_points = static_cast<uint32_t>(child_result.num_points);
+            cache->next_entries.push_back(entry);
         }
+    };
+
+    // Visit the children of the compound with fewer nodes which intersect the
+    // AABB of the other, and then the children of the other which intersect
+    // each of them in its tree. Expand the AABBs to include children within
+    // the contact threshold.
+    const auto inset = vector3_one * -ctx.threshold;
+
+    if (shA.nodes.size() >= shB.nodes.size()) {
+        auto aabbA_in_B = aabb_to_object_space(ctx.aabbA, ctx.posB, ctx.ornB).inset(inset);
+
+        shB.visit(aabbA_in_B, [&](auto &&, size_t idxB) {
+            auto child_aabbB = aabb_to_world_space(shB.nodes[idxB].aabb, ctx.posB, ctx.ornB);
+            auto child_aabbB_in_A = aabb_to_object_space(child_aabbB, ctx.posA, ctx.ornA).inset(inset);
+
+            shA.visit(child_aabbB_in_A, [&](auto &&, size_t idxA) {
+                collide_children(idxA, idxB);
+            });
+        });
+    } else {
+        auto aabbB_in_A = aabb_to_object_space(ctx.aabbB, ctx.posA, ctx.ornA).inset(inset);
+
+        shA.visit(aabbB_in_A, [&](auto &&, size_t idxA) {
+            auto child_aabbA = aabb_to_world_space(shA.nodes[idxA].aabb, ctx.posA, ctx.ornA);
+            auto child_aabbA_in_B = aabb_to_object_space(child_aabbA, ctx.posB, ctx.ornB).inset(inset);
+
+            shB.visit(child_aabbA_in_B, [&](auto &&, size_t idxB) {
+                collide_children(idxA, idxB);
+            });
+        });
+    }
+
+    if (cache) {
+        // Pairs which are no longer near each other are dropped.
+        std::sort(cache->next_entries.begin(), cache->next_entries.end(), [](auto &e0, auto &e1) {
+            return e0.nodeA < e1.nodeA || (e0.nodeA == e1.nodeA && e0.nodeB < e1.nodeB);
+        });
+        cache->entries.swap(cache->next_entries);
+        cache->points.swap(cache->next_points);
     }
 }
 
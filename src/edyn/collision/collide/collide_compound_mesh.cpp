@@ -11,7 +11,12 @@ void collide(const compound_shape &compound, const triangle_mesh &mesh,
     // the compound's AABB and start the tree queries from that node in the
     // child collision tests.
 
-    for (size_t node_idx = 0; node_idx < compound.nodes.size(); ++node_idx) {
+    // Only visit the children which are near the triangle mesh, which is in
+    // world space.
+    const auto inset = vector3_one * -contact_breaking_threshold;
+    auto mesh_aabb_in_A = aabb_to_object_space(mesh.get_aabb().inset(inset), ctx.posA, ctx.ornA);
+
+    compound.visit(mesh_aabb_in_A, [&](auto &&shape, size_t node_idx) {
         auto &node = compound.nodes[node_idx];
 
         // New collision context with child shape in world space.
@@ -19,12 +24,11 @@ void collide(const compound_shape &compound, const triangle_mesh &mesh,
         child_ctx.posA = to_world_space(node.position, ctx.posA, ctx.ornA);
         child_ctx.ornA = ctx.ornA * node.orientation;
         child_ctx.aabbA = aabb_to_world_space(node.aabb, ctx.posA, ctx.ornA);
+        child_ctx.sat_cache = nullptr;
 
         collision_result child_result;
 
-        std::visit([&](auto &&sh) {
-            collide(sh, mesh, child_ctx, child_result);
-        }, node.shape_var);
+        collide(shape, mesh, child_ctx, child_result);
 
         // The elements of A in the collision points must be transformed from
         // the child node's space into the compound's space.
@@ -41,7 +45,7 @@ void collide(const compound_shape &compound, const triangle_mesh &mesh,
 
             result.maybe_add_point(child_point);
         }
-    }
+    });
 }
 
 }
@@ -19,6 +19,7 @@ void collide(const compound_shape &shA, const plane_shape &shB,
         auto child_ctx = ctx;
         child_ctx.posA = to_world_space(node.position, ctx.posA, ctx.ornA);
         child_ctx.ornA *= node.orientation;
+        child_ctx.sat_cache = nullptr;
         collision_result child_result;
 
         std::visit([&](auto &&sh) {
@@ -0,0 +1,254 @@
+#include "edyn/collision/collide.hpp"
+#include "edyn/collision/collision_result.hpp"
+#include "edyn/config/constants.hpp"
+#include "edyn/math/vector3.hpp"
+#include "edyn/math/triangle.hpp"
+#include "edyn/math/geom.hpp"
+#include "edyn/math/vector2_3_util.hpp"
+#include "edyn/math/math.hpp"
+#include "edyn/math/transform.hpp"
+#include "edyn/util/shape_util.hpp"
+#include <numeric>
+
+namespace edyn {
+
+// Indices of the vertices of a triangle feature, in order.
+static size_t get_triangle_feature_hull(triangle_feature tri_feature, size_t tri_feature_index,
+                                        std::array<size_t, 3> &hull) {
+    switch (tri_feature) {
+    case triangle_feature::face:
+        std::iota(hull.begin(), hull.end(), 0);
+        return 3;
+    case triangle_feature::edge:
+        hull[0] = tri_feature_index;
+        hull[1] = (tri_feature_index + 1) % 3;
+        return 2;
+    case triangle_feature::vertex:
+        hull[0] = tri_feature_index;
+        return 1;
+    }
+
+    return 0;
+}
+
+static void collide_triangle_triangle(
+    const triangle_mesh &meshA, size_t tri_idxA,
+    const triangle_mesh &meshB, size_t tri_idxB,
+    const collision_context &ctx, collision_result &result) {
+
+    // Both meshes are in world space.
+    auto verticesA = meshA.get_triangle_vertices(tri_idxA);
+    auto verticesB = meshB.get_triangle_vertices(tri_idxB);
+    auto normalA = meshA.get_triangle_normal(tri_idxA);
+    auto normalB = meshB.get_triangle_normal(tri_idxB);
+    auto centroidA = (verticesA[0] + verticesA[1] + verticesA[2]) / scalar(3);
+    auto centroidB = (verticesB[0] + verticesB[1] + verticesB[2]) / scalar(3);
+
+    // Distance along an axis that points towards A.
+    auto axis_distance = [&](const vector3 &dir) {
+        return -get_triangle_support_projection(verticesA, -dir) -
+                get_triangle_support_projection(verticesB, dir);
+    };
+
+    // Triangle B's normal points towards A and triangle A's normal points
+    // towards B when they face each other.
+    auto sep_axis = normalB;
+    auto distance = axis_distance(normalB);
+
+    {
+        auto dist = axis_distance(-normalA);
+
+        if (dist > distance) {
+            distance = dist;
+            sep_axis = -normalA;
+        }
+    }
+
+    // Edge vs edge.
+    for (size_t i = 0; i < 3; ++i) {
+        auto edgeA = verticesA[(i + 1) % 3] - verticesA[i];
+
+        for (size_t j = 0; j < 3; ++j) {
+            auto edgeB = verticesB[(j + 1) % 3] - verticesB[j];
+            auto dir = cross(edgeA, edgeB);
+
+            if (!try_normalize(dir)) {
+                continue;
+            }
+
+            if (dot(centroidA - centroidB, dir) < 0) {
+                dir *= -1;
+            }
+
+            auto dist = axis_distance(dir);
+
+            if (dist > distance) {
+                distance = dist;
+                sep_axis = dir;
+            }
+        }
+    }
+
+    if (distance > ctx.threshold) {
+        return;
+    }
+
+    triangle_feature featureB;
+    size_t feature_indexB;
+    scalar projectionB;
+    get_triangle_support_feature(verticesB, vector3_zero, sep_axis,
+                                 featureB, feature_indexB,
+                                 projectionB, support_feature_tolerance);
+
+    sep_axis = clip_triangle_separating_axis(sep_axis, meshB, tri_idxB, verticesB, normalB, featureB, feature_indexB);
+
+    get_triangle_support_feature(verticesB, vector3_zero, sep_axis,
+                                 featureB, feature_indexB,
+                                 projectionB, support_feature_tolerance);
+
+    triangle_feature featureA;
+    size_t feature_indexA;
+    scalar projectionA;
+    get_triangle_support_feature(verticesA, vector3_zero, -sep_axis,
+                                 featureA, feature_indexA,
+                                 projectionA, support_feature_tolerance);
+    projectionA = -projectionA;
+
+    distance = projectionA - projectionB;
+
+    if (distance > ctx.threshold) {
+        return;
+    }
+
+    if (-distance > meshB.get_thickness()) {
+        return;
+    }
+
+    auto hullA = std::array<size_t, 3>{};
+    auto hullB = std::array<size_t, 3>{};
+    auto hull_sizeA = get_triangle_feature_hull(featureA, feature_indexA, hullA);
+    auto hull_sizeB = get_triangle_feature_hull(featureB, feature_indexB, hullB);
+
+    auto contact_originA = sep_axis * projectionA;
+    auto contact_originB = sep_axis * projectionB;
+    auto basis = make_tangent_basis(sep_axis);
+    auto plane_verticesA = std::array<vector2, 3>{};
+    auto plane_verticesB = std::array<vector2, 3>{};
+
+    for (size_t i = 0; i < 3; ++i) {
+        plane_verticesA[i] = to_vector2_xz(to_object_space(verticesA[i], contact_originB, basis));
+        plane_verticesB[i] = to_vector2_xz(to_object_space(verticesB[i], contact_originB, basis));
+    }
+
+    collision_result::collision_point point;
+    point.normal = sep_axis;
+    point.distance = distance;
+    point.featureA = {featureA};
+    point.featureA->index = get_triangle_mesh_feature_index(meshA, tri_idxA, featureA, feature_indexA);
+    point.featureB = {featureB};
+    point.featureB->index = get_triangle_mesh_feature_index(meshB, tri_idxB, featureB, feature_indexB);
+    point.normal_attachment = contact_normal_attachment::none;
+
+    auto num_added = size_t{0};
+
+    auto add_point = [&](const vector3 &pivotA, const vector3 &pivotB) {
+        point.pivotA = pivotA;
+        point.pivotB = pivotB;
+        result.maybe_add_point(point);
+        ++num_added;
+    };
+
+    // Vertices of the closest feature of A inside the face of B and vice versa.
+    if (featureB == triangle_feature::face) {
+        point.normal_attachment = contact_normal_attachment::normal_on_B;
+
+        for (size_t i = 0; i < hull_sizeA; ++i) {
+            auto &pointA = verticesA[hullA[i]];
+
+            if (point_in_triangle(verticesB, sep_axis, pointA)) {
+                add_point(pointA, project_plane(pointA, contact_originB, sep_axis));
+            }
+        }
+    } else if (featureA == triangle_feature::face) {
+        point.normal_attachment = contact_normal_attachment::normal_on_A;
+    }
+
+    if (featureA == triangle_feature::face) {
+        for (size_t i = 0; i < hull_sizeB; ++i) {
+            auto &pointB = verticesB[hullB[i]];
+
+            if (point_in_triangle(verticesA, sep_axis, pointB)) {
+                add_point(project_plane(pointB, contact_originA, sep_axis), pointB);
+            }
+        }
+    }
+
+    // Calculate 2D intersection of edges on the closest features.
+    if (hull_sizeA > 1 && hull_sizeB > 1) {
+        // Avoid calculating the same segment-segment intersection twice if
+        // the feature is a single edge.
+        const auto limitA = hull_sizeA == 2 ? 1 : hull_sizeA;
+        const auto limitB = hull_sizeB == 2 ? 1 : hull_sizeB;
+        scalar s[2], t[2];
+
+        for (size_t i = 0; i < limitA; ++i) {
+            auto idx0A = hullA[i];
+            auto idx1A = hullA[(i + 1) % hull_sizeA];
+
+            for (size_t j = 0; j < limitB; ++j) {
+                auto idx0B = hullB[j];
+                auto idx1B = hullB[(j + 1) % hull_sizeB];
+                auto num_points = intersect_segments(plane_verticesA[idx0A], plane_verticesA[idx1A],
+                                                     plane_verticesB[idx0B], plane_verticesB[idx1B],
+                                                     s[0], t[0], s[1], t[1]);
+
+                for (size_t k = 0; k < num_points; ++k) {
+                    add_point(lerp(verticesA[idx0A], verticesA[idx1A], s[k]),
+                              lerp(verticesB[idx0B], verticesB[idx1B], t[k]));
+                }
+            }
+        }
+    }
+
+    // Features touching at a vertex generate no points above, thus use the
+    // support point of A along the separating axis.
+    if (num_added == 0 && (hull_sizeA == 1 || hull_sizeB == 1)) {
+        if (hull_sizeA == 1) {
+            auto &pointA = verticesA[hullA[0]];
+            add_point(pointA, pointA - sep_axis * distance);
+        } else {
+            auto &pointB = verticesB[hullB[0]];
+            add_point(pointB + sep_axis * distance, pointB);
+        }
+    }
+}
+
+void collide(const triangle_mesh &meshA, const triangle_mesh &meshB,
+             const collision_context &ctx, collision_result &result) {
+    // Gather all pairs of nearby triangles first, with both trees traversed
+    // at once, and then run the narrow-phase on each pair.
+    auto tri_pairs = std::vector<std::pair<uint32_t, uint32_t>>{};
+    meshA.visit_triangle_pairs(meshB, contact_breaking_threshold, [&](auto tri_idxA, auto tri_idxB) {
+        tri_pairs.emplace_back(tri_idxA, tri_idxB);
+    });
+
+    for (auto [tri_idxA, tri_idxB] : tri_pairs) {
+        collide_triangle_triangle(meshA, tri_idxA, meshB, tri_idxB, ctx, result);
+    }
+}
+
+void collide(const mesh_shape &shA, const paged_mesh_shape &shB,
+             const collision_context &ctx, collision_result &result) {
+    // Use the generic paged mesh function, which collides the triangle mesh
+    // with each nearby submesh and drops duplicate contacts on the seams.
+    collide<mesh_shape>(shA, shB, ctx, result);
+}
+
+void collide(const mesh_shape &shA, const heightfield_shape &shB,
+             const collision_context &ctx, collision_result &result) {
+    // Use the generic heightfield function, which collides the triangle mesh
+    // with the triangles of the cells under it.
+    collide<mesh_shape>(shA, shB, ctx, result);
+}
+
+}
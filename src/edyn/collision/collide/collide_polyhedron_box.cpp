@@ -11,6 +11,111 @@
 
 namespace edyn {
 
+// Calculates the projections of the polyhedron and the box onto the normal
+// of a face of the polyhedron. All in the polyhedron's space.
+static
+void polyhedron_face_separation(const polyhedron_shape &shA, const box_shape &shB,
+                                const vector3 &posB, const quaternion &ornB, uint32_t face_idx,
+                                vector3 &dir, scalar &projectionA, scalar &projectionB) {
+    const auto &meshA = *shA.mesh;
+    dir = -meshA.normals[face_idx]; // Point towards polyhedron.
+    auto vertexA = meshA.vertices[meshA.first_vertex_index(face_idx)];
+
+    // Find point on box that's furthest along the opposite direction
+    // of the face normal.
+    projectionA = dot(vertexA, dir);
+    projectionB = shB.support_projection(posB, ornB, dir);
+}
+
+// Calculates the projections of the polyhedron and the box onto the normal
+// of a face of the box.
+static
+void box_face_separation(const polyhedron_shape &shA, const box_shape &shB,
+                         const vector3 &posB, const std::array<vector3, 3> &box_axes, size_t i,
+                         vector3 &dir, scalar &projectionA, scalar &projectionB) {
+    const auto &meshA = *shA.mesh;
+    dir = box_axes[i];
+
+    if (dot(posB, dir) > 0) {
+        dir = -dir; // Point towards polyhedron.
+    }
+
+    // Find point on polyhedron that's furthest along the opposite direction
+    // of the box face normal.
+    projectionA = -polyhedron_support_projection(meshA.vertices, meshA.neighbors_start, meshA.neighbor_indices, -dir);
+    projectionB = dot(posB, dir) + shB.half_extents[i];
+}
+
+// Evaluates the cached separating axis with the current transforms. Returns
+// false if the cached feature is no longer valid.
+static
+bool cached_separation(const separating_axis_cache &cache,
+                       const polyhedron_shape &shA, const box_shape &shB,
+                       const vector3 &posB, const quaternion &ornB,
+                       const std::array<vector3, 3> &box_axes,
+                       vector3 &dir, scalar &projectionA, scalar &projectionB) {
+    const auto &meshA = *shA.mesh;
+
+    switch (cache.type) {
+    case separating_axis_cache::axis_type::faceA:
+        if (cache.indexA >= meshA.num_faces()) {
+            return false;
+        }
+
+        polyhedron_face_separation(shA, shB, posB, ornB, cache.indexA, dir, projectionA, projectionB);
+        return true;
+    case separating_axis_cache::axis_type::faceB:
+        if (cache.indexB >= 3) {
+            return false;
+        }
+
+        box_face_separation(shA, shB, posB, box_axes, cache.indexB, dir, projectionA, projectionB);
+        return true;
+    case separating_axis_cache::axis_type::edge: {
+        if (cache.indexA >= meshA.num_edges() || cache.indexB >= get_box_num_features(box_feature::edge)) {
+            return false;
+        }
+
+        auto vertex_idxA = meshA.get_edge_vertices(cache.indexA);
+        auto face_idxA = meshA.get_edge_faces(cache.indexA);
+        vector3 normalsA[] = {meshA.normals[face_idxA[0]], meshA.normals[face_idxA[1]]};
+        vector3 verticesA[] = {meshA.vertices[vertex_idxA[0]],
+                               meshA.vertices[vertex_idxA[1]]};
+        auto edge_dirA = verticesA[0] - verticesA[1];
+
+        auto normalsB = shB.get_edge_face_normals(cache.indexB, ornB);
+        auto verticesB = shB.get_edge(cache.indexB, posB, ornB);
+        auto edge_dirB = verticesB[0] - verticesB[1];
+
+        if (!edges_generate_minkowski_face(normalsA[0], normalsA[1],
+                                           normalsB[0], normalsB[1],
+                                           edge_dirA, edge_dirB)) {
+            return false;
+        }
+
+        dir = cross(edge_dirA, edge_dirB);
+
+        if (!try_normalize(dir)) {
+            return false;
+        }
+
+        // Make direction point outside of shape A.
+        if (dot(verticesA[0], dir) < 0) {
+            dir *= -1;
+        }
+
+        // Make it point towards A as per the global standard.
+        dir *= -1;
+
+        projectionA = dot(verticesA[0], dir);
+        projectionB = dot(verticesB[0], dir);
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
 void collide(const polyhedron_shape &shA, const box_shape &shB,
              const collision_context &ctx, collision_result &result) {
     // Convex polyhedron against box SAT. All calculations done in the
@@ -19,6 +124,8 @@ void collide(const polyhedron_shape &shA, const box_shape &shB,
     const auto ornB = conjugate(ctx.ornA) * ctx.ornB;
     const auto threshold = ctx.threshold;
     const auto &meshA = *shA.mesh;
+    // Support queries start at the support vertex of the previous query.
+    uint32_t support_vertex {0};
 
     const auto box_axes = std::array<vector3, 3>{
         quaternion_x(ornB),
@@ -29,99 +136,134 @@ void collide(const polyhedron_shape &shA, const box_shape &shB,
     auto distance = -EDYN_SCALAR_MAX;
     auto projection_poly = scalar(0);
     auto sep_axis = vector3_zero;
+    auto *cache = ctx.sat_cache;
+    auto cache_hit = false;
+
+    // Test the separating axis found in the previous step first. If it still
+    // separates the shapes beyond the threshold, there is no collision. If
+    // the shapes barely moved relative to each other, it is still the best
+    // axis and the full search is skipped.
+    if (cache && cache->type != separating_axis_cache::axis_type::none) {
+        vector3 dir;
+        scalar projA, projB;
+
+        if (cached_separation(*cache, shA, shB, posB, ornB, box_axes, dir, projA, projB)) {
+            if (projA - projB > threshold) {
+                return;
+            }
 
-    // Face normals of polyhedron.
-    for (auto face_idx : meshA.relevant_faces) {
-        auto normalA = -meshA.normals[face_idx]; // Point towards polyhedron.
-        auto vertexA = meshA.vertices[meshA.first_vertex_index(face_idx)];
-
-        // Find point on box that's furthest along the opposite direction
-        // of the face normal.
-        auto projA = dot(vertexA, normalA);
-        auto projB = shB.support_projection(posB, ornB, normalA);
-        auto dist = projA - projB;
-
-        if (dist > distance) {
-            distance = dist;
-            projection_poly = projA;
-            sep_axis = normalA;
+            if (cache->transform_matches(posB, ornB)) {
+                distance = projA - projB;
+                projection_poly = projA;
+                sep_axis = dir;
+                cache_hit = true;
+            }
         }
     }
 
-    // Face normals of box.
-    for (size_t i = 0; i < 3; ++i) {
-        auto dir = box_axes[i];
-
-        if (dot(posB, dir) > 0) {
-            dir = -dir; // Point towards polyhedron.
+    if (!cache_hit) {
+        auto best_type = separating_axis_cache::axis_type::none;
+        uint32_t best_indexA = 0, best_indexB = 0;
+
+        // Face normals of polyhedron.
+        for (auto face_idx : meshA.relevant_faces) {
+            vector3 normalA;
+            scalar projA, projB;
+            polyhedron_face_separation(shA, shB, posB, ornB, face_idx, normalA, projA, projB);
+            auto dist = projA - projB;
+
+            if (dist > distance) {
+                distance = dist;
+                projection_poly = projA;
+                sep_axis = normalA;
+                best_type = separating_axis_cache::axis_type::faceA;
+                best_indexA = face_idx;
+            }
         }
 
-        // Find point on polyhedron that's furthest along the opposite direction
-        // of the box face normal.
-        auto projA = -polyhedron_support_projection(meshA.vertices, meshA.neighbors_start, meshA.neighbor_indices, -dir);
-        auto projB = dot(posB, dir) + shB.half_extents[i];
-        auto dist = projA - projB;
-
-        if (dist > distance) {
-            distance = dist;
-            projection_poly = projA;
-            sep_axis = dir;
+        // Face normals of box.
+        for (size_t i = 0; i < 3; ++i) {
+            vector3 dir;
+            scalar projA, projB;
+            box_face_separation(shA, shB, posB, box_axes, i, dir, projA, projB);
+            auto dist = projA - projB;
+
+            if (dist > distance) {
+                distance = dist;
+                projection_poly = projA;
+                sep_axis = dir;
+                best_type = separating_axis_cache::axis_type::faceB;
+                best_indexB = static_cast<uint32_t>(i);
+            }
         }
-    }
 
-    // Edge vs edge.
-    scalar min_edge_dist = -EDYN_SCALAR_MAX;
-    scalar edge_projectionA, edge_projectionB;
-    auto edge_dir = vector3_zero;
-
-    for (auto edge_idxA = 0u; edge_idxA < meshA.num_edges(); ++edge_idxA) {
-        auto vertex_idxA = meshA.get_edge_vertices(edge_idxA);
-        auto face_idxA = meshA.get_edge_faces(edge_idxA);
-
-        vector3 normalsA[] = {meshA.normals[face_idxA[0]], meshA.normals[face_idxA[1]]};
-        vector3 verticesA[] = {meshA.vertices[vertex_idxA[0]],
-                               meshA.vertices[vertex_idxA[1]]};
-        auto edge_dirA = verticesA[0] - verticesA[1];
-
-        for (auto edge_idxB = 0u; edge_idxB < get_box_num_features(box_feature::edge); ++edge_idxB) {
-            auto normalsB = shB.get_edge_face_normals(edge_idxB, ornB);
-            auto verticesB = shB.get_edge(edge_idxB, posB, ornB);
-            auto edge_dirB = verticesB[0] - verticesB[1];
-
-            if (edges_generate_minkowski_face(normalsA[0], normalsA[1],
-                                              normalsB[0], normalsB[1],
-                                              edge_dirA, edge_dirB))
-            {
-                auto dir = cross(edge_dirA, edge_dirB);
-
-                if (try_normalize(dir)) {
-                    // Make direction point outside of shape A.
-                    if (dot(verticesA[0], dir) < 0) {
-                        dir *= -1;
-                    }
-
-                    auto edge_dist = dot(verticesB[0] - verticesA[0], dir);
-
-                    if (edge_dist > min_edge_dist) {
-                        min_edge_dist = edge_dist;
-                        // Make it point towards A as per the global standard.
-                        dir *= -1;
-                        edge_projectionA = dot(verticesA[0], dir);
-                        edge_projectionB = dot(verticesB[0], dir);
-                        edge_dir = dir;
+        // Edge vs edge.
+        scalar min_edge_dist = -EDYN_SCALAR_MAX;
+        scalar edge_projectionA = 0, edge_projectionB = 0;
+        auto edge_dir = vector3_zero;
+        uint32_t edge_indexA, edge_indexB;
+
+        for (auto edge_idxA = 0u; edge_idxA < meshA.num_edges(); ++edge_idxA) {
+            auto vertex_idxA = meshA.get_edge_vertices(edge_idxA);
+            auto face_idxA = meshA.get_edge_faces(edge_idxA);
+
+            vector3 normalsA[] = {meshA.normals[face_idxA[0]], meshA.normals[face_idxA[1]]};
+            vector3 verticesA[] = {meshA.vertices[vertex_idxA[0]],
+                                   meshA.vertices[vertex_idxA[1]]};
+            auto edge_dirA = verticesA[0] - verticesA[1];
+
+            for (auto edge_idxB = 0u; edge_idxB < get_box_num_features(box_feature::edge); ++edge_idxB) {
+                auto normalsB = shB.get_edge_face_normals(edge_idxB, ornB);
+                auto verticesB = shB.get_edge(edge_idxB, posB, ornB);
+                auto edge_dirB = verticesB[0] - verticesB[1];
+
+                if (edges_generate_minkowski_face(normalsA[0], normalsA[1],
+                                                  normalsB[0], normalsB[1],
+                                                  edge_dirA, edge_dirB))
+                {
+                    auto dir = cross(edge_dirA, edge_dirB);
+
+                    if (try_normalize(dir)) {
+                        // Make direction point outside of shape A.
+                        if (dot(verticesA[0], dir) < 0) {
+                            dir *= -1;
+                        }
+
+                        auto edge_dist = dot(verticesB[0] - verticesA[0], dir);
+
+                        if (edge_dist > min_edge_dist) {
+                            min_edge_dist = edge_dist;
+                            // Make it point towards A as per the global standard.
+                            dir *= -1;
+                            edge_projectionA = dot(verticesA[0], dir);
+                            edge_projectionB = dot(verticesB[0], dir);
+                            edge_dir = dir;
+                            edge_indexA = edge_idxA;
+                            edge_indexB = edge_idxB;
+                        }
                     }
                 }
             }
         }
-    }
 
-    if (edge_dir != vector3_zero) {
-        auto edge_distance = edge_projectionA - edge_projectionB;
+        if (edge_dir != vector3_zero) {
+            auto edge_distance = edge_projectionA - edge_projectionB;
+
+            if (edge_distance > distance) {
+                distance = edge_distance;
+                projection_poly = edge_projectionA;
+                sep_axis = edge_dir;
+                best_type = separating_axis_cache::axis_type::edge;
+                best_indexA = edge_indexA;
+                best_indexB = edge_indexB;
+            }
+        }
 
-        if (edge_distance > distance) {
-            distance = edge_distance;
-            projection_poly = edge_projectionA;
-            sep_axis = edge_dir;
+        if (cache) {
+            cache->type = best_type;
+            cache->indexA = best_indexA;
+            cache->indexB = best_indexB;
+            cache->set_transform(posB, ornB);
         }
     }
 
@@ -129,9 +271,9 @@ void collide(const polyhedron_shape &shA, const box_shape &shB,
         return;
     }
 
-    auto polygon = point_cloud_support_polygon(
-        meshA.vertices.begin(), meshA.vertices.end(), vector3_zero,
-        sep_axis, projection_poly, true, support_feature_tolerance);
+    auto polygon = polyhedron_support_polygon(
+        meshA.vertices, meshA.neighbors_start, meshA.neighbor_indices, vector3_zero,
+        sep_axis, projection_poly, true, support_feature_tolerance, support_vertex);
 
     box_feature featureB;
     size_t feature_indexB;
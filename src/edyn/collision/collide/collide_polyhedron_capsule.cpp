@@ -15,6 +15,8 @@ void collide(const polyhedron_shape &shA, const capsule_shape &shB,
     const auto ornB = conjugate(ctx.ornA) * ctx.ornB;
     auto threshold = ctx.threshold;
     auto &meshA = *shA.mesh;
+    // Support queries start at the support vertex of the previous query.
+    uint32_t support_vertex {0};
 
     auto capsule_vertices = shB.get_vertices(posB, ornB);
 
@@ -57,7 +59,7 @@ void collide(const polyhedron_shape &shA, const capsule_shape &shB,
             dir *= -1;
         }
 
-        auto projA = -polyhedron_support_projection(meshA.vertices, meshA.neighbors_start, meshA.neighbor_indices, -dir);
+        auto projA = -polyhedron_support_projection(meshA.vertices, meshA.neighbors_start, meshA.neighbor_indices, -dir, support_vertex);
         auto projB = capsule_support_projection(capsule_vertices, shB.radius, dir);
         auto dist = projA - projB;
 
@@ -80,9 +82,9 @@ void collide(const polyhedron_shape &shA, const capsule_shape &shB,
     auto is_capsule_edge = std::abs(proj_capsule_vertices[0] -
                                     proj_capsule_vertices[1]) < support_feature_tolerance;
 
-    auto polygon = point_cloud_support_polygon(
-        meshA.vertices.begin(), meshA.vertices.end(), vector3_zero,
-        sep_axis, projection_poly, true, support_feature_tolerance);
+    auto polygon = polyhedron_support_polygon(
+        meshA.vertices, meshA.neighbors_start, meshA.neighbor_indices, vector3_zero,
+        sep_axis, projection_poly, true, support_feature_tolerance, support_vertex);
 
     collision_result::collision_point point;
     // Separating axis is in A's space. Transform it to world space.
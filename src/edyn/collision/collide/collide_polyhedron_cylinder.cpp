@@ -18,6 +18,8 @@ void collide(const polyhedron_shape &shA, const cylinder_shape &shB,
     const auto ornB = conjugate(ctx.ornA) * ctx.ornB;
     const auto threshold = ctx.threshold;
     const auto &meshA = *shA.mesh;
+    // Support queries start at the support vertex of the previous query.
+    uint32_t support_vertex {0};
 
     const auto cyl_axis = coordinate_axis_vector(shB.axis, ornB);
     const auto face_center_pos = posB + cyl_axis * shB.half_length;
@@ -48,7 +50,7 @@ void collide(const polyhedron_shape &shA, const cylinder_shape &shB,
     // Cylinder cap face normals.
     for (size_t i = 0; i < 2; ++i) {
         auto dir = std::array<vector3, 2>{cyl_axis, -cyl_axis}[i];
-        auto projA = -polyhedron_support_projection(meshA.vertices, meshA.neighbors_start, meshA.neighbor_indices, -dir);
+        auto projA = -polyhedron_support_projection(meshA.vertices, meshA.neighbors_start, meshA.neighbor_indices, -dir, support_vertex);
         auto projB = dot(posB, dir) + shB.half_length;
         auto dist = projA - projB;
 
@@ -73,7 +75,7 @@ void collide(const polyhedron_shape &shA, const cylinder_shape &shB,
             dir *= -1;
         }
 
-        auto projA = -polyhedron_support_projection(meshA.vertices, meshA.neighbors_start, meshA.neighbor_indices, -dir);
+        auto projA = -polyhedron_support_projection(meshA.vertices, meshA.neighbors_start, meshA.neighbor_indices, -dir, support_vertex);
         auto projB = shB.support_projection(posB, ornB, dir);
         auto dist = projA - projB;
 
@@ -99,7 +101,7 @@ void collide(const polyhedron_shape &shA, const cylinder_shape &shB,
             dir *= -1;
         }
 
-        auto projA = -polyhedron_support_projection(meshA.vertices, meshA.neighbors_start, meshA.neighbor_indices, -dir);
+        auto projA = -polyhedron_support_projection(meshA.vertices, meshA.neighbors_start, meshA.neighbor_indices, -dir, support_vertex);
         auto projB = shB.support_projection(posB, ornB, dir);
         auto dist = projA - projB;
 
@@ -138,7 +140,7 @@ void collide(const polyhedron_shape &shA, const cylinder_shape &shB,
                 dir *= -1;
             }
 
-            auto projA = -polyhedron_support_projection(meshA.vertices, meshA.neighbors_start, meshA.neighbor_indices, -dir);
+            auto projA = -polyhedron_support_projection(meshA.vertices, meshA.neighbors_start, meshA.neighbor_indices, -dir, support_vertex);
             auto projB = shB.support_projection(posB, ornB, dir);
             auto dist = projA - projB;
 
@@ -157,9 +159,9 @@ void collide(const polyhedron_shape &shA, const cylinder_shape &shB,
     // Separating axis is in A's space.
     auto normal = rotate(ctx.ornA, sep_axis);
 
-    auto polygon = point_cloud_support_polygon(
-        meshA.vertices.begin(), meshA.vertices.end(), vector3_zero,
-        sep_axis, projection_poly, true, support_feature_tolerance);
+    auto polygon = polyhedron_support_polygon(
+        meshA.vertices, meshA.neighbors_start, meshA.neighbor_indices, vector3_zero,
+        sep_axis, projection_poly, true, support_feature_tolerance, support_vertex);
 
     cylinder_feature featureB;
     size_t feature_indexB;
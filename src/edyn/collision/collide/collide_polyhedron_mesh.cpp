@@ -12,7 +12,7 @@ namespace edyn {
 
 static void collide_polyhedron_triangle(
     const polyhedron_shape &poly, const triangle_mesh &tri_mesh, size_t tri_idx,
-    const collision_context &ctx, collision_result &result) {
+    const collision_context &ctx, collision_result &result, uint32_t &support_vertex) {
 
     // The triangle vertices are shifted by the polyhedron's position so all
     // calculations are effectively done with the polyhedron in the origin.
@@ -57,7 +57,7 @@ static void collide_polyhedron_triangle(
     {
         // Find point on polyhedron that's furthest along the opposite direction
         // of the triangle normal.
-        auto proj_poly = -polyhedron_support_projection(rmesh.vertices, poly_mesh.neighbors_start, poly_mesh.neighbor_indices, -tri_normal);
+        auto proj_poly = -polyhedron_support_projection(rmesh.vertices, poly_mesh.neighbors_start, poly_mesh.neighbor_indices, -tri_normal, support_vertex);
         auto proj_tri = dot(tri_vertices[0], tri_normal);
         auto dist = proj_poly - proj_tri;
 
@@ -138,7 +138,7 @@ static void collide_polyhedron_triangle(
                                  tri_feature, tri_feature_index,
                                  proj_tri, support_feature_tolerance);
 
-    projection_poly = -polyhedron_support_projection(rmesh.vertices, poly_mesh.neighbors_start, poly_mesh.neighbor_indices, -sep_axis);
+    projection_poly = -polyhedron_support_projection(rmesh.vertices, poly_mesh.neighbors_start, poly_mesh.neighbor_indices, -sep_axis, support_vertex);
 
     distance = projection_poly - proj_tri;
 
@@ -150,9 +150,9 @@ static void collide_polyhedron_triangle(
         return;
     }
 
-    auto polygon = point_cloud_support_polygon(
-        rmesh.vertices.begin(), rmesh.vertices.end(), vector3_zero,
-        sep_axis, projection_poly, true, support_feature_tolerance);
+    auto polygon = polyhedron_support_polygon(
+        rmesh.vertices, poly_mesh.neighbors_start, poly_mesh.neighbor_indices, vector3_zero,
+        sep_axis, projection_poly, true, support_feature_tolerance, support_vertex);
 
     auto contact_origin_tri = sep_axis * projection_tri;
     auto hull_tri = std::array<size_t, 3>{};
@@ -265,8 +265,12 @@ void collide(const polyhedron_shape &poly, const triangle_mesh &mesh,
     const auto inset = vector3_one * -contact_breaking_threshold;
     const auto visit_aabb = ctx.aabbA.inset(inset);
 
+    // Neighboring triangles have similar support vertices on the polyhedron,
+    // thus each support query starts where the previous one ended.
+    uint32_t support_vertex {0};
+
     mesh.visit_triangles(visit_aabb, [&](auto tri_idx) {
-        collide_polyhedron_triangle(poly, mesh, tri_idx, ctx, result);
+        collide_polyhedron_triangle(poly, mesh, tri_idx, ctx, result, support_vertex);
     });
 }
 
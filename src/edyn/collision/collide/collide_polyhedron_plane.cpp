@@ -15,15 +15,16 @@ void collide(const polyhedron_shape &shA, const plane_shape &shB,
     auto normal = shB.normal;
     auto center = shB.normal * shB.constant - posA;
 
-    auto proj_poly = -polyhedron_support_projection(rmeshA.vertices, shA.mesh->neighbors_start, shA.mesh->neighbor_indices, -normal);
+    uint32_t support_vertex {0};
+    auto proj_poly = -polyhedron_support_projection(rmeshA.vertices, shA.mesh->neighbors_start, shA.mesh->neighbor_indices, -normal, support_vertex);
     auto proj_plane = dot(center, normal);
     scalar distance = proj_poly - proj_plane;
 
     if (distance > ctx.threshold) return;
 
-    auto polygon = point_cloud_support_polygon(
-        rmeshA.vertices.begin(), rmeshA.vertices.end(), vector3_zero,
-        normal, proj_poly, true, support_feature_tolerance);
+    auto polygon = polyhedron_support_polygon(
+        rmeshA.vertices, shA.mesh->neighbors_start, shA.mesh->neighbor_indices, vector3_zero,
+        normal, proj_poly, true, support_feature_tolerance, support_vertex);
     auto normal_attachment = contact_normal_attachment::normal_on_B;
 
     for (auto idxA : polygon.hull) {
@@ -4,34 +4,51 @@
 #include "edyn/math/vector2_3_util.hpp"
 #include "edyn/math/transform.hpp"
 #include "edyn/math/constants.hpp"
+#include "edyn/collision/gjk.hpp"
 #include "edyn/util/shape_util.hpp"
 
 namespace edyn {
 
+// Calculates the projections of A and B onto the normal of a face of A.
+static
+void face_support_distance(const polyhedron_shape &shA, const rotated_mesh &rotatedA, const vector3 &posA,
+                           const polyhedron_shape &shB, const rotated_mesh &rotatedB, const vector3 &posB,
+                           uint32_t face_idx, vector3 &dir, scalar &projectionA, scalar &projectionB,
+                           uint32_t &support_vertexB) {
+    const auto &meshA = *shA.mesh;
+    const auto &meshB = *shB.mesh;
+
+    dir = -rotatedA.normals[face_idx]; // Normal pointing towards A.
+    auto vertexA = rotatedA.vertices[meshA.first_vertex_index(face_idx)];
+    auto vertex_world = vertexA + posA;
+    projectionA = dot(vertex_world, dir);
+
+    // Find point on B that's furthest along the opposite direction
+    // of the face normal.
+    projectionB = polyhedron_support_projection(rotatedB.vertices, meshB.neighbors_start, meshB.neighbor_indices, dir, support_vertexB) + dot(posB, dir);
+}
+
 // Finds the direction that maximizes the projected distance between
-// A and B among all face normals of A.
+// A and B among all face normals of A. Each support query on B starts at
+// the support vertex found in the previous one.
 static
 void max_support_direction(const polyhedron_shape &shA, const rotated_mesh &rotatedA, const vector3 &posA,
                            const polyhedron_shape &shB, const rotated_mesh &rotatedB, const vector3 &posB,
-                           vector3 &dir, scalar &distance, scalar &projectionA, scalar &projectionB) {
+                           vector3 &dir, scalar &distance, scalar &projectionA, scalar &projectionB,
+                           uint32_t &face_index, uint32_t &support_vertexB) {
     scalar max_proj_A = EDYN_SCALAR_MAX;
     scalar max_proj_B = -EDYN_SCALAR_MAX;
     scalar max_distance = -EDYN_SCALAR_MAX;
     auto best_dir = vector3_zero;
+    uint32_t best_face = 0;
 
     const auto &meshA = *shA.mesh;
-    const auto &meshB = *shB.mesh;
 
     for (auto face_idx : meshA.relevant_faces) {
-        auto normal_world = -rotatedA.normals[face_idx]; // Normal pointing towards A.
-        auto vertexA = rotatedA.vertices[meshA.first_vertex_index(face_idx)];
-        auto vertex_world = vertexA + posA;
-        auto projA = dot(vertex_world, normal_world);
-
-        // Find point on B that's furthest along the opposite direction
-        // of the face normal.
-        auto projB = polyhedron_support_projection(rotatedB.vertices, meshB.neighbors_start, meshB.neighbor_indices, normal_world) + dot(posB, normal_world);
-
+        vector3 normal_world;
+        scalar projA, projB;
+        face_support_distance(shA, rotatedA, posA, shB, rotatedB, posB, face_idx,
+                              normal_world, projA, projB, support_vertexB);
         auto dist = projA - projB;
 
         if (dist > max_distance) {
@@ -39,6 +56,7 @@ void max_support_direction(const polyhedron_shape &shA, const rotated_mesh &rota
             max_proj_A = projA;
             max_proj_B = projB;
             best_dir = normal_world;
+            best_face = face_idx;
         }
     }
 
@@ -46,6 +64,152 @@ void max_support_direction(const polyhedron_shape &shA, const rotated_mesh &rota
     distance = max_distance;
     projectionA = max_proj_A;
     projectionB = max_proj_B;
+    face_index = best_face;
+}
+
+// Calculates the separating axis given by a pair of edges, if the edges
+// generate a face in the Minkowski difference.
+static
+bool edge_edge_separation(const polyhedron_shape &shA, const rotated_mesh &rmeshA, const vector3 &posA,
+                          const polyhedron_shape &shB, const rotated_mesh &rmeshB, const vector3 &posB,
+                          uint32_t edge_idxA, uint32_t edge_idxB,
+                          vector3 &dir, scalar &projectionA, scalar &projectionB) {
+    const auto &meshA = *shA.mesh;
+    const auto &meshB = *shB.mesh;
+
+    auto vertex_idxA = meshA.get_edge_vertices(edge_idxA);
+    auto face_idxA = meshA.get_edge_faces(edge_idxA);
+    vector3 normalsA[] = {rmeshA.normals[face_idxA[0]], rmeshA.normals[face_idxA[1]]};
+    vector3 verticesA[] = {rmeshA.vertices[vertex_idxA[0]] + posA,
+                           rmeshA.vertices[vertex_idxA[1]] + posA};
+    auto edge_dirA = verticesA[0] - verticesA[1];
+
+    auto vertex_idxB = meshB.get_edge_vertices(edge_idxB);
+    auto face_idxB = meshB.get_edge_faces(edge_idxB);
+    vector3 normalsB[] = {rmeshB.normals[face_idxB[0]], rmeshB.normals[face_idxB[1]]};
+    vector3 verticesB[] = {rmeshB.vertices[vertex_idxB[0]] + posB,
+                           rmeshB.vertices[vertex_idxB[1]] + posB};
+    auto edge_dirB = verticesB[0] - verticesB[1];
+
+    // Negate normals due to the Minkowski _difference_.
+    // Negate `edge_dir` because the argument is BxA and DxC, whereas
+    // `edge_dir` points in the same direction as `cross(normals[0], normals[1])`.
+    if (!edges_generate_minkowski_face(normalsA[0], normalsA[1],
+                                       normalsB[0], normalsB[1],
+                                       edge_dirA, edge_dirB)) {
+        return false;
+    }
+
+    dir = cross(edge_dirA, edge_dirB);
+
+    if (!try_normalize(dir)) {
+        return false;
+    }
+
+    // Make direction point outside of shape A.
+    if (dot(verticesA[0] - posA, dir) < 0) {
+        dir *= -1;
+    }
+
+    // Make it point towards A as per the global standard.
+    dir *= -1;
+    projectionA = dot(verticesA[0], dir);
+    projectionB = dot(verticesB[0], dir);
+    return true;
+}
+
+// Evaluates the cached separating axis with the current transforms. Returns
+// false if the cached feature is no longer valid.
+static
+bool cached_separation(const separating_axis_cache &cache,
+                       const polyhedron_shape &shA, const rotated_mesh &rmeshA, const vector3 &posA,
+                       const polyhedron_shape &shB, const rotated_mesh &rmeshB, const vector3 &posB,
+                       vector3 &dir, scalar &projectionA, scalar &projectionB,
+                       uint32_t &support_vertexA, uint32_t &support_vertexB) {
+    switch (cache.type) {
+    case separating_axis_cache::axis_type::faceA:
+        if (cache.indexA >= shA.mesh->num_faces()) {
+            return false;
+        }
+
+        face_support_distance(shA, rmeshA, posA, shB, rmeshB, posB, cache.indexA,
+                              dir, projectionA, projectionB, support_vertexB);
+        return true;
+    case separating_axis_cache::axis_type::faceB:
+        if (cache.indexB >= shB.mesh->num_faces()) {
+            return false;
+        }
+
+        face_support_distance(shB, rmeshB, posB, shA, rmeshA, posA, cache.indexB,
+                              dir, projectionB, projectionA, support_vertexA);
+        // Signs must be flipped because parameters were swapped above.
+        dir *= -1;
+        projectionA *= -1;
+        projectionB *= -1;
+        return true;
+    case separating_axis_cache::axis_type::edge:
+        if (cache.indexA >= shA.mesh->num_edges() || cache.indexB >= shB.mesh->num_edges()) {
+            return false;
+        }
+
+        return edge_edge_separation(shA, rmeshA, posA, shB, rmeshB, posB,
+                                    cache.indexA, cache.indexB,
+                                    dir, projectionA, projectionB);
+    default:
+        return false;
+    }
+}
+
+enum class gjk_axis_result {
+    separated,
+    found,
+    failed
+};
+
+// Finds the separating axis with GJK and, if the shapes intersect, EPA. It is
+// calculated in the object space of A, with `posB` and `ornB` relative to A.
+// The simplex of the last run is used as the starting point.
+static
+gjk_axis_result gjk_separating_axis(const polyhedron_shape &shA, const polyhedron_shape &shB,
+                                    const vector3 &posB, const quaternion &ornB,
+                                    scalar threshold, gjk_simplex &simplex,
+                                    uint32_t &support_vertexA, uint32_t &support_vertexB,
+                                    vector3 &axis) {
+    const auto &meshA = *shA.mesh;
+    const auto &meshB = *shB.mesh;
+
+    auto support_funcA = [&](const vector3 &dir) {
+        polyhedron_support_projection(meshA.vertices, meshA.neighbors_start,
+                                      meshA.neighbor_indices, dir, support_vertexA);
+        return meshA.vertices[support_vertexA];
+    };
+
+    auto support_funcB = [&](const vector3 &dir) {
+        polyhedron_support_projection(meshB.vertices, meshB.neighbors_start,
+                                      meshB.neighbor_indices, dir, support_vertexB);
+        return meshB.vertices[support_vertexB];
+    };
+
+    auto result = gjk(support_funcA, support_funcB, posB, ornB, simplex, threshold);
+
+    if (!result.intersecting) {
+        if (result.distance > threshold) {
+            return gjk_axis_result::separated;
+        }
+
+        // Point towards A as per the global standard.
+        axis = result.pointA - result.pointB;
+        return try_normalize(axis) ? gjk_axis_result::found : gjk_axis_result::failed;
+    }
+
+    auto penetration = epa_result{};
+
+    if (!epa(support_funcA, support_funcB, posB, ornB, simplex, penetration)) {
+        return gjk_axis_result::failed;
+    }
+
+    axis = -penetration.normal;
+    return gjk_axis_result::found;
 }
 
 void collide(const polyhedron_shape &shA, const polyhedron_shape &shB,
@@ -70,102 +234,198 @@ void collide(const polyhedron_shape &shA, const polyhedron_shape &shB,
     scalar projectionB = -EDYN_SCALAR_MAX;
     auto sep_axis = vector3_zero;
 
-    // Find best support direction among all face normals of A.
-    max_support_direction(shA, rmeshA, posA, shB, rmeshB, posB,
-                          sep_axis, distance, projectionA, projectionB);
-
-    // Find best support direction among all face normals of B.
-    {
-        scalar dist, projA, projB;
+    // Relative transform used to decide whether the cached axis can be reused.
+    const auto rel_posB = rotate(conjugate(ornA), posB);
+    const auto rel_ornB = conjugate(ornA) * ornB;
+    auto *cache = ctx.sat_cache;
+    auto cache_hit = false;
+
+    // Start the support queries at the support vertices of the last step.
+    uint32_t supportA = cache ? cache->support_vertexA : 0;
+    uint32_t supportB = cache ? cache->support_vertexB : 0;
+
+    // Test the separating axis found in the previous step first. If it still
+    // separates the shapes beyond the threshold, there is no collision. If
+    // the shapes barely moved relative to each other, it is still the best
+    // axis and the full search is skipped.
+    if (cache && cache->type != separating_axis_cache::axis_type::none) {
         vector3 dir;
-        max_support_direction(shB, rmeshB, posB, shA, rmeshA, posA,
-                              dir, dist, projB, projA);
-
-        if (dist > distance) {
-            // Signs must be flipped because parameters were swapped above.
-            dir *= -1;
-            projA *= -1;
-            projB *= -1;
-
-            distance = dist;
-            projectionA = projA;
-            projectionB = projB;
-            sep_axis = dir;
+        scalar projA, projB;
+
+        if (cached_separation(*cache, shA, rmeshA, posA, shB, rmeshB, posB,
+                              dir, projA, projB, supportA, supportB)) {
+            if (projA - projB > threshold) {
+                return;
+            }
+
+            if (cache->transform_matches(rel_posB, rel_ornB)) {
+                distance = projA - projB;
+                projectionA = projA;
+                projectionB = projB;
+                sep_axis = dir;
+                cache_hit = true;
+            }
         }
     }
 
-    // Edge vs edge.
-    scalar min_edge_dist = -EDYN_SCALAR_MAX;
-    scalar edge_projectionA, edge_projectionB;
-    vector3 edge_dir;
-
-    for (auto edge_idxA = 0u; edge_idxA < meshA.num_edges(); ++edge_idxA) {
-        auto vertex_idxA = meshA.get_edge_vertices(edge_idxA);
-        auto face_idxA = meshA.get_edge_faces(edge_idxA);
-
-        vector3 normalsA[] = {rmeshA.normals[face_idxA[0]], rmeshA.normals[face_idxA[1]]};
-        vector3 verticesA[] = {rmeshA.vertices[vertex_idxA[0]] + posA,
-                               rmeshA.vertices[vertex_idxA[1]] + posA};
-        auto edge_dirA = verticesA[0] - verticesA[1];
-
-        for (auto edge_idxB = 0u; edge_idxB < meshB.num_edges(); ++edge_idxB) {
-            auto vertex_idxB = meshB.get_edge_vertices(edge_idxB);
-            auto face_idxB = meshB.get_edge_faces(edge_idxB);
-
-            vector3 normalsB[] = {rmeshB.normals[face_idxB[0]], rmeshB.normals[face_idxB[1]]};
-            vector3 verticesB[] = {rmeshB.vertices[vertex_idxB[0]] + posB,
-                                   rmeshB.vertices[vertex_idxB[1]] + posB};
-            auto edge_dirB = verticesB[0] - verticesB[1];
-
-            // Negate normals due to the Minkowski _difference_.
-            // Negate `edge_dir` because the argument is BxA and DxC, whereas
-            // `edge_dir` points in the same direction as `cross(normals[0], normals[1])`.
-            if (edges_generate_minkowski_face(normalsA[0], normalsA[1],
-                                              normalsB[0], normalsB[1],
-                                              edge_dirA, edge_dirB))
-            {
-                auto dir = cross(edge_dirA, edge_dirB);
-
-                if (try_normalize(dir)) {
-                    // Make direction point outside of shape A.
-                    if (dot(verticesA[0] - posA, dir) < 0) {
-                        dir *= -1;
-                    }
+    // SAT tests all pairs of edges, which is too expensive for polyhedrons
+    // with many edges. GJK finds the separating axis instead, and SAT is only
+    // used if EPA fails.
+    auto gjk_hit = false;
+
+    if (!cache_hit && meshA.num_edges() * meshB.num_edges() > polyhedron_sat_max_edge_pairs) {
+        auto local_simplex = gjk_simplex{};
+        auto &simplex = cache ? cache->simplex : local_simplex;
+        vector3 axis;
+
+        switch (gjk_separating_axis(shA, shB, rel_posB, rel_ornB, threshold,
+                                    simplex, supportA, supportB, axis)) {
+        case gjk_axis_result::separated:
+            if (cache) {
+                cache->support_vertexA = supportA;
+                cache->support_vertexB = supportB;
+            }
+            return;
+        case gjk_axis_result::found:
+            sep_axis = rotate(ornA, axis);
+            projectionA = -polyhedron_support_projection(rmeshA.vertices, meshA.neighbors_start,
+                                                         meshA.neighbor_indices, -sep_axis, supportA);
+            projectionB = polyhedron_support_projection(rmeshB.vertices, meshB.neighbors_start,
+                                                        meshB.neighbor_indices, sep_axis, supportB) +
+                          dot(posB, sep_axis);
+            distance = projectionA - projectionB;
+            gjk_hit = true;
+            break;
+        case gjk_axis_result::failed:
+            break;
+        }
+    }
 
-                    auto edge_dist = dot(verticesB[0] - verticesA[0], dir);
+    if (!cache_hit && !gjk_hit) {
+        auto best_type = separating_axis_cache::axis_type::faceA;
+        uint32_t best_indexA, best_indexB = 0;
+
+        // Find best support direction among all face normals of A.
+        max_support_direction(shA, rmeshA, posA, shB, rmeshB, posB,
+                              sep_axis, distance, projectionA, projectionB,
+                              best_indexA, supportB);
+
+        // Find best support direction among all face normals of B.
+        {
+            scalar dist, projA, projB;
+            vector3 dir;
+            uint32_t face_idx;
+            max_support_direction(shB, rmeshB, posB, shA, rmeshA, posA,
+                                  dir, dist, projB, projA, face_idx, supportA);
+
+            if (dist > distance) {
+                // Signs must be flipped because parameters were swapped above.
+                dir *= -1;
+                projA *= -1;
+                projB *= -1;
+
+                distance = dist;
+                projectionA = projA;
+                projectionB = projB;
+                sep_axis = dir;
+                best_type = separating_axis_cache::axis_type::faceB;
+                best_indexB = face_idx;
+            }
+        }
 
-                    if (edge_dist > min_edge_dist) {
-                        min_edge_dist = edge_dist;
-                        // Make it point towards A as per the global standard.
-                        dir *= -1;
-                        edge_projectionA = dot(verticesA[0], dir);
-                        edge_projectionB = dot(verticesB[0], dir);
-                        edge_dir = dir;
+        // Edge vs edge.
+        scalar min_edge_dist = -EDYN_SCALAR_MAX;
+        scalar edge_projectionA = 0, edge_projectionB = 0;
+        vector3 edge_dir;
+        uint32_t edge_indexA, edge_indexB;
+
+        for (auto edge_idxA = 0u; edge_idxA < meshA.num_edges(); ++edge_idxA) {
+            auto vertex_idxA = meshA.get_edge_vertices(edge_idxA);
+            auto face_idxA = meshA.get_edge_faces(edge_idxA);
+
+            vector3 normalsA[] = {rmeshA.normals[face_idxA[0]], rmeshA.normals[face_idxA[1]]};
+            vector3 verticesA[] = {rmeshA.vertices[vertex_idxA[0]] + posA,
+                                   rmeshA.vertices[vertex_idxA[1]] + posA};
+            auto edge_dirA = verticesA[0] - verticesA[1];
+
+            for (auto edge_idxB = 0u; edge_idxB < meshB.num_edges(); ++edge_idxB) {
+                auto vertex_idxB = meshB.get_edge_vertices(edge_idxB);
+                auto face_idxB = meshB.get_edge_faces(edge_idxB);
+
+                vector3 normalsB[] = {rmeshB.normals[face_idxB[0]], rmeshB.normals[face_idxB[1]]};
+                vector3 verticesB[] = {rmeshB.vertices[vertex_idxB[0]] + posB,
+                                       rmeshB.vertices[vertex_idxB[1]] + posB};
+                auto edge_dirB = verticesB[0] - verticesB[1];
+
+                // Negate normals due to the Minkowski _difference_.
+                // Negate `edge_dir` because the argument is BxA and DxC, whereas
+                // `edge_dir` points in the same direction as `cross(normals[0], normals[1])`.
+                if (edges_generate_minkowski_face(normalsA[0], normalsA[1],
+                                                  normalsB[0], normalsB[1],
+                                                  edge_dirA, edge_dirB))
+                {
+                    auto dir = cross(edge_dirA, edge_dirB);
+
+                    if (try_normalize(dir)) {
+                        // Make direction point outside of shape A.
+                        if (dot(verticesA[0] - posA, dir) < 0) {
+                            dir *= -1;
+                        }
+
+                        auto edge_dist = dot(verticesB[0] - verticesA[0], dir);
+
+                        if (edge_dist > min_edge_dist) {
+                            min_edge_dist = edge_dist;
+                            // Make it point towards A as per the global standard.
+                            dir *= -1;
+                            edge_projectionA = dot(verticesA[0], dir);
+                            edge_projectionB = dot(verticesB[0], dir);
+                            edge_dir = dir;
+                            edge_indexA = edge_idxA;
+                            edge_indexB = edge_idxB;
+                        }
                     }
                 }
             }
         }
-    }
 
-    auto edge_distance = edge_projectionA - edge_projectionB;
+        if (min_edge_dist > -EDYN_SCALAR_MAX) {
+            auto edge_distance = edge_projectionA - edge_projectionB;
+
+            if (edge_distance > distance) {
+                distance = edge_distance;
+                projectionA = edge_projectionA;
+                projectionB = edge_projectionB;
+                sep_axis = edge_dir;
+                best_type = separating_axis_cache::axis_type::edge;
+                best_indexA = edge_indexA;
+                best_indexB = edge_indexB;
+            }
+        }
 
-    if (edge_distance > distance) {
-        distance = edge_distance;
-        projectionA = edge_projectionA;
-        projectionB = edge_projectionB;
-        sep_axis = edge_dir;
+        if (cache) {
+            cache->type = best_type;
+            cache->indexA = best_indexA;
+            cache->indexB = best_indexB;
+            cache->set_transform(rel_posB, rel_ornB);
+        }
     }
 
     if (distance > threshold) {
         return;
     }
 
-    auto polygonA = point_cloud_support_polygon(
-        rmeshA.vertices.begin(), rmeshA.vertices.end(), posA,
-        sep_axis, projectionA, true, support_feature_tolerance);
-    auto polygonB = point_cloud_support_polygon(
-        rmeshB.vertices.begin(), rmeshB.vertices.end(), posB,
-        sep_axis, projectionB, false, support_feature_tolerance);
+    auto polygonA = polyhedron_support_polygon(
+        rmeshA.vertices, meshA.neighbors_start, meshA.neighbor_indices, posA,
+        sep_axis, projectionA, true, support_feature_tolerance, supportA);
+    auto polygonB = polyhedron_support_polygon(
+        rmeshB.vertices, meshB.neighbors_start, meshB.neighbor_indices, posB,
+        sep_axis, projectionB, false, support_feature_tolerance, supportB);
+
+    if (cache) {
+        cache->support_vertexA = supportA;
+        cache->support_vertexB = supportB;
+    }
 
     auto normal_attachment = contact_normal_attachment::none;
 
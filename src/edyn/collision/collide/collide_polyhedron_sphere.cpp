@@ -16,6 +16,8 @@ void collide(const polyhedron_shape &shA, const sphere_shape &shB,
     const auto ornB = conjugate(ctx.ornA) * ctx.ornB;
     auto threshold = ctx.threshold;
     const auto &meshA = *shA.mesh;
+    // Support queries start at the support vertex of the previous query.
+    uint32_t support_vertex {0};
 
     scalar distance = -EDYN_SCALAR_MAX;
     scalar projection_poly = EDYN_SCALAR_MAX;
@@ -41,9 +43,9 @@ void collide(const polyhedron_shape &shA, const sphere_shape &shB,
         return;
     }
 
-    auto polygon = point_cloud_support_polygon(
-        meshA.vertices.begin(), meshA.vertices.end(), vector3_zero,
-        sep_axis, projection_poly, true, support_feature_tolerance);
+    auto polygon = polyhedron_support_polygon(
+        meshA.vertices, meshA.neighbors_start, meshA.neighbor_indices, vector3_zero,
+        sep_axis, projection_poly, true, support_feature_tolerance, support_vertex);
 
     EDYN_ASSERT(polygon.hull.size() > 2);
 
@@ -0,0 +1,88 @@
+#include "edyn/collision/collision_stats.hpp"
+#include "edyn/collision/broadphase.hpp"
+#include "edyn/collision/contact_manifold.hpp"
+#include "edyn/collision/narrowphase.hpp"
+#include "edyn/comp/island.hpp"
+#include "edyn/comp/tag.hpp"
+#include "edyn/context/settings.hpp"
+#include "edyn/networking/context/client_network_context.hpp"
+#include "edyn/simulation/stepper_async.hpp"
+#include <entt/entity/registry.hpp>
+#include <algorithm>
+
+namespace edyn {
+
+bool get_collect_collision_stats(const entt::registry &registry) {
+    return registry.ctx().get<settings>().collect_collision_stats;
+}
+
+void set_collect_collision_stats(entt::registry &registry, bool enabled) {
+    auto &settings = registry.ctx().get<edyn::settings>();
+
+    if (enabled && !settings.collect_collision_stats) {
+        registry.ctx().get<collision_stats>() = {};
+    }
+
+    settings.collect_collision_stats = enabled;
+
+    if (auto *stepper = registry.ctx().find<stepper_async>()) {
+        stepper->settings_changed();
+    }
+
+    if (auto *ctx = registry.ctx().find<client_network_context>()) {
+        for (auto &extrapolator : ctx->extrapolators) {
+            extrapolator->set_settings(settings);
+        }
+    }
+}
+
+const collision_stats & get_collision_stats(const entt::registry &registry) {
+    return registry.ctx().get<collision_stats>();
+}
+
+}
+
+namespace edyn::internal {
+
+void collect_collision_stats(entt::registry &registry, collision_stats &stats) {
+    stats.broadphase = registry.ctx().get<broadphase>().get_stats();
+
+    auto &nphase_stats = registry.ctx().get<narrowphase>().get_stats();
+    stats.num_narrowphase_manifolds = nphase_stats.num_manifolds;
+    stats.num_narrowphase_manifolds_by_shape = nphase_stats.num_manifolds_by_shape;
+    stats.num_points_created = nphase_stats.num_points_created;
+    stats.num_points_destroyed = nphase_stats.num_points_destroyed;
+    stats.num_manifolds = registry.storage<contact_manifold>().size();
+
+    stats.num_awake_islands = 0;
+    stats.num_sleeping_islands = 0;
+    stats.island_size_histogram = {};
+    auto sleeping_view = registry.view<sleeping_tag>();
+
+    for (auto [entity, island] : registry.view<edyn::island>().each()) {
+        if (sleeping_view.contains(entity)) {
+            ++stats.num_sleeping_islands;
+            continue;
+        }
+
+        ++stats.num_awake_islands;
+
+        // Index of the highest set bit of the node count.
+        size_t bucket = 0;
+
+        for (auto size = island.nodes.size(); size > 1; size >>= 1) {
+            ++bucket;
+        }
+
+        bucket = std::min(bucket, collision_stats::num_island_size_buckets - 1);
+        ++stats.island_size_histogram[bucket];
+    }
+}
+
+void update_collision_stats(entt::registry &registry) {
+    if (registry.ctx().get<settings>().collect_collision_stats) {
+        collect_collision_stats(registry, registry.ctx().get<collision_stats>());
+    }
+}
+
+}
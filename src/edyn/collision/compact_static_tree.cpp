@@ -0,0 +1,69 @@
+#include "edyn/collision/compact_static_tree.hpp"
+
+namespace edyn {
+
+compact_tree_node_id_t compact_static_tree::build_node(const static_tree &tree, uint32_t id, const compact_tree_frame &f) {
+    uint32_t children[compact_tree_width];
+    auto count = collapse_binary_tree_node(tree, id, children);
+
+    auto node_id = static_cast<compact_tree_node_id_t>(m_nodes.size());
+    m_nodes.emplace_back();
+
+    for (unsigned k = 0; k < compact_tree_width; ++k) {
+        auto &node = m_nodes[node_id];
+
+        if (k >= count) {
+            clear_compact_tree_child(node, k);
+            continue;
+        }
+
+        auto &child = tree.get_node(children[k]);
+        set_compact_tree_child_bounds(node, k, f, child.aabb);
+
+        if (child.leaf()) {
+            node.child[k] = child.id | compact_tree_leaf_bit;
+        } else {
+            // Children are quantized relative to the dequantized bounds, which
+            // is what the queries compute while descending the tree.
+            auto cf = compact_tree_child_frame(f, node, k);
+            // The node array may be reallocated thus assign by index.
+            auto child_id = build_node(tree, children[k], cf);
+            m_nodes[node_id].child[k] = child_id;
+        }
+    }
+
+    return node_id;
+}
+
+void compact_static_tree::collapse(const static_tree &tree) {
+    if (tree.empty()) {
+        return;
+    }
+
+    auto &root_node = tree.get_node(0);
+    m_root_aabb = root_node.aabb;
+
+    if (root_node.leaf()) {
+        // Single leaf. Store it as the only child of the root.
+        auto &node = m_nodes.emplace_back();
+
+        for (unsigned k = 0; k < compact_tree_width; ++k) {
+            clear_compact_tree_child(node, k);
+        }
+
+        node.min_x[0] = node.min_y[0] = node.min_z[0] = 0;
+        node.max_x[0] = node.max_y[0] = node.max_z[0] = compact_tree_quantized_max;
+        node.child[0] = root_node.id | compact_tree_leaf_bit;
+        return;
+    }
+
+    build_node(tree, 0, make_compact_tree_frame(m_root_aabb));
+}
+
+void compact_static_tree::clear() {
+    m_nodes.clear();
+    m_leaves.clear();
+    m_ids.clear();
+}
+
+}
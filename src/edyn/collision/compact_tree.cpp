@@ -0,0 +1,82 @@
+#include "edyn/collision/compact_tree.hpp"
+#include "edyn/collision/dynamic_tree.hpp"
+
+namespace edyn {
+
+compact_tree_node_id_t compact_tree::build_node(const dynamic_tree &tree, tree_node_id_t id, const compact_tree_frame &f) {
+    tree_node_id_t children[compact_tree_width];
+    auto count = collapse_binary_tree_node(tree, id, children);
+
+    auto node_id = static_cast<compact_tree_node_id_t>(m_nodes.size());
+    m_nodes.emplace_back();
+    // The union of the children is the filter of the source node.
+    m_node_filters.push_back(tree.get_node(id).filter);
+
+    for (unsigned k = 0; k < compact_tree_width; ++k) {
+        auto &node = m_nodes[node_id];
+
+        if (k >= count) {
+            clear_compact_tree_child(node, k);
+            continue;
+        }
+
+        auto &child = tree.get_node(children[k]);
+        set_compact_tree_child_bounds(node, k, f, child.aabb);
+
+        if (child.leaf()) {
+            node.child[k] = static_cast<compact_tree_node_id_t>(m_leaves.size()) | compact_tree_leaf_bit;
+            m_leaves.push_back(child.entity);
+            m_leaf_filters.push_back(child.filter);
+        } else {
+            // Children are quantized relative to the dequantized bounds, which
+            // is what the queries compute while descending the tree.
+            auto cf = compact_tree_child_frame(f, node, k);
+            // The node array may be reallocated thus assign by index.
+            auto child_id = build_node(tree, children[k], cf);
+            m_nodes[node_id].child[k] = child_id;
+        }
+    }
+
+    return node_id;
+}
+
+void compact_tree::build(const dynamic_tree &tree) {
+    clear();
+
+    auto root = tree.root();
+
+    if (root == null_tree_node_id) {
+        return;
+    }
+
+    auto &root_node = tree.get_node(root);
+    m_root_aabb = root_node.aabb;
+
+    if (root_node.leaf()) {
+        // Single leaf. Store it as the only child of the root.
+        auto &node = m_nodes.emplace_back();
+
+        for (unsigned k = 0; k < compact_tree_width; ++k) {
+            node.min_x[k] = node.min_y[k] = node.min_z[k] = k == 0 ? 0 : compact_tree_quantized_max;
+            node.max_x[k] = node.max_y[k] = node.max_z[k] = k == 0 ? compact_tree_quantized_max : 0;
+            node.child[k] = null_compact_tree_node_id;
+        }
+
+        node.child[0] = compact_tree_leaf_bit;
+        m_node_filters.push_back(root_node.filter);
+        m_leaves.push_back(root_node.entity);
+        m_leaf_filters.push_back(root_node.filter);
+        return;
+    }
+
+    build_node(tree, root, make_compact_tree_frame(m_root_aabb));
+}
+
+void compact_tree::clear() {
+    m_nodes.clear();
+    m_node_filters.clear();
+    m_leaves.clear();
+    m_leaf_filters.clear();
+}
+
+}
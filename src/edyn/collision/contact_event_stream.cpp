@@ -0,0 +1,141 @@
+#include "edyn/collision/contact_event_stream.hpp"
+#include "edyn/collision/contact_manifold.hpp"
+#include "edyn/collision/contact_manifold_events.hpp"
+#include "edyn/comp/orientation.hpp"
+#include "edyn/comp/tag.hpp"
+#include "edyn/context/settings.hpp"
+#include "edyn/math/transform.hpp"
+#include "edyn/networking/context/client_network_context.hpp"
+#include "edyn/simulation/stepper_async.hpp"
+#include "edyn/util/rigidbody.hpp"
+#include <entt/entity/registry.hpp>
+
+namespace edyn {
+
+contact_event_stream::contact_event_stream(entt::registry &registry)
+    : m_registry(&registry)
+{
+    m_connections.emplace_back(registry.on_destroy<contact_manifold>().connect<&contact_event_stream::on_destroy_contact_manifold>(*this));
+}
+
+bool contact_event_stream::should_report(const contact_manifold &manifold, scalar impulse) const {
+    auto &settings = m_registry->ctx().get<edyn::settings>();
+
+    if (impulse < settings.contact_event_min_impulse) {
+        return false;
+    }
+
+    if (settings.contact_event_require_tag) {
+        auto tag_view = m_registry->view<contact_event_tag>();
+        return tag_view.contains(manifold.body[0]) || tag_view.contains(manifold.body[1]);
+    }
+
+    return true;
+}
+
+void contact_event_stream::update() {
+    if (!m_registry->ctx().get<settings>().stream_contact_events) {
+        m_reported.clear();
+        m_destroyed.clear();
+        return;
+    }
+
+    auto &events = m_registry->ctx().get<contact_event_buffer>().events;
+    events.insert(events.end(), m_destroyed.begin(), m_destroyed.end());
+    m_destroyed.clear();
+    auto orn_view = m_registry->view<orientation>();
+
+    for (auto [entity, manifold, manifold_events] :
+         m_registry->view<contact_manifold, contact_manifold_events>().each()) {
+        // Same as the emitter, a contact that ended and started again in the
+        // same step generates no event.
+        if (manifold_events.contact_ended && !manifold_events.contact_started) {
+            if (m_reported.erase(entity)) {
+                auto &event = events.emplace_back();
+                event.body = manifold.body;
+                event.type = contact_event_type::ended;
+            }
+
+            continue;
+        }
+
+        if (!manifold_events.contact_started || manifold_events.contact_ended) {
+            continue;
+        }
+
+        auto impulse = scalar(0);
+        auto max_impulse = -EDYN_SCALAR_MAX;
+        const contact_point *strongest = nullptr;
+
+        manifold.each_point([&](const contact_point &cp, const contact_point_cold &cold) {
+            auto point_impulse = cp.normal_impulse + cold.normal_restitution_impulse;
+            impulse += point_impulse;
+
+            if (point_impulse > max_impulse) {
+                max_impulse = point_impulse;
+                strongest = &cp;
+            }
+        });
+
+        if (strongest == nullptr || !should_report(manifold, impulse)) {
+            continue;
+        }
+
+        auto &event = events.emplace_back();
+        event.body = manifold.body;
+        event.type = contact_event_type::started;
+        event.impulse = impulse;
+        event.point = to_world_space(strongest->pivotB,
+                                     get_rigidbody_origin(*m_registry, manifold.body[1]),
+                                     orn_view.get<orientation>(manifold.body[1]));
+        event.normal = strongest->normal;
+        m_reported.insert(entity);
+    }
+}
+
+void contact_event_stream::on_destroy_contact_manifold(entt::registry &registry, entt::entity entity) {
+    // Manifolds are destroyed with points in them when their AABBs separate
+    // or one of the bodies is destroyed.
+    if (m_reported.erase(entity)) {
+        auto &manifold = registry.get<contact_manifold>(entity);
+        auto &event = m_destroyed.emplace_back();
+        event.body = manifold.body;
+        event.type = contact_event_type::ended;
+    }
+}
+
+bool get_stream_contact_events(const entt::registry &registry) {
+    return registry.ctx().get<settings>().stream_contact_events;
+}
+
+static void contact_event_settings_changed(entt::registry &registry) {
+    auto &settings = registry.ctx().get<edyn::settings>();
+
+    if (auto *stepper = registry.ctx().find<stepper_async>()) {
+        stepper->settings_changed();
+    }
+
+    if (auto *ctx = registry.ctx().find<client_network_context>()) {
+        for (auto &extrapolator : ctx->extrapolators) {
+            extrapolator->set_settings(settings);
+        }
+    }
+}
+
+void set_stream_contact_events(entt::registry &registry, bool enabled) {
+    registry.ctx().get<settings>().stream_contact_events = enabled;
+    contact_event_settings_changed(registry);
+}
+
+void set_contact_event_filter(entt::registry &registry, scalar min_impulse, bool require_tag) {
+    auto &settings = registry.ctx().get<edyn::settings>();
+    settings.contact_event_min_impulse = min_impulse;
+    settings.contact_event_require_tag = require_tag;
+    contact_event_settings_changed(registry);
+}
+
+const std::vector<contact_event> & get_contact_events(const entt::registry &registry) {
+    return registry.ctx().get<contact_event_buffer>().events;
+}
+
+}
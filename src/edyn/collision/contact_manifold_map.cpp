@@ -1,9 +1,37 @@
 #include "edyn/collision/contact_manifold_map.hpp"
 #include "edyn/collision/contact_manifold.hpp"
+#include "edyn/config/config.h"
 #include <entt/entity/registry.hpp>
+#include <algorithm>
 
 namespace edyn {
 
+static_assert(sizeof(entt::entity) <= sizeof(uint32_t), "Entity pairs must fit in 64 bits");
+
+// Key of slots not in use. It corresponds to a pair of null entities, which
+// never have a manifold.
+static constexpr uint64_t empty_pair_key = ~uint64_t{0};
+static constexpr size_t npos_slot = ~size_t{0};
+static constexpr size_t min_slot_count = 16;
+
+static uint64_t pack_entity_pair(entt::entity first, entt::entity second) {
+    auto a = static_cast<uint64_t>(entt::to_integral(first));
+    auto b = static_cast<uint64_t>(entt::to_integral(second));
+    return a < b ? (a << 32) | b : (b << 32) | a;
+}
+
+static size_t hash_pair_key(uint64_t key) {
+    // Finalizer of SplitMix64, which spreads the bits of the key over the
+    // whole word so that entity indices which are close to one another end
+    // up far apart.
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ull;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebull;
+    key ^= key >> 31;
+    return static_cast<size_t>(key);
+}
+
 contact_manifold_map::contact_manifold_map(entt::registry &registry) {
     m_connections.push_back(
         registry.on_construct<contact_manifold>()
@@ -14,44 +42,137 @@ contact_manifold_map::contact_manifold_map(entt::registry &registry) {
         .connect<&contact_manifold_map::on_destroy_contact_manifold>(*this));
 }
 
+size_t contact_manifold_map::find(uint64_t key) const {
+    if (m_slots.empty()) {
+        return npos_slot;
+    }
+
+    auto mask = m_slots.size() - 1;
+
+    for (auto i = hash_pair_key(key) & mask;; i = (i + 1) & mask) {
+        auto slot_key = m_slots[i].key;
+
+        if (slot_key == key) {
+            return i;
+        }
+
+        // The table is never full thus an empty slot is always found.
+        if (slot_key == empty_pair_key) {
+            return npos_slot;
+        }
+    }
+}
+
+void contact_manifold_map::insert(uint64_t key, entt::entity manifold) {
+    if ((m_size + 1) * 2 > m_slots.size()) {
+        rehash(std::max(m_slots.size() * 2, min_slot_count));
+    }
+
+    auto mask = m_slots.size() - 1;
+    auto i = hash_pair_key(key) & mask;
+
+    while (m_slots[i].key != empty_pair_key) {
+        EDYN_ASSERT(m_slots[i].key != key);
+        i = (i + 1) & mask;
+    }
+
+    m_slots[i] = {key, manifold};
+    ++m_size;
+}
+
+void contact_manifold_map::erase(uint64_t key) {
+    auto i = find(key);
+
+    if (i == npos_slot) {
+        return;
+    }
+
+    // Backward shift deletion. Move subsequent entries of the probe sequence
+    // into the hole unless they already are at or after their home slot,
+    // which leaves no tombstones behind.
+    auto mask = m_slots.size() - 1;
+    auto j = i;
+
+    while (true) {
+        j = (j + 1) & mask;
+
+        if (m_slots[j].key == empty_pair_key) {
+            break;
+        }
+
+        auto home = hash_pair_key(m_slots[j].key) & mask;
+
+        // Whether `home` lies cyclically in `(i, j]`.
+        auto in_range = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+
+        if (!in_range) {
+            m_slots[i] = m_slots[j];
+            i = j;
+        }
+    }
+
+    m_slots[i].key = empty_pair_key;
+    --m_size;
+}
+
+void contact_manifold_map::rehash(size_t capacity) {
+    auto old_slots = std::move(m_slots);
+    m_slots.assign(capacity, slot{empty_pair_key, entt::null});
+    m_size = 0;
+
+    for (auto &s : old_slots) {
+        if (s.key != empty_pair_key) {
+            insert(s.key, s.manifold);
+        }
+    }
+}
+
+void contact_manifold_map::reserve(size_t num_manifolds) {
+    auto capacity = min_slot_count;
+
+    while (capacity < num_manifolds * 2) {
+        capacity *= 2;
+    }
+
+    if (capacity > m_slots.size()) {
+        rehash(capacity);
+    }
+}
+
 bool contact_manifold_map::contains(entity_pair pair) const {
-    return m_pair_map.count(pair) > 0;
+    return contains(pair.first, pair.second);
 }
 
 bool contact_manifold_map::contains(entt::entity first, entt::entity second) const {
-    return contains(std::make_pair(first, second));
+    return find(pack_entity_pair(first, second)) != npos_slot;
 }
 
 entt::entity contact_manifold_map::get(entity_pair pair) const {
-    EDYN_ASSERT(contains(pair));
-    return m_pair_map.at(pair);
+    return get(pair.first, pair.second);
 }
 
 entt::entity contact_manifold_map::get(entt::entity first, entt::entity second) const {
-    return get(std::make_pair(first, second));
+    auto i = find(pack_entity_pair(first, second));
+    EDYN_ASSERT(i != npos_slot);
+    return m_slots[i].manifold;
 }
 
 void contact_manifold_map::on_construct_contact_manifold(entt::registry &registry, entt::entity entity) {
     auto &manifold = registry.get<contact_manifold>(entity);
-    // Insert all permutations.
-    auto p = std::make_pair(manifold.body[0], manifold.body[1]);
-    auto q = std::make_pair(manifold.body[1], manifold.body[0]);
-    EDYN_ASSERT(m_pair_map.count(p) == 0 && m_pair_map.count(q) == 0);
-    m_pair_map[p] = entity;
-    m_pair_map[q] = entity;
+    auto key = pack_entity_pair(manifold.body[0], manifold.body[1]);
+    EDYN_ASSERT(find(key) == npos_slot);
+    insert(key, entity);
 }
 
 void contact_manifold_map::on_destroy_contact_manifold(entt::registry &registry, entt::entity entity) {
     auto &manifold = registry.get<contact_manifold>(entity);
     // Cleanup cached info.
-    auto p = std::make_pair(manifold.body[0], manifold.body[1]);
-    auto q = std::make_pair(manifold.body[1], manifold.body[0]);
-    m_pair_map.erase(p);
-    m_pair_map.erase(q);
+    erase(pack_entity_pair(manifold.body[0], manifold.body[1]));
 }
 
 void contact_manifold_map::clear() {
-    m_pair_map.clear();
+    m_slots.clear();
+    m_size = 0;
 }
 
 }
@@ -1,8 +1,17 @@
 #include "edyn/collision/dynamic_tree.hpp"
 #include <entt/entity/registry.hpp>
+#include <algorithm>
+#include <array>
 
 namespace edyn {
 
+// Fits the bounds and the collision filter of an internal node to its
+// children.
+static void fit_node(tree_node &node, const tree_node &child1, const tree_node &child2) {
+    node.aabb = enclosing_aabb(child1.aabb, child2.aabb);
+    node.filter = collision_filter_union(child1.filter, child2.filter);
+}
+
 dynamic_tree::dynamic_tree()
     : m_root(null_tree_node_id)
     , m_free_list(null_tree_node_id)
@@ -17,6 +26,7 @@ tree_node_id_t dynamic_tree::allocate() {
         node.child1 = null_tree_node_id;
         node.child2 = null_tree_node_id;
         node.entity = entt::null;
+        node.filter = {};
         node.height = 0;
         return id;
     } else {
@@ -26,6 +36,7 @@ tree_node_id_t dynamic_tree::allocate() {
         node.child1 = null_tree_node_id;
         node.child2 = null_tree_node_id;
         node.entity = entt::null;
+        node.filter = {};
         node.height = 0;
         m_free_list = node.next;
         return id;
@@ -39,45 +50,286 @@ void dynamic_tree::free(tree_node_id_t id) {
     m_free_list = id;
 }
 
-tree_node_id_t dynamic_tree::create(const AABB &aabb, entt::entity entity) {
+AABB dynamic_tree::inflate(const AABB &aabb, const vector3 &displacement, const aabb_margin &margin) {
+    auto inflated = aabb.inset(vector3_one * -margin.margin);
+
+    // Extend the inflated AABB towards where the entity is heading only,
+    // instead of inflating it in all directions.
+    auto d = displacement * margin.displacement_multiplier;
+
+    for (int i = 0; i < 3; ++i) {
+        if (d[i] < 0) {
+            inflated.min[i] += d[i];
+        } else {
+            inflated.max[i] += d[i];
+        }
+    }
+
+    return inflated;
+}
+
+bool dynamic_tree::needs_move(tree_node_id_t id, const AABB &aabb, const vector3 &displacement,
+                              const aabb_margin &margin) const {
+    auto &node = m_nodes[id];
+    EDYN_ASSERT(node.leaf());
+
+    if (!node.aabb.contains(aabb)) {
+        return true;
+    }
+
+    // The AABB is still inside the inflated AABB of the leaf, but it could
+    // be much larger than necessary after the entity slowed down, which would
+    // create needless pairs. Compare sizes instead of testing containment as
+    // in Box2D, since the leaf of a fast entity trails behind the inflated
+    // AABB it would get now and would be reinserted in every step otherwise.
+    auto excess = node.aabb.size() - inflate(aabb, displacement, margin).size();
+    auto limit = 2 * margin.margin * huge_margin_multiplier;
+    return excess.x > limit || excess.y > limit || excess.z > limit;
+}
+
+tree_node_id_t dynamic_tree::create(const AABB &aabb, entt::entity entity, const collision_filter &filter,
+                                    const aabb_margin &margin) {
     auto id = allocate();
     auto &node = m_nodes[id];
     node.entity = entity;
-    node.aabb = aabb.inset(aabb_inset);
+    node.aabb = inflate(aabb, vector3_zero, margin);
+    node.filter = filter;
 
     insert(id);
 
     return id;
 }
 
+void dynamic_tree::create(const std::vector<AABB> &aabbs, const std::vector<entt::entity> &entities,
+                          std::vector<tree_node_id_t> &ids, const std::vector<collision_filter> &filters,
+                          const std::vector<aabb_margin> &margins) {
+    EDYN_ASSERT(aabbs.size() == entities.size());
+    EDYN_ASSERT(filters.empty() || filters.size() == aabbs.size());
+    EDYN_ASSERT(margins.empty() || margins.size() == aabbs.size());
+    ids.clear();
+
+    if (aabbs.empty()) {
+        return;
+    }
+
+    // A tree with n leaves has n - 1 internal nodes.
+    m_nodes.reserve(m_nodes.size() + 2 * aabbs.size());
+    ids.reserve(aabbs.size());
+
+    for (size_t i = 0; i < aabbs.size(); ++i) {
+        auto id = allocate();
+        auto &node = m_nodes[id];
+        node.entity = entities[i];
+        node.aabb = inflate(aabbs[i], vector3_zero, margins.empty() ? aabb_margin{} : margins[i]);
+
+        if (!filters.empty()) {
+            node.filter = filters[i];
+        }
+
+        ids.push_back(id);
+    }
+
+    // The leaves are reordered while building.
+    auto leaves = ids;
+    auto subtree_root = build(leaves.data(), leaves.data() + leaves.size());
+
+    // Insert the subtree as a whole, like a single leaf.
+    insert(subtree_root);
+}
+
+tree_node_id_t dynamic_tree::build(tree_node_id_t *first, tree_node_id_t *last) {
+    auto count = static_cast<size_t>(last - first);
+    EDYN_ASSERT(count > 0);
+
+    if (count == 1) {
+        return *first;
+    }
+
+    // Bounds of the centers of the leaves, whose largest axis is split.
+    auto centroid_aabb = AABB{m_nodes[*first].aabb.center(), m_nodes[*first].aabb.center()};
+
+    for (auto it = first + 1; it != last; ++it) {
+        auto center = m_nodes[*it].aabb.center();
+        centroid_aabb.min = min(centroid_aabb.min, center);
+        centroid_aabb.max = max(centroid_aabb.max, center);
+    }
+
+    auto extent = centroid_aabb.max - centroid_aabb.min;
+    auto axis = max_index(extent);
+    auto *mid = first + count / 2;
+
+    if (extent[axis] > EDYN_EPSILON) {
+        constexpr size_t num_bins = 16;
+        std::array<AABB, num_bins> bin_aabbs;
+        std::array<size_t, num_bins> bin_counts {};
+        auto scale = scalar(num_bins) / extent[axis];
+
+        auto bin_index = [&](tree_node_id_t id) {
+            auto offset = (m_nodes[id].aabb.center()[axis] - centroid_aabb.min[axis]) * scale;
+            return std::min(static_cast<size_t>(offset), num_bins - 1);
+        };
+
+        for (auto it = first; it != last; ++it) {
+            auto bin = bin_index(*it);
+            auto &aabb = m_nodes[*it].aabb;
+            bin_aabbs[bin] = bin_counts[bin] == 0 ? aabb : enclosing_aabb(bin_aabbs[bin], aabb);
+            ++bin_counts[bin];
+        }
+
+        // Sweep from the right to obtain the area and count to the right of
+        // each split plane, then from the left to evaluate the cost.
+        std::array<scalar, num_bins> right_cost {};
+        auto right_aabb = AABB{};
+        size_t right_count = 0;
+
+        for (auto i = num_bins - 1; i > 0; --i) {
+            if (bin_counts[i] > 0) {
+                right_aabb = right_count == 0 ? bin_aabbs[i] : enclosing_aabb(right_aabb, bin_aabbs[i]);
+                right_count += bin_counts[i];
+            }
+
+            right_cost[i - 1] = right_count > 0 ? right_aabb.area() * scalar(right_count) : scalar(0);
+        }
+
+        auto left_aabb = AABB{};
+        size_t left_count = 0;
+        auto best_cost = EDYN_SCALAR_MAX;
+        size_t best_split = num_bins;
+
+        for (size_t i = 0; i < num_bins - 1; ++i) {
+            if (bin_counts[i] > 0) {
+                left_aabb = left_count == 0 ? bin_aabbs[i] : enclosing_aabb(left_aabb, bin_aabbs[i]);
+                left_count += bin_counts[i];
+            }
+
+            if (left_count == 0 || left_count == count) {
+                continue;
+            }
+
+            auto cost = left_aabb.area() * scalar(left_count) + right_cost[i];
+
+            if (cost < best_cost) {
+                best_cost = cost;
+                best_split = i;
+            }
+        }
+
+        if (best_split < num_bins) {
+            mid = std::partition(first, last, [&](tree_node_id_t id) {
+                return bin_index(id) <= best_split;
+            });
+        }
+    }
+
+    if (mid == first || mid == last) {
+        // All centers are effectively in the same spot. Split in the middle.
+        mid = first + count / 2;
+    }
+
+    auto child1 = build(first, mid);
+    auto child2 = build(mid, last);
+
+    auto id = allocate();
+    auto &node = m_nodes[id];
+    node.child1 = child1;
+    node.child2 = child2;
+    fit_node(node, m_nodes[child1], m_nodes[child2]);
+    node.height = std::max(m_nodes[child1].height, m_nodes[child2].height) + 1;
+    m_nodes[child1].parent = id;
+    m_nodes[child2].parent = id;
+
+    return id;
+}
+
+void dynamic_tree::set_filter(tree_node_id_t id, const collision_filter &filter) {
+    EDYN_ASSERT(m_nodes[id].leaf());
+    m_nodes[id].filter = filter;
+
+    // Only the unions change thus there's no need to rebalance.
+    for (auto parent = m_nodes[id].parent; parent != null_tree_node_id; parent = m_nodes[parent].parent) {
+        auto &node = m_nodes[parent];
+        node.filter = collision_filter_union(m_nodes[node.child1].filter, m_nodes[node.child2].filter);
+    }
+}
+
 void dynamic_tree::destroy(tree_node_id_t id) {
     EDYN_ASSERT(m_nodes[id].leaf());
     remove(id);
     free(id);
 }
 
-bool dynamic_tree::move(tree_node_id_t id, const AABB &aabb) {
-    auto &node = m_nodes[id];
-    EDYN_ASSERT(node.leaf());
-
+bool dynamic_tree::move(tree_node_id_t id, const AABB &aabb, const vector3 &displacement,
+                        const aabb_margin &margin) {
     // If the entity's AABB hasn't moved outside the inflated node AABB,
     // nothing has to be done.
-    if (node.aabb.contains(aabb)) {
+    if (!needs_move(id, aabb, displacement, margin)) {
         return false;
     }
 
-    // Extend AABB.
-    auto offset_aabb = aabb.inset(aabb_inset);
-
     // Reinsert node with updated AABB.
     remove(id);
-    m_nodes[id].aabb = offset_aabb;
+    m_nodes[id].aabb = inflate(aabb, displacement, margin);
     insert(id);
 
     // It moved.
     return true;
 }
 
+void dynamic_tree::move(const std::vector<tree_node_id_t> &ids, const std::vector<AABB> &aabbs,
+                        const std::vector<vector3> &displacements,
+                        const std::vector<aabb_margin> &margins) {
+    EDYN_ASSERT(ids.size() == aabbs.size());
+    EDYN_ASSERT(displacements.empty() || displacements.size() == ids.size());
+    EDYN_ASSERT(margins.empty() || margins.size() == ids.size());
+    m_refit_nodes.clear();
+    m_reinsert_leaves.clear();
+    m_refit_marks.resize(m_nodes.size(), 0);
+
+    for (size_t i = 0; i < ids.size(); ++i) {
+        auto id = ids[i];
+        auto &node = m_nodes[id];
+        auto displacement = displacements.empty() ? vector3_zero : displacements[i];
+        auto margin = margins.empty() ? aabb_margin{} : margins[i];
+
+        if (!needs_move(id, aabbs[i], displacement, margin)) {
+            continue;
+        }
+
+        node.aabb = inflate(aabbs[i], displacement, margin);
+
+        if (node.parent == null_tree_node_id || !m_nodes[node.parent].aabb.contains(node.aabb)) {
+            m_reinsert_leaves.push_back(id);
+            continue;
+        }
+
+        // Mark the ancestors for refitting. Stop at the first one which was
+        // marked already since the ones above it were marked as well.
+        for (auto parent = node.parent; parent != null_tree_node_id && !m_refit_marks[parent];
+             parent = m_nodes[parent].parent) {
+            m_refit_marks[parent] = 1;
+            m_refit_nodes.push_back(parent);
+        }
+    }
+
+    // Children are lower than their parents thus fitting in order of height
+    // fits the children first. The ancestors of the leaves that are
+    // reinserted below are refit again when they're removed.
+    std::sort(m_refit_nodes.begin(), m_refit_nodes.end(), [&](auto lhs, auto rhs) {
+        return m_nodes[lhs].height < m_nodes[rhs].height;
+    });
+
+    for (auto id : m_refit_nodes) {
+        auto &node = m_nodes[id];
+        fit_node(node, m_nodes[node.child1], m_nodes[node.child2]);
+        m_refit_marks[id] = 0;
+    }
+
+    for (auto id : m_reinsert_leaves) {
+        remove(id);
+        insert(id);
+    }
+}
+
 tree_node_id_t dynamic_tree::best(const AABB &aabb) {
     // Find leaf node that would be the best sibling for a new leaf with the
     // given AABB.
@@ -143,7 +395,7 @@ void dynamic_tree::insert(tree_node_id_t leaf) {
     parent_node.parent = old_parent;
 
     auto &sibling_node = m_nodes[sibling];
-    parent_node.aabb = enclosing_aabb(sibling_node.aabb, leaf_aabb);
+    fit_node(parent_node, sibling_node, m_nodes[leaf]);
     parent_node.height = sibling_node.height + 1;
 
     auto &leaf_node = m_nodes[leaf];
@@ -216,7 +468,7 @@ void dynamic_tree::refit(tree_node_id_t id) {
         auto &node = m_nodes[id];
         EDYN_ASSERT(node.child1 != null_tree_node_id);
         EDYN_ASSERT(node.child2 != null_tree_node_id);
-        node.aabb = enclosing_aabb(m_nodes[node.child1].aabb, m_nodes[node.child2].aabb);
+        fit_node(node, m_nodes[node.child1], m_nodes[node.child2]);
         node.height = std::max(m_nodes[node.child1].height, m_nodes[node.child2].height) + 1;
         id = node.parent;
     }
@@ -268,8 +520,8 @@ tree_node_id_t dynamic_tree::balance(tree_node_id_t idA) {
             nodeC.child2 = idF;
             nodeA.child2 = idG;
             nodeG.parent = idA;
-            nodeA.aabb = enclosing_aabb(nodeB.aabb, nodeG.aabb);
-            nodeC.aabb = enclosing_aabb(nodeA.aabb, nodeF.aabb);
+            fit_node(nodeA, nodeB, nodeG);
+            fit_node(nodeC, nodeA, nodeF);
 
             nodeA.height = std::max(nodeB.height, nodeG.height) + 1;
             nodeC.height = std::max(nodeA.height, nodeF.height) + 1;
@@ -277,8 +529,8 @@ tree_node_id_t dynamic_tree::balance(tree_node_id_t idA) {
             nodeC.child2 = idG;
             nodeA.child2 = idF;
             nodeF.parent = idA;
-            nodeA.aabb = enclosing_aabb(nodeB.aabb, nodeF.aabb);
-            nodeC.aabb = enclosing_aabb(nodeA.aabb, nodeG.aabb);
+            fit_node(nodeA, nodeB, nodeF);
+            fit_node(nodeC, nodeA, nodeG);
 
             nodeA.height = std::max(nodeB.height, nodeF.height) + 1;
             nodeC.height = std::max(nodeA.height, nodeG.height) + 1;
@@ -317,8 +569,8 @@ tree_node_id_t dynamic_tree::balance(tree_node_id_t idA) {
             nodeB.child2 = idD;
             nodeA.child1 = idE;
             nodeE.parent = idA;
-            nodeA.aabb = enclosing_aabb(nodeC.aabb, nodeE.aabb);
-            nodeB.aabb = enclosing_aabb(nodeA.aabb, nodeD.aabb);
+            fit_node(nodeA, nodeC, nodeE);
+            fit_node(nodeB, nodeA, nodeD);
 
             nodeA.height = std::max(nodeC.height, nodeE.height) + 1;
             nodeB.height = std::max(nodeA.height, nodeD.height) + 1;
@@ -326,8 +578,8 @@ tree_node_id_t dynamic_tree::balance(tree_node_id_t idA) {
             nodeB.child2 = idE;
             nodeA.child1 = idD;
             nodeD.parent = idA;
-            nodeA.aabb = enclosing_aabb(nodeC.aabb, nodeD.aabb);
-            nodeB.aabb = enclosing_aabb(nodeA.aabb, nodeE.aabb);
+            fit_node(nodeA, nodeC, nodeD);
+            fit_node(nodeB, nodeA, nodeE);
 
             nodeA.height = std::max(nodeC.height, nodeD.height) + 1;
             nodeB.height = std::max(nodeA.height, nodeE.height) + 1;
@@ -343,6 +595,15 @@ const tree_node & dynamic_tree::get_node(tree_node_id_t id) const {
     return m_nodes[id];
 }
 
+void dynamic_tree::shift_origin(const vector3 &offset) {
+    for (auto &node : m_nodes) {
+        if (node.height != -1) {
+            node.aabb.min -= offset;
+            node.aabb.max -= offset;
+        }
+    }
+}
+
 void dynamic_tree::clear() {
     m_root = null_tree_node_id;
     m_free_list = null_tree_node_id;
@@ -0,0 +1,328 @@
+#include "edyn/collision/gjk.hpp"
+#include "edyn/math/math.hpp"
+#include "edyn/config/config.h"
+#include <algorithm>
+#include <utility>
+
+namespace edyn::detail {
+
+// Closest point to the origin in a set of the vertices of the simplex. It
+// writes the indices of the vertices needed to express the point and their
+// barycentric coordinates.
+struct simplex_closest_point {
+    vector3 point;
+    std::array<size_t, 4> indices;
+    std::array<scalar, 4> lambda;
+    size_t size;
+};
+
+static simplex_closest_point closest_on_vertex(const gjk_state &state, size_t i) {
+    return {state.w[i], {i}, {scalar(1)}, 1};
+}
+
+static simplex_closest_point closest_on_segment(const gjk_state &state, size_t i, size_t j) {
+    auto &p0 = state.w[i];
+    auto &p1 = state.w[j];
+    auto edge = p1 - p0;
+    auto len_sqr = length_sqr(edge);
+
+    if (len_sqr <= EDYN_EPSILON) {
+        return closest_on_vertex(state, i);
+    }
+
+    auto t = -dot(p0, edge) / len_sqr;
+
+    if (t <= 0) {
+        return closest_on_vertex(state, i);
+    }
+
+    if (t >= 1) {
+        return closest_on_vertex(state, j);
+    }
+
+    return {p0 + edge * t, {i, j}, {1 - t, t}, 2};
+}
+
+// Based on Real-Time Collision Detection by Christer Ericson, section 5.1.5,
+// with the query point at the origin.
+static simplex_closest_point closest_on_triangle(const gjk_state &state, size_t i, size_t j, size_t k) {
+    auto &a = state.w[i];
+    auto &b = state.w[j];
+    auto &c = state.w[k];
+    auto ab = b - a;
+    auto ac = c - a;
+
+    auto d1 = -dot(ab, a);
+    auto d2 = -dot(ac, a);
+    if (d1 <= 0 && d2 <= 0) {
+        return closest_on_vertex(state, i);
+    }
+
+    auto d3 = -dot(ab, b);
+    auto d4 = -dot(ac, b);
+    if (d3 >= 0 && d4 <= d3) {
+        return closest_on_vertex(state, j);
+    }
+
+    auto vc = d1 * d4 - d3 * d2;
+    if (vc <= 0 && d1 >= 0 && d3 <= 0) {
+        auto v = d1 / (d1 - d3);
+        return {a + ab * v, {i, j}, {1 - v, v}, 2};
+    }
+
+    auto d5 = -dot(ab, c);
+    auto d6 = -dot(ac, c);
+    if (d6 >= 0 && d5 <= d6) {
+        return closest_on_vertex(state, k);
+    }
+
+    auto vb = d5 * d2 - d1 * d6;
+    if (vb <= 0 && d2 >= 0 && d6 <= 0) {
+        auto w = d2 / (d2 - d6);
+        return {a + ac * w, {i, k}, {1 - w, w}, 2};
+    }
+
+    auto va = d3 * d6 - d5 * d4;
+    if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0) {
+        auto w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        return {b + (c - b) * w, {j, k}, {1 - w, w}, 2};
+    }
+
+    auto sum = va + vb + vc;
+
+    if (sum <= EDYN_EPSILON) {
+        // Degenerate triangle. Pick the closest of its edges.
+        auto best = closest_on_segment(state, i, j);
+
+        for (auto candidate : {closest_on_segment(state, i, k), closest_on_segment(state, j, k)}) {
+            if (length_sqr(candidate.point) < length_sqr(best.point)) {
+                best = candidate;
+            }
+        }
+
+        return best;
+    }
+
+    auto v = vb / sum;
+    auto w = vc / sum;
+    return {a + ab * v + ac * w, {i, j, k}, {1 - v - w, v, w}, 3};
+}
+
+static simplex_closest_point closest_on_tetrahedron(const gjk_state &state) {
+    // Faces and the vertex opposite to each.
+    constexpr size_t faces[4][4] = {{0, 1, 2, 3}, {0, 3, 1, 2}, {0, 2, 3, 1}, {1, 3, 2, 0}};
+
+    auto &w = state.w;
+    auto volume = dot(w[3] - w[0], cross(w[1] - w[0], w[2] - w[0]));
+    auto scale = length(w[1] - w[0]) * length(w[2] - w[0]) * length(w[3] - w[0]);
+    auto degenerate = std::abs(volume) <= scalar(1e-4) * scale;
+
+    auto best = simplex_closest_point{};
+    best.size = 0;
+    auto best_dist_sqr = EDYN_SCALAR_MAX;
+
+    for (auto &face : faces) {
+        auto &a = w[face[0]];
+        auto normal = cross(w[face[1]] - a, w[face[2]] - a);
+        auto origin_side = -dot(a, normal);
+        auto opposite_side = dot(w[face[3]] - a, normal);
+
+        // The closest point can only be on a face if the origin is on the
+        // opposite side of the remaining vertex. All faces are considered
+        // if the tetrahedron is flat, since it has no interior.
+        if (!degenerate && origin_side * opposite_side >= 0) {
+            continue;
+        }
+
+        auto candidate = closest_on_triangle(state, face[0], face[1], face[2]);
+        auto dist_sqr = length_sqr(candidate.point);
+
+        if (dist_sqr < best_dist_sqr) {
+            best_dist_sqr = dist_sqr;
+            best = candidate;
+        }
+    }
+
+    if (best.size == 0) {
+        // Origin inside tetrahedron.
+        auto lambda = scalar(1) / 4;
+        return {vector3_zero, {0, 1, 2, 3}, {lambda, lambda, lambda, lambda}, 4};
+    }
+
+    return best;
+}
+
+vector3 gjk_closest_point(gjk_state &state) {
+    simplex_closest_point closest;
+
+    switch (state.size) {
+    case 1:
+        closest = closest_on_vertex(state, 0);
+        break;
+    case 2:
+        closest = closest_on_segment(state, 0, 1);
+        break;
+    case 3:
+        closest = closest_on_triangle(state, 0, 1, 2);
+        break;
+    default:
+        EDYN_ASSERT(state.size == 4);
+        closest = closest_on_tetrahedron(state);
+    }
+
+    // Keep only the vertices that support the closest point.
+    auto reduced = gjk_state{};
+
+    for (size_t i = 0; i < closest.size; ++i) {
+        auto idx = closest.indices[i];
+        reduced.push(state.w[idx], state.a[idx], state.b[idx]);
+        reduced.lambda[i] = closest.lambda[i];
+    }
+
+    state = reduced;
+
+    return closest.point;
+}
+
+bool epa_polytope::add_face(uint32_t i0, uint32_t i1, uint32_t i2) {
+    auto normal = cross(m_w[i1] - m_w[i0], m_w[i2] - m_w[i0]);
+
+    if (!try_normalize(normal)) {
+        return false;
+    }
+
+    m_faces.push_back({{i0, i1, i2}, normal, dot(normal, m_w[i0])});
+    return true;
+}
+
+bool epa_polytope::init(const gjk_state &state) {
+    EDYN_ASSERT(state.size == 4);
+
+    m_w.assign(state.w.begin(), state.w.end());
+    m_a.assign(state.a.begin(), state.a.end());
+    m_b.assign(state.b.begin(), state.b.end());
+    m_faces.clear();
+
+    // Faces must wind counter-clockwise seen from outside.
+    auto flip = dot(m_w[3] - m_w[0], cross(m_w[1] - m_w[0], m_w[2] - m_w[0])) > 0;
+    constexpr uint32_t faces[4][3] = {{0, 1, 2}, {0, 3, 1}, {0, 2, 3}, {1, 3, 2}};
+
+    for (auto &face : faces) {
+        auto added = flip ? add_face(face[0], face[2], face[1]) : add_face(face[0], face[1], face[2]);
+
+        if (!added) {
+            return false;
+        }
+    }
+
+    // The origin must be inside the tetrahedron for EPA to work. It can be
+    // on its boundary, where it is when the simplex had to be grown.
+    for (auto &face : m_faces) {
+        if (face.distance < -epa_tolerance) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+size_t epa_polytope::closest_face() const {
+    EDYN_ASSERT(!m_faces.empty());
+    size_t closest_idx = 0;
+
+    for (size_t i = 1; i < m_faces.size(); ++i) {
+        if (m_faces[i].distance < m_faces[closest_idx].distance) {
+            closest_idx = i;
+        }
+    }
+
+    return closest_idx;
+}
+
+bool epa_polytope::expand(const vector3 &w, const vector3 &a, const vector3 &b) {
+    // Edges of visible faces, with the ones shared by two visible faces
+    // removed, form the horizon, i.e. the boundary of the hole left by
+    // removing the visible faces.
+    auto horizon = std::vector<std::pair<uint32_t, uint32_t>>{};
+    auto faces = std::vector<face>{};
+    faces.reserve(m_faces.size());
+
+    for (auto &face : m_faces) {
+        if (dot(face.normal, w - m_w[face.vertices[0]]) <= 0) {
+            faces.push_back(face);
+            continue;
+        }
+
+        for (size_t i = 0; i < 3; ++i) {
+            auto edge = std::make_pair(face.vertices[i], face.vertices[(i + 1) % 3]);
+            auto reverse = std::find(horizon.begin(), horizon.end(), std::make_pair(edge.second, edge.first));
+
+            if (reverse != horizon.end()) {
+                horizon.erase(reverse);
+            } else {
+                horizon.push_back(edge);
+            }
+        }
+    }
+
+    if (horizon.empty()) {
+        return false;
+    }
+
+    auto new_idx = static_cast<uint32_t>(m_w.size());
+    m_w.push_back(w);
+    m_a.push_back(a);
+    m_b.push_back(b);
+
+    std::swap(faces, m_faces);
+
+    for (auto &edge : horizon) {
+        if (!add_face(edge.first, edge.second, new_idx)) {
+            // Restore the previous polytope.
+            std::swap(faces, m_faces);
+            m_w.pop_back();
+            m_a.pop_back();
+            m_b.pop_back();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void epa_polytope::make_result(size_t face_idx, const vector3 &posB, const quaternion &ornB,
+                               epa_result &result) const {
+    auto &face = m_faces[face_idx];
+    result.normal = face.normal;
+    result.depth = face.distance;
+
+    // Barycentric coordinates of the projection of the origin onto the face.
+    auto &i = face.vertices;
+    auto point = face.normal * face.distance;
+    auto v0 = m_w[i[1]] - m_w[i[0]];
+    auto v1 = m_w[i[2]] - m_w[i[0]];
+    auto v2 = point - m_w[i[0]];
+    auto d00 = dot(v0, v0);
+    auto d01 = dot(v0, v1);
+    auto d11 = dot(v1, v1);
+    auto d20 = dot(v2, v0);
+    auto d21 = dot(v2, v1);
+    auto denom = d00 * d11 - d01 * d01;
+    auto u = scalar(1) / 3, v = scalar(1) / 3;
+
+    if (denom > EDYN_EPSILON) {
+        u = (d11 * d20 - d01 * d21) / denom;
+        v = (d00 * d21 - d01 * d20) / denom;
+    }
+
+    auto lambda = std::array<scalar, 3>{1 - u - v, u, v};
+    result.pointA = vector3_zero;
+    result.pointB = vector3_zero;
+
+    for (size_t k = 0; k < 3; ++k) {
+        result.pointA += m_a[i[k]] * lambda[k];
+        result.pointB += (posB + rotate(ornB, m_b[i[k]])) * lambda[k];
+    }
+}
+
+}
@@ -0,0 +1,372 @@
+#include "edyn/collision/linear_bvh.hpp"
+#include "edyn/math/vector3.hpp"
+#include <algorithm>
+#include <numeric>
+
+namespace edyn {
+
+static constexpr auto lbvh_npos = ~size_t{0};
+
+// Morton codes have 10 bits per axis.
+static constexpr uint32_t morton_axis_max = 1023;
+static constexpr unsigned radix_bits = 10;
+static constexpr unsigned radix_passes = 3;
+
+static int count_leading_zeros(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return x == 0 ? 64 : __builtin_clzll(x);
+#else
+    int count = 0;
+
+    for (auto bit = uint64_t{1} << 63; bit != 0 && !(x & bit); bit >>= 1) {
+        ++count;
+    }
+
+    return count;
+#endif
+}
+
+// Inserts two zeros between each of the 10 lowest bits.
+static uint32_t expand_bits(uint32_t v) {
+    v &= 0x3ff;
+    v = (v * 0x00010001u) & 0xff0000ffu;
+    v = (v * 0x00000101u) & 0x0f00f00fu;
+    v = (v * 0x00000011u) & 0xc30c30c3u;
+    v = (v * 0x00000005u) & 0x49249249u;
+    return v;
+}
+
+static uint32_t quantize(scalar t) {
+    auto q = t * scalar(morton_axis_max);
+    return q <= 0 ? 0 : q >= scalar(morton_axis_max) ? morton_axis_max : static_cast<uint32_t>(q);
+}
+
+size_t linear_bvh::find(entt::entity entity) const {
+    auto id = static_cast<size_t>(entt::to_entity(entity));
+
+    if (id >= m_sparse.size() || m_sparse[id] == 0) {
+        return lbvh_npos;
+    }
+
+    auto index = static_cast<size_t>(m_sparse[id] - 1);
+    return index < m_entities.size() && m_entities[index] == entity ? index : lbvh_npos;
+}
+
+bool linear_bvh::contains(entt::entity entity) const {
+    return find(entity) != lbvh_npos;
+}
+
+void linear_bvh::set_index(size_t index) {
+    m_sparse[static_cast<size_t>(entt::to_entity(m_entities[index]))] = static_cast<uint32_t>(index + 1);
+}
+
+void linear_bvh::insert(entt::entity entity, const AABB &aabb, const collision_filter &filter) {
+    EDYN_ASSERT(entity != entt::null);
+    EDYN_ASSERT(!contains(entity));
+    EDYN_ASSERT(m_entities.size() < leaf_bit);
+
+    m_aabbs.push_back(aabb);
+    m_entities.push_back(entity);
+    m_filters.push_back(filter);
+
+    auto id = static_cast<size_t>(entt::to_entity(entity));
+
+    if (id >= m_sparse.size()) {
+        m_sparse.resize(id + 1, 0);
+    }
+
+    set_index(m_entities.size() - 1);
+    m_dirty = true;
+}
+
+void linear_bvh::erase(entt::entity entity) {
+    auto index = find(entity);
+    EDYN_ASSERT(index != lbvh_npos);
+
+    // The order is lost anyway since the hierarchy is rebuilt.
+    auto last = m_entities.size() - 1;
+
+    if (index != last) {
+        m_aabbs[index] = m_aabbs[last];
+        m_entities[index] = m_entities[last];
+        m_filters[index] = m_filters[last];
+        set_index(index);
+    }
+
+    m_aabbs.pop_back();
+    m_entities.pop_back();
+    m_filters.pop_back();
+    m_sparse[static_cast<size_t>(entt::to_entity(entity))] = 0;
+    m_dirty = true;
+}
+
+void linear_bvh::set_aabb(entt::entity entity, const AABB &aabb) {
+    auto index = find(entity);
+    EDYN_ASSERT(index != lbvh_npos);
+    m_aabbs[index] = aabb;
+    m_dirty = true;
+}
+
+void linear_bvh::set_filter(entt::entity entity, const collision_filter &filter) {
+    auto index = find(entity);
+    EDYN_ASSERT(index != lbvh_npos);
+    m_filters[index] = filter;
+}
+
+void linear_bvh::compute_codes() {
+    auto count = m_entities.size();
+    auto lower = vector3_one * EDYN_SCALAR_MAX;
+    auto upper = vector3_one * -EDYN_SCALAR_MAX;
+
+    for (auto &aabb : m_aabbs) {
+        auto center = aabb.center();
+        lower = min(lower, center);
+        upper = max(upper, center);
+    }
+
+    // Centers are mapped into the unit cube spanned by all centers.
+    auto extent = upper - lower;
+    auto scale = vector3_zero;
+
+    for (int i = 0; i < 3; ++i) {
+        scale[i] = extent[i] > EDYN_EPSILON ? scalar(1) / extent[i] : scalar(0);
+    }
+
+    m_codes.resize(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        auto t = (m_aabbs[i].center() - lower) * scale;
+        m_codes[i] = (expand_bits(quantize(t.x)) << 2) |
+                     (expand_bits(quantize(t.y)) << 1) |
+                      expand_bits(quantize(t.z));
+    }
+}
+
+void linear_bvh::sort_codes() {
+    // Stable least significant digit radix sort of the indices by code.
+    auto count = m_entities.size();
+    m_order.resize(count);
+    m_sort_buffer.resize(count);
+    std::iota(m_order.begin(), m_order.end(), uint32_t{0});
+
+    constexpr auto num_buckets = size_t{1} << radix_bits;
+    constexpr auto mask = static_cast<uint32_t>(num_buckets - 1);
+    auto offsets = std::array<uint32_t, num_buckets>{};
+
+    for (unsigned pass = 0; pass < radix_passes; ++pass) {
+        auto shift = pass * radix_bits;
+        offsets.fill(0);
+
+        for (auto index : m_order) {
+            ++offsets[(m_codes[index] >> shift) & mask];
+        }
+
+        uint32_t sum = 0;
+
+        for (auto &offset : offsets) {
+            auto bucket_count = offset;
+            offset = sum;
+            sum += bucket_count;
+        }
+
+        for (auto index : m_order) {
+            m_sort_buffer[offsets[(m_codes[index] >> shift) & mask]++] = index;
+        }
+
+        std::swap(m_order, m_sort_buffer);
+    }
+}
+
+void linear_bvh::reorder() {
+    // Apply the permutation in place by following its cycles, where the
+    // element at `i` becomes the element at `m_order[i]`.
+    auto count = m_entities.size();
+    m_visits.assign(count, 0);
+
+    for (size_t start = 0; start < count; ++start) {
+        if (m_visits[start]) {
+            continue;
+        }
+
+        auto aabb = m_aabbs[start];
+        auto entity = m_entities[start];
+        auto filter = m_filters[start];
+        auto code = m_codes[start];
+        auto i = start;
+
+        while (true) {
+            m_visits[i] = 1;
+            auto from = static_cast<size_t>(m_order[i]);
+
+            if (from == start) {
+                m_aabbs[i] = aabb;
+                m_entities[i] = entity;
+                m_filters[i] = filter;
+                m_codes[i] = code;
+                break;
+            }
+
+            m_aabbs[i] = m_aabbs[from];
+            m_entities[i] = m_entities[from];
+            m_filters[i] = m_filters[from];
+            m_codes[i] = m_codes[from];
+            i = from;
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        set_index(i);
+    }
+}
+
+void linear_bvh::build_nodes() {
+    auto count = static_cast<int64_t>(m_entities.size());
+    m_nodes.resize(count - 1);
+    m_parents.resize(2 * count - 1);
+    m_parents[0] = 0;
+
+    // Length of the common prefix of the sort keys of two leaves, or -1 if
+    // `j` is out of range. The index is part of the key thus all keys are
+    // unique, even where codes are equal.
+    auto delta = [&](int64_t i, int64_t j) -> int {
+        if (j < 0 || j >= count) {
+            return -1;
+        }
+
+        auto key_i = (uint64_t{m_codes[i]} << 32) | static_cast<uint64_t>(i);
+        auto key_j = (uint64_t{m_codes[j]} << 32) | static_cast<uint64_t>(j);
+        return count_leading_zeros(key_i ^ key_j);
+    };
+
+    // Each internal node covers a range of leaves, of which it is at one end.
+    // Find the other end and the split, which are independent of the other
+    // nodes.
+    for (int64_t i = 0; i < count - 1; ++i) {
+        // Direction of the range.
+        int64_t d = delta(i, i + 1) - delta(i, i - 1) > 0 ? 1 : -1;
+
+        // Upper bound for the length of the range.
+        auto delta_min = delta(i, i - d);
+        int64_t length_max = 2;
+
+        while (delta(i, i + length_max * d) > delta_min) {
+            length_max *= 2;
+        }
+
+        // Find the other end with a binary search.
+        int64_t length = 0;
+
+        for (auto t = length_max / 2; t >= 1; t /= 2) {
+            if (delta(i, i + (length + t) * d) > delta_min) {
+                length += t;
+            }
+        }
+
+        auto j = i + length * d;
+
+        // Find the split, which is where the common prefix of the range
+        // grows, with a binary search.
+        auto delta_node = delta(i, j);
+        int64_t split = 0;
+        auto t = length;
+
+        do {
+            t = (t + 1) / 2;
+
+            if (delta(i, i + (split + t) * d) > delta_node) {
+                split += t;
+            }
+        } while (t > 1);
+
+        auto gamma = i + split * d + std::min(d, int64_t{0});
+        auto &n = m_nodes[i];
+
+        if (std::min(i, j) == gamma) {
+            n.child[0] = static_cast<uint32_t>(gamma) | leaf_bit;
+            m_parents[count - 1 + gamma] = static_cast<uint32_t>(i);
+        } else {
+            n.child[0] = static_cast<uint32_t>(gamma);
+            m_parents[gamma] = static_cast<uint32_t>(i);
+        }
+
+        if (std::max(i, j) == gamma + 1) {
+            n.child[1] = static_cast<uint32_t>(gamma + 1) | leaf_bit;
+            m_parents[count + gamma] = static_cast<uint32_t>(i);
+        } else {
+            n.child[1] = static_cast<uint32_t>(gamma + 1);
+            m_parents[gamma + 1] = static_cast<uint32_t>(i);
+        }
+    }
+}
+
+void linear_bvh::refit() {
+    // Walk up from each leaf. The second visit of a node computes its AABB,
+    // since both children are up to date by then.
+    auto count = m_entities.size();
+    m_visits.assign(count - 1, 0);
+
+    auto child_aabb = [&](uint32_t child) -> const AABB & {
+        return child & leaf_bit ? m_aabbs[child & ~leaf_bit] : m_nodes[child].aabb;
+    };
+
+    for (size_t leaf = 0; leaf < count; ++leaf) {
+        auto parent = m_parents[count - 1 + leaf];
+
+        while (m_visits[parent]++ != 0) {
+            auto &n = m_nodes[parent];
+            n.aabb = enclosing_aabb(child_aabb(n.child[0]), child_aabb(n.child[1]));
+
+            if (parent == 0) {
+                break;
+            }
+
+            parent = m_parents[parent];
+        }
+    }
+}
+
+void linear_bvh::build() {
+    if (!m_dirty) {
+        return;
+    }
+
+    m_dirty = false;
+    m_nodes.clear();
+    m_parents.clear();
+
+    if (m_entities.size() < 2) {
+        return;
+    }
+
+    compute_codes();
+    sort_codes();
+    reorder();
+    build_nodes();
+    refit();
+}
+
+void linear_bvh::shift_origin(const vector3 &offset) {
+    for (auto &aabb : m_aabbs) {
+        aabb = {aabb.min - offset, aabb.max - offset};
+    }
+
+    for (auto &n : m_nodes) {
+        n.aabb = {n.aabb.min - offset, n.aabb.max - offset};
+    }
+}
+
+void linear_bvh::clear() {
+    m_aabbs.clear();
+    m_entities.clear();
+    m_filters.clear();
+    m_sparse.clear();
+    m_nodes.clear();
+    m_parents.clear();
+    m_codes.clear();
+    m_order.clear();
+    m_sort_buffer.clear();
+    m_visits.clear();
+    m_dirty = false;
+}
+
+}
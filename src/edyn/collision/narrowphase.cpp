@@ -1,13 +1,21 @@
 #include "edyn/collision/narrowphase.hpp"
 #include "edyn/collision/contact_manifold.hpp"
 #include "edyn/collision/contact_point.hpp"
+#include "edyn/config/config.h"
 #include "edyn/config/constants.hpp"
 #include "edyn/context/task.hpp"
 #include "edyn/context/task_util.hpp"
+#include "edyn/comp/linvel.hpp"
 #include "edyn/comp/material.hpp"
+#include "edyn/math/math.hpp"
+#include "edyn/collision/collide.hpp"
+#include "edyn/collision/collide_batch.hpp"
+#include "edyn/collision/compound_pair_cache.hpp"
 #include "edyn/util/entt_util.hpp"
-#include "edyn/util/island_util.hpp"
+#include "edyn/util/awake_group.hpp"
 #include <entt/signal/delegate.hpp>
+#include <algorithm>
+#include <cmath>
 
 namespace edyn {
 
@@ -15,6 +23,119 @@ narrowphase::narrowphase(entt::registry &reg)
     : m_registry(&reg)
 {}
 
+// Transform of B relative to A.
+static void relative_transform(const vector3 &posA, const quaternion &ornA,
+                               const vector3 &posB, const quaternion &ornB,
+                               vector3 &rel_pos, quaternion &rel_orn) {
+    auto inv_ornA = conjugate(ornA);
+    rel_pos = rotate(inv_ornA, posB - posA);
+    rel_orn = inv_ornA * ornB;
+}
+
+static void update_transform_cache(contact_manifold &manifold, const collision_context &ctx) {
+    auto &cache = manifold.transform_cache;
+    relative_transform(ctx.posA, ctx.ornA, ctx.posB, ctx.ornB, cache.posB, cache.ornB);
+    cache.ornA = ctx.ornA;
+    cache.valid = true;
+}
+
+// Extends the collision threshold of manifolds involving bodies tagged with
+// `ccd_tag` by how much the bodies can approach each other during the next
+// step. Points found within this margin are speculative contacts, which the
+// contact constraint only allows to close the remaining gap, thus preventing
+// fast bodies from tunneling through others.
+template<typename CCDView, typename VelView>
+static void add_speculative_margin(const contact_manifold &manifold, collision_context &ctx,
+                                   const CCDView &ccd_view, const VelView &vel_view, scalar dt) {
+    if (!ccd_view.contains(manifold.body[0]) && !ccd_view.contains(manifold.body[1])) {
+        return;
+    }
+
+    auto relvel = vector3_zero;
+
+    if (vel_view.contains(manifold.body[0])) {
+        relvel += vel_view.template get<linvel>(manifold.body[0]);
+    }
+
+    if (vel_view.contains(manifold.body[1])) {
+        relvel -= vel_view.template get<linvel>(manifold.body[1]);
+    }
+
+    ctx.threshold += length(relvel) * dt;
+}
+
+void narrowphase::reuse_unmoved_manifolds() {
+    auto &settings = m_registry->ctx().get<edyn::settings>();
+
+    if (!(settings.contact_reuse_linear_tolerance > 0 && settings.contact_reuse_angular_tolerance > 0)) {
+        return;
+    }
+
+    auto manifold_view = m_registry->view<contact_manifold>();
+    auto tr_view = m_registry->view<position, orientation>();
+    auto origin_view = m_registry->view<origin>();
+    auto index_view = m_registry->view<shape_index>();
+    const auto linear_tolerance_sqr = square(settings.contact_reuse_linear_tolerance);
+    const auto min_cos_half_angle = std::cos(settings.contact_reuse_angular_tolerance * scalar(0.5));
+
+    auto get_origin = [&](entt::entity entity) {
+        return origin_view.contains(entity) ?
+            static_cast<vector3>(origin_view.get<origin>(entity)) :
+            static_cast<vector3>(tr_view.get<position>(entity));
+    };
+
+    auto can_reuse = [&](contact_manifold &manifold) {
+        auto &cache = manifold.transform_cache;
+
+        // Paged meshes load submeshes in the background thus new triangles
+        // might be in contact without the bodies moving.
+        if (!cache.valid ||
+            is_shape_index<paged_mesh_shape>(index_view.get<shape_index>(manifold.body[0])) ||
+            is_shape_index<paged_mesh_shape>(index_view.get<shape_index>(manifold.body[1]))) {
+            return false;
+        }
+
+        auto &ornA = tr_view.get<orientation>(manifold.body[0]);
+        auto &ornB = tr_view.get<orientation>(manifold.body[1]);
+        vector3 rel_pos;
+        quaternion rel_orn;
+        relative_transform(get_origin(manifold.body[0]), ornA, get_origin(manifold.body[1]), ornB, rel_pos, rel_orn);
+
+        if (distance_sqr(rel_pos, cache.posB) > linear_tolerance_sqr ||
+            std::abs(dot(rel_orn, cache.ornB)) < min_cos_half_angle) {
+            return false;
+        }
+
+        // Keep the points. The pivots are in object space and their
+        // distances are already up to date. The normals are in world space
+        // and must follow the rotation of the bodies.
+        auto delta_ornA = ornA * conjugate(cache.ornA);
+
+        manifold.each_point([&](contact_point &cp) {
+            ++cp.lifetime;
+
+            switch (cp.normal_attachment) {
+            case contact_normal_attachment::normal_on_A:
+                cp.normal = rotate(ornA, cp.local_normal);
+                break;
+            case contact_normal_attachment::normal_on_B:
+                cp.normal = rotate(ornB, cp.local_normal);
+                break;
+            case contact_normal_attachment::none:
+                cp.normal = normalize(rotate(delta_ornA, cp.normal));
+            }
+        });
+
+        cache.ornA = ornA;
+        return true;
+    };
+
+    auto it = std::remove_if(m_pending_manifolds.begin(), m_pending_manifolds.end(), [&](entt::entity entity) {
+        return can_reuse(manifold_view.get<contact_manifold>(entity));
+    });
+    m_pending_manifolds.erase(it, m_pending_manifolds.end());
+}
+
 void narrowphase::clear_contact_manifold_events() {
     m_registry->view<contact_manifold_events>().each([](auto &events) {
         events = {};
@@ -25,22 +146,165 @@ void narrowphase::update(bool mt) {
     clear_contact_manifold_events();
     update_contact_distances(*m_registry);
 
-    auto manifold_view = m_registry->view<contact_manifold>(exclude_sleeping_disabled);
-    auto num_active_manifolds = calculate_view_size(manifold_view);
+    auto manifold_group = awake_group<contact_manifold>(*m_registry);
 
-    if (mt && num_active_manifolds > m_max_sequential_size) {
+    if (mt && manifold_group.size() > m_max_sequential_size) {
         detect_collision_parallel();
         finish_detect_collision();
     } else {
-        update_contact_manifolds(manifold_view.begin(), manifold_view.end());
+        update_contact_manifolds(manifold_group.begin(), manifold_group.end());
+    }
+}
+
+void narrowphase::attach_compound_pair_caches() {
+    // Create the storage beforehand since views are obtained while detecting
+    // collisions, which may run in parallel.
+    auto &cache_storage = m_registry->storage<compound_pair_cache>();
+    constexpr auto num_shapes = std::tuple_size_v<std::decay_t<decltype(shapes_tuple)>>;
+    constexpr auto compound_index = get_shape_index<compound_shape>();
+    constexpr auto compound_pair = unsigned(compound_index * num_shapes + compound_index);
+
+    for (size_t i = 0; i < m_manifold_entities.size(); ++i) {
+        auto entity = m_manifold_entities[i];
+
+        if (m_manifold_shape_pairs[i] == compound_pair && !cache_storage.contains(entity)) {
+            cache_storage.emplace(entity);
+        }
     }
 }
 
-void narrowphase::detect_collision_parallel_range(unsigned start, unsigned end) {
+template<typename ProcessFunc>
+void narrowphase::detect_collision_sorted(const entt::entity *first, const entt::entity *last,
+                                          unsigned start, ProcessFunc process) {
+    auto manifold_view = m_registry->view<contact_manifold>();
+    auto body_view = m_registry->view<AABB, shape_index, position, orientation>();
+    auto origin_view = m_registry->view<origin>();
+    auto ccd_view = m_registry->view<ccd_tag>();
+    auto vel_view = m_registry->view<linvel>();
+    auto compound_cache_view = m_registry->view<compound_pair_cache>();
+    auto dt = m_registry->ctx().get<settings>().fixed_dt;
+    auto views_tuple = get_tuple_of_shape_views(*m_registry);
+    constexpr auto num_shapes = std::tuple_size_v<std::decay_t<decltype(shapes_tuple)>>;
+
+    while (first != last) {
+        // Find the run of manifolds with the same pair of shape types and
+        // resolve the shape types only once for all of them.
+        auto shape_pair = m_manifold_shape_pairs[start];
+        auto run_last = first;
+        auto run_start = start;
+
+        while (run_last != last && m_manifold_shape_pairs[start] == shape_pair) {
+            ++run_last;
+            ++start;
+        }
+
+        visit_tuple(shapes_tuple, shape_pair / num_shapes, [&](auto &&shA_type) {
+            visit_tuple(shapes_tuple, shape_pair % num_shapes, [&](auto &&shB_type) {
+                using ShapeAType = std::decay_t<decltype(shA_type)>;
+                using ShapeBType = std::decay_t<decltype(shB_type)>;
+                auto &viewA = std::get<get_shape_index<ShapeAType>()>(views_tuple);
+                auto &viewB = std::get<get_shape_index<ShapeBType>()>(views_tuple);
+                auto index = run_start;
+
+                if constexpr(has_collide_batch_v<ShapeAType, ShapeBType>) {
+                    // Gather pairs into lanes and run a batched kernel once
+                    // all lanes are filled. Leftovers go through `collide`.
+                    collide_batch_shapes<ShapeAType> batchA;
+                    collide_batch_shapes<ShapeBType> batchB;
+                    collide_batch_contexts batch_ctx;
+                    entt::entity batch_entities[collide_batch_size];
+                    contact_manifold *batch_manifolds[collide_batch_size];
+                    unsigned batch_indices[collide_batch_size];
+                    size_t count = 0;
+
+                    auto flush = [&]() {
+                        collide_batch_results results;
+
+                        if (count == collide_batch_size) {
+                            collide_batch(batchA, batchB, batch_ctx, results);
+                        } else {
+                            for (size_t lane = 0; lane < count; ++lane) {
+                                collide(*batchA[lane], *batchB[lane], batch_ctx[lane], results[lane]);
+                            }
+                        }
+
+                        for (size_t lane = 0; lane < count; ++lane) {
+                            process(batch_indices[lane], batch_entities[lane], *batch_manifolds[lane], results[lane]);
+                        }
+
+                        count = 0;
+                    };
+
+                    for (auto it = first; it != run_last; ++it, ++index) {
+                        auto entity = *it;
+                        auto &manifold = manifold_view.get<contact_manifold>(entity);
+
+                        if (!make_collision_context(manifold.body, batch_ctx[count], body_view, origin_view)) {
+                            process(index, entity, manifold, collision_result{});
+                            continue;
+                        }
+
+                        add_speculative_margin(manifold, batch_ctx[count], ccd_view, vel_view, dt);
+                        update_transform_cache(manifold, batch_ctx[count]);
+                        batchA[count] = &viewA.template get<ShapeAType>(manifold.body[0]);
+                        batchB[count] = &viewB.template get<ShapeBType>(manifold.body[1]);
+                        batch_entities[count] = entity;
+                        batch_manifolds[count] = &manifold;
+                        batch_indices[count] = index;
+
+                        if (++count == collide_batch_size) {
+                            flush();
+                        }
+                    }
+
+                    flush();
+                } else {
+                    for (auto it = first; it != run_last; ++it, ++index) {
+                        auto entity = *it;
+                        auto &manifold = manifold_view.get<contact_manifold>(entity);
+                        collision_result result;
+                        collision_context ctx;
+
+                        if (make_collision_context(manifold.body, ctx, body_view, origin_view)) {
+                            ctx.sat_cache = &manifold.sat_cache;
+
+                            if constexpr(std::is_same_v<ShapeAType, compound_shape> &&
+                                         std::is_same_v<ShapeBType, compound_shape>) {
+                                ctx.compound_cache = &compound_cache_view.template get<compound_pair_cache>(entity);
+                            }
+
+                            add_speculative_margin(manifold, ctx, ccd_view, vel_view, dt);
+                            update_transform_cache(manifold, ctx);
+                            auto &shA = viewA.template get<ShapeAType>(manifold.body[0]);
+                            auto &shB = viewB.template get<ShapeBType>(manifold.body[1]);
+                            collide(shA, shB, ctx, result);
+                        } else {
+                            result.num_points = 0;
+                        }
+
+                        process(index, entity, manifold, result);
+                    }
+                }
+            });
+        });
+
+        first = run_last;
+    }
+}
+
+void narrowphase::update_sorted_contact_manifolds() {
+    m_cp_construction_infos.resize(m_manifold_entities.size());
+    m_cp_destruction_infos.resize(m_manifold_entities.size());
+
+    auto *first = m_manifold_entities.data();
+    auto *last = first + m_manifold_entities.size();
+    detect_collision_range(first, last, 0);
+    finish_detect_collision();
+}
+
+void narrowphase::detect_collision_range(const entt::entity *first, const entt::entity *last, unsigned start) {
     auto &registry = *m_registry;
-    auto manifold_view = registry.view<contact_manifold>();
     auto events_view = registry.view<contact_manifold_events>();
-    auto body_view = registry.view<AABB, shape_index, position, orientation>();
     auto tr_view = registry.view<position, orientation>();
     auto vel_view = registry.view<angvel>();
     auto rolling_view = registry.view<rolling_tag>();
@@ -49,20 +313,14 @@ void narrowphase::detect_collision_parallel_range(unsigned start, unsigned end)
     auto orn_view = registry.view<orientation>();
     auto mesh_shape_view = registry.view<mesh_shape>();
     auto paged_mesh_shape_view = registry.view<paged_mesh_shape>();
-    auto shapes_views_tuple = get_tuple_of_shape_views(registry);
     auto dt = registry.ctx().get<settings>().fixed_dt;
-    auto first = manifold_view.begin();
-    std::advance(first, start);
 
-    for (auto index = start; index < end; ++index, ++first) {
-        auto entity = *first;
-        auto [manifold] = manifold_view.get(entity);
+    detect_collision_sorted(first, last, start, [&](unsigned index, entt::entity entity,
+                                                    contact_manifold &manifold, const collision_result &result) {
         auto [events] = events_view.get(entity);
-        collision_result result;
         auto &construction_info = m_cp_construction_infos[index];
         auto &destruction_info = m_cp_destruction_infos[index];
 
-        detect_collision(manifold.body, result, body_view, origin_view, shapes_views_tuple);
         process_collision(entity, manifold, events, result, tr_view, vel_view,
                         rolling_view, origin_view, orn_view, material_view,
                         mesh_shape_view, paged_mesh_shape_view, dt,
@@ -72,43 +330,74 @@ void narrowphase::detect_collision_parallel_range(unsigned start, unsigned end)
             EDYN_ASSERT(pt_id < max_contacts);
             destruction_info.point_id[destruction_info.count++] = pt_id;
         });
-    }
+    });
 }
 
 void narrowphase::detect_collision_parallel() {
+    // Group manifolds by shape types so each task mostly runs long streaks of
+    // the same collision function.
+    auto manifold_group = awake_group<contact_manifold>(*m_registry);
+    sort_manifolds_by_shape(manifold_group.begin(), manifold_group.end());
+    update_rotated_meshes_in_contact(*m_registry, m_manifold_entities, m_rotated_mesh_entities, true);
+
     // Resize result collection vectors to allocate one slot for each iteration.
-    auto manifold_view = m_registry->view<contact_manifold>();
-    m_cp_construction_infos.resize(manifold_view.size());
-    m_cp_destruction_infos.resize(manifold_view.size());
+    m_cp_construction_infos.resize(m_manifold_entities.size());
+    m_cp_destruction_infos.resize(m_manifold_entities.size());
 
-    auto task = task_delegate_t(entt::connect_arg_t<&narrowphase::detect_collision_parallel_range>{}, *this);
-    enqueue_task_wait(*m_registry, task, manifold_view.size());
+    parallel_for_each_range(*m_registry, m_manifold_entities,
+                            [this](const entt::entity *first, const entt::entity *last, unsigned start) {
+        detect_collision_range(first, last, start);
+    });
 }
 
 void narrowphase::finish_detect_collision() {
     auto manifold_view = m_registry->view<contact_manifold>();
-    auto it = manifold_view.begin();
+    auto events_view = m_registry->view<contact_manifold_events>();
+    EDYN_ASSERT(m_manifold_entities.size() == m_cp_destruction_infos.size());
+    EDYN_ASSERT(m_manifold_entities.size() == m_cp_construction_infos.size());
 
-    // Destroy contact points.
-    for (size_t i = 0; i < manifold_view.size(); ++i, ++it) {
-        auto entity = *it;
-        auto &info_result = m_cp_destruction_infos[i];
+    m_stats.num_manifolds = m_manifold_entities.size();
+    m_stats.num_points_created = 0;
+    m_stats.num_points_destroyed = 0;
+    m_stats.churning_manifolds.clear();
+    m_stats.num_manifolds_by_shape = {};
 
-        for (size_t j = 0; j < info_result.count; ++j) {
-            destroy_contact_point(*m_registry, entity, info_result.point_id[j]);
-        }
+    for (auto shape_pair : m_manifold_shape_pairs) {
+        ++m_stats.num_manifolds_by_shape[shape_pair];
     }
 
-    // Create contact points.
-    it = manifold_view.begin();
+    for (size_t i = 0; i < m_manifold_entities.size(); ++i) {
+        auto &construction_info = m_cp_construction_infos[i];
+        auto &destruction_info = m_cp_destruction_infos[i];
 
-    for (size_t i = 0; i < manifold_view.size(); ++i, ++it) {
-        auto entity = *it;
+        if (construction_info.count == 0 && destruction_info.count == 0) {
+            continue;
+        }
+
+        // Destroyed points were already removed from the manifold in
+        // `process_collision`, thus only the new points must be inserted.
+        auto entity = m_manifold_entities[i];
         auto &manifold = manifold_view.get<contact_manifold>(entity);
-        auto &info_result = m_cp_construction_infos[i];
+        auto &events = events_view.get<contact_manifold_events>(entity);
+
+        if (construction_info.count > 0) {
+            // Mix materials once for all new points in this manifold.
+            auto mixed = mix_contact_material(*m_registry, manifold);
+
+            for (size_t j = 0; j < construction_info.count; ++j) {
+                insert_contact_point(*m_registry, manifold, events, construction_info.point[j], mixed);
+            }
+        }
+
+        // Trigger update signals once for all changes in this manifold.
+        m_registry->patch<contact_manifold>(entity);
+        m_registry->patch<contact_manifold_events>(entity);
+
+        m_stats.num_points_created += construction_info.count;
+        m_stats.num_points_destroyed += destruction_info.count;
 
-        for (size_t j = 0; j < info_result.count; ++j) {
-            create_contact_point(*m_registry, entity, manifold, info_result.point[j]);
+        if (construction_info.count > 0 && destruction_info.count > 0) {
+            m_stats.churning_manifolds.push_back(entity);
         }
     }
 
@@ -0,0 +1,103 @@
+#include "edyn/collision/overlap.hpp"
+#include "edyn/collision/collide.hpp"
+#include "edyn/collision/raycast_service.hpp"
+#include "edyn/config/constants.hpp"
+#include "edyn/context/settings.hpp"
+#include "edyn/math/transform.hpp"
+#include "edyn/simulation/stepper_async.hpp"
+#include "edyn/util/aabb_util.hpp"
+#include <entt/entity/registry.hpp>
+#include <algorithm>
+
+namespace edyn {
+
+overlap_result overlap(entt::registry &registry, const overlap_query &query,
+                       const std::vector<entt::entity> &ignore_entities) {
+    return overlap_batch(registry, {query}, ignore_entities).front();
+}
+
+std::vector<overlap_result> overlap_batch(entt::registry &registry,
+                                          const std::vector<overlap_query> &queries,
+                                          const std::vector<entt::entity> &ignore_entities) {
+    auto &settings = registry.ctx().get<edyn::settings>();
+    auto mt = settings.execution_mode == execution_mode::sequential_multithreaded;
+
+    auto service = raycast_service(registry);
+    service.add_overlap_batch(queries, 0, ignore_entities);
+    service.update(mt);
+
+    auto results = std::vector<overlap_result>{};
+    service.consume_overlap_results([&](unsigned, std::vector<overlap_result> &batch_results) {
+        results = std::move(batch_results);
+    });
+
+    return results;
+}
+
+overlap_id_type overlap_async(entt::registry &registry, const overlap_query &query,
+                              const overlap_delegate_type &delegate,
+                              const std::vector<entt::entity> &ignore_entities) {
+    auto &stepper = registry.ctx().get<stepper_async>();
+    return stepper.overlap(query, delegate, ignore_entities);
+}
+
+overlap_id_type overlap_batch_async(entt::registry &registry, std::vector<overlap_query> queries,
+                                    const overlap_batch_delegate_type &delegate,
+                                    const std::vector<entt::entity> &ignore_entities) {
+    auto &stepper = registry.ctx().get<stepper_async>();
+    return stepper.overlap_batch(std::move(queries), delegate, ignore_entities);
+}
+
+template<typename QueryShape, typename Shape>
+static overlap_hit closest_points(const QueryShape &query_shape, const Shape &shape,
+                                  const overlap_context &ctx) {
+    auto &query = ctx.query;
+    auto inset = vector3_one * -query.max_distance;
+    // The AABBs are inflated by the maximum distance so that the collision
+    // functions visit all parts of concave shapes within reach.
+    auto aabbA = shape_aabb(query_shape, query.pos, query.orn).inset(inset);
+    auto aabbB = shape_aabb(shape, ctx.pos, ctx.orn).inset(inset);
+    // Some collision functions rely on the threshold to find the features
+    // near the contact, thus it's never smaller than the usual one.
+    auto threshold = std::max(query.max_distance, contact_breaking_threshold);
+    auto col_ctx = collision_context{query.pos, query.orn, aabbA, ctx.pos, ctx.orn, aabbB, threshold};
+    auto col_result = collision_result{};
+    collide(query_shape, shape, col_ctx, col_result);
+
+    auto hit = overlap_hit{};
+
+    for (size_t i = 0; i < col_result.num_points; ++i) {
+        auto &point = col_result.point[i];
+
+        if (point.distance > query.max_distance || point.distance >= hit.distance) {
+            continue;
+        }
+
+        hit.distance = point.distance;
+        hit.pointA = to_world_space(point.pivotA, query.pos, query.orn);
+        hit.pointB = to_world_space(point.pivotB, ctx.pos, ctx.orn);
+        hit.normal = point.normal;
+    }
+
+    return hit;
+}
+
+template<typename Shape>
+overlap_hit overlap(const Shape &shape, const overlap_context &ctx) {
+    return std::visit([&](auto &&query_shape) {
+        return closest_points(query_shape, shape, ctx);
+    }, ctx.query.shape);
+}
+
+template overlap_hit overlap(const plane_shape &, const overlap_context &);
+template overlap_hit overlap(const sphere_shape &, const overlap_context &);
+template overlap_hit overlap(const cylinder_shape &, const overlap_context &);
+template overlap_hit overlap(const capsule_shape &, const overlap_context &);
+template overlap_hit overlap(const box_shape &, const overlap_context &);
+template overlap_hit overlap(const polyhedron_shape &, const overlap_context &);
+template overlap_hit overlap(const compound_shape &, const overlap_context &);
+template overlap_hit overlap(const mesh_shape &, const overlap_context &);
+template overlap_hit overlap(const paged_mesh_shape &, const overlap_context &);
+template overlap_hit overlap(const heightfield_shape &, const overlap_context &);
+
+}
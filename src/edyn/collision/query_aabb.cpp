@@ -12,6 +12,23 @@ query_aabb_id_type query_island_aabb_async(entt::registry &registry, const AABB
     return stepper.query_aabb(aabb, delegate, query_procedural, query_non_procedural, query_islands);
 }
 
+query_future<query_aabb_result> query_aabb_async_future(entt::registry &registry, const AABB &aabb,
+                                                        bool query_procedural,
+                                                        bool query_non_procedural,
+                                                        bool query_islands) {
+    auto &stepper = registry.ctx().get<stepper_async>();
+    return stepper.query_aabb_future(aabb, query_procedural, query_non_procedural, query_islands);
+}
+
+query_aabb_id_type query_aabb_batch_async(entt::registry &registry, std::vector<AABB> aabbs,
+                                          const query_aabb_batch_delegate_type &delegate,
+                                          bool query_procedural,
+                                          bool query_non_procedural,
+                                          bool query_islands) {
+    auto &stepper = registry.ctx().get<stepper_async>();
+    return stepper.query_aabb_batch(std::move(aabbs), delegate, query_procedural,
+                                    query_non_procedural, query_islands);
+}
 
 query_aabb_id_type query_aabb_of_interest_async(entt::registry &registry, const AABB &aabb,
                                                 const query_aabb_delegate_type &delegate) {
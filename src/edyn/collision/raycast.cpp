@@ -4,6 +4,7 @@
 #include "edyn/math/geom.hpp"
 #include "edyn/math/math.hpp"
 #include "edyn/math/transform.hpp"
+#include "edyn/simulation/broadphase_mirror.hpp"
 #include "edyn/simulation/stepper_async.hpp"
 #include "edyn/math/triangle.hpp"
 #include <unordered_set>
@@ -17,8 +18,24 @@ raycast_id_type raycast_async(entt::registry &registry, vector3 p0, vector3 p1,
     return stepper.raycast(p0, p1, delegate, ignore_entities);
 }
 
-raycast_result raycast(entt::registry &registry, vector3 p0, vector3 p1,
-                       const std::vector<entt::entity> &ignore_entities) {
+query_future<raycast_result> raycast_async_future(entt::registry &registry, vector3 p0, vector3 p1,
+                                                  const std::vector<entt::entity> &ignore_entities) {
+    auto &stepper = registry.ctx().get<stepper_async>();
+    return stepper.raycast_future(p0, p1, ignore_entities);
+}
+
+raycast_id_type raycast_batch_async(entt::registry &registry, std::vector<raycast_query> rays,
+                                    const raycast_batch_delegate_type &delegate,
+                                    const std::vector<entt::entity> &ignore_entities,
+                                    bool any_hit) {
+    auto &stepper = registry.ctx().get<stepper_async>();
+    return stepper.raycast_batch(std::move(rays), delegate, ignore_entities, any_hit);
+}
+
+template<typename Broadphase>
+static raycast_result raycast_bodies(entt::registry &registry, const Broadphase &bphase,
+                                     vector3 p0, vector3 p1,
+                                     const std::vector<entt::entity> &ignore_entities, bool any_hit) {
     auto index_view = registry.view<shape_index>();
     auto tr_view = registry.view<position, orientation>();
     auto origin_view = registry.view<origin>();
@@ -33,7 +50,7 @@ raycast_result raycast(entt::registry &registry, vector3 p0, vector3 p1,
             static_cast<vector3>(origin_view.get<origin>(entity)) :
             tr_view.get<position>(entity);
         auto orn = tr_view.get<orientation>(entity);
-        auto ctx = raycast_context{pos, orn, p0, p1};
+        auto ctx = raycast_context{pos, orn, p0, p1, any_hit};
 
         visit_shape(sh_idx, entity, shape_views_tuple, [&](auto &&shape) {
             auto res = shape_raycast(shape, ctx);
@@ -45,9 +62,14 @@ raycast_result raycast(entt::registry &registry, vector3 p0, vector3 p1,
         });
     };
 
-    auto &bphase = registry.ctx().get<broadphase>();
     bphase.raycast(p0, p1, [&](entt::entity entity) {
-        if (!vector_contains(ignore_entities, entity)) {
+        if (any_hit && hit_entity != entt::null) {
+            return;
+        }
+
+        // Entities in the broadphase mirror might have been destroyed since
+        // it was published.
+        if (index_view.contains(entity) && !vector_contains(ignore_entities, entity)) {
             raycast_shape(entity);
         }
     });
@@ -55,6 +77,27 @@ raycast_result raycast(entt::registry &registry, vector3 p0, vector3 p1,
     return {result, hit_entity};
 }
 
+static raycast_result raycast_bodies(entt::registry &registry, vector3 p0, vector3 p1,
+                                     const std::vector<entt::entity> &ignore_entities, bool any_hit) {
+    if (auto *bphase = registry.ctx().find<broadphase>()) {
+        return raycast_bodies(registry, *bphase, p0, p1, ignore_entities, any_hit);
+    }
+
+    auto *mirror = find_broadphase_mirror(registry);
+    EDYN_ASSERT(mirror != nullptr);
+    return raycast_bodies(registry, *mirror, p0, p1, ignore_entities, any_hit);
+}
+
+raycast_result raycast(entt::registry &registry, vector3 p0, vector3 p1,
+                       const std::vector<entt::entity> &ignore_entities) {
+    return raycast_bodies(registry, p0, p1, ignore_entities, false);
+}
+
+raycast_result raycast_any(entt::registry &registry, vector3 p0, vector3 p1,
+                           const std::vector<entt::entity> &ignore_entities) {
+    return raycast_bodies(registry, p0, p1, ignore_entities, true);
+}
+
 shape_raycast_result shape_raycast(const box_shape &box, const raycast_context &ctx) {
     // Reference: Real-Time Collision Detection - Christer Ericson,
     // Section 5.3.3 - Intersecting Ray or Segment Against Box.
@@ -261,11 +304,24 @@ shape_raycast_result shape_raycast(const polyhedron_shape &poly, const raycast_c
     // Section 5.3.8 - Intersecting Ray or Segment Against Convex Polyhedron.
     auto p0 = to_object_space(ctx.p0, ctx.pos, ctx.orn);
     auto p1 = to_object_space(ctx.p1, ctx.pos, ctx.orn);
+    const auto &mesh = *poly.mesh;
+
+    // Reject segments which do not touch the bounding sphere before going
+    // through all faces.
+    {
+        scalar t;
+        vector3 q;
+        auto dist_sqr = closest_point_segment(p0, p1, vector3_zero, t, q);
+
+        if (dist_sqr > mesh.bounding_radius * mesh.bounding_radius) {
+            return {};
+        }
+    }
+
     auto d = p1 - p0;
     auto t0 = -EDYN_SCALAR_MAX;
     auto t1 = EDYN_SCALAR_MAX;
     auto intersect_face_idx = SIZE_MAX;
-    const auto &mesh = *poly.mesh;
 
     for (size_t face_idx = 0; face_idx < mesh.num_faces(); ++face_idx) {
         auto vertex = mesh.vertices[mesh.first_vertex_index(face_idx)];
@@ -277,7 +333,7 @@ shape_raycast_result shape_raycast(const polyhedron_shape &poly, const raycast_c
         if (std::abs(denom) < EDYN_EPSILON) {
             // Segment does not intersect polyhedron if there's any face that is
             // parallel to it and it lies in front of the face.
-            if (dist > 0) {
+            if (dist < 0) {
                 return {};
             }
         } else {
@@ -326,12 +382,17 @@ shape_raycast_result shape_raycast(const compound_shape &compound, const raycast
     shape_raycast_result result;
 
     compound.raycast(p0, p1, [&](auto &&shape, auto node_index) {
+        if (ctx.any_hit && result.fraction != EDYN_SCALAR_MAX) {
+            return;
+        }
+
         auto &node = compound.nodes[node_index];
         auto child_ctx = raycast_context{};
         child_ctx.p0 = p0;
         child_ctx.p1 = p1;
         child_ctx.pos = node.position;
         child_ctx.orn = node.orientation;
+        child_ctx.any_hit = ctx.any_hit;
         auto child_result = shape_raycast(shape, child_ctx);
 
         if (child_result.fraction < result.fraction) {
@@ -382,6 +443,10 @@ shape_raycast_result shape_raycast(const mesh_shape &mesh, const raycast_context
     shape_raycast_result result;
 
     trimesh->raycast(ctx.p0, ctx.p1, [&](auto tri_idx) {
+        if (ctx.any_hit && result.fraction != EDYN_SCALAR_MAX) {
+            return;
+        }
+
         auto vertices = trimesh->get_triangle_vertices(tri_idx);
         auto normal = trimesh->get_triangle_normal(tri_idx);
         auto t = scalar(0);
@@ -404,6 +469,10 @@ shape_raycast_result shape_raycast(const paged_mesh_shape &paged_mesh, const ray
     shape_raycast_result result;
 
     paged_mesh.trimesh->raycast_cached(ctx.p0, ctx.p1, [&](auto submesh_idx, auto tri_idx) {
+        if (ctx.any_hit && result.fraction != EDYN_SCALAR_MAX) {
+            return;
+        }
+
         auto trimesh = paged_mesh.trimesh->get_submesh(submesh_idx);
         auto vertices = trimesh->get_triangle_vertices(tri_idx);
         auto normal = trimesh->get_triangle_normal(tri_idx);
@@ -424,4 +493,33 @@ shape_raycast_result shape_raycast(const paged_mesh_shape &paged_mesh, const ray
     return result;
 }
 
+shape_raycast_result shape_raycast(const heightfield_shape &heightfield, const raycast_context &ctx) {
+    auto &hf = *heightfield.heightfield;
+    shape_raycast_result result;
+
+    hf.raycast(ctx.p0, ctx.p1, [&](uint32_t column, uint32_t row) {
+        for (uint32_t k = 0; k < 2; ++k) {
+            auto vertices = hf.get_cell_triangle_vertices(column, row, k);
+            auto normal = normalize(cross(vertices[1] - vertices[0], vertices[2] - vertices[1]));
+            auto t = scalar(0);
+
+            if (!intersect_segment_triangle(ctx.p0, ctx.p1, vertices, normal, t)) {
+                continue;
+            }
+
+            if (t < result.fraction) {
+                result.fraction = t;
+                result.normal = normal;
+                result.info_var = heightfield_raycast_info{column, row, hf.get_triangle_index(column, row, k)};
+            }
+        }
+
+        // Cells are visited in the order they are crossed thus no cell after
+        // this one can have a closer intersection.
+        return result.fraction == EDYN_SCALAR_MAX;
+    });
+
+    return result;
+}
+
 }
@@ -2,8 +2,13 @@
 #include "edyn/collision/broadphase.hpp"
 #include "edyn/context/task.hpp"
 #include "edyn/context/task_util.hpp"
+#include "edyn/context/settings.hpp"
+#include "edyn/parallel/job_dispatcher.hpp"
+#include "edyn/serialization/memory_archive.hpp"
+#include "edyn/util/aabb_util.hpp"
 #include "edyn/util/vector_util.hpp"
 #include <entt/signal/delegate.hpp>
+#include <algorithm>
 
 namespace edyn {
 
@@ -11,44 +16,123 @@ raycast_service::raycast_service(entt::registry &registry)
     : m_registry(&registry)
 {}
 
+void raycast_service::add_ray_batch(const std::vector<raycast_query> &rays, unsigned id,
+                                    std::vector<entt::entity> ignore_entities, bool any_hit) {
+    auto batch_index = m_batches.size();
+    auto &batch = m_batches.emplace_back();
+    batch.id = id;
+    batch.ignore_entities = std::move(ignore_entities);
+    batch.results.resize(rays.size());
+
+    for (unsigned i = 0; i < rays.size(); ++i) {
+        auto &ctx = m_broad_ctx.emplace_back();
+        ctx.id = i;
+        ctx.p0 = rays[i].p0;
+        ctx.p1 = rays[i].p1;
+        ctx.batch = batch_index;
+        ctx.any_hit = any_hit;
+    }
+}
+
+void raycast_service::add_shape_cast_batch(const std::vector<shape_cast_query> &queries, unsigned id,
+                                           std::vector<entt::entity> ignore_entities) {
+    auto batch_index = m_cast_batches.size();
+    auto &batch = m_cast_batches.emplace_back();
+    batch.id = id;
+    batch.ignore_entities = std::move(ignore_entities);
+    batch.results.resize(queries.size());
+
+    for (unsigned i = 0; i < queries.size(); ++i) {
+        auto &ctx = m_cast_broad_ctx.emplace_back();
+        ctx.id = i;
+        ctx.batch = batch_index;
+        ctx.query = queries[i];
+    }
+}
+
+void raycast_service::add_overlap_batch(const std::vector<overlap_query> &queries, unsigned id,
+                                        std::vector<entt::entity> ignore_entities) {
+    auto batch_index = m_overlap_batches.size();
+    auto &batch = m_overlap_batches.emplace_back();
+    batch.id = id;
+    batch.ignore_entities = std::move(ignore_entities);
+    batch.results.resize(queries.size());
+
+    for (unsigned i = 0; i < queries.size(); ++i) {
+        auto &ctx = m_overlap_broad_ctx.emplace_back();
+        ctx.id = i;
+        ctx.batch = batch_index;
+        ctx.query = queries[i];
+    }
+}
+
+bool raycast_service::is_ignored(const broadphase_context &ctx, entt::entity entity) const {
+    if (ctx.batch != no_batch) {
+        return vector_contains(m_batches[ctx.batch].ignore_entities, entity);
+    }
+
+    return vector_contains(ctx.ignore_entities, entity);
+}
+
+raycast_result & raycast_service::get_result(unsigned id, size_t batch) {
+    if (batch != no_batch) {
+        return m_batches[batch].results[id];
+    }
+
+    return m_results[id];
+}
+
+void raycast_service::make_packets() {
+    m_packets.clear();
+
+    for (size_t i = 0; i < m_broad_ctx.size(); ++i) {
+        auto batch = m_broad_ctx[i].batch;
+
+        // Rays in a batch usually come from the same sensor or weapon and
+        // are thus coherent. Single rays are queried on their own.
+        if (batch != no_batch && !m_packets.empty()) {
+            auto &last = m_packets.back();
+            auto &last_ctx = m_broad_ctx[last.first];
+
+            if (last_ctx.batch == batch && last.count < simd_width) {
+                ++last.count;
+                continue;
+            }
+        }
+
+        m_packets.push_back(packet_range{i, 1});
+    }
+}
+
 void raycast_service::run_broadphase(bool mt) {
-    auto &bphase = m_registry->ctx().get<broadphase>();
+    make_packets();
 
     if (mt && m_broad_ctx.size() > m_max_raycast_broadphase_sequential_size) {
-        auto *raycasts = &m_broad_ctx;
-
-        auto task_func = [raycasts, &bphase](unsigned start, unsigned end) {
-            for (auto index = start; index < end; ++index) {
-                auto &ctx = (*raycasts)[index];
-                bphase.raycast(ctx.p0, ctx.p1, [&](entt::entity entity) {
-                    if (!vector_contains(ctx.ignore_entities, entity)) {
-                        ctx.candidates.push_back(entity);
-                    }
-                });
+        parallel_for_each_range(*m_registry, m_packets, [this](auto *first, auto *last, unsigned) {
+            for (; first != last; ++first) {
+                query_broadphase(*first);
             }
-        };
-
-        auto task = task_delegate_t(entt::connect_arg_t<&decltype(task_func)::operator()>{}, task_func);
-        enqueue_task_wait(*m_registry, task, m_broad_ctx.size());
+        });
     } else {
-        for (auto &ctx : m_broad_ctx) {
-            bphase.raycast(ctx.p0, ctx.p1, [&](entt::entity entity) {
-                if (!vector_contains(ctx.ignore_entities, entity)) {
-                    ctx.candidates.push_back(entity);
-                }
-            });
+        for (auto &packet : m_packets) {
+            query_broadphase(packet);
         }
     }
 }
 
 void raycast_service::finish_broadphase() {
     for (auto &ctx : m_broad_ctx) {
+        // Rays which hit nothing also get a result.
+        get_result(ctx.id, ctx.batch);
+
         for (auto entity : ctx.candidates) {
             auto &narrow_ctx = m_narrow_ctx.emplace_back();
             narrow_ctx.id = ctx.id;
             narrow_ctx.p0 = ctx.p0;
             narrow_ctx.p1 = ctx.p1;
             narrow_ctx.entity = entity;
+            narrow_ctx.batch = ctx.batch;
+            narrow_ctx.any_hit = ctx.any_hit;
         }
     }
 
@@ -62,26 +146,22 @@ void raycast_service::run_narrowphase(bool mt) {
     auto shape_views_tuple = get_tuple_of_shape_views(*m_registry);
 
     if (mt && m_narrow_ctx.size() > m_max_raycast_narrowphase_sequential_size) {
-        auto *ctxes = &m_narrow_ctx;
-
-        auto task_func = [ctxes, index_view, origin_view, tr_view, shape_views_tuple](unsigned start, unsigned end) {
-            for (auto index = start; index < end; ++index) {
-                auto &ctx = (*ctxes)[index];
+        parallel_for_each_range(*m_registry, m_narrow_ctx,
+                                [index_view, origin_view, tr_view, shape_views_tuple](auto *first, auto *last, unsigned) {
+            for (; first != last; ++first) {
+                auto &ctx = *first;
 
                 auto sh_idx = index_view.get<shape_index>(ctx.entity);
                 auto pos = origin_view.contains(ctx.entity) ?
                     static_cast<vector3>(origin_view.get<origin>(ctx.entity)) : tr_view.get<position>(ctx.entity);
                 auto orn = tr_view.get<orientation>(ctx.entity);
-                auto ray_ctx = raycast_context{pos, orn, ctx.p0, ctx.p1};
+                auto ray_ctx = raycast_context{pos, orn, ctx.p0, ctx.p1, ctx.any_hit};
 
                 visit_shape(sh_idx, ctx.entity, shape_views_tuple, [&](auto &&shape) {
                     ctx.result = shape_raycast(shape, ray_ctx);
                 });
             }
-        };
-
-        auto task = task_delegate_t(entt::connect_arg_t<&decltype(task_func)::operator()>{}, task_func);
-        enqueue_task_wait(*m_registry, task, m_narrow_ctx.size());
+        });
     } else {
         auto index_view = m_registry->view<shape_index>();
         auto tr_view = m_registry->view<position, orientation>();
@@ -93,7 +173,7 @@ void raycast_service::run_narrowphase(bool mt) {
             auto pos = origin_view.contains(ctx.entity) ?
                 static_cast<vector3>(origin_view.get<origin>(ctx.entity)) : tr_view.get<position>(ctx.entity);
             auto orn = tr_view.get<orientation>(ctx.entity);
-            auto ray_ctx = raycast_context{pos, orn, ctx.p0, ctx.p1};
+            auto ray_ctx = raycast_context{pos, orn, ctx.p0, ctx.p1, ctx.any_hit};
 
             visit_shape(sh_idx, ctx.entity, shape_views_tuple, [&](auto &&shape) {
                 ctx.result = shape_raycast(shape, ray_ctx);
@@ -104,7 +184,7 @@ void raycast_service::run_narrowphase(bool mt) {
 
 void raycast_service::finish_narrowphase() {
     for (auto &ctx : m_narrow_ctx) {
-        auto &res = m_results[ctx.id];
+        auto &res = get_result(ctx.id, ctx.batch);
 
         if (ctx.result.fraction < res.fraction) {
             res = ctx.result;
@@ -115,11 +195,385 @@ void raycast_service::finish_narrowphase() {
     m_narrow_ctx.clear();
 }
 
-void raycast_service::update(bool mt) {
+static job make_ray_job(raycast_service *service, size_t index, job::function_type *func) {
+    auto j = job();
+    j.func = func;
+    auto archive = fixed_memory_output_archive(j.data.data(), j.data.size());
+    auto service_ptr = reinterpret_cast<intptr_t>(service);
+    auto ctx_index = static_cast<uint64_t>(index);
+    archive(service_ptr);
+    archive(ctx_index);
+    return j;
+}
+
+template<typename Func>
+static void invoke_ray_job(job::data_type &data, Func func) {
+    auto archive = memory_input_archive(data.data(), data.size());
+    intptr_t service_ptr;
+    uint64_t ctx_index;
+    archive(service_ptr);
+    archive(ctx_index);
+    func(reinterpret_cast<raycast_service *>(service_ptr), static_cast<size_t>(ctx_index));
+}
+
+void raycast_service::query_broadphase(broadphase_context &ctx) {
+    auto &bphase = m_registry->ctx().get<broadphase>();
+    bphase.raycast(ctx.p0, ctx.p1, [&](entt::entity entity) {
+        if (!is_ignored(ctx, entity)) {
+            ctx.candidates.push_back(entity);
+        }
+    });
+}
+
+void raycast_service::query_broadphase(const packet_range &range) {
+    if (range.count == 1) {
+        query_broadphase(m_broad_ctx[range.first]);
+        return;
+    }
+
+    auto packet = ray_packet{};
+
+    for (size_t i = 0; i < range.count; ++i) {
+        auto &ctx = m_broad_ctx[range.first + i];
+        packet.add(ctx.p0, ctx.p1);
+    }
+
+    // Candidates are only collected in the broadphase thus no lane is ever
+    // clipped nor terminated.
+    auto &bphase = m_registry->ctx().get<broadphase>();
+    bphase.raycast(packet, [&](entt::entity entity, unsigned mask) {
+        for (unsigned lane = 0; lane < range.count; ++lane) {
+            if (!(mask & (1u << lane))) {
+                continue;
+            }
+
+            auto &ctx = m_broad_ctx[range.first + lane];
+
+            if (!is_ignored(ctx, entity)) {
+                ctx.candidates.push_back(entity);
+            }
+        }
+    });
+}
+
+void raycast_service::raycast_candidates(broadphase_context &ctx) {
+    auto index_view = m_registry->view<shape_index>();
+    auto tr_view = m_registry->view<position, orientation>();
+    auto origin_view = m_registry->view<origin>();
+    auto shape_views_tuple = get_tuple_of_shape_views(*m_registry);
+
+    for (auto entity : ctx.candidates) {
+        if (ctx.any_hit && ctx.entity != entt::null) {
+            break;
+        }
+
+        auto sh_idx = index_view.get<shape_index>(entity);
+        auto pos = origin_view.contains(entity) ?
+            static_cast<vector3>(origin_view.get<origin>(entity)) : tr_view.get<position>(entity);
+        auto orn = tr_view.get<orientation>(entity);
+        auto ray_ctx = raycast_context{pos, orn, ctx.p0, ctx.p1, ctx.any_hit};
+
+        visit_shape(sh_idx, entity, shape_views_tuple, [&](auto &&shape) {
+            auto result = shape_raycast(shape, ray_ctx);
+
+            if (result.fraction < ctx.result.fraction) {
+                ctx.result = result;
+                ctx.entity = entity;
+            }
+        });
+    }
+}
+
+void raycast_service::query_broadphase_job(job::data_type &data) {
+    invoke_ray_job(data, [](raycast_service *service, size_t index) {
+        service->query_broadphase(service->m_packets[index]);
+    });
+}
+
+void raycast_service::raycast_candidates_job(job::data_type &data) {
+    invoke_ray_job(data, [](raycast_service *service, size_t index) {
+        service->raycast_candidates(service->m_broad_ctx[index]);
+    });
+}
+
+void raycast_service::run_task_graph() {
+    // Create the views in this thread before running the tasks since views
+    // create the storage of their components if it does not exist yet.
+    m_registry->view<shape_index>();
+    m_registry->view<position, orientation>();
+    m_registry->view<origin>();
+    get_tuple_of_shape_views(*m_registry);
+
+    m_graph.clear();
+    make_packets();
+
+    for (size_t i = 0; i < m_packets.size(); ++i) {
+        auto query = m_graph.add_task(make_ray_job(this, i, &raycast_service::query_broadphase_job));
+        auto &range = m_packets[i];
+
+        for (auto j = range.first; j < range.first + range.count; ++j) {
+            auto cast = m_graph.add_task(make_ray_job(this, j, &raycast_service::raycast_candidates_job));
+            m_graph.precede(query, cast);
+        }
+    }
+
+    m_graph.run(job_dispatcher::current());
+
+    for (auto &ctx : m_broad_ctx) {
+        auto &res = get_result(ctx.id, ctx.batch);
+
+        if (ctx.result.fraction < res.fraction) {
+            res = ctx.result;
+            res.entity = ctx.entity;
+        }
+    }
+
+    m_broad_ctx.clear();
+}
+
+void raycast_service::update_rays(bool mt) {
+    // The task graph runs on the job dispatcher, thus it can only be used if
+    // the default task scheduler is in use.
+    auto &settings = m_registry->ctx().get<edyn::settings>();
+
+    if (mt && settings.enqueue_task_wait == &enqueue_task_wait_default &&
+        m_broad_ctx.size() > m_max_raycast_broadphase_sequential_size) {
+        run_task_graph();
+        return;
+    }
+
     run_broadphase(mt);
     finish_broadphase();
     run_narrowphase(mt);
     finish_narrowphase();
 }
 
+// The AABB swept by the shape of a cast, which contains all AABBs the shape
+// could touch.
+static AABB shape_cast_aabb(const shape_cast_query &query) {
+    return std::visit([&](auto &&shape) {
+        return enclosing_aabb(shape_aabb(shape, query.p0, query.orn),
+                              shape_aabb(shape, query.p1, query.orn));
+    }, query.shape);
+}
+
+void raycast_service::run_cast_broadphase(bool mt) {
+    auto &bphase = m_registry->ctx().get<broadphase>();
+
+    auto query = [this, &bphase](cast_broadphase_context &ctx) {
+        auto &ignore_entities = m_cast_batches[ctx.batch].ignore_entities;
+        auto aabb = shape_cast_aabb(ctx.query);
+        auto add_candidate = [&](entt::entity entity) {
+            if (!vector_contains(ignore_entities, entity)) {
+                ctx.candidates.push_back(entity);
+            }
+        };
+
+        bphase.query_procedural(aabb, add_candidate);
+        bphase.query_non_procedural(aabb, add_candidate);
+    };
+
+    if (mt && m_cast_broad_ctx.size() > m_max_raycast_broadphase_sequential_size) {
+        parallel_for_each_range(*m_registry, m_cast_broad_ctx, [&query](auto *first, auto *last, unsigned) {
+            for (; first != last; ++first) {
+                query(*first);
+            }
+        });
+    } else {
+        for (auto &ctx : m_cast_broad_ctx) {
+            query(ctx);
+        }
+    }
+}
+
+void raycast_service::finish_cast_broadphase() {
+    for (auto &ctx : m_cast_broad_ctx) {
+        for (auto entity : ctx.candidates) {
+            auto &narrow_ctx = m_cast_narrow_ctx.emplace_back();
+            narrow_ctx.id = ctx.id;
+            narrow_ctx.batch = ctx.batch;
+            narrow_ctx.query = ctx.query;
+            narrow_ctx.entity = entity;
+        }
+    }
+
+    m_cast_broad_ctx.clear();
+}
+
+void raycast_service::run_cast_narrowphase(bool mt) {
+    auto index_view = m_registry->view<shape_index>();
+    auto tr_view = m_registry->view<position, orientation>();
+    auto origin_view = m_registry->view<origin>();
+    auto shape_views_tuple = get_tuple_of_shape_views(*m_registry);
+
+    auto cast = [&](cast_narrowphase_context &ctx) {
+        auto sh_idx = index_view.get<shape_index>(ctx.entity);
+        auto pos = origin_view.contains(ctx.entity) ?
+            static_cast<vector3>(origin_view.get<origin>(ctx.entity)) : tr_view.get<position>(ctx.entity);
+        auto orn = tr_view.get<orientation>(ctx.entity);
+        auto cast_ctx = shape_cast_context{pos, orn, ctx.query};
+
+        visit_shape(sh_idx, ctx.entity, shape_views_tuple, [&](auto &&shape) {
+            ctx.result = shape_cast(shape, cast_ctx);
+        });
+    };
+
+    if (mt && m_cast_narrow_ctx.size() > m_max_raycast_narrowphase_sequential_size) {
+        parallel_for_each_range(*m_registry, m_cast_narrow_ctx, [&cast](auto *first, auto *last, unsigned) {
+            for (; first != last; ++first) {
+                cast(*first);
+            }
+        });
+    } else {
+        for (auto &ctx : m_cast_narrow_ctx) {
+            cast(ctx);
+        }
+    }
+}
+
+void raycast_service::finish_cast_narrowphase() {
+    for (auto &ctx : m_cast_narrow_ctx) {
+        auto &res = m_cast_batches[ctx.batch].results[ctx.id];
+
+        if (ctx.result.fraction < res.fraction) {
+            res = ctx.result;
+            res.entity = ctx.entity;
+        }
+    }
+
+    m_cast_narrow_ctx.clear();
+}
+
+void raycast_service::update_shape_casts(bool mt) {
+    if (m_cast_broad_ctx.empty()) {
+        return;
+    }
+
+    run_cast_broadphase(mt);
+    finish_cast_broadphase();
+    run_cast_narrowphase(mt);
+    finish_cast_narrowphase();
+}
+
+// The AABB of the shape of an overlap query inflated by the maximum
+// distance, which contains all AABBs within reach.
+static AABB overlap_aabb(const overlap_query &query) {
+    return std::visit([&](auto &&shape) {
+        return shape_aabb(shape, query.pos, query.orn).inset(vector3_one * -query.max_distance);
+    }, query.shape);
+}
+
+void raycast_service::run_overlap_broadphase(bool mt) {
+    auto &bphase = m_registry->ctx().get<broadphase>();
+
+    auto query = [this, &bphase](overlap_broadphase_context &ctx) {
+        auto &ignore_entities = m_overlap_batches[ctx.batch].ignore_entities;
+        auto aabb = overlap_aabb(ctx.query);
+        auto add_candidate = [&](entt::entity entity) {
+            if (!vector_contains(ignore_entities, entity)) {
+                ctx.candidates.push_back(entity);
+            }
+        };
+
+        bphase.query_procedural(aabb, add_candidate);
+        bphase.query_non_procedural(aabb, add_candidate);
+    };
+
+    if (mt && m_overlap_broad_ctx.size() > m_max_raycast_broadphase_sequential_size) {
+        parallel_for_each_range(*m_registry, m_overlap_broad_ctx, [&query](auto *first, auto *last, unsigned) {
+            for (; first != last; ++first) {
+                query(*first);
+            }
+        });
+    } else {
+        for (auto &ctx : m_overlap_broad_ctx) {
+            query(ctx);
+        }
+    }
+}
+
+void raycast_service::finish_overlap_broadphase() {
+    for (auto &ctx : m_overlap_broad_ctx) {
+        for (auto entity : ctx.candidates) {
+            auto &narrow_ctx = m_overlap_narrow_ctx.emplace_back();
+            narrow_ctx.id = ctx.id;
+            narrow_ctx.batch = ctx.batch;
+            narrow_ctx.query = ctx.query;
+            narrow_ctx.entity = entity;
+        }
+    }
+
+    m_overlap_broad_ctx.clear();
+}
+
+void raycast_service::run_overlap_narrowphase(bool mt) {
+    auto index_view = m_registry->view<shape_index>();
+    auto tr_view = m_registry->view<position, orientation>();
+    auto origin_view = m_registry->view<origin>();
+    auto shape_views_tuple = get_tuple_of_shape_views(*m_registry);
+
+    auto test = [&](overlap_narrowphase_context &ctx) {
+        auto sh_idx = index_view.get<shape_index>(ctx.entity);
+        auto pos = origin_view.contains(ctx.entity) ?
+            static_cast<vector3>(origin_view.get<origin>(ctx.entity)) : tr_view.get<position>(ctx.entity);
+        auto orn = tr_view.get<orientation>(ctx.entity);
+        auto overlap_ctx = overlap_context{pos, orn, ctx.query};
+
+        visit_shape(sh_idx, ctx.entity, shape_views_tuple, [&](auto &&shape) {
+            ctx.hit = overlap(shape, overlap_ctx);
+        });
+    };
+
+    if (mt && m_overlap_narrow_ctx.size() > m_max_raycast_narrowphase_sequential_size) {
+        parallel_for_each_range(*m_registry, m_overlap_narrow_ctx, [&test](auto *first, auto *last, unsigned) {
+            for (; first != last; ++first) {
+                test(*first);
+            }
+        });
+    } else {
+        for (auto &ctx : m_overlap_narrow_ctx) {
+            test(ctx);
+        }
+    }
+}
+
+void raycast_service::finish_overlap_narrowphase() {
+    for (auto &ctx : m_overlap_narrow_ctx) {
+        if (ctx.hit.distance == EDYN_SCALAR_MAX) {
+            continue;
+        }
+
+        auto &res = m_overlap_batches[ctx.batch].results[ctx.id];
+        auto &hit = res.hits.emplace_back(ctx.hit);
+        hit.entity = ctx.entity;
+    }
+
+    m_overlap_narrow_ctx.clear();
+
+    for (auto &batch : m_overlap_batches) {
+        for (auto &res : batch.results) {
+            std::sort(res.hits.begin(), res.hits.end(), [](auto &lhs, auto &rhs) {
+                return lhs.distance < rhs.distance;
+            });
+        }
+    }
+}
+
+void raycast_service::update_overlaps(bool mt) {
+    if (m_overlap_broad_ctx.empty()) {
+        return;
+    }
+
+    run_overlap_broadphase(mt);
+    finish_overlap_broadphase();
+    run_overlap_narrowphase(mt);
+    finish_overlap_narrowphase();
+}
+
+void raycast_service::update(bool mt) {
+    update_rays(mt);
+    update_shape_casts(mt);
+    update_overlaps(mt);
+}
+
 }
@@ -0,0 +1,59 @@
+#include "edyn/collision/sensor.hpp"
+#include "edyn/collision/collide.hpp"
+#include "edyn/comp/aabb.hpp"
+#include "edyn/comp/origin.hpp"
+#include "edyn/comp/orientation.hpp"
+#include "edyn/comp/position.hpp"
+#include "edyn/comp/shape_index.hpp"
+#include "edyn/config/constants.hpp"
+#include "edyn/shapes/shapes.hpp"
+#include <entt/entity/registry.hpp>
+
+namespace edyn {
+
+const std::vector<sensor_event> & get_sensor_events(const entt::registry &registry) {
+    return registry.ctx().get<sensor_event_buffer>().events;
+}
+
+}
+
+namespace edyn::internal {
+
+static vector3 get_collision_position(entt::registry &registry, entt::entity entity) {
+    if (auto *orig = registry.try_get<origin>(entity)) {
+        return static_cast<vector3>(*orig);
+    }
+
+    return registry.get<position>(entity);
+}
+
+bool sensor_shapes_intersect(entt::registry &registry, entt::entity sensor, entt::entity other) {
+    auto ctx = collision_context{};
+    ctx.posA = get_collision_position(registry, sensor);
+    ctx.ornA = registry.get<orientation>(sensor);
+    ctx.aabbA = registry.get<AABB>(sensor);
+    ctx.posB = get_collision_position(registry, other);
+    ctx.ornB = registry.get<orientation>(other);
+    ctx.aabbB = registry.get<AABB>(other);
+    // Some collision functions rely on the threshold to find the features
+    // near the contact, thus only count points which penetrate.
+    ctx.threshold = contact_breaking_threshold;
+
+    auto result = collision_result{};
+
+    visit_shape(registry, sensor, [&](auto &&shA) {
+        visit_shape(registry, other, [&](auto &&shB) {
+            collide(shA, shB, ctx, result);
+        });
+    });
+
+    for (size_t i = 0; i < result.num_points; ++i) {
+        if (result.point[i].distance <= 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+}
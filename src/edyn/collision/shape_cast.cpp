@@ -0,0 +1,146 @@
+#include "edyn/collision/shape_cast.hpp"
+#include "edyn/collision/collide.hpp"
+#include "edyn/collision/raycast_service.hpp"
+#include "edyn/config/constants.hpp"
+#include "edyn/context/settings.hpp"
+#include "edyn/math/transform.hpp"
+#include "edyn/simulation/stepper_async.hpp"
+#include "edyn/util/aabb_util.hpp"
+#include <entt/entity/registry.hpp>
+#include <type_traits>
+
+namespace edyn {
+
+shape_cast_result shape_cast(entt::registry &registry, const shape_cast_query &query,
+                             const std::vector<entt::entity> &ignore_entities) {
+    return shape_cast_batch(registry, {query}, ignore_entities).front();
+}
+
+std::vector<shape_cast_result> shape_cast_batch(entt::registry &registry,
+                                                const std::vector<shape_cast_query> &queries,
+                                                const std::vector<entt::entity> &ignore_entities) {
+    auto &settings = registry.ctx().get<edyn::settings>();
+    auto mt = settings.execution_mode == execution_mode::sequential_multithreaded;
+
+    // Goes through the same stages the simulation worker runs the shape
+    // casts requested asynchronously in.
+    auto service = raycast_service(registry);
+    service.add_shape_cast_batch(queries, 0, ignore_entities);
+    service.update(mt);
+
+    auto results = std::vector<shape_cast_result>{};
+    service.consume_shape_cast_results([&](unsigned, std::vector<shape_cast_result> &batch_results) {
+        results = std::move(batch_results);
+    });
+
+    return results;
+}
+
+shape_cast_id_type shape_cast_async(entt::registry &registry, const shape_cast_query &query,
+                                    const shape_cast_delegate_type &delegate,
+                                    const std::vector<entt::entity> &ignore_entities) {
+    auto &stepper = registry.ctx().get<stepper_async>();
+    return stepper.shape_cast(query, delegate, ignore_entities);
+}
+
+shape_cast_id_type shape_cast_batch_async(entt::registry &registry, std::vector<shape_cast_query> queries,
+                                          const shape_cast_batch_delegate_type &delegate,
+                                          const std::vector<entt::entity> &ignore_entities) {
+    auto &stepper = registry.ctx().get<stepper_async>();
+    return stepper.shape_cast_batch(std::move(queries), delegate, ignore_entities);
+}
+
+template<typename Shape>
+static constexpr bool is_convex_cast_target() {
+    return !std::is_same_v<Shape, mesh_shape> &&
+           !std::is_same_v<Shape, paged_mesh_shape> &&
+           !std::is_same_v<Shape, heightfield_shape> &&
+           !std::is_same_v<Shape, compound_shape>;
+}
+
+template<typename CastShape, typename Shape>
+static shape_cast_result sweep_shape(const CastShape &cast_shape, const Shape &shape,
+                                     const shape_cast_context &ctx) {
+    auto &query = ctx.query;
+    auto delta = query.p1 - query.p0;
+    auto dist = length(delta);
+    auto aabbB = shape_aabb(shape, ctx.pos, ctx.orn);
+    auto aabb_end = shape_aabb(cast_shape, query.p1, query.orn);
+    auto fraction = scalar(0);
+
+    for (unsigned i = 0; i < shape_cast_max_iterations; ++i) {
+        // Find the closest points within the remainder of the sweep. Using
+        // the AABB of the remainder of the sweep makes the collision
+        // functions visit all parts of concave shapes that could be hit.
+        auto posA = query.p0 + delta * fraction;
+        auto aabbA = enclosing_aabb(shape_aabb(cast_shape, posA, query.orn), aabb_end);
+        auto threshold = dist * (1 - fraction) + shape_cast_tolerance;
+        auto col_ctx = collision_context{posA, query.orn, aabbA, ctx.pos, ctx.orn, aabbB, threshold};
+        auto col_result = collision_result{};
+        collide(cast_shape, shape, col_ctx, col_result);
+
+        if (col_result.num_points == 0) {
+            return {};
+        }
+
+        auto *closest = &col_result.point[0];
+
+        for (size_t j = 1; j < col_result.num_points; ++j) {
+            if (col_result.point[j].distance < closest->distance) {
+                closest = &col_result.point[j];
+            }
+        }
+
+        if (closest->distance <= shape_cast_tolerance || i + 1 == shape_cast_max_iterations) {
+            auto result = shape_cast_result{};
+            result.fraction = fraction;
+            result.normal = closest->normal;
+            result.point = to_world_space(closest->pivotB, ctx.pos, ctx.orn);
+            return result;
+        }
+
+        // The distance can't shrink faster than the swept shape moves. If the
+        // other shape is convex, the plane orthogonal to the normal through
+        // the closest point separates them, thus only the motion towards the
+        // plane counts, which converges much faster.
+        scalar approach;
+
+        if constexpr(is_convex_cast_target<Shape>()) {
+            approach = -dot(delta, closest->normal);
+        } else {
+            approach = dist;
+        }
+
+        if (approach < EDYN_EPSILON) {
+            return {};
+        }
+
+        fraction += closest->distance / approach;
+
+        if (fraction > 1) {
+            return {};
+        }
+    }
+
+    return {};
+}
+
+template<typename Shape>
+shape_cast_result shape_cast(const Shape &shape, const shape_cast_context &ctx) {
+    return std::visit([&](auto &&cast_shape) {
+        return sweep_shape(cast_shape, shape, ctx);
+    }, ctx.query.shape);
+}
+
+template shape_cast_result shape_cast(const plane_shape &, const shape_cast_context &);
+template shape_cast_result shape_cast(const sphere_shape &, const shape_cast_context &);
+template shape_cast_result shape_cast(const cylinder_shape &, const shape_cast_context &);
+template shape_cast_result shape_cast(const capsule_shape &, const shape_cast_context &);
+template shape_cast_result shape_cast(const box_shape &, const shape_cast_context &);
+template shape_cast_result shape_cast(const polyhedron_shape &, const shape_cast_context &);
+template shape_cast_result shape_cast(const compound_shape &, const shape_cast_context &);
+template shape_cast_result shape_cast(const mesh_shape &, const shape_cast_context &);
+template shape_cast_result shape_cast(const paged_mesh_shape &, const shape_cast_context &);
+template shape_cast_result shape_cast(const heightfield_shape &, const shape_cast_context &);
+
+}
@@ -25,35 +25,20 @@ bool should_collide_default(const entt::registry &registry, entt::entity first,
         return false;
     }
 
+    // Entities without a filter use the default group and mask values.
     auto filter_view = registry.view<collision_filter>();
-    auto first_has_filter = filter_view.contains(first);
-    auto second_has_filter = filter_view.contains(second);
+    auto filter0 = filter_view.contains(first) ? std::get<0>(filter_view.get(first)) : collision_filter{};
+    auto filter1 = filter_view.contains(second) ? std::get<0>(filter_view.get(second)) : collision_filter{};
 
-    if (first_has_filter && second_has_filter) {
-        auto [filter0] = filter_view.get(first);
-        auto [filter1] = filter_view.get(second);
-
-        if ((filter0.group & filter1.mask) == 0 ||
-            (filter1.group & filter0.mask) == 0) {
-            return false;
-        }
-    } else if (first_has_filter || second_has_filter) {
-        // If only one of them has a filter, use the default group and mask
-        // values for the other.
-        auto filter = first_has_filter ? std::get<0>(filter_view.get(first)) : std::get<0>(filter_view.get(second));
-
-        if ((filter.group & collision_filter::all_groups) == 0 ||
-            (filter.mask & collision_filter::all_groups) == 0) {
-            return false;
-        }
-    }
-
-    if (should_exclude(registry, first, second) ||
-        should_exclude(registry, second, first)) {
+    if (!collision_filter_test(filter0, filter1)) {
         return false;
     }
 
-    return true;
+    return !is_collision_excluded(registry, first, second);
+}
+
+bool is_collision_excluded(const entt::registry &registry, entt::entity first, entt::entity second) {
+    return should_exclude(registry, first, second) || should_exclude(registry, second, first);
 }
 
 void set_should_collide(entt::registry &registry, should_collide_func_t func) {
@@ -65,7 +50,9 @@ void set_should_collide(entt::registry &registry, should_collide_func_t func) {
     }
 
     if (auto *ctx = registry.ctx().find<client_network_context>()) {
-        ctx->extrapolator->set_settings(settings);
+        for (auto &extrapolator : ctx->extrapolators) {
+            extrapolator->set_settings(settings);
+        }
     }
 }
 
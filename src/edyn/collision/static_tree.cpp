@@ -0,0 +1,301 @@
+#include "edyn/collision/static_tree.hpp"
+#include <entt/signal/delegate.hpp>
+#include <array>
+#include <limits>
+
+namespace edyn {
+
+// Number of bins along each axis where split candidates are evaluated.
+static constexpr size_t sah_num_bins = 16;
+
+// Subtrees with up to this many objects are built by a single task.
+static constexpr uint32_t sah_min_subtree_size = 4096;
+
+struct sah_build_context {
+    const std::vector<AABB> &aabbs;
+    const std::vector<vector3> &centroids;
+    std::vector<uint32_t> &ids;
+    uint32_t max_obj_per_leaf;
+};
+
+struct sah_split {
+    // Bounds of all objects in the range.
+    AABB aabb;
+    // Start of the range of the second child. Equals the end of the range
+    // if it should be a leaf.
+    uint32_t mid;
+};
+
+// Subtree to be built in a separate task and then moved into the tree. The
+// root of the subtree takes the place of node `node` of the tree.
+struct sah_subtree_task {
+    uint32_t first;
+    uint32_t last;
+    uint32_t node;
+    std::vector<static_tree::tree_node> nodes;
+    std::vector<detail::static_tree_leaf_range> leaves;
+};
+
+static size_t sah_bin_index(scalar c, scalar origin, scalar scale) {
+    return std::min(static_cast<size_t>((c - origin) * scale), sah_num_bins - 1);
+}
+
+static sah_split find_sah_split(const sah_build_context &ctx, uint32_t first, uint32_t last) {
+    auto &ids = ctx.ids;
+    auto set_aabb = ctx.aabbs[ids[first]];
+    auto centroid_aabb = AABB{ctx.centroids[ids[first]], ctx.centroids[ids[first]]};
+
+    for (auto i = first + 1; i < last; ++i) {
+        auto &c = ctx.centroids[ids[i]];
+        set_aabb = enclosing_aabb(set_aabb, ctx.aabbs[ids[i]]);
+        centroid_aabb.min = min(centroid_aabb.min, c);
+        centroid_aabb.max = max(centroid_aabb.max, c);
+    }
+
+    auto count = last - first;
+    auto result = sah_split{set_aabb, last};
+
+    if (count == 1) {
+        return result;
+    }
+
+    // Find the split with the lowest sum of area times number of objects of
+    // both sides over all bins of all axes.
+    auto best_cost = std::numeric_limits<scalar>::max();
+    auto best_axis = size_t(3);
+    auto best_bin = size_t(0);
+
+    for (size_t axis = 0; axis < 3; ++axis) {
+        auto extent = centroid_aabb.max[axis] - centroid_aabb.min[axis];
+
+        if (!(extent > 0)) {
+            continue;
+        }
+
+        auto scale = scalar(sah_num_bins) / extent;
+        std::array<AABB, sah_num_bins> bin_aabbs;
+        std::array<uint32_t, sah_num_bins> bin_counts {};
+
+        for (auto i = first; i < last; ++i) {
+            auto &aabb = ctx.aabbs[ids[i]];
+            auto bin = sah_bin_index(ctx.centroids[ids[i]][axis], centroid_aabb.min[axis], scale);
+            bin_aabbs[bin] = bin_counts[bin] == 0 ? aabb : enclosing_aabb(bin_aabbs[bin], aabb);
+            ++bin_counts[bin];
+        }
+
+        // Sweep from the right to obtain the area and number of objects on
+        // the right side of each split.
+        std::array<scalar, sah_num_bins> right_areas;
+        std::array<uint32_t, sah_num_bins> right_counts;
+        AABB right_aabb;
+        uint32_t right_count = 0;
+
+        for (auto bin = sah_num_bins - 1; bin > 0; --bin) {
+            if (bin_counts[bin] > 0) {
+                right_aabb = right_count == 0 ? bin_aabbs[bin] : enclosing_aabb(right_aabb, bin_aabbs[bin]);
+                right_count += bin_counts[bin];
+            }
+
+            right_counts[bin] = right_count;
+            right_areas[bin] = right_count > 0 ? right_aabb.area() : scalar(0);
+        }
+
+        AABB left_aabb;
+        uint32_t left_count = 0;
+
+        for (size_t bin = 0; bin < sah_num_bins - 1; ++bin) {
+            if (bin_counts[bin] > 0) {
+                left_aabb = left_count == 0 ? bin_aabbs[bin] : enclosing_aabb(left_aabb, bin_aabbs[bin]);
+                left_count += bin_counts[bin];
+            }
+
+            // Split between this bin and the next.
+            if (left_count == 0 || right_counts[bin + 1] == 0) {
+                continue;
+            }
+
+            auto cost = left_aabb.area() * scalar(left_count) +
+                        right_areas[bin + 1] * scalar(right_counts[bin + 1]);
+
+            if (cost < best_cost) {
+                best_cost = cost;
+                best_axis = axis;
+                best_bin = bin;
+            }
+        }
+    }
+
+    if (best_axis == 3) {
+        // All centroids coincide. Split in half if there are too many objects.
+        if (count > ctx.max_obj_per_leaf) {
+            result.mid = first + count / 2;
+        }
+
+        return result;
+    }
+
+    // Compare the cost of splitting, which includes the cost of traversing
+    // this node, with the cost of testing all objects in a leaf.
+    auto parent_area = set_aabb.area();
+    auto split_cost = scalar(1) + (parent_area > 0 ? best_cost / parent_area : scalar(0));
+    auto leaf_cost = scalar(count);
+
+    if (count <= ctx.max_obj_per_leaf && leaf_cost <= split_cost) {
+        return result;
+    }
+
+    auto origin = centroid_aabb.min[best_axis];
+    auto scale = scalar(sah_num_bins) / (centroid_aabb.max[best_axis] - origin);
+    auto it = std::partition(ids.begin() + first, ids.begin() + last, [&](uint32_t id) {
+        return sah_bin_index(ctx.centroids[id][best_axis], origin, scale) <= best_bin;
+    });
+    result.mid = static_cast<uint32_t>(std::distance(ids.begin(), it));
+    EDYN_ASSERT(result.mid > first && result.mid < last);
+
+    return result;
+}
+
+// Builds the subtree for the range of ids with its root at `node_idx`. If
+// `tasks` is not null, subranges with up to `task_size` objects are not
+// built and are added to it instead. `Nodes` is the node array of the tree or
+// a `std::vector` of nodes for the subtree of a task.
+template<typename Nodes>
+static void build_sah_subtree(const sah_build_context &ctx, uint32_t first, uint32_t last,
+                              Nodes &nodes, uint32_t node_idx,
+                              std::vector<detail::static_tree_leaf_range> &leaves,
+                              std::vector<sah_subtree_task> *tasks, uint32_t task_size) {
+    if (tasks && last - first <= task_size) {
+        auto &task = tasks->emplace_back();
+        task.first = first;
+        task.last = last;
+        task.node = node_idx;
+        return;
+    }
+
+    auto split = find_sah_split(ctx, first, last);
+    nodes[node_idx].aabb = split.aabb;
+
+    if (split.mid == last) {
+        nodes[node_idx].child1 = EDYN_NULL_NODE;
+        leaves.push_back({node_idx, first, last});
+        return;
+    }
+
+    auto child1 = static_cast<uint32_t>(nodes.size());
+    auto child2 = child1 + 1;
+    nodes[node_idx].child1 = child1;
+    nodes[node_idx].child2 = child2;
+    nodes.emplace_back();
+    nodes.emplace_back();
+
+    build_sah_subtree(ctx, first, split.mid, nodes, child1, leaves, tasks, task_size);
+    build_sah_subtree(ctx, split.mid, last, nodes, child2, leaves, tasks, task_size);
+}
+
+void static_tree::build_sah_nodes(const std::vector<AABB> &aabbs, std::vector<uint32_t> &ids,
+                                  uint32_t max_obj_per_leaf, enqueue_task_wait_t *enqueue_task_wait,
+                                  std::vector<detail::static_tree_leaf_range> &leaves) {
+    std::vector<vector3> centroids;
+    centroids.reserve(aabbs.size());
+
+    for (auto &aabb : aabbs) {
+        centroids.push_back(aabb.center());
+    }
+
+    auto ctx = sah_build_context{aabbs, centroids, ids, max_obj_per_leaf};
+    auto num_objects = static_cast<uint32_t>(ids.size());
+
+    m_nodes.clear();
+    m_nodes.emplace_back();
+
+    if (!enqueue_task_wait || num_objects <= sah_min_subtree_size) {
+        build_sah_subtree(ctx, 0, num_objects, m_nodes, 0, leaves, nullptr, 0);
+        return;
+    }
+
+    // Split the top levels in this thread until the subtrees are small
+    // enough and then build each of them in a separate task.
+    auto task_size = std::max(sah_min_subtree_size, num_objects / 64);
+    std::vector<sah_subtree_task> tasks;
+    build_sah_subtree(ctx, 0, num_objects, m_nodes, 0, leaves, &tasks, task_size);
+
+    auto task_func = [&](unsigned start, unsigned end) {
+        for (auto i = start; i < end; ++i) {
+            auto &task = tasks[i];
+            task.nodes.emplace_back();
+            build_sah_subtree(ctx, task.first, task.last, task.nodes, 0, task.leaves, nullptr, 0);
+        }
+    };
+
+    auto task = task_delegate_t(entt::connect_arg_t<&decltype(task_func)::operator()>{}, task_func);
+    (*enqueue_task_wait)(task, static_cast<unsigned>(tasks.size()));
+
+    // Move subtrees into the tree. The root of each subtree replaces its
+    // placeholder and the other nodes are appended.
+    for (auto &task : tasks) {
+        auto offset = static_cast<uint32_t>(m_nodes.size()) - 1;
+        auto to_tree_index = [&](uint32_t idx) {
+            return idx == 0 ? task.node : offset + idx;
+        };
+
+        for (size_t i = 0; i < task.nodes.size(); ++i) {
+            auto node = task.nodes[i];
+
+            if (!node.leaf()) {
+                node.child1 = to_tree_index(node.child1);
+                node.child2 = to_tree_index(node.child2);
+            }
+
+            if (i == 0) {
+                m_nodes[task.node] = node;
+            } else {
+                m_nodes.push_back(node);
+            }
+        }
+
+        for (auto &leaf : task.leaves) {
+            leaves.push_back({to_tree_index(leaf.node), leaf.first, leaf.last});
+        }
+    }
+}
+
+void static_tree::update_build_stats(const std::vector<uint32_t> &leaf_sizes) {
+    m_build_stats = {};
+
+    if (m_nodes.empty()) {
+        return;
+    }
+
+    EDYN_ASSERT(leaf_sizes.size() == m_nodes.size());
+    auto root_area = m_nodes.front().aabb.area();
+
+    struct entry {
+        uint32_t node;
+        uint32_t depth;
+    };
+
+    std::vector<entry> stack;
+    stack.push_back({0, 0});
+
+    while (!stack.empty()) {
+        auto [node_idx, depth] = stack.back();
+        stack.pop_back();
+
+        auto &node = m_nodes[node_idx];
+        auto probability = root_area > 0 ? node.aabb.area() / root_area : scalar(1);
+
+        if (node.leaf()) {
+            m_build_stats.sah_cost += probability * scalar(leaf_sizes[node_idx]);
+            m_build_stats.max_depth = std::max(m_build_stats.max_depth, depth);
+            ++m_build_stats.num_leaves;
+        } else {
+            m_build_stats.sah_cost += probability;
+            stack.push_back({node.child1, depth + 1});
+            stack.push_back({node.child2, depth + 1});
+        }
+    }
+
+    m_build_stats.num_nodes = static_cast<uint32_t>(m_nodes.size());
+}
+
+}
@@ -0,0 +1,265 @@
+#include "edyn/collision/sweep_and_prune.hpp"
+#include "edyn/config/config.h"
+#include <algorithm>
+#include <numeric>
+
+namespace edyn {
+
+static constexpr auto sap_npos = ~size_t{0};
+
+size_t sweep_and_prune::find(entt::entity entity) const {
+    auto id = static_cast<size_t>(entt::to_entity(entity));
+
+    if (id >= m_sparse.size() || m_sparse[id] == 0) {
+        return sap_npos;
+    }
+
+    auto index = static_cast<size_t>(m_sparse[id] - 1);
+    return m_entities[index] == entity ? index : sap_npos;
+}
+
+bool sweep_and_prune::contains(entt::entity entity) const {
+    return find(entity) != sap_npos;
+}
+
+AABB sweep_and_prune::get_aabb(size_t index) const {
+    auto &b = m_blocks[index / simd_width];
+    auto lane = index % simd_width;
+    return {{b.min[0][lane], b.min[1][lane], b.min[2][lane]},
+            {b.max[0][lane], b.max[1][lane], b.max[2][lane]}};
+}
+
+void sweep_and_prune::set_bounds(size_t index, const AABB &aabb) {
+    auto &b = m_blocks[index / simd_width];
+    auto lane = index % simd_width;
+
+    for (int i = 0; i < 3; ++i) {
+        b.min[i][lane] = aabb.min[i];
+        b.max[i][lane] = aabb.max[i];
+    }
+}
+
+void sweep_and_prune::set_padding(size_t index) {
+    auto &b = m_blocks[index / simd_width];
+    auto lane = index % simd_width;
+
+    for (int i = 0; i < 3; ++i) {
+        b.min[i][lane] = EDYN_SCALAR_MAX;
+        b.max[i][lane] = -EDYN_SCALAR_MAX;
+    }
+}
+
+void sweep_and_prune::move_proxy(size_t from, size_t to) {
+    set_bounds(to, get_aabb(from));
+    m_entities[to] = m_entities[from];
+    m_filters[to] = m_filters[from];
+    m_moved[to] = m_moved[from];
+
+    if (m_entities[to] != entt::null) {
+        m_sparse[static_cast<size_t>(entt::to_entity(m_entities[to]))] = static_cast<uint32_t>(to + 1);
+    }
+}
+
+void sweep_and_prune::insert(entt::entity entity, const AABB &aabb, const collision_filter &filter) {
+    EDYN_ASSERT(entity != entt::null);
+    EDYN_ASSERT(!contains(entity));
+
+    auto index = m_entities.size();
+
+    if (index % simd_width == 0) {
+        m_blocks.emplace_back();
+
+        for (size_t lane = 0; lane < simd_width; ++lane) {
+            set_padding(index + lane);
+        }
+    }
+
+    m_entities.push_back(entity);
+    m_filters.push_back(filter);
+    m_moved.push_back(1);
+    ++m_num_moved;
+    set_bounds(index, aabb);
+
+    auto id = static_cast<size_t>(entt::to_entity(entity));
+
+    if (id >= m_sparse.size()) {
+        m_sparse.resize(id + 1, 0);
+    }
+
+    m_sparse[id] = static_cast<uint32_t>(index + 1);
+}
+
+void sweep_and_prune::erase(entt::entity entity) {
+    auto index = find(entity);
+    EDYN_ASSERT(index != sap_npos);
+
+    // Sorts after all others thus it's popped in the next sort.
+    set_padding(index);
+    m_sparse[static_cast<size_t>(entt::to_entity(entity))] = 0;
+    m_entities[index] = entt::null;
+
+    if (m_moved[index]) {
+        m_moved[index] = 0;
+        --m_num_moved;
+    }
+
+    ++m_num_erased;
+}
+
+void sweep_and_prune::set_aabb(entt::entity entity, const AABB &aabb) {
+    auto index = find(entity);
+    EDYN_ASSERT(index != sap_npos);
+    set_bounds(index, aabb);
+
+    if (!m_moved[index]) {
+        m_moved[index] = 1;
+        ++m_num_moved;
+    }
+}
+
+void sweep_and_prune::set_filter(entt::entity entity, const collision_filter &filter) {
+    auto index = find(entity);
+    EDYN_ASSERT(index != sap_npos);
+    m_filters[index] = filter;
+
+    if (!m_moved[index]) {
+        m_moved[index] = 1;
+        ++m_num_moved;
+    }
+}
+
+void sweep_and_prune::choose_axis() {
+    vector3 sum = vector3_zero;
+    vector3 sum_sqr = vector3_zero;
+    size_t count = 0;
+
+    for (size_t i = 0; i < m_entities.size(); ++i) {
+        if (m_entities[i] == entt::null) {
+            continue;
+        }
+
+        auto center = get_aabb(i).center();
+        sum += center;
+        sum_sqr += center * center;
+        ++count;
+    }
+
+    m_axis_choice_size = count;
+
+    if (count == 0) {
+        return;
+    }
+
+    auto mean = sum / scalar(count);
+    auto variance = sum_sqr / scalar(count) - mean * mean;
+    auto axis = static_cast<unsigned>(max_index(variance));
+
+    if (axis == m_axis) {
+        return;
+    }
+
+    m_axis = axis;
+
+    // The insertion sort would take quadratic time when the axis changes.
+    // Sort a permutation instead and reorder everything at once.
+    std::vector<size_t> order(m_entities.size());
+    std::iota(order.begin(), order.end(), size_t{0});
+    std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+        return get_min(lhs, m_axis) < get_min(rhs, m_axis);
+    });
+
+    auto blocks = m_blocks;
+    auto entities = m_entities;
+    auto filters = m_filters;
+    auto moved = m_moved;
+
+    for (size_t i = 0; i < order.size(); ++i) {
+        auto from = order[i];
+        auto &b = blocks[from / simd_width];
+        auto lane = from % simd_width;
+        auto aabb = AABB{{b.min[0][lane], b.min[1][lane], b.min[2][lane]},
+                         {b.max[0][lane], b.max[1][lane], b.max[2][lane]}};
+        set_bounds(i, aabb);
+        m_entities[i] = entities[from];
+        m_filters[i] = filters[from];
+        m_moved[i] = moved[from];
+
+        if (m_entities[i] != entt::null) {
+            m_sparse[static_cast<size_t>(entt::to_entity(m_entities[i]))] = static_cast<uint32_t>(i + 1);
+        }
+    }
+}
+
+void sweep_and_prune::sort() {
+    if (size() >= min_axis_choice_size && size() >= 2 * m_axis_choice_size) {
+        choose_axis();
+    }
+
+    // Insertion sort, which is linear when the order barely changed.
+    for (size_t i = 1; i < m_entities.size(); ++i) {
+        auto key = get_min(i, m_axis);
+
+        if (!(key < get_min(i - 1, m_axis))) {
+            continue;
+        }
+
+        auto aabb = get_aabb(i);
+        auto entity = m_entities[i];
+        auto filter = m_filters[i];
+        auto moved = m_moved[i];
+        auto j = i;
+
+        while (j > 0 && key < get_min(j - 1, m_axis)) {
+            move_proxy(j - 1, j);
+            --j;
+        }
+
+        set_bounds(j, aabb);
+        m_entities[j] = entity;
+        m_filters[j] = filter;
+        m_moved[j] = moved;
+
+        if (entity != entt::null) {
+            m_sparse[static_cast<size_t>(entt::to_entity(entity))] = static_cast<uint32_t>(j + 1);
+        }
+    }
+
+    // Erased entities are at the end now. Their bounds are padding already.
+    while (m_num_erased > 0) {
+        EDYN_ASSERT(m_entities.back() == entt::null);
+        m_entities.pop_back();
+        m_filters.pop_back();
+        m_moved.pop_back();
+        --m_num_erased;
+    }
+
+    m_blocks.resize((m_entities.size() + simd_width - 1) / simd_width);
+}
+
+void sweep_and_prune::clear_moved() {
+    std::fill(m_moved.begin(), m_moved.end(), uint8_t{0});
+    m_num_moved = 0;
+}
+
+void sweep_and_prune::shift_origin(const vector3 &offset) {
+    for (size_t i = 0; i < m_entities.size(); ++i) {
+        if (m_entities[i] != entt::null) {
+            auto aabb = get_aabb(i);
+            set_bounds(i, {aabb.min - offset, aabb.max - offset});
+        }
+    }
+}
+
+void sweep_and_prune::clear() {
+    m_blocks.clear();
+    m_entities.clear();
+    m_filters.clear();
+    m_moved.clear();
+    m_sparse.clear();
+    m_num_moved = 0;
+    m_num_erased = 0;
+    m_axis_choice_size = 0;
+    m_axis = 0;
+}
+
+}
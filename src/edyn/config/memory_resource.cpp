@@ -0,0 +1,44 @@
+#include "edyn/config/memory_resource.hpp"
+#include <new>
+
+namespace edyn {
+
+namespace {
+
+class new_delete_memory_resource final : public memory_resource {
+public:
+    void * allocate(size_t size, size_t alignment) override {
+        if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            return ::operator new(size, std::align_val_t(alignment));
+        }
+
+        return ::operator new(size);
+    }
+
+    void deallocate(void *ptr, size_t size, size_t alignment) override {
+        if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            ::operator delete(ptr, size, std::align_val_t(alignment));
+        } else {
+            ::operator delete(ptr, size);
+        }
+    }
+};
+
+}
+
+static thread_local memory_resource *bound_memory_resource = nullptr;
+
+memory_resource * memory_resource::new_delete() {
+    static new_delete_memory_resource instance;
+    return &instance;
+}
+
+memory_resource * memory_resource::current() {
+    return bound_memory_resource ? bound_memory_resource : new_delete();
+}
+
+void memory_resource::bind_current(memory_resource *resource) {
+    bound_memory_resource = resource;
+}
+
+}
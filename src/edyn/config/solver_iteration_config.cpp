@@ -1,5 +1,7 @@
 #include "edyn/config/solver_iteration_config.hpp"
+#include "edyn/config/config.h"
 #include "edyn/context/settings.hpp"
+#include "edyn/dynamics/row_cache.hpp"
 #include "edyn/networking/context/client_network_context.hpp"
 #include "edyn/simulation/stepper_async.hpp"
 #include <entt/entity/registry.hpp>
@@ -19,7 +21,9 @@ void set_solver_velocity_iterations(entt::registry &registry, unsigned iteration
     }
 
     if (auto *ctx = registry.ctx().find<client_network_context>()) {
-        ctx->extrapolator->set_settings(settings);
+        for (auto &extrapolator : ctx->extrapolators) {
+            extrapolator->set_settings(settings);
+        }
     }
 }
 
@@ -36,7 +40,9 @@ void set_solver_position_iterations(entt::registry &registry, unsigned iteration
     }
 
     if (auto *ctx = registry.ctx().find<client_network_context>()) {
-        ctx->extrapolator->set_settings(settings);
+        for (auto &extrapolator : ctx->extrapolators) {
+            extrapolator->set_settings(settings);
+        }
     }
 }
 
@@ -53,7 +59,9 @@ void set_solver_restitution_iterations(entt::registry &registry, unsigned iterat
     }
 
     if (auto *ctx = registry.ctx().find<client_network_context>()) {
-        ctx->extrapolator->set_settings(settings);
+        for (auto &extrapolator : ctx->extrapolators) {
+            extrapolator->set_settings(settings);
+        }
     }
 }
 
@@ -70,8 +78,153 @@ void set_solver_individual_restitution_iterations(entt::registry &registry, unsi
     }
 
     if (auto *ctx = registry.ctx().find<client_network_context>()) {
-        ctx->extrapolator->set_settings(settings);
+        for (auto &extrapolator : ctx->extrapolators) {
+            extrapolator->set_settings(settings);
+        }
     }
 }
 
+unsigned get_solver_substeps(const entt::registry &registry) {
+    return registry.ctx().get<settings>().num_solver_substeps;
+}
+
+void set_solver_substeps(entt::registry &registry, unsigned substeps) {
+    EDYN_ASSERT(substeps > 0);
+    auto &settings = registry.ctx().get<edyn::settings>();
+    settings.num_solver_substeps = substeps;
+
+    if (auto *stepper = registry.ctx().find<stepper_async>()) {
+        stepper->settings_changed();
+    }
+
+    if (auto *ctx = registry.ctx().find<client_network_context>()) {
+        for (auto &extrapolator : ctx->extrapolators) {
+            extrapolator->set_settings(settings);
+        }
+    }
+}
+
+unsigned get_solver_min_velocity_iterations(const entt::registry &registry) {
+    return registry.ctx().get<settings>().min_solver_velocity_iterations;
+}
+
+void set_solver_min_velocity_iterations(entt::registry &registry, unsigned iterations) {
+    auto &settings = registry.ctx().get<edyn::settings>();
+    settings.min_solver_velocity_iterations = iterations;
+
+    if (auto *stepper = registry.ctx().find<stepper_async>()) {
+        stepper->settings_changed();
+    }
+
+    if (auto *ctx = registry.ctx().find<client_network_context>()) {
+        for (auto &extrapolator : ctx->extrapolators) {
+            extrapolator->set_settings(settings);
+        }
+    }
+}
+
+scalar get_solver_velocity_tolerance(const entt::registry &registry) {
+    return registry.ctx().get<settings>().solver_velocity_tolerance;
+}
+
+void set_solver_velocity_tolerance(entt::registry &registry, scalar tolerance) {
+    EDYN_ASSERT(!(tolerance < 0));
+    auto &settings = registry.ctx().get<edyn::settings>();
+    settings.solver_velocity_tolerance = tolerance;
+
+    if (auto *stepper = registry.ctx().find<stepper_async>()) {
+        stepper->settings_changed();
+    }
+
+    if (auto *ctx = registry.ctx().find<client_network_context>()) {
+        for (auto &extrapolator : ctx->extrapolators) {
+            extrapolator->set_settings(settings);
+        }
+    }
+}
+
+bool get_contact_block_solver(const entt::registry &registry) {
+    return registry.ctx().get<settings>().contact_block_solver;
+}
+
+void set_contact_block_solver(entt::registry &registry, bool enabled) {
+    auto &settings = registry.ctx().get<edyn::settings>();
+    settings.contact_block_solver = enabled;
+
+    if (auto *stepper = registry.ctx().find<stepper_async>()) {
+        stepper->settings_changed();
+    }
+
+    if (auto *ctx = registry.ctx().find<client_network_context>()) {
+        for (auto &extrapolator : ctx->extrapolators) {
+            extrapolator->set_settings(settings);
+        }
+    }
+}
+
+bool get_articulate_distance_chains(const entt::registry &registry) {
+    return registry.ctx().get<settings>().articulate_distance_chains;
+}
+
+void set_articulate_distance_chains(entt::registry &registry, bool enabled) {
+    auto &settings = registry.ctx().get<edyn::settings>();
+    settings.articulate_distance_chains = enabled;
+
+    if (auto *stepper = registry.ctx().find<stepper_async>()) {
+        stepper->settings_changed();
+    }
+
+    if (auto *ctx = registry.ctx().find<client_network_context>()) {
+        for (auto &extrapolator : ctx->extrapolators) {
+            extrapolator->set_settings(settings);
+        }
+    }
+}
+
+bool get_deterministic(const entt::registry &registry) {
+    return registry.ctx().get<settings>().deterministic;
+}
+
+void set_deterministic(entt::registry &registry, bool enabled) {
+    auto &settings = registry.ctx().get<edyn::settings>();
+    settings.deterministic = enabled;
+
+    if (auto *stepper = registry.ctx().find<stepper_async>()) {
+        stepper->settings_changed();
+    }
+
+    if (auto *ctx = registry.ctx().find<client_network_context>()) {
+        for (auto &extrapolator : ctx->extrapolators) {
+            extrapolator->set_settings(settings);
+        }
+    }
+}
+
+bool get_collect_solver_stats(const entt::registry &registry) {
+    return registry.ctx().get<settings>().collect_solver_stats;
+}
+
+void set_collect_solver_stats(entt::registry &registry, bool enabled) {
+    auto &settings = registry.ctx().get<edyn::settings>();
+    settings.collect_solver_stats = enabled;
+
+    if (auto *stepper = registry.ctx().find<stepper_async>()) {
+        stepper->settings_changed();
+    }
+
+    if (auto *ctx = registry.ctx().find<client_network_context>()) {
+        for (auto &extrapolator : ctx->extrapolators) {
+            extrapolator->set_settings(settings);
+        }
+    }
+}
+
+unsigned get_island_solver_velocity_iterations(const entt::registry &registry, entt::entity island_entity) {
+    if (auto *cache = registry.try_get<row_cache>(island_entity)) {
+        return cache->num_velocity_iterations;
+    }
+
+    return 0;
+}
+
 }
@@ -0,0 +1,10 @@
+#include "edyn/constraints/breakable_constraint.hpp"
+#include <entt/entity/registry.hpp>
+
+namespace edyn {
+
+const std::vector<constraint_break_event> & get_constraint_break_events(const entt::registry &registry) {
+    return registry.ctx().get<constraint_break_event_buffer>().events;
+}
+
+}
@@ -1,59 +1,54 @@
 #include "edyn/constraints/constraint_row.hpp"
 #include "edyn/constraints/constraint_row_options.hpp"
+#include "edyn/constraints/constraint_body.hpp"
 
 namespace edyn {
 
 void prepare_row(constraint_row &row,
                  const constraint_row_options &options,
-                 const vector3 &linvelA, const vector3 &angvelA,
-                 const vector3 &linvelB, const vector3 &angvelB) {
-    auto J_invM_JT = dot(row.J[0], row.J[0]) * row.inv_mA +
-                     dot(row.inv_IA * row.J[1], row.J[1]) +
-                     dot(row.J[2], row.J[2]) * row.inv_mB +
-                     dot(row.inv_IB * row.J[3], row.J[3]);
-    row.eff_mass = 1 / J_invM_JT;
-
-    auto relvel = dot(row.J[0], linvelA) +
-                  dot(row.J[1], angvelA) +
-                  dot(row.J[2], linvelB) +
-                  dot(row.J[3], angvelB);
+                 const constraint_body &bodyA, const constraint_body &bodyB) {
+    auto J_invM_JT = dot(row.J[0], row.J[0]) * bodyA.inv_m +
+                     dot(bodyA.inv_I * row.J[1], row.J[1]) +
+                     dot(row.J[2], row.J[2]) * bodyB.inv_m +
+                     dot(bodyB.inv_I * row.J[3], row.J[3]);
+    // Rows between bodies that cannot move, such as a frozen body resting on
+    // a static body, apply no impulse.
+    row.eff_mass = J_invM_JT > 0 ? 1 / J_invM_JT : 0;
+
+    auto relvel = dot(row.J[0], bodyA.linvel) +
+                  dot(row.J[1], bodyA.angvel) +
+                  dot(row.J[2], bodyB.linvel) +
+                  dot(row.J[3], bodyB.angvel);
 
     row.rhs = -(options.error * options.erp + relvel * (1 + options.restitution));
 }
 
-void apply_row_impulse(scalar impulse, constraint_row &row) {
+void apply_row_impulse(scalar impulse, const constraint_row &row, std::vector<solver_body> &bodies) {
+    auto &bodyA = bodies[row.body[0]];
+    auto &bodyB = bodies[row.body[1]];
+
     // Apply linear impulse.
-    *row.dvA += row.inv_mA * row.J[0] * impulse;
-    *row.dvB += row.inv_mB * row.J[2] * impulse;
+    bodyA.dv += bodyA.inv_m * row.J[0] * impulse;
+    bodyB.dv += bodyB.inv_m * row.J[2] * impulse;
 
     // Apply angular impulse.
-    *row.dwA += row.inv_IA * row.J[1] * impulse;
-    *row.dwB += row.inv_IB * row.J[3] * impulse;
+    bodyA.dw += bodyA.inv_I * row.J[1] * impulse;
+    bodyB.dw += bodyB.inv_I * row.J[3] * impulse;
 }
 
-void warm_start(constraint_row &row) {
-    apply_row_impulse(row.impulse, row);
+void warm_start(const constraint_row &row, std::vector<solver_body> &bodies) {
+    apply_row_impulse(row.impulse, row, bodies);
 }
 
-scalar solve(constraint_row &row) {
-    auto delta_relvel = dot(row.J[0], *row.dvA) +
-                        dot(row.J[1], *row.dwA) +
-                        dot(row.J[2], *row.dvB) +
-                        dot(row.J[3], *row.dwB);
+scalar solve(constraint_row &row, const std::vector<solver_body> &bodies) {
+    auto &bodyA = bodies[row.body[0]];
+    auto &bodyB = bodies[row.body[1]];
+    auto delta_relvel = dot(row.J[0], bodyA.dv) +
+                        dot(row.J[1], bodyA.dw) +
+                        dot(row.J[2], bodyB.dv) +
+                        dot(row.J[3], bodyB.dw);
     auto delta_impulse = (row.rhs - delta_relvel) * row.eff_mass;
-    auto impulse = row.impulse + delta_impulse;
-
-    if (impulse < row.lower_limit) {
-        delta_impulse = row.lower_limit - row.impulse;
-        row.impulse = row.lower_limit;
-    } else if (impulse > row.upper_limit) {
-        delta_impulse = row.upper_limit - row.impulse;
-        row.impulse = row.upper_limit;
-    } else {
-        row.impulse = impulse;
-    }
-
-    return delta_impulse;
+    return apply_row_limits(row, delta_impulse);
 }
 
 }
@@ -0,0 +1,213 @@
+#include "edyn/constraints/constraint_row_block.hpp"
+#include "edyn/math/constants.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace edyn {
+
+// Relative amount added to the diagonal of the block matrix. The normal rows
+// of four contact points on a face are linearly dependent, which makes the
+// matrix singular. Regularizing it gives the solution with the impulses
+// evenly distributed among the points.
+static constexpr auto block_regularization = scalar(1e-4);
+
+// Tolerance for the relative velocity of rows which are not pushing.
+static constexpr auto block_velocity_tolerance = scalar(1e-5);
+
+bool can_solve_in_block(const constraint_row &row) {
+    return row.lower_limit == 0 && row.upper_limit >= large_scalar;
+}
+
+void prepare_block(constraint_row_block &block, const std::vector<constraint_row> &rows,
+                   const std::vector<solver_body> &bodies) {
+    EDYN_ASSERT(block.num_rows > 1 && block.num_rows <= constraint_row_block::max_rows);
+
+    for (unsigned i = 0; i < block.num_rows; ++i) {
+        auto &row_i = rows[block.first_row + i];
+        auto &bodyA = bodies[row_i.body[0]];
+        auto &bodyB = bodies[row_i.body[1]];
+
+        // Rows in a block all share the same pair of bodies.
+        for (unsigned j = i; j < block.num_rows; ++j) {
+            auto &row_j = rows[block.first_row + j];
+            EDYN_ASSERT(row_j.body == row_i.body);
+            auto k = dot(row_i.J[0], row_j.J[0]) * bodyA.inv_m +
+                     dot(bodyA.inv_I * row_i.J[1], row_j.J[1]) +
+                     dot(row_i.J[2], row_j.J[2]) * bodyB.inv_m +
+                     dot(bodyB.inv_I * row_i.J[3], row_j.J[3]);
+            block.K[i][j] = block.K[j][i] = k;
+        }
+
+        block.K[i][i] *= 1 + block_regularization;
+    }
+}
+
+// Solves `A x = b` for a small system using Gaussian elimination with partial
+// pivoting. Returns false if the matrix is singular.
+static bool solve_linear_system(std::array<std::array<scalar, constraint_row_block::max_rows>,
+                                           constraint_row_block::max_rows> A,
+                                std::array<scalar, constraint_row_block::max_rows> b,
+                                unsigned n, std::array<scalar, constraint_row_block::max_rows> &x) {
+    for (unsigned c = 0; c < n; ++c) {
+        auto pivot = c;
+
+        for (auto r = c + 1; r < n; ++r) {
+            if (std::abs(A[r][c]) > std::abs(A[pivot][c])) {
+                pivot = r;
+            }
+        }
+
+        if (std::abs(A[pivot][c]) <= EDYN_EPSILON) {
+            return false;
+        }
+
+        std::swap(A[c], A[pivot]);
+        std::swap(b[c], b[pivot]);
+
+        for (auto r = c + 1; r < n; ++r) {
+            auto f = A[r][c] / A[c][c];
+
+            for (auto k = c; k < n; ++k) {
+                A[r][k] -= f * A[c][k];
+            }
+
+            b[r] -= f * b[c];
+        }
+    }
+
+    for (auto c = n; c-- > 0;) {
+        auto sum = b[c];
+
+        for (auto k = c + 1; k < n; ++k) {
+            sum -= A[c][k] * x[k];
+        }
+
+        x[c] = sum / A[c][c];
+    }
+
+    return true;
+}
+
+static unsigned count_bits(unsigned mask) {
+    unsigned count = 0;
+
+    for (; mask != 0; mask &= mask - 1) {
+        ++count;
+    }
+
+    return count;
+}
+
+scalar solve_block(const constraint_row_block &block, std::vector<constraint_row> &rows,
+                   std::vector<solver_body> &bodies) {
+    constexpr auto max_rows = constraint_row_block::max_rows;
+    const auto n = block.num_rows;
+    auto *block_rows = rows.data() + block.first_row;
+    auto &bodyA = bodies[block_rows[0].body[0]];
+    auto &bodyB = bodies[block_rows[0].body[1]];
+
+    // Find impulses `x` such that `x >= 0`, `w = K x + b >= 0` and `x_i w_i = 0`,
+    // where `w` is the relative velocity after the impulses are applied minus
+    // the right hand side and `b` is the same before the impulses are applied,
+    // with the accumulated impulses removed.
+    std::array<scalar, max_rows> b;
+
+    for (unsigned i = 0; i < n; ++i) {
+        auto &row = block_rows[i];
+        b[i] = dot(row.J[0], bodyA.dv) +
+               dot(row.J[1], bodyA.dw) +
+               dot(row.J[2], bodyB.dv) +
+               dot(row.J[3], bodyB.dw) - row.rhs;
+
+        for (unsigned j = 0; j < n; ++j) {
+            b[i] -= block.K[i][j] * block_rows[j].impulse;
+        }
+    }
+
+    // Enumerate the sets of rows which are pushing, starting with the largest,
+    // until one that satisfies all conditions is found.
+    const auto full_mask = (1u << n) - 1;
+    std::array<scalar, max_rows> x;
+    auto found = false;
+
+    for (auto num_active = n + 1; num_active-- > 0 && !found;) {
+        for (auto mask = full_mask; ; --mask) {
+            if (count_bits(mask) == num_active) {
+                std::array<unsigned, max_rows> active;
+                std::array<std::array<scalar, max_rows>, max_rows> A;
+                std::array<scalar, max_rows> rhs, x_active;
+                unsigned m = 0;
+
+                for (unsigned i = 0; i < n; ++i) {
+                    if (mask & (1u << i)) {
+                        active[m++] = i;
+                    }
+                }
+
+                for (unsigned i = 0; i < m; ++i) {
+                    for (unsigned j = 0; j < m; ++j) {
+                        A[i][j] = block.K[active[i]][active[j]];
+                    }
+
+                    rhs[i] = -b[active[i]];
+                }
+
+                if (m == 0 || solve_linear_system(A, rhs, m, x_active)) {
+                    x.fill(0);
+                    auto valid = true;
+
+                    for (unsigned i = 0; i < m; ++i) {
+                        valid &= x_active[i] >= 0;
+                        x[active[i]] = x_active[i];
+                    }
+
+                    for (unsigned i = 0; i < n && valid; ++i) {
+                        if (mask & (1u << i)) continue;
+
+                        auto w = b[i];
+
+                        for (unsigned j = 0; j < n; ++j) {
+                            w += block.K[i][j] * x[j];
+                        }
+
+                        valid &= w >= -block_velocity_tolerance;
+                    }
+
+                    if (valid) {
+                        found = true;
+                        break;
+                    }
+                }
+            }
+
+            if (mask == 0) {
+                break;
+            }
+        }
+    }
+
+    auto max_delta_impulse = scalar(0);
+
+    if (!found) {
+        // Degenerate case. Solve rows one at a time.
+        for (unsigned i = 0; i < n; ++i) {
+            auto delta_impulse = solve(block_rows[i], bodies);
+            apply_row_impulse(delta_impulse, block_rows[i], bodies);
+            max_delta_impulse = std::max(std::abs(delta_impulse), max_delta_impulse);
+        }
+
+        return max_delta_impulse;
+    }
+
+    for (unsigned i = 0; i < n; ++i) {
+        auto &row = block_rows[i];
+        auto delta_impulse = x[i] - row.impulse;
+        apply_row_impulse(delta_impulse, row, bodies);
+        row.impulse = x[i];
+        max_delta_impulse = std::max(std::abs(delta_impulse), max_delta_impulse);
+    }
+
+    return max_delta_impulse;
+}
+
+}
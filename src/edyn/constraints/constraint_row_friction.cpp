@@ -3,22 +3,23 @@
 #include "edyn/math/math.hpp"
 #include "edyn/math/vector2.hpp"
 #include "edyn/util/constraint_util.hpp"
-#include "edyn/comp/delta_linvel.hpp"
-#include "edyn/comp/delta_angvel.hpp"
 
 namespace edyn {
 
-void solve_friction(constraint_row_friction &friction_row, const std::vector<constraint_row> &row_cache) {
+void solve_friction(constraint_row_friction &friction_row, const std::vector<constraint_row> &row_cache,
+                    std::vector<solver_body> &bodies) {
     // Impulse is limited by the length of a 2D vector to assure a friction circle.
     vector2 delta_impulse;
     vector2 impulse;
     auto &normal_row = row_cache[friction_row.normal_row_index];
+    auto &bodyA = bodies[normal_row.body[0]];
+    auto &bodyB = bodies[normal_row.body[1]];
 
     for (auto i = 0; i < 2; ++i) {
         auto &row_i = friction_row.row[i];
         auto delta_relspd = get_relative_speed(row_i.J,
-                                               *normal_row.dvA, *normal_row.dwA,
-                                               *normal_row.dvB, *normal_row.dwB);
+                                               bodyA.dv, bodyA.dw,
+                                               bodyB.dv, bodyB.dw);
         delta_impulse[i] = (row_i.rhs - delta_relspd) * row_i.eff_mass;
         impulse[i] = row_i.impulse + delta_impulse[i];
     }
@@ -46,22 +47,25 @@ void solve_friction(constraint_row_friction &friction_row, const std::vector<con
         auto &row_i = friction_row.row[i];
         row_i.impulse = impulse[i];
 
-        *normal_row.dvA += normal_row.inv_mA * row_i.J[0] * delta_impulse[i];
-        *normal_row.dwA += normal_row.inv_IA * row_i.J[1] * delta_impulse[i];
-        *normal_row.dvB += normal_row.inv_mB * row_i.J[2] * delta_impulse[i];
-        *normal_row.dwB += normal_row.inv_IB * row_i.J[3] * delta_impulse[i];
+        bodyA.dv += bodyA.inv_m * row_i.J[0] * delta_impulse[i];
+        bodyA.dw += bodyA.inv_I * row_i.J[1] * delta_impulse[i];
+        bodyB.dv += bodyB.inv_m * row_i.J[2] * delta_impulse[i];
+        bodyB.dw += bodyB.inv_I * row_i.J[3] * delta_impulse[i];
     }
 }
 
-void warm_start(constraint_row_friction &friction_row, const std::vector<constraint_row> &row_cache) {
+void warm_start(const constraint_row_friction &friction_row, const std::vector<constraint_row> &row_cache,
+                std::vector<solver_body> &bodies) {
     auto &normal_row = row_cache[friction_row.normal_row_index];
+    auto &bodyA = bodies[normal_row.body[0]];
+    auto &bodyB = bodies[normal_row.body[1]];
 
     for (int i = 0; i < 2; ++i) {
         auto &row_i = friction_row.row[i];
-        *normal_row.dvA += normal_row.inv_mA * row_i.J[0] * row_i.impulse;
-        *normal_row.dwA += normal_row.inv_IA * row_i.J[1] * row_i.impulse;
-        *normal_row.dvB += normal_row.inv_mB * row_i.J[2] * row_i.impulse;
-        *normal_row.dwB += normal_row.inv_IB * row_i.J[3] * row_i.impulse;
+        bodyA.dv += bodyA.inv_m * row_i.J[0] * row_i.impulse;
+        bodyA.dw += bodyA.inv_I * row_i.J[1] * row_i.impulse;
+        bodyB.dv += bodyB.inv_m * row_i.J[2] * row_i.impulse;
+        bodyB.dw += bodyB.inv_I * row_i.J[3] * row_i.impulse;
     }
 }
 
@@ -2,11 +2,14 @@
 
 namespace edyn {
 
-void solve_spin_friction(constraint_row_spin_friction &row, const std::vector<constraint_row> &row_cache) {
+void solve_spin_friction(constraint_row_spin_friction &row, const std::vector<constraint_row> &row_cache,
+                         std::vector<solver_body> &bodies) {
     auto &normal_row = row_cache[row.normal_row_index];
+    auto &bodyA = bodies[normal_row.body[0]];
+    auto &bodyB = bodies[normal_row.body[1]];
     auto max_impulse_len = row.friction_coefficient * normal_row.impulse;
 
-    auto delta_relvel = dot(row.J[0], *normal_row.dwA) + dot(row.J[1], *normal_row.dwB);
+    auto delta_relvel = dot(row.J[0], bodyA.dw) + dot(row.J[1], bodyB.dw);
     auto delta_impulse = (row.rhs - delta_relvel) * row.eff_mass;
     auto impulse = row.impulse + delta_impulse;
     auto lower_limit = -max_impulse_len;
@@ -23,15 +26,18 @@ void solve_spin_friction(constraint_row_spin_friction &row, const std::vector<co
     }
 
     // Apply angular impulse.
-    *normal_row.dwA += normal_row.inv_IA * row.J[0] * delta_impulse;
-    *normal_row.dwB += normal_row.inv_IB * row.J[1] * delta_impulse;
+    bodyA.dw += bodyA.inv_I * row.J[0] * delta_impulse;
+    bodyB.dw += bodyB.inv_I * row.J[1] * delta_impulse;
 }
 
-void warm_start(constraint_row_spin_friction &row, const std::vector<constraint_row> &row_cache) {
+void warm_start(const constraint_row_spin_friction &row, const std::vector<constraint_row> &row_cache,
+                std::vector<solver_body> &bodies) {
     auto &normal_row = row_cache[row.normal_row_index];
+    auto &bodyA = bodies[normal_row.body[0]];
+    auto &bodyB = bodies[normal_row.body[1]];
     // Apply angular impulse.
-    *normal_row.dwA += normal_row.inv_IA * row.J[0] * row.impulse;
-    *normal_row.dwB += normal_row.inv_IB * row.J[1] * row.impulse;
+    bodyA.dw += bodyA.inv_I * row.J[0] * row.impulse;
+    bodyB.dw += bodyB.inv_I * row.J[1] * row.impulse;
 }
 
 }
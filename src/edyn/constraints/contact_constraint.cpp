@@ -21,6 +21,7 @@ void contact_constraint::prepare(
     // Create constraint rows for each contact point.
     for (unsigned pt_idx = 0; pt_idx < manifold.num_points; ++pt_idx) {
         auto &cp = manifold.get_point(pt_idx);
+        auto &cold = manifold.get_cold(pt_idx);
 
         EDYN_ASSERT(length_sqr(cp.normal) > EDYN_EPSILON);
         auto normal = cp.normal;
@@ -40,25 +41,25 @@ void contact_constraint::prepare(
         // Do not use the traditional restitution path if the restitution solver
         // is being used.
         if (settings.num_restitution_iterations == 0) {
-            normal_options.restitution = cp.restitution;
+            normal_options.restitution = cold.restitution;
         }
 
         if (cp.distance < 0) {
-            if (cp.stiffness < large_scalar) {
+            if (cold.stiffness < large_scalar) {
                 auto vA = bodyA.linvel + cross(bodyA.angvel, rA);
                 auto vB = bodyB.linvel + cross(bodyB.angvel, rB);
                 auto relvel = vA - vB;
                 auto normal_relvel = dot(relvel, normal);
                 // Divide stiffness by number of points for correct force
                 // distribution. All points have the same stiffness.
-                auto spring_force = -cp.distance * cp.stiffness / manifold.num_points;
-                auto damper_force = -normal_relvel * cp.damping / manifold.num_points;
+                auto spring_force = -cp.distance * cold.stiffness / manifold.num_points;
+                auto damper_force = -normal_relvel * cold.damping / manifold.num_points;
                 normal_row.upper_limit = std::max(spring_force + damper_force, scalar(0)) * dt;
                 normal_options.error = -large_scalar;
             } else {
                 normal_row.upper_limit = large_scalar;
             }
-        } else if (cp.stiffness >= large_scalar) {
+        } else if (cold.stiffness >= large_scalar) {
             // It is not penetrating thus apply an impulse that will prevent
             // penetration after the following physics update.
             normal_options.error = cp.distance / dt;
@@ -67,7 +68,7 @@ void contact_constraint::prepare(
 
         // Create special friction rows.
         auto &friction_row = cache.add_friction_row();
-        friction_row.friction_coefficient = cp.friction;
+        friction_row.friction_coefficient = cold.friction;
 
         vector3 tangents[2];
         plane_space(normal, tangents[0], tangents[1]);
@@ -80,9 +81,9 @@ void contact_constraint::prepare(
             row_i.rhs = -get_relative_speed(row_i.J, bodyA.linvel, bodyA.angvel, bodyB.linvel, bodyB.angvel);
         }
 
-        if (cp.roll_friction > 0) {
+        if (cold.roll_friction > 0) {
             auto &roll_row = cache.add_rolling_row();
-            roll_row.friction_coefficient = cp.roll_friction;
+            roll_row.friction_coefficient = cold.roll_friction;
 
             auto roll_dir_view = registry.view<roll_direction>();
 
@@ -109,16 +110,16 @@ void contact_constraint::prepare(
             }
         }
 
-        if (cp.spin_friction > 0) {
+        if (cold.spin_friction > 0) {
             auto &spin_row = cache.add_spinning_row();
-            spin_row.friction_coefficient = cp.spin_friction;
+            spin_row.friction_coefficient = cold.spin_friction;
             spin_row.J = {normal, -normal};
             spin_row.impulse = cp.spin_friction_impulse;
 
             auto J_invM_JT = dot(bodyA.inv_I * spin_row.J[0], spin_row.J[0]) +
                              dot(bodyB.inv_I * spin_row.J[1], spin_row.J[1]);
-            EDYN_ASSERT(J_invM_JT > EDYN_EPSILON);
-            spin_row.eff_mass = scalar(1) / J_invM_JT;
+            // Zero for particles on static bodies, which can't spin anyway.
+            spin_row.eff_mass = J_invM_JT > EDYN_EPSILON ? scalar(1) / J_invM_JT : 0;
             spin_row.rhs = -(dot(spin_row.J[0], bodyA.angvel) + dot(spin_row.J[1], bodyB.angvel));
         }
     }
@@ -132,7 +133,7 @@ void contact_constraint::solve_position(position_solver &solver, contact_manifol
         auto &cp = manifold.get_point(pt_idx);
 
         // Ignore soft contacts.
-        if (cp.stiffness < large_scalar) {
+        if (manifold.get_cold(pt_idx).stiffness < large_scalar) {
             continue;
         }
 
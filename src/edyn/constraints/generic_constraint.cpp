@@ -4,14 +4,162 @@
 #include "edyn/math/math.hpp"
 #include "edyn/math/transform.hpp"
 #include "edyn/util/constraint_util.hpp"
+#include <utility>
 
 namespace edyn {
 
+// Calculates the current angle of the i-th angular degree of freedom and its
+// axes of rotation in world space.
+static scalar get_angular_axes(const generic_constraint &con, int i,
+                               const quaternion &ornA, const quaternion &ornB,
+                               const vector3 &axisA_x, const vector3 &axisB_x,
+                               vector3 &axisA, vector3 &axisB) {
+    if (i == 0) {
+        // Quaternion which rotates the axis of B so it's parallel to the
+        // the axis of A.
+        auto arc_quat = shortest_arc(axisB_x, axisA_x);
+
+        // Transform a non-axial vector in the frame of B onto A's space so
+        // the angular error can be calculated.
+        auto angle_axisB = edyn::rotate(conjugate(ornA) * arc_quat * ornB, con.frame[1].column(1));
+        axisA = axisA_x;
+        axisB = axisB_x;
+        return std::atan2(dot(angle_axisB, con.frame[0].column(2)),
+                          dot(angle_axisB, con.frame[0].column(1)));
+    }
+
+    auto axisA_other = rotate(ornA, con.frame[0].column(i == 1 ? 2 : 1));
+    auto cos_angle = std::clamp(dot(axisB_x, axisA_other), scalar(-1), scalar(1));
+    auto axis = cross(axisA_other, axisB_x);
+
+    if (!try_normalize(axis)) {
+        axis = i == 1 ? vector3_z : vector3_y;
+    }
+
+    axisA = axisB = -axis;
+    return half_pi - std::acos(cos_angle);
+}
+
+// A degree of freedom is locked if it only has a rigid equality row and free
+// if it has no rows at all.
+static bool is_locked(const generic_constraint::linear_dof &dof) {
+    return dof.limit_enabled && !(dof.offset_min < dof.offset_max) &&
+           dof.spring_stiffness == 0 && dof.friction_force == 0 && dof.damping == 0;
+}
+
+static bool is_free(const generic_constraint::linear_dof &dof) {
+    return !dof.limit_enabled &&
+           dof.spring_stiffness == 0 && dof.friction_force == 0 && dof.damping == 0;
+}
+
+static bool is_locked(const generic_constraint::angular_dof &dof) {
+    return dof.limit_enabled && !(dof.angle_min < dof.angle_max) &&
+           dof.spring_stiffness == 0 && dof.friction_torque == 0 && dof.damping == 0;
+}
+
+static bool is_free(const generic_constraint::angular_dof &dof) {
+    return !dof.limit_enabled &&
+           dof.spring_stiffness == 0 && dof.friction_torque == 0 && dof.damping == 0;
+}
+
+// Prepares a constraint where every degree of freedom is either locked or
+// free, which covers ball, hinge, slider and weld joints. The masks have one
+// bit per axis, which is set if the axis is locked. The axes of the frame are
+// transformed together as a matrix and the rows are generated without
+// branching on the dof settings. The rows are the same as the general path's.
+template<unsigned LinearMask, unsigned AngularMask>
+static void prepare_locked(generic_constraint &con, constraint_row_prep_cache &cache, scalar dt,
+                           const constraint_body &bodyA, const constraint_body &bodyB) {
+    // Rows of the transposed basis are the axes of the frame in world space.
+    auto axesA = transpose(to_matrix3x3(bodyA.orn) * con.frame[0]);
+
+    if constexpr (LinearMask != 0) {
+        auto pivotA = to_world_space(con.pivot[0], bodyA.origin, bodyA.orn);
+        auto pivotB = to_world_space(con.pivot[1], bodyB.origin, bodyB.orn);
+        auto rA = pivotA - bodyA.pos;
+        auto rB = pivotB - bodyB.pos;
+
+        // Rows are `cross(rA, axis)` and `-cross(rB, axis)` for each axis.
+        auto angularA = axesA * skew_matrix(-rA);
+        auto angularB = axesA * skew_matrix(rB);
+
+        for (int i = 0; i < 3; ++i) {
+            if ((LinearMask & (1u << i)) == 0) {
+                continue;
+            }
+
+            auto &row = cache.add_row();
+            row.J = {axesA[i], angularA[i], -axesA[i], angularB[i]};
+            row.impulse = con.linear_dofs[i].applied_impulse.limit;
+            row.lower_limit = -large_scalar;
+            row.upper_limit = large_scalar;
+        }
+    }
+
+    // The current angle is always updated since it's also used as output.
+    auto axisA_x = axesA[0];
+    auto axisB_x = rotate(bodyB.orn, con.frame[1].column(0));
+
+    for (int i = 0; i < 3; ++i) {
+        auto &dof = con.angular_dofs[i];
+        vector3 axisA, axisB;
+        dof.current_angle = get_angular_axes(con, i, bodyA.orn, bodyB.orn, axisA_x, axisB_x, axisA, axisB);
+
+        if ((AngularMask & (1u << i)) == 0) {
+            continue;
+        }
+
+        auto &row = cache.add_row();
+        row.J = {vector3_zero, axisA, vector3_zero, -axisB};
+        row.impulse = dof.applied_impulse.limit;
+        row.lower_limit = -large_scalar;
+        row.upper_limit = large_scalar;
+
+        auto &options = cache.get_options();
+        options.error = -dof.current_angle / dt;
+    }
+}
+
+using prepare_locked_func_t = void(*)(generic_constraint &, constraint_row_prep_cache &, scalar,
+                                      const constraint_body &, const constraint_body &);
+
+template<size_t... Masks>
+static constexpr auto make_prepare_locked_functions(std::index_sequence<Masks...>) {
+    return std::array<prepare_locked_func_t, sizeof...(Masks)>{
+        {&prepare_locked<(Masks & 7u), (Masks >> 3)>...}
+    };
+}
+
+// One function for each combination of locked linear and angular axes.
+static constexpr auto prepare_locked_functions = make_prepare_locked_functions(std::make_index_sequence<64>{});
+
 void generic_constraint::prepare(
     const entt::registry &, entt::entity,
     constraint_row_prep_cache &cache, scalar dt,
     const constraint_body &bodyA, const constraint_body &bodyB) {
 
+    unsigned locked_mask = 0;
+    bool all_locked_or_free = true;
+
+    for (int i = 0; i < 3; ++i) {
+        if (is_locked(linear_dofs[i])) {
+            locked_mask |= 1u << i;
+        } else if (!is_free(linear_dofs[i])) {
+            all_locked_or_free = false;
+        }
+
+        if (is_locked(angular_dofs[i])) {
+            locked_mask |= 1u << (i + 3);
+        } else if (!is_free(angular_dofs[i])) {
+            all_locked_or_free = false;
+        }
+    }
+
+    if (all_locked_or_free) {
+        prepare_locked_functions[locked_mask](*this, cache, dt, bodyA, bodyB);
+        return;
+    }
+
     auto pivotA = to_world_space(pivot[0], bodyA.origin, bodyA.orn);
     auto pivotB = to_world_space(pivot[1], bodyB.origin, bodyB.orn);
     auto rA = pivotA - bodyA.pos;
@@ -132,31 +280,7 @@ void generic_constraint::prepare(
         auto &dof = angular_dofs[i];
         auto non_zero_limit = dof.angle_min < dof.angle_max;
         vector3 axisA, axisB;
-
-        if (i == 0) {
-            // Quaternion which rotates the axis of B so it's parallel to the
-            // the axis of A.
-            auto arc_quat = shortest_arc(axisB_x, axisA_x);
-
-            // Transform a non-axial vector in the frame of B onto A's space so
-            // the angular error can be calculated.
-            auto angle_axisB = edyn::rotate(conjugate(bodyA.orn) * arc_quat * bodyB.orn, frame[1].column(1));
-            dof.current_angle = std::atan2(dot(angle_axisB, frame[0].column(2)),
-                                           dot(angle_axisB, frame[0].column(1)));
-            axisA = axisA_x;
-            axisB = axisB_x;
-        } else {
-            auto axisA_other = rotate(bodyA.orn, frame[0].column(i == 1 ? 2 : 1));
-            auto cos_angle = std::clamp(dot(axisB_x, axisA_other), scalar(-1), scalar(1));
-            dof.current_angle = half_pi - std::acos(cos_angle);
-            auto axis = cross(axisA_other, axisB_x);
-
-            if (!try_normalize(axis)) {
-                axis = i == 1 ? vector3_z : vector3_y;
-            }
-
-            axisA = axisB = -axis;
-        }
+        dof.current_angle = get_angular_axes(*this, i, bodyA.orn, bodyB.orn, axisA_x, axisB_x, axisA, axisB);
 
         auto J = std::array<vector3, 4>{vector3_zero, axisA, vector3_zero, -axisB};
 
@@ -1,10 +1,17 @@
 #include "edyn/context/task.hpp"
 #include "edyn/config/config.h"
+#include "edyn/config/constants.hpp"
 #include "edyn/context/settings.hpp"
 #include "edyn/parallel/job_dispatcher.hpp"
+#include "edyn/parallel/worker.hpp"
 #include "edyn/serialization/memory_archive.hpp"
+#include "edyn/time/time.hpp"
+#include "edyn/util/profiling.hpp"
 #include "edyn/util/settings_util.hpp"
 #include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
 #include <entt/entity/registry.hpp>
 #include <entt/signal/delegate.hpp>
 
@@ -12,11 +19,15 @@ namespace edyn {
 
 struct parallel_for_context {
     using IndexType = size_t;
+    // Set in `state` when the waiting thread is asleep.
+    static constexpr size_t parked_bit = size_t(1) << (sizeof(size_t) * 8 - 1);
+
     std::atomic<IndexType> current;
     const IndexType last;
     const IndexType step;
     const IndexType chunk_size;
-    size_t count;
+    // Number of jobs which haven't finished yet and the parked bit.
+    std::atomic<size_t> state;
     bool done;
     std::mutex mutex;
     std::condition_variable cv;
@@ -28,42 +39,56 @@ struct parallel_for_context {
         , last(last)
         , step(step)
         , chunk_size(chunk_size)
-        , count(num_jobs)
+        , state(num_jobs)
         , done(false)
         , task(task)
     {}
 
     ~parallel_for_context() {
-        EDYN_ASSERT(count == 0);
+        EDYN_ASSERT((state.load(std::memory_order_relaxed) & ~parked_bit) == 0);
     }
 
     void decrement() {
-        std::lock_guard lock(mutex);
-        EDYN_ASSERT(count > 0);
-        --count;
-        done = count == 0;
-
-        // Normally, `notify_one` would be called without the lock being held.
-        // However, according to
-        // https://en.cppreference.com/w/cpp/thread/condition_variable/notify_one:
-        // "Notifying while under the lock may nevertheless be necessary when precise
-        // scheduling of events is required, e.g. if the waiting thread would exit
-        // the program if the condition is satisfied, causing destruction of the
-        // notifying thread's condition_variable."
-        // If the lock would be released right here, there is a very slim chance
-        // that `wait()` would be called in the other thread right after, before
-        // `notify_one()` below, where the lock would be acquired and the predicate
-        // would test true, causing `parallel_for` to return, thus destroying this
-        // object (since it is in the stack) and then everything down from here is
-        // undefined behavior.
-        if (done) {
+        auto prev = state.fetch_sub(1, std::memory_order_acq_rel);
+        EDYN_ASSERT((prev & ~parked_bit) > 0);
+
+        // Nothing in this object can be touched after the count reaches zero
+        // unless the waiting thread is parked, since it could return from
+        // `wait()` at any moment, destroying this object, which lives in its
+        // stack. If it is parked, it only wakes up once `done` is set under
+        // the lock, which is why the lock is held while notifying.
+        if (prev == (parked_bit | 1)) {
+            std::lock_guard lock(mutex);
+            done = true;
             cv.notify_one();
         }
     }
 
     void wait() {
-        std::unique_lock lock(mutex);
-        cv.wait(lock, [&] { return done; });
+        auto &dispatcher = job_dispatcher::current();
+        // Workers never park, since that would take them out of the pool
+        // while the jobs of nested tasks might still be queued.
+        const auto in_worker = worker::current() != nullptr;
+        unsigned spin_count = 0;
+
+        // Run other jobs in the meantime and spin for a while before parking.
+        while ((state.load(std::memory_order_acquire) & ~parked_bit) > 0) {
+            if (dispatcher.run_pending_job()) {
+                spin_count = 0;
+            } else if (!in_worker && ++spin_count > parallel_for_wait_spin_count) {
+                std::unique_lock lock(mutex);
+                auto prev = state.fetch_or(parked_bit, std::memory_order_acq_rel);
+
+                // The last job might have finished right before parking.
+                if (prev != 0) {
+                    cv.wait(lock, [&] { return done; });
+                }
+
+                return;
+            } else {
+                std::this_thread::yield();
+            }
+        }
     }
 };
 
@@ -155,13 +180,48 @@ void parallel_for_async_job_func(job::data_type &data) {
     }
 }
 
+// Tasks which run in a single job carry their delegates in the payload of the
+// job, thus no context has to be allocated and shared among jobs.
+struct single_job_task {
+    task_delegate_t task;
+    task_completion_delegate_t completion;
+    unsigned size;
+};
+
+static_assert(std::is_trivially_copyable_v<single_job_task>);
+static_assert(sizeof(single_job_task) <= job::data_size);
+
+void single_job_task_func(job::data_type &data) {
+    single_job_task ctx;
+    std::memcpy(&ctx, data.data(), sizeof(ctx));
+    ctx.task(0, ctx.size);
+
+    if (ctx.completion) {
+        ctx.completion();
+    }
+}
+
+static void enqueue_single_job_task(job_dispatcher &dispatcher, task_delegate_t task,
+                                    unsigned size, task_completion_delegate_t completion) {
+    auto ctx = single_job_task{task, completion, size};
+    auto child_job = job();
+    child_job.func = &single_job_task_func;
+    std::memcpy(child_job.data.data(), &ctx, sizeof(ctx));
+    dispatcher.async(child_job);
+}
+
 void enqueue_task_default(task_delegate_t task, unsigned size, task_completion_delegate_t completion) {
-    auto &dispatcher = job_dispatcher::global();
+    auto &dispatcher = job_dispatcher::current();
     auto num_workers = dispatcher.num_workers();
 
+    if (size > 0 && (size == 1 || num_workers == 1)) {
+        enqueue_single_job_task(dispatcher, task, size, completion);
+        return;
+    }
+
     // Size of chunk that will be processed per job iteration.
     auto count_per_worker_ceil = size / num_workers + (size % num_workers != 0);
-    auto chunk_size = std::max(count_per_worker_ceil, 1ull);
+    auto chunk_size = std::max(count_per_worker_ceil, size_t{1});
 
     // Number of jobs that will be dispatched. Must not be greater than number
     // of workers.
@@ -184,11 +244,18 @@ void enqueue_task_default(task_delegate_t task, unsigned size, task_completion_d
     }
 }
 
+void enqueue_continuation_default(task_delegate_t task) {
+    enqueue_single_job_task(job_dispatcher::current(), task, 1, {});
+}
+
 void enqueue_task_wait_default(task_delegate_t task, unsigned size) {
-    auto &dispatcher = job_dispatcher::global();
+    EDYN_PROFILE_ZONE("enqueue_task_wait");
+    auto &dispatcher = job_dispatcher::current();
+    auto collect_stats = dispatcher.collecting_stats();
+    auto start_time = collect_stats ? performance_time() : 0;
     auto num_workers = dispatcher.num_workers();
-    auto chunk_size = std::max(size / (num_workers + 1), 1ull);
-    auto num_jobs = std::min(num_workers, size - 1ull);
+    auto chunk_size = std::max(size / (num_workers + 1), size_t{1});
+    auto num_jobs = std::min(num_workers, size_t{size} - 1);
     auto context = parallel_for_context{0u, size, 1u, chunk_size, num_jobs, task};
 
     auto child_job = job();
@@ -205,8 +272,20 @@ void enqueue_task_wait_default(task_delegate_t task, unsigned size) {
     // Process chunks of the for loop in the current thread as well.
     run_parallel_for(context);
 
-    // Wait all background jobs to finish.
+    // Wait all background jobs to finish. The duration of this zone shows how
+    // unbalanced the chunks were.
+    EDYN_PROFILE_ZONE("wait");
+    auto wait_start_time = collect_stats ? performance_time() : 0;
     context.wait();
+
+    if (collect_stats) {
+        auto end_time = performance_time();
+        auto call = task_wait_call_stats{};
+        call.num_chunks = size / chunk_size + (size % chunk_size != 0);
+        call.duration = end_time - start_time;
+        call.wait_time = end_time - wait_start_time;
+        dispatcher.record_task_wait(call);
+    }
 }
 
 }
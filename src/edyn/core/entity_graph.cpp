@@ -1,10 +1,57 @@
 #include "edyn/core/entity_graph.hpp"
 #include "edyn/config/config.h"
+#include <algorithm>
 
 namespace edyn {
 
 static constexpr size_t allocation_size = 16;
 
+namespace internal {
+    void graph_visit_scratch::begin(size_t num_nodes, size_t num_edges) {
+        // Marks are only grown, never cleared, since old marks are stale once
+        // the epoch is incremented.
+        if (node_marks.size() < num_nodes) {
+            node_marks.resize(num_nodes, 0);
+        }
+
+        if (edge_marks.size() < num_edges) {
+            edge_marks.resize(num_edges, 0);
+        }
+
+        // Zero is reserved for unvisited elements.
+        if (++epoch == 0) {
+            std::fill(node_marks.begin(), node_marks.end(), 0);
+            std::fill(edge_marks.begin(), edge_marks.end(), 0);
+            epoch = 1;
+        }
+
+        to_visit.clear();
+    }
+
+    static graph_visit_scratch & thread_visit_scratch() {
+        static thread_local graph_visit_scratch scratch;
+        return scratch;
+    }
+
+    graph_visit_scope::graph_visit_scope(size_t num_nodes, size_t num_edges) {
+        auto &scratch = thread_visit_scratch();
+
+        if (scratch.in_use) {
+            m_local = std::make_unique<graph_visit_scratch>();
+            m_scratch = m_local.get();
+        } else {
+            m_scratch = &scratch;
+        }
+
+        m_scratch->in_use = true;
+        m_scratch->begin(num_nodes, num_edges);
+    }
+
+    graph_visit_scope::~graph_visit_scope() {
+        m_scratch->in_use = false;
+    }
+}
+
 entity_graph::index_type entity_graph::insert_node(entt::entity entity, bool non_connecting) {
     EDYN_ASSERT(entity != entt::null);
 
@@ -212,13 +259,17 @@ void entity_graph::remove_all_edges(index_type node_index) {
             neighbor_adj_index = neighbor_adj.next;
         }
 
-        adj_index = adj.next;
+        auto next_adj_index = adj.next;
 
         // Remove adjacency.
         adj.node_index = null_index;
         adj.edge_index = null_index;
         adj.next = m_adjacencies_free_list;
         m_adjacencies_free_list = adj_index;
+        --m_adjacency_count;
+        ++m_adjacency_changes;
+
+        adj_index = next_adj_index;
     }
 }
 
@@ -305,6 +356,8 @@ entity_graph::index_type entity_graph::create_adjacency(index_type destination_n
     adj.node_index = destination_node_index;
     adj.edge_index = edge_index;
     adj.next = null_index;
+    ++m_adjacency_count;
+    ++m_adjacency_changes;
 
     return index;
 }
@@ -352,14 +405,15 @@ void entity_graph::remove_adjacency(index_type source_node_index, index_type adj
     adj.edge_index = null_index;
     adj.next = m_adjacencies_free_list;
     m_adjacencies_free_list = adj_index;
+    --m_adjacency_count;
+    ++m_adjacency_changes;
 }
 
 bool entity_graph::is_single_connected_component() const {
     EDYN_ASSERT(m_node_count > 0);
 
-    std::vector<bool> visited;
-    visited.assign(m_nodes.size(), false);
-    std::vector<index_type> to_visit;
+    auto scope = internal::graph_visit_scope(m_nodes.size(), m_edges.size());
+    auto &to_visit = scope.to_visit();
 
     for (index_type i = 0; i < m_nodes.size(); ++i) {
         if (m_nodes[i].entity != entt::null &&
@@ -373,7 +427,7 @@ bool entity_graph::is_single_connected_component() const {
         auto node_index = to_visit.back();
         to_visit.pop_back();
 
-        visited[node_index] = true;
+        scope.set_node_visited(node_index, true);
         auto &node = m_nodes[node_index];
 
         if (node.non_connecting) {
@@ -385,9 +439,9 @@ bool entity_graph::is_single_connected_component() const {
         while (adj_index != null_index) {
             auto neighbor_index = m_adjacencies[adj_index].node_index;
 
-            if (!visited[neighbor_index]) {
+            if (!scope.node_visited(neighbor_index)) {
                 to_visit.push_back(neighbor_index);
-                visited[neighbor_index] = true;
+                scope.set_node_visited(neighbor_index, true);
             }
 
             adj_index = m_adjacencies[adj_index].next;
@@ -395,8 +449,8 @@ bool entity_graph::is_single_connected_component() const {
     }
 
     // Check if there's any one connecting node that has not been visited.
-    for (size_t i = 0; i < visited.size(); ++i) {
-        if (!visited[i] &&
+    for (size_t i = 0; i < m_nodes.size(); ++i) {
+        if (!scope.node_visited(i) &&
             m_nodes[i].entity != entt::null &&
             !m_nodes[i].non_connecting) {
             return false;
@@ -407,131 +461,163 @@ bool entity_graph::is_single_connected_component() const {
 }
 
 entity_graph::connected_components_t entity_graph::connected_components() const {
-    auto components = entity_graph::connected_components_t{};
-
-    std::vector<bool> visited;
-    std::vector<bool> visited_edges;
-    visited.assign(m_nodes.size(), false);
-    visited_edges.assign(m_edges.size(), false);
-
-    std::vector<index_type> to_visit;
+    // Disjoint-set forest where the root of each set is its node with the
+    // lowest index, thus sets are found in the order of their first node.
+    auto parents = std::vector<index_type>(m_nodes.size());
 
-    for (size_t node_index = 0; node_index < m_nodes.size(); ++node_index) {
-        auto &node = m_nodes[node_index];
-        if (node.entity != entt::null && !node.non_connecting) {
-            to_visit.push_back(node_index);
-            break;
-        }
+    for (index_type i = 0; i < parents.size(); ++i) {
+        parents[i] = i;
     }
 
-    std::vector<index_type> non_connecting_indices;
-
-    while (true) {
-        auto &connected = components.emplace_back();
+    auto find_root = [&](index_type node_index) {
+        while (parents[node_index] != node_index) {
+            // Path halving.
+            parents[node_index] = parents[parents[node_index]];
+            node_index = parents[node_index];
+        }
+        return node_index;
+    };
+
+    // Non-connecting nodes do not join the sets of their neighbors.
+    for (auto &edge : m_edges) {
+        if (edge.entity == entt::null ||
+            m_nodes[edge.node_index0].non_connecting ||
+            m_nodes[edge.node_index1].non_connecting) {
+            continue;
+        }
 
-        // Visit nodes reachable from the initial node inserted into `to_visit`.
-        while (!to_visit.empty()) {
-            auto node_index = to_visit.back();
-            to_visit.pop_back();
+        auto root0 = find_root(edge.node_index0);
+        auto root1 = find_root(edge.node_index1);
 
-            visited[node_index] = true;
+        if (root0 < root1) {
+            parents[root1] = root0;
+        } else if (root1 < root0) {
+            parents[root0] = root1;
+        }
+    }
 
-            const auto &node = m_nodes[node_index];
-            connected.nodes.push_back(node.entity);
+    auto components = entity_graph::connected_components_t{};
+    auto component_indices = std::vector<index_type>(m_nodes.size(), null_index);
 
-            if (node.non_connecting) {
-                non_connecting_indices.push_back(node_index);
-                continue;
-            }
+    for (index_type node_index = 0; node_index < m_nodes.size(); ++node_index) {
+        auto &node = m_nodes[node_index];
 
-            auto adj_index = node.adjacency_index;
+        if (node.entity == entt::null || node.non_connecting) {
+            continue;
+        }
 
-            while (adj_index != null_index) {
-                auto &adj = m_adjacencies[adj_index];
-                auto edge_index = adj.edge_index;
+        auto root = find_root(node_index);
 
-                while (edge_index != null_index) {
-                    auto &edge = m_edges[edge_index];
+        if (component_indices[root] == null_index) {
+            component_indices[root] = components.size();
+            components.emplace_back();
+        }
 
-                    if (!visited_edges[edge_index]) {
-                        EDYN_ASSERT(edge.entity != entt::null);
-                        connected.edges.push_back(edge.entity);
-                        visited_edges[edge_index] = true;
-                    }
+        components[component_indices[root]].nodes.push_back(node.entity);
+    }
 
-                    edge_index = edge.next;
-                }
+    // Edges belong to the component of their connecting nodes. Non-connecting
+    // nodes are present in the components of all their connecting neighbors.
+    auto non_connecting_nodes = std::vector<std::pair<index_type, index_type>>{};
 
-                auto neighbor_index = adj.node_index;
+    for (auto &edge : m_edges) {
+        if (edge.entity == entt::null) {
+            continue;
+        }
 
-                if (!visited[neighbor_index]) {
-                    to_visit.push_back(neighbor_index);
-                    // Mark as visited in advance to prevent inserting the same node index
-                    // in the `to_visit` array more than once.
-                    visited[neighbor_index] = true;
-                }
+        auto non_connecting0 = m_nodes[edge.node_index0].non_connecting;
+        auto non_connecting1 = m_nodes[edge.node_index1].non_connecting;
 
-                adj_index = adj.next;
-            }
+        // Edges between two non-connecting nodes are not reachable.
+        if (non_connecting0 && non_connecting1) {
+            continue;
         }
 
-        // Mark non-connecting nodes as unvisited so they'll be visited again
-        // once while traversing the next connected component.
-        for (auto node_index : non_connecting_indices) {
-            visited[node_index] = false;
-        }
-        non_connecting_indices.clear();
+        auto root = find_root(non_connecting0 ? edge.node_index1 : edge.node_index0);
+        auto component_index = component_indices[root];
+        components[component_index].edges.push_back(edge.entity);
 
-        // Look for a connecting node that has not yet been visited.
-        for (size_t node_index = 0; node_index < m_nodes.size(); ++node_index) {
-            if (!visited[node_index] &&
-                m_nodes[node_index].entity != entt::null &&
-                !m_nodes[node_index].non_connecting) {
-                to_visit.push_back(node_index);
-                break;
-            }
+        if (non_connecting0) {
+            non_connecting_nodes.emplace_back(component_index, edge.node_index0);
+        } else if (non_connecting1) {
+            non_connecting_nodes.emplace_back(component_index, edge.node_index1);
         }
+    }
 
-        // No more nodes left to visit.
-        if (to_visit.empty()) {
-            break;
-        }
+    std::sort(non_connecting_nodes.begin(), non_connecting_nodes.end());
+    non_connecting_nodes.erase(std::unique(non_connecting_nodes.begin(), non_connecting_nodes.end()),
+                               non_connecting_nodes.end());
+
+    for (auto [component_index, node_index] : non_connecting_nodes) {
+        components[component_index].nodes.push_back(m_nodes[node_index].entity);
     }
 
     return components;
 }
 
-double entity_graph::efficiency() const {
-    if (m_nodes.empty()) {
-        return 0;
+void entity_graph::optimize() {
+    // Rebuild the adjacency array with the adjacencies of each node stored
+    // contiguously in node order. Adjacency indices are not visible outside
+    // of the graph, thus only the edges have to be updated.
+    auto adjacencies = decltype(m_adjacencies)(m_adjacencies.get_allocator());
+    adjacencies.reserve(m_adjacency_count);
+    auto new_indices = std::vector<index_type>(m_adjacencies.size(), null_index);
+
+    for (auto &node : m_nodes) {
+        if (node.entity == entt::null || node.adjacency_index == null_index) {
+            continue;
+        }
+
+        auto adj_index = node.adjacency_index;
+        node.adjacency_index = adjacencies.size();
+
+        while (adj_index != null_index) {
+            auto adj = m_adjacencies[adj_index];
+            new_indices[adj_index] = adjacencies.size();
+            adj_index = adj.next;
+            adj.next = adj_index == null_index ? null_index : adjacencies.size() + 1;
+            adjacencies.push_back(adj);
+        }
     }
 
-    return (double)m_node_count / (double)m_nodes.size();
-}
+    for (auto &edge : m_edges) {
+        if (edge.entity == entt::null) {
+            continue;
+        }
 
-void entity_graph::optimize() {
-    // TODO: Remove all the rightmost free entries and sort the free lists.
-    /*for (size_t i = m_nodes.size() - 1; i > 0; --i) {
-        if (m_nodes[i].entity != entt::null) {
-            m_nodes.resize(i + 1);
+        edge.adj_index0 = new_indices[edge.adj_index0];
 
-            break;
+        if (edge.node_index0 != edge.node_index1) {
+            edge.adj_index1 = new_indices[edge.adj_index1];
         }
-    }*/
+    }
+
+    m_adjacencies = std::move(adjacencies);
+    m_adjacencies_free_list = null_index;
+    m_adjacency_count = m_adjacencies.size();
+    m_adjacency_changes = 0;
 }
 
 void entity_graph::optimize_if_needed() {
-    if (efficiency() < 0.6) {
+    if (needs_optimization()) {
         optimize();
     }
 }
 
+bool entity_graph::needs_optimization() const {
+    // Amortized over the changes, which make the adjacency lists of the nodes
+    // scattered over time.
+    return m_adjacency_changes > m_adjacency_count;
+}
+
 void entity_graph::clear() {
     m_nodes_free_list = null_index;
     m_edges_free_list = null_index;
     m_adjacencies_free_list = null_index;
     m_node_count = 0;
     m_edge_count = 0;
+    m_adjacency_count = 0;
+    m_adjacency_changes = 0;
 
     if (!m_nodes.empty()) {
         for (size_t i = 0; i < m_nodes.size(); ++i) {
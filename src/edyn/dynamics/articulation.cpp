@@ -0,0 +1,441 @@
+#include "edyn/dynamics/articulation.hpp"
+#include "edyn/config/config.h"
+#include "edyn/config/constants.hpp"
+#include "edyn/math/constants.hpp"
+#include "edyn/math/matrix3x3.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace edyn {
+
+using block = articulation::block;
+using node = articulation::node;
+
+bool can_solve_in_articulation(const constraint_row &row) {
+    return row.lower_limit <= -large_scalar && row.upper_limit >= large_scalar && row.eff_mass > 0;
+}
+
+// Inverts a small matrix in place using Gauss-Jordan elimination with partial
+// pivoting. Returns false if the matrix is singular.
+static bool invert(block &m, unsigned n) {
+    auto inv = block{};
+    auto scale = scalar(0);
+
+    for (unsigned i = 0; i < n; ++i) {
+        inv[i][i] = 1;
+
+        for (unsigned j = 0; j < n; ++j) {
+            scale = std::max(std::abs(m[i][j]), scale);
+        }
+    }
+
+    for (unsigned c = 0; c < n; ++c) {
+        auto pivot = c;
+
+        for (auto r = c + 1; r < n; ++r) {
+            if (std::abs(m[r][c]) > std::abs(m[pivot][c])) {
+                pivot = r;
+            }
+        }
+
+        if (std::abs(m[pivot][c]) <= EDYN_EPSILON * scale) {
+            return false;
+        }
+
+        std::swap(m[c], m[pivot]);
+        std::swap(inv[c], inv[pivot]);
+
+        auto inv_pivot = 1 / m[c][c];
+
+        for (unsigned j = 0; j < n; ++j) {
+            m[c][j] *= inv_pivot;
+            inv[c][j] *= inv_pivot;
+        }
+
+        for (unsigned r = 0; r < n; ++r) {
+            if (r == c || m[r][c] == 0) {
+                continue;
+            }
+
+            auto f = m[r][c];
+
+            for (unsigned j = 0; j < n; ++j) {
+                m[r][j] -= f * m[c][j];
+                inv[r][j] -= f * inv[c][j];
+            }
+        }
+    }
+
+    m = inv;
+    return true;
+}
+
+// Jacobian of one row with respect to one of its bodies, as a row of the
+// block which couples a joint node with a body node.
+static std::array<scalar, 6> get_row_jacobian(const constraint_row &row, solver_body_index_t body) {
+    auto side = row.body[0] == body ? 0 : 2;
+    auto &lin = row.J[side];
+    auto &ang = row.J[side + 1];
+    return {lin.x, lin.y, lin.z, ang.x, ang.y, ang.z};
+}
+
+// Block of the system which couples a node with its parent, with as many rows
+// as the size of the node and as many columns as the size of the parent.
+static block get_parent_coupling(const node &child, const node &parent,
+                                 const std::vector<constraint_row> &rows) {
+    auto H = block{};
+    auto &joint = child.is_body ? parent : child;
+    auto &body = child.is_body ? child : parent;
+
+    for (unsigned r = 0; r < joint.size; ++r) {
+        auto J = get_row_jacobian(rows[joint.rows[r]], body.body);
+
+        for (unsigned c = 0; c < 6; ++c) {
+            if (child.is_body) {
+                H[c][r] = J[c];
+            } else {
+                H[r][c] = J[c];
+            }
+        }
+    }
+
+    return H;
+}
+
+// Eliminates the nodes from the leaves to the root. The diagonal blocks of all
+// nodes are assigned first and then the children are subtracted from the
+// parents as they're eliminated.
+static bool factor(articulation &art, const std::vector<constraint_row> &rows,
+                   const std::vector<solver_body> &bodies) {
+    for (auto &n : art.nodes) {
+        n.D_inv = {};
+
+        if (n.is_body) {
+            auto &body = bodies[n.body];
+            auto mass = 1 / body.inv_m;
+            auto I = inverse_matrix_symmetric(body.inv_I);
+
+            for (unsigned i = 0; i < 3; ++i) {
+                n.D_inv[i][i] = mass;
+
+                for (unsigned j = 0; j < 3; ++j) {
+                    n.D_inv[i + 3][j + 3] = I[i][j];
+                }
+            }
+        }
+    }
+
+    for (auto &n : art.nodes) {
+        if (!invert(n.D_inv, n.size)) {
+            return false;
+        }
+
+        if (n.parent == articulation::no_parent) {
+            continue;
+        }
+
+        auto &parent = art.nodes[n.parent];
+        auto H = get_parent_coupling(n, parent, rows);
+
+        // L = D^-1 H.
+        for (unsigned i = 0; i < n.size; ++i) {
+            for (unsigned j = 0; j < parent.size; ++j) {
+                auto sum = scalar(0);
+
+                for (unsigned k = 0; k < n.size; ++k) {
+                    sum += n.D_inv[i][k] * H[k][j];
+                }
+
+                n.L[i][j] = sum;
+            }
+        }
+
+        // D_parent -= H^T L.
+        for (unsigned i = 0; i < parent.size; ++i) {
+            for (unsigned j = 0; j < parent.size; ++j) {
+                auto sum = scalar(0);
+
+                for (unsigned k = 0; k < n.size; ++k) {
+                    sum += H[k][i] * n.L[k][j];
+                }
+
+                parent.D_inv[i][j] -= sum;
+            }
+        }
+    }
+
+    return true;
+}
+
+static solver_body_index_t find_root(std::vector<solver_body_index_t> &sets, solver_body_index_t i) {
+    while (sets[i] != i) {
+        sets[i] = sets[sets[i]];
+        i = sets[i];
+    }
+
+    return i;
+}
+
+void make_articulations(const std::vector<articulation_joint> &joints,
+                        const std::vector<constraint_row> &rows,
+                        const std::vector<solver_body> &bodies,
+                        std::vector<articulation> &articulations,
+                        std::vector<unsigned> &articulated_rows) {
+    // Bodies with zero inverse mass are the ground and are left out of the
+    // tree. Bodies which can't rotate about some axis have no inertia matrix
+    // and can't be part of an articulation either.
+    auto is_ground = [&](solver_body_index_t idx) {
+        return bodies[idx].inv_m == 0;
+    };
+    auto can_articulate = [&](solver_body_index_t idx) {
+        return is_ground(idx) || std::abs(bodies[idx].inv_I.determinant()) > EDYN_EPSILON;
+    };
+
+    // Accept joints that do not close a loop, tracking which bodies are
+    // connected with a disjoint set. All ground bodies are the same node,
+    // thus a second joint attaching a tree to the ground closes a loop.
+    auto sets = std::vector<solver_body_index_t>(bodies.size());
+    std::iota(sets.begin(), sets.end(), solver_body_index_t{0});
+    auto find_set = [&](solver_body_index_t idx) {
+        return find_root(sets, is_ground(idx) ? fixed_solver_body_index : idx);
+    };
+    auto accepted = std::vector<articulation_joint>{};
+
+    for (auto &joint : joints) {
+        auto &first = rows[joint.first_row];
+        auto has_bilateral_rows = false;
+
+        for (unsigned i = 0; i < joint.num_rows; ++i) {
+            EDYN_ASSERT(rows[joint.first_row + i].body == first.body);
+            has_bilateral_rows |= can_solve_in_articulation(rows[joint.first_row + i]);
+        }
+
+        if (!has_bilateral_rows ||
+            !can_articulate(first.body[0]) || !can_articulate(first.body[1]) ||
+            (is_ground(first.body[0]) && is_ground(first.body[1]))) {
+            continue;
+        }
+
+        auto rootA = find_set(first.body[0]);
+        auto rootB = find_set(first.body[1]);
+
+        if (rootA == rootB) {
+            continue;
+        }
+
+        sets[rootA] = rootB;
+
+        accepted.push_back(joint);
+    }
+
+    if (accepted.empty()) {
+        return;
+    }
+
+    // Joints of each body in compressed form.
+    auto body_offsets = std::vector<unsigned>(bodies.size() + 1, 0);
+
+    for (auto &joint : accepted) {
+        for (auto body : rows[joint.first_row].body) {
+            if (!is_ground(body)) {
+                ++body_offsets[body + 1];
+            }
+        }
+    }
+
+    std::partial_sum(body_offsets.begin(), body_offsets.end(), body_offsets.begin());
+    auto body_joints = std::vector<unsigned>(body_offsets.back());
+    auto fill = std::vector<unsigned>(body_offsets.begin(), body_offsets.end() - 1);
+
+    for (unsigned j = 0; j < accepted.size(); ++j) {
+        for (auto body : rows[accepted[j].first_row].body) {
+            if (!is_ground(body)) {
+                body_joints[fill[body]++] = j;
+            }
+        }
+    }
+
+    // A joint attached to the ground has a zero diagonal block and no body
+    // on the other side, thus it can't be eliminated before its body. Trees
+    // which are attached to the ground, which happens through one joint at
+    // most, are rooted at that joint and the others at one of their bodies.
+    auto starts = std::vector<unsigned>(accepted.size());
+    std::iota(starts.begin(), starts.end(), 0u);
+    std::stable_partition(starts.begin(), starts.end(), [&](unsigned j) {
+        auto &body = rows[accepted[j].first_row].body;
+        return is_ground(body[0]) || is_ground(body[1]);
+    });
+
+    auto visited_joints = std::vector<bool>(accepted.size(), false);
+    auto stack = std::vector<std::pair<solver_body_index_t, unsigned>>{};
+
+    for (auto start : starts) {
+        if (visited_joints[start]) {
+            continue;
+        }
+
+        // Traverse the tree adding nodes in depth-first order, where parents
+        // come before their children, and reverse it afterwards.
+        auto art = articulation{};
+
+        auto add_body = [&](solver_body_index_t body, unsigned parent) {
+            auto &n = art.nodes.emplace_back();
+            n.parent = parent;
+            n.size = 6;
+            n.is_body = true;
+            n.body = body;
+            stack.emplace_back(body, static_cast<unsigned>(art.nodes.size() - 1));
+        };
+
+        auto add_joint = [&](unsigned j, solver_body_index_t from_body, unsigned parent) {
+            visited_joints[j] = true;
+            auto &joint = accepted[j];
+            auto &n = art.nodes.emplace_back();
+            n.parent = parent;
+            n.size = 0;
+            n.is_body = false;
+            n.body = fixed_solver_body_index;
+
+            for (unsigned i = 0; i < joint.num_rows && n.size < articulation::max_node_size; ++i) {
+                if (can_solve_in_articulation(rows[joint.first_row + i])) {
+                    n.rows[n.size++] = joint.first_row + i;
+                }
+            }
+
+            auto joint_node = static_cast<unsigned>(art.nodes.size() - 1);
+
+            for (auto body : rows[joint.first_row].body) {
+                if (body != from_body && !is_ground(body)) {
+                    add_body(body, joint_node);
+                }
+            }
+        };
+
+        auto &start_body = rows[accepted[start].first_row].body;
+
+        if (is_ground(start_body[0]) || is_ground(start_body[1])) {
+            add_joint(start, fixed_solver_body_index, articulation::no_parent);
+        } else {
+            add_body(start_body[0], articulation::no_parent);
+        }
+
+        while (!stack.empty()) {
+            auto [body, body_node] = stack.back();
+            stack.pop_back();
+
+            for (auto k = body_offsets[body]; k < body_offsets[body + 1]; ++k) {
+                if (auto j = body_joints[k]; !visited_joints[j]) {
+                    add_joint(j, body, body_node);
+                }
+            }
+        }
+
+        std::reverse(art.nodes.begin(), art.nodes.end());
+        const auto last = static_cast<unsigned>(art.nodes.size() - 1);
+
+        for (auto &n : art.nodes) {
+            if (n.parent != articulation::no_parent) {
+                n.parent = last - n.parent;
+            }
+        }
+
+        if (!factor(art, rows, bodies)) {
+            continue;
+        }
+
+        for (auto &n : art.nodes) {
+            if (!n.is_body) {
+                articulated_rows.insert(articulated_rows.end(), n.rows.begin(), n.rows.begin() + n.size);
+            }
+        }
+
+        articulations.push_back(std::move(art));
+    }
+
+    std::sort(articulated_rows.begin(), articulated_rows.end());
+}
+
+scalar solve_articulation(articulation &art, std::vector<constraint_row> &rows,
+                          std::vector<solver_body> &bodies) {
+    // The right hand side of the joint nodes is the velocity error of their
+    // rows and it's zero for the bodies.
+    for (auto &n : art.nodes) {
+        n.x = {};
+
+        if (n.is_body) {
+            continue;
+        }
+
+        for (unsigned i = 0; i < n.size; ++i) {
+            auto &row = rows[n.rows[i]];
+            auto &bodyA = bodies[row.body[0]];
+            auto &bodyB = bodies[row.body[1]];
+            auto delta_relvel = dot(row.J[0], bodyA.dv) +
+                                dot(row.J[1], bodyA.dw) +
+                                dot(row.J[2], bodyB.dv) +
+                                dot(row.J[3], bodyB.dw);
+            n.x[i] = row.rhs - delta_relvel;
+        }
+    }
+
+    // Forward substitution, from the leaves to the root.
+    for (auto &n : art.nodes) {
+        if (n.parent == articulation::no_parent) {
+            continue;
+        }
+
+        auto &parent = art.nodes[n.parent];
+
+        for (unsigned j = 0; j < parent.size; ++j) {
+            for (unsigned i = 0; i < n.size; ++i) {
+                parent.x[j] -= n.L[i][j] * n.x[i];
+            }
+        }
+    }
+
+    // Back substitution, from the root to the leaves.
+    for (auto it = art.nodes.rbegin(); it != art.nodes.rend(); ++it) {
+        auto &n = *it;
+        auto y = std::array<scalar, articulation::max_node_size>{};
+
+        for (unsigned i = 0; i < n.size; ++i) {
+            for (unsigned j = 0; j < n.size; ++j) {
+                y[i] += n.D_inv[i][j] * n.x[j];
+            }
+        }
+
+        if (n.parent != articulation::no_parent) {
+            auto &parent = art.nodes[n.parent];
+
+            for (unsigned i = 0; i < n.size; ++i) {
+                for (unsigned j = 0; j < parent.size; ++j) {
+                    y[i] -= n.L[i][j] * parent.x[j];
+                }
+            }
+        }
+
+        n.x = y;
+    }
+
+    // The solution of the joint nodes is the negated delta impulse.
+    auto max_delta_impulse = scalar(0);
+
+    for (auto &n : art.nodes) {
+        if (n.is_body) {
+            continue;
+        }
+
+        for (unsigned i = 0; i < n.size; ++i) {
+            auto &row = rows[n.rows[i]];
+            auto delta_impulse = -n.x[i];
+            row.impulse += delta_impulse;
+            apply_row_impulse(delta_impulse, row, bodies);
+            max_delta_impulse = std::max(std::abs(delta_impulse), max_delta_impulse);
+        }
+    }
+
+    return max_delta_impulse;
+}
+
+}
@@ -0,0 +1,37 @@
+#include "edyn/dynamics/constraint_row_prep_arena.hpp"
+
+namespace edyn {
+
+constraint_row_prep_arena & constraint_row_prep_arena_pool::acquire() {
+    auto lock = std::lock_guard(m_mutex);
+
+    if (m_num_acquired == m_arenas.size()) {
+        m_arenas.push_back(std::make_unique<constraint_row_prep_arena>(m_resource));
+    }
+
+    return *m_arenas[m_num_acquired++];
+}
+
+void constraint_row_prep_arena_pool::reset() {
+    auto lock = std::lock_guard(m_mutex);
+
+    for (size_t i = 0; i < m_num_acquired; ++i) {
+        m_arenas[i]->elements.clear();
+    }
+
+    m_num_acquired = 0;
+}
+
+size_t constraint_row_prep_arena_pool::num_bytes() {
+    auto lock = std::lock_guard(m_mutex);
+    auto size = m_arenas.capacity() * sizeof(m_arenas[0]);
+
+    for (auto &arena : m_arenas) {
+        size += sizeof(constraint_row_prep_arena) +
+                arena->elements.capacity() * sizeof(constraint_row_prep_element);
+    }
+
+    return size;
+}
+
+}
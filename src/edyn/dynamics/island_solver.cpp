@@ -15,12 +15,22 @@
 #include "edyn/constraints/constraint.hpp"
 #include "edyn/constraints/constraint_row_friction.hpp"
 #include "edyn/constraints/contact_constraint.hpp"
+#include "edyn/context/settings.hpp"
 #include "edyn/context/task.hpp"
 #include "edyn/context/task_util.hpp"
+#include "edyn/dynamics/articulation.hpp"
 #include "edyn/dynamics/island_constraint_entities.hpp"
+#include "edyn/dynamics/island_solver_stats.hpp"
 #include "edyn/dynamics/position_solver.hpp"
 #include "edyn/dynamics/row_cache.hpp"
+#include "edyn/dynamics/row_coloring.hpp"
+#include "edyn/dynamics/solver_body.hpp"
+#include "edyn/comp/delta_linvel.hpp"
+#include "edyn/comp/delta_angvel.hpp"
 #include "edyn/parallel/atomic_counter_sync.hpp"
+#include "edyn/sys/update_island_nodes.hpp"
+#include "edyn/util/profiling.hpp"
+#include "edyn/time/time.hpp"
 #include "edyn/util/entt_util.hpp"
 #include "edyn/util/island_util.hpp"
 #include "edyn/util/constraint_util.hpp"
@@ -29,6 +39,9 @@
 #include "edyn/config/config.h"
 #include <entt/entity/fwd.hpp>
 #include <entt/entity/registry.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstdint>
 #include <entt/signal/delegate.hpp>
 #include <iterator>
@@ -38,36 +51,31 @@
 
 namespace edyn {
 
-enum class island_solver_state : uint8_t {
-    pack_rows,
-    solve_constraints,
-    assign_applied_impulses,
-    apply_solution,
-    solve_position_constraints
-};
-
 struct island_solver_context {
     entt::registry *registry;
     entt::entity island_entity;
     atomic_counter_sync *counter_sync {nullptr};
     scalar dt;
-    uint8_t num_iterations;
-    uint8_t num_position_iterations;
-    uint8_t iteration {};
+    island_solver_params params;
+    unsigned iteration {};
     island_solver_state state {island_solver_state::pack_rows};
+    island_solver_stats *stats {nullptr};
 
     island_solver_context() = default;
 
     island_solver_context(entt::registry &registry, entt::entity island_entity,
-                          uint8_t num_iterations, uint8_t num_position_iterations,
-                          scalar dt, atomic_counter_sync *counter)
+                          const island_solver_params &params, scalar dt,
+                          atomic_counter_sync *counter)
         : registry(&registry)
         , island_entity(island_entity)
-        , num_iterations(num_iterations)
-        , num_position_iterations(num_position_iterations)
-        , dt(dt)
         , counter_sync(counter)
-    {}
+        , dt(dt)
+        , params(params)
+    {
+        if (params.collect_stats) {
+            stats = registry.try_get<island_solver_stats>(island_entity);
+        }
+    }
 
     void decrement_counter() {
         EDYN_ASSERT(counter_sync != nullptr);
@@ -75,105 +83,845 @@ struct island_solver_context {
     }
 };
 
+#ifdef EDYN_ENABLE_PROFILING
+static const char *island_solver_state_names[] = {
+    "pack_rows",
+    "solve_constraints",
+    "assign_applied_impulses",
+    "apply_solution",
+    "solve_position_constraints",
+    "update_nodes"
+};
+#endif
+
+// Accumulates the time spent in each state of the island solver into the
+// stats of the island, if present.
+struct island_solver_timer {
+    island_solver_stats *stats;
+    double start;
+
+    island_solver_timer(island_solver_stats *stats)
+        : stats(stats)
+        , start(stats ? performance_time() : 0)
+    {}
+
+    void record(island_solver_state state) {
+        if (stats) {
+            auto now = performance_time();
+            stats->state_time[static_cast<size_t>(state)] += now - start;
+            start = now;
+        }
+    }
+};
+
+// Records the residual of one velocity iteration.
+static void record_residual(island_solver_stats *stats, scalar residual) {
+    if (stats) {
+        if (stats->num_velocity_iterations++ == 0) {
+            stats->initial_residual = residual;
+        }
+
+        stats->final_residual = residual;
+    }
+}
+
 static void warm_start(row_cache &cache) {
-    for (auto &row : cache.rows) {
-        warm_start(row);
+    if (cache.rows_partitioned) {
+        for (auto i : cache.two_sided_rows) {
+            warm_start(cache.rows[i], cache.bodies);
+        }
+
+        for (auto i : cache.one_sided_rows[0]) {
+            warm_start_one_sided<0>(cache.rows[i], cache.bodies);
+        }
+
+        for (auto i : cache.one_sided_rows[1]) {
+            warm_start_one_sided<1>(cache.rows[i], cache.bodies);
+        }
+    } else {
+        for (auto &row : cache.rows) {
+            warm_start(row, cache.bodies);
+        }
     }
 
     for (auto &row : cache.friction) {
-        warm_start(row, cache.rows);
+        warm_start(row, cache.rows, cache.bodies);
     }
 
     for (auto &row : cache.rolling) {
-        warm_start(row, cache.rows);
+        warm_start(row, cache.rows, cache.bodies);
     }
 
     for (auto &row : cache.spinning) {
-        warm_start(row, cache.rows);
+        warm_start(row, cache.rows, cache.bodies);
     }
 }
 
-static void solve(row_cache &cache) {
-    for (auto &row : cache.rows) {
-        auto delta_impulse = solve(row);
-        apply_row_impulse(delta_impulse, row);
+// Solves the rows of one group of a partitioned row cache.
+template<size_t Side>
+static scalar solve_one_sided_rows(row_cache &cache) {
+    auto max_delta_impulse = scalar(0);
+
+    for (auto i : cache.one_sided_rows[Side]) {
+        auto &row = cache.rows[i];
+        auto delta_impulse = solve_one_sided<Side>(row, cache.bodies);
+        apply_row_impulse_one_sided<Side>(delta_impulse, row, cache.bodies);
+        max_delta_impulse = std::max(std::abs(delta_impulse), max_delta_impulse);
+    }
+
+    return max_delta_impulse;
+}
+
+// Solves the normal rows in order, solving the rows of each block together
+// once its first row is reached. Articulations are solved before all other
+// rows, which skip the articulated rows. If the rows are partitioned, they're
+// solved one group at a time instead.
+static scalar solve_normal_rows(row_cache &cache) {
+    auto max_delta_impulse = scalar(0);
+
+    for (auto &art : cache.articulations) {
+        max_delta_impulse = std::max(solve_articulation(art, cache.rows, cache.bodies), max_delta_impulse);
+    }
+
+    if (cache.rows_partitioned) {
+        for (auto i : cache.two_sided_rows) {
+            auto &row = cache.rows[i];
+            auto delta_impulse = solve(row, cache.bodies);
+            apply_row_impulse(delta_impulse, row, cache.bodies);
+            max_delta_impulse = std::max(std::abs(delta_impulse), max_delta_impulse);
+        }
+
+        max_delta_impulse = std::max(solve_one_sided_rows<0>(cache), max_delta_impulse);
+        max_delta_impulse = std::max(solve_one_sided_rows<1>(cache), max_delta_impulse);
+        return max_delta_impulse;
+    }
+
+    auto block_it = cache.blocks.begin();
+    auto articulated_it = cache.articulated_rows.begin();
+    const auto num_rows = cache.rows.size();
+
+    for (size_t i = 0; i < num_rows;) {
+        if (block_it != cache.blocks.end() && block_it->first_row == i) {
+            auto delta_impulse = solve_block(*block_it, cache.rows, cache.bodies);
+            max_delta_impulse = std::max(delta_impulse, max_delta_impulse);
+            i += block_it->num_rows;
+            ++block_it;
+            continue;
+        }
+
+        if (articulated_it != cache.articulated_rows.end() && *articulated_it == i) {
+            ++articulated_it;
+            ++i;
+            continue;
+        }
+
+        auto &row = cache.rows[i];
+        auto delta_impulse = solve(row, cache.bodies);
+        apply_row_impulse(delta_impulse, row, cache.bodies);
+        max_delta_impulse = std::max(std::abs(delta_impulse), max_delta_impulse);
+        ++i;
     }
 
+    return max_delta_impulse;
+}
+
+// Runs one solver iteration and returns the largest magnitude of the delta
+// impulses applied by the normal rows, which is used as the residual.
+static scalar solve(row_cache &cache) {
+#ifdef EDYN_SIMD_SOLVER
+    // Rows are not batched if there are blocks or articulations.
+    auto max_delta_impulse = cache.blocks.empty() && cache.articulations.empty() ?
+        solve(cache.soa, cache.rows, cache.bodies) : solve_normal_rows(cache);
+#else
+    auto max_delta_impulse = solve_normal_rows(cache);
+#endif
+
     for (auto &row : cache.friction) {
-        solve_friction(row, cache.rows);
+        solve_friction(row, cache.rows, cache.bodies);
     }
 
     for (auto &row : cache.rolling) {
-        solve_friction(row, cache.rows);
+        solve_friction(row, cache.rows, cache.bodies);
     }
 
     for (auto &row : cache.spinning) {
-        solve_spin_friction(row, cache.rows);
+        solve_spin_friction(row, cache.rows, cache.bodies);
+    }
+
+    return max_delta_impulse;
+}
+
+static scalar solve_color_entry(row_cache &cache, const row_color_entry &entry) {
+    auto &row = cache.rows[entry.row];
+    auto delta_impulse = solve(row, cache.bodies);
+    apply_row_impulse(delta_impulse, row, cache.bodies);
+
+    auto flags = cache.flags[entry.row];
+
+    if (flags & constraint_row_flag_friction) {
+        solve_friction(cache.friction[entry.friction], cache.rows, cache.bodies);
+    }
+
+    if (flags & constraint_row_flag_rolling_friction) {
+        solve_friction(cache.rolling[entry.rolling], cache.rows, cache.bodies);
+    }
+
+    if (flags & constraint_row_flag_spinning_friction) {
+        solve_spin_friction(cache.spinning[entry.spinning], cache.rows, cache.bodies);
+    }
+
+    return std::abs(delta_impulse);
+}
+
+struct solve_color_context {
+    row_cache *cache;
+    unsigned offset;
+    std::atomic<scalar> max_delta_impulse {0};
+
+    void task_func(unsigned start, unsigned end) {
+        auto local_max = scalar(0);
+
+        for (auto i = start; i < end; ++i) {
+            local_max = std::max(solve_color_entry(*cache, cache->color_entries[offset + i]), local_max);
+        }
+
+        auto current = max_delta_impulse.load(std::memory_order_relaxed);
+
+        while (current < local_max &&
+               !max_delta_impulse.compare_exchange_weak(current, local_max, std::memory_order_relaxed));
+    }
+};
+
+// Solves one iteration of a row cache which was partitioned with `color_rows`.
+// Colors are solved in order and the rows in each color are solved in
+// parallel if `mt` is true. Since rows of the same color have no bodies in
+// common, the result does not depend on how the work is split among threads,
+// or whether it's split at all. Returns the largest magnitude of the delta
+// impulses applied by the normal rows.
+static scalar solve_colored(entt::registry &registry, row_cache &cache, bool mt) {
+    constexpr unsigned max_sequential_size = 64;
+    auto num_colors = cache.color_offsets.size() - 1;
+    auto max_delta_impulse = scalar(0);
+
+    for (size_t c = 0; c < num_colors; ++c) {
+        auto begin = cache.color_offsets[c];
+        auto end = cache.color_offsets[c + 1];
+        auto size = end - begin;
+        auto is_overflow = cache.has_overflow_color && c == num_colors - 1;
+
+        if (!mt || is_overflow || size <= max_sequential_size) {
+            for (auto i = begin; i < end; ++i) {
+                max_delta_impulse = std::max(solve_color_entry(cache, cache.color_entries[i]), max_delta_impulse);
+            }
+        } else {
+            auto ctx = solve_color_context{};
+            ctx.cache = &cache;
+            ctx.offset = begin;
+            auto task = task_delegate_t(entt::connect_arg_t<&solve_color_context::task_func>{}, ctx);
+            enqueue_task_wait(registry, task, size);
+            max_delta_impulse = std::max(ctx.max_delta_impulse.load(std::memory_order_relaxed), max_delta_impulse);
+        }
+    }
+
+    return max_delta_impulse;
+}
+
+// Index of a body in the solver body array built by `pack_bodies`.
+template<typename ProceduralView>
+solver_body_index_t get_solver_body_index(const island &island, const ProceduralView &procedural_view,
+                                          entt::entity entity) {
+    if (!procedural_view.contains(entity)) {
+        return fixed_solver_body_index;
+    }
+
+    EDYN_ASSERT(island.nodes.contains(entity));
+    return static_cast<solver_body_index_t>(island.nodes.index(entity) + 1);
+}
+
+// Builds the solver body array of an island. The first body is shared by all
+// non-procedural entities and it is followed by one body per node in the
+// same order as in the packed array of `island.nodes`. Frozen bodies keep a
+// zero inverse mass and velocity, thus the rows do not move them.
+static void pack_bodies(entt::registry &registry, row_cache &cache, const island &island, bool substep) {
+    auto body_view = registry.view<mass_inv, inertia_world_inv, delta_linvel, delta_angvel, procedural_tag>(entt::exclude<frozen_tag>);
+    auto vel_view = registry.view<linvel, angvel>();
+    const auto *nodes = island.nodes.data();
+    const auto num_nodes = island.nodes.size();
+
+    cache.bodies.clear();
+    cache.bodies.reserve(num_nodes + 1);
+    cache.bodies.emplace_back();
+
+    if (substep) {
+        cache.body_substeps.clear();
+        cache.body_substeps.resize(num_nodes + 1);
+    }
+
+    for (size_t i = 0; i < num_nodes; ++i) {
+        auto &body = cache.bodies.emplace_back();
+        auto entity = nodes[i];
+
+        if (body_view.contains(entity)) {
+            auto [inv_m, inv_I, dv, dw] = body_view.get<mass_inv, inertia_world_inv, delta_linvel, delta_angvel>(entity);
+            body.inv_m = inv_m;
+            body.inv_I = inv_I;
+            body.dv = dv;
+            body.dw = dw;
+
+            if (substep) {
+                auto [v, w] = vel_view.get<linvel, angvel>(entity);
+                cache.body_substeps[i + 1].linvel = v;
+                cache.body_substeps[i + 1].angvel = w;
+            }
+        }
+    }
+}
+
+// Writes the delta velocities of the solver bodies back into the registry
+// after the solver iterations.
+static void scatter_bodies(entt::registry &registry, const row_cache &cache, const island &island) {
+    auto delta_view = registry.view<delta_linvel, delta_angvel, procedural_tag>();
+    const auto *nodes = island.nodes.data();
+    const auto num_nodes = island.nodes.size();
+
+    for (size_t i = 0; i < num_nodes; ++i) {
+        auto entity = nodes[i];
+
+        if (delta_view.contains(entity)) {
+            auto &body = cache.bodies[i + 1];
+            auto [dv, dw] = delta_view.get<delta_linvel, delta_angvel>(entity);
+            dv = body.dv;
+            dw = body.dw;
+        }
+    }
+}
+
+// Position of the next element to be written into each array of a row cache.
+struct row_cache_cursor {
+    size_t con {};
+    size_t row {};
+    size_t friction {};
+    size_t rolling {};
+    size_t spinning {};
+};
+
+// Returns the element at `index` and advances it. If not in place, a new
+// element is appended instead.
+template<typename T>
+T & next_element(std::vector<T> &vec, size_t &index, bool in_place) {
+    if (in_place) {
+        EDYN_ASSERT(index < vec.size());
+        return vec[index++];
     }
+
+    ++index;
+    return vec.emplace_back();
 }
 
+// Inserts the rows of the constraints of type `C` in the island, given by
+// `entities`, into the cache. If `in_place` is true, the layout of the cache
+// from the last step is expected to match, i.e. the same constraints with the
+// same number of rows and friction rows, and the existing rows are
+// overwritten. Returns false if the layout does not match, in which case the
+// cache must be rebuilt.
 template<typename C>
-void insert_rows(entt::registry &registry, row_cache &cache, const entt::sparse_set &entities,
-                 island_constraint_entities &constraint_entities) {
+bool insert_rows(entt::registry &registry, row_cache &cache, const island &island,
+                 const std::vector<entt::entity> &entities,
+                 row_cache_cursor &cursor, bool in_place, bool substep) {
     auto prep_view = registry.view<constraint_row_prep_cache>();
     auto con_view = registry.view<C>();
-    auto con_idx = tuple_index_of<unsigned, C>(constraints_tuple);
+    auto procedural_view = registry.view<procedural_tag>();
 
     for (auto entity : entities) {
-        if (!con_view.contains(entity)) {
-            continue;
-        }
-
         EDYN_ASSERT((!registry.any_of<disabled_tag>(entity)));
         EDYN_ASSERT((!registry.any_of<sleeping_tag>(entity)));
 
-        // Insert entity into array located at the constraint type index.
-        constraint_entities.entities[con_idx].push_back(entity);
-
         auto [prep_cache] = prep_view.get(entity);
 
-        // Insert the number of rows for the current constraint before consuming.
-        cache.con_num_rows.push_back(prep_cache.current_num_rows());
+        if (in_place) {
+            if (cache.con_num_rows[cursor.con] != prep_cache.current_num_rows()) {
+                return false;
+            }
+        } else {
+            // Insert the number of rows for the current constraint before consuming.
+            cache.con_num_rows.push_back(prep_cache.current_num_rows());
+        }
+
+        ++cursor.con;
+
+        auto [con] = con_view.get(entity);
+        auto body_indexA = get_solver_body_index(island, procedural_view, con.body[0]);
+        auto body_indexB = get_solver_body_index(island, procedural_view, con.body[1]);
+        auto flags_match = true;
 
         // Insert all constraint rows into island row cache. Since an entity
         // can have multiple constraints (of different types), these could be
         // rows of more than one constraint.
         prep_cache.consume_rows([&](constraint_row_prep_cache::element &elem) {
-            auto normal_row_index = cache.rows.size();
-            cache.rows.push_back(elem.row);
-            cache.flags.push_back(elem.flags);
+            if (in_place && (!flags_match || cache.flags[cursor.row] != elem.flags)) {
+                flags_match = false;
+                return;
+            }
+
+            auto normal_row_index = cursor.row;
+
+            if (!in_place) {
+                cache.flags.push_back(elem.flags);
+            }
+
+            if (substep) {
+                // Split the right hand side calculated in `prepare_row` so
+                // that the position error term can be updated later. Rows
+                // with an infinite error only use it to saturate the limits.
+                auto &options = elem.options;
+                auto &entry = in_place ? cache.row_substeps[cursor.row] : cache.row_substeps.emplace_back();
+
+                if (std::abs(options.error) < large_scalar) {
+                    entry.velocity_rhs = elem.row.rhs + options.error * options.erp;
+                    entry.error = options.error;
+                    entry.erp = options.erp;
+                } else {
+                    entry.velocity_rhs = elem.row.rhs;
+                    entry.error = 0;
+                    entry.erp = 0;
+                }
+            }
+
+            auto &row = next_element(cache.rows, cursor.row, in_place);
+            row = elem.row;
+            row.body = {body_indexA, body_indexB};
 
             if (elem.flags & constraint_row_flag_friction) {
-                cache.friction.push_back(elem.friction);
-                cache.friction.back().normal_row_index = normal_row_index;
+                auto &friction = next_element(cache.friction, cursor.friction, in_place);
+                friction = elem.friction;
+                friction.normal_row_index = normal_row_index;
             }
 
             if (elem.flags & constraint_row_flag_rolling_friction) {
-                cache.rolling.push_back(elem.rolling);
-                cache.rolling.back().normal_row_index = normal_row_index;
+                auto &rolling = next_element(cache.rolling, cursor.rolling, in_place);
+                rolling = elem.rolling;
+                rolling.normal_row_index = normal_row_index;
             }
 
             if (elem.flags & constraint_row_flag_spinning_friction) {
-                cache.spinning.push_back(elem.spinning);
-                cache.spinning.back().normal_row_index = normal_row_index;
+                auto &spinning = next_element(cache.spinning, cursor.spinning, in_place);
+                spinning = elem.spinning;
+                spinning.normal_row_index = normal_row_index;
             }
         });
+
+        if (!flags_match) {
+            return false;
+        }
     }
+
+    return true;
 }
 
-void pack_rows(entt::registry &registry, row_cache &cache, const entt::sparse_set &entities,
-               island_constraint_entities &constraint_entities) {
-    cache.clear();
+// Groups the constraint entities of the island by type, in the order they
+// appear in the island. The type recorded in the preparation cache of each
+// entity is checked first, thus the storage of every constraint type is only
+// checked for entities with constraints of multiple types.
+static void collect_constraint_entities(entt::registry &registry, const island &island,
+                                        island_constraint_entities::entity_array &entities) {
+    auto prep_view = registry.view<constraint_row_prep_cache>();
+    auto pools = std::apply([&](auto ... c) {
+        return std::array<const entt::sparse_set *, sizeof...(c)>{&registry.storage<decltype(c)>()...};
+    }, constraints_tuple);
 
-    for (auto &ents : constraint_entities.entities) {
+    for (auto &ents : entities) {
         ents.clear();
     }
 
-    std::apply([&](auto ... c) {
-        (insert_rows<decltype(c)>(registry, cache, entities, constraint_entities), ...);
+    for (auto entity : island.edges) {
+        if (!prep_view.contains(entity)) {
+            continue;
+        }
+
+        auto type_index = prep_view.get<constraint_row_prep_cache>(entity).type_index;
+
+        if (type_index < pools.size() && pools[type_index]->contains(entity)) {
+            entities[type_index].push_back(entity);
+            continue;
+        }
+
+        for (size_t i = 0; i < pools.size(); ++i) {
+            if (pools[i]->contains(entity)) {
+                entities[i].push_back(entity);
+            }
+        }
+    }
+}
+
+// Tries to refresh the rows of the cache in place, which is possible if the
+// island has the same constraints and number of rows as in the last step.
+// This avoids clearing the cache and appending all rows again.
+static bool refresh_rows(entt::registry &registry, row_cache &cache, const island &island,
+                         island_constraint_entities &constraint_entities, bool substep) {
+    // The island must have the same constraints as in the last step.
+    if (cache.con_num_rows.empty() || constraint_entities.next_entities != constraint_entities.entities) {
+        return false;
+    }
+
+    if (substep) {
+        cache.row_substeps.resize(cache.rows.size());
+    }
+
+    auto cursor = row_cache_cursor{};
+    auto success = std::apply([&](auto ... c) {
+        return (insert_rows<decltype(c)>(registry, cache, island,
+                                         constraint_entities.entities[tuple_index_of<unsigned, decltype(c)>(constraints_tuple)],
+                                         cursor, true, substep) && ...);
     }, constraints_tuple);
 
+    if (success && cursor.con == cache.con_num_rows.size()) {
+        EDYN_ASSERT(cursor.row == cache.rows.size());
+        EDYN_ASSERT(cursor.friction == cache.friction.size());
+        EDYN_ASSERT(cursor.rolling == cache.rolling.size());
+        EDYN_ASSERT(cursor.spinning == cache.spinning.size());
+
+        // Colors and batches are assigned again after the rows are refreshed.
+        cache.color_entries.clear();
+        cache.color_offsets.clear();
+        cache.has_overflow_color = false;
+        cache.blocks.clear();
+        cache.articulations.clear();
+        cache.articulated_rows.clear();
+        cache.rows_partitioned = false;
+#ifdef EDYN_SIMD_SOLVER
+        cache.soa.clear();
+#endif
+        return true;
+    }
+
+    // Rows might have been partially consumed. Rewind so they can be
+    // consumed again while rebuilding the cache.
+    auto prep_view = registry.view<constraint_row_prep_cache>();
+
+    for (auto entity : island.edges) {
+        if (prep_view.contains(entity)) {
+            prep_view.get<constraint_row_prep_cache>(entity).current_constraint_index = 0;
+        }
+    }
+
+    return false;
+}
+
+// Groups the normal rows of each contact manifold into a block. The rows of
+// contact constraints follow the rows of the constraint types that come
+// before it in `constraints_tuple`. Manifolds with a single point or with
+// soft contact rows, which have an upper limit, are solved row by row.
+static void pack_contact_blocks(row_cache &cache, const island_constraint_entities &constraint_entities) {
+    auto contact_idx = tuple_index_of<unsigned, contact_constraint>(constraints_tuple);
+    size_t con_idx = 0;
+    size_t row_idx = 0;
+
+    for (unsigned i = 0; i < contact_idx; ++i) {
+        for (size_t j = 0; j < constraint_entities.entities[i].size(); ++j) {
+            row_idx += cache.con_num_rows[con_idx++];
+        }
+    }
+
+    auto num_contacts = constraint_entities.entities[contact_idx].size();
+    cache.blocks.clear();
+    cache.blocks.reserve(num_contacts);
+
+    for (size_t i = 0; i < num_contacts; ++i) {
+        unsigned num_rows = cache.con_num_rows[con_idx++];
+        auto first = cache.rows.begin() + row_idx;
+
+        if (num_rows > 1 && num_rows <= constraint_row_block::max_rows &&
+            std::all_of(first, first + num_rows, can_solve_in_block)) {
+            auto &block = cache.blocks.emplace_back();
+            block.first_row = static_cast<unsigned>(row_idx);
+            block.num_rows = num_rows;
+            prepare_block(block, cache.rows, cache.bodies);
+        }
+
+        row_idx += num_rows;
+    }
+}
+
+// Groups the rows of the constraints with an `articulation_tag` into
+// articulations. The rows of each constraint type follow the rows of the types
+// that come before it in `constraints_tuple`, and contacts are never
+// articulated. If `distance_chains` is set, untagged distance constraints
+// whose bodies have no more than two of them, i.e. the links of ropes and
+// chains, are articulated as well, after the tagged constraints. Links at
+// branch points are solved iteratively.
+static void pack_articulations(entt::registry &registry, row_cache &cache,
+                               const island_constraint_entities &constraint_entities,
+                               bool distance_chains) {
+    auto articulation_view = registry.view<articulation_tag>();
+    auto distance_idx = tuple_index_of<unsigned, distance_constraint>(constraints_tuple);
+    distance_chains = distance_chains && !constraint_entities.entities[distance_idx].empty();
+
+    if (articulation_view.empty() && !distance_chains) {
+        return;
+    }
+
+    auto contact_idx = tuple_index_of<unsigned, contact_constraint>(constraints_tuple);
+    auto joints = std::vector<articulation_joint>{};
+    auto links = std::vector<articulation_joint>{};
+    auto num_links = std::vector<unsigned>{};
+    size_t con_idx = 0;
+    unsigned row_idx = 0;
+
+    if (distance_chains) {
+        num_links.assign(cache.bodies.size(), 0);
+    }
+
+    for (unsigned i = 0; i < contact_idx; ++i) {
+        for (auto entity : constraint_entities.entities[i]) {
+            unsigned num_rows = cache.con_num_rows[con_idx++];
+
+            if (num_rows > 0) {
+                if (articulation_view.contains(entity)) {
+                    joints.push_back({row_idx, num_rows});
+                } else if (distance_chains && i == distance_idx) {
+                    links.push_back({row_idx, num_rows});
+
+                    for (auto body : cache.rows[row_idx].body) {
+                        ++num_links[body];
+                    }
+                }
+            }
+
+            row_idx += num_rows;
+        }
+    }
+
+    for (auto &link : links) {
+        auto &row = cache.rows[link.first_row];
+        auto in_chain = std::all_of(row.body.begin(), row.body.end(), [&](auto body) {
+            return cache.bodies[body].inv_m == 0 || num_links[body] <= 2;
+        });
+
+        if (in_chain) {
+            joints.push_back(link);
+        }
+    }
+
+    cache.articulations.clear();
+    cache.articulated_rows.clear();
+
+    if (!joints.empty()) {
+        make_articulations(joints, cache.rows, cache.bodies, cache.articulations, cache.articulated_rows);
+    }
+}
+
+// Partitions the normal rows by which of their bodies are dynamic so that rows
+// against the fixed body, such as contacts with static geometry, are solved
+// with the one-sided row functions without branching in the solver loop.
+static void partition_rows(row_cache &cache) {
+    cache.two_sided_rows.clear();
+    cache.one_sided_rows[0].clear();
+    cache.one_sided_rows[1].clear();
+
+    for (unsigned i = 0; i < cache.rows.size(); ++i) {
+        auto &row = cache.rows[i];
+        auto fixedA = row.body[0] == fixed_solver_body_index;
+        auto fixedB = row.body[1] == fixed_solver_body_index;
+
+        if (fixedA && !fixedB) {
+            cache.one_sided_rows[1].push_back(i);
+        } else if (fixedB && !fixedA) {
+            cache.one_sided_rows[0].push_back(i);
+        } else {
+            cache.two_sided_rows.push_back(i);
+        }
+    }
+
+    cache.rows_partitioned = true;
+}
+
+void pack_rows(entt::registry &registry, row_cache &cache, const island &island,
+               island_constraint_entities &constraint_entities, bool color, bool substep,
+               bool block, bool distance_chains) {
+    collect_constraint_entities(registry, island, constraint_entities.next_entities);
+
+    if (!refresh_rows(registry, cache, island, constraint_entities, substep)) {
+        cache.clear();
+        std::swap(constraint_entities.entities, constraint_entities.next_entities);
+
+        auto cursor = row_cache_cursor{};
+        std::apply([&](auto ... c) {
+            (insert_rows<decltype(c)>(registry, cache, island,
+                                      constraint_entities.entities[tuple_index_of<unsigned, decltype(c)>(constraints_tuple)],
+                                      cursor, false, substep), ...);
+        }, constraints_tuple);
+    }
+
+    // Body indices in the rows only depend on the order of the nodes in the
+    // island, thus bodies can be packed after the rows.
+    pack_bodies(registry, cache, island, substep);
+
+    if (block && !color) {
+        pack_contact_blocks(cache, constraint_entities);
+    }
+
+    if (!color) {
+        pack_articulations(registry, cache, constraint_entities, distance_chains);
+    }
+
+#ifndef EDYN_SIMD_SOLVER
+    // Colored rows, blocks and articulations are solved in their own order.
+    if (!color && cache.blocks.empty() && cache.articulations.empty()) {
+        partition_rows(cache);
+    }
+#endif
+
     warm_start(cache);
+
+    if (color) {
+        color_rows(cache);
+
+        if (substep) {
+            // The fixed bodies appended during coloring do not move.
+            cache.body_substeps.resize(cache.bodies.size());
+        }
+
+        return;
+    }
+
+#ifdef EDYN_SIMD_SOLVER
+    if (cache.blocks.empty() && cache.articulations.empty()) {
+        pack_row_batches(cache.soa, cache.rows, cache.bodies);
+    }
+#endif
+}
+
+// Resets the stats of an island and counts the normal rows of each constraint
+// type and how many of them were warm-started. The number of rows of each
+// constraint is stored in `con_num_rows` in the same order as the entities.
+static void reset_stats(island_solver_stats &stats, const row_cache &cache,
+                        const island_constraint_entities &constraint_entities) {
+    stats = {};
+    size_t con_idx = 0;
+
+    for (size_t i = 0; i < constraint_entities.entities.size(); ++i) {
+        unsigned num_rows = 0;
+
+        for (size_t j = 0; j < constraint_entities.entities[i].size(); ++j) {
+            num_rows += cache.con_num_rows[con_idx++];
+        }
+
+        stats.num_rows[i] = num_rows;
+    }
+
+    for (auto &row : cache.rows) {
+        if (row.impulse != 0) {
+            ++stats.num_warm_started_rows;
+        }
+    }
+}
+
+// Recalculates the right hand side of the normal rows using the position
+// error at the start of the step plus a linear approximation of its change
+// due to the displacement of the bodies in the substeps done so far. The bias
+// is removed from the rows during relaxation.
+static void update_substep_rhs(row_cache &cache, scalar dt, scalar h, bool relax) {
+    EDYN_ASSERT(cache.row_substeps.size() == cache.rows.size());
+
+    for (size_t i = 0; i < cache.rows.size(); ++i) {
+        auto &row = cache.rows[i];
+        auto &entry = cache.row_substeps[i];
+
+        if (relax || entry.erp == 0) {
+            row.rhs = entry.velocity_rhs;
+            continue;
+        }
+
+        auto &bodyA = cache.body_substeps[row.body[0]];
+        auto &bodyB = cache.body_substeps[row.body[1]];
+        auto error = entry.error * dt +
+                     dot(row.J[0], bodyA.linear_displacement) +
+                     dot(row.J[1], bodyA.angular_displacement) +
+                     dot(row.J[2], bodyB.linear_displacement) +
+                     dot(row.J[3], bodyB.angular_displacement);
+        row.rhs = entry.velocity_rhs - error * entry.erp / h;
+    }
+
+#ifdef EDYN_SIMD_SOLVER
+    if (!cache.soa.batches.empty()) {
+        update_row_batch_rhs(cache.soa, cache.rows);
+    }
+#endif
+}
+
+static void integrate_substep(row_cache &cache, scalar h) {
+    EDYN_ASSERT(cache.body_substeps.size() == cache.bodies.size());
+
+    for (size_t i = 0; i < cache.bodies.size(); ++i) {
+        auto &body = cache.bodies[i];
+        auto &substep = cache.body_substeps[i];
+        substep.linear_displacement += (substep.linvel + body.dv) * h;
+        substep.angular_displacement += (substep.angvel + body.dw) * h;
+    }
+}
+
+// Runs one substep, where rows are solved with a bias that corrects position
+// error in the duration of the substep, then bodies are moved forward and
+// the rows are solved once more without bias to remove the velocity that was
+// added to correct the error, which would otherwise cause overshooting.
+static void solve_substep(entt::registry &registry, row_cache &cache, scalar dt,
+                          unsigned num_substeps, unsigned num_iterations, bool color, bool mt,
+                          island_solver_stats *stats) {
+    auto h = dt / num_substeps;
+    auto solve_iteration = [&]() {
+        return color ? solve_colored(registry, cache, mt) : solve(cache);
+    };
+
+    update_substep_rhs(cache, dt, h, false);
+
+    for (unsigned i = 0; i < num_iterations; ++i) {
+        record_residual(stats, solve_iteration());
+    }
+
+    integrate_substep(cache, h);
+
+    update_substep_rhs(cache, dt, h, true);
+    solve_iteration();
+}
+
+// Number of velocity iterations per substep. The velocity iterations are
+// distributed among substeps so the cost is similar to not substepping.
+static unsigned get_substep_iterations(unsigned num_iterations, unsigned num_substeps) {
+    return std::max(num_iterations / num_substeps, 1u);
+}
+
+// Whether the velocity iterations can stop early in adaptive mode, which
+// happens once the residual of the last iteration is below the tolerance.
+static bool has_converged(const island_solver_params &params, unsigned iteration, scalar residual) {
+    return params.velocity_tolerance > 0 &&
+           iteration >= params.min_velocity_iterations &&
+           residual < params.velocity_tolerance;
+}
+
+// Applies the delta velocities and the displacement accumulated over all
+// substeps to the bodies of the island. This replaces `apply_solution` when
+// substepping.
+static void apply_substep_solution(entt::registry &registry, const row_cache &cache,
+                                   const island &island, scalar dt) {
+    auto view = registry.view<position, orientation, linvel, angvel, dynamic_tag>();
+    const auto *nodes = island.nodes.data();
+    const auto num_nodes = island.nodes.size();
+
+    for (size_t i = 0; i < num_nodes; ++i) {
+        auto entity = nodes[i];
+
+        if (!view.contains(entity)) {
+            continue;
+        }
+
+        auto [pos, orn, v, w] = view.get(entity);
+        auto &body = cache.bodies[i + 1];
+        auto &substep = cache.body_substeps[i + 1];
+        v += body.dv;
+        w += body.dw;
+        pos += substep.linear_displacement;
+        orn = integrate(orn, substep.angular_displacement / dt, dt);
+    }
 }
 
 template<typename C>
@@ -182,7 +930,11 @@ void update_impulse(entt::registry &registry, const std::vector<entt::entity> &e
                     size_t &rolling_row_idx, size_t &spinning_row_idx) {
     auto con_view = registry.view<C>();
     auto manifold_view = registry.view<contact_manifold>();
-    std::vector<scalar> applied_impulses;
+    auto breakable_view = registry.view<breakable_constraint>();
+    const auto any_breakable = !registry.storage<breakable_constraint>().empty();
+    // Reused by all islands solved in this thread to avoid allocating in
+    // every step. It's a vector since it's passed to the constraints.
+    static thread_local std::vector<scalar> applied_impulses;
 
     for (auto entity : entities) {
         auto [con] = con_view.get(entity);
@@ -219,6 +971,20 @@ void update_impulse(entt::registry &registry, const std::vector<entt::entity> &e
             }
 
             con.store_applied_impulses(applied_impulses);
+
+            if (any_breakable && breakable_view.contains(entity)) {
+                auto impulse_sqr = scalar(0);
+
+                for (auto impulse : applied_impulses) {
+                    impulse_sqr += impulse * impulse;
+                }
+
+                auto threshold = breakable_view.template get<breakable_constraint>(entity).impulse_threshold;
+
+                if (impulse_sqr > threshold * threshold) {
+                    cache.broken_constraints.push_back({entity, con.body, std::sqrt(impulse_sqr)});
+                }
+            }
         }
 
         applied_impulses.clear();
@@ -270,104 +1036,221 @@ public:
     static constexpr bool value = sizeof(test<T>(0)) == sizeof(yes);
 };
 
-template<typename C, typename BodyView, typename OriginView, typename ProceduralView>
-scalar solve_position_constraints_each(entt::registry &registry, const std::vector<entt::entity> &entities,
-                                       const BodyView &body_view, const OriginView &origin_view,
-                                       const ProceduralView &procedural_view) {
-    auto max_error = scalar(0);
+// Copies the transform of a body into a position solver body, which is
+// assigned zero inverse mass and inertia.
+template<typename TransformView, typename OriginView>
+void pack_position_body(position_solver_body &body, entt::entity entity,
+                        const TransformView &tr_view, const OriginView &origin_view) {
+    auto [pos, orn] = tr_view.template get<position, orientation>(entity);
+    body.pos = pos;
+    body.orn = orn;
+    body.inv_m = 0;
+    body.inv_I = {matrix3x3_zero};
+    body.inv_I_local = {matrix3x3_zero};
+    body.has_origin = origin_view.contains(entity);
+
+    if (body.has_origin) {
+        auto [orig, com] = origin_view.template get<origin, center_of_mass>(entity);
+        body.orig = orig;
+        body.com = com;
+    }
+}
 
-    if constexpr(has_solve_position<C>::value) {
-        auto con_view = registry.view<C>();
-        auto manifold_view = registry.view<contact_manifold>();
-        auto solver = position_solver{};
-
-        // Masses and inertias to be used for non-procedural entities.
-        mass inv_mA {0}, inv_mB {0};
-        inertia_world_inv inv_IA {matrix3x3_zero}, inv_IB{matrix3x3_zero};
-        inertia_inv inv_IA_local{matrix3x3_zero}, inv_IB_local{matrix3x3_zero};
-
-        for (auto entity : entities) {
-            auto [con] = con_view.get(entity);
-            auto [posA, ornA] = body_view.template get<position, orientation>(con.body[0]);
-            auto [posB, ornB] = body_view.template get<position, orientation>(con.body[1]);
-
-            solver.posA = &posA;
-            solver.posB = &posB;
-            solver.ornA = &ornA;
-            solver.ornB = &ornB;
-
-            if (procedural_view.contains(con.body[0])) {
-                solver.inv_mA = body_view.template get<mass_inv>(con.body[0]);
-                solver.inv_IA = &body_view.template get<inertia_world_inv>(con.body[0]);
-                solver.inv_IA_local = &body_view.template get<inertia_inv>(con.body[0]);
-            } else {
-                solver.inv_mA = inv_mA;
-                solver.inv_IA = &inv_IA;
-                solver.inv_IA_local = &inv_IA_local;
+// Builds the position solver bodies and constraint entries of an island. The
+// bodies of the nodes are in the same order as in `pack_bodies` and each
+// reference to a non-procedural body gets its own copy. Only constraint
+// types which implement `solve_position` are inserted.
+static void pack_position_constraints(entt::registry &registry, row_cache &cache, const island &island,
+                                      const island_constraint_entities &constraint_entities) {
+    auto tr_view = registry.view<position, orientation>();
+    auto mass_view = registry.view<mass_inv, inertia_world_inv, inertia_inv, procedural_tag>(entt::exclude<frozen_tag>);
+    auto origin_view = registry.view<origin, center_of_mass>();
+    auto procedural_view = registry.view<procedural_tag>();
+    const auto *nodes = island.nodes.data();
+    const auto num_nodes = island.nodes.size();
+
+    cache.position_bodies.clear();
+    cache.position_entries.clear();
+    cache.position_color_offsets.clear();
+    cache.position_has_overflow_color = false;
+    cache.position_bodies.resize(num_nodes + 1);
+
+    for (size_t i = 0; i < num_nodes; ++i) {
+        auto entity = nodes[i];
+
+        if (procedural_view.contains(entity)) {
+            auto &body = cache.position_bodies[i + 1];
+            pack_position_body(body, entity, tr_view, origin_view);
+
+            if (mass_view.contains(entity)) {
+                auto [inv_m, inv_I, inv_I_local] = mass_view.get<mass_inv, inertia_world_inv, inertia_inv>(entity);
+                body.inv_m = inv_m;
+                body.inv_I = inv_I;
+                body.inv_I_local = inv_I_local;
             }
+        }
+    }
 
-            if (procedural_view.contains(con.body[1])) {
-                solver.inv_mB = body_view.template get<mass_inv>(con.body[1]);
-                solver.inv_IB = &body_view.template get<inertia_world_inv>(con.body[1]);
-                solver.inv_IB_local = &body_view.template get<inertia_inv>(con.body[1]);
-            } else {
-                solver.inv_mB = inv_mB;
-                solver.inv_IB = &inv_IB;
-                solver.inv_IB_local = &inv_IB_local;
-            }
+    auto insert_entries = [&](auto con_type, unsigned con_idx) {
+        using C = decltype(con_type);
 
-            if (origin_view.contains(con.body[0])) {
-                solver.originA = &origin_view.template get<origin>(con.body[0]);
-                solver.comA = origin_view.template get<center_of_mass>(con.body[0]);
-            } else {
-                solver.originA = nullptr;
-            }
+        if constexpr(has_solve_position<C>::value) {
+            auto con_view = registry.view<C>();
+            auto &entities = constraint_entities.entities[con_idx];
 
-            if (origin_view.contains(con.body[1])) {
-                solver.originB = &origin_view.template get<origin>(con.body[1]);
-                solver.comB = origin_view.template get<center_of_mass>(con.body[1]);
-            } else {
-                solver.originB = nullptr;
-            }
+            for (unsigned i = 0; i < entities.size(); ++i) {
+                auto [con] = con_view.get(entities[i]);
+                auto &entry = cache.position_entries.emplace_back();
+                entry.type = con_idx;
+                entry.entity_index = i;
 
-            if constexpr(std::is_same_v<std::decay_t<C>, contact_constraint>) {
-                auto [manifold] = manifold_view.get(entity);
-                con.solve_position(solver, manifold);
-            } else {
-                con.solve_position(solver);
+                for (unsigned j = 0; j < 2; ++j) {
+                    auto body_idx = get_solver_body_index(island, procedural_view, con.body[j]);
+
+                    if (body_idx == fixed_solver_body_index) {
+                        body_idx = static_cast<solver_body_index_t>(cache.position_bodies.size());
+                        auto &body = cache.position_bodies.emplace_back();
+                        pack_position_body(body, con.body[j], tr_view, origin_view);
+                    }
+
+                    entry.body[j] = body_idx;
+                }
             }
+        }
+    };
+
+    std::apply([&](auto ... c) {
+        unsigned con_idx = 0;
+        (insert_entries(c, con_idx++), ...);
+    }, constraints_tuple);
+}
+
+// Writes the transforms of the position solver bodies back into the registry.
+// Frozen bodies are not moved and their inertia must not be replaced by the
+// zero inertia of their solver body.
+static void scatter_position_bodies(entt::registry &registry, const row_cache &cache, const island &island) {
+    auto view = registry.view<position, orientation, inertia_world_inv, procedural_tag>(entt::exclude<frozen_tag>);
+    auto origin_view = registry.view<origin>();
+    const auto *nodes = island.nodes.data();
+    const auto num_nodes = island.nodes.size();
+
+    for (size_t i = 0; i < num_nodes; ++i) {
+        auto entity = nodes[i];
 
-            max_error = std::max(solver.max_error, max_error);
+        if (!view.contains(entity)) {
+            continue;
         }
-    }
 
-    return max_error;
+        auto &body = cache.position_bodies[i + 1];
+        auto [pos, orn, inv_I] = view.get<position, orientation, inertia_world_inv>(entity);
+        pos = body.pos;
+        orn = body.orn;
+        inv_I = body.inv_I;
+
+        if (body.has_origin) {
+            origin_view.get<origin>(entity) = body.orig;
+        }
+    }
 }
 
-template<typename... Args>
-constexpr auto max_variadic(Args &&...args) {
-    return std::max({std::forward<Args>(args)...});
+template<typename C>
+scalar solve_position_constraint(entt::registry &registry, entt::entity entity, position_solver &solver) {
+    if constexpr(has_solve_position<C>::value) {
+        auto &con = registry.get<C>(entity);
+
+        if constexpr(std::is_same_v<C, contact_constraint>) {
+            con.solve_position(solver, registry.get<contact_manifold>(entity));
+        } else {
+            con.solve_position(solver);
+        }
+    }
+
+    return solver.max_error;
 }
 
-template<typename... C, size_t... Ints>
-scalar solve_position_constraints_indexed(entt::registry &registry, const island_constraint_entities &constraint_entities,
-                                         [[maybe_unused]] std::tuple<C...>, std::index_sequence<Ints...>) {
-    auto body_view = registry.view<position, orientation, mass_inv, inertia_world_inv, inertia_inv>();
-    auto origin_view = registry.view<origin, center_of_mass>();
-    auto procedural_view = registry.view<procedural_tag>();
-    return max_variadic(solve_position_constraints_each<C>(registry, constraint_entities.entities[Ints], body_view, origin_view, procedural_view)...);
+template<size_t... Ints>
+scalar solve_position_entry(entt::registry &registry, row_cache &cache,
+                            const island_constraint_entities &constraint_entities,
+                            const position_constraint_entry &entry, std::index_sequence<Ints...>) {
+    auto solver = position_solver(cache.position_bodies[entry.body[0]], cache.position_bodies[entry.body[1]]);
+    auto entity = constraint_entities.entities[entry.type][entry.entity_index];
+    auto error = scalar(0);
+    ((entry.type == Ints ?
+        (error = solve_position_constraint<std::tuple_element_t<Ints, constraints_tuple_t>>(registry, entity, solver), void(0)) :
+        void(0)), ...);
+    return error;
 }
 
-template<typename... C>
-scalar solve_position_constraints(entt::registry &registry, const island_constraint_entities &constraint_entities,
-                                  const std::tuple<C...> &constraints) {
-    return solve_position_constraints_indexed(registry, constraint_entities, constraints,
-                                              std::make_index_sequence<sizeof...(C)>());
+static scalar solve_position_entry(entt::registry &registry, row_cache &cache,
+                                   const island_constraint_entities &constraint_entities,
+                                   const position_constraint_entry &entry) {
+    return solve_position_entry(registry, cache, constraint_entities, entry,
+                                std::make_index_sequence<std::tuple_size_v<constraints_tuple_t>>());
 }
 
-static bool solve_position_constraints(entt::registry &registry, const island_constraint_entities &constraint_entities) {
-    auto error = solve_position_constraints(registry, constraint_entities, constraints_tuple);
-    return error < scalar(0.005);
+struct solve_position_color_context {
+    entt::registry *registry;
+    row_cache *cache;
+    const island_constraint_entities *constraint_entities;
+    unsigned offset;
+    std::atomic<scalar> max_error {0};
+
+    void task_func(unsigned start, unsigned end) {
+        auto local_max = scalar(0);
+
+        for (auto i = start; i < end; ++i) {
+            auto &entry = cache->position_entries[offset + i];
+            local_max = std::max(solve_position_entry(*registry, *cache, *constraint_entities, entry), local_max);
+        }
+
+        auto current = max_error.load(std::memory_order_relaxed);
+
+        while (current < local_max &&
+               !max_error.compare_exchange_weak(current, local_max, std::memory_order_relaxed));
+    }
+};
+
+// Runs one position iteration and returns whether the error is small enough
+// to stop. If the entries were colored, the entries of each color are solved
+// in parallel if `mt` is true, like in `solve_colored`.
+static bool solve_position_constraints(entt::registry &registry, row_cache &cache,
+                                       const island_constraint_entities &constraint_entities,
+                                       bool mt) {
+    constexpr unsigned max_sequential_size = 64;
+    auto max_error = scalar(0);
+
+    if (cache.position_color_offsets.empty()) {
+        for (auto &entry : cache.position_entries) {
+            max_error = std::max(solve_position_entry(registry, cache, constraint_entities, entry), max_error);
+        }
+    } else {
+        auto num_colors = cache.position_color_offsets.size() - 1;
+
+        for (size_t c = 0; c < num_colors; ++c) {
+            auto begin = cache.position_color_offsets[c];
+            auto end = cache.position_color_offsets[c + 1];
+            auto size = end - begin;
+            auto is_overflow = cache.position_has_overflow_color && c == num_colors - 1;
+
+            if (!mt || is_overflow || size <= max_sequential_size) {
+                for (auto i = begin; i < end; ++i) {
+                    auto &entry = cache.position_entries[i];
+                    max_error = std::max(solve_position_entry(registry, cache, constraint_entities, entry), max_error);
+                }
+            } else {
+                auto ctx = solve_position_color_context{};
+                ctx.registry = &registry;
+                ctx.cache = &cache;
+                ctx.constraint_entities = &constraint_entities;
+                ctx.offset = begin;
+                auto task = task_delegate_t(entt::connect_arg_t<&solve_position_color_context::task_func>{}, ctx);
+                enqueue_task_wait(registry, task, size);
+                max_error = std::max(ctx.max_error.load(std::memory_order_relaxed), max_error);
+            }
+        }
+    }
+
+    return max_error < scalar(0.005);
 }
 
 static void island_solver_update(island_solver_context &ctx);
@@ -377,17 +1260,22 @@ bool apply_solution(entt::registry &registry, scalar dt, const entt::sparse_set
     auto view = registry.view<position, orientation,
                               linvel, angvel, delta_linvel, delta_angvel,
                               dynamic_tag>();
+    auto particle_view = registry.view<particle_tag>();
 
-    auto for_loop_body = [view, dt](entt::entity entity) {
+    auto for_loop_body = [view, particle_view, dt](entt::entity entity) {
         if (view.contains(entity)) {
             auto [pos, orn, v, w, dv, dw] = view.get(entity);
 
             // Apply deltas.
             v += dv;
             w += dw;
-            // Integrate velocities and obtain new transforms.
+            // Integrate velocities and obtain new transforms. Particles
+            // don't rotate.
             pos += v * dt;
-            orn = integrate(orn, w, dt);
+
+            if (!particle_view.contains(entity)) {
+                orn = integrate(orn, w, dt);
+            }
             // Reset deltas back to zero for next update.
             dv = vector3_zero;
             dw = vector3_zero;
@@ -410,6 +1298,7 @@ bool apply_solution(entt::registry &registry, scalar dt, const entt::sparse_set
                                             linvel, angvel,
                                             delta_linvel, delta_angvel,
                                             dynamic_tag>();
+            auto particle_view = registry->view<particle_tag>();
 
             for (; first != last; ++first) {
                 auto entity = *first;
@@ -421,7 +1310,10 @@ bool apply_solution(entt::registry &registry, scalar dt, const entt::sparse_set
                     w += dw;
                     // Integrate velocities and obtain new transforms.
                     pos += v * dt;
-                    orn = integrate(orn, w, dt);
+
+                    if (!particle_view.contains(entity)) {
+                        orn = integrate(orn, w, dt);
+                    }
                     // Reset deltas back to zero for next update.
                     dv = vector3_zero;
                     dw = vector3_zero;
@@ -431,7 +1323,7 @@ bool apply_solution(entt::registry &registry, scalar dt, const entt::sparse_set
 
         void completion_func() {
             auto task = task_delegate_t(entt::connect_arg_t<&island_solver_update>{}, *isle_ctx);
-            enqueue_task(*registry, task, 1, {});
+            enqueue_continuation(*registry, task);
             delete this;
         };
     };
@@ -473,38 +1365,82 @@ static void island_solver_update(island_solver_context &ctx) {
     auto task = task_delegate_t(entt::connect_arg_t<&island_solver_update>{}, ctx);
     auto &registry = *ctx.registry;
 
-    switch (ctx.state) {
+    // The time spent in the current state must be recorded before the next
+    // task is enqueued, since it could run the same state in another thread.
+    const auto state = ctx.state;
+    EDYN_PROFILE_ZONE(island_solver_state_names[static_cast<size_t>(state)]);
+    auto timer = island_solver_timer(ctx.stats);
+    auto enqueue_next = [&]() {
+        timer.record(state);
+        enqueue_continuation(registry, task);
+    };
+
+    switch (state) {
     case island_solver_state::pack_rows: {
         auto &island = registry.get<edyn::island>(ctx.island_entity);
         auto &constraint_entities = registry.get<island_constraint_entities>(ctx.island_entity);
         auto &cache = registry.get<row_cache>(ctx.island_entity);
-        pack_rows(registry, cache, island.edges, constraint_entities);
+        pack_rows(registry, cache, island, constraint_entities, false, ctx.params.num_substeps > 1,
+                  ctx.params.block_contacts, ctx.params.articulate_distance_chains);
+
+        if (ctx.stats) {
+            reset_stats(*ctx.stats, cache, constraint_entities);
+        }
 
         ctx.state = island_solver_state::solve_constraints;
         ctx.iteration = 0;
 
-        enqueue_task(registry, task, 1, {});
+        enqueue_next();
         break;
     }
     case island_solver_state::solve_constraints: {
         auto &cache = registry.get<row_cache>(ctx.island_entity);
-        solve(cache);
+        auto &params = ctx.params;
 
-        ++ctx.iteration;
+        // When substepping, each task runs one entire substep.
+        if (params.num_substeps > 1) {
+            auto num_substep_iterations = get_substep_iterations(params.num_velocity_iterations, params.num_substeps);
+            solve_substep(registry, cache, ctx.dt, params.num_substeps, num_substep_iterations, false, false, ctx.stats);
+            ++ctx.iteration;
 
-        if (ctx.iteration >= ctx.num_iterations) {
-            ctx.state = island_solver_state::apply_solution;
+            if (ctx.iteration >= params.num_substeps) {
+                cache.num_velocity_iterations = params.num_substeps * num_substep_iterations;
+                ctx.state = island_solver_state::apply_solution;
+            }
+        } else {
+            auto residual = solve(cache);
+            record_residual(ctx.stats, residual);
+            ++ctx.iteration;
+
+            if (ctx.iteration >= params.num_velocity_iterations ||
+                has_converged(params, ctx.iteration, residual)) {
+                cache.num_velocity_iterations = ctx.iteration;
+                ctx.state = island_solver_state::apply_solution;
+            }
         }
 
-        enqueue_task(registry, task, 1, {});
+        enqueue_next();
         break;
     }
     case island_solver_state::apply_solution: {
         auto &island = registry.get<edyn::island>(ctx.island_entity);
+        auto &cache = registry.get<row_cache>(ctx.island_entity);
         ctx.state = island_solver_state::assign_applied_impulses;
 
+        if (ctx.params.num_substeps > 1) {
+            apply_substep_solution(registry, cache, island, ctx.dt);
+            enqueue_next();
+            break;
+        }
+
+        scatter_bodies(registry, cache, island);
+
+        // The context could be deleted by the time `apply_solution` returns
+        // if it completes asynchronously.
+        timer.record(state);
+
         if (apply_solution(registry, ctx.dt, island.nodes, execution_mode::asynchronous, &ctx)) {
-            enqueue_task(registry, task, 1, {});
+            enqueue_continuation(registry, task);
         }
         break;
     }
@@ -513,63 +1449,182 @@ static void island_solver_update(island_solver_context &ctx) {
         auto &constraint_entities = registry.get<island_constraint_entities>(ctx.island_entity);
         assign_applied_impulses(registry, cache, constraint_entities);
 
-        if (ctx.num_position_iterations > 0) {
+        if (ctx.params.num_position_iterations > 0) {
+            auto &island = registry.get<edyn::island>(ctx.island_entity);
+            pack_position_constraints(registry, cache, island, constraint_entities);
+            color_position_constraints(cache, island.nodes.size() + 1);
             ctx.iteration = 0;
             ctx.state = island_solver_state::solve_position_constraints;
-            enqueue_task(registry, task, 1, {});
         } else {
-            // Done.
-            ctx.decrement_counter();
-            delete &ctx;
+            ctx.state = island_solver_state::update_nodes;
         }
+
+        enqueue_next();
         break;
     }
     case island_solver_state::solve_position_constraints: {
+        auto &cache = registry.get<row_cache>(ctx.island_entity);
         auto &constraint_entities = registry.get<island_constraint_entities>(ctx.island_entity);
+        auto solved = solve_position_constraints(registry, cache, constraint_entities, true);
 
-        if (solve_position_constraints(registry, constraint_entities) ||
-            ++ctx.iteration >= ctx.num_position_iterations) {
-            // Done. Decrement atomic counter.
-            ctx.decrement_counter();
-            delete &ctx;
-        } else {
-            enqueue_task(registry, task, 1, {});
+        if (ctx.stats) {
+            ++ctx.stats->num_position_iterations;
+        }
+
+        if (solved || ++ctx.iteration >= ctx.params.num_position_iterations) {
+            auto &island = registry.get<edyn::island>(ctx.island_entity);
+            scatter_position_bodies(registry, cache, island);
+            ctx.state = island_solver_state::update_nodes;
         }
+
+        enqueue_next();
+        break;
+    }
+    case island_solver_state::update_nodes: {
+        // Update the state derived from the transforms of the nodes right
+        // away, without waiting for other islands to be solved.
+        update_island_nodes(registry, ctx.island_entity);
+        timer.record(state);
+
+        // Done. Decrement atomic counter.
+        ctx.decrement_counter();
+        delete &ctx;
         break;
     }
     }
 }
 
+island_solver_params make_island_solver_params(const settings &settings) {
+    auto params = island_solver_params{};
+    params.num_velocity_iterations = settings.num_solver_velocity_iterations;
+    params.min_velocity_iterations = settings.min_solver_velocity_iterations;
+    params.num_position_iterations = settings.num_solver_position_iterations;
+    params.num_substeps = settings.num_solver_substeps;
+    params.velocity_tolerance = settings.solver_velocity_tolerance;
+    params.block_contacts = settings.contact_block_solver;
+    params.articulate_distance_chains = settings.articulate_distance_chains;
+    params.collect_stats = settings.collect_solver_stats;
+    params.deterministic = settings.deterministic;
+    return params;
+}
+
 void run_island_solver_seq_mt(entt::registry &registry, entt::entity island_entity,
-                             unsigned num_iterations, unsigned num_position_iterations,
-                             scalar dt, atomic_counter_sync *counter) {
-    auto *ctx = new island_solver_context(registry, island_entity, num_iterations, num_position_iterations, dt, counter);
+                              const island_solver_params &params, scalar dt,
+                              atomic_counter_sync *counter) {
+    auto *ctx = new island_solver_context(registry, island_entity, params, dt, counter);
     auto task = task_delegate_t(entt::connect_arg_t<&island_solver_update>{}, *ctx);
-    enqueue_task(registry, task, 1, {});
+    enqueue_continuation(registry, task);
+}
+
+struct island_solver_batch_context {
+    entt::registry *registry;
+    const entt::entity *island_entities;
+    const island_solver_params *const *params;
+    size_t count;
+    scalar dt;
+    atomic_counter_sync *counter_sync;
+};
+
+static void island_solver_batch_update(island_solver_batch_context &ctx) {
+    for (size_t i = 0; i < ctx.count; ++i) {
+        run_island_solver_seq(*ctx.registry, ctx.island_entities[i], *ctx.params[i], ctx.dt);
+    }
+
+    ctx.counter_sync->decrement();
+    delete &ctx;
+}
+
+void run_island_solver_batch_mt(entt::registry &registry, const entt::entity *island_entities,
+                                const island_solver_params *const *params, size_t count,
+                                scalar dt, atomic_counter_sync *counter) {
+    EDYN_ASSERT(counter != nullptr);
+    auto *ctx = new island_solver_batch_context{&registry, island_entities, params, count, dt, counter};
+    auto task = task_delegate_t(entt::connect_arg_t<&island_solver_batch_update>{}, *ctx);
+    enqueue_continuation(registry, task);
 }
 
 void run_island_solver_seq(entt::registry &registry, entt::entity island_entity,
-                           unsigned num_iterations, unsigned num_position_iterations,
-                           scalar dt) {
+                           const island_solver_params &params, scalar dt, bool color, bool mt) {
     auto &island = registry.get<edyn::island>(island_entity);
     auto &constraint_entities = registry.get<island_constraint_entities>(island_entity);
     auto &cache = registry.get<row_cache>(island_entity);
-    pack_rows(registry, cache, island.edges, constraint_entities);
+    auto *stats = params.collect_stats ? registry.try_get<island_solver_stats>(island_entity) : nullptr;
+    auto timer = island_solver_timer(stats);
 
-    for (unsigned i = 0; i < num_iterations; ++i) {
-        solve(cache);
+    pack_rows(registry, cache, island, constraint_entities, color, params.num_substeps > 1,
+              params.block_contacts && !color, params.articulate_distance_chains);
+
+    if (stats) {
+        reset_stats(*stats, cache, constraint_entities);
     }
 
-    const auto exec_mode = execution_mode::sequential;
-    apply_solution(registry, dt, island.nodes, exec_mode, nullptr);
+    timer.record(island_solver_state::pack_rows);
+
+    if (params.num_substeps > 1) {
+        auto num_substep_iterations = get_substep_iterations(params.num_velocity_iterations, params.num_substeps);
+
+        for (unsigned i = 0; i < params.num_substeps; ++i) {
+            solve_substep(registry, cache, dt, params.num_substeps, num_substep_iterations, color, mt, stats);
+        }
+
+        cache.num_velocity_iterations = params.num_substeps * num_substep_iterations;
+        timer.record(island_solver_state::solve_constraints);
+
+        apply_substep_solution(registry, cache, island, dt);
+        timer.record(island_solver_state::apply_solution);
+    } else {
+        unsigned iteration = 0;
+
+        while (iteration < params.num_velocity_iterations) {
+            auto residual = color ? solve_colored(registry, cache, mt) : solve(cache);
+            record_residual(stats, residual);
+            ++iteration;
+
+            if (has_converged(params, iteration, residual)) {
+                break;
+            }
+        }
+
+        cache.num_velocity_iterations = iteration;
+        timer.record(island_solver_state::solve_constraints);
+
+        scatter_bodies(registry, cache, island);
+
+        const auto exec_mode = mt ? execution_mode::sequential_multithreaded : execution_mode::sequential;
+        apply_solution(registry, dt, island.nodes, exec_mode, nullptr);
+        timer.record(island_solver_state::apply_solution);
+    }
 
     assign_applied_impulses(registry, cache, constraint_entities);
+    timer.record(island_solver_state::assign_applied_impulses);
 
-    for (unsigned i = 0; i < num_position_iterations; ++i) {
-        if (solve_position_constraints(registry, constraint_entities)) {
-            break;
+    if (params.num_position_iterations > 0) {
+        pack_position_constraints(registry, cache, island, constraint_entities);
+
+        // Islands solved in worker threads always color their position
+        // constraints, thus in deterministic mode, all islands do so.
+        if (color || params.deterministic) {
+            color_position_constraints(cache, island.nodes.size() + 1);
+        }
+
+        for (unsigned i = 0; i < params.num_position_iterations; ++i) {
+            auto solved = solve_position_constraints(registry, cache, constraint_entities, mt);
+
+            if (stats) {
+                ++stats->num_position_iterations;
+            }
+
+            if (solved) {
+                break;
+            }
         }
+
+        scatter_position_bodies(registry, cache, island);
+        timer.record(island_solver_state::solve_position_constraints);
     }
+
+    update_island_nodes(registry, island_entity);
+    timer.record(island_solver_state::update_nodes);
 }
 
 }
@@ -0,0 +1,88 @@
+#include "edyn/dynamics/material_mixing.hpp"
+
+namespace edyn {
+
+void material_mix_table::insert(const pair_type &pair, const material_base &material) {
+#ifndef EDYN_DISABLE_ASSERT
+    EDYN_ASSERT(pair.first != std::numeric_limits<material::id_type>::max());
+    EDYN_ASSERT(pair.second != std::numeric_limits<material::id_type>::max());
+#endif
+
+    auto key = pack_pair(pair);
+
+    if (auto i = find(key); i != npos_slot) {
+        m_slots[i].material = material;
+        return;
+    }
+
+    // Keep the load factor at or below one half.
+    if ((m_size + 1) * 2 > m_slots.size()) {
+        rehash(m_slots.empty() ? 16 : m_slots.size() * 2);
+    }
+
+    auto mask = m_slots.size() - 1;
+    auto i = hash_key(key) & mask;
+
+    while (m_slots[i].key != empty_key) {
+        i = (i + 1) & mask;
+    }
+
+    m_slots[i] = {key, material};
+    ++m_size;
+}
+
+void material_mix_table::remove(const pair_type &pair) {
+    auto i = find(pack_pair(pair));
+
+    if (i == npos_slot) {
+        return;
+    }
+
+    // Backward shift deletion, which moves subsequent entries of the probe
+    // sequence into the vacated slot, thus no tombstones are needed.
+    auto mask = m_slots.size() - 1;
+    auto j = i;
+
+    while (true) {
+        j = (j + 1) & mask;
+
+        if (m_slots[j].key == empty_key) {
+            break;
+        }
+
+        auto home = hash_key(m_slots[j].key) & mask;
+
+        // Move entry at `j` into `i` if its home slot is not cyclically in
+        // the range `(i, j]`.
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            m_slots[i] = m_slots[j];
+            i = j;
+        }
+    }
+
+    m_slots[i].key = empty_key;
+    --m_size;
+}
+
+void material_mix_table::rehash(size_t capacity) {
+    auto slots = std::vector<slot>(capacity, slot{empty_key, {}});
+    auto mask = capacity - 1;
+
+    for (auto &entry : m_slots) {
+        if (entry.key == empty_key) {
+            continue;
+        }
+
+        auto i = hash_key(entry.key) & mask;
+
+        while (slots[i].key != empty_key) {
+            i = (i + 1) & mask;
+        }
+
+        slots[i] = entry;
+    }
+
+    m_slots = std::move(slots);
+}
+
+}
@@ -206,6 +206,10 @@ matrix3x3 moment_of_inertia(const paged_mesh_shape &sh, scalar mass) {
     return diagonal_matrix(vector3_max);
 }
 
+matrix3x3 moment_of_inertia(const heightfield_shape &sh, scalar mass) {
+    return diagonal_matrix(vector3_max);
+}
+
 matrix3x3 moment_of_inertia(const shapes_variant_t &var, scalar mass) {
     matrix3x3 inertia;
     std::visit([&](auto &&shape) {
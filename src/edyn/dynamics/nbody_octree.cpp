@@ -0,0 +1,177 @@
+#include "edyn/dynamics/nbody_octree.hpp"
+#include "edyn/config/config.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace edyn {
+
+namespace {
+
+void accumulate(vector3 &acc, const vector3 &point, const vector3 &position,
+                scalar mass, scalar softening_sqr) {
+    auto d = position - point;
+    // A mass located at the point has no effect since `d` is zero.
+    auto l2 = std::max(length_sqr(d) + softening_sqr, EDYN_EPSILON);
+    acc += d * (mass / (l2 * std::sqrt(l2)));
+}
+
+}
+
+void nbody_octree::clear() {
+    m_masses.clear();
+    m_nodes.clear();
+}
+
+void nbody_octree::insert(const vector3 &position, scalar mass) {
+    EDYN_ASSERT(mass > 0);
+    m_masses.push_back({position, mass});
+}
+
+void nbody_octree::build() {
+    m_nodes.clear();
+
+    if (m_masses.empty()) {
+        return;
+    }
+
+    auto min = m_masses.front().position;
+    auto max = min;
+    auto weighted_sum = vector3_zero;
+    auto total_mass = scalar(0);
+
+    for (auto &pm : m_masses) {
+        min = edyn::min(min, pm.position);
+        max = edyn::max(max, pm.position);
+        weighted_sum += pm.position * pm.mass;
+        total_mass += pm.mass;
+    }
+
+    auto extent = max - min;
+    auto &root = m_nodes.emplace_back();
+    root.center_of_mass = weighted_sum / total_mass;
+    root.mass = total_mass;
+    root.size = std::max(std::max(extent.x, extent.y), extent.z);
+    root.first_child = 0;
+    root.num_children = 0;
+    root.first = 0;
+    root.count = static_cast<uint32_t>(m_masses.size());
+
+    subdivide(0, min, 0);
+}
+
+void nbody_octree::subdivide(uint32_t node_index, const vector3 &min, unsigned depth) {
+    auto first = m_nodes[node_index].first;
+    auto count = m_nodes[node_index].count;
+    auto half_size = m_nodes[node_index].size / 2;
+
+    if (count <= max_leaf_size || depth >= max_depth || !(half_size > 0)) {
+        return;
+    }
+
+    // Sort masses into octants by splitting them along each axis in turn.
+    // The masses in octant `i` are in `[bounds[i], bounds[i + 1])` where the
+    // bits of `i` tell whether it's on the upper side in x, y and z.
+    auto mid = min + vector3_one * half_size;
+    auto *masses = m_masses.data();
+    auto bounds = std::array<uint32_t, 9>{};
+    bounds[0] = first;
+    bounds[8] = first + count;
+
+    for (auto axis = 0; axis < 3; ++axis) {
+        auto step = 8u >> axis;
+
+        for (auto i = 0u; i < 8; i += step) {
+            auto *begin = masses + bounds[i];
+            auto *end = masses + bounds[i + step];
+            auto *split = std::partition(begin, end, [&](const point_mass &pm) {
+                return pm.position[axis] < mid[axis];
+            });
+            bounds[i + step / 2] = static_cast<uint32_t>(split - masses);
+        }
+    }
+
+    auto first_child = static_cast<uint32_t>(m_nodes.size());
+    auto child_mins = std::array<vector3, 8>{};
+    auto num_children = uint32_t{0};
+
+    for (auto i = 0u; i < 8; ++i) {
+        if (bounds[i] == bounds[i + 1]) {
+            continue;
+        }
+
+        auto weighted_sum = vector3_zero;
+        auto total_mass = scalar(0);
+
+        for (auto j = bounds[i]; j < bounds[i + 1]; ++j) {
+            weighted_sum += masses[j].position * masses[j].mass;
+            total_mass += masses[j].mass;
+        }
+
+        auto &child = m_nodes.emplace_back();
+        child.center_of_mass = weighted_sum / total_mass;
+        child.mass = total_mass;
+        child.size = half_size;
+        child.first_child = 0;
+        child.num_children = 0;
+        child.first = bounds[i];
+        child.count = bounds[i + 1] - bounds[i];
+
+        child_mins[num_children] = {
+            i & 4 ? mid.x : min.x,
+            i & 2 ? mid.y : min.y,
+            i & 1 ? mid.z : min.z
+        };
+        ++num_children;
+    }
+
+    // Nodes might have been reallocated.
+    m_nodes[node_index].first_child = first_child;
+    m_nodes[node_index].num_children = num_children;
+
+    for (auto i = 0u; i < num_children; ++i) {
+        subdivide(first_child + i, child_mins[i], depth + 1);
+    }
+}
+
+vector3 nbody_octree::acceleration(const vector3 &point, scalar theta, scalar softening) const {
+    auto acc = vector3_zero;
+
+    if (m_nodes.empty()) {
+        return acc;
+    }
+
+    auto theta_sqr = theta * theta;
+    auto softening_sqr = softening * softening;
+
+    // Each level pushes at most 8 children after popping their parent.
+    auto stack = std::array<uint32_t, max_depth * 7 + 8>{};
+    auto stack_size = size_t{0};
+    stack[stack_size++] = 0;
+
+    while (stack_size > 0) {
+        auto &node = m_nodes[stack[--stack_size]];
+
+        if (node.num_children == 0) {
+            for (auto i = node.first; i < node.first + node.count; ++i) {
+                accumulate(acc, point, m_masses[i].position, m_masses[i].mass, softening_sqr);
+            }
+            continue;
+        }
+
+        auto dist_sqr = length_sqr(node.center_of_mass - point);
+
+        if (node.size * node.size < theta_sqr * dist_sqr) {
+            accumulate(acc, point, node.center_of_mass, node.mass, softening_sqr);
+            continue;
+        }
+
+        for (auto i = 0u; i < node.num_children; ++i) {
+            stack[stack_size++] = node.first_child + i;
+        }
+    }
+
+    return acc;
+}
+
+}
@@ -5,6 +5,8 @@
 #include "edyn/constraints/contact_constraint.hpp"
 #include "edyn/constraints/constraint_row.hpp"
 #include "edyn/constraints/constraint_row_options.hpp"
+#include "edyn/constraints/constraint_body.hpp"
+#include "edyn/dynamics/solver_body.hpp"
 #include "edyn/collision/contact_manifold.hpp"
 #include "edyn/collision/contact_point.hpp"
 #include "edyn/math/matrix3x3.hpp"
@@ -24,8 +26,13 @@
 #include "edyn/core/entity_graph.hpp"
 #include "edyn/comp/graph_node.hpp"
 #include "edyn/context/settings.hpp"
+#include "edyn/context/task.hpp"
+#include "edyn/context/task_util.hpp"
 #include "edyn/util/island_util.hpp"
 #include <entt/entity/registry.hpp>
+#include <algorithm>
+#include <utility>
+#include <vector>
 
 namespace edyn {
 
@@ -80,15 +87,17 @@ scalar get_manifold_min_relvel(const contact_manifold &manifold, const BodyView
     return min_relvel;
 }
 
-bool solve_restitution_iteration(entt::registry &registry, entt::entity island_entity,
-                                 scalar dt, unsigned individual_iterations) {
+// Runs one restitution iteration in an island. The manifolds with restitution
+// in the island are provided, which are used to find where to start solving.
+static bool solve_restitution_iteration(entt::registry &registry,
+                                        const std::vector<entt::entity> &restitution_manifolds,
+                                        scalar dt, unsigned individual_iterations) {
     auto body_view = registry.view<position, orientation, linvel, angvel,
                                    mass_inv, inertia_world_inv,
                                    delta_linvel, delta_angvel>();
     auto origin_view = registry.view<origin>();
-    auto procedural_view = registry.view<procedural_tag>();
+    auto procedural_view = registry.view<procedural_tag>(entt::exclude<frozen_tag>);
     auto static_view = registry.view<static_tag>();
-    auto restitution_view = registry.view<contact_manifold_with_restitution>();
     auto manifold_view = registry.view<contact_manifold>();
 
     // Solve manifolds in small groups, these groups being all manifolds connected
@@ -103,13 +112,8 @@ bool solve_restitution_iteration(entt::registry &registry, entt::entity island_e
     // Find manifold with highest penetration velocity.
     auto min_relvel = EDYN_SCALAR_MAX;
     auto fastest_manifold_entity = entt::entity{entt::null};
-    auto &island = registry.get<edyn::island>(island_entity);
-
-    for (auto entity : island.edges) {
-        if (!restitution_view.contains(entity)) {
-            continue;
-        }
 
+    for (auto entity : restitution_manifolds) {
         auto &manifold = manifold_view.get<contact_manifold>(entity);
         auto local_min_relvel = get_manifold_min_relvel(manifold, body_view, origin_view, static_view);
 
@@ -138,19 +142,41 @@ bool solve_restitution_iteration(entt::registry &registry, entt::entity island_e
     // Reuse collections of rows to prevent a high number of allocations.
     auto normal_rows = std::vector<constraint_row>{};
     auto friction_rows = std::vector<constraint_row_friction>{};
+    auto bodies = std::vector<solver_body>{};
+    auto body_entities = std::vector<entt::entity>{};
 
     normal_rows.reserve(10);
     friction_rows.reserve(10);
 
+    // Insert body into solver body array if it's not there yet and return
+    // its index. Manifolds are solved in small groups thus a linear search
+    // is sufficient.
+    auto get_body_index = [&](entt::entity entity, scalar inv_m, const matrix3x3 &inv_I) {
+        auto it = std::find(body_entities.begin(), body_entities.end(), entity);
+
+        if (it != body_entities.end()) {
+            return static_cast<solver_body_index_t>(std::distance(body_entities.begin(), it));
+        }
+
+        auto index = static_cast<solver_body_index_t>(bodies.size());
+        auto &body = bodies.emplace_back();
+        body.inv_m = inv_m;
+        body.inv_I = inv_I;
+        body_entities.push_back(entity);
+        return index;
+    };
+
     auto solve_manifolds = [&](const std::vector<entt::entity> &manifold_entities) {
         normal_rows.clear();
         friction_rows.clear();
+        bodies.clear();
+        body_entities.clear();
 
         for (auto manifold_entity : manifold_entities) {
             auto &manifold = manifold_view.get<contact_manifold>(manifold_entity);
 
-            auto [posA, ornA, dvA, dwA] = body_view.get<position, orientation, delta_linvel, delta_angvel>(manifold.body[0]);
-            auto [posB, ornB, dvB, dwB] = body_view.get<position, orientation, delta_linvel, delta_angvel>(manifold.body[1]);
+            auto [posA, ornA] = body_view.get<position, orientation>(manifold.body[0]);
+            auto [posB, ornB] = body_view.get<position, orientation>(manifold.body[1]);
 
             auto originA = origin_view.contains(manifold.body[0]) ?
                 origin_view.get<origin>(manifold.body[0]) : static_cast<vector3>(posA);
@@ -197,10 +223,16 @@ bool solve_restitution_iteration(entt::registry &registry, entt::entity island_e
                 angvelB = body_view.get<angvel>(manifold.body[1]);
             }
 
+            auto body_indexA = get_body_index(manifold.body[0], inv_mA, inv_IA);
+            auto body_indexB = get_body_index(manifold.body[1], inv_mB, inv_IB);
+            const auto bodyA = constraint_body{originA, posA, ornA, linvelA, angvelA, inv_mA, inv_IA};
+            const auto bodyB = constraint_body{originB, posB, ornB, linvelB, angvelB, inv_mB, inv_IB};
+
             // Create constraint rows for non-penetration constraints for each
             // contact point.
             for (size_t pt_idx = 0; pt_idx < manifold.num_points; ++pt_idx) {
                 auto &cp = manifold.get_point(pt_idx);
+                auto &cold = manifold.get_cold(pt_idx);
 
                 auto normal = cp.normal;
                 auto pivotA = to_world_space(cp.pivotA, originA, ornA);
@@ -211,20 +243,17 @@ bool solve_restitution_iteration(entt::registry &registry, entt::entity island_e
                 auto normal_row_index = normal_rows.size();
                 auto &normal_row = normal_rows.emplace_back();
                 normal_row.J = {normal, cross(rA, normal), -normal, -cross(rB, normal)};
-                normal_row.inv_mA = inv_mA; normal_row.inv_IA = inv_IA;
-                normal_row.inv_mB = inv_mB; normal_row.inv_IB = inv_IB;
-                normal_row.dvA = &dvA; normal_row.dwA = &dwA;
-                normal_row.dvB = &dvB; normal_row.dwB = &dwB;
+                normal_row.body = {body_indexA, body_indexB};
                 normal_row.lower_limit = 0;
                 normal_row.upper_limit = large_scalar;
 
                 auto normal_options = constraint_row_options{};
-                normal_options.restitution = cp.restitution;
+                normal_options.restitution = cold.restitution;
 
-                prepare_row(normal_row, normal_options, linvelA, angvelA, linvelB, angvelB);
+                prepare_row(normal_row, normal_options, bodyA, bodyB);
 
                 auto &friction_row = friction_rows.emplace_back();
-                friction_row.friction_coefficient = cp.friction;
+                friction_row.friction_coefficient = cold.friction;
                 friction_row.normal_row_index = normal_row_index;
 
                 vector3 tangents[2];
@@ -243,11 +272,11 @@ bool solve_restitution_iteration(entt::registry &registry, entt::entity island_e
         for (unsigned iter = 0; iter < individual_iterations; ++iter) {
             for (size_t row_idx = 0; row_idx < normal_rows.size(); ++row_idx) {
                 auto &normal_row = normal_rows[row_idx];
-                auto delta_impulse = solve(normal_row);
-                apply_row_impulse(delta_impulse, normal_row);
+                auto delta_impulse = solve(normal_row, bodies);
+                apply_row_impulse(delta_impulse, normal_row, bodies);
 
                 auto &friction_row_pair = friction_rows[row_idx];
-                solve_friction(friction_row_pair, normal_rows);
+                solve_friction(friction_row_pair, normal_rows, bodies);
             }
         }
 
@@ -261,33 +290,27 @@ bool solve_restitution_iteration(entt::registry &registry, entt::entity island_e
             auto &manifold = manifold_view.get<contact_manifold>(manifold_entity);
 
             for (size_t pt_idx = 0; pt_idx < manifold.num_points; ++pt_idx) {
-                auto &cp = manifold.get_point(pt_idx);
+                auto &cold = manifold.get_cold(pt_idx);
                 auto &normal_row = normal_rows[row_idx];
-                cp.normal_restitution_impulse = normal_row.impulse;
+                cold.normal_restitution_impulse = normal_row.impulse;
 
                 auto &friction_row_pair = friction_rows[row_idx];
 
                 for (auto i = 0; i < 2; ++i) {
-                    cp.friction_restitution_impulse[i] = friction_row_pair.row[i].impulse;
+                    cold.friction_restitution_impulse[i] = friction_row_pair.row[i].impulse;
                 }
 
                 ++row_idx;
             }
         }
 
-        // Apply delta velocities.
-        for (auto manifold_entity : manifold_entities) {
-            auto &manifold = manifold_view.get<contact_manifold>(manifold_entity);
-
-            for (auto body_entity : manifold.body) {
-                // There are duplicates among all manifold bodies but this
-                // operation is idempotent since the delta velocity is set
-                // to zero.
-                auto [v, w, dv, dw] = body_view.get<linvel, angvel, delta_linvel, delta_angvel>(body_entity);
-                v += dv;
-                w += dw;
-                dv = vector3_zero;
-                dw = vector3_zero;
+        // Apply delta velocities. Non-procedural bodies have zero inverse
+        // mass thus their delta velocities remain zero.
+        for (size_t i = 0; i < bodies.size(); ++i) {
+            if (bodies[i].inv_m > 0) {
+                auto [v, w] = body_view.get<linvel, angvel>(body_entities[i]);
+                v += bodies[i].dv;
+                w += bodies[i].dw;
             }
         }
     };
@@ -353,20 +376,84 @@ bool solve_restitution_iteration(entt::registry &registry, entt::entity island_e
     return false;
 }
 
-void solve_restitution(entt::registry &registry, scalar dt) {
+static void solve_restitution_island(entt::registry &registry,
+                                     const std::vector<entt::entity> &restitution_manifolds,
+                                     scalar dt, unsigned num_iterations,
+                                     unsigned num_individual_iterations) {
+    for (unsigned i = 0; i < num_iterations; ++i) {
+        if (solve_restitution_iteration(registry, restitution_manifolds, dt, num_individual_iterations)) {
+            break;
+        }
+    }
+}
+
+void solve_restitution(entt::registry &registry, scalar dt, bool mt) {
     auto &settings = registry.ctx().get<edyn::settings>();
+
+    if (settings.num_restitution_iterations == 0) {
+        return;
+    }
+
     auto island_view = registry.view<island_tag>(exclude_sleeping_disabled);
+    auto restitution_view = registry.view<contact_manifold_with_restitution, island_resident>();
 
-    for (unsigned i = 0; i < settings.num_restitution_iterations; ++i) {
-        bool all_solved = true;
+    // Group manifolds with restitution by island, thus islands without any
+    // of them are never visited. Islands do not share any procedural body
+    // thus they can be solved independently.
+    std::vector<std::pair<entt::entity, entt::entity>> island_manifold_pairs;
 
-        for (auto island_entity : island_view) {
-            all_solved &= solve_restitution_iteration(registry, island_entity, dt,
-                                                      settings.num_individual_restitution_iterations);
+    for (auto [manifold_entity, resident] : restitution_view.each()) {
+        if (island_view.contains(resident.island_entity)) {
+            island_manifold_pairs.emplace_back(resident.island_entity, manifold_entity);
         }
+    }
 
-        if (all_solved) {
-            break;
+    if (island_manifold_pairs.empty()) {
+        return;
+    }
+
+    if (settings.deterministic) {
+        // Also sort manifolds within each island so they're solved in the
+        // same order regardless of the order of the storage.
+        std::sort(island_manifold_pairs.begin(), island_manifold_pairs.end());
+    } else {
+        std::stable_sort(island_manifold_pairs.begin(), island_manifold_pairs.end(),
+                         [](auto &lhs, auto &rhs) { return lhs.first < rhs.first; });
+    }
+
+    std::vector<std::vector<entt::entity>> island_manifolds;
+
+    for (size_t i = 0; i < island_manifold_pairs.size(); ++i) {
+        if (i == 0 || island_manifold_pairs[i].first != island_manifold_pairs[i - 1].first) {
+            island_manifolds.emplace_back();
+        }
+
+        island_manifolds.back().push_back(island_manifold_pairs[i].second);
+    }
+
+    auto num_iterations = settings.num_restitution_iterations;
+    auto num_individual_iterations = settings.num_individual_restitution_iterations;
+
+    if (mt && island_manifolds.size() > 1) {
+        // Views are created in the tasks, which could create storage for
+        // components that were never assigned. That is not thread-safe, so
+        // ensure they exist beforehand.
+        registry.storage<origin>();
+        registry.storage<procedural_tag>();
+        registry.storage<static_tag>();
+
+        auto task_func = [&](unsigned start, unsigned end) {
+            for (auto i = start; i < end; ++i) {
+                solve_restitution_island(registry, island_manifolds[i], dt,
+                                         num_iterations, num_individual_iterations);
+            }
+        };
+
+        auto task = task_delegate_t(entt::connect_arg_t<&decltype(task_func)::operator()>{}, task_func);
+        enqueue_task_wait(registry, task, island_manifolds.size());
+    } else {
+        for (auto &manifolds : island_manifolds) {
+            solve_restitution_island(registry, manifolds, dt, num_iterations, num_individual_iterations);
         }
     }
 }
@@ -0,0 +1,172 @@
+#include "edyn/dynamics/row_cache_soa.hpp"
+#include "edyn/config/config.h"
+#include <algorithm>
+
+namespace edyn {
+
+// Number of trailing batches that are searched for a free lane before a new
+// batch is started. Bounds the cost of packing in large islands.
+static constexpr size_t max_open_batches = 16;
+
+void pack_row_batches(row_cache_soa &soa, const std::vector<constraint_row> &rows,
+                      const std::vector<solver_body> &bodies) {
+    soa.clear();
+    soa.batches.reserve(rows.size() / simd_width + 1);
+
+    // Dynamic bodies referenced by each lane of each batch. Non-dynamic bodies
+    // are never written to during the iterations thus they can be shared
+    // among lanes and are represented by the fixed body index.
+    using batch_bodies = std::array<solver_body_index_t, 2 * simd_width>;
+    std::vector<batch_bodies> batch_body_indices;
+    batch_body_indices.reserve(soa.batches.capacity());
+    size_t first_open = 0;
+
+    for (unsigned row_idx = 0; row_idx < rows.size(); ++row_idx) {
+        auto &row = rows[row_idx];
+        auto &bodyA = bodies[row.body[0]];
+        auto &bodyB = bodies[row.body[1]];
+        auto keyA = bodyA.inv_m > 0 ? row.body[0] : fixed_solver_body_index;
+        auto keyB = bodyB.inv_m > 0 ? row.body[1] : fixed_solver_body_index;
+
+        auto num_batches = soa.batches.size();
+        auto batch_idx = num_batches;
+        auto search_begin = std::max(first_open, num_batches > max_open_batches ? num_batches - max_open_batches : size_t{0});
+
+        for (auto i = search_begin; i < num_batches; ++i) {
+            auto count = soa.batches[i].count;
+
+            if (count == simd_width) {
+                continue;
+            }
+
+            auto first = batch_body_indices[i].begin();
+            auto last = first + 2 * count;
+
+            if ((keyA != fixed_solver_body_index && std::find(first, last, keyA) != last) ||
+                (keyB != fixed_solver_body_index && std::find(first, last, keyB) != last)) {
+                continue;
+            }
+
+            batch_idx = i;
+            break;
+        }
+
+        if (batch_idx == num_batches) {
+            // Value-initialized so that unused lanes are zero and produce a
+            // zero impulse.
+            soa.batches.emplace_back();
+            batch_body_indices.emplace_back();
+        }
+
+        auto &batch = soa.batches[batch_idx];
+        auto lane = batch.count++;
+        batch_body_indices[batch_idx][2 * lane] = keyA;
+        batch_body_indices[batch_idx][2 * lane + 1] = keyB;
+
+        const vector3 MJ[4] = {
+            bodyA.inv_m * row.J[0],
+            bodyA.inv_I * row.J[1],
+            bodyB.inv_m * row.J[2],
+            bodyB.inv_I * row.J[3]
+        };
+
+        for (unsigned j = 0; j < 4; ++j) {
+            for (unsigned c = 0; c < 3; ++c) {
+                batch.J[3 * j + c][lane] = row.J[j][c];
+                batch.MJ[3 * j + c][lane] = MJ[j][c];
+            }
+        }
+
+        batch.eff_mass[lane] = row.eff_mass;
+        batch.rhs[lane] = row.rhs;
+        batch.lower_limit[lane] = row.lower_limit;
+        batch.upper_limit[lane] = row.upper_limit;
+        batch.impulse[lane] = row.impulse;
+        batch.row_index[lane] = row_idx;
+        batch.bodyA[lane] = row.body[0];
+        batch.bodyB[lane] = row.body[1];
+
+        while (first_open < soa.batches.size() && soa.batches[first_open].count == simd_width) {
+            ++first_open;
+        }
+    }
+}
+
+void update_row_batch_rhs(row_cache_soa &soa, const std::vector<constraint_row> &rows) {
+    for (auto &batch : soa.batches) {
+        for (unsigned i = 0; i < batch.count; ++i) {
+            batch.rhs[i] = rows[batch.row_index[i]].rhs;
+        }
+    }
+}
+
+scalar solve(row_cache_soa &soa, std::vector<constraint_row> &rows, std::vector<solver_body> &bodies) {
+    // Delta velocities of all bodies in a batch, laid out like the Jacobian.
+    alignas(simd_alignment) scalar vel[12][simd_width];
+    alignas(simd_alignment) scalar abs_delta_impulse[simd_width];
+    auto max_delta_impulse = simd_scalar::splat(0);
+
+    for (auto &batch : soa.batches) {
+        EDYN_ASSERT(batch.count > 0 && batch.count <= simd_width);
+
+        for (unsigned i = 0; i < simd_width; ++i) {
+            if (i < batch.count) {
+                auto &bodyA = bodies[batch.bodyA[i]];
+                auto &bodyB = bodies[batch.bodyB[i]];
+
+                for (unsigned c = 0; c < 3; ++c) {
+                    vel[c][i] = bodyA.dv[c];
+                    vel[3 + c][i] = bodyA.dw[c];
+                    vel[6 + c][i] = bodyB.dv[c];
+                    vel[9 + c][i] = bodyB.dw[c];
+                }
+            } else {
+                for (unsigned k = 0; k < 12; ++k) {
+                    vel[k][i] = 0;
+                }
+            }
+        }
+
+        simd_scalar v[12];
+        auto delta_relvel = simd_scalar::splat(0);
+
+        for (unsigned k = 0; k < 12; ++k) {
+            v[k] = simd_scalar::load(vel[k]);
+            delta_relvel = mul_add(simd_scalar::load(batch.J[k]), v[k], delta_relvel);
+        }
+
+        auto impulse = simd_scalar::load(batch.impulse);
+        auto delta_impulse = (simd_scalar::load(batch.rhs) - delta_relvel) * simd_scalar::load(batch.eff_mass);
+        auto new_impulse = min(max(impulse + delta_impulse,
+                                   simd_scalar::load(batch.lower_limit)),
+                                   simd_scalar::load(batch.upper_limit));
+        delta_impulse = new_impulse - impulse;
+        new_impulse.store(batch.impulse);
+
+        // Unused lanes have a zero delta impulse.
+        max_delta_impulse = max(max(delta_impulse, simd_scalar::splat(0) - delta_impulse), max_delta_impulse);
+
+        for (unsigned k = 0; k < 12; ++k) {
+            mul_add(simd_scalar::load(batch.MJ[k]), delta_impulse, v[k]).store(vel[k]);
+        }
+
+        for (unsigned i = 0; i < batch.count; ++i) {
+            auto &bodyA = bodies[batch.bodyA[i]];
+            auto &bodyB = bodies[batch.bodyB[i]];
+
+            for (unsigned c = 0; c < 3; ++c) {
+                bodyA.dv[c] = vel[c][i];
+                bodyA.dw[c] = vel[3 + c][i];
+                bodyB.dv[c] = vel[6 + c][i];
+                bodyB.dw[c] = vel[9 + c][i];
+            }
+
+            rows[batch.row_index[i]].impulse = batch.impulse[i];
+        }
+    }
+
+    max_delta_impulse.store(abs_delta_impulse);
+    return *std::max_element(abs_delta_impulse, abs_delta_impulse + simd_width);
+}
+
+}
@@ -0,0 +1,150 @@
+#include "edyn/dynamics/row_coloring.hpp"
+#include "edyn/dynamics/row_cache.hpp"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace edyn {
+
+// Greedily assigns to each of `count` elements the lowest color that is not
+// used by any other element which shares a dynamic body with it and fills
+// `color_offsets` with the offset of each color in use plus one past the
+// last. `get_bodies(i)` returns the body indices of element i, where only
+// indices below `num_dynamic_bodies` refer to dynamic bodies. Elements that
+// cannot be assigned one of `max_row_colors` colors go into a last color.
+// Fills `slots` with the position of each element in the array grouped by
+// color and returns whether there is an overflow color.
+template<typename GetBodiesFunc>
+static bool assign_colors(size_t count, size_t num_dynamic_bodies, GetBodiesFunc get_bodies,
+                          std::vector<unsigned> &color_offsets, std::vector<unsigned> &slots) {
+    // Bitset of colors already in use by the elements of each dynamic body.
+    std::vector<uint64_t> body_colors(num_dynamic_bodies);
+    std::array<unsigned, max_row_colors + 1> color_count {};
+    slots.resize(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        auto bodies = get_bodies(i);
+        uint64_t used = 0;
+
+        for (auto idx : bodies) {
+            if (idx < num_dynamic_bodies) {
+                used |= body_colors[idx];
+            }
+        }
+
+        unsigned color = 0;
+
+        while (color < max_row_colors && (used & (uint64_t(1) << color))) {
+            ++color;
+        }
+
+        if (color < max_row_colors) {
+            auto bit = uint64_t(1) << color;
+
+            for (auto idx : bodies) {
+                if (idx < num_dynamic_bodies) {
+                    body_colors[idx] |= bit;
+                }
+            }
+        }
+
+        // Store the color temporarily.
+        slots[i] = color;
+        ++color_count[color];
+    }
+
+    // Colors are assigned lowest first thus the regular colors in use are
+    // contiguous. The overflow color goes last, if present.
+    std::array<unsigned, max_row_colors + 1> cursor;
+    unsigned offset = 0;
+    color_offsets.clear();
+
+    for (unsigned c = 0; c <= max_row_colors; ++c) {
+        cursor[c] = offset;
+
+        if (color_count[c] > 0) {
+            color_offsets.push_back(offset);
+            offset += color_count[c];
+        }
+    }
+
+    color_offsets.push_back(offset);
+
+    for (auto &slot : slots) {
+        slot = cursor[slot]++;
+    }
+
+    return color_count[max_row_colors] > 0;
+}
+
+void color_rows(row_cache &cache) {
+    cache.color_entries.clear();
+    cache.color_offsets.clear();
+    cache.has_overflow_color = false;
+
+    auto num_rows = cache.rows.size();
+    auto num_bodies = cache.bodies.size();
+    unsigned num_fixed = 0;
+
+    for (auto &row : cache.rows) {
+        for (auto idx : row.body) {
+            num_fixed += cache.bodies[idx].inv_m > 0 ? 0 : 1;
+        }
+    }
+
+    // Delta velocities of non-dynamic bodies are never changed by an impulse,
+    // but they're still read and written to. Give each row its own copy of
+    // the fixed body so that rows in different threads do not access the
+    // same memory. The copies are appended thus all bodies referenced by the
+    // rows with an index below `num_bodies` are dynamic.
+    cache.bodies.reserve(num_bodies + num_fixed);
+
+    for (auto &row : cache.rows) {
+        for (auto &idx : row.body) {
+            if (!(cache.bodies[idx].inv_m > 0)) {
+                idx = static_cast<solver_body_index_t>(cache.bodies.size());
+                cache.bodies.emplace_back();
+            }
+        }
+    }
+
+    std::vector<unsigned> slots;
+    cache.has_overflow_color = assign_colors(num_rows, num_bodies, [&](size_t i) {
+        return cache.rows[i].body;
+    }, cache.color_offsets, slots);
+    cache.color_entries.resize(num_rows);
+
+    // Friction rows are stored in the same order as their normal rows.
+    unsigned friction_idx = 0, rolling_idx = 0, spinning_idx = 0;
+
+    for (unsigned i = 0; i < num_rows; ++i) {
+        auto &entry = cache.color_entries[slots[i]];
+        entry.row = i;
+        entry.friction = friction_idx;
+        entry.rolling = rolling_idx;
+        entry.spinning = spinning_idx;
+
+        auto flags = cache.flags[i];
+        if (flags & constraint_row_flag_friction) ++friction_idx;
+        if (flags & constraint_row_flag_rolling_friction) ++rolling_idx;
+        if (flags & constraint_row_flag_spinning_friction) ++spinning_idx;
+    }
+}
+
+void color_position_constraints(row_cache &cache, size_t num_dynamic_bodies) {
+    auto &entries = cache.position_entries;
+    std::vector<unsigned> slots;
+    cache.position_has_overflow_color = assign_colors(entries.size(), num_dynamic_bodies, [&](size_t i) {
+        return entries[i].body;
+    }, cache.position_color_offsets, slots);
+
+    auto sorted = std::vector<position_constraint_entry>(entries.size());
+
+    for (size_t i = 0; i < entries.size(); ++i) {
+        sorted[slots[i]] = entries[i];
+    }
+
+    entries = std::move(sorted);
+}
+
+}
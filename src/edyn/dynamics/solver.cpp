@@ -6,19 +6,26 @@
 #include "edyn/comp/mass.hpp"
 #include "edyn/comp/origin.hpp"
 #include "edyn/comp/tag.hpp"
+#include "edyn/comp/solver_substeps.hpp"
 #include "edyn/comp/position.hpp"
 #include "edyn/comp/orientation.hpp"
 #include "edyn/dynamics/island_solver.hpp"
 #include "edyn/constraints/constraint_body.hpp"
 #include "edyn/context/task.hpp"
 #include "edyn/dynamics/island_constraint_entities.hpp"
+#include "edyn/dynamics/island_solver_stats.hpp"
+#include "edyn/dynamics/nbody_octree.hpp"
+#include "edyn/util/step_profile.hpp"
 #include "edyn/dynamics/row_cache.hpp"
 #include "edyn/parallel/atomic_counter_sync.hpp"
+#include "edyn/parallel/job_dispatcher.hpp"
+#include "edyn/parallel/worker.hpp"
 #include "edyn/serialization/s11n_util.hpp"
 #include "edyn/sys/apply_gravity.hpp"
+#include "edyn/sys/apply_nbody_gravity.hpp"
 #include "edyn/sys/update_aabbs.hpp"
-#include "edyn/sys/update_rotated_meshes.hpp"
-#include "edyn/sys/update_inertias.hpp"
+#include "edyn/sys/update_island_nodes.hpp"
+#include "edyn/sys/update_kinematic_tracks.hpp"
 #include "edyn/sys/update_origins.hpp"
 #include "edyn/constraints/constraint_row.hpp"
 #include "edyn/comp/linvel.hpp"
@@ -32,21 +39,92 @@
 #include "edyn/context/settings.hpp"
 #include "edyn/context/task_util.hpp"
 #include "edyn/util/entt_util.hpp"
+#include "edyn/util/tuple_util.hpp"
 #include <entt/entity/registry.hpp>
 #include <entt/signal/delegate.hpp>
+#include <algorithm>
+#include <deque>
 #include <optional>
+#include <thread>
 #include <type_traits>
 
 namespace edyn {
 
+// Releases the solver data of entities that go to sleep, which is rebuilt
+// from scratch once they wake up.
+static void on_construct_sleeping_tag(entt::registry &registry, entt::entity entity) {
+    if (!registry.ctx().get<settings>().compact_sleeping_islands) {
+        return;
+    }
+
+    if (auto *cache = registry.try_get<row_cache>(entity)) {
+        auto num_velocity_iterations = cache->num_velocity_iterations;
+        *cache = {};
+        cache->num_velocity_iterations = num_velocity_iterations;
+    }
+
+    if (auto *constraint_entities = registry.try_get<island_constraint_entities>(entity)) {
+        *constraint_entities = {};
+    }
+
+    registry.remove<constraint_row_prep_cache>(entity);
+}
+
+// Gives back the preparation cache to constraints that woke up. Every other
+// constraint has one, thus there's nothing to do if the counts match.
+static void restore_prep_caches(entt::registry &registry) {
+    if (registry.storage<constraint_row_prep_cache>().size() == registry.storage<constraint_tag>().size()) {
+        return;
+    }
+
+    auto view = registry.view<constraint_tag>(entt::exclude<constraint_row_prep_cache, sleeping_tag>);
+
+    for (auto entity : view) {
+        registry.emplace<constraint_row_prep_cache>(entity);
+    }
+}
+
+// Destroys the constraints that broke while the islands were solved and
+// reports them in the event buffer, if there's one in this registry.
+static void destroy_broken_constraints(entt::registry &registry) {
+    auto broken = std::vector<constraint_break_event>{};
+
+    registry.view<row_cache>().each([&](row_cache &cache) {
+        broken.insert(broken.end(), cache.broken_constraints.begin(), cache.broken_constraints.end());
+        cache.broken_constraints.clear();
+    });
+
+    if (broken.empty()) {
+        return;
+    }
+
+    auto *buffer = registry.ctx().find<constraint_break_event_buffer>();
+
+    for (auto &event : broken) {
+        // Multiple constraints of the same entity could break at once.
+        if (!registry.valid(event.entity)) {
+            continue;
+        }
+
+        if (buffer) {
+            buffer->events.push_back(event);
+        }
+
+        registry.destroy(event.entity);
+    }
+}
+
 solver::solver(entt::registry &registry)
     : m_registry(&registry)
+    , m_prep_arenas(std::make_unique<constraint_row_prep_arena_pool>())
+    , m_nbody_octree(std::make_unique<nbody_octree>())
 {
     m_connections.emplace_back(registry.on_construct<linvel>().connect<&entt::registry::emplace<delta_linvel>>());
     m_connections.emplace_back(registry.on_construct<angvel>().connect<&entt::registry::emplace<delta_angvel>>());
     m_connections.emplace_back(registry.on_construct<island_tag>().connect<&entt::registry::emplace<row_cache>>());
     m_connections.emplace_back(registry.on_construct<island_tag>().connect<&entt::registry::emplace<island_constraint_entities>>());
     m_connections.emplace_back(registry.on_construct<constraint_tag>().connect<&entt::registry::emplace<constraint_row_prep_cache>>());
+    m_connections.emplace_back(registry.on_construct<sleeping_tag>().connect<&on_construct_sleeping_tag>());
 }
 
 solver::~solver() {
@@ -56,24 +134,43 @@ solver::~solver() {
     m_registry->clear<constraint_row_prep_cache>();
 }
 
-template<typename C, typename BodyView, typename OriginView, typename ManifoldView, typename ProceduralView, typename StaticView>
+size_t solver::num_bytes() const {
+    return m_prep_arenas->num_bytes() + m_prep_entities.capacity() * sizeof(entt::entity) +
+           m_prep_offsets.capacity() * sizeof(size_t) +
+           m_island_costs.capacity() * sizeof(std::pair<size_t, entt::entity>) +
+           m_island_entities.capacity() * sizeof(entt::entity) +
+           m_island_params.capacity() * sizeof(const island_solver_params *) +
+           m_island_jobs.capacity() * sizeof(std::pair<size_t, size_t>);
+}
+
+template<typename C, typename BodyView, typename OriginView, typename ManifoldView,
+         typename ProceduralView, typename StaticView, typename FrozenView>
 void invoke_prepare_constraint(entt::registry &registry, entt::entity entity, C &&con,
                                constraint_row_prep_cache &cache, scalar dt,
                                const BodyView &body_view, const OriginView &origin_view,
                                const ManifoldView &manifold_view, const ProceduralView &procedural_view,
-                               const StaticView &static_view) {
-    auto [posA, ornA, dvA, dwA] = body_view.template get<position, orientation, delta_linvel, delta_angvel>(con.body[0]);
-    auto [posB, ornB, dvB, dwB] = body_view.template get<position, orientation, delta_linvel, delta_angvel>(con.body[1]);
+                               const StaticView &static_view, const FrozenView &frozen_view) {
+    auto [posA, ornA] = body_view.template get<position, orientation>(con.body[0]);
+    auto [posB, ornB] = body_view.template get<position, orientation>(con.body[1]);
 
     // Get velocity from registry for non-static entities (dynamic and kinematic).
-    // Get mass and inertia from registry for procedural entities (dynamic only).
-    // Use zero mass, inertia and velocities otherwise.
+    // Get mass and inertia from registry for procedural entities (dynamic only)
+    // which are not frozen. Use zero mass, inertia and velocities otherwise.
     vector3 linvelA, linvelB;
     vector3 angvelA, angvelB;
     scalar inv_mA, inv_mB;
     matrix3x3 inv_IA, inv_IB;
+    auto movableA = procedural_view.contains(con.body[0]) && !frozen_view.contains(con.body[0]);
+    auto movableB = procedural_view.contains(con.body[1]) && !frozen_view.contains(con.body[1]);
+
+    // Frozen bodies touching static bodies or other frozen bodies would give
+    // rows with infinite effective mass. Add the constraint without rows.
+    if (!movableA && !movableB) {
+        cache.add_constraint();
+        return;
+    }
 
-    if (procedural_view.contains(con.body[0])) {
+    if (movableA) {
         inv_mA = body_view.template get<mass_inv>(con.body[0]);
         inv_IA = body_view.template get<inertia_world_inv>(con.body[0]);
     } else {
@@ -89,7 +186,7 @@ void invoke_prepare_constraint(entt::registry &registry, entt::entity entity, C
         angvelA = body_view.template get<angvel>(con.body[0]);
     }
 
-    if (procedural_view.contains(con.body[1])) {
+    if (movableB) {
         inv_mB = body_view.template get<mass_inv>(con.body[1]);
         inv_IB = body_view.template get<inertia_world_inv>(con.body[1]);
     } else {
@@ -128,20 +225,62 @@ void invoke_prepare_constraint(entt::registry &registry, entt::entity entity, C
         con.prepare(registry, entity, cache, dt, bodyA, bodyB);
     }
 
-    // Assign masses and deltas to new rows.
+    // Calculate effective mass and right hand side of new rows. The body
+    // indices are assigned later when the rows are packed into the island.
     for (auto i = row_start_index; i < cache.num_rows; ++i) {
-        auto &row = cache.rows[i].row;
-        row.inv_mA = inv_mA; row.inv_IA = inv_IA;
-        row.inv_mB = inv_mB; row.inv_IB = inv_IB;
-        row.dvA = &dvA; row.dwA = &dwA;
-        row.dvB = &dvB; row.dwB = &dwB;
-
-        auto &options = cache.rows[i].options;
-        prepare_row(row, options, linvelA, angvelA, linvelB, angvelB);
+        auto &elem = cache.get_element(i);
+        auto &row = elem.row;
+        auto &options = elem.options;
+        prepare_row(row, options, bodyA, bodyB);
     }
 }
 
-static void prepare_constraints(entt::registry &registry, scalar dt, bool mt) {
+// Collects the constraint entities to be prepared by going over the storage
+// of each constraint type, which groups them by type in the order of
+// `constraints_tuple`, followed by the entities that have constraints of more
+// than one type. The type of each entity is recorded in its preparation cache.
+static void collect_prep_entities(entt::registry &registry, std::vector<entt::entity> &entities,
+                                  std::vector<size_t> &offsets, uint32_t step) {
+    auto cache_view = registry.view<constraint_row_prep_cache>(exclude_sleeping_disabled);
+    auto multiple_type_entities = std::vector<entt::entity>{};
+    entities.clear();
+    offsets.clear();
+
+    std::apply([&](auto ... c) {
+        ([&]() {
+            using C = decltype(c);
+            constexpr auto type_index = tuple_type_index_of<uint8_t, C, constraints_tuple_t>::value;
+            offsets.push_back(entities.size());
+
+            for (auto entity : registry.view<C>()) {
+                if (!cache_view.contains(entity)) {
+                    continue;
+                }
+
+                auto &prep_cache = cache_view.get<constraint_row_prep_cache>(entity);
+
+                if (prep_cache.collect_step != step) {
+                    prep_cache.collect_step = step;
+                    prep_cache.type_index = type_index;
+                    entities.push_back(entity);
+                } else if (prep_cache.type_index != constraint_row_prep_cache::multiple_types) {
+                    // Already collected with a type that comes before. It will
+                    // be skipped in the range of that type.
+                    prep_cache.type_index = constraint_row_prep_cache::multiple_types;
+                    multiple_type_entities.push_back(entity);
+                }
+            }
+        }(), ...);
+    }, constraints_tuple);
+
+    offsets.push_back(entities.size());
+    entities.insert(entities.end(), multiple_type_entities.begin(), multiple_type_entities.end());
+    offsets.push_back(entities.size());
+}
+
+static void prepare_constraints(entt::registry &registry, constraint_row_prep_arena_pool &arenas,
+                                std::vector<entt::entity> &entities, std::vector<size_t> &offsets,
+                                uint32_t step, scalar dt, bool mt) {
     auto body_view = registry.view<position, orientation,
                                    linvel, angvel,
                                    mass_inv, inertia_world_inv,
@@ -151,41 +290,97 @@ static void prepare_constraints(entt::registry &registry, scalar dt, bool mt) {
     auto manifold_view = registry.view<contact_manifold>();
     auto procedural_view = registry.view<procedural_tag>();
     auto static_view = registry.view<static_tag>();
+    auto frozen_view = registry.view<frozen_tag>();
     auto con_view_tuple = get_tuple_of_views(registry, constraints_tuple);
 
-    auto for_loop_body = [&registry, body_view, cache_view, origin_view,
-                          manifold_view, procedural_view, static_view, con_view_tuple, dt](entt::entity entity) {
-        auto &prep_cache = cache_view.get<constraint_row_prep_cache>(entity);
-        prep_cache.clear();
-
-        std::apply([&](auto &&... con_view) {
-            ((con_view.contains(entity) ?
-                invoke_prepare_constraint(registry, entity, std::get<0>(con_view.get(entity)), prep_cache,
-                                          dt, body_view, origin_view, manifold_view, procedural_view, static_view) : void(0)), ...);
-        }, con_view_tuple);
+    collect_prep_entities(registry, entities, offsets, step);
+
+    // Prepares the entities in `[first, last)`, going over the range of each
+    // constraint type that intersects it and getting the constraints straight
+    // from the storage of that type.
+    auto prepare_range = [&registry, &entities, &offsets, body_view, cache_view, origin_view, manifold_view,
+                          procedural_view, static_view, frozen_view, con_view_tuple, dt]
+                          (size_t first, size_t last, constraint_row_prep_arena &arena) {
+        std::apply([&](auto ... c) {
+            ([&]() {
+                using C = decltype(c);
+                constexpr auto type_index = tuple_type_index_of<uint8_t, C, constraints_tuple_t>::value;
+                auto &con_view = std::get<type_index>(con_view_tuple);
+                auto begin = std::max(first, offsets[type_index]);
+                auto end = std::min(last, offsets[type_index + 1]);
+
+                for (auto i = begin; i < end; ++i) {
+                    auto entity = entities[i];
+                    auto &prep_cache = cache_view.get<constraint_row_prep_cache>(entity);
+
+                    if (prep_cache.type_index != type_index) {
+                        continue;
+                    }
+
+                    prep_cache.begin(arena);
+                    invoke_prepare_constraint(registry, entity, std::get<0>(con_view.get(entity)), prep_cache,
+                                              dt, body_view, origin_view, manifold_view, procedural_view,
+                                              static_view, frozen_view);
+                }
+            }(), ...);
+        }, constraints_tuple);
+
+        // Entities with constraints of multiple types have them prepared
+        // together, in the order of `constraints_tuple`, since their rows must
+        // be contiguous.
+        auto begin = std::max(first, offsets[offsets.size() - 2]);
+        auto end = std::min(last, offsets.back());
+
+        for (auto i = begin; i < end; ++i) {
+            auto entity = entities[i];
+            auto &prep_cache = cache_view.get<constraint_row_prep_cache>(entity);
+            prep_cache.begin(arena);
+
+            std::apply([&](auto &&... con_view) {
+                ((con_view.contains(entity) ?
+                    invoke_prepare_constraint(registry, entity, std::get<0>(con_view.get(entity)), prep_cache,
+                                              dt, body_view, origin_view, manifold_view, procedural_view,
+                                              static_view, frozen_view) : void(0)), ...);
+            }, con_view_tuple);
+        }
     };
 
     const size_t max_sequential_size = 4;
-    auto num_constraints = calculate_view_size(cache_view);
+    auto num_constraints = entities.size();
 
-    if (mt && num_constraints > max_sequential_size) {
-        auto task_func = [&for_loop_body, cache_view](unsigned start, unsigned end) {
-            auto first = cache_view.begin();
-            std::advance(first, start);
-            auto last = first;
-            std::advance(last, end - start);
-
-            for (; first != last; ++first) {
-                auto entity = *first;
-                for_loop_body(entity);
-            }
-        };
+    // Rows prepared in the last step are not needed anymore since they were
+    // packed into the row caches of their islands.
+    arenas.reset();
 
-        auto task = task_delegate_t(entt::connect_arg_t<&decltype(task_func)::operator()>{}, task_func);
-        enqueue_task_wait(registry, task, calculate_view_size(cache_view));
+    if (mt && num_constraints > max_sequential_size) {
+        parallel_for_each_range(registry, entities,
+                                [&prepare_range, &arenas](const entt::entity *first, const entt::entity *last,
+                                                          unsigned start) {
+            // Each invocation appends rows to its own arena.
+            auto &arena = arenas.acquire();
+            prepare_range(start, start + static_cast<size_t>(last - first), arena);
+        });
     } else {
-        for (auto entity : cache_view) {
-            for_loop_body(entity);
+        auto &arena = arenas.acquire();
+        prepare_range(0, num_constraints, arena);
+    }
+}
+
+// Assigns solver stats to the awake islands if enabled or removes all of them
+// otherwise. Must be done before the islands are solved because components
+// cannot be emplaced from worker threads.
+static void assign_solver_stats(entt::registry &registry, bool enabled) {
+    if (!enabled) {
+        registry.clear<island_solver_stats>();
+        return;
+    }
+
+    auto island_view = registry.view<island>(exclude_sleeping_disabled);
+    auto stats_view = registry.view<island_solver_stats>();
+
+    for (auto island_entity : island_view) {
+        if (!stats_view.contains(island_entity)) {
+            registry.emplace<island_solver_stats>(island_entity);
         }
     }
 }
@@ -194,47 +389,203 @@ void solver::update(bool mt) {
     auto &registry = *m_registry;
     auto &settings = registry.ctx().get<edyn::settings>();
     auto dt = settings.fixed_dt;
+    auto timer = step_profile_timer(internal::find_step_profile(registry));
 
-    solve_restitution(registry, dt);
-    apply_gravity(registry, dt);
+    solve_restitution(registry, dt, mt);
+    timer.record(step_phase::restitution);
 
-    prepare_constraints(registry, dt, mt);
+    apply_nbody_gravity(registry, *m_nbody_octree, m_nbody_entities, dt, mt);
+    apply_gravity(registry, dt);
+    update_kinematic_tracks(registry, dt);
+    restore_prep_caches(registry);
+    prepare_constraints(registry, *m_prep_arenas, m_prep_entities, m_prep_offsets, ++m_prep_step, dt, mt);
+    timer.record(step_phase::prepare_constraints);
 
     auto island_view = registry.view<island>(exclude_sleeping_disabled);
     auto num_islands = calculate_view_size(island_view);
+    auto params = make_island_solver_params(settings);
+
+    // Islands where all rigid bodies are tagged as low fidelity are solved
+    // with fewer iterations.
+    auto low_fidelity_params = params;
+    low_fidelity_params.num_velocity_iterations =
+        std::min(params.num_velocity_iterations, settings.num_low_fidelity_velocity_iterations);
+    low_fidelity_params.min_velocity_iterations =
+        std::min(params.min_velocity_iterations, low_fidelity_params.num_velocity_iterations);
+    low_fidelity_params.num_position_iterations =
+        std::min(params.num_position_iterations, settings.num_low_fidelity_position_iterations);
+
+    // Islands with bodies which request more substeps are solved in that
+    // many substeps. Islands sharing the same parameters share one instance,
+    // which must stay in place until all islands are solved.
+    auto substep_params = std::deque<island_solver_params>{};
+
+    auto &low_fidelity_storage = registry.storage<low_fidelity_tag>();
+    auto &substeps_storage = registry.storage<solver_substeps>();
+    auto get_params = [&](entt::entity island_entity) -> const island_solver_params & {
+        if (low_fidelity_storage.empty() && substeps_storage.empty()) {
+            return params;
+        }
+
+        auto &nodes = island_view.get<island>(island_entity).nodes;
+        auto low_fidelity = !low_fidelity_storage.empty() &&
+            std::all_of(nodes.begin(), nodes.end(), [&](entt::entity entity) {
+                return low_fidelity_storage.contains(entity);
+            });
+        auto &base_params = low_fidelity ? low_fidelity_params : params;
+        auto num_substeps = base_params.num_substeps;
+
+        if (!substeps_storage.empty()) {
+            for (auto entity : nodes) {
+                if (substeps_storage.contains(entity)) {
+                    num_substeps = std::max(num_substeps, substeps_storage.get(entity).count);
+                }
+            }
+        }
+
+        if (num_substeps == base_params.num_substeps) {
+            return base_params;
+        }
+
+        for (auto &p : substep_params) {
+            if (p.num_substeps == num_substeps &&
+                p.num_velocity_iterations == base_params.num_velocity_iterations &&
+                p.num_position_iterations == base_params.num_position_iterations) {
+                return p;
+            }
+        }
+
+        auto &p = substep_params.emplace_back(base_params);
+        p.num_substeps = num_substeps;
+        return p;
+    };
+
+    assign_solver_stats(registry, params.collect_stats);
+
+    // Constraints are checked for breaking from worker threads thus the
+    // storage must exist before.
+    registry.storage<breakable_constraint>();
+
+    // Islands update their nodes in worker threads after being solved.
+    if (mt) {
+        reserve_update_island_nodes_storage(registry);
+    }
+
+    // Large islands are solved in the current thread, with their rows solved
+    // in parallel, while smaller islands are each solved in a worker thread.
+    // In deterministic mode, large islands are colored even if not running
+    // multi-threaded, so the order rows are solved in doesn't depend on it.
+    auto min_parallel_size = settings.min_island_constraints_parallel_solve;
+    auto is_large_island = [&](entt::entity island_entity) {
+        return (mt || settings.deterministic) && min_parallel_size > 0 &&
+               island_view.get<island>(island_entity).edges.size() >= min_parallel_size;
+    };
 
     if (mt && num_islands > 1) {
-        auto counter = atomic_counter_sync(num_islands);
+        // Islands are dispatched in decreasing order of cost, so the largest
+        // ones don't start last and delay the end of the step. The cost of
+        // an island is estimated by its number of bodies plus the number of
+        // rows it had in the previous step, or its number of constraints if
+        // it has no rows yet.
+        auto cache_view = registry.view<row_cache>();
+        m_island_costs.clear();
+
+        for (auto island_entity : island_view) {
+            if (!is_large_island(island_entity)) {
+                auto &island = island_view.get<edyn::island>(island_entity);
+                auto &rows = cache_view.get<row_cache>(island_entity).rows;
+                auto cost = island.nodes.size() + (rows.empty() ? island.edges.size() : rows.size());
+                m_island_costs.emplace_back(cost, island_entity);
+            }
+        }
+
+        std::stable_sort(m_island_costs.begin(), m_island_costs.end(), [](auto &lhs, auto &rhs) {
+            return lhs.first > rhs.first;
+        });
+
+        m_island_entities.clear();
+        m_island_params.clear();
+        m_island_jobs.clear();
+
+        for (auto [cost, island_entity] : m_island_costs) {
+            m_island_entities.push_back(island_entity);
+            m_island_params.push_back(&get_params(island_entity));
+        }
+
+        // Islands cheaper than the batch size are grouped into batches of
+        // about that cost, since they're sorted by cost.
+        auto batch_size = settings.island_solver_batch_size;
+
+        for (size_t first = 0, last = 0; first < m_island_costs.size(); first = last) {
+            auto batch_cost = size_t{0};
+
+            do {
+                batch_cost += m_island_costs[last++].first;
+            } while (last < m_island_costs.size() && batch_cost < batch_size);
+
+            m_island_jobs.emplace_back(first, last);
+        }
+
+        auto counter = atomic_counter_sync(m_island_jobs.size());
+
+        for (auto [first, last] : m_island_jobs) {
+            if (last - first == 1) {
+                run_island_solver_seq_mt(registry, m_island_entities[first], *m_island_params[first], dt, &counter);
+            } else {
+                run_island_solver_batch_mt(registry, m_island_entities.data() + first,
+                                           m_island_params.data() + first, last - first, dt, &counter);
+            }
+        }
 
         for (auto island_entity : island_view) {
-            run_island_solver_seq_mt(registry, island_entity,
-                                     settings.num_solver_velocity_iterations,
-                                     settings.num_solver_position_iterations,
-                                     dt, &counter);
+            if (is_large_island(island_entity)) {
+                run_island_solver_seq(registry, island_entity, get_params(island_entity), dt, true, true);
+            }
         }
 
-        counter.wait();
+        if (!m_island_jobs.empty()) {
+            if (worker::current() != nullptr) {
+                // The step runs in a worker when started with `begin_update`.
+                // It must not block, since the island jobs might be queued in
+                // its own deque.
+                auto &dispatcher = job_dispatcher::current();
+
+                while (!counter.is_done()) {
+                    if (!dispatcher.run_pending_job()) {
+                        std::this_thread::yield();
+                    }
+                }
+            } else {
+                counter.wait();
+            }
+        }
     } else {
         for (auto island_entity : island_view) {
-            run_island_solver_seq(registry, island_entity,
-                                  settings.num_solver_velocity_iterations,
-                                  settings.num_solver_position_iterations, dt);
+            run_island_solver_seq(registry, island_entity, get_params(island_entity), dt,
+                                  is_large_island(island_entity), mt);
         }
     }
 
-    update_origins(registry);
+    timer.record(step_phase::solve_islands);
 
-    // Update rotated vertices of convex meshes after rotations change. It is
-    // important to do this before `update_aabbs` because the rotated meshes
-    // will be used to calculate AABBs of polyhedrons.
-    update_rotated_meshes(registry);
+    destroy_broken_constraints(registry);
 
-    // Update AABBs after transforms change.
-    update_aabbs(registry);
-    update_island_aabbs(registry);
+    // Stats were written directly into the components by the island solvers.
+    // Patch them so observers, such as the one that sends the changes to the
+    // main registry in asynchronous mode, are notified.
+    if (params.collect_stats) {
+        for (auto island_entity : island_view) {
+            registry.patch<island_solver_stats>(island_entity);
+        }
+    }
 
-    // Update world-space moment of inertia.
-    update_inertias(registry);
+    // The origins, AABBs and inertias of dynamic entities were updated by each
+    // island once it was solved. Update the remaining entities, which do not
+    // belong to islands. Rotated meshes are updated by the narrowphase only
+    // for bodies that are in contact.
+    update_non_dynamic_origins(registry);
+    update_kinematic_aabbs(registry);
+    timer.record(step_phase::post_solve);
 }
 
 }
@@ -4,12 +4,16 @@
 #include "edyn/collision/contact_manifold.hpp"
 #include "edyn/collision/contact_manifold_map.hpp"
 #include "edyn/collision/narrowphase.hpp"
+#include "edyn/collision/sensor.hpp"
+#include "edyn/constraints/breakable_constraint.hpp"
+#include "edyn/collision/contact_event_stream.hpp"
 #include "edyn/comp/child_list.hpp"
 #include "edyn/comp/collision_exclusion.hpp"
 #include "edyn/comp/island.hpp"
 #include "edyn/comp/tag.hpp"
 #include "edyn/comp/tree_resident.hpp"
 #include "edyn/config/config.h"
+#include "edyn/config/memory_resource.hpp"
 #include "edyn/config/execution_mode.hpp"
 #include "edyn/constraints/constraint.hpp"
 #include "edyn/constraints/null_constraint.hpp"
@@ -18,6 +22,7 @@
 #include "edyn/networking/comp/entity_owner.hpp"
 #include "edyn/parallel/message_dispatcher.hpp"
 #include "edyn/shapes/shapes.hpp"
+#include "edyn/simulation/maintenance_scheduler.hpp"
 #include "edyn/simulation/stepper_async.hpp"
 #include "edyn/simulation/stepper_sequential.hpp"
 #include "edyn/dynamics/material_mixing.hpp"
@@ -25,9 +30,12 @@
 #include "edyn/util/paged_mesh_load_reporting.hpp"
 #include "edyn/util/rigidbody.hpp"
 #include "edyn/util/settings_util.hpp"
+#include "edyn/util/world_capture.hpp"
+#include "edyn/sys/shift_origin.hpp"
 #include "edyn/parallel/job_dispatcher.hpp"
 #include <entt/meta/factory.hpp>
 #include <entt/core/hashed_string.hpp>
+#include <entt/signal/delegate.hpp>
 
 namespace edyn {
 
@@ -62,8 +70,12 @@ static void init_meta() {
 
 void attach(entt::registry &registry, const init_config &config) {
     init_meta();
-    auto use_job_dispatcher = config.enqueue_task == enqueue_task_default ||
-                              config.enqueue_task_wait == enqueue_task_wait_default;
+    // Containers of this world created in the meantime take memory from its
+    // resource.
+    auto memory_binding = scoped_memory_resource(config.memory_resource);
+    auto use_job_dispatcher = !config.dispatcher &&
+                              (config.enqueue_task == enqueue_task_default ||
+                               config.enqueue_task_wait == enqueue_task_wait_default);
 
     if (use_job_dispatcher && !job_dispatcher::global().running()) {
         auto num_workers = size_t{};
@@ -87,28 +99,42 @@ void attach(entt::registry &registry, const init_config &config) {
             break;
         }
 
-        job_dispatcher::global().start(num_workers);
+        job_dispatcher::global().start(num_workers, config.worker_idle_policy,
+                                       config.thread_affinity.worker_cores);
     }
 
     auto &settings = registry.ctx().emplace<edyn::settings>();
     settings.execution_mode = config.execution_mode;
     settings.fixed_dt = config.fixed_dt;
     settings.start_thread_func = config.start_thread_func;
+    settings.simulation_thread_cores = config.thread_affinity.simulation_cores;
     settings.enqueue_task = config.enqueue_task;
     settings.enqueue_task_wait = config.enqueue_task_wait;
+    settings.dispatcher = config.dispatcher;
+    settings.memory_resource = config.memory_resource;
+    settings.pacing = config.pacing;
+    settings.broadphase_algorithm = config.broadphase_algorithm;
+    settings.deterministic = config.deterministic;
 
     registry.ctx().emplace<entity_graph>();
     registry.ctx().emplace<material_mix_table>();
     registry.ctx().emplace<contact_manifold_map>(registry);
     registry.ctx().emplace<contact_event_emitter>(registry);
     registry.ctx().emplace<registry_operation_context>();
+    registry.ctx().emplace<step_profile>();
+    registry.ctx().emplace<collision_stats>();
+    registry.ctx().emplace<sensor_event_buffer>();
+    registry.ctx().emplace<contact_event_buffer>();
+    registry.ctx().emplace<constraint_break_event_buffer>();
     auto timestamp = config.timestamp ? *config.timestamp : (*settings.time_func)();
 
     switch (config.execution_mode) {
     case execution_mode::sequential:
     case execution_mode::sequential_multithreaded:
+        registry.ctx().emplace<maintenance_scheduler>();
         registry.ctx().emplace<broadphase>(registry);
         registry.ctx().emplace<narrowphase>(registry);
+        registry.ctx().emplace<contact_event_stream>(registry);
         registry.ctx().emplace<stepper_sequential>(registry, timestamp,
                                                    config.execution_mode == execution_mode::sequential_multithreaded);
         break;
@@ -126,18 +152,30 @@ void registry_clear(entt::registry &registry, [[maybe_unused]] const std::tuple<
 }
 
 void detach(entt::registry &registry) {
+    end_update(registry);
+    internal::deinit_capture(registry);
     internal::deinit_paged_mesh_load_reporting(registry);
 
+    // Custom dispatchers are owned by the caller.
+    auto uses_global_dispatcher = registry.ctx().get<settings>().dispatcher == nullptr;
+
     registry.ctx().erase<settings>();
     registry.ctx().erase<entity_graph>();
     registry.ctx().erase<material_mix_table>();
     registry.ctx().erase<contact_manifold_map>();
     registry.ctx().erase<contact_event_emitter>();
     registry.ctx().erase<registry_operation_context>();
+    registry.ctx().erase<step_profile>();
+    registry.ctx().erase<collision_stats>();
+    registry.ctx().erase<sensor_event_buffer>();
+    registry.ctx().erase<contact_event_buffer>();
+    registry.ctx().erase<constraint_break_event_buffer>();
+    registry.ctx().erase<contact_event_stream>();
     registry.ctx().erase<broadphase>();
     registry.ctx().erase<narrowphase>();
     registry.ctx().erase<stepper_async>();
     registry.ctx().erase<stepper_sequential>();
+    registry.ctx().erase<maintenance_scheduler>();
 
     registry.clear<rigidbody_tag, constraint_tag, dynamic_tag, kinematic_tag, static_tag,
                    procedural_tag, networked_tag, external_tag, network_exclude_tag,
@@ -146,7 +184,16 @@ void detach(entt::registry &registry) {
 
     registry.clear<shape_index>();
     registry.clear<AABB>();
+    registry.clear<aabb_margin>();
     registry.clear<rolling_tag>();
+    registry.clear<ccd_tag>();
+    registry.clear<particle_tag>();
+    registry.clear<sensor_tag, sensor_aabb_tag>();
+    registry.clear<contact_event_tag>();
+    registry.clear<articulation_tag>();
+    registry.clear<breakable_constraint>();
+    registry.clear<low_fidelity_tag>();
+    registry.clear<solver_substeps>();
     registry.clear<roll_direction>();
 
     registry_clear(registry, shapes_tuple);
@@ -171,7 +218,10 @@ void detach(entt::registry &registry) {
     auto manifold_view = registry.view<contact_manifold>();
     registry.destroy(manifold_view.begin(), manifold_view.end());
 
-    job_dispatcher::global().stop();
+    if (uses_global_dispatcher) {
+        job_dispatcher::global().stop();
+    }
+
     message_dispatcher::global().clear_queues();
 }
 
@@ -191,6 +241,85 @@ void set_max_steps_per_update(entt::registry &registry, unsigned max_steps) {
     refresh_settings(registry);
 }
 
+void set_contact_reuse_tolerances(entt::registry &registry, scalar linear, scalar angular) {
+    EDYN_ASSERT(linear >= 0 && angular >= 0);
+    auto &settings = registry.ctx().get<edyn::settings>();
+    settings.contact_reuse_linear_tolerance = linear;
+    settings.contact_reuse_angular_tolerance = angular;
+    refresh_settings(registry);
+}
+
+void set_freeze_resting_bodies(entt::registry &registry, bool enabled) {
+    auto &settings = registry.ctx().get<edyn::settings>();
+    settings.freeze_resting_bodies = enabled;
+    refresh_settings(registry);
+}
+
+void set_nbody_gravity(entt::registry &registry, bool enabled,
+                       scalar constant, scalar theta, scalar softening) {
+    EDYN_ASSERT(theta >= 0 && softening >= 0);
+    auto &settings = registry.ctx().get<edyn::settings>();
+    settings.nbody_gravity = enabled;
+    settings.nbody_gravity_constant = constant;
+    settings.nbody_gravity_theta = theta;
+    settings.nbody_gravity_softening = softening;
+    refresh_settings(registry);
+}
+
+void set_compact_sleeping_islands(entt::registry &registry, bool enabled) {
+    auto &settings = registry.ctx().get<edyn::settings>();
+    settings.compact_sleeping_islands = enabled;
+    refresh_settings(registry);
+}
+
+void set_island_split_delay(entt::registry &registry, scalar delay) {
+    EDYN_ASSERT(delay >= 0);
+    auto &settings = registry.ctx().get<edyn::settings>();
+    settings.island_split_delay = delay;
+    refresh_settings(registry);
+}
+
+void set_maintenance_budget(entt::registry &registry, double budget) {
+    EDYN_ASSERT(budget >= 0);
+    auto &settings = registry.ctx().get<edyn::settings>();
+    settings.maintenance_budget = budget;
+    refresh_settings(registry);
+}
+
+void set_island_storage_sort_interval(entt::registry &registry, unsigned interval) {
+    auto &settings = registry.ctx().get<edyn::settings>();
+    settings.island_storage_sort_interval = interval;
+    refresh_settings(registry);
+}
+
+void set_paged_mesh_prefetch_lookahead(entt::registry &registry, scalar lookahead) {
+    EDYN_ASSERT(lookahead >= 0);
+    auto &settings = registry.ctx().get<edyn::settings>();
+    settings.paged_mesh_prefetch_lookahead = lookahead;
+    refresh_settings(registry);
+}
+
+// The presentation settings are only used in the main thread, thus there's
+// no need to refresh the settings of the simulation worker.
+void set_present_tagged_only(entt::registry &registry, bool enabled) {
+    registry.ctx().get<edyn::settings>().present_tagged_only = enabled;
+}
+
+void set_min_presentation_parallel_size(entt::registry &registry, unsigned size) {
+    registry.ctx().get<edyn::settings>().min_presentation_parallel_size = size;
+}
+
+// Step updates are only applied in the main thread.
+void set_min_step_update_parallel_size(entt::registry &registry, unsigned size) {
+    registry.ctx().get<edyn::settings>().min_step_update_parallel_size = size;
+}
+
+void set_publish_broadphase(entt::registry &registry, bool enabled) {
+    auto &settings = registry.ctx().get<edyn::settings>();
+    settings.publish_broadphase = enabled;
+    refresh_settings(registry);
+}
+
 bool is_paused(const entt::registry &registry) {
     return registry.ctx().get<settings>().paused;
 }
@@ -211,42 +340,148 @@ void update(entt::registry &registry) {
     update(registry, time);
 }
 
+// Runs the jobs scheduled while stepping a world in sequential mode in the
+// dispatcher of that world and allocates from its memory resource. Restores
+// the dispatcher of the calling thread after, since the same thread might be
+// stepping other worlds.
+class scoped_dispatcher_binding {
+public:
+    scoped_dispatcher_binding(entt::registry &registry)
+        : m_previous(&job_dispatcher::current())
+        , m_memory_binding(registry.ctx().get<settings>().memory_resource)
+    {
+        job_dispatcher::bind_current(registry.ctx().get<settings>().dispatcher);
+    }
+
+    ~scoped_dispatcher_binding() {
+        job_dispatcher::bind_current(m_previous);
+    }
+
+private:
+    job_dispatcher *m_previous;
+    scoped_memory_resource m_memory_binding;
+};
+
 void update(entt::registry &registry, double time) {
+    internal::capture_call(registry, internal::capture_record_type::update, time);
+
     if (registry.ctx().contains<stepper_async>()) {
         registry.ctx().get<stepper_async>().update(time);
     } else if (registry.ctx().contains<stepper_sequential>()) {
-        registry.ctx().get<stepper_sequential>().update(time);
+        auto binding = scoped_dispatcher_binding(registry);
+        auto &stepper = registry.ctx().get<stepper_sequential>();
+        EDYN_ASSERT(!stepper.is_updating());
+        stepper.update(time);
     }
 
+    internal::capture_resume(registry);
     internal::update_paged_mesh_load_reporting(registry);
 }
 
+void begin_update(entt::registry &registry) {
+    auto &settings = registry.ctx().get<edyn::settings>();
+    auto time = (*settings.time_func)();
+    begin_update(registry, time);
+}
+
+void begin_update(entt::registry &registry, double time) {
+    if (auto *stepper = registry.ctx().find<stepper_sequential>()) {
+        // The update is scheduled in the dispatcher of this world, which
+        // binds the memory resource in the worker thread.
+        auto binding = scoped_dispatcher_binding(registry);
+        internal::capture_call(registry, internal::capture_record_type::update, time);
+        stepper->begin_update(time);
+    } else {
+        update(registry, time);
+    }
+}
+
+void end_update(entt::registry &registry) {
+    if (auto *stepper = registry.ctx().find<stepper_sequential>(); stepper && stepper->is_updating()) {
+        auto binding = scoped_dispatcher_binding(registry);
+        stepper->end_update();
+        internal::capture_resume(registry);
+        internal::update_paged_mesh_load_reporting(registry);
+    }
+}
+
 void step_simulation(entt::registry &registry) {
+    auto &settings = registry.ctx().get<edyn::settings>();
+    auto time = (*settings.time_func)();
+    step_simulation(registry, time);
+}
+
+void step_simulation(entt::registry &registry, double time) {
     EDYN_ASSERT(is_paused(registry));
+    internal::capture_call(registry, internal::capture_record_type::step, time);
 
     if (auto *stepper = registry.ctx().find<stepper_async>()) {
         stepper->step_simulation();
     } else {
-        auto &settings = registry.ctx().get<edyn::settings>();
-        auto time = (*settings.time_func)();
+        auto binding = scoped_dispatcher_binding(registry);
         registry.ctx().get<stepper_sequential>().step_simulation(time);
     }
 
+    internal::capture_resume(registry);
     internal::update_paged_mesh_load_reporting(registry);
 }
 
-void step_simulation(entt::registry &registry, double time) {
+void batch_step_simulation(entt::registry &registry, unsigned num_steps) {
     EDYN_ASSERT(is_paused(registry));
+    auto &settings = registry.ctx().get<edyn::settings>();
+    internal::capture_call(registry, internal::capture_record_type::batch_step,
+                           (*settings.time_func)(), num_steps);
 
     if (auto *stepper = registry.ctx().find<stepper_async>()) {
-        stepper->step_simulation();
+        stepper->step_simulation(num_steps);
     } else {
-        registry.ctx().get<stepper_sequential>().step_simulation(time);
+        auto binding = scoped_dispatcher_binding(registry);
+        registry.ctx().get<stepper_sequential>().batch_step_simulation(num_steps);
     }
 
+    internal::capture_resume(registry);
     internal::update_paged_mesh_load_reporting(registry);
 }
 
+void rebase_origin(entt::registry &registry, const vector3 &offset) {
+    if (auto *stepper = registry.ctx().find<stepper_async>()) {
+        stepper->shift_origin(offset);
+    } else {
+        shift_origin(registry, offset);
+    }
+}
+
+void batch_step_simulation(const std::vector<entt::registry *> &registries, unsigned num_steps) {
+    if (registries.empty()) {
+        return;
+    }
+
+    auto &settings = registries.front()->ctx().get<edyn::settings>();
+
+    for (auto *registry : registries) {
+        EDYN_ASSERT(get_execution_mode(*registry) == execution_mode::sequential);
+        EDYN_ASSERT(is_paused(*registry));
+        auto time = (*registry->ctx().get<edyn::settings>().time_func)();
+        internal::capture_call(*registry, internal::capture_record_type::batch_step, time, num_steps);
+    }
+
+    auto task_func = [&](unsigned start, unsigned end) {
+        for (auto i = start; i < end; ++i) {
+            registries[i]->ctx().get<stepper_sequential>().batch_step_simulation(num_steps);
+        }
+    };
+
+    auto binding = scoped_dispatcher_binding(*registries.front());
+    auto task = task_delegate_t(entt::connect_arg_t<&decltype(task_func)::operator()>{}, task_func);
+    (*settings.enqueue_task_wait)(task, static_cast<unsigned>(registries.size()));
+
+    // Signals are emitted in the calling thread.
+    for (auto *registry : registries) {
+        internal::capture_resume(*registry);
+        internal::update_paged_mesh_load_reporting(*registry);
+    }
+}
+
 execution_mode get_execution_mode(const entt::registry &registry) {
     auto &settings = registry.ctx().get<edyn::settings>();
     return settings.execution_mode;
@@ -275,4 +510,38 @@ enqueue_task_wait_t * get_enqueue_task_wait(entt::registry &registry) {
     return registry.ctx().get<settings>().enqueue_task_wait;
 }
 
+job_dispatcher & get_job_dispatcher(entt::registry &registry) {
+    auto *dispatcher = registry.ctx().get<settings>().dispatcher;
+    return dispatcher ? *dispatcher : job_dispatcher::global();
+}
+
+void set_job_dispatcher(entt::registry &registry, job_dispatcher *dispatcher,
+                        const core_set &simulation_cores) {
+    EDYN_ASSERT((dispatcher ? *dispatcher : job_dispatcher::global()).running());
+    auto &settings = registry.ctx().get<edyn::settings>();
+    settings.dispatcher = dispatcher;
+    settings.simulation_thread_cores = simulation_cores;
+    refresh_settings(registry);
+}
+
+simulation_pacing get_simulation_pacing(const entt::registry &registry) {
+    return registry.ctx().get<settings>().pacing;
+}
+
+void set_simulation_pacing(entt::registry &registry, simulation_pacing pacing) {
+    auto &settings = registry.ctx().get<edyn::settings>();
+    settings.pacing = pacing;
+    refresh_settings(registry);
+}
+
+tick_jitter_histogram get_tick_jitter_histogram(const entt::registry &registry) {
+    EDYN_ASSERT(registry.ctx().contains<stepper_async>());
+    return registry.ctx().get<stepper_async>().get_tick_jitter_histogram();
+}
+
+void reset_tick_jitter_histogram(entt::registry &registry) {
+    EDYN_ASSERT(registry.ctx().contains<stepper_async>());
+    registry.ctx().get<stepper_async>().reset_tick_jitter_histogram();
+}
+
 }
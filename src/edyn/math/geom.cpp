@@ -5,6 +5,7 @@
 #include "edyn/math/vector3.hpp"
 #include "edyn/math/transform.hpp"
 #include "edyn/math/triangle.hpp"
+#include "edyn/math/simd_vector3.hpp"
 #include <algorithm>
 
 namespace edyn {
@@ -169,6 +170,87 @@ scalar closest_point_segment_segment(const vector3 &p1, const vector3 &q1,
     return length_sqr(c1 - c2);
 }
 
+// Stores the first `count` lanes of `v` into `ptr`.
+static void store_lanes(simd_scalar v, scalar *ptr, size_t count) noexcept {
+    alignas(simd_alignment) scalar values[simd_width];
+    v.store(values);
+    std::copy_n(values, std::min(count, simd_width), ptr);
+}
+
+static simd_scalar clamp_unit(simd_scalar s) noexcept {
+    return min(max(s, simd_scalar::splat(0)), simd_scalar::splat(1));
+}
+
+void closest_point_segment_segment(const vector3 *p1, const vector3 *q1,
+                                   const vector3 *p2, const vector3 *q2,
+                                   size_t count, scalar *s, scalar *t,
+                                   scalar *dist_sqr) noexcept {
+    const auto eps = simd_scalar::splat(EDYN_EPSILON);
+
+    for (size_t i = 0; i < count; i += simd_width) {
+        auto n = count - i;
+        auto p1i = simd_vector3::gather(p1 + i, n);
+        auto p2i = simd_vector3::gather(p2 + i, n);
+        auto d1 = simd_vector3::gather(q1 + i, n) - p1i;
+        auto d2 = simd_vector3::gather(q2 + i, n) - p2i;
+        auto r = p1i - p2i;
+        auto a = dot(d1, d1);
+        auto e = dot(d2, d2);
+        auto b = dot(d1, d2);
+        auto c = dot(d1, r);
+        auto f = dot(d2, r);
+
+        // Branchless form of the single pair version. Clamping the
+        // denominators handles degenerate and parallel segments: the
+        // numerators vanish along with them, giving a parameter of zero, or
+        // the parameter is clamped to one of the ends in the parallel case,
+        // which is one of the closest points. Recomputing `s` from the clamped
+        // `t` is a no-op if `t` was not clamped.
+        auto si = clamp_unit((b * f - c * e) / max(a * e - b * b, eps));
+        auto ti = clamp_unit((b * si + f) / max(e, eps));
+        si = clamp_unit((b * ti - c) / max(a, eps));
+
+        auto d = (p1i + d1 * si) - (p2i + d2 * ti);
+
+        store_lanes(si, s + i, n);
+        store_lanes(ti, t + i, n);
+        store_lanes(dot(d, d), dist_sqr + i, n);
+    }
+}
+
+void to_world_space(const vector3 *points, size_t count, const vector3 &pos,
+                    const quaternion &orn, vector3 *result) noexcept {
+    auto basis = to_matrix3x3(orn);
+    auto row0 = simd_vector3::splat(basis[0]);
+    auto row1 = simd_vector3::splat(basis[1]);
+    auto row2 = simd_vector3::splat(basis[2]);
+    auto posv = simd_vector3::splat(pos);
+
+    for (size_t i = 0; i < count; i += simd_width) {
+        auto n = count - i;
+        auto p = simd_vector3::gather(points + i, n);
+        auto q = posv + simd_vector3{dot(row0, p), dot(row1, p), dot(row2, p)};
+        q.scatter(result + i, n);
+    }
+}
+
+void to_object_space(const vector3 *points, size_t count, const vector3 &pos,
+                     const quaternion &orn, vector3 *result) noexcept {
+    // Multiply by the transpose of the rotation matrix, which is its inverse.
+    auto basis = transpose(to_matrix3x3(orn));
+    auto row0 = simd_vector3::splat(basis[0]);
+    auto row1 = simd_vector3::splat(basis[1]);
+    auto row2 = simd_vector3::splat(basis[2]);
+    auto posv = simd_vector3::splat(pos);
+
+    for (size_t i = 0; i < count; i += simd_width) {
+        auto n = count - i;
+        auto p = simd_vector3::gather(points + i, n) - posv;
+        auto q = simd_vector3{dot(row0, p), dot(row1, p), dot(row2, p)};
+        q.scatter(result + i, n);
+    }
+}
+
 scalar closest_point_disc(const vector3 &dpos, const quaternion &dorn,
                           scalar radius, coordinate_axis axis,
                           const vector3 &p, vector3 &q) noexcept {
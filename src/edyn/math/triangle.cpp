@@ -1,5 +1,6 @@
 #include "edyn/math/triangle.hpp"
 #include "edyn/math/constants.hpp"
+#include "edyn/math/simd_vector3.hpp"
 #include "edyn/shapes/triangle_mesh.hpp"
 
 namespace edyn {
@@ -25,6 +26,40 @@ bool point_in_triangle(const triangle_vertices &vertices,
            (d0 < EDYN_EPSILON && d1 < EDYN_EPSILON && d2 < EDYN_EPSILON);
 }
 
+void point_in_triangle(const triangle_vertices &vertices,
+                       const vector3 &normal,
+                       const vector3 *points, size_t count,
+                       bool *result) {
+    auto edges = get_triangle_edges(vertices);
+    auto v0 = simd_vector3::splat(vertices[0]);
+    auto v1 = simd_vector3::splat(vertices[1]);
+    auto v2 = simd_vector3::splat(vertices[2]);
+    auto en0 = simd_vector3::splat(cross(edges[0], normal));
+    auto en1 = simd_vector3::splat(cross(edges[1], normal));
+    auto en2 = simd_vector3::splat(cross(edges[2], normal));
+    auto pos_eps = simd_scalar::splat(EDYN_EPSILON);
+    auto neg_eps = simd_scalar::splat(-EDYN_EPSILON);
+
+    for (size_t i = 0; i < count; i += simd_width) {
+        auto n = count - i;
+        auto p = simd_vector3::gather(points + i, n);
+
+        auto d0 = dot(en0, p - v0);
+        auto d1 = dot(en1, p - v1);
+        auto d2 = dot(en2, p - v2);
+
+        // Lanes where any distance is outside the tolerance on either side.
+        auto below = less_equal_mask(d0, neg_eps) | less_equal_mask(d1, neg_eps) | less_equal_mask(d2, neg_eps);
+        auto above = less_equal_mask(pos_eps, d0) | less_equal_mask(pos_eps, d1) | less_equal_mask(pos_eps, d2);
+        // Inside if all are above `-EDYN_EPSILON` or all are below `EDYN_EPSILON`.
+        auto inside = ~below | ~above;
+
+        for (size_t lane = 0; lane < std::min(n, simd_width); ++lane) {
+            result[i + lane] = (inside >> lane) & 1u;
+        }
+    }
+}
+
 triangle_edges get_triangle_edges(const triangle_vertices &vertices) {
     return {
         vertices[1] - vertices[0],
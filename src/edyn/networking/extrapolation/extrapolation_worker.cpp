@@ -8,6 +8,7 @@
 #include "edyn/comp/rotated_mesh_list.hpp"
 #include "edyn/comp/tag.hpp"
 #include "edyn/config/config.h"
+#include "edyn/config/memory_resource.hpp"
 #include "edyn/constraints/contact_constraint.hpp"
 #include "edyn/context/registry_operation_context.hpp"
 #include "edyn/context/settings.hpp"
@@ -25,6 +26,7 @@
 #include "edyn/replication/registry_operation_builder.hpp"
 #include "edyn/comp/graph_node.hpp"
 #include "edyn/comp/graph_edge.hpp"
+#include "edyn/comp/island.hpp"
 #include "edyn/sys/update_aabbs.hpp"
 #include "edyn/sys/update_inertias.hpp"
 #include "edyn/sys/update_origins.hpp"
@@ -40,7 +42,8 @@ namespace edyn {
 extrapolation_worker::extrapolation_worker(const settings &settings,
                                            const registry_operation_context &reg_op_ctx,
                                            const material_mix_table &material_table,
-                                           make_extrapolation_modified_comp_func_t *make_extrapolation_modified_comp)
+                                           make_extrapolation_modified_comp_func_t *make_extrapolation_modified_comp,
+                                           const std::string &queue_name)
     : m_solver(m_registry)
     , m_poly_initializer(m_registry)
     , m_island_manager(m_registry)
@@ -51,7 +54,7 @@ extrapolation_worker::extrapolation_worker(const settings &settings,
         msg::set_settings,
         msg::set_registry_operation_context,
         msg::set_material_table,
-        msg::set_extrapolator_context_settings>("extrapolation_worker"))
+        msg::set_extrapolator_context_settings>(queue_name))
 {
     m_registry.ctx().emplace<contact_manifold_map>(m_registry);
     m_registry.ctx().emplace<broadphase>(m_registry);
@@ -111,30 +114,37 @@ void extrapolation_worker::stop() {
 
 void extrapolation_worker::set_settings(const edyn::settings &settings) {
     auto &dispatcher = message_dispatcher::global();
-    dispatcher.send<msg::set_settings>(m_message_queue.identifier, {"unknown"}, settings);
+    dispatcher.send<msg::set_settings>(m_message_queue.id, {}, settings);
 }
 
 void extrapolation_worker::set_material_table(const material_mix_table &material_table) {
     auto &dispatcher = message_dispatcher::global();
-    dispatcher.send<msg::set_material_table>(m_message_queue.identifier, {"unknown"}, material_table);
+    dispatcher.send<msg::set_material_table>(m_message_queue.id, {}, material_table);
 }
 
 void extrapolation_worker::set_registry_operation_context(const registry_operation_context &reg_op_ctx) {
     auto &dispatcher = message_dispatcher::global();
-    dispatcher.send<msg::set_registry_operation_context>(m_message_queue.identifier, {"unknown"}, reg_op_ctx);
+    dispatcher.send<msg::set_registry_operation_context>(m_message_queue.id, {}, reg_op_ctx);
 }
 
 void extrapolation_worker::set_context_settings(std::shared_ptr<input_state_history_reader> input_history,
                                                 make_extrapolation_modified_comp_func_t *make_extrapolation_modified_comp) {
     EDYN_ASSERT(make_extrapolation_modified_comp != nullptr);
     auto &dispatcher = message_dispatcher::global();
-    dispatcher.send<msg::set_extrapolator_context_settings>(m_message_queue.identifier, {"unknown"},
+    dispatcher.send<msg::set_extrapolator_context_settings>(m_message_queue.id, {},
                                                             input_history, make_extrapolation_modified_comp);
 }
 
+void extrapolation_worker::send_request(message_queue_id source, extrapolation_request &&request) {
+    m_num_pending_requests.fetch_add(1, std::memory_order_relaxed);
+    auto &dispatcher = message_dispatcher::global();
+    dispatcher.send<extrapolation_request>(m_message_queue.id, source, std::move(request));
+}
+
 void extrapolation_worker::on_extrapolation_request(message<extrapolation_request> &msg) {
     if (m_requests.size() == m_max_requests) {
         m_requests.erase(m_requests.begin());
+        m_num_pending_requests.fetch_sub(1, std::memory_order_relaxed);
     }
 
     m_requests.emplace_back(std::move(msg.content));
@@ -150,6 +160,7 @@ void extrapolation_worker::on_extrapolation_operation_destroy(message<extrapolat
         m_entity_map.erase(remote_entity);
 
         m_owned_entities.remove(local_entity);
+        m_diverged_entities.remove(local_entity);
         m_modified_comp->remove_entity(local_entity);
 
         if (m_registry.valid(local_entity)) {
@@ -215,7 +226,7 @@ void extrapolation_worker::on_extrapolation_operation_create(message<extrapolati
     });
 
     // Initialize shapes for new entities.
-    m_poly_initializer.init_new_shapes();
+    m_poly_initializer.init_new_shapes(true);
 
     // Initialize new nodes and edges and create islands.
     m_island_manager.update(m_current_time);
@@ -247,6 +258,10 @@ void extrapolation_worker::on_set_settings(message<msg::set_settings> &msg) {
         (*client_settings.extrapolation_init_callback)(m_registry);
     }
 
+    if (settings.dispatcher != current.dispatcher) {
+        job_dispatcher::bind_current(settings.dispatcher);
+    }
+
     current = settings;
 }
 
@@ -341,8 +356,25 @@ bool extrapolation_worker::begin_extrapolation(const extrapolation_request &requ
         }
     }
 
+    // The registry persists between extrapolations, thus entities which were
+    // not simulated since they were last imported still hold the last known
+    // remote state. Only rewind the entities which diverged and recalculate
+    // derived properties only for these and the ones in the snapshot.
+    auto rewind_entities = entt::sparse_set{};
+    auto refresh_entities = entt::sparse_set{};
+
+    for (auto entity : entities) {
+        if (m_diverged_entities.contains(entity)) {
+            rewind_entities.push(entity);
+            refresh_entities.push(entity);
+            m_diverged_entities.remove(entity);
+        } else if (snapshot_entities.contains(entity)) {
+            refresh_entities.push(entity);
+        }
+    }
+
     // Apply last known remote state as the initial state for extrapolation.
-    m_modified_comp->import_remote_state(entities);
+    m_modified_comp->import_remote_state(rewind_entities);
 
     if (m_input_history) {
         // Apply inputs that happened before the start time.
@@ -375,7 +407,7 @@ bool extrapolation_worker::begin_extrapolation(const extrapolation_request &requ
     // Recalculate properties after setting initial state from server.
     auto origin_view = m_registry.view<position, orientation, center_of_mass, origin>();
 
-    for (auto entity : entities) {
+    for (auto entity : refresh_entities) {
         if (origin_view.contains(entity)) {
             auto [pos, orn, com, orig] = origin_view.get(entity);
             orig = to_world_space(-com, pos, orn);
@@ -427,7 +459,7 @@ void extrapolation_worker::finish_extrapolation(const extrapolation_request &req
     m_modified_comp->clear_modified();
 
     auto result = extrapolation_result{};
-    result.ops = std::move(builder->finish());
+    result.ops = builder->finish();
     EDYN_ASSERT(!result.ops.empty());
 
     // All manifolds that are not sleeping have been involved in the
@@ -439,6 +471,26 @@ void extrapolation_worker::finish_extrapolation(const extrapolation_request &req
         }
     });
 
+    // Entities in awake islands have been simulated and have to be rewound
+    // before being involved in another extrapolation. Islands might have
+    // merged with others during extrapolation, thus these can include entities
+    // which were not involved at the beginning.
+    auto island_view = m_registry.view<island>(entt::exclude_t<sleeping_tag>{});
+
+    island_view.each([&](island &island) {
+        for (auto entity : island.nodes) {
+            if (!m_diverged_entities.contains(entity)) {
+                m_diverged_entities.push(entity);
+            }
+        }
+
+        for (auto entity : island.edges) {
+            if (!m_diverged_entities.contains(entity)) {
+                m_diverged_entities.push(entity);
+            }
+        }
+    });
+
     // Put all islands to sleep at the end.
     m_island_manager.put_all_to_sleep();
 
@@ -454,7 +506,7 @@ void extrapolation_worker::finish_extrapolation(const extrapolation_request &req
     }
 
     auto &dispatcher = message_dispatcher::global();
-    dispatcher.send<extrapolation_result>(request.destination, m_message_queue.identifier, std::move(result));
+    dispatcher.send<extrapolation_result>(request.destination, m_message_queue.id, std::move(result));
 }
 
 bool extrapolation_worker::should_step(const extrapolation_request &request) {
@@ -528,6 +580,8 @@ void extrapolation_worker::extrapolate(const extrapolation_request &request) {
 }
 
 void extrapolation_worker::run() {
+    job_dispatcher::bind_current(m_registry.ctx().get<settings>().dispatcher);
+    memory_resource::bind_current(m_registry.ctx().get<settings>().memory_resource);
     init();
 
     while (m_running.load(std::memory_order_relaxed)) {
@@ -546,6 +600,7 @@ void extrapolation_worker::run() {
                 auto req = std::move(m_requests.front());
                 m_requests.erase(m_requests.begin());
                 extrapolate(req);
+                m_num_pending_requests.fetch_sub(1, std::memory_order_relaxed);
             }
         } while (!m_requests.empty() && m_has_messages.exchange(false, std::memory_order_relaxed));
     }
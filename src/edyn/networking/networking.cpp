@@ -29,7 +29,12 @@ void edit_client_settings(entt::registry &registry, Func func) {
 
         if (auto *ctx = registry.ctx().find<client_network_context>()) {
             auto &settings = registry.ctx().get<edyn::settings>();
-            ctx->extrapolator->set_settings(settings);
+
+            for (auto &extrapolator : ctx->extrapolators) {
+                extrapolator->set_settings(settings);
+            }
+
+            update_extrapolation_workers(registry);
         }
     }
 }
@@ -104,6 +109,12 @@ network_client_packet_sink(entt::registry &registry) {
     return ctx.packet_sink();
 }
 
+entt::sink<entt::sigh<void(const uint8_t *, size_t, bool)>>
+network_client_packet_batch_sink(entt::registry &registry) {
+    auto &ctx = registry.ctx().get<client_network_context>();
+    return ctx.packet_batch_sink();
+}
+
 entt::sink<entt::sigh<void(entt::entity)>>
 network_client_assigned_sink(entt::registry &registry) {
     auto &ctx = registry.ctx().get<client_network_context>();
@@ -134,4 +145,10 @@ network_server_packet_sink(entt::registry &registry) {
     return ctx.packet_sink();
 }
 
+entt::sink<entt::sigh<void(entt::entity, const uint8_t *, size_t, bool)>>
+network_server_packet_batch_sink(entt::registry &registry) {
+    auto &ctx = registry.ctx().get<server_network_context>();
+    return ctx.packet_batch_sink();
+}
+
 }
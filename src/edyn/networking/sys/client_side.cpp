@@ -5,10 +5,12 @@
 #include "edyn/config/execution_mode.hpp"
 #include "edyn/constraints/constraint.hpp"
 #include "edyn/context/registry_operation_context.hpp"
+#include "edyn/context/task_util.hpp"
 #include "edyn/dynamics/material_mixing.hpp"
 #include "edyn/networking/comp/action_history.hpp"
 #include "edyn/networking/comp/asset_ref.hpp"
 #include "edyn/networking/comp/discontinuity.hpp"
+#include "edyn/networking/comp/interpolation_buffer.hpp"
 #include "edyn/networking/extrapolation/extrapolation_operation.hpp"
 #include "edyn/networking/extrapolation/extrapolation_result.hpp"
 #include "edyn/networking/networking_external.hpp"
@@ -17,7 +19,9 @@
 #include "edyn/networking/packet/entity_entered.hpp"
 #include "edyn/networking/packet/entity_exited.hpp"
 #include "edyn/networking/packet/entity_response.hpp"
+#include "edyn/networking/packet/island_sleep.hpp"
 #include "edyn/networking/util/component_index_type.hpp"
+#include "edyn/networking/util/packet_batch.hpp"
 #include "edyn/networking/util/process_extrapolation_result.hpp"
 #include "edyn/networking/util/process_update_entity_map_packet.hpp"
 #include "edyn/core/entity_graph.hpp"
@@ -29,17 +33,26 @@
 #include "edyn/networking/context/client_network_context.hpp"
 #include "edyn/networking/extrapolation/extrapolation_worker.hpp"
 #include "edyn/comp/tag.hpp"
+#include "edyn/comp/position.hpp"
+#include "edyn/comp/orientation.hpp"
 #include "edyn/networking/util/snap_to_pool_snapshot.hpp"
+#include "edyn/networking/util/reconcile_pool_snapshot.hpp"
 #include "edyn/parallel/message_dispatcher.hpp"
 #include "edyn/simulation/stepper_async.hpp"
 #include "edyn/parallel/job_dispatcher.hpp"
 #include "edyn/serialization/std_s11n.hpp"
+#include "edyn/util/entt_util.hpp"
 #include "edyn/util/island_util.hpp"
+#include "edyn/util/rigidbody.hpp"
 #include "edyn/util/vector_util.hpp"
 #include "edyn/util/aabb_util.hpp"
 #include "edyn/time/simulation_time.hpp"
+#include "edyn/time/time.hpp"
 #include <entt/entity/registry.hpp>
 #include <set>
+#include <string>
+#include <algorithm>
+#include <thread>
 
 namespace edyn {
 
@@ -80,6 +93,8 @@ void on_construct_entity_owner(entt::registry &registry, entt::entity entity) {
 
     if (owner.client_entity == ctx.client_entity) {
         ctx.owned_entities.push(entity);
+        // Owned entities are presented from the local simulation.
+        registry.remove<interpolation_buffer>(entity);
     }
 }
 
@@ -105,7 +120,7 @@ static void update_input_history(entt::registry &registry, double timestamp) {
     auto &settings = registry.ctx().get<edyn::settings>();
     auto &client_settings = std::get<client_network_settings>(settings.network_settings);
     const auto client_server_time_difference =
-        ctx.server_playout_delay + client_settings.round_trip_time / 2;
+        ctx.server_playout_delay + clock_sync_round_trip_time(ctx.clock_sync, client_settings.round_trip_time) / 2;
     ctx.input_history->erase_until(timestamp - (client_server_time_difference * 1.6 + 0.4));
 }
 
@@ -130,8 +145,18 @@ static void on_extrapolation_result(entt::registry &registry, message<extrapolat
     }
 }
 
+static void batch_packet(entt::registry &registry, const packet::edyn_packet &packet) {
+    auto &settings = registry.ctx().get<edyn::settings>();
+    auto &client_settings = std::get<client_network_settings>(settings.network_settings);
+
+    if (client_settings.batch_packets) {
+        registry.ctx().get<client_network_context>().outbound_packets.insert(packet);
+    }
+}
+
 void init_network_client(entt::registry &registry) {
     auto &ctx = registry.ctx().emplace<client_network_context>(registry);
+    ctx.packet_sink().connect<&batch_packet>(registry);
 
     registry.on_construct<networked_tag>().connect<&on_construct_networked_entity>();
     registry.on_destroy<networked_tag>().connect<&on_destroy_networked_entity>();
@@ -150,16 +175,29 @@ void init_network_client(entt::registry &registry) {
         stepper->settings_changed();
     }
 
-    auto &reg_op_ctx = registry.ctx().get<registry_operation_context>();
-    auto &material_table = registry.ctx().get<material_mix_table>();
-    ctx.extrapolator = std::make_unique<extrapolation_worker>(settings, reg_op_ctx, material_table,
-                                                              ctx.make_extrapolation_modified_comp);
-    ctx.extrapolator->start();
+    update_extrapolation_workers(registry);
 
     ctx.message_queue.sink<extrapolation_result>().connect<&on_extrapolation_result>(registry);
 }
 
 void deinit_network_client(entt::registry &registry) {
+    // Wait for the snapshot decoding task to finish since it refers to the
+    // context which is about to be destroyed.
+    auto &decode_queue = *registry.ctx().get<client_network_context>().snapshot_decode;
+
+    while (true) {
+        {
+            std::lock_guard lock(decode_queue.mutex);
+            decode_queue.pending.clear();
+
+            if (!decode_queue.running) {
+                break;
+            }
+        }
+
+        std::this_thread::yield();
+    }
+
     registry.ctx().erase<client_network_context>();
 
     registry.on_construct<networked_tag>().disconnect<&on_construct_networked_entity>();
@@ -173,9 +211,9 @@ void deinit_network_client(entt::registry &registry) {
     registry.on_destroy<graph_edge>().disconnect<&on_destroy_shared>();
 }
 
-void add_entities_to_extrapolator(entt::registry &registry,
-                                  const std::vector<entt::entity> &entities,
-                                  const std::vector<entt::entity> &owned_entities) {
+static void add_entities_to_extrapolator(entt::registry &registry, extrapolation_worker &extrapolator,
+                                         const std::vector<entt::entity> &entities,
+                                         const std::vector<entt::entity> &owned_entities) {
     auto &ctx = registry.ctx().get<client_network_context>();
     auto &reg_op_ctx = registry.ctx().get<registry_operation_context>();
     auto builder = (*reg_op_ctx.make_reg_op_builder)(registry);
@@ -195,16 +233,80 @@ void add_entities_to_extrapolator(entt::registry &registry,
     auto op = builder->finish();
     auto &dispatcher = message_dispatcher::global();
     dispatcher.send<extrapolation_operation_create>(
-        {"extrapolation_worker"}, ctx.message_queue.identifier,
+        extrapolator.queue_id(), ctx.message_queue.id,
         std::move(op), owned_entities);
 }
 
+void add_entities_to_extrapolator(entt::registry &registry,
+                                  const std::vector<entt::entity> &entities,
+                                  const std::vector<entt::entity> &owned_entities) {
+    // Operations can't be copied, thus one is built for each worker.
+    auto &ctx = registry.ctx().get<client_network_context>();
+
+    for (auto &extrapolator : ctx.extrapolators) {
+        add_entities_to_extrapolator(registry, *extrapolator, entities, owned_entities);
+    }
+}
+
 void remove_entities_from_extrapolator(entt::registry &registry,
                                        const std::vector<entt::entity> &entities) {
     auto &ctx = registry.ctx().get<client_network_context>();
     auto &dispatcher = message_dispatcher::global();
-    dispatcher.send<extrapolation_operation_destroy>(
-        {"extrapolation_worker"}, ctx.message_queue.identifier, entities);
+
+    for (auto &extrapolator : ctx.extrapolators) {
+        dispatcher.send<extrapolation_operation_destroy>(
+            extrapolator->queue_id(), ctx.message_queue.id, entities);
+    }
+}
+
+void update_extrapolation_workers(entt::registry &registry) {
+    auto &ctx = registry.ctx().get<client_network_context>();
+    auto &settings = registry.ctx().get<edyn::settings>();
+    auto &client_settings = std::get<client_network_settings>(settings.network_settings);
+    auto num_workers = std::max(client_settings.num_extrapolation_workers, 1u);
+
+    if (ctx.extrapolators.size() >= num_workers) {
+        return;
+    }
+
+    auto &reg_op_ctx = registry.ctx().get<registry_operation_context>();
+    auto &material_table = registry.ctx().get<material_mix_table>();
+
+    // New workers need a copy of all networked entities created so far.
+    auto manifold_view = registry.view<contact_manifold>();
+    auto entities = std::vector<entt::entity>{};
+    auto owned_entities = std::vector<entt::entity>{};
+
+    for (auto entity : registry.view<networked_tag>()) {
+        if (!manifold_view.contains(entity) && !vector_contains(ctx.created_entities, entity)) {
+            entities.push_back(entity);
+
+            if (ctx.owned_entities.contains(entity)) {
+                owned_entities.push_back(entity);
+            }
+        }
+    }
+
+    while (ctx.extrapolators.size() < num_workers) {
+        auto queue_name = ctx.extrapolators.empty() ?
+            std::string("extrapolation_worker") :
+            "extrapolation_worker_" + std::to_string(ctx.extrapolators.size());
+        auto &extrapolator = ctx.extrapolators.emplace_back(
+            std::make_unique<extrapolation_worker>(settings, reg_op_ctx, material_table,
+                                                   ctx.make_extrapolation_modified_comp,
+                                                   queue_name));
+        ctx.extrapolator_entities.emplace_back();
+
+        if (ctx.input_history_reader) {
+            extrapolator->set_context_settings(ctx.input_history_reader, ctx.make_extrapolation_modified_comp);
+        }
+
+        if (!entities.empty()) {
+            add_entities_to_extrapolator(registry, *extrapolator, entities, owned_entities);
+        }
+
+        extrapolator->start();
+    }
 }
 
 static void process_created_entities(entt::registry &registry) {
@@ -289,12 +391,52 @@ static void dispatch_extrapolations(entt::registry &registry) {
         return;
     }
 
-    auto &dispatcher = message_dispatcher::global();
+    auto &settings = registry.ctx().get<edyn::settings>();
+    auto &client_settings = std::get<client_network_settings>(settings.network_settings);
+    auto num_workers = std::clamp(client_settings.num_extrapolation_workers, 1u,
+                                  static_cast<unsigned>(ctx.extrapolators.size()));
+
+    for (unsigned i = 0; i < num_workers; ++i) {
+        if (ctx.extrapolators[i]->num_pending_requests() == 0) {
+            ctx.extrapolator_entities[i].clear();
+        }
+    }
 
     for (auto &req : ctx.pending_extrapolations) {
-        dispatcher.send<extrapolation_request>({"extrapolation_worker"},
-                                               ctx.message_queue.identifier,
-                                               std::move(req));
+        // Requests involving entities which are being extrapolated by a worker
+        // go to the same worker so results arrive in order. Independent
+        // requests go to the least busy worker.
+        auto worker_index = num_workers;
+
+        for (unsigned i = 0; i < num_workers && worker_index == num_workers; ++i) {
+            for (auto entity : req.snapshot.entities) {
+                if (ctx.extrapolator_entities[i].contains(entity)) {
+                    worker_index = i;
+                    break;
+                }
+            }
+        }
+
+        if (worker_index == num_workers) {
+            worker_index = 0;
+
+            for (unsigned i = 1; i < num_workers; ++i) {
+                if (ctx.extrapolators[i]->num_pending_requests() <
+                    ctx.extrapolators[worker_index]->num_pending_requests()) {
+                    worker_index = i;
+                }
+            }
+        }
+
+        auto &worker_entities = ctx.extrapolator_entities[worker_index];
+
+        for (auto entity : req.snapshot.entities) {
+            if (!worker_entities.contains(entity)) {
+                worker_entities.push(entity);
+            }
+        }
+
+        ctx.extrapolators[worker_index]->send_request(ctx.message_queue.id, std::move(req));
     }
 
     ctx.pending_extrapolations.clear();
@@ -311,11 +453,22 @@ static void maybe_publish_registry_snapshot(entt::registry &registry, double tim
 
     ctx.last_snapshot_time = time;
 
+    const auto collect_stats = client_settings.collect_network_stats;
+    const auto start_time = collect_stats ? performance_time() : 0;
+
     auto packet = packet::registry_snapshot{};
     ctx.snapshot_exporter->export_modified(packet, ctx.client_entity, ctx.owned_entities, ctx.allow_full_ownership);
 
     if (!packet.entities.empty() && !packet.pools.empty()) {
         packet.timestamp = get_simulation_timestamp(registry);
+        packet.clock = clock_sync_make_sample(ctx.clock_sync, time);
+
+        if (collect_stats) {
+            ++ctx.stats.snapshots_sent;
+            ctx.stats.export_time += performance_time() - start_time;
+            ctx.stats.record_sent(packet);
+        }
+
         ctx.packet_signal.publish(packet::edyn_packet{std::move(packet)});
     }
 }
@@ -347,6 +500,52 @@ void update_client_snapshot_exporter(entt::registry &registry, double time) {
     ctx.snapshot_exporter->update(time);
 }
 
+static void publish_snapshot_acks(entt::registry &registry) {
+    auto &ctx = registry.ctx().get<client_network_context>();
+
+    if (ctx.pending_snapshot_acks.empty()) {
+        return;
+    }
+
+    auto packet = packet::snapshot_ack{};
+    packet.ids = std::move(ctx.pending_snapshot_acks);
+    ctx.pending_snapshot_acks.clear();
+    ctx.packet_signal.publish(packet::edyn_packet{std::move(packet)});
+}
+
+static void publish_packet_batch(entt::registry &registry) {
+    auto &ctx = registry.ctx().get<client_network_context>();
+    ctx.outbound_packets.flush([&](const uint8_t *data, size_t size, bool reliable) {
+        ctx.packet_batch_signal.publish(data, size, reliable);
+    });
+}
+
+static void process_decoded_registry_snapshot(entt::registry &registry, packet::registry_snapshot &snapshot);
+
+static void process_decoded_registry_snapshots(entt::registry &registry) {
+    auto &ctx = registry.ctx().get<client_network_context>();
+    auto &queue = *ctx.snapshot_decode;
+    auto snapshots = std::vector<packet::registry_snapshot>{};
+
+    {
+        std::lock_guard lock(queue.mutex);
+        snapshots.swap(queue.decoded);
+        ctx.pending_snapshot_acks.insert(ctx.pending_snapshot_acks.end(), queue.acks.begin(), queue.acks.end());
+        queue.acks.clear();
+        auto &settings = registry.ctx().get<edyn::settings>();
+
+        if (std::get<client_network_settings>(settings.network_settings).collect_network_stats) {
+            ctx.stats.import_time += queue.decode_time;
+        }
+
+        queue.decode_time = 0;
+    }
+
+    for (auto &snapshot : snapshots) {
+        process_decoded_registry_snapshot(registry, snapshot);
+    }
+}
+
 void update_network_client(entt::registry &registry) {
     auto &settings = registry.ctx().get<edyn::settings>();
     auto time = (*settings.time_func)();
@@ -356,12 +555,15 @@ void update_network_client(entt::registry &registry) {
     process_client_destroyed_entities(registry, time);
     process_created_entities(registry);
     process_destroyed_entities(registry);
+    process_decoded_registry_snapshots(registry);
     dispatch_extrapolations(registry);
     update_client_snapshot_exporter(registry, time);
     maybe_publish_registry_snapshot(registry, time);
+    publish_snapshot_acks(registry);
     registry.ctx().get<client_network_context>().message_queue.update();
     trim_and_insert_actions(registry, time);
     update_input_history(registry, time);
+    publish_packet_batch(registry);
 }
 
 static void process_packet(entt::registry &registry, const packet::client_created &packet) {
@@ -422,21 +624,139 @@ static void assign_discontinuity_components(entt::registry &registry, entt::enti
     }
 }
 
+// Assigns the components which are not networked to entities which were just
+// imported from the server, such as computed properties, graph nodes and
+// discontinuities. Each component is inserted into all entities at once.
+static void initialize_imported_entities(entt::registry &registry, const std::vector<entt::entity> &entities) {
+    if (entities.size() > 1) {
+        reserve_storage<AABB, mass_inv, inertia_inv, inertia_world_inv,
+                        networked_tag, graph_node>(registry, entities.size());
+    }
+
+    auto shape_view = registry.view<shape_index, position, orientation>();
+    auto mass_view = registry.view<mass>();
+    auto inertia_view = registry.view<inertia>();
+    auto dynamic_view = registry.view<dynamic_tag>();
+    auto procedural_view = registry.view<procedural_tag>();
+    auto rigidbody_view = registry.view<rigidbody_tag>();
+    auto external_view = registry.view<external_tag>();
+    auto &discontinuity_storage = registry.storage<discontinuity>();
+    auto &networked_storage = registry.storage<networked_tag>();
+    auto &graph_node_storage = registry.storage<graph_node>();
+    auto &graph = registry.ctx().get<entity_graph>();
+
+    auto aabb_entities = std::vector<entt::entity>{};
+    auto aabbs = std::vector<AABB>{};
+    auto mass_entities = std::vector<entt::entity>{};
+    auto mass_invs = std::vector<mass_inv>{};
+    auto inertia_entities = std::vector<entt::entity>{};
+    auto inertia_invs = std::vector<inertia_inv>{};
+    auto inertia_world_invs = std::vector<inertia_world_inv>{};
+    auto discontinuity_entities = std::vector<entt::entity>{};
+    auto untagged_entities = std::vector<entt::entity>{};
+    auto node_entities = std::vector<entt::entity>{};
+    auto nodes = std::vector<graph_node>{};
+    auto procedural_entities = std::vector<entt::entity>{};
+    auto non_procedural_entities = std::vector<entt::entity>{};
+
+    for (auto entity : entities) {
+        // Assign computed properties such as AABB and inverse mass.
+        if (shape_view.contains(entity)) {
+            auto &pos = shape_view.get<position>(entity);
+            auto &orn = shape_view.get<orientation>(entity);
+
+            visit_shape(registry, entity, [&](auto &&shape) {
+                aabb_entities.push_back(entity);
+                aabbs.push_back(shape_aabb(shape, pos, orn));
+            });
+        }
+
+        auto is_dynamic = dynamic_view.contains(entity);
+
+        if (mass_view.contains(entity)) {
+            auto [m] = mass_view.get(entity);
+            EDYN_ASSERT(
+                (is_dynamic && m > 0 && m < EDYN_SCALAR_MAX) ||
+                (registry.any_of<kinematic_tag, static_tag>(entity) && m == EDYN_SCALAR_MAX));
+            mass_entities.push_back(entity);
+            mass_invs.push_back({is_dynamic ? scalar(1) / m : scalar(0)});
+        }
+
+        if (inertia_view.contains(entity)) {
+            auto [I] = inertia_view.get(entity);
+            EDYN_ASSERT(is_dynamic ? I != matrix3x3_zero : I == matrix3x3_zero);
+            auto I_inv = is_dynamic ? inverse_matrix_symmetric(I) : matrix3x3_zero;
+            inertia_entities.push_back(entity);
+            inertia_invs.push_back({I_inv});
+            inertia_world_invs.push_back({I_inv});
+        }
+
+        // Assign discontinuity to dynamic rigid bodies.
+        if (is_dynamic && !discontinuity_storage.contains(entity)) {
+            discontinuity_entities.push_back(entity);
+        }
+
+        // All remote entities must have a networked tag.
+        if (!networked_storage.contains(entity)) {
+            untagged_entities.push_back(entity);
+        }
+
+        // Assign graph node to rigid bodies and external entities.
+        if ((rigidbody_view.contains(entity) || external_view.contains(entity)) &&
+            !graph_node_storage.contains(entity)) {
+            auto is_procedural = procedural_view.contains(entity);
+            node_entities.push_back(entity);
+            nodes.push_back({graph.insert_node(entity, !is_procedural)});
+
+            if (is_procedural) {
+                procedural_entities.push_back(entity);
+            } else {
+                non_procedural_entities.push_back(entity);
+            }
+        }
+    }
+
+    registry.insert<AABB>(aabb_entities.begin(), aabb_entities.end(), aabbs.begin());
+    registry.insert<mass_inv>(mass_entities.begin(), mass_entities.end(), mass_invs.begin());
+    registry.insert<inertia_inv>(inertia_entities.begin(), inertia_entities.end(), inertia_invs.begin());
+    registry.insert<inertia_world_inv>(inertia_entities.begin(), inertia_entities.end(), inertia_world_invs.begin());
+
+    registry.insert<discontinuity>(discontinuity_entities.begin(), discontinuity_entities.end());
+    registry.insert<discontinuity_accumulator>(discontinuity_entities.begin(), discontinuity_entities.end());
+
+    // As in `assign_discontinuity_components`.
+    if (registry.ctx().get<settings>().execution_mode != execution_mode::asynchronous) {
+        registry.insert<previous_position>(discontinuity_entities.begin(), discontinuity_entities.end());
+        registry.insert<previous_orientation>(discontinuity_entities.begin(), discontinuity_entities.end());
+    }
+
+    registry.insert<networked_tag>(untagged_entities.begin(), untagged_entities.end());
+    registry.insert<graph_node>(node_entities.begin(), node_entities.end(), nodes.begin());
+    registry.insert<island_resident>(procedural_entities.begin(), procedural_entities.end());
+    registry.insert<multi_island_resident>(non_procedural_entities.begin(), non_procedural_entities.end());
+}
+
 static void process_packet(entt::registry &registry, const packet::create_entity &packet) {
     auto &ctx = registry.ctx().get<client_network_context>();
 
     // Collect new entity mappings to send back to server.
     auto emap_packet = packet::update_entity_map{};
-    std::vector<entt::entity> entities_created;
+    std::vector<entt::entity> remote_entities_created;
 
-    // Create entities first...
     for (auto remote_entity : packet.entities) {
-        if (ctx.entity_map.contains(remote_entity)) continue;
+        if (!ctx.entity_map.contains(remote_entity)) {
+            remote_entities_created.push_back(remote_entity);
+        }
+    }
 
-        auto local_entity = registry.create();
-        ctx.entity_map.insert(remote_entity, local_entity);
-        emap_packet.pairs.emplace_back(remote_entity, local_entity);
-        entities_created.push_back(local_entity);
+    // Create all entities first...
+    std::vector<entt::entity> entities_created(remote_entities_created.size());
+    registry.create(entities_created.begin(), entities_created.end());
+    emap_packet.pairs.reserve(entities_created.size());
+
+    for (size_t i = 0; i < entities_created.size(); ++i) {
+        ctx.entity_map.insert(remote_entities_created[i], entities_created[i]);
+        emap_packet.pairs.emplace_back(remote_entities_created[i], entities_created[i]);
     }
 
     if (!emap_packet.pairs.empty()) {
@@ -455,64 +775,10 @@ static void process_packet(entt::registry &registry, const packet::create_entity
     ctx.snapshot_exporter->set_observer_enabled(true);
 
     // Create nodes and edges in entity graph, assign networked tags and
-    // dependent components which are not networked.
-    for (auto entity : entities_created) {
-        // Assign computed properties such as AABB and inverse mass.
-        if (registry.any_of<shape_index>(entity)) {
-            auto &pos = registry.get<position>(entity);
-            auto &orn = registry.get<orientation>(entity);
-
-            visit_shape(registry, entity, [&](auto &&shape) {
-                auto aabb = shape_aabb(shape, pos, orn);
-                registry.emplace<AABB>(entity, aabb);
-            });
-        }
-
-        if (auto *mass = registry.try_get<edyn::mass>(entity)) {
-            EDYN_ASSERT(
-                (registry.all_of<dynamic_tag>(entity) && *mass > 0 && *mass < EDYN_SCALAR_MAX) ||
-                (registry.any_of<kinematic_tag, static_tag>(entity) && *mass == EDYN_SCALAR_MAX));
-            auto inv = registry.all_of<dynamic_tag>(entity) ? scalar(1) / *mass : scalar(0);
-            registry.emplace<mass_inv>(entity, inv);
-        }
-
-        if (auto *inertia = registry.try_get<edyn::inertia>(entity)) {
-            if (registry.all_of<dynamic_tag>(entity)) {
-                EDYN_ASSERT(*inertia != matrix3x3_zero);
-                auto I_inv = inverse_matrix_symmetric(*inertia);
-                registry.emplace<inertia_inv>(entity, I_inv);
-                registry.emplace<inertia_world_inv>(entity, I_inv);
-            } else {
-                EDYN_ASSERT(*inertia == matrix3x3_zero);
-                registry.emplace<inertia_inv>(entity, matrix3x3_zero);
-                registry.emplace<inertia_world_inv>(entity, matrix3x3_zero);
-            }
-        }
-
-        // Assign discontinuity to dynamic rigid bodies.
-        if (registry.any_of<dynamic_tag>(entity) && !registry.all_of<discontinuity>(entity)) {
-            assign_discontinuity_components(registry, entity);
-        }
-
-        // All remote entities must have a networked tag.
-        if (!registry.all_of<networked_tag>(entity)) {
-            registry.emplace<networked_tag>(entity);
-        }
-
-        // Assign graph node to rigid bodies and external entities.
-        if (registry.any_of<rigidbody_tag, external_tag>(entity) &&
-            !registry.all_of<graph_node>(entity)) {
-            auto is_procedural = registry.any_of<procedural_tag>(entity);
-            auto node_index = registry.ctx().get<entity_graph>().insert_node(entity, !is_procedural);
-            registry.emplace<graph_node>(entity, node_index);
-
-            if (is_procedural) {
-                registry.emplace<island_resident>(entity);
-            } else {
-                registry.emplace<multi_island_resident>(entity);
-            }
-        }
-    }
+    // dependent components which are not networked. The new graph nodes are
+    // sent to the extrapolators together in the next update (see
+    // `process_created_entities`).
+    initialize_imported_entities(registry, entities_created);
 
     // Create graph edges for constraints *after* graph nodes have been created
     // for rigid bodies above.
@@ -575,8 +841,14 @@ static void process_packet(entt::registry &registry, packet::entity_entered &pac
     auto emap_packet = packet::update_entity_map{};
     std::vector<entt::entity> local_entities;
     local_entities.reserve(packet.entry.size());
+    emap_packet.pairs.reserve(packet.entry.size());
 
-    // Create entities first...
+    if (packet.entry.size() > 1) {
+        reserve_storage<asset_ref, networked_tag>(registry, packet.entry.size());
+    }
+
+    // Entities are created one by one since each is announced to the
+    // application as soon as it's created, which may instantiate the asset.
     for (auto &info : packet.entry) {
         auto remote_entity = info.entity;
         if (ctx.entity_map.contains(remote_entity)) continue;
@@ -688,26 +960,308 @@ static void snap_to_registry_snapshot(entt::registry &registry, packet::registry
                                                                  std::move(snapshot.pools),
                                                                  should_accumulate_discontinuities);
     } else {
+        // Only wake up the islands of the entities which are corrected.
+        auto &client_settings = std::get<client_network_settings>(settings.network_settings);
+        auto corrected = std::vector<entt::entity>{};
+        reconcile_pool_snapshot(registry, snapshot.entities, snapshot.pools, client_settings, corrected);
+
         auto &ctx = registry.ctx().get<client_network_context>();
         ctx.snapshot_exporter->set_observer_enabled(false);
         snap_to_pool_snapshot(registry, snapshot.entities, snapshot.pools, should_accumulate_discontinuities);
         ctx.snapshot_exporter->set_observer_enabled(true);
 
-        wake_up_island_residents(registry, snapshot.entities);
+        wake_up_island_residents(registry, corrected);
+    }
+}
+
+// Restores delta-encoded components and records the values in this snapshot
+// so it can be used as a baseline once the server gets the acknowledgement.
+// Returns whether the snapshot must be acknowledged. It only accesses the
+// snapshot baseline, thus it can run in a background task.
+static bool decode_registry_snapshot(client_network_context &ctx, packet::registry_snapshot &snapshot) {
+    if (snapshot.id == snapshot_baseline::null_id) {
+        return false;
+    }
+
+    // Do not acknowledge if some components could not be decoded since
+    // the server would assume this snapshot can be used as the baseline
+    // for those.
+    auto acknowledge = ctx.received_snapshots.decode(snapshot);
+    ctx.received_snapshots.insert(snapshot);
+
+    if (snapshot.id > ctx.last_received_snapshot_id) {
+        ctx.last_received_snapshot_id = snapshot.id;
+
+        if (snapshot.id > snapshot_baseline::max_age) {
+            ctx.received_snapshots.erase_until(snapshot.id - snapshot_baseline::max_age);
+        }
+    }
+
+    return acknowledge;
+}
+
+// Decodes all pending snapshots in a worker thread until there are none left.
+static void decode_registry_snapshots_task(client_network_context &ctx, unsigned, unsigned) {
+    auto &queue = *ctx.snapshot_decode;
+    auto snapshot = packet::registry_snapshot{};
+
+    while (true) {
+        {
+            std::lock_guard lock(queue.mutex);
+
+            if (queue.pending.empty()) {
+                queue.running = false;
+                return;
+            }
+
+            snapshot = std::move(queue.pending.front());
+            queue.pending.erase(queue.pending.begin());
+        }
+
+        auto start_time = performance_time();
+        auto acknowledge = decode_registry_snapshot(ctx, snapshot);
+        auto elapsed = performance_time() - start_time;
+
+        std::lock_guard lock(queue.mutex);
+        queue.decode_time += elapsed;
+
+        if (acknowledge) {
+            queue.acks.push_back(snapshot.id);
+        }
+
+        queue.decoded.push_back(std::move(snapshot));
     }
 }
 
 static void process_packet(entt::registry &registry, packet::registry_snapshot &snapshot) {
-    if (contains_unknown_entities(registry, snapshot.entities)) {
-        // Do not perform extrapolation if it contains unknown entities as the
-        // result would not make much sense if all parts are not involved.
-        // This should not happen very often.
+    auto &ctx = registry.ctx().get<client_network_context>();
+    auto &settings = registry.ctx().get<edyn::settings>();
+    auto &queue = *ctx.snapshot_decode;
+
+    clock_sync_process_sample(ctx.clock_sync, snapshot.clock, (*settings.time_func)());
+
+    auto collect_stats = std::get<client_network_settings>(settings.network_settings).collect_network_stats;
+
+    if (collect_stats) {
+        ++ctx.stats.packets_received;
+        ctx.stats.entities_received += snapshot.entities.size();
+    }
+
+    // Decode snapshots in a background task in the multithreaded execution
+    // modes, so the main thread doesn't stall when large snapshots arrive.
+    // They're processed in the next update once decoded. Snapshots must be
+    // decoded in order, thus they're queued while a task is running even if
+    // the execution mode has changed.
+    auto start_task = false;
+
+    {
+        std::lock_guard lock(queue.mutex);
+
+        if (settings.execution_mode != execution_mode::sequential || queue.running) {
+            queue.pending.push_back(std::move(snapshot));
+            start_task = !queue.running;
+            queue.running = true;
+
+            if (!start_task) {
+                return;
+            }
+        }
+    }
+
+    if (start_task) {
+        auto task = task_delegate_t(entt::connect_arg_t<&decode_registry_snapshots_task>{}, ctx);
+        enqueue_task(registry, task, 1, {});
         return;
     }
 
+    auto start_time = collect_stats ? performance_time() : 0;
+
+    if (decode_registry_snapshot(ctx, snapshot)) {
+        ctx.pending_snapshot_acks.push_back(snapshot.id);
+    }
+
+    if (collect_stats) {
+        ctx.stats.import_time += performance_time() - start_time;
+    }
+
+    process_decoded_registry_snapshot(registry, snapshot);
+}
+
+// Moves the entities which are not in the scope of extrapolation into a
+// separate snapshot, i.e. the entities in islands which don't contain owned
+// entities and which are not within the extrapolation radius of any of them.
+static void split_registry_snapshot_by_extrapolation_scope(entt::registry &registry,
+                                                           packet::registry_snapshot &snapshot,
+                                                           packet::registry_snapshot &outside) {
     auto &ctx = registry.ctx().get<client_network_context>();
     auto &settings = registry.ctx().get<edyn::settings>();
     auto &client_settings = std::get<client_network_settings>(settings.network_settings);
+    auto resident_view = registry.view<island_resident>();
+    auto island_aabb_view = registry.view<island_AABB>();
+    auto aabb_view = registry.view<AABB>();
+
+    // Islands containing owned entities, enlarged by the radius.
+    auto offset = vector3_one * -client_settings.extrapolation_radius;
+    auto owned_islands = entt::sparse_set{};
+    auto scope_aabbs = std::vector<AABB>{};
+
+    for (auto entity : ctx.owned_entities) {
+        if (resident_view.contains(entity)) {
+            auto island_entity = resident_view.get<island_resident>(entity).island_entity;
+
+            if (island_aabb_view.contains(island_entity) && !owned_islands.contains(island_entity)) {
+                owned_islands.push(island_entity);
+                scope_aabbs.push_back(island_aabb_view.get<island_AABB>(island_entity).inset(offset));
+                continue;
+            }
+        }
+
+        if (aabb_view.contains(entity)) {
+            scope_aabbs.push_back(aabb_view.get<AABB>(entity).inset(offset));
+        }
+    }
+
+    auto in_scope = [&](const AABB &aabb) {
+        return std::any_of(scope_aabbs.begin(), scope_aabbs.end(),
+                           [&](const AABB &scope_aabb) { return intersect(aabb, scope_aabb); });
+    };
+
+    // Entities which can't be located are kept in the extrapolation.
+    auto is_in_scope = std::vector<bool>(snapshot.entities.size(), true);
+
+    for (size_t i = 0; i < snapshot.entities.size(); ++i) {
+        auto entity = snapshot.entities[i];
+
+        if (resident_view.contains(entity)) {
+            auto island_entity = resident_view.get<island_resident>(entity).island_entity;
+
+            if (owned_islands.contains(island_entity)) {
+                continue;
+            }
+
+            if (island_aabb_view.contains(island_entity)) {
+                is_in_scope[i] = in_scope(island_aabb_view.get<island_AABB>(island_entity));
+                continue;
+            }
+        }
+
+        if (aabb_view.contains(entity)) {
+            is_in_scope[i] = in_scope(aabb_view.get<AABB>(entity));
+        }
+    }
+
+    if (std::all_of(is_in_scope.begin(), is_in_scope.end(), [](bool b) { return b; })) {
+        return;
+    }
+
+    // Rebuild both snapshots with the pool entries of the entities in each.
+    using index_type = pool_snapshot_data::index_type;
+    auto inside = packet::registry_snapshot{};
+    inside.timestamp = outside.timestamp = snapshot.timestamp;
+    inside.id = outside.id = snapshot.id;
+    auto local_indices = std::vector<index_type>(snapshot.entities.size());
+
+    for (size_t i = 0; i < snapshot.entities.size(); ++i) {
+        auto &dest = is_in_scope[i] ? inside : outside;
+        local_indices[i] = static_cast<index_type>(dest.entities.size());
+        dest.entities.push_back(snapshot.entities[i]);
+    }
+
+    for (auto &src_pool : snapshot.pools) {
+        pool_snapshot *pools[2] = {nullptr, nullptr};
+        auto &entity_indices = src_pool.ptr->entity_indices;
+
+        for (size_t position = 0; position < entity_indices.size(); ++position) {
+            auto entity_index = entity_indices[position];
+            auto side = is_in_scope[entity_index] ? 0 : 1;
+            auto &pool = pools[side];
+
+            if (pool == nullptr) {
+                auto &dest = side == 0 ? inside : outside;
+                pool = &dest.pools.emplace_back();
+                pool->component_index = src_pool.component_index;
+                pool->ptr = (*g_make_pool_snapshot_data)(src_pool.component_index);
+            }
+
+            pool->ptr->append(*src_pool.ptr, position, local_indices[entity_index]);
+        }
+    }
+
+    snapshot = std::move(inside);
+}
+
+// Inserts the transforms of the procedural entities in a snapshot which are
+// not owned by this client into their interpolation buffers. Transforms which
+// are not in the snapshot didn't change since the last sample.
+static void insert_to_interpolation_buffers(entt::registry &registry,
+                                            const packet::registry_snapshot &snapshot,
+                                            double snapshot_time) {
+    auto &ctx = registry.ctx().get<client_network_context>();
+    auto transform_view = registry.view<position, orientation, procedural_tag>();
+    auto entity_positions = std::vector<const vector3 *>(snapshot.entities.size(), nullptr);
+    auto entity_orientations = std::vector<const quaternion *>(snapshot.entities.size(), nullptr);
+
+    for (auto &pool : snapshot.pools) {
+        if (pool.ptr->get_type_id() == entt::type_index<position>::value()) {
+            auto &typed_pool = static_cast<const pool_snapshot_data_impl<position> &>(*pool.ptr);
+
+            for (size_t i = 0; i < typed_pool.entity_indices.size(); ++i) {
+                entity_positions[typed_pool.entity_indices[i]] = &typed_pool.components[i];
+            }
+        } else if (pool.ptr->get_type_id() == entt::type_index<orientation>::value()) {
+            auto &typed_pool = static_cast<const pool_snapshot_data_impl<orientation> &>(*pool.ptr);
+
+            for (size_t i = 0; i < typed_pool.entity_indices.size(); ++i) {
+                entity_orientations[typed_pool.entity_indices[i]] = &typed_pool.components[i];
+            }
+        }
+    }
+
+    for (size_t i = 0; i < snapshot.entities.size(); ++i) {
+        auto entity = snapshot.entities[i];
+
+        if (!transform_view.contains(entity) || ctx.owned_entities.contains(entity)) {
+            continue;
+        }
+
+        auto &buffer = registry.get_or_emplace<interpolation_buffer>(entity);
+        auto [pos, orn] = transform_view.get<position, orientation>(entity);
+        auto sample_pos = static_cast<vector3>(pos);
+        auto sample_orn = static_cast<quaternion>(orn);
+
+        if (buffer.count > 0) {
+            auto &last = buffer.samples[buffer.count - 1];
+            sample_pos = last.position;
+            sample_orn = last.orientation;
+        }
+
+        if (entity_positions[i]) {
+            sample_pos = *entity_positions[i];
+        }
+
+        if (entity_orientations[i]) {
+            sample_orn = *entity_orientations[i];
+        }
+
+        buffer.insert(snapshot_time, sample_pos, sample_orn);
+    }
+}
+
+static void process_decoded_registry_snapshot(entt::registry &registry, packet::registry_snapshot &snapshot) {
+    auto &ctx = registry.ctx().get<client_network_context>();
+    auto &settings = registry.ctx().get<edyn::settings>();
+    auto &client_settings = std::get<client_network_settings>(settings.network_settings);
+
+    if (contains_unknown_entities(registry, snapshot.entities)) {
+        // Do not perform extrapolation if it contains unknown entities as the
+        // result would not make much sense if all parts are not involved.
+        // This should not happen very often.
+        if (client_settings.collect_network_stats) {
+            ++ctx.stats.packets_discarded;
+        }
+
+        return;
+    }
 
     // Translate transient snapshot into client's space so entities in the
     // snapshot will make sense in this registry. This same snapshot will
@@ -723,9 +1277,10 @@ static void process_packet(entt::registry &registry, packet::registry_snapshot &
         client_server_time_difference = ctx.clock_sync.time_delta;
         snapshot_time = snapshot.timestamp + ctx.clock_sync.time_delta - ctx.server_playout_delay;
     } else {
-        auto remote_time = snapshot.timestamp + client_settings.round_trip_time / 2;
+        auto rtt = clock_sync_round_trip_time(ctx.clock_sync, client_settings.round_trip_time);
+        auto remote_time = snapshot.timestamp + rtt / 2;
         client_server_time_difference = time - remote_time;
-        snapshot_time = time - (client_settings.round_trip_time / 2 + ctx.server_playout_delay);
+        snapshot_time = time - (rtt / 2 + ctx.server_playout_delay);
     }
 
     // Input from other clients must be always added to the state history.
@@ -742,11 +1297,37 @@ static void process_packet(entt::registry &registry, packet::registry_snapshot &
 
     // If extrapolation is not enabled or not needed, snap to this state and
     // add the differences to the discontinuity components.
+    if (!client_settings.extrapolation_enabled && client_settings.interpolate_unpredicted_entities) {
+        insert_to_interpolation_buffers(registry, snapshot, snapshot_time);
+    }
+
     if (!needs_extrapolation || !client_settings.extrapolation_enabled) {
         snap_to_registry_snapshot(registry, snapshot);
         return;
     }
 
+    // Only predict what happens around the entities owned by this client if
+    // requested. The state of the other entities is applied right away.
+    if (client_settings.extrapolate_owned_islands_only) {
+        auto outside = packet::registry_snapshot{};
+        split_registry_snapshot_by_extrapolation_scope(registry, snapshot, outside);
+
+        if (!outside.entities.empty()) {
+            if (client_settings.interpolate_unpredicted_entities) {
+                insert_to_interpolation_buffers(registry, outside, snapshot_time);
+            }
+
+            snap_to_registry_snapshot(registry, outside);
+        }
+
+        // Extrapolated entities are presented from the local simulation.
+        registry.remove<interpolation_buffer>(snapshot.entities.begin(), snapshot.entities.end());
+
+        if (snapshot.entities.empty()) {
+            return;
+        }
+    }
+
     // Create input to send to extrapolation job later. They're not dispatched
     // immediately because it's necessary to process the pending created
     // entities first. Otherwise, this message would be processed by the
@@ -754,12 +1335,13 @@ static void process_packet(entt::registry &registry, packet::registry_snapshot &
     // the entities involved in this extrapolation.
     auto &req = ctx.pending_extrapolations.emplace_back();
     req.start_time = snapshot_time;
+    req.execution_time_limit = client_settings.extrapolation_time_limit;
 
     if (settings.execution_mode == edyn::execution_mode::asynchronous) {
         // Send extrapolation result directly to simulation worker.
-        req.destination = {"worker"};
+        req.destination = registry.ctx().get<stepper_async>().worker_queue_id();
     } else {
-        req.destination = ctx.message_queue.identifier;
+        req.destination = ctx.message_queue.id;
     }
 
     req.snapshot = std::move(snapshot);
@@ -793,10 +1375,25 @@ static void process_packet(entt::registry &registry, const packet::server_settin
     settings.num_solver_position_iterations = server.num_solver_position_iterations;
     settings.num_restitution_iterations = server.num_restitution_iterations;
     settings.num_individual_restitution_iterations = server.num_individual_restitution_iterations;
+    settings.num_solver_substeps = server.num_solver_substeps;
+    settings.min_solver_velocity_iterations = server.min_solver_velocity_iterations;
+    settings.solver_velocity_tolerance = server.solver_velocity_tolerance;
+    settings.contact_block_solver = server.contact_block_solver;
+    settings.articulate_distance_chains = server.articulate_distance_chains;
+    settings.deterministic = server.deterministic;
+    settings.contact_reuse_linear_tolerance = server.contact_reuse_linear_tolerance;
+    settings.contact_reuse_angular_tolerance = server.contact_reuse_angular_tolerance;
+    settings.nbody_gravity = server.nbody_gravity;
+    settings.nbody_gravity_constant = server.nbody_gravity_constant;
+    settings.nbody_gravity_theta = server.nbody_gravity_theta;
+    settings.nbody_gravity_softening = server.nbody_gravity_softening;
 
     auto &ctx = registry.ctx().get<client_network_context>();
     ctx.allow_full_ownership = server.allow_full_ownership;
-    ctx.extrapolator->set_settings(settings);
+
+    for (auto &extrapolator : ctx.extrapolators) {
+        extrapolator->set_settings(settings);
+    }
 
     if (auto *stepper = registry.ctx().find<stepper_async>()) {
         stepper->settings_changed();
@@ -825,9 +1422,49 @@ static void process_packet(entt::registry &registry, packet::asset_sync_response
     ctx.snapshot_exporter->set_observer_enabled(true);
 }
 
+static void process_packet(entt::registry &registry, packet::island_slept &packet) {
+    // The resting state is applied as the state in a registry snapshot. It's
+    // not part of the sequence of delta-encoded snapshots thus it's never
+    // acknowledged.
+    process_decoded_registry_snapshot(registry, packet.snapshot);
+}
+
+static void process_packet(entt::registry &registry, const packet::island_woke &packet) {
+    auto &ctx = registry.ctx().get<client_network_context>();
+    auto entities = std::vector<entt::entity>{};
+
+    for (auto remote_entity : packet.entities) {
+        if (!ctx.entity_map.contains(remote_entity)) {
+            continue;
+        }
+
+        if (auto local_entity = ctx.entity_map.at(remote_entity); registry.valid(local_entity)) {
+            entities.push_back(local_entity);
+        }
+    }
+
+    if (!entities.empty()) {
+        wake_up_entities(registry, entities);
+    }
+}
+
 static void process_packet(entt::registry &, const packet::set_aabb_of_interest &) {}
 static void process_packet(entt::registry &, const packet::query_entity &) {}
 static void process_packet(entt::registry &, const packet::asset_sync &) {}
+static void process_packet(entt::registry &, const packet::snapshot_ack &) {}
+
+static void process_packet(entt::registry &registry, const packet::action_ack &ack) {
+    // Actions received by the server don't have to be sent anymore.
+    auto &ctx = registry.ctx().get<client_network_context>();
+    auto history_view = registry.view<action_history>();
+
+    for (auto entity : ctx.owned_entities) {
+        if (history_view.contains(entity)) {
+            auto [history] = history_view.get(entity);
+            history.erase_through(ack.timestamp);
+        }
+    }
+}
 
 void client_receive_packet(entt::registry &registry, packet::edyn_packet &packet) {
     std::visit([&](auto &&inner_packet) {
@@ -835,6 +1472,12 @@ void client_receive_packet(entt::registry &registry, packet::edyn_packet &packet
     }, packet.var);
 }
 
+bool client_receive_packet_batch(entt::registry &registry, const uint8_t *data, size_t size) {
+    return read_packet_batch(data, size, [&](packet::edyn_packet &packet) {
+        client_receive_packet(registry, packet);
+    });
+}
+
 bool client_owns_entity(const entt::registry &registry, entt::entity entity) {
     auto &ctx = registry.ctx().get<client_network_context>();
     return ctx.client_entity == registry.get<entity_owner>(entity).client_entity;
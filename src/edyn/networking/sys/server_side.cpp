@@ -1,14 +1,17 @@
 #include "edyn/networking/sys/server_side.hpp"
+#include "edyn/comp/child_list.hpp"
 #include "edyn/comp/graph_edge.hpp"
 #include "edyn/comp/graph_node.hpp"
 #include "edyn/comp/inertia.hpp"
 #include "edyn/comp/island.hpp"
+#include "edyn/comp/linvel.hpp"
 #include "edyn/comp/mass.hpp"
 #include "edyn/comp/position.hpp"
 #include "edyn/comp/orientation.hpp"
 #include "edyn/comp/tag.hpp"
 #include "edyn/constraints/constraint.hpp"
 #include "edyn/constraints/null_constraint.hpp"
+#include "edyn/context/task_util.hpp"
 #include "edyn/networking/comp/action_history.hpp"
 #include "edyn/networking/comp/asset_ref.hpp"
 #include "edyn/networking/comp/asset_entry.hpp"
@@ -18,21 +21,29 @@
 #include "edyn/networking/packet/entity_entered.hpp"
 #include "edyn/networking/packet/entity_exited.hpp"
 #include "edyn/networking/packet/entity_response.hpp"
+#include "edyn/networking/packet/island_sleep.hpp"
 #include "edyn/networking/packet/query_entity.hpp"
 #include "edyn/networking/packet/registry_snapshot.hpp"
 #include "edyn/networking/packet/update_entity_map.hpp"
 #include "edyn/networking/comp/remote_client.hpp"
 #include "edyn/networking/comp/aabb_of_interest.hpp"
+#include "edyn/networking/comp/aabb_oi_follow.hpp"
 #include "edyn/networking/comp/entity_owner.hpp"
 #include "edyn/networking/sys/update_aabbs_of_interest.hpp"
+#include "edyn/networking/sys/update_paged_meshes_of_interest.hpp"
 #include "edyn/networking/context/server_network_context.hpp"
+#include "edyn/networking/util/packet_batch.hpp"
 #include "edyn/networking/util/process_update_entity_map_packet.hpp"
 #include "edyn/networking/util/snap_to_pool_snapshot.hpp"
 #include "edyn/simulation/stepper_async.hpp"
 #include "edyn/parallel/message.hpp"
 #include "edyn/replication/entity_map.hpp"
+#include "edyn/serialization/entt_s11n.hpp"
+#include "edyn/time/time.hpp"
+#include "edyn/serialization/memory_archive.hpp"
 #include "edyn/util/island_util.hpp"
 #include "edyn/util/vector_util.hpp"
+#include "edyn/util/world_capture.hpp"
 #include "edyn/util/aabb_util.hpp"
 #include "edyn/time/simulation_time.hpp"
 #include <entt/entity/registry.hpp>
@@ -281,14 +292,57 @@ static void process_packet(entt::registry &, entt::entity, const packet::entity_
 static void process_packet(entt::registry &, entt::entity, const packet::entity_exited &) {}
 static void process_packet(entt::registry &, entt::entity, const packet::asset_sync_response &) {}
 
+static void process_packet(entt::registry &, entt::entity, const packet::action_ack &) {}
+static void process_packet(entt::registry &, entt::entity, const packet::island_slept &) {}
+static void process_packet(entt::registry &, entt::entity, const packet::island_woke &) {}
+
+static void process_packet(entt::registry &registry, entt::entity client_entity, const packet::snapshot_ack &ack) {
+    auto &client = registry.get<remote_client>(client_entity);
+
+    for (auto id : ack.ids) {
+        client.sent_snapshots.acknowledge(id);
+    }
+}
+
+static void batch_packet(entt::registry &registry, entt::entity client_entity, const packet::edyn_packet &packet) {
+    auto &settings = registry.ctx().get<edyn::settings>();
+    auto &server_settings = std::get<server_network_settings>(settings.network_settings);
+
+    if (!server_settings.batch_packets) {
+        return;
+    }
+
+    if (auto *client = registry.try_get<remote_client>(client_entity)) {
+        client->outbound_packets.insert(packet);
+    }
+}
+
+static void on_construct_sleeping_tag(entt::registry &registry, entt::entity entity) {
+    if (registry.all_of<networked_tag, island_resident>(entity)) {
+        registry.ctx().get<server_network_context>().slept_entities.push_back(entity);
+    }
+}
+
+static void on_destroy_sleeping_tag(entt::registry &registry, entt::entity entity) {
+    if (registry.all_of<networked_tag, island_resident>(entity)) {
+        registry.ctx().get<server_network_context>().woken_entities.push_back(entity);
+    }
+}
+
 void init_network_server(entt::registry &registry) {
-    registry.ctx().emplace<server_network_context>(registry);
+    auto &ctx = registry.ctx().emplace<server_network_context>(registry);
+    ctx.packet_sink().connect<&batch_packet>(registry);
+
+    registry.on_construct<sleeping_tag>().connect<&on_construct_sleeping_tag>();
+    registry.on_destroy<sleeping_tag>().connect<&on_destroy_sleeping_tag>();
 
     auto &settings = registry.ctx().get<edyn::settings>();
     settings.network_settings = server_network_settings{};
 }
 
 void deinit_network_server(entt::registry &registry) {
+    registry.on_construct<sleeping_tag>().disconnect<&on_construct_sleeping_tag>();
+    registry.on_destroy<sleeping_tag>().disconnect<&on_destroy_sleeping_tag>();
     registry.ctx().erase<server_network_context>();
 
     auto &settings = registry.ctx().get<edyn::settings>();
@@ -297,19 +351,15 @@ void deinit_network_server(entt::registry &registry) {
 
 static void server_process_timed_packets(entt::registry &registry, double time) {
     registry.view<remote_client>().each([&](entt::entity client_entity, remote_client &client) {
-        auto it = client.packet_queue.begin();
-
-        for (; it != client.packet_queue.end(); ++it) {
-            if (it->timestamp > time - client.playout_delay) {
-                break;
-            }
+        while (!client.packet_queue.empty() &&
+               client.packet_queue.front().timestamp <= time - client.playout_delay) {
+            auto entry = std::move(client.packet_queue.front());
+            client.packet_queue.pop_front();
 
             std::visit([&](auto &&packet) {
                 process_packet(registry, client_entity, packet);
-            }, it->packet.var);
+            }, entry.packet.var);
         }
-
-        client.packet_queue.erase(client.packet_queue.begin(), it);
     });
 }
 
@@ -351,6 +401,12 @@ static void process_aabb_of_interest_entities_exited(entt::registry &registry,
 
     const auto entry_view = registry.view<asset_entry>();
     for (auto entity : aabboi.entities_exited) {
+        // Entities which haven't been sent yet are forgotten silently.
+        if (client.pending_entities_entered.contains(entity)) {
+            client.pending_entities_entered.remove(entity);
+            continue;
+        }
+
         if (entry_view.contains(entity)) {
             auto [entry] = entry_view.get(entity);
 
@@ -381,18 +437,142 @@ static void process_aabb_of_interest_entities_exited(entt::registry &registry,
     aabboi.entities_exited.clear();
 }
 
+// Point around which entities are sorted by distance for a client, which is
+// the entity followed by its AABB of interest or the center of the AABB.
+static vector3 get_point_of_interest(const entt::registry &registry, entt::entity client_entity,
+                                     const aabb_of_interest &aabboi) {
+    auto position_view = registry.view<position>();
+
+    if (auto *follow = registry.try_get<aabb_oi_follow>(client_entity);
+        follow && position_view.contains(follow->entity)) {
+        return std::get<0>(position_view.get(follow->entity));
+    }
+
+    return aabboi.aabb.center();
+}
+
+// Entity which holds the location of a networked entity. Edges take the
+// location of their first node.
+static entt::entity get_location_entity(const entt::registry &registry, entt::entity entity) {
+    if (auto *edge = registry.try_get<graph_edge>(entity)) {
+        auto &graph = registry.ctx().get<entity_graph>();
+        return graph.node_entity(graph.edge_node_indices(edge->edge_index)[0]);
+    }
+
+    return entity;
+}
+
+// Takes the entities that are going to be announced to the client in this
+// update from the entities that entered its AABB of interest and haven't been
+// sent yet. If the number is limited, the nearest are taken first and assets
+// are taken as a whole and count as one.
+static std::vector<entt::entity> take_entities_entered(entt::registry &registry,
+                                                       entt::entity client_entity,
+                                                       remote_client &client,
+                                                       const aabb_of_interest &aabboi) {
+    auto &settings = registry.ctx().get<edyn::settings>();
+    auto &server_settings = std::get<server_network_settings>(settings.network_settings);
+    auto max_entered = server_settings.max_entities_entered_per_update;
+    auto &pending = client.pending_entities_entered;
+    auto result = std::vector<entt::entity>{};
+
+    if (max_entered == 0 || pending.size() <= max_entered) {
+        for (auto entity : pending) {
+            if (registry.valid(entity)) {
+                result.push_back(entity);
+            }
+        }
+
+        pending.clear();
+        return result;
+    }
+
+    const auto origin = get_point_of_interest(registry, client_entity, aabboi);
+    const auto position_view = registry.view<position>();
+    const auto entry_view = registry.view<asset_entry>();
+    auto sorted = std::vector<std::pair<scalar, entt::entity>>{};
+
+    for (auto entity : pending) {
+        if (!registry.valid(entity)) {
+            continue;
+        }
+
+        auto location_entity = get_location_entity(registry, entity);
+        auto distance = position_view.contains(location_entity) ?
+            distance_sqr(std::get<0>(position_view.get(location_entity)), origin) : scalar(0);
+        sorted.emplace_back(distance, entity);
+    }
+
+    std::sort(sorted.begin(), sorted.end(), [](auto &&lhs, auto &&rhs) {
+        return lhs.first < rhs.first;
+    });
+
+    entt::sparse_set assets;
+    size_t count = 0;
+
+    for (auto [distance, entity] : sorted) {
+        if (entry_view.contains(entity)) {
+            // Include the remaining entities of assets being sent regardless
+            // of the limit.
+            auto [entry] = entry_view.get(entity);
+
+            if (!assets.contains(entry.asset_entity)) {
+                if (count == max_entered) {
+                    continue;
+                }
+
+                assets.push(entry.asset_entity);
+                ++count;
+            }
+        } else if (count == max_entered) {
+            continue;
+        } else {
+            ++count;
+        }
+
+        result.push_back(entity);
+    }
+
+    // Invalid entities are discarded as well.
+    pending.clear();
+
+    for (auto [distance, entity] : sorted) {
+        pending.push(entity);
+    }
+
+    for (auto entity : result) {
+        pending.remove(entity);
+    }
+
+    return result;
+}
+
 static void process_aabb_of_interest_entities_entered(entt::registry &registry,
                                                       entt::entity client_entity,
+                                                      remote_client &client,
                                                       aabb_of_interest &aabboi) {
-    if (aabboi.entities_entered.empty()) {
+    auto &pending = client.pending_entities_entered;
+
+    for (auto entity : aabboi.entities_entered) {
+        if (!pending.contains(entity)) {
+            pending.push(entity);
+        }
+    }
+
+    // Do not forget to clear it after processing.
+    aabboi.entities_entered.clear();
+
+    if (pending.empty()) {
         return;
     }
 
+    auto entities_entered = take_entities_entered(registry, client_entity, client, aabboi);
+
     const auto entry_view = registry.view<asset_entry>();
     entt::sparse_set assets;
     entt::sparse_set entities;
 
-    for (auto entity : aabboi.entities_entered) {
+    for (auto entity : entities_entered) {
         if (entry_view.contains(entity)) {
             auto [entry] = entry_view.get(entity);
 
@@ -447,29 +627,227 @@ static void process_aabb_of_interest_entities_entered(entt::registry &registry,
 
         ctx.packet_signal.publish(client_entity, packet::edyn_packet{std::move(packet)});
     }
+}
 
-    // Do not forget to clear it after processing.
-    aabboi.entities_entered.clear();
+// Rate at which an entity is sent to a client according to its distance to
+// the client's point of interest.
+static double get_tier_snapshot_rate(const server_network_settings &settings,
+                                     const remote_client &client, scalar distance) {
+    auto rate = client.snapshot_rate;
+
+    for (auto &tier : settings.snapshot_rate_tiers) {
+        rate = tier.rate;
+
+        if (distance <= tier.max_distance) {
+            break;
+        }
+    }
+
+    return std::min(rate, client.snapshot_rate);
 }
 
-static void maybe_publish_client_registry_snapshot(entt::registry &registry,
-                                                   entt::entity client_entity,
-                                                   remote_client &client,
-                                                   aabb_of_interest &aabboi,
-                                                   double time) {
-    if (time - client.last_snapshot_time < 1 / client.snapshot_rate) {
-        return;
+static void update_entity_export_states(entt::registry &registry, entt::entity client_entity,
+                                        remote_client &client, const aabb_of_interest &aabboi,
+                                        double time, double elapsed) {
+    auto &settings = registry.ctx().get<edyn::settings>();
+    auto &server_settings = std::get<server_network_settings>(settings.network_settings);
+    auto position_view = registry.view<position>();
+    auto linvel_view = registry.view<linvel>();
+
+    // Forget entities which are no longer of interest.
+    for (auto it = client.entity_states.begin(); it != client.entity_states.end();) {
+        if (aabboi.entities.contains(it->first)) {
+            ++it;
+        } else {
+            it = client.entity_states.erase(it);
+        }
+    }
+
+    // Priority is given to the entities near the entities owned by the client.
+    auto points_of_interest = std::vector<vector3>{};
+
+    for (auto entity : client.owned_entities) {
+        if (position_view.contains(entity)) {
+            points_of_interest.push_back(std::get<0>(position_view.get(entity)));
+        }
     }
 
-    client.last_snapshot_time = time;
+    if (points_of_interest.empty()) {
+        points_of_interest.push_back(aabboi.aabb.center());
+    }
+
+    // Rate tiers are based on the distance to the entity followed by the
+    // AABB of interest.
+    auto tier_origin = get_point_of_interest(registry, client_entity, aabboi);
+
+    // Allow entities to be sent slightly ahead of time so they aren't
+    // delayed by one snapshot due to jitter in the snapshot times.
+    const auto tolerance = 0.5 / client.snapshot_rate;
+
+    for (auto entity : aabboi.entities) {
+        // Edges take the location and velocity of their first node.
+        auto target_entity = get_location_entity(registry, entity);
+
+        auto distance = scalar(0);
+        auto tier_distance = scalar(0);
+
+        if (position_view.contains(target_entity)) {
+            auto [pos] = position_view.get(target_entity);
+            distance = EDYN_SCALAR_MAX;
+
+            for (auto &point : points_of_interest) {
+                distance = std::min(edyn::distance(pos, point), distance);
+            }
+
+            tier_distance = edyn::distance(pos, tier_origin);
+        }
+
+        auto speed = linvel_view.contains(target_entity) ?
+            length(std::get<0>(linvel_view.get(target_entity))) : scalar(0);
+        auto priority_rate = (1 + speed * server_settings.priority_speed_factor) /
+                             (1 + distance * server_settings.priority_distance_factor);
+
+        auto &state = client.entity_states[entity];
+        state.priority += priority_rate * static_cast<scalar>(elapsed);
+
+        if (server_settings.snapshot_rate_func != nullptr) {
+            state.rate = std::min((*server_settings.snapshot_rate_func)(registry, client_entity, entity),
+                                  client.snapshot_rate);
+        } else {
+            state.rate = get_tier_snapshot_rate(server_settings, client, tier_distance);
+        }
+
+        // Entities the client doesn't know about yet must not be sent.
+        state.due = state.rate > 0 && time + tolerance >= state.next_export_time &&
+                    !client.pending_entities_entered.contains(entity);
+    }
+}
+
+static size_t get_serialized_size(packet::registry_snapshot &snapshot) {
+    auto buffer = std::vector<uint8_t>{};
+    auto archive = memory_output_archive(buffer);
+    archive(snapshot);
+    return buffer.size();
+}
+
+// Exports the snapshot of a client into the packets that will be sent to it.
+// It only reads from the registry and modifies the state of the client, thus
+// it can run for multiple clients in parallel.
+static void export_client_registry_snapshot(entt::registry &registry,
+                                            entt::entity client_entity,
+                                            remote_client &client,
+                                            const aabb_of_interest &aabboi,
+                                            double time, double timestamp,
+                                            std::vector<packet::registry_snapshot> &result,
+                                            network_stats &stats) {
+    auto &settings = registry.ctx().get<edyn::settings>();
+    auto &server_settings = std::get<server_network_settings>(settings.network_settings);
+    const auto collect_stats = server_settings.collect_network_stats;
+    const auto start_time = collect_stats ? performance_time() : 0;
 
     auto &ctx = registry.ctx().get<server_network_context>();
     auto packet = packet::registry_snapshot{};
     ctx.snapshot_exporter->export_modified(packet, aabboi.entities, client_entity);
 
-    if (!packet.entities.empty() && !packet.pools.empty()) {
-        packet.timestamp = get_simulation_timestamp(registry);
-        ctx.packet_signal.publish(client_entity, packet::edyn_packet{packet});
+    if (packet.entities.empty() || packet.pools.empty()) {
+        return;
+    }
+
+    packet.timestamp = timestamp;
+
+    auto packets = std::vector<packet::registry_snapshot>{};
+
+    if (server_settings.max_snapshot_packet_size > 0) {
+        ctx.snapshot_exporter->split(packet, server_settings.max_snapshot_packet_size, packets);
+    } else {
+        packets.push_back(std::move(packet));
+    }
+
+    if (server_settings.snapshot_delta_encoding && client.next_snapshot_id > snapshot_baseline::max_age) {
+        client.sent_snapshots.erase_until(client.next_snapshot_id - snapshot_baseline::max_age);
+    }
+
+    // Share of the bandwidth available for this snapshot. Packets contain the
+    // entities in order of priority. Once the budget is exhausted, the
+    // remaining entities keep accumulating priority and are sent later.
+    const auto budget = client.max_snapshot_bandwidth / client.snapshot_rate;
+    auto bytes_sent = size_t{0};
+
+    // The priority of the entities which are sent is reset and they're not
+    // sent again until their rate allows.
+    auto mark_sent = [&client, time](const std::vector<entt::entity> &entities) {
+        for (auto entity : entities) {
+            if (auto it = client.entity_states.find(entity); it != client.entity_states.end()) {
+                it->second.priority = 0;
+                it->second.next_export_time = time + 1 / it->second.rate;
+            }
+        }
+    };
+
+    for (size_t packet_index = 0; packet_index < packets.size(); ++packet_index) {
+        auto &split_packet = packets[packet_index];
+        // Encoding removes unchanged components and leaves the full value in
+        // the others, which is what's recorded. The entities which are
+        // removed are up to date in the client thus they're marked as sent
+        // as well.
+        auto entities = split_packet.entities;
+
+        if (server_settings.snapshot_delta_encoding) {
+            split_packet.id = client.next_snapshot_id++;
+            client.sent_snapshots.encode(split_packet);
+
+            if (split_packet.pools.empty()) {
+                mark_sent(entities);
+                continue;
+            }
+        }
+
+        if (budget > 0) {
+            auto size = get_serialized_size(split_packet);
+
+            // Always send at least one packet.
+            if (bytes_sent > 0 && bytes_sent + size > budget) {
+                if (collect_stats) {
+                    for (auto i = packet_index; i < packets.size(); ++i) {
+                        stats.entities_deferred += packets[i].entities.size();
+                    }
+                }
+
+                break;
+            }
+
+            bytes_sent += size;
+        }
+
+        if (server_settings.snapshot_delta_encoding) {
+            client.sent_snapshots.insert(split_packet);
+        }
+
+        if (collect_stats) {
+            stats.record_sent(split_packet);
+        }
+
+        mark_sent(entities);
+        result.push_back(std::move(split_packet));
+    }
+
+    if (collect_stats) {
+        ++stats.snapshots_sent;
+        stats.export_time += performance_time() - start_time;
+    }
+}
+
+// Updates the round-trip time used in playout delay calculations and flags
+// the playout delays for recalculation if it changed significantly.
+static void update_client_playout_round_trip_time(server_network_context &ctx, remote_client &client) {
+    auto &clock_sync = client.clock_sync;
+    auto rtt = clock_sync.sample_count > 0 ?
+        clock_sync.round_trip_time + clock_sync.round_trip_time_deviation * 2 :
+        client.round_trip_time;
+
+    if (std::abs(rtt - client.playout_round_trip_time) > client.playout_round_trip_time * 0.05) {
+        client.playout_round_trip_time = rtt;
+        ctx.playout_delays_dirty = true;
     }
 }
 
@@ -479,7 +857,7 @@ static void calculate_client_playout_delay(entt::registry &registry,
                                            aabb_of_interest &aabboi) {
     auto owner_view = registry.view<entity_owner>();
     auto client_view = registry.view<remote_client>();
-    auto biggest_rtt = client.round_trip_time;
+    auto biggest_rtt = client.playout_round_trip_time;
 
     for (auto entity : aabboi.entities) {
         if (!owner_view.contains(entity)) {
@@ -488,7 +866,7 @@ static void calculate_client_playout_delay(entt::registry &registry,
 
         auto [owner] = owner_view.get(entity);
         auto [other_client] = client_view.get(owner.client_entity);
-        biggest_rtt = std::max(other_client.round_trip_time, biggest_rtt);
+        biggest_rtt = std::max(other_client.playout_round_trip_time, biggest_rtt);
     }
 
     auto &settings = registry.ctx().get<edyn::settings>();
@@ -503,17 +881,176 @@ static void calculate_client_playout_delay(entt::registry &registry,
 
         auto packet = edyn::packet::set_playout_delay{playout_delay};
         auto &ctx = registry.ctx().get<server_network_context>();
+        ctx.action_execution_times_dirty = true;
         ctx.packet_signal.publish(client_entity, edyn::packet::edyn_packet{packet});
     }
 }
 
+static void decrement_interest_count(server_network_context &ctx, entt::entity entity) {
+    auto it = ctx.interest_counts.find(entity);
+
+    if (it != ctx.interest_counts.end() && --it->second == 0) {
+        ctx.interest_counts.erase(it);
+    }
+}
+
+static void update_interest_counts(server_network_context &ctx, const aabb_of_interest &aabboi) {
+    for (auto entity : aabboi.entities_entered) {
+        ++ctx.interest_counts[entity];
+    }
+
+    for (auto entity : aabboi.entities_exited) {
+        decrement_interest_count(ctx, entity);
+    }
+}
+
+// Tags the rigid bodies which are not in any AABB of interest as low fidelity
+// and removes the tag from the ones that are.
+static void update_low_fidelity_tags(entt::registry &registry) {
+    auto &settings = registry.ctx().get<edyn::settings>();
+    auto &server_settings = std::get<server_network_settings>(settings.network_settings);
+    auto &ctx = registry.ctx().get<server_network_context>();
+    auto &low_fidelity_storage = registry.storage<low_fidelity_tag>();
+
+    if (!server_settings.low_fidelity_outside_interest) {
+        low_fidelity_storage.clear();
+        return;
+    }
+
+    for (auto [entity, count] : ctx.interest_counts) {
+        if (low_fidelity_storage.contains(entity)) {
+            low_fidelity_storage.remove(entity);
+        }
+    }
+
+    auto body_view = registry.view<rigidbody_tag, procedural_tag>(entt::exclude<low_fidelity_tag>);
+
+    for (auto entity : body_view) {
+        if (!ctx.interest_counts.count(entity)) {
+            registry.emplace<low_fidelity_tag>(entity);
+        }
+    }
+}
+
+static void prefetch_paged_meshes_of_interest(entt::registry &registry) {
+    auto &settings = registry.ctx().get<edyn::settings>();
+    auto &server_settings = std::get<server_network_settings>(settings.network_settings);
+    auto &ctx = registry.ctx().get<server_network_context>();
+
+    if (!server_settings.prefetch_paged_meshes_of_interest) {
+        if (!ctx.pinned_pages_of_interest.pages.empty()) {
+            ctx.pinned_pages_of_interest.assign({});
+        }
+        return;
+    }
+
+    update_paged_meshes_of_interest(registry, ctx.pinned_pages_of_interest,
+                                    server_settings.paged_mesh_of_interest_lookahead);
+}
+
 static void process_aabbs_of_interest(entt::registry &registry, double time) {
-    for (auto [client_entity, client, aabboi] : registry.view<remote_client, aabb_of_interest>().each()) {
+    auto &ctx = registry.ctx().get<server_network_context>();
+    auto client_view = registry.view<remote_client, aabb_of_interest>();
+    auto &snapshot_clients = ctx.snapshot_clients;
+    snapshot_clients.clear();
+
+    for (auto [client_entity, client, aabboi] : client_view.each()) {
+        if (!aabboi.entities_entered.empty() || !aabboi.entities_exited.empty()) {
+            client.playout_delay_dirty = true;
+        }
+
+        update_interest_counts(ctx, aabboi);
         process_aabb_of_interest_entities_exited(registry, client_entity, aabboi);
-        process_aabb_of_interest_entities_entered(registry, client_entity, aabboi);
-        maybe_publish_client_registry_snapshot(registry, client_entity, client, aabboi, time);
-        calculate_client_playout_delay(registry, client_entity, client, aabboi);
+        process_aabb_of_interest_entities_entered(registry, client_entity, client, aabboi);
+
+        if (time - client.last_snapshot_time >= 1 / client.snapshot_rate) {
+            update_entity_export_states(registry, client_entity, client, aabboi,
+                                        time, time - client.last_snapshot_time);
+            client.last_snapshot_time = time;
+            snapshot_clients.push_back(client_entity);
+        }
     }
+
+    // Export the snapshots of all clients in parallel, each into its own
+    // buffer, and publish them afterwards in this thread in client order.
+    auto &snapshot_packets = ctx.snapshot_packets;
+    snapshot_packets.resize(std::max(snapshot_packets.size(), snapshot_clients.size()));
+    auto &snapshot_stats = ctx.snapshot_stats;
+    snapshot_stats.resize(snapshot_packets.size());
+    auto timestamp = get_simulation_timestamp(registry);
+
+    auto export_range = [&](const entt::entity *first, const entt::entity *last, unsigned start) {
+        for (auto index = start; first != last; ++first, ++index) {
+            auto [client, aabboi] = client_view.get(*first);
+            export_client_registry_snapshot(registry, *first, client, aabboi,
+                                            time, timestamp, snapshot_packets[index],
+                                            snapshot_stats[index]);
+        }
+    };
+
+    // Components seen by multiple clients are copied from the registry once
+    // into a cache shared by all exports.
+    if (snapshot_clients.size() > 1) {
+        auto &cache_entities = ctx.snapshot_cache_entities;
+        cache_entities.clear();
+
+        for (auto client_entity : snapshot_clients) {
+            auto &aabboi = client_view.get<aabb_of_interest>(client_entity);
+
+            for (auto entity : aabboi.entities) {
+                if (!cache_entities.contains(entity)) {
+                    cache_entities.push(entity);
+                }
+            }
+        }
+
+        ctx.snapshot_exporter->cache_modified(cache_entities);
+    }
+
+    auto &settings = registry.ctx().get<edyn::settings>();
+    auto mt = settings.execution_mode != execution_mode::sequential;
+
+    if (mt && snapshot_clients.size() > 1) {
+        // Views are created in the tasks, which could create storage for
+        // components that were never assigned. That is not thread-safe, so
+        // ensure they exist beforehand.
+        registry.storage<entity_owner>();
+        registry.storage<parent_comp>();
+        registry.storage<child_list>();
+        parallel_for_each_range(registry, snapshot_clients, export_range);
+    } else if (!snapshot_clients.empty()) {
+        export_range(snapshot_clients.data(), snapshot_clients.data() + snapshot_clients.size(), 0);
+    }
+
+    for (size_t i = 0; i < snapshot_clients.size(); ++i) {
+        auto &client = client_view.get<remote_client>(snapshot_clients[i]);
+
+        client.stats.merge(snapshot_stats[i]);
+        ctx.stats.merge(snapshot_stats[i]);
+        snapshot_stats[i].reset();
+
+        for (auto &packet : snapshot_packets[i]) {
+            packet.clock = clock_sync_make_sample(client.clock_sync, time);
+            ctx.packet_signal.publish(snapshot_clients[i], packet::edyn_packet{std::move(packet)});
+        }
+
+        snapshot_packets[i].clear();
+    }
+
+    ctx.snapshot_exporter->clear_cache();
+
+    // Only recalculate playout delays when the round-trip time of some client
+    // changed or when the entities of interest of a client changed.
+    for (auto [client_entity, client, aabboi] : client_view.each()) {
+        if (ctx.playout_delays_dirty || client.playout_delay_dirty) {
+            calculate_client_playout_delay(registry, client_entity, client, aabboi);
+            client.playout_delay_dirty = false;
+        }
+    }
+
+    ctx.playout_delays_dirty = false;
+
+    update_low_fidelity_tags(registry);
 }
 
 static void server_update_clock_sync(entt::registry &registry, double time) {
@@ -524,63 +1061,185 @@ static void server_update_clock_sync(entt::registry &registry, double time) {
 
 static void dispatch_actions(entt::registry &registry, double time) {
     auto &ctx = registry.ctx().get<server_network_context>();
+    auto &queue = ctx.pending_actions;
     auto client_view = registry.view<remote_client>();
+    auto history_view = registry.view<action_history>();
 
-    // Consume actions with a timestamp that's before the current execution time.
-    for (auto [entity, history, owner] : registry.view<action_history, entity_owner>().each()) {
-        if (history.entries.empty()) {
+    if (ctx.action_execution_times_dirty) {
+        queue.update_execution_times([&](const queued_action &action) {
+            if (!client_view.contains(action.client_entity)) {
+                return action.execution_time;
+            }
+
+            auto [client] = client_view.get(action.client_entity);
+            return action.timestamp + client.playout_delay;
+        });
+        ctx.action_execution_times_dirty = false;
+    }
+
+    // Consume actions whose execution time is before the current time. The
+    // actions of an entity are due in order, thus each is at the front of its
+    // history once the previous ones are erased.
+    while (!queue.empty() && queue.top().execution_time <= time) {
+        auto action = queue.top();
+        queue.pop();
+
+        if (!history_view.contains(action.entity)) {
             continue;
         }
 
-        auto [client] = client_view.get(owner.client_entity);
-        auto it = history.entries.begin();
-        auto last_timestamp = client.last_executed_history_entry_timestamp;
+        auto [history] = history_view.get(action.entity);
+        auto it = history.find(action.timestamp);
 
-        for (; it != history.entries.end(); ++it) {
-            if (it->timestamp <= client.last_executed_history_entry_timestamp) {
-                // Action has already been processed.
-                continue;
-            }
+        if (it == history.entries.end()) {
+            continue;
+        }
 
-            if (it->timestamp > time - client.playout_delay) {
-                // This action and all that follow should be processed later.
-                break;
+        ctx.snapshot_importer->import_action(registry, action.entity, it->action_index,
+                                             history.entry_data(*it), it->size);
+
+        // Delete all actions up to the one that was executed.
+        history.erase_through(action.timestamp);
+
+        if (client_view.contains(action.client_entity)) {
+            auto [client] = client_view.get(action.client_entity);
+            client.last_executed_history_entry_timestamp =
+                std::max(client.last_executed_history_entry_timestamp, action.timestamp);
+        }
+    }
+}
+
+void update_server_snapshot_exporter(entt::registry &registry, double time) {
+    auto &ctx = registry.ctx().get<server_network_context>();
+    auto &settings = registry.ctx().get<edyn::settings>();
+    auto &server_settings = std::get<server_network_settings>(settings.network_settings);
+    ctx.snapshot_exporter->set_exclude_sleeping(server_settings.island_sleep_replication);
+    ctx.snapshot_exporter->update(time);
+}
+
+// Sorts the entities by island and removes duplicates and the entities which
+// are not in the expected state anymore, e.g. woken up right after they fell
+// asleep.
+static void group_by_island(entt::registry &registry, std::vector<entt::entity> &entities, bool sleeping) {
+    auto resident_view = registry.view<island_resident>();
+    auto sleeping_view = registry.view<sleeping_tag>();
+
+    entities.erase(std::remove_if(entities.begin(), entities.end(), [&](entt::entity entity) {
+        return !registry.valid(entity) || !resident_view.contains(entity) ||
+               sleeping_view.contains(entity) != sleeping;
+    }), entities.end());
+
+    std::sort(entities.begin(), entities.end(), [&](entt::entity lhs, entt::entity rhs) {
+        auto island_lhs = resident_view.get<island_resident>(lhs).island_entity;
+        auto island_rhs = resident_view.get<island_resident>(rhs).island_entity;
+        return island_lhs < island_rhs || (island_lhs == island_rhs && lhs < rhs);
+    });
+
+    entities.erase(std::unique(entities.begin(), entities.end()), entities.end());
+}
+
+// Tells each client once about the islands of interest to it which fell
+// asleep or woke up, instead of having the transforms of their residents sent
+// in registry snapshots while they are still considered modified. Each island
+// goes in a packet of its own, which has the residents the client knows about
+// and doesn't own.
+static void publish_island_sleep_changes(entt::registry &registry) {
+    auto &ctx = registry.ctx().get<server_network_context>();
+    auto &settings = registry.ctx().get<edyn::settings>();
+    auto &server_settings = std::get<server_network_settings>(settings.network_settings);
+
+    if (!server_settings.island_sleep_replication ||
+        (ctx.slept_entities.empty() && ctx.woken_entities.empty())) {
+        ctx.slept_entities.clear();
+        ctx.woken_entities.clear();
+        return;
+    }
+
+    group_by_island(registry, ctx.slept_entities, true);
+    group_by_island(registry, ctx.woken_entities, false);
+
+    auto resident_view = registry.view<island_resident>();
+    auto owner_view = registry.view<entity_owner>();
+    auto timestamp = get_simulation_timestamp(registry);
+    auto island_entities = std::vector<entt::entity>{};
+
+    // Calls `func` with the residents of each island which can be sent to
+    // the client.
+    auto for_each_island = [&](const std::vector<entt::entity> &entities, entt::entity client_entity,
+                               const remote_client &client, const aabb_of_interest &aabboi, auto func) {
+        for (auto first = entities.begin(); first != entities.end();) {
+            auto island_entity = resident_view.get<island_resident>(*first).island_entity;
+            island_entities.clear();
+
+            for (; first != entities.end() &&
+                 resident_view.get<island_resident>(*first).island_entity == island_entity; ++first) {
+                auto entity = *first;
+
+                if (!aabboi.entities.contains(entity) || client.pending_entities_entered.contains(entity) ||
+                    (owner_view.contains(entity) &&
+                     owner_view.get<entity_owner>(entity).client_entity == client_entity)) {
+                    continue;
+                }
+
+                island_entities.push_back(entity);
             }
 
-            ctx.snapshot_importer->import_action(registry, entity, it->action_index, it->data);
-            last_timestamp = it->timestamp;
+            if (!island_entities.empty()) {
+                func(island_entities);
+            }
         }
+    };
+
+    for (auto [client_entity, client, aabboi] : registry.view<remote_client, aabb_of_interest>().each()) {
+        for_each_island(ctx.slept_entities, client_entity, client, aabboi, [&, client_entity = client_entity](auto &entities) {
+            auto slept = packet::island_slept{};
+            slept.snapshot.timestamp = timestamp;
+            ctx.snapshot_exporter->export_rest_state(slept.snapshot, entities);
 
-        client.last_executed_history_entry_timestamp = last_timestamp;
+            if (!slept.snapshot.pools.empty()) {
+                ctx.packet_signal.publish(client_entity, packet::edyn_packet{std::move(slept)});
+            }
+        });
 
-        // Delete all actions up to the last one that was executed.
-        history.entries.erase(history.entries.begin(), it);
+        for_each_island(ctx.woken_entities, client_entity, client, aabboi, [&, client_entity = client_entity](auto &entities) {
+            ctx.packet_signal.publish(client_entity, packet::edyn_packet{packet::island_woke{entities}});
+        });
     }
+
+    ctx.slept_entities.clear();
+    ctx.woken_entities.clear();
 }
 
-void update_server_snapshot_exporter(entt::registry &registry, double time) {
+static void publish_packet_batches(entt::registry &registry) {
     auto &ctx = registry.ctx().get<server_network_context>();
-    ctx.snapshot_exporter->update(time);
+
+    for (auto [client_entity, client] : registry.view<remote_client>().each()) {
+        client.outbound_packets.flush([&, client_entity = client_entity](const uint8_t *data, size_t size, bool reliable) {
+            ctx.packet_batch_signal.publish(client_entity, data, size, reliable);
+        });
+    }
 }
 
 void update_network_server(entt::registry &registry) {
     auto &settings = registry.ctx().get<edyn::settings>();
     const auto time = (*settings.time_func)();
+    internal::capture_call(registry, internal::capture_record_type::network_update, time);
     server_update_clock_sync(registry, time);
     server_process_timed_packets(registry, time);
     update_server_snapshot_exporter(registry, time);
     update_aabbs_of_interest(registry);
+    prefetch_paged_meshes_of_interest(registry);
+    publish_island_sleep_changes(registry);
     process_aabbs_of_interest(registry, time);
     publish_pending_created_clients(registry);
     dispatch_actions(registry, time);
+    publish_packet_batches(registry);
+    internal::capture_resume(registry);
 }
 
 template<typename T>
 void insert_packet_to_queue(remote_client &client, double timestamp, T &&packet) {
-    // Sorted insertion.
-    auto insert_it = std::find_if(client.packet_queue.begin(), client.packet_queue.end(),
-                                  [timestamp](auto &&p) { return p.timestamp > timestamp; });
-    client.packet_queue.insert(insert_it, timed_packet{timestamp, packet::edyn_packet{std::move(packet)}});
+    client.packet_queue.push(timestamp, packet::edyn_packet{std::move(packet)});
 }
 
 template<typename T>
@@ -591,7 +1250,7 @@ void enqueue_packet(entt::registry &registry, entt::entity client_entity, T &pac
     if (client.clock_sync.count > 0) {
         packet_timestamp = std::min(packet.timestamp + client.clock_sync.time_delta, time);
     } else {
-        packet_timestamp = time - client.round_trip_time / 2;
+        packet_timestamp = time - clock_sync_round_trip_time(client.clock_sync, client.round_trip_time) / 2;
     }
 
     insert_packet_to_queue(client, packet_timestamp, packet);
@@ -603,17 +1262,43 @@ void enqueue_packet<packet::registry_snapshot>(entt::registry &registry, entt::e
     // Specialize it for registry snapshots. Transform entities to local and
     // import action history in advance.
     auto &client = registry.get<remote_client>(client_entity);
+    auto &ctx = registry.ctx().get<server_network_context>();
+
+    clock_sync_process_sample(client.clock_sync, packet.clock, time);
+    update_client_playout_round_trip_time(ctx, client);
+
+    auto &settings = registry.ctx().get<edyn::settings>();
+    auto collect_stats = std::get<server_network_settings>(settings.network_settings).collect_network_stats;
+    auto start_time = collect_stats ? performance_time() : 0;
+
+    // Updates the stats of the client and the totals.
+    auto record_received = [&](bool discarded) {
+        if (!collect_stats) {
+            return;
+        }
+
+        auto elapsed = performance_time() - start_time;
+
+        for (auto *stats : {&client.stats, &ctx.stats}) {
+            ++stats->packets_received;
+            stats->entities_received += packet.entities.size();
+            stats->packets_discarded += discarded ? 1 : 0;
+            stats->import_time += elapsed;
+        }
+    };
+
     double time_delta;
 
     if (client.clock_sync.count > 0) {
         time_delta = client.clock_sync.time_delta;
     } else {
-        time_delta = time - (packet.timestamp + client.round_trip_time / 2);
+        time_delta = time - (packet.timestamp + clock_sync_round_trip_time(client.clock_sync, client.round_trip_time) / 2);
     }
 
     for (auto &entity : packet.entities) {
         // Discard packet if it contains unknown entities.
         if (!client.entity_map.contains(entity)) {
+            record_received(true);
             return;
         }
         entity = client.entity_map.at(entity);
@@ -621,10 +1306,22 @@ void enqueue_packet<packet::registry_snapshot>(entt::registry &registry, entt::e
 
     // Transform snapshot entities into local registry space and then import
     // action history.
-    auto &ctx = registry.ctx().get<server_network_context>();
     const bool check_ownership = true;
     ctx.snapshot_importer->transform_to_local(registry, client_entity, packet, check_ownership);
-    ctx.snapshot_importer->merge_action_history(registry, packet, time_delta);
+    auto latest_action_timestamp =
+        ctx.snapshot_importer->merge_action_history(registry, client_entity, packet, time_delta,
+                                                    client.playout_delay, ctx.pending_actions);
+    record_received(false);
+
+    // Acknowledge received actions so the client stops resending them. The
+    // acknowledgement is sent whenever actions are received, thus a lost
+    // acknowledgement is replaced by the next.
+    if (latest_action_timestamp) {
+        client.last_received_action_timestamp =
+            std::max(client.last_received_action_timestamp, *latest_action_timestamp);
+        auto ack = packet::action_ack{client.last_received_action_timestamp};
+        ctx.packet_signal.publish(client_entity, packet::edyn_packet{ack});
+    }
 
     // The action history pool is removed from the packet after being merged.
     // Do not enqueue if there are no other pools in the packet.
@@ -634,7 +1331,7 @@ void enqueue_packet<packet::registry_snapshot>(entt::registry &registry, entt::e
         if (client.clock_sync.count > 0) {
             packet_timestamp = std::min(packet.timestamp + client.clock_sync.time_delta, time);
         } else {
-            packet_timestamp = time - client.round_trip_time / 2;
+            packet_timestamp = time - clock_sync_round_trip_time(client.clock_sync, client.round_trip_time) / 2;
         }
 
         insert_packet_to_queue(client, packet_timestamp, packet);
@@ -642,6 +1339,8 @@ void enqueue_packet<packet::registry_snapshot>(entt::registry &registry, entt::e
 }
 
 void server_receive_packet(entt::registry &registry, entt::entity client_entity, packet::edyn_packet &packet) {
+    internal::capture_packet(registry, client_entity, packet);
+
     std::visit([&](auto &&decoded_packet) {
         using PacketType = std::decay_t<decltype(decoded_packet)>;
         // If it's a timed packet, enqueue for later execution. Process
@@ -654,6 +1353,15 @@ void server_receive_packet(entt::registry &registry, entt::entity client_entity,
             process_packet(registry, client_entity, decoded_packet);
         }
     }, packet.var);
+
+    internal::capture_resume(registry);
+}
+
+bool server_receive_packet_batch(entt::registry &registry, entt::entity client_entity,
+                                 const uint8_t *data, size_t size) {
+    return read_packet_batch(data, size, [&](packet::edyn_packet &packet) {
+        server_receive_packet(registry, client_entity, packet);
+    });
 }
 
 // Local struct to be connected to the clock sync packet signal. This is
@@ -698,6 +1406,15 @@ entt::entity server_make_client(entt::registry &registry, bool allow_full_owners
 void server_destroy_client(entt::registry &registry, entt::entity client_entity) {
     auto &client = registry.get<remote_client>(client_entity);
 
+    // The entities in its AABB of interest are no longer of interest to it.
+    if (auto *aabboi = registry.try_get<aabb_of_interest>(client_entity)) {
+        auto &ctx = registry.ctx().get<server_network_context>();
+
+        for (auto entity : aabboi->entities) {
+            decrement_interest_count(ctx, entity);
+        }
+    }
+
     for (auto entity : client.owned_entities) {
         if (registry.valid(entity)) {
             registry.destroy(entity);
@@ -716,6 +1433,9 @@ void server_set_allow_full_ownership(entt::registry &registry, entt::entity clie
 void server_set_client_round_trip_time(entt::registry &registry, entt::entity client_entity, double rtt) {
     auto &client = registry.get<remote_client>(client_entity);
     client.round_trip_time = rtt;
+
+    auto &ctx = registry.ctx().get<server_network_context>();
+    update_client_playout_round_trip_time(ctx, client);
 }
 
 }
@@ -12,6 +12,9 @@
 #include "edyn/networking/comp/aabb_of_interest.hpp"
 #include "edyn/networking/comp/aabb_oi_follow.hpp"
 #include "edyn/networking/comp/entity_owner.hpp"
+#include "edyn/networking/settings/server_network_settings.hpp"
+#include "edyn/networking/util/interest_grid.hpp"
+#include "edyn/util/frame_arena.hpp"
 #include "edyn/collision/query_aabb.hpp"
 #include <entt/entity/fwd.hpp>
 #include <entt/entity/registry.hpp>
@@ -32,52 +35,13 @@ void follow_aabb_of_interest(entt::registry &registry) {
 }
 
 void update_aabbs_of_interest_seq(entt::registry &registry) {
-    auto networked_view = registry.view<networked_tag>();
-    auto &bphase = registry.ctx().get<broadphase>();
-
-    registry.view<aabb_of_interest>().each([&](aabb_of_interest &aabboi) {
-        entt::sparse_set contained_entities;
-
-        // Collect entities of islands which intersect the AABB of interest.
-        bphase.query_islands(aabboi.aabb, [&](entt::entity island_entity) {
-            auto &island = registry.get<edyn::island>(island_entity);
-
-            for (auto entity : island.nodes) {
-                if (networked_view.contains(entity) && !contained_entities.contains(entity)) {
-                    contained_entities.push(entity);
-                }
-            }
-
-            for (auto entity : island.edges) {
-                if (networked_view.contains(entity) && !contained_entities.contains(entity)) {
-                    contained_entities.push(entity);
-                }
-            }
-        });
-
-        bphase.query_non_procedural(aabboi.aabb, [&](entt::entity np_entity) {
-            if (networked_view.contains(np_entity) && !contained_entities.contains(np_entity)) {
-                contained_entities.push(np_entity);
-            }
-        });
-
-        // Calculate which entities have entered and exited the AABB of interest.
-        for (auto entity : aabboi.entities) {
-            if (!contained_entities.contains(entity)) {
-                aabboi.entities_exited.push_back(entity);
-            }
-        }
-
-        for (auto entity : contained_entities) {
-            if (!aabboi.entities.contains(entity)) {
-                aabboi.entities_entered.push_back(entity);
-            }
-        }
+    if (!registry.ctx().contains<interest_grid>()) {
+        auto &settings = registry.ctx().get<edyn::settings>();
+        auto &server_settings = std::get<server_network_settings>(settings.network_settings);
+        registry.ctx().emplace<interest_grid>(server_settings.interest_cell_size);
+    }
 
-        // Assign the current set of entities which are in an island that
-        // intersects the AABB of interest.
-        aabboi.entities = std::move(contained_entities);
-    });
+    registry.ctx().get<interest_grid>().update(registry);
 }
 
 struct aabb_of_interest_async_context {
@@ -100,7 +64,11 @@ void process_aabb_of_interest_result(entt::registry &registry, query_aabb_id_typ
     auto manifold_view = registry.view<contact_manifold>();
     auto networked_view = registry.view<networked_tag>();
     auto contained_entities = entt::sparse_set{};
-    auto to_visit = entt::sparse_set{};
+
+    // Entities still to be visited are only needed during the traversal.
+    using frame_sparse_set = entt::basic_sparse_set<entt::entity, allocator<entt::entity>>;
+    auto scope = frame_scope{};
+    auto to_visit = frame_sparse_set(scope.get_allocator<entt::entity>());
 
     for (auto entity : result.procedural_entities) {
         if (edge_view.contains(entity)) {
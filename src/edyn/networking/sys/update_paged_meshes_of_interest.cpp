@@ -0,0 +1,60 @@
+#include "edyn/networking/sys/update_paged_meshes_of_interest.hpp"
+#include "edyn/comp/linvel.hpp"
+#include "edyn/networking/comp/aabb_of_interest.hpp"
+#include "edyn/networking/comp/aabb_oi_follow.hpp"
+#include "edyn/shapes/paged_mesh_shape.hpp"
+#include "edyn/shapes/paged_mesh_pinned_pages.hpp"
+#include <entt/entity/registry.hpp>
+#include <vector>
+
+namespace edyn {
+
+void update_paged_meshes_of_interest(entt::registry &registry,
+                                     paged_mesh_pinned_pages &pinned,
+                                     scalar lookahead) {
+    auto mesh_view = registry.view<paged_mesh_shape>();
+    auto aabboi_view = registry.view<aabb_of_interest>();
+    auto follow_view = registry.view<aabb_oi_follow>();
+    auto vel_view = registry.view<linvel>();
+    auto pages = std::vector<paged_mesh_pinned_pages::page_type>{};
+
+    for (auto [client_entity, aabboi] : aabboi_view.each()) {
+        // Sweep the AABB of interest by the displacement of the entity it
+        // follows, which is usually the vehicle or character of the client.
+        auto displacement = vector3_zero;
+
+        if (follow_view.contains(client_entity)) {
+            auto [follow] = follow_view.get(client_entity);
+
+            if (vel_view.contains(follow.entity)) {
+                auto [vel] = vel_view.get(follow.entity);
+                displacement = vel * lookahead;
+            }
+        }
+
+        auto &aabb = aabboi.aabb;
+        auto prefetch_aabb = AABB{aabb.min + min(displacement, vector3_zero),
+                                  aabb.max + max(displacement, vector3_zero)};
+
+        for (auto [mesh_entity, shape] : mesh_view.each()) {
+            auto &trimesh_ptr = shape.trimesh;
+            auto &trimesh = *trimesh_ptr;
+
+            if (!intersect(trimesh.get_aabb(), prefetch_aabb)) {
+                continue;
+            }
+
+            trimesh.prefetch(prefetch_aabb);
+
+            // Pages are pinned before they're loaded, so they can't be
+            // unloaded as soon as they arrive to make room for others.
+            trimesh.visit_submesh_indices(aabb, [&](size_t mesh_idx) {
+                pages.emplace_back(trimesh_ptr, mesh_idx);
+            });
+        }
+    }
+
+    pinned.assign(std::move(pages));
+}
+
+}
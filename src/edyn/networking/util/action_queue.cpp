@@ -0,0 +1,16 @@
+#include "edyn/networking/util/action_queue.hpp"
+
+namespace edyn {
+
+void action_queue::push(const queued_action &action) {
+    m_heap.push_back(action);
+    std::push_heap(m_heap.begin(), m_heap.end(), &later);
+}
+
+void action_queue::pop() {
+    EDYN_ASSERT(!empty());
+    std::pop_heap(m_heap.begin(), m_heap.end(), &later);
+    m_heap.pop_back();
+}
+
+}
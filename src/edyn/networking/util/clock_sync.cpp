@@ -1,4 +1,6 @@
 #include "edyn/networking/util/clock_sync.hpp"
+#include <algorithm>
+#include <cmath>
 
 namespace edyn {
 
@@ -79,6 +81,14 @@ void clock_sync_process_time_response(clock_sync_data &clock_sync, const packet:
 }
 
 void update_clock_sync(clock_sync_data &clock_sync, double time, double avg_rtt) {
+    // Clock samples piggybacked on registry snapshots keep the estimates up
+    // to date, thus time requests are only needed when those are missing.
+    if (clock_sync.sample_count > 0 && time - clock_sync.last_sample_time < clock_sync.sample_timeout) {
+        return;
+    }
+
+    avg_rtt = clock_sync_round_trip_time(clock_sync, avg_rtt);
+
     switch (clock_sync.state) {
     case clock_sync_state::none: {
         if (clock_sync.count == 0 || time - clock_sync.time_req_timestamp > clock_sync.period) {
@@ -100,4 +110,64 @@ void update_clock_sync(clock_sync_data &clock_sync, double time, double avg_rtt)
     }
 }
 
+packet::clock_sample clock_sync_make_sample(const clock_sync_data &clock_sync, double time) {
+    auto sample = packet::clock_sample{};
+    sample.send_time = time;
+
+    if (clock_sync.has_remote_sample) {
+        sample.echo_time = clock_sync.remote_send_time;
+        sample.echo_delay = static_cast<float>(time - clock_sync.remote_receive_time);
+    }
+
+    return sample;
+}
+
+void clock_sync_process_sample(clock_sync_data &clock_sync, const packet::clock_sample &sample, double time) {
+    if (!clock_sync.has_remote_sample || sample.send_time > clock_sync.remote_send_time) {
+        clock_sync.remote_send_time = sample.send_time;
+        clock_sync.remote_receive_time = time;
+        clock_sync.has_remote_sample = true;
+    }
+
+    if (sample.echo_delay < 0 || sample.echo_time > time ||
+        (clock_sync.sample_count > 0 && !(sample.echo_time > clock_sync.last_echo_time))) {
+        return;
+    }
+
+    // The echoed time is in the local clock. The round-trip time is the time
+    // since it was sent minus the time it was held by the remote end.
+    auto rtt = std::max(time - sample.echo_time - sample.echo_delay, 0.0);
+
+    // The remote end received the echoed sample half the round-trip time after
+    // it was sent, and sent this one half the round-trip time ago.
+    auto time_delta = time - (sample.send_time + rtt / 2);
+
+    clock_sync.last_echo_time = sample.echo_time;
+    clock_sync.last_sample_time = time;
+
+    if (clock_sync.sample_count == 0) {
+        clock_sync.round_trip_time = rtt;
+        clock_sync.round_trip_time_deviation = rtt / 2;
+
+        if (clock_sync.count == 0) {
+            clock_sync.time_delta = time_delta;
+            clock_sync.count++;
+        }
+    } else {
+        // Packets which were delayed more than usual make for a poor time
+        // delta estimate since the delay is unlikely to be symmetric.
+        auto deviation = std::abs(rtt - clock_sync.round_trip_time);
+        auto is_outlier = deviation > clock_sync.round_trip_time_deviation * 4;
+
+        if (!is_outlier) {
+            clock_sync.time_delta += (time_delta - clock_sync.time_delta) * clock_sync.time_delta_gain;
+        }
+
+        clock_sync.round_trip_time_deviation += (deviation - clock_sync.round_trip_time_deviation) * clock_sync.deviation_gain;
+        clock_sync.round_trip_time += (rtt - clock_sync.round_trip_time) * clock_sync.round_trip_time_gain;
+    }
+
+    ++clock_sync.sample_count;
+}
+
 }
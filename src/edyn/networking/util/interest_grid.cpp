@@ -0,0 +1,418 @@
+#include "edyn/networking/util/interest_grid.hpp"
+#include "edyn/comp/island.hpp"
+#include "edyn/comp/tag.hpp"
+#include "edyn/networking/comp/aabb_of_interest.hpp"
+#include "edyn/config/config.h"
+#include <entt/entity/registry.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace edyn {
+
+// Cell coordinates are clamped to 21 bits so they can be packed in a key.
+static constexpr int32_t max_cell_coord = (1 << 20) - 1;
+
+static uint64_t get_cell_key(const std::array<int32_t, 3> &coords) {
+    constexpr uint64_t mask = (1 << 21) - 1;
+    return ((static_cast<uint64_t>(coords[0]) & mask) << 42) |
+           ((static_cast<uint64_t>(coords[1]) & mask) << 21) |
+           (static_cast<uint64_t>(coords[2]) & mask);
+}
+
+template<typename Func>
+static void each_cell_coords(const std::array<int32_t, 3> &min, const std::array<int32_t, 3> &max, Func func) {
+    auto coords = std::array<int32_t, 3>{};
+
+    for (coords[0] = min[0]; coords[0] <= max[0]; ++coords[0]) {
+        for (coords[1] = min[1]; coords[1] <= max[1]; ++coords[1]) {
+            for (coords[2] = min[2]; coords[2] <= max[2]; ++coords[2]) {
+                func(coords);
+            }
+        }
+    }
+}
+
+static void erase_value(std::vector<entt::entity> &entities, entt::entity entity) {
+    auto it = std::find(entities.begin(), entities.end(), entity);
+
+    if (it != entities.end()) {
+        *it = entities.back();
+        entities.pop_back();
+    }
+}
+
+bool interest_grid::cell_range::contains(const std::array<int32_t, 3> &coords) const {
+    for (int i = 0; i < 3; ++i) {
+        if (coords[i] < min[i] || coords[i] > max[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool interest_grid::cell_range::overlaps(const cell_range &other) const {
+    for (int i = 0; i < 3; ++i) {
+        if (other.max[i] < min[i] || other.min[i] > max[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+size_t interest_grid::cell_range::num_cells() const {
+    size_t count = 1;
+
+    for (int i = 0; i < 3; ++i) {
+        count *= static_cast<size_t>(max[i] - min[i] + 1);
+    }
+
+    return count;
+}
+
+bool interest_grid::cell_range::operator==(const cell_range &other) const {
+    return min == other.min && max == other.max;
+}
+
+bool interest_grid::cell_range::operator!=(const cell_range &other) const {
+    return !(*this == other);
+}
+
+interest_grid::interest_grid(scalar cell_size)
+    : m_cell_size(cell_size)
+{
+    EDYN_ASSERT(cell_size > 0);
+}
+
+interest_grid::cell_range interest_grid::get_range(const AABB &aabb) const {
+    auto to_coord = [&](scalar value) {
+        auto coord = std::floor(value / m_cell_size);
+        coord = std::clamp(coord, scalar(-max_cell_coord), scalar(max_cell_coord));
+        return static_cast<int32_t>(coord);
+    };
+
+    auto range = cell_range{};
+
+    for (int i = 0; i < 3; ++i) {
+        range.min[i] = to_coord(aabb.min[i]);
+        range.max[i] = to_coord(aabb.max[i]);
+    }
+
+    return range;
+}
+
+template<typename Func>
+void interest_grid::each_cell(const cell_range &range, Func func) {
+    each_cell_coords(range.min, range.max, [&](auto &coords) {
+        func(get_cell_key(coords));
+    });
+}
+
+void interest_grid::insert_unit(entt::entity entity, const unit &u) {
+    if (u.global) {
+        return;
+    }
+
+    each_cell(u.range, [&](uint64_t key) {
+        m_cells[key].units.push_back(entity);
+    });
+}
+
+void interest_grid::erase_unit(entt::entity entity, const unit &u) {
+    if (u.global) {
+        return;
+    }
+
+    each_cell(u.range, [&](uint64_t key) {
+        auto it = m_cells.find(key);
+
+        if (it == m_cells.end()) {
+            return;
+        }
+
+        erase_value(it->second.units, entity);
+
+        if (it->second.units.empty() && it->second.watchers.empty()) {
+            m_cells.erase(it);
+        }
+    });
+}
+
+bool interest_grid::is_interested(const watcher &w, const unit &u) const {
+    if (u.global) {
+        return intersect(w.aabb, u.aabb);
+    }
+
+    return w.range.overlaps(u.range);
+}
+
+void interest_grid::update(entt::registry &registry) {
+    auto networked_view = registry.view<networked_tag>();
+    auto sleeping_view = registry.view<sleeping_tag>();
+
+    // Previous state of the units which changed in this update. Units which
+    // do not exist anymore are only present here.
+    auto previous_units = std::unordered_map<entt::entity, unit>{};
+    auto seen_units = entt::sparse_set{};
+
+    auto update_unit = [&](entt::entity entity, const AABB &aabb, auto gather) {
+        seen_units.push(entity);
+
+        auto range = get_range(aabb);
+        auto global = range.num_cells() > max_unit_cells;
+        auto it = m_units.find(entity);
+
+        if (it == m_units.end()) {
+            auto &u = m_units[entity];
+            u.aabb = aabb;
+            u.range = range;
+            u.global = global;
+            gather(u.entities);
+            insert_unit(entity, u);
+            previous_units[entity] = unit{aabb, range, global, {}};
+            return;
+        }
+
+        auto &u = it->second;
+
+        // The contents of sleeping islands do not change and their AABB
+        // stays in place.
+        if (sleeping_view.contains(entity) && u.range == range && u.global == global) {
+            u.aabb = aabb;
+            return;
+        }
+
+        auto entities = std::vector<entt::entity>{};
+        gather(entities);
+
+        if (u.range == range && u.global == global && u.entities == entities &&
+            (!global || (u.aabb.min == aabb.min && u.aabb.max == aabb.max))) {
+            u.aabb = aabb;
+            return;
+        }
+
+        auto prev = std::move(u);
+        erase_unit(entity, prev);
+        u = unit{aabb, range, global, std::move(entities)};
+        insert_unit(entity, u);
+        previous_units[entity] = std::move(prev);
+    };
+
+    registry.view<island, island_AABB>().each([&](entt::entity island_entity, island &island, island_AABB &aabb) {
+        update_unit(island_entity, aabb, [&](std::vector<entt::entity> &entities) {
+            for (auto entity : island.nodes) {
+                if (networked_view.contains(entity)) {
+                    entities.push_back(entity);
+                }
+            }
+
+            for (auto entity : island.edges) {
+                if (networked_view.contains(entity)) {
+                    entities.push_back(entity);
+                }
+            }
+        });
+    });
+
+    registry.view<AABB, networked_tag>(entt::exclude_t<procedural_tag>{})
+        .each([&](entt::entity entity, AABB &aabb) {
+        update_unit(entity, aabb, [entity](std::vector<entt::entity> &entities) {
+            entities.push_back(entity);
+        });
+    });
+
+    for (auto it = m_units.begin(); it != m_units.end();) {
+        if (seen_units.contains(it->first)) {
+            ++it;
+        } else {
+            erase_unit(it->first, it->second);
+            previous_units[it->first] = std::move(it->second);
+            it = m_units.erase(it);
+        }
+    }
+
+    // Units each watcher must check again. Changed units are checked by the
+    // watchers of the cells they were in and of the cells they are in now.
+    // This must be done before the watchers are moved, since the watchers
+    // which contained a unit might not share a cell with it anymore.
+    auto pending = std::unordered_map<entt::entity, entt::sparse_set>{};
+
+    auto add_pending = [&](entt::entity watcher_entity, entt::entity unit_entity) {
+        auto &units = pending[watcher_entity];
+
+        if (!units.contains(unit_entity)) {
+            units.push(unit_entity);
+        }
+    };
+
+    auto add_cell_watchers_pending = [&](entt::entity unit_entity, const unit &u) {
+        if (u.global) {
+            for (auto &pair : m_watchers) {
+                add_pending(pair.first, unit_entity);
+            }
+            return;
+        }
+
+        each_cell(u.range, [&](uint64_t key) {
+            if (auto it = m_cells.find(key); it != m_cells.end()) {
+                for (auto watcher_entity : it->second.watchers) {
+                    add_pending(watcher_entity, unit_entity);
+                }
+            }
+        });
+    };
+
+    for (auto &[unit_entity, prev] : previous_units) {
+        add_cell_watchers_pending(unit_entity, prev);
+
+        if (auto it = m_units.find(unit_entity); it != m_units.end()) {
+            add_cell_watchers_pending(unit_entity, it->second);
+        }
+    }
+
+    // Move watchers across cells and check the units in the cells they
+    // entered and exited.
+    auto aabboi_view = registry.view<aabb_of_interest>();
+
+    for (auto it = m_watchers.begin(); it != m_watchers.end();) {
+        if (aabboi_view.contains(it->first)) {
+            ++it;
+            continue;
+        }
+
+        each_cell(it->second.range, [&](uint64_t key) {
+            auto cell_it = m_cells.find(key);
+            erase_value(cell_it->second.watchers, it->first);
+
+            if (cell_it->second.units.empty() && cell_it->second.watchers.empty()) {
+                m_cells.erase(cell_it);
+            }
+        });
+
+        pending.erase(it->first);
+        it = m_watchers.erase(it);
+    }
+
+    for (auto watcher_entity : aabboi_view) {
+        auto &aabboi = aabboi_view.get<aabb_of_interest>(watcher_entity);
+        auto range = get_range(aabboi.aabb);
+        auto it = m_watchers.find(watcher_entity);
+        auto is_new = it == m_watchers.end();
+        auto &w = m_watchers[watcher_entity];
+        auto aabb_changed = is_new || w.aabb.min != aabboi.aabb.min || w.aabb.max != aabboi.aabb.max;
+        w.aabb = aabboi.aabb;
+
+        if (is_new || w.range != range) {
+            auto enter_cell = [&](uint64_t key) {
+                auto &c = m_cells[key];
+                c.watchers.push_back(watcher_entity);
+
+                for (auto unit_entity : c.units) {
+                    add_pending(watcher_entity, unit_entity);
+                }
+            };
+
+            auto exit_cell = [&](uint64_t key) {
+                auto cell_it = m_cells.find(key);
+
+                for (auto unit_entity : cell_it->second.units) {
+                    add_pending(watcher_entity, unit_entity);
+                }
+
+                erase_value(cell_it->second.watchers, watcher_entity);
+
+                if (cell_it->second.units.empty() && cell_it->second.watchers.empty()) {
+                    m_cells.erase(cell_it);
+                }
+            };
+
+            if (is_new) {
+                each_cell(range, enter_cell);
+            } else {
+                each_cell_coords(w.range.min, w.range.max, [&](auto &coords) {
+                    if (!range.contains(coords)) {
+                        exit_cell(get_cell_key(coords));
+                    }
+                });
+                each_cell_coords(range.min, range.max, [&](auto &coords) {
+                    if (!w.range.contains(coords)) {
+                        enter_cell(get_cell_key(coords));
+                    }
+                });
+            }
+
+            w.range = range;
+        }
+
+        // Units which are not in the grid are tested against the AABB.
+        if (aabb_changed) {
+            for (auto &[unit_entity, u] : m_units) {
+                if (u.global) {
+                    add_pending(watcher_entity, unit_entity);
+                }
+            }
+        }
+    }
+
+    // Update the entities of interest of each watcher with the pending units.
+    for (auto &[watcher_entity, units] : pending) {
+        auto &w = m_watchers.at(watcher_entity);
+        auto &aabboi = aabboi_view.get<aabb_of_interest>(watcher_entity);
+        auto touched = entt::sparse_set{};
+
+        for (auto unit_entity : units) {
+            auto unit_it = m_units.find(unit_entity);
+            auto was_interested = w.units.count(unit_entity) > 0;
+            auto is_interested = unit_it != m_units.end() && this->is_interested(w, unit_it->second);
+
+            if (was_interested) {
+                auto prev_it = previous_units.find(unit_entity);
+                auto &prev = prev_it != previous_units.end() ? prev_it->second : unit_it->second;
+
+                for (auto entity : prev.entities) {
+                    --w.entity_count.at(entity);
+
+                    if (!touched.contains(entity)) {
+                        touched.push(entity);
+                    }
+                }
+
+                w.units.erase(unit_entity);
+            }
+
+            if (is_interested) {
+                for (auto entity : unit_it->second.entities) {
+                    ++w.entity_count[entity];
+
+                    if (!touched.contains(entity)) {
+                        touched.push(entity);
+                    }
+                }
+
+                w.units.insert(unit_entity);
+            }
+        }
+
+        // Calculate which entities have entered and exited the AABB of
+        // interest from the entities whose count has changed.
+        for (auto entity : touched) {
+            auto count_it = w.entity_count.find(entity);
+            auto contained = count_it != w.entity_count.end() && count_it->second > 0;
+
+            if (count_it != w.entity_count.end() && count_it->second == 0) {
+                w.entity_count.erase(count_it);
+            }
+
+            if (contained && !aabboi.entities.contains(entity)) {
+                aabboi.entities.push(entity);
+                aabboi.entities_entered.push_back(entity);
+            } else if (!contained && aabboi.entities.contains(entity)) {
+                aabboi.entities.remove(entity);
+                aabboi.entities_exited.push_back(entity);
+            }
+        }
+    }
+}
+
+}
@@ -0,0 +1,60 @@
+#include "edyn/networking/util/network_stats.hpp"
+#include "edyn/networking/packet/registry_snapshot.hpp"
+#include "edyn/serialization/entt_s11n.hpp"
+#include "edyn/serialization/memory_archive.hpp"
+#include "edyn/serialization/std_s11n.hpp"
+#include <algorithm>
+
+namespace edyn {
+
+void network_stats::merge(const network_stats &other) {
+    snapshots_sent += other.snapshots_sent;
+    packets_sent += other.packets_sent;
+    entities_sent += other.entities_sent;
+    bytes_sent += other.bytes_sent;
+
+    if (components_sent.size() < other.components_sent.size()) {
+        components_sent.resize(other.components_sent.size());
+    }
+
+    for (size_t i = 0; i < other.components_sent.size(); ++i) {
+        components_sent[i].count += other.components_sent[i].count;
+        components_sent[i].bytes += other.components_sent[i].bytes;
+    }
+
+    entities_deferred += other.entities_deferred;
+    export_time += other.export_time;
+    packets_received += other.packets_received;
+    entities_received += other.entities_received;
+    packets_discarded += other.packets_discarded;
+    import_time += other.import_time;
+}
+
+size_t network_stats::record_sent(packet::registry_snapshot &snap) {
+    auto buffer = std::vector<uint8_t>{};
+    auto archive = memory_output_archive(buffer);
+    archive(snap);
+    const auto size = buffer.size();
+
+    ++packets_sent;
+    entities_sent += snap.entities.size();
+    bytes_sent += size;
+
+    for (auto &pool : snap.pools) {
+        if (components_sent.size() <= pool.component_index) {
+            components_sent.resize(pool.component_index + 1);
+        }
+
+        buffer.clear();
+        auto pool_archive = memory_output_archive(buffer);
+        pool_archive(pool);
+
+        auto &stats = components_sent[pool.component_index];
+        stats.count += pool.ptr->entity_indices.size();
+        stats.bytes += buffer.size();
+    }
+
+    return size;
+}
+
+}
@@ -0,0 +1,19 @@
+#include "edyn/networking/util/packet_batch.hpp"
+
+namespace edyn {
+
+void packet_batch::insert(const packet::edyn_packet &packet) {
+    auto &buffer = should_send_reliably(packet) ? m_reliable : m_unreliable;
+
+    // Reserve space for the size and assign it after serializing.
+    auto offset = buffer.size();
+    buffer.resize(offset + sizeof(size_type));
+
+    auto archive = memory_output_archive(buffer);
+    archive(packet);
+
+    auto packet_size = static_cast<size_type>(buffer.size() - offset - sizeof(size_type));
+    std::memcpy(buffer.data() + offset, &packet_size, sizeof(size_type));
+}
+
+}
@@ -0,0 +1,173 @@
+#include "edyn/networking/util/reconcile_pool_snapshot.hpp"
+#include "edyn/networking/util/pool_snapshot.hpp"
+#include "edyn/networking/settings/client_network_settings.hpp"
+#include "edyn/comp/position.hpp"
+#include "edyn/comp/orientation.hpp"
+#include "edyn/comp/linvel.hpp"
+#include "edyn/comp/angvel.hpp"
+#include "edyn/math/quaternion.hpp"
+#include "edyn/replication/entity_map.hpp"
+#include <entt/entity/registry.hpp>
+#include <cmath>
+
+namespace edyn {
+
+namespace {
+
+template<typename Component>
+pool_snapshot_data_impl<Component> * find_pool(std::vector<pool_snapshot> &pools) {
+    for (auto &pool : pools) {
+        if (pool.ptr->get_type_id() == entt::type_index<Component>::value()) {
+            return static_cast<pool_snapshot_data_impl<Component> *>(pool.ptr.get());
+        }
+    }
+
+    return nullptr;
+}
+
+// Flags the entities of the snapshot which have an entry in the pool and
+// marks the ones whose local value does not match it.
+template<typename Component, typename ToLocal, typename Matches>
+void compare_pool(const entt::registry &registry, const std::vector<entt::entity> &entities,
+                  pool_snapshot_data_impl<Component> *pool, ToLocal to_local, Matches matches,
+                  std::vector<bool> &has_entry, std::vector<bool> &mismatch) {
+    if (pool == nullptr) {
+        return;
+    }
+
+    for (size_t i = 0; i < pool->entity_indices.size(); ++i) {
+        auto entity_index = pool->entity_indices[i];
+
+        if (entity_index >= entities.size()) {
+            continue;
+        }
+
+        has_entry[entity_index] = true;
+        auto local_entity = to_local(entities[entity_index]);
+
+        if (local_entity == entt::null || !registry.valid(local_entity) ||
+            !registry.all_of<Component>(local_entity) ||
+            !matches(registry.get<Component>(local_entity), pool->components[i])) {
+            mismatch[entity_index] = true;
+        }
+    }
+}
+
+template<typename Component>
+void erase_redundant(const std::vector<entt::entity> &entities,
+                     pool_snapshot_data_impl<Component> *pool,
+                     const std::vector<bool> &redundant) {
+    if (pool == nullptr) {
+        return;
+    }
+
+    auto keep = std::vector<bool>(pool->entity_indices.size());
+    auto any_redundant = false;
+
+    for (size_t i = 0; i < pool->entity_indices.size(); ++i) {
+        auto entity_index = pool->entity_indices[i];
+        keep[i] = entity_index >= entities.size() || !redundant[entity_index];
+        any_redundant |= !keep[i];
+    }
+
+    if (any_redundant) {
+        pool->erase_entries(keep);
+    }
+}
+
+template<typename ToLocal>
+void reconcile(const entt::registry &registry, const std::vector<entt::entity> &entities,
+               std::vector<pool_snapshot> &pools, const client_network_settings &settings,
+               std::vector<entt::entity> &corrected, ToLocal to_local) {
+    corrected.clear();
+
+    if (!settings.reconcile_snapshots) {
+        corrected = entities;
+        return;
+    }
+
+    auto *pos_pool = find_pool<position>(pools);
+    auto *orn_pool = find_pool<orientation>(pools);
+    auto *linvel_pool = find_pool<linvel>(pools);
+    auto *angvel_pool = find_pool<angvel>(pools);
+
+    auto has_entry = std::vector<bool>(entities.size());
+    auto mismatch = std::vector<bool>(entities.size());
+
+    auto pos_tolerance = settings.reconciliation_position_tolerance;
+    auto pos_tolerance_sqr = pos_tolerance * pos_tolerance;
+    // The angle between two orientations is twice the arc cosine of the
+    // absolute value of the dot product of the quaternions.
+    auto min_orn_dot = std::cos(settings.reconciliation_orientation_tolerance / 2);
+    auto vel_tolerance = settings.reconciliation_velocity_tolerance;
+    auto vel_tolerance_sqr = vel_tolerance * vel_tolerance;
+
+    compare_pool(registry, entities, pos_pool, to_local, [&](const position &local, const position &received) {
+        return distance_sqr(local, received) <= pos_tolerance_sqr;
+    }, has_entry, mismatch);
+    compare_pool(registry, entities, orn_pool, to_local, [&](const orientation &local, const orientation &received) {
+        return std::abs(dot(local, received)) >= min_orn_dot;
+    }, has_entry, mismatch);
+    compare_pool(registry, entities, linvel_pool, to_local, [&](const linvel &local, const linvel &received) {
+        return distance_sqr(local, received) <= vel_tolerance_sqr;
+    }, has_entry, mismatch);
+    compare_pool(registry, entities, angvel_pool, to_local, [&](const angvel &local, const angvel &received) {
+        return distance_sqr(local, received) <= vel_tolerance_sqr;
+    }, has_entry, mismatch);
+
+    auto redundant = std::vector<bool>(entities.size());
+    auto any_redundant = false;
+
+    for (size_t i = 0; i < entities.size(); ++i) {
+        redundant[i] = has_entry[i] && !mismatch[i];
+        any_redundant |= redundant[i];
+    }
+
+    if (any_redundant) {
+        erase_redundant(entities, pos_pool, redundant);
+        erase_redundant(entities, orn_pool, redundant);
+        erase_redundant(entities, linvel_pool, redundant);
+        erase_redundant(entities, angvel_pool, redundant);
+    }
+
+    // Entities which still have anything to be applied.
+    auto applied = std::vector<bool>(entities.size());
+
+    for (auto &pool : pools) {
+        for (auto entity_index : pool.ptr->entity_indices) {
+            if (entity_index < entities.size()) {
+                applied[entity_index] = true;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < entities.size(); ++i) {
+        if (applied[i]) {
+            corrected.push_back(entities[i]);
+        }
+    }
+}
+
+}
+
+void reconcile_pool_snapshot(const entt::registry &registry, const entity_map &emap,
+                             const std::vector<entt::entity> &entities,
+                             std::vector<pool_snapshot> &pools,
+                             const client_network_settings &settings,
+                             std::vector<entt::entity> &corrected) {
+    reconcile(registry, entities, pools, settings, corrected, [&](entt::entity remote_entity) {
+        return emap.contains(remote_entity) ? emap.at(remote_entity) : entt::entity{entt::null};
+    });
+}
+
+void reconcile_pool_snapshot(const entt::registry &registry,
+                             const std::vector<entt::entity> &entities,
+                             std::vector<pool_snapshot> &pools,
+                             const client_network_settings &settings,
+                             std::vector<entt::entity> &corrected) {
+    reconcile(registry, entities, pools, settings, corrected, [](entt::entity entity) {
+        return entity;
+    });
+}
+
+}
@@ -0,0 +1,130 @@
+#include "edyn/networking/util/server_snapshot_exporter.hpp"
+#include "edyn/serialization/memory_archive.hpp"
+#include <limits>
+
+namespace edyn {
+
+// Size of the fields of a snapshot besides its entities and pools, including
+// the type of packet in the `edyn_packet` variant.
+static constexpr size_t snapshot_overhead =
+    sizeof(uint8_t) + sizeof(double) + sizeof(snapshot_baseline::id_type) +
+    sizeof(uint32_t) + sizeof(uint16_t);
+
+// Maximum size of the fields of a pool besides its entries, i.e. component
+// index, size of data, index width, number of entities and delta flag.
+static constexpr size_t pool_overhead =
+    sizeof(component_index_type) + sizeof(uint16_t) + sizeof(uint8_t) + sizeof(uint32_t) + sizeof(uint8_t);
+
+void server_snapshot_exporter::export_rest_state(packet::registry_snapshot &snap,
+                                                 const std::vector<entt::entity> &entities) const {
+    auto indices = std::vector<component_index_type>{};
+
+    auto ids = std::array<entt::id_type, 4>{entt::type_index<position>(), entt::type_index<orientation>(),
+                                            entt::type_index<linvel>(), entt::type_index<angvel>()};
+
+    for (auto id : ids) {
+        if (auto it = m_component_indices.find(id); it != m_component_indices.end()) {
+            indices.push_back(it->second);
+        }
+    }
+
+    for (auto entity : entities) {
+        export_comp_index(snap, entity, indices);
+    }
+}
+
+void server_snapshot_exporter::split(const packet::registry_snapshot &snap, size_t max_size,
+                                     std::vector<packet::registry_snapshot> &result) const {
+    const auto num_pools = snap.pools.size();
+    constexpr auto null_index = std::numeric_limits<size_t>::max();
+
+    // Estimated size of a single entry in each pool, which is obtained by
+    // serializing the entire pool, since the size of each component depends
+    // on its encoding.
+    auto entry_sizes = std::vector<size_t>(num_pools);
+    // Pool index and position in pool of all entries of each entity.
+    auto entity_entries = std::vector<std::vector<std::pair<size_t, size_t>>>(snap.entities.size());
+    auto buffer = std::vector<uint8_t>{};
+
+    for (size_t i = 0; i < num_pools; ++i) {
+        auto &pool = *snap.pools[i].ptr;
+        const auto num_entries = pool.entity_indices.size();
+
+        if (num_entries == 0) {
+            continue;
+        }
+
+        buffer.clear();
+        auto archive = memory_output_archive(buffer);
+        pool.write(archive);
+        entry_sizes[i] = buffer.size() / num_entries + 1;
+
+        for (size_t j = 0; j < num_entries; ++j) {
+            auto entity_index = pool.entity_indices[j];
+            EDYN_ASSERT(entity_index < entity_entries.size());
+            entity_entries[entity_index].emplace_back(i, j);
+        }
+    }
+
+    // Index of each pool of the source snapshot in the current snapshot.
+    auto pool_indices = std::vector<size_t>(num_pools, null_index);
+    packet::registry_snapshot *current = nullptr;
+    size_t current_size = 0;
+
+    auto get_entity_size = [&](auto &entries) {
+        auto size = sizeof(entt::entity);
+
+        for (auto [pool_index, position] : entries) {
+            size += entry_sizes[pool_index];
+
+            if (pool_indices[pool_index] == null_index) {
+                size += pool_overhead;
+            }
+        }
+
+        return size;
+    };
+
+    // Entities are visited in order so the ones that come first in the source
+    // snapshot end up in the first snapshots.
+    for (size_t entity_index = 0; entity_index < snap.entities.size(); ++entity_index) {
+        auto &entries = entity_entries[entity_index];
+
+        if (entries.empty()) {
+            continue;
+        }
+
+        auto entity_size = current ? get_entity_size(entries) : size_t{};
+
+        // An entity that does not fit in an empty snapshot is still added to
+        // a snapshot of its own.
+        if (current == nullptr || (current_size + entity_size > max_size && !current->entities.empty())) {
+            current = &result.emplace_back();
+            current->timestamp = snap.timestamp;
+            current->id = snap.id;
+            current_size = snapshot_overhead;
+            std::fill(pool_indices.begin(), pool_indices.end(), null_index);
+            entity_size = get_entity_size(entries);
+        }
+
+        current_size += entity_size;
+
+        auto local_index = static_cast<pool_snapshot_data::index_type>(current->entities.size());
+        current->entities.push_back(snap.entities[entity_index]);
+
+        for (auto [pool_index, position] : entries) {
+            auto &src_pool = snap.pools[pool_index];
+
+            if (pool_indices[pool_index] == null_index) {
+                pool_indices[pool_index] = current->pools.size();
+                auto &pool = current->pools.emplace_back();
+                pool.component_index = src_pool.component_index;
+                pool.ptr = (*g_make_pool_snapshot_data)(src_pool.component_index);
+            }
+
+            current->pools[pool_indices[pool_index]].ptr->append(*src_pool.ptr, position, local_index);
+        }
+    }
+}
+
+}
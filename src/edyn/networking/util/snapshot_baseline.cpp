@@ -0,0 +1,155 @@
+#include "edyn/networking/util/snapshot_baseline.hpp"
+#include "edyn/networking/packet/registry_snapshot.hpp"
+#include "edyn/config/config.h"
+#include <algorithm>
+
+namespace edyn {
+
+void snapshot_baseline::insert(const packet::registry_snapshot &snap) {
+    EDYN_ASSERT(snap.id != null_id);
+
+    for (auto &pool : snap.pools) {
+        pool.ptr->record_baseline(*this, snap.id, snap.entities, pool.component_index);
+    }
+}
+
+void snapshot_baseline::insert(id_type id, entt::entity entity, component_index_type component_index,
+                               const void *data, size_t size) {
+    auto &rec = m_records[id];
+    auto offset = rec.data.size();
+    auto *bytes = static_cast<const uint8_t *>(data);
+    rec.data.insert(rec.data.end(), bytes, bytes + size);
+    rec.offsets[key_type{entity, component_index}] = offset;
+}
+
+const uint8_t * snapshot_baseline::find(id_type id, entt::entity entity, component_index_type component_index) const {
+    auto rec_it = m_records.find(id);
+
+    if (rec_it == m_records.end()) {
+        return nullptr;
+    }
+
+    auto &rec = rec_it->second;
+    auto offset_it = rec.offsets.find(key_type{entity, component_index});
+
+    if (offset_it == rec.offsets.end()) {
+        return nullptr;
+    }
+
+    return rec.data.data() + offset_it->second;
+}
+
+void snapshot_baseline::acknowledge(id_type id) {
+    auto rec_it = m_records.find(id);
+
+    if (rec_it == m_records.end()) {
+        return;
+    }
+
+    // Acknowledgements can arrive out of order.
+    for (auto &[key, offset] : rec_it->second.offsets) {
+        auto &acked_id = m_acknowledged[key];
+        acked_id = std::max(acked_id, id);
+    }
+}
+
+snapshot_baseline::id_type snapshot_baseline::find_acknowledged(entt::entity entity, component_index_type component_index) const {
+    auto it = m_acknowledged.find(key_type{entity, component_index});
+    return it != m_acknowledged.end() ? it->second : null_id;
+}
+
+void snapshot_baseline::erase_until(id_type id) {
+    m_records.erase(m_records.begin(), m_records.lower_bound(id));
+
+    for (auto it = m_acknowledged.begin(); it != m_acknowledged.end();) {
+        if (it->second < id) {
+            it = m_acknowledged.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+size_t snapshot_baseline::num_bytes() const {
+    // Approximate size of the links of a node of a `std::map`.
+    constexpr size_t node_overhead = 4 * sizeof(void *);
+    constexpr size_t offset_node_size = node_overhead + sizeof(std::pair<const key_type, size_t>);
+    size_t size = 0;
+
+    for (auto &[id, rec] : m_records) {
+        size += node_overhead + sizeof(std::pair<const id_type, record>);
+        size += rec.data.capacity() + rec.offsets.size() * offset_node_size;
+    }
+
+    size += m_acknowledged.size() * (node_overhead + sizeof(std::pair<const key_type, id_type>));
+
+    return size;
+}
+
+static void erase_empty_pools(packet::registry_snapshot &snap) {
+    snap.pools.erase(std::remove_if(snap.pools.begin(), snap.pools.end(), [](auto &&pool) {
+        return pool.ptr->empty();
+    }), snap.pools.end());
+}
+
+// Removes entities which are not referenced by any pool.
+static void erase_unused_entities(packet::registry_snapshot &snap) {
+    auto used = std::vector<bool>(snap.entities.size(), false);
+
+    for (auto &pool : snap.pools) {
+        for (auto idx : pool.ptr->entity_indices) {
+            used[idx] = true;
+        }
+    }
+
+    auto remap = std::vector<pool_snapshot_data::index_type>(snap.entities.size());
+    size_t count = 0;
+
+    for (size_t i = 0; i < snap.entities.size(); ++i) {
+        if (used[i]) {
+            remap[i] = static_cast<pool_snapshot_data::index_type>(count);
+            snap.entities[count++] = snap.entities[i];
+        }
+    }
+
+    if (count == snap.entities.size()) {
+        return;
+    }
+
+    snap.entities.resize(count);
+
+    for (auto &pool : snap.pools) {
+        for (auto &idx : pool.ptr->entity_indices) {
+            idx = remap[idx];
+        }
+    }
+}
+
+void snapshot_baseline::encode(packet::registry_snapshot &snap) const {
+    EDYN_ASSERT(snap.id != null_id);
+
+    for (auto &pool : snap.pools) {
+        pool.ptr->encode_deltas(*this, snap.id, snap.entities, pool.component_index);
+    }
+
+    erase_empty_pools(snap);
+    erase_unused_entities(snap);
+}
+
+bool snapshot_baseline::decode(packet::registry_snapshot &snap) const {
+    if (snap.id == null_id) {
+        return true;
+    }
+
+    auto success = true;
+
+    for (auto &pool : snap.pools) {
+        success &= pool.ptr->decode_deltas(*this, snap.id, snap.entities, pool.component_index);
+    }
+
+    erase_empty_pools(snap);
+
+    return success;
+}
+
+}
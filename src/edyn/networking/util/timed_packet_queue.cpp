@@ -0,0 +1,35 @@
+#include "edyn/networking/util/timed_packet_queue.hpp"
+#include <utility>
+
+namespace edyn {
+
+void timed_packet_queue::push(double timestamp, packet::edyn_packet &&packet) {
+    if (m_size == m_buffer.size()) {
+        grow();
+    }
+
+    // Move packets with a later timestamp one slot towards the back, starting
+    // from the back, and insert the new packet in the vacated slot.
+    auto index = m_size;
+
+    while (index > 0 && at(index - 1).timestamp > timestamp) {
+        at(index) = std::move(at(index - 1));
+        --index;
+    }
+
+    at(index) = timed_packet{timestamp, std::move(packet)};
+    ++m_size;
+}
+
+void timed_packet_queue::grow() {
+    auto buffer = std::vector<timed_packet>(m_buffer.empty() ? 16 : m_buffer.size() * 2);
+
+    for (size_t i = 0; i < m_size; ++i) {
+        buffer[i] = std::move(at(i));
+    }
+
+    m_buffer = std::move(buffer);
+    m_head = 0;
+}
+
+}
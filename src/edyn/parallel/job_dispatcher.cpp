@@ -1,45 +1,89 @@
 #include "edyn/parallel/job_dispatcher.hpp"
-#include "edyn/parallel/job_queue.hpp"
 #include "edyn/parallel/worker.hpp"
+#include "edyn/parallel/thread_affinity.hpp"
 #include "edyn/config/config.h"
+#include "edyn/time/time.hpp"
+#include "edyn/util/profiling.hpp"
 #include <cstdint>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#endif
 
 namespace edyn {
 
+// Hints the processor that this is a spin-wait loop, which saves power and
+// frees resources for the other hardware thread on the same core.
+static void cpu_pause() {
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    _mm_pause();
+#elif (defined(__aarch64__) || defined(__arm__)) && defined(__GNUC__)
+    asm volatile("yield");
+#endif
+}
+
+static thread_local job_dispatcher *bound_dispatcher = nullptr;
+
 job_dispatcher &job_dispatcher::global() {
     static job_dispatcher instance;
     return instance;
 }
 
+job_dispatcher &job_dispatcher::current() {
+    if (auto *w = worker::current()) {
+        return w->dispatcher();
+    }
+
+    return bound_dispatcher ? *bound_dispatcher : global();
+}
+
+void job_dispatcher::bind_current(job_dispatcher *dispatcher) {
+    bound_dispatcher = dispatcher;
+}
+
 job_dispatcher::~job_dispatcher() {
     stop();
 }
 
-void job_dispatcher::start(size_t num_worker_threads) {
+void job_dispatcher::start(size_t num_worker_threads, const worker_idle_policy &idle_policy,
+                           const std::vector<core_set> &worker_cores) {
     EDYN_ASSERT(num_worker_threads > 0);
     EDYN_ASSERT(m_workers.empty());
 
+    m_idle_policy = idle_policy;
+
+    // Create all workers before starting threads since workers access each
+    // other to steal jobs.
     for (size_t i = 0; i < num_worker_threads; ++i) {
-        auto w = std::make_unique<worker>();
-        auto t = std::make_unique<std::thread>(&worker::run, w.get());
-        auto id = t->get_id();
+        m_workers.push_back(std::make_unique<worker>(*this));
+    }
 
-        m_threads.push_back(std::move(t));
-        m_workers[id] = std::move(w);
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        auto cores = worker_cores.empty() ? core_set{} : worker_cores[i % worker_cores.size()];
+        m_threads.push_back(std::make_unique<std::thread>([w = m_workers[i].get(), cores = std::move(cores)]() {
+            // Pin before taking any job so no job runs on the wrong core.
+            set_current_thread_affinity(cores);
+            w->run();
+        }));
     }
 }
 
 void job_dispatcher::stop() {
-    for (auto &pair : m_workers) {
-        pair.second->stop();
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
     }
+    m_cv.notify_all();
 
+    // Workers finish all pending jobs before returning.
     for (auto &t : m_threads) {
         t->join();
     }
 
-    m_workers.clear();
     m_threads.clear();
+    m_workers.clear();
+    m_stopping = false;
 }
 
 bool job_dispatcher::running() const {
@@ -49,43 +93,168 @@ bool job_dispatcher::running() const {
 void job_dispatcher::async(const job &j) {
     EDYN_ASSERT(!m_workers.empty());
 
-    if (m_workers.size() == 1) {
-        m_workers.begin()->second->push_job(j);
-        return;
-    }
-
-    // Find least busy worker to insert job into. Start search from a different
-    // worker each time to create a better spread. This prevents the first
-    // worker from being prioritized and getting most jobs.
-    auto best_id = std::thread::id();
-    auto min_num_jobs = SIZE_MAX;
-    auto start = m_start.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
-    auto end = start + m_workers.size();
-
-    for (size_t i = start; i < end; ++i) {
-        auto k = i % m_workers.size();
-        auto first = m_workers.begin();
-        std::advance(first, k);
-        auto &pair = *first;
-
-        auto s = pair.second->size();
-        if (s == 0) {
-            pair.second->push_job(j);
-            return;
+    // Must be incremented before the job is visible to workers, otherwise
+    // it could go below zero when the job is taken.
+    m_num_pending.fetch_add(1, std::memory_order_seq_cst);
+
+    if (auto *w = worker::current(); w && &w->dispatcher() == this) {
+        w->push_local_job(j);
+    } else {
+        // Start from a different worker each time to create a better spread.
+        // Stealing balances the load afterwards.
+        auto idx = m_start.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+        m_workers[idx]->push_job(j);
+    }
+
+    // Sleeping workers increment the counter before checking for pending
+    // jobs, thus either they see the new job or it's seen here that they
+    // must be notified.
+    if (m_num_sleeping.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard lock(m_mutex);
+        m_cv.notify_one();
+    }
+}
+
+bool job_dispatcher::try_take_job(worker *w, job &j) {
+    auto found = w && w->try_pop(j);
+    size_t start = 0;
+
+    if (w) {
+        // Find the worker's index to start stealing from the next one, which
+        // spreads thieves among victims.
+        while (m_workers[start].get() != w) {
+            ++start;
         }
-        if (s < min_num_jobs) {
-            min_num_jobs = s;
-            best_id = pair.first;
+    } else {
+        start = m_start.load(std::memory_order_relaxed);
+    }
+
+    for (size_t i = 0; i < m_workers.size() && !found; ++i) {
+        auto &victim = m_workers[(start + i) % m_workers.size()];
+
+        if (victim.get() != w) {
+            found = victim->try_steal(j);
+
+            if (found && w) {
+                w->m_jobs_stolen.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    if (found) {
+        m_num_pending.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    return found;
+}
+
+bool job_dispatcher::run_pending_job() {
+    if (m_num_pending.load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+
+    auto *w = worker::current();
+
+    if (w && &w->dispatcher() != this) {
+        w = nullptr;
+    }
+
+    job j;
+
+    if (!try_take_job(w, j)) {
+        return false;
+    }
+
+    if (w) {
+        // Its duration is part of the busy time of the job that is waiting.
+        w->m_jobs_executed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    EDYN_PROFILE_ZONE("job");
+    j();
+    return true;
+}
+
+bool job_dispatcher::wait_for_jobs() {
+    if (m_idle_policy.spin_microseconds > 0 || m_idle_policy.yield_microseconds > 0) {
+        const auto spin_end = performance_time() + m_idle_policy.spin_microseconds * 1e-6;
+        const auto yield_end = spin_end + m_idle_policy.yield_microseconds * 1e-6;
+
+        while (!m_stopping.load(std::memory_order_relaxed)) {
+            if (m_num_pending.load(std::memory_order_relaxed) > 0) {
+                return true;
+            }
+
+            auto time = performance_time();
+
+            if (time < spin_end) {
+                // Pause a few times between reads of the clock.
+                for (int i = 0; i < 16; ++i) {
+                    cpu_pause();
+                }
+            } else if (time < yield_end) {
+                std::this_thread::yield();
+            } else {
+                break;
+            }
         }
     }
 
-    EDYN_ASSERT(m_workers.count(best_id));
+    std::unique_lock lock(m_mutex);
+    m_num_sleeping.fetch_add(1, std::memory_order_seq_cst);
+    m_cv.wait(lock, [&] {
+        return m_num_pending.load(std::memory_order_seq_cst) > 0 || m_stopping;
+    });
+    m_num_sleeping.fetch_sub(1, std::memory_order_relaxed);
 
-    m_workers[best_id]->push_job(j);
+    if (m_num_pending.load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+
+    // A job might still be on its way into a queue. Give way to the thread
+    // that is inserting it.
+    std::this_thread::yield();
+    return true;
 }
 
 size_t job_dispatcher::num_workers() const {
     return m_workers.size();
 }
 
+void job_dispatcher::set_collect_stats(bool collect) {
+    m_collect_stats.store(collect, std::memory_order_relaxed);
+}
+
+job_dispatcher_stats job_dispatcher::get_stats() const {
+    auto stats = job_dispatcher_stats{};
+
+    for (auto &w : m_workers) {
+        stats.workers.push_back(w->get_stats());
+    }
+
+    std::lock_guard lock(m_stats_mutex);
+    stats.task_wait = m_task_wait_stats;
+    return stats;
+}
+
+void job_dispatcher::reset_stats() {
+    for (auto &w : m_workers) {
+        w->reset_stats();
+    }
+
+    std::lock_guard lock(m_stats_mutex);
+    m_task_wait_stats = {};
+}
+
+void job_dispatcher::record_task_wait(const task_wait_call_stats &call) {
+    std::lock_guard lock(m_stats_mutex);
+    auto &stats = m_task_wait_stats;
+    ++stats.num_calls;
+    stats.num_chunks += call.num_chunks;
+    stats.duration += call.duration;
+    stats.wait_time += call.wait_time;
+    stats.max_wait_time = std::max(stats.max_wait_time, call.wait_time);
+    stats.last = call;
+}
+
 }
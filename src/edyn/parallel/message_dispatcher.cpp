@@ -1,4 +1,5 @@
 #include "edyn/parallel/message_dispatcher.hpp"
+#include <thread>
 
 namespace edyn {
 
@@ -7,4 +8,58 @@ message_dispatcher &message_dispatcher::global() {
     return instance;
 }
 
+message_dispatcher::~message_dispatcher() {
+    clear_queues();
+}
+
+void message_dispatcher::destroy_slot(uint32_t index) {
+    auto &slot = m_slots[index];
+    auto *queue = slot.queue.exchange(nullptr, std::memory_order_seq_cst);
+
+    if (!queue) {
+        return;
+    }
+
+    // Invalidate ids referring to this slot before it's reused.
+    slot.generation.fetch_add(1, std::memory_order_relaxed);
+
+    // Senders increment the counter before loading the queue, thus once it
+    // reaches zero, later senders will find no queue.
+    while (slot.num_senders.load(std::memory_order_acquire) > 0) {
+        std::this_thread::yield();
+    }
+
+    delete queue;
+    m_free_indices.push_back(index);
+}
+
+void message_dispatcher::destroy_queue(const message_queue_id &id) {
+    auto lock = std::lock_guard(m_queues_mutex);
+
+    if (!id.valid() || id.index >= m_num_slots ||
+        m_slots[id.index].generation.load(std::memory_order_relaxed) != id.generation) {
+        return;
+    }
+
+    for (auto it = m_names.begin(); it != m_names.end();) {
+        if (it->second == id) {
+            it = m_names.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    destroy_slot(id.index);
+}
+
+void message_dispatcher::clear_queues() {
+    auto lock = std::lock_guard(m_queues_mutex);
+
+    for (uint32_t i = 0; i < m_num_slots; ++i) {
+        destroy_slot(i);
+    }
+
+    m_names.clear();
+}
+
 }
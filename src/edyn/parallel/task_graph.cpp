@@ -0,0 +1,120 @@
+#include "edyn/parallel/task_graph.hpp"
+#include "edyn/parallel/job_dispatcher.hpp"
+#include "edyn/serialization/memory_archive.hpp"
+#include "edyn/config/config.h"
+#include "edyn/config/constants.hpp"
+#include <thread>
+
+namespace edyn {
+
+task_graph::task_id task_graph::add_task(const job &j) {
+    auto id = static_cast<task_id>(m_tasks.size());
+    m_tasks.push_back(task{j});
+    return id;
+}
+
+void task_graph::precede(task_id before, task_id after) {
+    EDYN_ASSERT(before < m_tasks.size() && after < m_tasks.size() && before != after);
+    m_tasks[before].successors.push_back(after);
+    ++m_tasks[after].num_predecessors;
+}
+
+void task_graph::clear() {
+    m_tasks.clear();
+    m_remaining.reset();
+}
+
+void task_graph::run_task_job(job::data_type &data) {
+    auto archive = memory_input_archive(data.data(), data.size());
+    intptr_t graph_ptr;
+    task_id id;
+    archive(graph_ptr);
+    archive(id);
+    auto *graph = reinterpret_cast<task_graph *>(graph_ptr);
+
+    auto j = graph->m_tasks[id].j;
+    j();
+
+    for (auto successor : graph->m_tasks[id].successors) {
+        if (graph->m_remaining[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            graph->dispatch(successor);
+        }
+    }
+
+    graph->finish_task();
+}
+
+void task_graph::dispatch(task_id id) {
+    auto j = job();
+    j.func = &task_graph::run_task_job;
+    auto archive = fixed_memory_output_archive(j.data.data(), j.data.size());
+    auto graph_ptr = reinterpret_cast<intptr_t>(this);
+    archive(graph_ptr);
+    archive(id);
+    m_dispatcher->async(j);
+}
+
+void task_graph::finish_task() {
+    auto prev = m_num_unfinished.fetch_sub(1, std::memory_order_acq_rel);
+    EDYN_ASSERT((prev & ~parked_bit) > 0);
+
+    // The graph can be destroyed as soon as `run` returns, thus it is not
+    // touched after the last task finishes unless `run` is parked, in which
+    // case it only returns once `m_done` is set under the lock.
+    if (prev == (parked_bit | 1)) {
+        std::lock_guard lock(m_mutex);
+        m_done = true;
+        m_cv.notify_one();
+    }
+}
+
+void task_graph::run(job_dispatcher &dispatcher) {
+    if (m_tasks.empty()) {
+        return;
+    }
+
+    m_dispatcher = &dispatcher;
+    m_done = false;
+    m_remaining = std::make_unique<std::atomic<uint32_t>[]>(m_tasks.size());
+
+    for (size_t i = 0; i < m_tasks.size(); ++i) {
+        m_remaining[i].store(m_tasks[i].num_predecessors, std::memory_order_relaxed);
+    }
+
+    m_num_unfinished.store(m_tasks.size(), std::memory_order_release);
+
+    auto num_roots = size_t{0};
+
+    for (task_id id = 0; id < m_tasks.size(); ++id) {
+        if (m_tasks[id].num_predecessors == 0) {
+            dispatch(id);
+            ++num_roots;
+        }
+    }
+
+    // A graph without roots has cycles and would never finish.
+    EDYN_ASSERT(num_roots > 0);
+
+    unsigned spin_count = 0;
+
+    // Run pending jobs in the meantime and spin for a while before parking.
+    while ((m_num_unfinished.load(std::memory_order_acquire) & ~parked_bit) > 0) {
+        if (dispatcher.run_pending_job()) {
+            spin_count = 0;
+        } else if (++spin_count > parallel_for_wait_spin_count) {
+            std::unique_lock lock(m_mutex);
+            auto prev = m_num_unfinished.fetch_or(parked_bit, std::memory_order_acq_rel);
+
+            if (prev != 0) {
+                m_cv.wait(lock, [&] { return m_done; });
+            }
+
+            m_num_unfinished.store(0, std::memory_order_relaxed);
+            break;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+}
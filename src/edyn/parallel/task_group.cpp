@@ -0,0 +1,111 @@
+#include "edyn/parallel/task_group.hpp"
+#include "edyn/parallel/job_dispatcher.hpp"
+#include "edyn/parallel/worker.hpp"
+#include "edyn/config/config.h"
+#include "edyn/config/constants.hpp"
+#include <entt/signal/delegate.hpp>
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+namespace edyn {
+
+namespace {
+
+// Each job carries its own sub-range, thus nothing is allocated per task.
+struct task_group_chunk {
+    task_group *group;
+    task_delegate_t task;
+    unsigned begin;
+    unsigned end;
+};
+
+static_assert(std::is_trivially_copyable_v<task_group_chunk>);
+static_assert(sizeof(task_group_chunk) <= job::data_size);
+
+}
+
+task_group::task_group(job_dispatcher &dispatcher)
+    : m_dispatcher(&dispatcher)
+{}
+
+task_group::~task_group() {
+    wait();
+}
+
+void task_group::run_chunk_job(job::data_type &data) {
+    task_group_chunk chunk;
+    std::memcpy(&chunk, data.data(), sizeof(chunk));
+    chunk.task(chunk.begin, chunk.end);
+    chunk.group->finish_job();
+}
+
+void task_group::run(task_delegate_t task, unsigned size) {
+    if (size == 0) {
+        return;
+    }
+
+    auto num_chunks = static_cast<unsigned>(std::min(m_dispatcher->num_workers() + 1, size_t{size}));
+    auto chunk_size = size / num_chunks;
+    auto remainder = size % num_chunks;
+
+    // Jobs must be counted before any of them can finish.
+    m_num_unfinished.fetch_add(num_chunks, std::memory_order_acq_rel);
+
+    auto child_job = job();
+    child_job.func = &task_group::run_chunk_job;
+    auto begin = 0u;
+
+    for (unsigned i = 0; i < num_chunks; ++i) {
+        auto end = begin + chunk_size + (i < remainder);
+        auto chunk = task_group_chunk{this, task, begin, end};
+        std::memcpy(child_job.data.data(), &chunk, sizeof(chunk));
+        m_dispatcher->async(child_job);
+        begin = end;
+    }
+
+    EDYN_ASSERT(begin == size);
+}
+
+void task_group::finish_job() {
+    auto prev = m_num_unfinished.fetch_sub(1, std::memory_order_acq_rel);
+    EDYN_ASSERT((prev & ~parked_bit) > 0);
+
+    // The group can be destroyed as soon as `wait` returns, thus it is not
+    // touched after the last job finishes unless `wait` is parked, in which
+    // case it only returns once `m_done` is set under the lock.
+    if (prev == (parked_bit | 1)) {
+        std::lock_guard lock(m_mutex);
+        m_done = true;
+        m_cv.notify_one();
+    }
+}
+
+void task_group::wait() {
+    const auto in_worker = worker::current() != nullptr;
+    unsigned spin_count = 0;
+
+    // Run pending jobs in the meantime. Only threads which aren't workers
+    // park after spinning for a while.
+    while ((m_num_unfinished.load(std::memory_order_acquire) & ~parked_bit) > 0) {
+        if (m_dispatcher->run_pending_job()) {
+            spin_count = 0;
+        } else if (!in_worker && ++spin_count > parallel_for_wait_spin_count) {
+            std::unique_lock lock(m_mutex);
+            auto prev = m_num_unfinished.fetch_or(parked_bit, std::memory_order_acq_rel);
+
+            if (prev != 0) {
+                m_cv.wait(lock, [&] { return m_done; });
+            }
+
+            m_num_unfinished.store(0, std::memory_order_relaxed);
+            m_done = false;
+            break;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+}
@@ -0,0 +1,34 @@
+#include "edyn/parallel/thread_affinity.hpp"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace edyn {
+
+bool set_current_thread_affinity(const core_set &cores) {
+    if (cores.empty()) {
+        return false;
+    }
+
+#if defined(__linux__)
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    auto any = false;
+
+    for (auto core : cores) {
+        if (core < CPU_SETSIZE) {
+            CPU_SET(core, &cpu_set);
+            any = true;
+        }
+    }
+
+    return any && pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+#else
+    // Other systems such as macOS do not allow pinning threads to cores.
+    return false;
+#endif
+}
+
+}
@@ -0,0 +1,38 @@
+#include "edyn/parallel/thread_affinity.hpp"
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+
+namespace edyn {
+
+bool set_current_thread_affinity(const core_set &cores) {
+    if (cores.empty()) {
+        return false;
+    }
+
+    // Machines with more than 64 logical processors split them into groups
+    // and a thread can only run on the processors of one group. The group of
+    // the first core is used and cores in other groups are ignored.
+    constexpr unsigned group_size = sizeof(KAFFINITY) * 8;
+    auto group = static_cast<WORD>(cores.front() / group_size);
+
+    if (group >= GetActiveProcessorGroupCount()) {
+        return false;
+    }
+
+    auto num_active = GetActiveProcessorCount(group);
+    GROUP_AFFINITY affinity {};
+    affinity.Group = group;
+
+    for (auto core : cores) {
+        if (core / group_size == group && core % group_size < num_active) {
+            affinity.Mask |= KAFFINITY{1} << (core % group_size);
+        }
+    }
+
+    return affinity.Mask != 0 && SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr) != 0;
+}
+
+}
@@ -0,0 +1,98 @@
+#include "edyn/parallel/work_stealing_deque.hpp"
+#include <cstring>
+#include <type_traits>
+
+namespace edyn {
+
+static_assert(std::is_trivially_copyable_v<job>);
+
+void work_stealing_deque::store(int64_t index, const job &j) {
+    uint64_t words[words_per_job];
+    std::memcpy(words, &j, sizeof(job));
+    auto &slot = m_slots[static_cast<size_t>(index) & (capacity - 1)];
+
+    for (size_t i = 0; i < words_per_job; ++i) {
+        slot[i].store(words[i], std::memory_order_relaxed);
+    }
+}
+
+job work_stealing_deque::load(int64_t index) const {
+    uint64_t words[words_per_job];
+    auto &slot = m_slots[static_cast<size_t>(index) & (capacity - 1)];
+
+    for (size_t i = 0; i < words_per_job; ++i) {
+        words[i] = slot[i].load(std::memory_order_relaxed);
+    }
+
+    job j;
+    std::memcpy(&j, words, sizeof(job));
+    return j;
+}
+
+bool work_stealing_deque::push(const job &j) {
+    auto b = m_bottom.load(std::memory_order_relaxed);
+    auto t = m_top.load(std::memory_order_acquire);
+
+    if (b - t >= static_cast<int64_t>(capacity)) {
+        return false;
+    }
+
+    store(b, j);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_bottom.store(b + 1, std::memory_order_relaxed);
+
+    return true;
+}
+
+bool work_stealing_deque::pop(job &j) {
+    auto b = m_bottom.load(std::memory_order_relaxed) - 1;
+    m_bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto t = m_top.load(std::memory_order_relaxed);
+
+    if (t > b) {
+        // Empty.
+        m_bottom.store(b + 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    j = load(b);
+
+    if (t == b) {
+        // Last job. Race against thieves for it.
+        auto won = m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                 std::memory_order_relaxed);
+        m_bottom.store(b + 1, std::memory_order_relaxed);
+        return won;
+    }
+
+    return true;
+}
+
+bool work_stealing_deque::steal(job &j) {
+    auto t = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto b = m_bottom.load(std::memory_order_acquire);
+
+    if (t >= b) {
+        return false;
+    }
+
+    auto stolen = load(t);
+
+    if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                       std::memory_order_relaxed)) {
+        return false;
+    }
+
+    j = stolen;
+    return true;
+}
+
+size_t work_stealing_deque::size() const {
+    auto b = m_bottom.load(std::memory_order_relaxed);
+    auto t = m_top.load(std::memory_order_relaxed);
+    return b > t ? static_cast<size_t>(b - t) : 0;
+}
+
+}
@@ -0,0 +1,120 @@
+#include "edyn/parallel/worker.hpp"
+#include "edyn/parallel/job_dispatcher.hpp"
+#include "edyn/config/config.h"
+#include "edyn/time/time.hpp"
+#include "edyn/util/profiling.hpp"
+
+namespace edyn {
+
+static thread_local worker *current_worker = nullptr;
+
+static uint64_t to_nanoseconds(double seconds) {
+    return static_cast<uint64_t>(seconds * 1e9);
+}
+
+worker::worker(job_dispatcher &dispatcher)
+    : m_dispatcher(&dispatcher)
+{}
+
+worker *worker::current() {
+    return current_worker;
+}
+
+void worker::push_job(const job &j) {
+    m_queue.push(j);
+
+    if (m_dispatcher->collecting_stats()) {
+        update_max_queue_depth();
+    }
+}
+
+void worker::push_local_job(const job &j) {
+    EDYN_ASSERT(current_worker == this);
+
+    // Overflow into the queue if the deque is full.
+    if (!m_deque.push(j)) {
+        m_queue.push(j);
+    }
+
+    if (m_dispatcher->collecting_stats()) {
+        update_max_queue_depth();
+    }
+}
+
+bool worker::try_pop(job &j) {
+    return m_deque.pop(j) || m_queue.try_pop(j);
+}
+
+bool worker::try_steal(job &j) {
+    return m_deque.steal(j) || m_queue.try_pop(j);
+}
+
+void worker::run() {
+    current_worker = this;
+    EDYN_PROFILE_THREAD_NAME("edyn worker");
+
+    for (;;) {
+        job j;
+
+        if (m_dispatcher->try_take_job(this, j)) {
+            EDYN_PROFILE_ZONE("job");
+            m_jobs_executed.fetch_add(1, std::memory_order_relaxed);
+
+            if (m_dispatcher->collecting_stats()) {
+                auto start = performance_time();
+                j();
+                m_busy_time.fetch_add(to_nanoseconds(performance_time() - start), std::memory_order_relaxed);
+            } else {
+                j();
+            }
+
+            continue;
+        }
+
+        auto collect_stats = m_dispatcher->collecting_stats();
+        auto idle_start = collect_stats ? performance_time() : 0;
+        auto has_jobs = m_dispatcher->wait_for_jobs();
+
+        if (collect_stats) {
+            m_idle_time.fetch_add(to_nanoseconds(performance_time() - idle_start), std::memory_order_relaxed);
+        }
+
+        if (!has_jobs) {
+            break;
+        }
+    }
+
+    current_worker = nullptr;
+}
+
+size_t worker::size() const {
+    return m_deque.size() + m_queue.size();
+}
+
+void worker::update_max_queue_depth() {
+    auto depth = size();
+    auto max_depth = m_max_queue_depth.load(std::memory_order_relaxed);
+
+    while (depth > max_depth &&
+           !m_max_queue_depth.compare_exchange_weak(max_depth, depth, std::memory_order_relaxed));
+}
+
+worker_stats worker::get_stats() const {
+    auto stats = worker_stats{};
+    stats.jobs_executed = m_jobs_executed.load(std::memory_order_relaxed);
+    stats.jobs_stolen = m_jobs_stolen.load(std::memory_order_relaxed);
+    stats.busy_time = m_busy_time.load(std::memory_order_relaxed) * 1e-9;
+    stats.idle_time = m_idle_time.load(std::memory_order_relaxed) * 1e-9;
+    stats.max_queue_depth = m_max_queue_depth.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void worker::reset_stats() {
+    m_jobs_executed.store(0, std::memory_order_relaxed);
+    m_jobs_stolen.store(0, std::memory_order_relaxed);
+    m_busy_time.store(0, std::memory_order_relaxed);
+    m_idle_time.store(0, std::memory_order_relaxed);
+    m_max_queue_depth.store(0, std::memory_order_relaxed);
+}
+
+}
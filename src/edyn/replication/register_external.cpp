@@ -20,8 +20,10 @@ void remove_external_components(entt::registry &registry) {
     }
 
     if (auto *ctx = registry.ctx().find<client_network_context>()) {
-        ctx->extrapolator->set_settings(settings);
-        ctx->extrapolator->set_registry_operation_context(reg_op_ctx);
+        for (auto &extrapolator : ctx->extrapolators) {
+            extrapolator->set_settings(settings);
+            extrapolator->set_registry_operation_context(reg_op_ctx);
+        }
     }
 }
 
@@ -0,0 +1,20 @@
+#include "edyn/replication/registry_operation.hpp"
+#include <atomic>
+
+namespace edyn {
+
+static std::atomic<size_t> registry_operation_allocated_bytes {0};
+
+size_t registry_operation::allocated_bytes() {
+    return registry_operation_allocated_bytes.load(std::memory_order_relaxed);
+}
+
+void registry_operation::track_allocation(size_t size) {
+    registry_operation_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void registry_operation::track_deallocation(size_t size) {
+    registry_operation_allocated_bytes.fetch_sub(size, std::memory_order_relaxed);
+}
+
+}
@@ -0,0 +1,57 @@
+#include "edyn/replication/registry_operation_pool.hpp"
+
+namespace edyn {
+
+registry_operation_pool &registry_operation_pool::global() {
+    static registry_operation_pool instance;
+    return instance;
+}
+
+registry_operation registry_operation_pool::acquire() {
+    // Pooled operations are shared by all worlds, thus they only hold memory
+    // of the default resource. Worlds with their own resource allocate new
+    // operations.
+    if (memory_resource::current() != memory_resource::new_delete()) {
+        return {};
+    }
+
+    auto lock = std::lock_guard(m_mutex);
+
+    if (m_operations.empty()) {
+        return {};
+    }
+
+    auto ops = std::move(m_operations.back());
+    m_operations.pop_back();
+
+    return ops;
+}
+
+void registry_operation_pool::release(registry_operation &&ops) {
+    // Destroy the operations outside of the lock.
+    ops.clear();
+
+    if (ops.data_blocks.empty() ||
+        ops.data_blocks.get_allocator().resource() != memory_resource::new_delete()) {
+        return;
+    }
+
+    auto lock = std::lock_guard(m_mutex);
+
+    if (m_operations.size() < max_pooled) {
+        m_operations.push_back(std::move(ops));
+    }
+}
+
+size_t registry_operation_pool::pooled_bytes() const {
+    auto lock = std::lock_guard(m_mutex);
+    size_t size = 0;
+
+    for (auto &ops : m_operations) {
+        size += ops.block_bytes();
+    }
+
+    return size;
+}
+
+}
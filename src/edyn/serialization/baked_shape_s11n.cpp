@@ -0,0 +1,201 @@
+#include "edyn/serialization/baked_shape_s11n.hpp"
+#include "edyn/serialization/mapped_archive.hpp"
+#include "edyn/serialization/mapped_file.hpp"
+#include "edyn/serialization/math_s11n.hpp"
+#include "edyn/serialization/triangle_mesh_s11n.hpp"
+#include <fstream>
+
+namespace edyn {
+
+template<typename Archive>
+void serialize(Archive &archive, baked_shape_header &header) {
+    archive(header.magic, header.version, header.scalar_size, header.alignment);
+    archive(header.kind, header.count);
+}
+
+// Unlike the regular serialization of a `convex_mesh`, which only stores the
+// input and recalculates everything else when loading, all members are
+// stored.
+template<typename Archive>
+static void serialize_baked(Archive &archive, convex_mesh &mesh) {
+    archive(mesh.vertices);
+    archive(mesh.indices);
+    archive(mesh.edges);
+    archive(mesh.faces);
+    archive(mesh.normals);
+    archive(mesh.edge_faces);
+    archive(mesh.relevant_faces);
+    archive(mesh.relevant_edges);
+    archive(mesh.neighbors_start);
+    archive(mesh.neighbor_indices);
+    archive(mesh.bounding_radius);
+}
+
+static baked_shape_header make_baked_shape_header(baked_shape_kind kind, size_t count) {
+    auto header = baked_shape_header{};
+    header.magic = baked_shape_magic;
+    header.version = baked_shape_version;
+    header.scalar_size = sizeof(scalar);
+    header.alignment = mapped_archive_alignment;
+    header.kind = static_cast<uint32_t>(kind);
+    header.count = static_cast<uint32_t>(count);
+    return header;
+}
+
+static bool read_baked_shape_header(mapped_input_archive &archive, baked_shape_kind kind,
+                                    baked_shape_header &header) {
+    archive(header);
+
+    return !archive.failed() &&
+        header.magic == baked_shape_magic &&
+        header.version == baked_shape_version &&
+        header.scalar_size == sizeof(scalar) &&
+        header.alignment == mapped_archive_alignment &&
+        header.kind == static_cast<uint32_t>(kind);
+}
+
+static bool write_baked_buffer(const std::string &path, const std::vector<uint8_t> &buffer) {
+    auto file = std::ofstream(path, std::ios::binary | std::ios::out);
+
+    if (!file.good()) {
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char *>(buffer.data()), buffer.size());
+    return file.good();
+}
+
+bool write_baked_triangle_mesh(const std::string &path, triangle_mesh &trimesh) {
+    // The header and the mesh are written by the same archive, thus the arrays
+    // are aligned relative to the start of the file, which is where it's
+    // mapped into memory.
+    auto buffer = std::vector<uint8_t>{};
+    auto archive = mapped_output_archive(buffer);
+    auto header = make_baked_shape_header(baked_shape_kind::triangle_mesh, 1);
+    archive(header);
+    archive(trimesh);
+
+    return write_baked_buffer(path, buffer);
+}
+
+std::shared_ptr<triangle_mesh> load_baked_triangle_mesh(const std::string &path) {
+    auto file = mapped_file{};
+
+    if (!file.open(path)) {
+        return {};
+    }
+
+    auto archive = mapped_input_archive(file.data(), file.size());
+    auto header = baked_shape_header{};
+
+    if (!read_baked_shape_header(archive, baked_shape_kind::triangle_mesh, header)) {
+        return {};
+    }
+
+    auto trimesh = std::make_shared<triangle_mesh>();
+    archive(*trimesh);
+
+    if (archive.failed()) {
+        return {};
+    }
+
+    return trimesh;
+}
+
+std::shared_ptr<triangle_mesh> view_baked_triangle_mesh(const uint8_t *data, size_t size,
+                                                        std::shared_ptr<const void> owner) {
+    auto archive = mapped_input_archive(data, size, true);
+    auto header = baked_shape_header{};
+
+    if (!read_baked_shape_header(archive, baked_shape_kind::triangle_mesh, header)) {
+        return {};
+    }
+
+    // The deleter holds the owner of the data, which thus lives as long as
+    // the mesh is referenced.
+    auto trimesh = std::shared_ptr<triangle_mesh>(new triangle_mesh, [owner = std::move(owner)](triangle_mesh *mesh) {
+        delete mesh;
+    });
+    archive(*trimesh);
+
+    if (archive.failed()) {
+        return {};
+    }
+
+    return trimesh;
+}
+
+std::shared_ptr<triangle_mesh> map_baked_triangle_mesh(const std::string &path) {
+    auto file = std::make_shared<mapped_file>();
+
+    if (!file->open(path)) {
+        return {};
+    }
+
+    return view_baked_triangle_mesh(file->data(), file->size(), file);
+}
+
+bool write_baked_convex_polyhedrons(const std::string &path,
+                                    std::vector<polyhedron_with_center> &polyhedrons) {
+    auto buffer = std::vector<uint8_t>{};
+    auto archive = mapped_output_archive(buffer);
+    auto header = make_baked_shape_header(baked_shape_kind::convex_polyhedrons, polyhedrons.size());
+    archive(header);
+
+    for (auto &poly : polyhedrons) {
+        EDYN_ASSERT(poly.shape.mesh);
+        archive(poly.center);
+        serialize_baked(archive, *poly.shape.mesh);
+    }
+
+    return write_baked_buffer(path, buffer);
+}
+
+std::vector<polyhedron_with_center> load_baked_convex_polyhedrons(const std::string &path) {
+    auto file = mapped_file{};
+
+    if (!file.open(path)) {
+        return {};
+    }
+
+    auto archive = mapped_input_archive(file.data(), file.size());
+    auto header = baked_shape_header{};
+
+    // Each polyhedron takes far more than a byte, which rejects corrupt counts.
+    if (!read_baked_shape_header(archive, baked_shape_kind::convex_polyhedrons, header) ||
+        header.count > archive.remaining_size()) {
+        return {};
+    }
+
+    auto polyhedrons = std::vector<polyhedron_with_center>(header.count);
+
+    for (auto &poly : polyhedrons) {
+        poly.shape.mesh = std::make_shared<convex_mesh>();
+        archive(poly.center);
+        serialize_baked(archive, *poly.shape.mesh);
+
+        if (archive.failed()) {
+            return {};
+        }
+    }
+
+    return polyhedrons;
+}
+
+compound_shape load_baked_compound_shape(const std::string &path) {
+    auto polyhedrons = load_baked_convex_polyhedrons(path);
+    auto compound = compound_shape{};
+
+    if (polyhedrons.empty()) {
+        return compound;
+    }
+
+    for (auto &poly : polyhedrons) {
+        compound.add_shape(poly.shape, poly.center, quaternion_identity);
+    }
+
+    compound.finish();
+    return compound;
+}
+
+}
@@ -0,0 +1,212 @@
+#include "edyn/serialization/paged_triangle_mesh_mapped_s11n.hpp"
+#include "edyn/serialization/mapped_archive.hpp"
+#include "edyn/serialization/triangle_mesh_s11n.hpp"
+#include "edyn/serialization/static_tree_s11n.hpp"
+#include "edyn/serialization/math_s11n.hpp"
+#include "edyn/shapes/triangle_mesh.hpp"
+#include <entt/signal/delegate.hpp>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <memory>
+
+namespace edyn {
+
+template<typename Archive>
+void serialize(Archive &archive, mapped_paged_triangle_mesh_header &header) {
+    archive(header.magic, header.version, header.scalar_size, header.alignment);
+    archive(header.num_pages, header.mesh_offset, header.mesh_size);
+}
+
+template<typename Archive>
+void serialize(Archive &archive, mapped_paged_triangle_mesh_page &page) {
+    archive(page.offset, page.size);
+}
+
+static void pad_to_alignment(std::vector<uint8_t> &buffer) {
+    buffer.resize(detail::mapped_archive_align(buffer.size()));
+}
+
+bool write_mapped_paged_triangle_mesh(const std::string &path, paged_triangle_mesh &paged_tri_mesh) {
+    auto num_pages = paged_tri_mesh.m_cache.size();
+
+    // Data of the paged triangle mesh itself.
+    auto mesh_buffer = std::vector<uint8_t>{};
+    {
+        auto archive = mapped_output_archive(mesh_buffer);
+        archive(paged_tri_mesh.m_thickness);
+        archive(paged_tri_mesh.m_tree);
+
+        for (auto &entry : paged_tri_mesh.m_cache) {
+            uint64_t num_vertices = entry.num_vertices;
+            uint64_t num_indices = entry.num_indices;
+            archive(num_vertices, num_indices);
+        }
+    }
+    pad_to_alignment(mesh_buffer);
+
+    auto header = mapped_paged_triangle_mesh_header{};
+    header.magic = mapped_paged_triangle_mesh_magic;
+    header.version = mapped_paged_triangle_mesh_version;
+    header.scalar_size = sizeof(scalar);
+    header.alignment = mapped_archive_alignment;
+    header.num_pages = num_pages;
+
+    auto header_size = sizeof(uint32_t) * 4 + sizeof(uint64_t) * 3 +
+                       num_pages * sizeof(uint64_t) * 2;
+    header.mesh_offset = detail::mapped_archive_align(header_size);
+    header.mesh_size = mesh_buffer.size();
+
+    // Write each submesh into its own aligned region and record where it is.
+    auto pages = std::vector<mapped_paged_triangle_mesh_page>(num_pages);
+    auto page_buffer = std::vector<uint8_t>{};
+    auto offset = header.mesh_offset + header.mesh_size;
+
+    auto file = std::ofstream(path, std::ios::binary | std::ios::out);
+
+    if (!file.good()) {
+        return false;
+    }
+
+    // The header is written once the location of all pages is known.
+    file.seekp(offset);
+
+    for (size_t i = 0; i < num_pages; ++i) {
+        auto trimesh = paged_tri_mesh.m_cache[i].trimesh;
+        EDYN_ASSERT(trimesh);
+
+        page_buffer.clear();
+        auto archive = mapped_output_archive(page_buffer);
+        archive(*trimesh);
+        auto size = page_buffer.size();
+        pad_to_alignment(page_buffer);
+
+        pages[i] = {offset, size};
+        file.write(reinterpret_cast<const char *>(page_buffer.data()), page_buffer.size());
+        offset += page_buffer.size();
+    }
+
+    auto header_buffer = std::vector<uint8_t>{};
+    {
+        auto archive = mapped_output_archive(header_buffer);
+        archive(header);
+
+        for (auto &page : pages) {
+            archive(page);
+        }
+    }
+    EDYN_ASSERT(header_buffer.size() == header_size);
+    pad_to_alignment(header_buffer);
+
+    file.seekp(0);
+    file.write(reinterpret_cast<const char *>(header_buffer.data()), header_buffer.size());
+    file.write(reinterpret_cast<const char *>(mesh_buffer.data()), mesh_buffer.size());
+
+    return file.good();
+}
+
+paged_triangle_mesh_mapped_input_archive::paged_triangle_mesh_mapped_input_archive(
+    const std::string &path, enqueue_task_t *enqueue_task)
+    : m_enqueue_task(enqueue_task)
+{
+    if (!m_file.open(path)) {
+        return;
+    }
+
+    auto archive = mapped_input_archive(m_file.data(), m_file.size());
+    auto header = mapped_paged_triangle_mesh_header{};
+    archive(header);
+
+    if (archive.failed() ||
+        header.magic != mapped_paged_triangle_mesh_magic ||
+        header.version != mapped_paged_triangle_mesh_version ||
+        header.scalar_size != sizeof(scalar) ||
+        header.alignment != mapped_archive_alignment ||
+        header.num_pages > m_file.size() / (sizeof(uint64_t) * 2)) {
+        return;
+    }
+
+    m_pages.resize(header.num_pages);
+
+    for (auto &page : m_pages) {
+        archive(page);
+
+        if (page.offset > m_file.size() || page.size > m_file.size() - page.offset) {
+            return;
+        }
+    }
+
+    if (archive.failed() || header.mesh_offset > m_file.size() ||
+        header.mesh_size > m_file.size() - header.mesh_offset) {
+        return;
+    }
+
+    m_mesh_offset = header.mesh_offset;
+    m_mesh_size = header.mesh_size;
+    m_valid = true;
+}
+
+void serialize(paged_triangle_mesh_mapped_input_archive &archive,
+               paged_triangle_mesh &paged_tri_mesh) {
+    EDYN_ASSERT(archive.is_valid());
+    EDYN_ASSERT(&paged_tri_mesh.get_page_loader() == &archive);
+
+    auto input = mapped_input_archive(archive.m_file.data() + archive.m_mesh_offset, archive.m_mesh_size);
+    input(paged_tri_mesh.m_thickness);
+    input(paged_tri_mesh.m_tree);
+
+    auto num_submeshes = archive.m_pages.size();
+    paged_tri_mesh.m_cache.resize(num_submeshes);
+
+    for (auto &entry : paged_tri_mesh.m_cache) {
+        uint64_t num_vertices {}, num_indices {};
+        input(num_vertices, num_indices);
+        entry.num_vertices = num_vertices;
+        entry.num_indices = num_indices;
+    }
+
+    EDYN_ASSERT(!input.failed());
+
+    paged_tri_mesh.init_cache();
+}
+
+/**
+ * Task used to load a submesh from the mapped file in the background.
+ */
+struct load_mapped_mesh_context {
+    const paged_triangle_mesh_mapped_input_archive *input;
+    paged_triangle_mesh *trimesh;
+    size_t index;
+
+    void load(unsigned start, unsigned end) {
+        input->load_page(trimesh, index);
+    }
+
+    void completion() {
+        delete this;
+    }
+};
+
+void paged_triangle_mesh_mapped_input_archive::load(paged_triangle_mesh *trimesh, size_t index) {
+    EDYN_ASSERT(m_valid && index < m_pages.size());
+
+    if (m_enqueue_task) {
+        auto *context = new load_mapped_mesh_context{this, trimesh, index};
+        auto task = task_delegate_t(entt::connect_arg_t<&load_mapped_mesh_context::load>{}, *context);
+        auto completion = task_completion_delegate_t(entt::connect_arg_t<&load_mapped_mesh_context::completion>{}, *context);
+        (*m_enqueue_task)(task, 1, completion);
+    } else {
+        load_page(trimesh, index);
+    }
+}
+
+void paged_triangle_mesh_mapped_input_archive::load_page(paged_triangle_mesh *trimesh, size_t index) const {
+    auto &page = m_pages[index];
+    auto input = mapped_input_archive(m_file.data() + page.offset, page.size);
+    auto mesh = std::make_shared<triangle_mesh>();
+    input(*mesh);
+    EDYN_ASSERT(!input.failed());
+    trimesh->assign_mesh(index, mesh);
+}
+
+}
@@ -0,0 +1,717 @@
+#include "edyn/serialization/world_s11n.hpp"
+#include "edyn/serialization/mapped_archive.hpp"
+#include "edyn/serialization/mapped_file.hpp"
+#include "edyn/serialization/math_s11n.hpp"
+#include "edyn/serialization/entt_s11n.hpp"
+#include "edyn/serialization/static_tree_s11n.hpp"
+#include "edyn/serialization/triangle_mesh_s11n.hpp"
+#include "edyn/collision/contact_manifold.hpp"
+#include "edyn/comp/aabb.hpp"
+#include "edyn/comp/position.hpp"
+#include "edyn/comp/orientation.hpp"
+#include "edyn/comp/linvel.hpp"
+#include "edyn/comp/angvel.hpp"
+#include "edyn/comp/mass.hpp"
+#include "edyn/comp/inertia.hpp"
+#include "edyn/comp/center_of_mass.hpp"
+#include "edyn/comp/origin.hpp"
+#include "edyn/comp/gravity.hpp"
+#include "edyn/comp/material.hpp"
+#include "edyn/comp/present_position.hpp"
+#include "edyn/comp/present_orientation.hpp"
+#include "edyn/comp/roll_direction.hpp"
+#include "edyn/comp/collision_filter.hpp"
+#include "edyn/comp/collision_exclusion.hpp"
+#include "edyn/comp/child_list.hpp"
+#include "edyn/comp/graph_node.hpp"
+#include "edyn/comp/island.hpp"
+#include "edyn/comp/tag.hpp"
+#include "edyn/constraints/constraint.hpp"
+#include "edyn/constraints/null_constraint.hpp"
+#include "edyn/constraints/breakable_constraint.hpp"
+#include "edyn/core/entity_graph.hpp"
+#include "edyn/networking/util/import_contact_manifolds.hpp"
+#include "edyn/replication/entity_map.hpp"
+#include "edyn/replication/map_child_entity.hpp"
+#include "edyn/shapes/shapes.hpp"
+#include "edyn/shapes/shape_asset_cache.hpp"
+#include "edyn/util/constraint_util.hpp"
+#include <entt/entity/registry.hpp>
+#include <fstream>
+#include <memory>
+#include <unordered_map>
+
+namespace edyn {
+
+// Components stored for each rigid body, in the order they're assigned by
+// `make_rigidbody`, which is also the order they're assigned on load so
+// observers see the same sequence. Entity graph nodes, island residents and
+// the `rigidbody_tag` are assigned after all of these. Changing this list
+// requires a new `world_save_version`.
+using world_body_components_t = std::tuple<
+    position, orientation,
+    mass, mass_inv, inertia, inertia_inv, inertia_world_inv,
+    linvel, angvel,
+    center_of_mass, origin, gravity, material,
+    present_position, present_orientation,
+    sphere_shape, cylinder_shape, capsule_shape, box_shape,
+    polyhedron_shape, compound_shape, plane_shape, mesh_shape,
+    shape_index, AABB, rolling_tag, roll_direction,
+    collision_filter, collision_exclusion,
+    dynamic_tag, procedural_tag, kinematic_tag, static_tag,
+    sleeping_disabled_tag, disabled_tag, ccd_tag, particle_tag, networked_tag,
+    sensor_tag, sensor_aabb_tag, contact_event_tag,
+    parent_comp, child_list
+>;
+
+// Contact constraints are not included since they're recreated along with
+// the contact manifolds.
+using world_constraint_components_t = std::tuple<
+    null_constraint,
+    gravity_constraint,
+    distance_constraint,
+    soft_distance_constraint,
+    hinge_constraint,
+    generic_constraint,
+    cvjoint_constraint,
+    cone_constraint,
+    point_constraint
+>;
+
+// Tags and settings of the saved constraints, assigned after all constraints
+// are created.
+using world_constraint_tags_t = std::tuple<
+    articulation_tag,
+    breakable_constraint
+>;
+
+using world_entity_index_map = std::unordered_map<entt::entity, uint32_t>;
+
+template<typename Component>
+struct world_pool {
+    // Indices of the entities in the entity array.
+    std::vector<uint32_t> indices;
+    std::vector<Component> components;
+};
+
+template<typename... Component>
+using world_pools_t = std::tuple<world_pool<Component>...>;
+
+template<typename Tuple>
+struct world_pools_of;
+
+template<typename... Component>
+struct world_pools_of<std::tuple<Component...>> {
+    using type = world_pools_t<Component...>;
+};
+
+/**
+ * Meshes shared by multiple shapes are stored once and shapes refer to them
+ * by index.
+ */
+struct world_mesh_table {
+    std::vector<std::shared_ptr<convex_mesh>> convex_meshes;
+    std::vector<std::shared_ptr<triangle_mesh>> triangle_meshes;
+    std::unordered_map<const convex_mesh *, uint32_t> convex_mesh_indices;
+    std::unordered_map<const triangle_mesh *, uint32_t> triangle_mesh_indices;
+    bool failed {false};
+
+    void insert(const std::shared_ptr<convex_mesh> &mesh) {
+        if (convex_mesh_indices.emplace(mesh.get(), convex_meshes.size()).second) {
+            convex_meshes.push_back(mesh);
+        }
+    }
+
+    void insert(const std::shared_ptr<triangle_mesh> &mesh) {
+        if (triangle_mesh_indices.emplace(mesh.get(), triangle_meshes.size()).second) {
+            triangle_meshes.push_back(mesh);
+        }
+    }
+
+    uint32_t index_of(const std::shared_ptr<convex_mesh> &mesh) const {
+        return convex_mesh_indices.at(mesh.get());
+    }
+
+    uint32_t index_of(const std::shared_ptr<triangle_mesh> &mesh) const {
+        return triangle_mesh_indices.at(mesh.get());
+    }
+
+    template<typename Mesh>
+    std::shared_ptr<Mesh> at(const std::vector<std::shared_ptr<Mesh>> &meshes, uint32_t index) {
+        if (index >= meshes.size()) {
+            failed = true;
+            return {};
+        }
+
+        return meshes[index];
+    }
+};
+
+struct world_save_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t scalar_size;
+    uint32_t alignment;
+    uint32_t num_body_pools;
+    uint32_t num_constraint_pools;
+};
+
+template<typename Archive>
+void serialize(Archive &archive, world_save_header &header) {
+    archive(header.magic, header.version, header.scalar_size, header.alignment);
+    archive(header.num_body_pools, header.num_constraint_pools);
+}
+
+// All properties are stored, including the calculated ones, so the mesh does
+// not have to be initialized again on load.
+template<typename Archive>
+static void serialize_convex_mesh(Archive &archive, convex_mesh &mesh) {
+    archive(mesh.vertices, mesh.indices, mesh.edges, mesh.faces, mesh.normals);
+    archive(mesh.edge_faces, mesh.relevant_faces, mesh.relevant_edges);
+    archive(mesh.neighbors_start, mesh.neighbor_indices, mesh.bounding_radius);
+}
+
+template<typename Shape>
+static void write_shape(mapped_output_archive &archive, Shape &shape, const world_mesh_table &) {
+    archive(shape);
+}
+
+static void write_shape(mapped_output_archive &archive, polyhedron_shape &shape, const world_mesh_table &meshes) {
+    auto index = meshes.index_of(shape.mesh);
+    archive(index);
+}
+
+template<typename Shape>
+static void read_shape(mapped_input_archive &archive, Shape &shape, world_mesh_table &) {
+    archive(shape);
+}
+
+static void read_shape(mapped_input_archive &archive, polyhedron_shape &shape, world_mesh_table &meshes) {
+    uint32_t index {};
+    archive(index);
+    shape.mesh = meshes.at(meshes.convex_meshes, index);
+}
+
+template<size_t Index = 0>
+static void read_node_shape(mapped_input_archive &archive, uint8_t id,
+                            compound_shape::shapes_variant_t &var, world_mesh_table &meshes) {
+    if constexpr(Index < std::variant_size_v<compound_shape::shapes_variant_t>) {
+        if (id == Index) {
+            auto shape = std::variant_alternative_t<Index, compound_shape::shapes_variant_t>{};
+            read_shape(archive, shape, meshes);
+            var = std::move(shape);
+        } else {
+            read_node_shape<Index + 1>(archive, id, var, meshes);
+        }
+    } else {
+        meshes.failed = true;
+    }
+}
+
+// Components are copied in bulk, except shapes which refer to meshes.
+template<typename Component>
+static void write_components(mapped_output_archive &archive, std::vector<Component> &components,
+                             const world_mesh_table &) {
+    archive(components);
+}
+
+template<typename Component>
+static void read_components(mapped_input_archive &archive, std::vector<Component> &components,
+                            world_mesh_table &) {
+    archive(components);
+}
+
+static void write_components(mapped_output_archive &archive, std::vector<polyhedron_shape> &components,
+                             const world_mesh_table &meshes) {
+    auto indices = std::vector<uint32_t>(components.size());
+
+    for (size_t i = 0; i < components.size(); ++i) {
+        indices[i] = meshes.index_of(components[i].mesh);
+    }
+
+    archive(indices);
+}
+
+static void read_components(mapped_input_archive &archive, std::vector<polyhedron_shape> &components,
+                            world_mesh_table &meshes) {
+    auto indices = std::vector<uint32_t>{};
+    archive(indices);
+    components.resize(indices.size());
+
+    for (size_t i = 0; i < indices.size(); ++i) {
+        components[i].mesh = meshes.at(meshes.convex_meshes, indices[i]);
+    }
+}
+
+static void write_components(mapped_output_archive &archive, std::vector<mesh_shape> &components,
+                             const world_mesh_table &meshes) {
+    auto indices = std::vector<uint32_t>(components.size());
+
+    for (size_t i = 0; i < components.size(); ++i) {
+        indices[i] = meshes.index_of(components[i].trimesh);
+    }
+
+    archive(indices);
+}
+
+static void read_components(mapped_input_archive &archive, std::vector<mesh_shape> &components,
+                            world_mesh_table &meshes) {
+    auto indices = std::vector<uint32_t>{};
+    archive(indices);
+    components.resize(indices.size());
+
+    for (size_t i = 0; i < indices.size(); ++i) {
+        components[i].trimesh = meshes.at(meshes.triangle_meshes, indices[i]);
+    }
+}
+
+// The tree of a compound is stored so it does not have to be built again.
+static void write_components(mapped_output_archive &archive, std::vector<compound_shape> &components,
+                             const world_mesh_table &meshes) {
+    for (auto &compound : components) {
+        auto num_nodes = static_cast<uint64_t>(compound.nodes.size());
+        archive(num_nodes);
+
+        for (auto &node : compound.nodes) {
+            auto id = static_cast<uint8_t>(node.shape_var.index());
+            archive(id, node.position, node.orientation, node.aabb);
+            std::visit([&](auto &&shape) {
+                write_shape(archive, shape, meshes);
+            }, node.shape_var);
+        }
+
+        archive(compound.tree);
+    }
+}
+
+static void read_components(mapped_input_archive &archive, std::vector<compound_shape> &components,
+                            world_mesh_table &meshes) {
+    for (auto &compound : components) {
+        uint64_t num_nodes {};
+        archive(num_nodes);
+
+        // Each node takes at least its id, position and orientation.
+        if (archive.failed() || num_nodes > archive.remaining_size() / (1 + sizeof(vector3) + sizeof(quaternion))) {
+            meshes.failed = true;
+            return;
+        }
+
+        compound.nodes.resize(num_nodes);
+
+        for (auto &node : compound.nodes) {
+            uint8_t id {};
+            archive(id, node.position, node.orientation, node.aabb);
+            read_node_shape(archive, id, node.shape_var, meshes);
+
+            if (archive.failed() || meshes.failed) {
+                return;
+            }
+        }
+
+        archive(compound.tree);
+    }
+}
+
+template<typename Component>
+static void write_pool(mapped_output_archive &archive, const entt::registry &registry,
+                       const world_entity_index_map &index_map, const world_mesh_table &meshes) {
+    auto pool = world_pool<Component>{};
+    auto view = registry.view<Component>();
+
+    for (auto entity : view) {
+        if (auto it = index_map.find(entity); it != index_map.end()) {
+            pool.indices.push_back(it->second);
+
+            if constexpr(!std::is_empty_v<Component>) {
+                pool.components.push_back(view.template get<Component>(entity));
+            }
+        }
+    }
+
+    archive(pool.indices);
+
+    if constexpr(!std::is_empty_v<Component>) {
+        write_components(archive, pool.components, meshes);
+    }
+}
+
+template<typename Component>
+static bool read_pool(mapped_input_archive &archive, world_pool<Component> &pool,
+                      world_mesh_table &meshes, size_t num_entities) {
+    archive(pool.indices);
+
+    if (archive.failed()) {
+        return false;
+    }
+
+    if constexpr(!std::is_empty_v<Component>) {
+        if constexpr(std::is_same_v<Component, compound_shape>) {
+            // Compounds are not stored as a vector, thus their count is
+            // implied by the number of indices.
+            pool.components.resize(pool.indices.size());
+        }
+
+        read_components(archive, pool.components, meshes);
+
+        if (pool.components.size() != pool.indices.size()) {
+            return false;
+        }
+    }
+
+    for (auto index : pool.indices) {
+        if (index >= num_entities) {
+            return false;
+        }
+    }
+
+    return !archive.failed() && !meshes.failed;
+}
+
+template<typename Component>
+static void insert_pool(entt::registry &registry, const entity_map &emap,
+                        world_pool<Component> &pool, const std::vector<entt::entity> &entities) {
+    if (pool.indices.empty()) {
+        return;
+    }
+
+    auto targets = std::vector<entt::entity>(pool.indices.size());
+
+    for (size_t i = 0; i < pool.indices.size(); ++i) {
+        targets[i] = entities[pool.indices[i]];
+    }
+
+    if constexpr(std::is_empty_v<Component>) {
+        registry.insert<Component>(targets.begin(), targets.end());
+    } else {
+        if (entt::resolve<Component>()) {
+            for (auto &comp : pool.components) {
+                internal::map_child_entity(registry, emap, comp);
+            }
+        }
+
+        registry.insert<Component>(targets.begin(), targets.end(), pool.components.begin());
+    }
+}
+
+template<typename Constraint>
+static void make_constraints(entt::registry &registry, const entity_map &emap,
+                             world_pool<Constraint> &pool, const std::vector<entt::entity> &entities) {
+    for (size_t i = 0; i < pool.indices.size(); ++i) {
+        auto entity = entities[pool.indices[i]];
+        auto &con = pool.components[i];
+        internal::map_child_entity(registry, emap, con);
+        internal::pre_make_constraint(registry, entity, con.body[0], con.body[1]);
+        registry.emplace<Constraint>(entity, con);
+    }
+}
+
+static bool is_saved_body(const entt::registry &registry, entt::entity entity) {
+    return registry.all_of<rigidbody_tag>(entity) &&
+           !registry.any_of<paged_mesh_shape, heightfield_shape>(entity);
+}
+
+void save_world(const entt::registry &registry, std::vector<uint8_t> &buffer) {
+    auto body_entities = std::vector<entt::entity>{};
+    auto body_index_map = world_entity_index_map{};
+
+    for (auto entity : registry.view<rigidbody_tag>()) {
+        if (is_saved_body(registry, entity)) {
+            body_index_map.emplace(entity, body_entities.size());
+            body_entities.push_back(entity);
+        }
+    }
+
+    // Only constraints between saved bodies are included.
+    auto constraint_entities = std::vector<entt::entity>{};
+    auto constraint_index_map = world_entity_index_map{};
+
+    std::apply([&](auto ... c) {
+        ([&]() {
+            using Constraint = decltype(c);
+
+            for (auto [entity, con] : registry.view<Constraint>().each()) {
+                if (body_index_map.count(con.body[0]) && body_index_map.count(con.body[1]) &&
+                    constraint_index_map.emplace(entity, constraint_entities.size()).second) {
+                    constraint_entities.push_back(entity);
+                }
+            }
+        }(), ...);
+    }, world_constraint_components_t{});
+
+    // Collect shared meshes.
+    auto meshes = world_mesh_table{};
+
+    for (auto [entity, shape] : registry.view<polyhedron_shape>().each()) {
+        if (body_index_map.count(entity)) {
+            meshes.insert(shape.mesh);
+        }
+    }
+
+    for (auto [entity, shape] : registry.view<compound_shape>().each()) {
+        if (body_index_map.count(entity)) {
+            for (auto &node : shape.nodes) {
+                if (std::holds_alternative<polyhedron_shape>(node.shape_var)) {
+                    meshes.insert(std::get<polyhedron_shape>(node.shape_var).mesh);
+                }
+            }
+        }
+    }
+
+    for (auto [entity, shape] : registry.view<mesh_shape>().each()) {
+        if (body_index_map.count(entity)) {
+            meshes.insert(shape.trimesh);
+        }
+    }
+
+    // Write into a separate buffer since alignment is relative to the start.
+    auto data = std::vector<uint8_t>{};
+    auto archive = mapped_output_archive(data);
+
+    auto header = world_save_header{};
+    header.magic = world_save_magic;
+    header.version = world_save_version;
+    header.scalar_size = sizeof(scalar);
+    header.alignment = mapped_archive_alignment;
+    header.num_body_pools = std::tuple_size_v<world_body_components_t>;
+    header.num_constraint_pools = std::tuple_size_v<world_constraint_components_t> +
+                                  std::tuple_size_v<world_constraint_tags_t>;
+    archive(header);
+
+    archive(body_entities, constraint_entities);
+
+    auto num_convex_meshes = static_cast<uint64_t>(meshes.convex_meshes.size());
+    archive(num_convex_meshes);
+
+    for (auto &mesh : meshes.convex_meshes) {
+        serialize_convex_mesh(archive, *mesh);
+    }
+
+    auto num_triangle_meshes = static_cast<uint64_t>(meshes.triangle_meshes.size());
+    archive(num_triangle_meshes);
+
+    for (auto &mesh : meshes.triangle_meshes) {
+        archive(*mesh);
+    }
+
+    std::apply([&](auto ... c) {
+        (write_pool<decltype(c)>(archive, registry, body_index_map, meshes), ...);
+    }, world_body_components_t{});
+
+    std::apply([&](auto ... c) {
+        (write_pool<decltype(c)>(archive, registry, constraint_index_map, meshes), ...);
+    }, world_constraint_components_t{});
+
+    std::apply([&](auto ... c) {
+        (write_pool<decltype(c)>(archive, registry, constraint_index_map, meshes), ...);
+    }, world_constraint_tags_t{});
+
+    auto manifolds = std::vector<contact_manifold>{};
+
+    for (auto [entity, manifold] : registry.view<contact_manifold>().each()) {
+        if (body_index_map.count(manifold.body[0]) && body_index_map.count(manifold.body[1])) {
+            manifolds.push_back(manifold);
+        }
+    }
+
+    archive(manifolds);
+
+    buffer.insert(buffer.end(), data.begin(), data.end());
+}
+
+bool save_world(const entt::registry &registry, const std::string &path) {
+    auto buffer = std::vector<uint8_t>{};
+    save_world(registry, buffer);
+
+    auto file = std::ofstream(path, std::ios::binary | std::ios::out);
+
+    if (!file.good()) {
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char *>(buffer.data()), buffer.size());
+
+    return file.good();
+}
+
+bool load_world(entt::registry &registry, const uint8_t *data, size_t size,
+                std::vector<entt::entity> *entities, entity_map *saved_entities) {
+    auto archive = mapped_input_archive(data, size);
+    auto header = world_save_header{};
+    archive(header);
+
+    if (archive.failed() ||
+        header.magic != world_save_magic ||
+        header.version != world_save_version ||
+        header.scalar_size != sizeof(scalar) ||
+        header.alignment != mapped_archive_alignment ||
+        header.num_body_pools != std::tuple_size_v<world_body_components_t> ||
+        header.num_constraint_pools != std::tuple_size_v<world_constraint_components_t> +
+                                       std::tuple_size_v<world_constraint_tags_t>) {
+        return false;
+    }
+
+    // Read everything before creating anything so that nothing is created if
+    // the data is invalid.
+    auto saved_body_entities = std::vector<entt::entity>{};
+    auto saved_constraint_entities = std::vector<entt::entity>{};
+    archive(saved_body_entities, saved_constraint_entities);
+
+    if (archive.failed()) {
+        return false;
+    }
+
+    auto meshes = world_mesh_table{};
+    uint64_t num_convex_meshes {};
+    archive(num_convex_meshes);
+
+    // Each mesh takes at least the sizes of its vectors.
+    if (archive.failed() || num_convex_meshes > archive.remaining_size() / sizeof(uint64_t)) {
+        return false;
+    }
+
+    // Meshes are shared with identical meshes already in use, e.g. when the
+    // same world is loaded multiple times.
+    auto &cache = shape_asset_cache::global();
+    meshes.convex_meshes.resize(num_convex_meshes);
+
+    for (auto &mesh : meshes.convex_meshes) {
+        mesh = std::make_shared<convex_mesh>();
+        serialize_convex_mesh(archive, *mesh);
+
+        if (!archive.failed()) {
+            mesh = cache.share(mesh);
+        }
+    }
+
+    uint64_t num_triangle_meshes {};
+    archive(num_triangle_meshes);
+
+    if (archive.failed() || num_triangle_meshes > archive.remaining_size() / sizeof(uint64_t)) {
+        return false;
+    }
+
+    meshes.triangle_meshes.resize(num_triangle_meshes);
+
+    for (auto &mesh : meshes.triangle_meshes) {
+        mesh = std::make_shared<triangle_mesh>();
+        archive(*mesh);
+
+        if (!archive.failed()) {
+            mesh = cache.share(mesh);
+        }
+    }
+
+    if (archive.failed()) {
+        return false;
+    }
+
+    auto body_pools = world_pools_of<world_body_components_t>::type{};
+    auto constraint_pools = world_pools_of<world_constraint_components_t>::type{};
+    auto constraint_tag_pools = world_pools_of<world_constraint_tags_t>::type{};
+
+    auto valid = std::apply([&](auto &... pool) {
+        return (read_pool(archive, pool, meshes, saved_body_entities.size()) && ...);
+    }, body_pools);
+
+    valid = valid && std::apply([&](auto &... pool) {
+        return (read_pool(archive, pool, meshes, saved_constraint_entities.size()) && ...);
+    }, constraint_pools);
+
+    valid = valid && std::apply([&](auto &... pool) {
+        return (read_pool(archive, pool, meshes, saved_constraint_entities.size()) && ...);
+    }, constraint_tag_pools);
+
+    if (!valid) {
+        return false;
+    }
+
+    auto manifolds = std::vector<contact_manifold>{};
+    archive(manifolds);
+
+    if (archive.failed()) {
+        return false;
+    }
+
+    // Create all entities at once.
+    auto body_entities = std::vector<entt::entity>(saved_body_entities.size());
+    auto constraint_entities = std::vector<entt::entity>(saved_constraint_entities.size());
+    registry.create(body_entities.begin(), body_entities.end());
+    registry.create(constraint_entities.begin(), constraint_entities.end());
+
+    auto emap = entity_map{};
+
+    for (size_t i = 0; i < body_entities.size(); ++i) {
+        emap.insert(saved_body_entities[i], body_entities[i]);
+    }
+
+    for (size_t i = 0; i < constraint_entities.size(); ++i) {
+        emap.insert(saved_constraint_entities[i], constraint_entities[i]);
+    }
+
+    std::apply([&](auto &... pool) {
+        (insert_pool(registry, emap, pool, body_entities), ...);
+    }, body_pools);
+
+    // Insert rigid bodies as nodes in the entity graph, as in `make_rigidbody`.
+    auto &graph = registry.ctx().get<entity_graph>();
+    auto is_dynamic = std::vector<bool>(body_entities.size(), false);
+
+    for (auto index : std::get<world_pool<dynamic_tag>>(body_pools).indices) {
+        is_dynamic[index] = true;
+    }
+
+    auto nodes = std::vector<graph_node>(body_entities.size());
+    auto dynamic_entities = std::vector<entt::entity>{};
+    auto non_dynamic_entities = std::vector<entt::entity>{};
+
+    for (size_t i = 0; i < body_entities.size(); ++i) {
+        nodes[i].node_index = graph.insert_node(body_entities[i], !is_dynamic[i]);
+
+        if (is_dynamic[i]) {
+            dynamic_entities.push_back(body_entities[i]);
+        } else {
+            non_dynamic_entities.push_back(body_entities[i]);
+        }
+    }
+
+    registry.insert<graph_node>(body_entities.begin(), body_entities.end(), nodes.begin());
+    registry.insert<island_resident>(dynamic_entities.begin(), dynamic_entities.end());
+    registry.insert<multi_island_resident>(non_dynamic_entities.begin(), non_dynamic_entities.end());
+
+    // Always do this last to signal the completion of the construction of the
+    // rigid bodies.
+    registry.insert<rigidbody_tag>(body_entities.begin(), body_entities.end());
+
+    std::apply([&](auto &... pool) {
+        (make_constraints(registry, emap, pool, constraint_entities), ...);
+    }, constraint_pools);
+
+    std::apply([&](auto &... pool) {
+        (insert_pool(registry, emap, pool, constraint_entities), ...);
+    }, constraint_tag_pools);
+
+    import_contact_manifolds(registry, emap, manifolds);
+
+    if (saved_entities) {
+        *saved_entities = std::move(emap);
+    }
+
+    if (entities) {
+        *entities = std::move(body_entities);
+    }
+
+    return true;
+}
+
+bool load_world(entt::registry &registry, const std::string &path,
+                std::vector<entt::entity> *entities, entity_map *saved_entities) {
+    auto file = mapped_file{};
+
+    if (!file.open(path)) {
+        return false;
+    }
+
+    return load_world(registry, file.data(), file.size(), entities, saved_entities);
+}
+
+}
@@ -19,6 +19,7 @@ void convex_mesh::update_calculated_properties() {
     calculate_neighbors();
     calculate_relevant_faces();
     calculate_relevant_edges();
+    calculate_bounding_radius();
 }
 
 void convex_mesh::shift_to_centroid() {
@@ -215,6 +216,16 @@ void convex_mesh::calculate_relevant_edges() {
     }
 }
 
+void convex_mesh::calculate_bounding_radius() {
+    auto radius_sqr = scalar(0);
+
+    for (auto &v : vertices) {
+        radius_sqr = std::max(radius_sqr, length_sqr(v));
+    }
+
+    bounding_radius = std::sqrt(radius_sqr);
+}
+
 bool convex_mesh::validate() const {
     // Check if all faces are flat.
     for (size_t i = 0; i < num_faces(); ++i) {
@@ -0,0 +1,220 @@
+#include "edyn/shapes/heightfield.hpp"
+#include <limits>
+
+namespace edyn {
+
+void heightfield::initialize(uint32_t num_columns, uint32_t num_rows, scalar cell_size,
+                             const vector3 &origin, uint32_t tile_size) {
+    EDYN_ASSERT(num_columns > 1 && num_rows > 1);
+    EDYN_ASSERT(m_heights.size() == size_t(num_columns) * num_rows);
+    EDYN_ASSERT(cell_size > 0);
+
+    m_num_columns = num_columns;
+    m_num_rows = num_rows;
+    m_cell_size = cell_size;
+    m_origin = origin;
+
+    auto [min_it, max_it] = std::minmax_element(m_heights.begin(), m_heights.end());
+    m_aabb.min = origin + vector3{0, *min_it, 0};
+    m_aabb.max = origin + vector3{(num_columns - 1) * cell_size, *max_it, (num_rows - 1) * cell_size};
+
+    m_tile_size = tile_size;
+    m_tile_min.clear();
+    m_tile_max.clear();
+
+    if (tile_size == 0) {
+        m_num_tile_columns = m_num_tile_rows = 0;
+        return;
+    }
+
+    const auto num_cells_x = num_columns - 1;
+    const auto num_cells_z = num_rows - 1;
+    m_num_tile_columns = (num_cells_x + tile_size - 1) / tile_size;
+    m_num_tile_rows = (num_cells_z + tile_size - 1) / tile_size;
+    m_tile_min.resize(m_num_tile_columns * m_num_tile_rows, std::numeric_limits<scalar>::max());
+    m_tile_max.resize(m_num_tile_columns * m_num_tile_rows, std::numeric_limits<scalar>::lowest());
+
+    // A sample on the border of a tile belongs to the cells of the tiles on
+    // both sides.
+    for (uint32_t row = 0; row < num_rows; ++row) {
+        auto first_tile_row = row == 0 ? 0 : (row - 1) / tile_size;
+        auto last_tile_row = std::min(row / tile_size, m_num_tile_rows - 1);
+
+        for (uint32_t column = 0; column < num_columns; ++column) {
+            auto height = origin.y + get_height(column, row);
+            auto first_tile_column = column == 0 ? 0 : (column - 1) / tile_size;
+            auto last_tile_column = std::min(column / tile_size, m_num_tile_columns - 1);
+
+            for (auto tile_row = first_tile_row; tile_row <= last_tile_row; ++tile_row) {
+                for (auto tile_column = first_tile_column; tile_column <= last_tile_column; ++tile_column) {
+                    auto tile_idx = tile_row * m_num_tile_columns + tile_column;
+                    m_tile_min[tile_idx] = std::min(m_tile_min[tile_idx], height);
+                    m_tile_max[tile_idx] = std::max(m_tile_max[tile_idx], height);
+                }
+            }
+        }
+    }
+}
+
+triangle_vertices heightfield::get_cell_triangle_vertices(uint32_t column, uint32_t row, uint32_t k) const {
+    EDYN_ASSERT(column + 1 < m_num_columns && row + 1 < m_num_rows && k < 2);
+    auto v00 = get_vertex_position(column, row);
+    auto v11 = get_vertex_position(column + 1, row + 1);
+
+    if (k == 0) {
+        return {v00, v11, get_vertex_position(column + 1, row)};
+    }
+
+    return {v00, get_vertex_position(column, row + 1), v11};
+}
+
+bool heightfield::get_cell_range(const AABB &aabb, uint32_t &first_column, uint32_t &first_row,
+                                 uint32_t &last_column, uint32_t &last_row) const {
+    if (aabb.max.x < m_aabb.min.x || aabb.min.x > m_aabb.max.x ||
+        aabb.max.z < m_aabb.min.z || aabb.min.z > m_aabb.max.z) {
+        return false;
+    }
+
+    auto to_cell = [&](scalar value, scalar origin, uint32_t num_samples) {
+        auto idx = static_cast<int64_t>(std::floor((value - origin) / m_cell_size));
+        return static_cast<uint32_t>(std::clamp<int64_t>(idx, 0, num_samples - 2));
+    };
+
+    first_column = to_cell(aabb.min.x, m_origin.x, m_num_columns);
+    last_column = to_cell(aabb.max.x, m_origin.x, m_num_columns);
+    first_row = to_cell(aabb.min.z, m_origin.z, m_num_rows);
+    last_row = to_cell(aabb.max.z, m_origin.z, m_num_rows);
+
+    return true;
+}
+
+bool heightfield::clip_segment(const vector3 &p0, const vector3 &p1, scalar &t0, scalar &t1) const {
+    auto aabb_min = m_aabb.min - vector3{0, m_thickness, 0};
+    auto aabb_max = m_aabb.max;
+    auto d = p1 - p0;
+    t0 = 0;
+    t1 = 1;
+
+    for (size_t i = 0; i < 3; ++i) {
+        if (std::abs(d[i]) <= EDYN_EPSILON) {
+            if (p0[i] < aabb_min[i] || p0[i] > aabb_max[i]) {
+                return false;
+            }
+
+            continue;
+        }
+
+        auto ta = (aabb_min[i] - p0[i]) / d[i];
+        auto tb = (aabb_max[i] - p0[i]) / d[i];
+
+        if (ta > tb) {
+            std::swap(ta, tb);
+        }
+
+        t0 = std::max(t0, ta);
+        t1 = std::min(t1, tb);
+
+        if (t0 > t1) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool heightfield::tile_intersects(uint32_t tile_column, uint32_t tile_row, scalar min_y, scalar max_y) const {
+    EDYN_ASSERT(tile_column < m_num_tile_columns && tile_row < m_num_tile_rows);
+    auto tile_idx = tile_row * m_num_tile_columns + tile_column;
+    return m_tile_max[tile_idx] >= min_y && m_tile_min[tile_idx] <= max_y;
+}
+
+void heightfield::make_patch(const AABB &aabb, heightfield_patch &patch) const {
+    patch.trimesh = triangle_mesh{};
+
+    auto any_cell = false;
+    visit_cells(aabb, [&](uint32_t, uint32_t) {
+        any_cell = true;
+    });
+
+    uint32_t first_column, first_row, last_column, last_row;
+
+    if (!any_cell || !get_cell_range(aabb, first_column, first_row, last_column, last_row)) {
+        return;
+    }
+
+    // Add ring of cells around the region.
+    first_column = first_column > 0 ? first_column - 1 : 0;
+    first_row = first_row > 0 ? first_row - 1 : 0;
+    last_column = std::min(last_column + 1, m_num_columns - 2);
+    last_row = std::min(last_row + 1, m_num_rows - 2);
+
+    patch.first_column = first_column;
+    patch.first_row = first_row;
+    patch.num_columns = last_column - first_column + 2;
+    const auto num_rows = last_row - first_row + 2;
+
+    auto vertices = std::vector<vector3>{};
+    vertices.reserve(patch.num_columns * num_rows);
+
+    for (uint32_t row = 0; row < num_rows; ++row) {
+        for (uint32_t column = 0; column < patch.num_columns; ++column) {
+            vertices.push_back(get_vertex_position(first_column + column, first_row + row));
+        }
+    }
+
+    // Same triangulation as `get_cell_triangle_vertices`.
+    auto indices = std::vector<triangle_mesh::index_type>{};
+    indices.reserve((patch.num_columns - 1) * (num_rows - 1) * 6);
+
+    for (uint32_t row = 0; row + 1 < num_rows; ++row) {
+        for (uint32_t column = 0; column + 1 < patch.num_columns; ++column) {
+            auto i00 = row * patch.num_columns + column;
+            auto i10 = i00 + 1;
+            auto i01 = i00 + patch.num_columns;
+            auto i11 = i01 + 1;
+            indices.insert(indices.end(), {i00, i11, i10, i00, i01, i11});
+        }
+    }
+
+    patch.trimesh.insert_vertices(vertices.begin(), vertices.end());
+    patch.trimesh.insert_indices(indices.begin(), indices.end());
+    patch.trimesh.set_thickness(m_thickness);
+    patch.trimesh.initialize();
+}
+
+size_t heightfield_patch::get_heightfield_feature_index(const heightfield &hf, triangle_feature tri_feature, size_t index) const {
+    auto to_heightfield_vertex = [&](size_t vertex_idx) {
+        auto column = first_column + vertex_idx % num_columns;
+        auto row = first_row + vertex_idx / num_columns;
+        return size_t(row) * hf.num_columns() + column;
+    };
+
+    switch (tri_feature) {
+    case triangle_feature::face: {
+        auto cell_idx = index / 2;
+        auto num_cells_x = num_columns - 1;
+        auto column = first_column + cell_idx % num_cells_x;
+        auto row = first_row + cell_idx / num_cells_x;
+        return hf.get_triangle_index(column, row, index % 2);
+    }
+    case triangle_feature::edge: {
+        auto [i0, i1] = trimesh.get_edge_vertex_indices(index);
+        auto v0 = to_heightfield_vertex(i0);
+        auto v1 = to_heightfield_vertex(i1);
+
+        if (v0 > v1) {
+            std::swap(v0, v1);
+        }
+
+        auto diff = v1 - v0;
+        auto k = diff == 1 ? 0 : (diff == hf.num_columns() ? 1 : 2);
+        return 3 * v0 + k;
+    }
+    case triangle_feature::vertex:
+        return to_heightfield_vertex(index);
+    }
+
+    return SIZE_MAX;
+}
+
+}
@@ -0,0 +1,170 @@
+#include "edyn/shapes/paged_mesh_page_cache.hpp"
+#include "edyn/shapes/paged_triangle_mesh.hpp"
+#include "edyn/config/config.h"
+#include <functional>
+
+namespace edyn {
+
+paged_mesh_page_cache &paged_mesh_page_cache::global() {
+    static paged_mesh_page_cache instance;
+    return instance;
+}
+
+size_t paged_mesh_page_cache::page_key_hash::operator()(const page_key &key) const {
+    auto seed = std::hash<const void *>{}(key.trimesh);
+    return seed ^ (std::hash<size_t>{}(key.index) + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+void paged_mesh_page_cache::set_byte_budget(size_t num_bytes) {
+    auto lock = std::lock_guard(m_mutex);
+    m_byte_budget = num_bytes;
+}
+
+size_t paged_mesh_page_cache::get_byte_budget() const {
+    auto lock = std::lock_guard(m_mutex);
+    return m_byte_budget;
+}
+
+paged_mesh_page_cache_stats paged_mesh_page_cache::get_stats() const {
+    auto lock = std::lock_guard(m_mutex);
+    auto stats = paged_mesh_page_cache_stats{};
+    stats.hits = m_hits.load(std::memory_order_relaxed);
+    stats.misses = m_misses.load(std::memory_order_relaxed);
+    stats.evictions = m_evictions.load(std::memory_order_relaxed);
+    stats.num_pages = m_entries.size();
+    stats.num_pinned_pages = m_pin_counts.size();
+    stats.num_bytes = m_num_bytes;
+    return stats;
+}
+
+void paged_mesh_page_cache::reset_stats() {
+    m_hits.store(0, std::memory_order_relaxed);
+    m_misses.store(0, std::memory_order_relaxed);
+    m_evictions.store(0, std::memory_order_relaxed);
+}
+
+void paged_mesh_page_cache::pin(paged_triangle_mesh *trimesh, size_t index) {
+    auto lock = std::lock_guard(m_mutex);
+    ++m_pin_counts[{trimesh, index}];
+}
+
+void paged_mesh_page_cache::unpin(paged_triangle_mesh *trimesh, size_t index) {
+    auto lock = std::lock_guard(m_mutex);
+    auto it = m_pin_counts.find({trimesh, index});
+    EDYN_ASSERT(it != m_pin_counts.end());
+
+    if (--it->second == 0) {
+        m_pin_counts.erase(it);
+    }
+}
+
+bool paged_mesh_page_cache::is_pinned(paged_triangle_mesh *trimesh, size_t index) const {
+    auto lock = std::lock_guard(m_mutex);
+    return is_pinned_unlocked({trimesh, index});
+}
+
+bool paged_mesh_page_cache::is_pinned_unlocked(const page_key &key) const {
+    return m_pin_counts.count(key) > 0;
+}
+
+void paged_mesh_page_cache::insert(paged_triangle_mesh *trimesh, size_t index, size_t num_bytes, bool evict_pages) {
+    auto lock = std::lock_guard(m_mutex);
+    auto key = page_key{trimesh, index};
+
+    if (auto it = m_entries.find(key); it != m_entries.end()) {
+        m_num_bytes -= it->second->num_bytes;
+        m_lru.erase(it->second);
+        m_entries.erase(it);
+    }
+
+    m_lru.push_front({key, num_bytes});
+    m_entries[key] = m_lru.begin();
+    m_num_bytes += num_bytes;
+
+    if (!evict_pages) {
+        return;
+    }
+
+    // Unload least recently used pages until the budget is met, skipping
+    // the page that was just inserted and pinned pages.
+    auto it = std::prev(m_lru.end());
+
+    while (m_num_bytes > m_byte_budget && it != m_lru.begin()) {
+        auto victim = it--;
+
+        if (!is_pinned_unlocked(victim->key)) {
+            evict(victim);
+        }
+    }
+}
+
+void paged_mesh_page_cache::erase(paged_triangle_mesh *trimesh) {
+    auto lock = std::lock_guard(m_mutex);
+
+    for (auto it = m_lru.begin(); it != m_lru.end();) {
+        if (it->key.trimesh == trimesh) {
+            m_num_bytes -= it->num_bytes;
+            m_entries.erase(it->key);
+            it = m_lru.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void paged_mesh_page_cache::remove_mesh(paged_triangle_mesh *trimesh) {
+    erase(trimesh);
+
+    auto lock = std::lock_guard(m_mutex);
+
+    for (auto it = m_pin_counts.begin(); it != m_pin_counts.end();) {
+        if (it->first.trimesh == trimesh) {
+            it = m_pin_counts.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void paged_mesh_page_cache::touch(paged_triangle_mesh *trimesh, size_t index) {
+    auto lock = std::lock_guard(m_mutex);
+
+    if (auto it = m_entries.find({trimesh, index}); it != m_entries.end()) {
+        m_lru.splice(m_lru.begin(), m_lru, it->second);
+    }
+}
+
+void paged_mesh_page_cache::record_hit() {
+    m_hits.fetch_add(1, std::memory_order_relaxed);
+}
+
+void paged_mesh_page_cache::record_miss() {
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool paged_mesh_page_cache::evict_least_recently_used(paged_triangle_mesh *trimesh) {
+    auto lock = std::lock_guard(m_mutex);
+
+    for (auto it = m_lru.rbegin(); it != m_lru.rend(); ++it) {
+        if (it->key.trimesh == trimesh && !is_pinned_unlocked(it->key)) {
+            evict(std::prev(it.base()));
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void paged_mesh_page_cache::evict(lru_list::iterator it) {
+    auto key = it->key;
+    m_num_bytes -= it->num_bytes;
+    m_entries.erase(key);
+    m_lru.erase(it);
+    m_evictions.fetch_add(1, std::memory_order_relaxed);
+
+    // The mesh is still alive since it removes its entries from the cache
+    // while holding the lock before being destroyed.
+    key.trimesh->unload_page(key.index);
+}
+
+}
@@ -5,6 +5,8 @@
 #include <mutex>
 #include <entt/entity/registry.hpp>
 #include "edyn/parallel/message_dispatcher.hpp"
+#include "edyn/serialization/triangle_mesh_s11n.hpp"
+#include "edyn/shapes/paged_mesh_page_cache.hpp"
 #include "edyn/shapes/triangle_mesh.hpp"
 #include "edyn/util/paged_mesh_load_reporting.hpp"
 
@@ -15,6 +17,24 @@ paged_triangle_mesh::paged_triangle_mesh(std::shared_ptr<triangle_mesh_page_load
 {
 }
 
+paged_triangle_mesh::~paged_triangle_mesh() {
+    paged_mesh_page_cache::global().remove_mesh(this);
+}
+
+void paged_triangle_mesh::init_cache() {
+    m_is_loading_submesh = std::make_unique<std::atomic<bool>[]>(m_cache.size());
+
+    // Submeshes which are already loaded are accounted for, but nothing is
+    // unloaded until new submeshes are loaded.
+    auto &page_cache = paged_mesh_page_cache::global();
+
+    for (size_t i = 0; i < m_cache.size(); ++i) {
+        if (auto trimesh = m_cache[i].trimesh) {
+            page_cache.insert(this, i, serialization_sizeof(*trimesh), false);
+        }
+    }
+}
+
 size_t paged_triangle_mesh::cache_num_vertices() const {
     size_t count = 0;
 
@@ -40,41 +60,48 @@ void paged_triangle_mesh::load_node_if_needed(size_t trimesh_idx) {
     auto &node = m_cache[trimesh_idx];
     // Make copy of shared_ptr to increment reference count and avoid concurrent deallocation.
     auto trimesh = node.trimesh;
+    auto &page_cache = paged_mesh_page_cache::global();
 
     if (trimesh) {
         m_is_loading_submesh[trimesh_idx].store(false, std::memory_order_relaxed);
+        page_cache.record_hit();
         return;
     }
 
     EDYN_ASSERT(node.num_vertices < m_max_cache_num_vertices);
+    page_cache.record_miss();
 
     // Load triangle mesh into cache. Clear cache if it would go
-    // above limits.
+    // above limits. The byte budget shared by all meshes is enforced
+    // by the page cache once the mesh is assigned.
     while (cache_num_vertices() + node.num_vertices > m_max_cache_num_vertices) {
-        unload_least_recently_visited_node();
+        if (!page_cache.evict_least_recently_used(this)) {
+            // All loaded nodes are pinned.
+            break;
+        }
     }
 
     m_page_loader->load(this, trimesh_idx);
 }
 
-void paged_triangle_mesh::mark_recent_visit(size_t trimesh_idx) {
-    auto lock = std::lock_guard(m_lru_mutex);
-    auto it = std::find(m_lru_indices.begin(), m_lru_indices.end(), trimesh_idx);
-    std::rotate(m_lru_indices.begin(), it, it + 1);
+void paged_triangle_mesh::prefetch(const AABB &aabb) {
+    m_tree.query(aabb, [&](auto tree_node_idx) {
+        auto mesh_idx = m_tree.get_node(tree_node_idx).id;
+        load_node_if_needed(mesh_idx);
+        mark_recent_visit(mesh_idx);
+    });
 }
 
-void paged_triangle_mesh::unload_least_recently_visited_node() {
-    auto lock = std::lock_guard(m_lru_mutex);
-
-    for (auto it = m_lru_indices.rbegin(); it != m_lru_indices.rend(); ++it) {
-        auto &node = m_cache[*it];
+void paged_triangle_mesh::mark_recent_visit(size_t trimesh_idx) {
+    paged_mesh_page_cache::global().touch(this, trimesh_idx);
+}
 
-        if (node.trimesh) {
-            node.trimesh.reset();
-            message_dispatcher::global().send<msg::paged_triangle_mesh_load_page>({internal::paged_mesh_load_queue_identifier}, {}, this, *it);
-            break;
-        }
-    }
+void paged_triangle_mesh::unload_page(size_t trimesh_idx) {
+    // Invoked by the page cache while holding its lock thus it must not
+    // call back into the cache.
+    auto lock = std::lock_guard(m_cache_mutex);
+    m_cache[trimesh_idx].trimesh.reset();
+    message_dispatcher::global().send<msg::paged_triangle_mesh_evict_page>({internal::paged_mesh_load_queue_identifier}, {}, this, trimesh_idx);
 }
 
 triangle_vertices paged_triangle_mesh::get_triangle_vertices(size_t mesh_idx, size_t tri_idx) const {
@@ -84,19 +111,28 @@ triangle_vertices paged_triangle_mesh::get_triangle_vertices(size_t mesh_idx, si
 }
 
 void paged_triangle_mesh::clear_cache() {
+    paged_mesh_page_cache::global().erase(this);
+
     for (auto &node : m_cache) {
         node.trimesh.reset();
     }
 }
 
 void paged_triangle_mesh::assign_mesh(size_t index, std::shared_ptr<triangle_mesh> mesh) {
-    // Use lock to prevent assigning to the same trimesh shared_ptr concurrently
-    // if `unload_least_recently_visited_node` is executing in another thread.
-    auto lock = std::lock_guard(m_lru_mutex);
-    m_cache[index].trimesh = mesh;
-    mesh->set_thickness(m_thickness);
-    m_is_loading_submesh[index].store(false, std::memory_order_release);
+    {
+        // Use lock to prevent assigning to the same trimesh shared_ptr concurrently
+        // if `unload_page` is executing in another thread.
+        auto lock = std::lock_guard(m_cache_mutex);
+        m_cache[index].trimesh = mesh;
+        mesh->set_thickness(m_thickness);
+        m_is_loading_submesh[index].store(false, std::memory_order_release);
+    }
+
     message_dispatcher::global().send<msg::paged_triangle_mesh_load_page>({internal::paged_mesh_load_queue_identifier}, {}, this, index);
+
+    // The cache locks this mesh when unloading pages, thus the lock above
+    // must be released before inserting.
+    paged_mesh_page_cache::global().insert(this, index, serialization_sizeof(*mesh), true);
 }
 
 bool paged_triangle_mesh::has_per_vertex_friction() const {
@@ -183,4 +219,18 @@ void paged_triangle_mesh::set_thickness(scalar thickness) {
     }
 }
 
+void paged_triangle_mesh::compress() {
+    auto &page_cache = paged_mesh_page_cache::global();
+
+    for (size_t i = 0; i < m_cache.size(); ++i) {
+        auto trimesh = m_cache[i].trimesh;
+
+        if (trimesh && !trimesh->is_compressed()) {
+            trimesh->compress();
+            // Account for the smaller size of the submesh.
+            page_cache.insert(this, i, serialization_sizeof(*trimesh), false);
+        }
+    }
+}
+
 }
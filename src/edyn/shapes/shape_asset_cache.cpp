@@ -0,0 +1,316 @@
+#include "edyn/shapes/shape_asset_cache.hpp"
+#include "edyn/config/config.h"
+#include <cstring>
+
+namespace edyn {
+
+// 64-bit FNV-1a over the values of the mesh. Scalars are hashed one at a time
+// so padding in `vector3` does not matter.
+struct mesh_content_hasher {
+    uint64_t value {14695981039346656037ull};
+
+    void add_uint(uint64_t v) {
+        for (size_t i = 0; i < sizeof(v); ++i) {
+            value ^= (v >> (i * 8)) & 0xff;
+            value *= 1099511628211ull;
+        }
+    }
+
+    void add_scalar(scalar s) {
+        // Negative zero has the same hash as zero.
+        if (s == 0) {
+            s = 0;
+        }
+
+        if constexpr(sizeof(scalar) == sizeof(uint32_t)) {
+            uint32_t bits;
+            std::memcpy(&bits, &s, sizeof(bits));
+            add_uint(bits);
+        } else {
+            uint64_t bits;
+            std::memcpy(&bits, &s, sizeof(bits));
+            add_uint(bits);
+        }
+    }
+
+    void add_vector3(const vector3 &v) {
+        add_scalar(v.x);
+        add_scalar(v.y);
+        add_scalar(v.z);
+    }
+};
+
+static uint64_t hash_mesh(const convex_mesh &mesh) {
+    auto hasher = mesh_content_hasher{};
+    hasher.add_uint(mesh.vertices.size());
+
+    for (auto &v : mesh.vertices) {
+        hasher.add_vector3(v);
+    }
+
+    hasher.add_uint(mesh.indices.size());
+
+    for (auto i : mesh.indices) {
+        hasher.add_uint(i);
+    }
+
+    hasher.add_uint(mesh.faces.size());
+
+    for (auto i : mesh.faces) {
+        hasher.add_uint(i);
+    }
+
+    return hasher.value;
+}
+
+static bool meshes_equal(const convex_mesh &a, const convex_mesh &b) {
+    return a.vertices == b.vertices && a.indices == b.indices && a.faces == b.faces;
+}
+
+static bool has_per_vertex_properties(const triangle_mesh &mesh) {
+    return mesh.has_per_vertex_friction() ||
+           mesh.has_per_vertex_restitution() ||
+           mesh.has_per_vertex_material_id();
+}
+
+// The tree type is passed separately since it's only assigned to the mesh
+// when it's initialized.
+static uint64_t hash_mesh(const triangle_mesh &mesh, triangle_mesh::tree_type type) {
+    auto hasher = mesh_content_hasher{};
+    hasher.add_uint(mesh.num_vertices());
+
+    for (size_t i = 0; i < mesh.num_vertices(); ++i) {
+        hasher.add_vector3(mesh.get_vertex_position(i));
+    }
+
+    hasher.add_uint(mesh.num_triangles());
+
+    for (size_t i = 0; i < mesh.num_triangles(); ++i) {
+        for (auto idx : mesh.get_triangle_vertex_indices(i)) {
+            hasher.add_uint(idx);
+        }
+    }
+
+    hasher.add_uint(static_cast<uint64_t>(type));
+    hasher.add_scalar(mesh.get_thickness());
+
+    return hasher.value;
+}
+
+static bool meshes_equal(const triangle_mesh &a, const triangle_mesh &b, triangle_mesh::tree_type b_type) {
+    if (has_per_vertex_properties(a) || has_per_vertex_properties(b) ||
+        a.num_vertices() != b.num_vertices() ||
+        a.num_triangles() != b.num_triangles() ||
+        a.get_tree_type() != b_type ||
+        a.get_thickness() != b.get_thickness()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < a.num_vertices(); ++i) {
+        if (a.get_vertex_position(i) != b.get_vertex_position(i)) {
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < a.num_triangles(); ++i) {
+        if (a.get_triangle_vertex_indices(i) != b.get_triangle_vertex_indices(i)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Returns the id of the mesh in the table for which `equal` returns true or
+// the id where a new mesh should be inserted. Hash collisions are resolved by
+// probing the following ids.
+template<typename Mesh, typename Equal>
+static shape_asset_cache::id_type probe_mesh_id(
+    const std::unordered_map<shape_asset_cache::id_type, std::shared_ptr<Mesh>> &meshes,
+    uint64_t hash, Equal equal) {
+
+    auto id = hash == shape_asset_cache::invalid_id ? hash + 1 : hash;
+
+    while (true) {
+        auto it = meshes.find(id);
+
+        if (it == meshes.end() || equal(*it->second)) {
+            return id;
+        }
+
+        if (++id == shape_asset_cache::invalid_id) {
+            ++id;
+        }
+    }
+}
+
+shape_asset_cache &shape_asset_cache::global() {
+    static shape_asset_cache instance;
+    return instance;
+}
+
+template<typename Mesh, typename Equal>
+shape_asset_cache::id_type shape_asset_cache::insert_unlocked(mesh_table<Mesh> &table,
+                                                              const std::shared_ptr<Mesh> &mesh,
+                                                              id_type hash, Equal equal) {
+    auto id = probe_mesh_id(table.meshes, hash, equal);
+
+    if (!table.meshes.count(id)) {
+        table.meshes.emplace(id, mesh);
+        table.ids.emplace(mesh.get(), id);
+    }
+
+    return id;
+}
+
+std::shared_ptr<convex_mesh> shape_asset_cache::get_convex_mesh(const std::vector<vector3> &vertices,
+                                                                const std::vector<uint32_t> &indices,
+                                                                const std::vector<uint32_t> &faces) {
+    auto mesh = std::make_shared<convex_mesh>();
+    mesh->vertices = vertices;
+    mesh->indices = indices;
+    mesh->faces = faces;
+
+    // Only shift the vertices, which is what's compared. The other
+    // properties are only calculated if the mesh isn't in the cache.
+    mesh->shift_to_centroid();
+    auto hash = hash_mesh(*mesh);
+
+    {
+        auto lock = std::lock_guard(m_mutex);
+        auto id = probe_mesh_id(m_convex_meshes.meshes, hash, [&](auto &other) {
+            return meshes_equal(other, *mesh);
+        });
+
+        if (auto it = m_convex_meshes.meshes.find(id); it != m_convex_meshes.meshes.end()) {
+            return it->second;
+        }
+    }
+
+    mesh->update_calculated_properties();
+    EDYN_ASSERT(mesh->validate());
+
+    // Another thread could have inserted the same mesh in the meantime.
+    return share(mesh);
+}
+
+std::shared_ptr<triangle_mesh> shape_asset_cache::get_triangle_mesh(const std::vector<vector3> &vertices,
+                                                                    const std::vector<uint32_t> &indices,
+                                                                    triangle_mesh::tree_type type) {
+    EDYN_ASSERT(indices.size() % 3 == 0);
+    auto mesh = std::make_shared<triangle_mesh>();
+    mesh->insert_vertices(vertices.begin(), vertices.end());
+    mesh->insert_indices(indices.begin(), indices.end());
+
+    auto hash = hash_mesh(*mesh, type);
+    auto equal = [&](auto &other) {
+        return meshes_equal(other, *mesh, type);
+    };
+
+    {
+        auto lock = std::lock_guard(m_mutex);
+        auto id = probe_mesh_id(m_triangle_meshes.meshes, hash, equal);
+
+        if (auto it = m_triangle_meshes.meshes.find(id); it != m_triangle_meshes.meshes.end()) {
+            return it->second;
+        }
+    }
+
+    mesh->initialize(type);
+
+    return share(mesh);
+}
+
+shape_asset_cache::id_type shape_asset_cache::insert(const std::shared_ptr<convex_mesh> &mesh) {
+    EDYN_ASSERT(mesh);
+    auto lock = std::lock_guard(m_mutex);
+
+    if (auto it = m_convex_meshes.ids.find(mesh.get()); it != m_convex_meshes.ids.end()) {
+        return it->second;
+    }
+
+    return insert_unlocked(m_convex_meshes, mesh, hash_mesh(*mesh), [&](auto &other) {
+        return meshes_equal(other, *mesh);
+    });
+}
+
+shape_asset_cache::id_type shape_asset_cache::insert(const std::shared_ptr<triangle_mesh> &mesh) {
+    EDYN_ASSERT(mesh);
+    auto lock = std::lock_guard(m_mutex);
+
+    if (auto it = m_triangle_meshes.ids.find(mesh.get()); it != m_triangle_meshes.ids.end()) {
+        return it->second;
+    }
+
+    auto type = mesh->get_tree_type();
+    return insert_unlocked(m_triangle_meshes, mesh, hash_mesh(*mesh, type), [&](auto &other) {
+        return meshes_equal(other, *mesh, type);
+    });
+}
+
+std::shared_ptr<convex_mesh> shape_asset_cache::share(const std::shared_ptr<convex_mesh> &mesh) {
+    auto id = insert(mesh);
+    auto lock = std::lock_guard(m_mutex);
+    return m_convex_meshes.meshes.at(id);
+}
+
+std::shared_ptr<triangle_mesh> shape_asset_cache::share(const std::shared_ptr<triangle_mesh> &mesh) {
+    auto id = insert(mesh);
+    auto lock = std::lock_guard(m_mutex);
+    return m_triangle_meshes.meshes.at(id);
+}
+
+shape_asset_cache::id_type shape_asset_cache::get_id(const convex_mesh *mesh) const {
+    auto lock = std::lock_guard(m_mutex);
+    auto it = m_convex_meshes.ids.find(mesh);
+    return it != m_convex_meshes.ids.end() ? it->second : invalid_id;
+}
+
+shape_asset_cache::id_type shape_asset_cache::get_id(const triangle_mesh *mesh) const {
+    auto lock = std::lock_guard(m_mutex);
+    auto it = m_triangle_meshes.ids.find(mesh);
+    return it != m_triangle_meshes.ids.end() ? it->second : invalid_id;
+}
+
+std::shared_ptr<convex_mesh> shape_asset_cache::find_convex_mesh(id_type id) const {
+    auto lock = std::lock_guard(m_mutex);
+    auto it = m_convex_meshes.meshes.find(id);
+    return it != m_convex_meshes.meshes.end() ? it->second : nullptr;
+}
+
+std::shared_ptr<triangle_mesh> shape_asset_cache::find_triangle_mesh(id_type id) const {
+    auto lock = std::lock_guard(m_mutex);
+    auto it = m_triangle_meshes.meshes.find(id);
+    return it != m_triangle_meshes.meshes.end() ? it->second : nullptr;
+}
+
+template<typename Mesh>
+static void erase_unused(std::unordered_map<shape_asset_cache::id_type, std::shared_ptr<Mesh>> &meshes,
+                         std::unordered_map<const Mesh *, shape_asset_cache::id_type> &ids) {
+    for (auto it = meshes.begin(); it != meshes.end();) {
+        if (it->second.use_count() == 1) {
+            ids.erase(it->second.get());
+            it = meshes.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void shape_asset_cache::clear_unused() {
+    auto lock = std::lock_guard(m_mutex);
+    erase_unused(m_convex_meshes.meshes, m_convex_meshes.ids);
+    erase_unused(m_triangle_meshes.meshes, m_triangle_meshes.ids);
+}
+
+size_t shape_asset_cache::num_convex_meshes() const {
+    auto lock = std::lock_guard(m_mutex);
+    return m_convex_meshes.meshes.size();
+}
+
+size_t shape_asset_cache::num_triangle_meshes() const {
+    auto lock = std::lock_guard(m_mutex);
+    return m_triangle_meshes.meshes.size();
+}
+
+}
@@ -1,12 +1,17 @@
 #include "edyn/shapes/triangle_mesh.hpp"
 #include "edyn/comp/aabb.hpp"
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <limits>
 #include <set>
 
 namespace edyn {
 
-void triangle_mesh::initialize() {
+void triangle_mesh::initialize(tree_type type) {
+    EDYN_ASSERT(!is_view());
+    m_tree_type = type;
+
     // Order is important.
     calculate_face_normals();
     init_edge_indices();
@@ -137,19 +142,97 @@ void triangle_mesh::build_triangle_tree() {
         aabbs.push_back(tri_aabb);
     }
 
+    if (m_tree_type == tree_type::compact) {
+        m_triangle_tree.clear();
+        m_compact_triangle_tree.build(aabbs.begin(), aabbs.end());
+        return;
+    }
+
     auto report_leaf = [](static_tree::tree_node &node, auto ids_begin, auto ids_end) {
         node.id = *ids_begin;
     };
+    m_compact_triangle_tree.clear();
     m_triangle_tree.build(aabbs.begin(), aabbs.end(), report_leaf);
 }
 
+void triangle_mesh::compress() {
+    EDYN_ASSERT(!m_compressed);
+    EDYN_ASSERT(!is_view());
+    EDYN_ASSERT(m_normals.size() == m_indices.size());
+
+    if (m_vertices.empty()) {
+        return;
+    }
+
+    // Quantize vertices relative to their AABB. The extremes of the AABB are
+    // mapped to the extremes of the quantized range, thus decoded vertices
+    // stay within the original AABB.
+    auto vertex_min = m_vertices.front();
+    auto vertex_max = m_vertices.front();
+
+    for (auto &v : m_vertices) {
+        vertex_min = min(vertex_min, v);
+        vertex_max = max(vertex_max, v);
+    }
+
+    constexpr auto quantized_max = scalar(std::numeric_limits<uint16_t>::max());
+    m_vertex_origin = vertex_min;
+    m_vertex_scale = (vertex_max - vertex_min) / quantized_max;
+
+    auto quantize = [&](scalar value, scalar origin, scalar scale) {
+        auto q = scale > 0 ? std::round((value - origin) / scale) : scalar(0);
+        return static_cast<uint16_t>(std::clamp(q, scalar(0), quantized_max));
+    };
+
+    m_quantized_vertices.resize(m_vertices.size());
+
+    for (size_t i = 0; i < m_vertices.size(); ++i) {
+        auto &v = m_vertices[i];
+        m_quantized_vertices[i] = {
+            quantize(v.x, m_vertex_origin.x, m_vertex_scale.x),
+            quantize(v.y, m_vertex_origin.y, m_vertex_scale.y),
+            quantize(v.z, m_vertex_origin.z, m_vertex_scale.z)
+        };
+    }
+
+    if (m_vertices.size() <= size_t(std::numeric_limits<uint16_t>::max()) + 1) {
+        m_compact_indices.resize(m_indices.size());
+
+        for (size_t i = 0; i < m_indices.size(); ++i) {
+            for (size_t j = 0; j < 3; ++j) {
+                m_compact_indices[i][j] = static_cast<uint16_t>(m_indices[i][j]);
+            }
+        }
+
+        decltype(m_indices){}.swap(m_indices);
+    }
+
+    m_encoded_normals.resize(m_normals.size());
+    m_encoded_adjacent_normals.resize(m_adjacent_normals.size());
+
+    for (size_t i = 0; i < m_normals.size(); ++i) {
+        m_encoded_normals[i] = octahedral_encode(m_normals[i]);
+
+        for (size_t j = 0; j < 3; ++j) {
+            m_encoded_adjacent_normals[i][j] = octahedral_encode(m_adjacent_normals[i][j]);
+        }
+    }
+
+    decltype(m_vertices){}.swap(m_vertices);
+    decltype(m_normals){}.swap(m_normals);
+    decltype(m_adjacent_normals){}.swap(m_adjacent_normals);
+    m_compressed = true;
+
+    // The quantized triangles can be slightly off from the original ones.
+    build_triangle_tree();
+}
+
 triangle_vertices triangle_mesh::get_triangle_vertices(size_t tri_idx) const {
-    EDYN_ASSERT(tri_idx < m_indices.size());
-    auto indices = m_indices[tri_idx];
+    auto indices = get_triangle_vertex_indices(tri_idx);
     return {
-        m_vertices[indices[0]],
-        m_vertices[indices[1]],
-        m_vertices[indices[2]]
+        get_vertex_position(indices[0]),
+        get_vertex_position(indices[1]),
+        get_vertex_position(indices[2])
     };
 }
 
@@ -175,9 +258,9 @@ scalar triangle_mesh::get_edge_friction(size_t edge_idx, vector3 point) const {
 }
 
 scalar triangle_mesh::get_face_friction(size_t tri_idx, vector3 point) const {
-    auto f0 = get_vertex_friction(m_indices[tri_idx][0]);
-    auto f1 = get_vertex_friction(m_indices[tri_idx][1]);
-    auto f2 = get_vertex_friction(m_indices[tri_idx][2]);
+    auto f0 = get_vertex_friction(get_face_vertex_index(tri_idx, 0));
+    auto f1 = get_vertex_friction(get_face_vertex_index(tri_idx, 1));
+    auto f2 = get_vertex_friction(get_face_vertex_index(tri_idx, 2));
     return  interpolate_triangle(tri_idx, point, {f0, f1, f2});
 }
 
@@ -203,9 +286,9 @@ scalar triangle_mesh::get_edge_restitution(size_t edge_idx, vector3 point) const
 }
 
 scalar triangle_mesh::get_face_restitution(size_t tri_idx, vector3 point) const {
-    auto f0 = get_vertex_restitution(m_indices[tri_idx][0]);
-    auto f1 = get_vertex_restitution(m_indices[tri_idx][1]);
-    auto f2 = get_vertex_restitution(m_indices[tri_idx][2]);
+    auto f0 = get_vertex_restitution(get_face_vertex_index(tri_idx, 0));
+    auto f1 = get_vertex_restitution(get_face_vertex_index(tri_idx, 1));
+    auto f2 = get_vertex_restitution(get_face_vertex_index(tri_idx, 2));
     return  interpolate_triangle(tri_idx, point, {f0, f1, f2});
 }
 
@@ -238,7 +321,7 @@ std::array<triangle_mesh::material_influence, 3> triangle_mesh::get_face_materia
     auto coord = barycentric_coordinates(tri_idx, point);
 
     for (int i = 0; i < 3; ++i) {
-        influence[i].id = get_vertex_material_id(m_indices[tri_idx][i]);
+        influence[i].id = get_vertex_material_id(get_face_vertex_index(tri_idx, i));
         influence[i].fraction = coord[i];
     }
 
@@ -0,0 +1,51 @@
+#include "edyn/simulation/broadphase_mirror.hpp"
+#include "edyn/collision/broadphase.hpp"
+#include "edyn/context/settings.hpp"
+#include "edyn/replication/entity_map.hpp"
+#include "edyn/simulation/stepper_async.hpp"
+#include <entt/entity/registry.hpp>
+
+namespace edyn {
+
+void broadphase_mirror::write(const broadphase &bphase, const entity_map &emap,
+                              uint32_t origin_shift_count) {
+    auto to_remote = [&](entt::entity local) {
+        return emap.contains_local(local) ? emap.at_local(local) : entt::entity{entt::null};
+    };
+
+    if (m_np_tree_version != bphase.non_procedural_compact_tree_version()) {
+        m_np_tree = bphase.non_procedural_compact_tree();
+        m_np_tree.remap_leaves(to_remote);
+        m_np_tree_version = bphase.non_procedural_compact_tree_version();
+    }
+
+    auto &back = m_buffers.back();
+    back.procedural_tree.build(bphase.procedural_tree());
+    back.procedural_tree.remap_leaves(to_remote);
+
+    // The back buffer might hold a non-procedural tree from a few writes ago.
+    if (back.np_tree_version != m_np_tree_version) {
+        back.np_tree = m_np_tree;
+        back.np_tree_version = m_np_tree_version;
+    }
+
+    back.origin_shift_count = origin_shift_count;
+    m_buffers.publish();
+}
+
+bool broadphase_mirror::read(const origin_shift_history *shifts) {
+    m_shifts = shifts;
+    return m_buffers.swap();
+}
+
+const broadphase_mirror * find_broadphase_mirror(const entt::registry &registry) {
+    auto *stepper = registry.ctx().find<stepper_async>();
+
+    if (stepper == nullptr || !registry.ctx().get<settings>().publish_broadphase) {
+        return nullptr;
+    }
+
+    return &stepper->get_broadphase_mirror();
+}
+
+}
@@ -1,18 +1,27 @@
 #include "edyn/simulation/island_manager.hpp"
+#include "edyn/collision/contact_manifold.hpp"
 #include "edyn/comp/angvel.hpp"
 #include "edyn/comp/graph_node.hpp"
 #include "edyn/comp/graph_edge.hpp"
 #include "edyn/comp/island.hpp"
 #include "edyn/comp/linvel.hpp"
+#include "edyn/comp/mass.hpp"
+#include "edyn/comp/rest_timer.hpp"
 #include "edyn/comp/tag.hpp"
+#include "edyn/config/constants.hpp"
 #include "edyn/config/execution_mode.hpp"
 #include "edyn/context/settings.hpp"
+#include "edyn/core/entity_graph.hpp"
 #include "edyn/math/vector3.hpp"
+#include "edyn/simulation/maintenance_scheduler.hpp"
+#include "edyn/sys/sort_storages_by_island.hpp"
 #include "edyn/util/island_util.hpp"
+#include "edyn/util/awake_group.hpp"
 #include "edyn/util/vector_util.hpp"
 #include "edyn/util/entt_util.hpp"
 #include <entt/entity/registry.hpp>
-#include <set>
+#include <algorithm>
+#include <limits>
 
 namespace edyn {
 
@@ -31,6 +40,12 @@ island_manager::~island_manager() {
     // Clear here to avoid invalid island entities in `on_destroy<island_resident>` events.
     m_connections.clear();
 
+    if (auto *scheduler = m_registry->ctx().find<maintenance_scheduler>()) {
+        scheduler->cancel({entt::connect_arg<&island_manager::split_deferred_island>, *this});
+        scheduler->cancel({entt::connect_arg<&island_manager::optimize_graph>, *this});
+        scheduler->cancel({entt::connect_arg<&island_manager::sort_storages>, *this});
+    }
+
     // Destroy all island entities created by this manager.
     auto island_view = m_registry->view<island>();
     m_registry->destroy(island_view.begin(), island_view.end());
@@ -91,6 +106,10 @@ void island_manager::on_destroy_island_resident(entt::registry &registry, entt::
         m_islands_to_split.push(resident.island_entity);
     }
 
+    if (!island.split_timestamp) {
+        island.split_timestamp = m_last_time;
+    }
+
     if (!m_islands_to_wake_up.contains(resident.island_entity)) {
         m_islands_to_wake_up.push(resident.island_entity);
     }
@@ -125,12 +144,14 @@ void island_manager::init_new_nodes_and_edges() {
     auto &graph = m_registry->ctx().get<entity_graph>();
     auto node_view = m_registry->view<graph_node>();
     auto edge_view = m_registry->view<graph_edge>();
-    std::set<entity_graph::index_type> procedural_node_indices;
+    auto procedural_view = m_registry->view<procedural_tag>();
+    std::vector<entity_graph::index_type> procedural_node_indices;
+    procedural_node_indices.reserve(m_new_graph_nodes.size() + m_new_graph_edges.size() * 2);
 
     for (auto entity : m_new_graph_nodes) {
-        if (m_registry->any_of<procedural_tag>(entity)) {
+        if (procedural_view.contains(entity)) {
             auto &node = node_view.get<graph_node>(entity);
-            procedural_node_indices.insert(node.node_index);
+            procedural_node_indices.push_back(node.node_index);
         }
     }
 
@@ -138,14 +159,21 @@ void island_manager::init_new_nodes_and_edges() {
         auto &edge = edge_view.get<graph_edge>(edge_entity);
         auto node_entities = graph.edge_node_entities(edge.edge_index);
 
-        if (m_registry->any_of<procedural_tag>(node_entities.first)) {
+        if (procedural_view.contains(node_entities.first)) {
             auto &node = node_view.get<graph_node>(node_entities.first);
-            procedural_node_indices.insert(node.node_index);
+            procedural_node_indices.push_back(node.node_index);
         }
 
-        if (m_registry->any_of<procedural_tag>(node_entities.second)) {
+        if (procedural_view.contains(node_entities.second)) {
             auto &node = node_view.get<graph_node>(node_entities.second);
-            procedural_node_indices.insert(node.node_index);
+            procedural_node_indices.push_back(node.node_index);
+        }
+
+        // Only contacts can unfreeze bodies, thus bodies cannot stay frozen
+        // once attached to other constraints.
+        if (!m_registry->any_of<contact_manifold>(edge_entity)) {
+            m_registry->remove<frozen_tag>(node_entities.first);
+            m_registry->remove<frozen_tag>(node_entities.second);
         }
     }
 
@@ -154,11 +182,19 @@ void island_manager::init_new_nodes_and_edges() {
 
     if (procedural_node_indices.empty()) return;
 
+    // Each node is a starting point once, in increasing order of index.
+    std::sort(procedural_node_indices.begin(), procedural_node_indices.end());
+    procedural_node_indices.erase(std::unique(procedural_node_indices.begin(), procedural_node_indices.end()),
+                                  procedural_node_indices.end());
+
+    // All new nodes and edges are assigned to islands in a single traversal
+    // of the graph from the new procedural nodes, with a single insertion or
+    // merge per connected component, and the islands absorbed in merges are
+    // destroyed together at the end.
     std::vector<entt::entity> connected_nodes;
     std::vector<entt::entity> connected_edges;
     std::vector<entt::entity> island_entities;
     auto resident_view = m_registry->view<const island_resident>();
-    auto procedural_view = m_registry->view<procedural_tag>();
 
     graph.reach(
         procedural_node_indices.begin(), procedural_node_indices.end(),
@@ -190,7 +226,8 @@ void island_manager::init_new_nodes_and_edges() {
             // Do not visit non-procedural nodes.
             if (!procedural_view.contains(other_entity)) {
                 // However, add them to the island.
-                if (!vector_contains(connected_nodes, other_entity)) {
+                if (!m_connected_non_procedural.contains(other_entity)) {
+                    m_connected_non_procedural.push(other_entity);
                     connected_nodes.push_back(other_entity);
                 }
 
@@ -243,7 +280,10 @@ void island_manager::init_new_nodes_and_edges() {
             connected_nodes.clear();
             connected_edges.clear();
             island_entities.clear();
+            m_connected_non_procedural.clear();
         });
+
+    destroy_merged_islands();
 }
 
 entt::entity island_manager::create_island() {
@@ -290,6 +330,7 @@ void island_manager::insert_to_island(entt::entity island_entity,
     }
 
     island.edges.push(edges.begin(), edges.end());
+    m_residents_moved_since_storage_sort += nodes.size() + edges.size();
 
     wake_up_island(*m_registry, island_entity);
 }
@@ -321,6 +362,10 @@ entt::entity island_manager::merge_islands(const std::vector<entt::entity> &isla
 
     auto all_nodes = new_nodes;
     auto all_edges = new_edges;
+    // Keeps the search for duplicates constant time in large merges, e.g. when
+    // a level is loaded.
+    auto all_nodes_set = entt::sparse_set{};
+    all_nodes_set.push(all_nodes.begin(), all_nodes.end());
 
     for (auto other_island_entity : other_island_entities) {
         auto &island = island_view.get<edyn::island>(other_island_entity);
@@ -329,7 +374,8 @@ entt::entity island_manager::merge_islands(const std::vector<entt::entity> &isla
         // There could be duplicate nodes since non-procedural entities can be
         // in more than one island.
         for (auto entity : island.nodes) {
-            if (!vector_contains(all_nodes, entity)) {
+            if (!all_nodes_set.contains(entity)) {
+                all_nodes_set.push(entity);
                 all_nodes.push_back(entity);
             }
         }
@@ -337,18 +383,62 @@ entt::entity island_manager::merge_islands(const std::vector<entt::entity> &isla
 
     insert_to_island(island_entity, all_nodes, all_edges);
 
-    // Destroy empty islands.
-    m_registry->destroy(other_island_entities.begin(), other_island_entities.end());
+    // Islands waiting to be checked for splits could still be disconnected,
+    // thus the island that absorbs them has to be checked instead.
+    auto &island = island_view.get<edyn::island>(island_entity);
 
-    // Remove destroyed islands from residents.
-    for (auto [entity, resident] : m_registry->view<multi_island_resident>().each()) {
-        resident.island_entities.remove(other_island_entities.begin(), other_island_entities.end());
+    for (auto other_island_entity : other_island_entities) {
+        if (m_deferred_splits.remove(other_island_entity) && !m_deferred_splits.contains(island_entity)) {
+            m_deferred_splits.push(island_entity);
+        }
+
+        if (!m_islands_to_split.contains(other_island_entity)) {
+            continue;
+        }
+
+        if (!m_islands_to_split.contains(island_entity)) {
+            m_islands_to_split.push(island_entity);
+        }
+
+        auto &other_island = island_view.get<edyn::island>(other_island_entity);
+
+        if (!island.split_timestamp || *other_island.split_timestamp < *island.split_timestamp) {
+            island.split_timestamp = other_island.split_timestamp;
+        }
     }
 
+    // The empty islands are destroyed in `destroy_merged_islands`, which
+    // must be called after all merges are done.
+    m_merged_island_entities.insert(m_merged_island_entities.end(),
+                                    other_island_entities.begin(), other_island_entities.end());
+
     // Return island that survived the merge.
     return island_entity;
 }
 
+void island_manager::destroy_merged_islands() {
+    if (m_merged_island_entities.empty()) return;
+
+    m_registry->destroy(m_merged_island_entities.begin(), m_merged_island_entities.end());
+
+    // Remove destroyed islands from residents, visiting each of them once
+    // regardless of how many merges happened.
+    for (auto [entity, resident] : m_registry->view<multi_island_resident>().each()) {
+        resident.island_entities.remove(m_merged_island_entities.begin(), m_merged_island_entities.end());
+    }
+
+    m_merged_island_entities.clear();
+}
+
+// Returns the maintenance scheduler if work should be deferred to it.
+static maintenance_scheduler * find_maintenance_scheduler(entt::registry &registry) {
+    if (registry.ctx().get<settings>().maintenance_budget > 0) {
+        return registry.ctx().find<maintenance_scheduler>();
+    }
+
+    return nullptr;
+}
+
 void island_manager::split_islands() {
     for (auto island_entity : m_islands_to_split) {
         if (!m_registry->valid(island_entity)) {
@@ -356,7 +446,90 @@ void island_manager::split_islands() {
         }
     }
 
-    if (m_islands_to_split.empty()) return;
+    for (auto island_entity : m_deferred_splits) {
+        if (!m_registry->valid(island_entity)) {
+            m_deferred_splits.erase(island_entity);
+        }
+    }
+
+    if (m_islands_to_split.empty() && m_deferred_splits.empty()) return;
+
+    // Checking for splits requires traversing the entire island, thus it's
+    // deferred until the island could go to sleep, i.e. before it's put to
+    // sleep as a whole, or until enough time has passed. If there's a
+    // maintenance budget, islands which are split because enough time has
+    // passed are handed over to a maintenance job, which splits them over the
+    // next steps. Islands which are asleep or could go to sleep are always
+    // split right away.
+    auto &settings = m_registry->ctx().get<edyn::settings>();
+    auto *scheduler = find_maintenance_scheduler(*m_registry);
+    auto sleeping_view = m_registry->view<sleeping_tag>();
+    auto islands_to_split = std::vector<entt::entity>{};
+    auto ready_islands = std::vector<entt::entity>{};
+
+    for (auto island_entity : m_islands_to_split) {
+        auto &island = m_registry->get<edyn::island>(island_entity);
+        auto waiting = settings.island_split_delay > 0 && island.split_timestamp &&
+            m_last_time - *island.split_timestamp < settings.island_split_delay;
+        auto urgent = sleeping_view.contains(island_entity) || island.nodes.empty() ||
+            ((waiting || scheduler) && could_go_to_sleep(island_entity));
+
+        if (waiting && !urgent) {
+            continue;
+        }
+
+        island.split_timestamp.reset();
+        ready_islands.push_back(island_entity);
+
+        if (urgent || !scheduler) {
+            islands_to_split.push_back(island_entity);
+        } else if (!m_deferred_splits.contains(island_entity)) {
+            m_deferred_splits.push(island_entity);
+        }
+    }
+
+    m_islands_to_split.remove(ready_islands.begin(), ready_islands.end());
+
+    // Deferred islands which became urgent, or all of them if the budget was
+    // removed.
+    for (auto island_entity : m_deferred_splits) {
+        if (!scheduler || sleeping_view.contains(island_entity) || could_go_to_sleep(island_entity)) {
+            if (std::find(islands_to_split.begin(), islands_to_split.end(), island_entity) == islands_to_split.end()) {
+                islands_to_split.push_back(island_entity);
+            }
+        }
+    }
+
+    for (auto island_entity : islands_to_split) {
+        split_island(island_entity);
+    }
+
+    if (scheduler && !m_deferred_splits.empty()) {
+        auto job = maintenance_scheduler::job_delegate_t{entt::connect_arg<&island_manager::split_deferred_island>, *this};
+
+        if (!scheduler->contains(job)) {
+            scheduler->schedule(job);
+        }
+    }
+}
+
+bool island_manager::split_deferred_island() {
+    while (!m_deferred_splits.empty()) {
+        auto island_entity = *m_deferred_splits.begin();
+
+        if (m_registry->valid(island_entity)) {
+            split_island(island_entity);
+            break;
+        }
+
+        m_deferred_splits.erase(island_entity);
+    }
+
+    return m_deferred_splits.empty();
+}
+
+void island_manager::split_island(entt::entity source_island_entity) {
+    m_deferred_splits.remove(source_island_entity);
 
     auto island_view = m_registry->view<island, island_AABB>();
     auto node_view = m_registry->view<graph_node>();
@@ -366,160 +539,157 @@ void island_manager::split_islands() {
     auto disabled_view = m_registry->view<disabled_tag>();
     auto &graph = m_registry->ctx().get<entity_graph>();
 
-    for (auto source_island_entity : m_islands_to_split) {
-        auto &source_island = island_view.get<edyn::island>(source_island_entity);
-
-        // Island could now be empty or contain only non-procedural entities.
-        if (source_island.nodes.empty() ||
-            std::find_if(source_island.nodes.begin(), source_island.nodes.end(),
-                         [&](auto entity){return procedural_view.contains(entity);}) == source_island.nodes.end()) {
-            EDYN_ASSERT(source_island.edges.empty());
-
-            // Remove destroyed island from non-procedural entities.
-            for (auto entity : source_island.nodes) {
-                // All nodes are non-procedural at this point so there's no
-                // need to check.
-                auto [resident] = multi_resident_view.get(entity);
-                resident.island_entities.erase(source_island_entity);
-            }
+    auto &source_island = island_view.get<edyn::island>(source_island_entity);
 
-            m_registry->destroy(source_island_entity);
-            continue;
+    // Island could now be empty or contain only non-procedural entities.
+    if (source_island.nodes.empty() ||
+        std::find_if(source_island.nodes.begin(), source_island.nodes.end(),
+                     [&](auto entity){return procedural_view.contains(entity);}) == source_island.nodes.end()) {
+        EDYN_ASSERT(source_island.edges.empty());
+
+        // Remove destroyed island from non-procedural entities.
+        for (auto entity : source_island.nodes) {
+            // All nodes are non-procedural at this point so there's no
+            // need to check.
+            auto [resident] = multi_resident_view.get(entity);
+            resident.island_entities.erase(source_island_entity);
         }
 
-        auto all_nodes = entt::sparse_set{};
-        all_nodes.push(source_island.nodes.begin(), source_island.nodes.end());
-        std::vector<edyn::island> islands;
+        m_registry->destroy(source_island_entity);
+        return;
+    }
 
-        while (!all_nodes.empty()) {
-            auto start_node_entity = *all_nodes.begin();
+    auto all_nodes = entt::sparse_set{};
+    all_nodes.push(source_island.nodes.begin(), source_island.nodes.end());
+    std::vector<edyn::island> islands;
 
-            if (!procedural_view.contains(start_node_entity)) {
-                all_nodes.erase(start_node_entity);
-                continue;
-            }
+    while (!all_nodes.empty()) {
+        auto start_node_entity = *all_nodes.begin();
 
-            auto start_node_index = node_view.get<graph_node>(start_node_entity).node_index;
-            auto &curr_island = islands.emplace_back();
+        if (!procedural_view.contains(start_node_entity)) {
+            all_nodes.erase(start_node_entity);
+            continue;
+        }
 
-            graph.traverse(start_node_index,
-                [&](auto node_index) {
-                    // Add node to island and assign island to resident.
-                    auto node_entity = graph.node_entity(node_index);
-                    curr_island.nodes.push(node_entity);
+        auto start_node_index = node_view.get<graph_node>(start_node_entity).node_index;
+        auto &curr_island = islands.emplace_back();
 
-                    // Remove visited entity from list of entities to be visited.
-                    all_nodes.remove(node_entity);
-                }, [&](auto edge_index) {
-                    auto edge_entity = graph.edge_entity(edge_index);
-                    curr_island.edges.push(edge_entity);
-                });
-        }
+        graph.traverse(start_node_index,
+            [&](auto node_index) {
+                // Add node to island and assign island to resident.
+                auto node_entity = graph.node_entity(node_index);
+                curr_island.nodes.push(node_entity);
 
-        EDYN_ASSERT(!islands.empty());
+                // Remove visited entity from list of entities to be visited.
+                all_nodes.remove(node_entity);
+            }, [&](auto edge_index) {
+                auto edge_entity = graph.edge_entity(edge_index);
+                curr_island.edges.push(edge_entity);
+            });
+    }
 
-        if (islands.size() == 1) {
-            // Island is a single connected component in the entity graph.
-            continue;
-        }
+    EDYN_ASSERT(!islands.empty());
 
-        // Find biggest island among all and move that into the original as to
-        // minimize the amount of changes.
-        unsigned biggest_size = 0;
-        unsigned biggest_idx = 0;
+    if (islands.size() == 1) {
+        // Island is a single connected component in the entity graph.
+        return;
+    }
 
-        for (unsigned i = 0; i < islands.size(); ++i) {
-            auto &island = islands[i];
+    // Find biggest island among all and move that into the original as to
+    // minimize the amount of changes.
+    unsigned biggest_size = 0;
+    unsigned biggest_idx = 0;
 
-            if (island.nodes.size() > biggest_size) {
-                biggest_size = island.nodes.size();
-                biggest_idx = i;
-            }
+    for (unsigned i = 0; i < islands.size(); ++i) {
+        auto &island = islands[i];
+
+        if (island.nodes.size() > biggest_size) {
+            biggest_size = island.nodes.size();
+            biggest_idx = i;
         }
+    }
 
-        source_island = std::move(islands[biggest_idx]);
-        // swap with last and pop.
-        islands[biggest_idx] = std::move(islands.back());
-        islands.pop_back();
+    source_island = std::move(islands[biggest_idx]);
+    // swap with last and pop.
+    islands[biggest_idx] = std::move(islands.back());
+    islands.pop_back();
 
-        remove_sleeping_tag_from_island(*m_registry, source_island_entity, source_island);
-        const bool disabled = disabled_view.contains(source_island_entity);
+    remove_sleeping_tag_from_island(*m_registry, source_island_entity, source_island);
+    const bool disabled = disabled_view.contains(source_island_entity);
 
-        /* Update island AABB. */ {
-            auto is_first_node = true;
-            auto &island_aabb = island_view.get<island_AABB>(source_island_entity);
+    /* Update island AABB. */ {
+        auto is_first_node = true;
+        auto &island_aabb = island_view.get<island_AABB>(source_island_entity);
 
-            for (auto entity : source_island.nodes) {
-                if (procedural_view.contains(entity) && aabb_view.contains(entity)) {
-                    auto [node_aabb] = aabb_view.get(entity);
+        for (auto entity : source_island.nodes) {
+            if (procedural_view.contains(entity) && aabb_view.contains(entity)) {
+                auto [node_aabb] = aabb_view.get(entity);
 
-                    if (is_first_node) {
-                        island_aabb = {node_aabb};
-                        is_first_node = false;
-                    } else {
-                        island_aabb = {enclosing_aabb(island_aabb, node_aabb)};
-                    }
+                if (is_first_node) {
+                    island_aabb = {node_aabb};
+                    is_first_node = false;
+                } else {
+                    island_aabb = {enclosing_aabb(island_aabb, node_aabb)};
                 }
             }
         }
+    }
 
-        for (auto &other_island : islands) {
-            auto island_entity_new = m_registry->create();
-            auto &island_new = m_registry->emplace<edyn::island>(island_entity_new, std::move(other_island));
-            auto &aabb = m_registry->emplace<island_AABB>(island_entity_new);
-            auto is_first_node = true;
+    for (auto &other_island : islands) {
+        auto island_entity_new = m_registry->create();
+        auto &island_new = m_registry->emplace<edyn::island>(island_entity_new, std::move(other_island));
+        auto &aabb = m_registry->emplace<island_AABB>(island_entity_new);
+        auto is_first_node = true;
 
-            for (auto node_entity : island_new.nodes) {
-                bool is_procedural = procedural_view.contains(node_entity);
+        for (auto node_entity : island_new.nodes) {
+            bool is_procedural = procedural_view.contains(node_entity);
 
-                if (is_procedural) {
-                    m_registry->patch<island_resident>(node_entity, [island_entity_new](island_resident &resident) {
-                        resident.island_entity = island_entity_new;
-                    });
-                } else {
-                    auto [resident] = multi_resident_view.get(node_entity);
-                    resident.island_entities.push(island_entity_new);
-
-                    // Remove the original island if this non-procedural entity
-                    // is not contained in it anymore.
-                    auto &original_island = m_registry->get<edyn::island>(source_island_entity);
-                    if (!original_island.nodes.contains(node_entity)) {
-                        resident.island_entities.remove(source_island_entity);
-                    }
+            if (is_procedural) {
+                m_registry->patch<island_resident>(node_entity, [island_entity_new](island_resident &resident) {
+                    resident.island_entity = island_entity_new;
+                });
+            } else {
+                auto [resident] = multi_resident_view.get(node_entity);
+                resident.island_entities.push(island_entity_new);
+
+                // Remove the original island if this non-procedural entity
+                // is not contained in it anymore.
+                auto &original_island = m_registry->get<edyn::island>(source_island_entity);
+                if (!original_island.nodes.contains(node_entity)) {
+                    resident.island_entities.remove(source_island_entity);
                 }
+            }
+
+            // Update island AABB by uniting all AABBs of all
+            // procedural entities.
+            if (is_procedural && aabb_view.contains(node_entity)) {
+                auto [node_aabb] = aabb_view.get(node_entity);
 
-                // Update island AABB by uniting all AABBs of all
-                // procedural entities.
-                if (is_procedural && aabb_view.contains(node_entity)) {
-                    auto [node_aabb] = aabb_view.get(node_entity);
-
-                    if (is_first_node) {
-                        aabb = {node_aabb};
-                        is_first_node = false;
-                    } else {
-                        aabb = {enclosing_aabb(aabb, node_aabb)};
-                    }
+                if (is_first_node) {
+                    aabb = {node_aabb};
+                    is_first_node = false;
+                } else {
+                    aabb = {enclosing_aabb(aabb, node_aabb)};
                 }
             }
+        }
 
-            for (auto edge_entity : island_new.edges) {
-                m_registry->patch<island_resident>(edge_entity, [island_entity_new](island_resident &resident) {
-                    resident.island_entity = island_entity_new;
-                });
-            }
+        for (auto edge_entity : island_new.edges) {
+            m_registry->patch<island_resident>(edge_entity, [island_entity_new](island_resident &resident) {
+                resident.island_entity = island_entity_new;
+            });
+        }
 
-            remove_sleeping_tag_from_island(*m_registry, island_entity_new, island_new);
+        remove_sleeping_tag_from_island(*m_registry, island_entity_new, island_new);
+        m_residents_moved_since_storage_sort += island_new.nodes.size() + island_new.edges.size();
 
-            m_registry->emplace<island_tag>(island_entity_new);
+        m_registry->emplace<island_tag>(island_entity_new);
 
-            // Inherit disabled status.
-            if (disabled) {
-                m_registry->emplace<disabled_tag>(island_entity_new);
-            }
+        // Inherit disabled status.
+        if (disabled) {
+            m_registry->emplace<disabled_tag>(island_entity_new);
         }
     }
-
-    m_islands_to_split.clear();
 }
 
 void island_manager::wake_up_islands() {
@@ -535,21 +705,76 @@ void island_manager::update(double timestamp) {
     wake_up_islands();
     init_new_nodes_and_edges();
     split_islands();
+    update_frozen_bodies();
     put_islands_to_sleep();
+
+    auto &graph = m_registry->ctx().get<entity_graph>();
+
+    if (auto *scheduler = find_maintenance_scheduler(*m_registry); scheduler && graph.needs_optimization()) {
+        auto job = maintenance_scheduler::job_delegate_t{entt::connect_arg<&island_manager::optimize_graph>, *this};
+
+        if (!scheduler->contains(job)) {
+            scheduler->schedule(job, maintenance_priority::low);
+        }
+    } else {
+        graph.optimize_if_needed();
+    }
+
+    sort_storages_if_needed();
     m_last_time = timestamp;
 }
 
+bool island_manager::optimize_graph() {
+    m_registry->ctx().get<entity_graph>().optimize_if_needed();
+    return true;
+}
+
+bool island_manager::sort_storages() {
+    sort_storages_by_island(*m_registry);
+    m_updates_since_storage_sort = 0;
+    m_residents_moved_since_storage_sort = 0;
+    return true;
+}
+
+void island_manager::sort_storages_if_needed() {
+    auto interval = m_registry->ctx().get<edyn::settings>().island_storage_sort_interval;
+
+    if (interval == 0) {
+        return;
+    }
+
+    ++m_updates_since_storage_sort;
+    auto num_residents = m_registry->storage<island_resident>().size();
+
+    if (m_updates_since_storage_sort >= interval ||
+        m_residents_moved_since_storage_sort > num_residents / 2) {
+        // Sorting touches all storages of the world, thus it can wait for
+        // the spare time of later steps.
+        if (auto *scheduler = find_maintenance_scheduler(*m_registry)) {
+            auto job = maintenance_scheduler::job_delegate_t{entt::connect_arg<&island_manager::sort_storages>, *this};
+
+            if (!scheduler->contains(job)) {
+                scheduler->schedule(job, maintenance_priority::low);
+            }
+        } else {
+            sort_storages();
+        }
+    }
+}
+
 void island_manager::put_to_sleep(entt::entity island_entity) {
     m_registry->emplace<sleeping_tag>(island_entity);
 
     auto &island = m_registry->get<edyn::island>(island_entity);
     auto procedural_view = m_registry->view<procedural_tag>();
 
-    // Assign `sleeping_tag` to all procedural entities.
+    // Assign `sleeping_tag` to all procedural entities. Frozen bodies are
+    // unfrozen, thus the entire island starts moving when woken up.
     for (auto entity : island.nodes) {
         if (!procedural_view.contains(entity)) continue;
 
         m_registry->emplace<sleeping_tag>(entity);
+        m_registry->remove<frozen_tag, rest_timer>(entity);
 
         if (m_registry->all_of<linvel>(entity)) {
             m_registry->get<linvel>(entity) = vector3_zero;
@@ -623,6 +848,133 @@ void island_manager::put_islands_to_sleep() {
     }
 }
 
+void island_manager::unfreeze_bodies_hit_by_contacts() {
+    auto &settings = m_registry->ctx().get<edyn::settings>();
+    auto manifold_view = awake_group<contact_manifold>(*m_registry);
+    auto frozen_view = m_registry->view<frozen_tag>();
+    auto mass_view = m_registry->view<mass_inv>();
+    auto static_view = m_registry->view<static_tag>();
+    auto kinematic_view = m_registry->view<linvel, angvel, kinematic_tag>();
+    auto bodies_to_unfreeze = std::vector<entt::entity>{};
+
+    for (auto [manifold_entity, manifold] : manifold_view.each()) {
+        auto frozen0 = frozen_view.contains(manifold.body[0]);
+        auto frozen1 = frozen_view.contains(manifold.body[1]);
+
+        if (frozen0 == frozen1) {
+            continue;
+        }
+
+        auto frozen_entity = frozen0 ? manifold.body[0] : manifold.body[1];
+        auto other_entity = frozen0 ? manifold.body[1] : manifold.body[0];
+
+        if (static_view.contains(other_entity)) {
+            continue;
+        }
+
+        // No rows are solved between frozen and kinematic bodies, thus they
+        // unfreeze once touched by a moving kinematic body.
+        if (kinematic_view.contains(other_entity)) {
+            auto [v, w] = kinematic_view.get<linvel, angvel>(other_entity);
+
+            if ((length_sqr(v) > island_linear_sleep_threshold * island_linear_sleep_threshold) ||
+                (length_sqr(w) > island_angular_sleep_threshold * island_angular_sleep_threshold)) {
+                bodies_to_unfreeze.push_back(frozen_entity);
+            }
+
+            continue;
+        }
+
+        // The impulses were applied in the previous step. An impulse that would
+        // accelerate the frozen body by more than a few times gravity means it
+        // was hit by something, while bodies resting on top of it are not enough.
+        auto normal_impulse = scalar(0);
+        manifold.each_point([&](const contact_point &cp, const contact_point_cold &cold) {
+            normal_impulse += cp.normal_impulse + cold.normal_restitution_impulse;
+        });
+
+        scalar inv_m = mass_view.get<mass_inv>(frozen_entity);
+
+        if (normal_impulse * inv_m > frozen_body_wake_acceleration * settings.fixed_dt) {
+            bodies_to_unfreeze.push_back(frozen_entity);
+        }
+    }
+
+    for (auto entity : bodies_to_unfreeze) {
+        m_registry->remove<frozen_tag>(entity);
+    }
+}
+
+void island_manager::freeze_resting_bodies() {
+    auto island_view = m_registry->view<island>(exclude_sleeping_disabled);
+    auto body_view = m_registry->view<linvel, angvel, dynamic_tag>(entt::exclude<frozen_tag, sleeping_disabled_tag>);
+    auto timer_view = m_registry->view<rest_timer>();
+    auto manifold_view = m_registry->view<contact_manifold>();
+    auto node_view = m_registry->view<graph_node>();
+    auto &graph = m_registry->ctx().get<entity_graph>();
+    auto bodies_to_freeze = std::vector<entt::entity>{};
+
+    for (auto [island_entity, island] : island_view.each()) {
+        for (auto entity : island.nodes) {
+            if (!body_view.contains(entity)) {
+                continue;
+            }
+
+            auto [v, w] = body_view.get<linvel, angvel>(entity);
+
+            if ((length_sqr(v) > island_linear_sleep_threshold * island_linear_sleep_threshold) ||
+                (length_sqr(w) > island_angular_sleep_threshold * island_angular_sleep_threshold)) {
+                if (timer_view.contains(entity)) {
+                    m_registry->remove<rest_timer>(entity);
+                }
+                continue;
+            }
+
+            if (!timer_view.contains(entity)) {
+                m_registry->emplace<rest_timer>(entity, m_last_time);
+                continue;
+            }
+
+            if (m_last_time - timer_view.get<rest_timer>(entity).timestamp < body_time_to_freeze) {
+                continue;
+            }
+
+            // Contacts are the only constraints which can unfreeze a body,
+            // thus bodies attached to other constraints stay unfrozen.
+            auto only_contacts = true;
+            auto node_index = node_view.get<graph_node>(entity).node_index;
+
+            graph.visit_edges(node_index, [&](auto edge_index) {
+                only_contacts = manifold_view.contains(graph.edge_entity(edge_index));
+                return only_contacts;
+            });
+
+            if (only_contacts) {
+                bodies_to_freeze.push_back(entity);
+            }
+        }
+    }
+
+    for (auto entity : bodies_to_freeze) {
+        m_registry->remove<rest_timer>(entity);
+        m_registry->emplace<frozen_tag>(entity);
+        m_registry->get<linvel>(entity) = vector3_zero;
+        m_registry->get<angvel>(entity) = vector3_zero;
+    }
+}
+
+void island_manager::update_frozen_bodies() {
+    auto &settings = m_registry->ctx().get<edyn::settings>();
+
+    if (!settings.freeze_resting_bodies) {
+        m_registry->clear<frozen_tag, rest_timer>();
+        return;
+    }
+
+    unfreeze_bodies_hit_by_contacts();
+    freeze_resting_bodies();
+}
+
 void island_manager::set_procedural(entt::entity entity, bool is_procedural) {
     if (is_procedural) {
         if (auto *resident = m_registry->try_get<multi_island_resident>(entity)) {
@@ -641,6 +993,7 @@ void island_manager::set_procedural(entt::entity entity, bool is_procedural) {
                 if (resident->island_entities.size() > 1) {
                     auto island_entities = std::vector(resident->island_entities.begin(), resident->island_entities.end());
                     merged_island_entity = merge_islands(island_entities, {}, {});
+                    destroy_merged_islands();
                 } else {
                     merged_island_entity = *resident->island_entities.begin();
                 }
@@ -662,4 +1015,97 @@ void island_manager::set_procedural(entt::entity entity, bool is_procedural) {
     }
 }
 
+void island_manager::set_procedural(const std::vector<entt::entity> &entities, bool is_procedural) {
+    if (!is_procedural) {
+        // Turning non-procedural does not touch other islands.
+        for (auto entity : entities) {
+            set_procedural(entity, false);
+        }
+        return;
+    }
+
+    // Find sets of islands which are connected by the entities, using a
+    // disjoint-set forest indexed by the position of the islands in a sparse
+    // set. Each set becomes a single island.
+    auto multi_resident_view = m_registry->view<multi_island_resident>();
+    auto island_entities = entt::sparse_set{};
+    auto parent = std::vector<size_t>{};
+    constexpr auto no_island = std::numeric_limits<size_t>::max();
+    auto entity_island = std::vector<size_t>(entities.size(), no_island);
+
+    auto find_root = [&](size_t index) {
+        while (parent[index] != index) {
+            parent[index] = parent[parent[index]];
+            index = parent[index];
+        }
+        return index;
+    };
+
+    for (size_t i = 0; i < entities.size(); ++i) {
+        if (!multi_resident_view.contains(entities[i])) {
+            continue;
+        }
+
+        auto [resident] = multi_resident_view.get(entities[i]);
+
+        for (auto island_entity : resident.island_entities) {
+            if (!island_entities.contains(island_entity)) {
+                parent.push_back(island_entities.size());
+                island_entities.push(island_entity);
+            }
+
+            auto index = static_cast<size_t>(island_entities.index(island_entity));
+
+            if (entity_island[i] == no_island) {
+                entity_island[i] = index;
+            } else {
+                parent[find_root(index)] = find_root(entity_island[i]);
+            }
+        }
+    }
+
+    auto groups = std::vector<std::vector<entt::entity>>(island_entities.size());
+
+    for (size_t index = 0; index < island_entities.size(); ++index) {
+        groups[find_root(index)].push_back(island_entities.data()[index]);
+    }
+
+    // Merge each group once and store the surviving island at its root.
+    auto merged_island_entities = std::vector<entt::entity>(island_entities.size(), entt::null);
+
+    for (size_t root = 0; root < groups.size(); ++root) {
+        auto &group = groups[root];
+
+        if (group.size() > 1) {
+            merged_island_entities[root] = merge_islands(group, {}, {});
+        } else if (group.size() == 1) {
+            merged_island_entities[root] = group.front();
+        }
+    }
+
+    destroy_merged_islands();
+
+    for (size_t i = 0; i < entities.size(); ++i) {
+        auto entity = entities[i];
+
+        if (!multi_resident_view.contains(entity)) {
+            continue;
+        }
+
+        if (entity_island[i] == no_island) {
+            // Not connected to anything procedural thus it gets its own island.
+            set_procedural(entity, true);
+            continue;
+        }
+
+        auto island_entity = merged_island_entities[find_root(entity_island[i])];
+        EDYN_ASSERT(island_entity != entt::null);
+
+        // Must clear because `on_destroy_multi_island_resident` will be called.
+        multi_resident_view.get<multi_island_resident>(entity).island_entities.clear();
+        m_registry->remove<multi_island_resident>(entity);
+        m_registry->emplace<island_resident>(entity, island_entity);
+    }
+}
+
 }
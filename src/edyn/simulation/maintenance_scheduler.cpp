@@ -0,0 +1,118 @@
+#include "edyn/simulation/maintenance_scheduler.hpp"
+#include "edyn/context/settings.hpp"
+#include "edyn/simulation/stepper_async.hpp"
+#include "edyn/config/config.h"
+#include "edyn/time/time.hpp"
+#include <entt/entity/registry.hpp>
+#include <algorithm>
+
+namespace edyn {
+
+void maintenance_scheduler::schedule(job_delegate_t job, maintenance_priority priority) {
+    EDYN_ASSERT(!contains(job));
+    m_jobs.push_back({job, priority, m_next_sequence++});
+    std::push_heap(m_jobs.begin(), m_jobs.end(), entry_compare{});
+}
+
+void maintenance_scheduler::cancel(job_delegate_t job) {
+    if (job == m_running_job) {
+        m_running_job_cancelled = true;
+        return;
+    }
+
+    auto it = std::remove_if(m_jobs.begin(), m_jobs.end(), [&](auto &e) {
+        return e.job == job;
+    });
+
+    if (it != m_jobs.end()) {
+        m_jobs.erase(it, m_jobs.end());
+        std::make_heap(m_jobs.begin(), m_jobs.end(), entry_compare{});
+    }
+}
+
+bool maintenance_scheduler::contains(job_delegate_t job) const {
+    if (job == m_running_job && !m_running_job_cancelled) {
+        return true;
+    }
+
+    return std::find_if(m_jobs.begin(), m_jobs.end(), [&](auto &e) {
+        return e.job == job;
+    }) != m_jobs.end();
+}
+
+void maintenance_scheduler::run_top() {
+    // Take the job out of the heap while it runs, since it could schedule or
+    // cancel other jobs. If it's not done, it's pushed back with the same
+    // sequence, which keeps its place among the jobs of its priority.
+    std::pop_heap(m_jobs.begin(), m_jobs.end(), entry_compare{});
+    auto top = m_jobs.back();
+    m_jobs.pop_back();
+
+    m_running_job = top.job;
+    m_running_job_cancelled = false;
+    auto done = top.job();
+    auto cancelled = m_running_job_cancelled;
+    m_running_job = {};
+
+    if (!done && !cancelled) {
+        m_jobs.push_back(top);
+        std::push_heap(m_jobs.begin(), m_jobs.end(), entry_compare{});
+    }
+}
+
+unsigned maintenance_scheduler::run(double budget) {
+    if (m_jobs.empty()) {
+        return 0;
+    }
+
+    auto start = performance_time();
+    unsigned num_slices = 0;
+
+    do {
+        run_top();
+        ++num_slices;
+    } while (!m_jobs.empty() && performance_time() - start < budget);
+
+    return num_slices;
+}
+
+unsigned maintenance_scheduler::finish() {
+    unsigned num_slices = 0;
+
+    while (!m_jobs.empty()) {
+        run_top();
+        ++num_slices;
+    }
+
+    return num_slices;
+}
+
+void finish_maintenance(entt::registry &registry) {
+    if (auto *stepper = registry.ctx().find<stepper_async>()) {
+        stepper->finish_maintenance();
+    } else if (auto *scheduler = registry.ctx().find<maintenance_scheduler>()) {
+        scheduler->finish();
+    }
+}
+
+}
+
+namespace edyn::internal {
+
+void run_maintenance(entt::registry &registry) {
+    auto *scheduler = registry.ctx().find<maintenance_scheduler>();
+
+    if (!scheduler || scheduler->empty()) {
+        return;
+    }
+
+    auto budget = registry.ctx().get<settings>().maintenance_budget;
+
+    if (budget > 0) {
+        scheduler->run(budget);
+    } else {
+        scheduler->finish();
+    }
+}
+
+}
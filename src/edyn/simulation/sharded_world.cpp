@@ -0,0 +1,252 @@
+#include "edyn/simulation/sharded_world.hpp"
+#include "edyn/comp/graph_edge.hpp"
+#include "edyn/comp/graph_node.hpp"
+#include "edyn/comp/island.hpp"
+#include "edyn/comp/position.hpp"
+#include "edyn/comp/present_position.hpp"
+#include "edyn/comp/present_orientation.hpp"
+#include "edyn/comp/tag.hpp"
+#include "edyn/collision/contact_manifold.hpp"
+#include "edyn/constraints/null_constraint.hpp"
+#include "edyn/core/entity_graph.hpp"
+#include "edyn/replication/entity_map.hpp"
+#include "edyn/replication/make_reg_op_builder.hpp"
+#include "edyn/util/constraint_util.hpp"
+#include <entt/entity/registry.hpp>
+#include <limits>
+#include <unordered_map>
+
+namespace edyn {
+
+sharded_raycast_result closest_raycast_result(sharded_query_future<raycast_result> &future) {
+    auto closest = sharded_raycast_result{};
+    closest.shard = 0;
+
+    for (size_t i = 0; i < future.size(); ++i) {
+        auto &result = future.get(i);
+
+        if (result.entity != entt::null && result.fraction < closest.result.fraction) {
+            closest.shard = i;
+            closest.result = result;
+        }
+    }
+
+    return closest;
+}
+
+sharded_world::sharded_world(const std::vector<AABB> &regions, const init_config &config) {
+    EDYN_ASSERT(!regions.empty());
+    EDYN_ASSERT(config.execution_mode == execution_mode::asynchronous);
+
+    for (auto &region : regions) {
+        auto &shard = m_shards.emplace_back();
+        shard.region = region;
+        shard.registry = std::make_unique<entt::registry>();
+        attach(*shard.registry, config);
+    }
+}
+
+sharded_world::~sharded_world() {
+    for (auto &shard : m_shards) {
+        detach(*shard.registry);
+    }
+}
+
+size_t sharded_world::shard_at(const vector3 &point) const {
+    auto closest = size_t{0};
+    auto closest_dist_sqr = std::numeric_limits<scalar>::max();
+
+    for (size_t i = 0; i < m_shards.size(); ++i) {
+        auto &region = m_shards[i].region;
+
+        if (region.contains(point)) {
+            return i;
+        }
+
+        auto dist_sqr = distance_sqr(point, max(region.min, min(point, region.max)));
+
+        if (dist_sqr < closest_dist_sqr) {
+            closest = i;
+            closest_dist_sqr = dist_sqr;
+        }
+    }
+
+    return closest;
+}
+
+sharded_entity sharded_world::make_rigidbody(const rigidbody_def &def) {
+    EDYN_ASSERT(def.kind == rigidbody_kind::rb_dynamic);
+    auto shard = shard_at(def.position);
+    return {shard, edyn::make_rigidbody(*m_shards[shard].registry, def)};
+}
+
+std::vector<entt::entity> sharded_world::make_shared_rigidbody(const rigidbody_def &def) {
+    EDYN_ASSERT(def.kind != rigidbody_kind::rb_dynamic);
+    auto entities = std::vector<entt::entity>{};
+
+    for (auto &shard : m_shards) {
+        entities.push_back(edyn::make_rigidbody(*shard.registry, def));
+    }
+
+    m_shared_bodies.push_back(entities);
+
+    return entities;
+}
+
+void sharded_world::update() {
+    for (auto &shard : m_shards) {
+        edyn::update(*shard.registry);
+    }
+
+    for (size_t i = 0; i < m_shards.size(); ++i) {
+        auto &registry = *m_shards[i].registry;
+        auto &region = m_shards[i].region;
+
+        // The AABB of islands is not kept up to date in the main registry,
+        // thus it's calculated from the positions of the bodies, which are.
+        auto island_entities = std::unordered_map<entt::entity, std::vector<entt::entity>>{};
+        auto island_bounds = std::unordered_map<entt::entity, AABB>{};
+        auto body_view = registry.view<island_resident, position, dynamic_tag>();
+
+        for (auto [entity, resident, pos] : body_view.each()) {
+            if (resident.island_entity == entt::null) {
+                continue;
+            }
+
+            auto [it, inserted] = island_bounds.try_emplace(resident.island_entity, AABB{pos, pos});
+
+            if (!inserted) {
+                it->second = enclosing_aabb(it->second, AABB{pos, pos});
+            }
+        }
+
+        for (auto [island_entity, bounds] : island_bounds) {
+            if (!region.contains(bounds.center())) {
+                island_entities[island_entity];
+            }
+        }
+
+        if (island_entities.empty()) {
+            continue;
+        }
+
+        // Contact manifolds are not migrated since they're recreated by the
+        // broadphase of the other shard.
+        auto resident_view = registry.view<island_resident>(entt::exclude<contact_manifold>);
+
+        for (auto [entity, resident] : resident_view.each()) {
+            if (auto it = island_entities.find(resident.island_entity); it != island_entities.end()) {
+                it->second.push_back(entity);
+            }
+        }
+
+        for (auto &[island_entity, entities] : island_entities) {
+            auto target = shard_at(island_bounds.at(island_entity).center());
+
+            if (target != i) {
+                migrate_island(i, target, entities);
+            }
+        }
+    }
+}
+
+void sharded_world::migrate_island(size_t from, size_t to, const std::vector<entt::entity> &entities) {
+    auto &src = *m_shards[from].registry;
+    auto &dst = *m_shards[to].registry;
+
+    auto builder = make_reg_op_builder(src);
+    builder->create(entities.begin(), entities.end());
+    builder->emplace_all(entities);
+    auto ops = builder->finish();
+    // Islands are assigned by the simulation worker of the new shard, which
+    // starts off with the island awake.
+    ops.erase_payload<island_resident, sleeping_tag>();
+
+    // Constraints attached to shared bodies must refer to the copy of the
+    // body in the new shard.
+    auto emap = entity_map{};
+
+    for (auto &shared : m_shared_bodies) {
+        emap.insert(shared[from], shared[to]);
+    }
+
+    auto &graph = dst.ctx().get<entity_graph>();
+
+    ops.execute(dst, emap, [&](operation_base *op) {
+        if (op->operation_type() != registry_operation_type::emplace) {
+            return;
+        }
+
+        auto local_entity = emap.at(op->entity);
+
+        // Insert nodes and edges for bodies and constraints, same as when
+        // importing entities from the simulation worker.
+        if (op->payload_type_any_of<rigidbody_tag, external_tag>()) {
+            auto non_connecting = !dst.any_of<procedural_tag>(local_entity);
+            auto node_index = graph.insert_node(local_entity, non_connecting);
+            dst.emplace<graph_node>(local_entity, node_index);
+
+            if (non_connecting) {
+                dst.emplace<multi_island_resident>(local_entity);
+            } else {
+                dst.emplace<island_resident>(local_entity);
+            }
+        }
+
+        if (op->payload_type_any_of(constraints_tuple) || op->payload_type_any_of<null_constraint>()) {
+            if (!dst.any_of<graph_edge>(local_entity)) {
+                create_graph_edge_for_constraints(dst, local_entity, graph, constraints_tuple);
+                create_graph_edge_for_constraint<null_constraint>(dst, local_entity, graph);
+                dst.emplace<island_resident>(local_entity);
+            }
+        }
+    });
+
+    // Components which are not shared are not part of the operation.
+    for (auto entity : entities) {
+        if (auto *pos = src.try_get<present_position>(entity)) {
+            dst.emplace<present_position>(emap.at(entity), *pos);
+        }
+
+        if (auto *orn = src.try_get<present_orientation>(entity)) {
+            dst.emplace<present_orientation>(emap.at(entity), *orn);
+        }
+    }
+
+    for (auto entity : entities) {
+        m_migrate_signal.publish(sharded_entity{from, entity}, sharded_entity{to, emap.at(entity)});
+    }
+
+    // Destroying the bodies also destroys their constraints.
+    for (auto entity : entities) {
+        if (src.valid(entity)) {
+            src.destroy(entity);
+        }
+    }
+}
+
+sharded_query_future<raycast_result> sharded_world::raycast_async(vector3 p0, vector3 p1) {
+    auto futures = std::vector<query_future<raycast_result>>{};
+
+    for (auto &shard : m_shards) {
+        futures.push_back(raycast_async_future(*shard.registry, p0, p1));
+    }
+
+    return {std::move(futures)};
+}
+
+sharded_query_future<query_aabb_result> sharded_world::query_aabb_async(const AABB &aabb,
+                                                                        bool query_procedural,
+                                                                        bool query_non_procedural,
+                                                                        bool query_islands) {
+    auto futures = std::vector<query_future<query_aabb_result>>{};
+
+    for (auto &shard : m_shards) {
+        futures.push_back(query_aabb_async_future(*shard.registry, aabb, query_procedural,
+                                                  query_non_procedural, query_islands));
+    }
+
+    return {std::move(futures)};
+}
+
+}
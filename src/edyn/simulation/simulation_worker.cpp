@@ -1,5 +1,8 @@
 #include "edyn/simulation/simulation_worker.hpp"
 #include "edyn/collision/broadphase.hpp"
+#include "edyn/collision/collision_stats.hpp"
+#include "edyn/collision/sensor.hpp"
+#include "edyn/collision/contact_event_stream.hpp"
 #include "edyn/collision/contact_manifold.hpp"
 #include "edyn/collision/contact_manifold_map.hpp"
 #include "edyn/collision/narrowphase.hpp"
@@ -12,18 +15,23 @@
 #include "edyn/comp/origin.hpp"
 #include "edyn/comp/center_of_mass.hpp"
 #include "edyn/config/config.h"
+#include "edyn/config/memory_resource.hpp"
 #include "edyn/constraints/null_constraint.hpp"
 #include "edyn/math/vector3.hpp"
 #include "edyn/networking/comp/discontinuity.hpp"
 #include "edyn/networking/sys/accumulate_discontinuities.hpp"
 #include "edyn/networking/util/process_extrapolation_result.hpp"
 #include "edyn/networking/util/snap_to_pool_snapshot.hpp"
+#include "edyn/networking/util/reconcile_pool_snapshot.hpp"
 #include "edyn/parallel/job.hpp"
 #include "edyn/comp/island.hpp"
 #include "edyn/parallel/message_dispatcher.hpp"
 #include "edyn/replication/entity_map.hpp"
+#include "edyn/sys/shift_origin.hpp"
+#include "edyn/simulation/maintenance_scheduler.hpp"
 #include "edyn/sys/update_aabbs.hpp"
 #include "edyn/sys/update_inertias.hpp"
+#include "edyn/sys/update_paged_meshes.hpp"
 #include "edyn/sys/update_rotated_meshes.hpp"
 #include "edyn/parallel/job_dispatcher.hpp"
 #include "edyn/parallel/message.hpp"
@@ -32,21 +40,29 @@
 #include "edyn/comp/graph_node.hpp"
 #include "edyn/comp/graph_edge.hpp"
 #include "edyn/comp/rotated_mesh_list.hpp"
+#include "edyn/config/constants.hpp"
 #include "edyn/math/constants.hpp"
 #include "edyn/math/transform.hpp"
 #include "edyn/util/aabb_util.hpp"
+#include "edyn/util/frame_arena.hpp"
+#include "edyn/util/memory_stats.hpp"
+#include "edyn/util/profiling.hpp"
+#include "edyn/util/step_profile.hpp"
 #include "edyn/util/constraint_util.hpp"
 #include "edyn/util/island_util.hpp"
 #include "edyn/util/rigidbody.hpp"
 #include "edyn/util/vector_util.hpp"
 #include "edyn/replication/registry_operation.hpp"
+#include "edyn/replication/registry_operation_pool.hpp"
 #include "edyn/replication/registry_operation_builder.hpp"
 #include "edyn/context/settings.hpp"
+#include "edyn/parallel/thread_affinity.hpp"
 #include "edyn/context/registry_operation_context.hpp"
 #include "edyn/networking/extrapolation/extrapolation_result.hpp"
 #include <entt/core/type_info.hpp>
 #include <entt/entity/fwd.hpp>
 #include <entt/entity/registry.hpp>
+#include <thread>
 #include <algorithm>
 #include <atomic>
 #include <mutex>
@@ -69,27 +85,42 @@ simulation_worker::simulation_worker(const settings &settings,
         msg::set_registry_operation_context,
         msg::step_simulation,
         msg::set_com,
+        msg::shift_origin,
+        msg::finish_maintenance,
         msg::set_material_table,
         msg::update_entities,
         msg::apply_network_pools,
         msg::wake_up_residents,
         msg::change_rigidbody_kind,
         msg::raycast_request,
+        msg::raycast_batch_request,
+        msg::shape_cast_request,
+        msg::overlap_request,
         msg::query_aabb_request,
+        msg::query_aabb_batch_request,
         msg::query_aabb_of_interest_request,
-        extrapolation_result>("worker"))
+        msg::query_memory_stats_request,
+        extrapolation_result>())
 {
     m_registry.ctx().emplace<contact_manifold_map>(m_registry);
+    m_registry.ctx().emplace<maintenance_scheduler>();
     m_registry.ctx().emplace<broadphase>(m_registry);
     m_registry.ctx().emplace<narrowphase>(m_registry);
     m_registry.ctx().emplace<entity_graph>();
     m_registry.ctx().emplace<edyn::settings>(settings);
     m_registry.ctx().emplace<registry_operation_context>(reg_op_ctx);
     m_registry.ctx().emplace<material_mix_table>(material_table);
+    m_registry.ctx().emplace<step_profile>();
+    m_registry.ctx().emplace<collision_stats>();
+    m_registry.ctx().emplace<sensor_event_buffer>();
+    m_registry.ctx().emplace<constraint_break_event_buffer>();
+    m_registry.ctx().emplace<contact_event_buffer>();
+    m_registry.ctx().emplace<contact_event_stream>(m_registry);
 }
 
 simulation_worker::~simulation_worker() {
     stop();
+    message_dispatcher::global().destroy_queue(m_message_queue.id);
 
     // The destructor of `polyhedron_shape_initializer` touches `m_registry` when
     // destroying `rotated_mesh_list` elements it creates for compound shapes
@@ -105,17 +136,25 @@ void simulation_worker::init() {
     m_connections.push_back(m_registry.on_destroy<graph_node>().connect<&simulation_worker::on_destroy_shared_entity>(*this));
     m_connections.push_back(m_registry.on_destroy<graph_edge>().connect<&simulation_worker::on_destroy_shared_entity>(*this));
     m_connections.push_back(m_registry.on_destroy<island_tag>().connect<&simulation_worker::on_destroy_shared_entity>(*this));
+    m_connections.push_back(m_registry.on_destroy<transform_mirror_slot>().connect<&transform_mirror::on_destroy_slot>(m_transform_mirror));
 
     m_message_queue.sink<msg::update_entities>().connect<&simulation_worker::on_update_entities>(*this);
     m_message_queue.sink<msg::set_paused>().connect<&simulation_worker::on_set_paused>(*this);
     m_message_queue.sink<msg::step_simulation>().connect<&simulation_worker::on_step_simulation>(*this);
     m_message_queue.sink<msg::set_com>().connect<&simulation_worker::on_set_com>(*this);
+    m_message_queue.sink<msg::shift_origin>().connect<&simulation_worker::on_shift_origin>(*this);
+    m_message_queue.sink<msg::finish_maintenance>().connect<&simulation_worker::on_finish_maintenance>(*this);
     m_message_queue.sink<msg::set_settings>().connect<&simulation_worker::on_set_settings>(*this);
     m_message_queue.sink<msg::set_registry_operation_context>().connect<&simulation_worker::on_set_reg_op_ctx>(*this);
     m_message_queue.sink<msg::set_material_table>().connect<&simulation_worker::on_set_material_table>(*this);
     m_message_queue.sink<msg::raycast_request>().connect<&simulation_worker::on_raycast_request>(*this);
+    m_message_queue.sink<msg::raycast_batch_request>().connect<&simulation_worker::on_raycast_batch_request>(*this);
+    m_message_queue.sink<msg::shape_cast_request>().connect<&simulation_worker::on_shape_cast_request>(*this);
+    m_message_queue.sink<msg::overlap_request>().connect<&simulation_worker::on_overlap_request>(*this);
     m_message_queue.sink<msg::query_aabb_request>().connect<&simulation_worker::on_query_aabb_request>(*this);
+    m_message_queue.sink<msg::query_aabb_batch_request>().connect<&simulation_worker::on_query_aabb_batch_request>(*this);
     m_message_queue.sink<msg::query_aabb_of_interest_request>().connect<&simulation_worker::on_query_aabb_of_interest_request>(*this);
+    m_message_queue.sink<msg::query_memory_stats_request>().connect<&simulation_worker::on_query_memory_stats_request>(*this);
     m_message_queue.sink<msg::apply_network_pools>().connect<&simulation_worker::on_apply_network_pools>(*this);
     m_message_queue.sink<msg::wake_up_residents>().connect<&simulation_worker::on_wake_up_residents>(*this);
     m_message_queue.sink<msg::change_rigidbody_kind>().connect<&simulation_worker::on_change_rigidbody_kind>(*this);
@@ -273,6 +312,9 @@ void simulation_worker::on_update_entities(message<msg::update_entities> &msg) {
 
     // Wake up all islands involved.
     wake_up_affected_islands(msg.content.ops);
+
+    // Give the memory back to be reused by the builder of the main thread.
+    registry_operation_pool::global().release(std::move(ops));
 }
 
 void simulation_worker::wake_up_affected_islands(const registry_operation &ops) {
@@ -297,14 +339,32 @@ void simulation_worker::wake_up_affected_islands(const registry_operation &ops)
 }
 
 void simulation_worker::sync() {
-    if (!m_op_builder->empty()) {
-        auto &&ops = std::move(m_op_builder->finish());
+    auto stats = std::unique_ptr<collision_stats>{};
+
+    if (m_registry.ctx().get<settings>().collect_collision_stats) {
+        stats = std::make_unique<collision_stats>(m_registry.ctx().get<collision_stats>());
+    }
+
+    auto &sensor_events = m_registry.ctx().get<sensor_event_buffer>().events;
+    auto &contact_events = m_registry.ctx().get<contact_event_buffer>().events;
+    auto &break_events = m_registry.ctx().get<constraint_break_event_buffer>().events;
+
+    m_op_observer->flush();
+
+    if (!m_op_builder->empty() || stats || !sensor_events.empty() || !contact_events.empty() ||
+        !break_events.empty()) {
+        auto ops = m_op_builder->finish();
         message_dispatcher::global().send<msg::step_update>(
-            {"main"}, m_message_queue.identifier, std::move(ops), m_sim_time);
+            m_main_queue, m_message_queue.id, std::move(ops), m_sim_time, m_origin_shift_count,
+            std::move(stats), std::move(sensor_events), std::move(contact_events), std::move(break_events));
+        sensor_events.clear();
+        contact_events.clear();
+        break_events.clear();
     }
 }
 
-void simulation_worker::start() {
+void simulation_worker::start(message_queue_id main_queue) {
+    m_main_queue = main_queue;
     m_running.store(true, std::memory_order_release);
 
     auto &settings = m_registry.ctx().get<edyn::settings>();
@@ -323,6 +383,7 @@ void simulation_worker::stop() {
 }
 
 void simulation_worker::update() {
+    EDYN_PROFILE_ZONE("simulation_worker::update");
     // Must clear before reading messages to avoid accumulating over values that
     // have already been sent to main thread.
     clear_accumulated_discontinuities_quietly(m_registry);
@@ -357,21 +418,35 @@ void simulation_worker::update() {
         step_dt = advance_dt / effective_steps;
     }
 
-    m_poly_initializer.init_new_shapes();
+    m_poly_initializer.init_new_shapes(true);
 
     auto &nphase = m_registry.ctx().get<narrowphase>();
     auto &bphase = m_registry.ctx().get<broadphase>();
     bphase.init_new_aabb_entities();
 
+    auto *profile = internal::find_step_profile(m_registry);
+
     for (unsigned i = 0; i < effective_steps; ++i) {
         if (settings.pre_step_callback) {
             (*settings.pre_step_callback)(m_registry);
         }
 
+        auto timer = step_profile_timer(profile);
         bphase.update(true);
+        timer.record(step_phase::broadphase);
         m_island_manager.update(m_sim_time);
+        timer.record(step_phase::island_management);
+        update_paged_meshes(m_registry);
+        timer.record(step_phase::paged_meshes);
         nphase.update(true);
+        timer.record(step_phase::narrowphase);
         m_solver.update(true);
+        timer.skip();
+        internal::run_maintenance(m_registry);
+        timer.record(step_phase::maintenance);
+        timer.finish();
+        internal::update_collision_stats(m_registry);
+        m_registry.ctx().get<contact_event_stream>().update();
 
         m_sim_time += step_dt;
 
@@ -383,37 +458,110 @@ void simulation_worker::update() {
             (*settings.post_step_callback)(m_registry);
         }
 
-        mark_transforms_replaced();
+        write_mirrors();
         sync();
     }
 
+    if (profile && effective_steps > 0) {
+        send_step_profile();
+    }
+
     m_last_time = m_current_time;
     m_sim_time = m_last_time - m_accumulated_time;
 }
 
+void simulation_worker::write_mirrors() {
+    m_transform_mirror.write(m_registry, m_entity_map, m_sim_time, m_origin_shift_count);
+
+    if (m_registry.ctx().get<edyn::settings>().publish_broadphase) {
+        auto &bphase = m_registry.ctx().get<broadphase>();
+        m_broadphase_mirror.write(bphase, m_entity_map, m_origin_shift_count);
+    }
+}
+
+void simulation_worker::send_step_profile() {
+    message_dispatcher::global().send<msg::step_profile_update>(
+        m_main_queue, m_message_queue.id, m_registry.ctx().get<step_profile>());
+}
+
+void simulation_worker::wait_next_update(double dt, double &deadline, double &i_term) {
+    auto &settings = m_registry.ctx().get<edyn::settings>();
+    auto desired_dt = static_cast<double>(settings.fixed_dt);
+
+    switch (settings.pacing) {
+    case simulation_pacing::adaptive_delay: {
+        // Use a PID to keep updates at a fixed and controlled rate.
+        auto proportional_term = 0.18;
+        auto integral_term = 0.06;
+        auto error = desired_dt - dt;
+        i_term = std::max(-1.0, std::min(i_term + integral_term * error, 1.0));
+        auto delay = std::max(0.0, proportional_term * error + i_term);
+        edyn::delay(delay * 1000);
+        break;
+    }
+    case simulation_pacing::deadline: {
+        auto now = (*settings.time_func)();
+        deadline += desired_dt;
+
+        // If running behind, e.g. after a long step or after switching to
+        // this mode, start over from now instead of rushing to catch up.
+        // Late steps are already made up for in the next update.
+        if (deadline < now || deadline > now + desired_dt) {
+            deadline = now;
+            break;
+        }
+
+        sleep_for(deadline - now - simulation_deadline_spin_time);
+
+        while ((*settings.time_func)() < deadline) {
+            std::this_thread::yield();
+        }
+        break;
+    }
+    case simulation_pacing::as_fast_as_possible:
+        break;
+    }
+}
+
 void simulation_worker::run() {
-    // Use a PID to keep updates at a fixed and controlled rate.
-    auto proportional_term = 0.18;
-    auto integral_term = 0.06;
     auto i_term = 0.0;
+    auto deadline = 0.0;
 
     m_finished.store(false, std::memory_order_relaxed);
+    EDYN_PROFILE_THREAD_NAME("edyn simulation");
+    set_current_thread_affinity(m_registry.ctx().get<settings>().simulation_thread_cores);
+    job_dispatcher::bind_current(m_registry.ctx().get<settings>().dispatcher);
+    memory_resource::bind_current(m_registry.ctx().get<settings>().memory_resource);
     m_current_time = (*m_registry.ctx().get<settings>().time_func)();
     init();
 
+    auto prev_pacing = m_registry.ctx().get<settings>().pacing;
+
     while (m_running.load(std::memory_order_relaxed)) {
-        auto t1 = (*m_registry.ctx().get<settings>().time_func)();
+        auto &settings = m_registry.ctx().get<edyn::settings>();
+        auto pacing = settings.pacing;
+        auto as_fast_as_possible = pacing == simulation_pacing::as_fast_as_possible;
+        // Time advances by exactly one step per update when running as fast
+        // as possible, which is not related to the clock.
+        auto t1 = as_fast_as_possible ? m_current_time + settings.fixed_dt : (*settings.time_func)();
+
+        if (prev_pacing == simulation_pacing::as_fast_as_possible && !as_fast_as_possible) {
+            // Continue from the current time after running apart from the clock.
+            m_last_time += t1 - m_current_time;
+            m_current_time = t1;
+        }
+
         auto dt = t1 - m_current_time;
         m_current_time = t1;
+        prev_pacing = pacing;
         update();
         sync();
 
-        // Apply delay to maintain a fixed update rate.
-        auto desired_dt = m_registry.ctx().get<settings>().fixed_dt;
-        auto error = desired_dt - dt;
-        i_term = std::max(-1.0, std::min(i_term + integral_term * error, 1.0));
-        auto delay = std::max(0.0, proportional_term * error + i_term);
-        edyn::delay(delay * 1000);
+        if (!as_fast_as_possible) {
+            m_tick_jitter.record(dt - settings.fixed_dt);
+        }
+
+        wait_next_update(dt, deadline, i_term);
     }
 
     deinit();
@@ -426,17 +574,26 @@ void simulation_worker::run() {
 void simulation_worker::consume_raycast_results() {
     auto &dispatcher = message_dispatcher::global();
     m_raycast_service.consume_results([&](unsigned id, raycast_result &result) {
-        dispatcher.send<msg::raycast_response>(
-            {"main"}, m_message_queue.identifier, id, result);
+        if (auto it = m_raycast_promises.find(id); it != m_raycast_promises.end()) {
+            it->second.set_value(result);
+            m_raycast_promises.erase(it);
+        } else {
+            dispatcher.send<msg::raycast_response>(
+                m_main_queue, m_message_queue.id, id, result);
+        }
+    });
+    m_raycast_service.consume_batch_results([&](unsigned id, std::vector<raycast_result> &results) {
+        dispatcher.send<msg::raycast_batch_response>(
+            m_main_queue, m_message_queue.id, id, std::move(results));
+    });
+    m_raycast_service.consume_shape_cast_results([&](unsigned id, std::vector<shape_cast_result> &results) {
+        dispatcher.send<msg::shape_cast_response>(
+            m_main_queue, m_message_queue.id, id, std::move(results));
+    });
+    m_raycast_service.consume_overlap_results([&](unsigned id, std::vector<overlap_result> &results) {
+        dispatcher.send<msg::overlap_response>(
+            m_main_queue, m_message_queue.id, id, std::move(results));
     });
-}
-
-void simulation_worker::mark_transforms_replaced() {
-    auto body_view = m_registry.view<position, orientation, linvel, angvel, dynamic_tag>(exclude_sleeping_disabled);
-    m_op_builder->replace<position>(body_view.begin(), body_view.end());
-    m_op_builder->replace<orientation>(body_view.begin(), body_view.end());
-    m_op_builder->replace<linvel>(body_view.begin(), body_view.end());
-    m_op_builder->replace<angvel>(body_view.begin(), body_view.end());
 }
 
 void simulation_worker::on_set_paused(message<msg::set_paused> &msg) {
@@ -450,34 +607,58 @@ void simulation_worker::on_set_paused(message<msg::set_paused> &msg) {
     }
 }
 
-void simulation_worker::on_step_simulation(message<msg::step_simulation> &) {
+void simulation_worker::on_step_simulation(message<msg::step_simulation> &msg) {
     m_last_time = m_current_time;
     m_sim_time = m_last_time;
 
     auto &bphase = m_registry.ctx().get<broadphase>();
     auto &nphase = m_registry.ctx().get<narrowphase>();
     auto &settings = m_registry.ctx().get<edyn::settings>();
+    auto *profile = internal::find_step_profile(m_registry);
 
-    if (settings.pre_step_callback) {
-        (*settings.pre_step_callback)(m_registry);
-    }
+    for (unsigned i = 0; i < msg.content.num_steps; ++i) {
+        // Further steps advance by exactly one fixed step each.
+        if (i > 0) {
+            m_sim_time += settings.fixed_dt;
+        }
 
-    m_poly_initializer.init_new_shapes();
-    bphase.update(true);
-    m_island_manager.update(m_last_time);
-    nphase.update(true);
-    m_solver.update(true);
+        if (settings.pre_step_callback) {
+            (*settings.pre_step_callback)(m_registry);
+        }
 
-    if (settings.clear_actions_func) {
-        (*settings.clear_actions_func)(m_registry);
-    }
+        m_poly_initializer.init_new_shapes(true);
+        auto timer = step_profile_timer(profile);
+        bphase.update(true);
+        timer.record(step_phase::broadphase);
+        m_island_manager.update(m_sim_time);
+        timer.record(step_phase::island_management);
+        update_paged_meshes(m_registry);
+        timer.record(step_phase::paged_meshes);
+        nphase.update(true);
+        timer.record(step_phase::narrowphase);
+        m_solver.update(true);
+        timer.skip();
+        internal::run_maintenance(m_registry);
+        timer.record(step_phase::maintenance);
+        timer.finish();
+        internal::update_collision_stats(m_registry);
+        m_registry.ctx().get<contact_event_stream>().update();
+
+        if (settings.clear_actions_func) {
+            (*settings.clear_actions_func)(m_registry);
+        }
 
-    if (settings.post_step_callback) {
-        (*settings.post_step_callback)(m_registry);
+        if (settings.post_step_callback) {
+            (*settings.post_step_callback)(m_registry);
+        }
     }
 
-    mark_transforms_replaced();
+    write_mirrors();
     sync();
+
+    if (profile && msg.content.num_steps > 0) {
+        send_step_profile();
+    }
 }
 
 void simulation_worker::on_set_settings(message<msg::set_settings> &msg) {
@@ -495,6 +676,24 @@ void simulation_worker::on_set_settings(message<msg::set_settings> &msg) {
         m_island_manager.set_last_time(m_last_time);
     }
 
+    // Messages are processed in the simulation thread, thus this moves the
+    // world onto the new dispatcher before the next step.
+    if (settings.dispatcher != current.dispatcher) {
+        job_dispatcher::bind_current(settings.dispatcher);
+    }
+
+    if (settings.simulation_thread_cores != current.simulation_thread_cores) {
+        set_current_thread_affinity(settings.simulation_thread_cores);
+    }
+
+    if (settings.profile_steps && !current.profile_steps) {
+        m_registry.ctx().get<step_profile>().reset();
+    }
+
+    if (settings.collect_collision_stats && !current.collect_collision_stats) {
+        m_registry.ctx().get<collision_stats>() = {};
+    }
+
     current = settings;
 
     if (std::holds_alternative<client_network_settings>(settings.network_settings)) {
@@ -524,6 +723,17 @@ void simulation_worker::on_set_com(message<msg::set_com> &msg) {
     }
 }
 
+void simulation_worker::on_shift_origin(message<msg::shift_origin> &msg) {
+    // Send pending changes first since they're in the previous frame.
+    sync();
+    shift_origin(m_registry, msg.content.offset);
+    ++m_origin_shift_count;
+}
+
+void simulation_worker::on_finish_maintenance(message<msg::finish_maintenance> &) {
+    m_registry.ctx().get<maintenance_scheduler>().finish();
+}
+
 void simulation_worker::on_raycast_request(message<msg::raycast_request> &msg) {
     auto ignore_entities = std::vector<entt::entity>{};
 
@@ -534,6 +744,84 @@ void simulation_worker::on_raycast_request(message<msg::raycast_request> &msg) {
         }
     }
     m_raycast_service.add_ray(msg.content.p0, msg.content.p1, msg.content.id, ignore_entities);
+
+    if (msg.content.promise.valid()) {
+        m_raycast_promises.emplace(msg.content.id, std::move(msg.content.promise));
+    }
+}
+
+void simulation_worker::on_raycast_batch_request(message<msg::raycast_batch_request> &msg) {
+    auto &request = msg.content;
+    auto ignore_entities = std::vector<entt::entity>{};
+
+    for (auto remote_entity : request.ignore_entities) {
+        if (m_entity_map.contains(remote_entity)) {
+            ignore_entities.push_back(m_entity_map.at(remote_entity));
+        }
+    }
+
+    m_raycast_service.add_ray_batch(request.rays, request.id, std::move(ignore_entities), request.any_hit);
+}
+
+void simulation_worker::on_shape_cast_request(message<msg::shape_cast_request> &msg) {
+    auto &request = msg.content;
+    auto ignore_entities = std::vector<entt::entity>{};
+
+    for (auto remote_entity : request.ignore_entities) {
+        if (m_entity_map.contains(remote_entity)) {
+            ignore_entities.push_back(m_entity_map.at(remote_entity));
+        }
+    }
+
+    m_raycast_service.add_shape_cast_batch(request.queries, request.id, std::move(ignore_entities));
+}
+
+void simulation_worker::on_overlap_request(message<msg::overlap_request> &msg) {
+    auto &request = msg.content;
+    auto ignore_entities = std::vector<entt::entity>{};
+
+    for (auto remote_entity : request.ignore_entities) {
+        if (m_entity_map.contains(remote_entity)) {
+            ignore_entities.push_back(m_entity_map.at(remote_entity));
+        }
+    }
+
+    m_raycast_service.add_overlap_batch(request.queries, request.id, std::move(ignore_entities));
+}
+
+void simulation_worker::on_query_aabb_batch_request(message<msg::query_aabb_batch_request> &msg) {
+    auto &bphase = m_registry.ctx().get<broadphase>();
+    auto &request = msg.content;
+    auto response = msg::query_aabb_batch_response{};
+    response.id = request.id;
+    response.results.resize(request.aabbs.size());
+
+    for (size_t i = 0; i < request.aabbs.size(); ++i) {
+        auto &aabb = request.aabbs[i];
+        auto &result = response.results[i];
+
+        if (request.query_islands) {
+            bphase.query_islands(aabb, [&result](entt::entity island_entity) {
+                result.island_entities.push_back(island_entity);
+            });
+        }
+
+        if (request.query_procedural) {
+            bphase.query_procedural(aabb, [&result](entt::entity entity) {
+                result.procedural_entities.push_back(entity);
+            });
+        }
+
+        if (request.query_non_procedural) {
+            bphase.query_non_procedural(aabb, [&result](entt::entity entity) {
+                result.non_procedural_entities.push_back(entity);
+            });
+        }
+    }
+
+    auto &dispatcher = message_dispatcher::global();
+    dispatcher.send<msg::query_aabb_batch_response>(
+            m_main_queue, m_message_queue.id, std::move(response));
 }
 
 void simulation_worker::on_query_aabb_request(message<msg::query_aabb_request> &msg) {
@@ -560,9 +848,24 @@ void simulation_worker::on_query_aabb_request(message<msg::query_aabb_request> &
         });
     }
 
+    if (request.promise.valid()) {
+        auto result = query_aabb_result{};
+        result.procedural_entities = std::move(response.procedural_entities);
+        result.non_procedural_entities = std::move(response.non_procedural_entities);
+        result.island_entities = std::move(response.island_entities);
+        request.promise.set_value(std::move(result));
+        return;
+    }
+
     auto &dispatcher = message_dispatcher::global();
     dispatcher.send<msg::query_aabb_response>(
-            {"main"}, m_message_queue.identifier, std::move(response));
+            m_main_queue, m_message_queue.id, std::move(response));
+}
+
+void simulation_worker::on_query_memory_stats_request(message<msg::query_memory_stats_request> &msg) {
+    auto stats = memory_stats{};
+    internal::collect_simulation_memory_stats(m_registry, m_solver, stats);
+    msg.content.promise.set_value(std::move(stats));
 }
 
 void simulation_worker::on_query_aabb_of_interest_request(message<msg::query_aabb_of_interest_request> &msg) {
@@ -571,9 +874,13 @@ void simulation_worker::on_query_aabb_of_interest_request(message<msg::query_aab
     auto island_view = m_registry.view<island>();
     auto manifold_view = m_registry.view<contact_manifold>();
     auto procedural_view = m_registry.view<procedural_tag>();
-    entt::sparse_set procedural_entities;
-    entt::sparse_set np_entities;
-    entt::sparse_set island_entities;
+
+    // The sets are only needed until the response is built.
+    using frame_sparse_set = entt::basic_sparse_set<entt::entity, allocator<entt::entity>>;
+    auto scope = frame_scope{};
+    auto procedural_entities = frame_sparse_set(scope.get_allocator<entt::entity>());
+    auto np_entities = frame_sparse_set(scope.get_allocator<entt::entity>());
+    auto island_entities = frame_sparse_set(scope.get_allocator<entt::entity>());
 
     // Collect entities of islands which intersect the AABB of interest.
     bphase.query_islands(request.aabb, [&](entt::entity island_entity) {
@@ -615,7 +922,7 @@ void simulation_worker::on_query_aabb_of_interest_request(message<msg::query_aab
 
     auto &dispatcher = message_dispatcher::global();
     dispatcher.send<msg::query_aabb_response>(
-            {"main"}, m_message_queue.identifier, std::move(response));
+            m_main_queue, m_message_queue.id, std::move(response));
 }
 
 void simulation_worker::on_extrapolation_result(message<extrapolation_result> &msg) {
@@ -626,8 +933,19 @@ void simulation_worker::on_extrapolation_result(message<extrapolation_result> &m
 void simulation_worker::on_apply_network_pools(message<msg::apply_network_pools> &msg) {
     EDYN_ASSERT(!msg.content.pools.empty());
     auto &snap = msg.content;
+    auto &settings = m_registry.ctx().get<edyn::settings>();
+    auto *client_settings = std::get_if<client_network_settings>(&settings.network_settings);
+    auto corrected = std::vector<entt::entity>{};
+
+    // Only wake up the islands of the entities which are corrected.
+    if (client_settings) {
+        reconcile_pool_snapshot(m_registry, m_entity_map, snap.entities, snap.pools, *client_settings, corrected);
+    } else {
+        corrected = snap.entities;
+    }
+
     snap_to_pool_snapshot(m_registry, m_entity_map, snap.entities, snap.pools, snap.should_accumulate_discontinuities);
-    wake_up_island_residents(m_registry, snap.entities, m_entity_map);
+    wake_up_island_residents(m_registry, corrected, m_entity_map);
 }
 
 void simulation_worker::on_wake_up_residents(message<msg::wake_up_residents> &msg) {
@@ -635,9 +953,13 @@ void simulation_worker::on_wake_up_residents(message<msg::wake_up_residents> &ms
 }
 
 void simulation_worker::on_change_rigidbody_kind(message<msg::change_rigidbody_kind> &msg) {
-    for (auto [entity, kind] : msg.content.changes) {
-        internal::rigidbody_apply_kind(m_registry, m_entity_map.at(entity), kind, m_island_manager);
+    auto changes = msg.content.changes;
+
+    for (auto &change : changes) {
+        change.first = m_entity_map.at(change.first);
     }
+
+    internal::rigidbody_apply_kind(m_registry, changes, m_island_manager);
 }
 
 }
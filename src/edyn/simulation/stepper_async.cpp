@@ -1,9 +1,13 @@
 #include "edyn/simulation/stepper_async.hpp"
 #include "edyn/collision/contact_event_emitter.hpp"
+#include "edyn/collision/contact_event_stream.hpp"
 #include "edyn/collision/contact_manifold_events.hpp"
 #include "edyn/collision/query_aabb.hpp"
+#include "edyn/collision/sensor.hpp"
 #include "edyn/comp/child_list.hpp"
 #include "edyn/comp/island.hpp"
+#include "edyn/comp/origin.hpp"
+#include "edyn/comp/position.hpp"
 #include "edyn/comp/tag.hpp"
 #include "edyn/constraints/null_constraint.hpp"
 #include "edyn/constraints/constraint.hpp"
@@ -15,10 +19,13 @@
 #include "edyn/comp/graph_node.hpp"
 #include "edyn/comp/graph_edge.hpp"
 #include "edyn/replication/registry_operation.hpp"
+#include "edyn/replication/registry_operation_pool.hpp"
 #include "edyn/context/settings.hpp"
+#include "edyn/context/task_util.hpp"
 #include "edyn/dynamics/material_mixing.hpp"
 #include "edyn/util/constraint_util.hpp"
 #include <entt/entity/registry.hpp>
+#include <algorithm>
 #include <numeric>
 
 namespace edyn {
@@ -28,9 +35,14 @@ stepper_async::stepper_async(entt::registry &registry, double time)
     , m_message_queue_handle(
         message_dispatcher::global().make_queue<
             msg::step_update,
+            msg::step_profile_update,
             msg::raycast_response,
-            msg::query_aabb_response
-        >("main"))
+            msg::raycast_batch_response,
+            msg::shape_cast_response,
+            msg::overlap_response,
+            msg::query_aabb_response,
+            msg::query_aabb_batch_response
+        >())
     , m_worker(registry.ctx().get<settings>(),
                registry.ctx().get<registry_operation_context>(),
                registry.ctx().get<material_mix_table>())
@@ -44,14 +56,25 @@ stepper_async::stepper_async(entt::registry &registry, double time)
     m_connections.push_back(registry.on_construct<child_list>().connect<&stepper_async::on_construct_shared>(*this));
 
     m_message_queue_handle.sink<msg::step_update>().connect<&stepper_async::on_step_update>(*this);
+    m_message_queue_handle.sink<msg::step_profile_update>().connect<&stepper_async::on_step_profile_update>(*this);
     m_message_queue_handle.sink<msg::raycast_response>().connect<&stepper_async::on_raycast_response>(*this);
+    m_message_queue_handle.sink<msg::raycast_batch_response>().connect<&stepper_async::on_raycast_batch_response>(*this);
+    m_message_queue_handle.sink<msg::shape_cast_response>().connect<&stepper_async::on_shape_cast_response>(*this);
+    m_message_queue_handle.sink<msg::overlap_response>().connect<&stepper_async::on_overlap_response>(*this);
     m_message_queue_handle.sink<msg::query_aabb_response>().connect<&stepper_async::on_query_aabb_response>(*this);
+    m_message_queue_handle.sink<msg::query_aabb_batch_response>().connect<&stepper_async::on_query_aabb_batch_response>(*this);
 
     auto &reg_op_ctx = m_registry->ctx().get<registry_operation_context>();
     m_op_builder = (*reg_op_ctx.make_reg_op_builder)(*m_registry);
     m_op_observer = (*reg_op_ctx.make_reg_op_observer)(*m_op_builder);
 
-    m_worker.start();
+    m_worker.start(m_message_queue_handle.id);
+}
+
+stepper_async::~stepper_async() {
+    // Stop the worker before destroying the queue it sends messages to.
+    m_worker.stop();
+    message_dispatcher::global().destroy_queue(m_message_queue_handle.id);
 }
 
 void stepper_async::on_construct_shared(entt::registry &registry, entt::entity entity) {
@@ -114,14 +137,60 @@ void stepper_async::on_step_update(message<msg::step_update> &msg) {
     m_op_observer->set_active(false);
 
     m_sim_time = msg.content.timestamp;
+
+    if (msg.content.stats) {
+        registry.ctx().get<collision_stats>() = *msg.content.stats;
+    }
+
     // Only calculate delay if the sim time was set.
     m_should_calculate_presentation_delay = true;
 
-    auto &ops = msg.content.ops;
-    ops.execute(registry, m_entity_map, [&](operation_base *op) {
+    // The state might have been taken before the worker applied the latest
+    // origin shifts, which were already applied to this registry.
+    m_step_update_origin_shift_count = msg.content.origin_shift_count;
+    auto origin_offset = m_origin_shifts.offset_since(msg.content.origin_shift_count);
+    auto has_origin_offset = origin_offset != vector3_zero;
+
+    // Broken constraints are destroyed by the operations, thus their entities
+    // must be mapped before executing them.
+    auto &break_events = registry.ctx().get<constraint_break_event_buffer>().events;
+
+    for (auto &event : msg.content.constraint_break_events) {
+        auto entity = map_result_entity(event.entity);
+        auto body0 = map_result_entity(event.body[0]);
+        auto body1 = map_result_entity(event.body[1]);
+
+        if (entity != entt::null) {
+            break_events.push_back(constraint_break_event{entity, {body0, body1}, event.impulse});
+        }
+    }
+
+    // Replacements must be safe to process concurrently in here for different
+    // components, see `min_step_update_parallel_size`.
+    auto process_op = [&](operation_base *op) {
         auto op_type = op->operation_type();
         auto remote_entity = op->entity;
 
+        if (has_origin_offset &&
+            (op_type == registry_operation_type::emplace || op_type == registry_operation_type::replace) &&
+            m_entity_map.contains(remote_entity)) {
+            auto local_entity = m_entity_map.at(remote_entity);
+
+            if (op->payload_type_any_of<position>()) {
+                registry.get<position>(local_entity) -= origin_offset;
+            } else if (op->payload_type_any_of<origin>()) {
+                registry.get<origin>(local_entity) -= origin_offset;
+            } else if (op->payload_type_any_of<AABB>()) {
+                auto &aabb = registry.get<AABB>(local_entity);
+                aabb.min -= origin_offset;
+                aabb.max -= origin_offset;
+            } else if (op->payload_type_any_of<island_AABB>()) {
+                auto &aabb = registry.get<island_AABB>(local_entity);
+                aabb.min -= origin_offset;
+                aabb.max -= origin_offset;
+            }
+        }
+
         // Insert entity mappings for new entities into the current op.
         if (op_type == registry_operation_type::create) {
             auto local_entity = m_entity_map.at(remote_entity);
@@ -155,15 +224,70 @@ void stepper_async::on_step_update(message<msg::step_update> &msg) {
                 create_graph_edge_for_constraint<null_constraint>(registry, local_entity, graph);
             }
         }
-    });
+    };
+
+    auto &ops = msg.content.ops;
+    auto &settings = registry.ctx().get<edyn::settings>();
+
+    if (settings.min_step_update_parallel_size > 0 &&
+        ops.operations.size() >= settings.min_step_update_parallel_size) {
+        // Entities, tags and graph nodes are created in order first. Then,
+        // replacements of different components are applied in parallel,
+        // since each group only modifies the pool of its component.
+        auto num_groups = ops.execute_except_replace(registry, m_entity_map, m_replace_groups, process_op);
+
+        auto task_func = [&](unsigned start, unsigned end) {
+            for (auto i = start; i < end; ++i) {
+                registry_operation::execute_replace_group(registry, m_entity_map, m_replace_groups[i], process_op);
+            }
+        };
+
+        if (num_groups > 0) {
+            auto task = task_delegate_t(entt::connect_arg_t<&decltype(task_func)::operator()>{}, task_func);
+            enqueue_task_wait(registry, task, static_cast<unsigned>(num_groups));
+        }
+    } else {
+        ops.execute(registry, m_entity_map, process_op);
+    }
 
     m_importing = false;
     m_op_observer->set_active(true);
 
+    // Give the memory back to be reused by the builder of the worker.
+    registry_operation_pool::global().release(std::move(ops));
+
     // Must consume events after each snapshot to avoid losing any event that
     // could be overriden in the next snapshot.
     auto &emitter = registry.ctx().get<contact_event_emitter>();
     emitter.consume_events();
+
+    // Events of entities destroyed in the meantime are dropped.
+    auto &sensor_events = registry.ctx().get<sensor_event_buffer>().events;
+
+    for (auto &event : msg.content.sensor_events) {
+        auto sensor = map_result_entity(event.sensor);
+        auto other = map_result_entity(event.other);
+
+        if (sensor != entt::null && other != entt::null) {
+            sensor_events.push_back(sensor_event{sensor, other, event.type});
+        }
+    }
+
+    auto &contact_events = registry.ctx().get<contact_event_buffer>().events;
+
+    for (auto &event : msg.content.contact_events) {
+        auto body0 = map_result_entity(event.body[0]);
+        auto body1 = map_result_entity(event.body[1]);
+
+        if (body0 != entt::null && body1 != entt::null) {
+            auto &local_event = contact_events.emplace_back(event);
+            local_event.body = {body0, body1};
+        }
+    }
+}
+
+void stepper_async::on_step_profile_update(message<msg::step_profile_update> &msg) {
+    m_registry->ctx().get<step_profile>() = msg.content.profile;
 }
 
 void stepper_async::on_raycast_response(message<msg::raycast_response> &msg) {
@@ -211,7 +335,103 @@ void stepper_async::on_query_aabb_response(message<msg::query_aabb_response> &ms
     m_query_aabb_ctx.erase(response.id);
 }
 
+entt::entity stepper_async::map_result_entity(entt::entity entity) const {
+    if (entity != entt::null && m_entity_map.contains(entity)) {
+        return m_entity_map.at(entity);
+    }
+
+    return entt::null;
+}
+
+void stepper_async::on_raycast_batch_response(message<msg::raycast_batch_response> &msg) {
+    auto &response = msg.content;
+
+    // Map entities in place, the results are handed to the delegate as is.
+    for (auto &result : response.results) {
+        result.entity = map_result_entity(result.entity);
+    }
+
+    auto &ctx = m_raycast_batch_ctx.at(response.id);
+    ctx.delegate(response.id, response.results);
+    m_raycast_batch_ctx.erase(response.id);
+}
+
+void stepper_async::on_shape_cast_response(message<msg::shape_cast_response> &msg) {
+    auto &response = msg.content;
+
+    for (auto &result : response.results) {
+        result.entity = map_result_entity(result.entity);
+    }
+
+    auto &ctx = m_shape_cast_ctx.at(response.id);
+
+    if (ctx.batch_delegate) {
+        ctx.batch_delegate(response.id, response.results);
+    } else {
+        ctx.delegate(response.id, response.results.front());
+    }
+
+    m_shape_cast_ctx.erase(response.id);
+}
+
+void stepper_async::on_overlap_response(message<msg::overlap_response> &msg) {
+    auto &response = msg.content;
+
+    // Drop hits on entities unknown to the main registry, e.g. destroyed in
+    // the meantime.
+    for (auto &result : response.results) {
+        auto last = std::remove_if(result.hits.begin(), result.hits.end(), [&](overlap_hit &hit) {
+            hit.entity = map_result_entity(hit.entity);
+            return hit.entity == entt::null;
+        });
+        result.hits.erase(last, result.hits.end());
+    }
+
+    auto &ctx = m_overlap_ctx.at(response.id);
+
+    if (ctx.batch_delegate) {
+        ctx.batch_delegate(response.id, response.results);
+    } else {
+        ctx.delegate(response.id, response.results.front());
+    }
+
+    m_overlap_ctx.erase(response.id);
+}
+
+// Drops entities unknown to the main registry, e.g. destroyed in the
+// meantime, and maps the others in place.
+static void map_query_aabb_result(const entity_map &emap, query_aabb_result &result) {
+    auto map_entities = [&](std::vector<entt::entity> &entities) {
+        auto last = std::remove_if(entities.begin(), entities.end(), [&](entt::entity entity) {
+            return !emap.contains(entity);
+        });
+        entities.erase(last, entities.end());
+
+        for (auto &entity : entities) {
+            entity = emap.at(entity);
+        }
+    };
+
+    map_entities(result.island_entities);
+    map_entities(result.procedural_entities);
+    map_entities(result.non_procedural_entities);
+}
+
+void stepper_async::on_query_aabb_batch_response(message<msg::query_aabb_batch_response> &msg) {
+    auto &response = msg.content;
+
+    for (auto &result : response.results) {
+        map_query_aabb_result(m_entity_map, result);
+    }
+
+    auto &ctx = m_query_aabb_batch_ctx.at(response.id);
+    ctx.delegate(response.id, response.results);
+    m_query_aabb_batch_ctx.erase(response.id);
+}
+
 void stepper_async::sync() {
+    m_op_observer->flush();
+
     if (!m_op_builder->empty()) {
         send_message_to_worker<msg::update_entities>(m_op_builder->finish());
     }
@@ -257,10 +477,37 @@ void stepper_async::calculate_presentation_delay(double current_time, double ela
 }
 
 void stepper_async::update(double current_time) {
+    // Only keep the sensor, contact and constraint break events received in
+    // this update.
+    m_registry->ctx().get<sensor_event_buffer>().events.clear();
+    m_registry->ctx().get<contact_event_buffer>().events.clear();
+    m_registry->ctx().get<constraint_break_event_buffer>().events.clear();
     m_message_queue_handle.update();
-    sync();
 
+    // Transforms of dynamic bodies are taken from the latest state published
+    // by the worker, which is at least as recent as the last step update.
+    auto &mirror = m_worker.get_transform_mirror();
+
+    if (mirror.read(*m_registry, m_sim_time, &m_origin_shifts)) {
+        m_should_calculate_presentation_delay = true;
+    }
+
+    // Shifts are no longer needed once both the step updates and the mirrors
+    // carry state taken after them.
+    auto acknowledged_shifts = std::min(m_step_update_origin_shift_count,
+                                        mirror.read_origin_shift_count());
     auto &settings = m_registry->ctx().get<edyn::settings>();
+
+    if (settings.publish_broadphase) {
+        auto &bphase_mirror = m_worker.get_broadphase_mirror();
+        bphase_mirror.read(&m_origin_shifts);
+        acknowledged_shifts = std::min(acknowledged_shifts, bphase_mirror.read_origin_shift_count());
+    }
+
+    m_origin_shifts.acknowledge(acknowledged_shifts);
+
+    sync();
+
     if (settings.clear_actions_func) {
         (*settings.clear_actions_func)(*m_registry);
     }
@@ -289,8 +536,8 @@ void stepper_async::set_paused(bool paused) {
     send_message_to_worker<msg::set_paused>(paused);
 }
 
-void stepper_async::step_simulation() {
-    send_message_to_worker<msg::step_simulation>();
+void stepper_async::step_simulation(unsigned num_steps) {
+    send_message_to_worker<msg::step_simulation>(num_steps);
 }
 
 void stepper_async::settings_changed() {
@@ -314,6 +561,19 @@ void stepper_async::set_center_of_mass(entt::entity entity, const vector3 &com)
     send_message_to_worker<msg::set_com>(entity, com);
 }
 
+void stepper_async::shift_origin(const vector3 &offset) {
+    // Pending changes are in the previous frame, thus they must reach the
+    // worker before the shift.
+    sync();
+    edyn::shift_origin(*m_registry, offset);
+    m_origin_shifts.push(offset);
+    send_message_to_worker<msg::shift_origin>(offset);
+}
+
+void stepper_async::finish_maintenance() {
+    send_message_to_worker<msg::finish_maintenance>();
+}
+
 void stepper_async::wake_up_entity(entt::entity entity) {
     auto msg = std::vector<entt::entity>{};
     msg.push_back(entity);
@@ -329,6 +589,22 @@ void stepper_async::set_rigidbody_kind(entt::entity entity, rigidbody_kind kind)
     send_message_to_worker<msg::change_rigidbody_kind>(std::move(msg));
 }
 
+void stepper_async::wake_up_entities(const std::vector<entt::entity> &entities) {
+    send_message_to_worker<msg::wake_up_residents>(entities);
+}
+
+void stepper_async::set_rigidbody_kind(const std::vector<entt::entity> &entities, rigidbody_kind kind) {
+    sync();
+    auto msg = msg::change_rigidbody_kind{};
+    msg.changes.reserve(entities.size());
+
+    for (auto entity : entities) {
+        msg.changes.emplace_back(entity, kind);
+    }
+
+    send_message_to_worker<msg::change_rigidbody_kind>(std::move(msg));
+}
+
 raycast_id_type stepper_async::raycast(vector3 p0, vector3 p1,
                                        const raycast_delegate_type &delegate,
                                        std::vector<entt::entity> ignore_entities) {
@@ -342,6 +618,100 @@ raycast_id_type stepper_async::raycast(vector3 p0, vector3 p1,
     return id;
 }
 
+query_future<raycast_result> stepper_async::raycast_future(vector3 p0, vector3 p1,
+                                                           std::vector<entt::entity> ignore_entities) {
+    // The result holds entities of the simulation worker, which are mapped
+    // into the main registry when the result is taken in the main thread.
+    auto promise = query_promise<raycast_result>{};
+    auto future = promise.get_future([this](raycast_result &result) {
+        result.entity = map_result_entity(result.entity);
+    });
+    send_message_to_worker<msg::raycast_request>(m_next_raycast_id++, p0, p1,
+                                                 std::move(ignore_entities), std::move(promise));
+
+    return future;
+}
+
+query_future<query_aabb_result> stepper_async::query_aabb_future(const AABB &aabb,
+                                                                 bool query_procedural,
+                                                                 bool query_non_procedural,
+                                                                 bool query_islands) {
+    auto promise = query_promise<query_aabb_result>{};
+    auto future = promise.get_future([this](query_aabb_result &result) {
+        map_query_aabb_result(m_entity_map, result);
+    });
+    send_message_to_worker<msg::query_aabb_request>(m_next_query_aabb_id++, aabb, query_procedural,
+                                                    query_non_procedural, query_islands, std::move(promise));
+
+    return future;
+}
+
+raycast_id_type stepper_async::raycast_batch(std::vector<raycast_query> rays,
+                                             const raycast_batch_delegate_type &delegate,
+                                             std::vector<entt::entity> ignore_entities,
+                                             bool any_hit) {
+    auto id = m_next_raycast_id++;
+    m_raycast_batch_ctx[id].delegate = delegate;
+    send_message_to_worker<msg::raycast_batch_request>(id, std::move(rays), std::move(ignore_entities), any_hit);
+
+    return id;
+}
+
+shape_cast_id_type stepper_async::shape_cast(const shape_cast_query &query,
+                                             const shape_cast_delegate_type &delegate,
+                                             std::vector<entt::entity> ignore_entities) {
+    auto id = m_next_shape_cast_id++;
+    m_shape_cast_ctx[id].delegate = delegate;
+    send_message_to_worker<msg::shape_cast_request>(id, std::vector<shape_cast_query>{query},
+                                                    std::move(ignore_entities));
+
+    return id;
+}
+
+shape_cast_id_type stepper_async::shape_cast_batch(std::vector<shape_cast_query> queries,
+                                                   const shape_cast_batch_delegate_type &delegate,
+                                                   std::vector<entt::entity> ignore_entities) {
+    auto id = m_next_shape_cast_id++;
+    m_shape_cast_ctx[id].batch_delegate = delegate;
+    send_message_to_worker<msg::shape_cast_request>(id, std::move(queries), std::move(ignore_entities));
+
+    return id;
+}
+
+overlap_id_type stepper_async::overlap(const overlap_query &query,
+                                       const overlap_delegate_type &delegate,
+                                       std::vector<entt::entity> ignore_entities) {
+    auto id = m_next_overlap_id++;
+    m_overlap_ctx[id].delegate = delegate;
+    send_message_to_worker<msg::overlap_request>(id, std::vector<overlap_query>{query},
+                                                 std::move(ignore_entities));
+
+    return id;
+}
+
+overlap_id_type stepper_async::overlap_batch(std::vector<overlap_query> queries,
+                                             const overlap_batch_delegate_type &delegate,
+                                             std::vector<entt::entity> ignore_entities) {
+    auto id = m_next_overlap_id++;
+    m_overlap_ctx[id].batch_delegate = delegate;
+    send_message_to_worker<msg::overlap_request>(id, std::move(queries), std::move(ignore_entities));
+
+    return id;
+}
+
+query_aabb_id_type stepper_async::query_aabb_batch(std::vector<AABB> aabbs,
+                                                   const query_aabb_batch_delegate_type &delegate,
+                                                   bool query_procedural,
+                                                   bool query_non_procedural,
+                                                   bool query_islands) {
+    auto id = m_next_query_aabb_id++;
+    m_query_aabb_batch_ctx[id].delegate = delegate;
+    send_message_to_worker<msg::query_aabb_batch_request>(id, std::move(aabbs), query_procedural,
+                                                          query_non_procedural, query_islands);
+
+    return id;
+}
+
 query_aabb_id_type stepper_async::query_aabb(const AABB &aabb,
                                              const query_aabb_delegate_type &delegate,
                                              bool query_procedural,
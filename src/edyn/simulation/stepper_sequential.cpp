@@ -1,14 +1,25 @@
 #include "edyn/simulation/stepper_sequential.hpp"
 #include "edyn/collision/contact_event_emitter.hpp"
+#include "edyn/collision/contact_event_stream.hpp"
 #include "edyn/context/settings.hpp"
 #include "edyn/collision/broadphase.hpp"
+#include "edyn/collision/collision_stats.hpp"
 #include "edyn/collision/contact_manifold_map.hpp"
 #include "edyn/collision/narrowphase.hpp"
+#include "edyn/collision/sensor.hpp"
+#include "edyn/config/memory_resource.hpp"
+#include "edyn/constraints/breakable_constraint.hpp"
+#include "edyn/context/task_util.hpp"
 #include "edyn/core/entity_graph.hpp"
 #include "edyn/dynamics/material_mixing.hpp"
+#include "edyn/parallel/job_dispatcher.hpp"
+#include "edyn/simulation/maintenance_scheduler.hpp"
 #include "edyn/sys/update_presentation.hpp"
+#include "edyn/sys/update_paged_meshes.hpp"
+#include "edyn/util/step_profile.hpp"
 #include <entt/entity/registry.hpp>
 #include <cstdint>
+#include <thread>
 
 namespace edyn {
 
@@ -25,6 +36,10 @@ stepper_sequential::stepper_sequential(entt::registry &registry, double time, bo
 }
 
 void stepper_sequential::update(double time) {
+    m_registry->ctx().get<sensor_event_buffer>().events.clear();
+    m_registry->ctx().get<contact_event_buffer>().events.clear();
+    m_registry->ctx().get<constraint_break_event_buffer>().events.clear();
+
     if (m_paused) {
         m_island_manager.update(m_last_time);
         snap_presentation(*m_registry);
@@ -44,6 +59,7 @@ void stepper_sequential::update(double time) {
     auto &bphase = m_registry->ctx().get<broadphase>();
     auto &nphase = m_registry->ctx().get<narrowphase>();
     auto &emitter = m_registry->ctx().get<contact_event_emitter>();
+    auto &event_stream = m_registry->ctx().get<contact_event_stream>();
 
     auto effective_steps = num_steps;
     auto step_dt = fixed_dt;
@@ -55,9 +71,11 @@ void stepper_sequential::update(double time) {
     }
 
     // Initialize new AABBs and shapes even in case num_steps is zero.
-    m_poly_initializer.init_new_shapes();
+    m_poly_initializer.init_new_shapes(m_multithreaded);
     bphase.init_new_aabb_entities();
 
+    auto *profile = internal::find_step_profile(*m_registry);
+
     for (unsigned i = 0; i < effective_steps; ++i) {
         auto step_time = sim_time + step_dt * i;
 
@@ -65,10 +83,22 @@ void stepper_sequential::update(double time) {
             (*settings.pre_step_callback)(*m_registry);
         }
 
+        auto timer = step_profile_timer(profile);
         bphase.update(m_multithreaded);
+        timer.record(step_phase::broadphase);
         m_island_manager.update(step_time);
+        timer.record(step_phase::island_management);
+        update_paged_meshes(*m_registry);
+        timer.record(step_phase::paged_meshes);
         nphase.update(m_multithreaded);
+        timer.record(step_phase::narrowphase);
         m_solver.update(m_multithreaded);
+        timer.skip();
+        internal::run_maintenance(*m_registry);
+        timer.record(step_phase::maintenance);
+        timer.finish();
+        internal::update_collision_stats(*m_registry);
+        event_stream.update();
         emitter.consume_events();
 
         if (settings.clear_actions_func) {
@@ -84,11 +114,7 @@ void stepper_sequential::update(double time) {
     update_presentation(*m_registry, get_simulation_timestamp(), time, elapsed, fixed_dt);
 }
 
-void stepper_sequential::step_simulation(double time) {
-    EDYN_ASSERT(m_paused);
-
-    m_last_time = time;
-
+void stepper_sequential::run_step() {
     auto &bphase = m_registry->ctx().get<broadphase>();
     auto &nphase = m_registry->ctx().get<narrowphase>();
     auto &emitter = m_registry->ctx().get<contact_event_emitter>();
@@ -98,11 +124,23 @@ void stepper_sequential::step_simulation(double time) {
         (*settings.pre_step_callback)(*m_registry);
     }
 
-    m_poly_initializer.init_new_shapes();
+    m_poly_initializer.init_new_shapes(m_multithreaded);
+    auto timer = step_profile_timer(internal::find_step_profile(*m_registry));
     bphase.update(m_multithreaded);
+    timer.record(step_phase::broadphase);
     m_island_manager.update(m_last_time);
+    timer.record(step_phase::island_management);
+    update_paged_meshes(*m_registry);
+    timer.record(step_phase::paged_meshes);
     nphase.update(m_multithreaded);
+    timer.record(step_phase::narrowphase);
     m_solver.update(m_multithreaded);
+    timer.skip();
+    internal::run_maintenance(*m_registry);
+    timer.record(step_phase::maintenance);
+    timer.finish();
+    internal::update_collision_stats(*m_registry);
+    m_registry->ctx().get<contact_event_stream>().update();
     emitter.consume_events();
 
     if (settings.clear_actions_func) {
@@ -114,6 +152,61 @@ void stepper_sequential::step_simulation(double time) {
     }
 }
 
+void stepper_sequential::begin_update(double time) {
+    EDYN_ASSERT(!m_updating);
+    m_update_time = time;
+    m_updating = true;
+    m_update_done.store(false, std::memory_order_relaxed);
+
+    auto task = task_delegate_t(entt::connect_arg_t<&stepper_sequential::run_update_task>{}, *this);
+    enqueue_continuation(*m_registry, task);
+}
+
+void stepper_sequential::run_update_task(unsigned, unsigned) {
+    // Containers created during the update allocate from the memory resource
+    // of this world, as they would in the thread that called `begin_update`.
+    auto binding = scoped_memory_resource(m_registry->ctx().get<edyn::settings>().memory_resource);
+    update(m_update_time);
+    m_update_done.store(true, std::memory_order_release);
+}
+
+void stepper_sequential::end_update() {
+    EDYN_ASSERT(m_updating);
+    auto &dispatcher = job_dispatcher::current();
+
+    // Help with the jobs of the update instead of sleeping.
+    while (!m_update_done.load(std::memory_order_acquire)) {
+        if (!dispatcher.run_pending_job()) {
+            std::this_thread::yield();
+        }
+    }
+
+    m_updating = false;
+}
+
+void stepper_sequential::step_simulation(double time) {
+    EDYN_ASSERT(m_paused);
+
+    m_registry->ctx().get<sensor_event_buffer>().events.clear();
+    m_registry->ctx().get<contact_event_buffer>().events.clear();
+    m_registry->ctx().get<constraint_break_event_buffer>().events.clear();
+    m_last_time = time;
+    run_step();
+}
+
+void stepper_sequential::batch_step_simulation(unsigned num_steps) {
+    EDYN_ASSERT(m_paused);
+
+    // Time advances by exactly one fixed step per step, regardless of the
+    // time source.
+    const auto fixed_dt = m_registry->ctx().get<edyn::settings>().fixed_dt;
+
+    for (unsigned i = 0; i < num_steps; ++i) {
+        m_last_time += fixed_dt;
+        run_step();
+    }
+}
+
 void stepper_sequential::set_paused(bool paused) {
     m_paused = paused;
     m_accumulated_time = 0;
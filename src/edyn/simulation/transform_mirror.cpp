@@ -0,0 +1,163 @@
+#include "edyn/simulation/transform_mirror.hpp"
+#include "edyn/comp/position.hpp"
+#include "edyn/comp/orientation.hpp"
+#include "edyn/comp/linvel.hpp"
+#include "edyn/comp/angvel.hpp"
+#include "edyn/comp/kinematic_track.hpp"
+#include "edyn/comp/tag.hpp"
+#include "edyn/config/constants.hpp"
+#include "edyn/math/math.hpp"
+#include "edyn/replication/entity_map.hpp"
+#include "edyn/sys/shift_origin.hpp"
+#include "edyn/util/awake_group.hpp"
+#include <entt/entity/registry.hpp>
+
+namespace edyn {
+
+void transform_mirror::assign_slot(entt::registry &registry, entt::entity local, entt::entity remote) {
+    uint32_t index;
+
+    if (!m_free_slots.empty()) {
+        index = m_free_slots.back();
+        m_free_slots.pop_back();
+    } else {
+        index = static_cast<uint32_t>(m_changed_step.size());
+        m_local_entities.emplace_back();
+        m_remote_entities.emplace_back();
+        m_changed_step.emplace_back();
+        m_positions.emplace_back();
+        m_orientations.emplace_back();
+        m_linvels.emplace_back();
+        m_angvels.emplace_back();
+    }
+
+    m_local_entities[index] = local;
+    m_remote_entities[index] = remote;
+    m_changed_step[index] = m_step;
+    registry.emplace<transform_mirror_slot>(local, index);
+}
+
+bool transform_mirror::update_slot(uint32_t index, const vector3 &pos, const quaternion &orn,
+                                   const vector3 &linvel, const vector3 &angvel) {
+    // New slots are always sent.
+    if (m_changed_step[index] != m_step &&
+        distance_sqr(pos, m_positions[index]) <= square(transform_mirror_position_tolerance) &&
+        std::abs(dot(orn, m_orientations[index])) >= scalar(1) - transform_mirror_orientation_tolerance &&
+        distance_sqr(linvel, m_linvels[index]) <= square(transform_mirror_velocity_tolerance) &&
+        distance_sqr(angvel, m_angvels[index]) <= square(transform_mirror_velocity_tolerance)) {
+        return false;
+    }
+
+    m_positions[index] = pos;
+    m_orientations[index] = orn;
+    m_linvels[index] = linvel;
+    m_angvels[index] = angvel;
+    m_changed_step[index] = m_step;
+
+    return true;
+}
+
+void transform_mirror::on_destroy_slot(entt::registry &registry, entt::entity entity) {
+    auto index = registry.get<transform_mirror_slot>(entity).index;
+    m_local_entities[index] = entt::null;
+    m_remote_entities[index] = entt::null;
+    // Let the reader know the slot is free in the next write.
+    m_changed_step[index] = m_step + 1;
+    m_free_slots.push_back(index);
+}
+
+void transform_mirror::write(entt::registry &registry, const entity_map &emap, double timestamp,
+                             uint32_t origin_shift_count) {
+    ++m_step;
+
+    auto body_view = awake_group<position, orientation, linvel, angvel, dynamic_tag>(registry);
+    auto slot_view = registry.view<transform_mirror_slot>();
+
+    auto write_body = [&](entt::entity entity, const vector3 &pos, const quaternion &orn,
+                          const vector3 &v, const vector3 &w) {
+        if (slot_view.contains(entity)) {
+            update_slot(slot_view.get<transform_mirror_slot>(entity).index, pos, orn, v, w);
+        } else if (emap.contains_local(entity)) {
+            // Bodies get a slot once they're known to the main registry, thus
+            // bodies which only exist in the worker are never sent.
+            assign_slot(registry, entity, emap.at_local(entity));
+            update_slot(slot_view.get<transform_mirror_slot>(entity).index, pos, orn, v, w);
+        }
+    };
+
+    for (auto [entity, pos, orn, v, w] : body_view.each()) {
+        write_body(entity, pos, orn, v, w);
+    }
+
+    // Kinematic bodies are moved in the worker only when they follow a track.
+    auto track_view = registry.view<position, orientation, linvel, angvel, kinematic_track, kinematic_tag>();
+
+    for (auto [entity, pos, orn, v, w, track] : track_view.each()) {
+        write_body(entity, pos, orn, v, w);
+    }
+
+    // The back buffer was last written a few steps ago, thus only the slots
+    // which changed since then have to be updated.
+    auto &back = m_buffers.back();
+    auto num_slots = m_changed_step.size();
+    back.entities.resize(num_slots, entt::null);
+    back.changed_step.resize(num_slots, 0);
+    back.positions.resize(num_slots);
+    back.orientations.resize(num_slots);
+    back.linvels.resize(num_slots);
+    back.angvels.resize(num_slots);
+
+    for (size_t i = 0; i < num_slots; ++i) {
+        if (m_changed_step[i] <= back.step) {
+            continue;
+        }
+
+        back.changed_step[i] = m_changed_step[i];
+        back.entities[i] = m_remote_entities[i];
+        back.positions[i] = m_positions[i];
+        back.orientations[i] = m_orientations[i];
+        back.linvels[i] = m_linvels[i];
+        back.angvels[i] = m_angvels[i];
+    }
+
+    back.step = m_step;
+    back.timestamp = timestamp;
+    back.origin_shift_count = origin_shift_count;
+    m_buffers.publish();
+}
+
+bool transform_mirror::read(entt::registry &registry, double &timestamp,
+                            const origin_shift_history *shifts) {
+    if (!m_buffers.swap()) {
+        return false;
+    }
+
+    auto &front = m_buffers.front();
+    auto offset = shifts ? shifts->offset_since(front.origin_shift_count) : vector3_zero;
+    auto tr_view = registry.view<position, orientation, linvel, angvel>();
+
+    for (size_t i = 0; i < front.entities.size(); ++i) {
+        auto entity = front.entities[i];
+
+        // Buffers published before the previous read might have been
+        // skipped, thus everything that changed since then is assigned.
+        if (front.changed_step[i] <= m_read_step ||
+            entity == entt::null || !tr_view.contains(entity)) {
+            continue;
+        }
+
+        auto [pos, orn, v, w] = tr_view.get<position, orientation, linvel, angvel>(entity);
+        pos = front.positions[i] - offset;
+        orn = front.orientations[i];
+        v = front.linvels[i];
+        w = front.angvels[i];
+    }
+
+    m_read_step = front.step;
+    m_read_origin_shift_count = front.origin_shift_count;
+    timestamp = front.timestamp;
+
+    return true;
+}
+
+}
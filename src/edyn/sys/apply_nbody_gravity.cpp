@@ -0,0 +1,64 @@
+#include "edyn/sys/apply_nbody_gravity.hpp"
+#include "edyn/comp/linvel.hpp"
+#include "edyn/comp/mass.hpp"
+#include "edyn/comp/position.hpp"
+#include "edyn/comp/tag.hpp"
+#include "edyn/context/settings.hpp"
+#include "edyn/context/task_util.hpp"
+#include "edyn/dynamics/nbody_octree.hpp"
+#include <entt/entity/registry.hpp>
+
+namespace edyn {
+
+// Bodies are accelerated in worker threads once there are more than this
+// many of them.
+static constexpr size_t nbody_gravity_parallel_threshold = 256;
+
+void apply_nbody_gravity(entt::registry &registry, nbody_octree &octree,
+                         std::vector<entt::entity> &entities, scalar dt, bool mt) {
+    auto &settings = registry.ctx().get<edyn::settings>();
+
+    if (!settings.nbody_gravity) {
+        return;
+    }
+
+    octree.clear();
+
+    auto source_view = registry.view<position, mass, dynamic_tag>(entt::exclude<disabled_tag>);
+    source_view.each([&](position &pos, mass &m) {
+        if (m > 0) {
+            octree.insert(pos, m);
+        }
+    });
+
+    if (octree.empty()) {
+        return;
+    }
+
+    octree.build();
+
+    // Frozen bodies are treated as static, thus they must not gain velocity.
+    auto view = registry.view<position, linvel, dynamic_tag>(entt::exclude<sleeping_tag, disabled_tag, frozen_tag>);
+    entities.clear();
+    entities.insert(entities.end(), view.begin(), view.end());
+
+    auto scale = settings.nbody_gravity_constant * dt;
+    auto theta = settings.nbody_gravity_theta;
+    auto softening = settings.nbody_gravity_softening;
+
+    // The octree is only read and each body only writes its own velocity.
+    auto accelerate = [&](const entt::entity *first, const entt::entity *last, unsigned) {
+        for (; first != last; ++first) {
+            auto [pos, vel] = view.get<position, linvel>(*first);
+            vel += octree.acceleration(pos, theta, softening) * scale;
+        }
+    };
+
+    if (mt && entities.size() > nbody_gravity_parallel_threshold) {
+        parallel_for_each_range(registry, entities, accelerate);
+    } else {
+        accelerate(entities.data(), entities.data() + entities.size(), 0);
+    }
+}
+
+}
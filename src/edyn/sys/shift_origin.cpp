@@ -0,0 +1,47 @@
+#include "edyn/sys/shift_origin.hpp"
+#include "edyn/collision/broadphase.hpp"
+#include "edyn/comp/aabb.hpp"
+#include "edyn/comp/island.hpp"
+#include "edyn/comp/kinematic_track.hpp"
+#include "edyn/comp/origin.hpp"
+#include "edyn/comp/position.hpp"
+#include "edyn/comp/present_position.hpp"
+#include <entt/entity/registry.hpp>
+
+namespace edyn {
+
+void shift_origin(entt::registry &registry, const vector3 &offset) {
+    for (auto [entity, pos] : registry.view<position>().each()) {
+        pos -= offset;
+    }
+
+    for (auto [entity, orig] : registry.view<origin>().each()) {
+        orig -= offset;
+    }
+
+    for (auto [entity, pos] : registry.view<present_position>().each()) {
+        pos -= offset;
+    }
+
+    for (auto [entity, track] : registry.view<kinematic_track>().each()) {
+        for (auto &keyframe : track.keyframes) {
+            keyframe.position -= offset;
+        }
+    }
+
+    for (auto [entity, aabb] : registry.view<AABB>().each()) {
+        aabb.min -= offset;
+        aabb.max -= offset;
+    }
+
+    for (auto [entity, aabb] : registry.view<island_AABB>().each()) {
+        aabb.min -= offset;
+        aabb.max -= offset;
+    }
+
+    if (auto *bphase = registry.ctx().find<broadphase>()) {
+        bphase->shift_origin(offset);
+    }
+}
+
+}
@@ -0,0 +1,79 @@
+#include "edyn/sys/sort_storages_by_island.hpp"
+#include "edyn/collision/contact_manifold.hpp"
+#include "edyn/comp/aabb.hpp"
+#include "edyn/comp/angvel.hpp"
+#include "edyn/comp/delta_angvel.hpp"
+#include "edyn/comp/delta_linvel.hpp"
+#include "edyn/comp/inertia.hpp"
+#include "edyn/comp/island.hpp"
+#include "edyn/comp/linvel.hpp"
+#include "edyn/comp/mass.hpp"
+#include "edyn/comp/orientation.hpp"
+#include "edyn/comp/position.hpp"
+#include "edyn/comp/tag.hpp"
+#include "edyn/constraints/constraint.hpp"
+#include "edyn/dynamics/row_cache.hpp"
+#include "edyn/shapes/shapes.hpp"
+#include "edyn/util/awake_group.hpp"
+#include <entt/entity/registry.hpp>
+#include <tuple>
+#include <vector>
+
+namespace edyn {
+
+namespace {
+
+template<typename... Ts, typename It>
+void sort_storages_as(entt::registry &registry, [[maybe_unused]] std::tuple<Ts...>, It first, It last) {
+    (registry.storage<Ts>().sort_as(first, last), ...);
+}
+
+// The groups must be obtained with the same components in the same order as
+// in the systems which use them, otherwise new groups are created instead.
+template<typename... Shapes, typename It>
+void sort_aabb_groups_as(entt::registry &registry, [[maybe_unused]] std::tuple<Shapes...>, It first, It last) {
+    (awake_group<position, orientation, Shapes, AABB, dynamic_tag>(registry).sort_as(first, last), ...);
+}
+
+}
+
+void sort_storages_by_island(entt::registry &registry) {
+    auto procedural_view = registry.view<procedural_tag>();
+    auto nodes = std::vector<entt::entity>{};
+    auto edges = std::vector<entt::entity>{};
+
+    auto append_island = [&](const island &island) {
+        // Non-procedural nodes are shared by many islands, thus they're left
+        // at the end.
+        for (auto entity : island.nodes) {
+            if (procedural_view.contains(entity)) {
+                nodes.push_back(entity);
+            }
+        }
+
+        edges.insert(edges.end(), island.edges.begin(), island.edges.end());
+    };
+
+    for (auto [island_entity, island] : registry.view<edyn::island>(entt::exclude<sleeping_tag>).each()) {
+        append_island(island);
+    }
+
+    for (auto [island_entity, island] : registry.view<edyn::island, sleeping_tag>().each()) {
+        append_island(island);
+    }
+
+    using node_components = std::tuple<
+        position, orientation, linvel, angvel, mass, mass_inv, inertia,
+        inertia_inv, inertia_world_inv, delta_linvel, delta_angvel, AABB
+    >;
+    sort_storages_as(registry, node_components{}, nodes.begin(), nodes.end());
+    sort_storages_as(registry, constraints_tuple, edges.begin(), edges.end());
+    sort_storages_as(registry, std::tuple<contact_manifold, constraint_row_prep_cache>{}, edges.begin(), edges.end());
+
+    awake_group<position, orientation, linvel, angvel, dynamic_tag>(registry).sort_as(nodes.begin(), nodes.end());
+    awake_group<orientation, inertia_inv, inertia_world_inv, dynamic_tag>(registry).sort_as(nodes.begin(), nodes.end());
+    sort_aabb_groups_as(registry, dynamic_shapes_tuple, nodes.begin(), nodes.end());
+    awake_group<contact_manifold>(registry).sort_as(edges.begin(), edges.end());
+}
+
+}
@@ -7,7 +7,10 @@
 #include "edyn/comp/island.hpp"
 #include "edyn/util/aabb_util.hpp"
 #include "edyn/util/island_util.hpp"
+#include "edyn/util/awake_group.hpp"
+#include "edyn/util/shape_util.hpp"
 #include <entt/entity/registry.hpp>
+#include <tuple>
 
 namespace edyn {
 
@@ -21,10 +24,21 @@ AABB updated_aabb(const polyhedron_shape &polyhedron,
                   const vector3 &pos, const quaternion &orn) {
     // `shape_aabb(const polyhedron_shape &, ...)` rotates each vertex of a
     // polyhedron to calculate the AABB. Specialize `updated_aabb` for
-    // polyhedrons to use the rotated mesh.
-    auto aabb = point_cloud_aabb(polyhedron.rotated->vertices);
-    aabb.min += pos;
-    aabb.max += pos;
+    // polyhedrons to find the extreme vertices along each world axis by
+    // walking over the vertex adjacency graph in object space instead, which
+    // visits only a few vertices and does not require the rotated mesh,
+    // since it is only updated for polyhedrons in contact.
+    auto &mesh = *polyhedron.mesh;
+    auto basis = to_matrix3x3(orn);
+    auto aabb = AABB{};
+
+    for (auto i = 0; i < 3; ++i) {
+        // Row `i` of the basis is the world axis in object space.
+        auto dir = basis.row[i];
+        aabb.max[i] = pos[i] + polyhedron_support_projection(mesh.vertices, mesh.neighbors_start, mesh.neighbor_indices, dir);
+        aabb.min[i] = pos[i] - polyhedron_support_projection(mesh.vertices, mesh.neighbors_start, mesh.neighbor_indices, -dir);
+    }
+
     return aabb;
 }
 
@@ -47,9 +61,12 @@ void update_aabb(entt::registry &registry, entt::entity entity) {
     });
 }
 
+template<typename ShapeType>
+void update_kinematic_aabbs(entt::registry &registry);
+
 template<typename ShapeType>
 void update_aabbs(entt::registry &registry) {
-    auto tr_view = registry.view<position, orientation, ShapeType, AABB, dynamic_tag>(exclude_sleeping_disabled);
+    auto tr_view = awake_group<position, orientation, ShapeType, AABB, dynamic_tag>(registry);
     auto origin_view = registry.view<origin>();
 
     for (auto entity : tr_view) {
@@ -57,6 +74,13 @@ void update_aabbs(entt::registry &registry) {
         update_aabb(entity, shape, tr_view, origin_view);
     }
 
+    update_kinematic_aabbs<ShapeType>(registry);
+}
+
+template<typename ShapeType>
+void update_kinematic_aabbs(entt::registry &registry) {
+    auto origin_view = registry.view<origin>();
+
     // TODO: only update AABB of kinematic entities that have moved.
     auto kin_tr_view = registry.view<position, orientation, ShapeType, AABB, kinematic_tag>();
     for (auto entity : kin_tr_view) {
@@ -75,29 +99,48 @@ void update_aabbs(entt::registry &registry) {
     update_aabbs(registry, dynamic_shapes_tuple);
 }
 
+void update_kinematic_aabbs(entt::registry &registry) {
+    std::apply([&](auto ... t) {
+        (update_kinematic_aabbs<decltype(t)>(registry), ...);
+    }, dynamic_shapes_tuple);
+}
+
+template<typename AABBView, typename ProceduralView>
+void update_island_aabb(const island &island, island_AABB &aabb,
+                        const AABBView &aabb_view, const ProceduralView &procedural_view) {
+    auto is_first_node = true;
+
+    for (auto entity : island.nodes) {
+        if (!procedural_view.contains(entity) || !aabb_view.contains(entity)) {
+            continue;
+        }
+
+        auto &node_aabb = aabb_view.template get<AABB>(entity);
+
+        if (is_first_node) {
+            aabb = {node_aabb};
+            is_first_node = false;
+        } else {
+            aabb = {enclosing_aabb(aabb, node_aabb)};
+        }
+    }
+}
+
 void update_island_aabbs(entt::registry &registry) {
     auto aabb_view = registry.view<AABB>();
     auto procedural_view = registry.view<procedural_tag>();
 
     registry.view<island, island_AABB>(exclude_sleeping_disabled)
         .each([&](island &island, island_AABB &aabb) {
-        auto is_first_node = true;
-
-        for (auto entity : island.nodes) {
-            if (!procedural_view.contains(entity) || !aabb_view.contains(entity)) {
-                continue;
-            }
-
-            auto &node_aabb = aabb_view.get<AABB>(entity);
-
-            if (is_first_node) {
-                aabb = {node_aabb};
-                is_first_node = false;
-            } else {
-                aabb = {enclosing_aabb(aabb, node_aabb)};
-            }
-        }
+        update_island_aabb(island, aabb, aabb_view, procedural_view);
     });
 }
 
+void update_island_aabb(entt::registry &registry, entt::entity island_entity) {
+    auto aabb_view = registry.view<AABB>();
+    auto procedural_view = registry.view<procedural_tag>();
+    auto [island, aabb] = registry.get<edyn::island, island_AABB>(island_entity);
+    update_island_aabb(island, aabb, aabb_view, procedural_view);
+}
+
 }
@@ -2,7 +2,7 @@
 #include "edyn/comp/orientation.hpp"
 #include "edyn/comp/inertia.hpp"
 #include "edyn/comp/tag.hpp"
-#include "edyn/util/island_util.hpp"
+#include "edyn/util/awake_group.hpp"
 #include <entt/entity/registry.hpp>
 
 namespace edyn {
@@ -15,7 +15,7 @@ void update_inertia(entt::entity entity, OrnInertiaView &view) {
 }
 
 void update_inertias(entt::registry &registry) {
-    auto view = registry.view<orientation, inertia_inv, inertia_world_inv, dynamic_tag>(exclude_sleeping_disabled);
+    auto view = awake_group<orientation, inertia_inv, inertia_world_inv, dynamic_tag>(registry);
     for (auto entity : view) {
         update_inertia(entity, view);
     }
@@ -0,0 +1,283 @@
+#include "edyn/sys/update_island_nodes.hpp"
+#include "edyn/sys/update_aabbs.hpp"
+#include "edyn/comp/aabb.hpp"
+#include "edyn/comp/center_of_mass.hpp"
+#include "edyn/comp/inertia.hpp"
+#include "edyn/comp/linvel.hpp"
+#include "edyn/comp/island.hpp"
+#include "edyn/comp/origin.hpp"
+#include "edyn/comp/orientation.hpp"
+#include "edyn/comp/position.hpp"
+#include "edyn/comp/tag.hpp"
+#include "edyn/context/settings.hpp"
+#include "edyn/context/task_util.hpp"
+#include "edyn/math/simd_vector3.hpp"
+#include "edyn/math/transform.hpp"
+#include "edyn/shapes/shapes.hpp"
+#include "edyn/util/aabb_util.hpp"
+#include <entt/entity/registry.hpp>
+#include <mutex>
+
+namespace edyn {
+
+// Bounds which enclose nothing, thus any AABB merged into them replaces them.
+static AABB empty_bounds() {
+    return {vector3_one * EDYN_SCALAR_MAX, vector3_one * -EDYN_SCALAR_MAX};
+}
+
+// Entities whose state is calculated in packs of `simd_width`, along with
+// the data loaded for each lane.
+struct update_nodes_batch {
+    entt::entity entities[simd_width];
+    alignas(simd_alignment) scalar orn[4][simd_width];
+    alignas(simd_alignment) scalar data[9][simd_width] {};
+    size_t size {0};
+
+    void push(entt::entity entity, const quaternion &q) {
+        entities[size] = entity;
+
+        for (size_t i = 0; i < 4; ++i) {
+            orn[i][size] = q[i];
+        }
+
+        ++size;
+    }
+
+    bool full() const {
+        return size == simd_width;
+    }
+
+    simd_quaternion load_orientation() {
+        // Fill unused lanes with valid rotations.
+        for (auto lane = size; lane < simd_width; ++lane) {
+            for (size_t i = 0; i < 4; ++i) {
+                orn[i][lane] = quaternion_identity[i];
+            }
+        }
+
+        return simd_quaternion::load(orn);
+    }
+
+    simd_vector3 load_vector3(size_t first_row) const {
+        return {simd_scalar::load(data[first_row]),
+                simd_scalar::load(data[first_row + 1]),
+                simd_scalar::load(data[first_row + 2])};
+    }
+};
+
+// Enclose the motion of fast bodies during the next step so the broadphase
+// finds the pairs they might hit along the way.
+template<typename CCDView>
+static void extend_ccd_aabb(AABB &aabb, entt::entity entity, CCDView &ccd_view, scalar dt) {
+    if (ccd_view.contains(entity)) {
+        auto displacement = ccd_view.template get<linvel>(entity) * dt;
+        aabb.min += min(displacement, vector3_zero);
+        aabb.max += max(displacement, vector3_zero);
+    }
+}
+
+// Calculates `R * I_inv * R^T` for a batch of bodies, where the inverse
+// inertia of each lane was loaded into `data` in row-major order.
+template<typename InertiaView>
+static void update_inertia_batch(update_nodes_batch &batch, InertiaView &inertia_view) {
+    auto basis = to_matrix3x3(batch.load_orientation());
+    auto inv_I = simd_matrix3x3{{batch.load_vector3(0), batch.load_vector3(3), batch.load_vector3(6)}};
+    auto inv_IW = basis * inv_I * transpose(basis);
+
+    alignas(simd_alignment) scalar result[3][3][simd_width];
+
+    for (size_t i = 0; i < 3; ++i) {
+        inv_IW.row[i].x.store(result[i][0]);
+        inv_IW.row[i].y.store(result[i][1]);
+        inv_IW.row[i].z.store(result[i][2]);
+    }
+
+    for (size_t lane = 0; lane < batch.size; ++lane) {
+        auto &m = inertia_view.template get<inertia_world_inv>(batch.entities[lane]);
+
+        for (size_t i = 0; i < 3; ++i) {
+            for (size_t j = 0; j < 3; ++j) {
+                m[i][j] = result[i][j][lane];
+            }
+        }
+    }
+
+    batch.size = 0;
+}
+
+// Calculates the AABB of a batch of boxes, where the center of each box was
+// loaded into the first 3 rows of `data` and the half extents into the next 3.
+// The AABBs are added to `bounds`.
+template<typename AABBView, typename CCDView>
+static void update_box_aabb_batch(update_nodes_batch &batch, AABBView &aabb_view,
+                                  CCDView &ccd_view, scalar dt, AABB &bounds) {
+    // Reference: Real-Time Collision Detection - Christer Ericson, section 4.2.6.
+    auto basis = to_matrix3x3(batch.load_orientation());
+    auto abs_basis = simd_matrix3x3{{abs(basis.row[0]), abs(basis.row[1]), abs(basis.row[2])}};
+    auto center = batch.load_vector3(0);
+    auto extent = abs_basis * batch.load_vector3(3);
+
+    alignas(simd_alignment) scalar lower[3][simd_width], upper[3][simd_width];
+    (center - extent).store(lower);
+    (center + extent).store(upper);
+
+    for (size_t lane = 0; lane < batch.size; ++lane) {
+        auto entity = batch.entities[lane];
+        auto &aabb = aabb_view.template get<AABB>(entity);
+        aabb.min = {lower[0][lane], lower[1][lane], lower[2][lane]};
+        aabb.max = {upper[0][lane], upper[1][lane], upper[2][lane]};
+        extend_ccd_aabb(aabb, entity, ccd_view, dt);
+        bounds = enclosing_aabb(bounds, aabb);
+    }
+
+    batch.size = 0;
+}
+
+// Updates the nodes in the range `[first, last)` of the packed array of
+// `island.nodes` and returns the AABB enclosing their AABBs. Only dynamic
+// nodes move, which are the procedural nodes that make up the island AABB,
+// thus it's refit in the same pass instead of visiting all nodes again.
+static AABB update_island_nodes(entt::registry &registry, const entt::entity *first,
+                                const entt::entity *last, scalar dt) {
+    auto dynamic_view = registry.view<dynamic_tag>();
+    auto tr_view = registry.view<position, orientation>();
+    auto origin_view = registry.view<center_of_mass, origin>();
+    auto aabb_view = registry.view<AABB>();
+    auto box_view = registry.view<box_shape>();
+    auto inertia_view = registry.view<inertia_inv, inertia_world_inv>();
+    auto ccd_view = registry.view<linvel, ccd_tag>();
+    auto particle_view = registry.view<sphere_shape, particle_tag>();
+    auto inertia_batch = update_nodes_batch{};
+    auto box_batch = update_nodes_batch{};
+    auto bounds = empty_bounds();
+
+    for (auto it = first; it != last; ++it) {
+        auto entity = *it;
+
+        if (!dynamic_view.contains(entity)) {
+            continue;
+        }
+
+        // Particles have no origin, their AABB does not depend on orientation
+        // and their inertia is zero, thus only the AABB is updated.
+        if (particle_view.contains(entity)) {
+            auto &pos = tr_view.get<position>(entity);
+            auto &aabb = aabb_view.get<AABB>(entity);
+            aabb = sphere_aabb(particle_view.get<sphere_shape>(entity).radius, pos);
+            extend_ccd_aabb(aabb, entity, ccd_view, dt);
+            bounds = enclosing_aabb(bounds, aabb);
+            continue;
+        }
+
+        auto [pos, orn] = tr_view.get<position, orientation>(entity);
+        auto center = static_cast<vector3>(pos);
+
+        if (origin_view.contains(entity)) {
+            auto [com, orig] = origin_view.get<center_of_mass, origin>(entity);
+            orig = to_world_space(-com, pos, orn);
+            center = orig;
+        }
+
+        if (aabb_view.contains(entity)) {
+            if (box_view.contains(entity)) {
+                auto lane = box_batch.size;
+                auto &half_extents = box_view.get<box_shape>(entity).half_extents;
+
+                for (size_t i = 0; i < 3; ++i) {
+                    box_batch.data[i][lane] = center[i];
+                    box_batch.data[i + 3][lane] = half_extents[i];
+                }
+
+                box_batch.push(entity, orn);
+
+                if (box_batch.full()) {
+                    update_box_aabb_batch(box_batch, aabb_view, ccd_view, dt, bounds);
+                }
+            } else {
+                update_aabb(registry, entity);
+                auto &aabb = aabb_view.get<AABB>(entity);
+                extend_ccd_aabb(aabb, entity, ccd_view, dt);
+                bounds = enclosing_aabb(bounds, aabb);
+            }
+        }
+
+        if (inertia_view.contains(entity)) {
+            auto lane = inertia_batch.size;
+            auto &inv_I = inertia_view.get<inertia_inv>(entity);
+
+            for (size_t i = 0; i < 3; ++i) {
+                for (size_t j = 0; j < 3; ++j) {
+                    inertia_batch.data[i * 3 + j][lane] = inv_I[i][j];
+                }
+            }
+
+            inertia_batch.push(entity, orn);
+
+            if (inertia_batch.full()) {
+                update_inertia_batch(inertia_batch, inertia_view);
+            }
+        }
+    }
+
+    if (box_batch.size > 0) {
+        update_box_aabb_batch(box_batch, aabb_view, ccd_view, dt, bounds);
+    }
+
+    if (inertia_batch.size > 0) {
+        update_inertia_batch(inertia_batch, inertia_view);
+    }
+
+    return bounds;
+}
+
+void update_island_nodes(entt::registry &registry, entt::entity island_entity) {
+    // Nodes of large islands are updated in parallel, which is safe since
+    // each node only writes to its own components.
+    constexpr unsigned max_sequential_size = 256;
+    auto &island = registry.get<edyn::island>(island_entity);
+    auto *nodes = island.nodes.data();
+    auto num_nodes = static_cast<unsigned>(island.nodes.size());
+    auto dt = registry.ctx().get<settings>().fixed_dt;
+
+    auto bounds = empty_bounds();
+
+    if (num_nodes <= max_sequential_size) {
+        bounds = update_island_nodes(registry, nodes, nodes + num_nodes, dt);
+    } else {
+        // Each range is merged into the island bounds once it's done.
+        auto bounds_mutex = std::mutex{};
+        auto task_func = [&registry, &bounds, &bounds_mutex, nodes, dt](unsigned start, unsigned end) {
+            auto range_bounds = update_island_nodes(registry, nodes + start, nodes + end, dt);
+            auto lock = std::lock_guard(bounds_mutex);
+            bounds = enclosing_aabb(bounds, range_bounds);
+        };
+        auto task = task_delegate_t(entt::connect_arg_t<&decltype(task_func)::operator()>{}, task_func);
+        enqueue_task_wait(registry, task, num_nodes);
+    }
+
+    // Islands without dynamic nodes keep their AABB, as in `update_island_aabb`.
+    if (bounds.min.x <= bounds.max.x) {
+        registry.get<island_AABB>(island_entity) = {bounds};
+    }
+}
+
+void reserve_update_island_nodes_storage(entt::registry &registry) {
+    registry.storage<dynamic_tag>();
+    registry.storage<procedural_tag>();
+    registry.storage<center_of_mass>();
+    registry.storage<origin>();
+    registry.storage<AABB>();
+    registry.storage<island_AABB>();
+    registry.storage<inertia_inv>();
+    registry.storage<inertia_world_inv>();
+    registry.storage<linvel>();
+    registry.storage<ccd_tag>();
+    registry.storage<particle_tag>();
+    registry.storage<shape_index>();
+
+    std::apply([&](auto ... shape) {
+        (registry.storage<decltype(shape)>(), ...);
+    }, shapes_tuple);
+}
+
+}
@@ -0,0 +1,110 @@
+#include "edyn/sys/update_kinematic_tracks.hpp"
+#include "edyn/comp/kinematic_track.hpp"
+#include "edyn/comp/position.hpp"
+#include "edyn/comp/orientation.hpp"
+#include "edyn/comp/linvel.hpp"
+#include "edyn/comp/angvel.hpp"
+#include "edyn/comp/tag.hpp"
+#include "edyn/config/config.h"
+#include "edyn/math/math.hpp"
+#include <entt/entity/registry.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace edyn {
+
+static scalar wrap_track_time(const kinematic_track &track, scalar time) {
+    auto start = track.keyframes.front().time;
+    auto end = track.keyframes.back().time;
+
+    if (!(end > start)) {
+        return start;
+    }
+
+    if (track.loop) {
+        auto t = std::fmod(time - start, end - start);
+        return start + (t < 0 ? t + (end - start) : t);
+    }
+
+    return std::clamp(time, start, end);
+}
+
+static vector3 catmull_rom(const vector3 &p0, const vector3 &p1,
+                           const vector3 &p2, const vector3 &p3, scalar u) {
+    auto u2 = u * u;
+    auto u3 = u2 * u;
+    return ((p1 * scalar(2)) +
+            (p2 - p0) * u +
+            (p0 * scalar(2) - p1 * scalar(5) + p2 * scalar(4) - p3) * u2 +
+            (p1 * scalar(3) - p0 - p2 * scalar(3) + p3) * u3) * scalar(0.5);
+}
+
+void evaluate_kinematic_track(const kinematic_track &track, scalar time,
+                              vector3 &pos, quaternion &orn) {
+    auto &keyframes = track.keyframes;
+    EDYN_ASSERT(!keyframes.empty());
+    time = wrap_track_time(track, time);
+
+    // First keyframe after the time, which is the end of the segment.
+    auto it = std::upper_bound(keyframes.begin(), keyframes.end(), time, [](scalar t, const kinematic_keyframe &kf) {
+        return t < kf.time;
+    });
+
+    if (it == keyframes.begin() || it == keyframes.end()) {
+        auto &kf = it == keyframes.end() ? keyframes.back() : keyframes.front();
+        pos = kf.position;
+        orn = kf.orientation;
+        return;
+    }
+
+    auto i1 = static_cast<size_t>(it - keyframes.begin());
+    auto i0 = i1 - 1;
+    auto &k0 = keyframes[i0];
+    auto &k1 = keyframes[i1];
+    auto u = (time - k0.time) / (k1.time - k0.time);
+
+    if (track.interpolation == kinematic_track_interpolation::spline && keyframes.size() > 2) {
+        // The first and last keyframes are the same position in a looping
+        // track, thus their neighbors are taken from the other end.
+        auto last = keyframes.size() - 1;
+        auto prev = i0 > 0 ? i0 - 1 : (track.loop ? last - 1 : i0);
+        auto next = i1 < last ? i1 + 1 : (track.loop ? 1 : i1);
+        pos = catmull_rom(keyframes[prev].position, k0.position, k1.position, keyframes[next].position, u);
+    } else {
+        pos = lerp(k0.position, k1.position, u);
+    }
+
+    orn = slerp(k0.orientation, k1.orientation, u);
+}
+
+void update_kinematic_tracks(entt::registry &registry, scalar dt) {
+    auto view = registry.view<kinematic_track, position, orientation, linvel, angvel, kinematic_tag>(entt::exclude<disabled_tag>);
+
+    for (auto [entity, track, pos, orn, v, w] : view.each()) {
+        if (track.keyframes.empty()) {
+            continue;
+        }
+
+        track.time = wrap_track_time(track, track.time + dt * track.speed);
+
+        auto next_pos = vector3{};
+        auto next_orn = quaternion{};
+        evaluate_kinematic_track(track, track.time, next_pos, next_orn);
+
+        // The angular velocity takes the shortest rotation from the current
+        // orientation, in world space.
+        v = (next_pos - pos) / dt;
+        auto q = normalize(next_orn * conjugate(orn));
+
+        if (q.w < 0) {
+            q = quaternion{-q.x, -q.y, -q.z, -q.w};
+        }
+
+        auto angle = std::acos(std::min(q.w, scalar(1))) * scalar(2);
+        w = quaternion_axis(q) * (angle / dt);
+        pos = next_pos;
+        orn = next_orn;
+    }
+}
+
+}
@@ -17,4 +17,11 @@ void update_origins(entt::registry &registry) {
     });
 }
 
+void update_non_dynamic_origins(entt::registry &registry) {
+    registry.view<position, orientation, center_of_mass, origin>(entt::exclude_t<dynamic_tag, sleeping_tag, disabled_tag>{})
+        .each([](position &pos, orientation &orn, center_of_mass &com, origin &orig) {
+        orig = to_world_space(-com, pos, orn);
+    });
+}
+
 }
@@ -0,0 +1,109 @@
+#include "edyn/sys/update_paged_meshes.hpp"
+#include "edyn/comp/aabb.hpp"
+#include "edyn/comp/island.hpp"
+#include "edyn/comp/linvel.hpp"
+#include "edyn/comp/tag.hpp"
+#include "edyn/collision/contact_manifold.hpp"
+#include "edyn/context/settings.hpp"
+#include "edyn/config/constants.hpp"
+#include "edyn/parallel/message.hpp"
+#include "edyn/parallel/message_dispatcher.hpp"
+#include "edyn/shapes/paged_mesh_shape.hpp"
+#include "edyn/shapes/paged_mesh_pinned_pages.hpp"
+#include "edyn/util/island_util.hpp"
+#include "edyn/util/paged_mesh_load_reporting.hpp"
+#include <entt/entity/registry.hpp>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace edyn {
+
+// Pins the pages referenced by contact points so they are not unloaded while
+// bodies rest on them.
+static void pin_pages_in_contact(entt::registry &registry) {
+    if (!registry.ctx().contains<paged_mesh_pinned_pages>()) {
+        registry.ctx().emplace<paged_mesh_pinned_pages>();
+    }
+
+    auto &pinned = registry.ctx().get<paged_mesh_pinned_pages>();
+    auto mesh_view = registry.view<paged_mesh_shape>();
+    auto manifold_view = registry.view<contact_manifold>();
+    auto pages = std::vector<paged_mesh_pinned_pages::page_type>{};
+
+    for (auto [manifold_entity, manifold] : manifold_view.each()) {
+        for (auto i = 0; i < 2; ++i) {
+            if (!mesh_view.contains(manifold.body[i])) {
+                continue;
+            }
+
+            auto &trimesh = mesh_view.get<paged_mesh_shape>(manifold.body[i]).trimesh;
+
+            manifold.each_point([&](const contact_point &, const contact_point_cold &cold) {
+                auto &feature = i == 0 ? cold.featureA : cold.featureB;
+
+                if (feature) {
+                    pages.emplace_back(trimesh, feature->part);
+                }
+            });
+        }
+    }
+
+    pinned.assign(std::move(pages));
+}
+
+void update_paged_meshes(entt::registry &registry) {
+    auto mesh_view = registry.view<paged_mesh_shape>();
+
+    if (mesh_view.empty()) {
+        return;
+    }
+
+    pin_pages_in_contact(registry);
+
+    auto island_view = registry.view<island, island_AABB>(exclude_sleeping_disabled);
+    auto vel_view = registry.view<linvel, procedural_tag>();
+    auto lookahead = registry.ctx().get<settings>().paged_mesh_prefetch_lookahead;
+    auto &dispatcher = message_dispatcher::global();
+
+    // Same margin used in the collision functions for paged meshes.
+    constexpr auto inset = vector3_one * -contact_breaking_threshold;
+
+    for (auto [island_entity, island, island_aabb] : island_view.each()) {
+        // Sweep the island AABB by the displacement of its fastest nodes
+        // along each axis.
+        auto min_displacement = vector3_zero;
+        auto max_displacement = vector3_zero;
+
+        for (auto entity : island.nodes) {
+            if (vel_view.contains(entity)) {
+                auto displacement = vel_view.get<linvel>(entity) * lookahead;
+                min_displacement = min(min_displacement, displacement);
+                max_displacement = max(max_displacement, displacement);
+            }
+        }
+
+        auto aabb = island_aabb.inset(inset);
+        auto prefetch_aabb = AABB{aabb.min + min_displacement, aabb.max + max_displacement};
+
+        for (auto [mesh_entity, shape] : mesh_view.each()) {
+            auto &trimesh = *shape.trimesh;
+
+            if (!intersect(trimesh.get_aabb(), prefetch_aabb)) {
+                continue;
+            }
+
+            trimesh.prefetch(prefetch_aabb);
+
+            // Pages which the island already touches but are still being
+            // loaded won't be considered in collision detection in this step.
+            trimesh.visit_missing_submeshes(aabb, [&](size_t mesh_idx, const AABB &page_aabb) {
+                dispatcher.send<msg::paged_triangle_mesh_page_miss>(
+                    {internal::paged_mesh_load_queue_identifier}, {},
+                    shape.trimesh.get(), mesh_idx, page_aabb);
+            });
+        }
+    }
+}
+
+}
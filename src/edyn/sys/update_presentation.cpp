@@ -7,10 +7,12 @@
 #include "edyn/comp/angvel.hpp"
 #include "edyn/comp/tag.hpp"
 #include "edyn/context/settings.hpp"
+#include "edyn/context/task_util.hpp"
 #include "edyn/math/math.hpp"
 #include "edyn/math/quaternion.hpp"
 #include "edyn/math/vector3.hpp"
 #include "edyn/networking/comp/discontinuity.hpp"
+#include "edyn/networking/comp/interpolation_buffer.hpp"
 #include "edyn/util/island_util.hpp"
 #include <entt/entity/registry.hpp>
 
@@ -61,26 +63,88 @@ void update_presentation(entt::registry &registry, double sim_time, double curre
         update_discontinuities(registry, delta_time);
     }
 
-    auto linear_view = registry.view<position, linvel, present_position, procedural_tag>(exclude_sleeping_disabled);
-    auto angular_view = registry.view<orientation, angvel, present_orientation, procedural_tag>(exclude_sleeping_disabled);
+    auto procedural_view = registry.view<procedural_tag>(exclude_sleeping_disabled);
+    auto linear_view = registry.view<position, linvel>();
+    auto angular_view = registry.view<orientation, angvel>();
+    auto present_pos_view = registry.view<present_position>();
+    auto present_orn_view = registry.view<present_orientation>();
+    auto discontinuity_view = registry.view<discontinuity>(entt::exclude<interpolation_buffer>);
 
     // Interpolate transforms at `sim_time` towards a consistent point in time
     // which is `presentation_delay` seconds behind the current time.
     const auto interpolation_dt = std::min(static_cast<scalar>(current_time - presentation_delay - sim_time), settings.fixed_dt);
 
-    linear_view.each([interpolation_dt](position &pos, linvel &vel, present_position &pre) {
-        pre = pos + vel * interpolation_dt;
-    });
+    // Procedural entities are extrapolated and discontinuities are applied in
+    // a single pass over the entities. Entities with an interpolation buffer
+    // have no discontinuity applied since they're presented afterwards from
+    // their buffer.
+    auto present = [&](entt::entity entity) {
+        if (!present_pos_view.contains(entity) || !present_orn_view.contains(entity)) {
+            return;
+        }
 
-    angular_view.each([interpolation_dt](orientation &orn, angvel &vel, present_orientation &pre) {
-        pre = integrate(orn, vel, interpolation_dt);
-    });
+        auto [p_pos] = present_pos_view.get(entity);
+        auto [p_orn] = present_orn_view.get(entity);
 
-    auto discontinuity_view = registry.view<discontinuity, present_position, present_orientation>();
-    discontinuity_view.each([](discontinuity &dis, present_position &p_pos, present_orientation &p_orn) {
-        p_pos += dis.position_offset;
-        p_orn = dis.orientation_offset * p_orn;
-    });
+        if (procedural_view.contains(entity)) {
+            if (linear_view.contains(entity)) {
+                auto [pos, vel] = linear_view.get(entity);
+                p_pos = pos + vel * interpolation_dt;
+            }
+
+            if (angular_view.contains(entity)) {
+                auto [orn, vel] = angular_view.get(entity);
+                p_orn = integrate(orn, vel, interpolation_dt);
+            }
+        }
+
+        if (discontinuity_view.contains(entity)) {
+            auto [dis] = discontinuity_view.get(entity);
+            p_pos += dis.position_offset;
+            p_orn = dis.orientation_offset * p_orn;
+        }
+    };
+
+    // Iterate over the packed array of the smallest relevant pool, which can
+    // be split in sub-ranges of equal size without walking a view.
+    const entt::sparse_set &entities = settings.present_tagged_only ?
+        static_cast<const entt::sparse_set &>(registry.storage<presentation_tag>()) :
+        static_cast<const entt::sparse_set &>(registry.storage<present_position>());
+    const auto num_entities = entities.size();
+
+    if (settings.execution_mode != execution_mode::sequential &&
+        settings.min_presentation_parallel_size > 0 &&
+        num_entities >= settings.min_presentation_parallel_size) {
+        auto task_func = [&entities, &present](unsigned start, unsigned end) {
+            for (auto i = start; i < end; ++i) {
+                present(entities[i]);
+            }
+        };
+
+        auto task = task_delegate_t(entt::connect_arg_t<&decltype(task_func)::operator()>{}, task_func);
+        enqueue_task_wait(registry, task, static_cast<unsigned>(num_entities));
+    } else {
+        for (auto entity : entities) {
+            present(entity);
+        }
+    }
+
+    // Entities presented from the transforms received from the server.
+    if (auto *client_settings = std::get_if<client_network_settings>(&settings.network_settings);
+        client_settings && client_settings->interpolate_unpredicted_entities) {
+        auto interpolation_time = current_time - client_settings->interpolation_delay;
+        auto interpolation_view = registry.view<interpolation_buffer, present_position, present_orientation>();
+        auto interpolate = [interpolation_time](interpolation_buffer &buffer,
+                                                present_position &p_pos, present_orientation &p_orn) {
+            buffer.interpolate(interpolation_time, p_pos, p_orn);
+        };
+
+        if (settings.present_tagged_only) {
+            (interpolation_view | registry.view<presentation_tag>()).each(interpolate);
+        } else {
+            interpolation_view.each(interpolate);
+        }
+    }
 }
 
 void snap_presentation(entt::registry &registry) {
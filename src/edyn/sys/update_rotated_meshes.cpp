@@ -3,8 +3,11 @@
 #include "edyn/comp/orientation.hpp"
 #include "edyn/comp/rotated_mesh_list.hpp"
 #include "edyn/comp/tag.hpp"
+#include "edyn/collision/contact_manifold.hpp"
+#include "edyn/context/task_util.hpp"
 #include "edyn/util/island_util.hpp"
 #include <entt/entity/registry.hpp>
+#include <algorithm>
 #include <variant>
 
 namespace edyn {
@@ -32,6 +35,7 @@ void update_rotated_mesh(rotated_mesh &rotated, const convex_mesh &mesh,
                          const quaternion &orn) {
     update_rotated_mesh_vertices(rotated, mesh, orn);
     update_rotated_mesh_normals(rotated, mesh, orn);
+    rotated.orientation = orn;
 }
 
 template<typename RotatedView, typename OrientationView>
@@ -42,11 +46,25 @@ void update_rotated_mesh(entt::entity entity, RotatedView &rotated_view, Orienta
         auto &rotated = rotated_view.template get<rotated_mesh_list>(entity);
         // TODO: `rot_list_ptr->orientation` is often `quaternion_identity`.
         // What could be done to avoid this often unnecessary multiplication?
-        update_rotated_mesh(*rotated.rotated, *rotated.mesh, orn * rotated.orientation);
+        auto rotated_orn = orn * rotated.orientation;
+
+        if (rotated.rotated->orientation != rotated_orn) {
+            update_rotated_mesh(*rotated.rotated, *rotated.mesh, rotated_orn);
+        }
+
         entity = rotated.next;
     } while (entity != entt::null);
 }
 
+// Whether the rotated mesh of an entity does not match its orientation. All
+// meshes in the list are updated together thus only the first is checked.
+template<typename RotatedView, typename OrientationView>
+bool is_rotated_mesh_outdated(entt::entity entity, RotatedView &rotated_view, OrientationView &orn_view) {
+    auto &rotated = rotated_view.template get<rotated_mesh_list>(entity);
+    auto &orn = orn_view.template get<orientation>(entity);
+    return rotated.rotated->orientation != orn * rotated.orientation;
+}
+
 void update_rotated_mesh(entt::registry &registry, entt::entity entity) {
     auto rotated_view = registry.view<rotated_mesh_list>();
     auto orn_view = registry.view<orientation>();
@@ -61,6 +79,53 @@ void update_rotated_meshes(entt::registry &registry) {
         update_rotated_mesh(entity, rotated_view, orn_view);
     }
 
+    update_kinematic_rotated_meshes(registry);
+}
+
+void update_rotated_meshes_in_contact(entt::registry &registry,
+                                      const std::vector<entt::entity> &manifold_entities,
+                                      std::vector<entt::entity> &entities, bool mt) {
+    auto rotated_view = registry.view<rotated_mesh_list>();
+    auto orn_view = registry.view<orientation>();
+    auto manifold_view = registry.view<contact_manifold>();
+    entities.clear();
+
+    for (auto manifold_entity : manifold_entities) {
+        auto &manifold = manifold_view.get<contact_manifold>(manifold_entity);
+
+        for (auto body_entity : manifold.body) {
+            if (rotated_view.contains(body_entity) &&
+                is_rotated_mesh_outdated(body_entity, rotated_view, orn_view)) {
+                entities.push_back(body_entity);
+            }
+        }
+    }
+
+    if (entities.empty()) {
+        return;
+    }
+
+    // A body can be in many manifolds.
+    std::sort(entities.begin(), entities.end());
+    entities.erase(std::unique(entities.begin(), entities.end()), entities.end());
+
+    if (mt && entities.size() > 1) {
+        parallel_for_each_range(registry, entities, [&](const entt::entity *first, const entt::entity *last, unsigned) {
+            for (; first != last; ++first) {
+                update_rotated_mesh(*first, rotated_view, orn_view);
+            }
+        });
+    } else {
+        for (auto entity : entities) {
+            update_rotated_mesh(entity, rotated_view, orn_view);
+        }
+    }
+}
+
+void update_kinematic_rotated_meshes(entt::registry &registry) {
+    auto rotated_view = registry.view<rotated_mesh_list>();
+    auto orn_view = registry.view<orientation>();
+
     // TODO: update only kinematic entities that have rotated.
     for (auto entity : registry.view<rotated_mesh_list, kinematic_tag>()) {
         update_rotated_mesh(entity, rotated_view, orn_view);
@@ -191,4 +191,35 @@ void delay(uint32_t ms) {
     } while (was_error && (errno == EINTR));
 }
 
+void sleep_for(double seconds) {
+    if (seconds <= 0) {
+        return;
+    }
+
+    auto whole_seconds = static_cast<time_t>(seconds);
+    auto nanoseconds = static_cast<long>((seconds - whole_seconds) * 1e9);
+
+#ifdef __linux__
+    // Sleep until an absolute time, thus interruptions do not add up error.
+    // `CLOCK_MONOTONIC_RAW` can't be used to sleep.
+    struct timespec target;
+    clock_gettime(CLOCK_MONOTONIC, &target);
+    target.tv_sec += whole_seconds;
+    target.tv_nsec += nanoseconds;
+
+    if (target.tv_nsec >= 1000000000L) {
+        target.tv_nsec -= 1000000000L;
+        ++target.tv_sec;
+    }
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &target, nullptr) == EINTR);
+#else
+    struct timespec remaining;
+    remaining.tv_sec = whole_seconds;
+    remaining.tv_nsec = nanoseconds;
+
+    while (nanosleep(&remaining, &remaining) != 0 && errno == EINTR);
+#endif
+}
+
 }
@@ -14,6 +14,47 @@ void delay(uint32_t ms) {
     Sleep(static_cast<DWORD>(ms));
 }
 
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+// High resolution timers are only available since Windows 10 version 1803.
+// Creation fails on older versions, in which case `Sleep` is used instead.
+struct waitable_timer {
+    HANDLE handle;
+
+    waitable_timer()
+        : handle(CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS))
+    {}
+
+    ~waitable_timer() {
+        if (handle) {
+            CloseHandle(handle);
+        }
+    }
+};
+
+void sleep_for(double seconds) {
+    if (seconds <= 0) {
+        return;
+    }
+
+    thread_local waitable_timer timer;
+
+    if (timer.handle) {
+        // Negative due time is relative, in units of 100 nanoseconds.
+        LARGE_INTEGER due_time;
+        due_time.QuadPart = -static_cast<LONGLONG>(seconds * 1e7);
+
+        if (SetWaitableTimerEx(timer.handle, &due_time, 0, nullptr, nullptr, nullptr, 0)) {
+            WaitForSingleObject(timer.handle, INFINITE);
+            return;
+        }
+    }
+
+    Sleep(static_cast<DWORD>(seconds * 1000));
+}
+
 uint64_t performance_counter() {
     LARGE_INTEGER ticks;
     if (QueryPerformanceCounter(&ticks)) {
@@ -203,6 +203,13 @@ AABB shape_aabb(const paged_mesh_shape &sh, const vector3 &pos, const quaternion
     };
 }
 
+AABB shape_aabb(const heightfield_shape &sh, const vector3 &pos, const quaternion &orn) {
+    return {
+        sh.heightfield->get_aabb().min + pos,
+        sh.heightfield->get_aabb().max + pos
+    };
+}
+
 AABB shape_aabb(const compound_shape &sh, const vector3 &pos, const quaternion &orn) {
     // Using AABB of transformed AABB for greater performance.
     auto aabb = aabb_to_world_space(sh.nodes.front().aabb, pos, orn);
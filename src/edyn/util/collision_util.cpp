@@ -15,13 +15,13 @@
 #include "edyn/math/math.hpp"
 #include "edyn/dynamics/material_mixing.hpp"
 #include "edyn/math/triangle.hpp"
-#include "edyn/util/island_util.hpp"
+#include "edyn/util/awake_group.hpp"
 #include <limits>
 
 namespace edyn {
 
 void update_contact_distances(entt::registry &registry) {
-    auto manifold_view = registry.view<contact_manifold>(exclude_sleeping_disabled);
+    auto manifold_view = awake_group<contact_manifold>(registry);
     auto tr_view = registry.view<position, orientation>();
     auto origin_view = registry.view<origin>();
 
@@ -95,7 +95,7 @@ static scalar get_paged_mesh_restitution(const paged_mesh_shape &shape,
 }
 
 static bool try_assign_per_vertex_friction(
-    std::array<entt::entity, 2> body, contact_point &cp,
+    std::array<entt::entity, 2> body, const contact_point &cp, contact_point_cold &cold,
     const material_view_t &material_view,
     const mesh_shape_view_t &mesh_shape_view,
     const paged_mesh_shape_view_t &paged_mesh_shape_view) {
@@ -105,8 +105,8 @@ static bool try_assign_per_vertex_friction(
         if (shapeA.trimesh->has_per_vertex_friction()) {
             auto [materialA] = material_view.get(body[0]);
             auto [materialB] = material_view.get(body[1]);
-            auto frictionA = get_trimesh_friction(*shapeA.trimesh, cp.pivotA, *cp.featureA) * materialA.friction;
-            cp.friction = material_mix_friction(frictionA, materialB.friction);
+            auto frictionA = get_trimesh_friction(*shapeA.trimesh, cp.pivotA, *cold.featureA) * materialA.friction;
+            cold.friction = material_mix_friction(frictionA, materialB.friction);
             return true;
         }
     } else if (mesh_shape_view.contains(body[1])) {
@@ -114,8 +114,8 @@ static bool try_assign_per_vertex_friction(
         if (shapeB.trimesh->has_per_vertex_friction()) {
             auto [materialA] = material_view.get(body[0]);
             auto [materialB] = material_view.get(body[1]);
-            auto frictionB = get_trimesh_friction(*shapeB.trimesh, cp.pivotB, *cp.featureB) * materialB.friction;
-            cp.friction = material_mix_friction(materialA.friction, frictionB);
+            auto frictionB = get_trimesh_friction(*shapeB.trimesh, cp.pivotB, *cold.featureB) * materialB.friction;
+            cold.friction = material_mix_friction(materialA.friction, frictionB);
             return true;
         }
     } else if (paged_mesh_shape_view.contains(body[0])) {
@@ -123,8 +123,8 @@ static bool try_assign_per_vertex_friction(
         if (shapeA.trimesh->has_per_vertex_friction()) {
             auto [materialA] = material_view.get(body[0]);
             auto [materialB] = material_view.get(body[1]);
-            auto frictionA = get_paged_mesh_friction(shapeA, cp.pivotA, *cp.featureA) * materialA.friction;
-            cp.friction = material_mix_friction(frictionA, materialB.friction);
+            auto frictionA = get_paged_mesh_friction(shapeA, cp.pivotA, *cold.featureA) * materialA.friction;
+            cold.friction = material_mix_friction(frictionA, materialB.friction);
             return true;
         }
     } else if (paged_mesh_shape_view.contains(body[1])) {
@@ -132,8 +132,8 @@ static bool try_assign_per_vertex_friction(
         if (shapeB.trimesh->has_per_vertex_friction()) {
             auto [materialA] = material_view.get(body[0]);
             auto [materialB] = material_view.get(body[1]);
-            auto frictionB = get_paged_mesh_friction(shapeB, cp.pivotB, *cp.featureB) * materialB.friction;
-            cp.friction = material_mix_friction(materialA.friction, frictionB);
+            auto frictionB = get_paged_mesh_friction(shapeB, cp.pivotB, *cold.featureB) * materialB.friction;
+            cold.friction = material_mix_friction(materialA.friction, frictionB);
             return true;
         }
     }
@@ -142,7 +142,7 @@ static bool try_assign_per_vertex_friction(
 }
 
 static bool try_assign_per_vertex_restitution(
-    std::array<entt::entity, 2> body, contact_point &cp,
+    std::array<entt::entity, 2> body, const contact_point &cp, contact_point_cold &cold,
     const material_view_t &material_view,
     const mesh_shape_view_t &mesh_shape_view,
     const paged_mesh_shape_view_t &paged_mesh_shape_view) {
@@ -152,8 +152,8 @@ static bool try_assign_per_vertex_restitution(
         if (shapeA.trimesh->has_per_vertex_restitution()) {
             auto [materialA] = material_view.get(body[0]);
             auto [materialB] = material_view.get(body[1]);
-            auto restitutionA = get_trimesh_restitution(*shapeA.trimesh, cp.pivotA, *cp.featureA) * materialA.restitution;
-            cp.restitution = material_mix_restitution(restitutionA, materialB.restitution);
+            auto restitutionA = get_trimesh_restitution(*shapeA.trimesh, cp.pivotA, *cold.featureA) * materialA.restitution;
+            cold.restitution = material_mix_restitution(restitutionA, materialB.restitution);
             return true;
         }
     } else if (mesh_shape_view.contains(body[1])) {
@@ -161,8 +161,8 @@ static bool try_assign_per_vertex_restitution(
         if (shapeB.trimesh->has_per_vertex_restitution()) {
             auto [materialA] = material_view.get(body[0]);
             auto [materialB] = material_view.get(body[1]);
-            auto restitutionB = get_trimesh_restitution(*shapeB.trimesh, cp.pivotB, *cp.featureB) * materialB.restitution;
-            cp.restitution = material_mix_restitution(materialA.restitution, restitutionB);
+            auto restitutionB = get_trimesh_restitution(*shapeB.trimesh, cp.pivotB, *cold.featureB) * materialB.restitution;
+            cold.restitution = material_mix_restitution(materialA.restitution, restitutionB);
             return true;
         }
     } else if (paged_mesh_shape_view.contains(body[0])) {
@@ -170,8 +170,8 @@ static bool try_assign_per_vertex_restitution(
         if (shapeA.trimesh->has_per_vertex_restitution()) {
             auto [materialA] = material_view.get(body[0]);
             auto [materialB] = material_view.get(body[1]);
-            auto restitutionA = get_paged_mesh_restitution(shapeA, cp.pivotA, *cp.featureA) * materialA.restitution;
-            cp.restitution = material_mix_restitution(restitutionA, materialB.restitution);
+            auto restitutionA = get_paged_mesh_restitution(shapeA, cp.pivotA, *cold.featureA) * materialA.restitution;
+            cold.restitution = material_mix_restitution(restitutionA, materialB.restitution);
             return true;
         }
     } else if (paged_mesh_shape_view.contains(body[1])) {
@@ -179,8 +179,8 @@ static bool try_assign_per_vertex_restitution(
         if (shapeB.trimesh->has_per_vertex_restitution()) {
             auto [materialA] = material_view.get(body[0]);
             auto [materialB] = material_view.get(body[1]);
-            auto restitutionB = get_paged_mesh_restitution(shapeB, cp.pivotB, *cp.featureB) * materialB.restitution;
-            cp.restitution = material_mix_restitution(materialA.restitution, restitutionB);
+            auto restitutionB = get_paged_mesh_restitution(shapeB, cp.pivotB, *cold.featureB) * materialB.restitution;
+            cold.restitution = material_mix_restitution(materialA.restitution, restitutionB);
             return true;
         }
     }
@@ -189,7 +189,8 @@ static bool try_assign_per_vertex_restitution(
 }
 
 void merge_point(std::array<entt::entity, 2> body,
-                 const collision_result::collision_point &rp, contact_point &cp,
+                 const collision_result::collision_point &rp,
+                 contact_point &cp, contact_point_cold &cold,
                  const orientation_view_t &orn_view,
                  const material_view_t &material_view,
                  const mesh_shape_view_t &mesh_shape_view,
@@ -199,8 +200,8 @@ void merge_point(std::array<entt::entity, 2> body,
     cp.normal = rp.normal;
     cp.distance = rp.distance;
     cp.normal_attachment = rp.normal_attachment;
-    cp.featureA = rp.featureA;
-    cp.featureB = rp.featureB;
+    cold.featureA = rp.featureA;
+    cold.featureB = rp.featureB;
 
     if (rp.normal_attachment != contact_normal_attachment::none) {
         auto idx = rp.normal_attachment == contact_normal_attachment::normal_on_A ? 0 : 1;
@@ -210,8 +211,8 @@ void merge_point(std::array<entt::entity, 2> body,
         cp.local_normal = vector3_zero;
     }
 
-    try_assign_per_vertex_friction(body, cp, material_view, mesh_shape_view, paged_mesh_shape_view);
-    try_assign_per_vertex_restitution(body, cp, material_view, mesh_shape_view, paged_mesh_shape_view);
+    try_assign_per_vertex_friction(body, cp, cold, material_view, mesh_shape_view, paged_mesh_shape_view);
+    try_assign_per_vertex_restitution(body, cp, cold, material_view, mesh_shape_view, paged_mesh_shape_view);
 }
 
 size_t find_nearest_contact(const contact_point &cp,
@@ -263,46 +264,72 @@ size_t find_nearest_contact_rolling(const collision_result &result, const vector
     return nearest_idx;
 }
 
-static void assign_material_properties(entt::registry &registry, contact_manifold &manifold, contact_point &cp) {
+contact_material mix_contact_material(entt::registry &registry, const contact_manifold &manifold) {
+    auto result = contact_material{};
     auto material_view = registry.view<material>();
+
+    if (!material_view.contains(manifold.body[0]) || !material_view.contains(manifold.body[1])) {
+        return result;
+    }
+
+    result.valid = true;
     auto [materialA] = material_view.get(manifold.body[0]);
     auto [materialB] = material_view.get(manifold.body[1]);
 
     auto &material_table = registry.ctx().get<material_mix_table>();
 
     if (auto *material = material_table.try_get({materialA.id, materialB.id})) {
-        cp.restitution = material->restitution;
-        cp.friction = material->friction;
-        cp.roll_friction = material->roll_friction;
-        cp.spin_friction = material->spin_friction;
-        cp.stiffness = material->stiffness;
-        cp.damping = material->damping;
+        result.material = *material;
+        result.from_table = true;
     } else {
-        auto mesh_shape_view = registry.view<mesh_shape>();
-        auto paged_mesh_shape_view = registry.view<paged_mesh_shape>();
+        auto &mixed = result.material;
+        mixed.friction = material_mix_friction(materialA.friction, materialB.friction);
+        mixed.restitution = material_mix_restitution(materialA.restitution, materialB.restitution);
+        mixed.roll_friction = material_mix_roll_friction(materialA.roll_friction, materialB.roll_friction);
+        mixed.spin_friction = material_mix_spin_friction(materialA.spin_friction, materialB.spin_friction);
 
-        if (!try_assign_per_vertex_friction(manifold.body, cp, material_view, mesh_shape_view, paged_mesh_shape_view)) {
-            cp.friction = material_mix_friction(materialA.friction, materialB.friction);
-        }
-
-        if (!try_assign_per_vertex_restitution(manifold.body, cp, material_view, mesh_shape_view, paged_mesh_shape_view)) {
-            cp.restitution = material_mix_restitution(materialA.restitution, materialB.restitution);
+        if (materialA.stiffness < large_scalar || materialB.stiffness < large_scalar) {
+            mixed.stiffness = material_mix_stiffness(materialA.stiffness, materialB.stiffness);
+            mixed.damping = material_mix_damping(materialA.damping, materialB.damping);
         }
+    }
 
-        cp.roll_friction = material_mix_roll_friction(materialA.roll_friction, materialB.roll_friction);
-        cp.spin_friction = material_mix_spin_friction(materialA.spin_friction, materialB.spin_friction);
+    return result;
+}
 
-        if (materialA.stiffness < large_scalar || materialB.stiffness < large_scalar) {
-            cp.stiffness = material_mix_stiffness(materialA.stiffness, materialB.stiffness);
-            cp.damping = material_mix_damping(materialA.damping, materialB.damping);
-        }
+static void assign_material_properties(entt::registry &registry, const contact_manifold &manifold,
+                                       const contact_material &mixed,
+                                       const contact_point &cp, contact_point_cold &cold) {
+    cold.restitution = mixed.material.restitution;
+    cold.friction = mixed.material.friction;
+    cold.roll_friction = mixed.material.roll_friction;
+    cold.spin_friction = mixed.material.spin_friction;
+    cold.stiffness = mixed.material.stiffness;
+    cold.damping = mixed.material.damping;
+
+    // Per-vertex friction and restitution of meshes depend on the features
+    // of each point and are not used for pairs in the material table.
+    if (!mixed.from_table) {
+        auto material_view = registry.view<material>();
+        auto mesh_shape_view = registry.view<mesh_shape>();
+        auto paged_mesh_shape_view = registry.view<paged_mesh_shape>();
+        try_assign_per_vertex_friction(manifold.body, cp, cold, material_view, mesh_shape_view, paged_mesh_shape_view);
+        try_assign_per_vertex_restitution(manifold.body, cp, cold, material_view, mesh_shape_view, paged_mesh_shape_view);
     }
 }
 
-void create_contact_point(entt::registry &registry,
-                          entt::entity manifold_entity,
-                          contact_manifold& manifold,
+void insert_contact_point(entt::registry &registry,
+                          contact_manifold &manifold,
+                          contact_manifold_events &events,
                           const collision_result::collision_point& rp) {
+    insert_contact_point(registry, manifold, events, rp, mix_contact_material(registry, manifold));
+}
+
+void insert_contact_point(entt::registry &registry,
+                          contact_manifold &manifold,
+                          contact_manifold_events &events,
+                          const collision_result::collision_point& rp,
+                          const contact_material &mixed) {
     EDYN_ASSERT(manifold.num_points < max_contacts);
 
     // Find available index.
@@ -332,14 +359,16 @@ void create_contact_point(entt::registry &registry,
 
     // Assign new point.
     auto &cp = manifold.point[pt_id];
+    auto &cold = manifold.cold[pt_id];
     cp = {}; // Clear cached point.
+    cold = {};
     cp.pivotA = rp.pivotA;
     cp.pivotB = rp.pivotB;
     cp.normal = rp.normal;
     cp.normal_attachment = rp.normal_attachment;
     cp.distance = rp.distance;
-    cp.featureA = rp.featureA;
-    cp.featureB = rp.featureB;
+    cold.featureA = rp.featureA;
+    cold.featureB = rp.featureB;
 
     if (rp.normal_attachment != contact_normal_attachment::none) {
         auto idx = rp.normal_attachment == contact_normal_attachment::normal_on_A ? 0 : 1;
@@ -350,19 +379,26 @@ void create_contact_point(entt::registry &registry,
     }
 
     // Assign material properties to contact point.
-    if (registry.all_of<material>(manifold.body[0]) && registry.all_of<material>(manifold.body[1])) {
-        assign_material_properties(registry, manifold, cp);
+    if (mixed.valid) {
+        assign_material_properties(registry, manifold, mixed, cp, cold);
     }
 
+    // Add contact created event.
+    events.contact_started |= is_first_contact;
+    EDYN_ASSERT(events.num_contacts_created < max_contacts);
+    events.contacts_created[events.num_contacts_created++] = pt_id;
+}
+
+void create_contact_point(entt::registry &registry,
+                          entt::entity manifold_entity,
+                          contact_manifold& manifold,
+                          const collision_result::collision_point& rp) {
+    auto &events = registry.get<contact_manifold_events>(manifold_entity);
+    insert_contact_point(registry, manifold, events, rp);
+
     // Force update signal to be triggered for contact manifold.
     registry.patch<contact_manifold>(manifold_entity);
-
-    // Add contact created event.
-    registry.patch<contact_manifold_events>(manifold_entity, [&](contact_manifold_events &events) {
-        events.contact_started |= is_first_contact;
-        EDYN_ASSERT(events.num_contacts_created < max_contacts);
-        events.contacts_created[events.num_contacts_created++] = pt_id;
-    });
+    registry.patch<contact_manifold_events>(manifold_entity);
 }
 
 bool maybe_remove_point(contact_manifold &manifold,
@@ -410,9 +446,8 @@ void destroy_contact_point(entt::registry &registry, entt::entity manifold_entit
     registry.patch<contact_manifold_events>(manifold_entity);
 }
 
-void detect_collision(std::array<entt::entity, 2> body, collision_result &result,
-                      const detect_collision_body_view_t &body_view, const origin_view_t &origin_view,
-                      const tuple_of_shape_views_t &views_tuple) {
+bool make_collision_context(std::array<entt::entity, 2> body, collision_context &ctx,
+                            const detect_collision_body_view_t &body_view, const origin_view_t &origin_view) {
     auto &aabbA = body_view.get<AABB>(body[0]);
     auto &aabbB = body_view.get<AABB>(body[1]);
     const auto offset = vector3_one * -contact_breaking_threshold;
@@ -421,20 +456,32 @@ void detect_collision(std::array<entt::entity, 2> body, collision_result &result
     // a manifold is allowed to exist whilst the AABB separation is smaller
     // than `manifold.separation_threshold` which is greater than the
     // contact breaking threshold.
-    if (intersect(aabbA.inset(offset), aabbB)) {
-        auto &ornA = body_view.get<orientation>(body[0]);
-        auto &ornB = body_view.get<orientation>(body[1]);
+    if (!intersect(aabbA.inset(offset), aabbB)) {
+        return false;
+    }
 
-        auto originA = origin_view.contains(body[0]) ?
-            static_cast<vector3>(origin_view.get<origin>(body[0])) :
-            static_cast<vector3>(body_view.get<position>(body[0]));
-        auto originB = origin_view.contains(body[1]) ?
-            static_cast<vector3>(origin_view.get<origin>(body[1])) :
-            static_cast<vector3>(body_view.get<position>(body[1]));
+    auto &ornA = body_view.get<orientation>(body[0]);
+    auto &ornB = body_view.get<orientation>(body[1]);
+
+    auto originA = origin_view.contains(body[0]) ?
+        static_cast<vector3>(origin_view.get<origin>(body[0])) :
+        static_cast<vector3>(body_view.get<position>(body[0]));
+    auto originB = origin_view.contains(body[1]) ?
+        static_cast<vector3>(origin_view.get<origin>(body[1])) :
+        static_cast<vector3>(body_view.get<position>(body[1]));
+
+    ctx = collision_context{originA, ornA, aabbA, originB, ornB, aabbB, collision_threshold};
+    return true;
+}
+
+void detect_collision(std::array<entt::entity, 2> body, collision_result &result,
+                      const detect_collision_body_view_t &body_view, const origin_view_t &origin_view,
+                      const tuple_of_shape_views_t &views_tuple) {
+    collision_context ctx;
 
+    if (make_collision_context(body, ctx, body_view, origin_view)) {
         auto shape_indexA = body_view.get<shape_index>(body[0]);
         auto shape_indexB = body_view.get<shape_index>(body[1]);
-        auto ctx = collision_context{originA, ornA, aabbA, originB, ornB, aabbB, collision_threshold};
 
         visit_shape(shape_indexA, body[0], views_tuple, [&](auto &&shA) {
             visit_shape(shape_indexB, body[1], views_tuple, [&](auto &&shB) {
@@ -1,6 +1,7 @@
 #include "edyn/util/constraint_util.hpp"
 #include "edyn/collision/contact_manifold.hpp"
 #include "edyn/collision/contact_manifold_events.hpp"
+#include "edyn/collision/contact_manifold_map.hpp"
 #include "edyn/comp/island.hpp"
 #include "edyn/comp/material.hpp"
 #include "edyn/comp/tag.hpp"
@@ -9,6 +10,7 @@
 #include "edyn/constraints/constraint.hpp"
 #include "edyn/constraints/contact_constraint.hpp"
 #include "edyn/constraints/null_constraint.hpp"
+#include "edyn/constraints/breakable_constraint.hpp"
 #include "edyn/context/settings.hpp"
 #include "edyn/core/entity_graph.hpp"
 #include "edyn/constraints/constraint_row.hpp"
@@ -52,9 +54,94 @@ void clear_constraint(entt::registry &registry, entt::entity entity) {
     registry.erase<constraint_tag>(entity);
     registry.erase<graph_edge, island_resident>(entity);
     registry.remove<null_constraint>(entity);
+    registry.remove<breakable_constraint>(entity);
     remove_components(registry, entity, constraints_tuple);
 }
 
+namespace {
+
+// Storages and context objects used to set up contact manifolds, which are
+// looked up once when creating many manifolds at a time. Manifolds get the
+// same components, in the same order, as constraints made with
+// `make_constraint`, thus the same signals are emitted.
+struct contact_manifold_maker {
+    entt::registry &registry;
+    entt::registry::storage_for_type<contact_manifold> &manifolds;
+    entt::registry::storage_for_type<contact_manifold_events> &events;
+    entt::registry::storage_for_type<contact_manifold_with_restitution> &restitution_tags;
+    entt::registry::storage_for_type<graph_node> &nodes;
+    entt::registry::storage_for_type<graph_edge> &edges;
+    entt::registry::storage_for_type<island_resident> &residents;
+    entt::registry::storage_for_type<constraint_tag> &constraint_tags;
+    entt::registry::storage_for_type<contact_constraint> &contacts;
+    entt::registry::storage_for_type<null_constraint> &null_constraints;
+    entt::registry::storage_for_type<material> &materials;
+    entity_graph &graph;
+    material_mix_table &material_table;
+
+    contact_manifold_maker(entt::registry &registry)
+        : registry(registry)
+        , manifolds(registry.storage<contact_manifold>())
+        , events(registry.storage<contact_manifold_events>())
+        , restitution_tags(registry.storage<contact_manifold_with_restitution>())
+        , nodes(registry.storage<graph_node>())
+        , edges(registry.storage<graph_edge>())
+        , residents(registry.storage<island_resident>())
+        , constraint_tags(registry.storage<constraint_tag>())
+        , contacts(registry.storage<contact_constraint>())
+        , null_constraints(registry.storage<null_constraint>())
+        , materials(registry.storage<material>())
+        , graph(registry.ctx().get<entity_graph>())
+        , material_table(registry.ctx().get<material_mix_table>())
+    {}
+
+    // Equivalent to `internal::pre_make_constraint` for a new entity.
+    void make_edge(entt::entity entity, entt::entity body0, entt::entity body1) {
+        auto node_index0 = nodes.get(body0).node_index;
+        auto node_index1 = nodes.get(body1).node_index;
+        auto edge_index = graph.insert_edge(entity, node_index0, node_index1);
+        edges.emplace(entity, edge_index);
+        residents.emplace(entity);
+        constraint_tags.emplace(entity);
+    }
+
+    void make(entt::entity manifold_entity, entt::entity body0, entt::entity body1,
+              scalar separation_threshold) {
+        EDYN_ASSERT(registry.valid(body0) && registry.valid(body1));
+        manifolds.emplace(manifold_entity, body0, body1, separation_threshold);
+        events.emplace(manifold_entity);
+
+        // Only create contact constraint if bodies have material.
+        if (!materials.contains(body0) || !materials.contains(body1)) {
+            // If not, emplace a null constraint to ensure an edge will exist in
+            // the entity graph.
+            make_edge(manifold_entity, body0, body1);
+            null_constraints.emplace(manifold_entity, body0, body1);
+            return;
+        }
+
+        auto &material0 = materials.get(body0);
+        auto &material1 = materials.get(body1);
+        auto restitution = scalar(0);
+
+        if (auto *material = material_table.try_get({material0.id, material1.id})) {
+            restitution = material->restitution;
+        } else {
+            restitution = material_mix_restitution(material0.restitution, material1.restitution);
+        }
+
+        if (restitution > EDYN_EPSILON) {
+            restitution_tags.emplace(manifold_entity);
+        }
+
+        // Assign contact constraint to manifold.
+        make_edge(manifold_entity, body0, body1);
+        contacts.emplace(manifold_entity, body0, body1);
+    }
+};
+
+}
+
 entt::entity make_contact_manifold(entt::registry &registry,
                                    entt::entity body0, entt::entity body1,
                                    scalar separation_threshold) {
@@ -66,46 +153,43 @@ entt::entity make_contact_manifold(entt::registry &registry,
 void make_contact_manifold(entt::entity manifold_entity, entt::registry &registry,
                            entt::entity body0, entt::entity body1,
                            scalar separation_threshold) {
-    EDYN_ASSERT(registry.valid(body0) && registry.valid(body1));
-    registry.emplace<contact_manifold>(manifold_entity, body0, body1, separation_threshold);
-    registry.emplace<contact_manifold_events>(manifold_entity);
-
-    auto material_view = registry.view<material>();
-
-    // Only create contact constraint if bodies have material.
-    if (!material_view.contains(body0) || !material_view.contains(body1)) {
-        // If not, emplace a null constraint to ensure an edge will exist in
-        // the entity graph.
-        make_constraint<null_constraint>(registry, manifold_entity, body0, body1);
-        return;
+    auto maker = contact_manifold_maker(registry);
+    maker.make(manifold_entity, body0, body1, separation_threshold);
+}
+
+size_t make_contact_manifolds(entt::registry &registry, const entity_pair_vector &pairs,
+                              scalar separation_threshold) {
+    if (pairs.empty()) {
+        return 0;
     }
 
-    auto &material0 = material_view.get<material>(body0);
-    auto &material1 = material_view.get<material>(body1);
+    auto maker = contact_manifold_maker(registry);
+    auto &manifold_map = registry.ctx().get<contact_manifold_map>();
+    size_t count = 0;
 
-    auto &material_table = registry.ctx().get<material_mix_table>();
-    auto restitution = scalar(0);
+    maker.manifolds.reserve(maker.manifolds.size() + pairs.size());
+    maker.events.reserve(maker.events.size() + pairs.size());
 
-    if (auto *material = material_table.try_get({material0.id, material1.id})) {
-        restitution = material->restitution;
-    } else {
-        restitution = material_mix_restitution(material0.restitution, material1.restitution);
-    }
+    for (auto [body0, body1] : pairs) {
+        // The map is updated as manifolds are constructed, thus repeated
+        // pairs are skipped.
+        if (manifold_map.contains(body0, body1)) {
+            continue;
+        }
 
-    if (restitution > EDYN_EPSILON) {
-        registry.emplace<contact_manifold_with_restitution>(manifold_entity);
+        maker.make(registry.create(), body0, body1, separation_threshold);
+        ++count;
     }
 
-    // Assign contact constraint to manifold.
-    make_constraint<contact_constraint>(registry, manifold_entity, body0, body1);
+    return count;
 }
 
 void swap_manifold(contact_manifold &manifold) {
     std::swap(manifold.body[0], manifold.body[1]);
 
-    manifold.each_point([](contact_point &cp) {
+    manifold.each_point([](contact_point &cp, contact_point_cold &cold) {
         std::swap(cp.pivotA, cp.pivotB);
-        std::swap(cp.featureA, cp.featureB);
+        std::swap(cold.featureA, cold.featureB);
         cp.normal *= -1; // Point towards new A.
 
         if (cp.normal_attachment == contact_normal_attachment::normal_on_A) {
@@ -116,8 +200,10 @@ void swap_manifold(contact_manifold &manifold) {
     });
 }
 
-scalar get_effective_mass(const constraint_row &row) {
-    return get_effective_mass(row.J, row.inv_mA, row.inv_IA, row.inv_mB, row.inv_IB);
+scalar get_effective_mass(const constraint_row &row, const std::vector<solver_body> &bodies) {
+    auto &bodyA = bodies[row.body[0]];
+    auto &bodyB = bodies[row.body[1]];
+    return get_effective_mass(row.J, bodyA.inv_m, bodyA.inv_I, bodyB.inv_m, bodyB.inv_I);
 }
 
 scalar get_effective_mass(const std::array<vector3, 4> &J,
@@ -127,7 +213,7 @@ scalar get_effective_mass(const std::array<vector3, 4> &J,
                      dot(inv_IA * J[1], J[1]) +
                      dot(J[2], J[2]) * inv_mB +
                      dot(inv_IB * J[3], J[3]);
-    auto eff_mass = scalar(1) / J_invM_JT;
+    auto eff_mass = J_invM_JT > 0 ? scalar(1) / J_invM_JT : scalar(0);
     return eff_mass;
 }
 
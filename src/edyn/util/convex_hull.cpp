@@ -0,0 +1,765 @@
+#include "edyn/util/convex_hull.hpp"
+#include "edyn/config/config.h"
+#include "edyn/util/shape_util.hpp"
+#include <entt/signal/delegate.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+
+namespace edyn {
+
+namespace {
+
+constexpr auto invalid_index = std::numeric_limits<uint32_t>::max();
+
+/**
+ * Triangle of the hull under construction. Edge `i` goes from `vertices[i]`
+ * to `vertices[(i + 1) % 3]` and `adjacent[i]` is the triangle on the other
+ * side of it. Vertices are in counter-clockwise order seen from outside.
+ */
+struct hull_triangle {
+    std::array<uint32_t, 3> vertices;
+    std::array<uint32_t, 3> adjacent;
+    vector3 normal;
+    scalar offset;
+    // Head of the linked list of points outside of this triangle, which are
+    // the points assigned to it that are above its plane.
+    uint32_t outside_head {invalid_index};
+    bool alive {true};
+
+    scalar distance(const vector3 &point) const {
+        return dot(normal, point) - offset;
+    }
+
+    uint32_t edge_to(uint32_t triangle_index) const {
+        for (uint32_t i = 0; i < 3; ++i) {
+            if (adjacent[i] == triangle_index) {
+                return i;
+            }
+        }
+
+        EDYN_ASSERT(false);
+        return 0;
+    }
+};
+
+// Edge of the horizon, which separates the triangles visible from the eye
+// point from the others. It's an edge of a visible triangle.
+struct horizon_edge {
+    uint32_t triangle;
+    uint32_t edge;
+};
+
+/**
+ * Finds the unique directions in the same way as
+ * `convex_mesh::calculate_relevant_faces` and `calculate_relevant_edges`,
+ * i.e. a direction is relevant if no previous relevant direction is similar
+ * to it, but only compares directions that fall in neighboring cells of a
+ * grid, instead of comparing against all relevant directions found so far.
+ * If `ignore_sign` is true, opposite directions are considered similar.
+ */
+void find_relevant_directions(const std::vector<vector3> &directions, bool ignore_sign,
+                              std::vector<uint32_t> &relevant) {
+    constexpr auto min_dot = scalar(1) - convex_mesh_relevant_direction_tolerance;
+    // Similar unit vectors are within `sqrt(2 * tolerance)` of one another.
+    // The cells are made twice as large for safety against rounding errors.
+    const auto cell_size = scalar(2) * std::sqrt(scalar(2) * convex_mesh_relevant_direction_tolerance);
+
+    auto cell_of = [&](const vector3 &dir) {
+        return std::array<int32_t, 3>{
+            static_cast<int32_t>(std::floor(dir.x / cell_size)),
+            static_cast<int32_t>(std::floor(dir.y / cell_size)),
+            static_cast<int32_t>(std::floor(dir.z / cell_size))
+        };
+    };
+
+    auto cell_key = [](int32_t x, int32_t y, int32_t z) {
+        constexpr auto mask = (uint64_t(1) << 21) - 1;
+        return (uint64_t(x) & mask) | ((uint64_t(y) & mask) << 21) | ((uint64_t(z) & mask) << 42);
+    };
+
+    // Relevant directions in each cell, in a linked list.
+    auto cell_head = std::unordered_map<uint64_t, uint32_t>{};
+    auto next = std::vector<uint32_t>(directions.size(), invalid_index);
+
+    auto has_similar = [&](const vector3 &dir) {
+        auto cell = cell_of(dir);
+
+        for (auto x = cell[0] - 1; x <= cell[0] + 1; ++x) {
+            for (auto y = cell[1] - 1; y <= cell[1] + 1; ++y) {
+                for (auto z = cell[2] - 1; z <= cell[2] + 1; ++z) {
+                    auto it = cell_head.find(cell_key(x, y, z));
+
+                    if (it == cell_head.end()) continue;
+
+                    for (auto i = it->second; i != invalid_index; i = next[i]) {
+                        auto d = dot(dir, directions[i]);
+
+                        if (!((ignore_sign ? std::abs(d) : d) < min_dot)) {
+                            return true;
+                        }
+                    }
+                }
+            }
+        }
+
+        return false;
+    };
+
+    for (uint32_t i = 0; i < directions.size(); ++i) {
+        auto &dir = directions[i];
+
+        if (has_similar(dir) || (ignore_sign && has_similar(-dir))) {
+            continue;
+        }
+
+        relevant.push_back(i);
+        auto cell = cell_of(dir);
+        auto [it, inserted] = cell_head.emplace(cell_key(cell[0], cell[1], cell[2]), i);
+
+        if (!inserted) {
+            next[i] = it->second;
+            it->second = i;
+        }
+    }
+}
+
+class quickhull_builder {
+public:
+    quickhull_builder(const std::vector<vector3> &points, scalar tolerance)
+        : m_points(points)
+        , m_point_next(points.size(), invalid_index)
+    {
+        auto min = vector3_max;
+        auto max = -vector3_max;
+
+        for (auto &p : points) {
+            min = edyn::min(min, p);
+            max = edyn::max(max, p);
+        }
+
+        auto extent = points.empty() ? vector3_zero : max - min;
+        auto largest_extent = std::max(extent.x, std::max(extent.y, extent.z));
+        m_merge_tolerance = largest_extent * tolerance;
+
+        // The hull is built with a tolerance close to the precision of the
+        // coordinates. A larger tolerance lets points near short edges
+        // introduce errors in orientation big enough to make the hull concave.
+        // Nearly coplanar faces are merged afterwards with the larger one.
+        auto max_abs = edyn::max(abs(min), abs(max));
+        m_tolerance = scalar(3) * EDYN_EPSILON * (max_abs.x + max_abs.y + max_abs.z);
+    }
+
+    bool build() {
+        if (!create_simplex()) {
+            return false;
+        }
+
+        while (!m_pending.empty()) {
+            auto triangle_index = m_pending.back();
+            m_pending.pop_back();
+            auto &triangle = m_triangles[triangle_index];
+
+            if (!triangle.alive || triangle.outside_head == invalid_index) {
+                continue;
+            }
+
+            // The eye point is the point farthest from the triangle, which is
+            // certainly a vertex of the hull.
+            auto eye = invalid_index;
+            auto max_dist = -large_scalar;
+
+            for (auto p = triangle.outside_head; p != invalid_index; p = m_point_next[p]) {
+                auto dist = triangle.distance(m_points[p]);
+
+                if (dist > max_dist) {
+                    max_dist = dist;
+                    eye = p;
+                }
+            }
+
+            add_point(triangle_index, eye);
+        }
+
+        return true;
+    }
+
+    void assign_to(convex_mesh &mesh);
+
+private:
+    bool create_simplex();
+    void add_point(uint32_t triangle_index, uint32_t eye);
+    void find_horizon(uint32_t triangle_index, uint32_t eye);
+    uint32_t create_triangle(uint32_t v0, uint32_t v1, uint32_t v2);
+    void kill_triangle(uint32_t triangle_index);
+    void assign_points(const std::vector<uint32_t> &points, uint32_t first_triangle);
+
+    const std::vector<vector3> &m_points;
+    std::vector<uint32_t> m_point_next;
+    std::vector<hull_triangle> m_triangles;
+    std::vector<uint32_t> m_pending;
+    std::vector<horizon_edge> m_horizon;
+    std::vector<uint32_t> m_unclaimed;
+    scalar m_tolerance;
+    scalar m_merge_tolerance;
+};
+
+uint32_t quickhull_builder::create_triangle(uint32_t v0, uint32_t v1, uint32_t v2) {
+    auto &triangle = m_triangles.emplace_back();
+    triangle.vertices = {v0, v1, v2};
+    triangle.adjacent = {invalid_index, invalid_index, invalid_index};
+
+    auto &p0 = m_points[v0];
+    auto &p1 = m_points[v1];
+    auto &p2 = m_points[v2];
+    auto normal = cross(p1 - p0, p2 - p0);
+
+    if (!try_normalize(normal)) {
+        normal = vector3_y;
+    }
+
+    triangle.normal = normal;
+    triangle.offset = dot(normal, (p0 + p1 + p2) / scalar(3));
+
+    return static_cast<uint32_t>(m_triangles.size() - 1);
+}
+
+void quickhull_builder::kill_triangle(uint32_t triangle_index) {
+    auto &triangle = m_triangles[triangle_index];
+    triangle.alive = false;
+
+    for (auto p = triangle.outside_head; p != invalid_index; p = m_point_next[p]) {
+        m_unclaimed.push_back(p);
+    }
+
+    triangle.outside_head = invalid_index;
+}
+
+void quickhull_builder::assign_points(const std::vector<uint32_t> &points, uint32_t first_triangle) {
+    // Assign each point to the triangle it is farthest above. Points which are
+    // not above any of the triangles are inside of the hull and are dropped.
+    for (auto p : points) {
+        auto &point = m_points[p];
+        auto best_triangle = invalid_index;
+        auto max_dist = m_tolerance;
+
+        for (auto i = first_triangle; i < m_triangles.size(); ++i) {
+            auto dist = m_triangles[i].distance(point);
+
+            if (dist > max_dist) {
+                max_dist = dist;
+                best_triangle = i;
+            }
+        }
+
+        if (best_triangle != invalid_index) {
+            auto &triangle = m_triangles[best_triangle];
+
+            if (triangle.outside_head == invalid_index) {
+                m_pending.push_back(best_triangle);
+            }
+
+            m_point_next[p] = triangle.outside_head;
+            triangle.outside_head = p;
+        }
+    }
+}
+
+bool quickhull_builder::create_simplex() {
+    if (m_points.size() < 4) {
+        return false;
+    }
+
+    // Pick two points far apart among the extreme points along each axis.
+    std::array<uint32_t, 6> extremes {};
+
+    for (uint32_t i = 0; i < m_points.size(); ++i) {
+        for (int axis = 0; axis < 3; ++axis) {
+            if (m_points[i][axis] < m_points[extremes[axis * 2]][axis]) {
+                extremes[axis * 2] = i;
+            }
+
+            if (m_points[i][axis] > m_points[extremes[axis * 2 + 1]][axis]) {
+                extremes[axis * 2 + 1] = i;
+            }
+        }
+    }
+
+    uint32_t v0 = 0, v1 = 0;
+    auto max_dist_sqr = scalar(0);
+
+    for (int axis = 0; axis < 3; ++axis) {
+        auto i0 = extremes[axis * 2];
+        auto i1 = extremes[axis * 2 + 1];
+        auto dist_sqr = distance_sqr(m_points[i0], m_points[i1]);
+
+        if (dist_sqr > max_dist_sqr) {
+            max_dist_sqr = dist_sqr;
+            v0 = i0;
+            v1 = i1;
+        }
+    }
+
+    if (!(max_dist_sqr > m_merge_tolerance * m_merge_tolerance) || !(m_tolerance > 0)) {
+        return false;
+    }
+
+    // Point farthest from the line.
+    auto &p0 = m_points[v0];
+    auto dir = normalize(m_points[v1] - p0);
+    uint32_t v2 = 0;
+    max_dist_sqr = 0;
+
+    for (uint32_t i = 0; i < m_points.size(); ++i) {
+        auto d = m_points[i] - p0;
+        auto dist_sqr = length_sqr(d - dir * dot(d, dir));
+
+        if (dist_sqr > max_dist_sqr) {
+            max_dist_sqr = dist_sqr;
+            v2 = i;
+        }
+    }
+
+    if (!(max_dist_sqr > m_merge_tolerance * m_merge_tolerance)) {
+        return false;
+    }
+
+    // Point farthest from the plane.
+    auto normal = normalize(cross(m_points[v1] - p0, m_points[v2] - p0));
+    uint32_t v3 = 0;
+    auto max_dist = scalar(0);
+
+    for (uint32_t i = 0; i < m_points.size(); ++i) {
+        auto dist = std::abs(dot(m_points[i] - p0, normal));
+
+        if (dist > max_dist) {
+            max_dist = dist;
+            v3 = i;
+        }
+    }
+
+    if (!(max_dist > m_merge_tolerance)) {
+        return false;
+    }
+
+    // Make the base triangle face away from the fourth point.
+    if (dot(m_points[v3] - p0, normal) > 0) {
+        std::swap(v1, v2);
+    }
+
+    // Triangles 1, 2 and 3 share edges 0, 1 and 2 of the base, respectively,
+    // in their edge 0 and share the edges that go up to `v3` between them.
+    create_triangle(v0, v1, v2);
+    create_triangle(v1, v0, v3);
+    create_triangle(v2, v1, v3);
+    create_triangle(v0, v2, v3);
+
+    m_triangles[0].adjacent = {1, 2, 3};
+    m_triangles[1].adjacent = {0, 3, 2};
+    m_triangles[2].adjacent = {0, 1, 3};
+    m_triangles[3].adjacent = {0, 2, 1};
+
+    auto points = std::vector<uint32_t>{};
+    points.reserve(m_points.size());
+
+    for (uint32_t i = 0; i < m_points.size(); ++i) {
+        if (i != v0 && i != v1 && i != v2 && i != v3) {
+            points.push_back(i);
+        }
+    }
+
+    assign_points(points, 0);
+
+    return true;
+}
+
+void quickhull_builder::find_horizon(uint32_t triangle_index, uint32_t eye) {
+    // Depth-first traversal of the visible triangles which stops at the
+    // triangles that are not visible. The horizon edges are found in order,
+    // forming a loop around the visible region, because the edges of each
+    // triangle are visited in order starting after the edge it was entered
+    // through. An explicit stack is used since the visible region can be large.
+    struct frame {
+        uint32_t triangle;
+        uint32_t edge;
+        uint32_t remaining;
+    };
+
+    auto &eye_point = m_points[eye];
+    auto stack = std::vector<frame>{};
+    stack.push_back({triangle_index, 0, 3});
+    kill_triangle(triangle_index);
+    m_horizon.clear();
+
+    while (!stack.empty()) {
+        auto &top = stack.back();
+
+        if (top.remaining == 0) {
+            stack.pop_back();
+            continue;
+        }
+
+        auto current = top.triangle;
+        auto edge = top.edge;
+        top.edge = (edge + 1) % 3;
+        --top.remaining;
+
+        auto neighbor = m_triangles[current].adjacent[edge];
+
+        if (!m_triangles[neighbor].alive) {
+            continue;
+        }
+
+        if (m_triangles[neighbor].distance(eye_point) > m_tolerance) {
+            auto entry_edge = m_triangles[neighbor].edge_to(current);
+            kill_triangle(neighbor);
+            stack.push_back({neighbor, (entry_edge + 1) % 3, 2});
+        } else {
+            m_horizon.push_back({current, edge});
+        }
+    }
+}
+
+void quickhull_builder::add_point(uint32_t triangle_index, uint32_t eye) {
+    m_unclaimed.clear();
+    find_horizon(triangle_index, eye);
+    EDYN_ASSERT(m_horizon.size() >= 3);
+
+    // Create a fan of triangles connecting the horizon to the eye point.
+    auto first_new = static_cast<uint32_t>(m_triangles.size());
+    auto num_new = static_cast<uint32_t>(m_horizon.size());
+
+    for (uint32_t i = 0; i < num_new; ++i) {
+        auto [visible, edge] = m_horizon[i];
+        auto v0 = m_triangles[visible].vertices[edge];
+        auto v1 = m_triangles[visible].vertices[(edge + 1) % 3];
+        auto outside = m_triangles[visible].adjacent[edge];
+
+        auto new_index = create_triangle(v0, v1, eye);
+        auto &triangle = m_triangles[new_index];
+        triangle.adjacent[0] = outside;
+        triangle.adjacent[1] = first_new + (i + 1) % num_new;
+        triangle.adjacent[2] = first_new + (i + num_new - 1) % num_new;
+
+        auto &outside_triangle = m_triangles[outside];
+        outside_triangle.adjacent[outside_triangle.edge_to(visible)] = new_index;
+    }
+
+    // The eye point is now a vertex.
+    m_unclaimed.erase(std::remove(m_unclaimed.begin(), m_unclaimed.end(), eye), m_unclaimed.end());
+    assign_points(m_unclaimed, first_new);
+}
+
+void quickhull_builder::assign_to(convex_mesh &mesh) {
+    auto num_triangles = static_cast<uint32_t>(m_triangles.size());
+
+    // Merge nearly coplanar triangles into polygons by growing a region from
+    // each of the largest remaining triangles. All vertices of the region must
+    // be close to the plane of the first triangle, which prevents drifting
+    // along slightly curved surfaces.
+    auto order = std::vector<uint32_t>{};
+    auto area = std::vector<scalar>(num_triangles, scalar(0));
+
+    for (uint32_t i = 0; i < num_triangles; ++i) {
+        auto &triangle = m_triangles[i];
+
+        if (!triangle.alive) continue;
+
+        auto &p0 = m_points[triangle.vertices[0]];
+        auto &p1 = m_points[triangle.vertices[1]];
+        auto &p2 = m_points[triangle.vertices[2]];
+        area[i] = length_sqr(cross(p1 - p0, p2 - p0));
+        order.push_back(i);
+    }
+
+    std::sort(order.begin(), order.end(), [&](auto a, auto b) {
+        return area[a] > area[b];
+    });
+
+    auto group = std::vector<uint32_t>(num_triangles, invalid_index);
+    auto num_groups = uint32_t{0};
+    auto frontier = std::vector<uint32_t>{};
+
+    for (auto seed : order) {
+        if (group[seed] != invalid_index) continue;
+
+        auto &seed_triangle = m_triangles[seed];
+        group[seed] = num_groups;
+        frontier.push_back(seed);
+
+        while (!frontier.empty()) {
+            auto current = frontier.back();
+            frontier.pop_back();
+
+            for (auto neighbor : m_triangles[current].adjacent) {
+                if (group[neighbor] != invalid_index) continue;
+
+                auto &triangle = m_triangles[neighbor];
+                auto coplanar = dot(triangle.normal, seed_triangle.normal) > 0;
+
+                for (auto v : triangle.vertices) {
+                    coplanar &= std::abs(seed_triangle.distance(m_points[v])) < m_merge_tolerance;
+                }
+
+                if (coplanar) {
+                    group[neighbor] = num_groups;
+                    frontier.push_back(neighbor);
+                }
+            }
+        }
+
+        ++num_groups;
+    }
+
+    // Absorb triangles surrounded by a single group, which would otherwise
+    // leave a hole in its polygon.
+    for (auto i : order) {
+        auto &adjacent = m_triangles[i].adjacent;
+        auto g = group[adjacent[0]];
+
+        if (g != group[i] && g == group[adjacent[1]] && g == group[adjacent[2]]) {
+            group[i] = g;
+        }
+    }
+
+    // Collect the boundary of each group as a loop of vertices. If the
+    // boundary is not a single simple loop, the group is split back into
+    // the triangles it's made of.
+    auto group_triangles = std::vector<std::vector<uint32_t>>(num_groups);
+
+    for (auto i : order) {
+        group_triangles[group[i]].push_back(i);
+    }
+
+    auto loops = std::vector<std::vector<uint32_t>>{};
+    auto next_vertex = std::unordered_map<uint32_t, uint32_t>{};
+
+    for (auto &triangles : group_triangles) {
+        if (triangles.empty()) continue;
+
+        next_vertex.clear();
+        auto simple = true;
+
+        for (auto i : triangles) {
+            auto &triangle = m_triangles[i];
+
+            for (uint32_t e = 0; e < 3; ++e) {
+                if (group[triangle.adjacent[e]] == group[i]) continue;
+
+                auto v0 = triangle.vertices[e];
+                auto v1 = triangle.vertices[(e + 1) % 3];
+                simple &= next_vertex.emplace(v0, v1).second;
+            }
+        }
+
+        auto loop = std::vector<uint32_t>{};
+
+        if (simple && !next_vertex.empty()) {
+            auto start = next_vertex.begin()->first;
+            auto v = start;
+
+            do {
+                loop.push_back(v);
+                auto it = next_vertex.find(v);
+
+                if (it == next_vertex.end() || loop.size() > next_vertex.size()) {
+                    simple = false;
+                    break;
+                }
+
+                v = it->second;
+            } while (v != start);
+
+            simple &= loop.size() == next_vertex.size();
+        }
+
+        if (simple) {
+            loops.push_back(std::move(loop));
+        } else {
+            for (auto i : triangles) {
+                auto &vertices = m_triangles[i].vertices;
+                loops.emplace_back(vertices.begin(), vertices.end());
+            }
+        }
+    }
+
+    // Vertices in less than three faces lie in the middle of an edge or of a
+    // face, thus they're not corners of the hull and are removed.
+    auto num_points = static_cast<uint32_t>(m_points.size());
+    auto face_count = std::vector<uint32_t>(num_points, 0);
+
+    for (auto &loop : loops) {
+        for (auto v : loop) {
+            ++face_count[v];
+        }
+    }
+
+    for (auto &loop : loops) {
+        auto reduced = loop;
+        reduced.erase(std::remove_if(reduced.begin(), reduced.end(), [&](auto v) {
+            return face_count[v] < 3;
+        }), reduced.end());
+
+        if (reduced.size() >= 3) {
+            loop = std::move(reduced);
+        }
+    }
+
+    // Assign vertices and faces.
+    mesh = convex_mesh{};
+    auto vertex_remap = std::vector<uint32_t>(num_points, invalid_index);
+
+    for (auto &loop : loops) {
+        mesh.faces.push_back(static_cast<uint32_t>(mesh.indices.size()));
+        mesh.faces.push_back(static_cast<uint32_t>(loop.size()));
+
+        // Newell's method gives a good normal for polygons which are not
+        // perfectly flat.
+        auto normal = vector3_zero;
+
+        for (size_t i = 0; i < loop.size(); ++i) {
+            auto &p0 = m_points[loop[i]];
+            auto &p1 = m_points[loop[(i + 1) % loop.size()]];
+            normal += cross(p0, p1);
+        }
+
+        if (!try_normalize(normal)) {
+            normal = vector3_y;
+        }
+
+        mesh.normals.push_back(normal);
+
+        for (auto v : loop) {
+            if (vertex_remap[v] == invalid_index) {
+                vertex_remap[v] = static_cast<uint32_t>(mesh.vertices.size());
+                mesh.vertices.push_back(m_points[v]);
+            }
+
+            mesh.indices.push_back(vertex_remap[v]);
+        }
+    }
+
+    // Edges are found in the same orientation and order of
+    // `convex_mesh::calculate_edges`, using a map instead of a linear search.
+    auto edge_map = std::unordered_map<uint64_t, uint32_t>{};
+    edge_map.reserve(mesh.indices.size());
+
+    for (uint32_t face_idx = 0; face_idx < mesh.num_faces(); ++face_idx) {
+        auto first = mesh.faces[face_idx * 2];
+        auto count = mesh.faces[face_idx * 2 + 1];
+
+        for (uint32_t i = 0; i < count; ++i) {
+            auto v0 = mesh.indices[first + i];
+            auto v1 = mesh.indices[first + (i + 1) % count];
+            auto key = (uint64_t(std::min(v0, v1)) << 32) | uint64_t(std::max(v0, v1));
+            auto [it, inserted] = edge_map.emplace(key, static_cast<uint32_t>(mesh.num_edges()));
+
+            if (inserted) {
+                mesh.edges.push_back(v0);
+                mesh.edges.push_back(v1);
+                mesh.edge_faces.push_back(face_idx);
+                mesh.edge_faces.push_back(invalid_index);
+            } else {
+                EDYN_ASSERT(mesh.edge_faces[it->second * 2 + 1] == invalid_index);
+                mesh.edge_faces[it->second * 2 + 1] = face_idx;
+            }
+        }
+    }
+
+    // Vertex neighbors with a counting sort of the edges, which gives the same
+    // order as `convex_mesh::calculate_neighbors`.
+    auto num_vertices = mesh.vertices.size();
+    mesh.neighbors_start.assign(num_vertices + 1, 0);
+
+    for (auto v : mesh.edges) {
+        ++mesh.neighbors_start[v + 1];
+    }
+
+    for (size_t i = 0; i < num_vertices; ++i) {
+        mesh.neighbors_start[i + 1] += mesh.neighbors_start[i];
+    }
+
+    mesh.neighbor_indices.resize(mesh.edges.size());
+    auto cursor = std::vector<uint32_t>(mesh.neighbors_start.begin(), mesh.neighbors_start.end() - 1);
+
+    for (size_t edge_idx = 0; edge_idx < mesh.num_edges(); ++edge_idx) {
+        auto v0 = mesh.edges[edge_idx * 2];
+        auto v1 = mesh.edges[edge_idx * 2 + 1];
+        mesh.neighbor_indices[cursor[v0]++] = v1;
+        mesh.neighbor_indices[cursor[v1]++] = v0;
+    }
+
+}
+
+void calculate_relevant_directions(convex_mesh &mesh) {
+    find_relevant_directions(mesh.normals, false, mesh.relevant_faces);
+
+    auto edge_directions = std::vector<vector3>(mesh.num_edges());
+
+    for (size_t edge_idx = 0; edge_idx < mesh.num_edges(); ++edge_idx) {
+        edge_directions[edge_idx] = normalize(mesh.get_edge_direction(edge_idx));
+    }
+
+    find_relevant_directions(edge_directions, true, mesh.relevant_edges);
+}
+
+}
+
+bool make_convex_hull(const std::vector<vector3> &points, convex_mesh &mesh,
+                      vector3 *centroid, scalar tolerance) {
+    auto builder = quickhull_builder(points, tolerance);
+
+    if (!builder.build()) {
+        mesh = convex_mesh{};
+        return false;
+    }
+
+    builder.assign_to(mesh);
+
+    if (centroid) {
+        *centroid = mesh_centroid(mesh.vertices, mesh.indices, mesh.faces);
+
+        for (auto &v : mesh.vertices) {
+            v -= *centroid;
+        }
+    }
+
+    // Edge directions are calculated after shifting, as it would be done in
+    // `convex_mesh::initialize`, to get the exact same results.
+    calculate_relevant_directions(mesh);
+    mesh.calculate_bounding_radius();
+
+    EDYN_ASSERT(mesh.validate());
+
+    return true;
+}
+
+void make_convex_hulls(const std::vector<std::vector<vector3>> &point_clouds,
+                       std::vector<convex_mesh> &meshes,
+                       std::vector<vector3> *centroids,
+                       enqueue_task_wait_t *enqueue_task_wait) {
+    meshes.resize(point_clouds.size());
+
+    if (centroids) {
+        centroids->resize(point_clouds.size());
+    }
+
+    auto task_func = [&](unsigned start, unsigned end) {
+        for (auto i = start; i < end; ++i) {
+            auto *centroid = centroids ? &(*centroids)[i] : nullptr;
+            make_convex_hull(point_clouds[i], meshes[i], centroid);
+        }
+    };
+
+    if (enqueue_task_wait && point_clouds.size() > 1) {
+        auto task = task_delegate_t(entt::connect_arg_t<&decltype(task_func)::operator()>{}, task_func);
+        (*enqueue_task_wait)(task, static_cast<unsigned>(point_clouds.size()));
+    } else {
+        task_func(0, static_cast<unsigned>(point_clouds.size()));
+    }
+}
+
+}
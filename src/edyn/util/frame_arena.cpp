@@ -0,0 +1,47 @@
+#include "edyn/util/frame_arena.hpp"
+#include <algorithm>
+
+namespace edyn {
+
+frame_arena & frame_arena::local() {
+    static thread_local frame_arena arena;
+    return arena;
+}
+
+void * frame_arena::allocate(size_t size, size_t alignment) {
+    // Look for space in the current chunk and in the chunks after it, which
+    // were kept from before the last rewind.
+    for (; m_chunk < m_chunks.size(); ++m_chunk, m_offset = 0) {
+        auto &chunk = m_chunks[m_chunk];
+        auto base = reinterpret_cast<uintptr_t>(chunk.data.get());
+        auto start = ((base + m_offset + alignment - 1) & ~(alignment - 1)) - base;
+
+        if (start + size <= chunk.size) {
+            m_offset = start + size;
+            return chunk.data.get() + start;
+        }
+    }
+
+    auto chunk_size = m_chunks.empty() ? min_chunk_size : m_chunks.back().size * 2;
+    chunk_size = std::max(chunk_size, size + alignment);
+    m_chunks.push_back({std::make_unique<uint8_t[]>(chunk_size), chunk_size});
+
+    auto &chunk = m_chunks.back();
+    auto base = reinterpret_cast<uintptr_t>(chunk.data.get());
+    auto start = ((base + alignment - 1) & ~(alignment - 1)) - base;
+    m_offset = start + size;
+
+    return chunk.data.get() + start;
+}
+
+size_t frame_arena::capacity() const {
+    size_t size = 0;
+
+    for (auto &chunk : m_chunks) {
+        size += chunk.size;
+    }
+
+    return size;
+}
+
+}
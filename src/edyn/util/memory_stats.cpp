@@ -0,0 +1,105 @@
+#include "edyn/util/memory_stats.hpp"
+#include "edyn/collision/broadphase.hpp"
+#include "edyn/collision/contact_manifold.hpp"
+#include "edyn/core/entity_graph.hpp"
+#include "edyn/dynamics/row_cache.hpp"
+#include "edyn/dynamics/solver.hpp"
+#include "edyn/networking/comp/action_history.hpp"
+#include "edyn/networking/comp/remote_client.hpp"
+#include "edyn/networking/context/client_network_context.hpp"
+#include "edyn/networking/context/server_network_context.hpp"
+#include "edyn/parallel/message.hpp"
+#include "edyn/replication/registry_operation.hpp"
+#include "edyn/replication/registry_operation_pool.hpp"
+#include "edyn/shapes/paged_mesh_page_cache.hpp"
+#include "edyn/simulation/stepper_async.hpp"
+#include "edyn/simulation/stepper_sequential.hpp"
+#include <entt/entity/registry.hpp>
+
+namespace edyn {
+
+static size_t network_history_bytes(entt::registry &registry) {
+    size_t size = 0;
+
+    for (auto [entity, history] : registry.view<action_history>().each()) {
+        size += history.entries.capacity() * sizeof(action_history::entry) + history.data.capacity();
+    }
+
+    if (auto *ctx = registry.ctx().find<client_network_context>()) {
+        if (ctx->input_history) {
+            size += ctx->input_history->num_bytes();
+        }
+
+        // The baseline is only accessed by the decoding task while it runs.
+        auto lock = std::lock_guard(ctx->snapshot_decode->mutex);
+
+        if (!ctx->snapshot_decode->running) {
+            size += ctx->received_snapshots.num_bytes();
+        }
+    }
+
+    if (registry.ctx().contains<server_network_context>()) {
+        for (auto [entity, client] : registry.view<remote_client>().each()) {
+            size += client.sent_snapshots.num_bytes();
+        }
+    }
+
+    return size;
+}
+
+// Fills in the statistics of the main registry and those shared by all
+// worlds, which must be collected in the main thread.
+static void collect_main_memory_stats(entt::registry &registry, memory_stats &stats) {
+    stats.network_histories = network_history_bytes(registry);
+    stats.paged_mesh_pages = paged_mesh_page_cache::global().get_stats().num_bytes;
+
+    auto pooled = registry_operation_pool::global().pooled_bytes();
+    auto allocated = registry_operation::allocated_bytes();
+    stats.registry_operations_pooled = pooled;
+    stats.registry_operations_in_flight = allocated > pooled ? allocated - pooled : 0;
+}
+
+query_future<memory_stats> query_memory_stats(entt::registry &registry) {
+    auto promise = query_promise<memory_stats>{};
+    auto future = promise.get_future([&registry](memory_stats &stats) {
+        collect_main_memory_stats(registry, stats);
+    });
+
+    if (auto *stepper = registry.ctx().find<stepper_async>()) {
+        stepper->send_message_to_worker<msg::query_memory_stats_request>(std::move(promise));
+    } else {
+        auto stats = memory_stats{};
+        internal::collect_simulation_memory_stats(registry, registry.ctx().get<stepper_sequential>().get_solver(), stats);
+        promise.set_value(std::move(stats));
+    }
+
+    return future;
+}
+
+}
+
+namespace edyn::internal {
+
+void collect_simulation_memory_stats(entt::registry &registry, const solver &solver,
+                                     memory_stats &stats) {
+    if (auto *bphase = registry.ctx().find<broadphase>()) {
+        stats.broadphase = bphase->num_bytes();
+    }
+
+    if (auto *graph = registry.ctx().find<entity_graph>()) {
+        stats.entity_graph = graph->num_bytes();
+    }
+
+    stats.contact_manifolds = registry.storage<contact_manifold>().capacity() * sizeof(contact_manifold);
+
+    stats.row_caches = 0;
+
+    for (auto [entity, cache] : registry.view<row_cache>().each()) {
+        stats.row_caches += sizeof(row_cache) + cache.num_bytes();
+    }
+
+    stats.prep_caches = solver.num_bytes() +
+        registry.storage<constraint_row_prep_cache>().capacity() * sizeof(constraint_row_prep_cache);
+}
+
+}
@@ -6,8 +6,12 @@
 namespace edyn::internal {
 
 struct paged_mesh_page_load_context {
-    message_queue_handle<msg::paged_triangle_mesh_load_page> queue;
+    message_queue_handle<msg::paged_triangle_mesh_load_page,
+                         msg::paged_triangle_mesh_evict_page,
+                         msg::paged_triangle_mesh_page_miss> queue;
     entt::sigh<void(entt::entity, size_t)> load_signal;
+    entt::sigh<void(entt::entity, size_t)> evict_signal;
+    entt::sigh<void(entt::entity, size_t, const AABB &)> miss_signal;
 };
 
 void on_paged_triangle_mesh_load_page(entt::registry &registry, message<msg::paged_triangle_mesh_load_page> &msg) {
@@ -21,10 +25,37 @@ void on_paged_triangle_mesh_load_page(entt::registry &registry, message<msg::pag
     }
 }
 
+void on_paged_triangle_mesh_evict_page(entt::registry &registry, message<msg::paged_triangle_mesh_evict_page> &msg) {
+    auto &ctx = registry.ctx().get<paged_mesh_page_load_context>();
+
+    for (auto [entity, shape] : registry.view<paged_mesh_shape>().each()) {
+        if (shape.trimesh.get() == msg.content.trimesh) {
+            ctx.evict_signal.publish(entity, msg.content.mesh_index);
+            break;
+        }
+    }
+}
+
+void on_paged_triangle_mesh_page_miss(entt::registry &registry, message<msg::paged_triangle_mesh_page_miss> &msg) {
+    auto &ctx = registry.ctx().get<paged_mesh_page_load_context>();
+
+    for (auto [entity, shape] : registry.view<paged_mesh_shape>().each()) {
+        if (shape.trimesh.get() == msg.content.trimesh) {
+            ctx.miss_signal.publish(entity, msg.content.mesh_index, msg.content.aabb);
+            break;
+        }
+    }
+}
+
 void init_paged_mesh_load_reporting(entt::registry &registry) {
     auto &dispatcher = message_dispatcher::global();
-    auto &ctx = registry.ctx().emplace<paged_mesh_page_load_context>(dispatcher.make_queue<msg::paged_triangle_mesh_load_page>(paged_mesh_load_queue_identifier));
+    auto &ctx = registry.ctx().emplace<paged_mesh_page_load_context>(
+        dispatcher.make_queue<msg::paged_triangle_mesh_load_page,
+                              msg::paged_triangle_mesh_evict_page,
+                              msg::paged_triangle_mesh_page_miss>(paged_mesh_load_queue_identifier));
     ctx.queue.sink<msg::paged_triangle_mesh_load_page>().connect<&on_paged_triangle_mesh_load_page>(registry);
+    ctx.queue.sink<msg::paged_triangle_mesh_evict_page>().connect<&on_paged_triangle_mesh_evict_page>(registry);
+    ctx.queue.sink<msg::paged_triangle_mesh_page_miss>().connect<&on_paged_triangle_mesh_page_miss>(registry);
 }
 
 void update_paged_mesh_load_reporting(entt::registry &registry) {
@@ -45,4 +76,14 @@ entt::sink<entt::sigh<void(entt::entity, size_t)>> on_paged_mesh_page_loaded(ent
     return {ctx.load_signal};
 }
 
+entt::sink<entt::sigh<void(entt::entity, size_t)>> on_paged_mesh_page_evicted(entt::registry &registry) {
+    auto &ctx = registry.ctx().get<internal::paged_mesh_page_load_context>();
+    return {ctx.evict_signal};
+}
+
+entt::sink<entt::sigh<void(entt::entity, size_t, const AABB &)>> on_paged_mesh_page_missed(entt::registry &registry) {
+    auto &ctx = registry.ctx().get<internal::paged_mesh_page_load_context>();
+    return {ctx.miss_signal};
+}
+
 }
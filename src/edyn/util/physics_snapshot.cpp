@@ -0,0 +1,68 @@
+#include "edyn/util/physics_snapshot.hpp"
+#include "edyn/collision/contact_manifold.hpp"
+#include "edyn/comp/aabb.hpp"
+#include "edyn/comp/angvel.hpp"
+#include "edyn/comp/inertia.hpp"
+#include "edyn/comp/island.hpp"
+#include "edyn/comp/linvel.hpp"
+#include "edyn/comp/orientation.hpp"
+#include "edyn/comp/origin.hpp"
+#include "edyn/comp/position.hpp"
+#include "edyn/constraints/constraint.hpp"
+#include <entt/entity/registry.hpp>
+
+namespace edyn {
+
+template<typename... Constraints>
+static void add_constraint_pools(physics_snapshot &snapshot, [[maybe_unused]] const std::tuple<Constraints...> &) {
+    (snapshot.add_component<Constraints>(), ...);
+}
+
+physics_snapshot::physics_snapshot() {
+    add_component<position>();
+    add_component<orientation>();
+    add_component<linvel>();
+    add_component<angvel>();
+    add_component<origin>();
+    add_component<AABB>();
+    add_component<island_AABB>();
+    add_component<inertia_world_inv>();
+    add_component<contact_manifold>();
+    add_constraint_pools(*this, constraints_tuple);
+}
+
+void physics_snapshot::capture(const entt::registry &registry) {
+    for (auto &pool : m_pools) {
+        pool->capture(registry);
+    }
+
+    m_manifold_entities.clear();
+
+    for (auto entity : registry.view<contact_manifold>()) {
+        m_manifold_entities.push(entity);
+    }
+}
+
+void physics_snapshot::restore(entt::registry &registry) const {
+    for (auto &pool : m_pools) {
+        pool->restore(registry);
+    }
+
+    for (auto [entity, manifold] : registry.view<contact_manifold>().each()) {
+        if (!m_manifold_entities.contains(entity)) {
+            manifold.num_points = 0;
+        }
+    }
+}
+
+size_t physics_snapshot::size_bytes() const {
+    auto size = size_t{};
+
+    for (auto &pool : m_pools) {
+        size += pool->size_bytes();
+    }
+
+    return size;
+}
+
+}
@@ -1,6 +1,7 @@
 #include "edyn/util/polyhedron_shape_initializer.hpp"
 #include "edyn/comp/orientation.hpp"
 #include "edyn/comp/rotated_mesh_list.hpp"
+#include "edyn/context/task_util.hpp"
 #include "edyn/shapes/compound_shape.hpp"
 #include "edyn/shapes/polyhedron_shape.hpp"
 #include "edyn/util/entt_util.hpp"
@@ -9,6 +10,10 @@
 
 namespace edyn {
 
+// Minimum number of new polyhedrons for their rotated meshes to be built in
+// worker threads.
+static constexpr size_t parallel_init_threshold = 32;
+
 polyhedron_shape_initializer::polyhedron_shape_initializer(entt::registry &registry)
     : m_registry(&registry)
 {
@@ -56,7 +61,7 @@ void polyhedron_shape_initializer::on_destroy_rotated_mesh_list(entt::registry &
     }
 }
 
-void polyhedron_shape_initializer::init_new_shapes() {
+void polyhedron_shape_initializer::init_new_shapes(bool mt) {
     entity_vector_erase_invalid(m_new_polyhedron_shapes, *m_registry);
     entity_vector_erase_invalid(m_new_compound_shapes, *m_registry);
 
@@ -66,48 +71,91 @@ void polyhedron_shape_initializer::init_new_shapes() {
     auto polyhedron_view = m_registry->view<polyhedron_shape>();
     auto compound_view = m_registry->view<compound_shape>();
 
+    // Gather all polyhedrons first, then build their rotated meshes, which
+    // only reads the registry and thus can be done in parallel. The rotated
+    // meshes are assigned afterwards, in the current thread.
+    m_new_rotated_meshes.clear();
+
     for (auto entity : m_new_polyhedron_shapes) {
-        auto [polyhedron] = polyhedron_view.get(entity);
-        auto [orn] = orn_view.get(entity);
-        // A new `rotated_mesh` is assigned to it, replacing another reference
-        // that could be already in there, thus preventing concurrent access.
-        auto rotated = make_rotated_mesh(*polyhedron.mesh, orn);
-        auto rotated_ptr = std::make_unique<rotated_mesh>(std::move(rotated));
-        polyhedron.rotated = rotated_ptr.get();
-        m_registry->emplace_or_replace<rotated_mesh_list>(entity, polyhedron.mesh, std::move(rotated_ptr));
+        m_new_rotated_meshes.push_back({entity, 0, nullptr});
     }
 
     for (auto entity : m_new_compound_shapes) {
         auto [compound] = compound_view.get(entity);
-        auto [orn] = orn_view.get(entity);
-        auto prev_rotated_entity = entt::entity{entt::null};
-
-        for (auto &node : compound.nodes) {
-            if (!std::holds_alternative<polyhedron_shape>(node.shape_var)) continue;
-
-            // Assign a `rotated_mesh_list` to this entity for the first
-            // polyhedron and link it with more rotated meshes for the
-            // remaining polyhedrons.
-            auto &polyhedron = std::get<polyhedron_shape>(node.shape_var);
-            auto local_orn = orn * node.orientation;
-            auto rotated = make_rotated_mesh(*polyhedron.mesh, local_orn);
-            auto rotated_ptr = std::make_unique<rotated_mesh>(std::move(rotated));
-            polyhedron.rotated = rotated_ptr.get();
-
-            if (prev_rotated_entity == entt::null) {
-                m_registry->emplace_or_replace<rotated_mesh_list>(entity, polyhedron.mesh, std::move(rotated_ptr), node.orientation);
-                prev_rotated_entity = entity;
-            } else {
-                auto next = m_registry->create();
-                m_registry->emplace<rotated_mesh_list>(next, polyhedron.mesh, std::move(rotated_ptr), node.orientation);
 
-                auto &prev_rotated_list = m_registry->get<rotated_mesh_list>(prev_rotated_entity);
-                prev_rotated_list.next = next;
-                prev_rotated_entity = next;
+        for (size_t i = 0; i < compound.nodes.size(); ++i) {
+            if (std::holds_alternative<polyhedron_shape>(compound.nodes[i].shape_var)) {
+                m_new_rotated_meshes.push_back({entity, i, nullptr});
+            }
+        }
+    }
+
+    const auto num_polyhedrons = m_new_polyhedron_shapes.size();
+
+    auto build = [&](new_rotated_mesh *first, new_rotated_mesh *last, unsigned start) {
+        for (auto index = size_t(start); first != last; ++first, ++index) {
+            auto [orn] = orn_view.get(first->entity);
+
+            if (index < num_polyhedrons) {
+                auto [polyhedron] = polyhedron_view.get(first->entity);
+                first->rotated = std::make_unique<rotated_mesh>(make_rotated_mesh(*polyhedron.mesh, orn));
+            } else {
+                auto [compound] = compound_view.get(first->entity);
+                auto &node = compound.nodes[first->node_index];
+                auto &polyhedron = std::get<polyhedron_shape>(node.shape_var);
+                auto local_orn = orn * node.orientation;
+                first->rotated = std::make_unique<rotated_mesh>(make_rotated_mesh(*polyhedron.mesh, local_orn));
             }
         }
+    };
+
+    if (mt && m_new_rotated_meshes.size() > parallel_init_threshold) {
+        parallel_for_each_range(*m_registry, m_new_rotated_meshes, build);
+    } else {
+        build(m_new_rotated_meshes.data(), m_new_rotated_meshes.data() + m_new_rotated_meshes.size(), 0);
+    }
+
+    for (size_t i = 0; i < num_polyhedrons; ++i) {
+        auto &entry = m_new_rotated_meshes[i];
+        auto [polyhedron] = polyhedron_view.get(entry.entity);
+        // A new `rotated_mesh` is assigned to it, replacing another reference
+        // that could be already in there, thus preventing concurrent access.
+        polyhedron.rotated = entry.rotated.get();
+        m_registry->emplace_or_replace<rotated_mesh_list>(entry.entity, polyhedron.mesh, std::move(entry.rotated));
+    }
+
+    auto prev_rotated_entity = entt::entity{entt::null};
+
+    for (size_t i = num_polyhedrons; i < m_new_rotated_meshes.size(); ++i) {
+        auto &entry = m_new_rotated_meshes[i];
+        auto [compound] = compound_view.get(entry.entity);
+        auto &node = compound.nodes[entry.node_index];
+        auto &polyhedron = std::get<polyhedron_shape>(node.shape_var);
+        polyhedron.rotated = entry.rotated.get();
+
+        // Assign a `rotated_mesh_list` to this entity for the first
+        // polyhedron and link it with more rotated meshes for the
+        // remaining polyhedrons. The polyhedrons of a compound are in
+        // increasing node order, thus a compound which was added more than
+        // once starts over when the node index doesn't increase.
+        auto first_in_compound = i == num_polyhedrons ||
+            m_new_rotated_meshes[i - 1].entity != entry.entity ||
+            m_new_rotated_meshes[i - 1].node_index >= entry.node_index;
+
+        if (first_in_compound) {
+            m_registry->emplace_or_replace<rotated_mesh_list>(entry.entity, polyhedron.mesh, std::move(entry.rotated), node.orientation);
+            prev_rotated_entity = entry.entity;
+        } else {
+            auto next = m_registry->create();
+            m_registry->emplace<rotated_mesh_list>(next, polyhedron.mesh, std::move(entry.rotated), node.orientation);
+
+            auto &prev_rotated_list = m_registry->get<rotated_mesh_list>(prev_rotated_entity);
+            prev_rotated_list.next = next;
+            prev_rotated_entity = next;
+        }
     }
 
+    m_new_rotated_meshes.clear();
     m_new_polyhedron_shapes.clear();
     m_new_compound_shapes.clear();
 }
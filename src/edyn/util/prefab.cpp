@@ -0,0 +1,266 @@
+#include "edyn/util/prefab.hpp"
+#include "edyn/comp/angvel.hpp"
+#include "edyn/comp/collision_exclusion.hpp"
+#include "edyn/comp/collision_filter.hpp"
+#include "edyn/comp/gravity.hpp"
+#include "edyn/comp/inertia.hpp"
+#include "edyn/comp/linvel.hpp"
+#include "edyn/comp/mass.hpp"
+#include "edyn/comp/material.hpp"
+#include "edyn/comp/orientation.hpp"
+#include "edyn/comp/position.hpp"
+#include "edyn/comp/present_position.hpp"
+#include "edyn/comp/tag.hpp"
+#include "edyn/config/config.h"
+#include "edyn/math/transform.hpp"
+#include "edyn/shapes/shapes.hpp"
+#include "edyn/util/constraint_util.hpp"
+#include <entt/entity/registry.hpp>
+#include <algorithm>
+#include <unordered_map>
+
+namespace edyn {
+
+using prefab_index_map = std::unordered_map<entt::entity, unsigned>;
+
+static rigidbody_def make_prefab_body(const entt::registry &registry, entt::entity entity,
+                                      const vector3 &position, const quaternion &orientation) {
+    auto def = rigidbody_def{};
+
+    if (registry.all_of<dynamic_tag>(entity)) {
+        def.kind = rigidbody_kind::rb_dynamic;
+    } else if (registry.all_of<kinematic_tag>(entity)) {
+        def.kind = rigidbody_kind::rb_kinematic;
+    } else {
+        def.kind = rigidbody_kind::rb_static;
+    }
+
+    // Velocities are stored at the center of mass but assigned at the origin
+    // in the definition.
+    auto origin = get_rigidbody_origin(registry, entity);
+    auto &pos = registry.get<edyn::position>(entity);
+    auto &orn = registry.get<edyn::orientation>(entity);
+    auto &angvel = registry.get<edyn::angvel>(entity);
+    auto linvel = registry.get<edyn::linvel>(entity) - cross(angvel, pos - origin);
+
+    def.position = to_object_space(origin, position, orientation);
+    def.orientation = conjugate(orientation) * orn;
+    def.linvel = rotate(conjugate(orientation), linvel);
+    def.angvel = rotate(conjugate(orientation), angvel);
+
+    if (auto *com = registry.try_get<center_of_mass>(entity)) {
+        def.center_of_mass = *com;
+    }
+
+    if (def.kind == rigidbody_kind::rb_dynamic) {
+        def.mass = registry.get<mass>(entity);
+        def.inertia = registry.get<inertia>(entity);
+        auto *gravity = registry.try_get<edyn::gravity>(entity);
+        def.gravity = gravity ? static_cast<vector3>(*gravity) : vector3_zero;
+    }
+
+    std::apply([&](auto ... s) {
+        ([&]() {
+            using ShapeType = decltype(s);
+
+            if (auto *shape = registry.try_get<ShapeType>(entity)) {
+                def.shape = *shape;
+            }
+        }(), ...);
+    }, shapes_tuple);
+
+    if (auto *material = registry.try_get<edyn::material>(entity)) {
+        def.material = *material;
+    } else {
+        def.material.reset();
+    }
+
+    if (auto *filter = registry.try_get<collision_filter>(entity)) {
+        def.collision_group = filter->group;
+        def.collision_mask = filter->mask;
+    }
+
+    def.presentation = registry.all_of<present_position>(entity);
+    def.sleeping_disabled = registry.all_of<sleeping_disabled_tag>(entity);
+    def.ccd = registry.all_of<ccd_tag>(entity);
+    def.particle = registry.all_of<particle_tag>(entity);
+    def.sensor = registry.all_of<sensor_tag>(entity);
+    def.sensor_exact = !registry.all_of<sensor_aabb_tag>(entity);
+    def.networked = registry.all_of<networked_tag>(entity);
+
+    return def;
+}
+
+prefab make_prefab(const entt::registry &registry,
+                   const std::vector<entt::entity> &bodies,
+                   const std::vector<entt::entity> &constraints,
+                   const vector3 &position, const quaternion &orientation) {
+    auto pf = prefab{};
+    auto body_index_map = prefab_index_map{};
+
+    for (auto entity : bodies) {
+        EDYN_ASSERT(registry.all_of<rigidbody_tag>(entity));
+        body_index_map.emplace(entity, static_cast<unsigned>(pf.bodies.size()));
+        pf.bodies.push_back(make_prefab_body(registry, entity, position, orientation));
+    }
+
+    pf.num_constraint_entities = static_cast<unsigned>(constraints.size());
+
+    for (unsigned i = 0; i < constraints.size(); ++i) {
+        auto entity = constraints[i];
+
+        std::apply([&](auto &... arrays) {
+            ([&]() {
+                using Constraint = typename std::decay_t<decltype(arrays)>::value_type::constraint_type;
+
+                if (auto *con = registry.try_get<Constraint>(entity)) {
+                    EDYN_ASSERT(body_index_map.count(con->body[0]) && body_index_map.count(con->body[1]));
+                    auto &entry = arrays.emplace_back();
+                    entry.entity = i;
+                    entry.body = {body_index_map.at(con->body[0]), body_index_map.at(con->body[1])};
+                    entry.con = *con;
+                    entry.con.body = {entt::null, entt::null};
+                }
+            }(), ...);
+        }, pf.constraints);
+
+        if (registry.all_of<articulation_tag>(entity)) {
+            pf.articulated.push_back(i);
+        }
+
+        if (auto *breakable = registry.try_get<breakable_constraint>(entity)) {
+            pf.breakable.emplace_back(i, *breakable);
+        }
+    }
+
+    for (unsigned i = 0; i < bodies.size(); ++i) {
+        auto *exclusion = registry.try_get<collision_exclusion>(bodies[i]);
+
+        if (!exclusion) {
+            continue;
+        }
+
+        for (unsigned k = 0; k < exclusion->num_entities(); ++k) {
+            auto it = body_index_map.find(exclusion->entity[k]);
+
+            // Exclusions are symmetric thus each pair is added once.
+            if (it != body_index_map.end() && it->second > i) {
+                pf.collision_exclusions.push_back({i, it->second});
+            }
+        }
+    }
+
+    return pf;
+}
+
+prefab_instances instantiate_prefab(entt::registry &registry, const prefab &pf,
+                                    const std::vector<vector3> &positions,
+                                    const std::vector<quaternion> &orientations) {
+    EDYN_ASSERT(positions.size() == orientations.size());
+    const auto num_instances = positions.size();
+    const auto num_bodies = pf.bodies.size();
+    const auto num_constraints = pf.num_constraint_entities;
+
+    auto instances = prefab_instances{};
+    instances.bodies.resize(num_instances * num_bodies);
+    instances.constraints.resize(num_instances * num_constraints);
+    registry.create(instances.bodies.begin(), instances.bodies.end());
+    registry.create(instances.constraints.begin(), instances.constraints.end());
+
+    auto defs = std::vector<rigidbody_def>{};
+    defs.reserve(instances.bodies.size());
+
+    for (size_t i = 0; i < num_instances; ++i) {
+        auto &pos = positions[i];
+        auto &orn = orientations[i];
+
+        for (auto &body : pf.bodies) {
+            auto &def = defs.emplace_back(body);
+            def.position = to_world_space(body.position, pos, orn);
+            def.orientation = orn * body.orientation;
+            def.linvel = rotate(orn, body.linvel);
+            def.angvel = rotate(orn, body.angvel);
+        }
+    }
+
+    batch_make_rigidbodies(instances.bodies, registry, defs);
+
+    std::apply([&](auto &... arrays) {
+        ([&]() {
+            using Constraint = typename std::decay_t<decltype(arrays)>::value_type::constraint_type;
+
+            if (arrays.empty()) {
+                return;
+            }
+
+            registry.storage<Constraint>().reserve(registry.storage<Constraint>().size() +
+                                                   arrays.size() * num_instances);
+
+            for (size_t i = 0; i < num_instances; ++i) {
+                auto *bodies = instances.bodies.data() + i * num_bodies;
+                auto *constraints = instances.constraints.data() + i * num_constraints;
+
+                for (auto &entry : arrays) {
+                    auto entity = constraints[entry.entity];
+                    auto con = entry.con;
+                    con.body = {bodies[entry.body[0]], bodies[entry.body[1]]};
+                    internal::pre_make_constraint(registry, entity, con.body[0], con.body[1]);
+                    registry.emplace<Constraint>(entity, con);
+                }
+            }
+        }(), ...);
+    }, pf.constraints);
+
+    if (!pf.collision_exclusions.empty()) {
+        auto exclusions = std::vector<collision_exclusion>(num_bodies);
+        auto sizes = std::vector<collision_exclusion::size_type>(num_bodies);
+
+        for (size_t i = 0; i < num_instances; ++i) {
+            auto *bodies = instances.bodies.data() + i * num_bodies;
+
+            std::fill(exclusions.begin(), exclusions.end(), collision_exclusion{});
+            std::fill(sizes.begin(), sizes.end(), 0);
+
+            for (auto [first, second] : pf.collision_exclusions) {
+                EDYN_ASSERT(sizes[first] < collision_exclusion::max_exclusions);
+                EDYN_ASSERT(sizes[second] < collision_exclusion::max_exclusions);
+                exclusions[first].entity[sizes[first]++] = bodies[second];
+                exclusions[second].entity[sizes[second]++] = bodies[first];
+            }
+
+            for (size_t j = 0; j < num_bodies; ++j) {
+                if (sizes[j] > 0) {
+                    registry.emplace<collision_exclusion>(bodies[j], exclusions[j]);
+                }
+            }
+        }
+    }
+
+    if (!pf.articulated.empty()) {
+        auto articulated = std::vector<entt::entity>{};
+        articulated.reserve(pf.articulated.size() * num_instances);
+
+        for (size_t i = 0; i < num_instances; ++i) {
+            for (auto index : pf.articulated) {
+                articulated.push_back(instances.constraints[i * num_constraints + index]);
+            }
+        }
+
+        registry.insert<articulation_tag>(articulated.begin(), articulated.end());
+    }
+
+    if (!pf.breakable.empty()) {
+        registry.storage<breakable_constraint>().reserve(registry.storage<breakable_constraint>().size() +
+                                                         pf.breakable.size() * num_instances);
+
+        for (size_t i = 0; i < num_instances; ++i) {
+            for (auto &[index, breakable] : pf.breakable) {
+                registry.emplace<breakable_constraint>(instances.constraints[i * num_constraints + index], breakable);
+            }
+        }
+    }
+
+    return instances;
+}
+
+}
@@ -0,0 +1,148 @@
+#include "edyn/util/profiling.hpp"
+
+#if defined(EDYN_ENABLE_PROFILING) && !defined(EDYN_PROFILING_TRACY)
+
+#include "edyn/time/time.hpp"
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace edyn {
+
+namespace {
+
+struct trace_event {
+    const char *name;
+    double start;
+    double duration;
+};
+
+// Events of a single thread. Only the owner thread appends events, while the
+// buffer is locked by the thread that writes the capture.
+struct thread_trace_buffer {
+    std::mutex mutex;
+    std::vector<trace_event> events;
+    const char *name {nullptr};
+    unsigned id;
+};
+
+struct trace_context {
+    std::atomic<bool> capturing {false};
+    double capture_start {};
+    std::mutex mutex;
+    // Buffers are kept alive after their thread exits so the events can still
+    // be written.
+    std::vector<std::unique_ptr<thread_trace_buffer>> buffers;
+};
+
+trace_context & get_trace_context() {
+    static trace_context ctx;
+    return ctx;
+}
+
+thread_trace_buffer & get_thread_buffer() {
+    static thread_local thread_trace_buffer *buffer = nullptr;
+
+    if (!buffer) {
+        auto &ctx = get_trace_context();
+        auto lock = std::lock_guard(ctx.mutex);
+        auto &ptr = ctx.buffers.emplace_back(std::make_unique<thread_trace_buffer>());
+        ptr->id = static_cast<unsigned>(ctx.buffers.size());
+        buffer = ptr.get();
+    }
+
+    return *buffer;
+}
+
+}
+
+trace_zone::trace_zone(const char *name)
+    : m_name(name)
+    , m_start(get_trace_context().capturing.load(std::memory_order_relaxed) ? performance_time() : -1)
+{}
+
+trace_zone::~trace_zone() {
+    if (m_start < 0 || !get_trace_context().capturing.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    auto duration = performance_time() - m_start;
+    auto &buffer = get_thread_buffer();
+    auto lock = std::lock_guard(buffer.mutex);
+    buffer.events.push_back({m_name, m_start, duration});
+}
+
+void set_trace_thread_name(const char *name) {
+    auto &buffer = get_thread_buffer();
+    auto lock = std::lock_guard(buffer.mutex);
+    buffer.name = name;
+}
+
+void begin_trace_capture() {
+    auto &ctx = get_trace_context();
+    auto lock = std::lock_guard(ctx.mutex);
+
+    for (auto &buffer : ctx.buffers) {
+        auto buffer_lock = std::lock_guard(buffer->mutex);
+        buffer->events.clear();
+    }
+
+    ctx.capture_start = performance_time();
+    ctx.capturing.store(true, std::memory_order_relaxed);
+}
+
+bool end_trace_capture(const std::string &path) {
+    auto &ctx = get_trace_context();
+    ctx.capturing.store(false, std::memory_order_relaxed);
+
+    auto *file = std::fopen(path.c_str(), "w");
+
+    if (!file) {
+        return false;
+    }
+
+    auto lock = std::lock_guard(ctx.mutex);
+    auto first = true;
+    std::fprintf(file, "{\"traceEvents\":[");
+
+    for (auto &buffer : ctx.buffers) {
+        auto buffer_lock = std::lock_guard(buffer->mutex);
+
+        if (buffer->name) {
+            std::fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                         first ? "" : ",", buffer->id, buffer->name);
+            first = false;
+        }
+
+        for (auto &event : buffer->events) {
+            // Timestamps are in microseconds.
+            std::fprintf(file, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                         first ? "" : ",", event.name, buffer->id,
+                         (event.start - ctx.capture_start) * 1e6, event.duration * 1e6);
+            first = false;
+        }
+
+        buffer->events.clear();
+    }
+
+    std::fprintf(file, "\n]}\n");
+    return std::fclose(file) == 0;
+}
+
+}
+
+#else
+
+namespace edyn {
+
+void begin_trace_capture() {}
+
+bool end_trace_capture(const std::string &) {
+    return false;
+}
+
+}
+
+#endif
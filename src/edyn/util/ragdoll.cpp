@@ -1,5 +1,6 @@
 #include "edyn/util/ragdoll.hpp"
 #include "edyn/comp/orientation.hpp"
+#include "edyn/comp/tag.hpp"
 #include "edyn/constraints/cone_constraint.hpp"
 #include "edyn/constraints/cvjoint_constraint.hpp"
 #include "edyn/constraints/hinge_constraint.hpp"
@@ -7,6 +8,7 @@
 #include "edyn/math/matrix3x3.hpp"
 #include "edyn/math/transform.hpp"
 #include "edyn/shapes/cylinder_shape.hpp"
+#include "edyn/shapes/shapes.hpp"
 #include "edyn/util/constraint_util.hpp"
 #include "edyn/dynamics/moment_of_inertia.hpp"
 #include "edyn/util/rigidbody.hpp"
@@ -14,6 +16,67 @@
 
 namespace edyn {
 
+// Assigns a capsule or cylinder to a ragdoll body. These shapes might have
+// been left out of the build, in which case the ragdoll can only use boxes.
+template<typename ShapeType>
+static void set_shape(rigidbody_def &def, const ShapeType &shape) {
+    if constexpr(is_shape_enabled_v<ShapeType>) {
+        def.shape = shape;
+    } else {
+        EDYN_ASSERT(false, "Ragdoll shape type is disabled in this build.");
+    }
+}
+
+// Members of `ragdoll_entities` in the order they're stored in a prefab.
+static const auto ragdoll_body_members = std::array{
+    &ragdoll_entities::head,
+    &ragdoll_entities::neck,
+    &ragdoll_entities::torso_upper,
+    &ragdoll_entities::torso_middle,
+    &ragdoll_entities::torso_lower,
+    &ragdoll_entities::hip,
+    &ragdoll_entities::leg_upper_left,
+    &ragdoll_entities::leg_upper_right,
+    &ragdoll_entities::leg_lower_left,
+    &ragdoll_entities::leg_lower_right,
+    &ragdoll_entities::foot_left,
+    &ragdoll_entities::foot_right,
+    &ragdoll_entities::shoulder_left,
+    &ragdoll_entities::shoulder_right,
+    &ragdoll_entities::arm_upper_left,
+    &ragdoll_entities::arm_upper_right,
+    &ragdoll_entities::arm_lower_left,
+    &ragdoll_entities::arm_lower_right,
+    &ragdoll_entities::arm_twist_left,
+    &ragdoll_entities::arm_twist_right,
+    &ragdoll_entities::hand_left,
+    &ragdoll_entities::hand_right
+};
+
+static const auto ragdoll_constraint_members = std::array{
+    &ragdoll_entities::hip_torso_lower_constraint,
+    &ragdoll_entities::torso_lower_torso_middle_constraint,
+    &ragdoll_entities::torso_middle_torso_upper_constraint,
+    &ragdoll_entities::torso_upper_neck_constraint,
+    &ragdoll_entities::neck_head_constraint,
+    &ragdoll_entities::hip_upper_leg_left_constraint,
+    &ragdoll_entities::hip_upper_leg_right_constraint,
+    &ragdoll_entities::knee_left_hinge,
+    &ragdoll_entities::knee_right_hinge,
+    &ragdoll_entities::ankle_left_constraint,
+    &ragdoll_entities::ankle_right_constraint,
+    &ragdoll_entities::torso_upper_shoulder_left_constraint,
+    &ragdoll_entities::torso_upper_shoulder_right_constraint,
+    &ragdoll_entities::shoulder_arm_upper_left_constraint,
+    &ragdoll_entities::shoulder_arm_upper_right_constraint,
+    &ragdoll_entities::elbow_left_hinge,
+    &ragdoll_entities::elbow_right_hinge,
+    &ragdoll_entities::arm_twist_left_hinge,
+    &ragdoll_entities::arm_twist_right_hinge,
+    &ragdoll_entities::wrist_left_constraint,
+    &ragdoll_entities::wrist_right_constraint
+};
+
 ragdoll_def make_ragdoll_def_from_simple(const ragdoll_simple_def &simple_def) {
     auto rag_def = ragdoll_def{};
 
@@ -58,6 +121,7 @@ ragdoll_def make_ragdoll_def_from_simple(const ragdoll_simple_def &simple_def) {
     rag_def.hand_size         = scale * 2 * vector3{0.065, 0.045, 0.045};
 
     rag_def.shape_type = simple_def.shape_type;
+    rag_def.articulated = simple_def.articulated;
 
     return rag_def;
 }
@@ -89,10 +153,10 @@ ragdoll_entities make_ragdoll(entt::registry &registry, const ragdoll_def &rag_d
             def.shape = box_shape{rag_def.head_size / 2};
             break;
         case ragdoll_shape_type::capsule:
-            def.shape = capsule_shape{rag_def.head_size.x / 2, (rag_def.head_size.y - rag_def.head_size.x) / 2, coordinate_axis::y};
+            set_shape(def, capsule_shape{rag_def.head_size.x / 2, (rag_def.head_size.y - rag_def.head_size.x) / 2, coordinate_axis::y});
             break;
         case ragdoll_shape_type::cylinder:
-            def.shape = cylinder_shape{rag_def.head_size.x / 2, rag_def.head_size.y / 2, coordinate_axis::y};
+            set_shape(def, cylinder_shape{rag_def.head_size.x / 2, rag_def.head_size.y / 2, coordinate_axis::y});
             break;
         }
 
@@ -118,10 +182,10 @@ ragdoll_entities make_ragdoll(entt::registry &registry, const ragdoll_def &rag_d
             def.shape = box_shape{rag_def.neck_size / 2};
             break;
         case ragdoll_shape_type::capsule:
-            def.shape = capsule_shape{rag_def.neck_size.x / 2, (rag_def.neck_size.y - rag_def.neck_size.x) / 2, coordinate_axis::y};
+            set_shape(def, capsule_shape{rag_def.neck_size.x / 2, (rag_def.neck_size.y - rag_def.neck_size.x) / 2, coordinate_axis::y});
             break;
         case ragdoll_shape_type::cylinder:
-            def.shape = cylinder_shape{rag_def.neck_size.x / 2, rag_def.neck_size.y / 2, coordinate_axis::y};
+            set_shape(def, cylinder_shape{rag_def.neck_size.x / 2, rag_def.neck_size.y / 2, coordinate_axis::y});
             break;
         }
 
@@ -146,10 +210,10 @@ ragdoll_entities make_ragdoll(entt::registry &registry, const ragdoll_def &rag_d
             def.shape = box_shape{rag_def.torso_upper_size / 2};
             break;
         case ragdoll_shape_type::capsule:
-            def.shape = capsule_shape{rag_def.torso_upper_size.y / 2, (rag_def.torso_upper_size.x - rag_def.torso_upper_size.y) / 2, coordinate_axis::x};
+            set_shape(def, capsule_shape{rag_def.torso_upper_size.y / 2, (rag_def.torso_upper_size.x - rag_def.torso_upper_size.y) / 2, coordinate_axis::x});
             break;
         case ragdoll_shape_type::cylinder:
-            def.shape = cylinder_shape{rag_def.torso_upper_size.y / 2, rag_def.torso_upper_size.x / 2, coordinate_axis::x};
+            set_shape(def, cylinder_shape{rag_def.torso_upper_size.y / 2, rag_def.torso_upper_size.x / 2, coordinate_axis::x});
             break;
         }
 
@@ -173,10 +237,10 @@ ragdoll_entities make_ragdoll(entt::registry &registry, const ragdoll_def &rag_d
             def.shape = box_shape{rag_def.torso_middle_size / 2};
             break;
         case ragdoll_shape_type::capsule:
-            def.shape = capsule_shape{rag_def.torso_middle_size.y / 2, (rag_def.torso_middle_size.x - rag_def.torso_middle_size.y) / 2, coordinate_axis::x};
+            set_shape(def, capsule_shape{rag_def.torso_middle_size.y / 2, (rag_def.torso_middle_size.x - rag_def.torso_middle_size.y) / 2, coordinate_axis::x});
             break;
         case ragdoll_shape_type::cylinder:
-            def.shape = cylinder_shape{rag_def.torso_middle_size.y / 2, rag_def.torso_middle_size.x / 2, coordinate_axis::x};
+            set_shape(def, cylinder_shape{rag_def.torso_middle_size.y / 2, rag_def.torso_middle_size.x / 2, coordinate_axis::x});
             break;
         }
 
@@ -199,10 +263,10 @@ ragdoll_entities make_ragdoll(entt::registry &registry, const ragdoll_def &rag_d
             def.shape = box_shape{rag_def.torso_lower_size / 2};
             break;
         case ragdoll_shape_type::capsule:
-            def.shape = capsule_shape{rag_def.torso_lower_size.y / 2, (rag_def.torso_lower_size.x - rag_def.torso_lower_size.y) / 2, coordinate_axis::x};
+            set_shape(def, capsule_shape{rag_def.torso_lower_size.y / 2, (rag_def.torso_lower_size.x - rag_def.torso_lower_size.y) / 2, coordinate_axis::x});
             break;
         case ragdoll_shape_type::cylinder:
-            def.shape = cylinder_shape{rag_def.torso_lower_size.y / 2, rag_def.torso_lower_size.x / 2, coordinate_axis::x};
+            set_shape(def, cylinder_shape{rag_def.torso_lower_size.y / 2, rag_def.torso_lower_size.x / 2, coordinate_axis::x});
             break;
         }
 
@@ -222,10 +286,10 @@ ragdoll_entities make_ragdoll(entt::registry &registry, const ragdoll_def &rag_d
             def.shape = box_shape{rag_def.hip_size / 2};
             break;
         case ragdoll_shape_type::capsule:
-            def.shape = capsule_shape{rag_def.hip_size.y / 2, (rag_def.hip_size.x - rag_def.hip_size.y) / 2, coordinate_axis::x};
+            set_shape(def, capsule_shape{rag_def.hip_size.y / 2, (rag_def.hip_size.x - rag_def.hip_size.y) / 2, coordinate_axis::x});
             break;
         case ragdoll_shape_type::cylinder:
-            def.shape = cylinder_shape{rag_def.hip_size.y / 2, rag_def.hip_size.x / 2, coordinate_axis::x};
+            set_shape(def, cylinder_shape{rag_def.hip_size.y / 2, rag_def.hip_size.x / 2, coordinate_axis::x});
             break;
         }
 
@@ -251,10 +315,10 @@ ragdoll_entities make_ragdoll(entt::registry &registry, const ragdoll_def &rag_d
             def.shape = box_shape{rag_def.leg_upper_size / 2};
             break;
         case ragdoll_shape_type::capsule:
-            def.shape = capsule_shape{rag_def.leg_upper_size.x / 2, (rag_def.leg_upper_size.y - rag_def.leg_upper_size.x) / 2, coordinate_axis::y};
+            set_shape(def, capsule_shape{rag_def.leg_upper_size.x / 2, (rag_def.leg_upper_size.y - rag_def.leg_upper_size.x) / 2, coordinate_axis::y});
             break;
         case ragdoll_shape_type::cylinder:
-            def.shape = cylinder_shape{rag_def.leg_upper_size.x / 2, rag_def.leg_upper_size.y / 2, coordinate_axis::y};
+            set_shape(def, cylinder_shape{rag_def.leg_upper_size.x / 2, rag_def.leg_upper_size.y / 2, coordinate_axis::y});
             break;
         }
 
@@ -278,10 +342,10 @@ ragdoll_entities make_ragdoll(entt::registry &registry, const ragdoll_def &rag_d
             def.shape = box_shape{rag_def.leg_lower_size / 2};
             break;
         case ragdoll_shape_type::capsule:
-            def.shape = capsule_shape{rag_def.leg_lower_size.x / 2, (rag_def.leg_lower_size.y - rag_def.leg_lower_size.x) / 2, coordinate_axis::y};
+            set_shape(def, capsule_shape{rag_def.leg_lower_size.x / 2, (rag_def.leg_lower_size.y - rag_def.leg_lower_size.x) / 2, coordinate_axis::y});
             break;
         case ragdoll_shape_type::cylinder:
-            def.shape = cylinder_shape{rag_def.leg_lower_size.x / 2, rag_def.leg_lower_size.y / 2, coordinate_axis::y};
+            set_shape(def, cylinder_shape{rag_def.leg_lower_size.x / 2, rag_def.leg_lower_size.y / 2, coordinate_axis::y});
             break;
         }
 
@@ -307,10 +371,10 @@ ragdoll_entities make_ragdoll(entt::registry &registry, const ragdoll_def &rag_d
             def.shape = box_shape{rag_def.foot_size / 2};
             break;
         case ragdoll_shape_type::capsule:
-            def.shape = capsule_shape{rag_def.foot_size.x / 2, (rag_def.foot_size.z - rag_def.foot_size.x) / 2, coordinate_axis::z};
+            set_shape(def, capsule_shape{rag_def.foot_size.x / 2, (rag_def.foot_size.z - rag_def.foot_size.x) / 2, coordinate_axis::z});
             break;
         case ragdoll_shape_type::cylinder:
-            def.shape = cylinder_shape{rag_def.foot_size.x / 2, rag_def.foot_size.z / 2, coordinate_axis::z};
+            set_shape(def, cylinder_shape{rag_def.foot_size.x / 2, rag_def.foot_size.z / 2, coordinate_axis::z});
             break;
         }
 
@@ -364,10 +428,10 @@ ragdoll_entities make_ragdoll(entt::registry &registry, const ragdoll_def &rag_d
             def.shape = box_shape{rag_def.arm_upper_size / 2};
             break;
         case ragdoll_shape_type::capsule:
-            def.shape = capsule_shape{rag_def.arm_upper_size.y / 2, (rag_def.arm_upper_size.x - rag_def.arm_upper_size.y) / 2, coordinate_axis::x};
+            set_shape(def, capsule_shape{rag_def.arm_upper_size.y / 2, (rag_def.arm_upper_size.x - rag_def.arm_upper_size.y) / 2, coordinate_axis::x});
             break;
         case ragdoll_shape_type::cylinder:
-            def.shape = cylinder_shape{rag_def.arm_upper_size.y / 2, rag_def.arm_upper_size.x / 2, coordinate_axis::x};
+            set_shape(def, cylinder_shape{rag_def.arm_upper_size.y / 2, rag_def.arm_upper_size.x / 2, coordinate_axis::x});
             break;
         }
 
@@ -394,10 +458,10 @@ ragdoll_entities make_ragdoll(entt::registry &registry, const ragdoll_def &rag_d
             def.shape = box_shape{rag_def.arm_lower_size / 2};
             break;
         case ragdoll_shape_type::capsule:
-            def.shape = capsule_shape{rag_def.arm_lower_size.y / 2, (rag_def.arm_lower_size.x - rag_def.arm_lower_size.y) / 2, coordinate_axis::x};
+            set_shape(def, capsule_shape{rag_def.arm_lower_size.y / 2, (rag_def.arm_lower_size.x - rag_def.arm_lower_size.y) / 2, coordinate_axis::x});
             break;
         case ragdoll_shape_type::cylinder:
-            def.shape = cylinder_shape{rag_def.arm_lower_size.y / 2, rag_def.arm_lower_size.x / 2, coordinate_axis::x};
+            set_shape(def, cylinder_shape{rag_def.arm_lower_size.y / 2, rag_def.arm_lower_size.x / 2, coordinate_axis::x});
             break;
         }
 
@@ -432,10 +496,10 @@ ragdoll_entities make_ragdoll(entt::registry &registry, const ragdoll_def &rag_d
             def.shape = box_shape{rag_def.hand_size / 2};
             break;
         case ragdoll_shape_type::capsule:
-            def.shape = capsule_shape{rag_def.hand_size.y / 2, (rag_def.hand_size.x - rag_def.hand_size.y) / 2, coordinate_axis::x};
+            set_shape(def, capsule_shape{rag_def.hand_size.y / 2, (rag_def.hand_size.x - rag_def.hand_size.y) / 2, coordinate_axis::x});
             break;
         case ragdoll_shape_type::cylinder:
-            def.shape = cylinder_shape{rag_def.hand_size.y / 2, rag_def.hand_size.x / 2, coordinate_axis::x};
+            set_shape(def, cylinder_shape{rag_def.hand_size.y / 2, rag_def.hand_size.x / 2, coordinate_axis::x});
             break;
         }
 
@@ -929,6 +993,46 @@ ragdoll_entities make_ragdoll(entt::registry &registry, const ragdoll_def &rag_d
         *std::array{&entities.wrist_left_constraint, &entities.wrist_right_constraint}[i] = con_entity;
     }
 
+    if (rag_def.articulated) {
+        for (auto member : ragdoll_constraint_members) {
+            registry.emplace<articulation_tag>(entities.*member);
+        }
+    }
+
+    return entities;
+}
+
+
+prefab make_ragdoll_prefab(const entt::registry &registry, const ragdoll_entities &entities) {
+    auto bodies = std::vector<entt::entity>{};
+    auto constraints = std::vector<entt::entity>{};
+
+    for (auto member : ragdoll_body_members) {
+        bodies.push_back(entities.*member);
+    }
+
+    for (auto member : ragdoll_constraint_members) {
+        constraints.push_back(entities.*member);
+    }
+
+    return make_prefab(registry, bodies, constraints,
+                       get_rigidbody_origin(registry, entities.hip),
+                       registry.get<orientation>(entities.hip));
+}
+
+ragdoll_entities get_ragdoll_instance(const prefab_instances &instances, size_t index) {
+    auto entities = ragdoll_entities{};
+    auto *bodies = instances.bodies.data() + index * ragdoll_body_members.size();
+    auto *constraints = instances.constraints.data() + index * ragdoll_constraint_members.size();
+
+    for (size_t i = 0; i < ragdoll_body_members.size(); ++i) {
+        entities.*ragdoll_body_members[i] = bodies[i];
+    }
+
+    for (size_t i = 0; i < ragdoll_constraint_members.size(); ++i) {
+        entities.*ragdoll_constraint_members[i] = constraints[i];
+    }
+
     return entities;
 }
 
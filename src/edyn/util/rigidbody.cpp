@@ -13,9 +13,11 @@
 #include "edyn/math/transform.hpp"
 #include "edyn/math/vector3.hpp"
 #include "edyn/shapes/shapes.hpp"
+#include "edyn/shapes/shape_asset_cache.hpp"
 #include "edyn/simulation/island_manager.hpp"
 #include "edyn/simulation/stepper_sequential.hpp"
 #include "edyn/util/constraint_util.hpp"
+#include "edyn/util/entt_util.hpp"
 #include "edyn/util/island_util.hpp"
 #include "edyn/util/rigidbody.hpp"
 #include "edyn/comp/tag.hpp"
@@ -40,15 +42,20 @@
 
 namespace edyn {
 
-void make_rigidbody(entt::entity entity, entt::registry &registry, const rigidbody_def &def) {
-    registry.emplace<position>(entity, def.position);
-    registry.emplace<orientation>(entity, def.orientation);
-
+static void emplace_mass_and_inertia(entt::registry &registry, entt::entity entity, const rigidbody_def &def) {
     if (def.kind == rigidbody_kind::rb_dynamic) {
         EDYN_ASSERT(def.mass > EDYN_EPSILON && def.mass < large_scalar, "Dynamic rigid body must have non-zero mass.");
         registry.emplace<mass>(entity, def.mass);
         registry.emplace<mass_inv>(entity, scalar(1) / def.mass);
 
+        if (def.particle) {
+            // Particles never rotate since their inverse inertia is zero.
+            registry.emplace<edyn::inertia>(entity, matrix3x3_zero);
+            registry.emplace<inertia_inv>(entity, matrix3x3_zero);
+            registry.emplace<inertia_world_inv>(entity, matrix3x3_zero);
+            return;
+        }
+
         matrix3x3 inertia;
 
         if (def.inertia) {
@@ -78,107 +85,205 @@ void make_rigidbody(entt::entity entity, entt::registry &registry, const rigidbo
         registry.emplace<inertia_inv>(entity, matrix3x3_zero);
         registry.emplace<inertia_world_inv>(entity, matrix3x3_zero);
     }
+}
 
-    if (def.kind == rigidbody_kind::rb_static) {
-        registry.emplace<linvel>(entity, vector3_zero);
-        registry.emplace<angvel>(entity, vector3_zero);
-    } else {
-        registry.emplace<linvel>(entity, def.linvel);
-        registry.emplace<angvel>(entity, def.angvel);
+// Replaces the meshes of a shape by identical meshes that are already in use,
+// so that rigid bodies created with copies of the same mesh share one instance.
+template<typename ShapeType>
+static void share_shape_meshes(ShapeType &shape) {
+    auto &cache = shape_asset_cache::global();
+
+    if constexpr(std::is_same_v<ShapeType, polyhedron_shape>) {
+        shape.mesh = cache.share(shape.mesh);
+    } else if constexpr(std::is_same_v<ShapeType, compound_shape>) {
+        for (auto &node : shape.nodes) {
+            if (auto *poly = std::get_if<polyhedron_shape>(&node.shape_var)) {
+                poly->mesh = cache.share(poly->mesh);
+            }
+        }
+    } else if constexpr(std::is_same_v<ShapeType, mesh_shape>) {
+        shape.trimesh = cache.share(shape.trimesh);
     }
+}
+
+static void emplace_shape(entt::registry &registry, entt::entity entity, const rigidbody_def &def) {
+    std::visit([&](auto &&def_shape) {
+        using ShapeType = std::decay_t<decltype(def_shape)>;
+        auto shape = def_shape;
+        share_shape_meshes(shape);
+
+        // Ensure shape is valid for this type of rigid body.
+        if (def.kind != rigidbody_kind::rb_static) {
+            EDYN_ASSERT((!tuple_has_type<ShapeType, static_shapes_tuple_t>::value),
+                        "Shapes of this type can only be used with static rigid bodies.");
+        }
 
-    if (def.center_of_mass) {
-        internal::apply_center_of_mass(registry, entity, *def.center_of_mass);
+        registry.emplace<ShapeType>(entity, std::move(shape));
+        registry.emplace<shape_index>(entity, get_shape_index<ShapeType>());
+        auto aabb = shape_aabb(def_shape, def.position, def.orientation);
+        registry.emplace<AABB>(entity, aabb);
+
+        // Assign tag for rolling shapes. Particles don't need it since they
+        // don't rotate.
+        if (def.kind == rigidbody_kind::rb_dynamic && !def.particle) {
+            if constexpr(tuple_has_type<ShapeType, rolling_shapes_tuple_t>::value) {
+                registry.emplace<rolling_tag>(entity);
+
+                auto roll_dir = shape_rolling_direction(def_shape);
+
+                if (roll_dir != vector3_zero) {
+                    registry.emplace<roll_direction>(entity, roll_dir);
+                }
+            }
+        }
+    }, *def.shape);
+
+    if (def.collision_group != collision_filter::all_groups ||
+        def.collision_mask != collision_filter::all_groups)
+    {
+        registry.emplace<collision_filter>(entity, def.collision_group, def.collision_mask);
     }
+}
 
-    auto gravity = def.gravity ? *def.gravity : get_gravity(registry);
+// Assigns the rigid body components to all entities. Each group of components
+// is assigned to all entities before moving on to the next, in the same
+// order as they'd be assigned to a single entity, thus `rigidbody_tag` is
+// still assigned last to signal the completion of the construction.
+static void make_rigidbodies(entt::registry &registry, const entt::entity *entities,
+                             const rigidbody_def *defs, size_t count) {
+    if (count > 1) {
+        // Only reserve for batches, since reserving for a single entity would
+        // defeat the geometric growth of the storage in repeated calls.
+        reserve_storage<position, orientation, linvel, angvel,
+                        mass, mass_inv, inertia, inertia_inv, inertia_world_inv,
+                        material, AABB, shape_index,
+                        graph_node, rigidbody_tag>(registry, count);
+    }
 
-    if (gravity != vector3_zero && def.kind == rigidbody_kind::rb_dynamic) {
-        registry.emplace<edyn::gravity>(entity, gravity);
+    for (size_t i = 0; i < count; ++i) {
+        registry.emplace<position>(entities[i], defs[i].position);
+        registry.emplace<orientation>(entities[i], defs[i].orientation);
     }
 
-    if (def.material) {
-        registry.emplace<material>(entity, *def.material);
+    for (size_t i = 0; i < count; ++i) {
+        emplace_mass_and_inertia(registry, entities[i], defs[i]);
     }
 
-    if (def.presentation && def.kind == rigidbody_kind::rb_dynamic) {
-        registry.emplace<present_position>(entity, def.position);
-        registry.emplace<present_orientation>(entity, def.orientation);
+    for (size_t i = 0; i < count; ++i) {
+        auto &def = defs[i];
+
+        if (def.kind == rigidbody_kind::rb_static) {
+            registry.emplace<linvel>(entities[i], vector3_zero);
+            registry.emplace<angvel>(entities[i], vector3_zero);
+        } else {
+            registry.emplace<linvel>(entities[i], def.linvel);
+            registry.emplace<angvel>(entities[i], def.particle ? vector3_zero : def.angvel);
+        }
     }
 
-    if (def.shape) {
-        std::visit([&](auto &&shape) {
-            using ShapeType = std::decay_t<decltype(shape)>;
+    const auto default_gravity = get_gravity(registry);
 
-            // Ensure shape is valid for this type of rigid body.
-            if (def.kind != rigidbody_kind::rb_static) {
-                EDYN_ASSERT((!tuple_has_type<ShapeType, static_shapes_tuple_t>::value),
-                            "Shapes of this type can only be used with static rigid bodies.");
-            }
+    for (size_t i = 0; i < count; ++i) {
+        auto entity = entities[i];
+        auto &def = defs[i];
 
-            registry.emplace<ShapeType>(entity, shape);
-            registry.emplace<shape_index>(entity, get_shape_index<ShapeType>());
-            auto aabb = shape_aabb(shape, def.position, def.orientation);
-            registry.emplace<AABB>(entity, aabb);
+        if (def.center_of_mass) {
+            internal::apply_center_of_mass(registry, entity, *def.center_of_mass);
+        }
 
-            // Assign tag for rolling shapes.
-            if (def.kind == rigidbody_kind::rb_dynamic) {
-                if constexpr(tuple_has_type<ShapeType, rolling_shapes_tuple_t>::value) {
-                    registry.emplace<rolling_tag>(entity);
+        auto gravity = def.gravity ? *def.gravity : default_gravity;
 
-                    auto roll_dir = shape_rolling_direction(shape);
+        if (gravity != vector3_zero && def.kind == rigidbody_kind::rb_dynamic) {
+            registry.emplace<edyn::gravity>(entity, gravity);
+        }
 
-                    if (roll_dir != vector3_zero) {
-                        registry.emplace<roll_direction>(entity, roll_dir);
-                    }
-                }
-            }
-        }, *def.shape);
-
-        if (def.collision_group != collision_filter::all_groups ||
-            def.collision_mask != collision_filter::all_groups)
-        {
-            auto &filter = registry.emplace<collision_filter>(entity);
-            filter.group = def.collision_group;
-            filter.mask = def.collision_mask;
+        if (def.material) {
+            registry.emplace<material>(entity, *def.material);
+        }
+
+        if (def.presentation && def.kind == rigidbody_kind::rb_dynamic) {
+            registry.emplace<present_position>(entity, def.position);
+            registry.emplace<present_orientation>(entity, def.orientation);
         }
     }
 
-    switch (def.kind) {
-    case rigidbody_kind::rb_dynamic:
-        registry.emplace<dynamic_tag>(entity);
-        registry.emplace<procedural_tag>(entity);
-        break;
-    case rigidbody_kind::rb_kinematic:
-        registry.emplace<kinematic_tag>(entity);
-        break;
-    case rigidbody_kind::rb_static:
-        registry.emplace<static_tag>(entity);
-        break;
+    for (size_t i = 0; i < count; ++i) {
+        if (defs[i].shape) {
+            emplace_shape(registry, entities[i], defs[i]);
+        }
     }
 
-    if (def.sleeping_disabled) {
-        registry.emplace<sleeping_disabled_tag>(entity);
+    for (size_t i = 0; i < count; ++i) {
+        auto entity = entities[i];
+        auto &def = defs[i];
+
+        switch (def.kind) {
+        case rigidbody_kind::rb_dynamic:
+            registry.emplace<dynamic_tag>(entity);
+            registry.emplace<procedural_tag>(entity);
+            break;
+        case rigidbody_kind::rb_kinematic:
+            registry.emplace<kinematic_tag>(entity);
+            break;
+        case rigidbody_kind::rb_static:
+            registry.emplace<static_tag>(entity);
+            break;
+        }
+
+        if (def.sleeping_disabled) {
+            registry.emplace<sleeping_disabled_tag>(entity);
+        }
+
+        if (def.ccd && def.kind == rigidbody_kind::rb_dynamic) {
+            registry.emplace<ccd_tag>(entity);
+        }
+
+        if (def.particle) {
+            EDYN_ASSERT(def.kind == rigidbody_kind::rb_dynamic, "A particle must be dynamic.");
+            EDYN_ASSERT(def.shape && std::holds_alternative<sphere_shape>(*def.shape), "A particle must be a sphere.");
+            EDYN_ASSERT(!def.center_of_mass || *def.center_of_mass == vector3_zero, "A particle can't have a center of mass offset.");
+            registry.emplace<particle_tag>(entity);
+        }
+
+        if (def.networked) {
+            registry.emplace<networked_tag>(entity);
+        }
+
+        if (def.sensor) {
+            registry.emplace<sensor_tag>(entity);
+
+            if (!def.sensor_exact) {
+                registry.emplace<sensor_aabb_tag>(entity);
+            }
+        }
     }
 
-    if (def.networked) {
-        registry.emplace<networked_tag>(entity);
+    // Insert rigid bodies as nodes in the entity graph.
+    auto &graph = registry.ctx().get<entity_graph>();
+
+    for (size_t i = 0; i < count; ++i) {
+        auto non_connecting = defs[i].kind != rigidbody_kind::rb_dynamic;
+        auto node_index = graph.insert_node(entities[i], non_connecting);
+        registry.emplace<graph_node>(entities[i], node_index);
     }
 
-    // Insert rigid body as a node in the entity graph.
-    auto non_connecting = def.kind != rigidbody_kind::rb_dynamic;
-    auto node_index = registry.ctx().get<entity_graph>().insert_node(entity, non_connecting);
-    registry.emplace<graph_node>(entity, node_index);
+    for (size_t i = 0; i < count; ++i) {
+        if (defs[i].kind == rigidbody_kind::rb_dynamic) {
+            registry.emplace<island_resident>(entities[i]);
+        } else {
+            registry.emplace<multi_island_resident>(entities[i]);
+        }
+    }
 
-    if (def.kind == rigidbody_kind::rb_dynamic) {
-        registry.emplace<island_resident>(entity);
-    } else {
-        registry.emplace<multi_island_resident>(entity);
+    // Always do this last to signal the completion of the construction of the
+    // rigid bodies.
+    for (size_t i = 0; i < count; ++i) {
+        registry.emplace<rigidbody_tag>(entities[i]);
     }
+}
 
-    // Always do this last to signal the completion of the construction of this
-    // rigid body.
-    registry.emplace<rigidbody_tag>(entity);
+void make_rigidbody(entt::entity entity, entt::registry &registry, const rigidbody_def &def) {
+    make_rigidbodies(registry, &entity, &def, 1);
 }
 
 entt::entity make_rigidbody(entt::registry &registry, const rigidbody_def &def) {
@@ -187,6 +292,19 @@ entt::entity make_rigidbody(entt::registry &registry, const rigidbody_def &def)
     return ent;
 }
 
+void batch_make_rigidbodies(const std::vector<entt::entity> &entities, entt::registry &registry,
+                            const std::vector<rigidbody_def> &defs) {
+    EDYN_ASSERT(entities.size() == defs.size());
+    make_rigidbodies(registry, entities.data(), defs.data(), defs.size());
+}
+
+std::vector<entt::entity> batch_make_rigidbodies(entt::registry &registry, const std::vector<rigidbody_def> &defs) {
+    auto entities = std::vector<entt::entity>(defs.size());
+    registry.create(entities.begin(), entities.end());
+    batch_make_rigidbodies(entities, registry, defs);
+    return entities;
+}
+
 void clear_rigidbody(entt::registry &registry, entt::entity entity) {
     registry.erase<rigidbody_tag>(entity);
     registry.remove<dynamic_tag, kinematic_tag, static_tag>(entity);
@@ -194,6 +312,9 @@ void clear_rigidbody(entt::registry &registry, entt::entity entity) {
 
     registry.remove<networked_tag>(entity);
     registry.remove<sleeping_disabled_tag>(entity);
+    registry.remove<ccd_tag>(entity);
+    registry.remove<particle_tag>(entity);
+    registry.remove<sensor_tag, sensor_aabb_tag>(entity);
     registry.remove<collision_filter>(entity);
 
     if (rigidbody_has_shape(registry, entity)) {
@@ -337,8 +458,8 @@ void set_rigidbody_friction(entt::registry &registry, entt::entity entity, scala
 
         auto combined_friction = material_mix_friction(friction, other_material.friction);
 
-        manifold.each_point([combined_friction](contact_point &cp) {
-            cp.friction = combined_friction;
+        manifold.each_point([combined_friction](contact_point &, contact_point_cold &cold) {
+            cold.friction = combined_friction;
         });
 
         // Force changes to be propagated to simulation worker.
@@ -399,6 +520,14 @@ void wake_up_entity(entt::registry &registry, entt::entity entity) {
     }
 }
 
+void wake_up_entities(entt::registry &registry, const std::vector<entt::entity> &entities) {
+    if (auto *stepper = registry.ctx().find<stepper_async>()) {
+        stepper->wake_up_entities(entities);
+    } else {
+        wake_up_island_residents(registry, entities);
+    }
+}
+
 template<typename ShapeType>
 void rigidbody_assign_shape(entt::registry &registry, entt::entity entity, ShapeType &shape) {
     if (!registry.any_of<static_tag>(entity)) {
@@ -433,7 +562,7 @@ void rigidbody_assign_shape(entt::registry &registry, entt::entity entity, Shape
     }
 
     // Assign tag for dynamic rolling shapes.
-    if (registry.all_of<dynamic_tag>(entity)) {
+    if (registry.all_of<dynamic_tag>(entity) && !registry.all_of<particle_tag>(entity)) {
         if constexpr(tuple_has_type<ShapeType, rolling_shapes_tuple_t>::value) {
             if (!registry.all_of<rolling_tag>(entity)) {
                 registry.emplace<rolling_tag>(entity);
@@ -456,6 +585,7 @@ void rigidbody_assign_shape(entt::registry &registry, entt::entity entity, Shape
 void rigidbody_set_shape(entt::registry &registry, entt::entity entity, std::optional<shapes_variant_t> shape_opt) {
     if (shape_opt) {
         std::visit([&](auto &shape) {
+            share_shape_meshes(shape);
             rigidbody_assign_shape(registry, entity, shape);
         }, *shape_opt);
     } else if (registry.all_of<shape_index>(entity)) {
@@ -495,6 +625,26 @@ void rigidbody_set_kind(entt::registry &registry, entt::entity entity, rigidbody
     }
 }
 
+void rigidbody_set_kind(entt::registry &registry, const std::vector<entt::entity> &entities, rigidbody_kind kind) {
+    if (auto *stepper = registry.ctx().find<stepper_async>()) {
+        for (auto entity : entities) {
+            internal::rigidbody_replace_kind_tags(registry, entity, kind);
+            internal::rigidbody_assert_supports_kind(registry, entity, kind);
+        }
+
+        stepper->set_rigidbody_kind(entities, kind);
+    } else {
+        auto changes = std::vector<std::pair<entt::entity, rigidbody_kind>>{};
+        changes.reserve(entities.size());
+
+        for (auto entity : entities) {
+            changes.emplace_back(entity, kind);
+        }
+
+        internal::rigidbody_apply_kind(registry, changes, registry.ctx().get<stepper_sequential>().get_island_manager());
+    }
+}
+
 }
 
 namespace edyn::internal {
@@ -588,4 +738,50 @@ void rigidbody_apply_kind(entt::registry &registry, entt::entity entity, rigidbo
     }
 }
 
+void rigidbody_apply_kind(entt::registry &registry,
+                          const std::vector<std::pair<entt::entity, rigidbody_kind>> &changes,
+                          island_manager &isle_mgr) {
+    auto &graph = registry.ctx().get<entity_graph>();
+    auto node_view = registry.view<graph_node>();
+    // Entities which became non-procedural and procedural, respectively.
+    std::vector<entt::entity> entities[2];
+
+    for (auto [entity, kind] : changes) {
+        rigidbody_replace_kind_tags(registry, entity, kind);
+        rigidbody_assert_supports_kind(registry, entity, kind);
+
+        const bool procedural = kind == rigidbody_kind::rb_dynamic;
+        auto [node] = node_view.get(entity);
+        graph.set_connecting_node(node.node_index, procedural);
+        entities[procedural].push_back(entity);
+    }
+
+    auto &bphase = registry.ctx().get<broadphase>();
+
+    for (int procedural = 0; procedural < 2; ++procedural) {
+        if (!entities[procedural].empty()) {
+            bphase.set_procedural(entities[procedural], procedural == 1);
+            isle_mgr.set_procedural(entities[procedural], procedural == 1);
+        }
+    }
+
+    // Remove all contacts between non-procedural entities once all tags have
+    // been replaced, since both sides of a contact could be in the batch.
+    auto manifold_view = registry.view<contact_manifold>();
+    auto procedural_view = registry.view<procedural_tag>();
+
+    for (auto entity : entities[0]) {
+        visit_edges(registry, entity, [&](entt::entity edge_entity) {
+            if (manifold_view.contains(edge_entity)) {
+                auto [manifold] = manifold_view.get(edge_entity);
+                auto other = manifold.body[0] == entity ? manifold.body[1] : manifold.body[0];
+
+                if (!procedural_view.contains(other)) {
+                    registry.destroy(edge_entity);
+                }
+            }
+        });
+    }
+}
+
 }
@@ -13,7 +13,9 @@ void refresh_settings(entt::registry &registry)
 
     if (auto *ctx = registry.ctx().find<client_network_context>()) {
         auto &settings = registry.ctx().get<edyn::settings>();
-        ctx->extrapolator->set_settings(settings);
+        for (auto &extrapolator : ctx->extrapolators) {
+            extrapolator->set_settings(settings);
+        }
     }
 }
 
@@ -1,39 +1,96 @@
 #include "edyn/util/shape_io.hpp"
+#include "edyn/serialization/mapped_file.hpp"
 #include "edyn/shapes/compound_shape.hpp"
 #include "edyn/shapes/polyhedron_shape.hpp"
 #include "edyn/util/shape_util.hpp"
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <sstream>
+#include <string_view>
 #include <numeric>
 
 namespace edyn {
 
-static vector3 read_vector3(std::istringstream &iss) {
-    edyn::vector3 v;
-    iss >> v.x >> v.y >> v.z;
-    return v;
+/*
+ * The obj parser works on the whole text of the file, which is memory mapped
+ * when loading from a path, and splits it into lines and tokens without
+ * copying or allocating. Numbers are parsed with `std::from_chars`, which
+ * does not depend on the locale and is much faster than stream extraction.
+ */
+
+static bool is_obj_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Removes the next token from the line and returns it. Returns an empty
+// string at the end of the line.
+static std::string_view next_token(std::string_view &line) {
+    size_t start = 0;
+
+    while (start < line.size() && is_obj_space(line[start])) {
+        ++start;
+    }
+
+    auto stop = start;
+
+    while (stop < line.size() && !is_obj_space(line[stop])) {
+        ++stop;
+    }
+
+    auto token = line.substr(start, stop - start);
+    line.remove_prefix(stop);
+    return token;
+}
+
+static bool parse_scalar(std::string_view token, scalar &value) {
+    if (token.empty()) {
+        return false;
+    }
+
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+    return result.ec == std::errc{};
+#else
+    // Floating point `from_chars` is not available in this standard library.
+    // The token is not null terminated thus it's copied into a buffer.
+    char buffer[64];
+
+    if (token.size() >= sizeof(buffer)) {
+        return false;
+    }
+
+    std::memcpy(buffer, token.data(), token.size());
+    buffer[token.size()] = '\0';
+    char *stop;
+    value = static_cast<scalar>(std::strtod(buffer, &stop));
+    return stop != buffer;
+#endif
 }
 
-static void read_face_indices(std::istringstream &iss,
+static bool read_vector3(std::string_view &line, vector3 &v) {
+    return parse_scalar(next_token(line), v.x) &&
+           parse_scalar(next_token(line), v.y) &&
+           parse_scalar(next_token(line), v.z);
+}
+
+static void read_face_indices(std::string_view line,
                               std::vector<uint32_t> &indices,
                               uint32_t offset, bool triangulate) {
-    std::string idx_str;
     auto count = size_t{};
     uint32_t first_idx;
     uint32_t prev_idx;
 
     while (true) {
-        iss >> idx_str;
-        if (iss.fail()) break;
-
-        // Remove everything after the first slash to keep only the first
-        // element in the "v/vt/vn" sequence.
-        auto pos = idx_str.find_first_of('/');
-        if (pos != std::string::npos) {
-            idx_str.erase(pos);
-        }
-
-        auto idx = static_cast<uint32_t>(std::stoi(idx_str));
+        auto idx_str = next_token(line);
+        if (idx_str.empty()) break;
+
+        // Only parse the first element in the "v/vt/vn" sequence. Parsing
+        // stops at the first slash.
+        uint32_t idx;
+        auto result = std::from_chars(idx_str.data(), idx_str.data() + idx_str.size(), idx);
+        if (result.ec != std::errc{}) break;
         EDYN_ASSERT(idx >= 1 + offset);
 
         if (triangulate && count >= 3) {
@@ -52,77 +109,98 @@ static void read_face_indices(std::istringstream &iss,
     }
 }
 
-static void read_face(std::istringstream &iss,
+static void read_face(std::string_view line,
                       std::vector<uint32_t> &indices,
                       std::vector<uint32_t> &faces,
                       uint32_t offset, bool triangulate) {
     // Store where this face starts in the `indices` array.
     faces.push_back(indices.size());
 
-    read_face_indices(iss, indices, offset, triangulate);
+    read_face_indices(line, indices, offset, triangulate);
 
     // Store the number of vertices in this face.
     auto count = indices.size() - faces.back();
     faces.push_back(count);
 }
 
-template<typename Stream>
-void load_meshes_from_obj_stream(Stream &stream,
-                                 std::vector<obj_mesh> &meshes,
-                                 vector3 pos,
-                                 quaternion orn,
-                                 vector3 scale) {
-    std::string line;
-    auto mesh = obj_mesh{};
-    uint32_t index_offset = 0;
+// Calls `func` with the command and the rest of each line.
+template<typename Func>
+void for_each_obj_line(std::string_view text, Func func) {
+    while (!text.empty()) {
+        auto line_end = text.find('\n');
+        auto line = text.substr(0, line_end);
+        text.remove_prefix(line_end == std::string_view::npos ? text.size() : line_end + 1);
 
-    while (std::getline(stream, line)) {
-        auto pos_space = line.find(" ");
+        auto cmd = next_token(line);
 
-        if (pos_space == std::string::npos) {
-            continue;
+        if (!cmd.empty()) {
+            func(cmd, line);
         }
+    }
+}
+
+// Maps the file into memory. Empty files cannot be mapped, thus they're
+// treated as empty text.
+static bool map_obj_file(const std::string &path, mapped_file &file, std::string_view &text) {
+    if (file.open(path)) {
+        text = std::string_view(reinterpret_cast<const char *>(file.data()), file.size());
+        return true;
+    }
+
+    text = {};
+    return std::ifstream(path).is_open();
+}
+
+static vector3 transform_obj_vertex(vector3 v, const vector3 &pos,
+                                    const quaternion &orn, const vector3 &scale) {
+    if (scale != vector3_one) {
+        v *= scale;
+    }
+
+    if (orn != quaternion_identity) {
+        v = rotate(orn, v);
+    }
 
-        auto cmd = line.substr(0, pos_space);
+    if (pos != vector3_zero ) {
+        v += pos;
+    }
 
+    return v;
+}
+
+static void load_meshes_from_obj_text(std::string_view text,
+                                      std::vector<obj_mesh> &meshes,
+                                      vector3 pos,
+                                      quaternion orn,
+                                      vector3 scale) {
+    auto mesh = obj_mesh{};
+    uint32_t index_offset = 0;
+
+    for_each_obj_line(text, [&](std::string_view cmd, std::string_view line) {
         if (cmd == "o") {
             if (!mesh.vertices.empty()) {
                 index_offset += mesh.vertices.size();
                 meshes.emplace_back(std::move(mesh));
-            }
-            auto iss = std::istringstream(line.substr(pos_space, line.size() - pos_space));
-            mesh.name = iss.str();
-        } else if (cmd == "v") {
-            auto iss = std::istringstream(line.substr(pos_space, line.size() - pos_space));
-            auto v = read_vector3(iss);
-
-            if (scale != vector3_one) {
-                v *= scale;
+                mesh = obj_mesh{};
             }
 
-            if (orn != quaternion_identity) {
-                v = rotate(orn, v);
-            }
-
-            if (pos != vector3_zero ) {
-                v += pos;
-            }
+            mesh.name = std::string(next_token(line));
+        } else if (cmd == "v") {
+            auto v = vector3{};
+            if (!read_vector3(line, v)) return;
 
-            mesh.vertices.push_back(v);
+            mesh.vertices.push_back(transform_obj_vertex(v, pos, orn, scale));
 
-            if (!iss.eof()) {
-                // Try reading vertex color.
-                auto color = read_vector3(iss);
+            // Try reading vertex color.
+            auto color = vector3{};
 
-                if (!iss.fail()) {
-                    mesh.colors.push_back(color);
-                }
+            if (read_vector3(line, color)) {
+                mesh.colors.push_back(color);
             }
         } else if (cmd == "f") {
-            auto iss = std::istringstream(line.substr(pos_space, line.size() - pos_space));
-            read_face(iss, mesh.indices, mesh.faces, index_offset, false);
+            read_face(line, mesh.indices, mesh.faces, index_offset, false);
         }
-    }
+    });
 
     if (!mesh.vertices.empty()) {
         meshes.emplace_back(std::move(mesh));
@@ -134,13 +212,14 @@ bool load_meshes_from_obj(const std::string &path,
                           vector3 pos,
                           quaternion orn,
                           vector3 scale) {
-    auto file = std::ifstream(path);
+    auto file = mapped_file{};
+    auto text = std::string_view{};
 
-    if (!file.is_open()) {
+    if (!map_obj_file(path, file, text)) {
         return false;
     }
 
-    load_meshes_from_obj_stream(file, meshes, pos, orn, scale);
+    load_meshes_from_obj_text(text, meshes, pos, orn, scale);
 
     return true;
 }
@@ -150,59 +229,34 @@ void load_meshes_from_obj(std::stringstream &ss,
                           vector3 pos,
                           quaternion orn,
                           vector3 scale) {
-    load_meshes_from_obj_stream(ss, meshes, pos, orn, scale);
+    auto text = ss.str();
+    load_meshes_from_obj_text(text, meshes, pos, orn, scale);
 }
 
-template<typename Stream>
-void load_tri_mesh_from_obj_stream(Stream &stream,
-                                   std::vector<vector3> &vertices,
-                                   std::vector<uint32_t> &indices,
-                                   std::vector<vector3> *colors,
-                                   vector3 pos,
-                                   quaternion orn,
-                                   vector3 scale) {
-    std::string line;
-
-    while (std::getline(stream, line)) {
-        auto pos_space = line.find(" ");
-
-        if (pos_space == std::string::npos) {
-            continue;
-        }
-
-        auto cmd = line.substr(0, pos_space);
-
+static void load_tri_mesh_from_obj_text(std::string_view text,
+                                        std::vector<vector3> &vertices,
+                                        std::vector<uint32_t> &indices,
+                                        std::vector<vector3> *colors,
+                                        vector3 pos,
+                                        quaternion orn,
+                                        vector3 scale) {
+    for_each_obj_line(text, [&](std::string_view cmd, std::string_view line) {
         if (cmd == "v") {
-            auto iss = std::istringstream(line.substr(pos_space, line.size() - pos_space));
-            auto v = read_vector3(iss);
+            auto v = vector3{};
+            if (!read_vector3(line, v)) return;
 
-            if (scale != vector3_one) {
-                v *= scale;
-            }
+            vertices.push_back(transform_obj_vertex(v, pos, orn, scale));
 
-            if (orn != quaternion_identity) {
-                v = rotate(orn, v);
-            }
+            // Try reading vertex color.
+            auto color = vector3{};
 
-            if (pos != vector3_zero ) {
-                v += pos;
-            }
-
-            vertices.push_back(v);
-
-            if (colors != nullptr && !iss.eof()) {
-                // Try reading vertex color.
-                auto color = read_vector3(iss);
-
-                if (!iss.fail()) {
-                    colors->push_back(color);
-                }
+            if (colors != nullptr && read_vector3(line, color)) {
+                colors->push_back(color);
             }
         } else if (cmd == "f") {
-            auto iss = std::istringstream(line.substr(pos_space, line.size() - pos_space));
-            read_face_indices(iss, indices, 0, true);
+            read_face_indices(line, indices, 0, true);
         }
-    }
+    });
 }
 
 bool load_tri_mesh_from_obj(const std::string &path,
@@ -212,13 +266,14 @@ bool load_tri_mesh_from_obj(const std::string &path,
                             vector3 pos,
                             quaternion orn,
                             vector3 scale) {
-    auto file = std::ifstream(path);
+    auto file = mapped_file{};
+    auto text = std::string_view{};
 
-    if (!file.is_open()) {
+    if (!map_obj_file(path, file, text)) {
         return false;
     }
 
-    load_tri_mesh_from_obj_stream(file, vertices, indices, colors, pos, orn, scale);
+    load_tri_mesh_from_obj_text(text, vertices, indices, colors, pos, orn, scale);
     return true;
 }
 
@@ -229,19 +284,19 @@ void load_tri_mesh_from_obj(std::stringstream &stream,
                             vector3 pos,
                             quaternion orn,
                             vector3 scale) {
-    load_tri_mesh_from_obj_stream(stream, vertices, indices, colors, pos, orn, scale);
+    auto text = stream.str();
+    load_tri_mesh_from_obj_text(text, vertices, indices, colors, pos, orn, scale);
 }
 
-template<typename Stream>
-std::vector<polyhedron_with_center> load_convex_polyhedrons_from_obj_stream(
-    Stream &stream,
+static std::vector<polyhedron_with_center> load_convex_polyhedrons_from_obj_text(
+    std::string_view text,
     const vector3 &pos,
     const quaternion &orn,
     const vector3 &scale) {
 
     auto meshes = std::vector<obj_mesh>{};
 
-    load_meshes_from_obj_stream(stream, meshes, pos, orn, scale);
+    load_meshes_from_obj_text(text, meshes, pos, orn, scale);
 
     EDYN_ASSERT(!meshes.empty());
     auto polyhedrons = std::vector<polyhedron_with_center>{};
@@ -281,13 +336,14 @@ std::vector<polyhedron_with_center> load_convex_polyhedrons_from_obj(
     const quaternion &orn,
     const vector3 &scale) {
 
-    auto file = std::ifstream(path_to_obj);
+    auto file = mapped_file{};
+    auto text = std::string_view{};
 
-    if (!file.is_open()) {
+    if (!map_obj_file(path_to_obj, file, text)) {
         return {};
     }
 
-    return load_convex_polyhedrons_from_obj_stream(file, pos, orn, scale);
+    return load_convex_polyhedrons_from_obj_text(text, pos, orn, scale);
 }
 
 std::vector<polyhedron_with_center> load_convex_polyhedrons_from_obj(
@@ -295,17 +351,17 @@ std::vector<polyhedron_with_center> load_convex_polyhedrons_from_obj(
     const vector3 &pos,
     const quaternion &orn,
     const vector3 &scale) {
-    return load_convex_polyhedrons_from_obj_stream(ss, pos, orn, scale);
+    auto text = ss.str();
+    return load_convex_polyhedrons_from_obj_text(text, pos, orn, scale);
 }
 
-template<typename Stream>
-compound_shape load_compound_shape_from_obj_stream(
-    Stream &stream,
+static compound_shape load_compound_shape_from_obj_text(
+    std::string_view text,
     const vector3 &pos,
     const quaternion &orn,
     const vector3 &scale) {
 
-    auto polyhedrons = load_convex_polyhedrons_from_obj_stream(stream, pos, orn, scale);
+    auto polyhedrons = load_convex_polyhedrons_from_obj_text(text, pos, orn, scale);
     EDYN_ASSERT(!polyhedrons.empty());
 
     auto compound = compound_shape{};
@@ -325,13 +381,14 @@ compound_shape load_compound_shape_from_obj(
     const quaternion &orn,
     const vector3 &scale) {
 
-    auto file = std::ifstream(path_to_obj);
+    auto file = mapped_file{};
+    auto text = std::string_view{};
 
-    if (!file.is_open()) {
+    if (!map_obj_file(path_to_obj, file, text)) {
         return {};
     }
 
-    return load_compound_shape_from_obj_stream(file, pos, orn, scale);
+    return load_compound_shape_from_obj_text(text, pos, orn, scale);
 }
 
 compound_shape load_compound_shape_from_obj(
@@ -339,7 +396,8 @@ compound_shape load_compound_shape_from_obj(
     const vector3 &pos,
     const quaternion &orn,
     const vector3 &scale) {
-    return load_compound_shape_from_obj_stream(ss, pos, orn, scale);
+    auto text = ss.str();
+    return load_compound_shape_from_obj_text(text, pos, orn, scale);
 }
 
 }
@@ -6,6 +6,7 @@
 #include "edyn/math/math.hpp"
 #include "edyn/math/vector3.hpp"
 #include "edyn/shapes/triangle_mesh.hpp"
+#include <algorithm>
 
 namespace edyn {
 
@@ -49,14 +50,22 @@ scalar polyhedron_support_projection(const std::vector<vector3> &vertices,
                                      const std::vector<uint32_t> &neighbors_start,
                                      const std::vector<uint32_t> &neighbor_indices,
                                      const vector3 &dir) {
-    // Starting at the first vertex, visit all neighbors and pick the neighboring
+    auto vertex_idx = 0u;
+    return polyhedron_support_projection(vertices, neighbors_start, neighbor_indices, dir, vertex_idx);
+}
+
+scalar polyhedron_support_projection(const std::vector<vector3> &vertices,
+                                     const std::vector<uint32_t> &neighbors_start,
+                                     const std::vector<uint32_t> &neighbor_indices,
+                                     const vector3 &dir, uint32_t &vertex_idx) {
+    // Starting at the given vertex, visit all neighbors and pick the neighboring
     // vertex with higher projection. Stop when there are no more neighbors with
     // a higher projection value than the current.
-    auto v_idx = 0u;
-    auto max_proj = dot(vertices[0], dir);
-
     EDYN_ASSERT(neighbors_start.size() == vertices.size() + 1);
 
+    auto v_idx = vertex_idx < vertices.size() ? vertex_idx : 0u;
+    auto max_proj = dot(vertices[v_idx], dir);
+
     while (true) {
         auto n_idx0 = neighbors_start[v_idx];
         auto n_idx1 = neighbors_start[v_idx + 1];
@@ -78,9 +87,62 @@ scalar polyhedron_support_projection(const std::vector<vector3> &vertices,
         }
     }
 
+    vertex_idx = v_idx;
+
     return max_proj;
 }
 
+support_polygon polyhedron_support_polygon(const std::vector<vector3> &vertices,
+                                           const std::vector<uint32_t> &neighbors_start,
+                                           const std::vector<uint32_t> &neighbor_indices,
+                                           const vector3 &offset, const vector3 &dir,
+                                           scalar projection, bool positive_side,
+                                           scalar tolerance, uint32_t &vertex_idx) {
+    auto is_in_boundary = [&](uint32_t idx) {
+        auto proj = dot(vertices[idx] + offset, dir);
+        return positive_side ? proj < projection + tolerance : proj > projection - tolerance;
+    };
+
+    // Find the support vertex and then the vertices connected to it which are
+    // within the tolerance. These form a connected set in a convex polyhedron.
+    polyhedron_support_projection(vertices, neighbors_start, neighbor_indices,
+                                  positive_side ? -dir : dir, vertex_idx);
+
+    if (!is_in_boundary(vertex_idx)) {
+        return point_cloud_support_polygon(vertices.begin(), vertices.end(), offset,
+                                           dir, projection, positive_side, tolerance);
+    }
+
+    auto indices = std::vector<uint32_t>{vertex_idx};
+
+    for (size_t k = 0; k < indices.size(); ++k) {
+        auto v_idx = indices[k];
+
+        for (auto i = neighbors_start[v_idx]; i < neighbors_start[v_idx + 1]; ++i) {
+            auto nv_idx = neighbor_indices[i];
+
+            if (is_in_boundary(nv_idx) &&
+                std::find(indices.begin(), indices.end(), nv_idx) == indices.end()) {
+                indices.push_back(nv_idx);
+            }
+        }
+    }
+
+    // Keep the order of the vertices in the mesh so the result is the same as
+    // that of `point_cloud_support_polygon`.
+    std::sort(indices.begin(), indices.end());
+
+    auto points = std::vector<vector3>{};
+    points.reserve(indices.size());
+
+    for (auto idx : indices) {
+        points.push_back(vertices[idx] + offset);
+    }
+
+    return point_cloud_support_polygon(points.begin(), points.end(), vector3_zero,
+                                       dir, projection, positive_side, tolerance);
+}
+
 vector3 point_cloud_support_point(const std::vector<vector3> &points, const vector3 &dir) {
     return point_cloud_support_point(points.begin(), points.end(), dir);
 }
@@ -0,0 +1,85 @@
+#include "edyn/util/step_profile.hpp"
+#include "edyn/context/settings.hpp"
+#include "edyn/networking/context/client_network_context.hpp"
+#include "edyn/simulation/stepper_async.hpp"
+#include "edyn/time/time.hpp"
+#include <entt/entity/registry.hpp>
+#include <algorithm>
+
+namespace edyn {
+
+void step_profile::record(step_phase phase, double duration) {
+    auto &timing = phases[static_cast<size_t>(phase)];
+    timing.last = duration;
+    timing.average = num_steps == 0 ? duration : timing.average + (duration - timing.average) * smoothing;
+    timing.max = std::max(timing.max, duration);
+}
+
+step_profile_timer::step_profile_timer(step_profile *profile)
+    : m_profile(profile)
+    , m_step_start(profile ? performance_time() : 0)
+    , m_start(m_step_start)
+{}
+
+void step_profile_timer::record(step_phase phase) {
+    if (m_profile) {
+        auto now = performance_time();
+        m_profile->record(phase, now - m_start);
+        m_start = now;
+    }
+}
+
+void step_profile_timer::skip() {
+    if (m_profile) {
+        m_start = performance_time();
+    }
+}
+
+void step_profile_timer::finish() {
+    if (m_profile) {
+        m_profile->record(step_phase::step, performance_time() - m_step_start);
+        ++m_profile->num_steps;
+    }
+}
+
+bool get_step_profiling(const entt::registry &registry) {
+    return registry.ctx().get<settings>().profile_steps;
+}
+
+void set_step_profiling(entt::registry &registry, bool enabled) {
+    auto &settings = registry.ctx().get<edyn::settings>();
+
+    if (enabled && !settings.profile_steps) {
+        registry.ctx().get<step_profile>().reset();
+    }
+
+    settings.profile_steps = enabled;
+
+    if (auto *stepper = registry.ctx().find<stepper_async>()) {
+        stepper->settings_changed();
+    }
+
+    if (auto *ctx = registry.ctx().find<client_network_context>()) {
+        for (auto &extrapolator : ctx->extrapolators) {
+            extrapolator->set_settings(settings);
+        }
+    }
+}
+
+const step_profile & get_step_profile(const entt::registry &registry) {
+    return registry.ctx().get<step_profile>();
+}
+
+}
+
+namespace edyn::internal {
+
+step_profile * find_step_profile(entt::registry &registry) {
+    if (!registry.ctx().get<settings>().profile_steps) {
+        return nullptr;
+    }
+
+    return registry.ctx().find<step_profile>();
+}
+
+}
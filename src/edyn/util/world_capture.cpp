@@ -0,0 +1,834 @@
+#include "edyn/util/world_capture.hpp"
+#include "edyn/config/config.h"
+#include "edyn/comp/graph_edge.hpp"
+#include "edyn/comp/graph_node.hpp"
+#include "edyn/comp/island.hpp"
+#include "edyn/comp/shared_comp.hpp"
+#include "edyn/comp/tag.hpp"
+#include "edyn/constraints/constraint.hpp"
+#include "edyn/constraints/null_constraint.hpp"
+#include "edyn/context/settings.hpp"
+#include "edyn/core/entity_graph.hpp"
+#include "edyn/edyn.hpp"
+#include "edyn/networking/packet/edyn_packet.hpp"
+#include "edyn/networking/context/server_network_context.hpp"
+#include "edyn/networking/sys/server_side.hpp"
+#include "edyn/replication/entity_map.hpp"
+#include "edyn/replication/registry_operation.hpp"
+#include "edyn/replication/registry_operation_builder.hpp"
+#include "edyn/replication/registry_operation_observer.hpp"
+#include "edyn/replication/registry_operation_pool.hpp"
+#include "edyn/serialization/entt_s11n.hpp"
+#include "edyn/serialization/mapped_file.hpp"
+#include "edyn/serialization/math_s11n.hpp"
+#include "edyn/serialization/memory_archive.hpp"
+#include "edyn/serialization/world_s11n.hpp"
+#include "edyn/shapes/shapes.hpp"
+#include "edyn/time/time.hpp"
+#include "edyn/util/constraint_util.hpp"
+#include "edyn/util/settings_util.hpp"
+#include <entt/entity/registry.hpp>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <type_traits>
+
+namespace edyn {
+
+template<typename Archive>
+void serialize(Archive &archive, world_capture_header &header) {
+    archive(header.magic, header.version, header.scalar_size, header.server, header.start_time);
+}
+
+}
+
+namespace edyn::internal {
+
+// Components whose changes can be recorded, i.e. the ones which can be
+// serialized, including tags.
+template<typename T, typename = void>
+struct is_capturable : std::is_empty<T> {};
+
+template<typename T>
+struct is_capturable<T, std::void_t<decltype(serialize(std::declval<memory_output_archive &>(),
+                                                       std::declval<T &>()))>> : std::true_type {};
+
+template<typename T>
+inline constexpr bool is_capturable_v = is_capturable<T>::value;
+
+template<typename... Components>
+auto capture_builder_type(std::tuple<Components...>) -> registry_operation_builder_impl<Components...>;
+
+template<typename... Components>
+auto capture_observer_type(std::tuple<Components...>) -> registry_operation_observer_impl<Components...>;
+
+using capture_builder_t = decltype(capture_builder_type(shared_components_t{}));
+using capture_observer_t = decltype(capture_observer_type(shared_components_t{}));
+
+// Settings which affect the simulation and can be recorded.
+struct capture_settings {
+    scalar fixed_dt;
+    bool paused;
+    vector3 gravity;
+    bool nbody_gravity;
+    scalar nbody_gravity_constant;
+    scalar nbody_gravity_theta;
+    scalar nbody_gravity_softening;
+    uint32_t max_steps_per_update;
+    uint32_t num_solver_velocity_iterations;
+    uint32_t min_solver_velocity_iterations;
+    scalar solver_velocity_tolerance;
+    uint32_t num_solver_position_iterations;
+    uint32_t num_restitution_iterations;
+    uint32_t num_individual_restitution_iterations;
+    uint32_t num_solver_substeps;
+    uint32_t num_low_fidelity_velocity_iterations;
+    uint32_t num_low_fidelity_position_iterations;
+    bool contact_block_solver;
+    bool articulate_distance_chains;
+    bool deterministic;
+    scalar contact_reuse_linear_tolerance;
+    scalar contact_reuse_angular_tolerance;
+    bool freeze_resting_bodies;
+    bool compact_sleeping_islands;
+    scalar island_split_delay;
+    double maintenance_budget;
+
+    static capture_settings from(const settings &s) {
+        return {
+            s.fixed_dt, s.paused, s.gravity,
+            s.nbody_gravity, s.nbody_gravity_constant, s.nbody_gravity_theta, s.nbody_gravity_softening,
+            s.max_steps_per_update,
+            s.num_solver_velocity_iterations, s.min_solver_velocity_iterations, s.solver_velocity_tolerance,
+            s.num_solver_position_iterations,
+            s.num_restitution_iterations, s.num_individual_restitution_iterations,
+            s.num_solver_substeps,
+            s.num_low_fidelity_velocity_iterations, s.num_low_fidelity_position_iterations,
+            s.contact_block_solver, s.articulate_distance_chains, s.deterministic,
+            s.contact_reuse_linear_tolerance, s.contact_reuse_angular_tolerance,
+            s.freeze_resting_bodies, s.compact_sleeping_islands, s.island_split_delay,
+            s.maintenance_budget
+        };
+    }
+
+    // Assigns everything but `paused`, which is set with `set_paused`.
+    void apply(settings &s) const {
+        s.fixed_dt = fixed_dt;
+        s.gravity = gravity;
+        s.nbody_gravity = nbody_gravity;
+        s.nbody_gravity_constant = nbody_gravity_constant;
+        s.nbody_gravity_theta = nbody_gravity_theta;
+        s.nbody_gravity_softening = nbody_gravity_softening;
+        s.max_steps_per_update = max_steps_per_update;
+        s.num_solver_velocity_iterations = num_solver_velocity_iterations;
+        s.min_solver_velocity_iterations = min_solver_velocity_iterations;
+        s.solver_velocity_tolerance = solver_velocity_tolerance;
+        s.num_solver_position_iterations = num_solver_position_iterations;
+        s.num_restitution_iterations = num_restitution_iterations;
+        s.num_individual_restitution_iterations = num_individual_restitution_iterations;
+        s.num_solver_substeps = num_solver_substeps;
+        s.num_low_fidelity_velocity_iterations = num_low_fidelity_velocity_iterations;
+        s.num_low_fidelity_position_iterations = num_low_fidelity_position_iterations;
+        s.contact_block_solver = contact_block_solver;
+        s.articulate_distance_chains = articulate_distance_chains;
+        s.deterministic = deterministic;
+        s.contact_reuse_linear_tolerance = contact_reuse_linear_tolerance;
+        s.contact_reuse_angular_tolerance = contact_reuse_angular_tolerance;
+        s.freeze_resting_bodies = freeze_resting_bodies;
+        s.compact_sleeping_islands = compact_sleeping_islands;
+        s.island_split_delay = island_split_delay;
+        s.maintenance_budget = maintenance_budget;
+    }
+};
+
+template<typename Archive>
+void serialize(Archive &archive, capture_settings &s) {
+    archive(s.fixed_dt, s.paused, s.gravity);
+    archive(s.nbody_gravity, s.nbody_gravity_constant, s.nbody_gravity_theta, s.nbody_gravity_softening);
+    archive(s.max_steps_per_update);
+    archive(s.num_solver_velocity_iterations, s.min_solver_velocity_iterations, s.solver_velocity_tolerance);
+    archive(s.num_solver_position_iterations);
+    archive(s.num_restitution_iterations, s.num_individual_restitution_iterations);
+    archive(s.num_solver_substeps);
+    archive(s.num_low_fidelity_velocity_iterations, s.num_low_fidelity_position_iterations);
+    archive(s.contact_block_solver, s.articulate_distance_chains, s.deterministic);
+    archive(s.contact_reuse_linear_tolerance, s.contact_reuse_angular_tolerance);
+    archive(s.freeze_resting_bodies, s.compact_sleeping_islands, s.island_split_delay);
+    archive(s.maintenance_budget);
+}
+
+static bool operator==(const capture_settings &a, const capture_settings &b) {
+    // Compared as serialized, which covers all members.
+    auto buffer_a = std::vector<uint8_t>{};
+    auto buffer_b = std::vector<uint8_t>{};
+    auto archive_a = memory_output_archive(buffer_a);
+    auto archive_b = memory_output_archive(buffer_b);
+    archive_a(const_cast<capture_settings &>(a));
+    archive_b(const_cast<capture_settings &>(b));
+    return buffer_a == buffer_b;
+}
+
+// Rigid bodies with these shapes are not recorded, since the shapes refer to
+// data which is managed by the application or can't be serialized on its own.
+static bool has_uncapturable_shape(const entt::registry &registry, entt::entity entity) {
+    return registry.any_of<mesh_shape, paged_mesh_shape, heightfield_shape>(entity);
+}
+
+/**
+ * Records what enters a world while a capture is in progress. Bodies and
+ * constraints are observed as in `stepper_async`, and the changes made to
+ * them are written into the capture in a single record before each call.
+ * The changes made during a call are not recorded, but the entities created
+ * in the meantime are, so the entities created by the same call on replay
+ * can be matched with them.
+ */
+class world_capture {
+public:
+    world_capture(entt::registry &registry)
+        : m_registry(&registry)
+        , m_builder(registry)
+        , m_observer(m_builder, shared_components_t{})
+    {
+        auto &settings = registry.ctx().get<edyn::settings>();
+
+        auto header = world_capture_header{};
+        header.scalar_size = sizeof(scalar);
+        header.server = registry.ctx().contains<server_network_context>();
+        header.start_time = (*settings.time_func)();
+
+        auto archive = memory_output_archive(m_data);
+        archive(header);
+
+        // The world as it is now is the starting point.
+        auto keyframe = std::vector<uint8_t>{};
+        save_world(registry, keyframe);
+        auto keyframe_size = static_cast<uint64_t>(keyframe.size());
+        archive(keyframe_size);
+        archive.write_array(keyframe.data(), keyframe.size());
+
+        // Observe what was saved without recording it again.
+        m_observer.set_active(false);
+
+        for (auto entity : registry.view<rigidbody_tag>()) {
+            if (!registry.any_of<paged_mesh_shape, heightfield_shape>(entity)) {
+                m_observer.observe(entity);
+            }
+        }
+
+        for (auto entity : registry.view<graph_edge>(entt::exclude<contact_manifold>)) {
+            if (constraint_bodies_observed(entity)) {
+                m_observer.observe(entity);
+            }
+        }
+
+        m_observer.set_active(true);
+        m_settings = capture_settings::from(settings);
+        write_settings(header.start_time);
+
+        m_connections.push_back(registry.on_construct<graph_node>().connect<&world_capture::on_construct_graph_node>(*this));
+        m_connections.push_back(registry.on_destroy<graph_node>().connect<&world_capture::on_destroy_shared>(*this));
+        m_connections.push_back(registry.on_construct<graph_edge>().connect<&world_capture::on_construct_graph_edge>(*this));
+        m_connections.push_back(registry.on_destroy<graph_edge>().connect<&world_capture::on_destroy_shared>(*this));
+    }
+
+    void record_call(capture_record_type type, double time, uint32_t num_steps) {
+        write_pending(time);
+        write_record(type, time);
+
+        if (type == capture_record_type::batch_step) {
+            auto archive = memory_output_archive(m_data);
+            archive(num_steps);
+        }
+
+        suspend(time);
+    }
+
+    void record_packet(entt::entity client_entity, const packet::edyn_packet &packet) {
+        auto &settings = m_registry->ctx().get<edyn::settings>();
+        auto time = (*settings.time_func)();
+        write_pending(time);
+        write_record(capture_record_type::packet, time);
+
+        auto archive = memory_output_archive(m_data);
+        archive(client_entity);
+        archive(packet);
+
+        suspend(time);
+    }
+
+    void resume() {
+        if (!m_suspended) {
+            return;
+        }
+
+        if (!m_created.empty()) {
+            write_record(capture_record_type::created_entities, m_suspend_time);
+            auto archive = memory_output_archive(m_data);
+            auto count = static_cast<uint32_t>(m_created.size());
+            archive(count);
+
+            for (auto entity : m_created) {
+                archive(entity);
+            }
+
+            m_created.clear();
+        }
+
+        m_suspended = false;
+        m_observer.set_active(true);
+    }
+
+    std::vector<uint8_t> finish() {
+        auto &settings = m_registry->ctx().get<edyn::settings>();
+        write_pending((*settings.time_func)());
+        return std::move(m_data);
+    }
+
+private:
+    void suspend(double time) {
+        m_observer.set_active(false);
+        m_suspended = true;
+        m_suspend_time = time;
+    }
+
+    bool constraint_bodies_observed(entt::entity entity) const {
+        auto &edge = m_registry->get<graph_edge>(entity);
+        auto [body0, body1] = m_registry->ctx().get<entity_graph>().edge_node_entities(edge.edge_index);
+        return m_observer.is_observed(body0) && m_observer.is_observed(body1);
+    }
+
+    void on_construct_graph_node(entt::registry &registry, entt::entity entity) {
+        if (m_suspended) {
+            m_created.push_back(entity);
+        }
+
+        if (!has_uncapturable_shape(registry, entity)) {
+            // Only inserts it in the set of observed entities while suspended.
+            m_observer.observe(entity);
+        }
+    }
+
+    void on_construct_graph_edge(entt::registry &registry, entt::entity entity) {
+        if (registry.any_of<contact_manifold>(entity)) {
+            return;
+        }
+
+        if (m_suspended) {
+            m_created.push_back(entity);
+        }
+
+        if (constraint_bodies_observed(entity)) {
+            m_observer.observe(entity);
+        }
+    }
+
+    void on_destroy_shared(entt::registry &registry, entt::entity entity) {
+        if (m_observer.is_observed(entity)) {
+            m_observer.unobserve(entity);
+        }
+    }
+
+    void write_record(capture_record_type type, double time) {
+        auto archive = memory_output_archive(m_data);
+        auto type_id = static_cast<uint8_t>(type);
+        archive(type_id, time);
+    }
+
+    void write_settings(double time) {
+        write_record(capture_record_type::settings, time);
+        auto archive = memory_output_archive(m_data);
+        archive(m_settings);
+    }
+
+    template<typename Component>
+    static bool write_component_operation(memory_output_archive &archive, const operation_base *op,
+                                          uint16_t index) {
+        if constexpr(is_capturable_v<Component>) {
+            auto type = static_cast<uint8_t>(op->operation_type());
+            archive(type, op->entity, index);
+
+            switch (op->operation_type()) {
+            case registry_operation_type::emplace:
+                archive(static_cast<const operation_emplace<Component> *>(op)->component);
+                break;
+            case registry_operation_type::replace:
+                archive(static_cast<const operation_replace<Component> *>(op)->component);
+                break;
+            default:
+                break;
+            }
+
+            return true;
+        } else {
+            return false;
+        }
+    }
+
+    template<typename... Components>
+    static bool write_operation(memory_output_archive &archive, const operation_base *op,
+                                [[maybe_unused]] std::tuple<Components...>) {
+        switch (op->operation_type()) {
+        case registry_operation_type::create:
+        case registry_operation_type::destroy: {
+            auto type = static_cast<uint8_t>(op->operation_type());
+            archive(type, op->entity);
+            return true;
+        }
+        case registry_operation_type::map_entity:
+            return false;
+        default:
+            break;
+        }
+
+        const auto id = op->payload_type_id();
+        auto index = uint16_t{0};
+        auto written = false;
+        ((entt::type_index<Components>::value() == id ?
+            (written = write_component_operation<Components>(archive, op, index), true) :
+            (++index, false)) || ...);
+        return written;
+    }
+
+    // Writes the changes made since the last record and the settings, if
+    // they changed.
+    void write_pending(double time) {
+        auto &settings = m_registry->ctx().get<edyn::settings>();
+
+        if (auto current = capture_settings::from(settings); !(current == m_settings)) {
+            m_settings = current;
+            write_settings(time);
+        }
+
+        m_observer.flush();
+
+        if (m_builder.empty()) {
+            return;
+        }
+
+        auto ops = m_builder.finish();
+        // Islands are assigned on replay, where bodies start awake.
+        ops.erase_payload<island_resident, sleeping_tag>();
+
+        write_record(capture_record_type::operations, time);
+        auto count_position = m_data.size();
+        auto count = uint32_t{0};
+        auto archive = memory_output_archive(m_data);
+        archive(count);
+
+        for (auto *op : ops.operations) {
+            if (write_operation(archive, op, shared_components_t{})) {
+                ++count;
+            }
+        }
+
+        std::memcpy(m_data.data() + count_position, &count, sizeof(count));
+        registry_operation_pool::global().release(std::move(ops));
+    }
+
+    entt::registry *m_registry;
+    std::vector<uint8_t> m_data;
+    capture_builder_t m_builder;
+    capture_observer_t m_observer;
+    std::vector<entt::scoped_connection> m_connections;
+    capture_settings m_settings;
+    std::vector<entt::entity> m_created;
+    double m_suspend_time {};
+    bool m_suspended {false};
+};
+
+void capture_call(entt::registry &registry, capture_record_type type, double time,
+                  uint32_t num_steps) {
+    if (auto *capture = registry.ctx().find<world_capture>()) {
+        capture->record_call(type, time, num_steps);
+    }
+}
+
+void capture_packet(entt::registry &registry, entt::entity client_entity,
+                    const packet::edyn_packet &packet) {
+    if (auto *capture = registry.ctx().find<world_capture>()) {
+        capture->record_packet(client_entity, packet);
+    }
+}
+
+void capture_resume(entt::registry &registry) {
+    if (auto *capture = registry.ctx().find<world_capture>()) {
+        capture->resume();
+    }
+}
+
+void deinit_capture(entt::registry &registry) {
+    registry.ctx().erase<world_capture>();
+}
+
+// Time returned by the time function of a world during a replay. It might be
+// read by the simulation worker in asynchronous mode.
+static std::atomic<double> replay_time_value {0};
+
+static double replay_time() {
+    return replay_time_value.load(std::memory_order_relaxed);
+}
+
+// Collects the entities created during a replayed call, to be matched with
+// the ones created during the same call when it was captured.
+struct replay_created_entities {
+    std::vector<entt::entity> entities;
+
+    void on_construct_graph_node(entt::registry &registry, entt::entity entity) {
+        entities.push_back(entity);
+    }
+
+    void on_construct_graph_edge(entt::registry &registry, entt::entity entity) {
+        if (!registry.any_of<contact_manifold>(entity)) {
+            entities.push_back(entity);
+        }
+    }
+};
+
+template<typename... Components>
+static bool read_operations(memory_input_archive &archive, capture_builder_t &builder,
+                            [[maybe_unused]] std::tuple<Components...> components) {
+    auto count = uint32_t{};
+    archive(count);
+
+    for (uint32_t i = 0; i < count && !archive.failed(); ++i) {
+        auto type_id = uint8_t{};
+        auto entity = entt::entity{};
+        archive(type_id, entity);
+
+        switch (static_cast<registry_operation_type>(type_id)) {
+        case registry_operation_type::create:
+            builder.create(entity);
+            continue;
+        case registry_operation_type::destroy:
+            builder.destroy(entity);
+            continue;
+        case registry_operation_type::emplace:
+        case registry_operation_type::replace:
+        case registry_operation_type::remove:
+            break;
+        default:
+            return false;
+        }
+
+        auto index = uint16_t{};
+        archive(index);
+
+        if (archive.failed() || index >= sizeof...(Components)) {
+            return false;
+        }
+
+        auto valid = true;
+
+        visit_tuple(components, index, [&](auto &&c) {
+            using Component = std::decay_t<decltype(c)>;
+
+            if constexpr(is_capturable_v<Component>) {
+                switch (static_cast<registry_operation_type>(type_id)) {
+                case registry_operation_type::emplace: {
+                    auto comp = Component{};
+                    archive(comp);
+                    builder.emplace<Component>(entity, comp);
+                    break;
+                }
+                case registry_operation_type::replace: {
+                    auto comp = Component{};
+                    archive(comp);
+                    builder.replace<Component>(entity, comp);
+                    break;
+                }
+                default:
+                    builder.remove<Component>(entity);
+                    break;
+                }
+            } else {
+                valid = false;
+            }
+        });
+
+        if (!valid) {
+            return false;
+        }
+    }
+
+    return !archive.failed();
+}
+
+// Executes operations in the same manner as `sharded_world::migrate_island`,
+// inserting nodes and edges in the entity graph for the new bodies and
+// constraints.
+static void execute_operations(entt::registry &registry, entity_map &emap, registry_operation &ops) {
+    auto &graph = registry.ctx().get<entity_graph>();
+
+    ops.execute(registry, emap, [&](operation_base *op) {
+        if (op->operation_type() != registry_operation_type::emplace || !emap.contains(op->entity)) {
+            return;
+        }
+
+        auto local_entity = emap.at(op->entity);
+
+        if (!registry.valid(local_entity)) {
+            return;
+        }
+
+        if (op->payload_type_any_of<rigidbody_tag, external_tag>() && !registry.any_of<graph_node>(local_entity)) {
+            auto non_connecting = !registry.any_of<procedural_tag>(local_entity);
+            auto node_index = graph.insert_node(local_entity, non_connecting);
+            registry.emplace<graph_node>(local_entity, node_index);
+
+            if (non_connecting) {
+                registry.emplace<multi_island_resident>(local_entity);
+            } else {
+                registry.emplace<island_resident>(local_entity);
+            }
+        }
+
+        if (op->payload_type_any_of(constraints_tuple) || op->payload_type_any_of<null_constraint>()) {
+            if (!registry.any_of<graph_edge>(local_entity)) {
+                create_graph_edge_for_constraints(registry, local_entity, graph, constraints_tuple);
+                create_graph_edge_for_constraint<null_constraint>(registry, local_entity, graph);
+                registry.emplace<island_resident>(local_entity);
+            }
+        }
+    });
+}
+
+}
+
+namespace edyn {
+
+void begin_capture(entt::registry &registry) {
+    EDYN_ASSERT(!is_capturing(registry));
+    registry.ctx().emplace<internal::world_capture>(registry);
+}
+
+bool is_capturing(const entt::registry &registry) {
+    return registry.ctx().contains<internal::world_capture>();
+}
+
+void end_capture(entt::registry &registry, std::vector<uint8_t> &buffer) {
+    auto *capture = registry.ctx().find<internal::world_capture>();
+
+    if (capture == nullptr) {
+        return;
+    }
+
+    auto data = capture->finish();
+    registry.ctx().erase<internal::world_capture>();
+    buffer.insert(buffer.end(), data.begin(), data.end());
+}
+
+bool end_capture(entt::registry &registry, const std::string &path) {
+    auto buffer = std::vector<uint8_t>{};
+    end_capture(registry, buffer);
+
+    auto file = std::ofstream(path, std::ios::binary | std::ios::out);
+
+    if (!file.good()) {
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char *>(buffer.data()), buffer.size());
+
+    return file.good();
+}
+
+bool read_capture_header(const uint8_t *data, size_t size, world_capture_header &header) {
+    auto archive = memory_input_archive(data, size);
+    archive(header);
+
+    return !archive.failed() &&
+           header.magic == world_capture_magic &&
+           header.version == world_capture_version &&
+           header.scalar_size == sizeof(scalar);
+}
+
+bool replay_capture(entt::registry &registry, const uint8_t *data, size_t size,
+                    world_replay_stats *stats) {
+    using namespace internal;
+
+    auto header = world_capture_header{};
+
+    if (!read_capture_header(data, size, header) ||
+        header.server != registry.ctx().contains<server_network_context>()) {
+        return false;
+    }
+
+    auto archive = memory_input_archive(data, size);
+    archive(header);
+
+    auto keyframe_size = uint64_t{};
+    archive(keyframe_size);
+
+    if (archive.failed() || keyframe_size > size) {
+        return false;
+    }
+
+    // Copied into a separate buffer since the alignment of the saved world is
+    // relative to its start.
+    auto keyframe = std::vector<uint8_t>(keyframe_size);
+    archive.read_array(keyframe.data(), keyframe.size());
+
+    // Maps entities in the capture into the registry.
+    auto emap = entity_map{};
+
+    if (archive.failed() ||
+        !load_world(registry, keyframe.data(), keyframe.size(), nullptr, &emap)) {
+        return false;
+    }
+
+    auto &settings = registry.ctx().get<edyn::settings>();
+    auto *time_func = settings.time_func;
+    const auto time_offset = (*time_func)() - header.start_time;
+    replay_time_value.store(header.start_time + time_offset, std::memory_order_relaxed);
+    settings.time_func = &replay_time;
+    refresh_settings(registry);
+
+    auto builder = capture_builder_t(registry);
+    auto clients = entity_map{};
+    auto created = replay_created_entities{};
+    auto connections = std::vector<entt::scoped_connection>{};
+    connections.push_back(registry.on_construct<graph_node>().connect<&replay_created_entities::on_construct_graph_node>(created));
+    connections.push_back(registry.on_construct<graph_edge>().connect<&replay_created_entities::on_construct_graph_edge>(created));
+
+    auto replay_stats = world_replay_stats{};
+    auto valid = true;
+
+    while (valid && !archive.eof()) {
+        auto type_id = uint8_t{};
+        auto time = double{};
+        archive(type_id, time);
+
+        if (archive.failed()) {
+            valid = false;
+            break;
+        }
+
+        replay_time_value.store(time + time_offset, std::memory_order_relaxed);
+        replay_stats.captured_duration = time - header.start_time;
+
+        // Entities in the operations executed next were created outside of
+        // replayed calls.
+        if (static_cast<capture_record_type>(type_id) != capture_record_type::created_entities) {
+            created.entities.clear();
+        }
+
+        switch (static_cast<capture_record_type>(type_id)) {
+        case capture_record_type::operations: {
+            valid = read_operations(archive, builder, shared_components_t{});
+
+            if (valid) {
+                auto ops = builder.finish();
+                replay_stats.num_operations += static_cast<uint32_t>(ops.operations.size());
+                execute_operations(registry, emap, ops);
+                registry_operation_pool::global().release(std::move(ops));
+            }
+            break;
+        }
+        case capture_record_type::settings: {
+            auto captured = capture_settings{};
+            archive(captured);
+
+            if (archive.failed()) {
+                valid = false;
+                break;
+            }
+
+            captured.apply(settings);
+            refresh_settings(registry);
+
+            if (captured.paused != is_paused(registry)) {
+                set_paused(registry, captured.paused);
+            }
+            break;
+        }
+        case capture_record_type::update:
+            update(registry, time + time_offset);
+            ++replay_stats.num_updates;
+            break;
+        case capture_record_type::step:
+            step_simulation(registry, time + time_offset);
+            ++replay_stats.num_steps;
+            break;
+        case capture_record_type::batch_step: {
+            auto num_steps = uint32_t{};
+            archive(num_steps);
+
+            if (archive.failed()) {
+                valid = false;
+                break;
+            }
+
+            batch_step_simulation(registry, num_steps);
+            replay_stats.num_steps += num_steps;
+            break;
+        }
+        case capture_record_type::packet: {
+            auto client_entity = entt::entity{};
+            auto packet = packet::edyn_packet{};
+            archive(client_entity, packet);
+
+            if (archive.failed()) {
+                valid = false;
+                break;
+            }
+
+            if (!clients.contains(client_entity)) {
+                clients.insert(client_entity, server_make_client(registry));
+            }
+
+            server_receive_packet(registry, clients.at(client_entity), packet);
+            ++replay_stats.num_packets;
+            break;
+        }
+        case capture_record_type::network_update:
+            update_network_server(registry);
+            break;
+        case capture_record_type::created_entities: {
+            auto count = uint32_t{};
+            archive(count);
+
+            for (uint32_t i = 0; i < count && !archive.failed(); ++i) {
+                auto entity = entt::entity{};
+                archive(entity);
+
+                // The same call is expected to create the same entities in
+                // the same order.
+                if (i < created.entities.size() && !emap.contains(entity) &&
+                    !emap.contains_local(created.entities[i])) {
+                    emap.insert(entity, created.entities[i]);
+                }
+            }
+
+            valid = !archive.failed();
+            created.entities.clear();
+            break;
+        }
+        default:
+            valid = false;
+            break;
+        }
+    }
+
+    settings.time_func = time_func;
+    refresh_settings(registry);
+
+    if (stats) {
+        *stats = replay_stats;
+    }
+
+    return valid;
+}
+
+bool replay_capture(entt::registry &registry, const std::string &path,
+                    world_replay_stats *stats) {
+    auto file = mapped_file{};
+
+    if (!file.open(path)) {
+        return false;
+    }
+
+    return replay_capture(registry, file.data(), file.size(), stats);
+}
+
+}
@@ -1,5 +1,9 @@
 #include "../common/common.hpp"
 #include "edyn/collision/should_collide.hpp"
+#include "edyn/collision/broadphase.hpp"
+#include "edyn/collision/contact_manifold_map.hpp"
+#include "edyn/comp/island.hpp"
+#include "edyn/comp/tag.hpp"
 
 TEST(test_broadphase, collision_filtering) {
     entt::registry registry;
@@ -32,3 +36,192 @@ TEST(test_broadphase, collision_filtering) {
 
     edyn::detach(registry);
 }
+
+TEST(test_broadphase, pending_pair_without_moving) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+
+    // Close enough for their inflated AABBs to overlap, but not intersecting.
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::box_shape{0.5, 0.5, 0.5};
+    auto first = edyn::make_rigidbody(registry, def);
+    def.position = {1.1, 0, 0};
+    auto second = edyn::make_rigidbody(registry, def);
+
+    auto &bphase = registry.ctx().get<edyn::broadphase>();
+    auto &manifold_map = registry.ctx().get<edyn::contact_manifold_map>();
+    bphase.update(false);
+    ASSERT_FALSE(manifold_map.contains(first, second));
+
+    // Move within the inflated AABB. The trees are not queried again but the
+    // pending pair is found to be intersecting now.
+    auto &aabb = registry.get<edyn::AABB>(second);
+    aabb.min.x -= edyn::scalar(0.09);
+    aabb.max.x -= edyn::scalar(0.09);
+    bphase.update(false);
+    ASSERT_TRUE(manifold_map.contains(first, second));
+
+    edyn::detach(registry);
+}
+
+TEST(test_broadphase, collision_filter_change) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::box_shape{0.5, 0.5, 0.5};
+    def.collision_group = 0x1;
+    def.collision_mask = ~0x2ull;
+    auto first = edyn::make_rigidbody(registry, def);
+    def.position = {0.9, 0, 0};
+    def.collision_group = 0x2;
+    def.collision_mask = ~0x1ull;
+    auto second = edyn::make_rigidbody(registry, def);
+
+    auto &bphase = registry.ctx().get<edyn::broadphase>();
+    auto &manifold_map = registry.ctx().get<edyn::contact_manifold_map>();
+    bphase.update(false);
+    ASSERT_FALSE(manifold_map.contains(first, second));
+
+    // The pair is found once the filters accept each other, without moving.
+    registry.patch<edyn::collision_filter>(second, [](auto &filter) {
+        filter.mask = edyn::collision_filter::all_groups;
+    });
+    registry.patch<edyn::collision_filter>(first, [](auto &filter) {
+        filter.mask = edyn::collision_filter::all_groups;
+    });
+    bphase.update(false);
+    ASSERT_TRUE(manifold_map.contains(first, second));
+
+    edyn::detach(registry);
+}
+
+TEST(test_broadphase, sweep_and_prune) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    config.broadphase_algorithm = edyn::broadphase_algorithm::sweep_and_prune;
+    edyn::attach(registry, config);
+
+    auto floor_def = edyn::rigidbody_def{};
+    floor_def.kind = edyn::rigidbody_kind::rb_static;
+    floor_def.shape = edyn::box_shape{10, 0.5, 10};
+    floor_def.position = {0, -0.5, 0};
+    auto floor = edyn::make_rigidbody(registry, floor_def);
+
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::box_shape{0.5, 0.5, 0.5};
+    def.position = {0, 0.5, 0};
+    auto first = edyn::make_rigidbody(registry, def);
+    def.position = {0.9, 0.5, 0};
+    auto second = edyn::make_rigidbody(registry, def);
+    def.position = {5, 0.5, 0};
+    auto third = edyn::make_rigidbody(registry, def);
+
+    auto &bphase = registry.ctx().get<edyn::broadphase>();
+    auto &manifold_map = registry.ctx().get<edyn::contact_manifold_map>();
+    bphase.update(false);
+    ASSERT_TRUE(manifold_map.contains(first, second));
+    ASSERT_TRUE(manifold_map.contains(first, floor));
+    ASSERT_TRUE(manifold_map.contains(third, floor));
+    ASSERT_FALSE(manifold_map.contains(first, third));
+    ASSERT_FALSE(manifold_map.contains(second, third));
+
+    // Move the third box next to the second.
+    auto &aabb = registry.get<edyn::AABB>(third);
+    aabb.min.x -= edyn::scalar(3.2);
+    aabb.max.x -= edyn::scalar(3.2);
+    bphase.update(false);
+    ASSERT_TRUE(manifold_map.contains(second, third));
+
+    edyn::detach(registry);
+}
+
+TEST(test_broadphase, linear_bvh) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    config.broadphase_algorithm = edyn::broadphase_algorithm::linear_bvh;
+    edyn::attach(registry, config);
+
+    auto floor_def = edyn::rigidbody_def{};
+    floor_def.kind = edyn::rigidbody_kind::rb_static;
+    floor_def.shape = edyn::box_shape{10, 0.5, 10};
+    floor_def.position = {0, -0.5, 0};
+    auto floor = edyn::make_rigidbody(registry, floor_def);
+
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::box_shape{0.5, 0.5, 0.5};
+    def.position = {0, 0.5, 0};
+    auto first = edyn::make_rigidbody(registry, def);
+    def.position = {0.9, 0.5, 0};
+    auto second = edyn::make_rigidbody(registry, def);
+    def.position = {5, 0.5, 0};
+    auto third = edyn::make_rigidbody(registry, def);
+
+    auto &bphase = registry.ctx().get<edyn::broadphase>();
+    auto &manifold_map = registry.ctx().get<edyn::contact_manifold_map>();
+    bphase.update(false);
+    ASSERT_TRUE(manifold_map.contains(first, second));
+    ASSERT_TRUE(manifold_map.contains(first, floor));
+    ASSERT_TRUE(manifold_map.contains(third, floor));
+    ASSERT_FALSE(manifold_map.contains(first, third));
+    ASSERT_FALSE(manifold_map.contains(second, third));
+
+    // Move the third box next to the second.
+    auto &aabb = registry.get<edyn::AABB>(third);
+    aabb.min.x -= edyn::scalar(3.2);
+    aabb.max.x -= edyn::scalar(3.2);
+    bphase.update(false);
+    ASSERT_TRUE(manifold_map.contains(second, third));
+
+    edyn::detach(registry);
+}
+
+TEST(test_broadphase, sleeping_island_tree) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+
+    auto island_entity = registry.create();
+    registry.emplace<edyn::island_AABB>(island_entity, edyn::island_AABB{{{0, 0, 0}, {1, 1, 1}}});
+
+    auto &bphase = registry.ctx().get<edyn::broadphase>();
+    auto query_aabb = edyn::AABB{{0.5, 0.5, 0.5}, {2, 2, 2}};
+    auto count = [&](auto query) {
+        size_t num_islands = 0;
+        query(query_aabb, [&](entt::entity entity) {
+            ASSERT_EQ(entity, island_entity);
+            ++num_islands;
+        });
+        return num_islands;
+    };
+    auto count_all = [&] { return count([&](auto &&... args) { bphase.query_islands(args...); }); };
+    auto count_awake = [&] { return count([&](auto &&... args) { bphase.query_awake_islands(args...); }); };
+    auto count_sleeping = [&] { return count([&](auto &&... args) { bphase.query_sleeping_islands(args...); }); };
+
+    ASSERT_EQ(count_all(), 1);
+    ASSERT_EQ(count_awake(), 1);
+    ASSERT_EQ(count_sleeping(), 0);
+
+    // The island moves to the sleeping tree and back as it falls asleep and
+    // wakes up.
+    registry.emplace<edyn::sleeping_tag>(island_entity);
+    ASSERT_EQ(count_all(), 1);
+    ASSERT_EQ(count_awake(), 0);
+    ASSERT_EQ(count_sleeping(), 1);
+
+    registry.remove<edyn::sleeping_tag>(island_entity);
+    ASSERT_EQ(count_awake(), 1);
+    ASSERT_EQ(count_sleeping(), 0);
+
+    registry.destroy(island_entity);
+    ASSERT_EQ(count_all(), 0);
+
+    edyn::detach(registry);
+}
@@ -0,0 +1,115 @@
+#include "../common/common.hpp"
+#include "edyn/collision/broadphase.hpp"
+#include "edyn/replication/entity_map.hpp"
+#include "edyn/simulation/broadphase_mirror.hpp"
+#include <algorithm>
+
+class test_broadphase_mirror : public ::testing::Test {
+protected:
+    void SetUp() override {
+        auto config = edyn::init_config{};
+        config.execution_mode = edyn::execution_mode::sequential;
+        edyn::attach(registry, config);
+        edyn::set_paused(registry, true);
+
+        auto def = edyn::rigidbody_def{};
+        def.shape = edyn::sphere_shape{0.5};
+        def.gravity = edyn::vector3_zero;
+        sphere = edyn::make_rigidbody(registry, def);
+
+        // Body which does not exist in the main registry.
+        def.position = {0, 5, 0};
+        unmapped = edyn::make_rigidbody(registry, def);
+
+        auto box_def = edyn::rigidbody_def{};
+        box_def.kind = edyn::rigidbody_kind::rb_static;
+        box_def.shape = edyn::box_shape{0.5, 0.5, 0.5};
+        box_def.position = {5, 0, 0};
+        box = edyn::make_rigidbody(registry, box_def);
+
+        edyn::step_simulation(registry);
+
+        main_sphere = main_registry.create();
+        main_box = main_registry.create();
+        emap.insert(main_sphere, sphere);
+        emap.insert(main_box, box);
+    }
+
+    void TearDown() override {
+        edyn::detach(registry);
+    }
+
+    std::vector<entt::entity> raycast(edyn::vector3 p0, edyn::vector3 p1) const {
+        auto result = std::vector<entt::entity>{};
+        mirror.raycast(p0, p1, [&](entt::entity entity) {
+            result.push_back(entity);
+        });
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    entt::registry registry;
+    entt::registry main_registry;
+    edyn::entity_map emap;
+    edyn::broadphase_mirror mirror;
+    entt::entity sphere, unmapped, box;
+    entt::entity main_sphere, main_box;
+};
+
+TEST_F(test_broadphase_mirror, queries_report_main_entities) {
+    auto &bphase = registry.ctx().get<edyn::broadphase>();
+    mirror.write(bphase, emap);
+    ASSERT_TRUE(mirror.read());
+
+    auto hits = raycast({-2, 0, 0}, {10, 0, 0});
+    auto expected = std::vector<entt::entity>{main_sphere, main_box};
+    std::sort(expected.begin(), expected.end());
+    ASSERT_EQ(hits, expected);
+
+    // The unmapped body is in the tree but it's not reported.
+    auto procedural = std::vector<entt::entity>{};
+    mirror.query_procedural({{-10, -10, -10}, {10, 10, 10}}, [&](entt::entity entity) {
+        procedural.push_back(entity);
+    });
+    ASSERT_EQ(procedural, std::vector<entt::entity>{main_sphere});
+
+    auto non_procedural = std::vector<entt::entity>{};
+    mirror.query_non_procedural({{4, -1, -1}, {6, 1, 1}}, [&](entt::entity entity) {
+        non_procedural.push_back(entity);
+    });
+    ASSERT_EQ(non_procedural, std::vector<entt::entity>{main_box});
+
+    // Nothing new until the next write.
+    ASSERT_FALSE(mirror.read());
+}
+
+TEST_F(test_broadphase_mirror, follows_moved_bodies) {
+    auto &bphase = registry.ctx().get<edyn::broadphase>();
+    mirror.write(bphase, emap);
+    mirror.read();
+    ASSERT_TRUE(raycast({-2, 3, 0}, {2, 3, 0}).empty());
+
+    registry.patch<edyn::position>(sphere, [](auto &pos) { pos = {0, 3, 0}; });
+    edyn::step_simulation(registry);
+    mirror.write(bphase, emap);
+
+    // The trees previously taken are queried until the next read.
+    ASSERT_TRUE(raycast({-2, 3, 0}, {2, 3, 0}).empty());
+    ASSERT_TRUE(mirror.read());
+    ASSERT_EQ(raycast({-2, 3, 0}, {2, 3, 0}), std::vector<entt::entity>{main_sphere});
+}
+
+TEST_F(test_broadphase_mirror, origin_shift_not_yet_applied) {
+    auto &bphase = registry.ctx().get<edyn::broadphase>();
+    mirror.write(bphase, emap);
+
+    // The main thread moved its origin after the trees were published, thus
+    // the sphere, which is at the origin in the worker, is at -10 in the main
+    // thread.
+    auto shifts = edyn::origin_shift_history{};
+    shifts.push({10, 0, 0});
+    mirror.read(&shifts);
+
+    ASSERT_EQ(raycast({-12, 0, 0}, {-8, 0, 0}), std::vector<entt::entity>{main_sphere});
+    ASSERT_TRUE(raycast({-2, 0, 0}, {2, 0, 0}).empty());
+}
@@ -0,0 +1,129 @@
+#include "../common/common.hpp"
+#include "edyn/collision/collide_batch.hpp"
+#include "edyn/math/constants.hpp"
+#include "edyn/math/quaternion.hpp"
+#include <random>
+
+// Runs batches of random pairs through `collide_batch` and through the
+// regular `collide` and checks that both produce the same contact points.
+template<typename ShapeAType, typename ShapeBType>
+void compare_with_scalar(const std::vector<ShapeAType> &shapesA, const std::vector<ShapeBType> &shapesB,
+                         edyn::scalar spread, unsigned num_batches) {
+    auto rng = std::mt19937(1234);
+    auto dist = std::uniform_real_distribution<edyn::scalar>(-1, 1);
+    auto random_vector = [&]() { return edyn::vector3{dist(rng), dist(rng), dist(rng)}; };
+    auto random_orientation = [&]() {
+        auto axis = random_vector();
+        axis = edyn::length_sqr(axis) > EDYN_EPSILON ? edyn::normalize(axis) : edyn::vector3_x;
+        return edyn::quaternion_axis_angle(axis, dist(rng) * edyn::pi);
+    };
+
+    unsigned num_hits = 0;
+
+    for (unsigned n = 0; n < num_batches; ++n) {
+        edyn::collide_batch_shapes<ShapeAType> batchA;
+        edyn::collide_batch_shapes<ShapeBType> batchB;
+        edyn::collide_batch_contexts ctx;
+        edyn::collide_batch_results results;
+
+        for (size_t lane = 0; lane < edyn::collide_batch_size; ++lane) {
+            batchA[lane] = &shapesA[(n + lane) % shapesA.size()];
+            batchB[lane] = &shapesB[(n * 3 + lane) % shapesB.size()];
+            ctx[lane] = {};
+            ctx[lane].posA = random_vector() * spread;
+            ctx[lane].ornA = random_orientation();
+            ctx[lane].posB = random_vector() * spread;
+            ctx[lane].ornB = random_orientation();
+            ctx[lane].threshold = edyn::scalar(0.02);
+        }
+
+        edyn::collide_batch(batchA, batchB, ctx, results);
+
+        for (size_t lane = 0; lane < edyn::collide_batch_size; ++lane) {
+            auto expected = edyn::collision_result{};
+            edyn::collide(*batchA[lane], *batchB[lane], ctx[lane], expected);
+            auto &result = results[lane];
+            ASSERT_EQ(result.num_points, expected.num_points);
+            num_hits += result.num_points > 0;
+
+            for (size_t i = 0; i < result.num_points; ++i) {
+                auto &cp = result.point[i];
+                auto &ep = expected.point[i];
+                ASSERT_NEAR(edyn::distance(cp.pivotA, ep.pivotA), 0, 1e-4);
+                ASSERT_NEAR(edyn::distance(cp.pivotB, ep.pivotB), 0, 1e-4);
+                ASSERT_NEAR(edyn::distance(cp.normal, ep.normal), 0, 1e-4);
+                ASSERT_NEAR(cp.distance, ep.distance, 1e-4);
+                ASSERT_EQ(cp.normal_attachment, ep.normal_attachment);
+                ASSERT_EQ(cp.featureA.has_value(), ep.featureA.has_value());
+                ASSERT_EQ(cp.featureB.has_value(), ep.featureB.has_value());
+            }
+        }
+    }
+
+    // Make sure the test actually covers intersecting pairs.
+    ASSERT_GT(num_hits, 0);
+}
+
+static std::vector<edyn::plane_shape> make_planes() {
+    return {
+        {edyn::vector3_y, 0},
+        {edyn::vector3_x, edyn::scalar(0.3)},
+        {edyn::normalize(edyn::vector3{1, 1, -1}), edyn::scalar(-0.2)}
+    };
+}
+
+TEST(test_collide_batch, sphere_sphere) {
+    auto spheres = std::vector<edyn::sphere_shape>{{0.5}, {0.3}, {0.8}};
+    compare_with_scalar(spheres, spheres, 1, 64);
+}
+
+TEST(test_collide_batch, sphere_sphere_coincident) {
+    auto sphere = edyn::sphere_shape{0.5};
+    edyn::collide_batch_shapes<edyn::sphere_shape> shapes;
+    edyn::collide_batch_contexts ctx;
+    edyn::collide_batch_results results;
+
+    for (size_t lane = 0; lane < edyn::collide_batch_size; ++lane) {
+        shapes[lane] = &sphere;
+        ctx[lane] = {};
+        ctx[lane].posA = ctx[lane].posB = edyn::vector3_one;
+        ctx[lane].ornA = ctx[lane].ornB = edyn::quaternion_identity;
+        ctx[lane].threshold = edyn::scalar(0.02);
+    }
+
+    edyn::collide_batch(shapes, shapes, ctx, results);
+
+    for (auto &result : results) {
+        ASSERT_EQ(result.num_points, 1);
+        ASSERT_EQ(result.point[0].normal, edyn::vector3_x);
+    }
+}
+
+TEST(test_collide_batch, sphere_plane) {
+    auto spheres = std::vector<edyn::sphere_shape>{{0.5}, {0.3}, {0.8}};
+    auto planes = make_planes();
+    compare_with_scalar(spheres, planes, 1, 64);
+    compare_with_scalar(planes, spheres, 1, 64);
+}
+
+TEST(test_collide_batch, capsule_plane) {
+    auto capsules = std::vector<edyn::capsule_shape>{
+        {0.2, 0.5, edyn::coordinate_axis::x},
+        {0.3, 0.4, edyn::coordinate_axis::y},
+        {0.1, 0.6, edyn::coordinate_axis::z}
+    };
+    auto planes = make_planes();
+    compare_with_scalar(capsules, planes, 1, 64);
+    compare_with_scalar(planes, capsules, 1, 64);
+}
+
+TEST(test_collide_batch, box_plane) {
+    auto boxes = std::vector<edyn::box_shape>{
+        {edyn::vector3{0.5, 0.5, 0.5}},
+        {edyn::vector3{0.2, 0.7, 0.3}},
+        {edyn::vector3{1.0, 0.1, 0.4}}
+    };
+    auto planes = make_planes();
+    compare_with_scalar(boxes, planes, 1, 64);
+    compare_with_scalar(planes, boxes, 1, 64);
+}
@@ -1,12 +1,15 @@
 #include "../common/common.hpp"
 #include "edyn/collision/collision_result.hpp"
+#include "edyn/collision/compound_pair_cache.hpp"
 #include "edyn/math/constants.hpp"
+#include "edyn/math/math.hpp"
 #include "edyn/math/quaternion.hpp"
 #include "edyn/math/vector3.hpp"
 #include "edyn/shapes/convex_mesh.hpp"
 #include "edyn/shapes/cylinder_shape.hpp"
 #include "edyn/shapes/polyhedron_shape.hpp"
 #include "edyn/util/shape_util.hpp"
+#include "edyn/util/aabb_util.hpp"
 #include <edyn/collision/collide.hpp>
 #include <memory>
 
@@ -489,3 +492,395 @@ TEST(test_collision, collide_cylinder_box_face_face) {
         ASSERT_TRUE(containsB);
     }
 }
+
+static void assert_same_result(const edyn::collision_result &a, const edyn::collision_result &b) {
+    ASSERT_EQ(a.num_points, b.num_points);
+
+    for (size_t i = 0; i < a.num_points; ++i) {
+        ASSERT_SCALAR_EQ(a.point[i].distance, b.point[i].distance);
+        ASSERT_LT(edyn::distance_sqr(a.point[i].normal, b.point[i].normal), EDYN_EPSILON);
+        ASSERT_LT(edyn::distance_sqr(a.point[i].pivotA, b.point[i].pivotA), EDYN_EPSILON);
+        ASSERT_LT(edyn::distance_sqr(a.point[i].pivotB, b.point[i].pivotB), EDYN_EPSILON);
+    }
+}
+
+TEST(test_collision, collide_polyhedron_polyhedron_sat_cache) {
+    auto mesh = std::make_shared<edyn::convex_mesh>();
+    edyn::make_box_mesh({0.5, 0.5, 0.5}, mesh->vertices, mesh->indices, mesh->faces);
+    mesh->initialize();
+
+    auto ornB = edyn::quaternion_axis_angle({0, 1, 0}, edyn::to_radians(30));
+    auto rotatedA = edyn::make_rotated_mesh(*mesh);
+    auto rotatedB = edyn::make_rotated_mesh(*mesh, ornB);
+
+    auto polyA = edyn::polyhedron_shape{};
+    polyA.mesh = mesh;
+    polyA.rotated = &rotatedA;
+    auto polyB = polyA;
+    polyB.rotated = &rotatedB;
+
+    auto cache = edyn::separating_axis_cache{};
+    auto ctx = edyn::collision_context{};
+    ctx.posA = edyn::vector3_zero;
+    ctx.ornA = edyn::quaternion_identity;
+    ctx.posB = edyn::vector3{0, 2, 0};
+    ctx.ornB = ornB;
+    ctx.threshold = 0.02;
+
+    auto collide_both = [&]() {
+        auto uncached_ctx = ctx;
+        auto expected = edyn::collision_result{};
+        edyn::collide(polyA, polyB, uncached_ctx, expected);
+
+        auto cached_ctx = ctx;
+        cached_ctx.sat_cache = &cache;
+        auto result = edyn::collision_result{};
+        edyn::collide(polyA, polyB, cached_ctx, result);
+        assert_same_result(result, expected);
+        return result.num_points;
+    };
+
+    // Separated. The axis is cached and used for early rejection next.
+    ASSERT_EQ(collide_both(), 0);
+    ASSERT_EQ(cache.type, edyn::separating_axis_cache::axis_type::faceA);
+    ASSERT_EQ(collide_both(), 0);
+
+    // Touching. The cached axis no longer separates thus the full SAT runs
+    // and then the axis is reused while the transform does not change.
+    ctx.posB = edyn::vector3{0, 0.99, 0};
+    ASSERT_GT(collide_both(), 0);
+    ASSERT_GT(collide_both(), 0);
+
+    ctx.posB.y -= edyn::separating_axis_cache_position_tolerance / 2;
+    ASSERT_GT(collide_both(), 0);
+}
+
+TEST(test_collision, collide_polyhedron_box_sat_cache) {
+    auto mesh = std::make_shared<edyn::convex_mesh>();
+    edyn::make_box_mesh({0.5, 0.5, 0.5}, mesh->vertices, mesh->indices, mesh->faces);
+    mesh->initialize();
+
+    auto rotated = edyn::make_rotated_mesh(*mesh);
+    auto polyhedron = edyn::polyhedron_shape{};
+    polyhedron.mesh = mesh;
+    polyhedron.rotated = &rotated;
+    auto box = edyn::box_shape{edyn::vector3{0.4, 0.3, 0.2}};
+
+    auto cache = edyn::separating_axis_cache{};
+    auto ctx = edyn::collision_context{};
+    ctx.posA = edyn::vector3_zero;
+    ctx.ornA = edyn::quaternion_identity;
+    ctx.posB = edyn::vector3{1.5, 0.2, 0};
+    ctx.ornB = edyn::quaternion_axis_angle({0, 0, 1}, edyn::to_radians(45));
+    ctx.threshold = 0.02;
+
+    auto collide_both = [&]() {
+        auto expected = edyn::collision_result{};
+        edyn::collide(polyhedron, box, ctx, expected);
+
+        auto cached_ctx = ctx;
+        cached_ctx.sat_cache = &cache;
+        auto result = edyn::collision_result{};
+        edyn::collide(polyhedron, box, cached_ctx, result);
+        assert_same_result(result, expected);
+        return result.num_points;
+    };
+
+    ASSERT_EQ(collide_both(), 0);
+    ASSERT_NE(cache.type, edyn::separating_axis_cache::axis_type::none);
+    ASSERT_EQ(collide_both(), 0);
+
+    ctx.posB.x = 0.5 + (0.4 + 0.3) / std::sqrt(edyn::scalar(2)) - 0.01;
+    ASSERT_GT(collide_both(), 0);
+    ASSERT_GT(collide_both(), 0);
+}
+
+TEST(test_collision, rotated_mesh_orientation) {
+    auto mesh = edyn::convex_mesh{};
+    edyn::make_box_mesh({0.5, 1, 1.5}, mesh.vertices, mesh.indices, mesh.faces);
+    mesh.initialize();
+
+    auto orn = edyn::quaternion_axis_angle(edyn::normalize(edyn::vector3{1, 2, 3}), edyn::to_radians(40));
+    auto rotated = edyn::make_rotated_mesh(mesh, orn);
+    ASSERT_EQ(rotated.orientation, orn);
+
+    for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+        ASSERT_VECTOR3_EQ(rotated.vertices[i], edyn::rotate(orn, mesh.vertices[i]));
+    }
+
+    for (size_t i = 0; i < mesh.normals.size(); ++i) {
+        ASSERT_VECTOR3_EQ(rotated.normals[i], edyn::rotate(orn, mesh.normals[i]));
+    }
+}
+
+TEST(test_collision, collide_compound_compound_nearby_children) {
+    // Two rows of boxes where only the last box of A touches the first box
+    // of B.
+    auto compound = edyn::compound_shape{};
+    auto box = edyn::box_shape{edyn::vector3{0.5, 0.5, 0.5}};
+
+    for (int i = 0; i < 10; ++i) {
+        compound.add_shape(box, edyn::vector3{edyn::scalar(i * 2), 0, 0}, edyn::quaternion_identity);
+    }
+
+    compound.finish();
+
+    auto ctx = edyn::collision_context{};
+    ctx.posA = edyn::vector3{0, 0, 0};
+    ctx.ornA = edyn::quaternion_identity;
+    ctx.aabbA = edyn::shape_aabb(compound, ctx.posA, ctx.ornA);
+    ctx.posB = edyn::vector3{18, 1, 0};
+    ctx.ornB = edyn::quaternion_identity;
+    ctx.aabbB = edyn::shape_aabb(compound, ctx.posB, ctx.ornB);
+    ctx.threshold = 0.02;
+
+    auto result = edyn::collision_result{};
+    edyn::collide(compound, compound, ctx, result);
+    ASSERT_EQ(result.num_points, 4);
+
+    for (size_t i = 0; i < result.num_points; ++i) {
+        auto &point = result.point[i];
+        ASSERT_TRUE(point.featureA && point.featureB);
+        ASSERT_EQ(point.featureA->part, 9);
+        ASSERT_EQ(point.featureB->part, 0);
+        ASSERT_NEAR(point.distance, 0, EDYN_EPSILON);
+    }
+}
+
+TEST(test_collision, collide_compound_compound_cached_pairs) {
+    auto compound = edyn::compound_shape{};
+    auto box = edyn::box_shape{edyn::vector3{0.5, 0.5, 0.5}};
+
+    for (int i = 0; i < 4; ++i) {
+        compound.add_shape(box, edyn::vector3{edyn::scalar(i * 2), 0, 0}, edyn::quaternion_identity);
+    }
+
+    compound.finish();
+
+    auto cache = edyn::compound_pair_cache{};
+    auto ctx = edyn::collision_context{};
+    ctx.posA = edyn::vector3{0, 0, 0};
+    ctx.ornA = edyn::quaternion_identity;
+    ctx.aabbA = edyn::shape_aabb(compound, ctx.posA, ctx.ornA);
+    ctx.posB = edyn::vector3{0, 1, 0};
+    ctx.ornB = edyn::quaternion_identity;
+    ctx.aabbB = edyn::shape_aabb(compound, ctx.posB, ctx.ornB);
+    ctx.threshold = 0.02;
+    ctx.compound_cache = &cache;
+
+    auto result = edyn::collision_result{};
+    edyn::collide(compound, compound, ctx, result);
+    ASSERT_EQ(result.num_points, 4);
+    // Each box touches the box above it and none of its neighbors.
+    ASSERT_EQ(cache.entries.size(), 4);
+    ASSERT_NE(cache.find(2, 2), nullptr);
+    ASSERT_EQ(cache.find(2, 2)->num_points, 4);
+    ASSERT_EQ(cache.find(0, 3), nullptr);
+
+    // Move both compounds together. The points are taken from the cache and
+    // follow the compounds.
+    auto offset = edyn::vector3{3, 0, 0};
+    auto points_before = cache.points;
+    ctx.posA += offset;
+    ctx.posB += offset;
+    ctx.aabbA = edyn::shape_aabb(compound, ctx.posA, ctx.ornA);
+    ctx.aabbB = edyn::shape_aabb(compound, ctx.posB, ctx.ornB);
+
+    auto cached_result = edyn::collision_result{};
+    edyn::collide(compound, compound, ctx, cached_result);
+    ASSERT_EQ(cached_result.num_points, result.num_points);
+    ASSERT_EQ(cache.points.size(), points_before.size());
+
+    for (size_t i = 0; i < cache.points.size(); ++i) {
+        ASSERT_VECTOR3_EQ(cache.points[i].pivotA, points_before[i].pivotA);
+    }
+
+    for (size_t i = 0; i < cached_result.num_points; ++i) {
+        ASSERT_VECTOR3_EQ(cached_result.point[i].pivotA, result.point[i].pivotA);
+        ASSERT_VECTOR3_EQ(cached_result.point[i].normal, result.point[i].normal);
+        ASSERT_NEAR(cached_result.point[i].distance, result.point[i].distance, EDYN_EPSILON);
+    }
+
+    // Separate them. The pairs are collided again and dropped.
+    ctx.posB += edyn::vector3{0, 1, 0};
+    ctx.aabbB = edyn::shape_aabb(compound, ctx.posB, ctx.ornB);
+    auto separated_result = edyn::collision_result{};
+    edyn::collide(compound, compound, ctx, separated_result);
+    ASSERT_EQ(separated_result.num_points, 0);
+    ASSERT_TRUE(cache.entries.empty());
+}
+
+// Prism with many sides along the y axis, with unit radius and half length.
+static void make_prism_mesh(uint32_t num_sides, edyn::convex_mesh &mesh) {
+    for (uint32_t i = 0; i < num_sides * 2; ++i) {
+        auto angle = edyn::pi2 * (i % num_sides) / num_sides;
+        auto y = i < num_sides ? edyn::scalar(-1) : edyn::scalar(1);
+        mesh.vertices.push_back({std::cos(angle), y, std::sin(angle)});
+    }
+
+    for (uint32_t i = 0; i < num_sides; ++i) {
+        mesh.indices.push_back(i);
+    }
+
+    for (uint32_t i = 0; i < num_sides; ++i) {
+        mesh.indices.push_back(num_sides * 2 - 1 - i);
+    }
+
+    mesh.faces.insert(mesh.faces.end(), {0, num_sides, num_sides, num_sides});
+
+    for (uint32_t i = 0; i < num_sides; ++i) {
+        auto j = (i + 1) % num_sides;
+        mesh.faces.insert(mesh.faces.end(), {uint32_t(mesh.indices.size()), 4});
+        mesh.indices.insert(mesh.indices.end(), {num_sides + i, num_sides + j, j, i});
+    }
+
+    mesh.initialize();
+}
+
+TEST(test_collision, polyhedron_support_polygon_warm_start) {
+    // Prism with many sides so the support vertices are far apart in the
+    // vertex list.
+    auto mesh = edyn::convex_mesh{};
+    make_prism_mesh(48, mesh);
+
+    auto offset = edyn::vector3{1, 2, 3};
+    auto tolerance = edyn::scalar(0.01);
+    uint32_t vertex_idx {0};
+
+    for (auto i = 0; i < 200; ++i) {
+        auto angle = edyn::scalar(0.1) * i;
+        auto dir = edyn::normalize(edyn::vector3{std::cos(angle), std::sin(angle * 3) * edyn::scalar(0.3), std::sin(angle)});
+
+        auto proj = edyn::polyhedron_support_projection(mesh.vertices, mesh.neighbors_start, mesh.neighbor_indices, dir, vertex_idx);
+        ASSERT_SCALAR_EQ(proj, edyn::point_cloud_support_projection(mesh.vertices, dir));
+        ASSERT_SCALAR_EQ(edyn::dot(mesh.vertices[vertex_idx], dir), proj);
+
+        for (auto positive_side : {false, true}) {
+            auto projection = positive_side ?
+                -edyn::point_cloud_support_projection(mesh.vertices, -dir) + edyn::dot(offset, dir) :
+                proj + edyn::dot(offset, dir);
+
+            auto expected = edyn::point_cloud_support_polygon(
+                mesh.vertices.begin(), mesh.vertices.end(), offset,
+                dir, projection, positive_side, tolerance);
+            auto polygon = edyn::polyhedron_support_polygon(
+                mesh.vertices, mesh.neighbors_start, mesh.neighbor_indices, offset,
+                dir, projection, positive_side, tolerance, vertex_idx);
+
+            ASSERT_EQ(polygon.vertices, expected.vertices);
+            ASSERT_EQ(polygon.hull, expected.hull);
+        }
+    }
+}
+
+TEST(test_collision, collide_polyhedron_polyhedron_gjk) {
+    // Enough edges for GJK to be used instead of SAT.
+    auto mesh = std::make_shared<edyn::convex_mesh>();
+    make_prism_mesh(48, *mesh);
+    ASSERT_GT(mesh->num_edges() * mesh->num_edges(), edyn::polyhedron_sat_max_edge_pairs);
+
+    auto ornB = edyn::quaternion_axis_angle({0, 1, 0}, edyn::to_radians(10));
+    auto rotatedA = edyn::make_rotated_mesh(*mesh);
+    auto rotatedB = edyn::make_rotated_mesh(*mesh, ornB);
+
+    auto polyA = edyn::polyhedron_shape{};
+    polyA.mesh = mesh;
+    polyA.rotated = &rotatedA;
+    auto polyB = polyA;
+    polyB.rotated = &rotatedB;
+
+    auto cache = edyn::separating_axis_cache{};
+    auto ctx = edyn::collision_context{};
+    ctx.posA = edyn::vector3_zero;
+    ctx.ornA = edyn::quaternion_identity;
+    ctx.posB = edyn::vector3{0.3, 2.5, 0};
+    ctx.ornB = ornB;
+    ctx.threshold = 0.02;
+    ctx.sat_cache = &cache;
+
+    // Separated.
+    auto result = edyn::collision_result{};
+    edyn::collide(polyA, polyB, ctx, result);
+    ASSERT_EQ(result.num_points, 0);
+    ASSERT_GT(cache.simplex.size, 0);
+
+    // Cap of B resting on cap of A. Then again starting from the simplex of
+    // the previous step.
+    ctx.posB = edyn::vector3{0.3, 1.99, 0};
+
+    for (auto i = 0; i < 2; ++i) {
+        result = edyn::collision_result{};
+        edyn::collide(polyA, polyB, ctx, result);
+        ASSERT_EQ(result.num_points, edyn::max_contacts);
+
+        for (size_t j = 0; j < result.num_points; ++j) {
+            auto &pt = result.point[j];
+            ASSERT_NEAR(pt.normal.x, 0, 1e-3);
+            ASSERT_NEAR(pt.normal.y, -1, 1e-3);
+            ASSERT_NEAR(pt.normal.z, 0, 1e-3);
+            ASSERT_NEAR(pt.distance, -0.01, 1e-3);
+        }
+    }
+}
+
+static void make_test_plane_mesh(edyn::scalar extent, size_t num_vertices, edyn::scalar height,
+                                 bool flip, edyn::triangle_mesh::tree_type type,
+                                 edyn::triangle_mesh &trimesh) {
+    auto vertices = std::vector<edyn::vector3>{};
+    auto indices = std::vector<edyn::triangle_mesh::index_type>{};
+    edyn::make_plane_mesh(extent, extent, num_vertices, num_vertices, vertices, indices);
+
+    for (auto &v : vertices) {
+        v.y = height;
+    }
+
+    // Reverse winding so the normals point down.
+    if (flip) {
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            std::swap(indices[i + 1], indices[i + 2]);
+        }
+    }
+
+    trimesh.insert_vertices(vertices.begin(), vertices.end());
+    trimesh.insert_indices(indices.begin(), indices.end());
+    trimesh.initialize(type);
+}
+
+TEST(test_collision, collide_mesh_mesh) {
+    for (auto type : {edyn::triangle_mesh::tree_type::binary, edyn::triangle_mesh::tree_type::compact}) {
+        // Small mesh facing down slightly above a larger mesh facing up.
+        auto meshA = edyn::triangle_mesh{};
+        make_test_plane_mesh(1, 3, 0.01, true, type, meshA);
+        auto meshB = edyn::triangle_mesh{};
+        make_test_plane_mesh(10, 11, 0, false, edyn::triangle_mesh::tree_type::binary, meshB);
+
+        auto ctx = edyn::collision_context{};
+        ctx.posA = ctx.posB = edyn::vector3_zero;
+        ctx.ornA = ctx.ornB = edyn::quaternion_identity;
+        ctx.aabbA = meshA.get_aabb();
+        ctx.aabbB = meshB.get_aabb();
+        ctx.threshold = edyn::contact_breaking_threshold;
+
+        auto result = edyn::collision_result{};
+        edyn::collide(meshA, meshB, ctx, result);
+        ASSERT_GT(result.num_points, 0);
+
+        for (size_t i = 0; i < result.num_points; ++i) {
+            auto &pt = result.point[i];
+            ASSERT_NEAR(pt.normal.y, 1, 1e-4);
+            ASSERT_NEAR(pt.distance, 0.01, 1e-4);
+            ASSERT_NEAR(pt.pivotA.y, 0.01, 1e-4);
+            ASSERT_NEAR(pt.pivotB.y, 0, 1e-4);
+            ASSERT_LE(std::abs(pt.pivotA.x), 0.5 + 1e-4);
+            ASSERT_LE(std::abs(pt.pivotA.z), 0.5 + 1e-4);
+        }
+
+        // Far apart meshes do not collide.
+        auto meshC = edyn::triangle_mesh{};
+        make_test_plane_mesh(1, 3, 1, true, type, meshC);
+        ctx.aabbA = meshC.get_aabb();
+        auto far_result = edyn::collision_result{};
+        edyn::collide(meshC, meshB, ctx, far_result);
+        ASSERT_EQ(far_result.num_points, 0);
+    }
+}
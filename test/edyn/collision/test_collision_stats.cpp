@@ -0,0 +1,59 @@
+#include "../common/common.hpp"
+#include "edyn/collision/collision_stats.hpp"
+#include <numeric>
+
+TEST(test_collision_stats, sequential) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+
+    ASSERT_FALSE(edyn::get_collect_collision_stats(registry));
+    edyn::set_collect_collision_stats(registry, true);
+
+    auto floor_def = edyn::rigidbody_def{};
+    floor_def.kind = edyn::rigidbody_kind::rb_static;
+    floor_def.shape = edyn::plane_shape{{0, 1, 0}, 0};
+    edyn::make_rigidbody(registry, floor_def);
+
+    // Two separate stacks of two boxes.
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::box_shape{0.5, 0.5, 0.5};
+
+    for (int i = 0; i < 2; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            def.position = {edyn::scalar(i * 5), edyn::scalar(0.5 + j), 0};
+            edyn::make_rigidbody(registry, def);
+        }
+    }
+
+    edyn::set_paused(registry, true);
+    edyn::step_simulation(registry);
+
+    auto &stats = edyn::get_collision_stats(registry);
+    ASSERT_GT(stats.broadphase.num_moved_entities, 0);
+    ASSERT_GE(stats.broadphase.num_overlaps, stats.broadphase.num_moved_entities);
+    ASSERT_EQ(stats.broadphase.num_manifolds_created, 4);
+    ASSERT_EQ(stats.num_manifolds, 4);
+    ASSERT_GT(stats.num_points_created, 0);
+
+    edyn::step_simulation(registry);
+
+    // Manifolds whose bodies did not move relative to each other are skipped.
+    ASSERT_GT(stats.num_narrowphase_manifolds, 0);
+    ASSERT_LE(stats.num_narrowphase_manifolds, 4);
+    ASSERT_LE(stats.narrowphase_manifolds<edyn::box_shape, edyn::box_shape>(), 2);
+    ASSERT_EQ(stats.narrowphase_manifolds<edyn::box_shape, edyn::box_shape>() +
+              stats.narrowphase_manifolds<edyn::box_shape, edyn::plane_shape>() +
+              stats.narrowphase_manifolds<edyn::plane_shape, edyn::box_shape>(),
+              stats.num_narrowphase_manifolds);
+
+    // Each stack is an island with two nodes.
+    ASSERT_EQ(stats.num_awake_islands, 2);
+    ASSERT_EQ(stats.num_sleeping_islands, 0);
+    ASSERT_EQ(stats.island_size_histogram[1], 2);
+    ASSERT_EQ(std::accumulate(stats.island_size_histogram.begin(),
+                              stats.island_size_histogram.end(), size_t{0}), 2);
+
+    edyn::detach(registry);
+}
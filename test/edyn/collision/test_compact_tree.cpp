@@ -0,0 +1,111 @@
+#include "../common/common.hpp"
+#include "edyn/collision/dynamic_tree.hpp"
+#include "edyn/collision/compact_tree.hpp"
+#include <algorithm>
+
+static std::vector<entt::entity> query_dynamic_tree(const edyn::dynamic_tree &tree, const edyn::AABB &aabb) {
+    auto result = std::vector<entt::entity>{};
+    tree.query(aabb, [&](edyn::tree_node_id_t id) {
+        result.push_back(tree.get_node(id).entity);
+    });
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+static std::vector<entt::entity> query_compact_tree(const edyn::compact_tree &tree, const edyn::AABB &aabb) {
+    auto result = std::vector<entt::entity>{};
+    tree.query(aabb, [&](entt::entity entity) {
+        result.push_back(entity);
+    });
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+TEST(test_compact_tree, query_matches_dynamic_tree) {
+    auto tree = edyn::dynamic_tree{};
+    auto num_entities = 0;
+
+    for (int x = 0; x < 20; ++x) {
+        for (int y = 0; y < 3; ++y) {
+            for (int z = 0; z < 20; ++z) {
+                auto center = edyn::vector3{edyn::scalar(x * 1.7), edyn::scalar(y * 4.1), edyn::scalar(z * -2.3)};
+                auto half = edyn::vector3{0.3, edyn::scalar(0.1 + 0.2 * y), 0.6};
+                tree.create({center - half, center + half}, entt::entity(num_entities++));
+            }
+        }
+    }
+
+    auto compact = edyn::compact_tree{};
+    compact.build(tree);
+    ASSERT_EQ(compact.num_leaves(), num_entities);
+
+    for (int i = 0; i < 50; ++i) {
+        auto center = edyn::vector3{edyn::scalar(i * 0.7), edyn::scalar(i % 9), edyn::scalar(i * -0.9)};
+        auto half = edyn::vector3_one * edyn::scalar(0.2 + 0.1 * (i % 7));
+        auto aabb = edyn::AABB{center - half, center + half};
+
+        auto expected = query_dynamic_tree(tree, aabb);
+        auto result = query_compact_tree(compact, aabb);
+
+        // Results are conservative and might contain a few more entities
+        // due to quantization.
+        ASSERT_TRUE(std::includes(result.begin(), result.end(), expected.begin(), expected.end()));
+    }
+
+    // Query covering everything finds all leaves exactly once.
+    auto all = query_compact_tree(compact, {edyn::vector3_one * -100, edyn::vector3_one * 100});
+    ASSERT_EQ(all.size(), num_entities);
+    ASSERT_TRUE(std::adjacent_find(all.begin(), all.end()) == all.end());
+}
+
+TEST(test_compact_tree, filtered_query) {
+    auto tree = edyn::dynamic_tree{};
+    constexpr int num_entities = 200;
+
+    for (int i = 0; i < num_entities; ++i) {
+        auto center = edyn::vector3{edyn::scalar(i % 20), 0, edyn::scalar(i / 20)};
+        auto half = edyn::vector3_one * edyn::scalar(0.4);
+        // Each group in a contiguous range thus whole nodes can be skipped.
+        auto group = uint64_t{1} << (i / 50);
+        tree.create({center - half, center + half}, entt::entity(i), {group, edyn::collision_filter::all_groups});
+    }
+
+    auto compact = edyn::compact_tree{};
+    compact.build(tree);
+
+    auto aabb = edyn::AABB{edyn::vector3_one * -100, edyn::vector3_one * 100};
+    auto result = std::vector<entt::entity>{};
+    compact.query(aabb, {edyn::collision_filter::all_groups, 0x2}, [&](entt::entity entity) {
+        result.push_back(entity);
+    });
+    std::sort(result.begin(), result.end());
+
+    ASSERT_EQ(result.size(), 50);
+    ASSERT_EQ(result.front(), entt::entity(50));
+    ASSERT_EQ(result.back(), entt::entity(99));
+}
+
+TEST(test_compact_tree, raycast) {
+    auto tree = edyn::dynamic_tree{};
+    auto compact = edyn::compact_tree{};
+    compact.build(tree);
+    ASSERT_TRUE(compact.empty());
+
+    auto entity = entt::entity(7);
+    tree.create({edyn::vector3{1, -1, -1}, edyn::vector3{2, 1, 1}}, entity);
+    tree.create({edyn::vector3{1, 5, -1}, edyn::vector3{2, 6, 1}}, entt::entity(8));
+    compact.build(tree);
+
+    auto hits = std::vector<entt::entity>{};
+    compact.raycast({0, 0, 0}, {3, 0, 0}, [&](entt::entity e) {
+        hits.push_back(e);
+    });
+    ASSERT_EQ(hits.size(), 1);
+    ASSERT_EQ(hits[0], entity);
+
+    hits.clear();
+    compact.raycast({0, 10, 0}, {3, 10, 0}, [&](entt::entity e) {
+        hits.push_back(e);
+    });
+    ASSERT_TRUE(hits.empty());
+}
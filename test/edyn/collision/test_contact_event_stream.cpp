@@ -0,0 +1,91 @@
+#include "../common/common.hpp"
+
+class test_contact_event_stream : public ::testing::Test {
+protected:
+    void SetUp() override {
+        auto config = edyn::init_config{};
+        config.execution_mode = edyn::execution_mode::sequential;
+        edyn::attach(registry, config);
+        edyn::set_paused(registry, true);
+        edyn::set_stream_contact_events(registry, true);
+
+        auto floor_def = edyn::rigidbody_def{};
+        floor_def.kind = edyn::rigidbody_kind::rb_static;
+        floor_def.shape = edyn::plane_shape{{0, 1, 0}, 0};
+        floor_entity = edyn::make_rigidbody(registry, floor_def);
+
+        auto def = edyn::rigidbody_def{};
+        def.shape = edyn::sphere_shape{0.5};
+        def.position = {0, 0.6, 0};
+        def.linvel = {0, -4, 0};
+        sphere_entity = edyn::make_rigidbody(registry, def);
+    }
+
+    void TearDown() override {
+        edyn::detach(registry);
+    }
+
+    // Steps the simulation and collects all contact events.
+    std::vector<edyn::contact_event> step(unsigned num_steps) {
+        auto events = std::vector<edyn::contact_event>{};
+
+        for (unsigned i = 0; i < num_steps; ++i) {
+            edyn::step_simulation(registry);
+            auto &step_events = edyn::get_contact_events(registry);
+            events.insert(events.end(), step_events.begin(), step_events.end());
+        }
+
+        return events;
+    }
+
+    bool is_pair(const edyn::contact_event &event) const {
+        return (event.body[0] == floor_entity && event.body[1] == sphere_entity) ||
+               (event.body[0] == sphere_entity && event.body[1] == floor_entity);
+    }
+
+    entt::registry registry;
+    entt::entity floor_entity;
+    entt::entity sphere_entity;
+};
+
+TEST_F(test_contact_event_stream, started_ended) {
+    auto events = step(10);
+    ASSERT_EQ(events.size(), 1);
+    ASSERT_EQ(events[0].type, edyn::contact_event_type::started);
+    ASSERT_TRUE(is_pair(events[0]));
+    ASSERT_GT(events[0].impulse, edyn::scalar(0));
+    ASSERT_NEAR(std::abs(events[0].normal.y), edyn::scalar(1), edyn::scalar(0.001));
+    ASSERT_NEAR(events[0].point.y, edyn::scalar(0), edyn::scalar(0.05));
+
+    registry.destroy(sphere_entity);
+    events = step(1);
+    ASSERT_EQ(events.size(), 1);
+    ASSERT_EQ(events[0].type, edyn::contact_event_type::ended);
+}
+
+TEST_F(test_contact_event_stream, min_impulse) {
+    // The impact is not strong enough, thus neither its start nor its end is
+    // reported.
+    edyn::set_contact_event_filter(registry, edyn::scalar(1000), false);
+    ASSERT_TRUE(step(10).empty());
+
+    registry.destroy(sphere_entity);
+    ASSERT_TRUE(step(1).empty());
+}
+
+TEST_F(test_contact_event_stream, require_tag) {
+    edyn::set_contact_event_filter(registry, edyn::scalar(0), true);
+    ASSERT_TRUE(step(10).empty());
+
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::sphere_shape{0.5};
+    def.position = {3, 0.6, 0};
+    def.linvel = {0, -4, 0};
+    auto entity = edyn::make_rigidbody(registry, def);
+    registry.emplace<edyn::contact_event_tag>(entity);
+
+    auto events = step(10);
+    ASSERT_EQ(events.size(), 1);
+    ASSERT_EQ(events[0].type, edyn::contact_event_type::started);
+    ASSERT_TRUE(events[0].body[0] == entity || events[0].body[1] == entity);
+}
@@ -0,0 +1,104 @@
+#include "../common/common.hpp"
+#include "edyn/collision/contact_manifold.hpp"
+#include "edyn/collision/contact_manifold_events.hpp"
+#include "edyn/collision/contact_manifold_map.hpp"
+#include "edyn/comp/island.hpp"
+#include "edyn/dynamics/row_cache.hpp"
+
+TEST(test_contact_manifold_map, insert_and_erase) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::sphere_shape{0.5};
+    auto bodies = std::vector<entt::entity>{};
+
+    for (int i = 0; i < 40; ++i) {
+        def.position = {edyn::scalar(i * 10), 0, 0};
+        bodies.push_back(edyn::make_rigidbody(registry, def));
+    }
+
+    auto &manifold_map = registry.ctx().get<edyn::contact_manifold_map>();
+    manifold_map.reserve(64);
+    auto manifolds = std::vector<entt::entity>{};
+
+    // Enough manifolds to make the table grow past the reserved size.
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        for (size_t j = i + 1; j < bodies.size(); j += 3) {
+            manifolds.push_back(edyn::make_contact_manifold(registry, bodies[i], bodies[j], 0.1));
+        }
+    }
+
+    ASSERT_EQ(manifold_map.size(), manifolds.size());
+
+    for (auto entity : manifolds) {
+        auto &manifold = registry.get<edyn::contact_manifold>(entity);
+        ASSERT_TRUE(manifold_map.contains(manifold.body[0], manifold.body[1]));
+        ASSERT_TRUE(manifold_map.contains(manifold.body[1], manifold.body[0]));
+        ASSERT_EQ(manifold_map.get(manifold.body[1], manifold.body[0]), entity);
+    }
+
+    ASSERT_FALSE(manifold_map.contains(bodies[0], bodies[2]));
+
+    // Destroy every other manifold and check the remaining ones can still be
+    // found.
+    for (size_t i = 0; i < manifolds.size(); i += 2) {
+        auto &manifold = registry.get<edyn::contact_manifold>(manifolds[i]);
+        auto [first, second] = manifold.body;
+        registry.destroy(manifolds[i]);
+        ASSERT_FALSE(manifold_map.contains(first, second));
+    }
+
+    for (size_t i = 1; i < manifolds.size(); i += 2) {
+        auto &manifold = registry.get<edyn::contact_manifold>(manifolds[i]);
+        ASSERT_EQ(manifold_map.get(manifold.body[0], manifold.body[1]), manifolds[i]);
+    }
+
+    ASSERT_EQ(manifold_map.size(), manifolds.size() / 2);
+
+    edyn::detach(registry);
+}
+
+TEST(test_contact_manifold_map, make_many_manifolds) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::sphere_shape{0.5};
+    auto bodies = std::vector<entt::entity>{};
+
+    for (int i = 0; i < 10; ++i) {
+        def.position = {edyn::scalar(i * 10), 0, 0};
+        bodies.push_back(edyn::make_rigidbody(registry, def));
+    }
+
+    // One pair already has a manifold and another is repeated, reversed.
+    auto existing = edyn::make_contact_manifold(registry, bodies[0], bodies[1], 0.1);
+    auto pairs = edyn::entity_pair_vector{};
+
+    for (size_t i = 0; i + 1 < bodies.size(); ++i) {
+        pairs.emplace_back(bodies[i], bodies[i + 1]);
+    }
+
+    pairs.emplace_back(bodies[3], bodies[2]);
+
+    ASSERT_EQ(edyn::make_contact_manifolds(registry, pairs, 0.1), bodies.size() - 2);
+
+    auto &manifold_map = registry.ctx().get<edyn::contact_manifold_map>();
+    ASSERT_EQ(manifold_map.size(), bodies.size() - 1);
+    ASSERT_EQ(manifold_map.get(bodies[0], bodies[1]), existing);
+
+    for (size_t i = 0; i + 1 < bodies.size(); ++i) {
+        auto entity = manifold_map.get(bodies[i], bodies[i + 1]);
+        ASSERT_TRUE((registry.all_of<edyn::contact_manifold, edyn::contact_manifold_events,
+                                     edyn::contact_constraint, edyn::graph_edge,
+                                     edyn::island_resident, edyn::constraint_tag,
+                                     edyn::constraint_row_prep_cache>(entity)));
+    }
+
+    edyn::detach(registry);
+}
@@ -0,0 +1,350 @@
+#include "../common/common.hpp"
+#include "edyn/collision/dynamic_tree.hpp"
+#include <algorithm>
+
+TEST(test_dynamic_tree, bulk_create_query) {
+    auto tree = edyn::dynamic_tree{};
+    auto all_aabbs = std::vector<edyn::AABB>{};
+    auto all_ids = std::vector<edyn::tree_node_id_t>{};
+
+    // Grid of boxes, some inserted one by one before the bulk insertion.
+    auto aabbs = std::vector<edyn::AABB>{};
+    auto entities = std::vector<entt::entity>{};
+
+    for (int x = 0; x < 12; ++x) {
+        for (int y = 0; y < 12; ++y) {
+            for (int z = 0; z < 4; ++z) {
+                auto center = edyn::vector3{edyn::scalar(x * 2), edyn::scalar(y * 2), edyn::scalar(z * 3)};
+                auto aabb = edyn::AABB{center - edyn::vector3_one * 0.5, center + edyn::vector3_one * 0.5};
+                auto entity = entt::entity(all_aabbs.size());
+                all_aabbs.push_back(aabb);
+
+                if (z == 0 && x < 3) {
+                    all_ids.push_back(tree.create(aabb, entity));
+                } else {
+                    all_ids.push_back(edyn::null_tree_node_id);
+                    aabbs.push_back(aabb);
+                    entities.push_back(entity);
+                }
+            }
+        }
+    }
+
+    auto ids = std::vector<edyn::tree_node_id_t>{};
+    tree.create(aabbs, entities, ids);
+    ASSERT_EQ(ids.size(), aabbs.size());
+
+    for (size_t i = 0, j = 0; i < all_ids.size(); ++i) {
+        if (all_ids[i] == edyn::null_tree_node_id) {
+            all_ids[i] = ids[j];
+            ASSERT_EQ(tree.get_node(ids[j]).entity, entities[j]);
+            ASSERT_TRUE(tree.get_node(ids[j]).leaf());
+            ++j;
+        }
+    }
+
+    auto query_aabb = edyn::AABB{{3, 3, -1}, {9, 7, 5}};
+    auto result = std::vector<edyn::tree_node_id_t>{};
+    tree.query(query_aabb, [&](edyn::tree_node_id_t id) {
+        result.push_back(id);
+    });
+
+    for (size_t i = 0; i < all_aabbs.size(); ++i) {
+        auto found = std::find(result.begin(), result.end(), all_ids[i]) != result.end();
+        ASSERT_EQ(found, edyn::intersect(all_aabbs[i], query_aabb));
+    }
+
+    // Nodes created in bulk can be destroyed individually.
+    for (auto id : all_ids) {
+        tree.destroy(id);
+    }
+
+    auto count = 0;
+    tree.query(query_aabb, [&](edyn::tree_node_id_t) { ++count; });
+    ASSERT_EQ(count, 0);
+}
+
+TEST(test_dynamic_tree, raycast_matches_segment_test) {
+    auto tree = edyn::dynamic_tree{};
+    auto ids = std::vector<edyn::tree_node_id_t>{};
+
+    for (int x = 0; x < 10; ++x) {
+        for (int y = 0; y < 10; ++y) {
+            auto center = edyn::vector3{edyn::scalar(x * 2), edyn::scalar(y * 2), edyn::scalar((x + y) % 3)};
+            auto half = edyn::vector3{0.5, 0.4, 0.7};
+            ids.push_back(tree.create({center - half, center + half}, entt::entity(ids.size())));
+        }
+    }
+
+    const edyn::vector3 segments[][2] = {
+        {{-1, -1, 0}, {20, 20, 1}},
+        {{5, -3, 0.5}, {5, 25, 0.5}}, // Parallel to an axis.
+        {{0, 4, -5}, {0, 4, 5}},
+        {{-3, 7, 2}, {14, 1, -1}},
+        {{30, 30, 30}, {40, 40, 40}} // Misses everything.
+    };
+
+    for (auto &segment : segments) {
+        auto result = std::vector<edyn::tree_node_id_t>{};
+        tree.raycast(segment[0], segment[1], [&](edyn::tree_node_id_t id) {
+            result.push_back(id);
+        });
+
+        for (auto id : ids) {
+            auto &aabb = tree.get_node(id).aabb;
+            auto found = std::find(result.begin(), result.end(), id) != result.end();
+            ASSERT_EQ(found, edyn::intersect_segment_aabb(segment[0], segment[1], aabb.min, aabb.max));
+        }
+    }
+}
+
+TEST(test_dynamic_tree, raycast_packet) {
+    auto tree = edyn::dynamic_tree{};
+    auto ids = std::vector<edyn::tree_node_id_t>{};
+
+    for (int x = 0; x < 10; ++x) {
+        for (int y = 0; y < 10; ++y) {
+            auto center = edyn::vector3{edyn::scalar(x * 2), edyn::scalar(y * 2), edyn::scalar((x + y) % 3)};
+            auto half = edyn::vector3{0.5, 0.4, 0.7};
+            ids.push_back(tree.create({center - half, center + half}, entt::entity(ids.size())));
+        }
+    }
+
+    const edyn::vector3 segments[][2] = {
+        {{-1, -1, 0}, {20, 20, 1}},
+        {{5, -3, 0.5}, {5, 25, 0.5}}, // Parallel to an axis.
+        {{0, 4, -5}, {0, 4, 5}},
+        {{-3, 7, 2}, {14, 1, -1}},
+        {{30, 30, 30}, {40, 40, 40}}, // Misses everything.
+        {{18, 18, 0}, {-1, 4, 2}},
+        {{6, 6, 1}, {6, 6, 1}}, // Degenerate.
+        {{-2, 10, 1}, {22, 10, 1}}
+    };
+    constexpr size_t num_segments = sizeof(segments) / sizeof(segments[0]);
+
+    for (size_t first = 0; first < num_segments; first += edyn::simd_width) {
+        auto packet = edyn::ray_packet{};
+
+        for (auto i = first; i < std::min(first + edyn::simd_width, num_segments); ++i) {
+            packet.add(segments[i][0], segments[i][1]);
+        }
+
+        auto results = std::vector<std::vector<edyn::tree_node_id_t>>(packet.size);
+        tree.raycast(packet, [&](edyn::tree_node_id_t id, unsigned mask) {
+            ASSERT_EQ(mask & ~((1u << packet.size) - 1u), 0);
+
+            for (unsigned lane = 0; lane < packet.size; ++lane) {
+                if (mask & (1u << lane)) {
+                    results[lane].push_back(id);
+                }
+            }
+        });
+
+        for (unsigned lane = 0; lane < packet.size; ++lane) {
+            auto &segment = segments[first + lane];
+
+            for (auto id : ids) {
+                auto &aabb = tree.get_node(id).aabb;
+                auto found = std::find(results[lane].begin(), results[lane].end(), id) != results[lane].end();
+                ASSERT_EQ(found, edyn::intersect_segment_aabb(segment[0], segment[1], aabb.min, aabb.max));
+            }
+        }
+    }
+
+    // Lanes terminated at their first hit are not reported again and the
+    // traversal stops once all lanes are terminated.
+    auto packet = edyn::ray_packet{};
+    packet.add(segments[0][0], segments[0][1]);
+    packet.add(segments[2][0], segments[2][1]);
+    unsigned hits[2] = {0, 0};
+    tree.raycast(packet, [&](edyn::tree_node_id_t, unsigned mask) {
+        for (unsigned lane = 0; lane < 2; ++lane) {
+            if (mask & (1u << lane)) {
+                ++hits[lane];
+                packet.terminate(lane);
+            }
+        }
+    });
+    ASSERT_EQ(hits[0], 1);
+    ASSERT_EQ(hits[1], 1);
+    ASSERT_EQ(packet.active_mask(), 0);
+}
+
+TEST(test_dynamic_tree, shift_origin) {
+    auto tree = edyn::dynamic_tree{};
+    auto aabbs = std::vector<edyn::AABB>{};
+    auto ids = std::vector<edyn::tree_node_id_t>{};
+
+    for (int x = 0; x < 8; ++x) {
+        for (int y = 0; y < 8; ++y) {
+            auto center = edyn::vector3{edyn::scalar(1000 + x * 2), edyn::scalar(y * 2), 0};
+            auto aabb = edyn::AABB{center - edyn::vector3_one * 0.5, center + edyn::vector3_one * 0.5};
+            ids.push_back(tree.create(aabb, entt::entity(aabbs.size())));
+            aabbs.push_back(aabb);
+        }
+    }
+
+    auto offset = edyn::vector3{1000, 0, 0};
+    tree.shift_origin(offset);
+
+    auto query_aabb = edyn::AABB{{3, 3, -1}, {9, 7, 1}};
+    auto result = std::vector<edyn::tree_node_id_t>{};
+    tree.query(query_aabb, [&](edyn::tree_node_id_t id) {
+        result.push_back(id);
+    });
+
+    for (size_t i = 0; i < aabbs.size(); ++i) {
+        auto shifted = edyn::AABB{aabbs[i].min - offset, aabbs[i].max - offset};
+        auto found = std::find(result.begin(), result.end(), ids[i]) != result.end();
+        ASSERT_EQ(found, edyn::intersect(shifted, query_aabb));
+    }
+}
+
+TEST(test_dynamic_tree, filtered_query) {
+    auto tree = edyn::dynamic_tree{};
+    auto ids = std::vector<edyn::tree_node_id_t>{};
+    auto groups = std::vector<uint64_t>{};
+
+    // Row of boxes whose groups alternate between two bits.
+    for (int i = 0; i < 64; ++i) {
+        auto center = edyn::vector3{edyn::scalar(i * 2), 0, 0};
+        auto aabb = edyn::AABB{center - edyn::vector3_one * 0.5, center + edyn::vector3_one * 0.5};
+        auto group = uint64_t{1} << (i % 2);
+        groups.push_back(group);
+        ids.push_back(tree.create(aabb, entt::entity(i), {group, edyn::collision_filter::all_groups}));
+    }
+
+    auto query_aabb = edyn::AABB{{-1, -1, -1}, {200, 1, 1}};
+
+    auto query = [&](const edyn::collision_filter &filter) {
+        auto result = std::vector<edyn::tree_node_id_t>{};
+        tree.query(query_aabb, filter, [&](edyn::tree_node_id_t id) {
+            result.push_back(id);
+        });
+        return result;
+    };
+
+    auto result = query({edyn::collision_filter::all_groups, 0x1});
+    ASSERT_EQ(result.size(), 32);
+
+    for (auto id : result) {
+        ASSERT_EQ(groups[static_cast<size_t>(tree.get_node(id).entity)], 0x1);
+    }
+
+    // No node has this group.
+    ASSERT_TRUE(query({edyn::collision_filter::all_groups, 0x4}).empty());
+
+    // Nodes whose mask does not contain the group of the query.
+    tree.set_filter(ids[1], {0x2, 0x8});
+    result = query({0x1, 0x2});
+    ASSERT_EQ(result.size(), 31);
+    ASSERT_EQ(std::find(result.begin(), result.end(), ids[1]), result.end());
+
+    // The unions of the ancestors include the new group.
+    tree.set_filter(ids[2], {0x10, edyn::collision_filter::all_groups});
+    result = query({edyn::collision_filter::all_groups, 0x10});
+    ASSERT_EQ(result.size(), 1);
+    ASSERT_EQ(result[0], ids[2]);
+}
+
+TEST(test_dynamic_tree, batch_move) {
+    auto tree = edyn::dynamic_tree{};
+    auto aabbs = std::vector<edyn::AABB>{};
+    auto ids = std::vector<edyn::tree_node_id_t>{};
+    auto half = edyn::vector3{0.5, 0.5, 0.5};
+
+    for (int x = 0; x < 16; ++x) {
+        for (int y = 0; y < 16; ++y) {
+            auto center = edyn::vector3{edyn::scalar(x * 2), edyn::scalar(y * 2), 0};
+            aabbs.push_back({center - half, center + half});
+            ids.push_back(tree.create(aabbs.back(), entt::entity(ids.size())));
+        }
+    }
+
+    // Move some leaves slightly, which keeps them in place, and others far
+    // away, which reinserts them, over a few steps.
+    for (int step = 1; step <= 4; ++step) {
+        auto moved_ids = std::vector<edyn::tree_node_id_t>{};
+        auto moved_aabbs = std::vector<edyn::AABB>{};
+
+        for (size_t i = 0; i < ids.size(); i += 3) {
+            auto offset = i % 2 == 0 ?
+                edyn::vector3{edyn::scalar(0.15), 0, 0} :
+                edyn::vector3{0, 0, edyn::scalar(5 * step)};
+            aabbs[i] = {aabbs[i].min + offset, aabbs[i].max + offset};
+            moved_ids.push_back(ids[i]);
+            moved_aabbs.push_back(aabbs[i]);
+        }
+
+        tree.move(moved_ids, moved_aabbs);
+
+        // Every leaf contains its AABB and every internal node contains its
+        // children.
+        for (size_t i = 0; i < ids.size(); ++i) {
+            auto *node = &tree.get_node(ids[i]);
+            ASSERT_TRUE(node->aabb.contains(aabbs[i]));
+
+            while (node->parent != edyn::null_tree_node_id) {
+                auto &parent = tree.get_node(node->parent);
+                ASSERT_TRUE(parent.aabb.contains(node->aabb));
+                node = &parent;
+            }
+
+            ASSERT_EQ(node, &tree.get_node(tree.root()));
+        }
+
+        auto query_aabb = edyn::AABB{{3, 3, -1}, {17, 11, 30}};
+        auto result = std::vector<entt::entity>{};
+        tree.query(query_aabb, [&](edyn::tree_node_id_t id) {
+            if (edyn::intersect(aabbs[static_cast<size_t>(tree.get_node(id).entity)], query_aabb)) {
+                result.push_back(tree.get_node(id).entity);
+            }
+        });
+
+        for (size_t i = 0; i < aabbs.size(); ++i) {
+            auto found = std::find(result.begin(), result.end(), entt::entity(i)) != result.end();
+            ASSERT_EQ(found, edyn::intersect(aabbs[i], query_aabb));
+        }
+    }
+}
+
+TEST(test_dynamic_tree, predictive_inflation) {
+    auto tree = edyn::dynamic_tree{};
+    auto half = edyn::vector3{0.5, 0.5, 0.5};
+    auto aabb = edyn::AABB{-half, half};
+    auto id = tree.create(aabb, entt::entity{0});
+    auto margin = edyn::aabb_margin{};
+
+    // Moving half a unit per step along x. The leaf is extended ahead of
+    // the entity only, thus it isn't reinserted in every step.
+    auto displacement = edyn::vector3{0.5, 0, 0};
+    auto num_moves = 0;
+
+    for (int step = 0; step < 6; ++step) {
+        aabb = {aabb.min + displacement, aabb.max + displacement};
+
+        if (tree.move(id, aabb, displacement, margin)) {
+            ++num_moves;
+            auto &node = tree.get_node(id);
+            ASSERT_SCALAR_EQ(node.aabb.min.x, aabb.min.x - margin.margin);
+            ASSERT_SCALAR_EQ(node.aabb.max.x, aabb.max.x + margin.margin +
+                             displacement.x * margin.displacement_multiplier);
+            ASSERT_SCALAR_EQ(node.aabb.max.y, aabb.max.y + margin.margin);
+        }
+
+        ASSERT_TRUE(tree.get_node(id).aabb.contains(aabb));
+    }
+
+    ASSERT_EQ(num_moves, 2);
+
+    // Once it stops, the leaf is shrunk back around the entity.
+    ASSERT_TRUE(tree.needs_move(id, aabb, edyn::vector3_zero, margin));
+    ASSERT_TRUE(tree.move(id, aabb, edyn::vector3_zero, margin));
+    ASSERT_SCALAR_EQ(tree.get_node(id).aabb.max.x, aabb.max.x + margin.margin);
+    ASSERT_FALSE(tree.move(id, aabb, edyn::vector3_zero, margin));
+
+    // A smaller margin gives a tighter leaf.
+    margin.margin = edyn::scalar(0.01);
+    ASSERT_TRUE(tree.move(id, aabb, edyn::vector3_zero, margin));
+    ASSERT_SCALAR_EQ(tree.get_node(id).aabb.min.y, aabb.min.y - margin.margin);
+}
@@ -0,0 +1,99 @@
+#include "../common/common.hpp"
+#include "edyn/collision/gjk.hpp"
+#include "edyn/math/math.hpp"
+#include "edyn/util/shape_util.hpp"
+
+static auto box_support(edyn::vector3 half_extents) {
+    return [=](const edyn::vector3 &dir) {
+        return edyn::support_point_box(half_extents, dir);
+    };
+}
+
+static auto sphere_support(edyn::scalar radius) {
+    return [=](const edyn::vector3 &dir) {
+        return edyn::normalize(dir) * radius;
+    };
+}
+
+TEST(test_gjk, separated_boxes) {
+    auto supportA = box_support({0.5, 0.5, 0.5});
+    auto supportB = box_support({0.5, 0.5, 0.5});
+    auto posB = edyn::vector3{0.2, 1.3, -0.1};
+    auto ornB = edyn::quaternion_identity;
+    auto simplex = edyn::gjk_simplex{};
+
+    auto result = edyn::gjk(supportA, supportB, posB, ornB, simplex);
+    ASSERT_FALSE(result.intersecting);
+    ASSERT_SCALAR_EQ(result.distance, 0.3);
+    ASSERT_SCALAR_EQ(result.pointA.y, 0.5);
+    ASSERT_SCALAR_EQ(result.pointB.y, 0.8);
+
+    // Starting from the previous simplex gives the same result.
+    auto warm = edyn::gjk(supportA, supportB, posB, ornB, simplex);
+    ASSERT_FALSE(warm.intersecting);
+    ASSERT_SCALAR_EQ(warm.distance, 0.3);
+}
+
+TEST(test_gjk, separated_max_distance) {
+    auto supportA = sphere_support(0.5);
+    auto supportB = sphere_support(0.5);
+    auto posB = edyn::vector3{3, 0, 0};
+    auto simplex = edyn::gjk_simplex{};
+
+    auto result = edyn::gjk(supportA, supportB, posB, edyn::quaternion_identity, simplex, 0.1);
+    ASSERT_FALSE(result.intersecting);
+    ASSERT_GT(result.distance, 0.1);
+    ASSERT_LE(result.distance, 2 + 1e-4);
+}
+
+TEST(test_gjk, rotated_box_sphere) {
+    auto supportA = box_support({1, 0.5, 1});
+    auto supportB = sphere_support(0.25);
+    auto posB = edyn::vector3{2, 2, 0};
+    auto ornB = edyn::quaternion_axis_angle({0, 0, 1}, edyn::to_radians(30));
+    auto simplex = edyn::gjk_simplex{};
+
+    // Closest point on the box is the corner edge at (1, 0.5).
+    auto result = edyn::gjk(supportA, supportB, posB, ornB, simplex);
+    ASSERT_FALSE(result.intersecting);
+    ASSERT_NEAR(result.distance, std::sqrt(edyn::scalar(1 + 1.5 * 1.5)) - 0.25, 1e-3);
+    ASSERT_NEAR(result.pointA.x, 1, 1e-3);
+    ASSERT_NEAR(result.pointA.y, 0.5, 1e-3);
+}
+
+TEST(test_gjk, penetrating_boxes) {
+    auto supportA = box_support({0.5, 0.5, 0.5});
+    auto supportB = box_support({0.5, 0.5, 0.5});
+    auto posB = edyn::vector3{0.1, 0.9, 0.2};
+    auto ornB = edyn::quaternion_identity;
+    auto simplex = edyn::gjk_simplex{};
+
+    auto result = edyn::gjk(supportA, supportB, posB, ornB, simplex);
+    ASSERT_TRUE(result.intersecting);
+
+    auto penetration = edyn::epa_result{};
+    ASSERT_TRUE(edyn::epa(supportA, supportB, posB, ornB, simplex, penetration));
+    ASSERT_NEAR(penetration.depth, 0.1, 1e-3);
+    ASSERT_NEAR(penetration.normal.x, 0, 1e-3);
+    ASSERT_NEAR(penetration.normal.y, 1, 1e-3);
+    ASSERT_NEAR(penetration.normal.z, 0, 1e-3);
+    ASSERT_NEAR(penetration.pointA.y, 0.5, 1e-3);
+    ASSERT_NEAR(penetration.pointB.y, 0.4, 1e-3);
+}
+
+TEST(test_gjk, penetrating_spheres) {
+    auto supportA = sphere_support(1);
+    auto supportB = sphere_support(0.5);
+    auto posB = edyn::normalize(edyn::vector3{1, -2, 1}) * 1.2;
+    auto simplex = edyn::gjk_simplex{};
+
+    auto result = edyn::gjk(supportA, supportB, posB, edyn::quaternion_identity, simplex);
+    ASSERT_TRUE(result.intersecting);
+
+    auto penetration = edyn::epa_result{};
+    ASSERT_TRUE(edyn::epa(supportA, supportB, posB, edyn::quaternion_identity, simplex, penetration));
+    // EPA approximates the spheres by a polytope thus the depth is a bit
+    // less than the exact value.
+    ASSERT_NEAR(penetration.depth, 0.3, 0.01);
+    ASSERT_GT(edyn::dot(penetration.normal, edyn::normalize(posB)), 0.99);
+}
@@ -0,0 +1,114 @@
+#include "../common/common.hpp"
+#include "edyn/collision/linear_bvh.hpp"
+#include <algorithm>
+#include <random>
+#include <set>
+
+static edyn::AABB random_aabb(std::mt19937 &rng) {
+    auto pos = std::uniform_real_distribution<edyn::scalar>(0, 20);
+    auto size = std::uniform_real_distribution<edyn::scalar>(0.1, 1.5);
+    auto center = edyn::vector3{pos(rng), pos(rng) * edyn::scalar(0.2), pos(rng) * edyn::scalar(0.5)};
+    auto half = edyn::vector3{size(rng), size(rng), size(rng)};
+    return {center - half, center + half};
+}
+
+TEST(test_linear_bvh, matches_brute_force) {
+    auto bvh = edyn::linear_bvh{};
+    auto rng = std::mt19937{42};
+    auto aabbs = std::vector<edyn::AABB>{};
+    auto alive = std::vector<bool>{};
+
+    for (int i = 0; i < 300; ++i) {
+        aabbs.push_back(random_aabb(rng));
+        alive.push_back(true);
+        bvh.insert(entt::entity(i), aabbs.back());
+    }
+
+    // Entities sharing a center have equal Morton codes.
+    for (int i = 300; i < 310; ++i) {
+        aabbs.push_back(aabbs[0]);
+        alive.push_back(true);
+        bvh.insert(entt::entity(i), aabbs.back());
+    }
+
+    auto pick = std::uniform_int_distribution<size_t>(0, aabbs.size() - 1);
+
+    for (int step = 0; step < 10; ++step) {
+        if (step > 0) {
+            for (int k = 0; k < 40; ++k) {
+                auto i = pick(rng);
+                if (!alive[i]) continue;
+
+                if (k % 10 == 0) {
+                    bvh.erase(entt::entity(i));
+                    alive[i] = false;
+                } else {
+                    aabbs[i] = random_aabb(rng);
+                    bvh.set_aabb(entt::entity(i), aabbs[i]);
+                }
+            }
+        }
+
+        bvh.build();
+        ASSERT_EQ(bvh.size(), size_t(std::count(alive.begin(), alive.end(), true)));
+
+        for (size_t i = 0; i < aabbs.size(); ++i) {
+            ASSERT_EQ(bvh.contains(entt::entity(i)), alive[i]);
+
+            if (!alive[i]) {
+                continue;
+            }
+
+            auto found = std::set<entt::entity>{};
+            bvh.query(entt::entity(i), false, [&](entt::entity other) {
+                ASSERT_NE(other, entt::entity(i));
+                ASSERT_TRUE(found.insert(other).second);
+            });
+
+            auto expected = std::set<entt::entity>{};
+
+            for (size_t j = 0; j < aabbs.size(); ++j) {
+                if (j != i && alive[j] && intersect(aabbs[i], aabbs[j])) {
+                    expected.insert(entt::entity(j));
+                }
+            }
+
+            ASSERT_EQ(found, expected);
+        }
+    }
+}
+
+TEST(test_linear_bvh, filters_and_shift) {
+    auto bvh = edyn::linear_bvh{};
+    auto aabb = edyn::AABB{{-1, -1, -1}, {1, 1, 1}};
+    bvh.insert(entt::entity(0), aabb, {0x1, ~0x2ull});
+    bvh.insert(entt::entity(1), aabb, {0x2, ~0x1ull});
+    bvh.insert(entt::entity(2), aabb);
+    bvh.build();
+
+    auto num_found = 0;
+    bvh.query(entt::entity(0), true, [&](entt::entity other) {
+        ASSERT_EQ(other, entt::entity(2));
+        ++num_found;
+    });
+    ASSERT_EQ(num_found, 1);
+
+    num_found = 0;
+    bvh.query(entt::entity(0), false, [&](entt::entity) { ++num_found; });
+    ASSERT_EQ(num_found, 2);
+
+    bvh.shift_origin({10, 0, 0});
+    num_found = 0;
+    bvh.query(edyn::AABB{{-11, -1, -1}, {-9, 1, 1}}, [&](entt::entity) { ++num_found; });
+    ASSERT_EQ(num_found, 3);
+
+    bvh.erase(entt::entity(1));
+    bvh.erase(entt::entity(2));
+    bvh.build();
+    ASSERT_EQ(bvh.size(), 1);
+    ASSERT_FALSE(bvh.contains(entt::entity(1)));
+
+    num_found = 0;
+    bvh.query(edyn::AABB{{-11, -1, -1}, {-9, 1, 1}}, [&](entt::entity) { ++num_found; });
+    ASSERT_EQ(num_found, 1);
+}
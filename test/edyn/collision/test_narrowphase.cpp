@@ -0,0 +1,38 @@
+#include "../common/common.hpp"
+#include "edyn/collision/narrowphase.hpp"
+#include "edyn/util/rigidbody.hpp"
+
+TEST(test_narrowphase, contact_point_stats) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+    edyn::set_paused(registry, true);
+
+    auto def = edyn::rigidbody_def{};
+    def.kind = edyn::rigidbody_kind::rb_static;
+    def.shape = edyn::box_shape{5, 0.5, 5};
+    def.position = {0, -0.5, 0};
+    edyn::make_rigidbody(registry, def);
+
+    // Box resting on the ground. Its contact points are created once and
+    // persist afterwards.
+    def.kind = edyn::rigidbody_kind::rb_dynamic;
+    def.shape = edyn::box_shape{0.5, 0.5, 0.5};
+    def.position = {0, 0.495, 0};
+    edyn::make_rigidbody(registry, def);
+
+    size_t num_points_created = 0;
+
+    for (auto i = 0; i < 10; ++i) {
+        edyn::step_simulation(registry);
+        auto &stats = registry.ctx().get<edyn::narrowphase>().get_stats();
+        num_points_created += stats.num_points_created;
+        ASSERT_EQ(stats.num_points_destroyed, 0);
+        ASSERT_TRUE(stats.churning_manifolds.empty());
+    }
+
+    ASSERT_EQ(num_points_created, edyn::max_contacts);
+
+    edyn::detach(registry);
+}
@@ -0,0 +1,77 @@
+#include "../common/common.hpp"
+
+TEST(test_overlap, sphere_box_distance) {
+    auto box = edyn::box_shape{0.5, 0.5, 0.5};
+    auto ctx = edyn::overlap_context{};
+    ctx.pos = edyn::vector3_zero;
+    ctx.orn = edyn::quaternion_identity;
+    ctx.query.shape = edyn::sphere_shape{0.5};
+    ctx.query.pos = {0, 1.25, 0};
+
+    // Separated by a quarter, thus not overlapping.
+    auto hit = edyn::overlap(box, ctx);
+    ASSERT_EQ(hit.distance, EDYN_SCALAR_MAX);
+
+    // Within reach of the closest point query.
+    ctx.query.max_distance = 0.5;
+    hit = edyn::overlap(box, ctx);
+    ASSERT_NEAR(hit.distance, edyn::scalar(0.25), edyn::scalar(0.001));
+    ASSERT_NEAR(hit.normal.y, edyn::scalar(1), edyn::scalar(0.001));
+    ASSERT_NEAR(hit.pointA.y, edyn::scalar(0.75), edyn::scalar(0.001));
+    ASSERT_NEAR(hit.pointB.y, edyn::scalar(0.5), edyn::scalar(0.001));
+
+    // Penetrating.
+    ctx.query.max_distance = 0;
+    ctx.query.pos = {0, 0.75, 0};
+    hit = edyn::overlap(box, ctx);
+    ASSERT_NEAR(hit.distance, edyn::scalar(-0.25), edyn::scalar(0.001));
+}
+
+TEST(test_overlap, overlap_batch) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+
+    auto floor_def = edyn::rigidbody_def{};
+    floor_def.kind = edyn::rigidbody_kind::rb_static;
+    floor_def.shape = edyn::plane_shape{{0, 1, 0}, 0};
+    auto floor_entity = edyn::make_rigidbody(registry, floor_def);
+
+    auto def = edyn::rigidbody_def{};
+    def.kind = edyn::rigidbody_kind::rb_static;
+    def.shape = edyn::box_shape{0.5, 0.5, 0.5};
+    def.position = {0, 0.5, 0};
+    auto box_entity = edyn::make_rigidbody(registry, def);
+    edyn::update(registry);
+
+    auto queries = std::vector<edyn::overlap_query>(3);
+    // Touches the box and the floor.
+    queries[0].shape = edyn::sphere_shape{0.5};
+    queries[0].pos = {0.85, 0.25, 0};
+    // Above the box, within reach of the closest point query.
+    queries[1].shape = edyn::capsule_shape{0.25, 0.5};
+    queries[1].pos = {0, 1.5, 0};
+    queries[1].max_distance = 0.5;
+    // Above everything.
+    queries[2].shape = edyn::box_shape{0.5, 0.5, 0.5};
+    queries[2].pos = {3, 3, 0};
+
+    auto results = edyn::overlap_batch(registry, queries);
+    ASSERT_EQ(results.size(), 3);
+    ASSERT_EQ(results[0].hits.size(), 2);
+    // Closest first, the floor is penetrated deeper.
+    ASSERT_EQ(results[0].hits[0].entity, floor_entity);
+    ASSERT_NEAR(results[0].hits[0].distance, edyn::scalar(-0.25), edyn::scalar(0.001));
+    ASSERT_EQ(results[0].hits[1].entity, box_entity);
+    ASSERT_EQ(results[1].hits.size(), 1);
+    ASSERT_EQ(results[1].hits[0].entity, box_entity);
+    ASSERT_NEAR(results[1].hits[0].distance, edyn::scalar(0.25), edyn::scalar(0.001));
+    ASSERT_TRUE(results[2].hits.empty());
+
+    auto result = edyn::overlap(registry, queries[0], {floor_entity});
+    ASSERT_EQ(result.hits.size(), 1);
+    ASSERT_EQ(result.hits[0].entity, box_entity);
+
+    edyn::detach(registry);
+}
@@ -32,3 +32,50 @@ TEST(test_raycast, raycast_box) {
     auto &info = std::get<edyn::box_raycast_info>(result.info_var);
     ASSERT_EQ(info.face_index, 2);
 }
+
+TEST(test_raycast, raycast_polyhedron) {
+    auto mesh = std::make_shared<edyn::convex_mesh>();
+    edyn::make_box_mesh({0.5, 0.5, 0.5}, mesh->vertices, mesh->indices, mesh->faces);
+    mesh->initialize();
+    auto poly = edyn::polyhedron_shape{mesh};
+    ASSERT_SCALAR_EQ(mesh->bounding_radius, std::sqrt(edyn::scalar(0.75)));
+
+    auto ctx = edyn::raycast_context{};
+    ctx.pos = {0, 1, 0};
+    ctx.orn = edyn::quaternion_identity;
+    ctx.p0 = {0, 3, 0};
+    ctx.p1 = {0, 1, 0};
+
+    auto result = edyn::shape_raycast(poly, ctx);
+    ASSERT_SCALAR_EQ(result.fraction, edyn::scalar(0.75));
+    ASSERT_TRUE(std::holds_alternative<edyn::polyhedron_raycast_info>(result.info_var));
+
+    // Outside of bounding sphere.
+    ctx.p0 = {1, 3, 0};
+    ctx.p1 = {1, -3, 0};
+    result = edyn::shape_raycast(poly, ctx);
+    ASSERT_EQ(result.fraction, EDYN_SCALAR_MAX);
+}
+
+TEST(test_raycast, raycast_compound_any_hit) {
+    auto compound = edyn::compound_shape{};
+    compound.add_shape(edyn::box_shape{0.5, 0.5, 0.5}, {0, 0, 0}, edyn::quaternion_identity);
+    compound.add_shape(edyn::box_shape{0.5, 0.5, 0.5}, {0, 2, 0}, edyn::quaternion_identity);
+    compound.finish();
+
+    auto ctx = edyn::raycast_context{};
+    ctx.pos = edyn::vector3_zero;
+    ctx.orn = edyn::quaternion_identity;
+    ctx.p0 = {0, 4, 0};
+    ctx.p1 = {0, -4, 0};
+
+    auto closest = edyn::shape_raycast(compound, ctx);
+    ASSERT_SCALAR_EQ(closest.fraction, edyn::scalar(1.5) / 8);
+    ASSERT_EQ(std::get<edyn::compound_raycast_info>(closest.info_var).child_index, 1);
+
+    // Any of the children may be reported.
+    ctx.any_hit = true;
+    auto any = edyn::shape_raycast(compound, ctx);
+    ASSERT_LT(any.fraction, edyn::scalar(1));
+    ASSERT_GE(any.fraction, closest.fraction);
+}
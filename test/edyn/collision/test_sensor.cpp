@@ -0,0 +1,115 @@
+#include "../common/common.hpp"
+
+class test_sensor : public ::testing::Test {
+protected:
+    void SetUp() override {
+        auto config = edyn::init_config{};
+        config.execution_mode = edyn::execution_mode::sequential;
+        edyn::attach(registry, config);
+        edyn::set_paused(registry, true);
+    }
+
+    void TearDown() override {
+        edyn::detach(registry);
+    }
+
+    // Steps the simulation and collects all sensor events.
+    std::vector<edyn::sensor_event> step(unsigned num_steps) {
+        auto events = std::vector<edyn::sensor_event>{};
+
+        for (unsigned i = 0; i < num_steps; ++i) {
+            edyn::step_simulation(registry);
+            auto &step_events = edyn::get_sensor_events(registry);
+            events.insert(events.end(), step_events.begin(), step_events.end());
+        }
+
+        return events;
+    }
+
+    entt::registry registry;
+};
+
+TEST_F(test_sensor, enter_exit) {
+    auto sensor_def = edyn::rigidbody_def{};
+    sensor_def.kind = edyn::rigidbody_kind::rb_static;
+    sensor_def.shape = edyn::box_shape{1, 1, 1};
+    sensor_def.sensor = true;
+    auto sensor_entity = edyn::make_rigidbody(registry, sensor_def);
+
+    // Falls through the sensor without touching it.
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::sphere_shape{0.25};
+    def.position = {0, 2, 0};
+    def.linvel = {0, -6, 0};
+    def.gravity = edyn::vector3_zero;
+    auto entity = edyn::make_rigidbody(registry, def);
+
+    auto events = step(60);
+    ASSERT_EQ(events.size(), 2);
+    ASSERT_EQ(events[0].sensor, sensor_entity);
+    ASSERT_EQ(events[0].other, entity);
+    ASSERT_EQ(events[0].type, edyn::sensor_event_type::enter);
+    ASSERT_EQ(events[1].sensor, sensor_entity);
+    ASSERT_EQ(events[1].other, entity);
+    ASSERT_EQ(events[1].type, edyn::sensor_event_type::exit);
+
+    ASSERT_TRUE(registry.view<edyn::contact_manifold>().empty());
+    ASSERT_SCALAR_EQ(registry.get<edyn::linvel>(entity).y, edyn::scalar(-6));
+}
+
+TEST_F(test_sensor, aabb_only) {
+    auto sensor_def = edyn::rigidbody_def{};
+    sensor_def.kind = edyn::rigidbody_kind::rb_static;
+    sensor_def.shape = edyn::sphere_shape{1};
+    sensor_def.sensor = true;
+    auto exact_sensor = edyn::make_rigidbody(registry, sensor_def);
+    sensor_def.position = {10, 0, 0};
+    sensor_def.sensor_exact = false;
+    auto aabb_sensor = edyn::make_rigidbody(registry, sensor_def);
+
+    // Boxes near a corner of the AABB of each sensor, outside of the sphere.
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::box_shape{0.1, 0.1, 0.1};
+    def.gravity = edyn::vector3_zero;
+    def.position = {0.85, 0.85, 0};
+    edyn::make_rigidbody(registry, def);
+    def.position = {10.85, 0.85, 0};
+    auto entity = edyn::make_rigidbody(registry, def);
+
+    auto events = step(2);
+    ASSERT_EQ(events.size(), 1);
+    ASSERT_EQ(events[0].sensor, aabb_sensor);
+    ASSERT_EQ(events[0].other, entity);
+    ASSERT_EQ(events[0].type, edyn::sensor_event_type::enter);
+    ASSERT_NE(events[0].sensor, exact_sensor);
+
+    // Destroying the entity inside of the sensor ends the overlap.
+    registry.destroy(entity);
+    events = step(1);
+    ASSERT_EQ(events.size(), 1);
+    ASSERT_EQ(events[0].sensor, aabb_sensor);
+    ASSERT_EQ(events[0].type, edyn::sensor_event_type::exit);
+}
+
+TEST_F(test_sensor, does_not_merge_islands) {
+    edyn::set_collect_collision_stats(registry, true);
+
+    auto sensor_def = edyn::rigidbody_def{};
+    sensor_def.kind = edyn::rigidbody_kind::rb_kinematic;
+    sensor_def.shape = edyn::box_shape{2, 2, 2};
+    sensor_def.sensor = true;
+    edyn::make_rigidbody(registry, sensor_def);
+
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::sphere_shape{0.5};
+    def.gravity = edyn::vector3_zero;
+    def.position = {-1, 0, 0};
+    edyn::make_rigidbody(registry, def);
+    def.position = {1, 0, 0};
+    edyn::make_rigidbody(registry, def);
+
+    auto events = step(2);
+    ASSERT_EQ(events.size(), 2);
+    ASSERT_TRUE(registry.view<edyn::contact_manifold>().empty());
+    ASSERT_EQ(edyn::get_collision_stats(registry).num_awake_islands, 2);
+}
@@ -0,0 +1,90 @@
+#include "../common/common.hpp"
+
+TEST(test_shape_cast, sphere_plane) {
+    auto plane = edyn::plane_shape{{0, 1, 0}, 0};
+    auto ctx = edyn::shape_cast_context{};
+    ctx.pos = edyn::vector3_zero;
+    ctx.orn = edyn::quaternion_identity;
+    ctx.query.shape = edyn::sphere_shape{0.5};
+    ctx.query.p0 = {0, 3, 0};
+    ctx.query.p1 = {0, -1, 0};
+
+    auto result = edyn::shape_cast(plane, ctx);
+    ASSERT_NEAR(result.fraction, edyn::scalar(0.625), edyn::scalar(0.001));
+    ASSERT_NEAR(result.normal.y, edyn::scalar(1), edyn::scalar(0.001));
+
+    // Moving away from the plane.
+    ctx.query.p1 = {0, 5, 0};
+    result = edyn::shape_cast(plane, ctx);
+    ASSERT_EQ(result.fraction, EDYN_SCALAR_MAX);
+}
+
+TEST(test_shape_cast, capsule_box_miss) {
+    auto box = edyn::box_shape{0.5, 0.5, 0.5};
+    auto ctx = edyn::shape_cast_context{};
+    ctx.pos = edyn::vector3_zero;
+    ctx.orn = edyn::quaternion_identity;
+    ctx.query.shape = edyn::capsule_shape{0.25, 0.5};
+    ctx.query.p0 = {-3, 2, 0};
+    ctx.query.p1 = {3, 2, 0};
+
+    auto result = edyn::shape_cast(box, ctx);
+    ASSERT_EQ(result.fraction, EDYN_SCALAR_MAX);
+
+    // Lower it so the capsule, which lies along the x axis, hits the side of
+    // the box with its cap.
+    ctx.query.p0.y = ctx.query.p1.y = 0;
+    result = edyn::shape_cast(box, ctx);
+    ASSERT_NEAR(result.fraction, edyn::scalar(1.75 / 6), edyn::scalar(0.001));
+    ASSERT_NEAR(result.normal.x, edyn::scalar(-1), edyn::scalar(0.001));
+}
+
+TEST(test_shape_cast, shape_cast_batch) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+
+    auto floor_def = edyn::rigidbody_def{};
+    floor_def.kind = edyn::rigidbody_kind::rb_static;
+    floor_def.shape = edyn::plane_shape{{0, 1, 0}, 0};
+    auto floor_entity = edyn::make_rigidbody(registry, floor_def);
+
+    auto def = edyn::rigidbody_def{};
+    def.kind = edyn::rigidbody_kind::rb_static;
+    def.shape = edyn::box_shape{0.5, 0.5, 0.5};
+    def.position = {0, 0.5, 0};
+    auto box_entity = edyn::make_rigidbody(registry, def);
+    edyn::update(registry);
+
+    auto queries = std::vector<edyn::shape_cast_query>(3);
+    // Straight down onto the box.
+    queries[0].shape = edyn::box_shape{0.25, 0.25, 0.25};
+    queries[0].p0 = {0, 3, 0};
+    queries[0].p1 = {0, 0, 0};
+    // Down onto the floor, next to the box.
+    queries[1].shape = edyn::sphere_shape{0.5};
+    queries[1].p0 = {3, 3, 0};
+    queries[1].p1 = {3, -1, 0};
+    // Above everything.
+    queries[2].shape = edyn::sphere_shape{0.5};
+    queries[2].p0 = {-3, 3, 0};
+    queries[2].p1 = {3, 3, 0};
+
+    auto results = edyn::shape_cast_batch(registry, queries);
+    ASSERT_EQ(results.size(), 3);
+    ASSERT_EQ(results[0].entity, box_entity);
+    ASSERT_NEAR(results[0].fraction, edyn::scalar(1.75 / 3), edyn::scalar(0.001));
+    ASSERT_EQ(results[1].entity, floor_entity);
+    ASSERT_NEAR(results[1].fraction, edyn::scalar(0.625), edyn::scalar(0.001));
+    ASSERT_EQ(results[2].entity, entt::null);
+
+    // Ignoring the box, a sweep through it which ends above the floor hits
+    // nothing.
+    auto query = queries[0];
+    query.p1 = {0, 0.5, 0};
+    auto result = edyn::shape_cast(registry, query, {box_entity});
+    ASSERT_EQ(result.entity, entt::null);
+
+    edyn::detach(registry);
+}
@@ -0,0 +1,179 @@
+#include "../common/common.hpp"
+#include "edyn/collision/static_tree.hpp"
+#include <algorithm>
+#include <thread>
+#include <entt/signal/delegate.hpp>
+
+// Grid of thin boxes resembling the triangles of a terrain.
+static std::vector<edyn::AABB> make_terrain_aabbs(int size) {
+    auto aabbs = std::vector<edyn::AABB>{};
+
+    for (int x = 0; x < size; ++x) {
+        for (int z = 0; z < size; ++z) {
+            auto y = edyn::scalar(std::sin(x * 0.3) + std::cos(z * 0.2));
+            auto min = edyn::vector3{edyn::scalar(x), y - edyn::scalar(0.2), edyn::scalar(z)};
+            auto max = edyn::vector3{edyn::scalar(x + 1), y + edyn::scalar(0.2), edyn::scalar(z + 1)};
+            aabbs.push_back({min, max});
+        }
+    }
+
+    return aabbs;
+}
+
+// Builds the tree and stores the ids in each leaf, which is indexed by node id.
+template<typename BuildFunc>
+static std::vector<std::vector<uint32_t>> build_tree(edyn::static_tree &tree, BuildFunc build) {
+    auto leaves = std::vector<std::vector<uint32_t>>{};
+    auto report_leaf = [&](edyn::static_tree::tree_node &node, auto ids_begin, auto ids_end) {
+        node.id = static_cast<uint32_t>(leaves.size());
+        leaves.emplace_back(ids_begin, ids_end);
+    };
+    build(report_leaf);
+    return leaves;
+}
+
+static std::vector<uint32_t> query_tree(const edyn::static_tree &tree,
+                                        const std::vector<std::vector<uint32_t>> &leaves,
+                                        const std::vector<edyn::AABB> &aabbs,
+                                        const edyn::AABB &aabb) {
+    auto result = std::vector<uint32_t>{};
+    tree.query(aabb, [&](uint32_t node_id) {
+        for (auto id : leaves[tree.get_node(node_id).id]) {
+            if (edyn::intersect(aabbs[id], aabb)) {
+                result.push_back(id);
+            }
+        }
+    });
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+static std::vector<uint32_t> query_brute_force(const std::vector<edyn::AABB> &aabbs, const edyn::AABB &aabb) {
+    auto result = std::vector<uint32_t>{};
+
+    for (uint32_t id = 0; id < aabbs.size(); ++id) {
+        if (edyn::intersect(aabbs[id], aabb)) {
+            result.push_back(id);
+        }
+    }
+
+    return result;
+}
+
+static void assert_leaves_valid(const std::vector<std::vector<uint32_t>> &leaves,
+                                size_t num_objects, uint32_t max_obj_per_leaf) {
+    auto ids = std::vector<uint32_t>{};
+
+    for (auto &leaf : leaves) {
+        ASSERT_FALSE(leaf.empty());
+        ASSERT_LE(leaf.size(), max_obj_per_leaf);
+        ids.insert(ids.end(), leaf.begin(), leaf.end());
+    }
+
+    // Every object must be in exactly one leaf.
+    std::sort(ids.begin(), ids.end());
+    ASSERT_EQ(ids.size(), num_objects);
+
+    for (uint32_t i = 0; i < ids.size(); ++i) {
+        ASSERT_EQ(ids[i], i);
+    }
+}
+
+static void assert_queries_match(const edyn::static_tree &tree,
+                                 const std::vector<std::vector<uint32_t>> &leaves,
+                                 const std::vector<edyn::AABB> &aabbs) {
+    for (int i = 0; i < 50; ++i) {
+        auto center = edyn::vector3{edyn::scalar((i * 7) % 64), edyn::scalar(i % 3) - 1, edyn::scalar((i * 13) % 64)};
+        auto half = edyn::vector3{edyn::scalar(1 + i % 4), 1, edyn::scalar(0.5 + i % 3)};
+        auto aabb = edyn::AABB{center - half, center + half};
+        ASSERT_EQ(query_tree(tree, leaves, aabbs, aabb), query_brute_force(aabbs, aabb));
+    }
+}
+
+// Runs each task in a separate thread, cutting the range in a few pieces.
+static void enqueue_task_wait_threads(edyn::task_delegate_t task, unsigned size) {
+    auto threads = std::vector<std::thread>{};
+    unsigned step = std::max(size / 4u, 1u);
+
+    for (unsigned start = 0; start < size; start += step) {
+        auto end = std::min(start + step, size);
+        threads.emplace_back([task, start, end] { task(start, end); });
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+TEST(test_static_tree, sah_query_matches_brute_force) {
+    auto aabbs = make_terrain_aabbs(64);
+    auto tree = edyn::static_tree{};
+    auto max_obj_per_leaf = 4u;
+    auto leaves = build_tree(tree, [&](auto &report_leaf) {
+        tree.build_sah(aabbs.begin(), aabbs.end(), report_leaf, max_obj_per_leaf);
+    });
+
+    assert_leaves_valid(leaves, aabbs.size(), max_obj_per_leaf);
+    assert_queries_match(tree, leaves, aabbs);
+
+    auto &stats = tree.get_build_stats();
+    ASSERT_EQ(stats.num_leaves, leaves.size());
+    ASSERT_EQ(stats.num_nodes, stats.num_leaves * 2 - 1);
+    ASSERT_GT(stats.max_depth, 0);
+    ASSERT_GT(stats.sah_cost, 0);
+}
+
+TEST(test_static_tree, sah_cost_not_worse_than_median) {
+    auto aabbs = make_terrain_aabbs(64);
+
+    auto median_tree = edyn::static_tree{};
+    auto median_leaves = build_tree(median_tree, [&](auto &report_leaf) {
+        median_tree.build(aabbs.begin(), aabbs.end(), report_leaf, 4);
+    });
+
+    auto sah_tree = edyn::static_tree{};
+    auto sah_leaves = build_tree(sah_tree, [&](auto &report_leaf) {
+        sah_tree.build_sah(aabbs.begin(), aabbs.end(), report_leaf, 4);
+    });
+
+    ASSERT_EQ(median_tree.get_build_stats().num_leaves, median_leaves.size());
+    ASSERT_GT(median_tree.get_build_stats().sah_cost, 0);
+    ASSERT_LE(sah_tree.get_build_stats().sah_cost, median_tree.get_build_stats().sah_cost);
+}
+
+TEST(test_static_tree, sah_parallel_build) {
+    auto aabbs = make_terrain_aabbs(128);
+    auto max_obj_per_leaf = 2u;
+
+    auto sequential_tree = edyn::static_tree{};
+    build_tree(sequential_tree, [&](auto &report_leaf) {
+        sequential_tree.build_sah(aabbs.begin(), aabbs.end(), report_leaf, max_obj_per_leaf);
+    });
+
+    auto enqueue_task_wait = &enqueue_task_wait_threads;
+    auto tree = edyn::static_tree{};
+    auto leaves = build_tree(tree, [&](auto &report_leaf) {
+        tree.build_sah(aabbs.begin(), aabbs.end(), report_leaf, max_obj_per_leaf, enqueue_task_wait);
+    });
+
+    assert_leaves_valid(leaves, aabbs.size(), max_obj_per_leaf);
+    assert_queries_match(tree, leaves, aabbs);
+
+    // Building in parallel yields the same tree with nodes in another order.
+    auto &stats = tree.get_build_stats();
+    auto &sequential_stats = sequential_tree.get_build_stats();
+    ASSERT_EQ(stats.num_nodes, sequential_stats.num_nodes);
+    ASSERT_EQ(stats.num_leaves, sequential_stats.num_leaves);
+    ASSERT_EQ(stats.max_depth, sequential_stats.max_depth);
+    ASSERT_SCALAR_EQ(stats.sah_cost, sequential_stats.sah_cost);
+}
+
+TEST(test_static_tree, sah_coincident_centroids) {
+    auto aabbs = std::vector<edyn::AABB>(10, edyn::AABB{edyn::vector3_zero, edyn::vector3_one});
+    auto tree = edyn::static_tree{};
+    auto leaves = build_tree(tree, [&](auto &report_leaf) {
+        tree.build_sah(aabbs.begin(), aabbs.end(), report_leaf, 3);
+    });
+
+    assert_leaves_valid(leaves, aabbs.size(), 3);
+}
@@ -0,0 +1,117 @@
+#include "../common/common.hpp"
+#include "edyn/collision/sweep_and_prune.hpp"
+#include <algorithm>
+#include <random>
+#include <set>
+
+using pair_set = std::set<std::pair<entt::entity, entt::entity>>;
+
+static std::pair<entt::entity, entt::entity> ordered_pair(entt::entity a, entt::entity b) {
+    return a < b ? std::make_pair(a, b) : std::make_pair(b, a);
+}
+
+static edyn::AABB random_aabb(std::mt19937 &rng) {
+    auto pos = std::uniform_real_distribution<edyn::scalar>(0, 20);
+    auto size = std::uniform_real_distribution<edyn::scalar>(0.1, 1.5);
+    auto center = edyn::vector3{pos(rng), pos(rng) * edyn::scalar(0.2), pos(rng) * edyn::scalar(0.5)};
+    auto half = edyn::vector3{size(rng), size(rng), size(rng)};
+    return {center - half, center + half};
+}
+
+TEST(test_sweep_and_prune, matches_brute_force) {
+    auto sap = edyn::sweep_and_prune{};
+    auto rng = std::mt19937{42};
+    auto aabbs = std::vector<edyn::AABB>{};
+    auto alive = std::vector<bool>{};
+
+    for (int i = 0; i < 300; ++i) {
+        aabbs.push_back(random_aabb(rng));
+        alive.push_back(true);
+        sap.insert(entt::entity(i), aabbs.back());
+    }
+
+    auto pick = std::uniform_int_distribution<size_t>(0, aabbs.size() - 1);
+
+    for (int step = 0; step < 10; ++step) {
+        auto moved = std::vector<bool>(aabbs.size(), step == 0);
+
+        if (step > 0) {
+            for (int k = 0; k < 40; ++k) {
+                auto i = pick(rng);
+                if (!alive[i]) continue;
+
+                if (k % 10 == 0) {
+                    sap.erase(entt::entity(i));
+                    alive[i] = false;
+                } else {
+                    aabbs[i] = random_aabb(rng);
+                    sap.set_aabb(entt::entity(i), aabbs[i]);
+                    moved[i] = true;
+                }
+            }
+        }
+
+        sap.sort();
+
+        auto found = pair_set{};
+        sap.find_pairs(false, [&](entt::entity a, entt::entity b) {
+            ASSERT_NE(a, b);
+            ASSERT_TRUE(found.insert(ordered_pair(a, b)).second);
+        });
+        sap.clear_moved();
+
+        auto expected = pair_set{};
+
+        for (size_t i = 0; i < aabbs.size(); ++i) {
+            for (size_t j = i + 1; j < aabbs.size(); ++j) {
+                if (alive[i] && alive[j] && (moved[i] || moved[j]) && intersect(aabbs[i], aabbs[j])) {
+                    expected.insert(ordered_pair(entt::entity(i), entt::entity(j)));
+                }
+            }
+        }
+
+        ASSERT_EQ(found, expected);
+        ASSERT_EQ(sap.size(), size_t(std::count(alive.begin(), alive.end(), true)));
+    }
+
+    // The centers are most spread out along x.
+    ASSERT_EQ(sap.axis(), 0);
+}
+
+TEST(test_sweep_and_prune, filters_and_moved) {
+    auto sap = edyn::sweep_and_prune{};
+    auto aabb = edyn::AABB{{-1, -1, -1}, {1, 1, 1}};
+    sap.insert(entt::entity(0), aabb, {0x1, ~0x2ull});
+    sap.insert(entt::entity(1), aabb, {0x2, ~0x1ull});
+    sap.insert(entt::entity(2), aabb);
+    sap.sort();
+
+    auto num_pairs = 0;
+    sap.find_pairs(true, [&](entt::entity, entt::entity) { ++num_pairs; });
+    ASSERT_EQ(num_pairs, 2);
+
+    num_pairs = 0;
+    sap.find_pairs(false, [&](entt::entity, entt::entity) { ++num_pairs; });
+    ASSERT_EQ(num_pairs, 3);
+
+    // Nothing moved.
+    sap.clear_moved();
+    num_pairs = 0;
+    sap.find_pairs(false, [&](entt::entity, entt::entity) { ++num_pairs; });
+    ASSERT_EQ(num_pairs, 0);
+
+    // Only pairs involving the moved entity are reported.
+    sap.set_aabb(entt::entity(2), aabb);
+    sap.sort();
+    sap.find_pairs(true, [&](entt::entity a, entt::entity b) {
+        ASSERT_TRUE(a == entt::entity(2) || b == entt::entity(2));
+        ++num_pairs;
+    });
+    ASSERT_EQ(num_pairs, 2);
+
+    sap.shift_origin({10, 0, 0});
+    sap.erase(entt::entity(1));
+    sap.sort();
+    ASSERT_EQ(sap.size(), 2);
+    ASSERT_FALSE(sap.contains(entt::entity(1)));
+}
@@ -0,0 +1,205 @@
+#include "../common/common.hpp"
+#include "edyn/comp/island.hpp"
+#include "edyn/dynamics/articulation.hpp"
+#include "edyn/dynamics/row_cache.hpp"
+#include <random>
+
+class articulation_test : public ::testing::Test {
+protected:
+    std::vector<edyn::solver_body> bodies;
+    std::vector<edyn::constraint_row> rows;
+    std::vector<edyn::articulation_joint> joints;
+
+    void SetUp() override {
+        // The fixed body.
+        bodies.emplace_back();
+    }
+
+    edyn::solver_body_index_t add_body(edyn::scalar mass) {
+        auto &body = bodies.emplace_back();
+        body.inv_m = 1 / mass;
+        body.inv_I = edyn::diagonal_matrix(edyn::vector3_one * 2 / mass);
+        return static_cast<edyn::solver_body_index_t>(bodies.size() - 1);
+    }
+
+    // Ball joint between two bodies with pivots relative to their centers.
+    void add_point_joint(edyn::solver_body_index_t bodyA, edyn::solver_body_index_t bodyB,
+                         const edyn::vector3 &rA, const edyn::vector3 &rB) {
+        auto &joint = joints.emplace_back();
+        joint.first_row = static_cast<unsigned>(rows.size());
+        joint.num_rows = 3;
+
+        for (auto axis : {edyn::vector3_x, edyn::vector3_y, edyn::vector3_z}) {
+            auto &row = rows.emplace_back();
+            row.J = {axis, edyn::cross(rA, axis), -axis, -edyn::cross(rB, axis)};
+            row.body = {bodyA, bodyB};
+            row.lower_limit = -edyn::large_scalar;
+            row.upper_limit = edyn::large_scalar;
+            row.rhs = 0;
+            row.impulse = 0;
+
+            auto &A = bodies[bodyA];
+            auto &B = bodies[bodyB];
+            auto J_invM_JT = dot(row.J[0], row.J[0]) * A.inv_m +
+                             dot(A.inv_I * row.J[1], row.J[1]) +
+                             dot(row.J[2], row.J[2]) * B.inv_m +
+                             dot(B.inv_I * row.J[3], row.J[3]);
+            row.eff_mass = 1 / J_invM_JT;
+        }
+    }
+
+    edyn::scalar relative_velocity(const edyn::constraint_row &row) {
+        auto &bodyA = bodies[row.body[0]];
+        auto &bodyB = bodies[row.body[1]];
+        return dot(row.J[0], bodyA.dv) + dot(row.J[1], bodyA.dw) +
+               dot(row.J[2], bodyB.dv) + dot(row.J[3], bodyB.dw);
+    }
+
+    void randomize_velocities() {
+        std::mt19937 gen {42};
+        std::uniform_real_distribution<edyn::scalar> dist {-1, 1};
+
+        for (size_t i = 1; i < bodies.size(); ++i) {
+            bodies[i].dv = {dist(gen), dist(gen), dist(gen)};
+            bodies[i].dw = {dist(gen), dist(gen), dist(gen)};
+        }
+    }
+
+    // Chain of bodies hanging from the fixed body with masses that vary by
+    // two orders of magnitude, which is hard for the iterative solver.
+    void make_chain(unsigned num_bodies) {
+        auto prev = edyn::fixed_solver_body_index;
+
+        for (unsigned i = 0; i < num_bodies; ++i) {
+            auto body = add_body(i % 2 == 0 ? edyn::scalar(100) : edyn::scalar(1));
+            auto rA = prev == edyn::fixed_solver_body_index ? edyn::vector3_zero : edyn::vector3{0, -0.5, 0};
+            add_point_joint(prev, body, rA, {0, 0.5, 0});
+            prev = body;
+        }
+    }
+};
+
+TEST_F(articulation_test, chain_is_solved_in_one_iteration) {
+    make_chain(10);
+    randomize_velocities();
+
+    auto articulations = std::vector<edyn::articulation>{};
+    auto articulated_rows = std::vector<unsigned>{};
+    edyn::make_articulations(joints, rows, bodies, articulations, articulated_rows);
+
+    ASSERT_EQ(articulations.size(), 1);
+    ASSERT_EQ(articulated_rows.size(), rows.size());
+
+    edyn::solve_articulation(articulations[0], rows, bodies);
+
+    for (auto &row : rows) {
+        ASSERT_NEAR(relative_velocity(row), 0, 0.001);
+    }
+
+    // Solving again must not change anything.
+    auto residual = edyn::solve_articulation(articulations[0], rows, bodies);
+    ASSERT_NEAR(residual, 0, 0.001);
+}
+
+TEST_F(articulation_test, loops_and_limited_rows_are_left_out) {
+    auto bodyA = add_body(1);
+    auto bodyB = add_body(1);
+    auto bodyC = add_body(1);
+    add_point_joint(bodyA, bodyB, {0.5, 0, 0}, {-0.5, 0, 0});
+    add_point_joint(bodyB, bodyC, {0.5, 0, 0}, {-0.5, 0, 0});
+    // Closes a loop.
+    add_point_joint(bodyC, bodyA, {0, 0.5, 0}, {0, 0.5, 0});
+    // A limited row of the first joint.
+    rows[0].lower_limit = 0;
+
+    auto articulations = std::vector<edyn::articulation>{};
+    auto articulated_rows = std::vector<unsigned>{};
+    edyn::make_articulations(joints, rows, bodies, articulations, articulated_rows);
+
+    ASSERT_EQ(articulations.size(), 1);
+    ASSERT_EQ(articulated_rows, (std::vector<unsigned>{1, 2, 3, 4, 5}));
+}
+
+TEST_F(articulation_test, second_ground_joint_is_left_out) {
+    make_chain(5);
+    add_point_joint(static_cast<edyn::solver_body_index_t>(bodies.size() - 1),
+                    edyn::fixed_solver_body_index, {0, -0.5, 0}, {0, -5, 0});
+    randomize_velocities();
+
+    auto articulations = std::vector<edyn::articulation>{};
+    auto articulated_rows = std::vector<unsigned>{};
+    edyn::make_articulations(joints, rows, bodies, articulations, articulated_rows);
+
+    ASSERT_EQ(articulations.size(), 1);
+    ASSERT_EQ(articulated_rows.size(), rows.size() - 3);
+
+    edyn::solve_articulation(articulations[0], rows, bodies);
+
+    for (auto i : articulated_rows) {
+        ASSERT_NEAR(relative_velocity(rows[i]), 0, 0.001);
+    }
+}
+
+// Rope of distance constraints with a branch in the middle, hanging from a
+// static anchor. Returns how far the end of the rope fell below its rest
+// position.
+static edyn::scalar hang_rope(bool articulate, size_t &num_articulated_rows) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+    edyn::set_paused(registry, true);
+    edyn::set_solver_velocity_iterations(registry, 4);
+    edyn::set_articulate_distance_chains(registry, articulate);
+
+    auto anchor_def = edyn::rigidbody_def{};
+    anchor_def.kind = edyn::rigidbody_kind::rb_static;
+    auto prev = edyn::make_rigidbody(registry, anchor_def);
+
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::sphere_shape{0.2};
+    def.mass = 1;
+    auto link = [&](entt::entity entityA, entt::entity entityB) {
+        edyn::make_constraint<edyn::distance_constraint>(registry, entityA, entityB, [](auto &con) {
+            con.pivot[0] = edyn::vector3_zero;
+            con.pivot[1] = edyn::vector3_zero;
+            con.distance = 1;
+        });
+    };
+
+    for (int i = 0; i < 30; ++i) {
+        def.position = {0, edyn::scalar(-1 - i), 0};
+        auto body = edyn::make_rigidbody(registry, def);
+        link(prev, body);
+
+        // The three links of the body at the branch point are solved
+        // iteratively.
+        if (i == 10) {
+            def.position = {1, edyn::scalar(-1 - i), 0};
+            link(body, edyn::make_rigidbody(registry, def));
+        }
+
+        prev = body;
+    }
+
+    for (int i = 0; i < 60; ++i) {
+        edyn::step_simulation(registry);
+    }
+
+    auto island_entity = registry.get<edyn::island_resident>(prev).island_entity;
+    num_articulated_rows = registry.get<edyn::row_cache>(island_entity).articulated_rows.size();
+    auto stretch = -30 - registry.get<edyn::position>(prev).y;
+    edyn::detach(registry);
+
+    return stretch;
+}
+
+TEST(test_articulation, distance_chains) {
+    size_t num_articulated_rows;
+    auto iterative_stretch = hang_rope(false, num_articulated_rows);
+    ASSERT_EQ(num_articulated_rows, 0);
+
+    auto articulated_stretch = hang_rope(true, num_articulated_rows);
+    ASSERT_EQ(num_articulated_rows, 31 - 3);
+    ASSERT_LT(articulated_stretch, iterative_stretch);
+}
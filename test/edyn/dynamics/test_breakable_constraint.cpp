@@ -0,0 +1,70 @@
+#include "../common/common.hpp"
+
+class test_breakable_constraint : public ::testing::Test {
+protected:
+    void SetUp() override {
+        auto config = edyn::init_config{};
+        config.execution_mode = edyn::execution_mode::sequential;
+        edyn::attach(registry, config);
+        edyn::set_paused(registry, true);
+
+        auto anchor_def = edyn::rigidbody_def{};
+        anchor_def.kind = edyn::rigidbody_kind::rb_static;
+        anchor = edyn::make_rigidbody(registry, anchor_def);
+
+        // A 2kg ball hanging from the anchor, which needs an impulse of
+        // `2 * 9.8 * dt` per step to hold it up.
+        auto def = edyn::rigidbody_def{};
+        def.mass = 2;
+        def.shape = edyn::sphere_shape{0.2};
+        def.position = {0, -1, 0};
+        ball = edyn::make_rigidbody(registry, def);
+
+        joint = edyn::make_constraint<edyn::point_constraint>(registry, anchor, ball, [](auto &con) {
+            con.pivot[0] = edyn::vector3_zero;
+            con.pivot[1] = {0, 1, 0};
+        });
+    }
+
+    void TearDown() override {
+        edyn::detach(registry);
+    }
+
+    entt::registry registry;
+    entt::entity anchor;
+    entt::entity ball;
+    entt::entity joint;
+};
+
+TEST_F(test_breakable_constraint, holds_below_threshold) {
+    registry.emplace<edyn::breakable_constraint>(joint, edyn::scalar(1));
+
+    for (int i = 0; i < 60; ++i) {
+        edyn::step_simulation(registry);
+        ASSERT_TRUE(edyn::get_constraint_break_events(registry).empty());
+    }
+
+    ASSERT_TRUE(registry.valid(joint));
+    ASSERT_NEAR(registry.get<edyn::position>(ball).y, -1, 0.01);
+}
+
+TEST_F(test_breakable_constraint, breaks_above_threshold) {
+    registry.emplace<edyn::breakable_constraint>(joint, edyn::scalar(0.1));
+    edyn::step_simulation(registry);
+
+    auto &events = edyn::get_constraint_break_events(registry);
+    ASSERT_EQ(events.size(), 1);
+    ASSERT_EQ(events[0].entity, joint);
+    ASSERT_EQ(events[0].body[0], anchor);
+    ASSERT_EQ(events[0].body[1], ball);
+    ASSERT_GT(events[0].impulse, edyn::scalar(0.1));
+    ASSERT_FALSE(registry.valid(joint));
+
+    // The ball falls freely once the joint is gone.
+    for (int i = 0; i < 30; ++i) {
+        edyn::step_simulation(registry);
+        ASSERT_TRUE(edyn::get_constraint_break_events(registry).empty());
+    }
+
+    ASSERT_LT(registry.get<edyn::position>(ball).y, edyn::scalar(-2));
+}
@@ -0,0 +1,99 @@
+#include "../common/common.hpp"
+#include "edyn/comp/island.hpp"
+#include "edyn/dynamics/island_constraint_entities.hpp"
+#include "edyn/dynamics/row_cache.hpp"
+#include "edyn/util/tuple_util.hpp"
+
+class test_constraint_preparation : public ::testing::Test {
+protected:
+    void SetUp() override {
+        auto config = edyn::init_config{};
+        config.execution_mode = edyn::execution_mode::sequential;
+        edyn::attach(registry, config);
+        edyn::set_paused(registry, true);
+
+        auto anchor_def = edyn::rigidbody_def{};
+        anchor_def.kind = edyn::rigidbody_kind::rb_static;
+        auto anchor = edyn::make_rigidbody(registry, anchor_def);
+
+        // Two balls hanging in a chain. The first joint has two constraints
+        // of different types in the same entity.
+        auto def = edyn::rigidbody_def{};
+        def.shape = edyn::sphere_shape{0.2};
+        def.position = {0, -1, 0};
+        ball = edyn::make_rigidbody(registry, def);
+        def.position = {0, -2, 0};
+        auto ball2 = edyn::make_rigidbody(registry, def);
+
+        joint = edyn::make_constraint<edyn::point_constraint>(registry, anchor, ball, [](auto &con) {
+            con.pivot[0] = edyn::vector3_zero;
+            con.pivot[1] = {0, 1, 0};
+        });
+        edyn::make_constraint<edyn::distance_constraint>(registry, joint, anchor, ball, [](auto &con) {
+            con.pivot[0] = edyn::vector3_zero;
+            con.pivot[1] = edyn::vector3_zero;
+            con.distance = 1;
+        });
+
+        joint2 = edyn::make_constraint<edyn::point_constraint>(registry, ball, ball2, [](auto &con) {
+            con.pivot[0] = edyn::vector3_zero;
+            con.pivot[1] = {0, 1, 0};
+        });
+    }
+
+    void TearDown() override {
+        edyn::detach(registry);
+    }
+
+    const edyn::island_constraint_entities & get_constraint_entities() {
+        auto island_entity = registry.get<edyn::island_resident>(ball).island_entity;
+        return registry.get<edyn::island_constraint_entities>(island_entity);
+    }
+
+    entt::registry registry;
+    entt::entity ball;
+    entt::entity joint;
+    entt::entity joint2;
+};
+
+TEST_F(test_constraint_preparation, multiple_types_in_one_entity) {
+    for (int i = 0; i < 30; ++i) {
+        edyn::step_simulation(registry);
+    }
+
+    auto point_idx = edyn::tuple_index_of<unsigned, edyn::point_constraint>(edyn::constraints_tuple);
+    auto distance_idx = edyn::tuple_index_of<unsigned, edyn::distance_constraint>(edyn::constraints_tuple);
+    auto &constraint_entities = get_constraint_entities();
+    ASSERT_EQ(constraint_entities.entities[point_idx].size(), 2);
+    ASSERT_EQ(constraint_entities.entities[distance_idx].size(), 1);
+    ASSERT_EQ(constraint_entities.entities[distance_idx][0], joint);
+
+    ASSERT_EQ(registry.get<edyn::constraint_row_prep_cache>(joint).type_index,
+              edyn::constraint_row_prep_cache::multiple_types);
+    ASSERT_EQ(registry.get<edyn::constraint_row_prep_cache>(joint2).type_index, point_idx);
+    ASSERT_EQ(registry.get<edyn::constraint_row_prep_cache>(joint).num_constraints, 2);
+
+    ASSERT_NEAR(registry.get<edyn::position>(ball).y, -1, 0.01);
+}
+
+TEST_F(test_constraint_preparation, type_removed_from_entity) {
+    for (int i = 0; i < 10; ++i) {
+        edyn::step_simulation(registry);
+    }
+
+    registry.remove<edyn::distance_constraint>(joint);
+
+    for (int i = 0; i < 10; ++i) {
+        edyn::step_simulation(registry);
+    }
+
+    auto point_idx = edyn::tuple_index_of<unsigned, edyn::point_constraint>(edyn::constraints_tuple);
+    auto distance_idx = edyn::tuple_index_of<unsigned, edyn::distance_constraint>(edyn::constraints_tuple);
+    auto &constraint_entities = get_constraint_entities();
+    ASSERT_EQ(constraint_entities.entities[point_idx].size(), 2);
+    ASSERT_TRUE(constraint_entities.entities[distance_idx].empty());
+    ASSERT_EQ(registry.get<edyn::constraint_row_prep_cache>(joint).type_index, point_idx);
+    ASSERT_EQ(registry.get<edyn::constraint_row_prep_cache>(joint).num_constraints, 1);
+
+    ASSERT_NEAR(registry.get<edyn::position>(ball).y, -1, 0.01);
+}
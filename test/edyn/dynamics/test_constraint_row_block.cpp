@@ -0,0 +1,145 @@
+#include "../common/common.hpp"
+#include "edyn/constraints/constraint_row_block.hpp"
+#include <random>
+
+class constraint_row_block_test : public ::testing::Test {
+protected:
+    std::vector<edyn::solver_body> bodies;
+    std::vector<edyn::constraint_row> rows;
+
+    void SetUp() override {
+        // A fixed body and a dynamic body with unit mass and inertia.
+        bodies.emplace_back();
+        auto &body = bodies.emplace_back();
+        body.inv_m = 1;
+        body.inv_I = edyn::matrix3x3_identity;
+    }
+
+    // Contact point along the vertical axis between the fixed body and the
+    // dynamic body with pivot `rB` relative to the center of mass of the
+    // dynamic body.
+    void add_contact(const edyn::vector3 &rB) {
+        auto normal = edyn::vector3_y;
+        auto &row = rows.emplace_back();
+        row.J = {-normal, edyn::vector3_zero, normal, edyn::cross(rB, normal)};
+        row.body = {edyn::fixed_solver_body_index, 1};
+        row.eff_mass = edyn::scalar(1) / (dot(row.J[2], row.J[2]) + dot(row.J[3], row.J[3]));
+        row.rhs = 0;
+        row.lower_limit = 0;
+        row.upper_limit = edyn::large_scalar;
+        row.impulse = 0;
+    }
+
+    edyn::constraint_row_block make_block() {
+        auto block = edyn::constraint_row_block{};
+        block.first_row = 0;
+        block.num_rows = static_cast<unsigned>(rows.size());
+        edyn::prepare_block(block, rows, bodies);
+        return block;
+    }
+
+    edyn::scalar relative_velocity(const edyn::constraint_row &row) {
+        auto &body = bodies[1];
+        return dot(row.J[2], body.dv) + dot(row.J[3], body.dw);
+    }
+};
+
+TEST_F(constraint_row_block_test, resting_contact_is_solved_in_one_iteration) {
+    add_contact({-1, -0.5, 0.2});
+    add_contact({1, -0.5, 0.2});
+    bodies[1].dv = {0, -1, 0};
+    bodies[1].dw = {0, 0, 0.3};
+
+    auto block = make_block();
+    edyn::solve_block(block, rows, bodies);
+
+    for (auto &row : rows) {
+        ASSERT_GT(row.impulse, 0);
+        ASSERT_NEAR(relative_velocity(row), 0, 0.001);
+    }
+
+    // Solving again must not change anything.
+    auto residual = edyn::solve_block(block, rows, bodies);
+    ASSERT_NEAR(residual, 0, 0.001);
+}
+
+TEST_F(constraint_row_block_test, matches_converged_sequential_solver) {
+    std::mt19937 gen {42};
+    std::uniform_real_distribution<edyn::scalar> dist {-1, 1};
+    add_contact({-1, -0.5, -1});
+    add_contact({1, -0.5, -1});
+    add_contact({0.2, -0.5, 1});
+    bodies[1].dv = {dist(gen), -1, dist(gen)};
+    bodies[1].dw = {dist(gen), dist(gen), dist(gen)};
+
+    auto seq_bodies = bodies;
+    auto seq_rows = rows;
+
+    for (unsigned i = 0; i < 500; ++i) {
+        for (auto &row : seq_rows) {
+            auto delta_impulse = edyn::solve(row, seq_bodies);
+            edyn::apply_row_impulse(delta_impulse, row, seq_bodies);
+        }
+    }
+
+    auto block = make_block();
+    edyn::solve_block(block, rows, bodies);
+
+    for (size_t i = 0; i < rows.size(); ++i) {
+        ASSERT_NEAR(rows[i].impulse, seq_rows[i].impulse, 0.001);
+    }
+
+    for (unsigned c = 0; c < 3; ++c) {
+        ASSERT_NEAR(bodies[1].dv[c], seq_bodies[1].dv[c], 0.001);
+        ASSERT_NEAR(bodies[1].dw[c], seq_bodies[1].dw[c], 0.001);
+    }
+}
+
+TEST_F(constraint_row_block_test, coplanar_points_share_impulse) {
+    // The rows of the four points on a face are linearly dependent.
+    add_contact({-1, -0.5, -1});
+    add_contact({1, -0.5, -1});
+    add_contact({1, -0.5, 1});
+    add_contact({-1, -0.5, 1});
+    bodies[1].dv = {0, -1, 0};
+
+    auto block = make_block();
+    edyn::solve_block(block, rows, bodies);
+
+    for (auto &row : rows) {
+        ASSERT_NEAR(row.impulse, 0.25, 0.001);
+        ASSERT_NEAR(relative_velocity(row), 0, 0.001);
+    }
+}
+
+TEST_F(constraint_row_block_test, separating_contact_applies_no_impulse) {
+    add_contact({-1, -0.5, 0});
+    add_contact({1, -0.5, 0});
+    bodies[1].dv = {0, 1, 0};
+
+    auto block = make_block();
+    edyn::solve_block(block, rows, bodies);
+
+    for (auto &row : rows) {
+        ASSERT_EQ(row.impulse, 0);
+    }
+
+    ASSERT_EQ(bodies[1].dv, (edyn::vector3{0, 1, 0}));
+}
+
+TEST_F(constraint_row_block_test, releases_accumulated_impulse_of_separating_point) {
+    // Rotating about the z axis such that the second point is separating.
+    add_contact({-1, -0.5, 0});
+    add_contact({1, -0.5, 0});
+    bodies[1].dw = {0, 0, 1};
+
+    auto block = make_block();
+    rows[1].impulse = 0.5;
+    edyn::warm_start(rows[1], bodies);
+    edyn::solve_block(block, rows, bodies);
+
+    ASSERT_EQ(rows[1].impulse, 0);
+    ASSERT_GE(rows[0].impulse, 0);
+    ASSERT_GE(relative_velocity(rows[1]), 0);
+    ASSERT_NEAR(relative_velocity(rows[0]), 0, 0.001);
+}
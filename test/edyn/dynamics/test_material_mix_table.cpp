@@ -0,0 +1,66 @@
+#include "../common/common.hpp"
+#include "edyn/dynamics/material_mixing.hpp"
+
+TEST(test_material_mix_table, insert_get_order_independent) {
+    auto table = edyn::material_mix_table{};
+    ASSERT_TRUE(table.empty());
+    ASSERT_EQ(table.try_get({0, 1}), nullptr);
+
+    auto mat = edyn::material_base{};
+    mat.friction = 0.8;
+    table.insert({3, 7}, mat);
+
+    ASSERT_EQ(table.size(), 1);
+    ASSERT_TRUE(table.contains({3, 7}));
+    ASSERT_TRUE(table.contains({7, 3}));
+    ASSERT_FALSE(table.contains({3, 3}));
+    ASSERT_SCALAR_EQ(table.get({7, 3}).friction, 0.8);
+
+    // Inserting an existing pair replaces its material.
+    mat.friction = 0.2;
+    table.insert({7, 3}, mat);
+    ASSERT_EQ(table.size(), 1);
+    ASSERT_SCALAR_EQ(table.get({3, 7}).friction, 0.2);
+}
+
+TEST(test_material_mix_table, rehash_and_remove) {
+    auto table = edyn::material_mix_table{};
+    constexpr edyn::material::id_type num_ids = 40;
+
+    for (edyn::material::id_type i = 0; i < num_ids; ++i) {
+        for (edyn::material::id_type j = i; j < num_ids; ++j) {
+            auto mat = edyn::material_base{};
+            mat.restitution = edyn::scalar(i * num_ids + j);
+            table.insert({j, i}, mat);
+        }
+    }
+
+    ASSERT_EQ(table.size(), num_ids * (num_ids + 1) / 2);
+
+    // Remove every other pair, which shifts entries back in probe sequences.
+    for (edyn::material::id_type i = 0; i < num_ids; ++i) {
+        for (edyn::material::id_type j = i; j < num_ids; ++j) {
+            if ((i + j) % 2 == 0) {
+                table.remove({i, j});
+            }
+        }
+    }
+
+    for (edyn::material::id_type i = 0; i < num_ids; ++i) {
+        for (edyn::material::id_type j = i; j < num_ids; ++j) {
+            auto *mat = table.try_get({i, j});
+
+            if ((i + j) % 2 == 0) {
+                ASSERT_EQ(mat, nullptr);
+            } else {
+                ASSERT_NE(mat, nullptr);
+                ASSERT_SCALAR_EQ(mat->restitution, edyn::scalar(i * num_ids + j));
+            }
+        }
+    }
+
+    // Removing a missing pair does nothing.
+    auto size = table.size();
+    table.remove({0, 0});
+    ASSERT_EQ(table.size(), size);
+}
@@ -0,0 +1,105 @@
+#include "../common/common.hpp"
+#include "edyn/comp/island.hpp"
+#include "edyn/dynamics/nbody_octree.hpp"
+#include <numeric>
+#include <random>
+
+static edyn::vector3 direct_acceleration(const std::vector<edyn::vector3> &positions,
+                                         const std::vector<edyn::scalar> &masses,
+                                         const edyn::vector3 &point) {
+    auto acc = edyn::vector3_zero;
+
+    for (size_t i = 0; i < positions.size(); ++i) {
+        auto d = positions[i] - point;
+        auto l2 = edyn::length_sqr(d);
+
+        if (l2 > 0) {
+            acc += d * (masses[i] / (l2 * std::sqrt(l2)));
+        }
+    }
+
+    return acc;
+}
+
+TEST(test_nbody_gravity, octree_matches_direct_sum) {
+    auto rng = std::mt19937(3);
+    auto dist = std::uniform_real_distribution<edyn::scalar>(-10, 10);
+    auto mass_dist = std::uniform_real_distribution<edyn::scalar>(1, 5);
+    auto positions = std::vector<edyn::vector3>{};
+    auto masses = std::vector<edyn::scalar>{};
+
+    // Two clusters and a few coincident masses.
+    for (int i = 0; i < 1000; ++i) {
+        auto offset = i % 2 == 0 ? edyn::vector3{30, 0, 0} : edyn::vector3_zero;
+        positions.push_back(edyn::vector3{dist(rng), dist(rng), dist(rng)} + offset);
+        masses.push_back(mass_dist(rng));
+    }
+
+    for (int i = 0; i < 10; ++i) {
+        positions.push_back({1, 2, 3});
+        masses.push_back(1);
+    }
+
+    auto octree = edyn::nbody_octree{};
+
+    for (size_t i = 0; i < positions.size(); ++i) {
+        octree.insert(positions[i], masses[i]);
+    }
+
+    octree.build();
+    ASSERT_GT(octree.nodes().size(), 1);
+    ASSERT_SCALAR_EQ(octree.nodes().front().mass,
+                     std::accumulate(masses.begin(), masses.end(), edyn::scalar(0)));
+
+    for (size_t i = 0; i < positions.size(); i += 7) {
+        auto &p = positions[i];
+        auto expected = direct_acceleration(positions, masses, p);
+        auto exact = octree.acceleration(p, 0, 0);
+        auto approx = octree.acceleration(p, 0.5, 0);
+        auto len = edyn::length(expected);
+        ASSERT_LT(edyn::length(exact - expected), len * edyn::scalar(1e-4));
+        ASSERT_LT(edyn::length(approx - expected), len * edyn::scalar(0.02));
+    }
+}
+
+TEST(test_nbody_gravity, bodies_attract_without_constraints) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+    edyn::set_paused(registry, true);
+    edyn::set_nbody_gravity(registry, true, 1);
+
+    auto def = edyn::rigidbody_def{};
+    def.gravity = edyn::vector3_zero;
+    def.mass = 10;
+    def.shape = edyn::sphere_shape{0.5};
+    def.position = {-5, 0, 0};
+    auto rb0 = edyn::make_rigidbody(registry, def);
+    def.mass = 30;
+    def.position = {5, 0, 0};
+    auto rb1 = edyn::make_rigidbody(registry, def);
+
+    // A static body has no effect.
+    auto static_def = edyn::rigidbody_def{};
+    static_def.kind = edyn::rigidbody_kind::rb_static;
+    static_def.shape = edyn::sphere_shape{0.5};
+    static_def.position = {0, 10, 0};
+    edyn::make_rigidbody(registry, static_def);
+
+    edyn::step_simulation(registry);
+
+    auto dt = registry.ctx().get<edyn::settings>().fixed_dt;
+    auto &v0 = registry.get<edyn::linvel>(rb0);
+    auto &v1 = registry.get<edyn::linvel>(rb1);
+    ASSERT_NEAR(v0.x, 30.0 / 100 * dt, 1e-6);
+    ASSERT_NEAR(v1.x, -10.0 / 100 * dt, 1e-6);
+    ASSERT_NEAR(v0.y, 0, 1e-6);
+    ASSERT_NEAR(edyn::length(v0 * 10 + v1 * 30), 0, 1e-6);
+
+    // The bodies are not connected thus they're in separate islands.
+    ASSERT_NE(registry.get<edyn::island_resident>(rb0).island_entity,
+              registry.get<edyn::island_resident>(rb1).island_entity);
+
+    edyn::detach(registry);
+}
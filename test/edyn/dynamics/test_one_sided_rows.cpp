@@ -0,0 +1,58 @@
+#include "../common/common.hpp"
+#include "edyn/constraints/constraint_row.hpp"
+#include <random>
+
+template<size_t Side>
+void check_one_sided_row_matches_generic() {
+    std::mt19937 gen {42};
+    std::uniform_real_distribution<edyn::scalar> dist {-1, 1};
+    auto random_vec = [&]() { return edyn::vector3{dist(gen), dist(gen), dist(gen)}; };
+
+    auto bodies = std::vector<edyn::solver_body>(2);
+    auto &body = bodies[1];
+    body.inv_m = 0.5;
+    body.inv_I = edyn::diagonal_matrix(edyn::vector3{0.3, 0.7, 0.2});
+    body.dv = random_vec();
+    body.dw = random_vec();
+
+    auto row = edyn::constraint_row{};
+    row.J = {random_vec(), random_vec(), random_vec(), random_vec()};
+    row.body[Side] = 1;
+    row.body[1 - Side] = edyn::fixed_solver_body_index;
+    row.eff_mass = 0.8;
+    row.rhs = 0.5;
+    row.lower_limit = 0;
+    row.upper_limit = 1;
+    row.impulse = 0.2;
+
+    auto generic_bodies = bodies;
+    auto generic_row = row;
+
+    edyn::warm_start(generic_row, generic_bodies);
+    edyn::warm_start_one_sided<Side>(row, bodies);
+
+    for (int i = 0; i < 4; ++i) {
+        auto generic_delta = edyn::solve(generic_row, generic_bodies);
+        edyn::apply_row_impulse(generic_delta, generic_row, generic_bodies);
+
+        auto delta = edyn::solve_one_sided<Side>(row, bodies);
+        edyn::apply_row_impulse_one_sided<Side>(delta, row, bodies);
+
+        ASSERT_SCALAR_EQ(delta, generic_delta);
+        ASSERT_SCALAR_EQ(row.impulse, generic_row.impulse);
+    }
+
+    ASSERT_EQ(bodies[1].dv, generic_bodies[1].dv);
+    ASSERT_EQ(bodies[1].dw, generic_bodies[1].dw);
+    // The fixed body is never written to.
+    ASSERT_EQ(bodies[0].dv, edyn::vector3_zero);
+    ASSERT_EQ(bodies[0].dw, edyn::vector3_zero);
+}
+
+TEST(one_sided_rows_test, first_body_dynamic) {
+    check_one_sided_row_matches_generic<0>();
+}
+
+TEST(one_sided_rows_test, second_body_dynamic) {
+    check_one_sided_row_matches_generic<1>();
+}
@@ -0,0 +1,78 @@
+#include "../common/common.hpp"
+
+class test_particle : public ::testing::Test {
+protected:
+    void SetUp() override {
+        auto config = edyn::init_config{};
+        config.execution_mode = edyn::execution_mode::sequential;
+        edyn::attach(registry, config);
+        edyn::set_paused(registry, true);
+
+        auto floor_def = edyn::rigidbody_def{};
+        floor_def.kind = edyn::rigidbody_kind::rb_static;
+        floor_def.shape = edyn::plane_shape{{0, 1, 0}, 0};
+        edyn::make_rigidbody(registry, floor_def);
+    }
+
+    void TearDown() override {
+        edyn::detach(registry);
+    }
+
+    void step(unsigned num_steps) {
+        for (unsigned i = 0; i < num_steps; ++i) {
+            edyn::step_simulation(registry);
+        }
+    }
+
+    entt::registry registry;
+};
+
+TEST_F(test_particle, has_no_angular_state) {
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::sphere_shape{0.1};
+    def.position = {0, 1, 0};
+    def.linvel = {1, 0, 0};
+    def.angvel = {0, 0, 5};
+    def.material->spin_friction = 0.01;
+    def.particle = true;
+    auto entity = edyn::make_rigidbody(registry, def);
+
+    ASSERT_TRUE(edyn::validate_rigidbody(registry, entity));
+    ASSERT_TRUE(registry.all_of<edyn::particle_tag>(entity));
+    ASSERT_FALSE(registry.all_of<edyn::rolling_tag>(entity));
+    ASSERT_EQ(registry.get<edyn::angvel>(entity), edyn::vector3_zero);
+
+    // Falls, slides on the floor and comes to rest due to friction without
+    // ever rotating.
+    step(180);
+
+    auto &pos = registry.get<edyn::position>(entity);
+    auto &orn = registry.get<edyn::orientation>(entity);
+    ASSERT_NEAR(pos.y, 0.1, 0.01);
+    ASSERT_EQ(orn, edyn::quaternion_identity);
+    ASSERT_EQ(registry.get<edyn::angvel>(entity), edyn::vector3_zero);
+    ASSERT_NEAR(edyn::length(registry.get<edyn::linvel>(entity)), 0, 0.01);
+
+    auto &aabb = registry.get<edyn::AABB>(entity);
+    ASSERT_NEAR(aabb.min.y, pos.y - 0.1, 0.0001);
+    ASSERT_NEAR(aabb.max.x, pos.x + 0.1, 0.0001);
+}
+
+TEST_F(test_particle, collides_with_rigid_bodies) {
+    auto box_def = edyn::rigidbody_def{};
+    box_def.shape = edyn::box_shape{0.5, 0.5, 0.5};
+    box_def.position = {0, 0.5, 0};
+    auto box_entity = edyn::make_rigidbody(registry, box_def);
+
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::sphere_shape{0.1};
+    def.position = {0, 2, 0};
+    def.particle = true;
+    auto entity = edyn::make_rigidbody(registry, def);
+
+    // Lands on the box.
+    step(120);
+
+    ASSERT_NEAR(registry.get<edyn::position>(entity).y, 1.1, 0.01);
+    ASSERT_NEAR(registry.get<edyn::position>(box_entity).y, 0.5, 0.01);
+}
@@ -0,0 +1,122 @@
+#include "../common/common.hpp"
+#include "edyn/dynamics/row_cache_soa.hpp"
+#include <random>
+
+class row_cache_soa_test : public ::testing::Test {
+protected:
+    std::mt19937 gen {42};
+    std::uniform_real_distribution<edyn::scalar> dist {-1, 1};
+
+    edyn::vector3 random_vec() {
+        return {dist(gen), dist(gen), dist(gen)};
+    }
+
+    edyn::solver_body make_body(edyn::scalar inv_m) {
+        auto body = edyn::solver_body{};
+        body.dv = random_vec();
+        body.dw = random_vec();
+        body.inv_m = inv_m;
+        body.inv_I = edyn::matrix3x3_identity * inv_m;
+        return body;
+    }
+
+    edyn::constraint_row make_row(const std::vector<edyn::solver_body> &bodies,
+                                  edyn::solver_body_index_t bodyA,
+                                  edyn::solver_body_index_t bodyB) {
+        auto row = edyn::constraint_row{};
+        row.J = {random_vec(), random_vec(), random_vec(), random_vec()};
+        row.body = {bodyA, bodyB};
+        row.eff_mass = edyn::scalar(1) / (bodies[bodyA].inv_m * (dot(row.J[0], row.J[0]) + dot(row.J[1], row.J[1])) +
+                                          bodies[bodyB].inv_m * (dot(row.J[2], row.J[2]) + dot(row.J[3], row.J[3])));
+        row.rhs = dist(gen);
+        row.lower_limit = 0;
+        row.upper_limit = EDYN_SCALAR_MAX;
+        row.impulse = 0;
+        return row;
+    }
+};
+
+TEST_F(row_cache_soa_test, independent_rows_match_scalar_solver) {
+    constexpr size_t num_rows = 13;
+    std::vector<edyn::solver_body> bodies;
+    bodies.emplace_back(); // Fixed body.
+
+    for (size_t i = 0; i < num_rows * 2; ++i) {
+        bodies.push_back(make_body(i % 2 ? edyn::scalar(0.5) : edyn::scalar(1)));
+    }
+
+    std::vector<edyn::constraint_row> rows;
+
+    for (size_t i = 0; i < num_rows; ++i) {
+        rows.push_back(make_row(bodies, 2 * i + 1, 2 * i + 2));
+    }
+
+    auto bodies_ref = bodies;
+    auto rows_ref = rows;
+
+    auto soa = edyn::row_cache_soa{};
+    edyn::pack_row_batches(soa, rows, bodies);
+    ASSERT_EQ(soa.batches.size(), num_rows / edyn::simd_width + (num_rows % edyn::simd_width != 0));
+
+    for (int iter = 0; iter < 4; ++iter) {
+        auto max_delta_impulse = edyn::solve(soa, rows, bodies);
+        auto max_delta_impulse_ref = edyn::scalar(0);
+
+        for (auto &row : rows_ref) {
+            auto delta_impulse = edyn::solve(row, bodies_ref);
+            edyn::apply_row_impulse(delta_impulse, row, bodies_ref);
+            max_delta_impulse_ref = std::max(std::abs(delta_impulse), max_delta_impulse_ref);
+        }
+
+        ASSERT_NEAR(max_delta_impulse, max_delta_impulse_ref, 1e-4);
+    }
+
+    for (size_t i = 0; i < num_rows; ++i) {
+        ASSERT_NEAR(rows[i].impulse, rows_ref[i].impulse, 1e-4);
+    }
+
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        for (size_t c = 0; c < 3; ++c) {
+            ASSERT_NEAR(bodies[i].dv[c], bodies_ref[i].dv[c], 1e-4);
+            ASSERT_NEAR(bodies[i].dw[c], bodies_ref[i].dw[c], 1e-4);
+        }
+    }
+}
+
+TEST_F(row_cache_soa_test, batches_do_not_share_dynamic_bodies) {
+    // A chain where each row shares a body with the next one, attached to
+    // the fixed body at the start.
+    constexpr size_t num_rows = 20;
+    std::vector<edyn::solver_body> bodies;
+    bodies.emplace_back();
+
+    for (size_t i = 0; i < num_rows; ++i) {
+        bodies.push_back(make_body(1));
+    }
+
+    std::vector<edyn::constraint_row> rows;
+
+    for (size_t i = 0; i < num_rows; ++i) {
+        rows.push_back(make_row(bodies, i, i + 1));
+    }
+
+    auto soa = edyn::row_cache_soa{};
+    edyn::pack_row_batches(soa, rows, bodies);
+
+    size_t total = 0;
+
+    for (auto &batch : soa.batches) {
+        total += batch.count;
+
+        for (unsigned i = 0; i < batch.count; ++i) {
+            for (unsigned j = i + 1; j < batch.count; ++j) {
+                ASSERT_NE(batch.bodyA[i], batch.bodyA[j]);
+                ASSERT_NE(batch.bodyA[i], batch.bodyB[j]);
+                ASSERT_NE(batch.bodyB[i], batch.bodyA[j]);
+                ASSERT_NE(batch.bodyB[i], batch.bodyB[j]);
+            }
+        }
+    }
+
+    ASSERT_EQ(total, num_rows);
+}
@@ -0,0 +1,110 @@
+#include "../common/common.hpp"
+#include "edyn/dynamics/row_cache.hpp"
+#include "edyn/dynamics/row_coloring.hpp"
+
+TEST(row_coloring_test, rows_in_same_color_do_not_share_dynamic_bodies) {
+    // A chain of bodies attached to the fixed body at both ends.
+    constexpr size_t num_bodies = 30;
+    auto cache = edyn::row_cache{};
+    cache.bodies.emplace_back();
+
+    for (size_t i = 0; i < num_bodies; ++i) {
+        cache.bodies.emplace_back().inv_m = 1;
+    }
+
+    auto add_row = [&](size_t a, size_t b) {
+        auto &row = cache.rows.emplace_back();
+        row.body = {edyn::solver_body_index_t(a), edyn::solver_body_index_t(b)};
+        cache.flags.push_back(edyn::constraint_row_flag_friction);
+        cache.friction.emplace_back();
+        cache.friction.back().normal_row_index = cache.rows.size() - 1;
+    };
+
+    auto fixed = edyn::fixed_solver_body_index;
+    add_row(fixed, 1);
+
+    for (size_t i = 1; i < num_bodies; ++i) {
+        add_row(i, i + 1);
+    }
+
+    add_row(num_bodies, fixed);
+
+    edyn::color_rows(cache);
+
+    ASSERT_EQ(cache.color_entries.size(), cache.rows.size());
+    ASSERT_FALSE(cache.has_overflow_color);
+    // A chain only needs two colors.
+    ASSERT_EQ(cache.color_offsets.size(), 3);
+
+    for (size_t c = 0; c < cache.color_offsets.size() - 1; ++c) {
+        std::vector<edyn::solver_body_index_t> bodies;
+
+        for (auto i = cache.color_offsets[c]; i < cache.color_offsets[c + 1]; ++i) {
+            auto &entry = cache.color_entries[i];
+            auto &row = cache.rows[entry.row];
+            ASSERT_EQ(cache.friction[entry.friction].normal_row_index, entry.row);
+
+            for (auto idx : row.body) {
+                ASSERT_EQ(std::find(bodies.begin(), bodies.end(), idx), bodies.end());
+                bodies.push_back(idx);
+            }
+        }
+    }
+
+    // Rows attached to the fixed body must have their own copy of it.
+    for (auto &row : cache.rows) {
+        ASSERT_NE(row.body[0], fixed);
+        ASSERT_NE(row.body[1], fixed);
+    }
+
+    ASSERT_EQ(cache.bodies.size(), num_bodies + 3);
+}
+
+TEST(row_coloring_test, position_constraints_in_same_color_do_not_share_dynamic_bodies) {
+    // A chain of bodies where the constraints at both ends have their own
+    // copy of a non-procedural body, which is appended after the nodes.
+    constexpr size_t num_bodies = 30;
+    constexpr size_t num_dynamic_bodies = num_bodies + 1;
+    auto cache = edyn::row_cache{};
+    cache.position_bodies.resize(num_dynamic_bodies + 2);
+
+    auto add_entry = [&](size_t a, size_t b) {
+        auto &entry = cache.position_entries.emplace_back();
+        entry.type = 0;
+        entry.entity_index = cache.position_entries.size() - 1;
+        entry.body = {edyn::solver_body_index_t(a), edyn::solver_body_index_t(b)};
+    };
+
+    add_entry(num_dynamic_bodies, 1);
+
+    for (size_t i = 1; i < num_bodies; ++i) {
+        add_entry(i, i + 1);
+    }
+
+    add_entry(num_bodies, num_dynamic_bodies + 1);
+
+    auto num_entries = cache.position_entries.size();
+    edyn::color_position_constraints(cache, num_dynamic_bodies);
+
+    ASSERT_EQ(cache.position_entries.size(), num_entries);
+    ASSERT_FALSE(cache.position_has_overflow_color);
+    ASSERT_EQ(cache.position_color_offsets.size(), 3);
+    ASSERT_EQ(cache.position_color_offsets.back(), num_entries);
+
+    std::vector<bool> visited(num_entries, false);
+
+    for (size_t c = 0; c < cache.position_color_offsets.size() - 1; ++c) {
+        std::vector<edyn::solver_body_index_t> bodies;
+
+        for (auto i = cache.position_color_offsets[c]; i < cache.position_color_offsets[c + 1]; ++i) {
+            auto &entry = cache.position_entries[i];
+            ASSERT_FALSE(visited[entry.entity_index]);
+            visited[entry.entity_index] = true;
+
+            for (auto idx : entry.body) {
+                ASSERT_EQ(std::find(bodies.begin(), bodies.end(), idx), bodies.end());
+                bodies.push_back(idx);
+            }
+        }
+    }
+}
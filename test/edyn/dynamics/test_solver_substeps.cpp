@@ -0,0 +1,67 @@
+#include "../common/common.hpp"
+
+class test_solver_substeps : public ::testing::Test {
+protected:
+    void SetUp() override {
+        auto config = edyn::init_config{};
+        config.execution_mode = edyn::execution_mode::sequential;
+        edyn::attach(registry, config);
+        edyn::set_paused(registry, true);
+        edyn::set_solver_velocity_iterations(registry, 2);
+
+        // Two balls hanging from separate anchors, thus in separate islands.
+        for (int i = 0; i < 2; ++i) {
+            auto anchor_def = edyn::rigidbody_def{};
+            anchor_def.kind = edyn::rigidbody_kind::rb_static;
+            anchor_def.position = {edyn::scalar(i * 5), 0, 0};
+            auto anchor = edyn::make_rigidbody(registry, anchor_def);
+
+            auto def = edyn::rigidbody_def{};
+            def.shape = edyn::sphere_shape{0.2};
+            def.position = {edyn::scalar(i * 5), -1, 0};
+            ball[i] = edyn::make_rigidbody(registry, def);
+
+            edyn::make_constraint<edyn::point_constraint>(registry, anchor, ball[i], [](auto &con) {
+                con.pivot[0] = edyn::vector3_zero;
+                con.pivot[1] = {0, 1, 0};
+            });
+        }
+    }
+
+    void TearDown() override {
+        edyn::detach(registry);
+    }
+
+    unsigned island_iterations(entt::entity entity) {
+        auto island_entity = registry.get<edyn::island_resident>(entity).island_entity;
+        return edyn::get_island_solver_velocity_iterations(registry, island_entity);
+    }
+
+    entt::registry registry;
+    std::array<entt::entity, 2> ball;
+};
+
+TEST_F(test_solver_substeps, only_requesting_island_substeps) {
+    registry.emplace<edyn::solver_substeps>(ball[0], 4u);
+
+    for (int i = 0; i < 60; ++i) {
+        edyn::step_simulation(registry);
+    }
+
+    // One velocity iteration in each of the 4 substeps.
+    ASSERT_EQ(island_iterations(ball[0]), 4);
+    ASSERT_LE(island_iterations(ball[1]), 2);
+
+    for (auto entity : ball) {
+        ASSERT_NEAR(registry.get<edyn::position>(entity).y, -1, 0.01);
+    }
+}
+
+TEST_F(test_solver_substeps, global_substeps_take_precedence) {
+    edyn::set_solver_substeps(registry, 2);
+    registry.emplace<edyn::solver_substeps>(ball[0], 1u);
+    edyn::step_simulation(registry);
+
+    ASSERT_EQ(island_iterations(ball[0]), 2);
+    ASSERT_EQ(island_iterations(ball[1]), 2);
+}
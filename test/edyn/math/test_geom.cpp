@@ -207,3 +207,51 @@ TEST(geom_test, closest_point_circle_circle_parallel) {
     ASSERT_SCALAR_EQ(normal.y, 0);
     ASSERT_SCALAR_EQ(normal.z, 1);
 }
+
+TEST(geom_test, closest_point_segment_segment_batch) {
+    // More pairs than the width of a pack, including degenerate ones.
+    std::vector<edyn::vector3> p1, q1, p2, q2;
+
+    for (int i = 0; i < 11; ++i) {
+        auto k = edyn::scalar(i);
+        p1.push_back({k, 0, 0});
+        q1.push_back({k, i % 3 == 0 ? 0 : 1, 0});
+        p2.push_back({-1, 0.5, k * 0.3});
+        q2.push_back({i % 4 == 0 ? -1 : 2, 0.5, k * 0.3 + 1});
+    }
+
+    auto count = p1.size();
+    std::vector<edyn::scalar> s(count), t(count), dist_sqr(count);
+    edyn::closest_point_segment_segment(p1.data(), q1.data(), p2.data(), q2.data(),
+                                        count, s.data(), t.data(), dist_sqr.data());
+
+    for (size_t i = 0; i < count; ++i) {
+        edyn::scalar si, ti;
+        edyn::vector3 c1, c2;
+        auto d = edyn::closest_point_segment_segment(p1[i], q1[i], p2[i], q2[i], si, ti, c1, c2);
+        ASSERT_NEAR(dist_sqr[i], d, 0.0001);
+        ASSERT_NEAR(s[i], si, 0.0001);
+        ASSERT_NEAR(t[i], ti, 0.0001);
+    }
+}
+
+TEST(geom_test, to_world_space_batch) {
+    auto pos = edyn::vector3{1, -2, 3};
+    auto orn = edyn::normalize(edyn::quaternion{0.1, 0.7, -0.3, 0.6});
+    std::vector<edyn::vector3> points;
+
+    for (int i = 0; i < 7; ++i) {
+        points.push_back({edyn::scalar(i), edyn::scalar(i * i) * 0.1f, -1});
+    }
+
+    auto world = points;
+    edyn::to_world_space(world.data(), world.size(), pos, orn, world.data());
+    auto local = std::vector<edyn::vector3>(points.size());
+    edyn::to_object_space(world.data(), world.size(), pos, orn, local.data());
+
+    for (size_t i = 0; i < points.size(); ++i) {
+        auto expected = edyn::to_world_space(points[i], pos, orn);
+        ASSERT_NEAR(edyn::distance(world[i], expected), 0, 0.0001);
+        ASSERT_NEAR(edyn::distance(local[i], points[i]), 0, 0.0001);
+    }
+}
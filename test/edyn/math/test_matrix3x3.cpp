@@ -1,4 +1,5 @@
 #include "../common/common.hpp"
+#include <edyn/math/simd_vector3.hpp>
 #include <random>
 
 class matrix3x3_test: public ::testing::Test {
@@ -59,3 +60,52 @@ TEST_F(matrix3x3_test, comparison) {
     ASSERT_GT(n, m);
     ASSERT_LT(m, n);
 }
+
+TEST_F(matrix3x3_test, simd_rotated_inertia) {
+    using namespace edyn;
+    quaternion orn[simd_width];
+    matrix3x3 inv_I[simd_width];
+    alignas(simd_alignment) scalar q[4][simd_width];
+    alignas(simd_alignment) scalar m[3][3][simd_width];
+
+    for (size_t lane = 0; lane < simd_width; ++lane) {
+        orn[lane] = normalize(quaternion{random(), random(), random(), random()});
+        inv_I[lane] = random_mat();
+
+        for (size_t i = 0; i < 4; ++i) {
+            q[i][lane] = orn[lane][i];
+        }
+
+        for (size_t i = 0; i < 3; ++i) {
+            for (size_t j = 0; j < 3; ++j) {
+                m[i][j][lane] = inv_I[lane][i][j];
+            }
+        }
+    }
+
+    auto basis = to_matrix3x3(simd_quaternion::load(q));
+    auto packed_inv_I = simd_matrix3x3{};
+
+    for (size_t i = 0; i < 3; ++i) {
+        packed_inv_I.row[i] = {simd_scalar::load(m[i][0]), simd_scalar::load(m[i][1]), simd_scalar::load(m[i][2])};
+    }
+
+    auto inv_IW = basis * packed_inv_I * transpose(basis);
+
+    for (size_t i = 0; i < 3; ++i) {
+        inv_IW.row[i].x.store(m[i][0]);
+        inv_IW.row[i].y.store(m[i][1]);
+        inv_IW.row[i].z.store(m[i][2]);
+    }
+
+    for (size_t lane = 0; lane < simd_width; ++lane) {
+        auto R = to_matrix3x3(orn[lane]);
+        auto expected = R * inv_I[lane] * transpose(R);
+
+        for (size_t i = 0; i < 3; ++i) {
+            for (size_t j = 0; j < 3; ++j) {
+                ASSERT_NEAR(m[i][j][lane], expected[i][j], scalar(1e-3) * (std::abs(expected[i][j]) + 1));
+            }
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#include "../common/common.hpp"
+#include "edyn/networking/util/action_queue.hpp"
+#include "edyn/networking/comp/action_history.hpp"
+
+TEST(test_action_queue, ordered_by_execution_time) {
+    auto queue = edyn::action_queue{};
+    ASSERT_TRUE(queue.empty());
+
+    auto entity = entt::entity{1};
+    auto client = entt::entity{2};
+    queue.push({3, 2, entity, client});
+    queue.push({1, 0.5, entity, client});
+    queue.push({2, 1, entity, client});
+    // Actions due at the same time are ordered by timestamp.
+    queue.push({2, 0.75, entity, client});
+    ASSERT_EQ(queue.size(), 4);
+
+    auto timestamps = std::vector<double>{};
+
+    while (!queue.empty()) {
+        timestamps.push_back(queue.top().timestamp);
+        queue.pop();
+    }
+
+    ASSERT_EQ(timestamps, (std::vector<double>{0.5, 0.75, 1, 2}));
+}
+
+TEST(test_action_queue, update_execution_times) {
+    auto queue = edyn::action_queue{};
+    auto entityA = entt::entity{1};
+    auto entityB = entt::entity{2};
+
+    for (int i = 0; i < 4; ++i) {
+        queue.push({i + 0.1, static_cast<double>(i), entityA, entityA});
+        queue.push({i + 0.2, static_cast<double>(i), entityB, entityB});
+    }
+
+    // Delay the actions of A by more than one second longer than those of B.
+    queue.update_execution_times([&](const edyn::queued_action &action) {
+        return action.timestamp + (action.client_entity == entityA ? 1.5 : 0.1);
+    });
+
+    auto entities = std::vector<entt::entity>{};
+
+    while (!queue.empty()) {
+        entities.push_back(queue.top().entity);
+        queue.pop();
+    }
+
+    auto expected = std::vector<entt::entity>{entityB, entityB, entityA, entityB,
+                                              entityA, entityB, entityA, entityA};
+    ASSERT_EQ(entities, expected);
+}
+
+TEST(test_action_queue, merge_action_history) {
+    auto data = uint8_t{0};
+    auto history = edyn::action_history{};
+    auto incoming = edyn::action_history{};
+
+    for (int i = 1; i <= 3; ++i) {
+        incoming.push_entry(i, 0, &data, 1);
+    }
+
+    ASSERT_EQ(history.merge(incoming), 3);
+
+    // Entries which were merged before are not appended again.
+    incoming.push_entry(4, 0, &data, 1);
+    ASSERT_EQ(history.merge(incoming), 1);
+    ASSERT_EQ(history.entries.size(), 4);
+    ASSERT_EQ(history.last_timestamp, 4);
+
+    ASSERT_NE(history.find(2), history.entries.end());
+    ASSERT_EQ(history.find(2.5), history.entries.end());
+
+    history.erase_through(2);
+    ASSERT_EQ(history.entries.size(), 2);
+    ASSERT_EQ(history.entries.front().timestamp, 3);
+
+    history.erase_until(4);
+    ASSERT_EQ(history.entries.size(), 1);
+    ASSERT_EQ(history.entries.front().offset, 0);
+}
@@ -0,0 +1,41 @@
+#include "../common/common.hpp"
+#include "edyn/networking/util/clock_sync.hpp"
+
+// Exchanges clock samples between two ends where the remote clock is ahead
+// of the local clock by `offset` and packets take `latency` seconds to
+// arrive in each direction.
+TEST(test_clock_sync, continuous_estimation) {
+    auto local = edyn::clock_sync_data{};
+    auto remote = edyn::clock_sync_data{};
+    const double offset = 100;
+    const double latency = 0.05;
+    const double interval = 0.05;
+    double time = 10;
+
+    ASSERT_EQ(edyn::clock_sync_round_trip_time(local, 0.3), 0.3);
+
+    for (int i = 0; i < 50; ++i) {
+        auto sample = edyn::clock_sync_make_sample(local, time);
+        edyn::clock_sync_process_sample(remote, sample, time + latency + offset);
+
+        // The remote end holds the sample for a while before replying.
+        auto reply_time = time + latency + interval / 2;
+        auto reply = edyn::clock_sync_make_sample(remote, reply_time + offset);
+        edyn::clock_sync_process_sample(local, reply, reply_time + latency);
+
+        time += interval;
+    }
+
+    ASSERT_GT(local.sample_count, 0);
+    ASSERT_GT(local.count, 0);
+    ASSERT_NEAR(edyn::clock_sync_round_trip_time(local, 0.3), latency * 2, 1e-6);
+    ASSERT_NEAR(local.round_trip_time_deviation, 0, 1e-3);
+    // Local time minus remote time.
+    ASSERT_NEAR(local.time_delta, -offset, 1e-6);
+
+    // Repeated echoes, e.g. of split snapshots, are ignored.
+    auto count = local.sample_count;
+    auto reply = edyn::clock_sync_make_sample(remote, time + offset);
+    edyn::clock_sync_process_sample(local, reply, time + latency);
+    ASSERT_EQ(local.sample_count, count);
+}
@@ -96,3 +96,40 @@ TEST(networking_test, input_state_history) {
     ASSERT_EQ(registry2.get<input>(emap.at(ent0)).value, -98);
     ASSERT_EQ(registry2.get<input>(emap.at(ent2)).value, 77);
 }
+
+TEST(networking_test, input_state_history_capacity) {
+    auto registry = entt::registry{};
+    auto entity = registry.create();
+    registry.emplace<input>(entity);
+
+    auto entities = entt::sparse_set{};
+    entities.emplace(entity);
+
+    auto history = std::make_shared<edyn::input_state_history<input>>();
+    auto writer = edyn::input_state_history_writer_impl<input>(history);
+    constexpr auto capacity = edyn::internal::input_ring<input>::capacity;
+
+    // The oldest states are discarded once the ring is full.
+    for (size_t i = 0; i < capacity + 10; ++i) {
+        registry.get<input>(entity).value = static_cast<int>(i);
+        writer.emplace(registry, entities, static_cast<double>(i));
+    }
+
+    auto registry2 = entt::registry{};
+    auto emap = edyn::entity_map{};
+    emap.insert(entity, registry2.create());
+    registry2.emplace<input>(emap.at(entity), -1);
+
+    auto reader = edyn::input_state_history_reader_impl<input>(history, {});
+    reader.import_latest(5, registry2, emap);
+    ASSERT_EQ(registry2.get<input>(emap.at(entity)).value, -1);
+
+    reader.import_latest(10, registry2, emap);
+    ASSERT_EQ(registry2.get<input>(emap.at(entity)).value, 10);
+
+    // Removed entities are no longer imported.
+    writer.remove_entity(entity);
+    registry2.get<input>(emap.at(entity)).value = -1;
+    reader.import_latest(100, registry2, emap);
+    ASSERT_EQ(registry2.get<input>(emap.at(entity)).value, -1);
+}
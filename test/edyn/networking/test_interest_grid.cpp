@@ -0,0 +1,105 @@
+#include "../common/common.hpp"
+#include "edyn/networking/comp/aabb_of_interest.hpp"
+#include "edyn/networking/util/interest_grid.hpp"
+
+static entt::entity make_island(entt::registry &registry, const edyn::AABB &aabb,
+                                std::vector<entt::entity> &nodes, size_t num_nodes) {
+    auto island_entity = registry.create();
+    auto &island = registry.emplace<edyn::island>(island_entity);
+    registry.emplace<edyn::island_AABB>(island_entity, aabb);
+
+    for (size_t i = 0; i < num_nodes; ++i) {
+        auto entity = registry.create();
+        registry.emplace<edyn::networked_tag>(entity);
+        registry.emplace<edyn::procedural_tag>(entity);
+        island.nodes.push(entity);
+        nodes.push_back(entity);
+    }
+
+    return island_entity;
+}
+
+TEST(test_interest_grid, enter_and_exit) {
+    auto registry = entt::registry{};
+    auto grid = edyn::interest_grid(10);
+
+    auto near_nodes = std::vector<entt::entity>{};
+    auto far_nodes = std::vector<entt::entity>{};
+    auto near_island = make_island(registry, {{1, 1, 1}, {3, 3, 3}}, near_nodes, 2);
+    make_island(registry, {{201, 1, 1}, {203, 3, 3}}, far_nodes, 3);
+
+    auto static_entity = registry.create();
+    registry.emplace<edyn::networked_tag>(static_entity);
+    registry.emplace<edyn::AABB>(static_entity, edyn::vector3{-5, -1, -5}, edyn::vector3{5, 0, 5});
+
+    auto client_entity = registry.create();
+    auto &aabboi = registry.emplace<edyn::aabb_of_interest>(client_entity);
+    aabboi.aabb = {{-20, -20, -20}, {20, 20, 20}};
+
+    grid.update(registry);
+    ASSERT_EQ(aabboi.entities.size(), 3);
+    ASSERT_EQ(aabboi.entities_entered.size(), 3);
+    ASSERT_TRUE(aabboi.entities_exited.empty());
+    ASSERT_TRUE(aabboi.entities.contains(static_entity));
+    aabboi.entities_entered.clear();
+
+    // Nothing changes if nothing moves.
+    grid.update(registry);
+    ASSERT_EQ(aabboi.entities.size(), 3);
+    ASSERT_TRUE(aabboi.entities_entered.empty());
+    ASSERT_TRUE(aabboi.entities_exited.empty());
+
+    // Move the AABB of interest over the far island.
+    aabboi.aabb = {{180, -20, -20}, {220, 20, 20}};
+    grid.update(registry);
+    ASSERT_EQ(aabboi.entities.size(), 3);
+    ASSERT_EQ(aabboi.entities_entered.size(), 3);
+    ASSERT_EQ(aabboi.entities_exited.size(), 3);
+
+    for (auto entity : far_nodes) {
+        ASSERT_TRUE(aabboi.entities.contains(entity));
+    }
+
+    aabboi.entities_entered.clear();
+    aabboi.entities_exited.clear();
+
+    // Move the near island into the AABB of interest and destroy a node.
+    registry.replace<edyn::island_AABB>(near_island, edyn::island_AABB{{{195, 1, 1}, {197, 2, 2}}});
+    registry.get<edyn::island>(near_island).nodes.remove(near_nodes[1]);
+    registry.destroy(near_nodes[1]);
+    grid.update(registry);
+    ASSERT_EQ(aabboi.entities.size(), 4);
+    ASSERT_EQ(aabboi.entities_entered.size(), 1);
+    ASSERT_EQ(aabboi.entities_entered.front(), near_nodes[0]);
+    ASSERT_TRUE(aabboi.entities_exited.empty());
+    aabboi.entities_entered.clear();
+
+    // Destroying the island removes its entities.
+    registry.destroy(near_island);
+    grid.update(registry);
+    ASSERT_EQ(aabboi.entities.size(), 3);
+    ASSERT_EQ(aabboi.entities_exited.size(), 1);
+    ASSERT_EQ(aabboi.entities_exited.front(), near_nodes[0]);
+}
+
+TEST(test_interest_grid, large_aabbs) {
+    auto registry = entt::registry{};
+    auto grid = edyn::interest_grid(10);
+
+    auto plane_entity = registry.create();
+    registry.emplace<edyn::networked_tag>(plane_entity);
+    registry.emplace<edyn::AABB>(plane_entity, edyn::vector3{-EDYN_SCALAR_MAX, -EDYN_SCALAR_MAX, -EDYN_SCALAR_MAX},
+                                 edyn::vector3{EDYN_SCALAR_MAX, 0, EDYN_SCALAR_MAX});
+
+    auto client_entity = registry.create();
+    auto &aabboi = registry.emplace<edyn::aabb_of_interest>(client_entity);
+    aabboi.aabb = {{-20, 10, -20}, {20, 30, 20}};
+
+    grid.update(registry);
+    ASSERT_TRUE(aabboi.entities.empty());
+
+    aabboi.aabb = {{-20, -10, -20}, {20, 10, 20}};
+    grid.update(registry);
+    ASSERT_TRUE(aabboi.entities.contains(plane_entity));
+    ASSERT_EQ(aabboi.entities_entered.size(), 1);
+}
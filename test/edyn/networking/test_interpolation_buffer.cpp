@@ -0,0 +1,40 @@
+#include "../common/common.hpp"
+#include "edyn/networking/comp/interpolation_buffer.hpp"
+
+TEST(test_interpolation_buffer, interpolate) {
+    auto buffer = edyn::interpolation_buffer{};
+    auto pos = edyn::vector3_zero;
+    auto orn = edyn::quaternion_identity;
+    ASSERT_FALSE(buffer.interpolate(0, pos, orn));
+
+    buffer.insert(1, {0, 0, 0}, edyn::quaternion_identity);
+    // Out of order samples are sorted.
+    buffer.insert(3, {4, 0, 0}, edyn::quaternion_identity);
+    buffer.insert(2, {2, 0, 0}, edyn::quaternion_identity);
+
+    ASSERT_TRUE(buffer.interpolate(1.5, pos, orn));
+    ASSERT_SCALAR_EQ(pos.x, 1);
+    buffer.interpolate(2.75, pos, orn);
+    ASSERT_SCALAR_EQ(pos.x, 3.5);
+
+    // Clamped outside the range of samples.
+    buffer.interpolate(0, pos, orn);
+    ASSERT_SCALAR_EQ(pos.x, 0);
+    buffer.interpolate(10, pos, orn);
+    ASSERT_SCALAR_EQ(pos.x, 4);
+}
+
+TEST(test_interpolation_buffer, discard_oldest) {
+    auto buffer = edyn::interpolation_buffer{};
+
+    for (int i = 0; i < 20; ++i) {
+        buffer.insert(i, {edyn::scalar(i), 0, 0}, edyn::quaternion_identity);
+    }
+
+    ASSERT_EQ(buffer.count, edyn::interpolation_buffer::max_samples);
+    ASSERT_EQ(buffer.samples[0].time, 20 - edyn::interpolation_buffer::max_samples);
+
+    // Older than all samples in a full buffer.
+    buffer.insert(0, {-1, 0, 0}, edyn::quaternion_identity);
+    ASSERT_EQ(buffer.samples[0].time, 20 - edyn::interpolation_buffer::max_samples);
+}
@@ -2,6 +2,9 @@
 #include "edyn/networking/networking.hpp"
 #include "edyn/networking/util/client_snapshot_exporter.hpp"
 #include "edyn/networking/util/client_snapshot_importer.hpp"
+#include "edyn/networking/util/server_snapshot_exporter.hpp"
+#include "edyn/networking/packet/edyn_packet.hpp"
+#include "edyn/serialization/memory_archive.hpp"
 #include <entt/core/type_info.hpp>
 #include <entt/meta/factory.hpp>
 #include <entt/core/hashed_string.hpp>
@@ -67,3 +70,153 @@ TEST(networking_test, client_export_import) {
     ASSERT_EQ(reg1.get<comp>(emap.at(ent0)).entity, emap.at(ent1));
     ASSERT_EQ(reg1.get<comp>(emap.at(ent0)).d, 1.618);
 }
+
+TEST(networking_test, large_snapshot) {
+    auto registry = entt::registry{};
+    auto entities = std::vector<entt::entity>{};
+
+    for (int i = 0; i < 1000; ++i) {
+        auto entity = registry.create();
+        registry.emplace<edyn::networked_tag>(entity);
+        registry.emplace<edyn::position>(entity, edyn::scalar(i), edyn::scalar(0), edyn::scalar(0));
+        entities.push_back(entity);
+    }
+
+    auto exporter = edyn::server_snapshot_exporter_impl(registry, edyn::networked_components);
+    auto snap = edyn::packet::registry_snapshot{};
+    snap.timestamp = 1;
+    exporter.export_all(snap, entities);
+    ASSERT_EQ(snap.entities.size(), entities.size());
+
+    // Indices greater than 255 survive serialization.
+    auto buffer = std::vector<uint8_t>{};
+    auto output = edyn::memory_output_archive(buffer);
+    output(snap);
+
+    auto input = edyn::memory_input_archive(buffer.data(), buffer.size());
+    auto snap_in = edyn::packet::registry_snapshot{};
+    input(snap_in);
+    ASSERT_FALSE(input.failed());
+    ASSERT_EQ(snap_in.entities, snap.entities);
+    ASSERT_EQ(snap_in.pools.size(), 1);
+    ASSERT_EQ(snap_in.pools[0].ptr->entity_indices, snap.pools[0].ptr->entity_indices);
+
+    // Split into packets that fit in the MTU.
+    constexpr size_t max_size = 1200;
+    auto packets = std::vector<edyn::packet::registry_snapshot>{};
+    exporter.split(snap, max_size, packets);
+    ASSERT_GT(packets.size(), 1);
+
+    auto split_entities = std::vector<entt::entity>{};
+
+    for (auto &packet : packets) {
+        auto packet_buffer = std::vector<uint8_t>{};
+        auto packet_output = edyn::memory_output_archive(packet_buffer);
+        auto edyn_packet = edyn::packet::edyn_packet{packet};
+        packet_output(edyn_packet);
+        ASSERT_LE(packet_buffer.size(), max_size);
+        ASSERT_EQ(packet.timestamp, snap.timestamp);
+
+        auto *pool = static_cast<edyn::pool_snapshot_data_impl<edyn::position> *>(packet.pools[0].ptr.get());
+
+        for (size_t i = 0; i < pool->entity_indices.size(); ++i) {
+            auto entity = packet.entities[pool->entity_indices[i]];
+            ASSERT_EQ(pool->components[i], registry.get<edyn::position>(entity));
+        }
+
+        split_entities.insert(split_entities.end(), packet.entities.begin(), packet.entities.end());
+    }
+
+    // Order is preserved.
+    ASSERT_EQ(split_entities, snap.entities);
+}
+
+TEST(networking_test, export_modified_cache) {
+    auto registry = entt::registry{};
+    registry.ctx().emplace<edyn::entity_graph>();
+    auto exporter = edyn::server_snapshot_exporter_impl(registry, edyn::networked_components);
+    auto entities = entt::sparse_set{};
+
+    for (int i = 0; i < 10; ++i) {
+        auto entity = registry.create();
+        registry.emplace<edyn::networked_tag>(entity);
+        registry.emplace<edyn::graph_node>(entity);
+        registry.emplace<edyn::position>(entity, edyn::scalar(i), edyn::scalar(0), edyn::scalar(0));
+        registry.patch<edyn::position>(entity);
+        entities.push(entity);
+    }
+
+    auto client_entity = registry.create();
+    auto &client = registry.emplace<edyn::remote_client>(client_entity);
+    client.allow_full_ownership = false;
+
+    auto uncached = edyn::packet::registry_snapshot{};
+    exporter.export_modified(uncached, entities, client_entity);
+
+    exporter.cache_modified(entities);
+
+    // Exports take the values from the cache until it's cleared.
+    for (auto entity : entities) {
+        registry.get<edyn::position>(entity).y = 1;
+    }
+
+    auto cached = edyn::packet::registry_snapshot{};
+    exporter.export_modified(cached, entities, client_entity);
+    exporter.clear_cache();
+
+    ASSERT_EQ(cached.entities, uncached.entities);
+    ASSERT_EQ(cached.pools.size(), 1);
+    ASSERT_EQ(uncached.pools.size(), 1);
+    ASSERT_EQ(cached.pools[0].component_index, uncached.pools[0].component_index);
+    ASSERT_EQ(cached.pools[0].ptr->entity_indices, uncached.pools[0].ptr->entity_indices);
+
+    auto *cached_pool = static_cast<edyn::pool_snapshot_data_impl<edyn::position> *>(cached.pools[0].ptr.get());
+    auto *uncached_pool = static_cast<edyn::pool_snapshot_data_impl<edyn::position> *>(uncached.pools[0].ptr.get());
+    ASSERT_EQ(cached_pool->components, uncached_pool->components);
+
+    auto current = edyn::packet::registry_snapshot{};
+    exporter.export_modified(current, entities, client_entity);
+    auto *current_pool = static_cast<edyn::pool_snapshot_data_impl<edyn::position> *>(current.pools[0].ptr.get());
+    ASSERT_SCALAR_EQ(current_pool->components[0].y, 1);
+}
+
+TEST(networking_test, exclude_sleeping) {
+    auto registry = entt::registry{};
+    registry.ctx().emplace<edyn::entity_graph>();
+    auto exporter = edyn::server_snapshot_exporter_impl(registry, edyn::networked_components);
+    auto entities = entt::sparse_set{};
+
+    for (int i = 0; i < 2; ++i) {
+        auto entity = registry.create();
+        registry.emplace<edyn::networked_tag>(entity);
+        registry.emplace<edyn::graph_node>(entity);
+        registry.emplace<edyn::dynamic_tag>(entity);
+        registry.emplace<edyn::position>(entity, edyn::scalar(i), edyn::scalar(0), edyn::scalar(0));
+        registry.emplace<edyn::orientation>(entity);
+        registry.emplace<edyn::linvel>(entity);
+        registry.emplace<edyn::angvel>(entity);
+        registry.patch<edyn::position>(entity);
+        entities.push(entity);
+    }
+
+    auto awake = entities[0];
+    auto sleeping = entities[1];
+    registry.emplace<edyn::sleeping_tag>(sleeping);
+
+    auto client_entity = registry.create();
+    registry.emplace<edyn::remote_client>(client_entity).allow_full_ownership = false;
+
+    // The transforms of sleeping entities stop being considered modified.
+    exporter.set_exclude_sleeping(true);
+    exporter.update(0.01);
+
+    auto snap = edyn::packet::registry_snapshot{};
+    exporter.export_modified(snap, entities, client_entity);
+    ASSERT_EQ(snap.entities, std::vector<entt::entity>{awake});
+
+    // Their resting state is exported on request instead.
+    auto rest = edyn::packet::registry_snapshot{};
+    exporter.export_rest_state(rest, {sleeping});
+    ASSERT_EQ(rest.entities, std::vector<entt::entity>{sleeping});
+    ASSERT_EQ(rest.pools.size(), 4);
+}
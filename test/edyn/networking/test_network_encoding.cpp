@@ -0,0 +1,75 @@
+#include "../common/common.hpp"
+#include "edyn/serialization/bitpack_archive.hpp"
+#include "edyn/serialization/memory_archive.hpp"
+#include "edyn/networking/util/network_encoding.hpp"
+#include "edyn/util/shape_util.hpp"
+
+TEST(test_network_encoding, bounded_position) {
+    auto positions = std::vector<edyn::position>{};
+
+    for (int i = 0; i < 10; ++i) {
+        auto k = edyn::scalar(i);
+        positions.push_back({edyn::vector3{k * 3.7f - 10, -k * 0.25f, 50}});
+    }
+
+    using encoding = edyn::network_encoding<edyn::position>::type;
+    auto buffer = edyn::bitpack_output_archive::buffer_type{};
+    auto output = edyn::bitpack_output_archive(buffer);
+    encoding::write(output, positions.data(), positions.size());
+    ASSERT_LT(buffer.size(), positions.size() * 3 * sizeof(float));
+
+    auto input = edyn::bitpack_input_archive(buffer.data(), buffer.size());
+    auto positions_in = std::vector<edyn::position>(positions.size());
+    encoding::read(input, positions_in.data(), positions_in.size());
+    ASSERT_FALSE(input.failed());
+
+    for (size_t i = 0; i < positions.size(); ++i) {
+        ASSERT_LT(edyn::distance(positions_in[i], positions[i]), 0.001);
+    }
+}
+
+TEST(test_network_encoding, smallest_three) {
+    auto orientations = std::vector<edyn::orientation>{};
+    orientations.push_back({edyn::quaternion_identity});
+    orientations.push_back({edyn::quaternion_axis_angle({0, 1, 0}, 2)});
+    orientations.push_back({edyn::quaternion_axis_angle(edyn::normalize(edyn::vector3{1, -2, 3}), -0.4)});
+    orientations.push_back({edyn::quaternion{0, 0, 0, -1}});
+
+    using encoding = edyn::network_encoding<edyn::orientation>::type;
+    auto buffer = edyn::bitpack_output_archive::buffer_type{};
+    auto output = edyn::bitpack_output_archive(buffer);
+    encoding::write(output, orientations.data(), orientations.size());
+    // 32 bits each.
+    ASSERT_EQ(buffer.size(), orientations.size() * 4);
+
+    auto input = edyn::bitpack_input_archive(buffer.data(), buffer.size());
+    auto orientations_in = std::vector<edyn::orientation>(orientations.size());
+    encoding::read(input, orientations_in.data(), orientations_in.size());
+    ASSERT_FALSE(input.failed());
+
+    for (size_t i = 0; i < orientations.size(); ++i) {
+        // Same rotation up to sign.
+        ASSERT_GT(std::abs(edyn::dot(orientations_in[i], orientations[i])), 0.9999);
+    }
+}
+
+TEST(test_network_encoding, polyhedron_mesh_id) {
+    auto vertices = std::vector<edyn::vector3>{};
+    auto indices = std::vector<uint32_t>{};
+    auto faces = std::vector<uint32_t>{};
+    edyn::make_box_mesh({0.5, 0.5, 0.5}, vertices, indices, faces);
+    auto mesh = edyn::shape_asset_cache::global().get_convex_mesh(vertices, indices, faces);
+    auto shapes = std::vector<edyn::polyhedron_shape>{edyn::polyhedron_shape{mesh}};
+
+    using encoding = edyn::network_encoding<edyn::polyhedron_shape>::type;
+    auto buffer = edyn::memory_output_archive::buffer_type{};
+    auto output = edyn::memory_output_archive(buffer);
+    encoding::write(output, shapes.data(), shapes.size());
+    ASSERT_EQ(buffer.size(), sizeof(edyn::shape_asset_cache::id_type));
+
+    auto input = edyn::memory_input_archive(buffer.data(), buffer.size());
+    auto shapes_in = std::vector<edyn::polyhedron_shape>(shapes.size());
+    encoding::read(input, shapes_in.data(), shapes_in.size());
+    ASSERT_FALSE(input.failed());
+    ASSERT_EQ(shapes_in[0].mesh, mesh);
+}
@@ -0,0 +1,44 @@
+#include "../common/common.hpp"
+#include "edyn/networking/util/packet_batch.hpp"
+
+TEST(test_packet_batch, insert_and_read) {
+    auto batch = edyn::packet_batch{};
+    ASSERT_TRUE(batch.empty());
+
+    batch.insert(edyn::packet::edyn_packet{edyn::packet::time_request{7}});
+    batch.insert(edyn::packet::edyn_packet{edyn::packet::set_playout_delay{0.25}});
+    batch.insert(edyn::packet::edyn_packet{edyn::packet::time_request{8}});
+    ASSERT_FALSE(batch.empty());
+
+    auto reliable_data = std::vector<uint8_t>{};
+    auto unreliable_data = std::vector<uint8_t>{};
+
+    batch.flush([&](const uint8_t *data, size_t size, bool reliable) {
+        auto &buffer = reliable ? reliable_data : unreliable_data;
+        buffer.assign(data, data + size);
+    });
+
+    ASSERT_TRUE(batch.empty());
+
+    // Time requests are unreliable and the playout delay is reliable.
+    auto ids = std::vector<uint32_t>{};
+    auto success = edyn::read_packet_batch(unreliable_data.data(), unreliable_data.size(), [&](auto &packet) {
+        ASSERT_TRUE(std::holds_alternative<edyn::packet::time_request>(packet.var));
+        ids.push_back(std::get<edyn::packet::time_request>(packet.var).id);
+    });
+    ASSERT_TRUE(success);
+    ASSERT_EQ(ids, (std::vector<uint32_t>{7, 8}));
+
+    auto num_packets = 0;
+    success = edyn::read_packet_batch(reliable_data.data(), reliable_data.size(), [&](auto &packet) {
+        ASSERT_TRUE(std::holds_alternative<edyn::packet::set_playout_delay>(packet.var));
+        ASSERT_EQ(std::get<edyn::packet::set_playout_delay>(packet.var).value, 0.25);
+        ++num_packets;
+    });
+    ASSERT_TRUE(success);
+    ASSERT_EQ(num_packets, 1);
+
+    // Truncated batches are rejected.
+    success = edyn::read_packet_batch(unreliable_data.data(), unreliable_data.size() - 1, [](auto &) {});
+    ASSERT_FALSE(success);
+}
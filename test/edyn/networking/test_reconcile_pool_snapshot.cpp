@@ -0,0 +1,97 @@
+#include "../common/common.hpp"
+#include "edyn/networking/comp/networked_comp.hpp"
+#include "edyn/networking/packet/registry_snapshot.hpp"
+#include "edyn/networking/settings/client_network_settings.hpp"
+#include "edyn/networking/util/reconcile_pool_snapshot.hpp"
+
+template<typename Component>
+static void insert_pool(entt::registry &registry, const std::vector<entt::entity> &entities,
+                        edyn::packet::registry_snapshot &snap) {
+    auto index = edyn::tuple_index_of<edyn::component_index_type, Component>(edyn::networked_components);
+    edyn::internal::snapshot_insert_entities<Component>(registry, entities.begin(), entities.end(), snap, index);
+}
+
+template<typename Component>
+static size_t pool_size(const edyn::packet::registry_snapshot &snap) {
+    for (auto &pool : snap.pools) {
+        if (pool.ptr->get_type_id() == entt::type_index<Component>::value()) {
+            return pool.ptr->entity_indices.size();
+        }
+    }
+
+    return 0;
+}
+
+class test_reconcile_pool_snapshot : public ::testing::Test {
+protected:
+    void SetUp() override {
+        for (int i = 0; i < 3; ++i) {
+            auto entity = server.create();
+            server.emplace<edyn::networked_tag>(entity);
+            server.emplace<edyn::position>(entity, edyn::scalar(i), edyn::scalar(0), edyn::scalar(0));
+            server.emplace<edyn::orientation>(entity, edyn::quaternion_identity);
+            server.emplace<edyn::linvel>(entity, edyn::vector3_zero);
+
+            // Same entity identifiers in the client.
+            auto local = client.create();
+            ASSERT_EQ(local, entity);
+            client.emplace<edyn::position>(local, server.get<edyn::position>(entity));
+            client.emplace<edyn::orientation>(local, edyn::quaternion_identity);
+            client.emplace<edyn::linvel>(local, edyn::vector3_zero);
+            entities.push_back(entity);
+        }
+    }
+
+    edyn::packet::registry_snapshot make_snapshot() {
+        auto snap = edyn::packet::registry_snapshot{};
+        insert_pool<edyn::position>(server, entities, snap);
+        insert_pool<edyn::orientation>(server, entities, snap);
+        insert_pool<edyn::linvel>(server, entities, snap);
+        return snap;
+    }
+
+    entt::registry server;
+    entt::registry client;
+    std::vector<entt::entity> entities;
+    edyn::client_network_settings settings;
+};
+
+TEST_F(test_reconcile_pool_snapshot, matching_state_is_skipped) {
+    // Within tolerance.
+    server.get<edyn::position>(entities[0]).x += settings.reconciliation_position_tolerance / 2;
+    // Out of tolerance in a single component.
+    server.get<edyn::linvel>(entities[1]).y = 1;
+
+    auto snap = make_snapshot();
+    auto corrected = std::vector<entt::entity>{};
+    edyn::reconcile_pool_snapshot(client, snap.entities, snap.pools, settings, corrected);
+
+    ASSERT_EQ(corrected, std::vector<entt::entity>{entities[1]});
+
+    // The corrected entity keeps all its entries.
+    ASSERT_EQ(pool_size<edyn::position>(snap), 1);
+    ASSERT_EQ(pool_size<edyn::orientation>(snap), 1);
+    ASSERT_EQ(pool_size<edyn::linvel>(snap), 1);
+}
+
+TEST_F(test_reconcile_pool_snapshot, rotated_entity_is_corrected) {
+    server.get<edyn::orientation>(entities[2]) =
+        edyn::quaternion_axis_angle(edyn::vector3_y, settings.reconciliation_orientation_tolerance * 2);
+
+    auto snap = make_snapshot();
+    auto corrected = std::vector<entt::entity>{};
+    edyn::reconcile_pool_snapshot(client, snap.entities, snap.pools, settings, corrected);
+
+    ASSERT_EQ(corrected, std::vector<entt::entity>{entities[2]});
+}
+
+TEST_F(test_reconcile_pool_snapshot, disabled) {
+    settings.reconcile_snapshots = false;
+
+    auto snap = make_snapshot();
+    auto corrected = std::vector<entt::entity>{};
+    edyn::reconcile_pool_snapshot(client, snap.entities, snap.pools, settings, corrected);
+
+    ASSERT_EQ(corrected, snap.entities);
+    ASSERT_EQ(pool_size<edyn::position>(snap), entities.size());
+}
@@ -0,0 +1,109 @@
+#include "../common/common.hpp"
+#include "edyn/networking/comp/networked_comp.hpp"
+#include "edyn/networking/packet/registry_snapshot.hpp"
+#include "edyn/networking/util/snapshot_baseline.hpp"
+#include "edyn/serialization/memory_archive.hpp"
+#include "edyn/serialization/bitpack_archive.hpp"
+
+static edyn::packet::registry_snapshot make_snapshot(entt::registry &registry,
+                                                     const std::vector<entt::entity> &entities,
+                                                     edyn::snapshot_baseline::id_type id) {
+    auto snap = edyn::packet::registry_snapshot{};
+    snap.id = id;
+    auto index = edyn::tuple_index_of<edyn::component_index_type, edyn::position>(edyn::networked_components);
+    edyn::internal::snapshot_insert_entities<edyn::position>(registry, entities.begin(), entities.end(), snap, index);
+    return snap;
+}
+
+template<typename OutputArchive, typename InputArchive>
+static edyn::packet::registry_snapshot serialize_snapshot(edyn::packet::registry_snapshot &snap) {
+    auto buffer = std::vector<uint8_t>{};
+    auto output = OutputArchive(buffer);
+    output(snap);
+
+    auto result = edyn::packet::registry_snapshot{};
+    auto input = InputArchive(buffer.data(), buffer.size());
+    input(result);
+    return result;
+}
+
+template<typename OutputArchive, typename InputArchive>
+static void test_delta_encoding() {
+    auto registry = entt::registry{};
+    auto entities = std::vector<entt::entity>{};
+
+    for (int i = 0; i < 10; ++i) {
+        auto entity = registry.create();
+        registry.emplace<edyn::networked_tag>(entity);
+        registry.emplace<edyn::position>(entity, edyn::scalar(i), edyn::scalar(1), edyn::scalar(2));
+        entities.push_back(entity);
+    }
+
+    auto server = edyn::snapshot_baseline{};
+    auto client = edyn::snapshot_baseline{};
+
+    // Nothing was acknowledged thus the first snapshot has full values.
+    auto snap1 = make_snapshot(registry, entities, 1);
+    server.encode(snap1);
+    ASSERT_EQ(snap1.entities.size(), entities.size());
+    server.insert(snap1);
+
+    auto recv1 = serialize_snapshot<OutputArchive, InputArchive>(snap1);
+    ASSERT_TRUE(client.decode(recv1));
+    client.insert(recv1);
+    server.acknowledge(recv1.id);
+
+    // Move a few entities along the x axis.
+    for (int i = 0; i < 3; ++i) {
+        registry.get<edyn::position>(entities[i]).x += edyn::scalar(0.5);
+    }
+
+    // Unchanged components are not included. The others only contain the
+    // words that changed.
+    auto snap2 = make_snapshot(registry, entities, 2);
+    server.encode(snap2);
+    ASSERT_EQ(snap2.entities.size(), 3);
+    ASSERT_EQ(snap2.pools.size(), 1);
+    ASSERT_FALSE(snap2.pools[0].ptr->baseline_ages.empty());
+    server.insert(snap2);
+
+    auto recv2 = serialize_snapshot<OutputArchive, InputArchive>(snap2);
+    ASSERT_EQ(recv2.id, 2);
+    ASSERT_TRUE(client.decode(recv2));
+
+    auto *pool = static_cast<edyn::pool_snapshot_data_impl<edyn::position> *>(recv2.pools[0].ptr.get());
+    ASSERT_EQ(pool->components.size(), 3);
+
+    for (size_t i = 0; i < pool->components.size(); ++i) {
+        auto entity = recv2.entities[pool->entity_indices[i]];
+        ASSERT_EQ(pool->components[i], registry.get<edyn::position>(entity));
+    }
+
+    // Components can't be decoded without the baseline.
+    auto recv3 = serialize_snapshot<OutputArchive, InputArchive>(snap2);
+    ASSERT_FALSE(edyn::snapshot_baseline{}.decode(recv3));
+    ASSERT_TRUE(recv3.pools.empty());
+}
+
+TEST(test_snapshot_baseline, delta_encoding_memory_archive) {
+    test_delta_encoding<edyn::memory_output_archive, edyn::memory_input_archive>();
+}
+
+TEST(test_snapshot_baseline, delta_encoding_bitpack_archive) {
+    test_delta_encoding<edyn::bitpack_output_archive, edyn::bitpack_input_archive>();
+}
+
+TEST(test_snapshot_baseline, erase_until) {
+    auto baseline = edyn::snapshot_baseline{};
+    auto value = edyn::scalar(3);
+    auto entity = entt::entity{1};
+    baseline.insert(1, entity, 0, &value, sizeof(value));
+    baseline.insert(2, entity, 0, &value, sizeof(value));
+    baseline.acknowledge(1);
+    ASSERT_EQ(baseline.find_acknowledged(entity, 0), 1);
+
+    baseline.erase_until(2);
+    ASSERT_EQ(baseline.find(1, entity, 0), nullptr);
+    ASSERT_NE(baseline.find(2, entity, 0), nullptr);
+    ASSERT_EQ(baseline.find_acknowledged(entity, 0), edyn::snapshot_baseline::null_id);
+}
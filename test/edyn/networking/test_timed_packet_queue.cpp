@@ -0,0 +1,57 @@
+#include "../common/common.hpp"
+#include "edyn/networking/util/timed_packet_queue.hpp"
+
+static uint32_t pop_id(edyn::timed_packet_queue &queue) {
+    auto id = std::get<edyn::packet::time_request>(queue.front().packet.var).id;
+    queue.pop_front();
+    return id;
+}
+
+TEST(test_timed_packet_queue, ordered_by_timestamp) {
+    auto queue = edyn::timed_packet_queue{};
+    ASSERT_TRUE(queue.empty());
+
+    queue.push(2, edyn::packet::edyn_packet{edyn::packet::time_request{2}});
+    queue.push(1, edyn::packet::edyn_packet{edyn::packet::time_request{1}});
+    queue.push(3, edyn::packet::edyn_packet{edyn::packet::time_request{3}});
+    // Packets with equal timestamps stay in insertion order.
+    queue.push(2, edyn::packet::edyn_packet{edyn::packet::time_request{4}});
+    ASSERT_EQ(queue.size(), 4);
+
+    ASSERT_EQ(queue.front().timestamp, 1);
+    ASSERT_EQ(pop_id(queue), 1);
+    ASSERT_EQ(pop_id(queue), 2);
+    ASSERT_EQ(pop_id(queue), 4);
+    ASSERT_EQ(pop_id(queue), 3);
+    ASSERT_TRUE(queue.empty());
+}
+
+TEST(test_timed_packet_queue, wrap_around_and_grow) {
+    auto queue = edyn::timed_packet_queue{};
+    uint32_t next_id = 0;
+    uint32_t expected_id = 0;
+
+    // Interleave insertions and removals so the ring wraps around while it
+    // grows.
+    for (int i = 0; i < 10; ++i) {
+        for (int j = 0; j < 12; ++j) {
+            queue.push(next_id, edyn::packet::edyn_packet{edyn::packet::time_request{next_id}});
+            ++next_id;
+        }
+
+        for (int j = 0; j < 7; ++j) {
+            ASSERT_EQ(pop_id(queue), expected_id++);
+        }
+    }
+
+    // A late packet goes before the newer ones.
+    queue.push(expected_id + 0.5, edyn::packet::edyn_packet{edyn::packet::time_request{1000}});
+    ASSERT_EQ(pop_id(queue), expected_id++);
+    ASSERT_EQ(pop_id(queue), 1000);
+
+    while (!queue.empty()) {
+        ASSERT_EQ(pop_id(queue), expected_id++);
+    }
+
+    ASSERT_EQ(expected_id, next_id);
+}
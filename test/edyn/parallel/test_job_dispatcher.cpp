@@ -2,9 +2,13 @@
 #include "edyn/parallel/job_dispatcher.hpp"
 #include "edyn/parallel/parallel_for.hpp"
 #include "edyn/parallel/parallel_for_async.hpp"
+#include "edyn/parallel/task_group.hpp"
+#include "edyn/context/task.hpp"
+#include <entt/signal/delegate.hpp>
 
 #include <array>
 #include <atomic>
+#include <thread>
 
 class job_dispatcher_test: public ::testing::Test {
 protected:
@@ -129,6 +133,169 @@ TEST_F(job_dispatcher_test, parallel_for_async) {
     }
 }
 
+static std::atomic<int> stats_job_counter {0};
+
+TEST_F(job_dispatcher_test, stats) {
+    dispatcher.set_collect_stats(true);
+    stats_job_counter = 0;
+    constexpr int num_jobs = 100;
+
+    for (int i = 0; i < num_jobs; ++i) {
+        auto j = edyn::job();
+        j.func = [](edyn::job::data_type &) {
+            stats_job_counter.fetch_add(1, std::memory_order_relaxed);
+        };
+        dispatcher.async(j);
+    }
+
+    while (stats_job_counter.load(std::memory_order_relaxed) < num_jobs) {
+        edyn::delay(1);
+    }
+
+    auto stats = dispatcher.get_stats();
+    ASSERT_EQ(stats.workers.size(), 4);
+
+    uint64_t jobs_executed = 0;
+    size_t max_queue_depth = 0;
+
+    for (auto &w : stats.workers) {
+        jobs_executed += w.jobs_executed;
+        max_queue_depth = std::max(max_queue_depth, w.max_queue_depth);
+        ASSERT_GE(w.busy_time, 0);
+        ASSERT_GE(w.idle_time, 0);
+    }
+
+    ASSERT_EQ(jobs_executed, num_jobs);
+    ASSERT_GT(max_queue_depth, 0);
+
+    dispatcher.reset_stats();
+    stats = dispatcher.get_stats();
+
+    for (auto &w : stats.workers) {
+        ASSERT_EQ(w.jobs_executed, 0);
+        ASSERT_EQ(w.jobs_stolen, 0);
+    }
+}
+
+struct task_wait_stats_test_data {
+    std::vector<int> values;
+
+    void run(unsigned start, unsigned end) {
+        for (auto i = start; i < end; ++i) {
+            values[i] = 1;
+        }
+    }
+};
+
+TEST_F(job_dispatcher_test, task_wait_stats) {
+    dispatcher.set_collect_stats(true);
+    edyn::job_dispatcher::bind_current(&dispatcher);
+
+    auto data = task_wait_stats_test_data{};
+    data.values.resize(1000);
+    auto task = edyn::task_delegate_t{};
+    task.connect<&task_wait_stats_test_data::run>(data);
+    edyn::enqueue_task_wait_default(task, data.values.size());
+    edyn::enqueue_task_wait_default(task, data.values.size());
+
+    edyn::job_dispatcher::bind_current(nullptr);
+
+    auto stats = dispatcher.get_stats().task_wait;
+    ASSERT_EQ(stats.num_calls, 2);
+    // The range is split into one chunk per worker plus one for the caller.
+    ASSERT_EQ(stats.last.num_chunks, 5);
+    ASSERT_EQ(stats.num_chunks, 10);
+    ASSERT_GE(stats.duration, stats.wait_time);
+    ASSERT_GE(stats.wait_time, stats.max_wait_time);
+    ASSERT_GE(stats.imbalance(), 0);
+    ASSERT_LE(stats.imbalance(), 1);
+
+    for (auto value : data.values) {
+        ASSERT_EQ(value, 1);
+    }
+}
+
+struct continuation_test_data {
+    std::atomic<unsigned> count {0};
+    std::atomic<bool> completed {false};
+    std::atomic<bool> completion_called {false};
+    unsigned num_steps;
+
+    void step() {
+        if (++count < num_steps) {
+            auto task = edyn::task_delegate_t(entt::connect_arg_t<&continuation_test_data::step>{}, *this);
+            edyn::enqueue_continuation_default(task);
+        } else {
+            completed = true;
+        }
+    }
+
+    void complete() {
+        completion_called = true;
+    }
+};
+
+TEST_F(job_dispatcher_test, continuation) {
+    edyn::job_dispatcher::bind_current(&dispatcher);
+
+    // A sequence of tasks where each one schedules the next.
+    auto data = continuation_test_data{};
+    data.num_steps = 1000;
+    edyn::enqueue_continuation_default(edyn::task_delegate_t(entt::connect_arg_t<&continuation_test_data::step>{}, data));
+
+    while (!data.completed) {
+        std::this_thread::yield();
+    }
+
+    ASSERT_EQ(data.count, data.num_steps);
+
+    // Tasks of size one run in a single job which calls the completion.
+    auto single = continuation_test_data{};
+    single.num_steps = 1;
+    edyn::enqueue_task_default(edyn::task_delegate_t(entt::connect_arg_t<&continuation_test_data::step>{}, single), 1,
+                               edyn::task_completion_delegate_t(entt::connect_arg_t<&continuation_test_data::complete>{}, single));
+
+    while (!single.completion_called) {
+        std::this_thread::yield();
+    }
+
+    ASSERT_EQ(single.count, 1);
+    ASSERT_TRUE(single.completed);
+    edyn::job_dispatcher::bind_current(nullptr);
+}
+
+TEST_F(job_dispatcher_test, nested_task_groups) {
+    constexpr unsigned num_outer = 64;
+    constexpr unsigned num_inner = 1000;
+    auto values = std::vector<std::atomic<int>>(num_outer * num_inner);
+
+    // Each job of the outer group runs an inner group and waits for it, thus
+    // all workers might be waiting at the same time.
+    auto outer_func = [&](unsigned start, unsigned end) {
+        for (auto i = start; i < end; ++i) {
+            auto inner_func = [&values, i](unsigned inner_start, unsigned inner_end) {
+                for (auto j = inner_start; j < inner_end; ++j) {
+                    ++values[i * num_inner + j];
+                }
+            };
+
+            auto inner = edyn::task_group(dispatcher);
+            inner.run(edyn::task_delegate_t(entt::connect_arg_t<&decltype(inner_func)::operator()>{}, inner_func), num_inner);
+            inner.wait();
+            // The group is reusable and waits in the destructor.
+            inner.run(edyn::task_delegate_t(entt::connect_arg_t<&decltype(inner_func)::operator()>{}, inner_func), num_inner);
+        }
+    };
+
+    auto outer = edyn::task_group(dispatcher);
+    outer.run(edyn::task_delegate_t(entt::connect_arg_t<&decltype(outer_func)::operator()>{}, outer_func), num_outer);
+    outer.wait();
+
+    for (auto &value : values) {
+        ASSERT_EQ(value, 2);
+    }
+}
+
 /*
 TEST_F(job_dispatcher_test, nested_parallel_for) {
     constexpr size_t rows = 2012;
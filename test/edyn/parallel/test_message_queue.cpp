@@ -0,0 +1,135 @@
+#include "../common/common.hpp"
+#include "edyn/parallel/message_dispatcher.hpp"
+
+#include <atomic>
+#include <thread>
+
+struct numbered_message {
+    int sender;
+    int number;
+};
+
+TEST(test_message_queue, order_per_sender) {
+    edyn::message_queue queue;
+    constexpr int num_senders = 4;
+    // More than fits in a ring so the overflow list is also used.
+    constexpr int num_messages = 20000;
+    std::atomic<int> num_done {0};
+
+    auto sender = [&](int index) {
+        auto id = edyn::message_queue_id{static_cast<uint32_t>(index), 0};
+
+        for (int i = 0; i < num_messages; ++i) {
+            queue.push<numbered_message>(id, numbered_message{index, i});
+        }
+
+        num_done.fetch_add(1, std::memory_order_release);
+    };
+
+    std::thread threads[num_senders];
+
+    for (int i = 0; i < num_senders; ++i) {
+        threads[i] = std::thread(sender, i);
+    }
+
+    int next[num_senders] = {};
+    bool in_order = true;
+
+    auto consume = [&]() {
+        queue.consume([&](const edyn::message_queue_id &id, edyn::message_any &content) {
+            auto *msg = entt::any_cast<numbered_message>(&content);
+            ASSERT_NE(msg, nullptr);
+            ASSERT_EQ(id.index, static_cast<uint32_t>(msg->sender));
+            in_order &= msg->number == next[msg->sender];
+            next[msg->sender] = msg->number + 1;
+        });
+    };
+
+    while (num_done.load(std::memory_order_acquire) < num_senders) {
+        consume();
+    }
+
+    consume();
+
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    ASSERT_TRUE(in_order);
+
+    for (int i = 0; i < num_senders; ++i) {
+        ASSERT_EQ(next[i], num_messages);
+    }
+}
+
+TEST(test_message_queue, shared_sender) {
+    edyn::message_queue queue;
+    constexpr int num_threads = 3;
+    constexpr int num_messages = 5000;
+    auto id = edyn::message_queue_id{0, 0};
+
+    // Threads pushing with the same sender must not corrupt the ring.
+    auto sender = [&](int index) {
+        for (int i = 0; i < num_messages; ++i) {
+            queue.push<numbered_message>(id, numbered_message{index, i});
+        }
+    };
+
+    std::thread threads[num_threads];
+    int count = 0;
+
+    for (int i = 0; i < num_threads; ++i) {
+        threads[i] = std::thread(sender, i);
+    }
+
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    queue.consume([&](const edyn::message_queue_id &, edyn::message_any &content) {
+        ASSERT_NE(entt::any_cast<numbered_message>(&content), nullptr);
+        ++count;
+    });
+
+    ASSERT_EQ(count, num_threads * num_messages);
+}
+
+static int received_sum = 0;
+
+static void on_numbered_message(edyn::message<numbered_message> &msg) {
+    received_sum += msg.content.number;
+}
+
+TEST(test_message_queue, dispatcher_ids_and_names) {
+    edyn::message_dispatcher dispatcher;
+    auto named = dispatcher.make_queue<numbered_message>("named");
+    auto anonymous = dispatcher.make_queue<numbered_message>();
+    named.sink<numbered_message>().connect<&on_numbered_message>();
+    anonymous.sink<numbered_message>().connect<&on_numbered_message>();
+
+    ASSERT_EQ(dispatcher.lookup({"named"}), named.id);
+    ASSERT_FALSE(dispatcher.lookup({"missing"}).valid());
+    ASSERT_NE(named.id, anonymous.id);
+
+    received_sum = 0;
+    dispatcher.send<numbered_message>(named.id, anonymous.id, numbered_message{0, 1});
+    dispatcher.send<numbered_message>(edyn::message_queue_identifier{"named"}, {}, numbered_message{0, 10});
+    dispatcher.send<numbered_message>(anonymous.id, named.id, numbered_message{0, 100});
+    named.update();
+    anonymous.update();
+    ASSERT_EQ(received_sum, 111);
+
+    // Messages sent to destroyed queues are dropped, even if a new queue
+    // took the place of the destroyed one.
+    auto stale_id = anonymous.id;
+    dispatcher.destroy_queue(anonymous.id);
+    auto replacement = dispatcher.make_queue<numbered_message>();
+    replacement.sink<numbered_message>().connect<&on_numbered_message>();
+    ASSERT_EQ(replacement.id.index, stale_id.index);
+    ASSERT_NE(replacement.id, stale_id);
+
+    received_sum = 0;
+    dispatcher.send<numbered_message>(stale_id, {}, numbered_message{0, 1});
+    replacement.update();
+    ASSERT_EQ(received_sum, 0);
+}
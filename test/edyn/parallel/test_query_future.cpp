@@ -0,0 +1,51 @@
+#include "../common/common.hpp"
+#include "edyn/parallel/query_future.hpp"
+
+#include <thread>
+#include <vector>
+
+TEST(test_query_future, resolved_from_another_thread) {
+    auto promise = edyn::query_promise<std::vector<int>>{};
+    auto future = promise.get_future();
+
+    ASSERT_TRUE(future.valid());
+    ASSERT_FALSE(future.is_ready());
+    ASSERT_FALSE(future.wait_for(std::chrono::milliseconds(1)));
+
+    auto thread = std::thread([promise] () mutable {
+        promise.set_value({1, 2, 3});
+    });
+
+    future.wait();
+    ASSERT_TRUE(future.is_ready());
+    ASSERT_EQ(future.get(), (std::vector<int>{1, 2, 3}));
+
+    thread.join();
+}
+
+TEST(test_query_future, finish_runs_once_in_taking_thread) {
+    auto promise = edyn::query_promise<int>{};
+    auto num_calls = 0;
+    auto taker = std::this_thread::get_id();
+    auto future = promise.get_future([&] (int &value) {
+        ASSERT_EQ(std::this_thread::get_id(), taker);
+        value *= 10;
+        ++num_calls;
+    });
+
+    auto thread = std::thread([promise] () mutable {
+        promise.set_value(4);
+    });
+    thread.join();
+
+    ASSERT_EQ(future.get(), 40);
+    ASSERT_EQ(future.get(), 40);
+    ASSERT_EQ(num_calls, 1);
+}
+
+TEST(test_query_future, default_is_invalid) {
+    auto future = edyn::query_future<int>{};
+    ASSERT_FALSE(future.valid());
+    auto promise = edyn::query_promise<int>{};
+    ASSERT_FALSE(promise.valid());
+}
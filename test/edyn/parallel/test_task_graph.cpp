@@ -0,0 +1,112 @@
+#include "../common/common.hpp"
+#include "edyn/parallel/job_dispatcher.hpp"
+#include "edyn/parallel/task_graph.hpp"
+
+#include <atomic>
+#include <cstring>
+
+struct record_context {
+    std::atomic<int> next {0};
+    std::atomic<int> order[8];
+};
+
+// Records the order in which the task with the given index ran.
+static edyn::job make_record_job(record_context *ctx, int index) {
+    auto j = edyn::job{};
+    std::memcpy(j.data.data(), &ctx, sizeof(ctx));
+    std::memcpy(j.data.data() + sizeof(ctx), &index, sizeof(index));
+    j.func = [](edyn::job::data_type &data) {
+        record_context *ctx;
+        int index;
+        std::memcpy(&ctx, data.data(), sizeof(ctx));
+        std::memcpy(&index, data.data() + sizeof(ctx), sizeof(index));
+        ctx->order[index].store(ctx->next.fetch_add(1), std::memory_order_relaxed);
+    };
+    return j;
+}
+
+static edyn::job make_counter_job(std::atomic<int> *counter) {
+    auto j = edyn::job{};
+    std::memcpy(j.data.data(), &counter, sizeof(counter));
+    j.func = [](edyn::job::data_type &data) {
+        std::atomic<int> *counter;
+        std::memcpy(&counter, data.data(), sizeof(counter));
+        counter->fetch_add(1, std::memory_order_relaxed);
+    };
+    return j;
+}
+
+TEST(test_task_graph, diamond) {
+    edyn::job_dispatcher dispatcher;
+    dispatcher.start(4);
+
+    for (int iteration = 0; iteration < 100; ++iteration) {
+        auto ctx = record_context{};
+        auto graph = edyn::task_graph{};
+        auto a = graph.add_task(make_record_job(&ctx, 0));
+        auto b = graph.add_task(make_record_job(&ctx, 1));
+        auto c = graph.add_task(make_record_job(&ctx, 2));
+        auto d = graph.add_task(make_record_job(&ctx, 3));
+        graph.precede(a, b);
+        graph.precede(a, c);
+        graph.precede(b, d);
+        graph.precede(c, d);
+        graph.run(dispatcher);
+
+        ASSERT_EQ(ctx.next.load(), 4);
+        ASSERT_EQ(ctx.order[a].load(), 0);
+        ASSERT_EQ(ctx.order[d].load(), 3);
+    }
+}
+
+TEST(test_task_graph, independent_chains) {
+    edyn::job_dispatcher dispatcher;
+    dispatcher.start(4);
+
+    constexpr int num_chains = 200;
+    constexpr int chain_length = 5;
+    std::atomic<int> counter {0};
+    auto graph = edyn::task_graph{};
+
+    for (int i = 0; i < num_chains; ++i) {
+        auto prev = graph.add_task(make_counter_job(&counter));
+
+        for (int j = 1; j < chain_length; ++j) {
+            auto next = graph.add_task(make_counter_job(&counter));
+            graph.precede(prev, next);
+            prev = next;
+        }
+    }
+
+    ASSERT_EQ(graph.size(), num_chains * chain_length);
+
+    // A graph can run more than once.
+    graph.run(dispatcher);
+    ASSERT_EQ(counter.load(), num_chains * chain_length);
+    graph.run(dispatcher);
+    ASSERT_EQ(counter.load(), 2 * num_chains * chain_length);
+}
+
+TEST(test_task_graph, fan_out_fan_in) {
+    edyn::job_dispatcher dispatcher;
+    dispatcher.start(4);
+
+    constexpr int num_branches = 500;
+    auto ctx = record_context{};
+    std::atomic<int> counter {0};
+    auto graph = edyn::task_graph{};
+    auto source = graph.add_task(make_record_job(&ctx, 0));
+    auto sink = graph.add_task(make_record_job(&ctx, 1));
+
+    for (int i = 0; i < num_branches; ++i) {
+        auto branch = graph.add_task(make_counter_job(&counter));
+        graph.precede(source, branch);
+        graph.precede(branch, sink);
+    }
+
+    graph.run(dispatcher);
+
+    ASSERT_EQ(counter.load(), num_branches);
+    ASSERT_EQ(ctx.order[source].load(), 0);
+    ASSERT_EQ(ctx.order[sink].load(), 1);
+}
@@ -0,0 +1,50 @@
+#include "../common/common.hpp"
+#include "edyn/parallel/triple_buffer.hpp"
+
+#include <thread>
+
+TEST(test_triple_buffer, takes_latest_value) {
+    auto buffer = edyn::triple_buffer<int>{};
+    ASSERT_FALSE(buffer.swap());
+
+    buffer.back() = 1;
+    buffer.publish();
+    buffer.back() = 2;
+    buffer.publish();
+
+    // Only the latest published value is seen.
+    ASSERT_TRUE(buffer.swap());
+    ASSERT_EQ(buffer.front(), 2);
+    ASSERT_FALSE(buffer.swap());
+    ASSERT_EQ(buffer.front(), 2);
+
+    buffer.back() = 3;
+    buffer.publish();
+    ASSERT_TRUE(buffer.swap());
+    ASSERT_EQ(buffer.front(), 3);
+}
+
+TEST(test_triple_buffer, concurrent_values_increase) {
+    constexpr int num_values = 100000;
+    auto buffer = edyn::triple_buffer<std::pair<int, int>>{};
+
+    auto writer = std::thread([&] {
+        for (int i = 1; i <= num_values; ++i) {
+            buffer.back() = {i, -i};
+            buffer.publish();
+        }
+    });
+
+    auto last = 0;
+
+    while (last < num_values) {
+        if (buffer.swap()) {
+            auto [value, negated] = buffer.front();
+            ASSERT_GT(value, last);
+            ASSERT_EQ(negated, -value);
+            last = value;
+        }
+    }
+
+    writer.join();
+}
@@ -0,0 +1,188 @@
+#include "../common/common.hpp"
+#include "edyn/parallel/job_dispatcher.hpp"
+#include "edyn/parallel/work_stealing_deque.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+static edyn::job make_counter_job(std::atomic<int> *counter, int value) {
+    auto j = edyn::job{};
+    std::memcpy(j.data.data(), &counter, sizeof(counter));
+    std::memcpy(j.data.data() + sizeof(counter), &value, sizeof(value));
+    j.func = [](edyn::job::data_type &data) {
+        std::atomic<int> *counter;
+        int value;
+        std::memcpy(&counter, data.data(), sizeof(counter));
+        std::memcpy(&value, data.data() + sizeof(counter), sizeof(value));
+        counter->fetch_add(value, std::memory_order_relaxed);
+    };
+    return j;
+}
+
+static int get_job_value(const edyn::job &j) {
+    int value;
+    std::memcpy(&value, j.data.data() + sizeof(std::atomic<int> *), sizeof(value));
+    return value;
+}
+
+TEST(test_work_stealing, deque_order) {
+    auto deque = std::make_unique<edyn::work_stealing_deque>();
+    std::atomic<int> counter {0};
+
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(deque->push(make_counter_job(&counter, i)));
+    }
+
+    ASSERT_EQ(deque->size(), 4);
+
+    // Owner takes the most recent job and thieves take the oldest.
+    edyn::job j;
+    ASSERT_TRUE(deque->pop(j));
+    ASSERT_EQ(get_job_value(j), 3);
+    ASSERT_TRUE(deque->steal(j));
+    ASSERT_EQ(get_job_value(j), 0);
+    ASSERT_TRUE(deque->pop(j));
+    ASSERT_EQ(get_job_value(j), 2);
+    ASSERT_TRUE(deque->pop(j));
+    ASSERT_EQ(get_job_value(j), 1);
+    ASSERT_FALSE(deque->pop(j));
+    ASSERT_FALSE(deque->steal(j));
+    ASSERT_EQ(deque->size(), 0);
+}
+
+TEST(test_work_stealing, deque_full) {
+    auto deque = std::make_unique<edyn::work_stealing_deque>();
+    std::atomic<int> counter {0};
+
+    for (size_t i = 0; i < edyn::work_stealing_deque::capacity; ++i) {
+        ASSERT_TRUE(deque->push(make_counter_job(&counter, 1)));
+    }
+
+    ASSERT_FALSE(deque->push(make_counter_job(&counter, 1)));
+}
+
+TEST(test_work_stealing, deque_concurrent_steal) {
+    auto deque = std::make_unique<edyn::work_stealing_deque>();
+    std::atomic<int> counter {0};
+    std::atomic<bool> done {false};
+    constexpr int num_jobs = 100000;
+
+    // Every job must run exactly once, either in the owner or in a thief.
+    auto thief = [&]() {
+        edyn::job j;
+        while (!done.load(std::memory_order_acquire)) {
+            if (deque->steal(j)) {
+                j();
+            }
+        }
+        while (deque->steal(j)) {
+            j();
+        }
+    };
+
+    std::thread thieves[] = {std::thread(thief), std::thread(thief), std::thread(thief)};
+
+    for (int i = 0; i < num_jobs; ++i) {
+        while (!deque->push(make_counter_job(&counter, 1))) {
+            edyn::job j;
+            if (deque->pop(j)) {
+                j();
+            }
+        }
+
+        if (i % 3 == 0) {
+            edyn::job j;
+            if (deque->pop(j)) {
+                j();
+            }
+        }
+    }
+
+    edyn::job j;
+    while (deque->pop(j)) {
+        j();
+    }
+
+    done.store(true, std::memory_order_release);
+
+    for (auto &t : thieves) {
+        t.join();
+    }
+
+    ASSERT_EQ(counter.load(), num_jobs);
+}
+
+struct spawn_context {
+    edyn::job_dispatcher *dispatcher;
+    std::atomic<int> counter {0};
+};
+
+TEST(test_work_stealing, dispatcher_nested_jobs) {
+    edyn::job_dispatcher dispatcher;
+    dispatcher.start(4);
+
+    auto ctx = spawn_context{};
+    ctx.dispatcher = &dispatcher;
+    constexpr int num_parents = 64;
+    constexpr int num_children = 200;
+
+    // Jobs scheduled from a worker go into its deque, from where the other
+    // workers have to steal them.
+    auto parent = edyn::job{};
+    auto ctx_ptr = &ctx;
+    std::memcpy(parent.data.data(), &ctx_ptr, sizeof(ctx_ptr));
+    parent.func = [](edyn::job::data_type &data) {
+        spawn_context *ctx;
+        std::memcpy(&ctx, data.data(), sizeof(ctx));
+
+        for (int i = 0; i < num_children; ++i) {
+            ctx->dispatcher->async(make_counter_job(&ctx->counter, 1));
+        }
+    };
+
+    for (int i = 0; i < num_parents; ++i) {
+        dispatcher.async(parent);
+    }
+
+    // Stopping runs all pending jobs.
+    dispatcher.stop();
+
+    ASSERT_EQ(ctx.counter.load(), num_parents * num_children);
+}
+
+struct current_context {
+    std::atomic<edyn::job_dispatcher *> seen {nullptr};
+};
+
+TEST(test_work_stealing, dispatcher_current) {
+    edyn::job_dispatcher first, second;
+    first.start(2);
+    second.start(2);
+
+    ASSERT_EQ(&edyn::job_dispatcher::current(), &edyn::job_dispatcher::global());
+    edyn::job_dispatcher::bind_current(&second);
+    ASSERT_EQ(&edyn::job_dispatcher::current(), &second);
+    edyn::job_dispatcher::bind_current(nullptr);
+    ASSERT_EQ(&edyn::job_dispatcher::current(), &edyn::job_dispatcher::global());
+
+    // Jobs see the dispatcher of the worker running them regardless of the
+    // dispatcher bound to the thread that scheduled them.
+    auto ctx = current_context{};
+    auto j = edyn::job{};
+    auto ctx_ptr = &ctx;
+    std::memcpy(j.data.data(), &ctx_ptr, sizeof(ctx_ptr));
+    j.func = [](edyn::job::data_type &data) {
+        current_context *ctx;
+        std::memcpy(&ctx, data.data(), sizeof(ctx));
+        ctx->seen.store(&edyn::job_dispatcher::current());
+    };
+
+    edyn::job_dispatcher::bind_current(&second);
+    first.async(j);
+    first.stop();
+    edyn::job_dispatcher::bind_current(nullptr);
+
+    ASSERT_EQ(ctx.seen.load(), &first);
+    second.stop();
+}
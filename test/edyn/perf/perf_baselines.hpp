@@ -0,0 +1,37 @@
+#ifndef TEST_EDYN_PERF_PERF_BASELINES_HPP
+#define TEST_EDYN_PERF_PERF_BASELINES_HPP
+
+#include <cstddef>
+
+/**
+ * Upper bounds for the work counted by the perf smoke tests, normalized by
+ * the size of each scenario. The counts are deterministic, thus they only
+ * change when the algorithms change. If a change legitimately increases a
+ * count, update the bound here in the same commit and explain why.
+ */
+namespace edyn::perf_baselines {
+
+// Grid of boxes resting on a plane, apart from one another.
+
+// Each moved box overlaps itself and the ground plane in the trees. The plane
+// moves once when it's created and overlaps all boxes.
+inline constexpr double max_overlaps_per_moved_entity = 3.0;
+// At most one manifold per box goes through collision detection per step.
+inline constexpr double max_narrowphase_manifolds_per_body_step = 1.0;
+// Normal rows of the contact constraint of each box, one per contact point.
+inline constexpr double max_solver_rows_per_body_step = 4.0;
+// Heap allocations per step once the world has settled, which must not
+// grow with the number of bodies.
+inline constexpr double max_allocations_per_step = 64.0;
+inline constexpr double max_allocations_per_body_step = 0.25;
+
+// Snapshot with position, orientation, linear and angular velocity of each
+// body, encoded with `memory_output_archive`. Bytes per entity besides the
+// 13 scalars of component data, i.e. the entity and its index, baseline age
+// and delta mask in each pool.
+inline constexpr size_t max_snapshot_overhead_bytes_per_entity = 56;
+inline constexpr size_t max_snapshot_header_bytes = 256;
+
+}
+
+#endif // TEST_EDYN_PERF_PERF_BASELINES_HPP
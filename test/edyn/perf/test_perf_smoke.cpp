@@ -0,0 +1,171 @@
+#include "../common/common.hpp"
+#include "perf_baselines.hpp"
+#include "edyn/collision/broadphase.hpp"
+#include "edyn/collision/narrowphase.hpp"
+#include "edyn/comp/angvel.hpp"
+#include "edyn/comp/linvel.hpp"
+#include "edyn/comp/orientation.hpp"
+#include "edyn/comp/position.hpp"
+#include "edyn/dynamics/island_solver_stats.hpp"
+#include "edyn/networking/comp/networked_comp.hpp"
+#include "edyn/networking/packet/registry_snapshot.hpp"
+#include "edyn/serialization/memory_archive.hpp"
+#include "edyn/util/tuple_util.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Counts heap allocations made by this test executable.
+static std::atomic<size_t> g_num_allocations {0};
+
+void * operator new(size_t size) {
+    g_num_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (auto *ptr = std::malloc(size > 0 ? size : 1)) {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+
+struct grid_counts {
+    size_t num_bodies {};
+    size_t num_steps {};
+    size_t num_moved_entities {};
+    size_t num_overlaps {};
+    size_t num_narrowphase_manifolds {};
+    size_t num_solver_rows {};
+    // Allocations in the steps after the warm-up steps.
+    size_t num_allocations {};
+    size_t num_measured_steps {};
+};
+
+// Steps a grid of boxes resting on a plane, which do not touch one another,
+// and accumulates the work done in each step.
+grid_counts run_resting_grid(unsigned side, unsigned num_steps, unsigned warmup_steps) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+    edyn::set_collect_solver_stats(registry, true);
+
+    auto floor_def = edyn::rigidbody_def{};
+    floor_def.kind = edyn::rigidbody_kind::rb_static;
+    floor_def.shape = edyn::plane_shape{{0, 1, 0}, 0};
+    edyn::make_rigidbody(registry, floor_def);
+
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::box_shape{0.25, 0.25, 0.25};
+    def.sleeping_disabled = true;
+
+    for (unsigned i = 0; i < side; ++i) {
+        for (unsigned j = 0; j < side; ++j) {
+            def.position = {edyn::scalar(i), edyn::scalar(0.25), edyn::scalar(j)};
+            edyn::make_rigidbody(registry, def);
+        }
+    }
+
+    edyn::set_paused(registry, true);
+
+    auto counts = grid_counts{};
+    counts.num_bodies = side * side;
+    counts.num_steps = num_steps;
+
+    for (unsigned step = 0; step < num_steps; ++step) {
+        auto num_allocations = g_num_allocations.load(std::memory_order_relaxed);
+        edyn::step_simulation(registry);
+
+        if (step >= warmup_steps) {
+            counts.num_allocations += g_num_allocations.load(std::memory_order_relaxed) - num_allocations;
+            ++counts.num_measured_steps;
+        }
+
+        auto &bphase_stats = registry.ctx().get<edyn::broadphase>().get_stats();
+        counts.num_moved_entities += bphase_stats.num_moved_entities;
+        counts.num_overlaps += bphase_stats.num_overlaps;
+        counts.num_narrowphase_manifolds += registry.ctx().get<edyn::narrowphase>().get_stats().num_manifolds;
+
+        for (auto [entity, stats] : registry.view<edyn::island_solver_stats>().each()) {
+            counts.num_solver_rows += stats.total_rows();
+        }
+    }
+
+    edyn::detach(registry);
+
+    return counts;
+}
+
+void check_grid_counts(const grid_counts &counts) {
+    using namespace edyn::perf_baselines;
+    auto body_steps = double(counts.num_bodies * counts.num_steps);
+
+    ASSERT_LE(double(counts.num_overlaps), max_overlaps_per_moved_entity * double(counts.num_moved_entities));
+    ASSERT_LE(double(counts.num_narrowphase_manifolds), max_narrowphase_manifolds_per_body_step * body_steps);
+    ASSERT_LE(double(counts.num_solver_rows), max_solver_rows_per_body_step * body_steps);
+    ASSERT_GT(counts.num_solver_rows, 0);
+
+    auto allocations_per_step = double(counts.num_allocations) / double(counts.num_measured_steps);
+    ASSERT_LE(allocations_per_step, max_allocations_per_step +
+                                    max_allocations_per_body_step * double(counts.num_bodies));
+}
+
+}
+
+TEST(test_perf_smoke, resting_grid_small) {
+    auto counts = run_resting_grid(4, 60, 30);
+    check_grid_counts(counts);
+}
+
+TEST(test_perf_smoke, resting_grid_large) {
+    auto counts = run_resting_grid(12, 60, 30);
+    check_grid_counts(counts);
+}
+
+TEST(test_perf_smoke, snapshot_bytes) {
+    entt::registry registry;
+    auto entities = std::vector<entt::entity>{};
+    constexpr size_t num_entities = 64;
+
+    for (size_t i = 0; i < num_entities; ++i) {
+        auto entity = registry.create();
+        auto k = edyn::scalar(i);
+        registry.emplace<edyn::position>(entity, k, edyn::scalar(1), -k);
+        registry.emplace<edyn::orientation>(entity, edyn::quaternion_axis_angle(edyn::vector3_y, k));
+        registry.emplace<edyn::linvel>(entity, edyn::scalar(1), k, edyn::scalar(0));
+        registry.emplace<edyn::angvel>(entity, edyn::scalar(0), edyn::scalar(2), edyn::scalar(0));
+        entities.push_back(entity);
+    }
+
+    auto snap = edyn::packet::registry_snapshot{};
+    snap.id = 1;
+
+    auto insert = [&](auto component) {
+        using component_type = decltype(component);
+        auto index = edyn::tuple_index_of<edyn::component_index_type, component_type>(edyn::networked_components);
+        edyn::internal::snapshot_insert_entities<component_type>(registry, entities.begin(), entities.end(), snap, index);
+    };
+
+    insert(edyn::position{});
+    insert(edyn::orientation{});
+    insert(edyn::linvel{});
+    insert(edyn::angvel{});
+
+    auto buffer = std::vector<uint8_t>{};
+    auto archive = edyn::memory_output_archive(buffer);
+    archive(snap);
+
+    using namespace edyn::perf_baselines;
+    auto max_bytes = max_snapshot_header_bytes + num_entities *
+        (13 * sizeof(edyn::scalar) + max_snapshot_overhead_bytes_per_entity);
+    ASSERT_LE(buffer.size(), max_bytes);
+}
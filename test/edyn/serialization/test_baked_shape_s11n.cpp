@@ -0,0 +1,163 @@
+#include "../common/common.hpp"
+#include "edyn/serialization/baked_shape_s11n.hpp"
+#include "edyn/util/shape_io.hpp"
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+static const char *cube_obj =
+    "# Unit cube\r\n"
+    "o Cube\r\n"
+    "v 1 1 1\r\n"
+    "v 1 1 -1\r\n"
+    "v 1 -1 1\r\n"
+    "v 1 -1 -1\r\n"
+    "v -1 1 1\r\n"
+    "v -1 1 -1\r\n"
+    "v -1 -1 1\r\n"
+    "v -1 -1 -1\r\n"
+    "vn 0 1 0\r\n"
+    "f 1//1 5//1 7//1 3//1\r\n"
+    "f 4/1/1 3/1/1 7/1/1 8/1/1\r\n"
+    "f 8 7 5 6\r\n"
+    "f 6 2 4 8\r\n"
+    "f 2 1 3 4\r\n"
+    "f 6 5 1 2\r\n";
+
+TEST(baked_shape_serialization, parse_obj) {
+    auto ss = std::stringstream(cube_obj);
+    auto meshes = std::vector<edyn::obj_mesh>{};
+    edyn::load_meshes_from_obj(ss, meshes);
+
+    ASSERT_EQ(meshes.size(), 1);
+    ASSERT_EQ(meshes[0].name, "Cube");
+    ASSERT_EQ(meshes[0].vertices.size(), 8);
+    ASSERT_EQ(meshes[0].faces.size(), 12);
+    ASSERT_EQ(meshes[0].indices[1], 4);
+    ASSERT_EQ(meshes[0].indices[4], 3);
+
+    ss = std::stringstream(cube_obj);
+    auto vertices = std::vector<edyn::vector3>{};
+    auto indices = std::vector<uint32_t>{};
+    edyn::load_tri_mesh_from_obj(ss, vertices, indices, nullptr,
+                                 edyn::vector3_zero, edyn::quaternion_identity, {2, 2, 2});
+
+    // Quads are triangulated.
+    ASSERT_EQ(indices.size(), 6 * 2 * 3);
+    ASSERT_SCALAR_EQ(vertices[7].y, -2);
+}
+
+TEST(baked_shape_serialization, triangle_mesh) {
+    auto ss = std::stringstream(cube_obj);
+    auto vertices = std::vector<edyn::vector3>{};
+    auto indices = std::vector<uint32_t>{};
+    edyn::load_tri_mesh_from_obj(ss, vertices, indices);
+
+    auto trimesh = edyn::triangle_mesh{};
+    trimesh.insert_vertices(vertices.begin(), vertices.end());
+    trimesh.insert_indices(indices.begin(), indices.end());
+    trimesh.initialize();
+
+    auto filename = "baked_trimesh.bin";
+    ASSERT_TRUE(edyn::write_baked_triangle_mesh(filename, trimesh));
+
+    auto baked = edyn::load_baked_triangle_mesh(filename);
+    ASSERT_TRUE(baked);
+    ASSERT_EQ(baked->num_vertices(), trimesh.num_vertices());
+    ASSERT_EQ(baked->num_triangles(), trimesh.num_triangles());
+    ASSERT_EQ(baked->num_edges(), trimesh.num_edges());
+    ASSERT_SCALAR_EQ(baked->get_aabb().max.x, trimesh.get_aabb().max.x);
+
+    for (size_t i = 0; i < trimesh.num_triangles(); ++i) {
+        ASSERT_EQ(baked->get_triangle_normal(i), trimesh.get_triangle_normal(i));
+    }
+
+    // Files of another kind are rejected.
+    ASSERT_TRUE(edyn::load_baked_convex_polyhedrons(filename).empty());
+}
+
+TEST(baked_shape_serialization, triangle_mesh_view) {
+    auto ss = std::stringstream(cube_obj);
+    auto vertices = std::vector<edyn::vector3>{};
+    auto indices = std::vector<uint32_t>{};
+    edyn::load_tri_mesh_from_obj(ss, vertices, indices);
+
+    auto trimesh = edyn::triangle_mesh{};
+    trimesh.insert_vertices(vertices.begin(), vertices.end());
+    trimesh.insert_indices(indices.begin(), indices.end());
+    trimesh.initialize();
+
+    auto filename = "baked_trimesh_view.bin";
+    ASSERT_TRUE(edyn::write_baked_triangle_mesh(filename, trimesh));
+
+    auto mapped = edyn::map_baked_triangle_mesh(filename);
+    ASSERT_TRUE(mapped);
+    ASSERT_TRUE(mapped->is_view());
+    ASSERT_FALSE(trimesh.is_view());
+    ASSERT_EQ(mapped->num_triangles(), trimesh.num_triangles());
+    ASSERT_EQ(mapped->num_edges(), trimesh.num_edges());
+
+    for (size_t i = 0; i < trimesh.num_triangles(); ++i) {
+        ASSERT_EQ(mapped->get_triangle_vertex_indices(i), trimesh.get_triangle_vertex_indices(i));
+        ASSERT_EQ(mapped->get_triangle_normal(i), trimesh.get_triangle_normal(i));
+
+        for (size_t j = 0; j < 3; ++j) {
+            ASSERT_EQ(mapped->get_face_edge_index(i, j), trimesh.get_face_edge_index(i, j));
+            ASSERT_EQ(mapped->get_adjacent_face_normal(i, j), trimesh.get_adjacent_face_normal(i, j));
+        }
+    }
+
+    for (size_t i = 0; i < trimesh.num_edges(); ++i) {
+        ASSERT_EQ(mapped->is_convex_edge(i), trimesh.is_convex_edge(i));
+        ASSERT_EQ(mapped->is_boundary_edge(i), trimesh.is_boundary_edge(i));
+    }
+
+    // The tree is used as stored.
+    auto query_aabb = edyn::AABB{{0.5, 0.5, -2}, {2, 2, 2}};
+    auto expected = std::vector<size_t>{};
+    auto visited = std::vector<size_t>{};
+    trimesh.visit_triangles(query_aabb, [&](auto tri_idx) { expected.push_back(tri_idx); });
+    mapped->visit_triangles(query_aabb, [&](auto tri_idx) { visited.push_back(tri_idx); });
+    ASSERT_FALSE(expected.empty());
+    ASSERT_EQ(visited, expected);
+
+    // Memory owned by the caller, which stays alive with the mesh.
+    auto file = std::ifstream(filename, std::ios::binary);
+    auto blob = std::make_shared<std::vector<uint8_t>>(std::istreambuf_iterator<char>(file),
+                                                       std::istreambuf_iterator<char>());
+    auto viewed = edyn::view_baked_triangle_mesh(blob->data(), blob->size(), blob);
+    blob.reset();
+    ASSERT_TRUE(viewed);
+    ASSERT_EQ(viewed->num_vertices(), trimesh.num_vertices());
+    ASSERT_EQ(viewed->get_vertex_position(7), trimesh.get_vertex_position(7));
+    ASSERT_SCALAR_EQ(viewed->get_aabb().min.z, trimesh.get_aabb().min.z);
+
+    // Truncated data is rejected.
+    auto truncated = std::vector<uint8_t>(64);
+    ASSERT_FALSE(edyn::view_baked_triangle_mesh(truncated.data(), truncated.size()));
+}
+
+TEST(baked_shape_serialization, convex_polyhedrons) {
+    auto ss = std::stringstream(cube_obj);
+    auto polyhedrons = edyn::load_convex_polyhedrons_from_obj(ss);
+    ASSERT_EQ(polyhedrons.size(), 1);
+
+    auto filename = "baked_polyhedrons.bin";
+    ASSERT_TRUE(edyn::write_baked_convex_polyhedrons(filename, polyhedrons));
+
+    auto baked = edyn::load_baked_convex_polyhedrons(filename);
+    ASSERT_EQ(baked.size(), 1);
+
+    auto &mesh = *polyhedrons[0].shape.mesh;
+    auto &baked_mesh = *baked[0].shape.mesh;
+    ASSERT_EQ(baked_mesh.vertices, mesh.vertices);
+    ASSERT_EQ(baked_mesh.edges, mesh.edges);
+    ASSERT_EQ(baked_mesh.normals, mesh.normals);
+    ASSERT_EQ(baked_mesh.neighbor_indices, mesh.neighbor_indices);
+    ASSERT_EQ(baked_mesh.relevant_faces, mesh.relevant_faces);
+    ASSERT_SCALAR_EQ(baked_mesh.bounding_radius, mesh.bounding_radius);
+    ASSERT_TRUE(baked_mesh.validate());
+
+    auto compound = edyn::load_baked_compound_shape(filename);
+    ASSERT_EQ(compound.nodes.size(), 1);
+}
@@ -0,0 +1,85 @@
+#include "../common/common.hpp"
+#include <edyn/serialization/bitpack_archive.hpp>
+
+TEST(bitpack_archive_test, round_trip) {
+    bool flags[] = {true, false, true};
+    uint8_t byte = 200;
+    uint32_t small = 5, large = 1u << 30;
+    int32_t negative = -3;
+    float f = 1.5f;
+    double d = -2.25;
+    auto axis = edyn::coordinate_axis::z;
+    auto str = std::string("edyn");
+
+    auto buffer = edyn::bitpack_output_archive::buffer_type{};
+    auto output = edyn::bitpack_output_archive(buffer);
+    output(flags[0], flags[1], flags[2], byte, small, large, negative, f, d, axis, str);
+
+    auto input = edyn::bitpack_input_archive(buffer.data(), buffer.size());
+    bool flags_in[3];
+    uint8_t byte_in;
+    uint32_t small_in, large_in;
+    int32_t negative_in;
+    float f_in;
+    double d_in;
+    edyn::coordinate_axis axis_in;
+    std::string str_in;
+    input(flags_in[0], flags_in[1], flags_in[2], byte_in, small_in, large_in, negative_in, f_in, d_in, axis_in, str_in);
+
+    ASSERT_FALSE(input.failed());
+    ASSERT_TRUE(input.eof());
+    ASSERT_EQ(flags_in[0], true);
+    ASSERT_EQ(flags_in[1], false);
+    ASSERT_EQ(flags_in[2], true);
+    ASSERT_EQ(byte_in, byte);
+    ASSERT_EQ(small_in, small);
+    ASSERT_EQ(large_in, large);
+    ASSERT_EQ(negative_in, negative);
+    ASSERT_EQ(f_in, f);
+    ASSERT_EQ(d_in, d);
+    ASSERT_EQ(axis_in, axis);
+    ASSERT_EQ(str_in, str);
+}
+
+TEST(bitpack_archive_test, smaller_than_memory_archive) {
+    auto values = std::vector<uint32_t>{1, 2, 3, 100, 7};
+
+    auto bitpack_buffer = edyn::bitpack_output_archive::buffer_type{};
+    auto bitpack_output = edyn::bitpack_output_archive(bitpack_buffer);
+    bitpack_output(values);
+
+    auto memory_buffer = edyn::memory_output_archive::buffer_type{};
+    auto memory_output = edyn::memory_output_archive(memory_buffer);
+    memory_output(values);
+
+    ASSERT_LT(bitpack_buffer.size(), memory_buffer.size());
+}
+
+TEST(bitpack_archive_test, quantized) {
+    edyn::scalar value = 12.3456;
+
+    auto buffer = edyn::bitpack_output_archive::buffer_type{};
+    auto output = edyn::bitpack_output_archive(buffer);
+    edyn::serialize_quantized(output, value, -1000, 1000, 0.01);
+    // 200k steps fit in 18 bits.
+    ASSERT_EQ(buffer.size(), 3);
+
+    auto input = edyn::bitpack_input_archive(buffer.data(), buffer.size());
+    edyn::scalar value_in;
+    edyn::serialize_quantized(input, value_in, -1000, 1000, 0.01);
+    ASSERT_FALSE(input.failed());
+    ASSERT_NEAR(value_in, value, 0.005 + 0.0001);
+}
+
+TEST(bitpack_archive_test, truncated_buffer_fails) {
+    uint64_t value = ~uint64_t{0};
+
+    auto buffer = edyn::bitpack_output_archive::buffer_type{};
+    auto output = edyn::bitpack_output_archive(buffer);
+    output(value);
+
+    auto input = edyn::bitpack_input_archive(buffer.data(), buffer.size() - 1);
+    uint64_t value_in;
+    input(value_in);
+    ASSERT_TRUE(input.failed());
+}
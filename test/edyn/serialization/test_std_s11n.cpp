@@ -26,3 +26,39 @@ TEST(std_serialization_test, test_map) {
     ASSERT_EQ(map_in["one"], 1);
     ASSERT_EQ(map_in["twelve"], 12);
 }
+
+TEST(memory_archive_test, bulk_array_matches_per_element) {
+    auto values = std::vector<edyn::linvel>{};
+
+    for (int i = 0; i < 5; ++i) {
+        values.push_back({edyn::vector3{edyn::scalar(i), 2, edyn::scalar(-i)}});
+    }
+
+    auto buffer = edyn::memory_output_archive::buffer_type{};
+    auto output = edyn::memory_output_archive(buffer);
+    output.write_array(values.data(), values.size());
+
+    auto expected = edyn::memory_output_archive::buffer_type{};
+    auto expected_output = edyn::memory_output_archive(expected);
+
+    for (auto &v : values) {
+        expected_output(v);
+    }
+
+    ASSERT_EQ(buffer, expected);
+
+    auto input = edyn::memory_input_archive(buffer.data(), buffer.size());
+    auto values_in = std::vector<edyn::linvel>(values.size());
+    input.read_array(values_in.data(), values_in.size());
+    ASSERT_FALSE(input.failed());
+    ASSERT_TRUE(input.eof());
+
+    for (size_t i = 0; i < values.size(); ++i) {
+        ASSERT_EQ(values_in[i], values[i]);
+    }
+
+    // Reading past the end fails.
+    auto truncated = edyn::memory_input_archive(buffer.data(), buffer.size() - 1);
+    truncated.read_array(values_in.data(), values_in.size());
+    ASSERT_TRUE(truncated.failed());
+}
@@ -1,5 +1,6 @@
 #include "../common/common.hpp"
 #include "edyn/util/shape_util.hpp"
+#include "edyn/shapes/create_paged_triangle_mesh.hpp"
 
 TEST(triangle_mesh_serialization, test) {
     // Create triangle mesh.
@@ -70,3 +71,164 @@ TEST(triangle_mesh_serialization, test) {
         ASSERT_EQ(trimesh.is_convex_edge(i), input_trimesh.is_convex_edge(i));
     }
 }
+
+TEST(triangle_mesh_serialization, compact_tree) {
+    std::vector<edyn::vector3> vertices;
+    std::vector<edyn::triangle_mesh::index_type> indices;
+    edyn::make_plane_mesh(6, 6, 12, 12, vertices, indices);
+
+    auto trimesh = edyn::triangle_mesh();
+    trimesh.insert_vertices(vertices.begin(), vertices.end());
+    trimesh.insert_indices(indices.begin(), indices.end());
+    trimesh.initialize(edyn::triangle_mesh::tree_type::compact);
+
+    auto filename = "trimesh_compact.bin";
+
+    {
+        auto output = edyn::file_output_archive(filename);
+        edyn::serialize(output, trimesh);
+    }
+
+    auto input_trimesh = edyn::triangle_mesh();
+
+    {
+        auto input = edyn::file_input_archive(filename);
+        edyn::serialize(input, input_trimesh);
+    }
+
+    ASSERT_EQ(input_trimesh.get_tree_type(), edyn::triangle_mesh::tree_type::compact);
+    ASSERT_EQ(trimesh.num_triangles(), input_trimesh.num_triangles());
+
+    auto aabb = edyn::AABB{{-1, -1, -1}, {1, 1, 1}};
+    auto expected = std::vector<size_t>{};
+    auto result = std::vector<size_t>{};
+    trimesh.visit_triangles(aabb, [&](auto tri_idx) { expected.push_back(tri_idx); });
+    input_trimesh.visit_triangles(aabb, [&](auto tri_idx) { result.push_back(tri_idx); });
+    ASSERT_FALSE(expected.empty());
+    ASSERT_EQ(expected, result);
+}
+
+TEST(triangle_mesh_serialization, compressed) {
+    std::vector<edyn::vector3> vertices;
+    std::vector<edyn::triangle_mesh::index_type> indices;
+    edyn::make_plane_mesh(6, 6, 12, 12, vertices, indices);
+
+    for (auto &v : vertices) {
+        v.y = std::sin(v.x) * std::cos(v.z);
+    }
+
+    auto trimesh = edyn::triangle_mesh();
+    trimesh.insert_vertices(vertices.begin(), vertices.end());
+    trimesh.insert_indices(indices.begin(), indices.end());
+    trimesh.initialize();
+    auto uncompressed_size = edyn::serialization_sizeof(trimesh);
+    trimesh.compress();
+    ASSERT_LT(edyn::serialization_sizeof(trimesh), uncompressed_size);
+
+    auto filename = "trimesh_compressed.bin";
+
+    {
+        auto output = edyn::file_output_archive(filename);
+        edyn::serialize(output, trimesh);
+    }
+
+    auto input_trimesh = edyn::triangle_mesh();
+
+    {
+        auto input = edyn::file_input_archive(filename);
+        edyn::serialize(input, input_trimesh);
+    }
+
+    ASSERT_TRUE(input_trimesh.is_compressed());
+    ASSERT_EQ(trimesh.num_vertices(), input_trimesh.num_vertices());
+    ASSERT_EQ(trimesh.num_triangles(), input_trimesh.num_triangles());
+
+    for (size_t i = 0; i < trimesh.num_vertices(); ++i) {
+        ASSERT_VECTOR3_EQ(trimesh.get_vertex_position(i), input_trimesh.get_vertex_position(i));
+    }
+
+    for (size_t i = 0; i < trimesh.num_triangles(); ++i) {
+        ASSERT_EQ(trimesh.get_triangle_vertex_indices(i), input_trimesh.get_triangle_vertex_indices(i));
+        ASSERT_VECTOR3_EQ(trimesh.get_triangle_normal(i), input_trimesh.get_triangle_normal(i));
+    }
+}
+
+class keep_triangle_mesh_page_loader: public edyn::triangle_mesh_page_loader_base {
+public:
+    void load(edyn::paged_triangle_mesh *, size_t) override {}
+};
+
+TEST(triangle_mesh_serialization, mapped_paged_mesh) {
+    std::vector<edyn::vector3> vertices;
+    std::vector<edyn::triangle_mesh::index_type> indices;
+    edyn::make_plane_mesh(20, 20, 21, 21, vertices, indices);
+
+    for (auto &v : vertices) {
+        v.y = std::sin(v.x) * std::cos(v.z);
+    }
+
+    auto trimesh = edyn::paged_triangle_mesh(std::make_shared<keep_triangle_mesh_page_loader>());
+    edyn::create_paged_triangle_mesh(trimesh, vertices.begin(), vertices.end(),
+                                     indices.begin(), indices.end(), 32, {}, {}, nullptr);
+
+    auto filename = "paged_trimesh_mapped.bin";
+    ASSERT_TRUE(edyn::write_mapped_paged_triangle_mesh(filename, trimesh));
+
+    auto input = std::make_shared<edyn::paged_triangle_mesh_mapped_input_archive>(filename);
+    ASSERT_TRUE(input->is_valid());
+
+    auto input_trimesh = edyn::paged_triangle_mesh(input);
+    edyn::serialize(*input, input_trimesh);
+    ASSERT_EQ(input_trimesh.num_submeshes(), trimesh.num_submeshes());
+    ASSERT_SCALAR_EQ(input_trimesh.get_aabb().min.x, trimesh.get_aabb().min.x);
+    ASSERT_SCALAR_EQ(input_trimesh.get_aabb().max.z, trimesh.get_aabb().max.z);
+
+    for (size_t i = 0; i < input_trimesh.num_submeshes(); ++i) {
+        ASSERT_EQ(input_trimesh.get_submesh(i), nullptr);
+    }
+
+    // Pages are loaded synchronously since there's no `enqueue_task`.
+    auto aabb = input_trimesh.get_aabb();
+    input_trimesh.prefetch(aabb);
+
+    for (size_t i = 0; i < input_trimesh.num_submeshes(); ++i) {
+        auto submesh = trimesh.get_submesh(i);
+        auto input_submesh = input_trimesh.get_submesh(i);
+        ASSERT_NE(input_submesh, nullptr);
+        ASSERT_EQ(submesh->num_vertices(), input_submesh->num_vertices());
+        ASSERT_EQ(submesh->num_triangles(), input_submesh->num_triangles());
+        ASSERT_EQ(submesh->num_edges(), input_submesh->num_edges());
+
+        for (size_t j = 0; j < submesh->num_vertices(); ++j) {
+            ASSERT_VECTOR3_EQ(submesh->get_vertex_position(j), input_submesh->get_vertex_position(j));
+        }
+
+        for (size_t j = 0; j < submesh->num_edges(); ++j) {
+            ASSERT_EQ(submesh->is_convex_edge(j), input_submesh->is_convex_edge(j));
+        }
+    }
+
+    auto query = edyn::AABB{{-3, -2, -3}, {3, 2, 3}};
+    auto expected = std::vector<std::pair<size_t, size_t>>{};
+    auto result = std::vector<std::pair<size_t, size_t>>{};
+    trimesh.visit_cached_triangles(query, [&](size_t m, size_t t) { expected.emplace_back(m, t); });
+    input_trimesh.visit_cached_triangles(query, [&](size_t m, size_t t) { result.emplace_back(m, t); });
+    ASSERT_FALSE(expected.empty());
+    ASSERT_EQ(expected, result);
+}
+
+TEST(triangle_mesh_serialization, mapped_paged_mesh_invalid_file) {
+    auto filename = "paged_trimesh_invalid.bin";
+
+    {
+        auto output = edyn::file_output_archive(filename);
+        uint32_t value = 1234;
+        output(value, value, value, value);
+    }
+
+    auto input = edyn::paged_triangle_mesh_mapped_input_archive(filename);
+    ASSERT_FALSE(input.is_valid());
+
+    auto missing = edyn::paged_triangle_mesh_mapped_input_archive("does_not_exist.bin");
+    ASSERT_FALSE(missing.is_valid());
+}
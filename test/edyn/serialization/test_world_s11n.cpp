@@ -0,0 +1,98 @@
+#include "../common/common.hpp"
+#include "edyn/serialization/world_s11n.hpp"
+#include "edyn/util/shape_util.hpp"
+
+TEST(test_world_s11n, save_and_load) {
+    entt::registry source;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(source, config);
+
+    auto floor_def = edyn::rigidbody_def{};
+    floor_def.kind = edyn::rigidbody_kind::rb_static;
+    floor_def.shape = edyn::plane_shape{{0, 1, 0}, 0};
+    edyn::make_rigidbody(source, floor_def);
+
+    auto mesh = std::make_shared<edyn::convex_mesh>();
+    edyn::make_box_mesh({0.5, 0.5, 0.5}, mesh->vertices, mesh->indices, mesh->faces);
+    mesh->initialize();
+
+    auto def = edyn::rigidbody_def{};
+    def.mass = 10;
+    def.shape = edyn::polyhedron_shape{mesh};
+    def.position = {0, 0.5, 0};
+    auto rb0 = edyn::make_rigidbody(source, def);
+    def.position = {2, 0.5, 0};
+    auto rb1 = edyn::make_rigidbody(source, def);
+    edyn::make_constraint<edyn::distance_constraint>(source, rb0, rb1, [](auto &con) {
+        con.distance = 2;
+    });
+
+    for (int i = 0; i < 10; ++i) {
+        edyn::update(source);
+    }
+
+    auto buffer = std::vector<uint8_t>{};
+    edyn::save_world(source, buffer);
+
+    entt::registry target;
+    edyn::attach(target, config);
+
+    auto entities = std::vector<entt::entity>{};
+    ASSERT_TRUE(edyn::load_world(target, buffer.data(), buffer.size(), &entities));
+    ASSERT_EQ(entities.size(), 3);
+    ASSERT_EQ(target.view<edyn::rigidbody_tag>().size(), 3);
+
+    // The mesh is shared by both bodies after loading.
+    auto poly_view = target.view<edyn::polyhedron_shape>();
+    ASSERT_EQ(poly_view.size(), 2);
+    auto &poly0 = poly_view.get<edyn::polyhedron_shape>(entities[1]);
+    auto &poly1 = poly_view.get<edyn::polyhedron_shape>(entities[2]);
+    ASSERT_EQ(poly0.mesh, poly1.mesh);
+    ASSERT_EQ(poly0.mesh->normals, mesh->normals);
+
+    ASSERT_EQ(target.get<edyn::position>(entities[1]), source.get<edyn::position>(rb0));
+    ASSERT_EQ(target.get<edyn::position>(entities[2]), source.get<edyn::position>(rb1));
+
+    auto con_view = target.view<edyn::distance_constraint>();
+    ASSERT_EQ(con_view.size(), 1);
+    auto &con = con_view.get<edyn::distance_constraint>(*con_view.begin());
+    ASSERT_EQ(con.body[0], entities[1]);
+    ASSERT_EQ(con.body[1], entities[2]);
+    ASSERT_SCALAR_EQ(con.distance, 2);
+
+    // Contact manifolds with the floor are restored.
+    ASSERT_EQ(target.view<edyn::contact_manifold>().size(),
+              source.view<edyn::contact_manifold>().size());
+
+    edyn::update(target);
+
+    edyn::detach(target);
+    edyn::detach(source);
+}
+
+TEST(test_world_s11n, reject_invalid_data) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::box_shape{0.5, 0.5, 0.5};
+    edyn::make_rigidbody(registry, def);
+
+    auto buffer = std::vector<uint8_t>{};
+    edyn::save_world(registry, buffer);
+
+    // Truncated data does not create anything.
+    entt::registry target;
+    edyn::attach(target, config);
+    ASSERT_FALSE(edyn::load_world(target, buffer.data(), buffer.size() / 2));
+    ASSERT_TRUE(target.view<edyn::rigidbody_tag>().empty());
+
+    buffer[0] = 0;
+    ASSERT_FALSE(edyn::load_world(target, buffer.data(), buffer.size()));
+
+    edyn::detach(target);
+    edyn::detach(registry);
+}
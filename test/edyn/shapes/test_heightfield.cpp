@@ -0,0 +1,115 @@
+#include "../common/common.hpp"
+#include "edyn/shapes/heightfield_shape.hpp"
+#include "edyn/collision/collide.hpp"
+#include "edyn/collision/raycast.hpp"
+
+static edyn::scalar test_height(edyn::scalar x, edyn::scalar z) {
+    return std::sin(x * edyn::scalar(0.5)) * std::cos(z * edyn::scalar(0.3));
+}
+
+static std::shared_ptr<edyn::heightfield> make_test_heightfield(uint32_t tile_size) {
+    constexpr uint32_t num_columns = 41, num_rows = 31;
+    constexpr auto cell_size = edyn::scalar(0.5);
+    auto origin = edyn::vector3{-10, 0, -7.5};
+    auto heights = std::vector<edyn::scalar>{};
+
+    for (uint32_t row = 0; row < num_rows; ++row) {
+        for (uint32_t column = 0; column < num_columns; ++column) {
+            heights.push_back(test_height(origin.x + column * cell_size, origin.z + row * cell_size));
+        }
+    }
+
+    auto hf = std::make_shared<edyn::heightfield>();
+    hf->insert_heights(heights.begin(), heights.end());
+    hf->initialize(num_columns, num_rows, cell_size, origin, tile_size);
+    return hf;
+}
+
+TEST(test_heightfield, cell_triangles) {
+    auto hf = make_test_heightfield(8);
+    ASSERT_SCALAR_EQ(hf->get_aabb().min.x, -10);
+    ASSERT_SCALAR_EQ(hf->get_aabb().max.z, 7.5);
+
+    for (uint32_t k = 0; k < 2; ++k) {
+        auto vertices = hf->get_cell_triangle_vertices(3, 4, k);
+        auto normal = edyn::cross(vertices[1] - vertices[0], vertices[2] - vertices[1]);
+        ASSERT_GT(normal.y, 0);
+    }
+}
+
+TEST(test_heightfield, raycast_tiles) {
+    // Raycasts with and without tiles must hit the same triangles.
+    auto hf_tiles = edyn::heightfield_shape{make_test_heightfield(8)};
+    auto hf_plain = edyn::heightfield_shape{make_test_heightfield(0)};
+
+    for (int i = 0; i < 50; ++i) {
+        auto ctx = edyn::raycast_context{};
+        ctx.pos = edyn::vector3_zero;
+        ctx.orn = edyn::quaternion_identity;
+        ctx.p0 = {edyn::scalar(i % 7 - 3) * 2.5f, 3, edyn::scalar(i % 5 - 2) * 2.5f};
+        ctx.p1 = {edyn::scalar(i % 3 - 1) * 4.5f, -3, edyn::scalar(i % 11 - 5) * 1.2f};
+
+        auto result_tiles = edyn::shape_raycast(hf_tiles, ctx);
+        auto result_plain = edyn::shape_raycast(hf_plain, ctx);
+        ASSERT_LT(result_tiles.fraction, edyn::scalar(1));
+        ASSERT_NEAR(result_tiles.fraction, result_plain.fraction, 1e-5);
+
+        // Intersection point must be on the surface.
+        auto point = edyn::lerp(ctx.p0, ctx.p1, result_tiles.fraction);
+        auto &info = std::get<edyn::heightfield_raycast_info>(result_tiles.info_var);
+        auto vertices = hf_tiles.heightfield->get_cell_triangle_vertices(info.column, info.row, info.triangle_index % 2);
+        ASSERT_NEAR(edyn::dot(point - vertices[0], result_tiles.normal), 0, 1e-4);
+    }
+
+    // Ray above the terrain misses.
+    auto ctx = edyn::raycast_context{};
+    ctx.pos = edyn::vector3_zero;
+    ctx.orn = edyn::quaternion_identity;
+    ctx.p0 = {-9, 2, -7};
+    ctx.p1 = {9, 2, 7};
+    ASSERT_EQ(edyn::shape_raycast(hf_tiles, ctx).fraction, EDYN_SCALAR_MAX);
+}
+
+TEST(test_heightfield, collide_sphere) {
+    auto shape = edyn::heightfield_shape{make_test_heightfield(8)};
+    auto sphere = edyn::sphere_shape{0.5};
+    auto x = edyn::scalar(1.3), z = edyn::scalar(-0.7);
+    auto pos = edyn::vector3{x, test_height(x, z) + edyn::scalar(0.45), z};
+
+    auto ctx = edyn::collision_context{};
+    ctx.posA = pos;
+    ctx.ornA = edyn::quaternion_identity;
+    ctx.aabbA = edyn::shape_aabb(sphere, pos, ctx.ornA);
+    ctx.posB = edyn::vector3_zero;
+    ctx.ornB = edyn::quaternion_identity;
+    ctx.aabbB = edyn::shape_aabb(shape, ctx.posB, ctx.ornB);
+    ctx.threshold = edyn::contact_breaking_threshold;
+
+    auto result = edyn::collision_result{};
+    edyn::collide(sphere, shape, ctx, result);
+    ASSERT_GT(result.num_points, 0);
+
+    for (size_t i = 0; i < result.num_points; ++i) {
+        auto &pt = result.point[i];
+        ASSERT_LT(pt.distance, 0);
+        ASSERT_GT(pt.normal.y, 0.8);
+        ASSERT_TRUE(pt.featureB.has_value());
+    }
+
+    // Feature index of a face is the triangle index in the heightfield.
+    auto &pt = result.point[0];
+    if (std::get<edyn::triangle_feature>(pt.featureB->feature) == edyn::triangle_feature::face) {
+        auto tri_idx = pt.featureB->index;
+        auto column = uint32_t(tri_idx / 2 % 40), row = uint32_t(tri_idx / 2 / 40);
+        auto vertices = shape.heightfield->get_cell_triangle_vertices(column, row, tri_idx % 2);
+        auto normal = edyn::normalize(edyn::cross(vertices[1] - vertices[0], vertices[2] - vertices[1]));
+        ASSERT_NEAR(edyn::dot(normal, pt.normal), 1, 1e-4);
+    }
+
+    // Sphere far above the terrain does not collide.
+    ctx.posA = pos + edyn::vector3{0, 3, 0};
+    ctx.aabbA = edyn::shape_aabb(sphere, ctx.posA, ctx.ornA);
+    auto far_result = edyn::collision_result{};
+    edyn::collide(sphere, shape, ctx, far_result);
+    ASSERT_EQ(far_result.num_points, 0);
+}
@@ -1,6 +1,16 @@
 #include "../common/common.hpp"
+#include "edyn/comp/linvel.hpp"
+#include "edyn/networking/comp/aabb_of_interest.hpp"
+#include "edyn/networking/comp/aabb_oi_follow.hpp"
+#include "edyn/networking/sys/update_paged_meshes_of_interest.hpp"
 #include "edyn/parallel/job_dispatcher.hpp"
 #include "edyn/shapes/create_paged_triangle_mesh.hpp"
+#include "edyn/shapes/paged_mesh_page_cache.hpp"
+#include "edyn/shapes/paged_mesh_pinned_pages.hpp"
+#include "edyn/shapes/paged_mesh_shape.hpp"
+#include "edyn/util/shape_util.hpp"
+#include <algorithm>
+#include <memory>
 
 class triangle_mesh_page_loader: public edyn::triangle_mesh_page_loader_base {
 public:
@@ -47,3 +57,276 @@ TEST(test_paged_trimesh, voronoi_regions) {
 
     edyn::job_dispatcher::global().stop();
 }
+
+// Keeps the submeshes and only assigns them when asked to, which simulates a
+// loader which reads pages from disk in the background.
+class deferred_triangle_mesh_page_loader: public edyn::triangle_mesh_page_loader_base {
+public:
+    void load(edyn::paged_triangle_mesh *trimesh, size_t index) override {
+        requests.push_back(index);
+    }
+
+    void finish(edyn::paged_triangle_mesh &trimesh) {
+        for (auto index : requests) {
+            trimesh.assign_mesh(index, submeshes[index]);
+        }
+
+        requests.clear();
+    }
+
+    std::vector<std::shared_ptr<edyn::triangle_mesh>> submeshes;
+    std::vector<size_t> requests;
+};
+
+TEST(test_paged_trimesh, prefetch_and_cached_visit) {
+    std::vector<edyn::vector3> vertices;
+    std::vector<edyn::triangle_mesh::index_type> indices;
+    edyn::make_plane_mesh(20, 20, 11, 11, vertices, indices);
+
+    auto loader = std::make_shared<deferred_triangle_mesh_page_loader>();
+    auto trimesh = edyn::paged_triangle_mesh(loader);
+    edyn::create_paged_triangle_mesh(trimesh, vertices.begin(), vertices.end(),
+                                     indices.begin(), indices.end(), 8, {}, {}, nullptr);
+    ASSERT_GT(trimesh.num_submeshes(), 4);
+
+    for (size_t i = 0; i < trimesh.num_submeshes(); ++i) {
+        loader->submeshes.push_back(trimesh.get_submesh(i));
+    }
+
+    trimesh.clear_cache();
+
+    auto aabb = edyn::AABB{{-10, -1, -10}, {-6, 1, -6}};
+    auto visited = std::vector<size_t>{};
+    trimesh.visit_cached_submeshes(aabb, [&](size_t mesh_idx) { visited.push_back(mesh_idx); });
+    ASSERT_TRUE(visited.empty());
+
+    auto missing = std::vector<size_t>{};
+    trimesh.visit_missing_submeshes(aabb, [&](size_t mesh_idx, const edyn::AABB &page_aabb) {
+        ASSERT_TRUE(edyn::intersect(page_aabb, aabb));
+        missing.push_back(mesh_idx);
+    });
+    ASSERT_FALSE(missing.empty());
+    ASSERT_LT(missing.size(), trimesh.num_submeshes());
+
+    // Loads are requested but nothing is available until the loader is done.
+    trimesh.prefetch(aabb);
+    auto requests = loader->requests;
+    std::sort(requests.begin(), requests.end());
+    std::sort(missing.begin(), missing.end());
+    ASSERT_EQ(requests, missing);
+
+    trimesh.visit_cached_triangles(aabb, [&](size_t, size_t) { visited.push_back(0); });
+    ASSERT_TRUE(visited.empty());
+
+    loader->finish(trimesh);
+
+    trimesh.visit_cached_submeshes(aabb, [&](size_t mesh_idx) { visited.push_back(mesh_idx); });
+    std::sort(visited.begin(), visited.end());
+    ASSERT_EQ(visited, missing);
+
+    auto num_missing = size_t{0};
+    trimesh.visit_missing_submeshes(aabb, [&](size_t, const edyn::AABB &) { ++num_missing; });
+    ASSERT_EQ(num_missing, 0);
+
+    auto num_triangles = size_t{0};
+    trimesh.visit_cached_triangles(aabb, [&](size_t, size_t) { ++num_triangles; });
+    ASSERT_GT(num_triangles, 0);
+}
+
+TEST(test_paged_trimesh, seam_edges) {
+    std::vector<edyn::vector3> vertices;
+    std::vector<edyn::triangle_mesh::index_type> indices;
+    edyn::make_plane_mesh(20, 20, 11, 11, vertices, indices);
+
+    auto loader = std::make_shared<triangle_mesh_page_loader>();
+    auto trimesh = edyn::paged_triangle_mesh(loader);
+    edyn::create_paged_triangle_mesh(trimesh, vertices.begin(), vertices.end(),
+                                     indices.begin(), indices.end(), 8, {}, {}, nullptr);
+    ASSERT_GT(trimesh.num_submeshes(), 4);
+
+    auto num_seam_edges = size_t{0};
+
+    for (size_t mesh_idx = 0; mesh_idx < trimesh.num_submeshes(); ++mesh_idx) {
+        auto submesh = trimesh.get_submesh(mesh_idx);
+
+        for (size_t edge_idx = 0; edge_idx < submesh->num_edges(); ++edge_idx) {
+            auto [v0, v1] = submesh->get_edge_vertices(edge_idx);
+            auto seam_mesh_idx = submesh->get_edge_seam_submesh_index(edge_idx);
+
+            if (seam_mesh_idx == edyn::triangle_mesh::invalid_submesh_index) {
+                // Only edges on the perimeter of the plane are at the boundary.
+                auto on_perimeter = (std::abs(v0.x) == 10 && v0.x == v1.x) ||
+                                    (std::abs(v0.z) == 10 && v0.z == v1.z);
+                ASSERT_EQ(submesh->is_boundary_edge(edge_idx), on_perimeter);
+                continue;
+            }
+
+            ++num_seam_edges;
+            ASSERT_NE(seam_mesh_idx, mesh_idx);
+            ASSERT_FALSE(submesh->is_boundary_edge(edge_idx));
+
+            // The neighboring submesh has the same edge pointing back.
+            auto neighbor = trimesh.get_submesh(seam_mesh_idx);
+            auto found = false;
+
+            for (size_t other_idx = 0; other_idx < neighbor->num_edges(); ++other_idx) {
+                auto [u0, u1] = neighbor->get_edge_vertices(other_idx);
+
+                if ((u0 == v0 && u1 == v1) || (u0 == v1 && u1 == v0)) {
+                    ASSERT_EQ(neighbor->get_edge_seam_submesh_index(other_idx), mesh_idx);
+                    ASSERT_EQ(neighbor->is_convex_edge(other_idx), submesh->is_convex_edge(edge_idx));
+                    found = true;
+                    break;
+                }
+            }
+
+            ASSERT_TRUE(found);
+        }
+    }
+
+    ASSERT_GT(num_seam_edges, 0);
+}
+
+TEST(test_paged_trimesh, shared_page_cache_budget) {
+    std::vector<edyn::vector3> vertices;
+    std::vector<edyn::triangle_mesh::index_type> indices;
+    edyn::make_plane_mesh(20, 20, 11, 11, vertices, indices);
+
+    auto &page_cache = edyn::paged_mesh_page_cache::global();
+    auto budget = page_cache.get_byte_budget();
+
+    auto loaderA = std::make_shared<deferred_triangle_mesh_page_loader>();
+    auto loaderB = std::make_shared<deferred_triangle_mesh_page_loader>();
+    auto trimeshA = edyn::paged_triangle_mesh(loaderA);
+    auto trimeshB = edyn::paged_triangle_mesh(loaderB);
+
+    for (auto [trimesh, loader] : {std::pair{&trimeshA, loaderA}, std::pair{&trimeshB, loaderB}}) {
+        edyn::create_paged_triangle_mesh(*trimesh, vertices.begin(), vertices.end(),
+                                         indices.begin(), indices.end(), 8, {}, {}, nullptr);
+
+        for (size_t i = 0; i < trimesh->num_submeshes(); ++i) {
+            loader->submeshes.push_back(trimesh->get_submesh(i));
+        }
+
+        trimesh->clear_cache();
+    }
+
+    auto stats_before = page_cache.get_stats();
+
+    // Load all pages of A into the cache.
+    trimeshA.prefetch(trimeshA.get_aabb());
+    loaderA->finish(trimeshA);
+    auto num_pages = trimeshA.num_submeshes();
+    auto stats = page_cache.get_stats();
+    ASSERT_EQ(stats.num_pages, stats_before.num_pages + num_pages);
+    ASSERT_EQ(stats.misses, stats_before.misses + num_pages);
+    auto bytes_per_mesh = stats.num_bytes - stats_before.num_bytes;
+    ASSERT_GT(bytes_per_mesh, 0);
+
+    // Make room for about one mesh in total and pin one page of A.
+    page_cache.set_byte_budget(stats_before.num_bytes + bytes_per_mesh);
+    page_cache.pin(&trimeshA, 0);
+
+    // Loading all pages of B must evict pages of A except the pinned one.
+    trimeshB.prefetch(trimeshB.get_aabb());
+    loaderB->finish(trimeshB);
+    stats = page_cache.get_stats();
+    ASSERT_GT(stats.evictions, stats_before.evictions);
+    ASSERT_NE(trimeshA.get_submesh(0), nullptr);
+
+    auto num_loadedA = size_t{0};
+    for (size_t i = 0; i < trimeshA.num_submeshes(); ++i) {
+        num_loadedA += trimeshA.get_submesh(i) != nullptr;
+    }
+    ASSERT_LT(num_loadedA, num_pages);
+
+    // Visiting loaded pages counts as a hit.
+    auto hits = stats.hits;
+    trimeshA.visit_submeshes(trimeshA.get_aabb(), [](size_t) {});
+    ASSERT_GT(page_cache.get_stats().hits, hits);
+
+    page_cache.unpin(&trimeshA, 0);
+    ASSERT_FALSE(page_cache.is_pinned(&trimeshA, 0));
+    page_cache.set_byte_budget(budget);
+}
+
+TEST(test_paged_trimesh, prefetch_and_pin_pages_of_interest) {
+    std::vector<edyn::vector3> vertices;
+    std::vector<edyn::triangle_mesh::index_type> indices;
+    edyn::make_plane_mesh(20, 20, 11, 11, vertices, indices);
+
+    auto loader = std::make_shared<deferred_triangle_mesh_page_loader>();
+    auto trimesh = std::make_shared<edyn::paged_triangle_mesh>(loader);
+    edyn::create_paged_triangle_mesh(*trimesh, vertices.begin(), vertices.end(),
+                                     indices.begin(), indices.end(), 8, {}, {}, nullptr);
+
+    for (size_t i = 0; i < trimesh->num_submeshes(); ++i) {
+        loader->submeshes.push_back(trimesh->get_submesh(i));
+    }
+
+    trimesh->clear_cache();
+
+    entt::registry registry;
+    auto mesh_entity = registry.create();
+    registry.emplace<edyn::paged_mesh_shape>(mesh_entity, trimesh);
+
+    // A client following a vehicle which moves along the x axis.
+    auto vehicle_entity = registry.create();
+    registry.emplace<edyn::linvel>(vehicle_entity, edyn::vector3{10, 0, 0});
+    auto client_entity = registry.create();
+    auto &aabboi = registry.emplace<edyn::aabb_of_interest>(client_entity);
+    aabboi.aabb = edyn::AABB{{-10, -1, -2}, {-6, 1, 2}};
+    registry.emplace<edyn::aabb_oi_follow>(client_entity, vehicle_entity);
+
+    auto &page_cache = edyn::paged_mesh_page_cache::global();
+    auto pinned = std::make_unique<edyn::paged_mesh_pinned_pages>();
+    edyn::update_paged_meshes_of_interest(registry, *pinned, 1);
+
+    auto pagesA = std::vector<size_t>{};
+    trimesh->visit_submesh_indices(aabboi.aabb, [&](size_t index) { pagesA.push_back(index); });
+    ASSERT_FALSE(pagesA.empty());
+
+    // Pages in the AABB of interest are pinned, and pages ahead of it are
+    // requested as well but not pinned.
+    for (auto index : pagesA) {
+        ASSERT_TRUE(page_cache.is_pinned(trimesh.get(), index));
+        ASSERT_NE(std::find(loader->requests.begin(), loader->requests.end(), index), loader->requests.end());
+    }
+
+    auto ahead = edyn::AABB{{0, -1, -2}, {4, 1, 2}};
+    auto num_ahead = size_t{0};
+    trimesh->visit_submesh_indices(ahead, [&](size_t index) {
+        if (std::find(pagesA.begin(), pagesA.end(), index) == pagesA.end()) {
+            ASSERT_FALSE(page_cache.is_pinned(trimesh.get(), index));
+            ASSERT_NE(std::find(loader->requests.begin(), loader->requests.end(), index), loader->requests.end());
+            ++num_ahead;
+        }
+    });
+    ASSERT_GT(num_ahead, 0);
+    loader->finish(*trimesh);
+
+    // Pages are unpinned once no AABB of interest intersects them.
+    aabboi.aabb = edyn::AABB{{6, -1, -2}, {10, 1, 2}};
+    registry.replace<edyn::linvel>(vehicle_entity, edyn::vector3_zero);
+    edyn::update_paged_meshes_of_interest(registry, *pinned, 1);
+
+    auto pagesB = std::vector<size_t>{};
+    trimesh->visit_submesh_indices(aabboi.aabb, [&](size_t index) { pagesB.push_back(index); });
+
+    for (auto index : pagesA) {
+        auto in_b = std::find(pagesB.begin(), pagesB.end(), index) != pagesB.end();
+        ASSERT_EQ(page_cache.is_pinned(trimesh.get(), index), in_b);
+    }
+
+    for (auto index : pagesB) {
+        ASSERT_TRUE(page_cache.is_pinned(trimesh.get(), index));
+    }
+
+    pinned.reset();
+
+    for (auto index : pagesB) {
+        ASSERT_FALSE(page_cache.is_pinned(trimesh.get(), index));
+    }
+
+    loader->finish(*trimesh);
+}
@@ -0,0 +1,80 @@
+#include "../common/common.hpp"
+#include "edyn/shapes/shape_asset_cache.hpp"
+#include "edyn/util/shape_util.hpp"
+
+TEST(test_shape_asset_cache, convex_meshes_are_shared) {
+    auto vertices = std::vector<edyn::vector3>{};
+    auto indices = std::vector<uint32_t>{};
+    auto faces = std::vector<uint32_t>{};
+    edyn::make_box_mesh({0.5, 0.5, 0.5}, vertices, indices, faces);
+
+    auto &cache = edyn::shape_asset_cache::global();
+    auto mesh0 = cache.get_convex_mesh(vertices, indices, faces);
+    auto mesh1 = cache.get_convex_mesh(vertices, indices, faces);
+    ASSERT_EQ(mesh0, mesh1);
+    ASSERT_EQ(mesh0->normals.size(), 6);
+
+    // A copy built separately is replaced by the cached instance.
+    auto copy = std::make_shared<edyn::convex_mesh>();
+    copy->vertices = vertices;
+    copy->indices = indices;
+    copy->faces = faces;
+    copy->initialize();
+    ASSERT_EQ(cache.share(copy), mesh0);
+
+    auto id = cache.get_id(mesh0.get());
+    ASSERT_NE(id, edyn::shape_asset_cache::invalid_id);
+    ASSERT_EQ(cache.find_convex_mesh(id), mesh0);
+
+    edyn::make_box_mesh({1, 0.5, 0.5}, vertices, indices, faces);
+    auto other = cache.get_convex_mesh(vertices, indices, faces);
+    ASSERT_NE(other, mesh0);
+    ASSERT_NE(cache.get_id(other.get()), id);
+}
+
+TEST(test_shape_asset_cache, triangle_meshes_are_shared) {
+    auto vertices = std::vector<edyn::vector3>{{0, 0, 0}, {1, 0, 0}, {1, 0, 1}, {0, 0, 1}};
+    auto indices = std::vector<uint32_t>{0, 1, 2, 0, 2, 3};
+
+    auto &cache = edyn::shape_asset_cache::global();
+    auto num_meshes = cache.num_triangle_meshes();
+    auto mesh0 = cache.get_triangle_mesh(vertices, indices);
+    auto mesh1 = cache.get_triangle_mesh(vertices, indices);
+    auto compact = cache.get_triangle_mesh(vertices, indices, edyn::triangle_mesh::tree_type::compact);
+    ASSERT_EQ(mesh0, mesh1);
+    ASSERT_NE(mesh0, compact);
+    ASSERT_EQ(mesh0->num_triangles(), 2);
+    ASSERT_EQ(cache.num_triangle_meshes(), num_meshes + 2);
+
+    mesh0.reset();
+    mesh1.reset();
+    compact.reset();
+    cache.clear_unused();
+    ASSERT_EQ(cache.num_triangle_meshes(), num_meshes);
+}
+
+TEST(test_shape_asset_cache, rigidbodies_share_meshes) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+
+    auto make_mesh = []() {
+        auto mesh = std::make_shared<edyn::convex_mesh>();
+        edyn::make_box_mesh({0.5, 0.25, 0.5}, mesh->vertices, mesh->indices, mesh->faces);
+        mesh->initialize();
+        return mesh;
+    };
+
+    auto def = edyn::rigidbody_def{};
+    def.mass = 1;
+    def.shape = edyn::polyhedron_shape{make_mesh()};
+    auto rb0 = edyn::make_rigidbody(registry, def);
+    def.shape = edyn::polyhedron_shape{make_mesh()};
+    auto rb1 = edyn::make_rigidbody(registry, def);
+
+    ASSERT_EQ(registry.get<edyn::polyhedron_shape>(rb0).mesh,
+              registry.get<edyn::polyhedron_shape>(rb1).mesh);
+
+    edyn::detach(registry);
+}
@@ -1,4 +1,7 @@
 #include "../common/common.hpp"
+#include "edyn/util/shape_util.hpp"
+#include <algorithm>
+#include <cmath>
 
 TEST(test_trimesh, voronoi_regions) {
     auto vertices = std::vector<edyn::vector3>{};
@@ -39,3 +42,120 @@ TEST(test_trimesh, voronoi_regions) {
     ASSERT_VECTOR3_EQ(trimesh.get_aabb().min, {-1, 0, -1});
     ASSERT_VECTOR3_EQ(trimesh.get_aabb().max, {2, 1, 1});
 }
+
+TEST(test_trimesh, compact_tree) {
+    auto vertices = std::vector<edyn::vector3>{};
+    auto indices = std::vector<edyn::triangle_mesh::index_type>{};
+    edyn::make_plane_mesh(20, 20, 40, 40, vertices, indices);
+
+    for (auto &v : vertices) {
+        v.y = std::sin(v.x * edyn::scalar(0.7)) * std::cos(v.z * edyn::scalar(0.4));
+    }
+
+    auto binary = edyn::triangle_mesh{};
+    binary.insert_vertices(vertices.begin(), vertices.end());
+    binary.insert_indices(indices.begin(), indices.end());
+    binary.initialize();
+
+    auto compact = edyn::triangle_mesh{};
+    compact.insert_vertices(vertices.begin(), vertices.end());
+    compact.insert_indices(indices.begin(), indices.end());
+    compact.initialize(edyn::triangle_mesh::tree_type::compact);
+    ASSERT_EQ(compact.get_tree_type(), edyn::triangle_mesh::tree_type::compact);
+
+    ASSERT_VECTOR3_EQ(binary.get_aabb().min, compact.get_aabb().min);
+    ASSERT_VECTOR3_EQ(binary.get_aabb().max, compact.get_aabb().max);
+
+    auto collect = [](const edyn::triangle_mesh &trimesh, auto &&visit) {
+        auto result = std::vector<size_t>{};
+        visit(trimesh, [&](auto tri_idx) { result.push_back(tri_idx); });
+        std::sort(result.begin(), result.end());
+        return result;
+    };
+
+    for (int i = 0; i < 40; ++i) {
+        auto center = edyn::vector3{edyn::scalar(i % 9 - 4) * 2, edyn::scalar(i % 3 - 1), edyn::scalar(i % 7 - 3) * 3};
+        auto half = edyn::vector3_one * edyn::scalar(0.1 + 0.15 * (i % 5));
+        auto aabb = edyn::AABB{center - half, center + half};
+
+        auto query = [&](const edyn::triangle_mesh &trimesh, auto &&func) {
+            trimesh.visit_triangles(aabb, func);
+        };
+        auto expected = collect(binary, query);
+        auto result = collect(compact, query);
+
+        // Queries are conservative and every triangle is reported once.
+        ASSERT_TRUE(std::includes(result.begin(), result.end(), expected.begin(), expected.end()));
+        ASSERT_TRUE(std::adjacent_find(result.begin(), result.end()) == result.end());
+
+        auto p0 = center + edyn::vector3{-3, 2, 1};
+        auto p1 = center + edyn::vector3{2, -2, -1};
+        auto raycast = [&](const edyn::triangle_mesh &trimesh, auto &&func) {
+            trimesh.raycast(p0, p1, func);
+        };
+        expected = collect(binary, raycast);
+        result = collect(compact, raycast);
+        ASSERT_TRUE(std::includes(result.begin(), result.end(), expected.begin(), expected.end()));
+    }
+
+    auto all = collect(compact, [](const edyn::triangle_mesh &trimesh, auto &&func) {
+        trimesh.visit_triangles(trimesh.get_aabb(), func);
+    });
+    ASSERT_EQ(all.size(), compact.num_triangles());
+}
+
+TEST(test_trimesh, compressed) {
+    auto vertices = std::vector<edyn::vector3>{};
+    auto indices = std::vector<edyn::triangle_mesh::index_type>{};
+    edyn::make_plane_mesh(20, 20, 40, 40, vertices, indices);
+
+    for (auto &v : vertices) {
+        v.y = std::sin(v.x * edyn::scalar(0.7)) * std::cos(v.z * edyn::scalar(0.4));
+    }
+
+    auto trimesh = edyn::triangle_mesh{};
+    trimesh.insert_vertices(vertices.begin(), vertices.end());
+    trimesh.insert_indices(indices.begin(), indices.end());
+    trimesh.initialize();
+
+    auto compressed = edyn::triangle_mesh{};
+    compressed.insert_vertices(vertices.begin(), vertices.end());
+    compressed.insert_indices(indices.begin(), indices.end());
+    compressed.initialize();
+    compressed.compress();
+
+    ASSERT_TRUE(compressed.is_compressed());
+    ASSERT_EQ(compressed.num_vertices(), trimesh.num_vertices());
+    ASSERT_EQ(compressed.num_triangles(), trimesh.num_triangles());
+    ASSERT_EQ(compressed.num_edges(), trimesh.num_edges());
+
+    // Half of the size of the mesh over 65535 on each axis.
+    auto max_error = edyn::scalar(20) / 65535;
+
+    for (size_t i = 0; i < trimesh.num_vertices(); ++i) {
+        auto error = edyn::abs(trimesh.get_vertex_position(i) - compressed.get_vertex_position(i));
+        ASSERT_LE(std::max({error.x, error.y, error.z}), max_error);
+    }
+
+    for (size_t i = 0; i < trimesh.num_triangles(); ++i) {
+        ASSERT_EQ(trimesh.get_triangle_vertex_indices(i), compressed.get_triangle_vertex_indices(i));
+        ASSERT_GT(edyn::dot(trimesh.get_triangle_normal(i), compressed.get_triangle_normal(i)), edyn::scalar(0.9999));
+
+        for (size_t j = 0; j < 3; ++j) {
+            ASSERT_GT(edyn::dot(trimesh.get_adjacent_face_normal(i, j),
+                                compressed.get_adjacent_face_normal(i, j)), edyn::scalar(0.9999));
+        }
+    }
+
+    // The tree is built from the quantized triangles, which enclose the same
+    // triangles for queries away from their boundaries.
+    auto aabb = edyn::AABB{{-3.1, -2, -2.3}, {2.7, 2, 4.3}};
+    auto expected = std::vector<size_t>{};
+    auto result = std::vector<size_t>{};
+    trimesh.visit_triangles(aabb, [&](auto tri_idx) { expected.push_back(tri_idx); });
+    compressed.visit_triangles(aabb, [&](auto tri_idx) { result.push_back(tri_idx); });
+    std::sort(expected.begin(), expected.end());
+    std::sort(result.begin(), result.end());
+    ASSERT_FALSE(expected.empty());
+    ASSERT_EQ(expected, result);
+}
@@ -0,0 +1,74 @@
+#include "../common/common.hpp"
+#include <edyn/sys/sort_storages_by_island.hpp>
+#include <array>
+
+TEST(test_sort_storages_by_island, islands_are_contiguous) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+    edyn::set_paused(registry, true);
+
+    // Two chains of bodies created in alternating order, which scatters the
+    // bodies of each island over the storages.
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::sphere_shape{0.2};
+    def.gravity = edyn::vector3_zero;
+    auto chains = std::array<std::vector<entt::entity>, 2>{};
+
+    for (int i = 0; i < 10; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            def.position = {edyn::scalar(i), edyn::scalar(j * 10), 0};
+            auto entity = edyn::make_rigidbody(registry, def);
+
+            if (!chains[j].empty()) {
+                edyn::make_constraint<edyn::distance_constraint>(registry, chains[j].back(), entity, [](auto &con) {
+                    con.distance = 1;
+                });
+            }
+
+            chains[j].push_back(entity);
+        }
+    }
+
+    edyn::update(registry);
+    edyn::sort_storages_by_island(registry);
+
+    auto island_of = [&](entt::entity entity) {
+        return registry.get<edyn::island_resident>(entity).island_entity;
+    };
+
+    ASSERT_NE(island_of(chains[0].front()), island_of(chains[1].front()));
+
+    auto count_island_changes = [&](auto &storage) {
+        auto changes = 0;
+        auto prev = entt::entity{entt::null};
+
+        for (auto entity : storage) {
+            auto curr = island_of(entity);
+
+            if (prev != entt::null && curr != prev) {
+                ++changes;
+            }
+
+            prev = curr;
+        }
+
+        return changes;
+    };
+
+    ASSERT_EQ(count_island_changes(registry.storage<edyn::position>()), 1);
+    ASSERT_EQ(count_island_changes(registry.storage<edyn::linvel>()), 1);
+    ASSERT_EQ(count_island_changes(registry.storage<edyn::distance_constraint>()), 1);
+
+    // Components still belong to their entities.
+    for (int j = 0; j < 2; ++j) {
+        for (int i = 0; i < 10; ++i) {
+            auto &pos = registry.get<edyn::position>(chains[j][i]);
+            ASSERT_SCALAR_EQ(pos.x, edyn::scalar(i));
+            ASSERT_SCALAR_EQ(pos.y, edyn::scalar(j * 10));
+        }
+    }
+
+    edyn::detach(registry);
+}
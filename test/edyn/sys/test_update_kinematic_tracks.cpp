@@ -0,0 +1,81 @@
+#include "../common/common.hpp"
+#include "edyn/comp/kinematic_track.hpp"
+#include "edyn/sys/update_kinematic_tracks.hpp"
+
+static edyn::kinematic_track make_track() {
+    auto track = edyn::kinematic_track{};
+    auto half_turn = edyn::quaternion_axis_angle({0, 1, 0}, edyn::pi);
+    track.keyframes.push_back({0, {0, 0, 0}, edyn::quaternion_identity});
+    track.keyframes.push_back({1, {2, 0, 0}, half_turn});
+    track.keyframes.push_back({2, {2, 0, 2}, half_turn});
+    return track;
+}
+
+TEST(test_update_kinematic_tracks, evaluate_linear) {
+    auto track = make_track();
+    auto pos = edyn::vector3{};
+    auto orn = edyn::quaternion{};
+
+    edyn::evaluate_kinematic_track(track, 0.5, pos, orn);
+    ASSERT_SCALAR_EQ(pos.x, 1);
+    ASSERT_SCALAR_EQ(pos.z, 0);
+    ASSERT_NEAR(edyn::quaternion_angle(orn), edyn::pi / 2, 0.001);
+
+    edyn::evaluate_kinematic_track(track, 1.5, pos, orn);
+    ASSERT_SCALAR_EQ(pos.x, 2);
+    ASSERT_SCALAR_EQ(pos.z, 1);
+
+    // Clamped past the end.
+    edyn::evaluate_kinematic_track(track, 5, pos, orn);
+    ASSERT_SCALAR_EQ(pos.z, 2);
+
+    // Wraps around when looping.
+    track.loop = true;
+    edyn::evaluate_kinematic_track(track, 2.5, pos, orn);
+    ASSERT_SCALAR_EQ(pos.x, 1);
+    ASSERT_SCALAR_EQ(pos.z, 0);
+}
+
+TEST(test_update_kinematic_tracks, evaluate_spline_passes_through_keyframes) {
+    auto track = make_track();
+    track.interpolation = edyn::kinematic_track_interpolation::spline;
+    auto pos = edyn::vector3{};
+    auto orn = edyn::quaternion{};
+
+    for (auto &kf : track.keyframes) {
+        edyn::evaluate_kinematic_track(track, kf.time, pos, orn);
+        ASSERT_NEAR(edyn::distance(pos, kf.position), 0, 0.0001);
+    }
+
+    // The spline bulges out of the corner in the middle keyframe.
+    edyn::evaluate_kinematic_track(track, 0.5, pos, orn);
+    ASSERT_LT(pos.z, 0);
+}
+
+TEST(test_update_kinematic_tracks, moves_kinematic_body) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+
+    auto def = edyn::rigidbody_def{};
+    def.kind = edyn::rigidbody_kind::rb_kinematic;
+    def.shape = edyn::box_shape{1, 0.1, 1};
+    auto platform = edyn::make_rigidbody(registry, def);
+    registry.emplace<edyn::kinematic_track>(platform, make_track());
+
+    auto dt = registry.ctx().get<edyn::settings>().fixed_dt;
+    auto num_steps = static_cast<int>(std::round(edyn::scalar(0.5) / dt));
+
+    for (int i = 0; i < num_steps; ++i) {
+        edyn::step_simulation(registry);
+    }
+
+    auto time = registry.get<edyn::kinematic_track>(platform).time;
+    ASSERT_NEAR(time, num_steps * dt, 0.0001);
+    ASSERT_NEAR(registry.get<edyn::position>(platform).x, 2 * time, 0.0001);
+    ASSERT_NEAR(registry.get<edyn::linvel>(platform).x, 2, 0.0001);
+    ASSERT_NEAR(registry.get<edyn::angvel>(platform).y, edyn::pi, 0.001);
+
+    edyn::detach(registry);
+}
@@ -0,0 +1,92 @@
+#include "../common/common.hpp"
+#include <edyn/sys/update_presentation.hpp>
+
+static std::vector<entt::entity> make_moving_bodies(entt::registry &registry, size_t count) {
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::sphere_shape{0.5};
+    def.gravity = edyn::vector3_zero;
+    auto entities = std::vector<entt::entity>{};
+
+    for (size_t i = 0; i < count; ++i) {
+        def.position = {edyn::scalar(i) * 2, 0, 0};
+        def.linvel = {1, edyn::scalar(i % 3), 0};
+        def.angvel = {0, 1, 0};
+        entities.push_back(edyn::make_rigidbody(registry, def));
+    }
+
+    return entities;
+}
+
+TEST(test_update_presentation, extrapolate) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+
+    auto entities = make_moving_bodies(registry, 4);
+    auto dt = edyn::scalar(0.01);
+    edyn::update_presentation(registry, 0, dt, dt, 0);
+
+    for (auto entity : entities) {
+        auto [pos, vel, p_pos] = registry.get<edyn::position, edyn::linvel, edyn::present_position>(entity);
+        ASSERT_VECTOR3_EQ(p_pos, pos + vel * dt);
+    }
+
+    edyn::detach(registry);
+}
+
+TEST(test_update_presentation, tagged_only) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+    edyn::set_present_tagged_only(registry, true);
+
+    auto entities = make_moving_bodies(registry, 4);
+    registry.emplace<edyn::presentation_tag>(entities[1]);
+    auto dt = edyn::scalar(0.01);
+    edyn::update_presentation(registry, 0, dt, dt, 0);
+
+    for (auto entity : entities) {
+        auto [pos, vel, p_pos] = registry.get<edyn::position, edyn::linvel, edyn::present_position>(entity);
+
+        if (entity == entities[1]) {
+            ASSERT_VECTOR3_EQ(p_pos, pos + vel * dt);
+        } else {
+            ASSERT_VECTOR3_EQ(p_pos, pos);
+        }
+    }
+
+    edyn::detach(registry);
+}
+
+TEST(test_update_presentation, parallel_same_as_sequential) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential_multithreaded;
+    edyn::attach(registry, config);
+
+    auto entities = make_moving_bodies(registry, 100);
+    auto dt = edyn::scalar(0.01);
+
+    edyn::set_min_presentation_parallel_size(registry, 0);
+    edyn::update_presentation(registry, 0, dt, dt, 0);
+
+    auto expected = std::vector<std::pair<edyn::vector3, edyn::quaternion>>{};
+
+    for (auto entity : entities) {
+        auto [p_pos, p_orn] = registry.get<edyn::present_position, edyn::present_orientation>(entity);
+        expected.emplace_back(p_pos, p_orn);
+    }
+
+    edyn::set_min_presentation_parallel_size(registry, 1);
+    edyn::update_presentation(registry, 0, dt, dt, 0);
+
+    for (size_t i = 0; i < entities.size(); ++i) {
+        auto [p_pos, p_orn] = registry.get<edyn::present_position, edyn::present_orientation>(entities[i]);
+        ASSERT_EQ(p_pos, expected[i].first);
+        ASSERT_EQ(p_orn, expected[i].second);
+    }
+
+    edyn::detach(registry);
+}
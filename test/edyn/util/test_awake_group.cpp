@@ -0,0 +1,38 @@
+#include "../common/common.hpp"
+#include "edyn/util/awake_group.hpp"
+
+TEST(test_awake_group, tracks_sleeping_and_disabled) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::sphere_shape{0.5};
+    auto entities = std::vector<entt::entity>{};
+
+    for (int i = 0; i < 4; ++i) {
+        def.position = {edyn::scalar(i * 2), 0, 0};
+        entities.push_back(edyn::make_rigidbody(registry, def));
+    }
+
+    auto group = edyn::awake_group<edyn::position, edyn::linvel, edyn::dynamic_tag>(registry);
+    ASSERT_EQ(group.size(), 4);
+
+    registry.emplace<edyn::sleeping_tag>(entities[0]);
+    registry.emplace<edyn::disabled_tag>(entities[1]);
+    ASSERT_EQ(group.size(), 2);
+    ASSERT_FALSE(group.contains(entities[0]));
+    ASSERT_FALSE(group.contains(entities[1]));
+
+    for (auto entity : group) {
+        ASSERT_TRUE(entity == entities[2] || entity == entities[3]);
+    }
+
+    // Getting the group again returns the same up to date group.
+    registry.remove<edyn::sleeping_tag>(entities[0]);
+    ASSERT_EQ((edyn::awake_group<edyn::position, edyn::linvel, edyn::dynamic_tag>(registry).size()), 3);
+    ASSERT_TRUE(group.contains(entities[0]));
+
+    edyn::detach(registry);
+}
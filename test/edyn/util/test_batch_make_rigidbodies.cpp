@@ -0,0 +1,194 @@
+#include "../common/common.hpp"
+#include "edyn/util/rigidbody.hpp"
+#include "edyn/comp/tree_resident.hpp"
+#include "edyn/comp/rotated_mesh_list.hpp"
+#include "edyn/util/shape_util.hpp"
+
+TEST(test_batch_make_rigidbodies, same_as_make_rigidbody) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+
+    auto defs = std::vector<edyn::rigidbody_def>{};
+
+    for (int i = 0; i < 30; ++i) {
+        auto &def = defs.emplace_back();
+        def.position = {edyn::scalar(i), 0, 0};
+
+        switch (i % 3) {
+        case 0:
+            def.shape = edyn::box_shape{0.5, 0.5, 0.5};
+            def.center_of_mass = edyn::vector3{0, 0.1, 0};
+            break;
+        case 1:
+            def.kind = edyn::rigidbody_kind::rb_kinematic;
+            def.shape = edyn::sphere_shape{0.5};
+            break;
+        case 2:
+            def.kind = edyn::rigidbody_kind::rb_static;
+            def.shape = edyn::box_shape{5, 0.5, 5};
+            break;
+        }
+    }
+
+    auto entities = edyn::batch_make_rigidbodies(registry, defs);
+    ASSERT_EQ(entities.size(), defs.size());
+
+    for (size_t i = 0; i < defs.size(); ++i) {
+        auto entity = entities[i];
+        auto single = edyn::make_rigidbody(registry, defs[i]);
+
+        ASSERT_TRUE(edyn::validate_rigidbody(registry, entity));
+        ASSERT_EQ(registry.get<edyn::position>(entity), registry.get<edyn::position>(single));
+        ASSERT_EQ(registry.get<edyn::linvel>(entity), registry.get<edyn::linvel>(single));
+        ASSERT_EQ(registry.get<edyn::mass>(entity).s, registry.get<edyn::mass>(single).s);
+        ASSERT_EQ(registry.get<edyn::shape_index>(entity).value, registry.get<edyn::shape_index>(single).value);
+        ASSERT_EQ(registry.all_of<edyn::dynamic_tag>(entity), registry.all_of<edyn::dynamic_tag>(single));
+        ASSERT_EQ(registry.all_of<edyn::origin>(entity), registry.all_of<edyn::origin>(single));
+        ASSERT_EQ(registry.all_of<edyn::island_resident>(entity), registry.all_of<edyn::island_resident>(single));
+    }
+
+    edyn::update(registry);
+
+    for (auto entity : entities) {
+        ASSERT_TRUE(registry.all_of<edyn::tree_resident>(entity));
+    }
+
+    edyn::detach(registry);
+}
+
+TEST(test_batch_make_rigidbodies, burst_of_polyhedrons) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential_multithreaded;
+    edyn::attach(registry, config);
+    edyn::set_paused(registry, true);
+
+    auto mesh = std::make_shared<edyn::convex_mesh>();
+    edyn::make_box_mesh({0.5, 0.25, 0.5}, mesh->vertices, mesh->indices, mesh->faces);
+    mesh->initialize();
+
+    auto compound = edyn::compound_shape{};
+    compound.add_shape(edyn::polyhedron_shape{mesh}, {0, 0, 0}, edyn::quaternion_identity);
+    compound.add_shape(edyn::box_shape{0.5, 0.5, 0.5}, {0, 1, 0}, edyn::quaternion_identity);
+    compound.add_shape(edyn::polyhedron_shape{mesh}, {0, 2, 0}, edyn::quaternion_axis_angle({0, 1, 0}, 1));
+    compound.finish();
+
+    // Enough polyhedrons to have their rotated meshes built in parallel.
+    auto defs = std::vector<edyn::rigidbody_def>{};
+
+    for (int i = 0; i < 200; ++i) {
+        auto &def = defs.emplace_back();
+        def.position = {edyn::scalar(i * 3), 0, 0};
+
+        if (i % 2 == 0) {
+            def.shape = edyn::polyhedron_shape{mesh};
+        } else {
+            def.shape = compound;
+        }
+    }
+
+    auto entities = edyn::batch_make_rigidbodies(registry, defs);
+    edyn::step_simulation(registry);
+
+    for (size_t i = 0; i < entities.size(); ++i) {
+        auto &list = registry.get<edyn::rotated_mesh_list>(entities[i]);
+        ASSERT_EQ(list.mesh, mesh);
+
+        if (i % 2 == 0) {
+            ASSERT_EQ(registry.get<edyn::polyhedron_shape>(entities[i]).rotated, list.rotated.get());
+            ASSERT_EQ(list.next, entt::null);
+        } else {
+            // One rotated mesh for each polyhedron in the compound.
+            auto &nodes = registry.get<edyn::compound_shape>(entities[i]).nodes;
+            ASSERT_EQ(std::get<edyn::polyhedron_shape>(nodes[0].shape_var).rotated, list.rotated.get());
+            ASSERT_NE(list.next, entt::null);
+
+            auto &next = registry.get<edyn::rotated_mesh_list>(list.next);
+            ASSERT_EQ(std::get<edyn::polyhedron_shape>(nodes[2].shape_var).rotated, next.rotated.get());
+            ASSERT_EQ(next.orientation, nodes[2].orientation);
+            ASSERT_EQ(next.next, entt::null);
+        }
+    }
+
+    edyn::detach(registry);
+}
+
+TEST(test_batch_make_rigidbodies, burst_merges_islands) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+    edyn::set_paused(registry, true);
+
+    auto anchor_def = edyn::rigidbody_def{};
+    anchor_def.kind = edyn::rigidbody_kind::rb_static;
+    auto anchor = edyn::make_rigidbody(registry, anchor_def);
+
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::sphere_shape{0.2};
+    def.gravity = edyn::vector3_zero;
+
+    auto connect = [&](entt::entity a, entt::entity b) {
+        edyn::make_constraint<edyn::distance_constraint>(registry, a, b, [](auto &con) {
+            con.distance = 1;
+        });
+    };
+
+    // Separate islands, each attached to the static anchor.
+    auto existing = std::vector<entt::entity>{};
+
+    for (int i = 0; i < 4; ++i) {
+        def.position = {edyn::scalar(i * 10), 0, 0};
+        existing.push_back(edyn::make_rigidbody(registry, def));
+        connect(anchor, existing.back());
+    }
+
+    edyn::step_simulation(registry);
+    ASSERT_EQ(registry.view<edyn::island>().size(), 4);
+
+    // A burst of bodies which connects the first three islands into one and
+    // creates another island of new bodies only.
+    auto defs = std::vector<edyn::rigidbody_def>(40, def);
+    auto entities = edyn::batch_make_rigidbodies(registry, defs);
+
+    for (size_t i = 0; i < 20; ++i) {
+        connect(i == 0 ? existing[0] : entities[i - 1], entities[i]);
+    }
+
+    connect(entities[9], existing[1]);
+    connect(entities[19], existing[2]);
+
+    for (size_t i = 21; i < entities.size(); ++i) {
+        connect(entities[i - 1], entities[i]);
+    }
+
+    edyn::step_simulation(registry);
+
+    auto island_of = [&](entt::entity entity) {
+        return registry.get<edyn::island_resident>(entity).island_entity;
+    };
+
+    ASSERT_EQ(registry.view<edyn::island>().size(), 3);
+    auto merged = island_of(existing[0]);
+    ASSERT_EQ(island_of(existing[1]), merged);
+    ASSERT_EQ(island_of(existing[2]), merged);
+    ASSERT_NE(island_of(existing[3]), merged);
+    ASSERT_NE(island_of(entities[20]), merged);
+
+    for (size_t i = 0; i < 20; ++i) {
+        ASSERT_EQ(island_of(entities[i]), merged);
+        ASSERT_EQ(island_of(entities[i + 20]), island_of(entities[20]));
+    }
+
+    // The static anchor is only in the islands which still exist.
+    auto &anchor_resident = registry.get<edyn::multi_island_resident>(anchor);
+    ASSERT_EQ(anchor_resident.island_entities.size(), 2);
+
+    for (auto island_entity : anchor_resident.island_entities) {
+        ASSERT_TRUE(registry.valid(island_entity));
+    }
+
+    edyn::detach(registry);
+}
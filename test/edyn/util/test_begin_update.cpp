@@ -0,0 +1,59 @@
+#include "../common/common.hpp"
+#include "edyn/simulation/stepper_sequential.hpp"
+
+static void make_pile(entt::registry &registry) {
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential_multithreaded;
+    config.deterministic = true;
+    config.timestamp = 0;
+    edyn::attach(registry, config);
+
+    auto floor_def = edyn::rigidbody_def{};
+    floor_def.kind = edyn::rigidbody_kind::rb_static;
+    floor_def.shape = edyn::plane_shape{{0, 1, 0}, 0};
+    edyn::make_rigidbody(registry, floor_def);
+
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::box_shape{0.2, 0.2, 0.2};
+
+    for (int x = 0; x < 4; ++x) {
+        for (int y = 0; y < 6; ++y) {
+            def.position = {edyn::scalar(x) * 2, edyn::scalar(0.2 + y * 0.41), 0};
+            edyn::make_rigidbody(registry, def);
+        }
+    }
+}
+
+TEST(test_begin_update, same_result_as_update) {
+    entt::registry reg0, reg1;
+    make_pile(reg0);
+    make_pile(reg1);
+
+    for (int i = 1; i <= 60; ++i) {
+        auto time = i * 0.016;
+        edyn::update(reg0, time);
+        edyn::begin_update(reg1, time);
+        edyn::end_update(reg1);
+    }
+
+    auto view0 = reg0.view<edyn::position, edyn::dynamic_tag>();
+    auto view1 = reg1.view<edyn::position, edyn::dynamic_tag>();
+    ASSERT_EQ(view0.size_hint(), view1.size_hint());
+
+    for (auto [entity, pos] : view0.each()) {
+        // Both registries create entities in the same order.
+        auto &other_pos = view1.get<edyn::position>(entity);
+        ASSERT_EQ(pos, other_pos);
+    }
+
+    edyn::detach(reg0);
+    edyn::detach(reg1);
+}
+
+TEST(test_begin_update, detach_ends_update) {
+    entt::registry registry;
+    make_pile(registry);
+    edyn::begin_update(registry, 0.1);
+    edyn::detach(registry);
+    ASSERT_FALSE(registry.ctx().contains<edyn::stepper_sequential>());
+}
@@ -1,4 +1,5 @@
 #include "../common/common.hpp"
+#include "edyn/comp/island.hpp"
 #include "edyn/comp/tag.hpp"
 #include "edyn/math/matrix3x3.hpp"
 #include "edyn/util/rigidbody.hpp"
@@ -90,3 +91,64 @@ TEST(test_change_rigidbody_kind, change_kind_dynamic_kinematic_amorphous) {
 
     edyn::detach(registry);
 }
+
+TEST(test_change_rigidbody_kind, change_kind_kinematic_dynamic_batch) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+    edyn::set_paused(registry, true);
+
+    auto floor_def = edyn::rigidbody_def{};
+    floor_def.kind = edyn::rigidbody_kind::rb_static;
+    floor_def.shape = edyn::plane_shape{{0, 1, 0}, 0};
+    edyn::make_rigidbody(registry, floor_def);
+
+    // A column of kinematic boxes, enough to build the tree leaves in bulk,
+    // with a dynamic box resting on top.
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::box_shape{0.5, 0.5, 0.5};
+    def.kind = edyn::rigidbody_kind::rb_kinematic;
+    auto column = std::vector<entt::entity>{};
+
+    for (int i = 0; i < 80; ++i) {
+        def.position = {0, edyn::scalar(0.5 + i), 0};
+        column.push_back(edyn::make_rigidbody(registry, def));
+    }
+
+    def.kind = edyn::rigidbody_kind::rb_dynamic;
+    def.position = {0, 80.5, 0};
+    auto top = edyn::make_rigidbody(registry, def);
+    edyn::step_simulation(registry);
+    edyn::step_simulation(registry);
+
+    for (auto entity : column) {
+        edyn::set_rigidbody_mass(registry, entity, 1);
+        edyn::set_rigidbody_inertia(registry, entity, edyn::matrix3x3_identity);
+    }
+
+    edyn::rigidbody_set_kind(registry, column, edyn::rigidbody_kind::rb_dynamic);
+    edyn::wake_up_entities(registry, column);
+
+    for (auto entity : column) {
+        ASSERT_TRUE((registry.all_of<edyn::dynamic_tag, edyn::procedural_tag, edyn::island_resident>(entity)));
+        ASSERT_FALSE(registry.any_of<edyn::multi_island_resident>(entity));
+    }
+
+    // The top box of the column was in the same island as the dynamic box.
+    ASSERT_EQ(registry.get<edyn::island_resident>(column.back()).island_entity,
+              registry.get<edyn::island_resident>(top).island_entity);
+
+    // Contacts between the boxes join all of them in a single island.
+    for (int i = 0; i < 3; ++i) {
+        edyn::step_simulation(registry);
+    }
+
+    auto island_entity = registry.get<edyn::island_resident>(top).island_entity;
+
+    for (auto entity : column) {
+        ASSERT_EQ(registry.get<edyn::island_resident>(entity).island_entity, island_entity);
+    }
+
+    edyn::detach(registry);
+}
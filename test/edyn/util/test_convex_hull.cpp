@@ -0,0 +1,126 @@
+#include "../common/common.hpp"
+#include "edyn/util/convex_hull.hpp"
+#include <cmath>
+#include <random>
+
+static void check_hull(const edyn::convex_mesh &mesh, const std::vector<edyn::vector3> &points,
+                       const edyn::vector3 &offset = edyn::vector3_zero) {
+    ASSERT_TRUE(mesh.validate());
+
+    // Euler characteristic of a convex polyhedron.
+    ASSERT_EQ(mesh.vertices.size() + mesh.num_faces(), mesh.num_edges() + 2);
+
+    // All points are inside.
+    for (size_t i = 0; i < mesh.num_faces(); ++i) {
+        auto &v0 = mesh.vertices[mesh.first_vertex_index(i)];
+
+        for (auto &p : points) {
+            ASSERT_LT(edyn::dot(p - offset - v0, mesh.normals[i]), 0.001);
+        }
+    }
+
+    // The calculated properties match the ones calculated from scratch.
+    auto reference = edyn::convex_mesh{};
+    reference.vertices = mesh.vertices;
+    reference.indices = mesh.indices;
+    reference.faces = mesh.faces;
+    reference.update_calculated_properties();
+
+    ASSERT_EQ(mesh.edges, reference.edges);
+    ASSERT_EQ(mesh.edge_faces, reference.edge_faces);
+    ASSERT_EQ(mesh.neighbors_start, reference.neighbors_start);
+    ASSERT_EQ(mesh.neighbor_indices, reference.neighbor_indices);
+    ASSERT_EQ(mesh.relevant_faces, reference.relevant_faces);
+    ASSERT_EQ(mesh.relevant_edges, reference.relevant_edges);
+    ASSERT_SCALAR_EQ(mesh.bounding_radius, reference.bounding_radius);
+
+    for (size_t i = 0; i < mesh.num_faces(); ++i) {
+        ASSERT_GT(edyn::dot(mesh.normals[i], reference.normals[i]), edyn::scalar(0.9999));
+    }
+}
+
+TEST(test_convex_hull, box_with_inner_points) {
+    auto points = std::vector<edyn::vector3>{};
+
+    for (int i = 0; i < 8; ++i) {
+        points.push_back({edyn::scalar(i & 1 ? 1 : -1), edyn::scalar(i & 2 ? 2 : -2), edyn::scalar(i & 4 ? 3 : -3)});
+    }
+
+    // Points inside, in the middle of faces and in the middle of edges.
+    points.push_back({0.2, -0.5, 1});
+    points.push_back({0, 0, 3});
+    points.push_back({1, 0.3, -1});
+    points.push_back({1, 2, 0});
+    points.push_back({0, -2, -3});
+
+    auto mesh = edyn::convex_mesh{};
+    ASSERT_TRUE(edyn::make_convex_hull(points, mesh));
+    ASSERT_EQ(mesh.vertices.size(), 8);
+    ASSERT_EQ(mesh.num_faces(), 6);
+    ASSERT_EQ(mesh.num_edges(), 12);
+    ASSERT_EQ(mesh.relevant_faces.size(), 6);
+    ASSERT_EQ(mesh.relevant_edges.size(), 3);
+    check_hull(mesh, points);
+}
+
+TEST(test_convex_hull, cylinder_caps_are_polygons) {
+    auto points = std::vector<edyn::vector3>{};
+    auto num_sides = 16;
+
+    for (int i = 0; i < num_sides; ++i) {
+        auto angle = edyn::scalar(i) / num_sides * edyn::pi2;
+        auto x = std::cos(angle);
+        auto z = std::sin(angle);
+        points.push_back({x, 1, z});
+        points.push_back({x, -1, z});
+    }
+
+    auto mesh = edyn::convex_mesh{};
+    ASSERT_TRUE(edyn::make_convex_hull(points, mesh));
+    ASSERT_EQ(mesh.vertices.size(), num_sides * 2);
+    ASSERT_EQ(mesh.num_faces(), num_sides + 2);
+    check_hull(mesh, points);
+}
+
+TEST(test_convex_hull, random_point_clouds) {
+    auto rng = std::mt19937(7);
+    auto dist = std::uniform_real_distribution<edyn::scalar>(-1, 1);
+    auto point_clouds = std::vector<std::vector<edyn::vector3>>(20);
+    auto offset = edyn::vector3{10, -3, 4};
+
+    for (auto &points : point_clouds) {
+        for (int i = 0; i < 300; ++i) {
+            auto p = edyn::vector3{dist(rng), dist(rng), dist(rng)};
+
+            // Mix points on a sphere and inside of it.
+            if (i % 2 == 0) {
+                p = edyn::normalize(p);
+            }
+
+            points.push_back(p + offset);
+        }
+    }
+
+    auto meshes = std::vector<edyn::convex_mesh>{};
+    auto centroids = std::vector<edyn::vector3>{};
+    edyn::make_convex_hulls(point_clouds, meshes, &centroids);
+    ASSERT_EQ(meshes.size(), point_clouds.size());
+
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        ASSERT_NEAR(edyn::length(centroids[i] - offset), 0, 0.1);
+        check_hull(meshes[i], point_clouds[i], centroids[i]);
+    }
+}
+
+TEST(test_convex_hull, degenerate_point_clouds) {
+    auto mesh = edyn::convex_mesh{};
+    auto coplanar = std::vector<edyn::vector3>{{0, 0, 0}, {1, 0, 0}, {0, 0, 1}, {1, 0, 1}, {0.5, 0, 0.2}};
+    ASSERT_FALSE(edyn::make_convex_hull(coplanar, mesh));
+    ASSERT_TRUE(mesh.vertices.empty());
+
+    auto too_few = std::vector<edyn::vector3>{{0, 0, 0}, {1, 0, 0}, {0, 1, 1}};
+    ASSERT_FALSE(edyn::make_convex_hull(too_few, mesh));
+
+    auto same = std::vector<edyn::vector3>(10, edyn::vector3_one);
+    ASSERT_FALSE(edyn::make_convex_hull(same, mesh));
+}
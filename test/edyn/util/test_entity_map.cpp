@@ -0,0 +1,84 @@
+#include "../common/common.hpp"
+#include "edyn/replication/entity_map.hpp"
+
+TEST(test_entity_map, insert_and_map_both_ways) {
+    entt::registry remote_registry, local_registry;
+    auto map = edyn::entity_map{};
+    auto remote = std::vector<entt::entity>{};
+    auto local = std::vector<entt::entity>{};
+
+    for (int i = 0; i < 16; ++i) {
+        remote.push_back(remote_registry.create());
+        local.push_back(local_registry.create());
+        map.insert(remote.back(), local.back());
+    }
+
+    ASSERT_EQ(map.size(), 16);
+
+    for (size_t i = 0; i < remote.size(); ++i) {
+        ASSERT_TRUE(map.contains(remote[i]));
+        ASSERT_TRUE(map.contains_local(local[i]));
+        ASSERT_EQ(map.at(remote[i]), local[i]);
+        ASSERT_EQ(map.at_local(local[i]), remote[i]);
+    }
+
+    map.swap();
+
+    for (size_t i = 0; i < remote.size(); ++i) {
+        ASSERT_EQ(map.at(local[i]), remote[i]);
+        ASSERT_EQ(map.at_local(remote[i]), local[i]);
+    }
+
+    map.clear();
+    ASSERT_TRUE(map.empty());
+    ASSERT_FALSE(map.contains(remote[0]));
+}
+
+TEST(test_entity_map, erase_keeps_other_pairs) {
+    entt::registry registry;
+    auto map = edyn::entity_map{};
+    auto entities = std::vector<entt::entity>{};
+
+    for (int i = 0; i < 10; ++i) {
+        auto entity = registry.create();
+        entities.push_back(entity);
+        // Map onto itself for simplicity.
+        map.insert(entity, entity);
+    }
+
+    map.erase(entities[0]);
+    map.erase_local(entities[5]);
+    map.erase_if([&](entt::entity remote, entt::entity) {
+        return remote == entities[9] || remote == entities[3];
+    });
+
+    ASSERT_EQ(map.size(), 6);
+    size_t count = 0;
+    map.each([&](entt::entity remote, entt::entity local) {
+        ASSERT_EQ(remote, local);
+        ++count;
+    });
+    ASSERT_EQ(count, 6);
+
+    for (size_t i = 0; i < entities.size(); ++i) {
+        auto erased = i == 0 || i == 3 || i == 5 || i == 9;
+        ASSERT_EQ(map.contains(entities[i]), !erased);
+    }
+}
+
+TEST(test_entity_map, version_mismatch_is_not_found) {
+    entt::registry registry;
+    auto map = edyn::entity_map{};
+
+    auto entity = registry.create();
+    map.insert(entity, entity);
+    registry.destroy(entity);
+
+    // Recycled identifier with a newer version.
+    auto recycled = registry.create();
+    ASSERT_EQ(entt::to_entity(recycled), entt::to_entity(entity));
+    ASSERT_NE(recycled, entity);
+    ASSERT_FALSE(map.contains(recycled));
+    ASSERT_FALSE(map.contains_local(recycled));
+    ASSERT_TRUE(map.contains(entity));
+}
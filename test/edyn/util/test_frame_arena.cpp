@@ -0,0 +1,63 @@
+#include "../common/common.hpp"
+#include "edyn/util/frame_arena.hpp"
+#include <cstdint>
+
+TEST(test_frame_arena, alignment) {
+    auto &arena = edyn::frame_arena::local();
+    auto marker = arena.mark();
+
+    arena.allocate(3, 1);
+    auto *ptr = arena.allocate(16, 64);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr) % 64, 0);
+
+    arena.rewind(marker);
+}
+
+TEST(test_frame_arena, scope_reuses_memory) {
+    auto &arena = edyn::frame_arena::local();
+    void *first_data = nullptr;
+
+    {
+        auto scope = edyn::frame_scope{};
+        auto vec = edyn::resource_vector<int>(scope.get_allocator<int>());
+        vec.resize(100);
+        first_data = vec.data();
+    }
+
+    auto capacity = arena.capacity();
+
+    {
+        auto scope = edyn::frame_scope{};
+        auto vec = edyn::resource_vector<int>(scope.get_allocator<int>());
+        vec.resize(100);
+        ASSERT_EQ(vec.data(), first_data);
+    }
+
+    // No chunks were added after the first scope.
+    ASSERT_EQ(arena.capacity(), capacity);
+}
+
+TEST(test_frame_arena, nested_scopes) {
+    auto &arena = edyn::frame_arena::local();
+    auto outer = edyn::frame_scope{};
+    auto *a = arena.allocate(64, 8);
+
+    {
+        auto inner = edyn::frame_scope{};
+        arena.allocate(64, 8);
+    }
+
+    // Memory allocated inside the inner scope is available again, while the
+    // allocation of the outer scope is still valid.
+    auto *b = arena.allocate(64, 8);
+    ASSERT_EQ(static_cast<uint8_t *>(b), static_cast<uint8_t *>(a) + 64);
+}
+
+TEST(test_frame_arena, grows) {
+    auto &arena = edyn::frame_arena::local();
+    auto scope = edyn::frame_scope{};
+    auto capacity = arena.capacity();
+    auto *ptr = static_cast<uint8_t *>(arena.allocate(capacity + 1024, 16));
+    ptr[capacity + 1023] = 1;
+    ASSERT_GT(arena.capacity(), capacity);
+}
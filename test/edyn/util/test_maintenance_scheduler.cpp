@@ -0,0 +1,100 @@
+#include "../common/common.hpp"
+#include "edyn/simulation/maintenance_scheduler.hpp"
+
+namespace {
+
+struct counting_job {
+    std::vector<int> *log;
+    int id;
+    int slices_left;
+
+    bool run() {
+        log->push_back(id);
+        return --slices_left <= 0;
+    }
+
+    auto delegate() {
+        return edyn::maintenance_scheduler::job_delegate_t{entt::connect_arg<&counting_job::run>, *this};
+    }
+};
+
+}
+
+TEST(test_maintenance_scheduler, priority_and_slices) {
+    auto scheduler = edyn::maintenance_scheduler{};
+    auto log = std::vector<int>{};
+    auto low = counting_job{&log, 0, 1};
+    auto normal0 = counting_job{&log, 1, 2};
+    auto normal1 = counting_job{&log, 2, 1};
+    auto high = counting_job{&log, 3, 1};
+
+    scheduler.schedule(low.delegate(), edyn::maintenance_priority::low);
+    scheduler.schedule(normal0.delegate());
+    scheduler.schedule(normal1.delegate());
+    scheduler.schedule(high.delegate(), edyn::maintenance_priority::high);
+    ASSERT_TRUE(scheduler.contains(low.delegate()));
+
+    // Without budget a single slice runs.
+    ASSERT_EQ(scheduler.run(0), 1);
+    ASSERT_EQ(log, (std::vector<int>{3}));
+
+    // Unfinished jobs keep their place among jobs of the same priority.
+    ASSERT_EQ(scheduler.run(0), 1);
+    ASSERT_EQ(scheduler.run(0), 1);
+    ASSERT_EQ(log, (std::vector<int>{3, 1, 1}));
+
+    scheduler.cancel(low.delegate());
+    ASSERT_FALSE(scheduler.contains(low.delegate()));
+    ASSERT_EQ(scheduler.finish(), 1);
+    ASSERT_EQ(log, (std::vector<int>{3, 1, 1, 2}));
+    ASSERT_TRUE(scheduler.empty());
+}
+
+TEST(test_maintenance_scheduler, island_splits_are_spread_over_steps) {
+    auto registry = entt::registry{};
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+    edyn::set_paused(registry, true);
+    edyn::set_island_split_delay(registry, 0);
+
+    // A tiny budget lets one slice run per step, which splits one island.
+    edyn::set_maintenance_budget(registry, 1e-9);
+
+    // Pairs of moving bodies held together by a joint, thus they can't go to
+    // sleep and be split right away when the joint is gone.
+    constexpr int num_pairs = 4;
+    auto constraints = std::vector<entt::entity>{};
+
+    for (int i = 0; i < num_pairs; ++i) {
+        auto def = edyn::rigidbody_def{};
+        def.shape = edyn::sphere_shape{0.2};
+        def.gravity = edyn::vector3_zero;
+        def.linvel = {1, 0, 0};
+        def.position = {0, 0, edyn::scalar(i * 10)};
+        auto body0 = edyn::make_rigidbody(registry, def);
+        def.position = {0, 2, edyn::scalar(i * 10)};
+        auto body1 = edyn::make_rigidbody(registry, def);
+        constraints.push_back(edyn::make_constraint<edyn::distance_constraint>(registry, body0, body1, [](auto &con) {
+            con.pivot = {edyn::vector3_zero, edyn::vector3_zero};
+            con.distance = 2;
+        }));
+    }
+
+    edyn::step_simulation(registry);
+    ASSERT_EQ(registry.view<edyn::island>().size(), num_pairs);
+
+    for (auto entity : constraints) {
+        registry.destroy(entity);
+    }
+
+    for (int i = 1; i <= 2; ++i) {
+        edyn::step_simulation(registry);
+        ASSERT_EQ(registry.view<edyn::island>().size(), num_pairs + i);
+    }
+
+    edyn::finish_maintenance(registry);
+    ASSERT_EQ(registry.view<edyn::island>().size(), 2 * num_pairs);
+
+    edyn::detach(registry);
+}
@@ -0,0 +1,88 @@
+#include "../common/common.hpp"
+#include "edyn/config/memory_resource.hpp"
+#include "edyn/core/entity_graph.hpp"
+#include "edyn/replication/registry_operation_pool.hpp"
+#include <atomic>
+
+namespace {
+
+class counting_memory_resource final : public edyn::memory_resource {
+public:
+    void * allocate(size_t size, size_t alignment) override {
+        ++num_allocations;
+        num_bytes += size;
+        return edyn::memory_resource::new_delete()->allocate(size, alignment);
+    }
+
+    void deallocate(void *ptr, size_t size, size_t alignment) override {
+        num_bytes -= size;
+        edyn::memory_resource::new_delete()->deallocate(ptr, size, alignment);
+    }
+
+    std::atomic<size_t> num_allocations {0};
+    std::atomic<size_t> num_bytes {0};
+};
+
+}
+
+TEST(test_memory_resource, scoped_binding) {
+    auto resource = counting_memory_resource{};
+    ASSERT_EQ(edyn::memory_resource::current(), edyn::memory_resource::new_delete());
+
+    {
+        auto binding = edyn::scoped_memory_resource(&resource);
+        ASSERT_EQ(edyn::memory_resource::current(), &resource);
+
+        {
+            auto inner = edyn::scoped_memory_resource(nullptr);
+            ASSERT_EQ(edyn::memory_resource::current(), edyn::memory_resource::new_delete());
+        }
+
+        ASSERT_EQ(edyn::memory_resource::current(), &resource);
+    }
+
+    ASSERT_EQ(edyn::memory_resource::current(), edyn::memory_resource::new_delete());
+}
+
+TEST(test_memory_resource, container_keeps_resource) {
+    auto resource = counting_memory_resource{};
+
+    {
+        auto graph = [&] {
+            auto binding = edyn::scoped_memory_resource(&resource);
+            return edyn::entity_graph{};
+        }();
+
+        // Allocated from the resource of the graph after the binding ended.
+        auto node0 = graph.insert_node(entt::entity{0});
+        auto node1 = graph.insert_node(entt::entity{1});
+        graph.insert_edge(entt::entity{2}, node0, node1);
+
+        ASSERT_GT(resource.num_allocations, 0);
+        ASSERT_GT(resource.num_bytes, 0);
+
+        auto vec = edyn::resource_vector<double>{};
+        vec.push_back(1);
+        ASSERT_EQ(vec.get_allocator().resource(), edyn::memory_resource::new_delete());
+    }
+
+    ASSERT_EQ(resource.num_bytes, 0);
+}
+
+TEST(test_memory_resource, operations_not_pooled) {
+    auto resource = counting_memory_resource{};
+    auto &pool = edyn::registry_operation_pool::global();
+
+    {
+        auto binding = edyn::scoped_memory_resource(&resource);
+        auto ops = pool.acquire();
+        ASSERT_EQ(ops.data_blocks.get_allocator().resource(), &resource);
+        ASSERT_GT(resource.num_bytes, 0);
+
+        auto pooled_bytes = pool.pooled_bytes();
+        pool.release(std::move(ops));
+        ASSERT_EQ(pool.pooled_bytes(), pooled_bytes);
+    }
+
+    ASSERT_EQ(resource.num_bytes, 0);
+}
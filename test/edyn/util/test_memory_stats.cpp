@@ -0,0 +1,53 @@
+#include "../common/common.hpp"
+#include "edyn/util/memory_stats.hpp"
+#include "edyn/replication/registry_operation.hpp"
+
+TEST(test_memory_stats, sequential) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::box_shape{0.5, 0.5, 0.5};
+    def.gravity = edyn::vector3_zero;
+
+    for (int i = 0; i < 2; ++i) {
+        def.position = {0, edyn::scalar(i * 0.9), 0};
+        edyn::make_rigidbody(registry, def);
+    }
+
+    edyn::set_paused(registry, true);
+
+    for (int i = 0; i < 3; ++i) {
+        edyn::step_simulation(registry);
+    }
+
+    auto future = edyn::query_memory_stats(registry);
+    ASSERT_TRUE(future.is_ready());
+
+    auto &stats = future.get();
+    ASSERT_GT(stats.broadphase, 0);
+    ASSERT_GT(stats.entity_graph, 0);
+    ASSERT_GT(stats.contact_manifolds, 0);
+    ASSERT_GT(stats.row_caches, 0);
+    ASSERT_GT(stats.prep_caches, 0);
+    ASSERT_EQ(stats.network_histories, 0);
+    ASSERT_GE(stats.world_total(), stats.broadphase + stats.row_caches);
+
+    edyn::detach(registry);
+}
+
+TEST(test_memory_stats, registry_operation_bytes) {
+    auto before = edyn::registry_operation::allocated_bytes();
+
+    {
+        auto ops = edyn::registry_operation{};
+        ASSERT_EQ(edyn::registry_operation::allocated_bytes(), before + ops.block_bytes());
+
+        auto moved = std::move(ops);
+        ASSERT_EQ(edyn::registry_operation::allocated_bytes(), before + moved.block_bytes());
+    }
+
+    ASSERT_EQ(edyn::registry_operation::allocated_bytes(), before);
+}
@@ -0,0 +1,62 @@
+#include "../common/common.hpp"
+#include "edyn/util/physics_snapshot.hpp"
+#include "edyn/collision/contact_manifold.hpp"
+
+class test_physics_snapshot : public ::testing::Test {
+protected:
+    void SetUp() override {
+        auto config = edyn::init_config{};
+        config.execution_mode = edyn::execution_mode::sequential;
+        edyn::attach(registry, config);
+        edyn::set_paused(registry, true);
+
+        auto floor_def = edyn::rigidbody_def{};
+        floor_def.kind = edyn::rigidbody_kind::rb_static;
+        floor_def.shape = edyn::plane_shape{{0, 1, 0}, 0};
+        edyn::make_rigidbody(registry, floor_def);
+
+        auto def = edyn::rigidbody_def{};
+        def.position = {0, 0.6, 0};
+        def.shape = edyn::box_shape{0.5, 0.5, 0.5};
+        box = edyn::make_rigidbody(registry, def);
+    }
+
+    void TearDown() override {
+        edyn::detach(registry);
+    }
+
+    entt::registry registry;
+    entt::entity box;
+};
+
+TEST_F(test_physics_snapshot, restore_transforms) {
+    auto snapshot = edyn::physics_snapshot{};
+    snapshot.capture(registry);
+    auto pos = registry.get<edyn::position>(box);
+    auto orn = registry.get<edyn::orientation>(box);
+
+    edyn::batch_step_simulation(registry, 30);
+    ASSERT_NE(registry.get<edyn::position>(box), pos);
+
+    snapshot.restore(registry);
+    ASSERT_EQ(registry.get<edyn::position>(box), pos);
+    ASSERT_EQ(registry.get<edyn::orientation>(box), orn);
+    ASSERT_EQ(registry.get<edyn::linvel>(box), edyn::vector3_zero);
+}
+
+TEST_F(test_physics_snapshot, clear_new_manifolds) {
+    auto snapshot = edyn::physics_snapshot{};
+    snapshot.capture(registry);
+    ASSERT_TRUE(registry.view<edyn::contact_manifold>().empty());
+
+    edyn::batch_step_simulation(registry, 30);
+
+    auto manifold_view = registry.view<edyn::contact_manifold>();
+    ASSERT_FALSE(manifold_view.empty());
+
+    snapshot.restore(registry);
+
+    for (auto [entity, manifold] : manifold_view.each()) {
+        ASSERT_EQ(manifold.num_points, 0);
+    }
+}
@@ -0,0 +1,53 @@
+#include "../common/common.hpp"
+#include "edyn/util/prefab.hpp"
+#include "edyn/util/ragdoll.hpp"
+
+TEST(test_prefab, ragdoll_instances_match_ragdoll) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+
+    auto def = edyn::ragdoll_simple_def{};
+    def.articulated = true;
+    auto ragdoll = edyn::make_ragdoll(registry, def);
+    auto prefab = edyn::make_ragdoll_prefab(registry, ragdoll);
+
+    ASSERT_EQ(prefab.bodies.size(), 22);
+    ASSERT_EQ(prefab.num_constraint_entities, 21);
+    ASSERT_EQ(prefab.articulated.size(), 21);
+
+    auto offset = edyn::vector3{3, 0, 0};
+    auto positions = std::vector<edyn::vector3>{offset, offset * 2};
+    auto orientations = std::vector<edyn::quaternion>(positions.size(), edyn::quaternion_identity);
+    auto instances = edyn::instantiate_prefab(registry, prefab, positions, orientations);
+
+    ASSERT_EQ(instances.bodies.size(), prefab.bodies.size() * positions.size());
+    ASSERT_EQ(instances.constraints.size(), prefab.num_constraint_entities * positions.size());
+
+    for (size_t i = 0; i < positions.size(); ++i) {
+        auto instance = edyn::get_ragdoll_instance(instances, i);
+        ASSERT_TRUE(edyn::validate_rigidbody(registry, instance.head));
+
+        auto head_pos = registry.get<edyn::position>(instance.head);
+        auto expected_pos = registry.get<edyn::position>(ragdoll.head) + positions[i];
+        ASSERT_NEAR(head_pos.x, expected_pos.x, 0.0001);
+        ASSERT_NEAR(head_pos.y, expected_pos.y, 0.0001);
+        ASSERT_NEAR(head_pos.z, expected_pos.z, 0.0001);
+
+        auto &hinge = registry.get<edyn::hinge_constraint>(instance.knee_left_hinge);
+        ASSERT_EQ(hinge.body[0], instance.leg_upper_left);
+        ASSERT_EQ(hinge.body[1], instance.leg_lower_left);
+        ASSERT_EQ(hinge.pivot, registry.get<edyn::hinge_constraint>(ragdoll.knee_left_hinge).pivot);
+
+        ASSERT_TRUE((registry.all_of<edyn::cone_constraint, edyn::cvjoint_constraint>(instance.wrist_left_constraint)));
+        ASSERT_TRUE(registry.all_of<edyn::articulation_tag>(instance.wrist_left_constraint));
+
+        auto &exclusion = registry.get<edyn::collision_exclusion>(instance.hip);
+        ASSERT_EQ(exclusion.num_entities(), registry.get<edyn::collision_exclusion>(ragdoll.hip).num_entities());
+        ASSERT_EQ(exclusion.entity[0], instance.torso_lower);
+    }
+
+    edyn::update(registry);
+    edyn::detach(registry);
+}
@@ -1,9 +1,12 @@
 #include "../common/common.hpp"
 #include "edyn/replication/registry_operation.hpp"
 #include "edyn/replication/registry_operation_builder.hpp"
+#include "edyn/replication/registry_operation_observer.hpp"
+#include "edyn/replication/registry_operation_pool.hpp"
 #include <entt/core/type_info.hpp>
 #include <entt/meta/factory.hpp>
 #include <entt/core/hashed_string.hpp>
+#include <thread>
 
 TEST(test_registry_operation, test_create_destroy) {
     auto reg0 = entt::registry{};
@@ -164,3 +167,180 @@ TEST(test_registry_operation, test_impl) {
 
     ASSERT_FALSE(reg1.all_of<another_comp>(ent11));
 }
+
+TEST(test_registry_operation, test_recycled_memory) {
+    auto reg0 = entt::registry{};
+    auto reg1 = entt::registry{};
+    auto emap = edyn::entity_map{};
+    auto &pool = edyn::registry_operation_pool::global();
+
+    auto entities = std::vector<entt::entity>(100);
+    reg0.create(entities.begin(), entities.end());
+
+    auto builder = edyn::registry_operation_builder_impl(reg0);
+    builder.create(entities.begin(), entities.end());
+    auto op0 = builder.finish();
+    auto *memory = op0.data_blocks.front().data();
+    auto num_blocks = op0.data_blocks.size();
+    op0.execute(reg1, emap);
+    pool.release(std::move(op0));
+
+    // The builder took an operation from the pool when finishing, thus it's
+    // only in the following one that the memory of `op0` is reused.
+    builder.destroy(entities.begin(), entities.end());
+    auto op1 = builder.finish();
+    builder.destroy(entities.begin(), entities.end());
+    auto op2 = builder.finish();
+
+    ASSERT_EQ(op2.data_blocks.front().data(), memory);
+    ASSERT_EQ(op2.data_blocks.size(), num_blocks);
+    ASSERT_EQ(op2.operations.size(), entities.size());
+
+    op2.execute(reg1, emap);
+
+    for (auto entity : entities) {
+        ASSERT_FALSE(emap.contains(entity));
+    }
+}
+
+TEST(test_registry_operation, test_replace_groups) {
+    auto reg0 = entt::registry{};
+    auto reg1 = entt::registry{};
+    auto emap = edyn::entity_map{};
+
+    auto entities = std::vector<entt::entity>(10);
+    reg0.create(entities.begin(), entities.end());
+
+    for (auto entity : entities) {
+        reg0.emplace<another_comp>(entity, 1.0);
+        reg0.emplace<edyn::position>(entity, edyn::vector3_x);
+    }
+
+    auto builder = edyn::registry_operation_builder_impl<another_comp, edyn::position>(reg0);
+    builder.create(entities.begin(), entities.end());
+    builder.emplace_all(entities);
+    auto ops = builder.finish();
+    ops.execute(reg1, emap);
+
+    for (auto entity : entities) {
+        reg0.get<another_comp>(entity).d = 2.0;
+        reg0.get<edyn::position>(entity) = edyn::vector3_y;
+    }
+
+    // Replacements interleaved with other operations.
+    auto new_entity = reg0.create();
+    reg0.emplace<another_comp>(new_entity, 3.0);
+    builder.replace<another_comp>(entities.begin(), entities.end());
+    builder.create(new_entity);
+    builder.emplace<another_comp>(new_entity);
+    builder.replace<edyn::position>(entities.begin(), entities.end());
+    builder.destroy(entities.front());
+    ops = builder.finish();
+
+    auto groups = std::vector<std::vector<edyn::operation_base *>>{};
+    auto num_ordered = size_t{0};
+    auto num_groups = ops.execute_except_replace(reg1, emap, groups, [&](edyn::operation_base *op) {
+        ASSERT_NE(op->operation_type(), edyn::registry_operation_type::replace);
+        ++num_ordered;
+    });
+
+    ASSERT_EQ(num_ordered, 3);
+    ASSERT_EQ(num_groups, 2);
+    ASSERT_TRUE(emap.contains(new_entity));
+    ASSERT_FALSE(emap.contains(entities.front()));
+    ASSERT_EQ(reg1.get<another_comp>(emap.at(new_entity)).d, 3.0);
+
+    for (size_t i = 0; i < num_groups; ++i) {
+        ASSERT_EQ(groups[i].size(), entities.size());
+        auto type_id = groups[i].front()->payload_type_id();
+
+        for (auto *op : groups[i]) {
+            ASSERT_EQ(op->operation_type(), edyn::registry_operation_type::replace);
+            ASSERT_EQ(op->payload_type_id(), type_id);
+        }
+    }
+
+    // Groups are executed in parallel in the main thread in asynchronous mode.
+    auto threads = std::vector<std::thread>{};
+
+    for (size_t i = 0; i < num_groups; ++i) {
+        threads.emplace_back([&, i] {
+            edyn::registry_operation::execute_replace_group(reg1, emap, groups[i]);
+        });
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    for (auto it = std::next(entities.begin()); it != entities.end(); ++it) {
+        auto local_entity = emap.at(*it);
+        ASSERT_EQ(reg1.get<another_comp>(local_entity).d, 2.0);
+        ASSERT_EQ(reg1.get<edyn::position>(local_entity), edyn::vector3_y);
+    }
+
+    // The arrays are reused.
+    builder.replace<edyn::position>(entities.back());
+    ops = builder.finish();
+    num_groups = ops.execute_except_replace(reg1, emap, groups);
+    ASSERT_EQ(num_groups, 1);
+    ASSERT_EQ(groups[0].size(), 1);
+    ASSERT_TRUE(groups[1].empty());
+}
+
+TEST(test_registry_operation, test_observer_gathers_updates) {
+    auto reg0 = entt::registry{};
+    auto builder = edyn::registry_operation_builder_impl<another_comp, edyn::position>(reg0);
+    auto observer = edyn::registry_operation_observer_impl(builder, std::tuple<another_comp, edyn::position>{});
+
+    auto ent0 = reg0.create();
+    auto ent1 = reg0.create();
+    auto unobserved = reg0.create();
+
+    for (auto entity : {ent0, ent1, unobserved}) {
+        reg0.emplace<another_comp>(entity, 1.0);
+        reg0.emplace<edyn::position>(entity, edyn::vector3_zero);
+    }
+
+    observer.observe(ent0);
+    observer.observe(ent1);
+    builder.finish();
+
+    // Many updates of the same component result in a single replacement
+    // with the latest value.
+    for (auto i = 0; i < 3; ++i) {
+        reg0.patch<another_comp>(ent0, [&](auto &comp) { comp.d = 2.0 + i; });
+        reg0.patch<another_comp>(unobserved, [&](auto &comp) { comp.d = 2.0 + i; });
+    }
+
+    // Updates of removed components are dropped.
+    reg0.patch<edyn::position>(ent1, [](auto &pos) { pos = edyn::vector3_x; });
+    reg0.remove<edyn::position>(ent1);
+
+    // The removal is inserted right away.
+    ASSERT_FALSE(builder.empty());
+    observer.flush();
+    auto ops = builder.finish();
+
+    auto num_replace = 0;
+    auto num_remove = 0;
+
+    for (auto *op : ops.operations) {
+        if (op->operation_type() == edyn::registry_operation_type::replace) {
+            ++num_replace;
+            ASSERT_EQ(op->entity, ent0);
+            ASSERT_TRUE(op->payload_type_any_of<another_comp>());
+            ASSERT_EQ(static_cast<edyn::operation_replace<another_comp> *>(op)->component.d, 4.0);
+        } else if (op->operation_type() == edyn::registry_operation_type::remove) {
+            ++num_remove;
+            ASSERT_EQ(op->entity, ent1);
+        }
+    }
+
+    ASSERT_EQ(num_replace, 1);
+    ASSERT_EQ(num_remove, 1);
+
+    // Nothing is left for the next flush.
+    observer.flush();
+    ASSERT_TRUE(builder.empty());
+}
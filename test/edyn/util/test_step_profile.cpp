@@ -0,0 +1,53 @@
+#include "../common/common.hpp"
+#include "edyn/util/step_profile.hpp"
+
+TEST(test_step_profile, moving_average_and_max) {
+    auto profile = edyn::step_profile{};
+    profile.record(edyn::step_phase::narrowphase, 0.002);
+    ++profile.num_steps;
+
+    auto &timing = profile[edyn::step_phase::narrowphase];
+    ASSERT_DOUBLE_EQ(timing.average, 0.002);
+    ASSERT_DOUBLE_EQ(timing.max, 0.002);
+
+    profile.record(edyn::step_phase::narrowphase, 0.004);
+    ++profile.num_steps;
+    ASSERT_DOUBLE_EQ(timing.last, 0.004);
+    ASSERT_DOUBLE_EQ(timing.max, 0.004);
+    ASSERT_DOUBLE_EQ(timing.average, 0.002 + 0.002 * edyn::step_profile::smoothing);
+
+    profile.record(edyn::step_phase::narrowphase, 0.001);
+    ASSERT_DOUBLE_EQ(timing.max, 0.004);
+
+    profile.reset();
+    ASSERT_EQ(profile.num_steps, 0);
+    ASSERT_DOUBLE_EQ(timing.max, 0);
+}
+
+TEST(test_step_profile, sequential_steps) {
+    entt::registry registry;
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+    edyn::attach(registry, config);
+
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::box_shape{0.5, 0.5, 0.5};
+    edyn::make_rigidbody(registry, def);
+
+    edyn::set_paused(registry, true);
+    edyn::step_simulation(registry);
+    ASSERT_EQ(edyn::get_step_profile(registry).num_steps, 0);
+
+    edyn::set_step_profiling(registry, true);
+
+    for (int i = 0; i < 3; ++i) {
+        edyn::step_simulation(registry);
+    }
+
+    auto &profile = edyn::get_step_profile(registry);
+    ASSERT_EQ(profile.num_steps, 3);
+    ASSERT_GT(profile[edyn::step_phase::step].max, 0);
+    ASSERT_GE(profile[edyn::step_phase::step].last, profile[edyn::step_phase::narrowphase].last);
+
+    edyn::detach(registry);
+}
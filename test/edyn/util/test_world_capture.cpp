@@ -0,0 +1,90 @@
+#include "../common/common.hpp"
+#include "edyn/util/world_capture.hpp"
+
+class test_world_capture : public ::testing::Test {
+protected:
+    void SetUp() override {
+        config.execution_mode = edyn::execution_mode::sequential;
+        edyn::attach(source, config);
+        edyn::set_paused(source, true);
+
+        auto floor_def = edyn::rigidbody_def{};
+        floor_def.kind = edyn::rigidbody_kind::rb_static;
+        floor_def.shape = edyn::plane_shape{{0, 1, 0}, 0};
+        edyn::make_rigidbody(source, floor_def);
+
+        auto def = edyn::rigidbody_def{};
+        def.shape = edyn::sphere_shape{0.5};
+        def.position = {0, 2, 0};
+        sphere = edyn::make_rigidbody(source, def);
+    }
+
+    void TearDown() override {
+        edyn::detach(source);
+        edyn::detach(target);
+    }
+
+    edyn::init_config config;
+    entt::registry source;
+    entt::registry target;
+    entt::entity sphere;
+};
+
+TEST_F(test_world_capture, replay_reproduces_changes) {
+    edyn::begin_capture(source);
+    ASSERT_TRUE(edyn::is_capturing(source));
+
+    for (int i = 0; i < 5; ++i) {
+        edyn::step_simulation(source);
+    }
+
+    // Changes made between steps and bodies created after the capture began.
+    source.patch<edyn::linvel>(sphere, [](auto &v) { v = {1, 0, 0}; });
+
+    auto def = edyn::rigidbody_def{};
+    def.shape = edyn::sphere_shape{0.5};
+    def.position = {5, 2, 0};
+    edyn::make_rigidbody(source, def);
+
+    edyn::set_fixed_dt(source, edyn::scalar(1) / 120);
+
+    for (int i = 0; i < 5; ++i) {
+        edyn::step_simulation(source);
+    }
+
+    auto buffer = std::vector<uint8_t>{};
+    edyn::end_capture(source, buffer);
+    ASSERT_FALSE(edyn::is_capturing(source));
+
+    edyn::attach(target, config);
+    auto stats = edyn::world_replay_stats{};
+    ASSERT_TRUE(edyn::replay_capture(target, buffer.data(), buffer.size(), &stats));
+    ASSERT_EQ(stats.num_steps, 10);
+    ASSERT_TRUE(edyn::is_paused(target));
+    ASSERT_SCALAR_EQ(edyn::get_fixed_dt(target), edyn::scalar(1) / 120);
+
+    auto source_view = source.view<edyn::dynamic_tag, edyn::position>();
+    auto target_view = target.view<edyn::dynamic_tag, edyn::position>();
+    ASSERT_EQ(target_view.size_hint(), source_view.size_hint());
+
+    for (auto [entity, pos] : source_view.each()) {
+        auto found = false;
+
+        for (auto [target_entity, target_pos] : target_view.each()) {
+            found = found || edyn::distance_sqr(pos, target_pos) < edyn::scalar(1e-6);
+        }
+
+        ASSERT_TRUE(found);
+    }
+}
+
+TEST_F(test_world_capture, invalid_capture) {
+    edyn::begin_capture(source);
+    edyn::step_simulation(source);
+    auto buffer = std::vector<uint8_t>{};
+    edyn::end_capture(source, buffer);
+
+    edyn::attach(target, config);
+    buffer[0] = 0;
+    ASSERT_FALSE(edyn::replay_capture(target, buffer.data(), buffer.size()));
+}
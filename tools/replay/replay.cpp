@@ -0,0 +1,107 @@
+#include <edyn/edyn.hpp>
+#include <edyn/networking/sys/server_side.hpp>
+#include <edyn/serialization/mapped_file.hpp>
+#include <edyn/time/time.hpp>
+#include <entt/entity/registry.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/**
+ * Replays a capture made with `edyn::begin_capture` and `edyn::end_capture`
+ * with step profiling enabled and prints the duration of each stage of the
+ * simulation step, to reproduce performance issues outside of the
+ * application where they were found.
+ */
+
+static void print_usage() {
+    std::printf("Usage: edyn_replay <capture> [sequential|async]\n"
+                "  sequential  Step the world in the calling thread (default).\n"
+                "  async       Step the world in a simulation worker thread.\n");
+}
+
+static const char * phase_name(edyn::step_phase phase) {
+    switch (phase) {
+    case edyn::step_phase::broadphase: return "broadphase";
+    case edyn::step_phase::island_management: return "island management";
+    case edyn::step_phase::paged_meshes: return "paged meshes";
+    case edyn::step_phase::narrowphase: return "narrowphase";
+    case edyn::step_phase::restitution: return "restitution";
+    case edyn::step_phase::prepare_constraints: return "prepare constraints";
+    case edyn::step_phase::solve_islands: return "solve islands";
+    case edyn::step_phase::post_solve: return "post solve";
+    case edyn::step_phase::maintenance: return "maintenance";
+    case edyn::step_phase::step: return "step";
+    }
+
+    return "";
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2 || argc > 3) {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+
+    auto config = edyn::init_config{};
+    config.execution_mode = edyn::execution_mode::sequential;
+
+    if (argc == 3) {
+        if (std::strcmp(argv[2], "async") == 0) {
+            config.execution_mode = edyn::execution_mode::asynchronous;
+        } else if (std::strcmp(argv[2], "sequential") != 0) {
+            print_usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    auto file = edyn::mapped_file{};
+    auto header = edyn::world_capture_header{};
+
+    if (!file.open(argv[1]) || !edyn::read_capture_header(file.data(), file.size(), header)) {
+        std::fprintf(stderr, "Failed to read %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    auto registry = entt::registry{};
+    edyn::attach(registry, config);
+
+    if (header.server) {
+        edyn::init_network_server(registry);
+    }
+
+    edyn::set_step_profiling(registry, true);
+
+    auto stats = edyn::world_replay_stats{};
+    auto start_time = edyn::performance_time();
+    auto valid = edyn::replay_capture(registry, file.data(), file.size(), &stats);
+    auto elapsed = edyn::performance_time() - start_time;
+
+    if (!valid) {
+        std::fprintf(stderr, "Invalid capture, replayed up to %.3fs of it.\n", stats.captured_duration);
+    }
+
+    std::printf("Replayed %.3fs in %.3fs: %u updates, %u steps, %u packets, %u operations.\n",
+                stats.captured_duration, elapsed,
+                stats.num_updates, stats.num_steps, stats.num_packets, stats.num_operations);
+
+    auto &profile = edyn::get_step_profile(registry);
+    std::printf("Profiled %llu steps.\n%-20s %10s %10s %10s\n",
+                static_cast<unsigned long long>(profile.num_steps),
+                "stage (ms)", "last", "average", "max");
+
+    for (size_t i = 0; i < edyn::num_step_phases; ++i) {
+        auto phase = static_cast<edyn::step_phase>(i);
+        auto &timing = profile[phase];
+        std::printf("%-20s %10.3f %10.3f %10.3f\n", phase_name(phase),
+                    timing.last * 1000, timing.average * 1000, timing.max * 1000);
+    }
+
+    if (header.server) {
+        edyn::deinit_network_server(registry);
+    }
+
+    edyn::detach(registry);
+
+    return valid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,84 @@
+#include <edyn/serialization/baked_shape_s11n.hpp>
+#include <edyn/util/shape_io.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/**
+ * Bakes shapes from *.obj files into files which can be loaded with
+ * `edyn::load_baked_triangle_mesh`, `edyn::load_baked_convex_polyhedrons`
+ * and `edyn::load_baked_compound_shape`, skipping parsing and the
+ * calculation of normals, edges, adjacency and trees at runtime.
+ */
+
+static void print_usage() {
+    std::printf("Usage: edyn_shape_baker <trimesh|convex> <input.obj> <output> [scale]\n"
+                "  trimesh  Bake a triangulated mesh for a mesh shape.\n"
+                "  convex   Bake every object in the file as a convex polyhedron, for\n"
+                "           polyhedron or compound shapes.\n");
+}
+
+static int bake_triangle_mesh(const char *input, const char *output, edyn::vector3 scale) {
+    auto vertices = std::vector<edyn::vector3>{};
+    auto indices = std::vector<uint32_t>{};
+
+    if (!edyn::load_tri_mesh_from_obj(input, vertices, indices, nullptr,
+                                      edyn::vector3_zero, edyn::quaternion_identity, scale)) {
+        std::fprintf(stderr, "Failed to read %s\n", input);
+        return EXIT_FAILURE;
+    }
+
+    auto trimesh = edyn::triangle_mesh{};
+    trimesh.insert_vertices(vertices.begin(), vertices.end());
+    trimesh.insert_indices(indices.begin(), indices.end());
+    trimesh.initialize();
+
+    if (!edyn::write_baked_triangle_mesh(output, trimesh)) {
+        std::fprintf(stderr, "Failed to write %s\n", output);
+        return EXIT_FAILURE;
+    }
+
+    std::printf("Baked triangle mesh with %zu vertices and %zu triangles.\n",
+                trimesh.num_vertices(), trimesh.num_triangles());
+    return EXIT_SUCCESS;
+}
+
+static int bake_convex_polyhedrons(const char *input, const char *output, edyn::vector3 scale) {
+    auto polyhedrons = edyn::load_convex_polyhedrons_from_obj(input, edyn::vector3_zero,
+                                                              edyn::quaternion_identity, scale);
+
+    if (polyhedrons.empty()) {
+        std::fprintf(stderr, "Failed to read %s\n", input);
+        return EXIT_FAILURE;
+    }
+
+    if (!edyn::write_baked_convex_polyhedrons(output, polyhedrons)) {
+        std::fprintf(stderr, "Failed to write %s\n", output);
+        return EXIT_FAILURE;
+    }
+
+    std::printf("Baked %zu convex polyhedrons.\n", polyhedrons.size());
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 4 || argc > 5) {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+
+    auto scale = edyn::vector3_one;
+
+    if (argc == 5) {
+        scale *= static_cast<edyn::scalar>(std::atof(argv[4]));
+    }
+
+    if (std::strcmp(argv[1], "trimesh") == 0) {
+        return bake_triangle_mesh(argv[2], argv[3], scale);
+    } else if (std::strcmp(argv[1], "convex") == 0) {
+        return bake_convex_polyhedrons(argv[2], argv[3], scale);
+    }
+
+    print_usage();
+    return EXIT_FAILURE;
+}